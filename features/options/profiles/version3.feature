@@ -0,0 +1,66 @@
+Feature: Profile API version 3
+
+    Background:
+        Given a grid size of 100 meters
+
+    Scenario: Batched node and way function calls
+        Given the profile file
+            """
+            api_version = 3
+
+            function setup()
+              return {
+                properties = {
+                  weight_name                       = 'test_version3',
+                  way_function_depends_on_tags_only = true
+                }
+              }
+            end
+
+            function process_node(profile, nodes, results)
+              print ('process_node batch of ' .. #nodes)
+            end
+
+            function process_way(profile, ways, results)
+              print ('process_way batch of ' .. #ways)
+              for i, way in ipairs(ways) do
+                local result = results[i]
+                result.name = way:get_value_by_key('name')
+                result.weight = 10
+                result.forward_mode = mode.driving
+                result.backward_mode = mode.driving
+                result.forward_speed = 36
+                result.backward_speed = 36
+              end
+            end
+
+            return {
+              setup = setup,
+              process_node = process_node,
+              process_way = process_way
+            }
+            """
+        And the node map
+            """
+               a
+              bcd
+               e
+            """
+        And the ways
+            | nodes  |
+            | ac     |
+            | cb     |
+            | cd     |
+            | ce     |
+        And the data has been saved to disk
+
+        When I run "osrm-extract --profile {profile_file} {osm_file}"
+        Then it should exit successfully
+        And stdout should contain "process_node batch of"
+        And stdout should contain "process_way batch of 4"
+
+        When I route I should get
+           | from | to | route    |
+           | a    | b  | ac,cb,cb |
+           | a    | d  | ac,cd,cd |
+           | a    | e  | ac,ce    |
@@ -67,6 +67,22 @@ class Contractor
                        std::vector<float> &inout_node_levels) const;
 
   private:
+    // Customizes the arcs of a contraction in nested dissection order instead of contracting
+    void RunCCH(const NodeID number_of_nodes,
+                const std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list) const;
+
+    // Renumbers the hierarchy and rewrites the files of osrm-extract in the order of
+    // makeLocalityPermutation, nodes already in the cell order of osrm-partition are kept
+    void RenumberNodes(util::DeallocatingVector<QueryEdge> &contracted_edge_list,
+                       std::vector<bool> &is_core_node,
+                       std::vector<float> &node_levels) const;
+
+    // Contracts the graph once for a node order and benchmarks the cores of the tuning factors
+    // built from that order, no files are written
+    void RunTuneCore(const NodeID number_of_nodes,
+                     std::vector<extractor::EdgeBasedEdge> edge_based_edge_list,
+                     const std::vector<EdgeWeight> &node_weights) const;
+
     ContractorConfig config;
 };
 }
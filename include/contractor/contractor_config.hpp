@@ -34,6 +34,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/filesystem/path.hpp>
 
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -47,8 +48,18 @@ struct ContractorConfig final : storage::IOConfig
               {
                   ".osrm",
               },
-              {},
-              {".osrm.level", ".osrm.core", ".osrm.hsgr", ".osrm.enw"}),
+              {".osrm.partition",
+               ".osrm.ebg",
+               ".osrm.ebg_nodes",
+               ".osrm.fileIndex",
+               ".osrm.nbg_nodes",
+               ".osrm.cnbg_to_ebg"},
+              {".osrm.level",
+               ".osrm.core",
+               ".osrm.hsgr",
+               ".osrm.enw",
+               ".osrm.cch",
+               ".osrm.checkpoint"}),
           requested_num_threads(0)
     {
     }
@@ -73,6 +84,30 @@ struct ContractorConfig final : storage::IOConfig
     // The remaining vertices form the core of the hierarchy
     //(e.g. 0.8 contracts 80 percent of the hierarchy, leaving a core of 20%)
     double core_factor;
+
+    // Build a customizable contraction hierarchy in the nested dissection order of the
+    // .osrm.partition file instead of contracting by node priorities. With use_cached_priority
+    // the order and arcs of the last run are read from .osrm.cch and only customized.
+    bool use_cch = false;
+
+    // Contract strictly in the order of the levels of the last run without evaluating any node
+    // priorities, implies use_cached_priority
+    bool use_fixed_order = false;
+
+    // Minutes between two checkpoints of the contraction in .osrm.checkpoint, 0 writes none.
+    // With resume_from_checkpoint an existing checkpoint is continued.
+    unsigned checkpoint_interval = 0;
+    bool resume_from_checkpoint = false;
+
+    // Number the nodes by level and along the Hilbert curve for the locality of the CH queries,
+    // all files of osrm-extract that use the edge-based node ids are rewritten in the new order
+    bool renumber_nodes = false;
+
+    // Core factors to compare on one contraction order instead of writing a hierarchy, each is
+    // benchmarked with the same random routes and one table of tune_table_size nodes squared
+    std::vector<double> tune_core_factors;
+    unsigned tune_number_of_routes = 1000;
+    unsigned tune_table_size = 100;
 };
 }
 }
@@ -6,25 +6,47 @@
 #include "util/typedefs.hpp"
 
 #include <cstddef>
+#include <cstdint>
 
 namespace osrm
 {
 namespace contractor
 {
 
+// Effort of the witness searches, summed up over the searches of a thread
+struct WitnessSearchStats
+{
+    std::uint64_t searches = 0;
+    std::uint64_t settled_nodes = 0;
+    // searches that stopped at the node limit before settling all targets
+    std::uint64_t exhausted_searches = 0;
+
+    WitnessSearchStats &operator+=(const WitnessSearchStats &other)
+    {
+        searches += other.searches;
+        settled_nodes += other.settled_nodes;
+        exhausted_searches += other.exhausted_searches;
+        return *this;
+    }
+};
+
 // allow access to the heap itself, add Dijkstra functionality on top
 class ContractorDijkstra
 {
   public:
     ContractorDijkstra(std::size_t heap_size);
 
-    // search the graph up
+    // search the graph up, only paths of at most hop_limit edges are followed
     void Run(const unsigned number_of_targets,
              const int node_limit,
              const int weight_limit,
+             const short hop_limit,
              const NodeID forbidden_node,
              const ContractorGraph &graph);
 
+    const WitnessSearchStats &GetStats() const { return stats; }
+    void ResetStats() { stats = WitnessSearchStats{}; }
+
     // adaption of the heap interface
     void Clear();
     bool WasInserted(const NodeID node) const;
@@ -42,6 +64,7 @@ class ContractorDijkstra
                    const ContractorGraph &graph);
 
     ContractorHeap heap;
+    WitnessSearchStats stats;
 };
 
 } // namespace contractor
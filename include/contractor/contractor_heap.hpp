@@ -18,11 +18,15 @@ struct ContractorHeapData
     bool target = false;
 };
 
+// Every thread keeps one heap for all its witness searches. The hash storage only holds the
+// nodes of one search and is cleared by bumping its timestamp, the implicit d-ary heap keeps the
+// weights of the entries in one array.
 using ContractorHeap = util::QueryHeap<NodeID,
                                        NodeID,
                                        EdgeWeight,
                                        ContractorHeapData,
-                                       util::XORFastHashStorage<NodeID, NodeID>>;
+                                       util::XORFastHashStorage<NodeID, NodeID>,
+                                       util::DAryHeapContainer<EdgeWeight, NodeID>>;
 
 } // namespace contractor
 } // namespace osrm
@@ -0,0 +1,57 @@
+#ifndef OSRM_CONTRACTOR_CUSTOMIZABLE_CONTRACTION_HPP
+#define OSRM_CONTRACTOR_CUSTOMIZABLE_CONTRACTION_HPP
+
+#include "contractor/query_edge.hpp"
+#include "extractor/edge_based_edge.hpp"
+#include "partition/multi_level_partition.hpp"
+
+#include "util/deallocating_vector.hpp"
+#include "util/typedefs.hpp"
+
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+// Metric independent part of a customizable contraction hierarchy (CCH): the contraction order
+// and the upward arcs that contracting the nodes in that order leaves. Unlike a CH contraction
+// there is no witness search, the arcs only depend on the order and every metric can be
+// customized onto them without contracting again.
+struct CCHTopology
+{
+    // the hierarchy numbers the nodes by rank, the lowest rank is contracted first
+    std::vector<NodeID> node_to_rank;
+    std::vector<NodeID> rank_to_node;
+    // the upward arcs of rank r are first_arc[r] to first_arc[r + 1], sorted by head rank
+    std::vector<EdgeID> first_arc;
+    std::vector<NodeID> arc_head;
+
+    NodeID GetNumberOfNodes() const { return rank_to_node.size(); }
+    EdgeID GetNumberOfArcs() const { return arc_head.size(); }
+};
+
+// Nested dissection order from the cells of osrm-partition. A cut edge makes one of its nodes a
+// separator node of the highest level its cells differ on. Nodes inside the cells of the lowest
+// level are contracted first, the separator nodes of the top level last, so contracting a node
+// only inserts arcs between nodes of the same cell and the separators around it.
+std::vector<NodeID> computeNestedDissectionOrder(const partition::MultiLevelPartition &mlp,
+                                                 const std::vector<extractor::EdgeBasedEdge> &edges,
+                                                 const NodeID number_of_nodes);
+
+// Contracts the graph in the order of node_to_rank, the upward neighbors of a node become a
+// clique. All edges are part of the topology, also the ones without a valid weight yet.
+CCHTopology contractTopology(std::vector<NodeID> node_to_rank,
+                             const std::vector<extractor::EdgeBasedEdge> &edges);
+
+// Computes the weights of all arcs of the topology for the edges by enumerating the lower
+// triangles of every arc. Nodes on the same level of the elimination tree do not depend on each
+// other and are customized in parallel. The arcs are returned in the format of a CH, so the CH
+// queries can search and unpack them.
+util::DeallocatingVector<QueryEdge>
+customizeTopology(const CCHTopology &topology, const std::vector<extractor::EdgeBasedEdge> &edges);
+}
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef OSRM_CONTRACTOR_FILES_HPP
 #define OSRM_CONTRACTOR_FILES_HPP
 
+#include "contractor/customizable_contraction.hpp"
 #include "contractor/query_graph.hpp"
 
 #include "util/serialization.hpp"
@@ -83,6 +84,30 @@ inline void writeLevels(const boost::filesystem::path &path, const std::vector<f
 
     storage::serialization::write(writer, node_levels);
 }
+
+// reads .osrm.cch file
+inline void readCCHTopology(const boost::filesystem::path &path, CCHTopology &topology)
+{
+    const auto fingerprint = storage::io::FileReader::VerifyFingerprint;
+    storage::io::FileReader reader{path, fingerprint};
+
+    storage::serialization::read(reader, topology.node_to_rank);
+    storage::serialization::read(reader, topology.rank_to_node);
+    storage::serialization::read(reader, topology.first_arc);
+    storage::serialization::read(reader, topology.arc_head);
+}
+
+// writes .osrm.cch file
+inline void writeCCHTopology(const boost::filesystem::path &path, const CCHTopology &topology)
+{
+    const auto fingerprint = storage::io::FileWriter::GenerateFingerprint;
+    storage::io::FileWriter writer{path, fingerprint};
+
+    storage::serialization::write(writer, topology.node_to_rank);
+    storage::serialization::write(writer, topology.rank_to_node);
+    storage::serialization::write(writer, topology.first_arc);
+    storage::serialization::write(writer, topology.arc_head);
+}
 }
 }
 }
@@ -13,12 +13,14 @@
 #include "util/xor_fast_hash.hpp"
 
 #include <boost/assert.hpp>
+#include <boost/filesystem/path.hpp>
 
 #include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_sort.h>
 
 #include <algorithm>
+#include <chrono>
 #include <limits>
 #include <memory>
 #include <vector>
@@ -32,6 +34,16 @@ namespace osrm
 namespace contractor
 {
 
+// Effort of one contraction round, the witness searches include the priority updates
+struct ContractionRoundStats
+{
+    NodeID remaining_nodes;
+    NodeID contracted_nodes;
+    float average_degree;
+    short witness_hop_limit;
+    WitnessSearchStats witness_searches;
+};
+
 class GraphContractor
 {
   private:
@@ -107,12 +119,21 @@ class GraphContractor
                                             std::vector<RemainingNodeData> &remaining_nodes,
                                             std::vector<float> &node_priorities);
 
-    void Run(double core_factor = 1.0);
+    // With fixed_order and cached node levels the nodes are contracted round by round in the order
+    // of their levels, only the nodes of the next rounds are checked for independence
+    void Run(double core_factor = 1.0, bool fixed_order = false);
+
+    // Run writes its state to the checkpoint after the first round that ends an interval later
+    // than the last checkpoint. With resume an existing checkpoint for the same graph is read
+    // instead of starting over and the contraction continues after its round.
+    void UseCheckpoint(boost::filesystem::path path, std::chrono::seconds interval, bool resume);
 
     std::vector<bool> GetCoreMarker();
 
     std::vector<float> GetNodeLevels();
 
+    const std::vector<ContractionRoundStats> &GetRoundStats() const { return round_stats; }
+
     template <class Edge> inline util::DeallocatingVector<Edge> GetEdges()
     {
         util::DeallocatingVector<Edge> edges;
@@ -145,6 +166,7 @@ class GraphContractor
                     BOOST_ASSERT_MSG(SPECIAL_NODEID != new_edge.target, "Target id invalid");
                     new_edge.data.weight = data.weight;
                     new_edge.data.duration = data.duration;
+                    new_edge.data.distance = data.distance;
                     new_edge.data.shortcut = data.shortcut;
                     if (!data.is_original_via_node_ID && !orig_node_id_from_new_node_id_map.empty())
                     {
@@ -262,6 +284,7 @@ class GraphContractor
                                                         target,
                                                         path_weight,
                                                         in_data.duration + out_data.duration,
+                                                        in_data.distance + out_data.distance,
                                                         out_data.originalEdges +
                                                             in_data.originalEdges,
                                                         node,
@@ -273,6 +296,7 @@ class GraphContractor
                                                         source,
                                                         path_weight,
                                                         in_data.duration + out_data.duration,
+                                                        in_data.distance + out_data.distance,
                                                         out_data.originalEdges +
                                                             in_data.originalEdges,
                                                         node,
@@ -297,14 +321,19 @@ class GraphContractor
                 dijkstra.Run(number_of_targets,
                              SIMULATION_SEARCH_SPACE_SIZE,
                              max_weight,
+                             witness_hop_limit,
                              node,
                              *contractor_graph);
             }
             else
             {
                 const int constexpr FULL_SEARCH_SPACE_SIZE = 2000;
-                dijkstra.Run(
-                    number_of_targets, FULL_SEARCH_SPACE_SIZE, max_weight, node, *contractor_graph);
+                dijkstra.Run(number_of_targets,
+                             FULL_SEARCH_SPACE_SIZE,
+                             max_weight,
+                             witness_hop_limit,
+                             node,
+                             *contractor_graph);
             }
             for (auto out_edge : contractor_graph->GetAdjacentEdgeRange(node))
             {
@@ -334,6 +363,7 @@ class GraphContractor
                                                     target,
                                                     path_weight,
                                                     in_data.duration + out_data.duration,
+                                                    in_data.distance + out_data.distance,
                                                     out_data.originalEdges + in_data.originalEdges,
                                                     node,
                                                     SHORTCUT_ARC,
@@ -344,6 +374,7 @@ class GraphContractor
                                                     source,
                                                     path_weight,
                                                     in_data.duration + out_data.duration,
+                                                    in_data.distance + out_data.distance,
                                                     out_data.originalEdges + in_data.originalEdges,
                                                     node,
                                                     SHORTCUT_ARC,
@@ -408,6 +439,33 @@ class GraphContractor
     // This bias function takes up 22 assembly instructions in total on X86
     bool Bias(const NodeID a, const NodeID b) const;
 
+    // Sets the hop limit of the witness searches by the average degree of the remaining nodes
+    float UpdateWitnessHopLimit(const std::vector<RemainingNodeData> &remaining_nodes);
+
+    // The state of Run between two rounds that is not kept in the members
+    struct ContractionProgress
+    {
+        // of the graph the contraction started with, a checkpoint only fits the same graph
+        NodeID number_of_nodes;
+        EdgeID number_of_edges;
+        NodeID number_of_contracted_nodes;
+        unsigned current_level;
+        bool flushed_contractor;
+        bool use_cached_node_priorities;
+        bool fixed_order;
+    };
+
+    void WriteCheckpoint(const ContractionProgress &progress,
+                         const std::vector<RemainingNodeData> &remaining_nodes,
+                         const std::vector<float> &node_priorities,
+                         const std::vector<NodeDepth> &node_depth) const;
+
+    ContractionProgress ReadCheckpoint(const NodeID number_of_nodes,
+                                       const EdgeID number_of_edges,
+                                       std::vector<RemainingNodeData> &remaining_nodes,
+                                       std::vector<float> &node_priorities,
+                                       std::vector<NodeDepth> &node_depth);
+
     std::shared_ptr<ContractorGraph> contractor_graph;
     ExternalVector<QueryEdge> external_edge_list;
     std::vector<NodeID> orig_node_id_from_new_node_id_map;
@@ -421,6 +479,14 @@ class GraphContractor
     std::vector<EdgeWeight> node_weights;
     std::vector<bool> is_core_node;
     util::XORFastHash<> fast_hash;
+
+    // Witness searches only follow paths of this many edges, the limit only grows
+    short witness_hop_limit = 1;
+    std::vector<ContractionRoundStats> round_stats;
+
+    boost::filesystem::path checkpoint_path;
+    std::chrono::seconds checkpoint_interval{0};
+    bool resume_from_checkpoint = false;
 };
 
 } // namespace contractor
@@ -0,0 +1,236 @@
+#ifndef OSRM_CONTRACTOR_PACKED_QUERY_GRAPH_HPP
+#define OSRM_CONTRACTOR_PACKED_QUERY_GRAPH_HPP
+
+#include "contractor/query_edge.hpp"
+#include "contractor/query_graph.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
+
+#include "storage/shared_memory_ownership.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+namespace packed_query_graph_details
+{
+// The adjacency of a node is split into the edges that are only usable forward, the ones usable
+// in both directions and the ones only usable backward, so each search direction scans one
+// contiguous range without the edges of the other direction.
+struct NodeArrayEntry
+{
+    EdgeID first_edge;
+    EdgeID first_bidirectional_edge;
+    EdgeID first_backward_edge;
+};
+
+// 16 bytes instead of the 20 of an edge of the QueryGraph, the weight, duration and flags share
+// one 64 bit word. The distances are only read by distance tables and are stored apart.
+struct EdgeArrayEntry
+{
+    NodeID target;
+    NodeID turn_id;
+    std::uint64_t weight : 31;
+    std::uint64_t duration : 30;
+    std::uint64_t shortcut : 1;
+    std::uint64_t forward : 1;
+    std::uint64_t backward : 1;
+};
+static_assert(sizeof(EdgeArrayEntry) == 16, "packed CH edges are expected to take 16 bytes");
+}
+
+namespace detail
+{
+// Read only CSR layout of a contracted graph with the interface of the QueryGraph that the CH
+// searches use. The edge data is unpacked on access and returned by value.
+template <storage::Ownership Ownership> class PackedQueryGraph
+{
+    template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
+
+  public:
+    using EdgeData = QueryEdge::EdgeData;
+    using NodeArrayEntry = packed_query_graph_details::NodeArrayEntry;
+    using EdgeArrayEntry = packed_query_graph_details::EdgeArrayEntry;
+    using EdgeRange = util::range<EdgeID>;
+
+    PackedQueryGraph() = default;
+
+    // Packs the edges of a QueryGraph, the edges of every direction keep their order by target
+    template <storage::Ownership OtherOwnership>
+    explicit PackedQueryGraph(const detail::QueryGraph<OtherOwnership> &graph)
+    {
+        const auto number_of_nodes = graph.GetNumberOfNodes();
+        node_array.reserve(number_of_nodes + 1);
+        edge_array.reserve(graph.GetNumberOfEdges());
+        distances.reserve(graph.GetNumberOfEdges());
+
+        const auto pack = [&](const NodeID node, const bool forward, const bool backward) {
+            for (const auto edge : graph.GetAdjacentEdgeRange(node))
+            {
+                const auto &data = graph.GetEdgeData(edge);
+                if (data.forward != forward || data.backward != backward)
+                    continue;
+
+                BOOST_ASSERT(data.weight >= 0);
+                EdgeArrayEntry entry;
+                entry.target = graph.GetTarget(edge);
+                entry.turn_id = data.turn_id;
+                entry.weight = data.weight;
+                entry.duration = data.duration;
+                entry.shortcut = data.shortcut;
+                entry.forward = data.forward;
+                entry.backward = data.backward;
+                edge_array.push_back(entry);
+                distances.push_back(data.distance);
+            }
+        };
+
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            NodeArrayEntry entry;
+            entry.first_edge = edge_array.size();
+            pack(node, true, false);
+            entry.first_bidirectional_edge = edge_array.size();
+            pack(node, true, true);
+            entry.first_backward_edge = edge_array.size();
+            pack(node, false, true);
+            node_array.push_back(entry);
+        }
+        const EdgeID number_of_edges = edge_array.size();
+        node_array.push_back(NodeArrayEntry{number_of_edges, number_of_edges, number_of_edges});
+    }
+
+    PackedQueryGraph(Vector<NodeArrayEntry> node_array_,
+                     Vector<EdgeArrayEntry> edge_array_,
+                     Vector<EdgeDistance> distances_)
+        : node_array(std::move(node_array_)), edge_array(std::move(edge_array_)),
+          distances(std::move(distances_))
+    {
+        BOOST_ASSERT(!node_array.empty());
+        BOOST_ASSERT(edge_array.size() == distances.size());
+        BOOST_ASSERT(node_array.back().first_edge == edge_array.size());
+    }
+
+    unsigned GetNumberOfNodes() const { return node_array.size() - 1; }
+
+    unsigned GetNumberOfEdges() const { return edge_array.size(); }
+
+    unsigned GetOutDegree(const NodeID node) const { return EndEdges(node) - BeginEdges(node); }
+
+    NodeID GetTarget(const EdgeID edge) const { return edge_array[edge].target; }
+
+    EdgeData GetEdgeData(const EdgeID edge) const
+    {
+        const auto &entry = edge_array[edge];
+        EdgeData data;
+        data.turn_id = entry.turn_id;
+        data.shortcut = entry.shortcut;
+        data.weight = entry.weight;
+        data.duration = entry.duration;
+        data.forward = entry.forward;
+        data.backward = entry.backward;
+        data.distance = distances[edge];
+        return data;
+    }
+
+    EdgeID BeginEdges(const NodeID node) const { return node_array[node].first_edge; }
+
+    EdgeID EndEdges(const NodeID node) const { return node_array[node + 1].first_edge; }
+
+    EdgeRange GetAdjacentEdgeRange(const NodeID node) const
+    {
+        return util::irange(BeginEdges(node), EndEdges(node));
+    }
+
+    // The edges of the node with data.forward set
+    EdgeRange GetForwardEdgeRange(const NodeID node) const
+    {
+        return util::irange(BeginEdges(node), node_array[node].first_backward_edge);
+    }
+
+    // The edges of the node with data.backward set
+    EdgeRange GetBackwardEdgeRange(const NodeID node) const
+    {
+        return util::irange(node_array[node].first_bidirectional_edge, EndEdges(node));
+    }
+
+    EdgeID FindEdge(const NodeID from, const NodeID to) const
+    {
+        for (const auto edge : GetAdjacentEdgeRange(from))
+        {
+            if (to == edge_array[edge].target)
+            {
+                return edge;
+            }
+        }
+        return SPECIAL_EDGEID;
+    }
+
+    // Finds the edge with the smallest weight from `from` to `to` whose data passes the filter
+    template <typename FilterFunction>
+    EdgeID FindSmallestEdge(const NodeID from, const NodeID to, FilterFunction &&filter) const
+    {
+        EdgeID smallest_edge = SPECIAL_EDGEID;
+        EdgeWeight smallest_weight = INVALID_EDGE_WEIGHT;
+        for (const auto edge : GetAdjacentEdgeRange(from))
+        {
+            const auto &entry = edge_array[edge];
+            if (entry.target == to && static_cast<EdgeWeight>(entry.weight) < smallest_weight &&
+                std::forward<FilterFunction>(filter)(GetEdgeData(edge)))
+            {
+                smallest_edge = edge;
+                smallest_weight = entry.weight;
+            }
+        }
+        return smallest_edge;
+    }
+
+    EdgeID FindEdgeInEitherDirection(const NodeID from, const NodeID to) const
+    {
+        const EdgeID edge = FindEdge(from, to);
+        return SPECIAL_EDGEID != edge ? edge : FindEdge(to, from);
+    }
+
+    EdgeID FindEdgeIndicateIfReverse(const NodeID from, const NodeID to, bool &result) const
+    {
+        EdgeID edge = FindEdge(from, to);
+        if (SPECIAL_EDGEID == edge)
+        {
+            edge = FindEdge(to, from);
+            if (SPECIAL_EDGEID != edge)
+            {
+                result = true;
+            }
+        }
+        return edge;
+    }
+
+    // Bytes of the node, edge and distance arrays
+    std::size_t GetMemorySize() const
+    {
+        return node_array.size() * sizeof(NodeArrayEntry) +
+               edge_array.size() * sizeof(EdgeArrayEntry) +
+               distances.size() * sizeof(EdgeDistance);
+    }
+
+  private:
+    Vector<NodeArrayEntry> node_array;
+    Vector<EdgeArrayEntry> edge_array;
+    Vector<EdgeDistance> distances;
+};
+}
+
+using PackedQueryGraph = detail::PackedQueryGraph<storage::Ownership::Container>;
+using PackedQueryGraphView = detail::PackedQueryGraph<storage::Ownership::View>;
+}
+}
+
+#endif
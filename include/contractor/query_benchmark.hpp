@@ -0,0 +1,38 @@
+#ifndef OSRM_CONTRACTOR_QUERY_BENCHMARK_HPP
+#define OSRM_CONTRACTOR_QUERY_BENCHMARK_HPP
+
+#include "contractor/packed_query_graph.hpp"
+#include "contractor/query_graph.hpp"
+
+#include <cstddef>
+
+namespace osrm
+{
+namespace contractor
+{
+
+struct QueryBenchmarkResult
+{
+    double route_milliseconds;
+    double route_settled_nodes;
+    double table_milliseconds;
+    std::size_t table_connected_pairs;
+};
+
+// A fixed workload of routes and one table between random nodes of a contracted graph, to
+// compare hierarchies without building a dataset for osrm-routed. The searches are those of the
+// CoreCH queries: upward searches outside of the core, since only they are contracted, and plain
+// Dijkstra searches on the core edges. Route searches stop at the best meeting node, the table
+// searches are exhaustive and meet in buckets.
+QueryBenchmarkResult benchmarkQueries(const QueryGraph &graph,
+                                      const std::size_t number_of_routes,
+                                      const std::size_t table_size);
+
+// The same workload on the packed layout, the searches only scan the edges of their direction
+QueryBenchmarkResult benchmarkQueries(const PackedQueryGraph &graph,
+                                      const std::size_t number_of_routes,
+                                      const std::size_t table_size);
+}
+}
+
+#endif
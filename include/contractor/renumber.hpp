@@ -0,0 +1,42 @@
+#ifndef OSRM_CONTRACTOR_RENUMBER_HPP
+#define OSRM_CONTRACTOR_RENUMBER_HPP
+
+#include "contractor/query_edge.hpp"
+#include "extractor/edge_based_node_segment.hpp"
+
+#include "util/coordinate.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+// Hilbert code of the first segment of every edge-based node, nodes without any segment get the
+// highest code
+std::vector<std::uint64_t>
+getNodeHilbertCodes(const NodeID number_of_nodes,
+                    const util::vector_view<const extractor::EdgeBasedNodeSegment> &segments,
+                    const std::vector<util::Coordinate> &coordinates);
+
+// Permutation from old to new node ids for the CH queries: the core and the highest levels get
+// the lowest ids, since every search ends in them, and the nodes of one level are numbered along
+// the Hilbert curve. The upward search of a query settles nodes whose data is close in memory.
+std::vector<NodeID> makeLocalityPermutation(const std::vector<float> &node_levels,
+                                            const std::vector<bool> &is_core_node,
+                                            const std::vector<std::uint64_t> &hilbert_codes);
+
+// Renumbers the sources, targets and middle nodes of the shortcuts, the edges are sorted again
+void renumber(util::DeallocatingVector<QueryEdge> &edges, const std::vector<NodeID> &permutation);
+
+// An empty marker stays empty
+void renumber(std::vector<bool> &is_core_node, const std::vector<NodeID> &permutation);
+}
+}
+
+#endif
@@ -7,7 +7,12 @@
 
 #include <tbb/enumerable_thread_specific.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
 #include <unordered_set>
+#include <vector>
 
 namespace osrm
 {
@@ -21,6 +26,7 @@ class CellCustomizer
     {
         bool from_clique;
         EdgeDuration duration;
+        EdgeDistance distance;
     };
 
   public:
@@ -28,11 +34,63 @@ class CellCustomizer
         util::QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, util::ArrayStorage<NodeID, int>>;
     using HeapPtr = tbb::enumerable_thread_specific<Heap>;
 
-    CellCustomizer(const partition::MultiLevelPartition &partition) : partition(partition) {}
+    // Overlay of the sub-cells of a cell above the first level and the shortest paths from all
+    // sources of the cell over it. The overlay nodes are the boundary nodes of the sub-cells, its
+    // arcs the clique arcs of the sub-cells and the base graph edges between them, grouped by the
+    // node they leave. Row i of the paths holds one column per source of the cell.
+    struct Matrix
+    {
+        struct Arc
+        {
+            std::size_t from;
+            std::size_t to;
+            EdgeWeight weight;
+            EdgeDuration duration;
+            EdgeDistance distance;
+        };
+
+        std::vector<NodeID> nodes;
+        std::vector<Arc> arcs;
+        std::vector<std::size_t> first_arc;
+
+        std::size_t num_sources;
+        std::vector<EdgeWeight> weights;
+        std::vector<EdgeDuration> durations;
+        std::vector<EdgeDistance> distances;
+        std::vector<std::uint8_t> changed;
+        std::vector<std::uint8_t> next_changed;
+    };
+    using MatrixPtr = tbb::enumerable_thread_specific<Matrix>;
+
+    // How the cells above the first level are customized, the first level is always customized
+    // with Dijkstra searches on the base graph
+    enum class Kernel
+    {
+        // a Dijkstra search per source over the cliques of the sub-cells
+        Dijkstra,
+        // min-plus products of a distance row per source and the matrix of the overlay
+        Matrix,
+        // the matrix for small cells with a dense overlay, Dijkstra searches otherwise
+        Automatic
+    };
+
+    // Up to this many overlay nodes the matrix of a cell fits into the cache
+    static constexpr std::size_t MAX_MATRIX_NODES = 256;
+    // The matrix is used if at least one in MATRIX_DENSITY entries holds an arc
+    static constexpr std::size_t MATRIX_DENSITY = 2;
+
+    CellCustomizer(const partition::MultiLevelPartition &partition,
+                   Kernel kernel = Kernel::Automatic)
+        : partition(partition), kernel(kernel)
+    {
+    }
 
     template <typename GraphT>
-    void Customize(
-        const GraphT &graph, Heap &heap, partition::CellStorage &cells, LevelID level, CellID id)
+    void Customize(const GraphT &graph,
+                   Heap &heap,
+                   partition::CellStorage &cells,
+                   LevelID level,
+                   CellID id) const
     {
         auto cell = cells.GetCell(level, id);
         auto destinations = cell.GetDestinationNodes();
@@ -42,7 +100,7 @@ class CellCustomizer
         {
             std::unordered_set<NodeID> destinations_set(destinations.begin(), destinations.end());
             heap.Clear();
-            heap.Insert(source, 0, {false, 0});
+            heap.Insert(source, 0, {false, 0, 0});
 
             // explore search space
             while (!heap.Empty() && !destinations_set.empty())
@@ -50,11 +108,12 @@ class CellCustomizer
                 const NodeID node = heap.DeleteMin();
                 const EdgeWeight weight = heap.GetKey(node);
                 const EdgeDuration duration = heap.GetData(node).duration;
+                const EdgeDistance distance = heap.GetData(node).distance;
 
                 if (level == 1)
-                    RelaxNode<true>(graph, cells, heap, level, node, weight, duration);
+                    RelaxNode<true>(graph, cells, heap, level, node, weight, duration, distance);
                 else
-                    RelaxNode<false>(graph, cells, heap, level, node, weight, duration);
+                    RelaxNode<false>(graph, cells, heap, level, node, weight, duration, distance);
 
                 destinations_set.erase(node);
             }
@@ -62,21 +121,118 @@ class CellCustomizer
             // fill a map of destination nodes to placeholder pointers
             auto weights = cell.GetOutWeight(source);
             auto durations = cell.GetOutDuration(source);
+            auto distances = cell.GetOutDistance(source);
             for (auto &destination : destinations)
             {
                 BOOST_ASSERT(!weights.empty());
                 BOOST_ASSERT(!durations.empty());
+                BOOST_ASSERT(!distances.empty());
 
                 const bool inserted = heap.WasInserted(destination);
                 weights.front() = inserted ? heap.GetKey(destination) : INVALID_EDGE_WEIGHT;
                 durations.front() =
                     inserted ? heap.GetData(destination).duration : MAXIMAL_EDGE_DURATION;
+                distances.front() =
+                    inserted ? heap.GetData(destination).distance : INVALID_EDGE_DISTANCE;
 
                 weights.advance_begin(1);
                 durations.advance_begin(1);
+                distances.advance_begin(1);
             }
             BOOST_ASSERT(weights.empty());
             BOOST_ASSERT(durations.empty());
+            BOOST_ASSERT(distances.empty());
+        }
+    }
+
+    // Same metric as the Dijkstra searches for a cell above the first level, computed for all
+    // sources at once. Every round relaxes the arcs leaving the rows that improved before, which
+    // is a min-plus product of those rows with the overlay. Relaxing an arc updates a whole row
+    // without branches and is vectorized by the compiler. Paths are extended arc by arc like in
+    // the Dijkstra search, so weights, durations and distances are summed in the same order. Of
+    // several paths with the same weight the one with the smallest duration and distance is
+    // taken, the Dijkstra search takes the first one it finds.
+    template <typename GraphT>
+    void Customize(const GraphT &graph,
+                   Matrix &matrix,
+                   partition::CellStorage &cells,
+                   LevelID level,
+                   CellID id) const
+    {
+        BOOST_ASSERT(level > 1);
+        BuildMatrix(graph, cells, level, id, matrix);
+
+        auto cell = cells.GetCell(level, id);
+        const auto sources = cell.GetSourceNodes();
+        const auto num_nodes = matrix.nodes.size();
+        const auto num_sources = matrix.num_sources = sources.size();
+        const auto index_of = [&matrix](const NodeID node) -> std::size_t {
+            const auto iter = std::lower_bound(matrix.nodes.begin(), matrix.nodes.end(), node);
+            BOOST_ASSERT(iter != matrix.nodes.end() && *iter == node);
+            return std::distance(matrix.nodes.begin(), iter);
+        };
+
+        // durations and distances of unreached nodes are 0 so that sums never overflow
+        matrix.weights.assign(num_nodes * num_sources, INVALID_EDGE_WEIGHT);
+        matrix.durations.assign(num_nodes * num_sources, 0);
+        matrix.distances.assign(num_nodes * num_sources, 0);
+        matrix.changed.assign(num_nodes, 0);
+        for (std::size_t column = 0; column < num_sources; ++column)
+        {
+            const auto row = index_of(sources[column]);
+            matrix.weights[row * num_sources + column] = 0;
+            matrix.changed[row] = 1;
+        }
+
+        bool any_changed = true;
+        while (any_changed)
+        {
+            any_changed = false;
+            matrix.next_changed.assign(num_nodes, 0);
+            for (std::size_t from = 0; from < num_nodes; ++from)
+            {
+                if (!matrix.changed[from])
+                    continue;
+
+                for (auto arc = matrix.first_arc[from]; arc < matrix.first_arc[from + 1]; ++arc)
+                {
+                    const auto to = matrix.arcs[arc].to;
+                    if (RelaxArc(matrix, matrix.arcs[arc]))
+                    {
+                        // rows after this one are still relaxed in this round
+                        auto &changed = to > from ? matrix.changed : matrix.next_changed;
+                        changed[to] = 1;
+                        any_changed |= to <= from;
+                    }
+                }
+            }
+            std::swap(matrix.changed, matrix.next_changed);
+        }
+
+        for (std::size_t column = 0; column < num_sources; ++column)
+        {
+            auto weights = cell.GetOutWeight(sources[column]);
+            auto durations = cell.GetOutDuration(sources[column]);
+            auto distances = cell.GetOutDistance(sources[column]);
+            for (auto destination : cell.GetDestinationNodes())
+            {
+                BOOST_ASSERT(!weights.empty());
+                BOOST_ASSERT(!durations.empty());
+                BOOST_ASSERT(!distances.empty());
+
+                const auto entry = index_of(destination) * num_sources + column;
+                const bool reached = matrix.weights[entry] != INVALID_EDGE_WEIGHT;
+                weights.front() = matrix.weights[entry];
+                durations.front() = reached ? matrix.durations[entry] : MAXIMAL_EDGE_DURATION;
+                distances.front() = reached ? matrix.distances[entry] : INVALID_EDGE_DISTANCE;
+
+                weights.advance_begin(1);
+                durations.advance_begin(1);
+                distances.advance_begin(1);
+            }
+            BOOST_ASSERT(weights.empty());
+            BOOST_ASSERT(durations.empty());
+            BOOST_ASSERT(distances.empty());
         }
     }
 
@@ -84,21 +240,230 @@ class CellCustomizer
     {
         Heap heap_exemplar(graph.GetNumberOfNodes());
         HeapPtr heaps(heap_exemplar);
+        MatrixPtr matrices;
 
         for (std::size_t level = 1; level < partition.GetNumberOfLevels(); ++level)
         {
             tbb::parallel_for(tbb::blocked_range<std::size_t>(0, partition.GetNumberOfCells(level)),
                               [&](const tbb::blocked_range<std::size_t> &range) {
-                                  auto &heap = heaps.local();
                                   for (auto id = range.begin(), end = range.end(); id != end; ++id)
                                   {
-                                      Customize(graph, heap, cells, level, id);
+                                      CustomizeCell(graph, heaps, matrices, cells, level, id);
                                   }
                               });
         }
     }
 
+    // Customizes only the cells that contain one of the updated nodes, and on the higher levels
+    // the cells containing those. All other cells keep the metric they already have in cells, so
+    // it has to be customized for the graph before its edges of the updated nodes changed.
+    // Returns the number of cells customized over all levels.
+    template <typename GraphT>
+    std::size_t Customize(const GraphT &graph,
+                          partition::CellStorage &cells,
+                          const std::vector<NodeID> &updated_nodes)
+    {
+        Heap heap_exemplar(graph.GetNumberOfNodes());
+        HeapPtr heaps(heap_exemplar);
+        MatrixPtr matrices;
+
+        std::size_t num_customized = 0;
+        std::vector<CellID> updated_cells;
+        for (std::size_t level = 1; level < partition.GetNumberOfLevels(); ++level)
+        {
+            // a cell on this level is the parent of the updated cells on the level below
+            updated_cells.clear();
+            for (const auto node : updated_nodes)
+            {
+                updated_cells.push_back(partition.GetCell(level, node));
+            }
+            std::sort(updated_cells.begin(), updated_cells.end());
+            updated_cells.erase(std::unique(updated_cells.begin(), updated_cells.end()),
+                                updated_cells.end());
+
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, updated_cells.size()),
+                              [&](const tbb::blocked_range<std::size_t> &range) {
+                                  for (auto index = range.begin(); index != range.end(); ++index)
+                                  {
+                                      CustomizeCell(graph,
+                                                    heaps,
+                                                    matrices,
+                                                    cells,
+                                                    level,
+                                                    updated_cells[index]);
+                                  }
+                              });
+            num_customized += updated_cells.size();
+        }
+        return num_customized;
+    }
+
   private:
+    template <typename GraphT>
+    void CustomizeCell(const GraphT &graph,
+                       HeapPtr &heaps,
+                       MatrixPtr &matrices,
+                       partition::CellStorage &cells,
+                       LevelID level,
+                       CellID id) const
+    {
+        if (UseMatrix(cells, level, id))
+        {
+            Customize(graph, matrices.local(), cells, level, id);
+        }
+        else
+        {
+            Customize(graph, heaps.local(), cells, level, id);
+        }
+    }
+
+    bool UseMatrix(const partition::CellStorage &cells, LevelID level, CellID id) const
+    {
+        if (level == 1 || kernel == Kernel::Dijkstra)
+            return false;
+        if (kernel == Kernel::Matrix)
+            return true;
+
+        // estimated from the cliques alone, border edges are few in comparison and most
+        // boundary nodes are both a source and a destination
+        std::size_t num_nodes = 0;
+        std::size_t num_arcs = 0;
+        for (auto child = partition.BeginChildren(level, id);
+             child != partition.EndChildren(level, id);
+             ++child)
+        {
+            const auto subcell = cells.GetCell(level - 1, child);
+            const std::size_t num_sources = subcell.GetSourceNodes().size();
+            const std::size_t num_destinations = subcell.GetDestinationNodes().size();
+            num_nodes += std::max(num_sources, num_destinations);
+            num_arcs += num_sources * num_destinations;
+        }
+        return num_nodes <= MAX_MATRIX_NODES && num_arcs * MATRIX_DENSITY >= num_nodes * num_nodes;
+    }
+
+    template <typename GraphT>
+    void BuildMatrix(const GraphT &graph,
+                     const partition::CellStorage &cells,
+                     LevelID level,
+                     CellID id,
+                     Matrix &matrix) const
+    {
+        const auto begin_children = partition.BeginChildren(level, id);
+        const auto end_children = partition.EndChildren(level, id);
+
+        matrix.nodes.clear();
+        for (auto child = begin_children; child != end_children; ++child)
+        {
+            const auto subcell = cells.GetCell(level - 1, child);
+            matrix.nodes.insert(matrix.nodes.end(),
+                                subcell.GetSourceNodes().begin(),
+                                subcell.GetSourceNodes().end());
+            matrix.nodes.insert(matrix.nodes.end(),
+                                subcell.GetDestinationNodes().begin(),
+                                subcell.GetDestinationNodes().end());
+        }
+        std::sort(matrix.nodes.begin(), matrix.nodes.end());
+        matrix.nodes.erase(std::unique(matrix.nodes.begin(), matrix.nodes.end()),
+                           matrix.nodes.end());
+
+        const auto num_nodes = matrix.nodes.size();
+        const auto index_of = [&matrix](const NodeID node) -> std::size_t {
+            BOOST_ASSERT(std::binary_search(matrix.nodes.begin(), matrix.nodes.end(), node));
+            return std::distance(
+                matrix.nodes.begin(),
+                std::lower_bound(matrix.nodes.begin(), matrix.nodes.end(), node));
+        };
+
+        matrix.arcs.clear();
+
+        // clique arcs of the sub-cells
+        for (auto child = begin_children; child != end_children; ++child)
+        {
+            const auto subcell = cells.GetCell(level - 1, child);
+            for (auto source : subcell.GetSourceNodes())
+            {
+                const auto from = index_of(source);
+                auto destination = subcell.GetDestinationNodes().begin();
+                auto duration = subcell.GetOutDuration(source).begin();
+                auto distance = subcell.GetOutDistance(source).begin();
+                for (auto weight : subcell.GetOutWeight(source))
+                {
+                    if (weight != INVALID_EDGE_WEIGHT)
+                        matrix.arcs.push_back(
+                            {from, index_of(*destination), weight, *duration, *distance});
+
+                    ++destination;
+                    ++duration;
+                    ++distance;
+                }
+            }
+        }
+
+        // base graph edges between sub-cells
+        for (std::size_t from = 0; from < num_nodes; ++from)
+        {
+            const auto node = matrix.nodes[from];
+            for (auto edge : graph.GetInternalEdgeRange(level, node))
+            {
+                const NodeID to = graph.GetTarget(edge);
+                const auto &data = graph.GetEdgeData(edge);
+                if (data.forward &&
+                    partition.GetCell(level - 1, node) != partition.GetCell(level - 1, to))
+                {
+                    matrix.arcs.push_back(
+                        {from, index_of(to), data.weight, data.duration, data.distance});
+                }
+            }
+        }
+
+        std::stable_sort(matrix.arcs.begin(),
+                         matrix.arcs.end(),
+                         [](const auto &lhs, const auto &rhs) { return lhs.from < rhs.from; });
+        matrix.first_arc.assign(num_nodes + 1, 0);
+        for (const auto &arc : matrix.arcs)
+        {
+            ++matrix.first_arc[arc.from + 1];
+        }
+        std::partial_sum(
+            matrix.first_arc.begin(), matrix.first_arc.end(), matrix.first_arc.begin());
+    }
+
+    // Extends the paths from all sources to the first node of the arc by the arc, true if one of
+    // the paths to the second node got shorter
+    static bool RelaxArc(Matrix &matrix, const typename Matrix::Arc &arc)
+    {
+        const auto num_sources = matrix.num_sources;
+        const EdgeWeight *const from_weights = matrix.weights.data() + arc.from * num_sources;
+        const EdgeDuration *const from_durations = matrix.durations.data() + arc.from * num_sources;
+        const EdgeDistance *const from_distances = matrix.distances.data() + arc.from * num_sources;
+        EdgeWeight *const to_weights = matrix.weights.data() + arc.to * num_sources;
+        EdgeDuration *const to_durations = matrix.durations.data() + arc.to * num_sources;
+        EdgeDistance *const to_distances = matrix.distances.data() + arc.to * num_sources;
+
+        std::uint8_t improved = 0;
+        for (std::size_t column = 0; column < num_sources; ++column)
+        {
+            // unreached nodes add nothing and never win, the sum can not overflow
+            const bool reached = from_weights[column] != INVALID_EDGE_WEIGHT;
+            const EdgeWeight weight = (reached ? from_weights[column] : 0) + arc.weight;
+            const EdgeDuration duration = from_durations[column] + arc.duration;
+            const EdgeDistance distance = from_distances[column] + arc.distance;
+
+            const bool better =
+                reached && (weight < to_weights[column] ||
+                            (weight == to_weights[column] &&
+                             (duration < to_durations[column] ||
+                              (duration == to_durations[column] &&
+                               distance < to_distances[column]))));
+
+            to_weights[column] = better ? weight : to_weights[column];
+            to_durations[column] = better ? duration : to_durations[column];
+            to_distances[column] = better ? distance : to_distances[column];
+            improved |= better;
+        }
+        return improved;
+    }
+
     template <bool first_level, typename GraphT>
     void RelaxNode(const GraphT &graph,
                    const partition::CellStorage &cells,
@@ -106,7 +471,8 @@ class CellCustomizer
                    LevelID level,
                    NodeID node,
                    EdgeWeight weight,
-                   EdgeDuration duration) const
+                   EdgeDuration duration,
+                   EdgeDistance distance) const
     {
         BOOST_ASSERT(heap.WasInserted(node));
 
@@ -126,25 +492,29 @@ class CellCustomizer
                 auto subcell = cells.GetCell(level - 1, subcell_id);
                 auto subcell_destination = subcell.GetDestinationNodes().begin();
                 auto subcell_duration = subcell.GetOutDuration(node).begin();
+                auto subcell_distance = subcell.GetOutDistance(node).begin();
                 for (auto subcell_weight : subcell.GetOutWeight(node))
                 {
                     if (subcell_weight != INVALID_EDGE_WEIGHT)
                     {
                         const NodeID to = *subcell_destination;
                         const EdgeWeight to_weight = weight + subcell_weight;
+                        const HeapData to_data{
+                            true, duration + *subcell_duration, distance + *subcell_distance};
                         if (!heap.WasInserted(to))
                         {
-                            heap.Insert(to, to_weight, {true, duration + *subcell_duration});
+                            heap.Insert(to, to_weight, to_data);
                         }
                         else if (to_weight < heap.GetKey(to))
                         {
                             heap.DecreaseKey(to, to_weight);
-                            heap.GetData(to) = {true, duration + *subcell_duration};
+                            heap.GetData(to) = to_data;
                         }
                     }
 
                     ++subcell_destination;
                     ++subcell_duration;
+                    ++subcell_distance;
                 }
             }
         }
@@ -159,20 +529,22 @@ class CellCustomizer
                  partition.GetCell(level - 1, node) != partition.GetCell(level - 1, to)))
             {
                 const EdgeWeight to_weight = weight + data.weight;
+                const HeapData to_data{false, duration + data.duration, distance + data.distance};
                 if (!heap.WasInserted(to))
                 {
-                    heap.Insert(to, to_weight, {false, duration + data.duration});
+                    heap.Insert(to, to_weight, to_data);
                 }
                 else if (to_weight < heap.GetKey(to))
                 {
                     heap.DecreaseKey(to, to_weight);
-                    heap.GetData(to) = {false, duration + data.duration};
+                    heap.GetData(to) = to_data;
                 }
             }
         }
     }
 
     const partition::MultiLevelPartition &partition;
+    const Kernel kernel;
 };
 }
 }
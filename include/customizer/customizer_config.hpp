@@ -5,6 +5,7 @@
 
 #include <array>
 #include <string>
+#include <vector>
 
 #include "storage/io_config.hpp"
 #include "updater/updater_config.hpp"
@@ -22,8 +23,9 @@ struct CustomizationConfig final : storage::IOConfig
                   ".osrm",
               },
               {},
-              {".osrm.ebg", ".osrm.partition", ".osrm.cells", ".osrm.mldgr"}),
-          requested_num_threads(0)
+              {".osrm.ebg", ".osrm.partition", ".osrm.cells", ".osrm.mldgr", ".osrm.landmarks"}),
+          requested_num_threads(0), incremental(false), quantize_cell_metrics(false),
+          num_landmarks(0)
     {
     }
 
@@ -34,6 +36,23 @@ struct CustomizationConfig final : storage::IOConfig
     }
 
     unsigned requested_num_threads;
+    // Only customizes the cells with edges updated by the speed and turn penalty files, all
+    // other cells keep the metric of the previous run in .osrm.cells. This is only correct if
+    // the previous run used the same files except for the segments and turns they update now.
+    bool incremental;
+    // Writes the cell metrics of the upper levels quantized, see CellStorage::Quantize
+    bool quantize_cell_metrics;
+    // Landmarks of the goal directed MLD queries, computed on metric 0 and written to
+    // .osrm.landmarks. 0 removes the landmarks of a previous run.
+    unsigned num_landmarks;
+    // Speed files of the additional metrics, metric 0 uses the speed files of updater_config.
+    // Every metric gets its own cell and edge weights next to the ones of metric 0, they share
+    // the turn penalty files and the geometry of metric 0 is saved to .osrm.geometry.
+    std::vector<std::vector<std::string>> metric_speed_lookup_paths;
+    // Typical speeds over the day, see updater::SpeedProfiles. Every time slot of the profiles
+    // gets a metric after the ones of metric_speed_lookup_paths, it only uses the profile speeds.
+    std::string speed_profile_path;
+    std::string segment_profile_path;
 
     updater::UpdaterConfig updater_config;
 };
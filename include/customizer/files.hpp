@@ -0,0 +1,47 @@
+#ifndef OSRM_CUSTOMIZER_FILES_HPP
+#define OSRM_CUSTOMIZER_FILES_HPP
+
+#include "customizer/landmarks.hpp"
+#include "customizer/serialization.hpp"
+
+#include "storage/io.hpp"
+
+namespace osrm
+{
+namespace customizer
+{
+namespace files
+{
+
+// reads .osrm.landmarks file
+template <typename LandmarksT>
+inline void readLandmarks(const boost::filesystem::path &path, LandmarksT &landmarks)
+{
+    static_assert(std::is_same<LandmarksView, LandmarksT>::value ||
+                      std::is_same<Landmarks, LandmarksT>::value,
+                  "");
+
+    const auto fingerprint = storage::io::FileReader::VerifyFingerprint;
+    storage::io::FileReader reader{path, fingerprint};
+
+    serialization::read(reader, landmarks);
+}
+
+// writes .osrm.landmarks file
+template <typename LandmarksT>
+inline void writeLandmarks(const boost::filesystem::path &path, const LandmarksT &landmarks)
+{
+    static_assert(std::is_same<LandmarksView, LandmarksT>::value ||
+                      std::is_same<Landmarks, LandmarksT>::value,
+                  "");
+
+    const auto fingerprint = storage::io::FileWriter::GenerateFingerprint;
+    storage::io::FileWriter writer{path, fingerprint};
+
+    serialization::write(writer, landmarks);
+}
+}
+}
+}
+
+#endif
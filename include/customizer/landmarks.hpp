@@ -0,0 +1,242 @@
+#ifndef OSRM_CUSTOMIZER_LANDMARKS_HPP
+#define OSRM_CUSTOMIZER_LANDMARKS_HPP
+
+#include "util/query_heap.hpp"
+#include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
+
+#include "storage/io_fwd.hpp"
+#include "storage/shared_memory_ownership.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace customizer
+{
+namespace detail
+{
+template <storage::Ownership Ownership> class LandmarksImpl;
+}
+using Landmarks = detail::LandmarksImpl<storage::Ownership::Container>;
+using LandmarksView = detail::LandmarksImpl<storage::Ownership::View>;
+
+namespace serialization
+{
+template <storage::Ownership Ownership>
+inline void read(storage::io::FileReader &reader, detail::LandmarksImpl<Ownership> &landmarks);
+template <storage::Ownership Ownership>
+inline void write(storage::io::FileWriter &writer,
+                  const detail::LandmarksImpl<Ownership> &landmarks);
+}
+
+namespace detail
+{
+// The weights from and to a few landmarks for every node of the base graph. By the triangle
+// inequality they bound the weight between any two nodes from below, which MLD queries use as
+// potentials that direct their search to the target (A*, landmarks, triangle inequality).
+//
+// The bounds only hold for metrics that are no faster than the one the landmarks were computed
+// on, so osrm-customize computes them on metric 0 every time it runs.
+template <storage::Ownership Ownership> class LandmarksImpl
+{
+    template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
+
+  public:
+    using Weight = std::uint32_t;
+    static constexpr Weight INVALID_WEIGHT = std::numeric_limits<Weight>::max();
+
+    LandmarksImpl() = default;
+
+    LandmarksImpl(const std::uint32_t num_landmarks_, Vector<Weight> weights_)
+        : num_landmarks(num_landmarks_), weights(std::move(weights_))
+    {
+        BOOST_ASSERT(num_landmarks == 0 || weights.size() % (2 * num_landmarks) == 0);
+    }
+
+    bool Empty() const { return num_landmarks == 0; }
+
+    std::uint32_t GetNumberOfLandmarks() const { return num_landmarks; }
+
+    // INVALID_WEIGHT if the node can't be reached from the landmark
+    Weight GetWeightFrom(const std::uint32_t landmark, const NodeID node) const
+    {
+        return weights[(std::size_t{node} * num_landmarks + landmark) * 2];
+    }
+
+    // INVALID_WEIGHT if the landmark can't be reached from the node
+    Weight GetWeightTo(const std::uint32_t landmark, const NodeID node) const
+    {
+        return weights[(std::size_t{node} * num_landmarks + landmark) * 2 + 1];
+    }
+
+    // Lower bound of the weight of the shortest path from -> to, landmarks that don't reach both
+    // nodes in the same direction don't bound it
+    EdgeWeight GetLowerBound(const NodeID from, const NodeID to) const
+    {
+        const auto *from_weights = &weights[std::size_t{from} * num_landmarks * 2];
+        const auto *to_weights = &weights[std::size_t{to} * num_landmarks * 2];
+
+        std::int64_t bound = 0;
+        for (std::uint32_t landmark = 0; landmark < num_landmarks; ++landmark)
+        {
+            // weight(landmark -> to) <= weight(landmark -> from) + weight(from -> to)
+            const auto landmark_from = from_weights[2 * landmark];
+            const auto landmark_to = to_weights[2 * landmark];
+            if (landmark_from != INVALID_WEIGHT && landmark_to != INVALID_WEIGHT)
+            {
+                bound = std::max<std::int64_t>(bound, std::int64_t{landmark_to} - landmark_from);
+            }
+
+            // weight(from -> landmark) <= weight(from -> to) + weight(to -> landmark)
+            const auto from_landmark = from_weights[2 * landmark + 1];
+            const auto to_landmark = to_weights[2 * landmark + 1];
+            if (from_landmark != INVALID_WEIGHT && to_landmark != INVALID_WEIGHT)
+            {
+                bound = std::max<std::int64_t>(bound, std::int64_t{from_landmark} - to_landmark);
+            }
+        }
+        return static_cast<EdgeWeight>(bound);
+    }
+
+    friend void serialization::read<Ownership>(storage::io::FileReader &reader,
+                                               detail::LandmarksImpl<Ownership> &landmarks);
+    friend void serialization::write<Ownership>(storage::io::FileWriter &writer,
+                                                const detail::LandmarksImpl<Ownership> &landmarks);
+
+  private:
+    std::uint32_t num_landmarks = 0;
+    // (landmark -> node, node -> landmark) of every landmark, grouped by node
+    Vector<Weight> weights;
+};
+
+template <storage::Ownership Ownership>
+constexpr typename LandmarksImpl<Ownership>::Weight LandmarksImpl<Ownership>::INVALID_WEIGHT;
+}
+
+namespace detail
+{
+// Weights of the shortest paths from the landmark if FROM_LANDMARK is set, to it otherwise,
+// written to the entries of the landmark in weights
+template <bool FROM_LANDMARK, typename GraphT>
+void computeLandmarkWeights(const GraphT &graph,
+                            const NodeID landmark,
+                            const std::uint32_t index,
+                            const std::uint32_t num_landmarks,
+                            std::vector<Landmarks::Weight> &weights)
+{
+    using Heap =
+        util::QueryHeap<NodeID, NodeID, EdgeWeight, NodeID, util::ArrayStorage<NodeID, int>>;
+    Heap heap(graph.GetNumberOfNodes());
+    heap.Insert(landmark, 0, landmark);
+    while (!heap.Empty())
+    {
+        const auto node = heap.DeleteMin();
+        const auto weight = heap.GetKey(node);
+        weights[(std::size_t{node} * num_landmarks + index) * 2 + (FROM_LANDMARK ? 0 : 1)] = weight;
+
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = graph.GetEdgeData(edge);
+            if (!(FROM_LANDMARK ? data.forward : data.backward) ||
+                data.weight == INVALID_EDGE_WEIGHT)
+            {
+                continue;
+            }
+
+            const auto to = graph.GetTarget(edge);
+            const auto to_weight = weight + data.weight;
+            if (!heap.WasInserted(to))
+            {
+                heap.Insert(to, to_weight, node);
+            }
+            else if (!heap.WasRemoved(to) && to_weight < heap.GetKey(to))
+            {
+                heap.GetData(to) = node;
+                heap.DecreaseKey(to, to_weight);
+            }
+        }
+    }
+}
+}
+
+// Selects the landmarks one after another as the node that is farthest from the ones selected
+// before, the first one is the farthest node from node 0. Every landmark needs a forward and a
+// backward Dijkstra search over the whole graph, these two run in parallel.
+template <typename GraphT>
+Landmarks computeLandmarks(const GraphT &graph, const std::uint32_t num_landmarks)
+{
+    const auto num_nodes = graph.GetNumberOfNodes();
+    if (num_landmarks == 0 || num_nodes == 0)
+    {
+        return Landmarks{};
+    }
+
+    std::vector<Landmarks::Weight> weights(std::size_t{num_nodes} * num_landmarks * 2,
+                                           Landmarks::INVALID_WEIGHT);
+
+    // the farthest node of a search from node 0 is the first landmark
+    std::vector<Landmarks::Weight> start_weights(std::size_t{num_nodes} * 2,
+                                                 Landmarks::INVALID_WEIGHT);
+    detail::computeLandmarkWeights<true>(graph, 0, 0, 1, start_weights);
+    NodeID landmark = 0;
+    for (NodeID node = 0; node < num_nodes; ++node)
+    {
+        if (start_weights[std::size_t{node} * 2] != Landmarks::INVALID_WEIGHT &&
+            start_weights[std::size_t{node} * 2] > start_weights[std::size_t{landmark} * 2])
+        {
+            landmark = node;
+        }
+    }
+    start_weights.clear();
+    start_weights.shrink_to_fit();
+
+    // weight of the nearest landmark in either direction, nodes that no landmark reaches in any
+    // direction are in other components and never become one
+    std::vector<Landmarks::Weight> nearest(num_nodes, Landmarks::INVALID_WEIGHT);
+    for (std::uint32_t index = 0; index < num_landmarks; ++index)
+    {
+        tbb::parallel_for(tbb::blocked_range<int>(0, 2, 1),
+                          [&](const tbb::blocked_range<int> &range) {
+                              for (auto direction = range.begin(); direction < range.end();
+                                   ++direction)
+                              {
+                                  if (direction == 0)
+                                      detail::computeLandmarkWeights<true>(
+                                          graph, landmark, index, num_landmarks, weights);
+                                  else
+                                      detail::computeLandmarkWeights<false>(
+                                          graph, landmark, index, num_landmarks, weights);
+                              }
+                          });
+
+        nearest[landmark] = 0;
+        NodeID farthest = landmark;
+        for (NodeID node = 0; node < num_nodes; ++node)
+        {
+            const auto from = weights[(std::size_t{node} * num_landmarks + index) * 2];
+            const auto to = weights[(std::size_t{node} * num_landmarks + index) * 2 + 1];
+            nearest[node] = std::min({nearest[node], from, to});
+            if (nearest[node] != Landmarks::INVALID_WEIGHT && nearest[node] > nearest[farthest])
+            {
+                farthest = node;
+            }
+        }
+        landmark = farthest;
+    }
+
+    return Landmarks{num_landmarks, std::move(weights)};
+}
+}
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef OSRM_CUSTOMIZER_SERIALIZATION_HPP
+#define OSRM_CUSTOMIZER_SERIALIZATION_HPP
+
+#include "customizer/landmarks.hpp"
+
+#include "storage/io.hpp"
+#include "storage/serialization.hpp"
+#include "storage/shared_memory_ownership.hpp"
+
+namespace osrm
+{
+namespace customizer
+{
+namespace serialization
+{
+
+template <storage::Ownership Ownership>
+inline void read(storage::io::FileReader &reader, detail::LandmarksImpl<Ownership> &landmarks)
+{
+    reader.ReadInto(landmarks.num_landmarks);
+    storage::serialization::read(reader, landmarks.weights);
+}
+
+template <storage::Ownership Ownership>
+inline void write(storage::io::FileWriter &writer,
+                  const detail::LandmarksImpl<Ownership> &landmarks)
+{
+    writer.WriteOne(landmarks.num_landmarks);
+    storage::serialization::write(writer, landmarks.weights);
+}
+}
+}
+}
+
+#endif
@@ -24,6 +24,13 @@ struct Algorithm final
 {
 };
 }
+// Customizable Contraction Hierarchy, searched and unpacked like a CH
+namespace cch
+{
+struct Algorithm final
+{
+};
+}
 // Multi-Level Dijkstra
 namespace mld
 {
@@ -36,6 +43,7 @@ struct Algorithm final
 template <typename AlgorithmT> const char *name();
 template <> inline const char *name<ch::Algorithm>() { return "CH"; }
 template <> inline const char *name<corech::Algorithm>() { return "CoreCH"; }
+template <> inline const char *name<cch::Algorithm>() { return "CCH"; }
 template <> inline const char *name<mld::Algorithm>() { return "MLD"; }
 
 template <typename AlgorithmT> struct HasAlternativePathSearch final : std::false_type
@@ -47,15 +55,27 @@ template <typename AlgorithmT> struct HasShortestPathSearch final : std::false_t
 template <typename AlgorithmT> struct HasDirectShortestPathSearch final : std::false_type
 {
 };
+template <typename AlgorithmT> struct HasConditionalDirectShortestPathSearch final : std::false_type
+{
+};
 template <typename AlgorithmT> struct HasMapMatching final : std::false_type
 {
 };
 template <typename AlgorithmT> struct HasManyToManySearch final : std::false_type
 {
 };
+template <typename AlgorithmT> struct HasManyToManyPaths final : std::false_type
+{
+};
+template <typename AlgorithmT> struct HasOneToAllSearch final : std::false_type
+{
+};
 template <typename AlgorithmT> struct HasGetTileTurns final : std::false_type
 {
 };
+template <typename AlgorithmT> struct HasRerouteSearch final : std::false_type
+{
+};
 
 // Algorithms supported by Contraction Hierarchies
 template <> struct HasAlternativePathSearch<ch::Algorithm> final : std::true_type
@@ -73,9 +93,18 @@ template <> struct HasMapMatching<ch::Algorithm> final : std::true_type
 template <> struct HasManyToManySearch<ch::Algorithm> final : std::true_type
 {
 };
+template <> struct HasManyToManyPaths<ch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasOneToAllSearch<ch::Algorithm> final : std::true_type
+{
+};
 template <> struct HasGetTileTurns<ch::Algorithm> final : std::true_type
 {
 };
+template <> struct HasRerouteSearch<ch::Algorithm> final : std::true_type
+{
+};
 
 // Algorithms supported by Contraction Hierarchies with core
 // the rest is disabled because of performance reasons
@@ -88,10 +117,42 @@ template <> struct HasDirectShortestPathSearch<corech::Algorithm> final : std::t
 template <> struct HasMapMatching<corech::Algorithm> final : std::true_type
 {
 };
+template <> struct HasManyToManySearch<corech::Algorithm> final : std::true_type
+{
+};
 template <> struct HasGetTileTurns<corech::Algorithm> final : std::true_type
 {
 };
 
+// Algorithms supported by Customizable Contraction Hierarchies, the same as for CH
+template <> struct HasAlternativePathSearch<cch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasShortestPathSearch<cch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasDirectShortestPathSearch<cch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasMapMatching<cch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasManyToManySearch<cch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasManyToManyPaths<cch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasOneToAllSearch<cch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasGetTileTurns<cch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasRerouteSearch<cch::Algorithm> final : std::true_type
+{
+};
+
 // Algorithms supported by Multi-Level Dijkstra
 template <> struct HasAlternativePathSearch<mld::Algorithm> final : std::true_type
 {
@@ -99,6 +160,9 @@ template <> struct HasAlternativePathSearch<mld::Algorithm> final : std::true_ty
 template <> struct HasDirectShortestPathSearch<mld::Algorithm> final : std::true_type
 {
 };
+template <> struct HasConditionalDirectShortestPathSearch<mld::Algorithm> final : std::true_type
+{
+};
 template <> struct HasShortestPathSearch<mld::Algorithm> final : std::true_type
 {
 };
@@ -108,6 +172,12 @@ template <> struct HasMapMatching<mld::Algorithm> final : std::true_type
 template <> struct HasManyToManySearch<mld::Algorithm> final : std::true_type
 {
 };
+template <> struct HasManyToManyPaths<mld::Algorithm> final : std::true_type
+{
+};
+template <> struct HasOneToAllSearch<mld::Algorithm> final : std::true_type
+{
+};
 template <> struct HasGetTileTurns<mld::Algorithm> final : std::true_type
 {
 };
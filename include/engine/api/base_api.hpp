@@ -54,7 +54,8 @@ class BaseAPI
             return json::makeWaypoint(
                 phantom.location,
                 facade.GetNameForID(facade.GetNameIndex(phantom.forward_segment_id.id)).to_string(),
-                Hint{phantom, facade.GetCheckSum()});
+                Hint{phantom, facade.GetCheckSum()},
+                parameters.compact_hints);
         }
         else
         {
@@ -36,6 +36,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/optional.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -57,12 +61,30 @@ namespace api
  *  - bearings: limits the search for segments in the road network to given bearing(s) in degree
  *              towards true north in clockwise direction, optional per coordinate
  *  - approaches: force the phantom node to start towards the node with the road country side.
+ *  - compact_hints: generate hints in the variable length encoding of Hint::ToCompactBase64
+ *  - timeout: abandon the query after this duration, can only tighten the engine default
+ *  - output_format: render the response as JSON or in the binary format of
+ *                   util/json_binary_renderer.hpp
+ *  - metric: route on this metric of an MLD dataset customized with several metrics
+ *  - exclude: route on the MLD metric that excludes these classes, see `excludable` in the
+ *             profile
+ *  - departure_time: route on the MLD metric of the time slot of this UNIX timestamp, for data
+ *                    customized with speed profiles, and avoid the conditional turn
+ *                    restrictions that apply at it
+ *  - debug: `stats` adds what the searches of the request did to the response, for engines
+ *           built with ENABLE_SEARCH_STATISTICS
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
  */
 struct BaseParameters
 {
+    enum class OutputFormatType
+    {
+        JSON,
+        Binary
+    };
+
     std::vector<util::Coordinate> coordinates;
     std::vector<boost::optional<Hint>> hints;
     std::vector<boost::optional<double>> radiuses;
@@ -72,6 +94,32 @@ struct BaseParameters
     // Adds hints to response which can be included in subsequent requests, see `hints` above.
     bool generate_hints = true;
 
+    // Encoding of generated hints, see `compact_hints` above. Both encodings are accepted in
+    // `hints` regardless of it.
+    bool compact_hints = false;
+
+    // Encoding of the response, see `output_format` above. The engine always fills in a
+    // json::Object, the format is applied when it is rendered.
+    OutputFormatType output_format = OutputFormatType::JSON;
+
+    // Metric to route on, see `metric` above. CH datasets only have metric 0.
+    std::size_t metric = 0;
+
+    // Classes to exclude, see `exclude` above. Only combinations the profile lists as excludable
+    // can be excluded.
+    std::vector<std::string> exclude;
+
+    // Seconds since the UNIX epoch, see `departure_time` above. Can not be combined with
+    // `metric` or `exclude`.
+    boost::optional<std::uint64_t> departure_time;
+
+    // Adds the search statistics to the response, see `debug` above. Ignored by engines built
+    // without them.
+    bool debug_stats = false;
+
+    // Per-request deadline, see `timeout` above. Not part of the URL, set by the HTTP server.
+    boost::optional<std::chrono::milliseconds> timeout;
+
     BaseParameters(const std::vector<util::Coordinate> coordinates_ = {},
                    const std::vector<boost::optional<Hint>> hints_ = {},
                    std::vector<boost::optional<double>> radiuses_ = {},
@@ -93,9 +93,12 @@ util::json::Object makeRoute(const guidance::Route &route,
 // Creates a Waypoint without Hint, see the Hint overload below
 util::json::Object makeWaypoint(const util::Coordinate location, std::string name);
 
-// Creates a Waypoint with Hint, see the overload above when Hint is not needed
-util::json::Object
-makeWaypoint(const util::Coordinate location, std::string name, const Hint &hint);
+// Creates a Waypoint with Hint, see the overload above when Hint is not needed. The hint is
+// written with Hint::ToCompactBase64 if compact_hint is set.
+util::json::Object makeWaypoint(const util::Coordinate location,
+                                std::string name,
+                                const Hint &hint,
+                                const bool compact_hint = false);
 
 util::json::Object makeRouteLeg(guidance::RouteLeg leg, util::json::Array steps);
 
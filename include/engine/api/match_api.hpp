@@ -8,6 +8,7 @@
 #include "engine/datafacade/datafacade_base.hpp"
 
 #include "engine/internal_route_result.hpp"
+#include "engine/map_matching/matching_session.hpp"
 #include "engine/map_matching/sub_matching.hpp"
 
 #include "util/integer_range.hpp"
@@ -86,6 +87,12 @@ class MatchAPI final : public RouteAPI
             for (auto point_index : util::irange(
                      0u, static_cast<unsigned>(sub_matchings[sub_matching_index].indices.size())))
             {
+                // the position a session matched in an earlier request
+                if (sub_matchings[sub_matching_index].indices[point_index] ==
+                    map_matching::FRONTIER_INDEX)
+                {
+                    continue;
+                }
                 trace_idx_to_matching_idx[tidy_result
                                               .tidied_to_original[sub_matchings[sub_matching_index]
                                                                       .indices[point_index]]] =
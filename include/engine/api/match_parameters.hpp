@@ -30,6 +30,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "engine/api/route_parameters.hpp"
 
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -44,6 +45,9 @@ namespace api
  *
  * Holds member attributes:
  *  - timestamps: timestamp(s) for the corresponding input coordinate(s)
+ *  - session: id of a matching session the coordinates extend, empty to match them on their own.
+ *    A session keeps the state of its trace between requests, so a request may add as little as
+ *    one coordinate and does not tidy its trace.
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -77,10 +81,13 @@ struct MatchParameters : public RouteParameters
     std::vector<unsigned> timestamps;
     GapsType gaps;
     bool tidy;
+    std::string session;
 
     bool IsValid() const
     {
-        return RouteParameters::IsValid() &&
+        const auto coordinates_ok = session.empty() ? coordinates.size() >= 2
+                                                    : !coordinates.empty() && !tidy;
+        return coordinates_ok && BaseParameters::IsValid() &&
                (timestamps.empty() || timestamps.size() == coordinates.size());
     }
 };
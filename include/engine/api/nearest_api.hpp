@@ -9,6 +9,7 @@
 
 #include <boost/assert.hpp>
 
+#include <algorithm>
 #include <vector>
 
 namespace osrm
@@ -47,6 +48,43 @@ class NearestAPI final : public BaseAPI
         response.values["waypoints"] = std::move(waypoints);
     }
 
+    // Only builds the phantom nodes of the candidates if their hints are requested, names and
+    // locations don't need them
+    void MakeResponse(const std::vector<SegmentCandidate> &candidates,
+                      util::json::Object &response) const
+    {
+        BOOST_ASSERT(parameters.coordinates.size() == 1);
+
+        const auto &input_coordinate = parameters.coordinates.front();
+        util::json::Array waypoints;
+        waypoints.values.resize(candidates.size());
+        std::transform(candidates.begin(),
+                       candidates.end(),
+                       waypoints.values.begin(),
+                       [this, &input_coordinate](const SegmentCandidate &candidate) {
+                           auto waypoint = MakeCandidateWaypoint(input_coordinate, candidate);
+                           waypoint.values["distance"] = candidate.distance;
+                           return waypoint;
+                       });
+
+        response.values["code"] = "Ok";
+        response.values["waypoints"] = std::move(waypoints);
+    }
+
+    util::json::Object MakeCandidateWaypoint(const util::Coordinate input_coordinate,
+                                             const SegmentCandidate &candidate) const
+    {
+        if (parameters.generate_hints)
+        {
+            return MakeWaypoint(facade.MakePhantomNode(input_coordinate, candidate).phantom_node);
+        }
+
+        return json::makeWaypoint(
+            candidate.location,
+            facade.GetNameForID(facade.GetNameIndex(candidate.data.forward_segment_id.id))
+                .to_string());
+    }
+
     const NearestParameters &parameters;
 };
 
@@ -23,6 +23,8 @@
 #include "util/integer_range.hpp"
 #include "util/json_util.hpp"
 
+#include <tbb/parallel_for.h>
+
 #include <iterator>
 #include <vector>
 
@@ -36,8 +38,11 @@ namespace api
 class RouteAPI : public BaseAPI
 {
   public:
-    RouteAPI(const datafacade::BaseDataFacade &facade_, const RouteParameters &parameters_)
-        : BaseAPI(facade_, parameters_), parameters(parameters_)
+    // With parallel_legs set the legs of a route are assembled in TBB tasks
+    RouteAPI(const datafacade::BaseDataFacade &facade_,
+             const RouteParameters &parameters_,
+             const bool parallel_legs_ = false)
+        : BaseAPI(facade_, parameters_), parameters(parameters_), parallel_legs(parallel_legs_)
     {
     }
 
@@ -96,96 +101,151 @@ class RouteAPI : public BaseAPI
         return annotations_store;
     }
 
+    RouteParameters::AnnotationsType RequestedAnnotations() const
+    {
+        // To maintain support for uses of the old default constructors, we check
+        // if annotations property was set manually after default construction
+        if ((parameters.annotations == true) &&
+            (parameters.annotations_type == RouteParameters::AnnotationsType::None))
+        {
+            return RouteParameters::AnnotationsType::All;
+        }
+        return parameters.annotations_type;
+    }
+
+    // The parts of the leg geometries the response is made of, steps, overview and annotations
+    // all read the locations
+    guidance::LegGeometryFields RequestedGeometryFields() const
+    {
+        const auto requested_annotations = RequestedAnnotations();
+
+        auto fields = guidance::LegGeometryFields::None;
+        if (parameters.steps || parameters.overview != RouteParameters::OverviewType::False ||
+            requested_annotations != RouteParameters::AnnotationsType::None)
+        {
+            fields |= guidance::LegGeometryFields::Locations;
+        }
+        if (requested_annotations & RouteParameters::AnnotationsType::Weight)
+        {
+            fields |= guidance::LegGeometryFields::Weights;
+        }
+        if (requested_annotations & RouteParameters::AnnotationsType::Datasources)
+        {
+            fields |= guidance::LegGeometryFields::Datasources;
+        }
+        return fields;
+    }
+
+    void MakeLeg(const PhantomNodes &phantoms,
+                 const std::vector<PathData> &path_data,
+                 const bool reversed_source,
+                 const bool reversed_target,
+                 const guidance::LegGeometryFields fields,
+                 guidance::RouteLeg &leg,
+                 guidance::LegGeometry &leg_geometry) const
+    {
+        leg_geometry = guidance::assembleGeometry(BaseAPI::facade,
+                                                  path_data,
+                                                  phantoms.source_phantom,
+                                                  phantoms.target_phantom,
+                                                  reversed_source,
+                                                  reversed_target,
+                                                  fields);
+        leg = guidance::assembleLeg(facade,
+                                    path_data,
+                                    leg_geometry,
+                                    phantoms.source_phantom,
+                                    phantoms.target_phantom,
+                                    reversed_target,
+                                    parameters.steps);
+
+        if (parameters.steps)
+        {
+            auto steps = guidance::assembleSteps(BaseAPI::facade,
+                                                 path_data,
+                                                 leg_geometry,
+                                                 phantoms.source_phantom,
+                                                 phantoms.target_phantom,
+                                                 reversed_source,
+                                                 reversed_target);
+
+            /* Perform step-based post-processing.
+             *
+             * Using post-processing on basis of route-steps for a single leg at a time
+             * comes at the cost that we cannot count the correct exit for roundabouts.
+             * We can only emit the exit nr/intersections up to/starting at a part of the leg.
+             * If a roundabout is not terminated in a leg, we will end up with a
+             *enter-roundabout
+             * and exit-roundabout-nr where the exit nr is out of sync with the previous enter.
+             *
+             *         | S |
+             *         *   *
+             *  ----*        * ----
+             *                  T
+             *  ----*        * ----
+             *       V *   *
+             *         |   |
+             *         |   |
+             *
+             * Coming from S via V to T, we end up with the legs S->V and V->T. V-T will say to
+             *take
+             * the second exit, even though counting from S it would be the third.
+             * For S, we only emit `roundabout` without an exit number, showing that we enter a
+             *roundabout
+             * to find a via point.
+             * The same exit will be emitted, though, if we should start routing at S, making
+             * the overall response consistent.
+             *
+             * ⚠ CAUTION: order of post-processing steps is important
+             *    - postProcess must be called before collapseTurnInstructions that expects
+             *      post-processed roundabouts without Exit instructions
+             */
+
+            guidance::trimShortSegments(steps, leg_geometry);
+            leg.steps = guidance::postProcess(std::move(steps));
+            leg.steps = guidance::collapseTurnInstructions(std::move(leg.steps));
+            leg.steps = guidance::anticipateLaneChange(std::move(leg.steps));
+            leg.steps = guidance::buildIntersections(std::move(leg.steps));
+            leg.steps = guidance::suppressShortNameSegments(std::move(leg.steps));
+            leg.steps = guidance::assignRelativeLocations(std::move(leg.steps),
+                                                          leg_geometry,
+                                                          phantoms.source_phantom,
+                                                          phantoms.target_phantom);
+            leg_geometry = guidance::resyncGeometry(std::move(leg_geometry), leg.steps);
+        }
+    }
+
     util::json::Object MakeRoute(const std::vector<PhantomNodes> &segment_end_coordinates,
                                  const std::vector<std::vector<PathData>> &unpacked_path_segments,
                                  const std::vector<bool> &source_traversed_in_reverse,
                                  const std::vector<bool> &target_traversed_in_reverse) const
     {
-        std::vector<guidance::RouteLeg> legs;
-        std::vector<guidance::LegGeometry> leg_geometries;
         auto number_of_legs = segment_end_coordinates.size();
-        legs.reserve(number_of_legs);
-        leg_geometries.reserve(number_of_legs);
+        std::vector<guidance::RouteLeg> legs(number_of_legs);
+        std::vector<guidance::LegGeometry> leg_geometries(number_of_legs);
 
-        for (auto idx : util::irange<std::size_t>(0UL, number_of_legs))
-        {
+        const auto fields = RequestedGeometryFields();
+        // every leg is assembled on its own, post-processing never looks past the end of a leg
+        const auto make_leg = [&](const std::size_t idx) {
             const auto &phantoms = segment_end_coordinates[idx];
-            const auto &path_data = unpacked_path_segments[idx];
-
-            const bool reversed_source = source_traversed_in_reverse[idx];
-            const bool reversed_target = target_traversed_in_reverse[idx];
-
-            auto leg_geometry = guidance::assembleGeometry(BaseAPI::facade,
-                                                           path_data,
-                                                           phantoms.source_phantom,
-                                                           phantoms.target_phantom,
-                                                           reversed_source,
-                                                           reversed_target);
-            auto leg = guidance::assembleLeg(facade,
-                                             path_data,
-                                             leg_geometry,
-                                             phantoms.source_phantom,
-                                             phantoms.target_phantom,
-                                             reversed_target,
-                                             parameters.steps);
-
-            if (parameters.steps)
+            MakeLeg(phantoms,
+                    unpacked_path_segments[idx],
+                    source_traversed_in_reverse[idx],
+                    target_traversed_in_reverse[idx],
+                    fields,
+                    legs[idx],
+                    leg_geometries[idx]);
+        };
+        if (parallel_legs && number_of_legs > 1)
+        {
+            tbb::parallel_for(std::size_t{0}, number_of_legs, make_leg);
+        }
+        else
+        {
+            for (auto idx : util::irange<std::size_t>(0UL, number_of_legs))
             {
-                auto steps = guidance::assembleSteps(BaseAPI::facade,
-                                                     path_data,
-                                                     leg_geometry,
-                                                     phantoms.source_phantom,
-                                                     phantoms.target_phantom,
-                                                     reversed_source,
-                                                     reversed_target);
-
-                /* Perform step-based post-processing.
-                 *
-                 * Using post-processing on basis of route-steps for a single leg at a time
-                 * comes at the cost that we cannot count the correct exit for roundabouts.
-                 * We can only emit the exit nr/intersections up to/starting at a part of the leg.
-                 * If a roundabout is not terminated in a leg, we will end up with a
-                 *enter-roundabout
-                 * and exit-roundabout-nr where the exit nr is out of sync with the previous enter.
-                 *
-                 *         | S |
-                 *         *   *
-                 *  ----*        * ----
-                 *                  T
-                 *  ----*        * ----
-                 *       V *   *
-                 *         |   |
-                 *         |   |
-                 *
-                 * Coming from S via V to T, we end up with the legs S->V and V->T. V-T will say to
-                 *take
-                 * the second exit, even though counting from S it would be the third.
-                 * For S, we only emit `roundabout` without an exit number, showing that we enter a
-                 *roundabout
-                 * to find a via point.
-                 * The same exit will be emitted, though, if we should start routing at S, making
-                 * the overall response consistent.
-                 *
-                 * ⚠ CAUTION: order of post-processing steps is important
-                 *    - postProcess must be called before collapseTurnInstructions that expects
-                 *      post-processed roundabouts without Exit instructions
-                 */
-
-                guidance::trimShortSegments(steps, leg_geometry);
-                leg.steps = guidance::postProcess(std::move(steps));
-                leg.steps = guidance::collapseTurnInstructions(std::move(leg.steps));
-                leg.steps = guidance::anticipateLaneChange(std::move(leg.steps));
-                leg.steps = guidance::buildIntersections(std::move(leg.steps));
-                leg.steps = guidance::suppressShortNameSegments(std::move(leg.steps));
-                leg.steps = guidance::assignRelativeLocations(std::move(leg.steps),
-                                                              leg_geometry,
-                                                              phantoms.source_phantom,
-                                                              phantoms.target_phantom);
-                leg_geometry = guidance::resyncGeometry(std::move(leg_geometry), leg.steps);
+                make_leg(idx);
             }
-
-            leg_geometries.push_back(std::move(leg_geometry));
-            legs.push_back(std::move(leg));
         }
 
         auto route = guidance::assembleRoute(legs);
@@ -236,15 +296,7 @@ class RouteAPI : public BaseAPI
 
         std::vector<util::json::Object> annotations;
 
-        // To maintain support for uses of the old default constructors, we check
-        // if annotations property was set manually after default construction
-        auto requested_annotations = parameters.annotations_type;
-        if ((parameters.annotations == true) &&
-            (parameters.annotations_type == RouteParameters::AnnotationsType::None))
-        {
-            requested_annotations = RouteParameters::AnnotationsType::All;
-        }
-
+        const auto requested_annotations = RequestedAnnotations();
         if (requested_annotations != RouteParameters::AnnotationsType::None)
         {
             for (const auto idx : util::irange<std::size_t>(0UL, leg_geometries.size()))
@@ -316,6 +368,7 @@ class RouteAPI : public BaseAPI
     }
 
     const RouteParameters &parameters;
+    const bool parallel_legs;
 };
 
 } // ns api
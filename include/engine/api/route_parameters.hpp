@@ -49,6 +49,8 @@ namespace api
  *  - overview: adds overview geometry either Full, Simplified (according to highest zoom level) or
  *              False (not at all)
  *  - continue_straight: enable or disable continue_straight (disabled by default)
+ *  - reroute: the destination is the one of an earlier route, e.g. of a client that left it,
+ *             whose reverse search space is kept for the next re-routes
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -138,6 +140,7 @@ struct RouteParameters : public BaseParameters
     GeometriesType geometries = GeometriesType::Polyline;
     OverviewType overview = OverviewType::Simplified;
     boost::optional<bool> continue_straight;
+    bool reroute = false;
 
     bool IsValid() const
     {
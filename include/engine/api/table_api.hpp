@@ -3,6 +3,7 @@
 
 #include "engine/api/base_api.hpp"
 #include "engine/api/json_factory.hpp"
+#include "engine/api/table_matrices.hpp"
 #include "engine/api/table_parameters.hpp"
 
 #include "engine/datafacade/datafacade_base.hpp"
@@ -16,10 +17,17 @@
 #include "engine/internal_route_result.hpp"
 
 #include "util/integer_range.hpp"
+#include "util/json_renderer.hpp"
 
 #include <boost/range/algorithm/transform.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
@@ -36,8 +44,13 @@ class TableAPI final : public BaseAPI
     {
     }
 
-    virtual void MakeResponse(const std::vector<EdgeWeight> &durations,
+    // the tables hold the durations and the distances, only the ones asked for are filled
+    using Tables = std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>;
+
+    // paths holds the routes of the entries in parameters.paths in their order
+    virtual void MakeResponse(const Tables &tables,
                               const std::vector<PhantomNode> &phantoms,
+                              const std::vector<InternalRouteResult> &paths,
                               util::json::Object &response) const
     {
         auto number_of_sources = parameters.sources.size();
@@ -64,8 +77,164 @@ class TableAPI final : public BaseAPI
             response.values["destinations"] = MakeWaypoints(phantoms, parameters.destinations);
         }
 
-        response.values["durations"] =
-            MakeTable(durations, number_of_sources, number_of_destinations);
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+        {
+            response.values["durations"] =
+                MakeTable(tables.first, number_of_sources, number_of_destinations);
+        }
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            response.values["distances"] =
+                MakeTable(tables.second, number_of_sources, number_of_destinations);
+        }
+        if (!parameters.paths.empty())
+        {
+            response.values["paths"] = MakePaths(paths);
+        }
+        response.values["code"] = "Ok";
+    }
+
+    // Renders the same response as above straight into the output buffer. Only the waypoints
+    // go through json::Values, the tables are formatted row by row.
+    virtual void MakeResponse(const Tables &tables,
+                              const std::vector<PhantomNode> &phantoms,
+                              const std::vector<InternalRouteResult> &paths,
+                              std::vector<char> &output) const
+    {
+        const auto number_of_sources =
+            parameters.sources.empty() ? phantoms.size() : parameters.sources.size();
+        const auto number_of_destinations =
+            parameters.destinations.empty() ? phantoms.size() : parameters.destinations.size();
+
+        util::json::ArrayRenderer renderer{output};
+        Write(output, "{\"sources\":");
+        renderer(parameters.sources.empty() ? MakeWaypoints(phantoms)
+                                            : MakeWaypoints(phantoms, parameters.sources));
+        Write(output, ",\"destinations\":");
+        renderer(parameters.destinations.empty()
+                     ? MakeWaypoints(phantoms)
+                     : MakeWaypoints(phantoms, parameters.destinations));
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+        {
+            Write(output, ",\"durations\":");
+            MakeTable(tables.first, number_of_sources, number_of_destinations, output);
+        }
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            Write(output, ",\"distances\":");
+            MakeTable(tables.second, number_of_sources, number_of_destinations, output);
+        }
+        if (!parameters.paths.empty())
+        {
+            Write(output, ",\"paths\":");
+            renderer(MakePaths(paths));
+        }
+        Write(output, ",\"code\":\"Ok\"}");
+    }
+
+    // The response of a table that is searched a chunk of sources at a time, in pieces that
+    // concatenate to the rendered response above. Only one matrix is rendered while the rows
+    // come in, the distance rows are collected in deferred_rows if durations are asked for, too.
+    virtual void MakeResponseHead(const std::vector<PhantomNode> &phantoms,
+                                  std::vector<char> &output) const
+    {
+        util::json::ArrayRenderer renderer{output};
+        Write(output, "{\"sources\":");
+        renderer(parameters.sources.empty() ? MakeWaypoints(phantoms)
+                                            : MakeWaypoints(phantoms, parameters.sources));
+        Write(output, ",\"destinations\":");
+        renderer(parameters.destinations.empty()
+                     ? MakeWaypoints(phantoms)
+                     : MakeWaypoints(phantoms, parameters.destinations));
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+            Write(output, ",\"durations\":[");
+        else
+            Write(output, ",\"distances\":[");
+    }
+
+    // the tables hold the rows of a chunk that starts at first_row
+    virtual void MakeResponseRows(const Tables &tables,
+                                  const std::size_t first_row,
+                                  const std::size_t number_of_rows,
+                                  const std::size_t number_of_columns,
+                                  std::vector<char> &output,
+                                  std::vector<char> &deferred_rows) const
+    {
+        const bool durations = parameters.annotations & TableParameters::AnnotationsType::Duration;
+        if (durations)
+        {
+            MakeRows(tables.first, first_row, number_of_rows, number_of_columns, output);
+        }
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            MakeRows(tables.second,
+                     first_row,
+                     number_of_rows,
+                     number_of_columns,
+                     durations ? deferred_rows : output);
+        }
+    }
+
+    virtual void MakeResponseTail(const std::vector<char> &deferred_rows,
+                                  std::vector<char> &output) const
+    {
+        output.push_back(']');
+        if (parameters.annotations == TableParameters::AnnotationsType::All)
+        {
+            Write(output, ",\"distances\":[");
+            output.insert(output.end(), deferred_rows.begin(), deferred_rows.end());
+            output.push_back(']');
+        }
+        Write(output, ",\"code\":\"Ok\"}");
+    }
+
+    // Copies the tables into flat matrices of seconds and meters, only the waypoints and paths
+    // are built as json::Values
+    virtual void MakeResponse(const Tables &tables,
+                              const std::vector<PhantomNode> &phantoms,
+                              const std::vector<InternalRouteResult> &paths,
+                              TableMatrices &matrices) const
+    {
+        matrices.number_of_sources =
+            parameters.sources.empty() ? phantoms.size() : parameters.sources.size();
+        matrices.number_of_destinations =
+            parameters.destinations.empty() ? phantoms.size() : parameters.destinations.size();
+
+        auto &response = matrices.response;
+        response.values["sources"] = parameters.sources.empty()
+                                         ? MakeWaypoints(phantoms)
+                                         : MakeWaypoints(phantoms, parameters.sources);
+        response.values["destinations"] = parameters.destinations.empty()
+                                              ? MakeWaypoints(phantoms)
+                                              : MakeWaypoints(phantoms, parameters.destinations);
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+        {
+            matrices.durations.resize(tables.first.size());
+            std::transform(tables.first.begin(),
+                           tables.first.end(),
+                           matrices.durations.begin(),
+                           [](const EdgeWeight duration) {
+                               return duration == MAXIMAL_EDGE_DURATION
+                                          ? std::numeric_limits<double>::quiet_NaN()
+                                          : duration / 10.;
+                           });
+        }
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            matrices.distances.resize(tables.second.size());
+            std::transform(tables.second.begin(),
+                           tables.second.end(),
+                           matrices.distances.begin(),
+                           [](const EdgeDistance distance) {
+                               return distance == INVALID_EDGE_DISTANCE
+                                          ? std::numeric_limits<double>::quiet_NaN()
+                                          : ToDecimeters(distance) / 10.;
+                           });
+        }
+        if (!parameters.paths.empty())
+        {
+            response.values["paths"] = MakePaths(paths);
+        }
         response.values["code"] = "Ok";
     }
 
@@ -97,6 +266,42 @@ class TableAPI final : public BaseAPI
         return json_waypoints;
     }
 
+    // The full geometry of every path as a polyline, null for unreachable entries
+    virtual util::json::Array MakePaths(const std::vector<InternalRouteResult> &paths) const
+    {
+        BOOST_ASSERT(paths.size() == parameters.paths.size());
+        util::json::Array json_paths;
+        json_paths.values.reserve(paths.size());
+        for (const auto index : util::irange<std::size_t>(0UL, paths.size()))
+        {
+            const auto &path = paths[index];
+            util::json::Object json_path;
+            json_path.values["source"] = util::json::Number(parameters.paths[index].first);
+            json_path.values["destination"] = util::json::Number(parameters.paths[index].second);
+            if (!path.is_valid())
+            {
+                json_path.values["geometry"] = util::json::Null();
+                json_paths.values.push_back(std::move(json_path));
+                continue;
+            }
+
+            const auto &phantoms = path.segment_end_coordinates.front();
+            const std::vector<guidance::LegGeometry> leg_geometries{
+                guidance::assembleGeometry(BaseAPI::facade,
+                                           path.unpacked_path_segments.front(),
+                                           phantoms.source_phantom,
+                                           phantoms.target_phantom,
+                                           path.source_traversed_in_reverse.front(),
+                                           path.target_traversed_in_reverse.front(),
+                                           guidance::LegGeometryFields::Locations)};
+            const auto overview = guidance::assembleOverview(leg_geometries, false);
+            json_path.values["geometry"] =
+                json::makePolyline<100000>(overview.begin(), overview.end());
+            json_paths.values.push_back(std::move(json_path));
+        }
+        return json_paths;
+    }
+
     virtual util::json::Array MakeTable(const std::vector<EdgeWeight> &values,
                                         std::size_t number_of_rows,
                                         std::size_t number_of_columns) const
@@ -123,7 +328,151 @@ class TableAPI final : public BaseAPI
         return json_table;
     }
 
+    // Distances are rendered in meters, rounded to one decimal
+    virtual util::json::Array MakeTable(const std::vector<EdgeDistance> &values,
+                                        std::size_t number_of_rows,
+                                        std::size_t number_of_columns) const
+    {
+        util::json::Array json_table;
+        for (const auto row : util::irange<std::size_t>(0UL, number_of_rows))
+        {
+            util::json::Array json_row;
+            auto row_begin_iterator = values.begin() + (row * number_of_columns);
+            auto row_end_iterator = values.begin() + ((row + 1) * number_of_columns);
+            json_row.values.resize(number_of_columns);
+            std::transform(row_begin_iterator,
+                           row_end_iterator,
+                           json_row.values.begin(),
+                           [](const EdgeDistance distance) {
+                               if (distance == INVALID_EDGE_DISTANCE)
+                               {
+                                   return util::json::Value(util::json::Null());
+                               }
+                               return util::json::Value(
+                                   util::json::Number(ToDecimeters(distance) / 10.));
+                           });
+            json_table.values.push_back(std::move(json_row));
+        }
+        return json_table;
+    }
+
+    virtual void MakeTable(const std::vector<EdgeWeight> &values,
+                           std::size_t number_of_rows,
+                           std::size_t number_of_columns,
+                           std::vector<char> &output) const
+    {
+        output.push_back('[');
+        MakeRows(values, 0, number_of_rows, number_of_columns, output);
+        output.push_back(']');
+    }
+
+    virtual void MakeTable(const std::vector<EdgeDistance> &values,
+                           std::size_t number_of_rows,
+                           std::size_t number_of_columns,
+                           std::vector<char> &output) const
+    {
+        output.push_back('[');
+        MakeRows(values, 0, number_of_rows, number_of_columns, output);
+        output.push_back(']');
+    }
+
+    // Renders the rows of the values without the brackets of the table, the rows after the
+    // first one of the table are separated from the rows before
+    virtual void MakeRows(const std::vector<EdgeWeight> &values,
+                          std::size_t first_row,
+                          std::size_t number_of_rows,
+                          std::size_t number_of_columns,
+                          std::vector<char> &output) const
+    {
+        // most durations fit into "1234.5,"
+        output.reserve(output.size() + number_of_rows * (number_of_columns * 7 + 2) + 2);
+
+        for (const auto row : util::irange<std::size_t>(0UL, number_of_rows))
+        {
+            if (first_row + row > 0)
+                output.push_back(',');
+            output.push_back('[');
+            const auto row_begin = values.begin() + (row * number_of_columns);
+            for (auto iter = row_begin; iter != row_begin + number_of_columns; ++iter)
+            {
+                if (iter != row_begin)
+                    output.push_back(',');
+                if (*iter == MAXIMAL_EDGE_DURATION)
+                    Write(output, "null");
+                else
+                    WriteTenths(output, *iter);
+            }
+            output.push_back(']');
+        }
+    }
+
+    virtual void MakeRows(const std::vector<EdgeDistance> &values,
+                          std::size_t first_row,
+                          std::size_t number_of_rows,
+                          std::size_t number_of_columns,
+                          std::vector<char> &output) const
+    {
+        // most distances fit into "12345.6,"
+        output.reserve(output.size() + number_of_rows * (number_of_columns * 8 + 2) + 2);
+
+        for (const auto row : util::irange<std::size_t>(0UL, number_of_rows))
+        {
+            if (first_row + row > 0)
+                output.push_back(',');
+            output.push_back('[');
+            const auto row_begin = values.begin() + (row * number_of_columns);
+            for (auto iter = row_begin; iter != row_begin + number_of_columns; ++iter)
+            {
+                if (iter != row_begin)
+                    output.push_back(',');
+                if (*iter == INVALID_EDGE_DISTANCE)
+                    Write(output, "null");
+                else
+                    WriteTenths(output, ToDecimeters(*iter));
+            }
+            output.push_back(']');
+        }
+    }
+
     const TableParameters &parameters;
+
+  private:
+    template <std::size_t N> static void Write(std::vector<char> &output, const char (&literal)[N])
+    {
+        output.insert(output.end(), literal, literal + N - 1);
+    }
+
+    static std::int64_t ToDecimeters(const EdgeDistance distance)
+    {
+        return static_cast<std::int64_t>(std::llround(distance * 10.));
+    }
+
+    // Renders deci-seconds and decimeters like json::Number(value / 10.) would
+    static void WriteTenths(std::vector<char> &output, const std::int64_t value)
+    {
+        // sign plus the nineteen digits of a 64 bit integer
+        char buffer[20];
+        char *end = buffer + sizeof(buffer);
+        char *begin = end;
+
+        auto magnitude = value < 0 ? -value : value;
+        const auto tenths = magnitude % 10;
+        magnitude /= 10;
+        do
+        {
+            *--begin = '0' + magnitude % 10;
+            magnitude /= 10;
+        } while (magnitude > 0);
+        if (value < 0)
+            *--begin = '-';
+
+        output.insert(output.end(), begin, end);
+        if (tenths != 0)
+        {
+            output.push_back('.');
+            output.push_back('0' + tenths);
+        }
+    }
 };
 
 } // ns api
@@ -0,0 +1,37 @@
+#ifndef ENGINE_API_TABLE_MATRICES_HPP
+#define ENGINE_API_TABLE_MATRICES_HPP
+
+#include "util/json_container.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+
+/**
+ * Table response that keeps the matrices as flat arrays instead of a json::Array per row.
+ *
+ * The matrices are in row-major order with number_of_destinations entries per row. Durations
+ * are in seconds and distances in meters like in the JSON response, entries without a route
+ * are NaN. A matrix that was not asked for with the annotations stays empty.
+ */
+struct TableMatrices
+{
+    std::size_t number_of_sources = 0;
+    std::size_t number_of_destinations = 0;
+    std::vector<double> durations;
+    std::vector<double> distances;
+
+    // everything else of the response: sources, destinations, paths, code and message
+    util::json::Object response;
+};
+}
+}
+}
+
+#endif
@@ -34,6 +34,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -51,6 +53,9 @@ namespace api
  *             use all coordinates as sources
  *  - destinations: indices into coordinates indicating destinations for the Table service, no
  *                  destinations means use all coordinates as destinations
+ *  - annotations: the tables to return, durations and/or distances
+ *  - paths: (source, destination) entries of the table, indices into its rows and columns, whose
+ *           route geometries are returned as well
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -60,6 +65,18 @@ struct TableParameters : public BaseParameters
     std::vector<std::size_t> sources;
     std::vector<std::size_t> destinations;
 
+    enum class AnnotationsType
+    {
+        None = 0,
+        Duration = 0x01,
+        Distance = 0x02,
+        All = Duration | Distance
+    };
+
+    AnnotationsType annotations = AnnotationsType::Duration;
+
+    std::vector<std::pair<std::size_t, std::size_t>> paths;
+
     TableParameters() = default;
     template <typename... Args>
     TableParameters(std::vector<std::size_t> sources_,
@@ -70,6 +87,16 @@ struct TableParameters : public BaseParameters
     {
     }
 
+    template <typename... Args>
+    TableParameters(std::vector<std::size_t> sources_,
+                    std::vector<std::size_t> destinations_,
+                    const AnnotationsType annotations_,
+                    Args... args_)
+        : BaseParameters{std::forward<Args>(args_)...}, sources{std::move(sources_)},
+          destinations{std::move(destinations_)}, annotations{annotations_}
+    {
+    }
+
     bool IsValid() const
     {
         if (!BaseParameters::IsValid())
@@ -79,6 +106,10 @@ struct TableParameters : public BaseParameters
         if (coordinates.size() < 2)
             return false;
 
+        // there has to be at least one table to return
+        if (annotations == AnnotationsType::None)
+            return false;
+
         // 1/ The user is able to specify duplicates in srcs and dsts, in that case it's her fault
 
         // 2/ len(srcs) and len(dsts) smaller or equal to len(locations)
@@ -97,9 +128,34 @@ struct TableParameters : public BaseParameters
         if (std::any_of(begin(destinations), end(destinations), not_in_range))
             return false;
 
+        // 4/ paths are entries of the table
+        const auto number_of_sources = sources.empty() ? coordinates.size() : sources.size();
+        const auto number_of_destinations =
+            destinations.empty() ? coordinates.size() : destinations.size();
+        const auto not_an_entry = [&](const std::pair<std::size_t, std::size_t> &path) {
+            return path.first >= number_of_sources || path.second >= number_of_destinations;
+        };
+        if (std::any_of(begin(paths), end(paths), not_an_entry))
+            return false;
+
         return true;
     }
 };
+
+inline bool operator&(TableParameters::AnnotationsType lhs, TableParameters::AnnotationsType rhs)
+{
+    return static_cast<bool>(
+        static_cast<std::underlying_type_t<TableParameters::AnnotationsType>>(lhs) &
+        static_cast<std::underlying_type_t<TableParameters::AnnotationsType>>(rhs));
+}
+
+inline TableParameters::AnnotationsType operator|(TableParameters::AnnotationsType lhs,
+                                                  TableParameters::AnnotationsType rhs)
+{
+    return (TableParameters::AnnotationsType)(
+        static_cast<std::underlying_type_t<TableParameters::AnnotationsType>>(lhs) |
+        static_cast<std::underlying_type_t<TableParameters::AnnotationsType>>(rhs));
+}
 }
 }
 }
@@ -0,0 +1,39 @@
+#ifndef ENGINE_API_TABLE_WRITER_HPP
+#define ENGINE_API_TABLE_WRITER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+
+/**
+ * Receives the rendered JSON of a table response in pieces while the matrix is searched a chunk
+ * of sources at a time.
+ *
+ * The pieces concatenate to the response OSRM::Table renders into a std::vector<char>. Tables
+ * with paths are searched at once and written in a single piece.
+ */
+struct TableWriter
+{
+    // rows of the matrices that are searched and rendered at a time
+    std::size_t rows_per_chunk = std::numeric_limits<std::size_t>::max();
+
+    // called with every piece in order, may take the piece's buffer. Returning false cancels the
+    // search of the remaining rows.
+    std::function<bool(std::vector<char> &piece)> write;
+
+    // the rendered error if the query failed, pieces written before are not revoked
+    std::vector<char> error;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef OSRM_ENGINE_ASYNC_EXECUTOR_HPP
+#define OSRM_ENGINE_ASYNC_EXECUTOR_HPP
+
+#include <tbb/task_arena.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Runs the queries of the asynchronous OSRM methods on the threads of a TBB arena. The parallel
+// parts of a query, e.g. the searches of large tables, are split into tasks of the same arena,
+// so a concurrency of n bounds the threads of all asynchronous queries together.
+//
+// Destroying the executor waits for the tasks posted to it, a task must not destroy its own
+// executor.
+class AsyncExecutor final
+{
+  public:
+    // concurrency of 0 for one thread per core
+    explicit AsyncExecutor(const int concurrency)
+        : arena(concurrency > 0 ? concurrency : tbb::task_arena::automatic)
+    {
+    }
+
+    ~AsyncExecutor()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return pending == 0; });
+    }
+
+    AsyncExecutor(const AsyncExecutor &) = delete;
+    AsyncExecutor &operator=(const AsyncExecutor &) = delete;
+
+    // task must not throw, an exception leaving it terminates the process
+    template <typename Task> void Post(Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++pending;
+        }
+
+        arena.enqueue([this, task]() {
+            task();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0)
+            {
+                idle.notify_all();
+            }
+        });
+    }
+
+  private:
+    tbb::task_arena arena;
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::size_t pending = 0;
+};
+}
+}
+
+#endif
@@ -8,6 +8,7 @@
 
 #include <climits>
 #include <cstddef>
+#include <cstdint>
 
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/archive/iterators/base64_from_binary.hpp>
@@ -135,6 +136,73 @@ template <typename T> T decodeBase64Bytewise(const std::string &encoded)
     return x;
 }
 
+// URL and Filename safe alphabet without padding, section 5 of RFC 4648
+
+// Encodes a chunk of memory with '-' and '_' instead of '+' and '/' and no trailing '='.
+inline std::string encodeBase64URL(const unsigned char *first, const std::size_t size)
+{
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    std::string encoded;
+    encoded.reserve((size * 4 + 2) / 3);
+    for (std::size_t index = 0; index < size; index += 3)
+    {
+        const auto remaining = size - index;
+        const std::uint32_t group = (std::uint32_t{first[index]} << 16) |
+                                    (remaining > 1 ? std::uint32_t{first[index + 1]} << 8 : 0) |
+                                    (remaining > 2 ? std::uint32_t{first[index + 2]} : 0);
+        encoded.push_back(alphabet[(group >> 18) & 0x3f]);
+        encoded.push_back(alphabet[(group >> 12) & 0x3f]);
+        if (remaining > 1)
+            encoded.push_back(alphabet[(group >> 6) & 0x3f]);
+        if (remaining > 2)
+            encoded.push_back(alphabet[group & 0x3f]);
+    }
+    return encoded;
+}
+
+// Reverses encodeBase64URL, returns false for characters outside of the alphabet and lengths
+// no encoding can have.
+inline bool decodeBase64URL(const std::string &encoded, std::string &decoded)
+{
+    const auto value = [](const char c) -> int {
+        if (c >= 'A' && c <= 'Z')
+            return c - 'A';
+        if (c >= 'a' && c <= 'z')
+            return c - 'a' + 26;
+        if (c >= '0' && c <= '9')
+            return c - '0' + 52;
+        if (c == '-')
+            return 62;
+        if (c == '_')
+            return 63;
+        return -1;
+    };
+
+    if (encoded.size() % 4 == 1)
+        return false;
+
+    decoded.clear();
+    decoded.reserve(encoded.size() * 3 / 4);
+    std::uint32_t group = 0;
+    std::size_t bits = 0;
+    for (const auto c : encoded)
+    {
+        const auto sextet = value(c);
+        if (sextet < 0)
+            return false;
+        group = (group << 6) | static_cast<std::uint32_t>(sextet);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            decoded.push_back(static_cast<char>((group >> bits) & 0xff));
+        }
+    }
+    return true;
+}
+
 } // ns engine
 } // ns osrm
 
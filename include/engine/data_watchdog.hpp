@@ -3,18 +3,28 @@
 
 #include "engine/datafacade/contiguous_internalmem_datafacade.hpp"
 #include "engine/datafacade/shared_memory_allocator.hpp"
+#include "engine/engine_statistics.hpp"
 
 #include "storage/shared_datatype.hpp"
 #include "storage/shared_memory.hpp"
 #include "storage/shared_monitor.hpp"
+#include "storage/shared_segments.hpp"
 
 #include <boost/interprocess/sync/named_upgradable_mutex.hpp>
 #include <boost/thread/lock_types.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
@@ -23,21 +33,39 @@ namespace engine
 
 // This class monitors the shared memory region that contains the pointers to
 // the data and layout regions that should be used. This region is updated
-// once a new dataset arrives.
+// once a new dataset arrives. The pages of a new dataset are faulted in before
+// queries switch to it, so the first queries on it do not stall on page faults.
+//
+// Queries don't share the reference count of the facades. Every thread keeps a copy of the facades
+// of the current epoch with a control block of its own and only looks at the shared facades again
+// once the epoch changed. The old facades are retired after the swap, when every thread either
+// picked up the new ones or had its copy reset by the watchdog, and released when the last query
+// on them is done.
 template <typename AlgorithmT> class DataWatchdog final
 {
     using mutex_type = typename storage::SharedMonitor<storage::SharedDataTimestamp>::mutex_type;
     using FacadeT = datafacade::ContiguousInternalMemoryDataFacade<AlgorithmT>;
+    using Facades = std::vector<std::shared_ptr<const FacadeT>>;
+
+    // The facades a thread picked up in an epoch, the mutex is only contended while the watchdog
+    // retires them
+    struct ThreadFacades
+    {
+        std::mutex mutex;
+        std::uint64_t epoch = 0;
+        Facades facades;
+    };
 
   public:
-    DataWatchdog() : active(true), timestamp(0)
+    DataWatchdog() : active(true), timestamp(0), id(NextId()), epoch(1)
     {
         // create the initial facade before launching the watchdog thread
         {
             boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
 
-            facade = std::make_shared<const FacadeT>(
-                std::make_unique<datafacade::SharedMemoryAllocator>(barrier.data().region));
+            facades = std::make_shared<const Facades>(datafacade::makeMetricFacades<FacadeT>(
+                std::make_shared<datafacade::SharedMemoryAllocator>(
+                    barrier.data().static_region, barrier.data().metric_region)));
             timestamp = barrier.data().timestamp;
         }
 
@@ -49,30 +77,152 @@ template <typename AlgorithmT> class DataWatchdog final
         active = false;
         barrier.notify_all();
         watcher.join();
+        Retire(std::numeric_limits<std::uint64_t>::max());
     }
 
-    std::shared_ptr<const FacadeT> Get() const { return facade; }
+    // nullptr if the data has no such metric
+    std::shared_ptr<const FacadeT> Get(const std::size_t metric) const
+    {
+        auto &local = GetThreadFacades();
+        // the facades are swapped before the epoch is bumped, so they are at least as new
+        const auto current_epoch = epoch.load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> lock(local.mutex);
+        if (local.epoch != current_epoch)
+        {
+            const auto current = std::atomic_load(&facades);
+            local.facades.clear();
+            for (const auto &facade : *current)
+            {
+                local.facades.emplace_back(facade.get(), [current](const FacadeT *) {});
+            }
+            local.epoch = current_epoch;
+        }
+        return metric < local.facades.size() ? local.facades[metric] : nullptr;
+    }
+
+    DataUpdateStatistics GetStatistics() const
+    {
+        storage::SharedGenerations generations;
+        {
+            boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
+            generations = storage::countGenerations(barrier.data());
+        }
+
+        std::lock_guard<std::mutex> lock(statistics_mutex);
+        auto result = statistics;
+        result.generations = generations.generations;
+        result.generation_bytes = generations.bytes;
+        return result;
+    }
 
   private:
+    static std::uint64_t NextId()
+    {
+        static std::atomic<std::uint64_t> next_id{0};
+        return ++next_id;
+    }
+
+    ThreadFacades &GetThreadFacades() const
+    {
+        // one entry per watchdog the thread queried, ids are never reused
+        static thread_local std::vector<std::pair<std::uint64_t, std::shared_ptr<ThreadFacades>>>
+            thread_facades;
+        for (const auto &entry : thread_facades)
+        {
+            if (entry.first == id)
+            {
+                return *entry.second;
+            }
+        }
+
+        auto local = std::make_shared<ThreadFacades>();
+        {
+            std::lock_guard<std::mutex> lock(threads_mutex);
+            threads.erase(std::remove_if(threads.begin(),
+                                         threads.end(),
+                                         [](const auto &thread) { return thread.expired(); }),
+                          threads.end());
+            threads.push_back(local);
+        }
+        thread_facades.emplace_back(id, local);
+        return *local;
+    }
+
+    // Resets the facades that threads picked up before current_epoch, the queries still running
+    // on them keep them alive
+    void Retire(const std::uint64_t current_epoch)
+    {
+        std::lock_guard<std::mutex> lock(threads_mutex);
+        for (const auto &thread : threads)
+        {
+            if (const auto local = thread.lock())
+            {
+                Facades retired;
+                {
+                    std::lock_guard<std::mutex> local_lock(local->mutex);
+                    if (local->epoch < current_epoch)
+                    {
+                        retired.swap(local->facades);
+                        local->epoch = 0;
+                    }
+                }
+            }
+        }
+    }
+
     void Run()
     {
         while (active)
         {
-            boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
-
-            while (active && timestamp == barrier.data().timestamp)
+            std::unique_ptr<datafacade::SharedMemoryAllocator> allocator;
+            storage::SharedDataType static_region = storage::REGION_NONE;
+            storage::SharedDataType metric_region = storage::REGION_NONE;
+            std::chrono::steady_clock::time_point notified;
             {
-                barrier.wait(current_region_lock);
+                boost::interprocess::scoped_lock<mutex_type> current_region_lock(
+                    barrier.get_mutex());
+
+                while (active && timestamp == barrier.data().timestamp)
+                {
+                    barrier.wait(current_region_lock);
+                }
+
+                if (timestamp != barrier.data().timestamp)
+                {
+                    notified = std::chrono::steady_clock::now();
+                    static_region = barrier.data().static_region;
+                    metric_region = barrier.data().metric_region;
+                    allocator = std::make_unique<datafacade::SharedMemoryAllocator>(
+                        static_region, metric_region);
+                    timestamp = barrier.data().timestamp;
+                }
             }
 
-            if (timestamp != barrier.data().timestamp)
+            // The regions stay mapped by the allocator, so the lock is not held while their
+            // pages are faulted in and other processes can still look at the current regions
+            if (allocator)
             {
-                auto region = barrier.data().region;
-                facade = std::make_shared<const FacadeT>(
-                    std::make_unique<datafacade::SharedMemoryAllocator>(region));
-                timestamp = barrier.data().timestamp;
-                util::Log() << "updated facade to region " << region << " with timestamp "
-                            << timestamp;
+                allocator->Prefault();
+                std::atomic_store(
+                    &facades,
+                    std::make_shared<const Facades>(datafacade::makeMetricFacades<FacadeT>(
+                        std::shared_ptr<datafacade::SharedMemoryAllocator>(std::move(allocator)))));
+                const auto current_epoch = epoch.fetch_add(1, std::memory_order_release) + 1;
+                Retire(current_epoch);
+
+                const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                                          std::chrono::steady_clock::now() - notified)
+                                          .count();
+                {
+                    std::lock_guard<std::mutex> lock(statistics_mutex);
+                    statistics.updates++;
+                    statistics.total_us += duration;
+                    statistics.last_us = duration;
+                }
+                util::Log() << "updated facade to regions "
+                            << storage::regionToString(static_region) << " and "
+                            << storage::regionToString(metric_region) << " with timestamp "
+                            << timestamp << " in " << (duration / 1000) << "ms";
             }
         }
 
@@ -83,7 +233,15 @@ template <typename AlgorithmT> class DataWatchdog final
     std::thread watcher;
     bool active;
     unsigned timestamp;
-    std::shared_ptr<const FacadeT> facade;
+    // one facade per metric, swapped atomically before the epoch is bumped, threads read it once
+    // per epoch
+    std::shared_ptr<const Facades> facades;
+    const std::uint64_t id;
+    std::atomic<std::uint64_t> epoch;
+    mutable std::mutex threads_mutex;
+    mutable std::vector<std::weak_ptr<ThreadFacades>> threads;
+    mutable std::mutex statistics_mutex;
+    DataUpdateStatistics statistics;
 };
 }
 }
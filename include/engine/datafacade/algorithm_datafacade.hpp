@@ -2,6 +2,8 @@
 #define OSRM_ENGINE_DATAFACADE_ALGORITHM_DATAFACADE_HPP
 
 #include "contractor/query_edge.hpp"
+#include "customizer/landmarks.hpp"
+#include "extractor/conditional_turn_mask.hpp"
 #include "extractor/edge_based_edge.hpp"
 #include "engine/algorithm.hpp"
 
@@ -9,6 +11,8 @@
 #include "partition/multi_level_partition.hpp"
 
 #include "util/integer_range.hpp"
+#include "util/search_edge.hpp"
+#include "util/vector_view.hpp"
 
 namespace osrm
 {
@@ -20,10 +24,16 @@ namespace datafacade
 // Namespace local aliases for algorithms
 using CH = routing_algorithms::ch::Algorithm;
 using CoreCH = routing_algorithms::corech::Algorithm;
+using CCH = routing_algorithms::cch::Algorithm;
 using MLD = routing_algorithms::mld::Algorithm;
 
 using EdgeRange = util::range<EdgeID>;
 
+// The interfaces the plugins see. The routing algorithms are instantiated against the concrete
+// ContiguousInternalMemoryDataFacade<Algorithm> (engine::DataFacade), which implements all of
+// the graph access as final overrides so that the calls in their search loops are resolved at
+// compile time and can be inlined.
+
 template <typename AlgorithmT> class AlgorithmDataFacade;
 
 template <> class AlgorithmDataFacade<CH>
@@ -42,12 +52,18 @@ template <> class AlgorithmDataFacade<CH>
 
     virtual const EdgeData &GetEdgeData(const EdgeID e) const = 0;
 
+    // the target, weight and directions of the edge, all a search relaxes
+    virtual const util::SearchEdge &GetSearchEdge(const EdgeID e) const = 0;
+
     virtual EdgeID BeginEdges(const NodeID n) const = 0;
 
     virtual EdgeID EndEdges(const NodeID n) const = 0;
 
     virtual EdgeRange GetAdjacentEdgeRange(const NodeID node) const = 0;
 
+    // hints that the edges of the node are looked up soon, see util/prefetch.hpp
+    virtual void PrefetchNode(const NodeID /*node*/) const {}
+
     // searches for a specific edge
     virtual EdgeID FindEdge(const NodeID from, const NodeID to) const = 0;
 
@@ -85,12 +101,18 @@ template <> class AlgorithmDataFacade<MLD>
 
     virtual const EdgeData &GetEdgeData(const EdgeID e) const = 0;
 
+    // the target, weight and directions of the edge, all a search relaxes
+    virtual const util::SearchEdge &GetSearchEdge(const EdgeID e) const = 0;
+
     virtual EdgeID BeginEdges(const NodeID n) const = 0;
 
     virtual EdgeID EndEdges(const NodeID n) const = 0;
 
     virtual EdgeRange GetAdjacentEdgeRange(const NodeID node) const = 0;
 
+    // hints that the edges of the node are looked up soon, see util/prefetch.hpp
+    virtual void PrefetchNode(const NodeID /*node*/) const {}
+
     virtual const partition::MultiLevelPartitionView &GetMultiLevelPartition() const = 0;
 
     virtual const partition::CellStorageView &GetCellStorage() const = 0;
@@ -99,6 +121,13 @@ template <> class AlgorithmDataFacade<MLD>
 
     // searches for a specific edge
     virtual EdgeID FindEdge(const NodeID from, const NodeID to) const = 0;
+
+    // conditional turn restrictions sorted by their turn, checked at the departure time of a query
+    virtual util::vector_view<const extractor::ConditionalTurnMask>
+    GetConditionalTurnMasks() const = 0;
+
+    // lower bounds of the weights between nodes, empty if they don't hold for the metric
+    virtual const customizer::LandmarksView &GetLandmarks() const = 0;
 };
 }
 }
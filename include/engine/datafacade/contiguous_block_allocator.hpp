@@ -17,9 +17,13 @@ class ContiguousBlockAllocator
 
     // interface to give access to the datafacades
     virtual storage::DataLayout &GetLayout() = 0;
-    virtual char *GetMemory() = 0;
+    virtual storage::DataLayout::Memory GetMemory() = 0;
 };
 
+// Locks the pages of all blocks into RAM and logs the locked bytes of every block. Throws if the
+// limit of locked memory of the process is too low for them.
+void lockBlocks(ContiguousBlockAllocator &allocator);
+
 } // namespace datafacade
 } // namespace engine
 } // namespace osrm
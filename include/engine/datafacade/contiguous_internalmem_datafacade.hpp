@@ -29,6 +29,7 @@
 #include "storage/shared_datatype.hpp"
 #include "storage/shared_memory_ownership.hpp"
 
+#include "util/delta_vector.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/guidance/bearing_class.hpp"
@@ -38,13 +39,15 @@
 #include "util/log.hpp"
 #include "util/name_table.hpp"
 #include "util/packed_vector.hpp"
-#include "util/range_table.hpp"
+#include "util/prefetch.hpp"
 #include "util/rectangle.hpp"
+#include "util/search_edge.hpp"
 #include "util/static_graph.hpp"
 #include "util/static_rtree.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
+#include <boost/optional.hpp>
 
 #include <algorithm>
 #include <cstddef>
@@ -73,11 +76,13 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
     using GraphEdge = QueryGraph::EdgeArrayEntry;
 
     QueryGraph m_query_graph;
+    util::vector_view<const util::SearchEdge> m_search_edges;
 
     // allocator that keeps the allocation data
     std::shared_ptr<ContiguousBlockAllocator> allocator;
 
-    void InitializeGraphPointer(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeGraphPointer(storage::DataLayout &data_layout,
+                                const storage::DataLayout::Memory &memory_block)
     {
         auto graph_nodes_ptr = data_layout.GetBlockPtr<GraphNode>(
             memory_block, storage::DataLayout::CH_GRAPH_NODE_LIST);
@@ -90,6 +95,12 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
         util::vector_view<GraphEdge> edge_list(
             graph_edges_ptr, data_layout.num_entries[storage::DataLayout::CH_GRAPH_EDGE_LIST]);
         m_query_graph = QueryGraph(node_list, edge_list);
+
+        auto search_edges_ptr = data_layout.GetBlockPtr<util::SearchEdge>(
+            memory_block, storage::DataLayout::CH_GRAPH_SEARCH_EDGE_LIST);
+        m_search_edges = util::vector_view<const util::SearchEdge>(
+            search_edges_ptr,
+            data_layout.num_entries[storage::DataLayout::CH_GRAPH_SEARCH_EDGE_LIST]);
     }
 
   public:
@@ -100,7 +111,8 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
         InitializeInternalPointers(allocator->GetLayout(), allocator->GetMemory());
     }
 
-    void InitializeInternalPointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeInternalPointers(storage::DataLayout &data_layout,
+                                    const storage::DataLayout::Memory &memory_block)
     {
         InitializeGraphPointer(data_layout, memory_block);
     }
@@ -122,6 +134,11 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
         return m_query_graph.GetEdgeData(e);
     }
 
+    const util::SearchEdge &GetSearchEdge(const EdgeID e) const override final
+    {
+        return m_search_edges[e];
+    }
+
     EdgeID BeginEdges(const NodeID n) const override final { return m_query_graph.BeginEdges(n); }
 
     EdgeID EndEdges(const NodeID n) const override final { return m_query_graph.EndEdges(n); }
@@ -131,6 +148,8 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
         return m_query_graph.GetAdjacentEdgeRange(node);
     }
 
+    void PrefetchNode(const NodeID node) const override final { m_query_graph.PrefetchNode(node); }
+
     // searches for a specific edge
     EdgeID FindEdge(const NodeID from, const NodeID to) const override final
     {
@@ -154,6 +173,14 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CH> : public datafacade::Algor
     {
         return m_query_graph.FindSmallestEdge(from, to, filter);
     }
+
+    // Overload for the routing algorithms which use this facade directly, the filter is inlined
+    // instead of being called through a std::function for every adjacent edge
+    template <typename FilterT>
+    EdgeID FindSmallestEdge(const NodeID from, const NodeID to, FilterT &&filter) const
+    {
+        return m_query_graph.FindSmallestEdge(from, to, std::forward<FilterT>(filter));
+    }
 };
 
 template <>
@@ -166,7 +193,8 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CoreCH>
     // allocator that keeps the allocation data
     std::shared_ptr<ContiguousBlockAllocator> allocator;
 
-    void InitializeCoreInformationPointer(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeCoreInformationPointer(storage::DataLayout &data_layout,
+                                          const storage::DataLayout::Memory &memory_block)
     {
         auto core_marker_ptr =
             data_layout.GetBlockPtr<unsigned>(memory_block, storage::DataLayout::CH_CORE_MARKER);
@@ -183,7 +211,8 @@ class ContiguousInternalMemoryAlgorithmDataFacade<CoreCH>
         InitializeInternalPointers(allocator->GetLayout(), allocator->GetMemory());
     }
 
-    void InitializeInternalPointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeInternalPointers(storage::DataLayout &data_layout,
+                                    const storage::DataLayout::Memory &memory_block)
     {
         InitializeCoreInformationPointer(data_layout, memory_block);
     }
@@ -206,7 +235,6 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
 {
   private:
     using super = BaseDataFacade;
-    using IndexBlock = util::RangeTable<16, storage::Ownership::View>::BlockT;
     using RTreeLeaf = super::RTreeLeaf;
     using SharedRTree = util::StaticRTree<RTreeLeaf, storage::Ownership::View>;
     using SharedGeospatialQuery = GeospatialQuery<SharedRTree, BaseDataFacade>;
@@ -224,6 +252,9 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
     util::vector_view<TurnPenalty> m_turn_weight_penalties;
     util::vector_view<TurnPenalty> m_turn_duration_penalties;
     extractor::SegmentDataView segment_data;
+    // the nodes of the segment data, which may be delta encoded
+    util::vector_view<unsigned> m_geometry_begin_indices;
+    util::DeltaVectorView<NodeID> m_geometry_nodes;
     extractor::TurnDataView turn_data;
     extractor::EdgeBasedNodeDataView edge_based_node_data;
 
@@ -246,13 +277,15 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
     // allocator that keeps the allocation data
     std::shared_ptr<ContiguousBlockAllocator> allocator;
 
-    void InitializeProfilePropertiesPointer(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeProfilePropertiesPointer(storage::DataLayout &data_layout,
+                                            const storage::DataLayout::Memory &memory_block)
     {
         m_profile_properties = data_layout.GetBlockPtr<extractor::ProfileProperties>(
             memory_block, storage::DataLayout::PROPERTIES);
     }
 
-    void InitializeTimestampPointer(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeTimestampPointer(storage::DataLayout &data_layout,
+                                    const storage::DataLayout::Memory &memory_block)
     {
         auto timestamp_ptr =
             data_layout.GetBlockPtr<char>(memory_block, storage::DataLayout::TIMESTAMP);
@@ -262,14 +295,16 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
                   m_timestamp.begin());
     }
 
-    void InitializeChecksumPointer(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeChecksumPointer(storage::DataLayout &data_layout,
+                                   const storage::DataLayout::Memory &memory_block)
     {
         m_check_sum =
             *data_layout.GetBlockPtr<unsigned>(memory_block, storage::DataLayout::HSGR_CHECKSUM);
         util::Log() << "set checksum: " << m_check_sum;
     }
 
-    void InitializeRTreePointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeRTreePointers(storage::DataLayout &data_layout,
+                                 const storage::DataLayout::Memory &memory_block)
     {
         BOOST_ASSERT_MSG(!m_coordinate_list.empty(), "coordinates must be loaded before r-tree");
 
@@ -298,7 +333,8 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
             new SharedGeospatialQuery(*m_static_rtree, m_coordinate_list, *this));
     }
 
-    void InitializeNodeInformationPointers(storage::DataLayout &layout, char *memory_ptr)
+    void InitializeNodeInformationPointers(storage::DataLayout &layout,
+                                           const storage::DataLayout::Memory &memory_ptr)
     {
         const auto coordinate_list_ptr =
             layout.GetBlockPtr<util::Coordinate>(memory_ptr, storage::DataLayout::COORDINATE_LIST);
@@ -315,8 +351,8 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
             layout.num_entries[storage::DataLayout::COORDINATE_LIST]);
     }
 
-    void InitializeEdgeBasedNodeDataInformationPointers(storage::DataLayout &layout,
-                                                        char *memory_ptr)
+    void InitializeEdgeBasedNodeDataInformationPointers(
+        storage::DataLayout &layout, const storage::DataLayout::Memory &memory_ptr)
     {
         const auto via_geometry_list_ptr =
             layout.GetBlockPtr<GeometryID>(memory_ptr, storage::DataLayout::GEOMETRY_ID_LIST);
@@ -350,42 +386,18 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
                                                                 std::move(classes));
     }
 
-    void InitializeEdgeInformationPointers(storage::DataLayout &layout, char *memory_ptr)
+    void InitializeEdgeInformationPointers(storage::DataLayout &layout,
+                                           const storage::DataLayout::Memory &memory_ptr)
     {
-        const auto lane_data_id_ptr =
-            layout.GetBlockPtr<LaneDataID>(memory_ptr, storage::DataLayout::LANE_DATA_ID);
-        util::vector_view<LaneDataID> lane_data_ids(
-            lane_data_id_ptr, layout.num_entries[storage::DataLayout::LANE_DATA_ID]);
-
-        const auto turn_instruction_list_ptr =
-            layout.GetBlockPtr<extractor::guidance::TurnInstruction>(
-                memory_ptr, storage::DataLayout::TURN_INSTRUCTION);
-        util::vector_view<extractor::guidance::TurnInstruction> turn_instructions(
-            turn_instruction_list_ptr, layout.num_entries[storage::DataLayout::TURN_INSTRUCTION]);
-
-        const auto entry_class_id_list_ptr =
-            layout.GetBlockPtr<EntryClassID>(memory_ptr, storage::DataLayout::ENTRY_CLASSID);
-        util::vector_view<EntryClassID> entry_class_ids(
-            entry_class_id_list_ptr, layout.num_entries[storage::DataLayout::ENTRY_CLASSID]);
-
-        const auto pre_turn_bearing_ptr = layout.GetBlockPtr<util::guidance::TurnBearing>(
-            memory_ptr, storage::DataLayout::PRE_TURN_BEARING);
-        util::vector_view<util::guidance::TurnBearing> pre_turn_bearings(
-            pre_turn_bearing_ptr, layout.num_entries[storage::DataLayout::PRE_TURN_BEARING]);
-
-        const auto post_turn_bearing_ptr = layout.GetBlockPtr<util::guidance::TurnBearing>(
-            memory_ptr, storage::DataLayout::POST_TURN_BEARING);
-        util::vector_view<util::guidance::TurnBearing> post_turn_bearings(
-            post_turn_bearing_ptr, layout.num_entries[storage::DataLayout::POST_TURN_BEARING]);
-
-        turn_data = extractor::TurnDataView(std::move(turn_instructions),
-                                            std::move(lane_data_ids),
-                                            std::move(entry_class_ids),
-                                            std::move(pre_turn_bearings),
-                                            std::move(post_turn_bearings));
+        const auto turn_data_ptr =
+            layout.GetBlockPtr<extractor::TurnData>(memory_ptr, storage::DataLayout::TURN_DATA);
+        util::vector_view<extractor::TurnData> turns(
+            turn_data_ptr, layout.num_entries[storage::DataLayout::TURN_DATA]);
+        turn_data = extractor::TurnDataView(std::move(turns));
     }
 
-    void InitializeNamePointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeNamePointers(storage::DataLayout &data_layout,
+                                const storage::DataLayout::Memory &memory_block)
     {
         auto name_data_ptr =
             data_layout.GetBlockPtr<char>(memory_block, storage::DataLayout::NAME_CHAR_DATA);
@@ -394,7 +406,7 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
     }
 
     void InitializeTurnLaneDescriptionsPointers(storage::DataLayout &data_layout,
-                                                char *memory_block)
+                                                const storage::DataLayout::Memory &memory_block)
     {
         auto offsets_ptr = data_layout.GetBlockPtr<std::uint32_t>(
             memory_block, storage::DataLayout::LANE_DESCRIPTION_OFFSETS);
@@ -417,7 +429,8 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         m_lane_tupel_id_pairs = std::move(lane_tupel_id_pair);
     }
 
-    void InitializeTurnPenalties(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeTurnPenalties(storage::DataLayout &data_layout,
+                                 const storage::DataLayout::Memory &memory_block)
     {
         auto turn_weight_penalties_ptr = data_layout.GetBlockPtr<TurnPenalty>(
             memory_block, storage::DataLayout::TURN_WEIGHT_PENALTIES);
@@ -431,18 +444,44 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
             data_layout.num_entries[storage::DataLayout::TURN_DURATION_PENALTIES]);
     }
 
-    void InitializeGeometryPointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeGeometryPointers(storage::DataLayout &data_layout,
+                                    const storage::DataLayout::Memory &memory_block)
     {
         auto geometries_index_ptr =
             data_layout.GetBlockPtr<unsigned>(memory_block, storage::DataLayout::GEOMETRIES_INDEX);
         util::vector_view<unsigned> geometry_begin_indices(
             geometries_index_ptr, data_layout.num_entries[storage::DataLayout::GEOMETRIES_INDEX]);
 
-        auto num_entries = data_layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_LIST];
+        // there is one datasource per node, unlike the nodes they are never encoded
+        auto num_entries =
+            data_layout.num_entries[storage::DataLayout::GEOMETRIES_FWD_DATASOURCES_LIST];
 
         auto geometries_node_list_ptr = data_layout.GetBlockPtr<NodeID>(
             memory_block, storage::DataLayout::GEOMETRIES_NODE_LIST);
-        util::vector_view<NodeID> geometry_node_list(geometries_node_list_ptr, num_entries);
+        util::vector_view<NodeID> geometry_node_list(
+            geometries_node_list_ptr,
+            data_layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_LIST]);
+
+        m_geometry_begin_indices = geometry_begin_indices;
+        if (data_layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_BLOCKS] > 0)
+        {
+            auto geometries_node_blocks_ptr = data_layout.GetBlockPtr<std::uint64_t>(
+                memory_block, storage::DataLayout::GEOMETRIES_NODE_BLOCKS);
+            auto geometries_node_deltas_ptr = data_layout.GetBlockPtr<std::uint8_t>(
+                memory_block, storage::DataLayout::GEOMETRIES_NODE_DELTAS);
+            m_geometry_nodes = util::DeltaVectorView<NodeID>(
+                util::vector_view<std::uint64_t>(
+                    geometries_node_blocks_ptr,
+                    data_layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_BLOCKS]),
+                util::vector_view<std::uint8_t>(
+                    geometries_node_deltas_ptr,
+                    data_layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_DELTAS]),
+                num_entries);
+        }
+        else
+        {
+            m_geometry_nodes = util::DeltaVectorView<NodeID>(geometry_node_list);
+        }
 
         auto geometries_fwd_weight_list_ptr =
             data_layout.GetBlockPtr<extractor::SegmentDataView::SegmentWeightVector::block_type>(
@@ -505,7 +544,8 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
             memory_block, storage::DataLayout::DATASOURCES_NAMES);
     }
 
-    void InitializeIntersectionClassPointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeIntersectionClassPointers(storage::DataLayout &data_layout,
+                                             const storage::DataLayout::Memory &memory_block)
     {
         auto bearing_class_id_ptr = data_layout.GetBlockPtr<BearingClassID>(
             memory_block, storage::DataLayout::BEARING_CLASSID);
@@ -517,20 +557,13 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         util::vector_view<DiscreteBearing> bearing_values(
             bearing_values_ptr, data_layout.num_entries[storage::DataLayout::BEARING_VALUES]);
 
-        auto offsets_ptr =
-            data_layout.GetBlockPtr<unsigned>(memory_block, storage::DataLayout::BEARING_OFFSETS);
-        auto blocks_ptr =
-            data_layout.GetBlockPtr<IndexBlock>(memory_block, storage::DataLayout::BEARING_BLOCKS);
-        util::vector_view<unsigned> bearing_offsets(
+        auto offsets_ptr = data_layout.GetBlockPtr<std::uint32_t>(
+            memory_block, storage::DataLayout::BEARING_OFFSETS);
+        util::vector_view<std::uint32_t> bearing_offsets(
             offsets_ptr, data_layout.num_entries[storage::DataLayout::BEARING_OFFSETS]);
-        util::vector_view<IndexBlock> bearing_blocks(
-            blocks_ptr, data_layout.num_entries[storage::DataLayout::BEARING_BLOCKS]);
-
-        util::RangeTable<16, storage::Ownership::View> bearing_range_table(
-            bearing_offsets, bearing_blocks, static_cast<unsigned>(bearing_values.size()));
 
         intersection_bearings_view = extractor::IntersectionBearingsView{
-            std::move(bearing_values), std::move(bearing_class_id), std::move(bearing_range_table)};
+            std::move(bearing_values), std::move(bearing_class_id), std::move(bearing_offsets)};
 
         auto entry_class_ptr = data_layout.GetBlockPtr<util::guidance::EntryClass>(
             memory_block, storage::DataLayout::ENTRY_CLASS);
@@ -539,7 +572,8 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         m_entry_class_table = std::move(entry_class_table);
     }
 
-    void InitializeInternalPointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeInternalPointers(storage::DataLayout &data_layout,
+                                    const storage::DataLayout::Memory &memory_block)
     {
         InitializeChecksumPointer(data_layout, memory_block);
         InitializeNodeInformationPointers(data_layout, memory_block);
@@ -555,6 +589,10 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         InitializeIntersectionClassPointers(data_layout, memory_block);
     }
 
+  protected:
+    // classes the metric of the facade excludes, only set for MLD metrics that exclude classes
+    extractor::ClassData excluded_classes = 0;
+
   public:
     // allows switching between process_memory/shared_memory datafacade, based on the type of
     // allocator
@@ -575,63 +613,71 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         return m_osmnodeid_list[id];
     }
 
-    std::vector<NodeID> GetUncompressedForwardGeometry(const EdgeID id) const override final
+    void PrefetchCoordinateOfNode(const NodeID id) const override final
+    {
+        util::prefetch(&m_coordinate_list[id]);
+    }
+
+    void PrefetchNodeData(const NodeID id) const override final
     {
+        edge_based_node_data.Prefetch(id);
+    }
+
+    void PrefetchGeometry(const EdgeID id) const override final
+    {
+        util::prefetch(&m_geometry_begin_indices[id]);
+    }
 
-        auto range = segment_data.GetForwardGeometry(id);
-        return std::vector<NodeID>{range.begin(), range.end()};
+    void PrefetchTurnData(const EdgeID id) const override final
+    {
+        turn_data.Prefetch(id);
+        util::prefetch(&m_turn_weight_penalties[id]);
+        util::prefetch(&m_turn_duration_penalties[id]);
+    }
+
+    NodeForwardRange GetUncompressedForwardGeometry(const EdgeID id) const override final
+    {
+        return m_geometry_nodes.GetRange(m_geometry_begin_indices[id],
+                                         m_geometry_begin_indices[id + 1]);
     }
 
-    virtual std::vector<NodeID> GetUncompressedReverseGeometry(const EdgeID id) const override final
+    NodeReverseRange GetUncompressedReverseGeometry(const EdgeID id) const override final
     {
-        auto range = segment_data.GetReverseGeometry(id);
-        return std::vector<NodeID>{range.begin(), range.end()};
+        return NodeReverseRange(GetUncompressedForwardGeometry(id));
     }
 
-    virtual std::vector<EdgeWeight>
-    GetUncompressedForwardDurations(const EdgeID id) const override final
+    DurationForwardRange GetUncompressedForwardDurations(const EdgeID id) const override final
     {
-        auto range = segment_data.GetForwardDurations(id);
-        return std::vector<EdgeWeight>{range.begin(), range.end()};
+        return segment_data.GetForwardDurations(id);
     }
 
-    virtual std::vector<EdgeWeight>
-    GetUncompressedReverseDurations(const EdgeID id) const override final
+    DurationReverseRange GetUncompressedReverseDurations(const EdgeID id) const override final
     {
-        auto range = segment_data.GetReverseDurations(id);
-        return std::vector<EdgeWeight>{range.begin(), range.end()};
+        return segment_data.GetReverseDurations(id);
     }
 
-    virtual std::vector<EdgeWeight>
-    GetUncompressedForwardWeights(const EdgeID id) const override final
+    WeightForwardRange GetUncompressedForwardWeights(const EdgeID id) const override final
     {
-        auto range = segment_data.GetForwardWeights(id);
-        return std::vector<EdgeWeight>{range.begin(), range.end()};
+        return segment_data.GetForwardWeights(id);
     }
 
-    virtual std::vector<EdgeWeight>
-    GetUncompressedReverseWeights(const EdgeID id) const override final
+    WeightReverseRange GetUncompressedReverseWeights(const EdgeID id) const override final
     {
-        auto range = segment_data.GetReverseWeights(id);
-        return std::vector<EdgeWeight>{range.begin(), range.end()};
+        return segment_data.GetReverseWeights(id);
     }
 
     // Returns the data source ids that were used to supply the edge
     // weights.
-    virtual std::vector<DatasourceID>
-    GetUncompressedForwardDatasources(const EdgeID id) const override final
+    DatasourceForwardRange GetUncompressedForwardDatasources(const EdgeID id) const override final
     {
-        auto range = segment_data.GetForwardDatasources(id);
-        return std::vector<DatasourceID>{range.begin(), range.end()};
+        return segment_data.GetForwardDatasources(id);
     }
 
     // Returns the data source ids that were used to supply the edge
     // weights.
-    virtual std::vector<DatasourceID>
-    GetUncompressedReverseDatasources(const EdgeID id) const override final
+    DatasourceReverseRange GetUncompressedReverseDatasources(const EdgeID id) const override final
     {
-        auto range = segment_data.GetReverseDatasources(id);
-        return std::vector<DatasourceID>{range.begin(), range.end()};
+        return segment_data.GetReverseDatasources(id);
     }
 
     virtual TurnPenalty GetWeightPenaltyForEdgeID(const unsigned id) const override final
@@ -661,79 +707,87 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         return m_geospatial_query->Search(bbox);
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate input_coordinate,
-                               const float max_distance,
-                               const Approach approach) const override final
+    std::vector<SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate input_coordinate,
+                             const float max_distance,
+                             const Approach approach) const override final
     {
         BOOST_ASSERT(m_geospatial_query.get());
 
-        return m_geospatial_query->NearestPhantomNodesInRange(
+        return m_geospatial_query->NearestCandidatesInRange(
             input_coordinate, max_distance, approach);
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate input_coordinate,
-                               const float max_distance,
-                               const int bearing,
-                               const int bearing_range,
-                               const Approach approach) const override final
+    std::vector<SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate input_coordinate,
+                             const float max_distance,
+                             const int bearing,
+                             const int bearing_range,
+                             const Approach approach) const override final
     {
         BOOST_ASSERT(m_geospatial_query.get());
 
-        return m_geospatial_query->NearestPhantomNodesInRange(
+        return m_geospatial_query->NearestCandidatesInRange(
             input_coordinate, max_distance, bearing, bearing_range, approach);
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const Approach approach) const override final
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const Approach approach) const override final
     {
         BOOST_ASSERT(m_geospatial_query.get());
 
-        return m_geospatial_query->NearestPhantomNodes(input_coordinate, max_results, approach);
+        return m_geospatial_query->NearestCandidates(input_coordinate, max_results, approach);
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const double max_distance,
-                        const Approach approach) const override final
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const double max_distance,
+                      const Approach approach) const override final
     {
         BOOST_ASSERT(m_geospatial_query.get());
 
-        return m_geospatial_query->NearestPhantomNodes(
+        return m_geospatial_query->NearestCandidates(
             input_coordinate, max_results, max_distance, approach);
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const int bearing,
-                        const int bearing_range,
-                        const Approach approach) const override final
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const int bearing,
+                      const int bearing_range,
+                      const Approach approach) const override final
     {
         BOOST_ASSERT(m_geospatial_query.get());
 
-        return m_geospatial_query->NearestPhantomNodes(
+        return m_geospatial_query->NearestCandidates(
             input_coordinate, max_results, bearing, bearing_range, approach);
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const double max_distance,
-                        const int bearing,
-                        const int bearing_range,
-                        const Approach approach) const override final
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const double max_distance,
+                      const int bearing,
+                      const int bearing_range,
+                      const Approach approach) const override final
     {
         BOOST_ASSERT(m_geospatial_query.get());
 
-        return m_geospatial_query->NearestPhantomNodes(
+        return m_geospatial_query->NearestCandidates(
             input_coordinate, max_results, max_distance, bearing, bearing_range, approach);
     }
 
+    PhantomNodeWithDistance MakePhantomNode(const util::Coordinate input_coordinate,
+                                            const SegmentCandidate &candidate) const override final
+    {
+        BOOST_ASSERT(m_geospatial_query.get());
+
+        return m_geospatial_query->MakePhantomNode(input_coordinate, candidate);
+    }
+
     std::pair<PhantomNode, PhantomNode>
     NearestPhantomNodeWithAlternativeFromBigComponent(const util::Coordinate input_coordinate,
                                                       const Approach approach) const override final
@@ -792,6 +846,16 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         return edge_based_node_data.GetComponentID(id);
     }
 
+    std::size_t GetNumberOfEdgeBasedNodes() const override final
+    {
+        return edge_based_node_data.Size();
+    }
+
+    std::size_t GetNumberOfGeometrySegments(const EdgeID id) const override final
+    {
+        return segment_data.GetNumberOfSegments(id);
+    }
+
     extractor::TravelMode GetTravelMode(const NodeID id) const override final
     {
         return edge_based_node_data.GetTravelMode(id);
@@ -813,6 +877,48 @@ class ContiguousInternalMemoryDataFacadeBase : public BaseDataFacade
         return classes;
     }
 
+    extractor::ClassData GetExcludedClasses() const override final { return excluded_classes; }
+
+    // The combinations of classes the profile can exclude, see ProfileProperties
+    std::vector<extractor::ClassData> GetExcludableClasses() const
+    {
+        return m_profile_properties->GetExcludableClasses();
+    }
+
+    // Metrics osrm-customize added for the time slots of speed profiles
+    std::size_t GetNumberOfTimeSlots() const { return m_profile_properties->num_time_slots; }
+
+    // The index of the combination of the classes in GetExcludableClasses, boost::none if a class
+    // is unknown or the profile can not exclude these classes together
+    boost::optional<std::size_t> GetExcludableIndex(const std::vector<std::string> &classes) const
+    {
+        extractor::ClassData mask = 0;
+        for (const auto &name : classes)
+        {
+            bool known = false;
+            for (std::size_t index = 0; index <= extractor::MAX_CLASS_INDEX && !known; ++index)
+            {
+                if (m_profile_properties->GetClassName(index) == name)
+                {
+                    mask |= 1u << index;
+                    known = true;
+                }
+            }
+            if (!known)
+            {
+                return boost::none;
+            }
+        }
+
+        const auto excludable = GetExcludableClasses();
+        const auto iter = std::find(excludable.begin(), excludable.end(), mask);
+        if (iter == excludable.end())
+        {
+            return boost::none;
+        }
+        return static_cast<std::size_t>(std::distance(excludable.begin(), iter));
+    }
+
     NameID GetNameIndex(const NodeID id) const override final
     {
         return edge_based_node_data.GetNameID(id);
@@ -948,6 +1054,17 @@ class ContiguousInternalMemoryDataFacade<CoreCH> final
     }
 };
 
+// The arcs of a customizable contraction hierarchy are stored as the edges of a CH
+template <>
+class ContiguousInternalMemoryDataFacade<CCH> final : public ContiguousInternalMemoryDataFacade<CH>
+{
+  public:
+    ContiguousInternalMemoryDataFacade(std::shared_ptr<ContiguousBlockAllocator> allocator)
+        : ContiguousInternalMemoryDataFacade<CH>(allocator)
+    {
+    }
+};
+
 template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public AlgorithmDataFacade<MLD>
 {
     // MLD data
@@ -958,14 +1075,36 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
     using GraphEdge = QueryGraph::EdgeArrayEntry;
 
     QueryGraph query_graph;
+    util::vector_view<const util::SearchEdge> search_edges;
+    std::size_t num_metrics = 1;
+
+    util::vector_view<const extractor::ConditionalTurnMask> conditional_turn_masks;
+    customizer::LandmarksView landmarks;
 
-    void InitializeInternalPointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeInternalPointers(storage::DataLayout &data_layout,
+                                    const storage::DataLayout::Memory &memory_block,
+                                    const std::size_t metric)
     {
         InitializeMLDDataPointers(data_layout, memory_block);
-        InitializeGraphPointer(data_layout, memory_block);
+        InitializeGraphPointer(data_layout, memory_block, metric);
+        InitializeConditionalTurnMasksPointer(data_layout, memory_block);
+        InitializeLandmarksPointer(data_layout, memory_block);
+
+        if (data_layout.GetBlockSize(storage::DataLayout::MLD_CELL_WEIGHTS) > 0)
+        {
+            if (mld_cell_storage.GetNumberOfMetrics() != num_metrics)
+            {
+                throw util::exception("The cells hold " +
+                                      std::to_string(mld_cell_storage.GetNumberOfMetrics()) +
+                                      " metrics but the graph " + std::to_string(num_metrics) +
+                                      ", run osrm-customize again" + SOURCE_REF);
+            }
+            mld_cell_storage.SelectMetric(metric);
+        }
     }
 
-    void InitializeMLDDataPointers(storage::DataLayout &data_layout, char *memory_block)
+    void InitializeMLDDataPointers(storage::DataLayout &data_layout,
+                                   const storage::DataLayout::Memory &memory_block)
     {
         if (data_layout.GetBlockSize(storage::DataLayout::MLD_PARTITION) > 0)
         {
@@ -1001,6 +1140,8 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
                 memory_block, storage::DataLayout::MLD_CELL_WEIGHTS);
             auto mld_cell_durations_ptr = data_layout.GetBlockPtr<EdgeDuration>(
                 memory_block, storage::DataLayout::MLD_CELL_DURATIONS);
+            auto mld_cell_distances_ptr = data_layout.GetBlockPtr<EdgeDistance>(
+                memory_block, storage::DataLayout::MLD_CELL_DISTANCES);
             auto mld_source_boundary_ptr = data_layout.GetBlockPtr<NodeID>(
                 memory_block, storage::DataLayout::MLD_CELL_SOURCE_BOUNDARY);
             auto mld_destination_boundary_ptr = data_layout.GetBlockPtr<NodeID>(
@@ -1014,6 +1155,8 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
                 data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_WEIGHTS);
             auto duration_entries_count =
                 data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_DURATIONS);
+            auto distance_entries_count =
+                data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_DISTANCES);
             auto source_boundary_entries_count =
                 data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_SOURCE_BOUNDARY);
             auto destination_boundary_entries_count =
@@ -1023,10 +1166,16 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
                 data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_LEVEL_OFFSETS);
 
             BOOST_ASSERT(weight_entries_count == duration_entries_count);
+            // distances are never quantized
+            BOOST_ASSERT(weight_entries_count == distance_entries_count ||
+                         data_layout.GetBlockEntries(
+                             storage::DataLayout::MLD_CELL_WEIGHT_CODES) > 0);
 
             util::vector_view<EdgeWeight> weights(mld_cell_weights_ptr, weight_entries_count);
             util::vector_view<EdgeDuration> durations(mld_cell_durations_ptr,
                                                       duration_entries_count);
+            util::vector_view<EdgeDistance> distances(mld_cell_distances_ptr,
+                                                      distance_entries_count);
             util::vector_view<NodeID> source_boundary(mld_source_boundary_ptr,
                                                       source_boundary_entries_count);
             util::vector_view<NodeID> destination_boundary(mld_destination_boundary_ptr,
@@ -1036,15 +1185,41 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
             util::vector_view<std::uint64_t> level_offsets(mld_cell_level_offsets_ptr,
                                                            cell_level_offsets_entries_count);
 
+            // empty unless osrm-customize quantized the upper levels
+            util::vector_view<partition::quantization::Code> weight_codes(
+                data_layout.GetBlockPtr<partition::quantization::Code>(
+                    memory_block, storage::DataLayout::MLD_CELL_WEIGHT_CODES),
+                data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_WEIGHT_CODES));
+            util::vector_view<partition::quantization::Code> duration_codes(
+                data_layout.GetBlockPtr<partition::quantization::Code>(
+                    memory_block, storage::DataLayout::MLD_CELL_DURATION_CODES),
+                data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_DURATION_CODES));
+            util::vector_view<partition::quantization::QuantizedRow> quantized_rows(
+                data_layout.GetBlockPtr<partition::quantization::QuantizedRow>(
+                    memory_block, storage::DataLayout::MLD_CELL_QUANTIZED_ROWS),
+                data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_QUANTIZED_ROWS));
+            util::vector_view<EdgeWeight> quantized_exceptions(
+                data_layout.GetBlockPtr<EdgeWeight>(
+                    memory_block, storage::DataLayout::MLD_CELL_QUANTIZED_EXCEPTIONS),
+                data_layout.GetBlockEntries(storage::DataLayout::MLD_CELL_QUANTIZED_EXCEPTIONS));
+
             mld_cell_storage = partition::CellStorageView{std::move(weights),
                                                           std::move(durations),
+                                                          std::move(distances),
                                                           std::move(source_boundary),
                                                           std::move(destination_boundary),
                                                           std::move(cells),
-                                                          std::move(level_offsets)};
+                                                          std::move(level_offsets),
+                                                          std::move(weight_codes),
+                                                          std::move(duration_codes),
+                                                          std::move(quantized_rows),
+                                                          std::move(quantized_exceptions)};
         }
     }
-    void InitializeGraphPointer(storage::DataLayout &data_layout, char *memory_block)
+    // The edge list holds the edges of one metric after another, see MultiLevelGraph
+    void InitializeGraphPointer(storage::DataLayout &data_layout,
+                                const storage::DataLayout::Memory &memory_block,
+                                const std::size_t metric)
     {
         auto graph_nodes_ptr = data_layout.GetBlockPtr<GraphNode>(
             memory_block, storage::DataLayout::MLD_GRAPH_NODE_LIST);
@@ -1057,33 +1232,93 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
 
         util::vector_view<GraphNode> node_list(
             graph_nodes_ptr, data_layout.num_entries[storage::DataLayout::MLD_GRAPH_NODE_LIST]);
+
+        const auto num_entries = data_layout.num_entries[storage::DataLayout::MLD_GRAPH_EDGE_LIST];
+        const std::size_t num_edges = node_list.empty() ? 0 : node_list.back().first_edge;
+        num_metrics = num_edges == 0 ? 1 : num_entries / num_edges;
+        if (metric >= num_metrics)
+        {
+            throw util::exception("The graph has no metric " + std::to_string(metric) +
+                                  SOURCE_REF);
+        }
         util::vector_view<GraphEdge> edge_list(
-            graph_edges_ptr, data_layout.num_entries[storage::DataLayout::MLD_GRAPH_EDGE_LIST]);
+            num_edges == 0 ? graph_edges_ptr : graph_edges_ptr + metric * num_edges,
+            num_edges == 0 ? num_entries : num_edges);
         util::vector_view<QueryGraph::EdgeOffset> node_to_offset(
             graph_node_to_offset_ptr,
             data_layout.num_entries[storage::DataLayout::MLD_GRAPH_NODE_TO_OFFSET]);
 
         query_graph =
             QueryGraph(std::move(node_list), std::move(edge_list), std::move(node_to_offset));
+
+        // the search edges have the same layers as the edge list
+        auto search_edges_ptr = data_layout.GetBlockPtr<util::SearchEdge>(
+            memory_block, storage::DataLayout::MLD_GRAPH_SEARCH_EDGE_LIST);
+        search_edges = util::vector_view<const util::SearchEdge>(
+            num_edges == 0 ? search_edges_ptr : search_edges_ptr + metric * num_edges,
+            num_edges == 0 ? num_entries : num_edges);
+    }
+
+    void InitializeConditionalTurnMasksPointer(storage::DataLayout &data_layout,
+                                               const storage::DataLayout::Memory &memory_block)
+    {
+        auto masks_ptr = data_layout.GetBlockPtr<extractor::ConditionalTurnMask>(
+            memory_block, storage::DataLayout::CONDITIONAL_TURN_MASKS);
+        conditional_turn_masks = util::vector_view<const extractor::ConditionalTurnMask>(
+            masks_ptr, data_layout.num_entries[storage::DataLayout::CONDITIONAL_TURN_MASKS]);
+    }
+
+    // The landmarks hold the weights of all nodes of the graph, one pair per landmark
+    void InitializeLandmarksPointer(storage::DataLayout &data_layout,
+                                    const storage::DataLayout::Memory &memory_block)
+    {
+        const auto num_entries = data_layout.num_entries[storage::DataLayout::MLD_LANDMARKS];
+        const std::size_t num_nodes = query_graph.GetNumberOfNodes();
+        if (num_entries == 0 || num_nodes == 0)
+        {
+            return;
+        }
+        if (num_entries % (2 * num_nodes) != 0)
+        {
+            throw util::exception("The landmarks don't match the graph, run osrm-customize again" +
+                                  SOURCE_REF);
+        }
+
+        auto weights_ptr = data_layout.GetBlockPtr<customizer::LandmarksView::Weight>(
+            memory_block, storage::DataLayout::MLD_LANDMARKS);
+        landmarks = customizer::LandmarksView(
+            num_entries / (2 * num_nodes),
+            util::vector_view<customizer::LandmarksView::Weight>(weights_ptr, num_entries));
     }
 
     // allocator that keeps the allocation data
     std::shared_ptr<ContiguousBlockAllocator> allocator;
 
+  protected:
+    // The landmarks bound the weights of metric 0, other metrics that can be faster must not use
+    // them
+    void DisableLandmarks() { landmarks = customizer::LandmarksView{}; }
+
   public:
     ContiguousInternalMemoryAlgorithmDataFacade(
-        std::shared_ptr<ContiguousBlockAllocator> allocator_)
+        std::shared_ptr<ContiguousBlockAllocator> allocator_, const std::size_t metric)
         : allocator(std::move(allocator_))
     {
-        InitializeInternalPointers(allocator->GetLayout(), allocator->GetMemory());
+        InitializeInternalPointers(allocator->GetLayout(), allocator->GetMemory(), metric);
     }
 
-    const partition::MultiLevelPartitionView &GetMultiLevelPartition() const override
+    // Metrics of the cells and the graph, this facade uses one of them
+    std::size_t GetNumberOfMetrics() const { return num_metrics; }
+
+    const partition::MultiLevelPartitionView &GetMultiLevelPartition() const override final
     {
         return mld_partition;
     }
 
-    const partition::CellStorageView &GetCellStorage() const override { return mld_cell_storage; }
+    const partition::CellStorageView &GetCellStorage() const override final
+    {
+        return mld_cell_storage;
+    }
 
     // search graph access
     unsigned GetNumberOfNodes() const override final { return query_graph.GetNumberOfNodes(); }
@@ -1102,6 +1337,11 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
         return query_graph.GetEdgeData(e);
     }
 
+    const util::SearchEdge &GetSearchEdge(const EdgeID e) const override final
+    {
+        return search_edges[e];
+    }
+
     EdgeID BeginEdges(const NodeID n) const override final { return query_graph.BeginEdges(n); }
 
     EdgeID EndEdges(const NodeID n) const override final { return query_graph.EndEdges(n); }
@@ -1111,6 +1351,8 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
         return query_graph.GetAdjacentEdgeRange(node);
     }
 
+    void PrefetchNode(const NodeID node) const override final { query_graph.PrefetchNode(node); }
+
     EdgeRange GetBorderEdgeRange(const LevelID level, const NodeID node) const override final
     {
         return query_graph.GetBorderEdgeRange(level, node);
@@ -1121,6 +1363,14 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
     {
         return query_graph.FindEdge(from, to);
     }
+
+    util::vector_view<const extractor::ConditionalTurnMask>
+    GetConditionalTurnMasks() const override final
+    {
+        return conditional_turn_masks;
+    }
+
+    const customizer::LandmarksView &GetLandmarks() const override final { return landmarks; }
 };
 
 template <>
@@ -1130,13 +1380,87 @@ class ContiguousInternalMemoryDataFacade<MLD> final
 {
   private:
   public:
-    ContiguousInternalMemoryDataFacade(std::shared_ptr<ContiguousBlockAllocator> allocator)
+    ContiguousInternalMemoryDataFacade(std::shared_ptr<ContiguousBlockAllocator> allocator,
+                                       const std::size_t metric = 0)
         : ContiguousInternalMemoryDataFacadeBase(allocator),
-          ContiguousInternalMemoryAlgorithmDataFacade<MLD>(allocator)
+          ContiguousInternalMemoryAlgorithmDataFacade<MLD>(allocator, metric)
+
+    {
+        const auto first_exclude_metric = GetFirstExcludeMetric();
+        if (first_exclude_metric && metric >= *first_exclude_metric)
+        {
+            excluded_classes = GetExcludableClasses()[metric - *first_exclude_metric];
+        }
+        // excluding classes only takes edges away, the other metrics can be faster than metric 0
+        else if (metric != 0)
+        {
+            DisableLandmarks();
+        }
+    }
+
+    // The metric that excludes the classes, boost::none if the data has none
+    boost::optional<std::size_t> GetExcludeMetric(const std::vector<std::string> &classes) const
+    {
+        const auto first_exclude_metric = GetFirstExcludeMetric();
+        const auto index = GetExcludableIndex(classes);
+        if (!first_exclude_metric || !index)
+        {
+            return boost::none;
+        }
+        return *first_exclude_metric + *index;
+    }
+
+    // The metric of the time slot the departure falls into, boost::none if the data has no
+    // speed profiles. The slots split the day from midnight UTC into equal parts.
+    boost::optional<std::size_t> GetTimeSlotMetric(const std::uint64_t departure_time) const
+    {
+        const std::uint64_t SECONDS_PER_DAY = 24 * 60 * 60;
+        const auto num_slots = GetNumberOfTimeSlots();
+        const auto num_excludable = GetFirstExcludeMetric() ? GetExcludableClasses().size() : 0;
+        if (num_slots == 0 || num_slots + num_excludable >= GetNumberOfMetrics())
+        {
+            return boost::none;
+        }
+        const auto first_slot_metric = GetNumberOfMetrics() - num_excludable - num_slots;
+        return first_slot_metric + departure_time % SECONDS_PER_DAY * num_slots / SECONDS_PER_DAY;
+    }
 
+  private:
+    // osrm-customize adds one metric per combination of excludable classes after all others,
+    // the metrics of the time slots are right before them
+    boost::optional<std::size_t> GetFirstExcludeMetric() const
     {
+        const auto num_excludable = GetExcludableClasses().size();
+        if (num_excludable == 0 || num_excludable >= GetNumberOfMetrics())
+        {
+            return boost::none;
+        }
+        return GetNumberOfMetrics() - num_excludable;
     }
 };
+
+// The facades of all metrics of the data, only MLD data can hold more than one metric
+template <typename FacadeT>
+std::vector<std::shared_ptr<const FacadeT>>
+makeMetricFacades(std::shared_ptr<ContiguousBlockAllocator> allocator)
+{
+    return {std::make_shared<const FacadeT>(std::move(allocator))};
+}
+
+template <>
+inline std::vector<std::shared_ptr<const ContiguousInternalMemoryDataFacade<MLD>>>
+makeMetricFacades<ContiguousInternalMemoryDataFacade<MLD>>(
+    std::shared_ptr<ContiguousBlockAllocator> allocator)
+{
+    using FacadeT = ContiguousInternalMemoryDataFacade<MLD>;
+    std::vector<std::shared_ptr<const FacadeT>> facades{
+        std::make_shared<const FacadeT>(allocator, 0)};
+    for (std::size_t metric = 1; metric < facades.front()->GetNumberOfMetrics(); ++metric)
+    {
+        facades.push_back(std::make_shared<const FacadeT>(allocator, metric));
+    }
+    return facades;
+}
 }
 }
 }
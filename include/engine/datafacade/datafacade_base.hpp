@@ -14,8 +14,10 @@
 #include "extractor/guidance/turn_lane_types.hpp"
 #include "extractor/original_edge_data.hpp"
 #include "extractor/query_node.hpp"
+#include "extractor/segment_data_container.hpp"
 #include "extractor/travel_mode.hpp"
 
+#include "util/delta_vector.hpp"
 #include "util/exception.hpp"
 #include "util/guidance/bearing_class.hpp"
 #include "util/guidance/entry_class.hpp"
@@ -47,6 +49,25 @@ class BaseDataFacade
 {
   public:
     using RTreeLeaf = extractor::EdgeBasedNodeSegment;
+
+    // Views of the compressed geometries in the segment data, the reverse ranges iterate the
+    // same storage backwards. Valid as long as the facade is. The nodes may be delta encoded and
+    // are decoded while iterating.
+    using NodeForwardRange = boost::iterator_range<util::DeltaVectorView<NodeID>::const_iterator>;
+    using NodeReverseRange = boost::reversed_range<const NodeForwardRange>;
+
+    using WeightForwardRange =
+        boost::iterator_range<extractor::SegmentDataView::SegmentWeightVector::const_iterator>;
+    using WeightReverseRange = boost::reversed_range<const WeightForwardRange>;
+
+    using DurationForwardRange =
+        boost::iterator_range<extractor::SegmentDataView::SegmentDurationVector::const_iterator>;
+    using DurationReverseRange = boost::reversed_range<const DurationForwardRange>;
+
+    using DatasourceForwardRange =
+        boost::iterator_range<extractor::SegmentDataView::SegmentDatasourceVector::const_iterator>;
+    using DatasourceReverseRange = boost::reversed_range<const DatasourceForwardRange>;
+
     BaseDataFacade() {}
     virtual ~BaseDataFacade() {}
 
@@ -59,30 +80,43 @@ class BaseDataFacade
 
     virtual GeometryID GetGeometryIndex(const NodeID id) const = 0;
 
+    // number of edge-based nodes, all segment ids of phantom nodes are below it
+    virtual std::size_t GetNumberOfEdgeBasedNodes() const = 0;
+
+    // number of segments of the geometry, the valid values of a fwd_segment_position
+    virtual std::size_t GetNumberOfGeometrySegments(const EdgeID id) const = 0;
+
     virtual ComponentID GetComponentID(const NodeID id) const = 0;
 
-    virtual std::vector<NodeID> GetUncompressedForwardGeometry(const EdgeID id) const = 0;
+    virtual NodeForwardRange GetUncompressedForwardGeometry(const EdgeID id) const = 0;
 
-    virtual std::vector<NodeID> GetUncompressedReverseGeometry(const EdgeID id) const = 0;
+    virtual NodeReverseRange GetUncompressedReverseGeometry(const EdgeID id) const = 0;
 
     virtual TurnPenalty GetWeightPenaltyForEdgeID(const unsigned id) const = 0;
 
+    // hints that the coordinate of the node, the data of the edge-based node, the start of the
+    // geometry or the data of the turn are looked up soon, see util/prefetch.hpp
+    virtual void PrefetchCoordinateOfNode(const NodeID /*id*/) const {}
+    virtual void PrefetchNodeData(const NodeID /*id*/) const {}
+    virtual void PrefetchGeometry(const EdgeID /*id*/) const {}
+    virtual void PrefetchTurnData(const EdgeID /*id*/) const {}
+
     virtual TurnPenalty GetDurationPenaltyForEdgeID(const unsigned id) const = 0;
 
     // Gets the weight values for each segment in an uncompressed geometry.
     // Should always be 1 shorter than GetUncompressedGeometry
-    virtual std::vector<EdgeWeight> GetUncompressedForwardWeights(const EdgeID id) const = 0;
-    virtual std::vector<EdgeWeight> GetUncompressedReverseWeights(const EdgeID id) const = 0;
+    virtual WeightForwardRange GetUncompressedForwardWeights(const EdgeID id) const = 0;
+    virtual WeightReverseRange GetUncompressedReverseWeights(const EdgeID id) const = 0;
 
     // Gets the duration values for each segment in an uncompressed geometry.
     // Should always be 1 shorter than GetUncompressedGeometry
-    virtual std::vector<EdgeWeight> GetUncompressedForwardDurations(const EdgeID id) const = 0;
-    virtual std::vector<EdgeWeight> GetUncompressedReverseDurations(const EdgeID id) const = 0;
+    virtual DurationForwardRange GetUncompressedForwardDurations(const EdgeID id) const = 0;
+    virtual DurationReverseRange GetUncompressedReverseDurations(const EdgeID id) const = 0;
 
     // Returns the data source ids that were used to supply the edge
     // weights.  Will return an empty array when only the base profile is used.
-    virtual std::vector<DatasourceID> GetUncompressedForwardDatasources(const EdgeID id) const = 0;
-    virtual std::vector<DatasourceID> GetUncompressedReverseDatasources(const EdgeID id) const = 0;
+    virtual DatasourceForwardRange GetUncompressedForwardDatasources(const EdgeID id) const = 0;
+    virtual DatasourceReverseRange GetUncompressedReverseDatasources(const EdgeID id) const = 0;
 
     // Gets the name of a datasource
     virtual StringView GetDatasourceName(const DatasourceID id) const = 0;
@@ -96,42 +130,49 @@ class BaseDataFacade
 
     virtual std::vector<std::string> GetClasses(const extractor::ClassData class_data) const = 0;
 
+    // Classes excluded by the metric of the facade, they are neither routed on nor snapped to
+    virtual extractor::ClassData GetExcludedClasses() const = 0;
+
     virtual std::vector<RTreeLeaf> GetEdgesInBox(const util::Coordinate south_west,
                                                  const util::Coordinate north_east) const = 0;
 
-    virtual std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate input_coordinate,
-                               const float max_distance,
-                               const int bearing,
-                               const int bearing_range,
-                               const Approach approach) const = 0;
-    virtual std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate input_coordinate,
-                               const float max_distance,
-                               const Approach approach) const = 0;
-
-    virtual std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const double max_distance,
-                        const int bearing,
-                        const int bearing_range,
-                        const Approach approach) const = 0;
-    virtual std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const int bearing,
-                        const int bearing_range,
-                        const Approach approach) const = 0;
-    virtual std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const Approach approach) const = 0;
-    virtual std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const double max_distance,
-                        const Approach approach) const = 0;
+    virtual std::vector<SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate input_coordinate,
+                             const float max_distance,
+                             const int bearing,
+                             const int bearing_range,
+                             const Approach approach) const = 0;
+    virtual std::vector<SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate input_coordinate,
+                             const float max_distance,
+                             const Approach approach) const = 0;
+
+    virtual std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const double max_distance,
+                      const int bearing,
+                      const int bearing_range,
+                      const Approach approach) const = 0;
+    virtual std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const int bearing,
+                      const int bearing_range,
+                      const Approach approach) const = 0;
+    virtual std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const Approach approach) const = 0;
+    virtual std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const double max_distance,
+                      const Approach approach) const = 0;
+
+    // Builds the PhantomNode of a candidate of NearestCandidates or NearestCandidatesInRange
+    virtual PhantomNodeWithDistance MakePhantomNode(const util::Coordinate input_coordinate,
+                                                    const SegmentCandidate &candidate) const = 0;
 
     virtual std::pair<PhantomNode, PhantomNode>
     NearestPhantomNodeWithAlternativeFromBigComponent(const util::Coordinate input_coordinate,
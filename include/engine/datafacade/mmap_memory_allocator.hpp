@@ -0,0 +1,50 @@
+#ifndef OSRM_ENGINE_DATAFACADE_MMAP_MEMORY_ALLOCATOR_HPP_
+#define OSRM_ENGINE_DATAFACADE_MMAP_MEMORY_ALLOCATOR_HPP_
+
+#include "engine/datafacade/contiguous_block_allocator.hpp"
+#include "engine/engine_config.hpp"
+#include "storage/storage_config.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <map>
+#include <string>
+
+namespace osrm
+{
+namespace engine
+{
+namespace datafacade
+{
+
+/**
+ * This allocator maps a file that holds the data in the same layout as
+ * the shared memory, read-only, so the data is paged in on demand and
+ * shared with every other process mapping the file.
+ * The file is written from the .osrm files first if it is missing or older
+ * than one of them.
+ */
+class MMapMemoryAllocator : public ContiguousBlockAllocator
+{
+  public:
+    MMapMemoryAllocator(const storage::StorageConfig &config,
+                        const boost::filesystem::path &memory_file,
+                        const std::map<std::string, EngineConfig::MemoryAdvice> &memory_advice);
+    ~MMapMemoryAllocator() override final;
+
+    // interface to give access to the datafacades
+    storage::DataLayout &GetLayout() override final;
+    storage::DataLayout::Memory GetMemory() override final;
+
+  private:
+    boost::iostreams::mapped_file_source mapped_memory;
+    storage::DataLayout layout;
+    char *memory;
+};
+
+} // namespace datafacade
+} // namespace engine
+} // namespace osrm
+
+#endif // OSRM_ENGINE_DATAFACADE_MMAP_MEMORY_ALLOCATOR_HPP_
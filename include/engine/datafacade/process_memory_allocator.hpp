@@ -3,6 +3,8 @@
 
 #include "storage/storage_config.hpp"
 #include "engine/datafacade/contiguous_block_allocator.hpp"
+#include "engine/engine_config.hpp"
+#include "util/huge_pages.hpp"
 
 #include <memory>
 
@@ -19,19 +21,26 @@ namespace datafacade
  * shared memory.
  * This class holds a unique_ptr to the memory block, so it
  * is auto-freed upon destruction.
+ * With use_huge_pages the block is backed by huge pages where the
+ * system provides them. With NUMAPlacement::Interleave its pages are
+ * spread over all NUMA nodes, with NUMAPlacement::Replicate they are
+ * allocated on numa_node.
  */
 class ProcessMemoryAllocator : public ContiguousBlockAllocator
 {
   public:
-    explicit ProcessMemoryAllocator(const storage::StorageConfig &config);
+    ProcessMemoryAllocator(const storage::StorageConfig &config,
+                           const bool use_huge_pages,
+                           const EngineConfig::NUMAPlacement numa_placement,
+                           const unsigned numa_node = 0);
     ~ProcessMemoryAllocator() override final;
 
     // interface to give access to the datafacades
     storage::DataLayout &GetLayout() override final;
-    char *GetMemory() override final;
+    storage::DataLayout::Memory GetMemory() override final;
 
   private:
-    std::unique_ptr<char[]> internal_memory;
+    std::unique_ptr<util::ProcessMemory> internal_memory;
     std::unique_ptr<storage::DataLayout> internal_layout;
 };
 
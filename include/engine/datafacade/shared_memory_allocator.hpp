@@ -16,22 +16,31 @@ namespace datafacade
 {
 
 /**
-* This allocator uses an IPC shared memory block as the data location.
+* This allocator uses IPC shared memory blocks as the data location, one for
+* the static and one for the metric part of the layout.
 * Many SharedMemoryDataFacade objects can be created that point to the same shared
-* memory block.
+* memory blocks.
 */
 class SharedMemoryAllocator : public ContiguousBlockAllocator
 {
   public:
-    explicit SharedMemoryAllocator(storage::SharedDataType data_region);
+    SharedMemoryAllocator(storage::SharedDataType static_region,
+                          storage::SharedDataType metric_region);
     ~SharedMemoryAllocator() override final;
 
     // interface to give access to the datafacades
     storage::DataLayout &GetLayout() override final;
-    char *GetMemory() override final;
+    storage::DataLayout::Memory GetMemory() override final;
+
+    // faults in the pages of both regions, which stay mapped as long as the allocator lives
+    void Prefault() const;
 
   private:
-    std::unique_ptr<storage::SharedMemory> m_large_memory;
+    std::unique_ptr<storage::SharedMemory> m_static_memory;
+    std::unique_ptr<storage::SharedMemory> m_metric_memory;
+    // sizes of the static blocks from the static region, of the metric blocks from the metric
+    // region, which may have been loaded later
+    storage::DataLayout m_layout;
 };
 
 } // namespace datafacade
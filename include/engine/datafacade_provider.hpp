@@ -4,7 +4,19 @@
 #include "engine/data_watchdog.hpp"
 #include "engine/datafacade.hpp"
 #include "engine/datafacade/contiguous_internalmem_datafacade.hpp"
+#include "engine/datafacade/contiguous_block_allocator.hpp"
 #include "engine/datafacade/process_memory_allocator.hpp"
+#include "engine/engine_statistics.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/numa.hpp"
+
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
@@ -20,7 +32,10 @@ template <typename AlgorithmT, template <typename A> class FacadeT> class DataFa
 
     virtual ~DataFacadeProvider() = default;
 
-    virtual std::shared_ptr<const Facade> Get() const = 0;
+    // The facade of a metric of the data, nullptr if the data has no such metric
+    virtual std::shared_ptr<const Facade> Get(const std::size_t metric) const = 0;
+
+    virtual DataUpdateStatistics GetUpdateStatistics() const { return DataUpdateStatistics{}; }
 };
 
 template <typename AlgorithmT, template <typename A> class FacadeT>
@@ -29,16 +44,99 @@ class ImmutableProvider final : public DataFacadeProvider<AlgorithmT, FacadeT>
   public:
     using Facade = typename DataFacadeProvider<AlgorithmT, FacadeT>::Facade;
 
-    ImmutableProvider(const storage::StorageConfig &config)
-        : immutable_data_facade(std::make_shared<Facade>(
-              std::make_shared<datafacade::ProcessMemoryAllocator>(config)))
+    ImmutableProvider(std::shared_ptr<datafacade::ContiguousBlockAllocator> allocator)
+        : immutable_data_facades(datafacade::makeMetricFacades<Facade>(std::move(allocator)))
     {
     }
 
-    std::shared_ptr<const Facade> Get() const override final { return immutable_data_facade; }
+    std::shared_ptr<const Facade> Get(const std::size_t metric) const override final
+    {
+        return metric < immutable_data_facades.size() ? immutable_data_facades[metric] : nullptr;
+    }
 
   private:
-    std::shared_ptr<const Facade> immutable_data_facade;
+    std::vector<std::shared_ptr<const Facade>> immutable_data_facades;
+};
+
+// Loads a copy of the data on every NUMA node and hands out the copy of the node the calling
+// thread runs on
+template <typename AlgorithmT, template <typename A> class FacadeT>
+class ReplicatedProvider final : public DataFacadeProvider<AlgorithmT, FacadeT>
+{
+  public:
+    using Facade = typename DataFacadeProvider<AlgorithmT, FacadeT>::Facade;
+
+    ReplicatedProvider(const storage::StorageConfig &config,
+                       const bool use_huge_pages,
+                       const bool lock_memory)
+    {
+        const auto nodes = util::numa::getNodes();
+        replicas.resize(nodes.size());
+
+        // Every copy is loaded by a thread on its node and its pages are bound there
+        std::vector<std::exception_ptr> errors(nodes.size());
+        std::vector<std::thread> loaders;
+        for (const auto index : util::irange<std::size_t>(0, nodes.size()))
+        {
+            loaders.emplace_back([&, index] {
+                try
+                {
+                    if (!util::numa::pinThreadToNode(nodes[index]))
+                    {
+                        util::Log(logWARNING) << "Could not load the data on NUMA node "
+                                              << nodes[index].id;
+                    }
+                    auto allocator = std::make_shared<datafacade::ProcessMemoryAllocator>(
+                        config,
+                        use_huge_pages,
+                        EngineConfig::NUMAPlacement::Replicate,
+                        nodes[index].id);
+                    if (lock_memory)
+                    {
+                        datafacade::lockBlocks(*allocator);
+                    }
+                    replicas[index] = datafacade::makeMetricFacades<Facade>(std::move(allocator));
+                }
+                catch (...)
+                {
+                    errors[index] = std::current_exception();
+                }
+            });
+        }
+        for (auto &loader : loaders)
+        {
+            loader.join();
+        }
+        for (const auto &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        for (const auto index : util::irange<std::size_t>(0, nodes.size()))
+        {
+            if (replica_of_node.size() <= nodes[index].id)
+            {
+                replica_of_node.resize(nodes[index].id + 1, 0);
+            }
+            replica_of_node[nodes[index].id] = index;
+        }
+        util::Log() << "Loaded a copy of the data on each of " << nodes.size() << " NUMA nodes";
+    }
+
+    std::shared_ptr<const Facade> Get(const std::size_t metric) const override final
+    {
+        const auto node = util::numa::getCurrentNode();
+        const auto &replica = replicas[node < replica_of_node.size() ? replica_of_node[node] : 0];
+        return metric < replica.size() ? replica[metric] : nullptr;
+    }
+
+  private:
+    // the facades of all metrics of each copy
+    std::vector<std::vector<std::shared_ptr<const Facade>>> replicas;
+    std::vector<std::size_t> replica_of_node;
 };
 
 template <typename AlgorithmT, template <typename A> class FacadeT>
@@ -49,7 +147,15 @@ class WatchingProvider : public DataFacadeProvider<AlgorithmT, FacadeT>
   public:
     using Facade = typename DataFacadeProvider<AlgorithmT, FacadeT>::Facade;
 
-    std::shared_ptr<const Facade> Get() const override final { return watchdog.Get(); }
+    std::shared_ptr<const Facade> Get(const std::size_t metric) const override final
+    {
+        return watchdog.Get(metric);
+    }
+
+    DataUpdateStatistics GetUpdateStatistics() const override final
+    {
+        return watchdog.GetStatistics();
+    }
 };
 }
 
@@ -59,6 +165,8 @@ template <typename AlgorithmT>
 using WatchingProvider = detail::WatchingProvider<AlgorithmT, DataFacade>;
 template <typename AlgorithmT>
 using ImmutableProvider = detail::ImmutableProvider<AlgorithmT, DataFacade>;
+template <typename AlgorithmT>
+using ReplicatedProvider = detail::ReplicatedProvider<AlgorithmT, DataFacade>;
 }
 }
 
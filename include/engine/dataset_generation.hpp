@@ -0,0 +1,52 @@
+#ifndef OSRM_ENGINE_DATASET_GENERATION_HPP
+#define OSRM_ENGINE_DATASET_GENERATION_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Numbers the datasets queries run on, for caches that outlive a query and must not mix results
+// of different datasets. Entries keyed with the generation of their dataset are never found by
+// queries on another one.
+//
+// A query on a dataset other than the last one seen, e.g. after the DataWatchdog switched to a new
+// shared memory region, starts a new generation. Queries still running on the old dataset insert
+// their results with the old generation.
+class DatasetGeneration
+{
+  public:
+    // dataset points to the facade of the query, on_change is called under the lock when a new
+    // generation starts
+    template <typename OnChange>
+    std::uint64_t Get(const std::shared_ptr<const void> &current_dataset, OnChange on_change)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // The DataWatchdog hands the facades out with a control block per thread, so the datasets
+        // are compared by their address. The weak pointer keeps a released dataset from being
+        // mistaken for a new one at the same address.
+        const auto same_dataset = address == current_dataset.get() && !dataset.expired();
+        if (!same_dataset)
+        {
+            dataset = current_dataset;
+            address = current_dataset.get();
+            ++generation;
+            on_change();
+        }
+        return generation;
+    }
+
+  private:
+    std::mutex mutex;
+    std::weak_ptr<const void> dataset;
+    const void *address = nullptr;
+    std::uint64_t generation = 0;
+};
+}
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef OSRM_ENGINE_DEADLINE_HPP
+#define OSRM_ENGINE_DEADLINE_HPP
+
+#include "util/exception.hpp"
+
+#include <boost/optional.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Thrown from inside the searches once a query ran past its deadline
+class DeadlineExceeded final : public util::exception
+{
+  public:
+    DeadlineExceeded() : util::exception("Query exceeded its deadline") {}
+};
+
+// Point in time after which a query is abandoned.
+//
+// Check() is meant to be called from the inner loops of the searches: it only reads the
+// clock every CHECK_INTERVAL calls, so the common case is an increment and a branch.
+class Deadline
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // A default constructed deadline never expires
+    Deadline() = default;
+    explicit Deadline(Clock::time_point expiry) : expiry(expiry), enabled(true) {}
+
+    static Deadline After(const boost::optional<std::chrono::milliseconds> &timeout)
+    {
+        return timeout ? Deadline(Clock::now() + *timeout) : Deadline();
+    }
+
+    bool IsSet() const { return enabled; }
+    bool IsExpired() const { return enabled && Clock::now() >= expiry; }
+
+    void Check()
+    {
+        if (enabled && (++calls % CHECK_INTERVAL) == 0 && Clock::now() >= expiry)
+        {
+            throw DeadlineExceeded();
+        }
+    }
+
+  private:
+    static constexpr std::uint32_t CHECK_INTERVAL = 1024;
+
+    Clock::time_point expiry;
+    bool enabled = false;
+    std::uint32_t calls = 0;
+};
+}
+}
+
+#endif
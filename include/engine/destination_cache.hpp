@@ -0,0 +1,69 @@
+#ifndef OSRM_ENGINE_DESTINATION_CACHE_HPP
+#define OSRM_ENGINE_DESTINATION_CACHE_HPP
+
+#include "engine/dataset_generation.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/routing_algorithms/direct_shortest_path.hpp"
+
+#include "util/lru_cache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Caches the reverse search spaces of the destinations of re-routes, shared by all queries of an
+// engine. A client that left its route asks again for a route to the same destination, which
+// snaps to the same phantom node, so only the forward search from its new position runs.
+//
+// Only the segments and offsets of the target phantom node are part of the key. Every key is tied
+// to the dataset it was computed on, once a query runs on a new dataset all search spaces are
+// dropped.
+class DestinationCache
+{
+  public:
+    using SearchSpace = routing_algorithms::DestinationSearchSpace;
+
+    struct Key
+    {
+        std::uint64_t generation;
+        std::vector<std::int32_t> words;
+
+        bool operator==(const Key &other) const
+        {
+            return generation == other.generation && words == other.words;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    explicit DestinationCache(const std::size_t capacity);
+
+    // dataset is any pointer that shares ownership with the facade of the query
+    Key MakeKey(const std::shared_ptr<const void> &dataset, const PhantomNode &target_phantom);
+
+    std::shared_ptr<const SearchSpace> Get(const Key &key) { return cache.Get(key); }
+
+    void Insert(Key key, std::shared_ptr<const SearchSpace> search_space)
+    {
+        cache.Insert(std::move(key), std::move(search_space));
+    }
+
+    util::CacheStatistics GetStatistics() const { return cache.GetStatistics(); }
+
+  private:
+    DatasetGeneration generation;
+    util::ShardedLRUCache<Key, SearchSpace, KeyHash> cache;
+};
+}
+}
+
+#endif
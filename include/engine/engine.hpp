@@ -1,31 +1,60 @@
 #ifndef ENGINE_HPP
 #define ENGINE_HPP
 
+#include "engine/api/isochrone_parameters.hpp"
 #include "engine/api/match_parameters.hpp"
 #include "engine/api/nearest_parameters.hpp"
 #include "engine/api/route_parameters.hpp"
+#include "engine/api/table_matrices.hpp"
 #include "engine/api/table_parameters.hpp"
+#include "engine/api/table_writer.hpp"
 #include "engine/api/tile_parameters.hpp"
 #include "engine/api/trip_parameters.hpp"
 #include "engine/data_watchdog.hpp"
 #include "engine/datafacade/contiguous_block_allocator.hpp"
+#include "engine/datafacade/mmap_memory_allocator.hpp"
+#include "engine/datafacade/process_memory_allocator.hpp"
 #include "engine/datafacade_provider.hpp"
+#include "engine/deadline.hpp"
 #include "engine/engine_config.hpp"
+#include "engine/engine_statistics.hpp"
+#include "engine/matching_sessions.hpp"
+#include "engine/plugins/isochrone.hpp"
 #include "engine/plugins/match.hpp"
 #include "engine/plugins/nearest.hpp"
 #include "engine/plugins/table.hpp"
 #include "engine/plugins/tile.hpp"
 #include "engine/plugins/trip.hpp"
 #include "engine/plugins/viaroute.hpp"
+#include "engine/request_coalescer.hpp"
 #include "engine/routing_algorithms.hpp"
+#include "engine/search_engine_data.hpp"
+#include "engine/search_trace.hpp"
+#include "engine/snapping_cache.hpp"
 #include "engine/status.hpp"
+#include "engine/sweep_order_cache.hpp"
+#include "engine/unpacking_cache.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/fingerprint.hpp"
 #include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
 
+#include <boost/assert.hpp>
+#include <boost/optional.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace osrm
 {
@@ -40,25 +69,79 @@ class EngineInterface
                          util::json::Object &result) const = 0;
     virtual Status Table(const api::TableParameters &parameters,
                          util::json::Object &result) const = 0;
+    virtual Status Table(const api::TableParameters &parameters,
+                         std::vector<char> &result) const = 0;
+    virtual Status Table(const api::TableParameters &parameters,
+                         api::TableMatrices &result) const = 0;
+    virtual Status Table(const api::TableParameters &parameters,
+                         api::TableWriter &result) const = 0;
     virtual Status Nearest(const api::NearestParameters &parameters,
                            util::json::Object &result) const = 0;
     virtual Status Trip(const api::TripParameters &parameters,
                         util::json::Object &result) const = 0;
     virtual Status Match(const api::MatchParameters &parameters,
                          util::json::Object &result) const = 0;
+    virtual Status MatchBatch(const std::vector<api::MatchParameters> &parameters,
+                              std::vector<util::json::Object> &results) const = 0;
     virtual Status Tile(const api::TileParameters &parameters, std::string &result) const = 0;
+    virtual Status Isochrone(const api::IsochroneParameters &parameters,
+                             util::json::Object &result) const = 0;
+    virtual Status Isochrone(const api::IsochroneParameters &parameters,
+                             std::string &result) const = 0;
+    virtual EngineStatistics GetStatistics() const = 0;
 };
 
 template <typename Algorithm> class Engine final : public EngineInterface
 {
   public:
     explicit Engine(const EngineConfig &config)
-        : route_plugin(config.max_locations_viaroute, config.max_alternatives), //
-          table_plugin(config.max_locations_distance_table),                    //
+        : snapping_cache(config.max_cached_snappings > 0
+                             ? std::make_shared<SnappingCache>(config.max_cached_snappings)
+                             : nullptr),
+          // MLD unpacks its paths through the cell storage, there are no shortcuts to cache
+          unpacking_cache(
+              config.max_cached_unpackings > 0 &&
+                      !std::is_same<Algorithm, routing_algorithms::mld::Algorithm>::value
+                  ? std::make_unique<UnpackingCache>(config.max_cached_unpackings)
+                  : nullptr),
+          sweep_order_cache(!std::is_same<Algorithm, routing_algorithms::mld::Algorithm>::value
+                                ? std::make_unique<SweepOrderCache>()
+                                : nullptr),
+          route_requests(config.coalesce_requests
+                             ? std::make_unique<RequestCoalescer<util::json::Object>>()
+                             : nullptr),
+          tile_requests(config.coalesce_requests ? std::make_unique<RequestCoalescer<std::string>>()
+                                                 : nullptr),
+          route_plugin(config.max_locations_viaroute,
+                       config.max_alternatives,
+                       config.max_cached_routes,
+                       config.max_reroute_destinations,
+                       config.min_parallel_route_size,
+                       config.min_parallel_search_distance,
+                       snapping_cache),                                         //
+          table_plugin(config.max_locations_distance_table,
+                       config.min_parallel_table_size,
+                       config.min_rphast_table_size,
+                       config.min_fused_table_size,
+                       snapping_cache),                                         //
           nearest_plugin(config.max_results_nearest),                           //
-          trip_plugin(config.max_locations_trip),                               //
-          match_plugin(config.max_locations_map_matching),                      //
-          tile_plugin()                                                         //
+          trip_plugin(config.max_locations_trip, snapping_cache),               //
+          match_plugin(config.max_locations_map_matching,
+                       config.min_parallel_match_size,
+                       config.max_matching_sessions > 0
+                           ? std::make_shared<MatchingSessions>(
+                                 config.max_matching_sessions,
+                                 std::chrono::seconds(config.matching_session_ttl))
+                           : nullptr),                                          //
+          tile_plugin(config.max_cached_tiles, config.tile_cache_directory),    //
+          isochrone_plugin(config.max_isochrone_duration, snapping_cache),      //
+          default_timeout(config.default_timeout == -1
+                              ? boost::none
+                              : boost::make_optional(
+                                    std::chrono::milliseconds(config.default_timeout))),
+          heap_pool(config.max_cached_heaps == -1
+                        ? boost::none
+                        : boost::make_optional(static_cast<std::size_t>(config.max_cached_heaps)))
 
     {
         if (config.use_shared_memory)
@@ -67,11 +150,53 @@ template <typename Algorithm> class Engine final : public EngineInterface
                                 << routing_algorithms::name<Algorithm>();
             facade_provider = std::make_unique<WatchingProvider<Algorithm>>();
         }
+        else if (!config.memory_file.empty())
+        {
+            util::Log(logDEBUG) << "Using memory mapped file with algorithm "
+                                << routing_algorithms::name<Algorithm>();
+            auto allocator = std::make_shared<datafacade::MMapMemoryAllocator>(
+                config.storage_config, config.memory_file, config.memory_advice);
+            if (config.lock_memory)
+            {
+                datafacade::lockBlocks(*allocator);
+            }
+            facade_provider = std::make_unique<ImmutableProvider<Algorithm>>(std::move(allocator));
+        }
+        else if (config.numa_placement == EngineConfig::NUMAPlacement::Replicate)
+        {
+            util::Log(logDEBUG) << "Using internal memory on every NUMA node with algorithm "
+                                << routing_algorithms::name<Algorithm>();
+            facade_provider = std::make_unique<ReplicatedProvider<Algorithm>>(
+                config.storage_config, config.use_huge_pages, config.lock_memory);
+        }
         else
         {
             util::Log(logDEBUG) << "Using internal memory with algorithm "
                                 << routing_algorithms::name<Algorithm>();
-            facade_provider = std::make_unique<ImmutableProvider<Algorithm>>(config.storage_config);
+            auto allocator = std::make_shared<datafacade::ProcessMemoryAllocator>(
+                config.storage_config, config.use_huge_pages, config.numa_placement);
+            if (config.lock_memory)
+            {
+                datafacade::lockBlocks(*allocator);
+            }
+            facade_provider = std::make_unique<ImmutableProvider<Algorithm>>(std::move(allocator));
+        }
+
+        if (config.numa_placement != EngineConfig::NUMAPlacement::None &&
+            (config.use_shared_memory || !config.memory_file.empty()))
+        {
+            util::Log(logWARNING) << "NUMA placement only applies to data in process memory, "
+                                     "ignoring it";
+        }
+        if (config.lock_memory && config.use_shared_memory)
+        {
+            util::Log(logWARNING) << "Shared memory is locked by osrm-datastore, ignoring "
+                                     "locking memory";
+        }
+
+        if (config.warmup_heap_sets > 0)
+        {
+            WarmUpHeaps(config.warmup_heap_sets);
         }
     }
 
@@ -85,48 +210,433 @@ template <typename Algorithm> class Engine final : public EngineInterface
     Status Route(const api::RouteParameters &params,
                  util::json::Object &result) const override final
     {
-        auto algorithms = RoutingAlgorithms<Algorithm>{heaps, facade_provider->Get()};
-        return route_plugin.HandleRequest(algorithms, params, result);
+        auto facade = GetFacade(params, result);
+        if (!facade)
+        {
+            return Status::Error;
+        }
+        if (!route_requests)
+        {
+            return HandleRequest(route_plugin, std::move(facade), params, result);
+        }
+        const auto key = route_requests->MakeKey(facade, EncodeRequest(params));
+        return route_requests->Run(key, result, [&](util::json::Object &computed) {
+            return HandleRequest(route_plugin, facade, params, computed);
+        });
     }
 
     Status Table(const api::TableParameters &params,
                  util::json::Object &result) const override final
     {
-        auto algorithms = RoutingAlgorithms<Algorithm>{heaps, facade_provider->Get()};
-        return table_plugin.HandleRequest(algorithms, params, result);
+        return HandleRequest(table_plugin, params, result);
+    }
+
+    Status Table(const api::TableParameters &params,
+                 std::vector<char> &result) const override final
+    {
+        return HandleRequest(table_plugin, params, result);
+    }
+
+    Status Table(const api::TableParameters &params,
+                 api::TableMatrices &result) const override final
+    {
+        return HandleRequest(table_plugin, params, result);
+    }
+
+    Status Table(const api::TableParameters &params,
+                 api::TableWriter &result) const override final
+    {
+        return HandleRequest(table_plugin, params, result);
     }
 
     Status Nearest(const api::NearestParameters &params,
                    util::json::Object &result) const override final
     {
-        auto algorithms = RoutingAlgorithms<Algorithm>{heaps, facade_provider->Get()};
-        return nearest_plugin.HandleRequest(algorithms, params, result);
+        return HandleRequest(nearest_plugin, params, result);
     }
 
     Status Trip(const api::TripParameters &params, util::json::Object &result) const override final
     {
-        auto algorithms = RoutingAlgorithms<Algorithm>{heaps, facade_provider->Get()};
-        return trip_plugin.HandleRequest(algorithms, params, result);
+        return HandleRequest(trip_plugin, params, result);
     }
 
     Status Match(const api::MatchParameters &params,
                  util::json::Object &result) const override final
     {
-        auto algorithms = RoutingAlgorithms<Algorithm>{heaps, facade_provider->Get()};
-        return match_plugin.HandleRequest(algorithms, params, result);
+        return HandleRequest(match_plugin, params, result);
+    }
+
+    // The traces are spread over tasks on all cores. A task leases one set of heaps for all the
+    // traces it matches, the hidden Markov models of map matching are kept per thread anyway.
+    Status MatchBatch(const std::vector<api::MatchParameters> &params,
+                      std::vector<util::json::Object> &results) const override final
+    {
+        results.clear();
+        results.resize(params.size());
+        std::atomic<bool> matched_all{true};
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, params.size()),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                SearchEngineData<Algorithm> heaps{heap_pool};
+                for (auto index = range.begin(); index != range.end(); ++index)
+                {
+                    auto status = Status::Error;
+                    if (!params[index].IsValid())
+                    {
+                        SetError(results[index], "InvalidOptions", "Trace is not valid.");
+                    }
+                    else if (auto facade = GetFacade(params[index], results[index]))
+                    {
+                        status = HandleRequest(
+                            match_plugin, heaps, std::move(facade), params[index], results[index]);
+                    }
+                    if (status != Status::Ok)
+                    {
+                        matched_all = false;
+                    }
+                }
+            });
+        return matched_all ? Status::Ok : Status::Error;
     }
 
     Status Tile(const api::TileParameters &params, std::string &result) const override final
     {
-        auto algorithms = RoutingAlgorithms<Algorithm>{heaps, facade_provider->Get()};
-        return tile_plugin.HandleRequest(algorithms, params, result);
+        // tiles show the data of the first metric
+        auto facade = facade_provider->Get(0);
+        const auto compute = [&](std::string &computed) {
+            SearchEngineData<Algorithm> heaps{heap_pool};
+            auto algorithms = RoutingAlgorithms<Algorithm>{heaps, facade};
+            return tile_plugin.HandleRequest(algorithms, params, computed);
+        };
+        if (!tile_requests)
+        {
+            return compute(result);
+        }
+        const auto key = tile_requests->MakeKey(facade, EncodeRequest(params));
+        return tile_requests->Run(key, result, compute);
+    }
+
+    Status Isochrone(const api::IsochroneParameters &params,
+                     util::json::Object &result) const override final
+    {
+        return HandleRequest(isochrone_plugin, params, result);
+    }
+
+    Status Isochrone(const api::IsochroneParameters &params,
+                     std::string &result) const override final
+    {
+        return HandleRequest(isochrone_plugin, params, result);
+    }
+
+    EngineStatistics GetStatistics() const override final
+    {
+        return EngineStatistics{route_plugin.GetCacheStatistics(),
+                                snapping_cache ? snapping_cache->GetStatistics()
+                                               : util::CacheStatistics{0, 0, 0, 0, 0},
+                                unpacking_cache ? unpacking_cache->GetStatistics()
+                                                : util::CacheStatistics{0, 0, 0, 0, 0},
+                                tile_plugin.GetCacheStatistics(),
+                                (route_requests ? route_requests->GetCoalesced() : 0) +
+                                    (tile_requests ? tile_requests->GetCoalesced() : 0),
+                                facade_provider->GetUpdateStatistics(),
+                                search_totals.Get()};
     }
 
     static bool CheckCompability(const EngineConfig &config);
 
   private:
+    // Leases the heap sets all at once so the pool creates each of them, the route and table
+    // heaps are sized to the graph before they go back to the pool
+    void WarmUpHeaps(const std::size_t number_of_sets) const
+    {
+        const auto number_of_nodes = facade_provider->Get(0)->GetNumberOfNodes();
+        std::vector<std::unique_ptr<SearchEngineData<Algorithm>>> leased;
+        for (std::size_t index = 0; index < number_of_sets; ++index)
+        {
+            leased.push_back(std::make_unique<SearchEngineData<Algorithm>>(heap_pool));
+            leased.back()->InitializeOrClearFirstHeaps(number_of_nodes);
+            leased.back()->InitializeOrClearManyToManyHeaps(number_of_nodes);
+        }
+        util::Log() << "Created " << number_of_sets << " heap sets for " << number_of_nodes
+                    << " nodes";
+    }
+
+    // The request timeout only ever tightens the configured default
+    Deadline MakeDeadline(const boost::optional<std::chrono::milliseconds> &timeout) const
+    {
+        if (!default_timeout || (timeout && *timeout < *default_timeout))
+        {
+            return Deadline::After(timeout);
+        }
+        return Deadline::After(default_timeout);
+    }
+
+    template <typename PluginT, typename ParametersT, typename ResultT>
+    Status HandleRequest(const PluginT &plugin, const ParametersT &params, ResultT &result) const
+    {
+        auto facade = GetFacade(params, result);
+        if (!facade)
+        {
+            return Status::Error;
+        }
+        return HandleRequest(plugin, std::move(facade), params, result);
+    }
+
+    template <typename PluginT, typename ParametersT, typename ResultT>
+    Status HandleRequest(const PluginT &plugin,
+                         std::shared_ptr<const DataFacade<Algorithm>> facade,
+                         const ParametersT &params,
+                         ResultT &result) const
+    {
+        SearchEngineData<Algorithm> heaps{heap_pool};
+        return HandleRequest(plugin, heaps, std::move(facade), params, result);
+    }
+
+    // Runs a request on heaps that were leased already, e.g. for all requests of a batch
+    template <typename PluginT, typename ParametersT, typename ResultT>
+    Status HandleRequest(const PluginT &plugin,
+                         SearchEngineData<Algorithm> &heaps,
+                         std::shared_ptr<const DataFacade<Algorithm>> facade,
+                         const ParametersT &params,
+                         ResultT &result) const
+    {
+        heaps.deadline = MakeDeadline(params.timeout);
+        auto algorithms = RoutingAlgorithms<Algorithm>{heaps, std::move(facade)};
+        UseUnpackingCache(heaps, algorithms.GetDataset());
+        UseSweepOrderCache(heaps, algorithms.GetDataset());
+
+        SearchTrace trace;
+        auto status = Status::Error;
+        {
+            SearchTracing::Scope trace_scope(&trace);
+            try
+            {
+                status = plugin.HandleRequest(algorithms, params, result);
+            }
+            catch (const DeadlineExceeded &)
+            {
+                SetTimeoutError(result);
+            }
+        }
+        if (SearchTracing::enabled)
+        {
+            RecordSearchTrace(trace, params, result);
+        }
+        return status;
+    }
+
+    // `debug=stats` adds the trace to JSON responses
+    void RecordSearchTrace(const SearchTrace &trace,
+                           const api::BaseParameters &params,
+                           util::json::Object &result) const
+    {
+        search_totals.Add(trace);
+        if (params.debug_stats)
+        {
+            auto stats = trace.ToJSON();
+            std::ostringstream rendered;
+            util::json::render(rendered, stats);
+            util::Log(logDEBUG) << "Search statistics: " << rendered.str();
+            result.values["stats"] = std::move(stats);
+        }
+    }
+
+    void RecordSearchTrace(const SearchTrace &trace,
+                           const api::BaseParameters &params,
+                           api::TableMatrices &result) const
+    {
+        RecordSearchTrace(trace, params, result.response);
+    }
+
+    template <typename ResultT>
+    void RecordSearchTrace(const SearchTrace &trace,
+                           const api::BaseParameters &,
+                           ResultT &) const
+    {
+        search_totals.Add(trace);
+    }
+
+    // The facade of the metric the request selects with `metric`, `exclude` or `departure_time`,
+    // nullptr and an error in the result if the data has no such metric
+    template <typename ParametersT, typename ResultT>
+    std::shared_ptr<const DataFacade<Algorithm>> GetFacade(const ParametersT &params,
+                                                           ResultT &result) const
+    {
+        auto metric = params.metric;
+        if (!params.exclude.empty())
+        {
+            const auto base_facade = facade_provider->Get(0);
+            const auto exclude_metric =
+                base_facade ? GetExcludeMetric(*base_facade, params.exclude) : boost::none;
+            if (params.metric != 0 || !exclude_metric)
+            {
+                SetExcludeError(result);
+                return nullptr;
+            }
+            metric = *exclude_metric;
+        }
+        if (params.departure_time)
+        {
+            const auto base_facade = facade_provider->Get(0);
+            const auto time_slot_metric =
+                base_facade ? GetTimeSlotMetric(*base_facade, *params.departure_time)
+                            : boost::none;
+            const auto has_conditional_turns = base_facade && HasConditionalTurns(*base_facade);
+            if (params.metric != 0 || !params.exclude.empty() ||
+                (!time_slot_metric && !has_conditional_turns))
+            {
+                SetDepartureTimeError(result);
+                return nullptr;
+            }
+            // without speed profiles the departure time only selects the conditional turns
+            if (time_slot_metric)
+            {
+                metric = *time_slot_metric;
+            }
+        }
+
+        auto facade = facade_provider->Get(metric);
+        if (!facade)
+        {
+            SetMetricError(result, metric);
+        }
+        return facade;
+    }
+
+    // only MLD customizes metrics that exclude classes
+    template <typename FacadeT>
+    static boost::optional<std::size_t> GetExcludeMetric(const FacadeT &,
+                                                         const std::vector<std::string> &)
+    {
+        return boost::none;
+    }
+
+    static boost::optional<std::size_t>
+    GetExcludeMetric(const DataFacade<routing_algorithms::mld::Algorithm> &facade,
+                     const std::vector<std::string> &classes)
+    {
+        return facade.GetExcludeMetric(classes);
+    }
+
+    // only MLD customizes metrics for the time slots of speed profiles
+    template <typename FacadeT>
+    static boost::optional<std::size_t> GetTimeSlotMetric(const FacadeT &, const std::uint64_t)
+    {
+        return boost::none;
+    }
+
+    static boost::optional<std::size_t>
+    GetTimeSlotMetric(const DataFacade<routing_algorithms::mld::Algorithm> &facade,
+                      const std::uint64_t departure_time)
+    {
+        return facade.GetTimeSlotMetric(departure_time);
+    }
+
+    // only MLD checks conditional turn restrictions at query time
+    template <typename FacadeT> static bool HasConditionalTurns(const FacadeT &) { return false; }
+
+    static bool HasConditionalTurns(const DataFacade<routing_algorithms::mld::Algorithm> &facade)
+    {
+        return !facade.GetConditionalTurnMasks().empty();
+    }
+
+    void UseUnpackingCache(SearchEngineData<routing_algorithms::ch::Algorithm> &heaps,
+                           const std::shared_ptr<const void> &dataset) const
+    {
+        if (unpacking_cache)
+        {
+            heaps.unpacking_cache = unpacking_cache->ForDataset(dataset);
+        }
+    }
+
+    static void UseUnpackingCache(SearchEngineData<routing_algorithms::mld::Algorithm> &,
+                                  const std::shared_ptr<const void> &)
+    {
+    }
+
+    void UseSweepOrderCache(SearchEngineData<routing_algorithms::ch::Algorithm> &heaps,
+                            const std::shared_ptr<const void> &dataset) const
+    {
+        BOOST_ASSERT(sweep_order_cache);
+        heaps.sweep_order_cache = sweep_order_cache->ForDataset(dataset);
+    }
+
+    static void UseSweepOrderCache(SearchEngineData<routing_algorithms::mld::Algorithm> &,
+                                   const std::shared_ptr<const void> &)
+    {
+    }
+
+    static void SetError(util::json::Object &result, std::string code, std::string message)
+    {
+        result.values.clear();
+        result.values["code"] = std::move(code);
+        result.values["message"] = std::move(message);
+    }
+
+    static void SetError(std::vector<char> &result, std::string code, std::string message)
+    {
+        util::json::Object json_result;
+        SetError(json_result, std::move(code), std::move(message));
+        result.clear();
+        util::json::render(result, json_result);
+    }
+
+    static void SetError(api::TableMatrices &result, std::string code, std::string message)
+    {
+        result = api::TableMatrices{};
+        SetError(result.response, std::move(code), std::move(message));
+    }
+
+    static void SetError(api::TableWriter &result, std::string code, std::string message)
+    {
+        SetError(result.error, std::move(code), std::move(message));
+    }
+
+    static void SetError(std::string &result, std::string code, std::string message)
+    {
+        std::vector<char> rendered;
+        SetError(rendered, std::move(code), std::move(message));
+        result.assign(rendered.begin(), rendered.end());
+    }
+
+    template <typename ResultT> static void SetTimeoutError(ResultT &result)
+    {
+        SetError(result, "Timeout", "Query took longer than the allowed time");
+    }
+
+    template <typename ResultT>
+    static void SetMetricError(ResultT &result, const std::size_t metric)
+    {
+        SetError(result, "InvalidValue", "The dataset has no metric " + std::to_string(metric));
+    }
+
+    template <typename ResultT> static void SetExcludeError(ResultT &result)
+    {
+        SetError(result, "InvalidValue", "Exclude flag combination is not supported.");
+    }
+
+    template <typename ResultT> static void SetDepartureTimeError(ResultT &result)
+    {
+        SetError(result,
+                 "InvalidValue",
+                 "Departure time needs a dataset customized with speed profiles or with "
+                 "conditional turn restrictions and can not be combined with metric or exclude.");
+    }
+
     std::unique_ptr<DataFacadeProvider<Algorithm>> facade_provider;
-    mutable SearchEngineData<Algorithm> heaps;
+
+    // shared by the plugins that snap with GetPhantomNodes, nullptr if disabled
+    const std::shared_ptr<SnappingCache> snapping_cache;
+
+    // shortcuts unpacked by CH queries, nullptr if disabled or for MLD
+    const std::unique_ptr<UnpackingCache> unpacking_cache;
+
+    // the order of the PHAST sweeps of isochrone queries, nullptr for MLD
+    const std::unique_ptr<SweepOrderCache> sweep_order_cache;
+
+    // identical route and tile requests in flight at the same time, nullptr if disabled
+    const std::unique_ptr<RequestCoalescer<util::json::Object>> route_requests;
+    const std::unique_ptr<RequestCoalescer<std::string>> tile_requests;
 
     const plugins::ViaRoutePlugin route_plugin;
     const plugins::TablePlugin table_plugin;
@@ -134,6 +644,15 @@ template <typename Algorithm> class Engine final : public EngineInterface
     const plugins::TripPlugin trip_plugin;
     const plugins::MatchPlugin match_plugin;
     const plugins::TilePlugin tile_plugin;
+    const plugins::IsochronePlugin isochrone_plugin;
+
+    const boost::optional<std::chrono::milliseconds> default_timeout;
+
+    // shared by all queries, leasing is thread safe
+    mutable typename SearchEngineData<Algorithm>::HeapPool heap_pool;
+
+    // empty unless built with ENABLE_SEARCH_STATISTICS
+    mutable SearchTraceTotals search_totals;
 };
 
 template <>
@@ -145,7 +664,7 @@ bool Engine<routing_algorithms::ch::Algorithm>::CheckCompability(const EngineCon
         using mutex_type = typename decltype(barrier)::mutex_type;
         boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
 
-        auto mem = storage::makeSharedMemory(barrier.data().region);
+        auto mem = storage::makeSharedMemory(barrier.data().metric_region);
         auto layout = reinterpret_cast<storage::DataLayout *>(mem->Ptr());
         return layout->GetBlockSize(storage::DataLayout::CH_GRAPH_NODE_LIST) > 4 &&
                layout->GetBlockSize(storage::DataLayout::CH_GRAPH_EDGE_LIST) > 4;
@@ -176,7 +695,7 @@ bool Engine<routing_algorithms::corech::Algorithm>::CheckCompability(const Engin
         using mutex_type = typename decltype(barrier)::mutex_type;
         boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
 
-        auto mem = storage::makeSharedMemory(barrier.data().region);
+        auto mem = storage::makeSharedMemory(barrier.data().metric_region);
         auto layout = reinterpret_cast<storage::DataLayout *>(mem->Ptr());
         return layout->GetBlockSize(storage::DataLayout::CH_CORE_MARKER) >
                sizeof(std::uint64_t) + sizeof(util::FingerPrint);
@@ -193,6 +712,20 @@ bool Engine<routing_algorithms::corech::Algorithm>::CheckCompability(const Engin
     }
 }
 
+// A CCH is stored like a CH, on disk the .osrm.cch file of osrm-contract --cch marks it. The
+// shared memory has no block for it, every CH loaded by osrm-datastore can be searched as a CCH.
+template <>
+bool Engine<routing_algorithms::cch::Algorithm>::CheckCompability(const EngineConfig &config)
+{
+    if (!Engine<routing_algorithms::ch::Algorithm>::CheckCompability(config))
+    {
+        return false;
+    }
+
+    return config.use_shared_memory ||
+           boost::filesystem::exists(config.storage_config.GetPath(".osrm.cch"));
+}
+
 template <>
 bool Engine<routing_algorithms::mld::Algorithm>::CheckCompability(const EngineConfig &config)
 {
@@ -202,7 +735,7 @@ bool Engine<routing_algorithms::mld::Algorithm>::CheckCompability(const EngineCo
         using mutex_type = typename decltype(barrier)::mutex_type;
         boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
 
-        auto mem = storage::makeSharedMemory(barrier.data().region);
+        auto mem = storage::makeSharedMemory(barrier.data().static_region);
         auto layout = reinterpret_cast<storage::DataLayout *>(mem->Ptr());
         return layout->GetBlockSize(storage::DataLayout::MLD_PARTITION) > 0;
     }
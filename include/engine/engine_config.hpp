@@ -32,6 +32,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/filesystem/path.hpp>
 
+#include <map>
 #include <string>
 
 namespace osrm
@@ -53,9 +54,79 @@ namespace engine
  *  - Match
  *  - Nearest
  *
+ * Isochrones can not have contours of more than max_isochrone_duration seconds (-1 for
+ * unlimited).
+ *
+ * A default deadline in milliseconds (-1 for unlimited) bounds how long a single query may
+ * search before it is aborted with a Timeout error. Requests can only tighten it.
+ *
+ * Tables with at least min_parallel_table_size entries (-1 for never) run their searches on all
+ * cores instead of only the request thread. CH tables with at least min_rphast_table_size entries
+ * (-1 for never) sweep the downward graph of their destinations once per source instead of
+ * matching the search spaces of every source and destination. Tables whose sources are their
+ * destinations with at least min_fused_table_size entries (-1 for never) run the backward and the
+ * forward search of every coordinate in a single pass. Traces with at least
+ * min_parallel_match_size coordinates (-1 for never) that are split at time gaps match the parts
+ * between the gaps on all cores. Routes with at least min_parallel_route_size coordinates (-1 for
+ * never) search and assemble their legs on all cores. MLD routes between two coordinates at least
+ * min_parallel_search_distance meters apart (-1 for never) run their forward and reverse search
+ * on two threads.
+ *
+ * Every running query uses a set of search heaps. Finished queries return them to a pool, which
+ * keeps at most max_cached_heaps of them (-1 for unlimited) around for the next queries. The
+ * engine creates warmup_heap_sets of them (0 for none) sized to the graph on startup, so the
+ * first queries do not allocate their heaps.
+ *
+ * The paths of the last max_cached_routes route queries (0 for none) between distinct snapped
+ * coordinates are cached until the dataset changes. So are the snappings of the last
+ * max_cached_snappings distinct coordinates (0 for none) of route, table and trip queries. CH
+ * queries keep the original edges of the last max_cached_unpackings shortcuts (0 for none) they
+ * unpacked.
+ *
+ * The reverse search spaces of the destinations of the last max_reroute_destinations CH route
+ * queries with reroute (0 for none) are cached until the dataset changes, re-routes to these
+ * destinations only search forward.
+ *
+ * The last max_cached_tiles rendered tiles (0 for none) are cached until the dataset changes.
+ * With a tile_cache_directory every rendered tile is also stored there as
+ * <timestamp>/<z>/<x>/<y>.mvt, where timestamp is the one of the dataset. The files outlive
+ * the process and are served to later engines on datasets with the same timestamp.
+ *
+ * The asynchronous methods of OSRM run their queries on an executor of async_threads threads (0
+ * for one per core), which also runs the parallel parts of these queries.
+ *
+ * Match requests with a session id extend a trace that is kept between requests for
+ * matching_session_ttl seconds after its last request. At most max_matching_sessions (0 for none)
+ * are kept, the least recently used one is dropped to make room for a new one.
+ *
+ * With coalesce_requests identical route and tile requests running at the same time, e.g. the
+ * retries of a client, are computed once and share the result.
+ *
  * In addition, shared memory can be used for datasets loaded with osrm-datastore.
  *
- * You can chose between three algorithms:
+ * Without shared memory the data is read into process memory, unless a memory_file is given.
+ * With use_huge_pages process memory is allocated from the huge pages the system reserved, or
+ * backed by transparent huge pages if there are none, which saves TLB misses in searches.
+ * With lock_memory the pages of process memory or of the memory_file are locked into RAM, so
+ * the kernel can not evict them under memory pressure. This fails if RLIMIT_MEMLOCK is lower than
+ * the size of the data. Shared memory is locked by osrm-datastore instead.
+ *
+ * On machines with several NUMA nodes numa_placement decides where process memory lives:
+ *  - NUMAPlacement::None
+ *    Pages are allocated on the nodes of the threads that load the data.
+ *  - NUMAPlacement::Interleave
+ *    Pages are spread round robin over all nodes, so every node sees the same latency.
+ *  - NUMAPlacement::Replicate
+ *    Every node gets its own copy of the data, queries read the copy of the node they run on.
+ *    This needs the memory of the dataset once per node.
+ * The data is then mapped from that file, which is created from the .osrm files on the first
+ * start and again whenever one of them is newer. Later starts are near instant and all processes
+ * mapping the same file share its pages in the page cache. memory_advice passes madvise hints for
+ * single blocks of the file, keyed by the block name, e.g. {"CH_GRAPH_EDGE_LIST", Random}.
+ * Once written the memory file holds all the data but the .osrm.fileIndex, so it can be used
+ * without the other .osrm files, and osrm-datastore --memory-file copies it into shared memory.
+ *
+ * You can chose between four algorithms:
  *  - Algorithm::CH
  *    Contraction Hierarchies, extremely fast queries but slow pre-processing. The default right
  * now.
@@ -64,6 +135,9 @@ namespace engine
  *  - Algorithm::MLD
  *    Multi Level Dijkstra which is experimental and moderately fast in both pre-processing and
  * query.
+ *  - Algorithm::CCH
+ *    Customizable Contraction Hierarchies of osrm-contract --cch, searched like a CH. Weight
+ * updates only customize the arcs again, queries are slower than on a CH.
  *
  * Algorithm::CH is specified we will automatically upgrade to CoreCH if we find the data for it.
  * If Algorithm::CoreCH is specified and we don't find the speedup data, we fail hard.
@@ -78,7 +152,23 @@ struct EngineConfig final
     {
         CH,     // will upgrade to CoreCH if it finds core data
         CoreCH, // will fail hard if there is no core data
-        MLD
+        MLD,
+        CCH // will fail hard if the data was not contracted with --cch
+    };
+
+    enum class NUMAPlacement
+    {
+        None,
+        Interleave,
+        Replicate
+    };
+
+    enum class MemoryAdvice
+    {
+        Normal,
+        Random,
+        Sequential,
+        WillNeed
     };
 
     storage::StorageConfig storage_config;
@@ -88,7 +178,32 @@ struct EngineConfig final
     int max_locations_map_matching = -1;
     int max_results_nearest = -1;
     int max_alternatives = 3; // set an arbitrary upper bound; can be adjusted by user
+    int max_isochrone_duration = -1; // in seconds
+    int default_timeout = -1; // in milliseconds
+    int max_cached_heaps = -1;
+    int warmup_heap_sets = 0;
+    int max_cached_routes = 0;
+    int max_reroute_destinations = 0;
+    int max_cached_snappings = 0;
+    int max_cached_unpackings = 0;
+    int max_cached_tiles = 0;
+    std::string tile_cache_directory; // empty for none
+    int max_matching_sessions = 0;
+    int matching_session_ttl = 300; // in seconds
+    int min_parallel_table_size = -1;      // in sources times destinations
+    int min_rphast_table_size = 1000000;   // in sources times destinations
+    int min_fused_table_size = 0;          // in sources times destinations
+    int min_parallel_match_size = -1;      // in trace coordinates
+    int min_parallel_route_size = -1;      // in route coordinates
+    int min_parallel_search_distance = -1; // in meters
+    int async_threads = 0;
+    bool coalesce_requests = false;
     bool use_shared_memory = true;
+    bool use_huge_pages = false;
+    bool lock_memory = false;
+    NUMAPlacement numa_placement = NUMAPlacement::None;
+    std::string memory_file; // empty to read the data into process memory
+    std::map<std::string, MemoryAdvice> memory_advice;
     Algorithm algorithm = Algorithm::CH;
 };
 }
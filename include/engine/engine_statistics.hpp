@@ -0,0 +1,44 @@
+#ifndef OSRM_ENGINE_ENGINE_STATISTICS_HPP
+#define OSRM_ENGINE_ENGINE_STATISTICS_HPP
+
+#include "engine/search_trace.hpp"
+#include "util/lru_cache.hpp"
+
+#include <cstdint>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Swaps to datasets that osrm-datastore loaded into shared memory, timed from the notification of
+// the new dataset until queries use it, which includes faulting in its pages
+struct DataUpdateStatistics
+{
+    std::uint64_t updates = 0;
+    std::uint64_t total_us = 0;
+    std::uint64_t last_us = 0;
+    // datasets of which shared memory still exists, the current one and the ones processes have
+    // not detached from yet, and the bytes of their shared memory
+    std::uint64_t generations = 0;
+    std::uint64_t generation_bytes = 0;
+};
+
+// Counters of the caches an engine keeps between queries, all zero for disabled caches
+struct EngineStatistics
+{
+    util::CacheStatistics route_cache;
+    util::CacheStatistics snapping_cache;
+    util::CacheStatistics unpacking_cache;
+    util::CacheStatistics tile_cache;
+    // requests that got the result of an identical request in flight instead of computing it
+    std::uint64_t coalesced_requests;
+    // all zero unless the data is in shared memory
+    DataUpdateStatistics data_updates;
+    // all zero unless built with ENABLE_SEARCH_STATISTICS
+    SearchTraceTotals::Statistics searches;
+};
+}
+}
+
+#endif
@@ -13,6 +13,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -47,15 +48,17 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         return rtree.SearchInBox(bbox);
     }
 
-    // Returns nearest PhantomNodes in the given bearing range within max_distance.
+    // Returns the nearest segments in the given bearing range within max_distance.
     // Does not filter by small/big component!
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate input_coordinate,
-                               const double max_distance,
-                               const Approach approach) const
+    std::vector<SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate input_coordinate,
+                             const double max_distance,
+                             const Approach approach) const
     {
         auto results = rtree.Nearest(
             input_coordinate,
+            max_distance,
+            [](const EdgeData &) { return true; },
             [this, approach, &input_coordinate](const CandidateSegment &segment) {
                 return boolPairAnd(HasValidEdge(segment),
                                    CheckApproach(input_coordinate, segment, approach));
@@ -65,24 +68,27 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 return CheckSegmentDistance(input_coordinate, segment, max_distance);
             });
 
-        return MakePhantomNodes(input_coordinate, results);
+        return MakeCandidates(input_coordinate, results);
     }
 
-    // Returns nearest PhantomNodes in the given bearing range within max_distance.
+    // Returns the nearest segments in the given bearing range within max_distance.
     // Does not filter by small/big component!
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate input_coordinate,
-                               const double max_distance,
-                               const int bearing,
-                               const int bearing_range,
-                               const Approach approach) const
+    std::vector<SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate input_coordinate,
+                             const double max_distance,
+                             const int bearing,
+                             const int bearing_range,
+                             const Approach approach) const
     {
         auto results = rtree.Nearest(
             input_coordinate,
+            max_distance,
+            AcceptBearing(bearing, bearing_range),
             [this, approach, &input_coordinate, bearing, bearing_range, max_distance](
                 const CandidateSegment &segment) {
-                auto use_direction = boolPairAnd(
-                    CheckSegmentBearing(segment, bearing, bearing_range), HasValidEdge(segment));
+                auto use_direction =
+                    boolPairAnd(CheckSegmentBearing(segment.data, bearing, bearing_range),
+                                HasValidEdge(segment));
                 use_direction =
                     boolPairAnd(use_direction, CheckApproach(input_coordinate, segment, approach));
                 return use_direction;
@@ -92,24 +98,27 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 return CheckSegmentDistance(input_coordinate, segment, max_distance);
             });
 
-        return MakePhantomNodes(input_coordinate, results);
+        return MakeCandidates(input_coordinate, results);
     }
 
-    // Returns max_results nearest PhantomNodes in the given bearing range.
+    // Returns the max_results nearest segments in the given bearing range.
     // Does not filter by small/big component!
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const int bearing,
-                        const int bearing_range,
-                        const Approach approach) const
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const int bearing,
+                      const int bearing_range,
+                      const Approach approach) const
     {
         auto results = rtree.Nearest(
             input_coordinate,
+            std::numeric_limits<double>::infinity(),
+            AcceptBearing(bearing, bearing_range),
             [this, approach, &input_coordinate, bearing, bearing_range](
                 const CandidateSegment &segment) {
-                auto use_direction = boolPairAnd(
-                    CheckSegmentBearing(segment, bearing, bearing_range), HasValidEdge(segment));
+                auto use_direction =
+                    boolPairAnd(CheckSegmentBearing(segment.data, bearing, bearing_range),
+                                HasValidEdge(segment));
                 return boolPairAnd(use_direction,
                                    CheckApproach(input_coordinate, segment, approach));
             },
@@ -117,26 +126,29 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 return num_results >= max_results;
             });
 
-        return MakePhantomNodes(input_coordinate, results);
+        return MakeCandidates(input_coordinate, results);
     }
 
-    // Returns max_results nearest PhantomNodes in the given bearing range within the maximum
+    // Returns the max_results nearest segments in the given bearing range within the maximum
     // distance.
     // Does not filter by small/big component!
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const double max_distance,
-                        const int bearing,
-                        const int bearing_range,
-                        const Approach approach) const
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const double max_distance,
+                      const int bearing,
+                      const int bearing_range,
+                      const Approach approach) const
     {
         auto results = rtree.Nearest(
             input_coordinate,
+            max_distance,
+            AcceptBearing(bearing, bearing_range),
             [this, approach, &input_coordinate, bearing, bearing_range](
                 const CandidateSegment &segment) {
-                auto use_direction = boolPairAnd(
-                    CheckSegmentBearing(segment, bearing, bearing_range), HasValidEdge(segment));
+                auto use_direction =
+                    boolPairAnd(CheckSegmentBearing(segment.data, bearing, bearing_range),
+                                HasValidEdge(segment));
                 return boolPairAnd(use_direction,
                                    CheckApproach(input_coordinate, segment, approach));
             },
@@ -146,15 +158,15 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                        CheckSegmentDistance(input_coordinate, segment, max_distance);
             });
 
-        return MakePhantomNodes(input_coordinate, results);
+        return MakeCandidates(input_coordinate, results);
     }
 
-    // Returns max_results nearest PhantomNodes.
+    // Returns the max_results nearest segments.
     // Does not filter by small/big component!
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const Approach approach) const
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const Approach approach) const
     {
         auto results = rtree.Nearest(
             input_coordinate,
@@ -166,19 +178,21 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 return num_results >= max_results;
             });
 
-        return MakePhantomNodes(input_coordinate, results);
+        return MakeCandidates(input_coordinate, results);
     }
 
-    // Returns max_results nearest PhantomNodes in the given max distance.
+    // Returns the max_results nearest segments in the given max distance.
     // Does not filter by small/big component!
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate input_coordinate,
-                        const unsigned max_results,
-                        const double max_distance,
-                        const Approach approach) const
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate input_coordinate,
+                      const unsigned max_results,
+                      const double max_distance,
+                      const Approach approach) const
     {
         auto results = rtree.Nearest(
             input_coordinate,
+            max_distance,
+            [](const EdgeData &) { return true; },
             [this, approach, &input_coordinate](const CandidateSegment &segment) {
                 return boolPairAnd(HasValidEdge(segment),
                                    CheckApproach(input_coordinate, segment, approach));
@@ -189,7 +203,7 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                        CheckSegmentDistance(input_coordinate, segment, max_distance);
             });
 
-        return MakePhantomNodes(input_coordinate, results);
+        return MakeCandidates(input_coordinate, results);
     }
 
     // Returns the nearest phantom node. If this phantom node is not from a big component
@@ -203,6 +217,8 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         bool has_big_component = false;
         auto results = rtree.Nearest(
             input_coordinate,
+            max_distance,
+            [](const EdgeData &) { return true; },
             [this, approach, &input_coordinate, &has_big_component, &has_small_component](
                 const CandidateSegment &segment) {
                 auto use_segment =
@@ -233,8 +249,11 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         }
 
         BOOST_ASSERT(results.size() == 1 || results.size() == 2);
-        return std::make_pair(MakePhantomNode(input_coordinate, results.front()).phantom_node,
-                              MakePhantomNode(input_coordinate, results.back()).phantom_node);
+        return std::make_pair(
+            MakePhantomNode(input_coordinate, MakeCandidate(input_coordinate, results.front()))
+                .phantom_node,
+            MakePhantomNode(input_coordinate, MakeCandidate(input_coordinate, results.back()))
+                .phantom_node);
     }
 
     // Returns the nearest phantom node. If this phantom node is not from a big component
@@ -276,8 +295,11 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         }
 
         BOOST_ASSERT(results.size() == 1 || results.size() == 2);
-        return std::make_pair(MakePhantomNode(input_coordinate, results.front()).phantom_node,
-                              MakePhantomNode(input_coordinate, results.back()).phantom_node);
+        return std::make_pair(
+            MakePhantomNode(input_coordinate, MakeCandidate(input_coordinate, results.front()))
+                .phantom_node,
+            MakePhantomNode(input_coordinate, MakeCandidate(input_coordinate, results.back()))
+                .phantom_node);
     }
 
     // Returns the nearest phantom node. If this phantom node is not from a big component
@@ -292,6 +314,8 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         bool has_big_component = false;
         auto results = rtree.Nearest(
             input_coordinate,
+            std::numeric_limits<double>::infinity(),
+            AcceptBearing(bearing, bearing_range),
             [this,
              approach,
              &input_coordinate,
@@ -307,7 +331,7 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 if (use_segment)
                 {
                     use_directions =
-                        boolPairAnd(CheckSegmentBearing(segment, bearing, bearing_range),
+                        boolPairAnd(CheckSegmentBearing(segment.data, bearing, bearing_range),
                                     HasValidEdge(segment));
                     use_directions = boolPairAnd(
                         use_directions, CheckApproach(input_coordinate, segment, approach));
@@ -331,8 +355,11 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         }
 
         BOOST_ASSERT(results.size() > 0);
-        return std::make_pair(MakePhantomNode(input_coordinate, results.front()).phantom_node,
-                              MakePhantomNode(input_coordinate, results.back()).phantom_node);
+        return std::make_pair(
+            MakePhantomNode(input_coordinate, MakeCandidate(input_coordinate, results.front()))
+                .phantom_node,
+            MakePhantomNode(input_coordinate, MakeCandidate(input_coordinate, results.back()))
+                .phantom_node);
     }
 
     // Returns the nearest phantom node. If this phantom node is not from a big component
@@ -348,6 +375,8 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         bool has_big_component = false;
         auto results = rtree.Nearest(
             input_coordinate,
+            max_distance,
+            AcceptBearing(bearing, bearing_range),
             [this,
              approach,
              &input_coordinate,
@@ -363,7 +392,7 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                 if (use_segment)
                 {
                     use_directions =
-                        boolPairAnd(CheckSegmentBearing(segment, bearing, bearing_range),
+                        boolPairAnd(CheckSegmentBearing(segment.data, bearing, bearing_range),
                                     HasValidEdge(segment));
                     use_directions = boolPairAnd(
                         use_directions, CheckApproach(input_coordinate, segment, approach));
@@ -389,36 +418,19 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         }
 
         BOOST_ASSERT(results.size() > 0);
-        return std::make_pair(MakePhantomNode(input_coordinate, results.front()).phantom_node,
-                              MakePhantomNode(input_coordinate, results.back()).phantom_node);
-    }
-
-  private:
-    std::vector<PhantomNodeWithDistance>
-    MakePhantomNodes(const util::Coordinate input_coordinate,
-                     const std::vector<EdgeData> &results) const
-    {
-        std::vector<PhantomNodeWithDistance> distance_and_phantoms(results.size());
-        std::transform(results.begin(),
-                       results.end(),
-                       distance_and_phantoms.begin(),
-                       [this, &input_coordinate](const EdgeData &data) {
-                           return MakePhantomNode(input_coordinate, data);
-                       });
-        return distance_and_phantoms;
+        return std::make_pair(
+            MakePhantomNode(input_coordinate, MakeCandidate(input_coordinate, results.front()))
+                .phantom_node,
+            MakePhantomNode(input_coordinate, MakeCandidate(input_coordinate, results.back()))
+                .phantom_node);
     }
 
+    // Builds the PhantomNode of a candidate returned by the queries above
     PhantomNodeWithDistance MakePhantomNode(const util::Coordinate input_coordinate,
-                                            const EdgeData &data) const
+                                            const SegmentCandidate &candidate) const
     {
-        util::Coordinate point_on_segment;
-        double ratio;
-        const auto current_perpendicular_distance =
-            util::coordinate_calculation::perpendicularDistance(coordinates[data.u],
-                                                                coordinates[data.v],
-                                                                input_coordinate,
-                                                                point_on_segment,
-                                                                ratio);
+        const auto &data = candidate.data;
+        const auto ratio = candidate.ratio;
 
         // Find the node-based-edge that this belongs to, and directly
         // calculate the forward_weight, forward_offset, reverse_weight, reverse_offset
@@ -435,13 +447,11 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         const auto geometry_id = datafacade.GetGeometryIndex(data.forward_segment_id.id).id;
         const auto component_id = datafacade.GetComponentID(data.forward_segment_id.id);
 
-        const std::vector<EdgeWeight> forward_weight_vector =
-            datafacade.GetUncompressedForwardWeights(geometry_id);
-        const std::vector<EdgeWeight> reverse_weight_vector =
-            datafacade.GetUncompressedReverseWeights(geometry_id);
-        const std::vector<EdgeWeight> forward_duration_vector =
+        const auto forward_weight_vector = datafacade.GetUncompressedForwardWeights(geometry_id);
+        const auto reverse_weight_vector = datafacade.GetUncompressedReverseWeights(geometry_id);
+        const auto forward_duration_vector =
             datafacade.GetUncompressedForwardDurations(geometry_id);
-        const std::vector<EdgeWeight> reverse_duration_vector =
+        const auto reverse_duration_vector =
             datafacade.GetUncompressedReverseDurations(geometry_id);
 
         for (std::size_t i = 0; i < data.fwd_segment_position; i++)
@@ -465,7 +475,6 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         reverse_duration =
             reverse_duration_vector[reverse_duration_vector.size() - data.fwd_segment_position - 1];
 
-        ratio = std::min(1.0, std::max(0.0, ratio));
         if (data.forward_segment_id.id != SPECIAL_SEGMENTID)
         {
             forward_weight = static_cast<EdgeWeight>(forward_weight * ratio);
@@ -505,13 +514,41 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                                                                is_forward_valid_target,
                                                                is_reverse_valid_source,
                                                                is_reverse_valid_target,
-                                                               point_on_segment,
+                                                               candidate.location,
                                                                input_coordinate},
-                                                   current_perpendicular_distance};
+                                                   candidate.distance};
 
         return transformed;
     }
 
+  private:
+    std::vector<SegmentCandidate> MakeCandidates(const util::Coordinate input_coordinate,
+                                                 const std::vector<EdgeData> &results) const
+    {
+        std::vector<SegmentCandidate> candidates(results.size());
+        std::transform(results.begin(),
+                       results.end(),
+                       candidates.begin(),
+                       [this, &input_coordinate](const EdgeData &data) {
+                           return MakeCandidate(input_coordinate, data);
+                       });
+        return candidates;
+    }
+
+    SegmentCandidate MakeCandidate(const util::Coordinate input_coordinate,
+                                   const EdgeData &data) const
+    {
+        SegmentCandidate candidate{data, {}, 0., 0.};
+        candidate.distance =
+            util::coordinate_calculation::perpendicularDistance(coordinates[data.u],
+                                                                coordinates[data.v],
+                                                                input_coordinate,
+                                                                candidate.location,
+                                                                candidate.ratio);
+        candidate.ratio = std::min(1.0, std::max(0.0, candidate.ratio));
+        return candidate;
+    }
+
     bool CheckSegmentDistance(const Coordinate input_coordinate,
                               const CandidateSegment &segment,
                               const double max_distance) const
@@ -528,38 +565,46 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
                max_distance;
     }
 
-    std::pair<bool, bool> CheckSegmentBearing(const CandidateSegment &segment,
+    std::pair<bool, bool> CheckSegmentBearing(const EdgeData &data,
                                               const int filter_bearing,
                                               const int filter_bearing_range) const
     {
-        BOOST_ASSERT(segment.data.forward_segment_id.id != SPECIAL_SEGMENTID ||
-                     !segment.data.forward_segment_id.enabled);
-        BOOST_ASSERT(segment.data.reverse_segment_id.id != SPECIAL_SEGMENTID ||
-                     !segment.data.reverse_segment_id.enabled);
-
-        const double forward_edge_bearing = util::coordinate_calculation::bearing(
-            coordinates[segment.data.u], coordinates[segment.data.v]);
+        BOOST_ASSERT(data.forward_segment_id.id != SPECIAL_SEGMENTID ||
+                     !data.forward_segment_id.enabled);
+        BOOST_ASSERT(data.reverse_segment_id.id != SPECIAL_SEGMENTID ||
+                     !data.reverse_segment_id.enabled);
 
-        const double backward_edge_bearing = (forward_edge_bearing + 180) > 360
-                                                 ? (forward_edge_bearing - 180)
-                                                 : (forward_edge_bearing + 180);
+        // the bearing is stored rounded, CheckInBounds maps the reverse one into [0, 360)
+        const int forward_edge_bearing = data.forward_bearing;
+        const int backward_edge_bearing = forward_edge_bearing + 180;
 
         const bool forward_bearing_valid =
             util::bearing::CheckInBounds(
-                std::round(forward_edge_bearing), filter_bearing, filter_bearing_range) &&
-            segment.data.forward_segment_id.enabled;
+                forward_edge_bearing, filter_bearing, filter_bearing_range) &&
+            data.forward_segment_id.enabled;
         const bool backward_bearing_valid =
             util::bearing::CheckInBounds(
-                std::round(backward_edge_bearing), filter_bearing, filter_bearing_range) &&
-            segment.data.reverse_segment_id.enabled;
+                backward_edge_bearing, filter_bearing, filter_bearing_range) &&
+            data.reverse_segment_id.enabled;
         return std::make_pair(forward_bearing_valid, backward_bearing_valid);
     }
 
+    // Lets the rtree skip segments that are outside of the bearing range in both directions
+    // before they are queued, without looking up their coordinates or the facade
+    auto AcceptBearing(const int bearing, const int bearing_range) const
+    {
+        return [this, bearing, bearing_range](const EdgeData &data) {
+            const auto use_directions = CheckSegmentBearing(data, bearing, bearing_range);
+            return use_directions.first || use_directions.second;
+        };
+    }
+
     /**
      * Checks to see if the edge weights are valid.  We might have an edge,
      * but a traffic update might set the speed to 0 (weight == INVALID_SEGMENT_WEIGHT).
      * which means that this edge is not currently traversible.  If this is the case,
-     * then we shouldn't snap to this edge.
+     * then we shouldn't snap to this edge. Neither should we snap to edges of classes that the
+     * metric of the facade excludes.
      */
     std::pair<bool, bool> HasValidEdge(const CandidateSegment &segment) const
     {
@@ -572,22 +617,31 @@ template <typename RTreeT, typename DataFacadeT> class GeospatialQuery
         BOOST_ASSERT(data.forward_segment_id.id != SPECIAL_NODEID);
         const auto geometry_id = datafacade.GetGeometryIndex(data.forward_segment_id.id).id;
 
-        const std::vector<EdgeWeight> forward_weight_vector =
-            datafacade.GetUncompressedForwardWeights(geometry_id);
+        const auto forward_weight_vector = datafacade.GetUncompressedForwardWeights(geometry_id);
 
         if (forward_weight_vector[data.fwd_segment_position] != INVALID_SEGMENT_WEIGHT)
         {
             forward_edge_valid = data.forward_segment_id.enabled;
         }
 
-        const std::vector<EdgeWeight> reverse_weight_vector =
-            datafacade.GetUncompressedReverseWeights(geometry_id);
+        const auto reverse_weight_vector = datafacade.GetUncompressedReverseWeights(geometry_id);
         if (reverse_weight_vector[reverse_weight_vector.size() - data.fwd_segment_position - 1] !=
             INVALID_SEGMENT_WEIGHT)
         {
             reverse_edge_valid = data.reverse_segment_id.enabled;
         }
 
+        const auto excluded_classes = datafacade.GetExcludedClasses();
+        if (excluded_classes != 0)
+        {
+            forward_edge_valid = forward_edge_valid &&
+                                 (datafacade.GetClassData(data.forward_segment_id.id) &
+                                  excluded_classes) == 0;
+            reverse_edge_valid = reverse_edge_valid &&
+                                 (datafacade.GetClassData(data.reverse_segment_id.id) &
+                                  excluded_classes) == 0;
+        }
+
         return std::make_pair(forward_edge_valid, reverse_edge_valid);
     }
 
@@ -10,6 +10,9 @@
 #include "engine/phantom_node.hpp"
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
+#include "util/coordinate_distances.hpp"
+#include "util/integer_range.hpp"
+#include "util/prefetch.hpp"
 
 #include <algorithm>
 #include <utility>
@@ -23,7 +26,8 @@ namespace guidance
 {
 // Extracts the geometry for each segment and calculates the traveled distance
 // Combines the geometry form the phantom node with the PathData
-// to the full route geometry.
+// to the full route geometry. Only the requested fields are assembled, e.g. a response without
+// steps, overview and annotations only needs the segment distances.
 //
 // turn    0   1   2   3   4
 //         s...x...y...z...t
@@ -36,50 +40,98 @@ inline LegGeometry assembleGeometry(const datafacade::BaseDataFacade &facade,
                                     const PhantomNode &source_node,
                                     const PhantomNode &target_node,
                                     const bool reversed_source,
-                                    const bool reversed_target)
+                                    const bool reversed_target,
+                                    const LegGeometryFields fields)
 {
     LegGeometry geometry;
 
-    // segment 0 first and last
-    geometry.segment_offsets.push_back(0);
-    geometry.locations.push_back(source_node.location);
+    const bool needs_locations = fields & LegGeometryFields::Locations;
+    const bool needs_weights = fields & LegGeometryFields::Weights;
+    const bool needs_datasources = fields & LegGeometryFields::Datasources;
+    const auto weight_multiplier = facade.GetWeightMultiplier();
 
-    //                          u       *      v
-    //                          0 -- 1 -- 2 -- 3
-    // fwd_segment_position:  1
-    // source node fwd:       1      1 -> 2 -> 3
-    // source node rev:       2 0 <- 1 <- 2
-    const auto source_segment_start_coordinate =
-        source_node.fwd_segment_position + (reversed_source ? 1 : 0);
     const auto source_node_id =
         reversed_source ? source_node.reverse_segment_id.id : source_node.forward_segment_id.id;
-    const auto source_geometry_id = facade.GetGeometryIndex(source_node_id).id;
-    std::vector<NodeID> source_geometry = facade.GetUncompressedForwardGeometry(source_geometry_id);
+    const auto target_node_id =
+        reversed_target ? target_node.reverse_segment_id.id : target_node.forward_segment_id.id;
 
-    geometry.osm_node_ids.push_back(
-        facade.GetOSMNodeIDOfNode(source_geometry[source_segment_start_coordinate]));
+    if (needs_locations)
+    {
+        // segment 0 first and last
+        geometry.segment_offsets.push_back(0);
+        geometry.locations.push_back(source_node.location);
+
+        //                          u       *      v
+        //                          0 -- 1 -- 2 -- 3
+        // fwd_segment_position:  1
+        // source node fwd:       1      1 -> 2 -> 3
+        // source node rev:       2 0 <- 1 <- 2
+        const auto source_segment_start_coordinate =
+            source_node.fwd_segment_position + (reversed_source ? 1 : 0);
+        const auto source_geometry_id = facade.GetGeometryIndex(source_node_id).id;
+        const auto source_geometry = facade.GetUncompressedForwardGeometry(source_geometry_id);
+
+        geometry.osm_node_ids.push_back(
+            facade.GetOSMNodeIDOfNode(source_geometry[source_segment_start_coordinate]));
+    }
+
+    // the coordinates and OSM ids of the via nodes are looked up in one pass that prefetches
+    // ahead, the distances between all consecutive coordinates of the leg in one batch
+    std::vector<util::Coordinate> leg_coordinates;
+    std::vector<OSMNodeID> leg_osm_node_ids;
+    leg_coordinates.reserve(leg_data.size() + 2);
+    leg_coordinates.push_back(source_node.location);
+    if (needs_locations)
+    {
+        leg_osm_node_ids.reserve(leg_data.size());
+    }
+    for (const auto path_index : util::irange<std::size_t>(0UL, leg_data.size()))
+    {
+        if (path_index + util::ASSEMBLY_PREFETCH_DISTANCE < leg_data.size())
+        {
+            facade.PrefetchCoordinateOfNode(
+                leg_data[path_index + util::ASSEMBLY_PREFETCH_DISTANCE].turn_via_node);
+        }
+        const auto via_node = leg_data[path_index].turn_via_node;
+        leg_coordinates.push_back(facade.GetCoordinateOfNode(via_node));
+        if (needs_locations)
+        {
+            leg_osm_node_ids.push_back(facade.GetOSMNodeIDOfNode(via_node));
+        }
+    }
+    leg_coordinates.push_back(target_node.location);
+    std::vector<double> leg_distances(leg_data.size() + 1);
+    util::coordinate_calculation::haversineDistances(leg_coordinates.data(),
+                                                     leg_coordinates.data() + 1,
+                                                     leg_distances.size(),
+                                                     leg_distances.data());
 
     auto cumulative_distance = 0.;
     auto current_distance = 0.;
-    auto prev_coordinate = geometry.locations.front();
-    for (const auto &path_point : leg_data)
+    for (const auto path_index : util::irange<std::size_t>(0UL, leg_data.size()))
     {
-        auto coordinate = facade.GetCoordinateOfNode(path_point.turn_via_node);
-        current_distance =
-            util::coordinate_calculation::haversineDistance(prev_coordinate, coordinate);
+        const auto &path_point = leg_data[path_index];
+        const auto &coordinate = leg_coordinates[path_index + 1];
+        current_distance = leg_distances[path_index];
         cumulative_distance += current_distance;
 
         // all changes to this check have to be matched with assemble_steps
         if (path_point.turn_instruction.type != extractor::guidance::TurnType::NoTurn)
         {
             geometry.segment_distances.push_back(cumulative_distance);
-            geometry.segment_offsets.push_back(geometry.locations.size());
+            if (needs_locations)
+            {
+                geometry.segment_offsets.push_back(geometry.locations.size());
+            }
             cumulative_distance = 0.;
         }
 
-        prev_coordinate = coordinate;
+        if (!needs_locations)
+        {
+            continue;
+        }
 
-        const auto osm_node_id = facade.GetOSMNodeIDOfNode(path_point.turn_via_node);
+        const auto osm_node_id = leg_osm_node_ids[path_index];
         if (osm_node_id != geometry.osm_node_ids.back())
         {
             geometry.annotations.emplace_back(LegGeometry::Annotation{
@@ -92,24 +144,32 @@ inline LegGeometry assembleGeometry(const datafacade::BaseDataFacade &facade,
                 //       non-preceeding-turn segments, but contains the turn value
                 //       for segments before a turn.
                 (path_point.duration_until_turn - path_point.duration_of_turn) / 10.,
-                (path_point.weight_until_turn - path_point.weight_of_turn) /
-                    facade.GetWeightMultiplier(),
-                path_point.datasource_id});
-            geometry.locations.push_back(std::move(coordinate));
+                needs_weights
+                    ? (path_point.weight_until_turn - path_point.weight_of_turn) / weight_multiplier
+                    : 0.,
+                needs_datasources ? path_point.datasource_id : DatasourceID{0}});
+            geometry.locations.push_back(coordinate);
             geometry.osm_node_ids.push_back(osm_node_id);
         }
     }
-    current_distance =
-        util::coordinate_calculation::haversineDistance(prev_coordinate, target_node.location);
+    current_distance = leg_distances.back();
     cumulative_distance += current_distance;
     // segment leading to the target node
     geometry.segment_distances.push_back(cumulative_distance);
 
-    const auto target_node_id =
-        reversed_target ? target_node.reverse_segment_id.id : target_node.forward_segment_id.id;
+    if (!needs_locations)
+    {
+        return geometry;
+    }
+
     const auto target_geometry_id = facade.GetGeometryIndex(target_node_id).id;
-    const std::vector<DatasourceID> forward_datasources =
-        facade.GetUncompressedForwardDatasources(target_geometry_id);
+    DatasourceID target_datasource = 0;
+    if (needs_datasources)
+    {
+        const auto forward_datasources =
+            facade.GetUncompressedForwardDatasources(target_geometry_id);
+        target_datasource = forward_datasources[target_node.fwd_segment_position];
+    }
 
     // FIXME if source and target phantoms are on the same segment then duration and weight
     // will be from one projected point till end of segment
@@ -117,9 +177,11 @@ inline LegGeometry assembleGeometry(const datafacade::BaseDataFacade &facade,
     geometry.annotations.emplace_back(LegGeometry::Annotation{
         current_distance,
         (reversed_target ? target_node.reverse_duration : target_node.forward_duration) / 10.,
-        (reversed_target ? target_node.reverse_weight : target_node.forward_weight) /
-            facade.GetWeightMultiplier(),
-        forward_datasources[target_node.fwd_segment_position]});
+        needs_weights
+            ? (reversed_target ? target_node.reverse_weight : target_node.forward_weight) /
+                  weight_multiplier
+            : 0.,
+        target_datasource});
 
     geometry.segment_offsets.push_back(geometry.locations.size());
     geometry.locations.push_back(target_node.location);
@@ -131,8 +193,7 @@ inline LegGeometry assembleGeometry(const datafacade::BaseDataFacade &facade,
     // target node rev:       1       1 <- 2 <- 3
     const auto target_segment_end_coordinate =
         target_node.fwd_segment_position + (reversed_target ? 0 : 1);
-    const std::vector<NodeID> target_geometry =
-        facade.GetUncompressedForwardGeometry(target_geometry_id);
+    const auto target_geometry = facade.GetUncompressedForwardGeometry(target_geometry_id);
     geometry.osm_node_ids.push_back(
         facade.GetOSMNodeIDOfNode(target_geometry[target_segment_end_coordinate]));
 
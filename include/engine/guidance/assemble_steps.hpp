@@ -82,8 +82,8 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                           0};
 
     IntermediateIntersection intersection{source_node.location,
-                                          std::vector<short>({bearings.second}),
-                                          std::vector<bool>({true}),
+                                          {bearings.second},
+                                          {true},
                                           IntermediateIntersection::NO_INDEX,
                                           0,
                                           util::guidance::LaneTuple(),
@@ -122,11 +122,11 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                 intersection.classes = facade.GetClasses(path_point.classes);
 
                 steps.push_back(RouteStep{step_name_id,
-                                          name.to_string(),
-                                          ref.to_string(),
-                                          pronunciation.to_string(),
-                                          destinations.to_string(),
-                                          exits.to_string(),
+                                          name,
+                                          ref,
+                                          pronunciation,
+                                          destinations,
+                                          exits,
                                           NO_ROTARY_NAME,
                                           NO_ROTARY_NAME,
                                           segment_duration / 10.,
@@ -151,12 +151,10 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                 bearings = std::make_pair<std::uint16_t, std::uint16_t>(
                     path_point.pre_turn_bearing.Get(), path_point.post_turn_bearing.Get());
                 const auto bearing_class = facade.GetBearingClass(path_point.turn_via_node);
-                auto bearing_data = bearing_class.getAvailableBearings();
+                const auto &bearing_data = bearing_class.getAvailableBearings();
                 intersection.in = bearing_class.findMatchingBearing(bearings.first);
                 intersection.out = bearing_class.findMatchingBearing(bearings.second);
                 intersection.location = facade.GetCoordinateOfNode(path_point.turn_via_node);
-                intersection.bearings.clear();
-                intersection.bearings.reserve(bearing_data.size());
                 intersection.lanes = path_point.lane_data.first;
                 intersection.lane_description =
                     path_point.lane_data.second != INVALID_LANE_DESCRIPTIONID
@@ -172,9 +170,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                              (!intersection.lane_description.empty() &&
                               intersection.lanes.lanes_in_turn != 0));
 
-                std::copy(bearing_data.begin(),
-                          bearing_data.end(),
-                          std::back_inserter(intersection.bearings));
+                intersection.bearings.assign(bearing_data.begin(), bearing_data.end());
                 intersection.entry.clear();
                 for (auto idx : util::irange<std::size_t>(0, intersection.bearings.size()))
                 {
@@ -200,11 +196,11 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
         intersection.classes = facade.GetClasses(facade.GetClassData(target_node_id));
         BOOST_ASSERT(duration >= 0);
         steps.push_back(RouteStep{step_name_id,
-                                  facade.GetNameForID(step_name_id).to_string(),
-                                  facade.GetRefForID(step_name_id).to_string(),
-                                  facade.GetPronunciationForID(step_name_id).to_string(),
-                                  facade.GetDestinationsForID(step_name_id).to_string(),
-                                  facade.GetExitsForID(step_name_id).to_string(),
+                                  facade.GetNameForID(step_name_id),
+                                  facade.GetRefForID(step_name_id),
+                                  facade.GetPronunciationForID(step_name_id),
+                                  facade.GetDestinationsForID(step_name_id),
+                                  facade.GetExitsForID(step_name_id),
                                   NO_ROTARY_NAME,
                                   NO_ROTARY_NAME,
                                   duration / 10.,
@@ -242,11 +238,11 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
         const EdgeWeight duration = std::max(0, target_duration - source_duration);
 
         steps.push_back(RouteStep{source_name_id,
-                                  facade.GetNameForID(source_name_id).to_string(),
-                                  facade.GetRefForID(source_name_id).to_string(),
-                                  facade.GetPronunciationForID(source_name_id).to_string(),
-                                  facade.GetDestinationsForID(source_name_id).to_string(),
-                                  facade.GetExitsForID(source_name_id).to_string(),
+                                  facade.GetNameForID(source_name_id),
+                                  facade.GetRefForID(source_name_id),
+                                  facade.GetPronunciationForID(source_name_id),
+                                  facade.GetDestinationsForID(source_name_id),
+                                  facade.GetExitsForID(source_name_id),
                                   NO_ROTARY_NAME,
                                   NO_ROTARY_NAME,
                                   duration / 10.,
@@ -264,8 +260,8 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
 
     intersection = {
         target_node.location,
-        std::vector<short>({static_cast<short>(util::bearing::reverse(bearings.first))}),
-        std::vector<bool>({true}),
+        {static_cast<short>(util::bearing::reverse(bearings.first))},
+        {true},
         0,
         IntermediateIntersection::NO_INDEX,
         util::guidance::LaneTuple(),
@@ -282,11 +278,11 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
 
     BOOST_ASSERT(!leg_geometry.locations.empty());
     steps.push_back(RouteStep{target_name_id,
-                              facade.GetNameForID(target_name_id).to_string(),
-                              facade.GetRefForID(target_name_id).to_string(),
-                              facade.GetPronunciationForID(target_name_id).to_string(),
-                              facade.GetDestinationsForID(target_name_id).to_string(),
-                              facade.GetExitsForID(target_name_id).to_string(),
+                              facade.GetNameForID(target_name_id),
+                              facade.GetRefForID(target_name_id),
+                              facade.GetPronunciationForID(target_name_id),
+                              facade.GetDestinationsForID(target_name_id),
+                              facade.GetExitsForID(target_name_id),
                               NO_ROTARY_NAME,
                               NO_ROTARY_NAME,
                               ZERO_DURATION,
@@ -10,6 +10,7 @@
 #include <cstddef>
 
 #include <cstdlib>
+#include <type_traits>
 #include <vector>
 
 namespace osrm
@@ -19,6 +20,38 @@ namespace engine
 namespace guidance
 {
 
+// Parts of a leg geometry that are only assembled if the response uses them. Segment distances
+// are always assembled, they make up the distance of the leg.
+enum class LegGeometryFields
+{
+    None = 0,
+    // locations, segment offsets, OSM node IDs and per-coordinate distances and durations
+    Locations = 0x01,
+    // per-coordinate weights, on top of the locations
+    Weights = 0x02,
+    // per-coordinate datasources, on top of the locations
+    Datasources = 0x04,
+    All = Locations | Weights | Datasources
+};
+
+inline bool operator&(LegGeometryFields lhs, LegGeometryFields rhs)
+{
+    return static_cast<bool>(static_cast<std::underlying_type_t<LegGeometryFields>>(lhs) &
+                             static_cast<std::underlying_type_t<LegGeometryFields>>(rhs));
+}
+
+inline LegGeometryFields operator|(LegGeometryFields lhs, LegGeometryFields rhs)
+{
+    return static_cast<LegGeometryFields>(
+        static_cast<std::underlying_type_t<LegGeometryFields>>(lhs) |
+        static_cast<std::underlying_type_t<LegGeometryFields>>(rhs));
+}
+
+inline LegGeometryFields &operator|=(LegGeometryFields &lhs, LegGeometryFields rhs)
+{
+    return lhs = lhs | rhs;
+}
+
 // locations 0---1---2-...-n-1---n
 // turns     s       x      y    t
 // segment   |   0   |  1   | 2  | sentinel
@@ -6,6 +6,8 @@
 #include "util/coordinate.hpp"
 #include "util/guidance/bearing_class.hpp"
 #include "util/guidance/entry_class.hpp"
+#include "util/small_vector.hpp"
+#include "util/string_view.hpp"
 
 #include "extractor/guidance/turn_lane_types.hpp"
 #include "util/guidance/turn_lanes.hpp"
@@ -29,13 +31,14 @@ namespace guidance
 // Departure: s --> a --> b. Represents the segment s,a with location being s.
 // Arrive: a --> b --> t. The segment (b,t) is already covered by the previous segment.
 
-// A representation of intermediate intersections
+// A representation of intermediate intersections, most of them connect up to four roads
 struct IntermediateIntersection
 {
     static const constexpr std::size_t NO_INDEX = std::numeric_limits<std::size_t>::max();
+    static const constexpr std::size_t INLINE_ROADS = 4;
     util::Coordinate location;
-    std::vector<short> bearings;
-    std::vector<bool> entry;
+    util::SmallVector<short, INLINE_ROADS> bearings;
+    util::SmallVector<bool, INLINE_ROADS> entry;
     std::size_t in;
     std::size_t out;
 
@@ -57,16 +60,18 @@ inline IntermediateIntersection getInvalidIntersection()
             {}};
 }
 
+// The names of a step refer to the name data of the facade it was assembled from, they are only
+// copied when the step is rendered
 struct RouteStep
 {
     unsigned name_id;
-    std::string name;
-    std::string ref;
-    std::string pronunciation;
-    std::string destinations;
-    std::string exits;
-    std::string rotary_name;
-    std::string rotary_pronunciation;
+    util::StringView name;
+    util::StringView ref;
+    util::StringView pronunciation;
+    util::StringView destinations;
+    util::StringView exits;
+    util::StringView rotary_name;
+    util::StringView rotary_pronunciation;
     double duration; // duration in seconds
     double distance; // distance in meters
     double weight;   // weight value
@@ -75,7 +80,8 @@ struct RouteStep
     // indices into the locations array stored the LegGeometry
     std::size_t geometry_begin;
     std::size_t geometry_end;
-    std::vector<IntermediateIntersection> intersections;
+    // one per step until post-processing merges steps, mostly into two or less
+    util::SmallVector<IntermediateIntersection, 2> intersections;
 
     // remove all information from the route step, marking it as invalid (used to indicate empty
     // steps to be removed).
@@ -0,0 +1,96 @@
+#ifndef OSRM_ENGINE_HEAP_POOL_HPP
+#define OSRM_ENGINE_HEAP_POOL_HPP
+
+#include "util/log.hpp"
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Hands out heap sets to queries for as long as they run, independent of the thread they run
+// on. Released sets are kept for the next query, but at most max_idle of them: a burst of
+// concurrent queries does not pin its memory forever. The heaps of a set are created lazily by
+// the query and are reused cleared afterwards.
+template <typename HeapSet> class HeapPool
+{
+  public:
+    struct Statistics
+    {
+        // heap sets currently leased to queries
+        std::size_t leased;
+        // the most heap sets that were leased at the same time
+        std::size_t high_water_mark;
+        // heap sets kept for reuse
+        std::size_t idle;
+        // heap sets handed out that were not reused
+        std::size_t created;
+    };
+
+    explicit HeapPool(const boost::optional<std::size_t> max_idle = boost::none)
+        : max_idle(max_idle)
+    {
+    }
+
+    HeapPool(const HeapPool &) = delete;
+    HeapPool &operator=(const HeapPool &) = delete;
+
+    ~HeapPool()
+    {
+        util::Log(logDEBUG) << "Heap pool: " << statistics.created << " heap sets created, "
+                            << statistics.high_water_mark << " leased at most at once";
+    }
+
+    HeapSet Acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        statistics.leased++;
+        statistics.high_water_mark = std::max(statistics.high_water_mark, statistics.leased);
+        if (idle.empty())
+        {
+            statistics.created++;
+            return HeapSet{};
+        }
+        auto heaps = std::move(idle.back());
+        idle.pop_back();
+        return heaps;
+    }
+
+    void Release(HeapSet heaps)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        statistics.leased--;
+        if (!max_idle || idle.size() < *max_idle)
+        {
+            idle.push_back(std::move(heaps));
+        }
+        // otherwise the heaps are freed outside of the lock
+    }
+
+    Statistics GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto result = statistics;
+        result.idle = idle.size();
+        return result;
+    }
+
+  private:
+    const boost::optional<std::size_t> max_idle;
+
+    mutable std::mutex mutex;
+    std::vector<HeapSet> idle;
+    Statistics statistics{0, 0, 0, 0};
+};
+}
+}
+
+#endif
@@ -32,6 +32,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "util/coordinate.hpp"
 
+#include <boost/optional.hpp>
+
 #include <cstdint>
 #include <iosfwd>
 #include <string>
@@ -53,12 +55,21 @@ struct Hint
     PhantomNode phantom;
     std::uint32_t data_checksum;
 
+    // Checks that the hint was made for this coordinate and dataset and that its segments exist
+    // in the facade. Only a constant number of facade lookups is needed, a valid hint replaces
+    // the snapping of the coordinate.
     bool IsValid(const util::Coordinate new_input_coordinates,
                  const datafacade::BaseDataFacade &facade) const;
 
     std::string ToBase64() const;
     static Hint FromBase64(const std::string &base64Hint);
 
+    // Variable length encoding with the COMPACT_HINT_PREFIX, the fields are stored as varints
+    // and the input coordinate relative to the snapped one. Usually less than half the size of
+    // ToBase64(). Returns none for malformed input.
+    std::string ToCompactBase64() const;
+    static boost::optional<Hint> FromCompactBase64(const std::string &base64Hint);
+
     friend bool operator==(const Hint &, const Hint &);
     friend std::ostream &operator<<(std::ostream &, const Hint &);
 };
@@ -67,6 +78,8 @@ static_assert(sizeof(Hint) == 64 + 4, "Hint is bigger than expected");
 constexpr std::size_t ENCODED_HINT_SIZE = 92;
 static_assert(ENCODED_HINT_SIZE / 4 * 3 >= sizeof(Hint),
               "ENCODED_HINT_SIZE does not match size of Hint");
+// Distinguishes compact hints from the fixed size ones, can not appear in base64
+constexpr char COMPACT_HINT_PREFIX = '.';
 }
 }
 
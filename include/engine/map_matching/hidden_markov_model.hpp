@@ -2,13 +2,17 @@
 #define HIDDEN_MARKOV_MODEL
 
 #include "util/integer_range.hpp"
+#include "util/vector_view.hpp"
 
 #include <boost/assert.hpp>
 #include <boost/math/constants/constants.hpp>
 
+#include <algorithm>
 #include <cmath>
-
+#include <cstddef>
+#include <cstdint>
 #include <limits>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -37,6 +41,16 @@ struct EmissionLogProbability
     {
         return -0.5 * (log_2_pi + (distance / sigma_z) * (distance / sigma_z)) - log_sigma_z;
     }
+
+    // The probabilities of a batch of distances at once, in place. A plain loop over contiguous
+    // values that the compiler vectorizes, with the same results as one distance at a time.
+    void operator()(double *first, double *last) const
+    {
+        for (; first != last; ++first)
+        {
+            *first = -0.5 * (log_2_pi + (*first / sigma_z) * (*first / sigma_z)) - log_sigma_z;
+        }
+    }
 };
 
 struct TransitionLogProbability
@@ -50,75 +64,98 @@ struct TransitionLogProbability
 
 template <class CandidateLists> struct HiddenMarkovModel
 {
-    std::vector<std::vector<double>> viterbi;
-    std::vector<std::vector<bool>> viterbi_reachable;
-    std::vector<std::vector<std::pair<unsigned, unsigned>>> parents;
-    std::vector<std::vector<float>> path_distances;
-    std::vector<std::vector<bool>> pruned;
-    std::vector<bool> breakage;
-
-    const CandidateLists &candidates_list;
-    const std::vector<std::vector<double>> &emission_log_probabilities;
-
-    HiddenMarkovModel(const CandidateLists &candidates_list,
-                      const std::vector<std::vector<double>> &emission_log_probabilities)
-        : breakage(candidates_list.size()), candidates_list(candidates_list),
-          emission_log_probabilities(emission_log_probabilities)
+    // The states of all timestamps, one array per field. The candidates of timestamp t are the
+    // entries offsets[t] to offsets[t + 1]. Reset() sizes the arrays for a trace without giving
+    // their memory back, a model that lives as long as its thread matches one trace after the
+    // other without allocating.
+    std::vector<std::size_t> offsets;
+    std::vector<double> emission_log_probabilities;
+    std::vector<double> viterbi;
+    std::vector<std::uint8_t> viterbi_reachable;
+    std::vector<std::pair<unsigned, unsigned>> parents;
+    std::vector<float> path_distances;
+    std::vector<std::uint8_t> pruned;
+    std::vector<std::uint8_t> breakage;
+
+    void Reset(const CandidateLists &candidates_list)
     {
-        viterbi.resize(candidates_list.size());
-        viterbi_reachable.resize(candidates_list.size());
-        parents.resize(candidates_list.size());
-        path_distances.resize(candidates_list.size());
-        pruned.resize(candidates_list.size());
-        breakage.resize(candidates_list.size());
-        for (const auto i : util::irange<std::size_t>(0UL, candidates_list.size()))
+        const auto num_timestamps = candidates_list.size();
+        offsets.resize(num_timestamps + 1);
+        offsets[0] = 0;
+        for (const auto t : util::irange<std::size_t>(0UL, num_timestamps))
         {
-            const auto &num_candidates = candidates_list[i].size();
-            // add empty vectors
-            if (num_candidates > 0)
-            {
-                viterbi[i].resize(num_candidates);
-                viterbi_reachable[i].resize(num_candidates);
-                parents[i].resize(num_candidates);
-                path_distances[i].resize(num_candidates);
-                pruned[i].resize(num_candidates);
-            }
+            offsets[t + 1] = offsets[t] + candidates_list[t].size();
         }
 
+        const auto num_states = offsets.back();
+        emission_log_probabilities.resize(num_states);
+        viterbi.resize(num_states);
+        viterbi_reachable.resize(num_states);
+        parents.resize(num_states);
+        path_distances.resize(num_states);
+        pruned.resize(num_states);
+        breakage.resize(num_timestamps);
+
         Clear(0);
     }
 
-    void Clear(std::size_t initial_timestamp)
+    std::size_t NumberOfTimestamps() const { return breakage.size(); }
+
+    std::size_t NumberOfCandidates(const std::size_t t) const
     {
-        BOOST_ASSERT(viterbi.size() == parents.size() && parents.size() == path_distances.size() &&
-                     path_distances.size() == pruned.size() && pruned.size() == breakage.size());
+        return offsets[t + 1] - offsets[t];
+    }
 
-        for (const auto t : util::irange(initial_timestamp, viterbi.size()))
-        {
-            std::fill(viterbi[t].begin(), viterbi[t].end(), IMPOSSIBLE_LOG_PROB);
-            std::fill(viterbi_reachable[t].begin(), viterbi_reachable[t].end(), false);
-            std::fill(parents[t].begin(), parents[t].end(), std::make_pair(0u, 0u));
-            std::fill(path_distances[t].begin(), path_distances[t].end(), 0);
-            std::fill(pruned[t].begin(), pruned[t].end(), true);
-        }
+    // Index of candidate s of timestamp t in the arrays
+    std::size_t State(const std::size_t t, const std::size_t s) const
+    {
+        BOOST_ASSERT(s < NumberOfCandidates(t));
+        return offsets[t] + s;
+    }
+
+    // The states of the candidates of timestamp t
+    template <typename T> util::vector_view<T> States(std::vector<T> &field, const std::size_t t)
+    {
+        BOOST_ASSERT(field.size() == offsets.back());
+        return util::vector_view<T>(field.data() + offsets[t], NumberOfCandidates(t));
+    }
+
+    auto Emissions(const std::size_t t) { return States(emission_log_probabilities, t); }
+    auto Viterbi(const std::size_t t) { return States(viterbi, t); }
+    auto ViterbiReachable(const std::size_t t) { return States(viterbi_reachable, t); }
+    auto Parents(const std::size_t t) { return States(parents, t); }
+    auto PathDistances(const std::size_t t) { return States(path_distances, t); }
+    auto Pruned(const std::size_t t) { return States(pruned, t); }
+
+    // Resets all states from the initial timestamp on, the emissions are kept
+    void Clear(std::size_t initial_timestamp)
+    {
+        BOOST_ASSERT(initial_timestamp < offsets.size());
+        const auto first = offsets[initial_timestamp];
+        std::fill(viterbi.begin() + first, viterbi.end(), IMPOSSIBLE_LOG_PROB);
+        std::fill(viterbi_reachable.begin() + first, viterbi_reachable.end(), false);
+        std::fill(parents.begin() + first, parents.end(), std::make_pair(0u, 0u));
+        std::fill(path_distances.begin() + first, path_distances.end(), 0);
+        std::fill(pruned.begin() + first, pruned.end(), true);
         std::fill(breakage.begin() + initial_timestamp, breakage.end(), true);
     }
 
     std::size_t initialize(std::size_t initial_timestamp)
     {
-        auto num_points = candidates_list.size();
+        const auto num_points = NumberOfTimestamps();
         do
         {
             BOOST_ASSERT(initial_timestamp < num_points);
 
-            for (const auto s : util::irange<std::size_t>(0UL, viterbi[initial_timestamp].size()))
+            for (const auto state : util::irange(offsets[initial_timestamp],
+                                                 offsets[initial_timestamp + 1]))
             {
-                viterbi[initial_timestamp][s] = emission_log_probabilities[initial_timestamp][s];
-                parents[initial_timestamp][s] = std::make_pair(initial_timestamp, s);
-                pruned[initial_timestamp][s] = viterbi[initial_timestamp][s] < MINIMAL_LOG_PROB;
+                const auto s = state - offsets[initial_timestamp];
+                viterbi[state] = emission_log_probabilities[state];
+                parents[state] = std::make_pair(initial_timestamp, s);
+                pruned[state] = viterbi[state] < MINIMAL_LOG_PROB;
 
-                breakage[initial_timestamp] =
-                    breakage[initial_timestamp] && pruned[initial_timestamp][s];
+                breakage[initial_timestamp] = breakage[initial_timestamp] && pruned[state];
             }
 
             ++initial_timestamp;
@@ -0,0 +1,48 @@
+#ifndef ENGINE_MAP_MATCHING_MATCHING_SESSION_HPP
+#define ENGINE_MAP_MATCHING_MATCHING_SESSION_HPP
+
+#include "engine/phantom_node.hpp"
+#include "util/coordinate.hpp"
+
+#include <boost/optional.hpp>
+
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace map_matching
+{
+
+// The index of the frontier a request started from in the matching of the request
+static const constexpr unsigned FRONTIER_INDEX = std::numeric_limits<unsigned>::max();
+
+// A trace that is matched one request at a time, e.g. the pings of a vehicle. Between requests
+// only the frontier of the Viterbi sweep is kept: the candidates of the last matched coordinate
+// and the log probabilities of the best paths that end in them. A request extends the sweep by
+// its coordinates, so its cost does not grow with the length of the trace.
+struct MatchingSession
+{
+    // empty before the first coordinate was matched
+    std::vector<PhantomNodeWithDistance> candidates;
+    // relative to the most probable candidate, which has 0
+    std::vector<double> viterbi;
+    util::Coordinate coordinate;
+    boost::optional<unsigned> timestamp;
+
+    // the time between the last matched coordinates, their median is the sample time that
+    // decides which time gaps split the trace
+    std::deque<unsigned> sample_times;
+    // coordinates after the frontier that could not be matched
+    unsigned broken_steps = 0;
+
+    bool Empty() const { return candidates.empty(); }
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef OSRM_ENGINE_MATCHING_SESSIONS_HPP
+#define OSRM_ENGINE_MATCHING_SESSIONS_HPP
+
+#include "engine/dataset_generation.hpp"
+#include "engine/map_matching/matching_session.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace osrm
+{
+namespace engine
+{
+
+// The matching sessions of the match requests of an engine, by the id the client picked.
+//
+// A session expires once it was not used for the time to live, and if there are more than
+// capacity sessions the one used least recently is dropped. The frontier of a session holds
+// phantom nodes of the dataset it was matched on, once a request runs on a new dataset all
+// sessions are dropped.
+class MatchingSessions
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Requests of a session lock its mutex while they match, so they extend it one after another
+    struct Session
+    {
+        std::mutex mutex;
+        map_matching::MatchingSession state;
+    };
+
+    MatchingSessions(const std::size_t capacity, const std::chrono::seconds time_to_live);
+
+    // The session with the id, a new one if there is none on the dataset or it expired.
+    // dataset is any pointer that shares ownership with the facade of the request.
+    std::shared_ptr<Session> Get(const std::string &id,
+                                 const std::shared_ptr<const void> &dataset,
+                                 const Clock::time_point now = Clock::now());
+
+    std::size_t Size() const;
+
+  private:
+    struct Entry
+    {
+        std::string id;
+        std::shared_ptr<Session> session;
+        Clock::time_point last_used;
+    };
+
+    const std::size_t capacity;
+    const std::chrono::seconds time_to_live;
+
+    DatasetGeneration generation;
+    mutable std::mutex mutex;
+    // most recently used first, the expired sessions are at the end
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+};
+}
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef OSRM_ENGINE_MEETING_LABELS_HPP
+#define OSRM_ENGINE_MEETING_LABELS_HPP
+
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace osrm
+{
+namespace engine
+{
+
+// The weights with which the forward and the reverse search of a bidirectional search that runs
+// on two threads reached the nodes, and the best path they found so far. Each search only writes
+// the labels of its own direction and reads the ones of the other, so neither thread has to look
+// into the heap of the other one.
+//
+// A search first stores its label of a node and then reads the label of the other direction.
+// Both are sequentially consistent, so of two searches that reach the same node at least one
+// sees the label of the other and records the path over it.
+//
+// The labels are tagged with a generation instead of being reset for every search, only when
+// the generations wrap around all labels are cleared.
+class MeetingLabels
+{
+  public:
+    explicit MeetingLabels(const unsigned number_of_nodes)
+        : number_of_nodes(number_of_nodes),
+          labels(std::make_unique<std::atomic<std::uint64_t>[]>(std::size_t{number_of_nodes} * 2))
+    {
+        for (std::size_t index = 0; index < std::size_t{number_of_nodes} * 2; ++index)
+        {
+            labels[index].store(0, std::memory_order_relaxed);
+        }
+        best_path.store(Pack(INVALID_EDGE_WEIGHT, SPECIAL_NODEID), std::memory_order_relaxed);
+    }
+
+    MeetingLabels(const MeetingLabels &) = delete;
+    MeetingLabels &operator=(const MeetingLabels &) = delete;
+
+    unsigned MaxID() const { return number_of_nodes; }
+
+    // Forgets all labels and paths of the previous search, must not run concurrently to it
+    void Clear(const EdgeWeight weight_upper_bound = INVALID_EDGE_WEIGHT)
+    {
+        BOOST_ASSERT(weight_upper_bound >= 0);
+        if (++generation == 0)
+        {
+            for (std::size_t index = 0; index < std::size_t{number_of_nodes} * 2; ++index)
+            {
+                labels[index].store(0, std::memory_order_relaxed);
+            }
+            generation = 1;
+        }
+        best_path.store(Pack(weight_upper_bound, SPECIAL_NODEID), std::memory_order_relaxed);
+    }
+
+    // Labels the node in the direction and records the path over it if the other direction
+    // labeled it as well
+    void Label(const bool direction, const NodeID node, const EdgeWeight weight)
+    {
+        BOOST_ASSERT(node < number_of_nodes);
+        labels[std::size_t{node} * 2 + direction].store(Pack(generation, weight));
+
+        const auto other = labels[std::size_t{node} * 2 + !direction].load();
+        if (static_cast<std::uint32_t>(other >> 32) == generation)
+        {
+            const auto path_weight = std::int64_t{weight} + Unpack(other);
+            // paths of negative weight leave the source segment behind its offset
+            if (path_weight >= 0 && path_weight < INVALID_EDGE_WEIGHT)
+            {
+                Improve(static_cast<EdgeWeight>(path_weight), node);
+            }
+        }
+    }
+
+    // INVALID_EDGE_WEIGHT if the direction did not reach the node
+    EdgeWeight GetLabel(const bool direction, const NodeID node) const
+    {
+        BOOST_ASSERT(node < number_of_nodes);
+        const auto label = labels[std::size_t{node} * 2 + direction].load();
+        return static_cast<std::uint32_t>(label >> 32) == generation ? Unpack(label)
+                                                                     : INVALID_EDGE_WEIGHT;
+    }
+
+    EdgeWeight GetBestWeight() const { return static_cast<EdgeWeight>(best_path.load() >> 32); }
+
+    // SPECIAL_NODEID if no path was found
+    NodeID GetBestMiddle() const { return static_cast<NodeID>(best_path.load()); }
+
+  private:
+    static std::uint64_t Pack(const std::uint32_t high, const EdgeWeight low)
+    {
+        return (std::uint64_t{high} << 32) | static_cast<std::uint32_t>(low);
+    }
+
+    static EdgeWeight Unpack(const std::uint64_t label)
+    {
+        return static_cast<EdgeWeight>(static_cast<std::uint32_t>(label));
+    }
+
+    // Only strictly lighter paths replace the best one, like in the sequential search
+    void Improve(const EdgeWeight weight, const NodeID middle)
+    {
+        const auto path = Pack(weight, static_cast<EdgeWeight>(middle));
+        auto best = best_path.load();
+        while (weight < static_cast<EdgeWeight>(best >> 32) &&
+               !best_path.compare_exchange_weak(best, path))
+        {
+        }
+    }
+
+    unsigned number_of_nodes;
+    // (forward, reverse) of every node, the generation in the upper and the weight in the lower
+    // half
+    std::unique_ptr<std::atomic<std::uint64_t>[]> labels;
+    // the weight in the upper and the middle node in the lower half
+    std::atomic<std::uint64_t> best_path;
+    std::uint32_t generation = 1;
+};
+}
+}
+
+#endif
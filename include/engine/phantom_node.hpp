@@ -28,6 +28,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef PHANTOM_NODES_H
 #define PHANTOM_NODES_H
 
+#include "extractor/edge_based_node_segment.hpp"
 #include "extractor/travel_mode.hpp"
 #include "util/typedefs.hpp"
 
@@ -186,6 +187,18 @@ struct PhantomNodeWithDistance
     double distance;
 };
 
+// A segment found by a nearest neighbour query and its point closest to the input coordinate,
+// before the PhantomNode is built. Building a PhantomNode reads the weights and durations of the
+// whole geometry, plugins that drop most candidates or only report their location build them
+// with BaseDataFacade::MakePhantomNode for the candidates they keep.
+struct SegmentCandidate
+{
+    extractor::EdgeBasedNodeSegment data;
+    util::Coordinate location;
+    double ratio;    // position of location on the segment from u to v, in [0, 1]
+    double distance; // in meters from the input coordinate
+};
+
 struct PhantomNodes
 {
     PhantomNode source_phantom;
@@ -0,0 +1,61 @@
+#ifndef ISOCHRONE_HPP
+#define ISOCHRONE_HPP
+
+#include "engine/api/isochrone_parameters.hpp"
+#include "engine/plugins/plugin_base.hpp"
+#include "engine/routing_algorithms.hpp"
+#include "engine/snapping_cache.hpp"
+
+#include "util/json_container.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * This plugin returns what can be reached from a coordinate within the durations of a list of
+ * contours, either as the areas within each contour or as the road segments split at the
+ * contours. The result is GeoJSON or, for a tile, a Mapbox Vector tile with a single layer.
+ */
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+class IsochronePlugin final : public BasePlugin
+{
+  public:
+    // Contours of more than max_isochrone_duration seconds (-1 for unlimited) are rejected. The
+    // coordinate is looked up in the snapping cache first if there is one.
+    IsochronePlugin(const int max_isochrone_duration,
+                    std::shared_ptr<SnappingCache> snapping_cache);
+
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::IsochroneParameters &params,
+                         util::json::Object &result) const;
+
+    // Encodes the vector tile of params.tile, errors are rendered as JSON into the buffer
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::IsochroneParameters &params,
+                         std::string &pbf_buffer) const;
+
+  private:
+    // Snaps the coordinate and searches everything within the last contour, errors go into the
+    // result
+    template <typename ResultT>
+    Status Search(const RoutingAlgorithmsInterface &algorithms,
+                  const api::IsochroneParameters &params,
+                  ResultT &result,
+                  PhantomNode &source,
+                  std::vector<routing_algorithms::ReachedNode> &reached) const;
+
+    const int max_isochrone_duration;
+    const std::shared_ptr<SnappingCache> snapping_cache;
+};
+}
+}
+}
+
+#endif // ISOCHRONE_HPP
@@ -2,11 +2,13 @@
 #define MATCH_HPP
 
 #include "engine/api/match_parameters.hpp"
+#include "engine/matching_sessions.hpp"
 #include "engine/plugins/plugin_base.hpp"
 #include "engine/routing_algorithms.hpp"
 
 #include "util/json_util.hpp"
 
+#include <memory>
 #include <vector>
 
 namespace osrm
@@ -24,8 +26,14 @@ class MatchPlugin : public BasePlugin
     using CandidateLists = routing_algorithms::CandidateLists;
     static const constexpr double RADIUS_MULTIPLIER = 3;
 
-    MatchPlugin(const int max_locations_map_matching)
-        : max_locations_map_matching(max_locations_map_matching)
+    // Traces with at least min_parallel_match_size coordinates (-1 for never) match the parts
+    // between their time gaps in parallel. Requests with a session id extend the traces kept in
+    // sessions, nullptr disables them.
+    MatchPlugin(const int max_locations_map_matching,
+                const int min_parallel_match_size,
+                std::shared_ptr<MatchingSessions> sessions)
+        : max_locations_map_matching(max_locations_map_matching),
+          min_parallel_match_size(min_parallel_match_size), sessions(std::move(sessions))
     {
     }
 
@@ -34,7 +42,20 @@ class MatchPlugin : public BasePlugin
                          util::json::Object &json_result) const;
 
   private:
+    Status HandleSessionRequest(const RoutingAlgorithmsInterface &algorithms,
+                                const api::MatchParameters &parameters,
+                                util::json::Object &json_result) const;
+
+    CandidateLists GetCandidateLists(const datafacade::BaseDataFacade &facade,
+                                     const api::MatchParameters &parameters) const;
+
+    std::vector<InternalRouteResult>
+    RouteSubMatchings(const RoutingAlgorithmsInterface &algorithms,
+                      const SubMatchingList &sub_matchings) const;
+
     const int max_locations_map_matching;
+    const int min_parallel_match_size;
+    const std::shared_ptr<MatchingSessions> sessions;
 };
 }
 }
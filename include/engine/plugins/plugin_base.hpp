@@ -2,14 +2,21 @@
 #define BASE_PLUGIN_HPP
 
 #include "engine/api/base_parameters.hpp"
+#include "engine/api/table_matrices.hpp"
+#include "engine/api/table_writer.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
 #include "engine/phantom_node.hpp"
+#include "engine/snapping_cache.hpp"
 #include "engine/status.hpp"
 
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
+#include "util/hilbert_value.hpp"
 #include "util/integer_range.hpp"
 #include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+
+#include <boost/optional.hpp>
 
 #include <algorithm>
 #include <iterator>
@@ -45,6 +52,43 @@ class BasePlugin
         return Status::Error;
     }
 
+    Status Error(const std::string &code,
+                 const std::string &message,
+                 std::vector<char> &rendered_result) const
+    {
+        util::json::Object json_result;
+        Error(code, message, json_result);
+        util::json::render(rendered_result, json_result);
+        return Status::Error;
+    }
+
+    Status Error(const std::string &code,
+                 const std::string &message,
+                 api::TableMatrices &matrices) const
+    {
+        matrices = api::TableMatrices{};
+        return Error(code, message, matrices.response);
+    }
+
+    Status Error(const std::string &code,
+                 const std::string &message,
+                 api::TableWriter &writer) const
+    {
+        writer.error.clear();
+        return Error(code, message, writer.error);
+    }
+
+    // for services that answer with a binary buffer but report errors as JSON
+    Status Error(const std::string &code,
+                 const std::string &message,
+                 std::string &rendered_result) const
+    {
+        std::vector<char> rendered;
+        Error(code, message, rendered);
+        rendered_result.assign(rendered.begin(), rendered.end());
+        return Status::Error;
+    }
+
     // Decides whether to use the phantom node from a big or small component if both are found.
     // Returns true if all phantom nodes are in the same component after snapping.
     std::vector<PhantomNode>
@@ -108,133 +152,95 @@ class BasePlugin
         return snapped_phantoms;
     }
 
-    // Falls back to default_radius for non-set radii
-    std::vector<std::vector<PhantomNodeWithDistance>>
-    GetPhantomNodesInRange(const datafacade::BaseDataFacade &facade,
-                           const api::BaseParameters &parameters,
-                           const std::vector<double> radiuses) const
+    // The phantom node of the hint of a coordinate if it has a valid one, nearest queries for the
+    // coordinate can be skipped then
+    boost::optional<PhantomNodeWithDistance>
+    GetHintedPhantomNode(const datafacade::BaseDataFacade &facade,
+                         const api::BaseParameters &parameters,
+                         const std::size_t index) const
     {
-        std::vector<std::vector<PhantomNodeWithDistance>> phantom_nodes(
-            parameters.coordinates.size());
-        BOOST_ASSERT(radiuses.size() == parameters.coordinates.size());
-
-        const bool use_hints = !parameters.hints.empty();
-        const bool use_bearings = !parameters.bearings.empty();
-        const bool use_approaches = !parameters.approaches.empty();
-
-        for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
+        if (parameters.hints.empty() || !parameters.hints[index] ||
+            !parameters.hints[index]->IsValid(parameters.coordinates[index], facade))
         {
-            Approach approach = engine::Approach::UNRESTRICTED;
-            if (use_approaches && parameters.approaches[i])
-                approach = parameters.approaches[i].get();
-
-            if (use_hints && parameters.hints[i] &&
-                parameters.hints[i]->IsValid(parameters.coordinates[i], facade))
-            {
-                phantom_nodes[i].push_back(PhantomNodeWithDistance{
-                    parameters.hints[i]->phantom,
-                    util::coordinate_calculation::haversineDistance(
-                        parameters.coordinates[i], parameters.hints[i]->phantom.location),
-                });
-                continue;
-            }
-            if (use_bearings && parameters.bearings[i])
-            {
-                phantom_nodes[i] =
-                    facade.NearestPhantomNodesInRange(parameters.coordinates[i],
-                                                      radiuses[i],
-                                                      parameters.bearings[i]->bearing,
-                                                      parameters.bearings[i]->range,
-                                                      approach);
-            }
-            else
-            {
-                phantom_nodes[i] = facade.NearestPhantomNodesInRange(
-                    parameters.coordinates[i], radiuses[i], approach);
-            }
+            return boost::none;
         }
 
-        return phantom_nodes;
+        return PhantomNodeWithDistance{
+            parameters.hints[index]->phantom,
+            util::coordinate_calculation::haversineDistance(
+                parameters.coordinates[index], parameters.hints[index]->phantom.location),
+        };
     }
 
-    std::vector<std::vector<PhantomNodeWithDistance>>
-    GetPhantomNodes(const datafacade::BaseDataFacade &facade,
-                    const api::BaseParameters &parameters,
-                    unsigned number_of_results) const
+    // The segments within radius of a coordinate that match its bearing and approach, their
+    // phantom nodes are built with BaseDataFacade::MakePhantomNode. Ignores hints.
+    std::vector<SegmentCandidate> GetCandidatesInRange(const datafacade::BaseDataFacade &facade,
+                                                       const api::BaseParameters &parameters,
+                                                       const std::size_t index,
+                                                       const double radius) const
     {
-        std::vector<std::vector<PhantomNodeWithDistance>> phantom_nodes(
-            parameters.coordinates.size());
+        Approach approach = engine::Approach::UNRESTRICTED;
+        if (!parameters.approaches.empty() && parameters.approaches[index])
+            approach = parameters.approaches[index].get();
 
-        const bool use_hints = !parameters.hints.empty();
-        const bool use_bearings = !parameters.bearings.empty();
-        const bool use_radiuses = !parameters.radiuses.empty();
-        const bool use_approaches = !parameters.approaches.empty();
+        if (!parameters.bearings.empty() && parameters.bearings[index])
+        {
+            return facade.NearestCandidatesInRange(parameters.coordinates[index],
+                                                   radius,
+                                                   parameters.bearings[index]->bearing,
+                                                   parameters.bearings[index]->range,
+                                                   approach);
+        }
+        return facade.NearestCandidatesInRange(parameters.coordinates[index], radius, approach);
+    }
 
+    // The number_of_results nearest segments of a coordinate that match its radius, bearing and
+    // approach, see GetCandidatesInRange
+    std::vector<SegmentCandidate> GetCandidates(const datafacade::BaseDataFacade &facade,
+                                                const api::BaseParameters &parameters,
+                                                const std::size_t index,
+                                                const unsigned number_of_results) const
+    {
         BOOST_ASSERT(parameters.IsValid());
-        for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
-        {
-            Approach approach = engine::Approach::UNRESTRICTED;
-            if (use_approaches && parameters.approaches[i])
-                approach = parameters.approaches[i].get();
 
-            if (use_hints && parameters.hints[i] &&
-                parameters.hints[i]->IsValid(parameters.coordinates[i], facade))
-            {
-                phantom_nodes[i].push_back(PhantomNodeWithDistance{
-                    parameters.hints[i]->phantom,
-                    util::coordinate_calculation::haversineDistance(
-                        parameters.coordinates[i], parameters.hints[i]->phantom.location),
-                });
-                continue;
-            }
+        Approach approach = engine::Approach::UNRESTRICTED;
+        if (!parameters.approaches.empty() && parameters.approaches[index])
+            approach = parameters.approaches[index].get();
 
-            if (use_bearings && parameters.bearings[i])
-            {
-                if (use_radiuses && parameters.radiuses[i])
-                {
-                    phantom_nodes[i] = facade.NearestPhantomNodes(parameters.coordinates[i],
-                                                                  number_of_results,
-                                                                  *parameters.radiuses[i],
-                                                                  parameters.bearings[i]->bearing,
-                                                                  parameters.bearings[i]->range,
-                                                                  approach);
-                }
-                else
-                {
-                    phantom_nodes[i] = facade.NearestPhantomNodes(parameters.coordinates[i],
-                                                                  number_of_results,
-                                                                  parameters.bearings[i]->bearing,
-                                                                  parameters.bearings[i]->range,
-                                                                  approach);
-                }
-            }
-            else
+        const auto &coordinate = parameters.coordinates[index];
+        const bool use_radius = !parameters.radiuses.empty() && parameters.radiuses[index];
+        if (!parameters.bearings.empty() && parameters.bearings[index])
+        {
+            const auto &bearing = *parameters.bearings[index];
+            if (use_radius)
             {
-                if (use_radiuses && parameters.radiuses[i])
-                {
-                    phantom_nodes[i] = facade.NearestPhantomNodes(parameters.coordinates[i],
-                                                                  number_of_results,
-                                                                  *parameters.radiuses[i],
-                                                                  approach);
-                }
-                else
-                {
-                    phantom_nodes[i] = facade.NearestPhantomNodes(
-                        parameters.coordinates[i], number_of_results, approach);
-                }
+                return facade.NearestCandidates(coordinate,
+                                                number_of_results,
+                                                *parameters.radiuses[index],
+                                                bearing.bearing,
+                                                bearing.range,
+                                                approach);
             }
+            return facade.NearestCandidates(
+                coordinate, number_of_results, bearing.bearing, bearing.range, approach);
+        }
 
-            // we didn't find a fitting node, return error
-            if (phantom_nodes[i].empty())
-            {
-                break;
-            }
+        if (use_radius)
+        {
+            return facade.NearestCandidates(
+                coordinate, number_of_results, *parameters.radiuses[index], approach);
         }
-        return phantom_nodes;
+        return facade.NearestCandidates(coordinate, number_of_results, approach);
     }
 
-    std::vector<PhantomNodePair> GetPhantomNodes(const datafacade::BaseDataFacade &facade,
-                                                 const api::BaseParameters &parameters) const
+    // Snaps every coordinate to the nearest segment and the nearest segment of a big component,
+    // repeated coordinates are looked up in the snapping cache if there is one. The coordinates
+    // are snapped in Hilbert order, searches for nearby coordinates follow each other and find
+    // the tree nodes and leaves they share in cache.
+    std::vector<PhantomNodePair>
+    GetPhantomNodes(const datafacade::BaseDataFacade &facade,
+                    const api::BaseParameters &parameters,
+                    const SnappingCache::Handle &snapping_cache = SnappingCache::Handle{}) const
     {
         std::vector<PhantomNodePair> phantom_node_pairs(parameters.coordinates.size());
 
@@ -244,7 +250,7 @@ class BasePlugin
         const bool use_approaches = !parameters.approaches.empty();
 
         BOOST_ASSERT(parameters.IsValid());
-        for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
+        for (const auto i : util::GetHilbertOrder(parameters.coordinates))
         {
             Approach approach = engine::Approach::UNRESTRICTED;
             if (use_approaches && parameters.approaches[i])
@@ -258,35 +264,44 @@ class BasePlugin
                 continue;
             }
 
-            if (use_bearings && parameters.bearings[i])
+            const auto bearing =
+                use_bearings ? parameters.bearings[i] : boost::optional<Bearing>{};
+            const auto radius = use_radiuses ? parameters.radiuses[i] : boost::optional<double>{};
+            boost::optional<PhantomNodePair> cached;
+            if (snapping_cache)
             {
-                if (use_radiuses && parameters.radiuses[i])
+                cached = snapping_cache.Get(parameters.coordinates[i], radius, bearing, approach);
+            }
+            if (cached)
+            {
+                phantom_node_pairs[i] = *cached;
+            }
+            else if (bearing)
+            {
+                if (radius)
                 {
                     phantom_node_pairs[i] =
                         facade.NearestPhantomNodeWithAlternativeFromBigComponent(
                             parameters.coordinates[i],
-                            *parameters.radiuses[i],
-                            parameters.bearings[i]->bearing,
-                            parameters.bearings[i]->range,
+                            *radius,
+                            bearing->bearing,
+                            bearing->range,
                             approach);
                 }
                 else
                 {
                     phantom_node_pairs[i] =
                         facade.NearestPhantomNodeWithAlternativeFromBigComponent(
-                            parameters.coordinates[i],
-                            parameters.bearings[i]->bearing,
-                            parameters.bearings[i]->range,
-                            approach);
+                            parameters.coordinates[i], bearing->bearing, bearing->range, approach);
                 }
             }
             else
             {
-                if (use_radiuses && parameters.radiuses[i])
+                if (radius)
                 {
                     phantom_node_pairs[i] =
                         facade.NearestPhantomNodeWithAlternativeFromBigComponent(
-                            parameters.coordinates[i], *parameters.radiuses[i], approach);
+                            parameters.coordinates[i], *radius, approach);
                 }
                 else
                 {
@@ -296,17 +311,25 @@ class BasePlugin
                 }
             }
 
-            // we didn't find a fitting node, return error
-            if (!phantom_node_pairs[i].first.IsValid())
+            if (snapping_cache && !cached)
             {
-                // This ensures the list of phantom nodes only consists of valid nodes.
-                // We can use this on the call-site to detect an error.
-                phantom_node_pairs.pop_back();
-                break;
+                snapping_cache.Insert(
+                    parameters.coordinates[i], radius, bearing, approach, phantom_node_pairs[i]);
             }
-            BOOST_ASSERT(phantom_node_pairs[i].first.IsValid());
-            BOOST_ASSERT(phantom_node_pairs[i].second.IsValid());
+
+            BOOST_ASSERT(!phantom_node_pairs[i].first.IsValid() ||
+                         phantom_node_pairs[i].second.IsValid());
         }
+
+        // we didn't find a fitting node, return error
+        // This ensures the list of phantom nodes only consists of valid nodes and ends
+        // before the first coordinate without one. We can use this on the call-site to
+        // detect an error.
+        const auto first_invalid =
+            std::find_if(phantom_node_pairs.begin(),
+                         phantom_node_pairs.end(),
+                         [](const PhantomNodePair &pair) { return !pair.first.IsValid(); });
+        phantom_node_pairs.erase(first_invalid, phantom_node_pairs.end());
         return phantom_node_pairs;
     }
 };
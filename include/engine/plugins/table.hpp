@@ -3,11 +3,16 @@
 
 #include "engine/plugins/plugin_base.hpp"
 
+#include "engine/api/table_matrices.hpp"
 #include "engine/api/table_parameters.hpp"
+#include "engine/api/table_writer.hpp"
 #include "engine/routing_algorithms.hpp"
 
 #include "util/json_container.hpp"
 
+#include <memory>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -18,14 +23,58 @@ namespace plugins
 class TablePlugin final : public BasePlugin
 {
   public:
-    explicit TablePlugin(const int max_locations_distance_table);
+    // Tables with at least min_parallel_table_size entries (-1 for never) search in parallel,
+    // with at least min_rphast_table_size entries (-1 for never) CH sweeps instead of buckets.
+    // Square tables with at least min_fused_table_size entries (-1 for never) search both
+    // directions of a coordinate in one pass. The coordinates are looked up in the snapping cache
+    // first if there is one.
+    TablePlugin(const int max_locations_distance_table,
+                const int min_parallel_table_size,
+                const int min_rphast_table_size,
+                const int min_fused_table_size,
+                std::shared_ptr<SnappingCache> snapping_cache);
 
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::TableParameters &params,
                          util::json::Object &result) const;
 
+    // Renders the response right into the buffer, the matrix never becomes a json::Array
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::TableParameters &params,
+                         std::vector<char> &result) const;
+
+    // Copies the matrices into flat arrays of numbers
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::TableParameters &params,
+                         api::TableMatrices &result) const;
+
+    // Searches and renders writer.rows_per_chunk sources at a time, every chunk of rows is
+    // written before the next one is searched
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::TableParameters &params,
+                         api::TableWriter &writer) const;
+
   private:
+    // Checks the parameters and snaps the coordinates, errors are set in the result
+    template <typename ResultT>
+    Status SnapCoordinates(const RoutingAlgorithmsInterface &algorithms,
+                           const api::TableParameters &params,
+                           std::vector<PhantomNode> &snapped_phantoms,
+                           ResultT &result) const;
+
+    routing_algorithms::ManyToManyOptions MakeOptions(const api::TableParameters &params,
+                                                      const std::size_t number_of_entries) const;
+
+    template <typename ResultT>
+    Status ComputeTable(const RoutingAlgorithmsInterface &algorithms,
+                        const api::TableParameters &params,
+                        ResultT &result) const;
+
     const int max_locations_distance_table;
+    const int min_parallel_table_size;
+    const int min_rphast_table_size;
+    const int min_fused_table_size;
+    const std::shared_ptr<SnappingCache> snapping_cache;
 };
 }
 }
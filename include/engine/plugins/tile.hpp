@@ -4,7 +4,10 @@
 #include "engine/api/tile_parameters.hpp"
 #include "engine/plugins/plugin_base.hpp"
 #include "engine/routing_algorithms.hpp"
+#include "engine/tile_cache.hpp"
 
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -15,6 +18,8 @@
  * to display maps that show the exact road network that
  * OSRM is routing.  This is very useful for debugging routing
  * errors
+ *
+ * Rendered tiles can be cached in memory and in a directory, see TileCache.
  */
 namespace osrm
 {
@@ -25,10 +30,18 @@ namespace plugins
 
 class TilePlugin final : public BasePlugin
 {
+  private:
+    // nullptr if tiles are not cached
+    const std::unique_ptr<TileCache> tile_cache;
+
   public:
+    TilePlugin(const int max_cached_tiles, const std::string &tile_cache_directory);
+
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::TileParameters &parameters,
                          std::string &pbf_buffer) const;
+
+    util::CacheStatistics GetCacheStatistics() const;
 };
 }
 }
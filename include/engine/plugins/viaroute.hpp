@@ -4,6 +4,8 @@
 #include "engine/plugins/plugin_base.hpp"
 
 #include "engine/api/route_parameters.hpp"
+#include "engine/destination_cache.hpp"
+#include "engine/route_cache.hpp"
 #include "engine/routing_algorithms.hpp"
 
 #include "util/json_container.hpp"
@@ -27,13 +29,32 @@ class ViaRoutePlugin final : public BasePlugin
   private:
     const int max_locations_viaroute;
     const int max_alternatives;
+    const int min_parallel_route_size;
+    const int min_parallel_search_distance;
+    // nullptr if routes are not cached
+    const std::unique_ptr<RouteCache> route_cache;
+    // nullptr if the search spaces of destinations are not kept for re-routes
+    const std::unique_ptr<DestinationCache> destination_cache;
+    const std::shared_ptr<SnappingCache> snapping_cache;
 
   public:
-    explicit ViaRoutePlugin(int max_locations_viaroute, int max_alternatives);
+    explicit ViaRoutePlugin(int max_locations_viaroute,
+                            int max_alternatives,
+                            int max_cached_routes,
+                            int max_reroute_destinations,
+                            int min_parallel_route_size,
+                            int min_parallel_search_distance,
+                            std::shared_ptr<SnappingCache> snapping_cache);
 
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::RouteParameters &route_parameters,
                          util::json::Object &json_result) const;
+
+    util::CacheStatistics GetCacheStatistics() const;
+
+  private:
+    InternalManyRoutesResult RerouteSearch(const RoutingAlgorithmsInterface &algorithms,
+                                           const PhantomNodes &phantom_nodes) const;
 };
 }
 }
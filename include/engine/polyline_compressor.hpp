@@ -5,6 +5,8 @@
 
 #include <algorithm>
 #include <boost/assert.hpp>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -14,58 +16,81 @@ namespace engine
 {
 namespace detail
 {
-std::string encode(std::vector<int> &numbers);
-std::int32_t decode_polyline_integer(std::string::const_iterator &first,
-                                     std::string::const_iterator last);
+// Appends the zig-zag coded number in chunks of five bits, most numbers of a geometry are deltas
+// that fit into one or two characters
+inline void encode(const std::int32_t number, std::string &output)
+{
+    // change two's complement to "zig-zag" sign coding
+    std::uint32_t value = number < 0 ? ~(static_cast<std::uint32_t>(number) << 1)
+                                     : static_cast<std::uint32_t>(number) << 1;
+    if (value < 0x20)
+    {
+        output.push_back(static_cast<char>(value + 63));
+        return;
+    }
+
+    char chunks[7];
+    std::size_t size = 0;
+    while (value >= 0x20)
+    {
+        chunks[size++] = static_cast<char>((0x20 | (value & 0x1f)) + 63);
+        value >>= 5;
+    }
+    chunks[size++] = static_cast<char>(value + 63);
+    output.append(chunks, size);
+}
+
+std::int32_t decode_polyline_integer(const char *&first, const char *last);
 }
 using CoordVectorForwardIter = std::vector<util::Coordinate>::const_iterator;
 // Encodes geometry into polyline format.
 // See: https://developers.google.com/maps/documentation/utilities/polylinealgorithm
 
+// Appends the polyline of the geometry to output in a single pass
 template <unsigned POLYLINE_PRECISION = 100000>
-std::string encodePolyline(CoordVectorForwardIter begin, CoordVectorForwardIter end)
+void encodePolyline(CoordVectorForwardIter begin, CoordVectorForwardIter end, std::string &output)
 {
-    double coordinate_to_polyline = POLYLINE_PRECISION / COORDINATE_PRECISION;
-    auto size = std::distance(begin, end);
-    if (size == 0)
-    {
-        return {};
-    }
-
-    std::vector<int> delta_numbers;
-    BOOST_ASSERT(size > 0);
-    delta_numbers.reserve((size - 1) * 2);
+    const double coordinate_to_polyline = POLYLINE_PRECISION / COORDINATE_PRECISION;
     int current_lat = 0;
     int current_lon = 0;
-    std::for_each(
-        begin,
-        end,
-        [&delta_numbers, &current_lat, &current_lon, coordinate_to_polyline](
-            const util::Coordinate loc) {
-            const int lat_diff =
-                std::round(static_cast<int>(loc.lat) * coordinate_to_polyline) - current_lat;
-            const int lon_diff =
-                std::round(static_cast<int>(loc.lon) * coordinate_to_polyline) - current_lon;
-            delta_numbers.emplace_back(lat_diff);
-            delta_numbers.emplace_back(lon_diff);
-            current_lat += lat_diff;
-            current_lon += lon_diff;
-        });
-    return detail::encode(delta_numbers);
+    std::for_each(begin, end, [&](const util::Coordinate loc) {
+        const int lat_diff =
+            std::round(static_cast<int>(loc.lat) * coordinate_to_polyline) - current_lat;
+        const int lon_diff =
+            std::round(static_cast<int>(loc.lon) * coordinate_to_polyline) - current_lon;
+        detail::encode(lat_diff, output);
+        detail::encode(lon_diff, output);
+        current_lat += lat_diff;
+        current_lon += lon_diff;
+    });
+}
+
+template <unsigned POLYLINE_PRECISION = 100000>
+std::string encodePolyline(CoordVectorForwardIter begin, CoordVectorForwardIter end)
+{
+    std::string output;
+    // deltas of consecutive coordinates mostly take three to four characters per axis
+    output.reserve(std::distance(begin, end) * 8);
+    encodePolyline<POLYLINE_PRECISION>(begin, end, output);
+    return output;
 }
 
 // Decodes geometry from polyline format
 // See: https://developers.google.com/maps/documentation/utilities/polylinealgorithm
 
+// Appends the coordinates of the polyline between first and last, e.g. a view into a request.
+// Only the coordinates vector allocates, once for all coordinates.
 template <unsigned POLYLINE_PRECISION = 100000>
-std::vector<util::Coordinate> decodePolyline(const std::string &polyline)
+void decodePolyline(const char *first,
+                    const char *const last,
+                    std::vector<util::Coordinate> &coordinates)
 {
-    double polyline_to_coordinate = COORDINATE_PRECISION / POLYLINE_PRECISION;
-    std::vector<util::Coordinate> coordinates;
-    std::int32_t latitude = 0, longitude = 0;
+    // every number ends with a character without the continuation bit
+    const auto numbers = std::count_if(first, last, [](const char chunk) { return chunk < 95; });
+    coordinates.reserve(coordinates.size() + (numbers + 1) / 2);
 
-    std::string::const_iterator first = polyline.begin();
-    const std::string::const_iterator last = polyline.end();
+    const double polyline_to_coordinate = COORDINATE_PRECISION / POLYLINE_PRECISION;
+    std::int32_t latitude = 0, longitude = 0;
     while (first != last)
     {
         const auto dlat = detail::decode_polyline_integer(first, last);
@@ -78,6 +103,14 @@ std::vector<util::Coordinate> decodePolyline(const std::string &polyline)
             util::FixedLongitude{static_cast<std::int32_t>(longitude * polyline_to_coordinate)},
             util::FixedLatitude{static_cast<std::int32_t>(latitude * polyline_to_coordinate)}});
     }
+}
+
+template <unsigned POLYLINE_PRECISION = 100000>
+std::vector<util::Coordinate> decodePolyline(const std::string &polyline)
+{
+    std::vector<util::Coordinate> coordinates;
+    decodePolyline<POLYLINE_PRECISION>(
+        polyline.data(), polyline.data() + polyline.size(), coordinates);
     return coordinates;
 }
 }
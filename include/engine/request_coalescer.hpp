@@ -0,0 +1,151 @@
+#ifndef OSRM_ENGINE_REQUEST_COALESCER_HPP
+#define OSRM_ENGINE_REQUEST_COALESCER_HPP
+
+#include "engine/api/route_parameters.hpp"
+#include "engine/api/tile_parameters.hpp"
+#include "engine/dataset_generation.hpp"
+#include "engine/status.hpp"
+
+#include <boost/assert.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Every parameter the engine computes a response from, in a canonical byte encoding. Two
+// parameter sets with the same encoding get the same response on the same dataset. The output
+// format is applied after the engine and not part of it.
+std::string EncodeRequest(const api::RouteParameters &parameters);
+std::string EncodeRequest(const api::TileParameters &parameters);
+
+// Lets concurrent identical requests share one computation, e.g. during retry storms of clients.
+//
+// The first request of a key computes its result, requests with the same key arriving while it
+// runs wait for it and get a copy of its status and result. Nothing is kept once the computation
+// finished, later requests compute again. Every key is tied to the dataset of its query, requests
+// on different datasets never share results.
+class RequestCoalescerBase
+{
+  public:
+    struct Key
+    {
+        std::uint64_t generation;
+        std::string request;
+
+        bool operator==(const Key &other) const
+        {
+            return generation == other.generation && request == other.request;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    // dataset is any pointer that shares ownership with the facade of the query
+    Key MakeKey(const std::shared_ptr<const void> &dataset, std::string request)
+    {
+        return Key{generation.Get(dataset, []() {}), std::move(request)};
+    }
+
+    // Requests that got the result of an identical one instead of computing it
+    std::uint64_t GetCoalesced() const { return coalesced.load(std::memory_order_relaxed); }
+
+  protected:
+    std::atomic<std::uint64_t> coalesced{0};
+
+  private:
+    DatasetGeneration generation;
+};
+
+template <typename ResultT> class RequestCoalescer final : public RequestCoalescerBase
+{
+  public:
+    // compute(result) fills in the result of the first request of a key and returns its status,
+    // exceptions it throws are rethrown in all waiting requests
+    template <typename Compute> Status Run(const Key &key, ResultT &result, Compute compute)
+    {
+        std::promise<Response> promise;
+        std::shared_future<Response> response;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const auto flight = in_flight.find(key);
+            if (flight != in_flight.end())
+            {
+                ++flight->second.followers;
+                response = flight->second.response;
+            }
+            else
+            {
+                in_flight.emplace(key, Flight{promise.get_future().share(), 0});
+            }
+        }
+
+        if (response.valid())
+        {
+            coalesced.fetch_add(1, std::memory_order_relaxed);
+            const auto &shared = response.get();
+            result = shared.second;
+            return shared.first;
+        }
+
+        try
+        {
+            const auto status = compute(result);
+            // only copies the result for requests that actually wait for it
+            if (Land(key))
+            {
+                promise.set_value(Response{status, result});
+            }
+            return status;
+        }
+        catch (...)
+        {
+            if (Land(key))
+            {
+                promise.set_exception(std::current_exception());
+            }
+            throw;
+        }
+    }
+
+  private:
+    using Response = std::pair<Status, ResultT>;
+
+    struct Flight
+    {
+        std::shared_future<Response> response;
+        std::size_t followers;
+    };
+
+    // Ends the flight of a key, returns whether requests wait for its response
+    bool Land(const Key &key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto flight = in_flight.find(key);
+        BOOST_ASSERT(flight != in_flight.end());
+        const auto followers = flight->second.followers;
+        in_flight.erase(flight);
+        return followers > 0;
+    }
+
+    std::mutex mutex;
+    std::unordered_map<Key, Flight, KeyHash> in_flight;
+};
+}
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef OSRM_ENGINE_ROUTE_CACHE_HPP
+#define OSRM_ENGINE_ROUTE_CACHE_HPP
+
+#include "engine/dataset_generation.hpp"
+#include "engine/internal_route_result.hpp"
+#include "engine/phantom_node.hpp"
+
+#include "util/lru_cache.hpp"
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Caches the paths found between snapped coordinates, shared by all queries of an engine.
+//
+// Two queries get the same paths if their phantom nodes lie at the same position of the same
+// segments and they ask for the same alternatives and u-turn handling, the input coordinates
+// they were snapped from do not matter. Every key is tied to the dataset it was computed on,
+// once a query runs on a new dataset all cached paths are dropped.
+class RouteCache
+{
+  public:
+    struct Key
+    {
+        std::uint64_t generation;
+        std::vector<std::int32_t> words;
+
+        bool operator==(const Key &other) const
+        {
+            return generation == other.generation && words == other.words;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    explicit RouteCache(const std::size_t capacity);
+
+    // dataset is any pointer that shares ownership with the facade of the query
+    Key MakeKey(const std::shared_ptr<const void> &dataset,
+                const std::vector<PhantomNodes> &start_end_nodes,
+                const unsigned number_of_alternatives,
+                const boost::optional<bool> continue_straight);
+
+    // The cached paths with the phantom nodes of the query, which may have different inputs
+    boost::optional<InternalManyRoutesResult>
+    Get(const Key &key, const std::vector<PhantomNodes> &start_end_nodes);
+
+    void Insert(Key key, InternalManyRoutesResult routes);
+
+    util::CacheStatistics GetStatistics() const { return cache.GetStatistics(); }
+
+  private:
+    DatasetGeneration generation;
+    util::ShardedLRUCache<Key, InternalManyRoutesResult, KeyHash> cache;
+};
+}
+}
+
+#endif
@@ -8,9 +8,12 @@
 #include "engine/routing_algorithms/direct_shortest_path.hpp"
 #include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/map_matching.hpp"
+#include "engine/routing_algorithms/one_to_all.hpp"
 #include "engine/routing_algorithms/shortest_path.hpp"
 #include "engine/routing_algorithms/tile_turns.hpp"
 
+#include <memory>
+
 namespace osrm
 {
 namespace engine
@@ -25,22 +28,62 @@ class RoutingAlgorithmsInterface
 
     virtual InternalRouteResult
     ShortestPathSearch(const std::vector<PhantomNodes> &phantom_node_pair,
-                       const boost::optional<bool> continue_straight_at_waypoint) const = 0;
+                       const boost::optional<bool> continue_straight_at_waypoint,
+                       const bool parallel) const = 0;
+
+    // parallel runs the forward and the reverse search on two threads if the algorithm can
+    virtual InternalRouteResult DirectShortestPathSearch(const PhantomNodes &phantom_node_pair,
+                                                         const bool parallel) const = 0;
+
+    // avoids the conditional turn restrictions that apply at the UNIX timestamp of the departure
+    virtual InternalRouteResult
+    ConditionalDirectShortestPathSearch(const PhantomNodes &phantom_node_pair,
+                                        const std::uint64_t departure_time) const = 0;
 
+    // the reverse search space of the target phantom node for rerouting to it
+    virtual routing_algorithms::DestinationSearchSpace
+    DestinationSearch(const PhantomNode &target_phantom) const = 0;
+
+    // the same route as DirectShortestPathSearch if destination is the search space of the target
     virtual InternalRouteResult
-    DirectShortestPathSearch(const PhantomNodes &phantom_node_pair) const = 0;
+    RerouteSearch(const PhantomNodes &phantom_node_pair,
+                  const routing_algorithms::DestinationSearchSpace &destination) const = 0;
+
+    // the options pick how the searches run, worth changing only for large tables
+    virtual std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+    ManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
+                     const std::vector<std::size_t> &source_indices,
+                     const std::vector<std::size_t> &target_indices,
+                     const routing_algorithms::ManyToManyOptions &options) const = 0;
 
-    virtual std::vector<EdgeWeight>
+    // also unpacks the shortest paths of the entries in options.paths
+    virtual std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
     ManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
                      const std::vector<std::size_t> &source_indices,
-                     const std::vector<std::size_t> &target_indices) const = 0;
+                     const std::vector<std::size_t> &target_indices,
+                     const routing_algorithms::ManyToManyOptions &options,
+                     std::vector<InternalRouteResult> &paths) const = 0;
+
+    // all nodes within max_duration of the source, in deciseconds
+    virtual std::vector<routing_algorithms::ReachedNode>
+    OneToAllSearch(const PhantomNode &source, const EdgeDuration max_duration) const = 0;
 
     virtual routing_algorithms::SubMatchingList
     MapMatching(const routing_algorithms::CandidateLists &candidates_list,
                 const std::vector<util::Coordinate> &trace_coordinates,
                 const std::vector<unsigned> &trace_timestamps,
                 const std::vector<boost::optional<double>> &trace_gps_precision,
-                const bool allow_splitting) const = 0;
+                const bool allow_splitting,
+                const bool parallel) const = 0;
+
+    // extends the trace of a matching session, see routing_algorithms::extendMapMatching
+    virtual map_matching::SubMatching
+    ExtendMapMatching(map_matching::MatchingSession &session,
+                      const routing_algorithms::CandidateLists &candidates_list,
+                      const std::vector<util::Coordinate> &trace_coordinates,
+                      const std::vector<unsigned> &trace_timestamps,
+                      const std::vector<boost::optional<double>> &trace_gps_precision,
+                      const bool allow_splitting) const = 0;
 
     virtual std::vector<routing_algorithms::TurnData>
     GetTileTurns(const std::vector<datafacade::BaseDataFacade::RTreeLeaf> &edges,
@@ -48,11 +91,18 @@ class RoutingAlgorithmsInterface
 
     virtual const DataFacadeBase &GetFacade() const = 0;
 
+    // Shares ownership with the facade, identifies the dataset for caches that outlive a query
+    virtual std::shared_ptr<const void> GetDataset() const = 0;
+
     virtual bool HasAlternativePathSearch() const = 0;
     virtual bool HasShortestPathSearch() const = 0;
     virtual bool HasDirectShortestPathSearch() const = 0;
+    virtual bool HasConditionalDirectShortestPathSearch() const = 0;
+    virtual bool HasRerouteSearch() const = 0;
     virtual bool HasMapMatching() const = 0;
     virtual bool HasManyToManySearch() const = 0;
+    virtual bool HasManyToManyPaths() const = 0;
+    virtual bool HasOneToAllSearch() const = 0;
     virtual bool HasGetTileTurns() const = 0;
 };
 
@@ -72,24 +122,57 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
     AlternativePathSearch(const PhantomNodes &phantom_node_pair,
                           unsigned number_of_alternatives) const final override;
 
-    InternalRouteResult ShortestPathSearch(
-        const std::vector<PhantomNodes> &phantom_node_pair,
-        const boost::optional<bool> continue_straight_at_waypoint) const final override;
+    InternalRouteResult
+    ShortestPathSearch(const std::vector<PhantomNodes> &phantom_node_pair,
+                       const boost::optional<bool> continue_straight_at_waypoint,
+                       const bool parallel) const final override;
+
+    InternalRouteResult DirectShortestPathSearch(const PhantomNodes &phantom_nodes,
+                                                 const bool parallel) const final override;
 
     InternalRouteResult
-    DirectShortestPathSearch(const PhantomNodes &phantom_nodes) const final override;
+    ConditionalDirectShortestPathSearch(const PhantomNodes &phantom_nodes,
+                                        const std::uint64_t departure_time) const final override;
+
+    routing_algorithms::DestinationSearchSpace
+    DestinationSearch(const PhantomNode &target_phantom) const final override;
+
+    InternalRouteResult RerouteSearch(const PhantomNodes &phantom_node_pair,
+                                      const routing_algorithms::DestinationSearchSpace &destination)
+        const final override;
+
+    std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+    ManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
+                     const std::vector<std::size_t> &source_indices,
+                     const std::vector<std::size_t> &target_indices,
+                     const routing_algorithms::ManyToManyOptions &options) const final override;
 
-    std::vector<EdgeWeight>
+    std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
     ManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
                      const std::vector<std::size_t> &source_indices,
-                     const std::vector<std::size_t> &target_indices) const final override;
+                     const std::vector<std::size_t> &target_indices,
+                     const routing_algorithms::ManyToManyOptions &options,
+                     std::vector<InternalRouteResult> &paths) const final override;
+
+    std::vector<routing_algorithms::ReachedNode>
+    OneToAllSearch(const PhantomNode &source,
+                   const EdgeDuration max_duration) const final override;
 
     routing_algorithms::SubMatchingList
     MapMatching(const routing_algorithms::CandidateLists &candidates_list,
                 const std::vector<util::Coordinate> &trace_coordinates,
                 const std::vector<unsigned> &trace_timestamps,
                 const std::vector<boost::optional<double>> &trace_gps_precision,
-                const bool allow_splitting) const final override;
+                const bool allow_splitting,
+                const bool parallel) const final override;
+
+    map_matching::SubMatching
+    ExtendMapMatching(map_matching::MatchingSession &session,
+                      const routing_algorithms::CandidateLists &candidates_list,
+                      const std::vector<util::Coordinate> &trace_coordinates,
+                      const std::vector<unsigned> &trace_timestamps,
+                      const std::vector<boost::optional<double>> &trace_gps_precision,
+                      const bool allow_splitting) const final override;
 
     std::vector<routing_algorithms::TurnData>
     GetTileTurns(const std::vector<datafacade::BaseDataFacade::RTreeLeaf> &edges,
@@ -97,6 +180,8 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
 
     const DataFacadeBase &GetFacade() const final override { return *facade; }
 
+    std::shared_ptr<const void> GetDataset() const final override { return facade; }
+
     bool HasAlternativePathSearch() const final override
     {
         return routing_algorithms::HasAlternativePathSearch<Algorithm>::value;
@@ -112,6 +197,16 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
         return routing_algorithms::HasDirectShortestPathSearch<Algorithm>::value;
     }
 
+    bool HasConditionalDirectShortestPathSearch() const final override
+    {
+        return routing_algorithms::HasConditionalDirectShortestPathSearch<Algorithm>::value;
+    }
+
+    bool HasRerouteSearch() const final override
+    {
+        return routing_algorithms::HasRerouteSearch<Algorithm>::value;
+    }
+
     bool HasMapMatching() const final override
     {
         return routing_algorithms::HasMapMatching<Algorithm>::value;
@@ -122,6 +217,16 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
         return routing_algorithms::HasManyToManySearch<Algorithm>::value;
     }
 
+    bool HasManyToManyPaths() const final override
+    {
+        return routing_algorithms::HasManyToManyPaths<Algorithm>::value;
+    }
+
+    bool HasOneToAllSearch() const final override
+    {
+        return routing_algorithms::HasOneToAllSearch<Algorithm>::value;
+    }
+
     bool HasGetTileTurns() const final override
     {
         return routing_algorithms::HasGetTileTurns<Algorithm>::value;
@@ -144,27 +249,75 @@ RoutingAlgorithms<Algorithm>::AlternativePathSearch(const PhantomNodes &phantom_
 template <typename Algorithm>
 InternalRouteResult RoutingAlgorithms<Algorithm>::ShortestPathSearch(
     const std::vector<PhantomNodes> &phantom_node_pair,
-    const boost::optional<bool> continue_straight_at_waypoint) const
+    const boost::optional<bool> continue_straight_at_waypoint,
+    const bool parallel) const
 {
     return routing_algorithms::shortestPathSearch(
-        heaps, *facade, phantom_node_pair, continue_straight_at_waypoint);
+        heaps, *facade, phantom_node_pair, continue_straight_at_waypoint, parallel);
 }
 
 template <typename Algorithm>
 InternalRouteResult
-RoutingAlgorithms<Algorithm>::DirectShortestPathSearch(const PhantomNodes &phantom_nodes) const
+RoutingAlgorithms<Algorithm>::DirectShortestPathSearch(const PhantomNodes &phantom_nodes,
+                                                       const bool /*parallel*/) const
 {
     return routing_algorithms::directShortestPathSearch(heaps, *facade, phantom_nodes);
 }
 
 template <typename Algorithm>
-std::vector<EdgeWeight>
-RoutingAlgorithms<Algorithm>::ManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
-                                               const std::vector<std::size_t> &source_indices,
-                                               const std::vector<std::size_t> &target_indices) const
+InternalRouteResult
+RoutingAlgorithms<Algorithm>::ConditionalDirectShortestPathSearch(const PhantomNodes &,
+                                                                  const std::uint64_t) const
+{
+    throw util::exception("ConditionalDirectShortestPathSearch is not implemented for the chosen "
+                          "search algorithm");
+}
+
+template <typename Algorithm>
+routing_algorithms::DestinationSearchSpace
+RoutingAlgorithms<Algorithm>::DestinationSearch(const PhantomNode &) const
+{
+    throw util::exception("DestinationSearch is not implemented for the chosen search algorithm");
+}
+
+template <typename Algorithm>
+InternalRouteResult RoutingAlgorithms<Algorithm>::RerouteSearch(
+    const PhantomNodes &, const routing_algorithms::DestinationSearchSpace &) const
+{
+    throw util::exception("RerouteSearch is not implemented for the chosen search algorithm");
+}
+
+template <typename Algorithm>
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+RoutingAlgorithms<Algorithm>::ManyToManySearch(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &source_indices,
+    const std::vector<std::size_t> &target_indices,
+    const routing_algorithms::ManyToManyOptions &options) const
 {
     return routing_algorithms::manyToManySearch(
-        heaps, *facade, phantom_nodes, source_indices, target_indices);
+        heaps, *facade, phantom_nodes, source_indices, target_indices, options);
+}
+
+template <typename Algorithm>
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+RoutingAlgorithms<Algorithm>::ManyToManySearch(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &source_indices,
+    const std::vector<std::size_t> &target_indices,
+    const routing_algorithms::ManyToManyOptions &options,
+    std::vector<InternalRouteResult> &paths) const
+{
+    return routing_algorithms::manyToManySearch(
+        heaps, *facade, phantom_nodes, source_indices, target_indices, options, paths);
+}
+
+template <typename Algorithm>
+std::vector<routing_algorithms::ReachedNode>
+RoutingAlgorithms<Algorithm>::OneToAllSearch(const PhantomNode &source,
+                                             const EdgeDuration max_duration) const
+{
+    return routing_algorithms::oneToAllSearch(heaps, *facade, source, max_duration);
 }
 
 template <typename Algorithm>
@@ -173,7 +326,8 @@ inline routing_algorithms::SubMatchingList RoutingAlgorithms<Algorithm>::MapMatc
     const std::vector<util::Coordinate> &trace_coordinates,
     const std::vector<unsigned> &trace_timestamps,
     const std::vector<boost::optional<double>> &trace_gps_precision,
-    const bool allow_splitting) const
+    const bool allow_splitting,
+    const bool parallel) const
 {
     return routing_algorithms::mapMatching(heaps,
                                            *facade,
@@ -181,7 +335,27 @@ inline routing_algorithms::SubMatchingList RoutingAlgorithms<Algorithm>::MapMatc
                                            trace_coordinates,
                                            trace_timestamps,
                                            trace_gps_precision,
-                                           allow_splitting);
+                                           allow_splitting,
+                                           parallel);
+}
+
+template <typename Algorithm>
+inline map_matching::SubMatching RoutingAlgorithms<Algorithm>::ExtendMapMatching(
+    map_matching::MatchingSession &session,
+    const routing_algorithms::CandidateLists &candidates_list,
+    const std::vector<util::Coordinate> &trace_coordinates,
+    const std::vector<unsigned> &trace_timestamps,
+    const std::vector<boost::optional<double>> &trace_gps_precision,
+    const bool allow_splitting) const
+{
+    return routing_algorithms::extendMapMatching(heaps,
+                                                 *facade,
+                                                 session,
+                                                 candidates_list,
+                                                 trace_coordinates,
+                                                 trace_timestamps,
+                                                 trace_gps_precision,
+                                                 allow_splitting);
 }
 
 template <typename Algorithm>
@@ -192,6 +366,23 @@ inline std::vector<routing_algorithms::TurnData> RoutingAlgorithms<Algorithm>::G
     return routing_algorithms::getTileTurns(*facade, edges, sorted_edge_indexes);
 }
 
+// CH overrides
+template <>
+inline routing_algorithms::DestinationSearchSpace
+RoutingAlgorithms<routing_algorithms::ch::Algorithm>::DestinationSearch(
+    const PhantomNode &target_phantom) const
+{
+    return routing_algorithms::destinationSearch(heaps, *facade, target_phantom);
+}
+
+template <>
+inline InternalRouteResult RoutingAlgorithms<routing_algorithms::ch::Algorithm>::RerouteSearch(
+    const PhantomNodes &phantom_nodes,
+    const routing_algorithms::DestinationSearchSpace &destination) const
+{
+    return routing_algorithms::rerouteSearch(heaps, *facade, phantom_nodes, destination);
+}
+
 // CoreCH overrides
 template <>
 InternalManyRoutesResult inline RoutingAlgorithms<
@@ -201,14 +392,139 @@ InternalManyRoutesResult inline RoutingAlgorithms<
     throw util::exception("AlternativePathSearch is disabled due to performance reasons");
 }
 
+// the core is not contracted, there is no hierarchy to sweep
+template <>
+inline std::vector<routing_algorithms::ReachedNode>
+RoutingAlgorithms<routing_algorithms::corech::Algorithm>::OneToAllSearch(const PhantomNode &,
+                                                                         const EdgeDuration) const
+{
+    throw util::exception("OneToAllSearch is not implemented for CoreCH");
+}
+
+// CCH overrides, the heaps and the facade of a CCH are the ones of a CH so the searches that are
+// templates run their CH instantiations
+template <>
+inline InternalRouteResult
+RoutingAlgorithms<routing_algorithms::cch::Algorithm>::ShortestPathSearch(
+    const std::vector<PhantomNodes> &phantom_node_pair,
+    const boost::optional<bool> continue_straight_at_waypoint,
+    const bool parallel) const
+{
+    return routing_algorithms::shortestPathSearch<routing_algorithms::ch::Algorithm>(
+        heaps, *facade, phantom_node_pair, continue_straight_at_waypoint, parallel);
+}
+
+template <>
+inline InternalRouteResult
+RoutingAlgorithms<routing_algorithms::cch::Algorithm>::DirectShortestPathSearch(
+    const PhantomNodes &phantom_nodes, const bool /*parallel*/) const
+{
+    return routing_algorithms::directShortestPathSearch<routing_algorithms::ch::Algorithm>(
+        heaps, *facade, phantom_nodes);
+}
+
+template <>
+inline std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+RoutingAlgorithms<routing_algorithms::cch::Algorithm>::ManyToManySearch(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &source_indices,
+    const std::vector<std::size_t> &target_indices,
+    const routing_algorithms::ManyToManyOptions &options) const
+{
+    return routing_algorithms::manyToManySearch<routing_algorithms::ch::Algorithm>(
+        heaps, *facade, phantom_nodes, source_indices, target_indices, options);
+}
+
+template <>
+inline std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+RoutingAlgorithms<routing_algorithms::cch::Algorithm>::ManyToManySearch(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &source_indices,
+    const std::vector<std::size_t> &target_indices,
+    const routing_algorithms::ManyToManyOptions &options,
+    std::vector<InternalRouteResult> &paths) const
+{
+    return routing_algorithms::manyToManySearch<routing_algorithms::ch::Algorithm>(
+        heaps, *facade, phantom_nodes, source_indices, target_indices, options, paths);
+}
+
+template <>
+inline routing_algorithms::SubMatchingList
+RoutingAlgorithms<routing_algorithms::cch::Algorithm>::MapMatching(
+    const routing_algorithms::CandidateLists &candidates_list,
+    const std::vector<util::Coordinate> &trace_coordinates,
+    const std::vector<unsigned> &trace_timestamps,
+    const std::vector<boost::optional<double>> &trace_gps_precision,
+    const bool allow_splitting,
+    const bool parallel) const
+{
+    return routing_algorithms::mapMatching<routing_algorithms::ch::Algorithm>(heaps,
+                                                                              *facade,
+                                                                              candidates_list,
+                                                                              trace_coordinates,
+                                                                              trace_timestamps,
+                                                                              trace_gps_precision,
+                                                                              allow_splitting,
+                                                                              parallel);
+}
+
+template <>
+inline map_matching::SubMatching
+RoutingAlgorithms<routing_algorithms::cch::Algorithm>::ExtendMapMatching(
+    map_matching::MatchingSession &session,
+    const routing_algorithms::CandidateLists &candidates_list,
+    const std::vector<util::Coordinate> &trace_coordinates,
+    const std::vector<unsigned> &trace_timestamps,
+    const std::vector<boost::optional<double>> &trace_gps_precision,
+    const bool allow_splitting) const
+{
+    return routing_algorithms::extendMapMatching<routing_algorithms::ch::Algorithm>(
+        heaps,
+        *facade,
+        session,
+        candidates_list,
+        trace_coordinates,
+        trace_timestamps,
+        trace_gps_precision,
+        allow_splitting);
+}
+
+template <>
+inline routing_algorithms::DestinationSearchSpace
+RoutingAlgorithms<routing_algorithms::cch::Algorithm>::DestinationSearch(
+    const PhantomNode &target_phantom) const
+{
+    return routing_algorithms::destinationSearch(heaps, *facade, target_phantom);
+}
+
+template <>
+inline InternalRouteResult RoutingAlgorithms<routing_algorithms::cch::Algorithm>::RerouteSearch(
+    const PhantomNodes &phantom_nodes,
+    const routing_algorithms::DestinationSearchSpace &destination) const
+{
+    return routing_algorithms::rerouteSearch(heaps, *facade, phantom_nodes, destination);
+}
+
+// MLD overrides
+template <>
+inline InternalRouteResult
+RoutingAlgorithms<routing_algorithms::mld::Algorithm>::DirectShortestPathSearch(
+    const PhantomNodes &phantom_nodes, const bool parallel) const
+{
+    if (parallel)
+    {
+        return routing_algorithms::parallelDirectShortestPathSearch(heaps, *facade, phantom_nodes);
+    }
+    return routing_algorithms::directShortestPathSearch(heaps, *facade, phantom_nodes);
+}
+
 template <>
-inline std::vector<EdgeWeight>
-RoutingAlgorithms<routing_algorithms::corech::Algorithm>::ManyToManySearch(
-    const std::vector<PhantomNode> &,
-    const std::vector<std::size_t> &,
-    const std::vector<std::size_t> &) const
+inline InternalRouteResult
+RoutingAlgorithms<routing_algorithms::mld::Algorithm>::ConditionalDirectShortestPathSearch(
+    const PhantomNodes &phantom_nodes, const std::uint64_t departure_time) const
 {
-    throw util::exception("ManyToManySearch is disabled due to performance reasons");
+    return routing_algorithms::directShortestPathSearch(
+        heaps, *facade, phantom_nodes, departure_time);
 }
 } // ns engine
 } // ns osrm
@@ -8,6 +8,9 @@
 
 #include "util/typedefs.hpp"
 
+#include <cstdint>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -26,6 +29,49 @@ InternalRouteResult directShortestPathSearch(SearchEngineData<Algorithm> &engine
                                              const DataFacade<Algorithm> &facade,
                                              const PhantomNodes &phantom_nodes);
 
+/// Runs the forward and the reverse search on two threads, only worth it for long routes.
+InternalRouteResult
+parallelDirectShortestPathSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                 const DataFacade<mld::Algorithm> &facade,
+                                 const PhantomNodes &phantom_nodes);
+
+/// Avoids the conditional turn restrictions that apply at the departure time, a UNIX timestamp,
+/// by descending below the cells that contain them.
+InternalRouteResult directShortestPathSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                             const DataFacade<mld::Algorithm> &facade,
+                                             const PhantomNodes &phantom_nodes,
+                                             const std::uint64_t departure_time);
+
+/// The reverse search of a CH query from a target, run until its heap is empty. Any forward
+/// search that meets it finds the shortest path to the target, so routes from new sources to
+/// the same target only have to search forward.
+struct DestinationSearchSpace
+{
+    struct Label
+    {
+        NodeID node;
+        EdgeWeight weight;
+        NodeID parent;
+    };
+
+    // sorted by node, the labels of the target segments are their own parents
+    std::vector<Label> labels;
+
+    // nullptr if the search did not reach the node
+    const Label *Find(const NodeID node) const;
+};
+
+DestinationSearchSpace destinationSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                         const DataFacade<ch::Algorithm> &facade,
+                                         const PhantomNode &target_phantom);
+
+/// The same route as directShortestPathSearch, the reverse search is the one of the destination
+/// of the target phantom node.
+InternalRouteResult rerouteSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                  const DataFacade<ch::Algorithm> &facade,
+                                  const PhantomNodes &phantom_nodes,
+                                  const DestinationSearchSpace &destination);
+
 } // namespace routing_algorithms
 } // namespace engine
 } // namespace osrm
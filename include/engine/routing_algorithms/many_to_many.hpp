@@ -3,10 +3,12 @@
 
 #include "engine/algorithm.hpp"
 #include "engine/datafacade.hpp"
+#include "engine/internal_route_result.hpp"
 #include "engine/search_engine_data.hpp"
 
 #include "util/typedefs.hpp"
 
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -16,12 +18,69 @@ namespace engine
 namespace routing_algorithms
 {
 
+// How manyToManySearch runs the searches of a table, all of them give the same weights
+struct ManyToManyOptions
+{
+    // split the searches across TBB tasks, each with heaps of its own leased from the pool of
+    // engine_working_data
+    bool parallel = false;
+    // CH only: sweep the downward graph of all targets once per source instead of scanning
+    // buckets, pays off for thousands of targets
+    bool rphast = false;
+    // tables whose sources are their targets search both directions of every coordinate in one
+    // pass over the coordinates, tables with paths search as any other
+    bool fuse_square = true;
+    // also sum up the distances of the shortest paths, from the per edge and per cell distances
+    // of the prepared data, no path is unpacked
+    bool distances = false;
+    // only look for paths lighter than this, heavier ones are reported as unreachable. The
+    // searches stop once they get this far, RPHAST does not support a bound
+    EdgeWeight weight_upper_bound = INVALID_EDGE_WEIGHT;
+    // (row, column) of the entries whose shortest paths are unpacked as well, traced back through
+    // the search spaces of the table. Tables with paths use buckets even if rphast is set.
+    std::vector<std::pair<std::size_t, std::size_t>> paths;
+};
+
+// Returns the durations of all pairs row by row and, if requested, their distances in meters
+template <typename Algorithm>
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                 const DataFacade<Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options);
+
+// Same as above, also returns the shortest paths of the entries in options.paths in their order.
+// The paths of unreachable entries are not valid.
 template <typename Algorithm>
-std::vector<EdgeWeight> manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
-                                         const DataFacade<Algorithm> &facade,
-                                         const std::vector<PhantomNode> &phantom_nodes,
-                                         const std::vector<std::size_t> &source_indices,
-                                         const std::vector<std::size_t> &target_indices);
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                 const DataFacade<Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options,
+                 std::vector<InternalRouteResult> &paths);
+
+// Core-CH searches the uncontracted core once per source, from all nodes the source enters it at
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<corech::Algorithm> &engine_working_data,
+                 const DataFacade<corech::Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options);
+
+// Core-CH returns no paths, options.paths has to be empty
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<corech::Algorithm> &engine_working_data,
+                 const DataFacade<corech::Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options,
+                 std::vector<InternalRouteResult> &paths);
 
 } // namespace routing_algorithms
 } // namespace engine
@@ -3,6 +3,7 @@
 
 #include "engine/algorithm.hpp"
 #include "engine/datafacade.hpp"
+#include "engine/map_matching/matching_session.hpp"
 #include "engine/map_matching/sub_matching.hpp"
 #include "engine/search_engine_data.hpp"
 
@@ -22,6 +23,9 @@ static const constexpr double DEFAULT_GPS_PRECISION = 5;
 
 //[1] "Hidden Markov Map Matching Through Noise and Sparseness";
 //     P. Newson and J. Krumm; 2009; ACM GIS
+//
+// With parallel set, traces that are split at time gaps match the parts between the gaps in TBB
+// tasks, each with heaps of its own leased from the pool of engine_working_data
 template <typename Algorithm>
 SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
                             const DataFacade<Algorithm> &facade,
@@ -29,7 +33,24 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
                             const std::vector<util::Coordinate> &trace_coordinates,
                             const std::vector<unsigned> &trace_timestamps,
                             const std::vector<boost::optional<double>> &trace_gps_precision,
-                            const bool allow_splitting);
+                            const bool allow_splitting,
+                            const bool parallel);
+
+// Extends the trace of the session by the coordinates and moves its frontier to the last one
+// that could be matched. The matching holds the most probable candidates along the best path
+// into the new frontier, which starts at the old frontier, with index
+// map_matching::FRONTIER_INDEX, unless the trace was split since. Coordinates before the split
+// and coordinates that could not be matched are left out.
+template <typename Algorithm>
+map_matching::SubMatching
+extendMapMatching(SearchEngineData<Algorithm> &engine_working_data,
+                  const DataFacade<Algorithm> &facade,
+                  map_matching::MatchingSession &session,
+                  const CandidateLists &candidates_list,
+                  const std::vector<util::Coordinate> &trace_coordinates,
+                  const std::vector<unsigned> &trace_timestamps,
+                  const std::vector<boost::optional<double>> &trace_gps_precision,
+                  const bool allow_splitting);
 
 } // namespace routing_algorithms
 } // namespace engine
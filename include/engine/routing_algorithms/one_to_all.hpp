@@ -0,0 +1,47 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_ONE_TO_ALL_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_ONE_TO_ALL_HPP
+
+#include "engine/algorithm.hpp"
+#include "engine/datafacade.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/search_engine_data.hpp"
+
+#include "util/typedefs.hpp"
+
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+// A node of the edge based graph a one-to-all search reached. The weight and the duration are
+// the ones of the lightest path to the start of its segment, negative for the nodes the source
+// is on.
+struct ReachedNode
+{
+    NodeID node;
+    EdgeWeight weight;
+    EdgeWeight duration;
+};
+
+// Returns the nodes the lightest paths from the source reach within max_duration, in no
+// particular order. CH sweeps the whole hierarchy once (PHAST), MLD runs a Dijkstra on the base
+// graph that stops at the bound.
+std::vector<ReachedNode> oneToAllSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                        const DataFacade<ch::Algorithm> &facade,
+                                        const PhantomNode &source,
+                                        const EdgeDuration max_duration);
+
+std::vector<ReachedNode> oneToAllSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                        const DataFacade<mld::Algorithm> &facade,
+                                        const PhantomNode &source,
+                                        const EdgeDuration max_duration);
+
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
+
+#endif
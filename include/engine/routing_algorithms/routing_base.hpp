@@ -11,6 +11,8 @@
 
 #include "util/coordinate_calculation.hpp"
 #include "util/guidance/turn_bearing.hpp"
+#include "util/integer_range.hpp"
+#include "util/prefetch.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
@@ -78,37 +80,97 @@ void insertNodesInHeaps(Heap &forward_heap, Heap &reverse_heap, const PhantomNod
     }
 }
 
+// Prefetches the heap slot and the edge offsets of the target of the edge PREFETCH_DISTANCE
+// positions ahead of edge in an adjacency list that ends at end_edge, see util/prefetch.hpp
+template <typename FacadeT, typename Heap>
+void prefetchEdgeTarget(const FacadeT &facade,
+                        const Heap &heap,
+                        const EdgeID edge,
+                        const EdgeID end_edge)
+{
+    if (util::PREFETCH_DISTANCE > 0 && edge + util::PREFETCH_DISTANCE < end_edge)
+    {
+        const NodeID ahead = facade.GetSearchEdge(edge + util::PREFETCH_DISTANCE).target;
+        heap.Prefetch(ahead);
+        facade.PrefetchNode(ahead);
+    }
+}
+
+// The length of the geometry from the start of the forward and the reverse segment of the
+// phantom node up to its location, the distance counterpart of its weight plus offset
+struct PhantomDistances
+{
+    EdgeDistance forward = 0;
+    EdgeDistance reverse = 0;
+};
+
+template <typename FacadeT>
+PhantomDistances getPhantomDistances(const FacadeT &facade, const PhantomNode &phantom_node)
+{
+    const auto geometry_id = facade.GetGeometryIndex(phantom_node.forward_segment_id.id).id;
+    const auto geometry = facade.GetUncompressedForwardGeometry(geometry_id);
+    BOOST_ASSERT(phantom_node.fwd_segment_position + 1u < geometry.size());
+
+    PhantomDistances distances;
+    EdgeDistance total = 0;
+    for (const auto index : util::irange<std::size_t>(0, geometry.size() - 1))
+    {
+        const auto from = facade.GetCoordinateOfNode(geometry[index]);
+        if (index == phantom_node.fwd_segment_position)
+        {
+            distances.forward = total + util::coordinate_calculation::haversineDistance(
+                                            from, phantom_node.location);
+        }
+        total += util::coordinate_calculation::haversineDistance(
+            from, facade.GetCoordinateOfNode(geometry[index + 1]));
+    }
+    distances.reverse = std::max<EdgeDistance>(0, total - distances.forward);
+    return distances;
+}
+
 template <typename ManyToManyQueryHeap>
-void insertSourceInHeap(ManyToManyQueryHeap &heap, const PhantomNode &phantom_node)
+void insertSourceInHeap(ManyToManyQueryHeap &heap,
+                        const PhantomNode &phantom_node,
+                        const PhantomDistances &distances)
 {
     if (phantom_node.IsValidForwardSource())
     {
         heap.Insert(phantom_node.forward_segment_id.id,
                     -phantom_node.GetForwardWeightPlusOffset(),
-                    {phantom_node.forward_segment_id.id, -phantom_node.GetForwardDuration()});
+                    {phantom_node.forward_segment_id.id,
+                     -phantom_node.GetForwardDuration(),
+                     -distances.forward});
     }
     if (phantom_node.IsValidReverseSource())
     {
         heap.Insert(phantom_node.reverse_segment_id.id,
                     -phantom_node.GetReverseWeightPlusOffset(),
-                    {phantom_node.reverse_segment_id.id, -phantom_node.GetReverseDuration()});
+                    {phantom_node.reverse_segment_id.id,
+                     -phantom_node.GetReverseDuration(),
+                     -distances.reverse});
     }
 }
 
 template <typename ManyToManyQueryHeap>
-void insertTargetInHeap(ManyToManyQueryHeap &heap, const PhantomNode &phantom_node)
+void insertTargetInHeap(ManyToManyQueryHeap &heap,
+                        const PhantomNode &phantom_node,
+                        const PhantomDistances &distances)
 {
     if (phantom_node.IsValidForwardTarget())
     {
         heap.Insert(phantom_node.forward_segment_id.id,
                     phantom_node.GetForwardWeightPlusOffset(),
-                    {phantom_node.forward_segment_id.id, phantom_node.GetForwardDuration()});
+                    {phantom_node.forward_segment_id.id,
+                     phantom_node.GetForwardDuration(),
+                     distances.forward});
     }
     if (phantom_node.IsValidReverseTarget())
     {
         heap.Insert(phantom_node.reverse_segment_id.id,
                     phantom_node.GetReverseWeightPlusOffset(),
-                    {phantom_node.reverse_segment_id.id, phantom_node.GetReverseDuration()});
+                    {phantom_node.reverse_segment_id.id,
+                     phantom_node.GetReverseDuration(),
+                     distances.reverse});
     }
 }
 
@@ -134,42 +196,100 @@ void annotatePath(const FacadeT &facade,
     BOOST_ASSERT(phantom_node_pair.target_phantom.forward_segment_id.id == target_node_id ||
                  phantom_node_pair.target_phantom.reverse_segment_id.id == target_node_id);
 
-    // datastructures to hold extracted data from geometry
+    // datastructures to hold extracted data from geometry, the geometries of both directions
+    // are copied out of the facade's ranges into the same buffers for every edge
     std::vector<NodeID> id_vector;
     std::vector<EdgeWeight> weight_vector;
     std::vector<EdgeWeight> duration_vector;
     std::vector<DatasourceID> datasource_vector;
 
     const auto get_segment_geometry = [&](const auto geometry_index) {
+        const auto copy = [](auto &vector, const auto &range) {
+            vector.assign(range.begin(), range.end());
+        };
+
         if (geometry_index.forward)
         {
-            id_vector = facade.GetUncompressedForwardGeometry(geometry_index.id);
-            weight_vector = facade.GetUncompressedForwardWeights(geometry_index.id);
-            duration_vector = facade.GetUncompressedForwardDurations(geometry_index.id);
-            datasource_vector = facade.GetUncompressedForwardDatasources(geometry_index.id);
+            copy(id_vector, facade.GetUncompressedForwardGeometry(geometry_index.id));
+            copy(weight_vector, facade.GetUncompressedForwardWeights(geometry_index.id));
+            copy(duration_vector, facade.GetUncompressedForwardDurations(geometry_index.id));
+            copy(datasource_vector, facade.GetUncompressedForwardDatasources(geometry_index.id));
         }
         else
         {
-            id_vector = facade.GetUncompressedReverseGeometry(geometry_index.id);
-            weight_vector = facade.GetUncompressedReverseWeights(geometry_index.id);
-            duration_vector = facade.GetUncompressedReverseDurations(geometry_index.id);
-            datasource_vector = facade.GetUncompressedReverseDatasources(geometry_index.id);
+            copy(id_vector, facade.GetUncompressedReverseGeometry(geometry_index.id));
+            copy(weight_vector, facade.GetUncompressedReverseWeights(geometry_index.id));
+            copy(duration_vector, facade.GetUncompressedReverseDurations(geometry_index.id));
+            copy(datasource_vector, facade.GetUncompressedReverseDatasources(geometry_index.id));
         }
     };
 
-    auto node_from = unpacked_nodes.begin(), node_last = std::prev(unpacked_nodes.end());
-    for (auto edge = unpacked_edges.begin(); node_from != node_last; ++node_from, ++edge)
+    // The data of the nodes and turns of the path is gathered in passes that prefetch ahead,
+    // the path is built from the gathered data afterwards
+    struct NodeAnnotation
+    {
+        GeometryID geometry_index;
+        NameID name_index;
+        extractor::TravelMode travel_mode;
+        extractor::ClassData classes;
+        EdgeID turn_id;
+    };
+    const auto number_of_turns = unpacked_edges.size();
+    std::vector<NodeAnnotation> node_annotations(number_of_turns);
+    for (const auto index : util::irange<std::size_t>(0, number_of_turns))
+    {
+        if (index + util::ASSEMBLY_PREFETCH_DISTANCE < number_of_turns)
+        {
+            facade.PrefetchNodeData(unpacked_nodes[index + util::ASSEMBLY_PREFETCH_DISTANCE]);
+        }
+        const auto node_id = unpacked_nodes[index]; // edge-based graph node index
+        node_annotations[index] = {facade.GetGeometryIndex(node_id),
+                                   facade.GetNameIndex(node_id),
+                                   facade.GetTravelMode(node_id),
+                                   facade.GetClassData(node_id),
+                                   // edge-based graph edge index
+                                   facade.GetEdgeData(unpacked_edges[index]).turn_id};
+    }
+
+    struct TurnAnnotation
+    {
+        extractor::guidance::TurnInstruction turn_instruction;
+        bool has_lane_data;
+        util::guidance::LaneTupleIdPair lane_data;
+        util::guidance::EntryClass entry_class;
+        TurnPenalty turn_weight;
+        TurnPenalty turn_duration;
+        util::guidance::TurnBearing pre_turn_bearing;
+        util::guidance::TurnBearing post_turn_bearing;
+    };
+    std::vector<TurnAnnotation> turn_annotations(number_of_turns);
+    for (const auto index : util::irange<std::size_t>(0, number_of_turns))
+    {
+        if (index + util::ASSEMBLY_PREFETCH_DISTANCE < number_of_turns)
+        {
+            const auto &ahead = node_annotations[index + util::ASSEMBLY_PREFETCH_DISTANCE];
+            facade.PrefetchTurnData(ahead.turn_id);
+            facade.PrefetchGeometry(ahead.geometry_index.id);
+        }
+        const auto turn_id = node_annotations[index].turn_id;
+        auto &turn = turn_annotations[index];
+        turn.turn_instruction = facade.GetTurnInstructionForEdgeID(turn_id);
+        turn.has_lane_data = facade.HasLaneData(turn_id);
+        if (turn.has_lane_data)
+            turn.lane_data = facade.GetLaneData(turn_id);
+        turn.entry_class = facade.GetEntryClass(turn_id);
+        turn.turn_weight = facade.GetWeightPenaltyForEdgeID(turn_id);
+        turn.turn_duration = facade.GetDurationPenaltyForEdgeID(turn_id);
+        turn.pre_turn_bearing = facade.PreTurnBearing(turn_id);
+        turn.post_turn_bearing = facade.PostTurnBearing(turn_id);
+    }
+
+    for (const auto index : util::irange<std::size_t>(0, number_of_turns))
     {
-        const auto &edge_data = facade.GetEdgeData(*edge);
-        const auto turn_id = edge_data.turn_id; // edge-based graph edge index
-        const auto node_id = *node_from;        // edge-based graph node index
-        const auto name_index = facade.GetNameIndex(node_id);
-        const auto turn_instruction = facade.GetTurnInstructionForEdgeID(turn_id);
-        const extractor::TravelMode travel_mode = facade.GetTravelMode(node_id);
-        const auto classes = facade.GetClassData(node_id);
+        const auto &node = node_annotations[index];
+        const auto &turn = turn_annotations[index];
 
-        const auto geometry_index = facade.GetGeometryIndex(node_id);
-        get_segment_geometry(geometry_index);
+        get_segment_geometry(node.geometry_index);
 
         BOOST_ASSERT(id_vector.size() > 0);
         BOOST_ASSERT(datasource_vector.size() > 0);
@@ -190,35 +310,32 @@ void annotatePath(const FacadeT &facade,
         for (std::size_t segment_idx = start_index; segment_idx < end_index; ++segment_idx)
         {
             unpacked_path.push_back(PathData{id_vector[segment_idx + 1],
-                                             name_index,
+                                             node.name_index,
                                              weight_vector[segment_idx],
                                              0,
                                              duration_vector[segment_idx],
                                              0,
                                              extractor::guidance::TurnInstruction::NO_TURN(),
                                              {{0, INVALID_LANEID}, INVALID_LANE_DESCRIPTIONID},
-                                             travel_mode,
-                                             classes,
+                                             node.travel_mode,
+                                             node.classes,
                                              EMPTY_ENTRY_CLASS,
                                              datasource_vector[segment_idx],
                                              util::guidance::TurnBearing(0),
                                              util::guidance::TurnBearing(0)});
         }
         BOOST_ASSERT(unpacked_path.size() > 0);
-        if (facade.HasLaneData(turn_id))
-            unpacked_path.back().lane_data = facade.GetLaneData(turn_id);
-
-        const auto turn_duration = facade.GetDurationPenaltyForEdgeID(turn_id);
-        const auto turn_weight = facade.GetWeightPenaltyForEdgeID(turn_id);
-
-        unpacked_path.back().entry_class = facade.GetEntryClass(turn_id);
-        unpacked_path.back().turn_instruction = turn_instruction;
-        unpacked_path.back().duration_until_turn += turn_duration;
-        unpacked_path.back().duration_of_turn = turn_duration;
-        unpacked_path.back().weight_until_turn += turn_weight;
-        unpacked_path.back().weight_of_turn = turn_weight;
-        unpacked_path.back().pre_turn_bearing = facade.PreTurnBearing(turn_id);
-        unpacked_path.back().post_turn_bearing = facade.PostTurnBearing(turn_id);
+        if (turn.has_lane_data)
+            unpacked_path.back().lane_data = turn.lane_data;
+
+        unpacked_path.back().entry_class = turn.entry_class;
+        unpacked_path.back().turn_instruction = turn.turn_instruction;
+        unpacked_path.back().duration_until_turn += turn.turn_duration;
+        unpacked_path.back().duration_of_turn = turn.turn_duration;
+        unpacked_path.back().weight_until_turn += turn.turn_weight;
+        unpacked_path.back().weight_of_turn = turn.turn_weight;
+        unpacked_path.back().pre_turn_bearing = turn.pre_turn_bearing;
+        unpacked_path.back().post_turn_bearing = turn.post_turn_bearing;
     }
 
     std::size_t start_index = 0, end_index = 0;
@@ -254,22 +371,25 @@ void annotatePath(const FacadeT &facade,
     // t: fwd_segment 3
     // -> (U, v), (v, w), (w, x)
     // note that (x, t) is _not_ included but needs to be added later.
+    const auto target_name_index = facade.GetNameIndex(target_node_id);
+    const auto target_travel_mode = facade.GetTravelMode(target_node_id);
+    const auto target_classes = facade.GetClassData(target_node_id);
     for (std::size_t segment_idx = start_index; segment_idx != end_index;
          (start_index < end_index ? ++segment_idx : --segment_idx))
     {
         BOOST_ASSERT(segment_idx < id_vector.size() - 1);
-        BOOST_ASSERT(facade.GetTravelMode(target_node_id) > 0);
+        BOOST_ASSERT(target_travel_mode > 0);
         unpacked_path.push_back(
             PathData{id_vector[start_index < end_index ? segment_idx + 1 : segment_idx - 1],
-                     facade.GetNameIndex(target_node_id),
+                     target_name_index,
                      weight_vector[segment_idx],
                      0,
                      duration_vector[segment_idx],
                      0,
                      extractor::guidance::TurnInstruction::NO_TURN(),
                      {{0, INVALID_LANEID}, INVALID_LANE_DESCRIPTIONID},
-                     facade.GetTravelMode(target_node_id),
-                     facade.GetClassData(target_node_id),
+                     target_travel_mode,
+                     target_classes,
                      EMPTY_ENTRY_CLASS,
                      datasource_vector[segment_idx],
                      util::guidance::TurnBearing(0),
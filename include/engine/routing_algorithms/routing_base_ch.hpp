@@ -5,11 +5,17 @@
 #include "engine/datafacade.hpp"
 #include "engine/routing_algorithms/routing_base.hpp"
 #include "engine/search_engine_data.hpp"
+#include "engine/search_trace.hpp"
+#include "engine/unpacking_cache.hpp"
 
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
 
+#include <array>
+#include <memory>
+#include <utility>
+
 namespace osrm
 {
 namespace engine
@@ -30,16 +36,17 @@ bool stallAtNode(const DataFacade<Algorithm> &facade,
 {
     for (auto edge : facade.GetAdjacentEdgeRange(node))
     {
-        const auto &data = facade.GetEdgeData(edge);
-        if (DIRECTION == REVERSE_DIRECTION ? data.forward : data.backward)
+        const auto &search_edge = facade.GetSearchEdge(edge);
+        if (DIRECTION == REVERSE_DIRECTION ? search_edge.forward : search_edge.backward)
         {
-            const NodeID to = facade.GetTarget(edge);
-            const EdgeWeight edge_weight = data.weight;
+            const NodeID to = search_edge.target;
+            const EdgeWeight edge_weight = search_edge.weight;
             BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
             if (query_heap.WasInserted(to))
             {
                 if (query_heap.GetKey(to) + edge_weight < weight)
                 {
+                    SearchTracing::Stalled();
                     return true;
                 }
             }
@@ -54,13 +61,16 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
                         const EdgeWeight weight,
                         SearchEngineData<Algorithm>::QueryHeap &heap)
 {
+    const auto end_edge = facade.EndEdges(node);
     for (const auto edge : facade.GetAdjacentEdgeRange(node))
     {
-        const auto &data = facade.GetEdgeData(edge);
-        if (DIRECTION == FORWARD_DIRECTION ? data.forward : data.backward)
+        prefetchEdgeTarget(facade, heap, edge, end_edge);
+        const auto &search_edge = facade.GetSearchEdge(edge);
+        if (DIRECTION == FORWARD_DIRECTION ? search_edge.forward : search_edge.backward)
         {
-            const NodeID to = facade.GetTarget(edge);
-            const EdgeWeight edge_weight = data.weight;
+            SearchTracing::Relaxed();
+            const NodeID to = search_edge.target;
+            const EdgeWeight edge_weight = search_edge.weight;
 
             BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
             const EdgeWeight to_weight = weight + edge_weight;
@@ -122,6 +132,7 @@ void routingStep(const DataFacade<Algorithm> &facade,
                  const bool force_loop_forward,
                  const bool force_loop_reverse)
 {
+    SearchTracing::Settled(forward_heap.Size());
     const NodeID node = forward_heap.DeleteMin();
     const EdgeWeight weight = forward_heap.GetKey(node);
 
@@ -205,6 +216,40 @@ EdgeWeight getLoopWeight(const DataFacade<Algorithm> &facade, NodeID node)
     return loop_weight;
 }
 
+inline EdgeDistance getLoopDistance(const DataFacade<Algorithm> &facade, NodeID node)
+{
+    EdgeDistance loop_distance = INVALID_EDGE_DISTANCE;
+    for (auto edge : facade.GetAdjacentEdgeRange(node))
+    {
+        const auto &data = facade.GetEdgeData(edge);
+        if (data.forward && facade.GetTarget(edge) == node)
+        {
+            loop_distance = std::min(loop_distance, data.distance);
+        }
+    }
+    return loop_distance;
+}
+
+// Finds the CH edge a packed path takes from `from` to `to` and whether it was found on the
+// backward graph of `to`, i.e. is traversed against the order it is stored in.
+inline std::pair<EdgeID, bool>
+findPackedEdge(const DataFacade<Algorithm> &facade, const NodeID from, const NodeID to)
+{
+    // Look for an edge on the forward CH graph (.forward)
+    const EdgeID forward_edge_id =
+        facade.FindSmallestEdge(from, to, [](const auto &data) { return data.forward; });
+    if (SPECIAL_EDGEID != forward_edge_id)
+    {
+        return std::make_pair(forward_edge_id, false);
+    }
+
+    // If we didn't find one there, the we might be looking at a part of the path that
+    // was found using the backward search.  Here, we flip the node order (to, from)
+    // and only consider edges with the `.backward` flag.
+    return std::make_pair(
+        facade.FindSmallestEdge(to, from, [](const auto &data) { return data.backward; }), true);
+}
+
 /**
  * Given a sequence of connected `NodeID`s in the CH graph, performs a depth-first unpacking of
  * the shortcut
@@ -235,6 +280,8 @@ void unpackPath(const DataFacade<Algorithm> &facade,
     if (packed_path_begin == packed_path_end)
         return;
 
+    SearchTracing::UnpackingTimer unpacking_timer;
+
     std::stack<std::pair<NodeID, NodeID>> recursion_stack;
 
     // We have to push the path in reverse order onto the stack because it's LIFO.
@@ -250,20 +297,9 @@ void unpackPath(const DataFacade<Algorithm> &facade,
         edge = recursion_stack.top();
         recursion_stack.pop();
 
-        // Look for an edge on the forward CH graph (.forward)
-        EdgeID smaller_edge_id = facade.FindSmallestEdge(
-            edge.first, edge.second, [](const auto &data) { return data.forward; });
-
-        // If we didn't find one there, the we might be looking at a part of the path that
-        // was found using the backward search.  Here, we flip the node order (.second, .first)
-        // and only consider edges with the `.backward` flag.
-        if (SPECIAL_EDGEID == smaller_edge_id)
-        {
-            smaller_edge_id = facade.FindSmallestEdge(
-                edge.second, edge.first, [](const auto &data) { return data.backward; });
-        }
+        const EdgeID smaller_edge_id = findPackedEdge(facade, edge.first, edge.second).first;
 
-        // If we didn't find anything *still*, then something is broken and someone has
+        // If we didn't find anything in either graph, then something is broken and someone has
         // called this function with bad values.
         BOOST_ASSERT_MSG(smaller_edge_id != SPECIAL_EDGEID, "Invalid smaller edge ID");
 
@@ -288,12 +324,71 @@ void unpackPath(const DataFacade<Algorithm> &facade,
     }
 }
 
+/**
+ * Same as above, but looks the shortcuts of the packed path up in the unpacking cache, shortcuts
+ * not cached yet are unpacked once and inserted. Without a cache this is the plain unpacking.
+ */
+template <typename BidirectionalIterator, typename Callback>
+void unpackPath(const DataFacade<Algorithm> &facade,
+                const UnpackingCache::Handle &unpacking_cache,
+                BidirectionalIterator packed_path_begin,
+                BidirectionalIterator packed_path_end,
+                Callback &&callback)
+{
+    if (!unpacking_cache)
+    {
+        unpackPath(facade, packed_path_begin, packed_path_end, std::forward<Callback>(callback));
+        return;
+    }
+
+    if (packed_path_begin == packed_path_end)
+        return;
+
+    SearchTracing::UnpackingTimer unpacking_timer;
+    for (auto current = packed_path_begin; std::next(current) != packed_path_end; ++current)
+    {
+        std::pair<NodeID, NodeID> edge{*current, *std::next(current)};
+        const auto packed_edge = findPackedEdge(facade, edge.first, edge.second);
+        BOOST_ASSERT_MSG(packed_edge.first != SPECIAL_EDGEID, "Invalid smaller edge ID");
+
+        if (!facade.GetEdgeData(packed_edge.first).shortcut)
+        {
+            std::forward<Callback>(callback)(edge, packed_edge.first);
+            continue;
+        }
+
+        auto unpacked = unpacking_cache.Get(packed_edge.first, packed_edge.second);
+        if (!unpacked)
+        {
+            auto edges = std::make_shared<UnpackingCache::UnpackedShortcut>();
+            const std::array<NodeID, 2> shortcut{{edge.first, edge.second}};
+            unpackPath(facade,
+                       shortcut.begin(),
+                       shortcut.end(),
+                       [&edges](const std::pair<NodeID, NodeID> &original, const EdgeID edge_id) {
+                           edges->emplace_back(original.second, edge_id);
+                       });
+            unpacked = edges;
+            unpacking_cache.Insert(packed_edge.first, packed_edge.second, std::move(edges));
+        }
+
+        for (const auto &original : *unpacked)
+        {
+            edge.second = original.first;
+            std::forward<Callback>(callback)(edge, original.second);
+            edge.first = original.first;
+        }
+        BOOST_ASSERT(edge.first == *std::next(current));
+    }
+}
+
 template <typename RandomIter, typename FacadeT>
 void unpackPath(const FacadeT &facade,
                 RandomIter packed_path_begin,
                 RandomIter packed_path_end,
                 const PhantomNodes &phantom_nodes,
-                std::vector<PathData> &unpacked_path)
+                std::vector<PathData> &unpacked_path,
+                const UnpackingCache::Handle &unpacking_cache = UnpackingCache::Handle{})
 {
     const auto nodes_number = std::distance(packed_path_begin, packed_path_end);
     BOOST_ASSERT(nodes_number > 0);
@@ -307,6 +402,7 @@ void unpackPath(const FacadeT &facade,
     if (nodes_number > 1)
     {
         unpackPath(facade,
+                   unpacking_cache,
                    packed_path_begin,
                    packed_path_end,
                    [&](std::pair<NodeID, NodeID> &edge, const auto &edge_id) {
@@ -325,11 +421,13 @@ void unpackPath(const FacadeT &facade,
  * @param from the node the CH edge starts at
  * @param to the node the CH edge finishes at
  * @param unpacked_path the sequence of original NodeIDs that make up the expanded CH edge
+ * @param unpacking_cache the cache to look the edge up in if it is a shortcut
  */
 void unpackEdge(const DataFacade<Algorithm> &facade,
                 const NodeID from,
                 const NodeID to,
-                std::vector<NodeID> &unpacked_path);
+                std::vector<NodeID> &unpacked_path,
+                const UnpackingCache::Handle &unpacking_cache = UnpackingCache::Handle{});
 
 void retrievePackedPathFromHeap(const SearchEngineData<Algorithm>::QueryHeap &forward_heap,
                                 const SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
@@ -414,9 +512,15 @@ void unpackPath(const FacadeT &facade,
                 RandomIter packed_path_begin,
                 RandomIter packed_path_end,
                 const PhantomNodes &phantom_nodes,
-                std::vector<PathData> &unpacked_path)
+                std::vector<PathData> &unpacked_path,
+                const UnpackingCache::Handle &unpacking_cache = UnpackingCache::Handle{})
 {
-    return ch::unpackPath(facade, packed_path_begin, packed_path_end, phantom_nodes, unpacked_path);
+    return ch::unpackPath(facade,
+                          packed_path_begin,
+                          packed_path_end,
+                          phantom_nodes,
+                          unpacked_path,
+                          unpacking_cache);
 }
 
 } // namespace corech
@@ -3,17 +3,28 @@
 
 #include "engine/algorithm.hpp"
 #include "engine/datafacade.hpp"
+#include "engine/meeting_labels.hpp"
 #include "engine/routing_algorithms/routing_base.hpp"
 #include "engine/search_engine_data.hpp"
+#include "engine/search_trace.hpp"
 
+#include "extractor/conditional_turn_mask.hpp"
+
+#include "util/for_each_valid_weight.hpp"
 #include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
 
 #include <boost/assert.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
 #include <iterator>
 #include <limits>
+#include <thread>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -25,6 +36,187 @@ namespace routing_algorithms
 namespace mld
 {
 
+// The turns whose conditional restriction applies at the departure time of a query. The shortcuts
+// of the cells that contain one of them could run over it, so the search descends below these
+// cells and skips the restricted turns on the base graph edges.
+class RestrictedTurns
+{
+  public:
+    template <typename MultiLevelPartition>
+    RestrictedTurns(const MultiLevelPartition &partition,
+                    const util::vector_view<const extractor::ConditionalTurnMask> &masks,
+                    const std::uint32_t minute_of_week)
+        : restricted_cells(partition.GetNumberOfLevels())
+    {
+        for (const auto &mask : masks)
+        {
+            if (!mask.IsActive(minute_of_week))
+                continue;
+
+            // the masks are sorted by their turn
+            turns.emplace_back(mask.from, mask.to);
+
+            // both nodes share the cells above the highest level that separates them
+            const auto number_of_levels = partition.GetNumberOfLevels();
+            for (LevelID level = partition.GetHighestDifferentLevel(mask.from, mask.to) + 1;
+                 level < number_of_levels;
+                 ++level)
+            {
+                restricted_cells[level].push_back(partition.GetCell(level, mask.from));
+            }
+        }
+
+        for (auto &cells : restricted_cells)
+        {
+            std::sort(cells.begin(), cells.end());
+            cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+        }
+    }
+
+    bool IsRestricted(const NodeID from, const NodeID to) const
+    {
+        return std::binary_search(turns.begin(), turns.end(), std::make_pair(from, to));
+    }
+
+    bool IsRestricted(const LevelID level, const CellID cell) const
+    {
+        const auto &cells = restricted_cells[level];
+        return std::binary_search(cells.begin(), cells.end(), cell);
+    }
+
+    // No turn is restricted at the departure time, the unrestricted search finds the same path
+    bool Empty() const { return turns.empty(); }
+
+  private:
+    std::vector<std::pair<NodeID, NodeID>> turns;
+    std::vector<std::vector<CellID>> restricted_cells;
+};
+
+// Potentials of a query by the lower bounds of the landmarks (ALT). The potential of a node is the
+// bound of the weight from it to the targets minus the one of the weight from the sources to it,
+// the forward search adds it to its keys and the reverse search subtracts it. Both bounds are
+// consistent, so the keys never decrease along an edge and the searches are done once the sum
+// of their minimal keys reaches the weight of the best path. To stay integral the keys are twice
+// the weight plus or minus the potential.
+class LandmarkPotentials
+{
+  public:
+    using Nodes = std::vector<std::pair<NodeID, EdgeWeight>>;
+
+    LandmarkPotentials(const customizer::LandmarksView &landmarks,
+                       const PhantomNodes &phantom_nodes)
+        : landmarks(landmarks)
+    {
+        // the same nodes and weights as insertNodesInHeaps without potentials
+        const auto &source = phantom_nodes.source_phantom;
+        if (source.IsValidForwardSource())
+            sources.emplace_back(source.forward_segment_id.id,
+                                 -source.GetForwardWeightPlusOffset());
+        if (source.IsValidReverseSource())
+            sources.emplace_back(source.reverse_segment_id.id,
+                                 -source.GetReverseWeightPlusOffset());
+
+        const auto &target = phantom_nodes.target_phantom;
+        if (target.IsValidForwardTarget())
+            targets.emplace_back(target.forward_segment_id.id,
+                                 target.GetForwardWeightPlusOffset());
+        if (target.IsValidReverseTarget())
+            targets.emplace_back(target.reverse_segment_id.id,
+                                 target.GetReverseWeightPlusOffset());
+    }
+
+    const Nodes &GetSources() const { return sources; }
+
+    const Nodes &GetTargets() const { return targets; }
+
+    template <bool DIRECTION> EdgeWeight ToKey(const NodeID node, const EdgeWeight weight) const
+    {
+        const auto potential = GetPotential(node);
+        return 2 * weight + (DIRECTION == FORWARD_DIRECTION ? potential : -potential);
+    }
+
+    template <bool DIRECTION> EdgeWeight ToWeight(const NodeID node, const EdgeWeight key) const
+    {
+        const auto potential = GetPotential(node);
+        return (key - (DIRECTION == FORWARD_DIRECTION ? potential : -potential)) / 2;
+    }
+
+    // The searches can stop once the sum of their minimal keys reaches this
+    std::int64_t GetStoppingKey(const EdgeWeight weight) const { return 2 * std::int64_t{weight}; }
+
+  private:
+    EdgeWeight GetPotential(const NodeID node) const
+    {
+        std::int64_t to_targets = 0;
+        if (!targets.empty())
+        {
+            to_targets = std::numeric_limits<std::int64_t>::max();
+            for (const auto &target : targets)
+            {
+                to_targets = std::min<std::int64_t>(
+                    to_targets,
+                    std::int64_t{landmarks.GetLowerBound(node, target.first)} + target.second);
+            }
+        }
+
+        std::int64_t from_sources = 0;
+        if (!sources.empty())
+        {
+            from_sources = std::numeric_limits<std::int64_t>::max();
+            for (const auto &source : sources)
+            {
+                from_sources = std::min<std::int64_t>(
+                    from_sources,
+                    std::int64_t{landmarks.GetLowerBound(source.first, node)} + source.second);
+            }
+        }
+
+        return static_cast<EdgeWeight>(to_targets - from_sources);
+    }
+
+    const customizer::LandmarksView &landmarks;
+    Nodes sources;
+    Nodes targets;
+};
+
+// The heap keys of a search that is not directed by potentials are its weights. It has the
+// interface of LandmarkPotentials, so the search kernels are instantiated for either of them and
+// don't check per edge which one they use.
+struct WeightKeys
+{
+    template <bool DIRECTION> EdgeWeight ToKey(const NodeID, const EdgeWeight weight) const
+    {
+        return weight;
+    }
+
+    template <bool DIRECTION> EdgeWeight ToWeight(const NodeID, const EdgeWeight key) const
+    {
+        return key;
+    }
+
+    std::int64_t GetStoppingKey(const EdgeWeight weight) const { return weight; }
+};
+
+// Inserts the nodes of the phantom nodes the potentials were made from with their keys
+template <typename Heap>
+void insertNodesInHeaps(Heap &forward_heap,
+                        Heap &reverse_heap,
+                        const LandmarkPotentials &potentials)
+{
+    for (const auto &source : potentials.GetSources())
+    {
+        forward_heap.Insert(source.first,
+                            potentials.ToKey<FORWARD_DIRECTION>(source.first, source.second),
+                            source.first);
+    }
+    for (const auto &target : potentials.GetTargets())
+    {
+        reverse_heap.Insert(target.first,
+                            potentials.ToKey<REVERSE_DIRECTION>(target.first, target.second),
+                            target.first);
+    }
+}
+
 namespace
 {
 // Unrestricted search (Args is const PhantomNodes &):
@@ -52,6 +244,72 @@ inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
 
 inline bool checkParentCellRestriction(CellID, const PhantomNodes &) { return true; }
 
+inline bool isRestrictedTurn(NodeID, NodeID, const PhantomNodes &) { return false; }
+
+inline WeightKeys getKeys(const PhantomNodes &) { return {}; }
+
+// Unrestricted search avoiding turns (Args is const PhantomNodes &, const RestrictedTurns &):
+//   * lower the node query level below the cells that contain a restricted turn
+//   * skip the restricted turns
+template <typename MultiLevelPartition>
+inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
+                                 NodeID node,
+                                 const PhantomNodes &phantom_nodes,
+                                 const RestrictedTurns &restricted_turns)
+{
+    auto level = getNodeQueryLevel(partition, node, phantom_nodes);
+    while (level >= 1 && level != INVALID_LEVEL_ID &&
+           restricted_turns.IsRestricted(level, partition.GetCell(level, node)))
+    {
+        --level;
+    }
+    return level;
+}
+
+inline bool checkParentCellRestriction(CellID, const PhantomNodes &, const RestrictedTurns &)
+{
+    return true;
+}
+
+inline bool isRestrictedTurn(NodeID from,
+                             NodeID to,
+                             const PhantomNodes &,
+                             const RestrictedTurns &restricted_turns)
+{
+    return restricted_turns.IsRestricted(from, to);
+}
+
+inline WeightKeys getKeys(const PhantomNodes &, const RestrictedTurns &) { return {}; }
+
+// Unrestricted search directed by landmarks (Args is const PhantomNodes &,
+// const LandmarkPotentials &):
+//   * use the node query level of the unrestricted search
+//   * the heap keys are the weights combined with the potentials
+template <typename MultiLevelPartition>
+inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
+                                 NodeID node,
+                                 const PhantomNodes &phantom_nodes,
+                                 const LandmarkPotentials &)
+{
+    return getNodeQueryLevel(partition, node, phantom_nodes);
+}
+
+inline bool checkParentCellRestriction(CellID, const PhantomNodes &, const LandmarkPotentials &)
+{
+    return true;
+}
+
+inline bool isRestrictedTurn(NodeID, NodeID, const PhantomNodes &, const LandmarkPotentials &)
+{
+    return false;
+}
+
+inline const LandmarkPotentials &getKeys(const PhantomNodes &,
+                                         const LandmarkPotentials &potentials)
+{
+    return potentials;
+}
+
 // Restricted search (Args is LevelID, CellID):
 //   * use the fixed level for queries
 //   * check if the node cell is the same as the specified parent onr
@@ -65,6 +323,10 @@ inline bool checkParentCellRestriction(CellID cell, LevelID, CellID parent)
 {
     return cell == parent;
 }
+
+inline bool isRestrictedTurn(NodeID, NodeID, LevelID, CellID) { return false; }
+
+inline WeightKeys getKeys(LevelID, CellID) { return {}; }
 }
 
 // Heaps only record for each node its predecessor ("parent") on the shortest path.
@@ -131,71 +393,63 @@ retrievePackedPathFromHeap(const SearchEngineData<Algorithm>::QueryHeap &forward
     return packed_path;
 }
 
-template <bool DIRECTION, typename Algorithm, typename... Args>
-void routingStep(const DataFacade<Algorithm> &facade,
-                 typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
-                 typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
-                 NodeID &middle_node,
-                 EdgeWeight &path_upper_bound,
-                 const bool force_loop_forward,
-                 const bool force_loop_reverse,
-                 Args... args)
+// Relaxes the shortcuts and the border edges of a node the search settled with the weight.
+// labeled(to, to_weight) is called for every node whose weight it improved.
+template <bool DIRECTION, typename Algorithm, typename Labeled, typename... Args>
+void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
+                        typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                        const NodeID node,
+                        const EdgeWeight weight,
+                        const Labeled &labeled,
+                        Args... args)
 {
     const auto &partition = facade.GetMultiLevelPartition();
     const auto &cells = facade.GetCellStorage();
 
-    const auto node = forward_heap.DeleteMin();
-    const auto weight = forward_heap.GetKey(node);
-
-    // Upper bound for the path source -> target with
-    // weight(source -> node) = weight weight(to -> target) ≤ reverse_weight
-    // is weight + reverse_weight
-    // More tighter upper bound requires additional condition reverse_heap.WasRemoved(to)
-    // with weight(to -> target) = reverse_weight and all weights ≥ 0
-    if (reverse_heap.WasInserted(node))
-    {
-        auto reverse_weight = reverse_heap.GetKey(node);
-        auto path_weight = weight + reverse_weight;
-
-        // if loops are forced, they are so at the source
-        if (!(force_loop_forward && forward_heap.GetData(node).parent == node) &&
-            !(force_loop_reverse && reverse_heap.GetData(node).parent == node) &&
-            (path_weight >= 0) && (path_weight < path_upper_bound))
+    // the heap keys are the weights unless the search is directed by potentials
+    const auto &keys = getKeys(args...);
+    const auto relax = [&](const NodeID to, const EdgeWeight to_weight, const bool clique_arc) {
+        const auto key = keys.template ToKey<DIRECTION>(to, to_weight);
+        if (!forward_heap.WasInserted(to))
         {
-            middle_node = node;
-            path_upper_bound = path_weight;
+            forward_heap.Insert(to, key, {node, clique_arc});
+            labeled(to, to_weight);
         }
-    }
+        else if (key < forward_heap.GetKey(to))
+        {
+            forward_heap.GetData(to) = {node, clique_arc};
+            forward_heap.DecreaseKey(to, key);
+            labeled(to, to_weight);
+        }
+    };
 
     const auto level = getNodeQueryLevel(partition, node, args...);
 
     if (level >= 1 && !forward_heap.GetData(node).from_clique_arc)
     {
+        SearchTracing::CellCrossed(level);
         if (DIRECTION == FORWARD_DIRECTION)
         {
-            // Shortcuts in forward direction
+            // Shortcuts in forward direction, a row of the cell is contiguous
             const auto &cell = cells.GetCell(level, partition.GetCell(level, node));
-            auto destination = cell.GetDestinationNodes().begin();
-            for (auto shortcut_weight : cell.GetOutWeight(node))
-            {
-                BOOST_ASSERT(destination != cell.GetDestinationNodes().end());
-                const NodeID to = *destination;
-                if (shortcut_weight != INVALID_EDGE_WEIGHT && node != to)
-                {
-                    const EdgeWeight to_weight = weight + shortcut_weight;
+            const auto destinations = cell.GetDestinationNodes();
+            const auto shortcut_weights = cell.GetOutWeight(node);
+            BOOST_ASSERT(shortcut_weights.empty() ||
+                         shortcut_weights.size() == destinations.size());
+            util::for_each_valid_weight(
+                shortcut_weights.begin(),
+                shortcut_weights.size(),
+                weight,
+                [&](const std::size_t index, const EdgeWeight to_weight) {
+                    const NodeID to = destinations[index];
                     BOOST_ASSERT(to_weight >= weight);
-                    if (!forward_heap.WasInserted(to))
+                    if (node == to)
                     {
-                        forward_heap.Insert(to, to_weight, {node, true});
+                        return;
                     }
-                    else if (to_weight < forward_heap.GetKey(to))
-                    {
-                        forward_heap.GetData(to) = {node, true};
-                        forward_heap.DecreaseKey(to, to_weight);
-                    }
-                }
-                ++destination;
-            }
+                    SearchTracing::Relaxed();
+                    relax(to, to_weight, true);
+                });
         }
         else
         {
@@ -208,17 +462,10 @@ void routingStep(const DataFacade<Algorithm> &facade,
                 const NodeID to = *source;
                 if (shortcut_weight != INVALID_EDGE_WEIGHT && node != to)
                 {
+                    SearchTracing::Relaxed();
                     const EdgeWeight to_weight = weight + shortcut_weight;
                     BOOST_ASSERT(to_weight >= weight);
-                    if (!forward_heap.WasInserted(to))
-                    {
-                        forward_heap.Insert(to, to_weight, {node, true});
-                    }
-                    else if (to_weight < forward_heap.GetKey(to))
-                    {
-                        forward_heap.GetData(to) = {node, true};
-                        forward_heap.DecreaseKey(to, to_weight);
-                    }
+                    relax(to, to_weight, true);
                 }
                 ++source;
             }
@@ -226,32 +473,69 @@ void routingStep(const DataFacade<Algorithm> &facade,
     }
 
     // Boundary edges
+    const auto end_edge = facade.EndEdges(node);
     for (const auto edge : facade.GetBorderEdgeRange(level, node))
     {
-        const auto &edge_data = facade.GetEdgeData(edge);
-        if (DIRECTION == FORWARD_DIRECTION ? edge_data.forward : edge_data.backward)
+        prefetchEdgeTarget(facade, forward_heap, edge, end_edge);
+        const auto &search_edge = facade.GetSearchEdge(edge);
+        if (DIRECTION == FORWARD_DIRECTION ? search_edge.forward : search_edge.backward)
         {
-            const NodeID to = facade.GetTarget(edge);
+            SearchTracing::Relaxed();
+            const NodeID to = search_edge.target;
 
-            if (checkParentCellRestriction(partition.GetCell(level + 1, to), args...))
+            if (checkParentCellRestriction(partition.GetCell(level + 1, to), args...) &&
+                !isRestrictedTurn(DIRECTION == FORWARD_DIRECTION ? node : to,
+                                  DIRECTION == FORWARD_DIRECTION ? to : node,
+                                  args...))
             {
-                BOOST_ASSERT_MSG(edge_data.weight > 0, "edge_weight invalid");
-                const EdgeWeight to_weight = weight + edge_data.weight;
-
-                if (!forward_heap.WasInserted(to))
-                {
-                    forward_heap.Insert(to, to_weight, {node, false});
-                }
-                else if (to_weight < forward_heap.GetKey(to))
-                {
-                    forward_heap.GetData(to) = {node, false};
-                    forward_heap.DecreaseKey(to, to_weight);
-                }
+                BOOST_ASSERT_MSG(search_edge.weight > 0, "edge_weight invalid");
+                relax(to, weight + search_edge.weight, false);
             }
         }
     }
 }
 
+template <bool DIRECTION, typename Algorithm, typename... Args>
+void routingStep(const DataFacade<Algorithm> &facade,
+                 typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                 typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                 NodeID &middle_node,
+                 EdgeWeight &path_upper_bound,
+                 const bool force_loop_forward,
+                 const bool force_loop_reverse,
+                 Args... args)
+{
+    SearchTracing::Settled(forward_heap.Size());
+
+    const auto &keys = getKeys(args...);
+    const auto node = forward_heap.DeleteMin();
+    const auto node_key = forward_heap.GetKey(node);
+    const auto weight = keys.template ToWeight<DIRECTION>(node, node_key);
+
+    // Upper bound for the path source -> target with
+    // weight(source -> node) = weight weight(to -> target) ≤ reverse_weight
+    // is weight + reverse_weight
+    // More tighter upper bound requires additional condition reverse_heap.WasRemoved(to)
+    // with weight(to -> target) = reverse_weight and all weights ≥ 0
+    if (reverse_heap.WasInserted(node))
+    {
+        auto reverse_weight = keys.template ToWeight<!DIRECTION>(node, reverse_heap.GetKey(node));
+        auto path_weight = weight + reverse_weight;
+
+        // if loops are forced, they are so at the source
+        if (!(force_loop_forward && forward_heap.GetData(node).parent == node) &&
+            !(force_loop_reverse && reverse_heap.GetData(node).parent == node) &&
+            (path_weight >= 0) && (path_weight < path_upper_bound))
+        {
+            middle_node = node;
+            path_upper_bound = path_weight;
+        }
+    }
+
+    relaxOutgoingEdges<DIRECTION>(
+        facade, forward_heap, node, weight, [](const NodeID, const EdgeWeight) {}, args...);
+}
+
 // With (s, middle, t) we trace back the paths middle -> s and middle -> t.
 // This gives us a packed path (node ids) from the base graph around s and t,
 // and overlay node ids otherwise. We then have to unpack the overlay clique
@@ -261,6 +545,127 @@ using UnpackedNodes = std::vector<NodeID>;
 using UnpackedEdges = std::vector<EdgeID>;
 using UnpackedPath = std::tuple<EdgeWeight, UnpackedNodes, UnpackedEdges>;
 
+template <typename Algorithm, typename... Args>
+UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
+                    const DataFacade<Algorithm> &facade,
+                    typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                    typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                    const bool force_loop_forward,
+                    const bool force_loop_reverse,
+                    EdgeWeight weight_upper_bound,
+                    Args... args);
+
+// Appends the base graph path of the overlay edge source -> target, which a search took on the
+// level, to the unpacked path that ends at source. The cell of the edge is searched again one
+// level below, with the heaps given.
+template <typename Algorithm>
+void unpackOverlayEdge(SearchEngineData<Algorithm> &engine_working_data,
+                       const DataFacade<Algorithm> &facade,
+                       typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                       typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                       const bool force_loop_forward,
+                       const bool force_loop_reverse,
+                       const NodeID source,
+                       const NodeID target,
+                       const LevelID level,
+                       UnpackedNodes &unpacked_nodes,
+                       UnpackedEdges &unpacked_edges)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    CellID parent_cell_id = partition.GetCell(level, source);
+    BOOST_ASSERT(parent_cell_id == partition.GetCell(level, target));
+
+    LevelID sublevel = level - 1;
+
+    // Here heaps can be reused, let's go deeper!
+    forward_heap.Clear();
+    reverse_heap.Clear();
+    forward_heap.Insert(source, 0, {source});
+    reverse_heap.Insert(target, 0, {target});
+
+    // TODO: when structured bindings will be allowed change to
+    // auto [subpath_weight, subpath_source, subpath_target, subpath] = ...
+    EdgeWeight subpath_weight;
+    std::vector<NodeID> subpath_nodes;
+    std::vector<EdgeID> subpath_edges;
+    std::tie(subpath_weight, subpath_nodes, subpath_edges) = search(engine_working_data,
+                                                                    facade,
+                                                                    forward_heap,
+                                                                    reverse_heap,
+                                                                    force_loop_forward,
+                                                                    force_loop_reverse,
+                                                                    INVALID_EDGE_WEIGHT,
+                                                                    sublevel,
+                                                                    parent_cell_id);
+    BOOST_ASSERT(!subpath_edges.empty());
+    BOOST_ASSERT(subpath_nodes.size() > 1);
+    BOOST_ASSERT(subpath_nodes.front() == source);
+    BOOST_ASSERT(subpath_nodes.back() == target);
+    unpacked_nodes.insert(
+        unpacked_nodes.end(), std::next(subpath_nodes.begin()), subpath_nodes.end());
+    unpacked_edges.insert(unpacked_edges.end(), subpath_edges.begin(), subpath_edges.end());
+}
+
+// Traces back the path of the given weight over the middle node in the heaps of a finished
+// search and unpacks its overlay edges, the heaps are reused for that
+template <typename Algorithm, typename... Args>
+UnpackedPath unpackSearchPath(SearchEngineData<Algorithm> &engine_working_data,
+                              const DataFacade<Algorithm> &facade,
+                              typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                              typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                              const bool force_loop_forward,
+                              const bool force_loop_reverse,
+                              const NodeID middle,
+                              const EdgeWeight weight,
+                              Args... args)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+
+    // Get packed path as edges {from node ID, to node ID, from_clique_arc}
+    auto packed_path = retrievePackedPathFromHeap(forward_heap, reverse_heap, middle);
+
+    // Beware the edge case when start, middle, end are all the same.
+    // In this case we return a single node, no edges. We also don't unpack.
+    const NodeID source_node = !packed_path.empty() ? std::get<0>(packed_path.front()) : middle;
+
+    // Unpack path
+    SearchTracing::UnpackingTimer unpacking_timer;
+    std::vector<NodeID> unpacked_nodes;
+    std::vector<EdgeID> unpacked_edges;
+    unpacked_nodes.reserve(packed_path.size());
+    unpacked_edges.reserve(packed_path.size());
+
+    unpacked_nodes.push_back(source_node);
+
+    for (auto const &packed_edge : packed_path)
+    {
+        NodeID source, target;
+        bool overlay_edge;
+        std::tie(source, target, overlay_edge) = packed_edge;
+        if (!overlay_edge)
+        { // a base graph edge
+            unpacked_nodes.push_back(target);
+            unpacked_edges.push_back(facade.FindEdge(source, target));
+        }
+        else
+        { // an overlay graph edge
+            unpackOverlayEdge(engine_working_data,
+                              facade,
+                              forward_heap,
+                              reverse_heap,
+                              force_loop_forward,
+                              force_loop_reverse,
+                              source,
+                              target,
+                              getNodeQueryLevel(partition, source, args...),
+                              unpacked_nodes,
+                              unpacked_edges);
+        }
+    }
+
+    return std::make_tuple(weight, std::move(unpacked_nodes), std::move(unpacked_edges));
+}
+
 template <typename Algorithm, typename... Args>
 UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
                     const DataFacade<Algorithm> &facade,
@@ -276,19 +681,19 @@ UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
         return std::make_tuple(INVALID_EDGE_WEIGHT, std::vector<NodeID>(), std::vector<EdgeID>());
     }
 
-    const auto &partition = facade.GetMultiLevelPartition();
-
     BOOST_ASSERT(!forward_heap.Empty() && forward_heap.MinKey() < INVALID_EDGE_WEIGHT);
     BOOST_ASSERT(!reverse_heap.Empty() && reverse_heap.MinKey() < INVALID_EDGE_WEIGHT);
 
     // run two-Target Dijkstra routing step.
+    const auto &keys = getKeys(args...);
     NodeID middle = SPECIAL_NODEID;
     EdgeWeight weight = weight_upper_bound;
     EdgeWeight forward_heap_min = forward_heap.MinKey();
     EdgeWeight reverse_heap_min = reverse_heap.MinKey();
     while (forward_heap.Size() + reverse_heap.Size() > 0 &&
-           forward_heap_min + reverse_heap_min < weight)
+           std::int64_t{forward_heap_min} + reverse_heap_min < keys.GetStoppingKey(weight))
     {
+        engine_working_data.deadline.Check();
         if (!forward_heap.Empty())
         {
             routingStep<FORWARD_DIRECTION>(facade,
@@ -323,70 +728,189 @@ UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
         return std::make_tuple(INVALID_EDGE_WEIGHT, std::vector<NodeID>(), std::vector<EdgeID>());
     }
 
-    // Get packed path as edges {from node ID, to node ID, from_clique_arc}
-    auto packed_path = retrievePackedPathFromHeap(forward_heap, reverse_heap, middle);
+    return unpackSearchPath(engine_working_data,
+                            facade,
+                            forward_heap,
+                            reverse_heap,
+                            force_loop_forward,
+                            force_loop_reverse,
+                            middle,
+                            weight,
+                            args...);
+}
 
-    // Beware the edge case when start, middle, end are all the same.
-    // In this case we return a single node, no edges. We also don't unpack.
-    const NodeID source_node = !packed_path.empty() ? std::get<0>(packed_path.front()) : middle;
+// The steps of one direction of parallelSearch. The search stops once the sum of its minimal key
+// and the last one the other direction published reaches the best path: as the keys never
+// decrease, every node the other direction has a smaller key for was settled and its edges were
+// labeled by then. An exhausted search publishes a key that stops the other one right away.
+template <bool DIRECTION, typename Algorithm, typename... Args>
+void parallelRoutingSteps(const DataFacade<Algorithm> &facade,
+                          typename SearchEngineData<Algorithm>::QueryHeap &heap,
+                          MeetingLabels &labels,
+                          std::atomic<std::int64_t> &min_key,
+                          const std::atomic<std::int64_t> &other_min_key,
+                          const std::atomic<bool> &aborted,
+                          Deadline deadline,
+                          Args... args)
+{
+    const auto &keys = getKeys(args...);
+    const auto labeled = [&labels](const NodeID to, const EdgeWeight to_weight) {
+        labels.Label(DIRECTION, to, to_weight);
+    };
 
-    // Unpack path
-    std::vector<NodeID> unpacked_nodes;
-    std::vector<EdgeID> unpacked_edges;
-    unpacked_nodes.reserve(packed_path.size());
-    unpacked_edges.reserve(packed_path.size());
+    while (!heap.Empty() && !aborted.load(std::memory_order_relaxed))
+    {
+        const auto best_weight = labels.GetBestWeight();
+        if (heap.MinKey() + other_min_key.load() >= keys.GetStoppingKey(best_weight))
+        {
+            break;
+        }
+        deadline.Check();
 
-    unpacked_nodes.push_back(source_node);
+        SearchTracing::Settled(heap.Size());
+        const auto node = heap.DeleteMin();
+        const auto node_key = heap.GetKey(node);
+        const auto weight = keys.template ToWeight<DIRECTION>(node, node_key);
+        relaxOutgoingEdges<DIRECTION>(facade, heap, node, weight, labeled, args...);
 
-    for (auto const &packed_edge : packed_path)
+        min_key.store(heap.Empty() ? std::numeric_limits<std::int64_t>::max() / 4
+                                   : std::int64_t{heap.MinKey()});
+    }
+}
+
+// Same as search with the phantom nodes, but runs the forward search on the calling thread and
+// the reverse search on a thread of its own. The heaps have to hold the nodes of the phantom
+// nodes, neither thread looks into the heap of the other one: they meet in MeetingLabels, whose
+// best path is the only state they share besides their published minimal keys. Loops can't be
+// forced and only the path is unpacked on the calling thread after both searches finished.
+//
+// Starting the thread costs some microseconds, so this only pays off for long routes.
+template <typename Algorithm, typename... Args>
+UnpackedPath parallelSearch(SearchEngineData<Algorithm> &engine_working_data,
+                            const DataFacade<Algorithm> &facade,
+                            typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                            typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                            EdgeWeight weight_upper_bound,
+                            const PhantomNodes &phantom_nodes,
+                            Args... args)
+{
+    if (forward_heap.Empty() || reverse_heap.Empty())
     {
-        NodeID source, target;
-        bool overlay_edge;
-        std::tie(source, target, overlay_edge) = packed_edge;
-        if (!overlay_edge)
-        { // a base graph edge
-            unpacked_nodes.push_back(target);
-            unpacked_edges.push_back(facade.FindEdge(source, target));
+        return std::make_tuple(INVALID_EDGE_WEIGHT, std::vector<NodeID>(), std::vector<EdgeID>());
+    }
+
+    // Only paths between a source and a target on the same segment can have a negative weight.
+    // Once such a path was skipped at a node, the labels of the node can't improve anymore and
+    // the valid paths over it that the other direction labeled earlier are lost. The sequential
+    // search checks the labels in settle order and finds them.
+    const auto &source = phantom_nodes.source_phantom;
+    const auto &target = phantom_nodes.target_phantom;
+    const auto is_source = [&source](const SegmentID &segment) {
+        return segment.enabled && ((source.IsValidForwardSource() &&
+                                    source.forward_segment_id.id == segment.id) ||
+                                   (source.IsValidReverseSource() &&
+                                    source.reverse_segment_id.id == segment.id));
+    };
+    if ((target.IsValidForwardTarget() && is_source(target.forward_segment_id)) ||
+        (target.IsValidReverseTarget() && is_source(target.reverse_segment_id)))
+    {
+        return search(engine_working_data,
+                      facade,
+                      forward_heap,
+                      reverse_heap,
+                      DO_NOT_FORCE_LOOPS,
+                      DO_NOT_FORCE_LOOPS,
+                      weight_upper_bound,
+                      phantom_nodes,
+                      args...);
+    }
+
+    engine_working_data.InitializeOrClearMeetingLabels(facade.GetNumberOfNodes());
+    auto &labels = *engine_working_data.meeting_labels;
+    labels.Clear(weight_upper_bound);
+
+    // the same nodes and weights insertNodesInHeaps inserted
+    if (source.IsValidForwardSource())
+        labels.Label(
+            FORWARD_DIRECTION, source.forward_segment_id.id, -source.GetForwardWeightPlusOffset());
+    if (source.IsValidReverseSource())
+        labels.Label(
+            FORWARD_DIRECTION, source.reverse_segment_id.id, -source.GetReverseWeightPlusOffset());
+    if (target.IsValidForwardTarget())
+        labels.Label(
+            REVERSE_DIRECTION, target.forward_segment_id.id, target.GetForwardWeightPlusOffset());
+    if (target.IsValidReverseTarget())
+        labels.Label(
+            REVERSE_DIRECTION, target.reverse_segment_id.id, target.GetReverseWeightPlusOffset());
+
+    std::atomic<std::int64_t> forward_min_key{forward_heap.MinKey()};
+    std::atomic<std::int64_t> reverse_min_key{reverse_heap.MinKey()};
+    std::atomic<bool> aborted{false};
+
+    std::exception_ptr reverse_error;
+    const auto trace = SearchTracing::Current();
+    std::thread reverse_thread([&] {
+        SearchTracing::WorkerScope trace_scope(trace);
+        try
+        {
+            parallelRoutingSteps<REVERSE_DIRECTION>(facade,
+                                                    reverse_heap,
+                                                    labels,
+                                                    reverse_min_key,
+                                                    forward_min_key,
+                                                    aborted,
+                                                    engine_working_data.deadline,
+                                                    phantom_nodes,
+                                                    args...);
         }
-        else
-        { // an overlay graph edge
-            LevelID level = getNodeQueryLevel(partition, source, args...);
-            CellID parent_cell_id = partition.GetCell(level, source);
-            BOOST_ASSERT(parent_cell_id == partition.GetCell(level, target));
-
-            LevelID sublevel = level - 1;
-
-            // Here heaps can be reused, let's go deeper!
-            forward_heap.Clear();
-            reverse_heap.Clear();
-            forward_heap.Insert(source, 0, {source});
-            reverse_heap.Insert(target, 0, {target});
-
-            // TODO: when structured bindings will be allowed change to
-            // auto [subpath_weight, subpath_source, subpath_target, subpath] = ...
-            EdgeWeight subpath_weight;
-            std::vector<NodeID> subpath_nodes;
-            std::vector<EdgeID> subpath_edges;
-            std::tie(subpath_weight, subpath_nodes, subpath_edges) = search(engine_working_data,
-                                                                            facade,
-                                                                            forward_heap,
-                                                                            reverse_heap,
-                                                                            force_loop_forward,
-                                                                            force_loop_reverse,
-                                                                            INVALID_EDGE_WEIGHT,
-                                                                            sublevel,
-                                                                            parent_cell_id);
-            BOOST_ASSERT(!subpath_edges.empty());
-            BOOST_ASSERT(subpath_nodes.size() > 1);
-            BOOST_ASSERT(subpath_nodes.front() == source);
-            BOOST_ASSERT(subpath_nodes.back() == target);
-            unpacked_nodes.insert(
-                unpacked_nodes.end(), std::next(subpath_nodes.begin()), subpath_nodes.end());
-            unpacked_edges.insert(unpacked_edges.end(), subpath_edges.begin(), subpath_edges.end());
+        catch (...)
+        {
+            reverse_error = std::current_exception();
+            aborted = true;
         }
+    });
+
+    try
+    {
+        parallelRoutingSteps<FORWARD_DIRECTION>(facade,
+                                                forward_heap,
+                                                labels,
+                                                forward_min_key,
+                                                reverse_min_key,
+                                                aborted,
+                                                engine_working_data.deadline,
+                                                phantom_nodes,
+                                                args...);
+    }
+    catch (...)
+    {
+        aborted = true;
+        reverse_thread.join();
+        throw;
+    }
+    reverse_thread.join();
+    if (reverse_error)
+    {
+        std::rethrow_exception(reverse_error);
     }
 
-    return std::make_tuple(weight, std::move(unpacked_nodes), std::move(unpacked_edges));
+    const auto weight = labels.GetBestWeight();
+    const auto middle = labels.GetBestMiddle();
+    if (weight >= weight_upper_bound || SPECIAL_NODEID == middle)
+    {
+        return std::make_tuple(INVALID_EDGE_WEIGHT, std::vector<NodeID>(), std::vector<EdgeID>());
+    }
+
+    return unpackSearchPath(engine_working_data,
+                            facade,
+                            forward_heap,
+                            reverse_heap,
+                            DO_NOT_FORCE_LOOPS,
+                            DO_NOT_FORCE_LOOPS,
+                            middle,
+                            weight,
+                            phantom_nodes,
+                            args...);
 }
 
 // Alias to be compatible with the CH-based search
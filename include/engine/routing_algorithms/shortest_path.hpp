@@ -13,11 +13,14 @@ namespace engine
 namespace routing_algorithms
 {
 
+// With parallel set, the legs are unpacked in TBB tasks. If u-turns are allowed at the
+// waypoints, the legs are independent of each other and are searched in TBB tasks as well.
 template <typename Algorithm>
 InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_working_data,
                                        const DataFacade<Algorithm> &facade,
                                        const std::vector<PhantomNodes> &phantom_nodes_vector,
-                                       const boost::optional<bool> continue_straight_at_waypoint);
+                                       const boost::optional<bool> continue_straight_at_waypoint,
+                                       const bool parallel);
 
 } // namespace routing_algorithms
 } // namespace engine
@@ -2,10 +2,20 @@
 #define OSRM_SHORTEST_PATH_IMPL_HPP
 
 #include "engine/routing_algorithms/shortest_path.hpp"
+#include "engine/search_trace.hpp"
 
 #include <boost/assert.hpp>
 #include <boost/optional.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -177,29 +187,192 @@ void search(SearchEngineData<Algorithm> &engine_working_data,
     }
 }
 
+// The weight of a leg searched with u-turns allowed, without the weight of the legs before it
+struct UTurnLeg
+{
+    EdgeWeight weight = INVALID_EDGE_WEIGHT;
+    std::vector<NodeID> packed_path;
+};
+
+// With u-turns allowed the search of a leg does not depend on the weights of the legs before
+// it, only on the directions of its source the previous leg can arrive at. As long as every leg
+// is routable these are the valid target directions of the previous leg, so all legs can be
+// searched at once. Every task searches with heaps of its own, leased from the pool of the
+// engine.
+template <typename Algorithm>
+std::vector<UTurnLeg> searchLegsWithUTurn(SearchEngineData<Algorithm> &engine_working_data,
+                                          const DataFacade<Algorithm> &facade,
+                                          const std::vector<PhantomNodes> &phantom_nodes_vector)
+{
+    tbb::enumerable_thread_specific<std::unique_ptr<SearchEngineData<Algorithm>>> task_data(
+        [&engine_working_data] {
+            return std::make_unique<SearchEngineData<Algorithm>>(
+                engine_working_data.GetHeapPool(), engine_working_data.deadline);
+        });
+
+    std::vector<UTurnLeg> legs(phantom_nodes_vector.size());
+    const auto trace = SearchTracing::Current();
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, phantom_nodes_vector.size(), 1),
+        [&](const tbb::blocked_range<std::size_t> &range) {
+            SearchTracing::WorkerScope trace_scope(trace);
+            auto &data = *task_data.local();
+            data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
+            for (auto leg = range.begin(); leg != range.end(); ++leg)
+            {
+                const auto &source_phantom = phantom_nodes_vector[leg].source_phantom;
+                const auto &target_phantom = phantom_nodes_vector[leg].target_phantom;
+                const bool search_from_forward_node =
+                    leg == 0 ? source_phantom.IsValidForwardSource()
+                             : phantom_nodes_vector[leg - 1].target_phantom.IsValidForwardTarget();
+                const bool search_from_reverse_node =
+                    leg == 0 ? source_phantom.IsValidReverseSource()
+                             : phantom_nodes_vector[leg - 1].target_phantom.IsValidReverseTarget();
+                const bool search_to_forward_node = target_phantom.IsValidForwardTarget();
+                const bool search_to_reverse_node = target_phantom.IsValidReverseTarget();
+
+                if (search_to_forward_node || search_to_reverse_node)
+                {
+                    searchWithUTurn(data,
+                                    facade,
+                                    *data.forward_heap_1,
+                                    *data.reverse_heap_1,
+                                    search_from_forward_node,
+                                    search_from_reverse_node,
+                                    search_to_forward_node,
+                                    search_to_reverse_node,
+                                    source_phantom,
+                                    target_phantom,
+                                    0,
+                                    0,
+                                    legs[leg].weight,
+                                    legs[leg].packed_path);
+                }
+            }
+        });
+    return legs;
+}
+
+// Only the search engine data of the built-in algorithms leases heaps for parallel tasks,
+// algorithms that bring their own search their legs one after another
+template <typename Algorithm> struct HasParallelLegSearch final : std::false_type
+{
+};
+template <> struct HasParallelLegSearch<ch::Algorithm> final : std::true_type
+{
+};
+template <> struct HasParallelLegSearch<corech::Algorithm> final : std::true_type
+{
+};
+template <> struct HasParallelLegSearch<mld::Algorithm> final : std::true_type
+{
+};
+
+template <typename Algorithm>
+std::vector<UTurnLeg> searchLegsInParallel(SearchEngineData<Algorithm> &engine_working_data,
+                                           const DataFacade<Algorithm> &facade,
+                                           const std::vector<PhantomNodes> &phantom_nodes_vector,
+                                           std::true_type)
+{
+    return searchLegsWithUTurn(engine_working_data, facade, phantom_nodes_vector);
+}
+
 template <typename Algorithm>
-void unpackLegs(const DataFacade<Algorithm> &facade,
+std::vector<UTurnLeg> searchLegsInParallel(SearchEngineData<Algorithm> & /* engine_working_data */,
+                                           const DataFacade<Algorithm> & /* facade */,
+                                           const std::vector<PhantomNodes> & /* phantom_nodes */,
+                                           std::false_type)
+{
+    return {};
+}
+
+template <typename Algorithm, typename RandomIter>
+void unpackLeg(const SearchEngineData<Algorithm> & /* engine_working_data */,
+               const DataFacade<Algorithm> &facade,
+               RandomIter leg_begin,
+               RandomIter leg_end,
+               const PhantomNodes &phantom_nodes,
+               std::vector<PathData> &unpacked_path)
+{
+    unpackPath(facade, leg_begin, leg_end, phantom_nodes, unpacked_path);
+}
+
+// CH legs look their shortcuts up in the unpacking cache of the query
+template <typename RandomIter>
+void unpackLeg(const SearchEngineData<ch::Algorithm> &engine_working_data,
+               const DataFacade<ch::Algorithm> &facade,
+               RandomIter leg_begin,
+               RandomIter leg_end,
+               const PhantomNodes &phantom_nodes,
+               std::vector<PathData> &unpacked_path)
+{
+    unpackPath(facade,
+               leg_begin,
+               leg_end,
+               phantom_nodes,
+               unpacked_path,
+               engine_working_data.unpacking_cache);
+}
+
+template <typename RandomIter>
+void unpackLeg(const SearchEngineData<corech::Algorithm> &engine_working_data,
+               const DataFacade<corech::Algorithm> &facade,
+               RandomIter leg_begin,
+               RandomIter leg_end,
+               const PhantomNodes &phantom_nodes,
+               std::vector<PathData> &unpacked_path)
+{
+    unpackPath(facade,
+               leg_begin,
+               leg_end,
+               phantom_nodes,
+               unpacked_path,
+               engine_working_data.unpacking_cache);
+}
+
+template <typename Algorithm>
+void unpackLegs(const SearchEngineData<Algorithm> &engine_working_data,
+                const DataFacade<Algorithm> &facade,
                 const std::vector<PhantomNodes> &phantom_nodes_vector,
                 const std::vector<NodeID> &total_packed_path,
                 const std::vector<std::size_t> &packed_leg_begin,
                 const EdgeWeight shortest_path_weight,
+                const bool parallel,
                 InternalRouteResult &raw_route_data)
 {
-    raw_route_data.unpacked_path_segments.resize(packed_leg_begin.size() - 1);
+    const auto number_of_legs = packed_leg_begin.size() - 1;
+    raw_route_data.unpacked_path_segments.resize(number_of_legs);
 
     raw_route_data.shortest_path_weight = shortest_path_weight;
 
-    for (const auto current_leg : util::irange<std::size_t>(0UL, packed_leg_begin.size() - 1))
+    const auto unpack = [&](const std::size_t current_leg) {
+        unpackLeg(engine_working_data,
+                  facade,
+                  total_packed_path.begin() + packed_leg_begin[current_leg],
+                  total_packed_path.begin() + packed_leg_begin[current_leg + 1],
+                  phantom_nodes_vector[current_leg],
+                  raw_route_data.unpacked_path_segments[current_leg]);
+    };
+    if (parallel)
+    {
+        const auto trace = SearchTracing::Current();
+        tbb::parallel_for(std::size_t{0}, number_of_legs, [&](const std::size_t current_leg) {
+            SearchTracing::WorkerScope trace_scope(trace);
+            unpack(current_leg);
+        });
+    }
+    else
+    {
+        for (const auto current_leg : util::irange<std::size_t>(0UL, number_of_legs))
+        {
+            unpack(current_leg);
+        }
+    }
+
+    for (const auto current_leg : util::irange<std::size_t>(0UL, number_of_legs))
     {
         auto leg_begin = total_packed_path.begin() + packed_leg_begin[current_leg];
         auto leg_end = total_packed_path.begin() + packed_leg_begin[current_leg + 1];
-        const auto &unpack_phantom_node_pair = phantom_nodes_vector[current_leg];
-        unpackPath(facade,
-                   leg_begin,
-                   leg_end,
-                   unpack_phantom_node_pair,
-                   raw_route_data.unpacked_path_segments[current_leg]);
-
         raw_route_data.source_traversed_in_reverse.push_back(
             (*leg_begin != phantom_nodes_vector[current_leg].source_phantom.forward_segment_id.id));
         raw_route_data.target_traversed_in_reverse.push_back(
@@ -213,7 +386,8 @@ template <typename Algorithm>
 InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_working_data,
                                        const DataFacade<Algorithm> &facade,
                                        const std::vector<PhantomNodes> &phantom_nodes_vector,
-                                       const boost::optional<bool> continue_straight_at_waypoint)
+                                       const boost::optional<bool> continue_straight_at_waypoint,
+                                       const bool parallel)
 {
     InternalRouteResult raw_route_data;
     raw_route_data.segment_end_coordinates = phantom_nodes_vector;
@@ -221,7 +395,7 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
         !(continue_straight_at_waypoint ? *continue_straight_at_waypoint
                                         : facade.GetContinueStraightDefault());
 
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
 
     auto &forward_heap = *engine_working_data.forward_heap_1;
     auto &reverse_heap = *engine_working_data.reverse_heap_1;
@@ -241,6 +415,15 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
     std::vector<NodeID> total_packed_path_to_reverse;
     std::vector<std::size_t> packed_leg_to_reverse_begin;
 
+    // empty if the legs are searched one after another
+    auto parallel_legs =
+        parallel && allow_uturn_at_waypoint && phantom_nodes_vector.size() > 1
+            ? searchLegsInParallel(engine_working_data,
+                                   facade,
+                                   phantom_nodes_vector,
+                                   HasParallelLegSearch<Algorithm>{})
+            : std::vector<UTurnLeg>{};
+
     std::size_t current_leg = 0;
     // this implements a dynamic program that finds the shortest route through
     // a list of vias
@@ -265,20 +448,31 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
         {
             if (allow_uturn_at_waypoint)
             {
-                searchWithUTurn(engine_working_data,
-                                facade,
-                                forward_heap,
-                                reverse_heap,
-                                search_from_forward_node,
-                                search_from_reverse_node,
-                                search_to_forward_node,
-                                search_to_reverse_node,
-                                source_phantom,
-                                target_phantom,
-                                total_weight_to_forward,
-                                total_weight_to_reverse,
-                                new_total_weight_to_forward,
-                                packed_leg_to_forward);
+                if (!parallel_legs.empty())
+                {
+                    new_total_weight_to_forward = parallel_legs[current_leg].weight;
+                    if (new_total_weight_to_forward != INVALID_EDGE_WEIGHT)
+                        new_total_weight_to_forward +=
+                            std::min(total_weight_to_forward, total_weight_to_reverse);
+                    packed_leg_to_forward = std::move(parallel_legs[current_leg].packed_path);
+                }
+                else
+                {
+                    searchWithUTurn(engine_working_data,
+                                    facade,
+                                    forward_heap,
+                                    reverse_heap,
+                                    search_from_forward_node,
+                                    search_from_reverse_node,
+                                    search_to_forward_node,
+                                    search_to_reverse_node,
+                                    source_phantom,
+                                    target_phantom,
+                                    total_weight_to_forward,
+                                    total_weight_to_reverse,
+                                    new_total_weight_to_forward,
+                                    packed_leg_to_forward);
+                }
                 // if only the reverse node is valid (e.g. when using the match plugin) we
                 // actually need to move
                 if (!target_phantom.IsValidForwardTarget())
@@ -432,11 +626,13 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
         packed_leg_to_forward_begin.push_back(total_packed_path_to_forward.size());
         BOOST_ASSERT(packed_leg_to_forward_begin.size() == phantom_nodes_vector.size() + 1);
 
-        unpackLegs(facade,
+        unpackLegs(engine_working_data,
+                   facade,
                    phantom_nodes_vector,
                    total_packed_path_to_forward,
                    packed_leg_to_forward_begin,
                    total_weight_to_forward,
+                   parallel,
                    raw_route_data);
     }
     else
@@ -445,11 +641,13 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
         packed_leg_to_reverse_begin.push_back(total_packed_path_to_reverse.size());
         BOOST_ASSERT(packed_leg_to_reverse_begin.size() == phantom_nodes_vector.size() + 1);
 
-        unpackLegs(facade,
+        unpackLegs(engine_working_data,
+                   facade,
                    phantom_nodes_vector,
                    total_packed_path_to_reverse,
                    packed_leg_to_reverse_begin,
                    total_weight_to_reverse,
+                   parallel,
                    raw_route_data);
     }
 
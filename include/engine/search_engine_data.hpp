@@ -2,10 +2,16 @@
 #define SEARCH_ENGINE_DATA_HPP
 
 #include "engine/algorithm.hpp"
+#include "engine/deadline.hpp"
+#include "engine/heap_pool.hpp"
+#include "engine/meeting_labels.hpp"
+#include "engine/search_statistics.hpp"
+#include "engine/sweep_order_cache.hpp"
+#include "engine/unpacking_cache.hpp"
 #include "util/query_heap.hpp"
 #include "util/typedefs.hpp"
 
-#include <boost/thread/tss.hpp>
+#include <memory>
 
 namespace osrm
 {
@@ -16,6 +22,80 @@ namespace engine
 // - CH algorithms use CH heaps
 // - CoreCH algorithms use CH
 // - MLD algorithms use MLD heaps
+//
+// A SearchEngineData lives as long as one query. It leases its heaps from a HeapPool of the
+// engine and hands them back on destruction, so queries share heaps no matter which thread
+// they run on. The deadline belongs to the query as well, and so do the handles of the
+// shortcut unpacking cache and of the sweep order cache of CH queries. The heap operations of
+// the query are added to the search statistics of the thread on destruction.
+//
+// The index storage of each heap is chosen at build time through the CH_HEAP_STORAGE,
+// CH_MANY_TO_MANY_HEAP_STORAGE, MLD_HEAP_STORAGE and MLD_MANY_TO_MANY_HEAP_STORAGE CMake options,
+// see util/query_heap.hpp for the trade-offs. Hash maps are the default: arrays are faster on
+// long distance queries but need memory proportional to the graph for every heap and thread.
+// HEAP_CONTAINER picks the priority queue of all heaps, all routing algorithms are monotone so
+// each of them can be used.
+
+#define OSRM_HEAP_STORAGE_UNORDERED_MAP 0
+#define OSRM_HEAP_STORAGE_ARRAY 1
+#define OSRM_HEAP_STORAGE_GENERATION_ARRAY 2
+
+#define OSRM_HEAP_CONTAINER_BOOST 0
+#define OSRM_HEAP_CONTAINER_D_ARY 1
+#define OSRM_HEAP_CONTAINER_RADIX 2
+
+#ifndef OSRM_HEAP_CONTAINER
+#define OSRM_HEAP_CONTAINER OSRM_HEAP_CONTAINER_BOOST
+#endif
+#ifndef OSRM_CH_HEAP_STORAGE
+#define OSRM_CH_HEAP_STORAGE OSRM_HEAP_STORAGE_UNORDERED_MAP
+#endif
+#ifndef OSRM_CH_MANY_TO_MANY_HEAP_STORAGE
+#define OSRM_CH_MANY_TO_MANY_HEAP_STORAGE OSRM_HEAP_STORAGE_UNORDERED_MAP
+#endif
+#ifndef OSRM_MLD_HEAP_STORAGE
+#define OSRM_MLD_HEAP_STORAGE OSRM_HEAP_STORAGE_UNORDERED_MAP
+#endif
+#ifndef OSRM_MLD_MANY_TO_MANY_HEAP_STORAGE
+#define OSRM_MLD_MANY_TO_MANY_HEAP_STORAGE OSRM_HEAP_STORAGE_UNORDERED_MAP
+#endif
+
+namespace detail
+{
+template <int Storage> struct HeapStorage;
+
+template <> struct HeapStorage<OSRM_HEAP_STORAGE_UNORDERED_MAP>
+{
+    using type = util::UnorderedMapStorage<NodeID, int>;
+};
+
+template <> struct HeapStorage<OSRM_HEAP_STORAGE_ARRAY>
+{
+    using type = util::ArrayStorage<NodeID, int>;
+};
+
+template <> struct HeapStorage<OSRM_HEAP_STORAGE_GENERATION_ARRAY>
+{
+    using type = util::GenerationArrayStorage<NodeID, int>;
+};
+
+template <int Container> struct HeapContainer;
+
+template <> struct HeapContainer<OSRM_HEAP_CONTAINER_BOOST>
+{
+    using type = util::BoostHeapContainer<EdgeWeight, NodeID>;
+};
+
+template <> struct HeapContainer<OSRM_HEAP_CONTAINER_D_ARY>
+{
+    using type = util::DAryHeapContainer<EdgeWeight, NodeID>;
+};
+
+template <> struct HeapContainer<OSRM_HEAP_CONTAINER_RADIX>
+{
+    using type = util::RadixHeapContainer<EdgeWeight, NodeID>;
+};
+}
 
 template <typename Algorithm> struct SearchEngineData
 {
@@ -30,44 +110,104 @@ struct HeapData
 struct ManyToManyHeapData : HeapData
 {
     EdgeWeight duration;
-    ManyToManyHeapData(NodeID p, EdgeWeight duration) : HeapData(p), duration(duration) {}
+    EdgeDistance distance;
+    ManyToManyHeapData(NodeID p, EdgeWeight duration, EdgeDistance distance)
+        : HeapData(p), duration(duration), distance(distance)
+    {
+    }
 };
 
 template <> struct SearchEngineData<routing_algorithms::ch::Algorithm>
 {
-    using QueryHeap = util::
-        QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, util::UnorderedMapStorage<NodeID, int>>;
+    using QueryHeap = util::QueryHeap<NodeID,
+                                      NodeID,
+                                      EdgeWeight,
+                                      HeapData,
+                                      detail::HeapStorage<OSRM_CH_HEAP_STORAGE>::type,
+                                      detail::HeapContainer<OSRM_HEAP_CONTAINER>::type>;
 
-    using ManyToManyQueryHeap = util::QueryHeap<NodeID,
-                                                NodeID,
-                                                EdgeWeight,
-                                                ManyToManyHeapData,
-                                                util::UnorderedMapStorage<NodeID, int>>;
+    using ManyToManyQueryHeap =
+        util::QueryHeap<NodeID,
+                        NodeID,
+                        EdgeWeight,
+                        ManyToManyHeapData,
+                        detail::HeapStorage<OSRM_CH_MANY_TO_MANY_HEAP_STORAGE>::type,
+                        detail::HeapContainer<OSRM_HEAP_CONTAINER>::type>;
 
-    using SearchEngineHeapPtr = boost::thread_specific_ptr<QueryHeap>;
-    using ManyToManyHeapPtr = boost::thread_specific_ptr<ManyToManyQueryHeap>;
+    using SearchEngineHeapPtr = std::unique_ptr<QueryHeap>;
+    using ManyToManyHeapPtr = std::unique_ptr<ManyToManyQueryHeap>;
 
-    static SearchEngineHeapPtr forward_heap_1;
-    static SearchEngineHeapPtr reverse_heap_1;
-    static SearchEngineHeapPtr forward_heap_2;
-    static SearchEngineHeapPtr reverse_heap_2;
-    static SearchEngineHeapPtr forward_heap_3;
-    static SearchEngineHeapPtr reverse_heap_3;
-    static ManyToManyHeapPtr many_to_many_heap;
+    struct HeapSet
+    {
+        SearchEngineHeapPtr forward_heap_1;
+        SearchEngineHeapPtr reverse_heap_1;
+        SearchEngineHeapPtr forward_heap_2;
+        SearchEngineHeapPtr reverse_heap_2;
+        SearchEngineHeapPtr forward_heap_3;
+        SearchEngineHeapPtr reverse_heap_3;
+        ManyToManyHeapPtr many_to_many_heap;
+    };
+    using HeapPool = engine::HeapPool<HeapSet>;
+
+  private:
+    HeapPool &pool;
+    HeapSet heaps;
+
+  public:
+    SearchEngineHeapPtr &forward_heap_1;
+    SearchEngineHeapPtr &reverse_heap_1;
+    SearchEngineHeapPtr &forward_heap_2;
+    SearchEngineHeapPtr &reverse_heap_2;
+    SearchEngineHeapPtr &forward_heap_3;
+    SearchEngineHeapPtr &reverse_heap_3;
+    ManyToManyHeapPtr &many_to_many_heap;
+
+    Deadline deadline;
 
-    void InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes);
+    // empty if the engine caches no unpacked shortcuts
+    UnpackingCache::Handle unpacking_cache;
+
+    // the order of one-to-all sweeps, empty outside of the engine
+    SweepOrderCache::Handle sweep_order_cache;
+
+    explicit SearchEngineData(HeapPool &pool, Deadline deadline = {})
+        : pool(pool), heaps(pool.Acquire()), forward_heap_1(heaps.forward_heap_1),
+          reverse_heap_1(heaps.reverse_heap_1), forward_heap_2(heaps.forward_heap_2),
+          reverse_heap_2(heaps.reverse_heap_2), forward_heap_3(heaps.forward_heap_3),
+          reverse_heap_3(heaps.reverse_heap_3), many_to_many_heap(heaps.many_to_many_heap),
+          deadline(deadline)
+    {
+    }
 
-    void InitializeOrClearSecondThreadLocalStorage(unsigned number_of_nodes);
+    SearchEngineData(const SearchEngineData &) = delete;
+    SearchEngineData &operator=(const SearchEngineData &) = delete;
 
-    void InitializeOrClearThirdThreadLocalStorage(unsigned number_of_nodes);
+    ~SearchEngineData();
 
-    void InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes);
+    // for searches that need heaps for more than one thread
+    HeapPool &GetHeapPool() const { return pool; }
+
+    void InitializeOrClearFirstHeaps(unsigned number_of_nodes);
+
+    void InitializeOrClearSecondHeaps(unsigned number_of_nodes);
+
+    void InitializeOrClearThirdHeaps(unsigned number_of_nodes);
+
+    void InitializeOrClearManyToManyHeaps(unsigned number_of_nodes);
 };
 
 template <>
 struct SearchEngineData<routing_algorithms::corech::Algorithm>
     : public SearchEngineData<routing_algorithms::ch::Algorithm>
 {
+    using SearchEngineData<routing_algorithms::ch::Algorithm>::SearchEngineData;
+};
+
+template <>
+struct SearchEngineData<routing_algorithms::cch::Algorithm>
+    : public SearchEngineData<routing_algorithms::ch::Algorithm>
+{
+    using SearchEngineData<routing_algorithms::ch::Algorithm>::SearchEngineData;
 };
 
 struct MultiLayerDijkstraHeapData
@@ -81,12 +221,16 @@ struct MultiLayerDijkstraHeapData
 struct ManyToManyMultiLayerDijkstraHeapData : MultiLayerDijkstraHeapData
 {
     EdgeWeight duration;
-    ManyToManyMultiLayerDijkstraHeapData(NodeID p, EdgeWeight duration)
-        : MultiLayerDijkstraHeapData(p), duration(duration)
+    EdgeDistance distance;
+    ManyToManyMultiLayerDijkstraHeapData(NodeID p, EdgeWeight duration, EdgeDistance distance)
+        : MultiLayerDijkstraHeapData(p), duration(duration), distance(distance)
     {
     }
-    ManyToManyMultiLayerDijkstraHeapData(NodeID p, bool from, EdgeWeight duration)
-        : MultiLayerDijkstraHeapData(p, from), duration(duration)
+    ManyToManyMultiLayerDijkstraHeapData(NodeID p,
+                                         bool from,
+                                         EdgeWeight duration,
+                                         EdgeDistance distance)
+        : MultiLayerDijkstraHeapData(p, from), duration(duration), distance(distance)
     {
     }
 };
@@ -97,24 +241,64 @@ template <> struct SearchEngineData<routing_algorithms::mld::Algorithm>
                                       NodeID,
                                       EdgeWeight,
                                       MultiLayerDijkstraHeapData,
-                                      util::UnorderedMapStorage<NodeID, int>>;
+                                      detail::HeapStorage<OSRM_MLD_HEAP_STORAGE>::type,
+                                      detail::HeapContainer<OSRM_HEAP_CONTAINER>::type>;
+
+    using ManyToManyQueryHeap =
+        util::QueryHeap<NodeID,
+                        NodeID,
+                        EdgeWeight,
+                        ManyToManyMultiLayerDijkstraHeapData,
+                        detail::HeapStorage<OSRM_MLD_MANY_TO_MANY_HEAP_STORAGE>::type,
+                        detail::HeapContainer<OSRM_HEAP_CONTAINER>::type>;
+
+    using SearchEngineHeapPtr = std::unique_ptr<QueryHeap>;
+    using ManyToManyHeapPtr = std::unique_ptr<ManyToManyQueryHeap>;
+
+    using MeetingLabelsPtr = std::unique_ptr<MeetingLabels>;
+
+    struct HeapSet
+    {
+        SearchEngineHeapPtr forward_heap_1;
+        SearchEngineHeapPtr reverse_heap_1;
+        ManyToManyHeapPtr many_to_many_heap;
+        MeetingLabelsPtr meeting_labels;
+    };
+    using HeapPool = engine::HeapPool<HeapSet>;
+
+  private:
+    HeapPool &pool;
+    HeapSet heaps;
+
+  public:
+    SearchEngineHeapPtr &forward_heap_1;
+    SearchEngineHeapPtr &reverse_heap_1;
+    ManyToManyHeapPtr &many_to_many_heap;
+    // shared by the two threads of a parallel bidirectional search
+    MeetingLabelsPtr &meeting_labels;
+
+    Deadline deadline;
+
+    explicit SearchEngineData(HeapPool &pool, Deadline deadline = {})
+        : pool(pool), heaps(pool.Acquire()), forward_heap_1(heaps.forward_heap_1),
+          reverse_heap_1(heaps.reverse_heap_1), many_to_many_heap(heaps.many_to_many_heap),
+          meeting_labels(heaps.meeting_labels), deadline(deadline)
+    {
+    }
+
+    SearchEngineData(const SearchEngineData &) = delete;
+    SearchEngineData &operator=(const SearchEngineData &) = delete;
 
-    using ManyToManyQueryHeap = util::QueryHeap<NodeID,
-                                                NodeID,
-                                                EdgeWeight,
-                                                ManyToManyMultiLayerDijkstraHeapData,
-                                                util::UnorderedMapStorage<NodeID, int>>;
+    ~SearchEngineData();
 
-    using SearchEngineHeapPtr = boost::thread_specific_ptr<QueryHeap>;
-    using ManyToManyHeapPtr = boost::thread_specific_ptr<ManyToManyQueryHeap>;
+    // for searches that need heaps for more than one thread
+    HeapPool &GetHeapPool() const { return pool; }
 
-    static SearchEngineHeapPtr forward_heap_1;
-    static SearchEngineHeapPtr reverse_heap_1;
-    static ManyToManyHeapPtr many_to_many_heap;
+    void InitializeOrClearFirstHeaps(unsigned number_of_nodes);
 
-    void InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes);
+    void InitializeOrClearManyToManyHeaps(unsigned number_of_nodes);
 
-    void InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes);
+    void InitializeOrClearMeetingLabels(unsigned number_of_nodes);
 };
 }
 }
@@ -0,0 +1,45 @@
+#ifndef OSRM_ENGINE_SEARCH_STATISTICS_HPP
+#define OSRM_ENGINE_SEARCH_STATISTICS_HPP
+
+#include <cstdint>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Work done by the searches of the queries that finished on a thread. Queries add the heap
+// operations of their SearchEngineData when it is destroyed, the searches that parallel table,
+// match and alternative queries run on worker threads are counted on those threads.
+//
+//   const auto before = engine::GetThreadSearchStatistics();
+//   osrm.Route(parameters, result);
+//   const auto query = engine::GetThreadSearchStatistics() - before;
+struct SearchStatistics
+{
+    std::uint64_t settled_nodes = 0;
+    std::uint64_t relaxed_edges = 0;
+
+    SearchStatistics &operator+=(const SearchStatistics &other)
+    {
+        settled_nodes += other.settled_nodes;
+        relaxed_edges += other.relaxed_edges;
+        return *this;
+    }
+
+    SearchStatistics operator-(const SearchStatistics &other) const
+    {
+        SearchStatistics difference;
+        difference.settled_nodes = settled_nodes - other.settled_nodes;
+        difference.relaxed_edges = relaxed_edges - other.relaxed_edges;
+        return difference;
+    }
+};
+
+SearchStatistics GetThreadSearchStatistics();
+
+void AddThreadSearchStatistics(const SearchStatistics &statistics);
+}
+}
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef OSRM_ENGINE_SEARCH_TRACE_HPP
+#define OSRM_ENGINE_SEARCH_TRACE_HPP
+
+#include "util/json_container.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Instruments the searches for the `debug=stats` request parameter and the search metrics of
+// /metrics, set by the ENABLE_SEARCH_STATISTICS CMake option. Without it all hooks are empty.
+#ifndef OSRM_SEARCH_STATISTICS
+#define OSRM_SEARCH_STATISTICS 0
+#endif
+
+namespace osrm
+{
+namespace engine
+{
+
+// What the searches of one request did
+struct SearchTrace
+{
+    // MLD overlay levels, level 0 is the base graph
+    static constexpr std::size_t MAX_LEVELS = 16;
+
+    std::uint64_t settled_nodes = 0;
+    // edges scanned in the direction of the search, whether they improved a weight or not
+    std::uint64_t relaxed_edges = 0;
+    // CH nodes pruned by stall-on-demand
+    std::uint64_t stalled_nodes = 0;
+    // the most nodes in a heap when a node was settled
+    std::uint64_t max_heap_size = 0;
+    // MLD cells whose shortcuts were relaxed, by level
+    std::array<std::uint64_t, MAX_LEVELS> cells_crossed{};
+    // turning the packed paths into paths of the base graph
+    std::chrono::nanoseconds unpacking_time{0};
+
+    SearchTrace &operator+=(const SearchTrace &other)
+    {
+        settled_nodes += other.settled_nodes;
+        relaxed_edges += other.relaxed_edges;
+        stalled_nodes += other.stalled_nodes;
+        max_heap_size = std::max(max_heap_size, other.max_heap_size);
+        for (std::size_t level = 0; level < MAX_LEVELS; ++level)
+            cells_crossed[level] += other.cells_crossed[level];
+        unpacking_time += other.unpacking_time;
+        return *this;
+    }
+
+    // {"settled_nodes": ..., "cells_crossed": [<level 1>, ...], "unpacking_time": <ms>, ...}
+    util::json::Object ToJSON() const
+    {
+        util::json::Object stats;
+        stats.values["settled_nodes"] = static_cast<double>(settled_nodes);
+        stats.values["relaxed_edges"] = static_cast<double>(relaxed_edges);
+        stats.values["stalled_nodes"] = static_cast<double>(stalled_nodes);
+        stats.values["max_heap_size"] = static_cast<double>(max_heap_size);
+
+        const auto last = std::find_if(cells_crossed.rbegin(),
+                                       cells_crossed.rend() - 1,
+                                       [](const auto cells) { return cells != 0; });
+        util::json::Array cells;
+        for (auto level = cells_crossed.begin() + 1; level != last.base(); ++level)
+            cells.values.push_back(static_cast<double>(*level));
+        stats.values["cells_crossed"] = std::move(cells);
+
+        stats.values["unpacking_time"] =
+            std::chrono::duration<double, std::milli>(unpacking_time).count();
+        return stats;
+    }
+};
+
+// The traces of all requests of an engine
+class SearchTraceTotals
+{
+  public:
+    struct Statistics
+    {
+        std::uint64_t requests = 0;
+        SearchTrace totals;
+    };
+
+    void Add(const SearchTrace &trace)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++statistics.requests;
+        statistics.totals += trace;
+    }
+
+    Statistics Get() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return statistics;
+    }
+
+  private:
+    mutable std::mutex mutex;
+    Statistics statistics;
+};
+
+// The hooks the searches call. They count into the trace of the calling thread, a request
+// installs its trace with a Scope and every task a search hands to a worker thread with a
+// WorkerScope. SearchTracePolicy<false> compiles to nothing.
+template <bool Enabled> struct SearchTracePolicy;
+
+template <> struct SearchTracePolicy<false>
+{
+    static constexpr bool enabled = false;
+
+    static SearchTrace *Current() { return nullptr; }
+
+    static void Settled(const std::size_t) {}
+    static void Relaxed() {}
+    static void Stalled() {}
+    static void CellCrossed(const std::size_t) {}
+
+    struct Scope
+    {
+        explicit Scope(SearchTrace *) {}
+    };
+
+    struct WorkerScope
+    {
+        explicit WorkerScope(SearchTrace *) {}
+    };
+
+    struct UnpackingTimer
+    {
+        UnpackingTimer() {}
+    };
+};
+
+template <> struct SearchTracePolicy<true>
+{
+    static constexpr bool enabled = true;
+
+    static SearchTrace *&Current()
+    {
+        thread_local SearchTrace *current = nullptr;
+        return current;
+    }
+
+    static void Settled(const std::size_t heap_size)
+    {
+        if (auto *trace = Current())
+        {
+            ++trace->settled_nodes;
+            trace->max_heap_size = std::max<std::uint64_t>(trace->max_heap_size, heap_size);
+        }
+    }
+
+    static void Relaxed()
+    {
+        if (auto *trace = Current())
+            ++trace->relaxed_edges;
+    }
+
+    static void Stalled()
+    {
+        if (auto *trace = Current())
+            ++trace->stalled_nodes;
+    }
+
+    static void CellCrossed(const std::size_t level)
+    {
+        if (auto *trace = Current())
+            ++trace->cells_crossed[std::min(level, SearchTrace::MAX_LEVELS - 1)];
+    }
+
+    class Scope
+    {
+      public:
+        explicit Scope(SearchTrace *trace) : previous(Current()) { Current() = trace; }
+        ~Scope() { Current() = previous; }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+      private:
+        SearchTrace *previous;
+    };
+
+    // Counts into a trace of its own and adds it to the trace of the request at the end, the
+    // tasks of a request run on several threads at once
+    class WorkerScope
+    {
+      public:
+        explicit WorkerScope(SearchTrace *parent_)
+            : parent(parent_), scope(parent ? &local : nullptr)
+        {
+        }
+
+        ~WorkerScope()
+        {
+            if (!parent)
+                return;
+            static std::mutex mutex;
+            std::lock_guard<std::mutex> lock(mutex);
+            *parent += local;
+        }
+
+        WorkerScope(const WorkerScope &) = delete;
+        WorkerScope &operator=(const WorkerScope &) = delete;
+
+      private:
+        SearchTrace *parent;
+        SearchTrace local;
+        Scope scope;
+    };
+
+    // Adds the time until its destruction to the unpacking time, nested unpacking is only
+    // timed once
+    class UnpackingTimer
+    {
+      public:
+        UnpackingTimer() : trace(Current())
+        {
+            if (trace && Depth()++ == 0)
+                start = std::chrono::steady_clock::now();
+        }
+
+        ~UnpackingTimer()
+        {
+            if (trace && --Depth() == 0)
+                trace->unpacking_time += std::chrono::steady_clock::now() - start;
+        }
+
+        UnpackingTimer(const UnpackingTimer &) = delete;
+        UnpackingTimer &operator=(const UnpackingTimer &) = delete;
+
+      private:
+        static std::size_t &Depth()
+        {
+            thread_local std::size_t depth = 0;
+            return depth;
+        }
+
+        SearchTrace *trace;
+        std::chrono::steady_clock::time_point start;
+    };
+};
+
+using SearchTracing = SearchTracePolicy<OSRM_SEARCH_STATISTICS != 0>;
+}
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef OSRM_ENGINE_SNAPPING_CACHE_HPP
+#define OSRM_ENGINE_SNAPPING_CACHE_HPP
+
+#include "engine/approach.hpp"
+#include "engine/bearing.hpp"
+#include "engine/dataset_generation.hpp"
+#include "engine/phantom_node.hpp"
+
+#include "util/coordinate.hpp"
+#include "util/lru_cache.hpp"
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Caches the phantom nodes coordinates snapped to, shared by all queries of an engine.
+//
+// The key is the coordinate in its fixed point representation together with the bearing, radius
+// and approach it was snapped with, a cached snapping is exactly what the R-tree search would
+// have returned. Every key is tied to the dataset it was snapped on, once a query runs on a new
+// dataset all cached snappings are dropped.
+class SnappingCache
+{
+  public:
+    struct Key
+    {
+        std::uint64_t generation;
+        std::int32_t longitude;
+        std::int32_t latitude;
+        // negative without bearing or radius
+        std::int32_t bearing;
+        std::int32_t bearing_range;
+        double radius;
+        Approach approach;
+
+        bool operator==(const Key &other) const
+        {
+            return generation == other.generation && longitude == other.longitude &&
+                   latitude == other.latitude && bearing == other.bearing &&
+                   bearing_range == other.bearing_range && radius == other.radius &&
+                   approach == other.approach;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    // The cache as seen by the queries on one dataset
+    class Handle
+    {
+      public:
+        Handle() = default;
+
+        boost::optional<PhantomNodePair> Get(const util::Coordinate coordinate,
+                                             const boost::optional<double> radius,
+                                             const boost::optional<Bearing> bearing,
+                                             const Approach approach) const;
+
+        void Insert(const util::Coordinate coordinate,
+                    const boost::optional<double> radius,
+                    const boost::optional<Bearing> bearing,
+                    const Approach approach,
+                    const PhantomNodePair &phantom_nodes) const;
+
+        explicit operator bool() const { return cache != nullptr; }
+
+      private:
+        friend class SnappingCache;
+        Handle(SnappingCache *cache, const std::uint64_t generation)
+            : cache(cache), generation(generation)
+        {
+        }
+
+        Key MakeKey(const util::Coordinate coordinate,
+                    const boost::optional<double> radius,
+                    const boost::optional<Bearing> bearing,
+                    const Approach approach) const;
+
+        SnappingCache *cache = nullptr;
+        std::uint64_t generation = 0;
+    };
+
+    explicit SnappingCache(const std::size_t capacity);
+
+    // dataset is any pointer that shares ownership with the facade of the query
+    Handle ForDataset(const std::shared_ptr<const void> &dataset);
+
+    util::CacheStatistics GetStatistics() const { return cache.GetStatistics(); }
+
+  private:
+    DatasetGeneration generation;
+    util::ShardedLRUCache<Key, PhantomNodePair, KeyHash> cache;
+};
+}
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef OSRM_ENGINE_SWEEP_ORDER_CACHE_HPP
+#define OSRM_ENGINE_SWEEP_ORDER_CACHE_HPP
+
+#include "engine/dataset_generation.hpp"
+
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Keeps the order the one-to-all sweeps visit the nodes of a CH in, shared by all queries of an
+// engine.
+//
+// The order only depends on the graph. The first sweep on a dataset computes it, the others wait
+// for it. The order of the previous dataset stays around until a sweep runs on the new one.
+class SweepOrderCache
+{
+  public:
+    // every node comes after all nodes it pulls weights from over its downward edges
+    using SweepOrder = std::vector<NodeID>;
+    using SweepOrderPtr = std::shared_ptr<const SweepOrder>;
+
+    // The cache as seen by the queries on one dataset
+    class Handle
+    {
+      public:
+        Handle() = default;
+
+        // compute() returns the SweepOrder of the dataset if it is not cached yet
+        template <typename ComputeT> SweepOrderPtr Get(ComputeT compute) const
+        {
+            BOOST_ASSERT(cache);
+            const auto generation = cache->generation.Get(dataset, []() {});
+
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            if (cache->order && cache->order_generation == generation)
+            {
+                return cache->order;
+            }
+            auto order = std::make_shared<const SweepOrder>(compute());
+            // queries still running on an older dataset keep the order of the new one
+            if (generation >= cache->order_generation)
+            {
+                cache->order = order;
+                cache->order_generation = generation;
+            }
+            return order;
+        }
+
+        explicit operator bool() const { return cache != nullptr; }
+
+      private:
+        friend class SweepOrderCache;
+        Handle(SweepOrderCache *cache, std::shared_ptr<const void> dataset)
+            : cache(cache), dataset(std::move(dataset))
+        {
+        }
+
+        SweepOrderCache *cache = nullptr;
+        std::shared_ptr<const void> dataset;
+    };
+
+    // dataset is any pointer that shares ownership with the facade of the query, queries that do
+    // not sweep never touch the cache
+    Handle ForDataset(std::shared_ptr<const void> dataset)
+    {
+        return Handle{this, std::move(dataset)};
+    }
+
+  private:
+    DatasetGeneration generation;
+    std::mutex mutex;
+    SweepOrderPtr order;
+    std::uint64_t order_generation = 0;
+};
+}
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef OSRM_ENGINE_TILE_CACHE_HPP
+#define OSRM_ENGINE_TILE_CACHE_HPP
+
+#include "engine/api/tile_parameters.hpp"
+#include "engine/dataset_generation.hpp"
+
+#include "util/lru_cache.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Caches rendered vector tiles, shared by all tile queries of an engine.
+//
+// The last capacity tiles are kept in memory, tied to the dataset they were rendered from like
+// the entries of the RouteCache. With a directory every rendered tile is also written to
+// <directory>/<dataset timestamp>/<z>/<x>/<y>.mvt, so tiles survive restarts and can be served
+// or pre-rendered without a running engine. Tiles on disk are only told apart by the timestamp
+// of their dataset, datasets with the same timestamp share them.
+class TileCache
+{
+  public:
+    struct Key
+    {
+        std::uint64_t generation;
+        unsigned x;
+        unsigned y;
+        unsigned z;
+
+        bool operator==(const Key &other) const
+        {
+            return generation == other.generation && x == other.x && y == other.y &&
+                   z == other.z;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    // a capacity of 0 keeps no tiles in memory, an empty directory stores none on disk
+    TileCache(const std::size_t capacity, boost::filesystem::path directory);
+
+    // dataset is any pointer that shares ownership with the facade of the query
+    Key MakeKey(const std::shared_ptr<const void> &dataset, const api::TileParameters &parameters);
+
+    // timestamp is the one of the facade of the query, returns nullptr if the tile is not cached
+    std::shared_ptr<const std::string> Get(const Key &key, const std::string &timestamp);
+
+    void Insert(const Key &key, const std::string &timestamp, std::string tile);
+
+    // Counters of the tiles in memory, tiles read from disk count as misses
+    util::CacheStatistics GetStatistics() const;
+
+    // The file of a tile below directory, the timestamp is reduced to characters safe in paths
+    static boost::filesystem::path GetTilePath(const boost::filesystem::path &directory,
+                                               const std::string &timestamp,
+                                               const api::TileParameters &parameters);
+
+    // Replaces the file at path with tile, returns false and logs a warning if that failed
+    static bool WriteTile(const boost::filesystem::path &path, const std::string &tile);
+
+  private:
+    DatasetGeneration generation;
+    // nullptr if tiles are not kept in memory
+    const std::unique_ptr<util::ShardedLRUCache<Key, std::string, KeyHash>> cache;
+    const boost::filesystem::path directory;
+};
+}
+}
+
+#endif
@@ -20,62 +20,79 @@ namespace engine
 namespace trip
 {
 
-// given a route and a new location, find the best place of insertion and
-// check the distance of roundtrip when the new location is additionally visited
-using NodeIDIter = std::vector<NodeID>::iterator;
-inline std::pair<EdgeWeight, NodeIDIter>
-GetShortestRoundTrip(const NodeID new_loc,
-                     const util::DistTableWrapper<EdgeWeight> &dist_table,
-                     const std::size_t number_of_locations,
-                     std::vector<NodeID> &route)
+namespace detail
 {
-    (void)number_of_locations; // unused
+// The cheapest place to insert a location into the round trip, between from and the location
+// following it
+struct Insertion
+{
+    EdgeWeight cost = INVALID_EDGE_WEIGHT;
+    NodeID from = SPECIAL_NODEID;
+};
+
+// Cost of visiting new_loc between from and to instead of going from from to to directly.
+// Returns INVALID_EDGE_WEIGHT if new_loc can not be reached from from or can not reach to.
+inline EdgeWeight InsertionCost(const util::DistTableWrapper<EdgeWeight> &dist_table,
+                                const NodeID new_loc,
+                                const NodeID from,
+                                const NodeID to)
+{
+    const auto dist_from = dist_table(from, new_loc);
+    const auto dist_to = dist_table(new_loc, to);
+    // If the edge_weight is very large (INVALID_EDGE_WEIGHT) then the algorithm will not choose
+    // this edge in final minimal path. So instead of computing all the permutations after this
+    // large edge, discard this edge right here and don't consider the path after this edge.
+    if (dist_from == INVALID_EDGE_WEIGHT || dist_to == INVALID_EDGE_WEIGHT)
+        return INVALID_EDGE_WEIGHT;
+    // This is not necessarily positive:
+    // Lets say you have an edge (u, v) with duration 100. If you place a coordinate exactly in
+    // the middle of the segment yielding (u, v'), the adjusted duration will be 100 * 0.5 = 50.
+    // Now imagine two coordinates. One placed at 0.99 and one at 0.999. This means (u, v') now
+    // has a duration of 100 * 0.99 = 99, but (u, v'') also has a duration of 100 * 0.995 = 99.
+    // In which case (v', v'') has a duration of 0.
+    return dist_from + dist_to - dist_table(from, to);
+}
 
-    auto min_trip_distance = INVALID_EDGE_WEIGHT;
-    NodeIDIter next_insert_point_candidate;
+// Of two insertions with the same cost the one earlier in the route wins
+inline bool IsBetterInsertion(const EdgeWeight cost,
+                              const NodeID from,
+                              const Insertion &best,
+                              const std::vector<std::size_t> &route_position)
+{
+    return cost != INVALID_EDGE_WEIGHT &&
+           (cost < best.cost ||
+            (cost == best.cost && route_position[from] < route_position[best.from]));
+}
 
-    // for all nodes in the current trip find the best insertion resulting in the shortest path
-    // assert min 2 nodes in route
-    const auto start = std::begin(route);
-    const auto end = std::end(route);
-    for (auto from_node = start; from_node != end; ++from_node)
+// Scans all places of the round trip for the cheapest insertion of new_loc
+inline Insertion FindCheapestInsertion(const NodeID new_loc,
+                                       const util::DistTableWrapper<EdgeWeight> &dist_table,
+                                       const std::vector<NodeID> &route)
+{
+    Insertion best;
+    for (std::size_t index = 0; index < route.size(); ++index)
     {
-        auto to_node = std::next(from_node);
-        if (to_node == end)
-        {
-            to_node = start;
-        }
-
-        const auto dist_from = dist_table(*from_node, new_loc);
-        const auto dist_to = dist_table(new_loc, *to_node);
-        const auto trip_dist = dist_from + dist_to - dist_table(*from_node, *to_node);
-
-        // If the edge_weight is very large (INVALID_EDGE_WEIGHT) then the algorithm will not choose
-        // this edge in final minimal path. So instead of computing all the permutations after this
-        // large edge, discard this edge right here and don't consider the path after this edge.
-        if (dist_from == INVALID_EDGE_WEIGHT || dist_to == INVALID_EDGE_WEIGHT)
-            continue;
-        // This is not neccessarily true:
-        // Lets say you have an edge (u, v) with duration 100. If you place a coordinate exactly in
-        // the middle of the segment yielding (u, v'), the adjusted duration will be 100 * 0.5 = 50.
-        // Now imagine two coordinates. One placed at 0.99 and one at 0.999. This means (u, v') now
-        // has a duration of 100 * 0.99 = 99, but (u, v'') also has a duration of 100 * 0.995 = 99.
-        // In which case (v', v'') has a duration of 0.
-        // BOOST_ASSERT_MSG(trip_dist >= 0, "previous trip was not minimal. something's wrong");
-
-        // from all possible insertions to the current trip, choose the shortest of all insertions
-        if (trip_dist < min_trip_distance)
+        const auto from = route[index];
+        const auto to = route[(index + 1) % route.size()];
+        const auto cost = InsertionCost(dist_table, new_loc, from, to);
+        if (cost != INVALID_EDGE_WEIGHT && cost < best.cost)
         {
-            min_trip_distance = trip_dist;
-            next_insert_point_candidate = to_node;
+            best.cost = cost;
+            best.from = from;
         }
     }
-    BOOST_ASSERT_MSG(min_trip_distance != INVALID_EDGE_WEIGHT, "trip has invalid edge weight");
-
-    return std::make_pair(min_trip_distance, next_insert_point_candidate);
+    return best;
+}
 }
 
 // given two initial start nodes, find a roundtrip route using the farthest insertion algorithm
+//
+// Every location that is not visited yet keeps its cheapest insertion into the current trip.
+// Inserting a location only replaces the edge it is inserted into by two new ones, so only the
+// two new edges need to be checked for the other locations. Only the locations whose cheapest
+// insertion was into the replaced edge scan the whole trip again. This takes O(n^2) steps
+// instead of the O(n^3) of scanning the trip for every location in every step and results in
+// the same trip.
 inline std::vector<NodeID> FindRoute(const std::size_t &number_of_locations,
                                      const util::DistTableWrapper<EdgeWeight> &dist_table,
                                      const NodeID &start1,
@@ -86,50 +103,79 @@ inline std::vector<NodeID> FindRoute(const std::size_t &number_of_locations,
 
     std::vector<NodeID> route;
     route.reserve(number_of_locations);
-
-    // tracks which nodes have been already visited
-    std::vector<bool> visited(number_of_locations, false);
-
-    visited[start1] = true;
-    visited[start2] = true;
     route.push_back(start1);
     route.push_back(start2);
 
-    // two nodes are already in the initial start trip, so we need to add all other nodes
-    for (std::size_t added_nodes = 2; added_nodes < number_of_locations; ++added_nodes)
+    // the index of every visited location in route
+    std::vector<std::size_t> route_position(number_of_locations, 0);
+    route_position[start2] = 1;
+
+    // the locations that still need to be visited with their cheapest insertion
+    std::vector<NodeID> candidates;
+    std::vector<detail::Insertion> insertions;
+    candidates.reserve(number_of_locations);
+    insertions.reserve(number_of_locations);
+    for (NodeID id = 0; id < number_of_locations; ++id)
     {
-        auto farthest_distance = std::numeric_limits<int>::min();
-        auto next_node = -1;
-        NodeIDIter next_insert_point;
+        if (id != start1 && id != start2)
+        {
+            candidates.push_back(id);
+            insertions.push_back(detail::FindCheapestInsertion(id, dist_table, route));
+        }
+    }
 
-        // find unvisited node that is the farthest away from all other visited locs
-        for (std::size_t id = 0; id < number_of_locations; ++id)
+    // two nodes are already in the initial start trip, so we need to add all other nodes
+    while (!candidates.empty())
+    {
+        // find unvisited node that is the farthest away from all other visited locs, the
+        // candidates are ordered by id
+        std::size_t farthest = 0;
+        for (std::size_t index = 0; index < candidates.size(); ++index)
         {
-            // find the shortest distance from i to all visited nodes
-            if (!visited[id])
+            BOOST_ASSERT_MSG(insertions[index].cost != INVALID_EDGE_WEIGHT,
+                             "shortest round trip is invalid");
+            if (insertions[index].cost > insertions[farthest].cost)
             {
-                const auto insert_candidate =
-                    GetShortestRoundTrip(id, dist_table, number_of_locations, route);
-
-                BOOST_ASSERT_MSG(insert_candidate.first != INVALID_EDGE_WEIGHT,
-                                 "shortest round trip is invalid");
-
-                // add the location to the current trip such that it results in the shortest total
-                // tour
-                if (insert_candidate.first > farthest_distance)
-                {
-                    farthest_distance = insert_candidate.first;
-                    next_node = id;
-                    next_insert_point = insert_candidate.second;
-                }
+                farthest = index;
             }
         }
 
-        BOOST_ASSERT_MSG(next_node >= 0, "next node to visit is invalid");
+        // add the location to the current trip such that it results in the shortest total tour
+        const auto next_node = candidates[farthest];
+        const auto from = insertions[farthest].from;
+        const auto to = route[(route_position[from] + 1) % route.size()];
+        // in front of to, which is the start of the route if from is the last location
+        const auto insert_position = route_position[to];
+        route.insert(route.begin() + insert_position, next_node);
+        for (auto index = insert_position; index < route.size(); ++index)
+        {
+            route_position[route[index]] = index;
+        }
+        candidates.erase(candidates.begin() + farthest);
+        insertions.erase(insertions.begin() + farthest);
 
-        // mark as visited and insert node
-        visited[next_node] = true;
-        route.insert(next_insert_point, next_node);
+        // from -> to was replaced by from -> next_node -> to
+        for (std::size_t index = 0; index < candidates.size(); ++index)
+        {
+            auto &insertion = insertions[index];
+            const auto candidate = candidates[index];
+            if (insertion.from == from)
+            {
+                insertion = detail::FindCheapestInsertion(candidate, dist_table, route);
+                continue;
+            }
+
+            const auto before_cost = detail::InsertionCost(dist_table, candidate, from, next_node);
+            if (detail::IsBetterInsertion(before_cost, from, insertion, route_position))
+            {
+                insertion = {before_cost, from};
+            }
+            const auto after_cost = detail::InsertionCost(dist_table, candidate, next_node, to);
+            if (detail::IsBetterInsertion(after_cost, next_node, insertion, route_position))
+            {
+                insertion = {after_cost, next_node};
+            }
+        }
     }
     return route;
 }
@@ -0,0 +1,152 @@
+#ifndef TRIP_HELD_KARP_HPP
+#define TRIP_HELD_KARP_HPP
+
+#include "util/dist_table_wrapper.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace trip
+{
+
+// Held-Karp dynamic program over the subsets of the locations, returns the optimal round trip
+// from location 0 in O(2^n * n^2) time and O(2^n * n) memory instead of the O(n!) of brute force.
+//
+// cost(set, last) is the lightest path that leaves location 0, visits all locations of set
+// and ends at last. The costs of all sets with the same number of locations only depend on the
+// sets with one location less, each such layer is evaluated in parallel. All ends of a set are
+// stored next to each other, a set is computed from the sets it contains with one location less
+// which are read row by row.
+inline std::vector<NodeID> HeldKarpTrip(const std::size_t number_of_locations,
+                                        const util::DistTableWrapper<EdgeWeight> &dist_table)
+{
+    BOOST_ASSERT(number_of_locations > 0);
+    BOOST_ASSERT_MSG(number_of_locations * number_of_locations == dist_table.size(),
+                     "number_of_locations and dist_table size do not match");
+    // the sets are bit masks of the locations except for 0, the ends fit into a byte
+    BOOST_ASSERT(number_of_locations <= 25);
+
+    if (number_of_locations < 3)
+    {
+        std::vector<NodeID> route(number_of_locations);
+        std::iota(route.begin(), route.end(), 0);
+        return route;
+    }
+
+    using Cost = std::int64_t;
+    constexpr Cost INVALID_COST = std::numeric_limits<Cost>::max();
+
+    // location i + 1 is bit i of a set
+    const auto number_of_ends = number_of_locations - 1;
+    const std::uint32_t number_of_sets = 1u << number_of_ends;
+    const auto distance = [&dist_table](const std::size_t from, const std::size_t to) -> Cost {
+        const auto weight = dist_table(from, to);
+        return weight == INVALID_EDGE_WEIGHT ? INVALID_COST : weight;
+    };
+
+    std::vector<Cost> costs(static_cast<std::size_t>(number_of_sets) * number_of_ends,
+                            INVALID_COST);
+    std::vector<std::uint8_t> parents(costs.size(), 0);
+    const auto index = [number_of_ends](const std::uint32_t set, const std::size_t end) {
+        return static_cast<std::size_t>(set) * number_of_ends + end;
+    };
+
+    for (std::size_t end = 0; end < number_of_ends; ++end)
+    {
+        costs[index(1u << end, end)] = distance(0, end + 1);
+    }
+
+    // the sets of every size, in increasing order
+    std::vector<std::vector<std::uint32_t>> layers(number_of_ends + 1);
+    for (std::uint32_t set = 1; set < number_of_sets; ++set)
+    {
+        layers[__builtin_popcount(set)].push_back(set);
+    }
+
+    for (std::size_t size = 2; size <= number_of_ends; ++size)
+    {
+        const auto &layer = layers[size];
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, layer.size()),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                for (auto position = range.begin(); position != range.end(); ++position)
+                {
+                    const auto set = layer[position];
+                    for (std::size_t end = 0; end < number_of_ends; ++end)
+                    {
+                        if (!(set & (1u << end)))
+                            continue;
+
+                        const auto previous_set = set & ~(1u << end);
+                        auto best_cost = INVALID_COST;
+                        std::uint8_t best_parent = 0;
+                        for (std::size_t last = 0; last < number_of_ends; ++last)
+                        {
+                            const auto previous_cost = costs[index(previous_set, last)];
+                            if (!(previous_set & (1u << last)) || previous_cost == INVALID_COST)
+                                continue;
+                            const auto step = distance(last + 1, end + 1);
+                            if (step == INVALID_COST)
+                                continue;
+                            if (previous_cost + step < best_cost)
+                            {
+                                best_cost = previous_cost + step;
+                                best_parent = static_cast<std::uint8_t>(last);
+                            }
+                        }
+                        costs[index(set, end)] = best_cost;
+                        parents[index(set, end)] = best_parent;
+                    }
+                }
+            });
+    }
+
+    // close the round trip, if no trip is possible at all any order will do
+    const auto all = number_of_sets - 1;
+    auto best_cost = INVALID_COST;
+    std::size_t best_end = 0;
+    for (std::size_t end = 0; end < number_of_ends; ++end)
+    {
+        const auto cost = costs[index(all, end)];
+        const auto step = distance(end + 1, 0);
+        if (cost != INVALID_COST && step != INVALID_COST && cost + step < best_cost)
+        {
+            best_cost = cost + step;
+            best_end = end;
+        }
+    }
+
+    std::vector<NodeID> route(number_of_locations);
+    auto set = all;
+    auto end = best_end;
+    for (auto position = number_of_locations - 1; position > 0; --position)
+    {
+        route[position] = static_cast<NodeID>(end + 1);
+        const auto parent = parents[index(set, end)];
+        set &= ~(1u << end);
+        end = parent;
+    }
+    route[0] = 0;
+
+    return route;
+}
+
+} // namespace trip
+} // namespace engine
+} // namespace osrm
+
+#endif // TRIP_HELD_KARP_HPP
@@ -0,0 +1,135 @@
+#ifndef TRIP_LOCAL_SEARCH_HPP
+#define TRIP_LOCAL_SEARCH_HPP
+
+#include "util/dist_table_wrapper.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace trip
+{
+
+namespace detail
+{
+using TripCost = std::int64_t;
+
+// Table entries that are INVALID_EDGE_WEIGHT are kept as their (huge) value, a move never
+// introduces such an edge unless it removes heavier ones.
+inline TripCost TripEdgeCost(const util::DistTableWrapper<EdgeWeight> &dist_table,
+                             const NodeID from,
+                             const NodeID to)
+{
+    return dist_table(from, to);
+}
+
+// Takes the first 2-opt move that makes the round trip lighter. The table is asymmetric, so
+// the cost of reversing a part of the trip is computed from prefix sums of the trip edges in
+// both directions.
+inline bool ApplyTwoOptMove(const util::DistTableWrapper<EdgeWeight> &dist_table,
+                            std::vector<NodeID> &trip)
+{
+    const auto size = trip.size();
+
+    // forward[i] is the cost of trip[0] -> ... -> trip[i], backward[i] of trip[i] -> ... trip[0]
+    std::vector<TripCost> forward(size, 0), backward(size, 0);
+    for (std::size_t i = 1; i < size; ++i)
+    {
+        forward[i] = forward[i - 1] + TripEdgeCost(dist_table, trip[i - 1], trip[i]);
+        backward[i] = backward[i - 1] + TripEdgeCost(dist_table, trip[i], trip[i - 1]);
+    }
+
+    // reverse trip[first..last], trip[0] stays in place
+    for (std::size_t first = 1; first + 1 < size; ++first)
+    {
+        const auto before = trip[first - 1];
+        for (std::size_t last = first + 1; last < size; ++last)
+        {
+            const auto after = trip[(last + 1) % size];
+            const auto removed = TripEdgeCost(dist_table, before, trip[first]) +
+                                 TripEdgeCost(dist_table, trip[last], after) + forward[last] -
+                                 forward[first];
+            const auto added = TripEdgeCost(dist_table, before, trip[last]) +
+                               TripEdgeCost(dist_table, trip[first], after) + backward[last] -
+                               backward[first];
+            if (added < removed)
+            {
+                std::reverse(trip.begin() + first, trip.begin() + last + 1);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Takes the first Or-opt move that makes the round trip lighter: a part of up to three
+// consecutive locations is moved between two other locations without reversing it.
+inline bool ApplyOrOptMove(const util::DistTableWrapper<EdgeWeight> &dist_table,
+                           std::vector<NodeID> &trip)
+{
+    const auto size = trip.size();
+    for (std::size_t length = 1; length <= 3 && length + 2 <= size; ++length)
+    {
+        for (std::size_t first = 0; first + length <= size; ++first)
+        {
+            const auto last = first + length - 1;
+            const auto before = trip[(first + size - 1) % size];
+            const auto after = trip[(last + 1) % size];
+            const auto removed_gain = TripEdgeCost(dist_table, before, trip[first]) +
+                                      TripEdgeCost(dist_table, trip[last], after) -
+                                      TripEdgeCost(dist_table, before, after);
+
+            // insert between trip[position] and the location following it
+            for (std::size_t offset = 1; offset + length < size; ++offset)
+            {
+                const auto position = (last + offset) % size;
+                const auto from = trip[position];
+                const auto to = trip[(position + 1) % size];
+                const auto inserted_cost = TripEdgeCost(dist_table, from, trip[first]) +
+                                           TripEdgeCost(dist_table, trip[last], to) -
+                                           TripEdgeCost(dist_table, from, to);
+                if (inserted_cost < removed_gain)
+                {
+                    const std::vector<NodeID> part(trip.begin() + first,
+                                                   trip.begin() + last + 1);
+                    trip.erase(trip.begin() + first, trip.begin() + last + 1);
+                    const auto insert_after = std::find(trip.begin(), trip.end(), from);
+                    BOOST_ASSERT(insert_after != trip.end());
+                    trip.insert(insert_after + 1, part.begin(), part.end());
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+}
+
+// Improves a round trip with 2-opt and Or-opt moves until none of them makes it lighter.
+// Every move strictly decreases the cost of the trip, so this terminates.
+inline std::vector<NodeID> LocalSearchTrip(std::vector<NodeID> trip,
+                                           const util::DistTableWrapper<EdgeWeight> &dist_table)
+{
+    BOOST_ASSERT(trip.size() * trip.size() == dist_table.size());
+    if (trip.size() < 4)
+        return trip;
+
+    while (detail::ApplyTwoOptMove(dist_table, trip) || detail::ApplyOrOptMove(dist_table, trip))
+    {
+    }
+    return trip;
+}
+
+} // namespace trip
+} // namespace engine
+} // namespace osrm
+
+#endif // TRIP_LOCAL_SEARCH_HPP
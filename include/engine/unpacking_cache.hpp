@@ -0,0 +1,89 @@
+#ifndef OSRM_ENGINE_UNPACKING_CACHE_HPP
+#define OSRM_ENGINE_UNPACKING_CACHE_HPP
+
+#include "engine/dataset_generation.hpp"
+
+#include "util/lru_cache.hpp"
+#include "util/typedefs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Caches the original edges CH shortcuts unpack to, shared by all queries of an engine.
+//
+// A shortcut is keyed by its edge id and the direction the packed path traverses it in: edges
+// found in the backward graph of their target are traversed against the order they are stored
+// in. Every key is tied to the dataset it was unpacked on, once a query runs on a new dataset all
+// cached shortcuts are dropped.
+class UnpackingCache
+{
+  public:
+    // The node every original edge of a shortcut ends at together with the id of the edge
+    using UnpackedShortcut = std::vector<std::pair<NodeID, EdgeID>>;
+    using UnpackedShortcutPtr = std::shared_ptr<const UnpackedShortcut>;
+
+    struct Key
+    {
+        std::uint64_t generation;
+        EdgeID shortcut;
+        bool reversed;
+
+        bool operator==(const Key &other) const
+        {
+            return generation == other.generation && shortcut == other.shortcut &&
+                   reversed == other.reversed;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    // The cache as seen by the queries on one dataset
+    class Handle
+    {
+      public:
+        Handle() = default;
+
+        // Returns nullptr if the shortcut is not cached
+        UnpackedShortcutPtr Get(const EdgeID shortcut, const bool reversed) const;
+
+        void Insert(const EdgeID shortcut, const bool reversed, UnpackedShortcutPtr edges) const;
+
+        explicit operator bool() const { return cache != nullptr; }
+
+      private:
+        friend class UnpackingCache;
+        Handle(UnpackingCache *cache, const std::uint64_t generation)
+            : cache(cache), generation(generation)
+        {
+        }
+
+        UnpackingCache *cache = nullptr;
+        std::uint64_t generation = 0;
+    };
+
+    explicit UnpackingCache(const std::size_t capacity);
+
+    // dataset is any pointer that shares ownership with the facade of the query
+    Handle ForDataset(const std::shared_ptr<const void> &dataset);
+
+    util::CacheStatistics GetStatistics() const { return cache.GetStatistics(); }
+
+  private:
+    DatasetGeneration generation;
+    util::ShardedLRUCache<Key, UnpackedShortcut, KeyHash> cache;
+};
+}
+}
+
+#endif
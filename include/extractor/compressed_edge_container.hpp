@@ -3,13 +3,19 @@
 
 #include "extractor/segment_data_container.hpp"
 
+#include "util/packed_vector.hpp"
 #include "util/typedefs.hpp"
 
 #include <unordered_map>
 
+#include <cstdint>
+#include <iterator>
 #include <string>
 #include <vector>
 
+#include <boost/assert.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/iterator/reverse_iterator.hpp>
 #include <boost/optional.hpp>
 
 namespace osrm
@@ -28,7 +34,80 @@ class CompressedEdgeContainer
         SegmentDuration duration; // the duration of the edge leading to this node
     };
 
-    using OnewayEdgeBucket = std::vector<OnewayCompressedEdge>;
+    // The segments of an edge. The segments of all edges are stored in one pool with bit-packed
+    // weights and durations, a bucket is a view of the range of one edge and returns copies.
+    class OnewayEdgeBucket
+    {
+      public:
+        class iterator : public boost::iterator_facade<iterator,
+                                                       OnewayCompressedEdge,
+                                                       boost::random_access_traversal_tag,
+                                                       OnewayCompressedEdge>
+        {
+            typedef boost::iterator_facade<iterator,
+                                           OnewayCompressedEdge,
+                                           boost::random_access_traversal_tag,
+                                           OnewayCompressedEdge>
+                base_t;
+
+          public:
+            typedef typename base_t::value_type value_type;
+            typedef typename base_t::difference_type difference_type;
+            typedef typename base_t::reference reference;
+            typedef std::random_access_iterator_tag iterator_category;
+
+            explicit iterator() : container(nullptr), position(0) {}
+            explicit iterator(const CompressedEdgeContainer *container, const std::size_t position)
+                : container(container), position(position)
+            {
+            }
+
+          private:
+            void increment() { ++position; }
+            void decrement() { --position; }
+            void advance(difference_type offset) { position += offset; }
+            bool equal(const iterator &other) const { return position == other.position; }
+            reference dereference() const { return container->GetSegment(position); }
+            difference_type distance_to(const iterator &other) const
+            {
+                return other.position - position;
+            }
+
+            const CompressedEdgeContainer *container;
+            std::size_t position;
+
+            friend class ::boost::iterator_core_access;
+        };
+        using reverse_iterator = boost::reverse_iterator<iterator>;
+
+        OnewayEdgeBucket(const CompressedEdgeContainer *container,
+                         const std::size_t offset,
+                         const std::size_t size)
+            : container(container), offset(offset), num_segments(size)
+        {
+        }
+
+        std::size_t size() const { return num_segments; }
+        bool empty() const { return num_segments == 0; }
+
+        OnewayCompressedEdge operator[](const std::size_t index) const
+        {
+            BOOST_ASSERT(index < num_segments);
+            return container->GetSegment(offset + index);
+        }
+        OnewayCompressedEdge front() const { return operator[](0); }
+        OnewayCompressedEdge back() const { return operator[](num_segments - 1); }
+
+        iterator begin() const { return iterator(container, offset); }
+        iterator end() const { return iterator(container, offset + num_segments); }
+        reverse_iterator rbegin() const { return reverse_iterator(end()); }
+        reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+      private:
+        const CompressedEdgeContainer *container;
+        std::size_t offset;
+        std::size_t num_segments;
+    };
 
     CompressedEdgeContainer();
     void CompressEdge(const EdgeID surviving_edge_id,
@@ -56,10 +135,10 @@ class CompressedEdgeContainer
     bool HasZippedEntryForForwardID(const EdgeID edge_id) const;
     bool HasZippedEntryForReverseID(const EdgeID edge_id) const;
     void PrintStatistics() const;
-    unsigned GetPositionForID(const EdgeID edge_id) const;
     unsigned GetZippedPositionForForwardID(const EdgeID edge_id) const;
     unsigned GetZippedPositionForReverseID(const EdgeID edge_id) const;
-    const OnewayEdgeBucket &GetBucketReference(const EdgeID edge_id) const;
+    // The bucket is invalidated by the next change of the container
+    OnewayEdgeBucket GetBucketReference(const EdgeID edge_id) const;
     bool IsTrivial(const EdgeID edge_id) const;
     NodeID GetFirstEdgeTargetID(const EdgeID edge_id) const;
     NodeID GetLastEdgeTargetID(const EdgeID edge_id) const;
@@ -72,14 +151,38 @@ class CompressedEdgeContainer
     SegmentWeight ClipWeight(const SegmentWeight weight);
     SegmentDuration ClipDuration(const SegmentDuration duration);
 
-    int free_list_maximum = 0;
+    // The segments of an edge are stored in a chunk of the next power of two of their number,
+    // chunks that are no longer used are reused for edges of the same chunk size
+    struct Bucket
+    {
+        std::uint32_t offset;
+        std::uint32_t size; // 0 if the edge has no entry
+    };
+    static std::size_t ChunkSizeClass(const std::uint32_t size);
+    std::uint32_t AllocateChunk(const std::uint32_t size);
+    void FreeChunk(const Bucket &bucket);
+    // Makes room for `additional_segments` more segments, moves the segments if necessary
+    Bucket &ReserveSegments(const EdgeID edge_id, const std::uint32_t additional_segments);
+    void AppendSegment(Bucket &bucket,
+                       const NodeID node_id,
+                       const SegmentWeight weight,
+                       const SegmentDuration duration);
+    OnewayCompressedEdge GetSegment(const std::size_t position) const
+    {
+        return {m_segment_nodes[position],
+                m_segment_weights[position],
+                m_segment_durations[position]};
+    }
+
     std::atomic_size_t clipped_weights{0};
     std::atomic_size_t clipped_durations{0};
 
-    void IncreaseFreeList();
-    std::vector<OnewayEdgeBucket> m_compressed_oneway_geometries;
-    std::vector<unsigned> m_free_list;
-    std::unordered_map<EdgeID, unsigned> m_edge_id_to_list_index_map;
+    // indexed by the edge id
+    std::vector<Bucket> m_buckets;
+    std::vector<NodeID> m_segment_nodes;
+    util::PackedVector<SegmentWeight, SEGMENT_WEIGHT_BITS> m_segment_weights;
+    util::PackedVector<SegmentDuration, SEGMENT_DURAITON_BITS> m_segment_durations;
+    std::vector<std::vector<std::uint32_t>> m_free_chunks;
     std::unordered_map<EdgeID, unsigned> m_forward_edge_id_to_zipped_index_map;
     std::unordered_map<EdgeID, unsigned> m_reverse_edge_id_to_zipped_index_map;
     std::unique_ptr<SegmentDataContainer> segment_data;
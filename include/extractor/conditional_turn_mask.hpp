@@ -0,0 +1,61 @@
+#ifndef OSRM_EXTRACTOR_CONDITIONAL_TURN_MASK_HPP_
+#define OSRM_EXTRACTOR_CONDITIONAL_TURN_MASK_HPP_
+
+#include "util/opening_hours.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+// A conditional turn restriction compiled into the steps of the week in which it applies, so a
+// query can check it against its departure time instead of osrm-contract or osrm-customize
+// disabling the turn for the time they ran at. The steps are 15 minutes of the week starting on
+// Sunday 00:00 UTC, as the time slots of speed profiles the masks do not know time zones.
+struct ConditionalTurnMask
+{
+    static constexpr std::uint32_t MINUTES_PER_STEP = 15;
+    static constexpr std::uint32_t MINUTES_PER_WEEK = 7 * 24 * 60;
+    static constexpr std::uint32_t NUMBER_OF_STEPS = MINUTES_PER_WEEK / MINUTES_PER_STEP;
+
+    // edge-based nodes the restricted turn connects
+    NodeID from;
+    NodeID to;
+    std::array<std::uint64_t, (NUMBER_OF_STEPS + 63) / 64> steps;
+
+    // The minute of the week of a UNIX timestamp, the epoch was a Thursday
+    static std::uint32_t MinuteOfWeek(const std::uint64_t timestamp)
+    {
+        return (timestamp / 60 + 4 * 24 * 60) % MINUTES_PER_WEEK;
+    }
+
+    bool IsActive(const std::uint32_t minute_of_week) const
+    {
+        BOOST_ASSERT(minute_of_week < MINUTES_PER_WEEK);
+        const auto step = minute_of_week / MINUTES_PER_STEP;
+        return steps[step / 64] & (std::uint64_t{1} << (step % 64));
+    }
+
+    void SetActive(const std::uint32_t step)
+    {
+        BOOST_ASSERT(step < NUMBER_OF_STEPS);
+        steps[step / 64] |= std::uint64_t{1} << (step % 64);
+    }
+};
+
+// Evaluates the conditions at the start of every step of the week. Returns false if the conditions
+// depend on dates, which a weekly mask can not express, those turns are left to the updater.
+bool compileConditionalTurnMask(const std::vector<util::OpeningHours> &conditions,
+                                ConditionalTurnMask &mask);
+
+} // namespace extractor
+} // namespace osrm
+
+#endif // OSRM_EXTRACTOR_CONDITIONAL_TURN_MASK_HPP_
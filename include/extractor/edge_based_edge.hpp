@@ -15,20 +15,25 @@ struct EdgeBasedEdge
   public:
     struct EdgeData
     {
-        EdgeData() : turn_id(0), weight(0), duration(0), forward(false), backward(false) {}
+        EdgeData()
+            : turn_id(0), weight(0), distance(0), duration(0), forward(false), backward(false)
+        {
+        }
 
         EdgeData(const NodeID turn_id,
                  const EdgeWeight weight,
+                 const EdgeDistance distance,
                  const EdgeWeight duration,
                  const bool forward,
                  const bool backward)
-            : turn_id(turn_id), weight(weight), duration(duration), forward(forward),
-              backward(backward)
+            : turn_id(turn_id), weight(weight), distance(distance), duration(duration),
+              forward(forward), backward(backward)
         {
         }
 
         NodeID turn_id; // ID of the edge based node (node based edge)
         EdgeWeight weight;
+        EdgeDistance distance; // length of the edge based node the edge leaves
         EdgeWeight duration : 30;
         std::uint32_t forward : 1;
         std::uint32_t backward : 1;
@@ -42,6 +47,7 @@ struct EdgeBasedEdge
                   const NodeID target,
                   const NodeID edge_id,
                   const EdgeWeight weight,
+                  const EdgeDistance distance,
                   const EdgeWeight duration,
                   const bool forward,
                   const bool backward);
@@ -53,7 +59,7 @@ struct EdgeBasedEdge
     NodeID target;
     EdgeData data;
 };
-static_assert(sizeof(extractor::EdgeBasedEdge) == 20,
+static_assert(sizeof(extractor::EdgeBasedEdge) == 24,
               "Size of extractor::EdgeBasedEdge type is "
               "bigger than expected. This will influence "
               "memory consumption.");
@@ -66,10 +72,11 @@ inline EdgeBasedEdge::EdgeBasedEdge(const NodeID source,
                                     const NodeID target,
                                     const NodeID turn_id,
                                     const EdgeWeight weight,
+                                    const EdgeDistance distance,
                                     const EdgeWeight duration,
                                     const bool forward,
                                     const bool backward)
-    : source(source), target(target), data{turn_id, weight, duration, forward, backward}
+    : source(source), target(target), data{turn_id, weight, distance, duration, forward, backward}
 {
 }
 
@@ -4,6 +4,7 @@
 #define EDGE_BASED_GRAPH_FACTORY_HPP_
 
 #include "extractor/compressed_edge_container.hpp"
+#include "extractor/conditional_turn_mask.hpp"
 #include "extractor/conditional_turn_penalty.hpp"
 #include "extractor/edge_based_edge.hpp"
 #include "extractor/edge_based_node_segment.hpp"
@@ -89,6 +90,7 @@ class EdgeBasedGraphFactory
              const std::string &turn_penalties_index_filename,
              const std::string &cnbg_ebg_mapping_path,
              const std::string &conditional_penalties_filename,
+             const std::string &conditional_turn_masks_filename,
              const RestrictionMap &node_restriction_map,
              const ConditionalRestrictionMap &conditional_restriction_map,
              const WayRestrictionMap &way_restriction_map);
@@ -134,6 +136,10 @@ class EdgeBasedGraphFactory
     std::vector<ConditionalTurnPenalty>
     IndexConditionals(std::vector<Conditional> &&conditionals) const;
 
+    // weekly masks of the conditionals that only depend on the time of the week
+    std::vector<ConditionalTurnMask>
+    CompileConditionalTurnMasks(const std::vector<Conditional> &conditionals) const;
+
     //! maps index from m_edge_based_node_list to ture/false if the node is an entry point to the
     //! graph
     std::vector<bool> m_edge_based_node_is_startpoint;
@@ -184,6 +190,7 @@ class EdgeBasedGraphFactory
                                    const std::string &turn_duration_penalties_filename,
                                    const std::string &turn_penalties_index_filename,
                                    const std::string &conditional_turn_penalties_filename,
+                                   const std::string &conditional_turn_masks_filename,
                                    const RestrictionMap &node_restriction_map,
                                    const ConditionalRestrictionMap &conditional_restriction_map,
                                    const WayRestrictionMap &way_restriction_map);
@@ -10,6 +10,12 @@
 
 #include <limits>
 
+// Leaf records carry the projected coordinates of u and v, see the RTREE_INLINE_COORDINATES CMake
+// option
+#ifndef OSRM_RTREE_INLINE_COORDINATES
+#define OSRM_RTREE_INLINE_COORDINATES 0
+#endif
+
 namespace osrm
 {
 namespace extractor
@@ -22,7 +28,7 @@ struct EdgeBasedNodeSegment
     EdgeBasedNodeSegment()
         : forward_segment_id{SPECIAL_SEGMENTID, false},
           reverse_segment_id{SPECIAL_SEGMENTID, false}, u(SPECIAL_NODEID), v(SPECIAL_NODEID),
-          fwd_segment_position(std::numeric_limits<unsigned short>::max())
+          fwd_segment_position(std::numeric_limits<unsigned short>::max()), forward_bearing(0)
     {
     }
 
@@ -30,9 +36,10 @@ struct EdgeBasedNodeSegment
                                   const SegmentID reverse_segment_id_,
                                   NodeID u,
                                   NodeID v,
-                                  unsigned short fwd_segment_position)
+                                  unsigned short fwd_segment_position,
+                                  unsigned short forward_bearing)
         : forward_segment_id(forward_segment_id_), reverse_segment_id(reverse_segment_id_), u(u),
-          v(v), fwd_segment_position(fwd_segment_position)
+          v(v), fwd_segment_position(fwd_segment_position), forward_bearing(forward_bearing)
     {
         BOOST_ASSERT(forward_segment_id.enabled || reverse_segment_id.enabled);
     }
@@ -42,6 +49,13 @@ struct EdgeBasedNodeSegment
     NodeID u;                     // node-based graph node ID of the start node
     NodeID v;                     // node-based graph node ID of the target node
     unsigned short fwd_segment_position; // segment id in a compressed geometry
+    unsigned short forward_bearing; // bearing from u to v rounded to degrees, fills the padding
+#if OSRM_RTREE_INLINE_COORDINATES
+    // u and v projected to web mercator, set by util::StaticRTree when it writes the leaves. The
+    // leaf scans read them in order instead of looking up u and v in the coordinate list.
+    util::Coordinate projected_u;
+    util::Coordinate projected_v;
+#endif
 };
 }
 }
@@ -3,12 +3,17 @@
 
 #include "extractor/first_and_last_segment_of_way.hpp"
 #include "extractor/internal_extractor_edge.hpp"
+#include "extractor/node_locations.hpp"
 #include "extractor/query_node.hpp"
 #include "extractor/restriction.hpp"
 #include "extractor/scripting_environment.hpp"
 
 #include "storage/io.hpp"
 
+#include "util/external_sorter.hpp"
+
+#include <memory>
+
 namespace osrm
 {
 namespace extractor
@@ -38,10 +43,24 @@ class ExtractionContainers
     using NameCharData = std::vector<unsigned char>;
     using NameOffsets = std::vector<unsigned>;
 
+    struct NodeIDLess
+    {
+        bool operator()(const QueryNode &lhs, const QueryNode &rhs) const
+        {
+            return lhs.node_id < rhs.node_id;
+        }
+    };
+    using NodeSorter = util::ExternalSorter<QueryNode, NodeIDLess>;
+
     std::vector<OSMNodeID> barrier_nodes;
     std::vector<OSMNodeID> traffic_signals;
     NodeIDVector used_node_id_list;
     NodeVector all_nodes_list;
+    // Set to look up the node coordinates by OSM id, all_nodes_list stays empty then
+    std::unique_ptr<NodeLocations> node_locations;
+    // Set to sort the nodes with a fixed memory budget, only the used nodes end up in
+    // all_nodes_list then
+    std::unique_ptr<NodeSorter> sorted_nodes;
     EdgeVector all_edges_list;
     NameCharData name_char_data;
     NameOffsets name_offsets;
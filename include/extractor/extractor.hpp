@@ -33,6 +33,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "extractor/extractor_config.hpp"
 #include "extractor/graph_compressor.hpp"
 
+#include "storage/io.hpp"
+
 #include "util/guidance/bearing_class.hpp"
 #include "util/guidance/entry_class.hpp"
 #include "util/guidance/turn_lanes.hpp"
@@ -89,9 +91,18 @@ class Extractor
                        extractor::PackedOSMIDs &osm_node_ids);
 
     // Writes compressed node based graph and its embedding into a file for osrm-partition to use.
-    static void WriteCompressedNodeBasedGraph(const std::string &path,
-                                              const util::NodeBasedDynamicGraph &graph,
-                                              const std::vector<util::Coordinate> &coordiantes);
+    static void
+    WriteCompressedNodeBasedGraph(const std::string &path,
+                                  const util::NodeBasedDynamicGraph &graph,
+                                  const std::vector<util::Coordinate> &coordiantes,
+                                  const storage::io::FileWriter::CompressionFlag compression);
+
+    // How the files only read by the other tools are written
+    storage::io::FileWriter::CompressionFlag IntermediateCompression() const
+    {
+        return config.compress_intermediate_files ? storage::io::FileWriter::CompressBlocks
+                                                  : storage::io::FileWriter::NoCompression;
+    }
 
     void WriteConditionalRestrictions(
         const std::string &path,
@@ -5,9 +5,9 @@
 #include "extractor/guidance/turn_lane_types.hpp"
 #include "util/typedefs.hpp"
 
-#include <boost/functional/hash.hpp>
 #include <boost/optional/optional_fwd.hpp>
 
+#include <cstddef>
 #include <string>
 #include <unordered_map>
 
@@ -17,25 +17,6 @@ class Node;
 class Way;
 }
 
-namespace std
-{
-template <> struct hash<std::tuple<std::string, std::string, std::string, std::string, std::string>>
-{
-    std::size_t operator()(
-        const std::tuple<std::string, std::string, std::string, std::string, std::string> &mk) const
-        noexcept
-    {
-        std::size_t seed = 0;
-        boost::hash_combine(seed, std::get<0>(mk));
-        boost::hash_combine(seed, std::get<1>(mk));
-        boost::hash_combine(seed, std::get<2>(mk));
-        boost::hash_combine(seed, std::get<3>(mk));
-        boost::hash_combine(seed, std::get<4>(mk));
-        return seed;
-    }
-};
-}
-
 namespace osrm
 {
 namespace extractor
@@ -58,10 +39,8 @@ class ExtractorCallbacks
 {
   private:
     // used to deduplicate street names, refs, destinations, pronunciation, exits:
-    // actually maps to name ids
-    using MapKey = std::tuple<std::string, std::string, std::string, std::string, std::string>;
-    using MapVal = unsigned;
-    std::unordered_map<MapKey, MapVal> string_map;
+    // maps their hash to the name ids, the strings are compared with the stored name data
+    std::unordered_multimap<std::size_t, NameID> name_ids;
     ExtractionContainers &external_memory;
     std::unordered_map<std::string, ClassData> &classes_map;
     guidance::LaneDescriptionMap &lane_description_map;
@@ -85,8 +64,17 @@ class ExtractorCallbacks
     // warning: caller needs to take care of synchronization!
     void ProcessRestriction(const InputConditionalTurnRestriction &restriction);
 
+    // Hash of the strings that share a name id. It is computed in the parallel stage of the
+    // extractor, so that ProcessWay only has to compare the strings with the known names.
+    static std::size_t HashNames(const ExtractionWay &result_way);
+
     // warning: caller needs to take care of synchronization!
-    void ProcessWay(const osmium::Way &current_way, const ExtractionWay &result_way);
+    void ProcessWay(const osmium::Way &current_way,
+                    const ExtractionWay &result_way,
+                    const std::size_t names_hash);
+
+  private:
+    NameID GetNameID(const ExtractionWay &result_way, const std::size_t names_hash);
 };
 }
 }
@@ -32,6 +32,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <array>
 #include <string>
+#include <vector>
 
 #include "storage/io_config.hpp"
 
@@ -49,6 +50,7 @@ struct ExtractorConfig final : storage::IOConfig
                                      {},
                                      {".osrm",
                                       ".osrm.restrictions",
+                                      ".osrm.conditional_turn_masks",
                                       ".osrm.names",
                                       ".osrm.tls",
                                       ".osrm.tld",
@@ -68,7 +70,10 @@ struct ExtractorConfig final : storage::IOConfig
                                       ".osrm.icd",
                                       ".osrm.cnbg",
                                       ".osrm.cnbg_to_ebg"}),
-                                 requested_num_threads(0)
+                                 requested_num_threads(0),
+                                 use_dense_node_locations(false),
+                                 external_sort_memory(0), two_pass_parsing(false),
+                                 compress_intermediate_files(false)
     {
     }
 
@@ -78,6 +83,8 @@ struct ExtractorConfig final : storage::IOConfig
     }
 
     boost::filesystem::path input_path;
+    // OSM change files applied to the input while it is read
+    std::vector<boost::filesystem::path> change_paths;
     boost::filesystem::path profile_path;
 
     unsigned requested_num_threads;
@@ -87,6 +94,13 @@ struct ExtractorConfig final : storage::IOConfig
 
     bool use_metadata;
     bool parse_conditionals;
+    bool use_dense_node_locations;
+    // memory budget of the external node sort in MiB, 0 keeps all nodes in memory
+    unsigned external_sort_memory;
+    // reads the ways first and only passes the nodes of routable ways to the profile
+    bool two_pass_parsing;
+    // compresses the files only the other tools read, .osrm.ebg, .osrm.enw and .osrm.cnbg
+    bool compress_intermediate_files;
 };
 }
 }
@@ -79,11 +79,14 @@ inline void writeProfileProperties(const boost::filesystem::path &path,
 template <typename EdgeBasedEdgeVector>
 void writeEdgeBasedGraph(const boost::filesystem::path &path,
                          EdgeID const max_edge_id,
-                         const EdgeBasedEdgeVector &edge_based_edge_list)
+                         const EdgeBasedEdgeVector &edge_based_edge_list,
+                         const storage::io::FileWriter::CompressionFlag compression =
+                             storage::io::FileWriter::NoCompression)
 {
     static_assert(std::is_same<typename EdgeBasedEdgeVector::value_type, EdgeBasedEdge>::value, "");
 
-    storage::io::FileWriter writer(path, storage::io::FileWriter::GenerateFingerprint);
+    storage::io::FileWriter writer(
+        path, storage::io::FileWriter::GenerateFingerprint, compression);
 
     writer.WriteElementCount64(max_edge_id);
     storage::serialization::write(writer, edge_based_edge_list);
@@ -153,6 +156,28 @@ inline void writeNBGMapping(const boost::filesystem::path &path,
     storage::serialization::write(writer, mapping);
 }
 
+// reads .osrm.conditional_turn_masks
+template <typename ConditionalTurnMaskVectorT>
+inline void readConditionalTurnMasks(const boost::filesystem::path &path,
+                                     ConditionalTurnMaskVectorT &masks)
+{
+    const auto fingerprint = storage::io::FileReader::VerifyFingerprint;
+    storage::io::FileReader reader{path, fingerprint};
+
+    storage::serialization::read(reader, masks);
+}
+
+// writes .osrm.conditional_turn_masks
+template <typename ConditionalTurnMaskVectorT>
+inline void writeConditionalTurnMasks(const boost::filesystem::path &path,
+                                      const ConditionalTurnMaskVectorT &masks)
+{
+    const auto fingerprint = storage::io::FileWriter::GenerateFingerprint;
+    storage::io::FileWriter writer{path, fingerprint};
+
+    storage::serialization::write(writer, masks);
+}
+
 // reads .osrm.datasource_names
 inline void readDatasources(const boost::filesystem::path &path, Datasources &sources)
 {
@@ -184,6 +209,19 @@ inline void readSegmentData(const boost::filesystem::path &path, SegmentDataT &s
     serialization::read(reader, segment_data);
 }
 
+// reads the weights, durations and datasources of .osrm.geometry
+template <typename SegmentDataT>
+inline void readSegmentMetric(const boost::filesystem::path &path, SegmentDataT &segment_data)
+{
+    static_assert(std::is_same<SegmentDataContainer, SegmentDataT>::value ||
+                      std::is_same<SegmentDataView, SegmentDataT>::value,
+                  "");
+    const auto fingerprint = storage::io::FileReader::VerifyFingerprint;
+    storage::io::FileReader reader{path, fingerprint};
+
+    serialization::readMetric(reader, segment_data);
+}
+
 // writes .osrm.geometry
 template <typename SegmentDataT>
 inline void writeSegmentData(const boost::filesystem::path &path, const SegmentDataT &segment_data)
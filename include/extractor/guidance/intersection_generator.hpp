@@ -11,12 +11,17 @@
 #include "util/node_based_graph.hpp"
 #include "util/typedefs.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <boost/optional.hpp>
 
+#include <tbb/enumerable_thread_specific.h>
+
 namespace osrm
 {
 namespace extractor
@@ -30,6 +35,13 @@ struct IntersectionGenerationParameters
     EdgeID via_eid;
 };
 
+// How often the intersection views requested from GetConnectedRoads were found in the cache
+struct IntersectionCacheStatistics
+{
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+};
+
 // The Intersection Generator is given a turn location and generates an intersection representation
 // from it. For this all turn possibilities are analysed.
 // We consider turn restrictions to indicate possible turns. U-turns are generated based on profile
@@ -84,11 +96,20 @@ class IntersectionGenerator
     // accurate coordinates. It should be good enough to check order of turns, find straightmost
     // turns. Even good enough to do some simple angle verifications. It is mostly available to
     // allow for faster graph traversal in the extraction phase.
+    // The views are cached per thread: the handlers look at the same intersections down the road
+    // over and over again while the turns of neighbouring nodes are analysed.
     OSRM_ATTR_WARN_UNUSED
     IntersectionView GetConnectedRoads(const NodeID from_node,
                                        const EdgeID via_eid,
                                        const bool use_low_precision_angles = false) const;
 
+    // Drops the intersection views cached by the calling thread. The cache only pays off for
+    // nearby intersections, so it is cleared for every block of nodes that is processed.
+    void ClearCache() const;
+
+    // Hits and misses of the caches of all threads
+    IntersectionCacheStatistics GetCacheStatistics() const;
+
     /*
      * To be used in the road network, we need to check for valid/restricted turns. These two
      * functions transform a basic intersection / a normalised intersection into the
@@ -116,6 +137,14 @@ class IntersectionGenerator
 
     // own state, used to find the correct coordinates along a road
     const CoordinateExtractor coordinate_extractor;
+
+    // the via edge identifies the intersection, the lowest bit the precision of the angles
+    struct IntersectionCache
+    {
+        std::unordered_map<std::uint64_t, IntersectionView> views;
+        IntersectionCacheStatistics statistics;
+    };
+    mutable tbb::enumerable_thread_specific<IntersectionCache> intersection_cache;
 };
 
 } // namespace guidance
@@ -1,13 +1,13 @@
 #ifndef OSRM_EXTRACTOR_BEARING_CONTAINER_HPP
 #define OSRM_EXTRACTOR_BEARING_CONTAINER_HPP
 
+#include "storage/io_fwd.hpp"
 #include "storage/shared_memory_ownership.hpp"
 
 #include "util/guidance/bearing_class.hpp"
-#include "util/range_table.hpp"
 #include "util/vector_view.hpp"
 
-#include <numeric>
+#include <cstdint>
 
 namespace osrm
 {
@@ -34,7 +34,6 @@ namespace detail
 template <storage::Ownership Ownership> class IntersectionBearingsContainer
 {
     template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
-    template <unsigned size> using RangeTable = util::RangeTable<size, Ownership>;
 
   public:
     IntersectionBearingsContainer() = default;
@@ -47,40 +46,31 @@ template <storage::Ownership Ownership> class IntersectionBearingsContainer
                                   const std::vector<util::guidance::BearingClass> &bearing_classes)
         : node_to_class_id(std::move(node_to_class_id_))
     {
-        std::vector<unsigned> bearing_counts(bearing_classes.size());
-        std::transform(bearing_classes.begin(),
-                       bearing_classes.end(),
-                       bearing_counts.begin(),
-                       [](const auto &bearings) { return bearings.getAvailableBearings().size(); });
-        auto total_bearings = std::accumulate(bearing_counts.begin(), bearing_counts.end(), 0);
-        class_id_to_ranges_table = RangeTable<16>{bearing_counts};
-
-        values.reserve(total_bearings);
+        class_id_to_offset.reserve(bearing_classes.size() + 1);
+        class_id_to_offset.push_back(0);
         for (const auto &bearing_class : bearing_classes)
         {
             const auto &bearings = bearing_class.getAvailableBearings();
             values.insert(values.end(), bearings.begin(), bearings.end());
+            class_id_to_offset.push_back(values.size());
         }
     }
 
     IntersectionBearingsContainer(Vector<DiscreteBearing> values_,
                                   Vector<BearingClassID> node_to_class_id_,
-                                  RangeTable<16> class_id_to_ranges_table_)
+                                  Vector<std::uint32_t> class_id_to_offset_)
         : values(std::move(values_)), node_to_class_id(std::move(node_to_class_id_)),
-          class_id_to_ranges_table(std::move(class_id_to_ranges_table_))
+          class_id_to_offset(std::move(class_id_to_offset_))
     {
     }
 
-    // Returns the bearing class for an intersection node
+    // Returns the bearing class for an intersection node, the bearings of a class are found with
+    // two lookups in the offsets instead of decoding the block of a range table
     util::guidance::BearingClass GetBearingClass(const NodeID node) const
     {
-        auto class_id = node_to_class_id[node];
-        auto range = class_id_to_ranges_table.GetRange(class_id);
-        util::guidance::BearingClass result;
-        std::for_each(values.begin() + range.front(),
-                      values.begin() + range.back() + 1,
-                      [&](const DiscreteBearing &bearing) { result.add(bearing); });
-        return result;
+        const auto class_id = node_to_class_id[node];
+        return util::guidance::BearingClass(values.begin() + class_id_to_offset[class_id],
+                                            values.begin() + class_id_to_offset[class_id + 1]);
     }
 
     friend void serialization::read<Ownership>(storage::io::FileReader &reader,
@@ -92,7 +82,8 @@ template <storage::Ownership Ownership> class IntersectionBearingsContainer
   private:
     Vector<DiscreteBearing> values;
     Vector<BearingClassID> node_to_class_id;
-    RangeTable<16> class_id_to_ranges_table;
+    // the bearings of class i are values[class_id_to_offset[i], class_id_to_offset[i + 1])
+    Vector<std::uint32_t> class_id_to_offset;
 };
 }
 
@@ -8,6 +8,7 @@
 #include "storage/shared_memory_ownership.hpp"
 
 #include "util/permutation.hpp"
+#include "util/prefetch.hpp"
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
 
@@ -67,6 +68,15 @@ template <storage::Ownership Ownership> class EdgeBasedNodeDataContainerImpl
 
     ClassData GetClassData(const NodeID node_id) const { return classes[node_id]; }
 
+    // the data route assembly reads for every node of a path
+    void Prefetch(const NodeID node_id) const
+    {
+        util::prefetch(&geometry_ids[node_id]);
+        util::prefetch(&name_ids[node_id]);
+        util::prefetch(&travel_modes[node_id]);
+        util::prefetch(&classes[node_id]);
+    }
+
     // Used by EdgeBasedGraphFactory to fill data structure
     template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
     void SetData(NodeID node_id,
@@ -0,0 +1,67 @@
+#ifndef OSRM_EXTRACTOR_NODE_LOCATIONS_HPP
+#define OSRM_EXTRACTOR_NODE_LOCATIONS_HPP
+
+#include "util/coordinate.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/optional.hpp>
+
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/dense_mmap_array.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+
+namespace osrm
+{
+namespace extractor
+{
+
+// Dense store of the node coordinates, indexed by the OSM node id like the osmium location
+// indexes. Edges look up the coordinates of their nodes directly, instead of sorting all nodes
+// and edges to merge them. The store takes 8 bytes for every id up to the largest node id.
+class NodeLocations
+{
+  public:
+    void Set(const OSMNodeID id, const util::Coordinate coordinate)
+    {
+        // The fixed OSRM coordinates are the x and y of the location. They are always smaller than
+        // the undefined coordinate that marks the ids without a node.
+        index.set(static_cast<std::uint64_t>(id),
+                  osmium::Location{static_cast<std::int32_t>(coordinate.lon),
+                                   static_cast<std::int32_t>(coordinate.lat)});
+    }
+
+    boost::optional<util::Coordinate> Get(const OSMNodeID id) const
+    {
+        const auto location = index.get_noexcept(static_cast<std::uint64_t>(id));
+        if (!location.valid())
+        {
+            return boost::none;
+        }
+        return util::Coordinate{util::FixedLongitude{location.x()},
+                                util::FixedLatitude{location.y()}};
+    }
+
+    bool Has(const OSMNodeID id) const
+    {
+        return index.get_noexcept(static_cast<std::uint64_t>(id)).valid();
+    }
+
+    void Clear() { index.clear(); }
+
+  private:
+#ifdef OSMIUM_HAS_INDEX_MAP_DENSE_MMAP_ARRAY
+    using Index = osmium::index::map::DenseMmapArray<osmium::unsigned_object_id_type,
+                                                     osmium::Location>;
+#else
+    using Index = osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type,
+                                                    osmium::Location>;
+#endif
+    Index index;
+};
+}
+}
+
+#endif
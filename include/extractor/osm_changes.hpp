@@ -0,0 +1,50 @@
+#ifndef OSRM_EXTRACTOR_OSM_CHANGES_HPP
+#define OSRM_EXTRACTOR_OSM_CHANGES_HPP
+
+#include <boost/filesystem/path.hpp>
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+// The objects of OSM change files, applied to the buffers of the input file while it is read.
+// Changed objects replace the object of the input, deleted ones are removed and created ones are
+// inserted where they belong in the order of the input. The input has to be sorted by type and
+// id like the planet files and extracts are.
+class OSMChanges
+{
+  public:
+    // Keeps the latest version of every object in changes
+    explicit OSMChanges(osmium::memory::Buffer changes);
+
+    // Returns the buffer with the changes to the objects up to its last one applied. A buffer
+    // without changes is returned as it is.
+    osmium::memory::Buffer Apply(osmium::memory::Buffer buffer);
+
+    // Returns the created objects that come after the last object of the input
+    osmium::memory::Buffer Remaining();
+
+    std::size_t NumberOfChanges() const { return objects.size(); }
+
+  private:
+    void AddChange(osmium::memory::Buffer &buffer, const osmium::OSMObject &change) const;
+
+    osmium::memory::Buffer changes;
+    // the latest versions ordered by type and id
+    std::vector<const osmium::OSMObject *> objects;
+    std::size_t next_change = 0;
+};
+
+// Reads the objects of the change files in the order they are given
+osmium::memory::Buffer readChangeFiles(const std::vector<boost::filesystem::path> &paths);
+}
+}
+
+#endif
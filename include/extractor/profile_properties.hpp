@@ -6,9 +6,12 @@
 #include "util/typedefs.hpp"
 
 #include <algorithm>
+#include <array>
 #include <boost/assert.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 #include <cstdint>
+#include <iterator>
+#include <vector>
 
 namespace osrm
 {
@@ -21,6 +24,7 @@ struct ProfileProperties
 {
     static constexpr int MAX_WEIGHT_NAME_LENGTH = 255;
     static constexpr int MAX_CLASS_NAME_LENGTH = 255;
+    static constexpr std::size_t MAX_EXCLUDABLE_CLASSES = 8;
 
     ProfileProperties()
         : traffic_signal_penalty(0), u_turn_penalty(0),
@@ -29,6 +33,7 @@ struct ProfileProperties
           weight_name{"duration"}, call_tagless_node_function(true)
     {
         BOOST_ASSERT(weight_name[MAX_WEIGHT_NAME_LENGTH] == '\0');
+        excludable_classes.fill(0);
     }
 
     double GetUturnPenalty() const { return u_turn_penalty / 10.; }
@@ -87,6 +92,22 @@ struct ProfileProperties
         return std::string(*name_it);
     }
 
+    void SetExcludableClasses(std::size_t index, ClassData classes)
+    {
+        BOOST_ASSERT(index < MAX_EXCLUDABLE_CLASSES);
+        excludable_classes[index] = classes;
+    }
+
+    std::vector<ClassData> GetExcludableClasses() const
+    {
+        std::vector<ClassData> classes;
+        std::copy_if(excludable_classes.begin(),
+                     excludable_classes.end(),
+                     std::back_inserter(classes),
+                     [](const ClassData data) { return data != 0; });
+        return classes;
+    }
+
     double GetWeightMultiplier() const { return std::pow(10., weight_precision); }
 
     double GetMaxTurnWeight() const
@@ -109,9 +130,15 @@ struct ProfileProperties
     char weight_name[MAX_WEIGHT_NAME_LENGTH + 1];
     //! stores the names of each class
     std::array<char[MAX_CLASS_NAME_LENGTH + 1], MAX_CLASS_INDEX + 1> class_names;
+    //! combinations of classes that MLD can exclude at query time, unused entries are 0
+    std::array<ClassData, MAX_EXCLUDABLE_CLASSES> excludable_classes;
+    //! number of MLD metrics osrm-customize added for the time slots of speed profiles
+    std::uint32_t num_time_slots = 0;
     unsigned weight_precision = 1;
     bool force_split_edges = false;
     bool call_tagless_node_function = true;
+    //! the way function only reads the tags of the way, its results are cached by tag set
+    bool way_function_depends_on_tags_only = false;
 };
 }
 }
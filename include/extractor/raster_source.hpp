@@ -8,11 +8,14 @@
 #include <boost/assert.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/qi_int.hpp>
 #include <storage/io.hpp>
 
+#include <cstdint>
 #include <iterator>
+#include <memory>
 #include <unordered_map>
 
 namespace osrm
@@ -35,13 +38,29 @@ struct RasterDatum
     RasterDatum(std::int32_t _datum) : datum(_datum) {}
 };
 
+// A binary raster file starts with this header in the byte order of the machine. The values
+// follow as tiles of tile_size x tile_size values, the tiles and the values within a tile in row
+// major order. The tiles at the right and bottom border are padded to the full tile size.
+struct RasterFileHeader
+{
+    static constexpr std::uint32_t VERSION = 1;
+
+    // "OSRMRST" followed by a zero
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t tile_size;
+    std::uint64_t width;
+    std::uint64_t height;
+};
+static_assert(sizeof(RasterFileHeader) == 32, "RasterFileHeader is part of the file format");
+
 class RasterGrid
 {
   public:
+    // Parses an ASCII raster with rows of integers
     RasterGrid(const boost::filesystem::path &filepath, std::size_t _xdim, std::size_t _ydim)
+        : xdim(_xdim), ydim(_ydim), tile_size(0)
     {
-        xdim = _xdim;
-        ydim = _ydim;
         _data.reserve(ydim * xdim);
 
         storage::io::FileReader file_reader(filepath, storage::io::FileReader::HasNoFingerprint);
@@ -77,22 +96,49 @@ class RasterGrid
         }
     }
 
+    // Maps a binary raster file, tiles are only read from disk when they are touched
+    explicit RasterGrid(const boost::filesystem::path &filepath);
+
     RasterGrid(const RasterGrid &) = default;
     RasterGrid &operator=(const RasterGrid &) = default;
 
     RasterGrid(RasterGrid &&) = default;
     RasterGrid &operator=(RasterGrid &&) = default;
 
-    std::int32_t operator()(std::size_t x, std::size_t y) { return _data[y * xdim + x]; }
-    std::int32_t operator()(std::size_t x, std::size_t y) const { return _data[(y)*xdim + (x)]; }
+    std::int32_t operator()(std::size_t x, std::size_t y) const
+    {
+        if (!region)
+            return _data[y * xdim + x];
+
+        const auto tiles_per_row = (xdim + tile_size - 1) / tile_size;
+        const auto tile = (y / tile_size) * tiles_per_row + x / tile_size;
+        return mapped_data[(tile * tile_size + y % tile_size) * tile_size + x % tile_size];
+    }
+
+    std::size_t Width() const { return xdim; }
+    std::size_t Height() const { return ydim; }
 
   private:
+    // parsed values of an ASCII raster in row major order
     std::vector<std::int32_t> _data;
+    // values of a binary raster, read only and shared by all copies of the grid
+    std::shared_ptr<boost::iostreams::mapped_file_source> region;
+    const std::int32_t *mapped_data = nullptr;
     std::size_t xdim, ydim;
+    std::size_t tile_size;
 };
 
+// True if the file starts with the header of a binary raster file
+bool isRasterFile(const boost::filesystem::path &path);
+
+// Writes the grid as binary raster file with tiles of tile_size x tile_size values
+void writeRasterFile(const boost::filesystem::path &path,
+                     const RasterGrid &grid,
+                     const std::uint32_t tile_size);
+
 /**
-    \brief Stores raster source data in memory and provides lookup functions.
+    \brief Stores raster source data in memory and provides lookup functions. Lookups only read
+   the grid and can be done from multiple threads at the same time.
 */
 class RasterSource
 {
@@ -4,8 +4,7 @@
 #include "extractor/restriction.hpp"
 #include "util/typedefs.hpp"
 
-#include <boost/unordered_map.hpp>
-
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -15,10 +14,15 @@ namespace extractor
 {
 
 // allows easy check for whether a node intersection is present at a given intersection
+//
+// The index is a flat array sorted by the (first, second) key. It is only read after construction,
+// so a lookup is a binary search and all restrictions of a key are a contiguous range of entries.
 template <typename restriction_type> class RestrictionIndex
 {
   public:
     using value_type = restriction_type;
+    using KeyType = std::pair<NodeID, NodeID>;
+    using EntryType = std::pair<KeyType, restriction_type *>;
 
     template <typename extractor_type>
     RestrictionIndex(std::vector<restriction_type> &restrictions, extractor_type extractor);
@@ -27,13 +31,26 @@ template <typename restriction_type> class RestrictionIndex
 
     auto Restrictions(NodeID first, NodeID second) const
     {
-        return restriction_hash.equal_range(std::make_pair(first, second));
+        return std::equal_range(restriction_entries.cbegin(),
+                                restriction_entries.cend(),
+                                std::make_pair(first, second),
+                                CompareKey{});
     };
 
-    auto Size() const { return restriction_hash.size(); }
+    auto Size() const { return restriction_entries.size(); }
 
   private:
-    boost::unordered_multimap<std::pair<NodeID, NodeID>, restriction_type *> restriction_hash;
+    struct CompareKey
+    {
+        bool operator()(const EntryType &lhs, const KeyType &rhs) const { return lhs.first < rhs; }
+        bool operator()(const KeyType &lhs, const EntryType &rhs) const { return lhs < rhs.first; }
+        bool operator()(const EntryType &lhs, const EntryType &rhs) const
+        {
+            return lhs.first < rhs.first;
+        }
+    };
+
+    std::vector<EntryType> restriction_entries;
 };
 
 template <typename restriction_type>
@@ -41,15 +58,21 @@ template <typename extractor_type>
 RestrictionIndex<restriction_type>::RestrictionIndex(std::vector<restriction_type> &restrictions,
                                                      extractor_type extractor)
 {
-    // build a multi-map
+    restriction_entries.reserve(restrictions.size());
     for (auto &restriction : restrictions)
-        restriction_hash.insert(std::make_pair(extractor(restriction), &restriction));
+        restriction_entries.emplace_back(extractor(restriction), &restriction);
+
+    // restrictions sharing a key keep the order of the input
+    std::stable_sort(restriction_entries.begin(), restriction_entries.end(), CompareKey{});
 }
 
 template <typename restriction_type>
 bool RestrictionIndex<restriction_type>::IsIndexed(const NodeID first, const NodeID second) const
 {
-    return restriction_hash.count(std::make_pair(first, second));
+    return std::binary_search(restriction_entries.begin(),
+                              restriction_entries.end(),
+                              std::make_pair(first, second),
+                              CompareKey{});
 }
 
 struct IndexNodeByFromAndVia
@@ -0,0 +1,50 @@
+#ifndef OSRM_EXTRACTOR_ROUTABLE_NODE_FILTER_HPP
+#define OSRM_EXTRACTOR_ROUTABLE_NODE_FILTER_HPP
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+// The nodes of the ways a profile may route on, collected in a first pass over the ways of the
+// input so the second pass skips all other nodes before they reach the profile. A way is a
+// candidate if it has one of the keys the profile lists in way_prefilter_keys, or any way if
+// the profile lists none.
+class RoutableNodeFilter
+{
+  public:
+    explicit RoutableNodeFilter(std::vector<std::string> way_keys);
+
+    bool IsCandidate(const osmium::Way &way) const;
+
+    // Marks the nodes of the way if it is a candidate
+    void AddWay(const osmium::Way &way);
+
+    bool IsReferenced(const osmium::Node &node) const
+    {
+        return referenced_nodes.get(node.positive_id());
+    }
+
+    std::size_t NumberOfReferencedNodes() const { return referenced_nodes.size(); }
+
+    // Copies the referenced nodes, the candidate ways and all relations of the buffer
+    osmium::memory::Buffer Filter(const osmium::memory::Buffer &buffer) const;
+
+  private:
+    std::vector<std::string> way_keys;
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> referenced_nodes;
+};
+}
+}
+
+#endif
@@ -54,7 +54,11 @@ class ScriptingEnvironment
 
     virtual std::vector<std::string> GetNameSuffixList() = 0;
     virtual std::vector<std::string> GetRestrictions() = 0;
+    virtual std::vector<std::vector<std::string>> GetExcludableClasses() = 0;
+    // Tag keys of which a way needs one to be routable, empty if the profile does not say
+    virtual std::vector<std::string> GetWayPrefilterKeys() = 0;
     virtual void ProcessTurn(ExtractionTurn &turn) = 0;
+    // Called concurrently from several threads
     virtual void ProcessSegment(ExtractionSegment &segment) = 0;
 
     virtual void
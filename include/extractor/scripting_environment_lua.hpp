@@ -1,9 +1,12 @@
 #ifndef SCRIPTING_ENVIRONMENT_LUA_HPP
 #define SCRIPTING_ENVIRONMENT_LUA_HPP
 
+#include "extractor/extraction_way.hpp"
 #include "extractor/raster_source.hpp"
 #include "extractor/scripting_environment.hpp"
 
+#include "util/lru_cache.hpp"
+
 #include <tbb/enumerable_thread_specific.h>
 
 #include <memory>
@@ -21,6 +24,11 @@ struct LuaScriptingContext final
 {
     void ProcessNode(const osmium::Node &, ExtractionNode &result);
     void ProcessWay(const osmium::Way &, ExtractionWay &result);
+    // Calls the way function only for tag sets that are not cached yet
+    void ProcessWayCached(const osmium::Way &, ExtractionWay &result);
+    // Copies the cached result of the tag set of the way, false if it is not cached
+    bool GetCachedWay(const osmium::Way &, ExtractionWay &result);
+    void CacheWay(const osmium::Way &, const ExtractionWay &result);
 
     ProfileProperties properties;
     RasterContainer raster_sources;
@@ -38,6 +46,12 @@ struct LuaScriptingContext final
 
     int api_version;
     sol::table profile_table;
+
+    // Most ways share their tag set with many others, e.g. a bare highway=residential. The
+    // context belongs to one thread, so the cache has a single shard.
+    static constexpr std::size_t WAY_CACHE_SIZE = 1 << 16;
+    util::ShardedLRUCache<std::string, ExtractionWay> way_cache{WAY_CACHE_SIZE, 1};
+    std::string way_cache_key;
 };
 
 /**
@@ -51,7 +65,7 @@ class Sol2ScriptingEnvironment final : public ScriptingEnvironment
 {
   public:
     static const constexpr int SUPPORTED_MIN_API_VERSION = 0;
-    static const constexpr int SUPPORTED_MAX_API_VERSION = 2;
+    static const constexpr int SUPPORTED_MAX_API_VERSION = 3;
 
     explicit Sol2ScriptingEnvironment(const std::string &file_name);
     ~Sol2ScriptingEnvironment() override = default;
@@ -63,7 +77,9 @@ class Sol2ScriptingEnvironment final : public ScriptingEnvironment
     std::vector<std::string> GetStringListFromTable(const std::string &table_name);
     std::vector<std::string> GetStringListFromFunction(const std::string &function_name);
     std::vector<std::string> GetNameSuffixList() override;
+    std::vector<std::string> GetWayPrefilterKeys() override;
     std::vector<std::string> GetRestrictions() override;
+    std::vector<std::vector<std::string>> GetExcludableClasses() override;
     void ProcessTurn(ExtractionTurn &turn) override;
     void ProcessSegment(ExtractionSegment &segment) override;
 
@@ -76,6 +92,14 @@ class Sol2ScriptingEnvironment final : public ScriptingEnvironment
 
   private:
     void InitContext(LuaScriptingContext &context);
+    // Version 3 profiles process all nodes and all ways of a buffer in one call each
+    void ProcessElementBatches(
+        LuaScriptingContext &context,
+        const osmium::memory::Buffer &buffer,
+        const RestrictionParser &restriction_parser,
+        std::vector<std::pair<const osmium::Node &, ExtractionNode>> &resulting_nodes,
+        std::vector<std::pair<const osmium::Way &, ExtractionWay>> &resulting_ways,
+        std::vector<InputConditionalTurnRestriction> &resulting_restrictions);
     std::mutex init_mutex;
     std::string file_name;
     tbb::enumerable_thread_specific<std::unique_ptr<LuaScriptingContext>> script_contexts;
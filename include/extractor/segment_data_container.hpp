@@ -35,6 +35,9 @@ template <storage::Ownership Ownership>
 inline void read(storage::io::FileReader &reader,
                  detail::SegmentDataContainerImpl<Ownership> &segment_data);
 template <storage::Ownership Ownership>
+inline void readMetric(storage::io::FileReader &reader,
+                       detail::SegmentDataContainerImpl<Ownership> &segment_data);
+template <storage::Ownership Ownership>
 inline void write(storage::io::FileWriter &writer,
                   const detail::SegmentDataContainerImpl<Ownership> &segment_data);
 }
@@ -53,6 +56,7 @@ template <storage::Ownership Ownership> class SegmentDataContainerImpl
     // FIXME We should change the indexing to Edge-Based-Node id
     using DirectionalGeometryID = std::uint32_t;
     using SegmentOffset = std::uint32_t;
+    using SegmentNodeVector = Vector<NodeID>;
     using SegmentWeightVector = PackedVector<SegmentWeight, SEGMENT_WEIGHT_BITS>;
     using SegmentDurationVector = PackedVector<SegmentDuration, SEGMENT_DURAITON_BITS>;
     using SegmentDatasourceVector = Vector<DatasourceID>;
@@ -198,10 +202,17 @@ template <storage::Ownership Ownership> class SegmentDataContainerImpl
 
     auto GetNumberOfGeometries() const { return index.size() - 1; }
     auto GetNumberOfSegments() const { return fwd_weights.size(); }
+    auto GetNumberOfSegments(const DirectionalGeometryID id) const
+    {
+        return index[id + 1] - index[id] - 1;
+    }
 
     friend void
     serialization::read<Ownership>(storage::io::FileReader &reader,
                                    detail::SegmentDataContainerImpl<Ownership> &segment_data);
+    friend void
+    serialization::readMetric<Ownership>(storage::io::FileReader &reader,
+                                         detail::SegmentDataContainerImpl<Ownership> &segment_data);
     friend void serialization::write<Ownership>(
         storage::io::FileWriter &writer,
         const detail::SegmentDataContainerImpl<Ownership> &segment_data);
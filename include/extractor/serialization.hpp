@@ -30,7 +30,7 @@ inline void read(storage::io::FileReader &reader,
 {
     storage::serialization::read(reader, intersection_bearings.values);
     storage::serialization::read(reader, intersection_bearings.node_to_class_id);
-    util::serialization::read(reader, intersection_bearings.class_id_to_ranges_table);
+    storage::serialization::read(reader, intersection_bearings.class_id_to_offset);
 }
 
 template <storage::Ownership Ownership>
@@ -39,7 +39,7 @@ inline void write(storage::io::FileWriter &writer,
 {
     storage::serialization::write(writer, intersection_bearings.values);
     storage::serialization::write(writer, intersection_bearings.node_to_class_id);
-    util::serialization::write(writer, intersection_bearings.class_id_to_ranges_table);
+    storage::serialization::write(writer, intersection_bearings.class_id_to_offset);
 }
 
 // read/write for properties file
@@ -79,6 +79,21 @@ inline void read(storage::io::FileReader &reader,
     storage::serialization::read(reader, segment_data.rev_datasources);
 }
 
+// only reads the weights, durations and datasources, skips the geometries
+template <storage::Ownership Ownership>
+inline void readMetric(storage::io::FileReader &reader,
+                       detail::SegmentDataContainerImpl<Ownership> &segment_data)
+{
+    reader.ReadVectorSize<std::uint32_t>(); // index
+    reader.ReadVectorSize<NodeID>();        // nodes
+    util::serialization::read(reader, segment_data.fwd_weights);
+    util::serialization::read(reader, segment_data.rev_weights);
+    util::serialization::read(reader, segment_data.fwd_durations);
+    util::serialization::read(reader, segment_data.rev_durations);
+    storage::serialization::read(reader, segment_data.fwd_datasources);
+    storage::serialization::read(reader, segment_data.rev_datasources);
+}
+
 template <storage::Ownership Ownership>
 inline void write(storage::io::FileWriter &writer,
                   const detail::SegmentDataContainerImpl<Ownership> &segment_data)
@@ -98,22 +113,14 @@ template <storage::Ownership Ownership>
 inline void read(storage::io::FileReader &reader,
                  detail::TurnDataContainerImpl<Ownership> &turn_data_container)
 {
-    storage::serialization::read(reader, turn_data_container.turn_instructions);
-    storage::serialization::read(reader, turn_data_container.lane_data_ids);
-    storage::serialization::read(reader, turn_data_container.entry_class_ids);
-    storage::serialization::read(reader, turn_data_container.pre_turn_bearings);
-    storage::serialization::read(reader, turn_data_container.post_turn_bearings);
+    storage::serialization::read(reader, turn_data_container.turns);
 }
 
 template <storage::Ownership Ownership>
 inline void write(storage::io::FileWriter &writer,
                   const detail::TurnDataContainerImpl<Ownership> &turn_data_container)
 {
-    storage::serialization::write(writer, turn_data_container.turn_instructions);
-    storage::serialization::write(writer, turn_data_container.lane_data_ids);
-    storage::serialization::write(writer, turn_data_container.entry_class_ids);
-    storage::serialization::write(writer, turn_data_container.pre_turn_bearings);
-    storage::serialization::write(writer, turn_data_container.post_turn_bearings);
+    storage::serialization::write(writer, turn_data_container.turns);
 }
 
 template <storage::Ownership Ownership>
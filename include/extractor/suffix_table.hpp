@@ -1,8 +1,10 @@
 #ifndef OSRM_EXTRACTOR_SUFFIX_LIST_HPP_
 #define OSRM_EXTRACTOR_SUFFIX_LIST_HPP_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_set>
+#include <vector>
 
 #include "util/string_view.hpp"
 
@@ -14,29 +16,29 @@ namespace extractor
 class ScriptingEnvironment;
 
 // A table containing suffixes.
-// At the moment, it is only a front for an unordered set. At some point we might want to make it
-// country dependent and have it behave accordingly
+// The suffixes of the profile are stored in a perfect hash table, every suffix has a slot of its
+// own so a membership check hashes the string once and compares it with at most one suffix.
+// Checks are case insensitive for ASCII letters. At some point we might want to make it country
+// dependent and have it behave accordingly
 class SuffixTable final
 {
   public:
     SuffixTable(ScriptingEnvironment &scripting_environment);
+    SuffixTable(std::vector<std::string> suffixes);
 
     // check whether a string is part of the know suffix list
     bool isSuffix(const std::string &possible_suffix) const;
     bool isSuffix(util::StringView possible_suffix) const;
 
   private:
-    // Store lower-cased strings in SuffixTable and a set of StringViews for quick membership
-    // checks.
-    //
-    // Why not uset<StringView>? StringView is non-owning, the vector<string> holds the string
-    // contents, the set<StringView> only holds [first,last) pointers into the vector.
-    //
-    // Then why not simply uset<string>? Because membership tests against StringView keys would
-    // require us to first convert StringViews into strings (allocation), do the membership,
-    // and destroy the StringView again.
+    std::uint32_t hash(util::StringView string) const;
+
+    // lower-cased and without duplicates
     std::vector<std::string> suffixes;
-    std::unordered_set<util::StringView> suffix_set;
+    // index of the suffix in a slot plus one, zero for empty slots
+    std::vector<std::uint32_t> slots;
+    std::uint32_t seed = 0;
+    std::size_t max_length = 0;
 };
 
 } /* namespace extractor */
@@ -16,10 +16,17 @@
 #include <boost/assert.hpp>
 #include <cstdint>
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <memory>
 #include <stack>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -27,6 +34,14 @@ namespace osrm
 namespace extractor
 {
 
+// Computes the strongly connected components of a graph in parallel:
+//  - nodes without incoming or outgoing edges are trimmed as components of their own
+//  - the component of a well connected pivot node, which holds most of the nodes of a road
+//    network, is the intersection of a parallel forward and backward search from the pivot
+//  - the remaining nodes form independent subgraphs: reached only forward, only backward or
+//    not at all. Their weakly connected components are searched with Tarjan's algorithm in
+//    parallel.
+// The components are numbered by their smallest node id.
 template <typename GraphT> class TarjanSCC
 {
     struct TarjanStackFrame
@@ -38,10 +53,25 @@ template <typename GraphT> class TarjanSCC
 
     struct TarjanNode
     {
-        TarjanNode() : index(SPECIAL_NODEID), low_link(SPECIAL_NODEID), on_stack(false) {}
+        TarjanNode()
+            : index(SPECIAL_NODEID), low_link(SPECIAL_NODEID), on_stack(false),
+              before_recursion(true)
+        {
+        }
         unsigned index;
         unsigned low_link;
         bool on_stack;
+        bool before_recursion;
+    };
+
+    // The phase that found the component of a node
+    enum NodeClass : std::uint8_t
+    {
+        REMAINING = 0,
+        FORWARD_REACHED = 1,
+        BACKWARD_REACHED = 2,
+        PIVOT_COMPONENT = FORWARD_REACHED | BACKWARD_REACHED,
+        TRIMMED = 4
     };
 
     std::vector<unsigned> components_index;
@@ -49,6 +79,14 @@ template <typename GraphT> class TarjanSCC
     const GraphT &m_graph;
     std::size_t size_one_counter;
 
+    // incoming edges of every node
+    std::vector<EdgeID> reverse_offsets;
+    std::vector<NodeID> reverse_sources;
+    // classes and components of the nodes while the search runs, a component is labeled by the
+    // id of one of its nodes
+    std::vector<std::uint8_t> node_class;
+    std::vector<NodeID> labels;
+
   public:
     TarjanSCC(const GraphT &graph)
         : components_index(graph.GetNumberOfNodes(), SPECIAL_NODEID), m_graph(graph),
@@ -61,20 +99,308 @@ template <typename GraphT> class TarjanSCC
     {
         TIMER_START(SCC_RUN);
         const NodeID max_node_id = m_graph.GetNumberOfNodes();
+        node_class.assign(max_node_id, REMAINING);
+        labels.assign(max_node_id, SPECIAL_NODEID);
+
+        BuildReverseGraph();
+        TrimNodes();
+        SearchPivotComponent();
+        SearchRemainingComponents();
+        NumberComponents();
+
+        reverse_offsets = std::vector<EdgeID>();
+        reverse_sources = std::vector<NodeID>();
+        node_class = std::vector<std::uint8_t>();
+        labels = std::vector<NodeID>();
+
+        TIMER_STOP(SCC_RUN);
+        const auto large_component_count =
+            std::count_if(component_size_vector.begin(),
+                          component_size_vector.end(),
+                          [](unsigned value) { return value > 1000; });
+        util::Log() << "Found " << component_size_vector.size() << " SCC (" << large_component_count
+                    << " large, " << (component_size_vector.size() - large_component_count)
+                    << " small)";
+        util::Log() << "SCC run took: " << TIMER_MSEC(SCC_RUN) / 1000. << "s";
+
+        size_one_counter = std::count_if(component_size_vector.begin(),
+                                         component_size_vector.end(),
+                                         [](unsigned value) { return 1 == value; });
+    }
+
+    std::size_t GetNumberOfComponents() const { return component_size_vector.size(); }
+
+    std::size_t GetSizeOneCount() const { return size_one_counter; }
+
+    unsigned GetComponentSize(const unsigned component_id) const
+    {
+        return component_size_vector[component_id];
+    }
+
+    unsigned GetComponentID(const NodeID node) const { return components_index[node]; }
+
+  private:
+    template <typename Callback> void ForEachTarget(const NodeID node, Callback &&callback) const
+    {
+        for (const auto edge : m_graph.GetAdjacentEdgeRange(node))
+        {
+            callback(static_cast<NodeID>(m_graph.GetTarget(edge)));
+        }
+    }
+
+    template <typename Callback> void ForEachSource(const NodeID node, Callback &&callback) const
+    {
+        for (auto index = reverse_offsets[node]; index < reverse_offsets[node + 1]; ++index)
+        {
+            callback(reverse_sources[index]);
+        }
+    }
+
+    template <typename Body> void ParallelForNodes(Body &&body) const
+    {
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, node_class.size()),
+                          [&](const tbb::blocked_range<NodeID> &range) {
+                              for (auto node = range.begin(); node != range.end(); ++node)
+                              {
+                                  body(node);
+                              }
+                          });
+    }
+
+    void BuildReverseGraph()
+    {
+        const NodeID number_of_nodes = node_class.size();
+
+        std::vector<std::atomic<EdgeID>> positions(number_of_nodes + 1);
+        ParallelForNodes([&](const NodeID node) {
+            ForEachTarget(node, [&](const NodeID target) {
+                positions[target + 1].fetch_add(1, std::memory_order_relaxed);
+            });
+        });
+
+        reverse_offsets.resize(number_of_nodes + 1);
+        reverse_offsets[0] = 0;
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            reverse_offsets[node + 1] = reverse_offsets[node] + positions[node + 1].load();
+            positions[node].store(reverse_offsets[node]);
+        }
+
+        reverse_sources.resize(reverse_offsets.back());
+        ParallelForNodes([&](const NodeID node) {
+            ForEachTarget(node, [&](const NodeID target) {
+                reverse_sources[positions[target].fetch_add(1, std::memory_order_relaxed)] = node;
+            });
+        });
+    }
+
+    // Nodes that cannot be entered or left from other nodes are components of their own. Every
+    // round trims the nodes that are left with only trimmed neighbours on one side.
+    void TrimNodes()
+    {
+        const constexpr int TRIM_ROUNDS = 3;
 
+        std::vector<std::uint8_t> trim(node_class.size());
+        for (int round = 0; round < TRIM_ROUNDS; ++round)
+        {
+            const auto has_neighbour = [this](const NodeID node, const NodeID neighbour) {
+                return neighbour != node && node_class[neighbour] != TRIMMED;
+            };
+
+            ParallelForNodes([&](const NodeID node) {
+                if (node_class[node] == TRIMMED)
+                {
+                    trim[node] = false;
+                    return;
+                }
+                bool has_target = false, has_source = false;
+                ForEachTarget(node, [&](const NodeID target) {
+                    has_target = has_target || has_neighbour(node, target);
+                });
+                ForEachSource(node, [&](const NodeID source) {
+                    has_source = has_source || has_neighbour(node, source);
+                });
+                trim[node] = !has_target || !has_source;
+            });
+
+            std::atomic<std::size_t> trimmed_nodes{0};
+            ParallelForNodes([&](const NodeID node) {
+                if (trim[node])
+                {
+                    node_class[node] = TRIMMED;
+                    labels[node] = node;
+                    trimmed_nodes.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+
+            if (trimmed_nodes == 0)
+                break;
+        }
+    }
+
+    // Marks all untrimmed nodes that are reachable from the pivot with reached
+    template <typename ForEachNeighbour>
+    void MarkReachable(const NodeID pivot,
+                       const std::uint8_t reached,
+                       const ForEachNeighbour &for_each_neighbour)
+    {
+        std::vector<std::atomic<bool>> visited(node_class.size());
+        visited[pivot].store(true);
+
+        // the search runs level by level, every level is expanded in parallel
+        std::vector<NodeID> frontier{pivot};
+        tbb::enumerable_thread_specific<std::vector<NodeID>> next_frontiers;
+        while (!frontier.empty())
+        {
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, frontier.size()),
+                              [&](const tbb::blocked_range<std::size_t> &range) {
+                                  auto &next_frontier = next_frontiers.local();
+                                  for (auto index = range.begin(); index != range.end(); ++index)
+                                  {
+                                      for_each_neighbour(frontier[index], [&](const NodeID node) {
+                                          if (node_class[node] != TRIMMED &&
+                                              !visited[node].load(std::memory_order_relaxed) &&
+                                              !visited[node].exchange(true))
+                                          {
+                                              next_frontier.push_back(node);
+                                          }
+                                      });
+                                  }
+                              });
+
+            frontier.clear();
+            for (auto &next_frontier : next_frontiers)
+            {
+                frontier.insert(frontier.end(), next_frontier.begin(), next_frontier.end());
+                next_frontier.clear();
+            }
+        }
+
+        ParallelForNodes([&](const NodeID node) {
+            if (visited[node].load(std::memory_order_relaxed))
+                node_class[node] |= reached;
+        });
+    }
+
+    void SearchPivotComponent()
+    {
+        // the node with the most connections is most likely part of the giant component
+        NodeID pivot = SPECIAL_NODEID;
+        std::uint64_t pivot_connections = 0;
+        for (const auto node : util::irange<NodeID>(0, node_class.size()))
+        {
+            if (node_class[node] == TRIMMED)
+                continue;
+
+            const auto out_degree = m_graph.GetAdjacentEdgeRange(node).size();
+            const auto in_degree = reverse_offsets[node + 1] - reverse_offsets[node];
+            const std::uint64_t connections = std::uint64_t{out_degree} * in_degree;
+            if (pivot == SPECIAL_NODEID || connections > pivot_connections)
+            {
+                pivot = node;
+                pivot_connections = connections;
+            }
+        }
+
+        if (pivot == SPECIAL_NODEID)
+            return;
+
+        MarkReachable(pivot, FORWARD_REACHED, [this](const NodeID node, const auto &callback) {
+            ForEachTarget(node, callback);
+        });
+        MarkReachable(pivot, BACKWARD_REACHED, [this](const NodeID node, const auto &callback) {
+            ForEachSource(node, callback);
+        });
+
+        ParallelForNodes([&](const NodeID node) {
+            if (node_class[node] == PIVOT_COMPONENT)
+                labels[node] = pivot;
+        });
+    }
+
+    // Components never span nodes of different classes, so every weakly connected component of
+    // the nodes of one class is searched on its own.
+    void SearchRemainingComponents()
+    {
+        const auto is_remaining = [this](const NodeID node) {
+            return node_class[node] < PIVOT_COMPONENT;
+        };
+
+        std::vector<NodeID> parents(node_class.size());
+        const auto find = [&parents](NodeID node) {
+            while (parents[node] != node)
+            {
+                parents[node] = parents[parents[node]];
+                node = parents[node];
+            }
+            return node;
+        };
+
+        std::vector<std::pair<NodeID, NodeID>> root_and_node;
+        for (const auto node : util::irange<NodeID>(0, node_class.size()))
+        {
+            if (is_remaining(node))
+                parents[node] = node;
+        }
+        for (const auto node : util::irange<NodeID>(0, node_class.size()))
+        {
+            if (!is_remaining(node))
+                continue;
+
+            ForEachTarget(node, [&](const NodeID target) {
+                if (node_class[target] == node_class[node])
+                {
+                    const auto node_root = find(node);
+                    const auto target_root = find(target);
+                    parents[std::max(node_root, target_root)] = std::min(node_root, target_root);
+                }
+            });
+        }
+        for (const auto node : util::irange<NodeID>(0, node_class.size()))
+        {
+            if (is_remaining(node))
+                root_and_node.emplace_back(find(node), node);
+        }
+        parents = std::vector<NodeID>();
+        tbb::parallel_sort(root_and_node.begin(), root_and_node.end());
+
+        std::vector<std::size_t> group_begins;
+        for (const auto index : util::irange<std::size_t>(0, root_and_node.size()))
+        {
+            if (index == 0 || root_and_node[index - 1].first != root_and_node[index].first)
+                group_begins.push_back(index);
+        }
+        group_begins.push_back(root_and_node.size());
+
+        std::vector<TarjanNode> tarjan_node_list(node_class.size());
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, group_begins.size() - 1),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              for (auto group = range.begin(); group != range.end(); ++group)
+                              {
+                                  RunTarjan(root_and_node.begin() + group_begins[group],
+                                            root_and_node.begin() + group_begins[group + 1],
+                                            tarjan_node_list);
+                              }
+                          });
+    }
+
+    // Tarjan's algorithm on a weakly connected part of the nodes of one class. The parts share
+    // no nodes, so they can write the node list at the same time.
+    template <typename Iterator>
+    void RunTarjan(const Iterator begin,
+                   const Iterator end,
+                   std::vector<TarjanNode> &tarjan_node_list)
+    {
         // The following is a hack to distinguish between stuff that happens
         // before the recursive call and stuff that happens after
         std::stack<TarjanStackFrame> recursion_stack;
         // true = stuff before, false = stuff after call
         std::stack<NodeID> tarjan_stack;
-        std::vector<TarjanNode> tarjan_node_list(max_node_id);
-        unsigned component_index = 0, size_of_current_component = 0;
-        unsigned large_component_count = 0;
         unsigned index = 0;
-        std::vector<bool> processing_node_before_recursion(max_node_id, true);
-        for (const NodeID node : util::irange(0u, max_node_id))
+        for (auto entry = begin; entry != end; ++entry)
         {
-            if (SPECIAL_NODEID == components_index[node])
+            const NodeID node = entry->second;
+            if (SPECIAL_NODEID == tarjan_node_list[node].index)
             {
                 recursion_stack.emplace(TarjanStackFrame(node, node));
             }
@@ -86,7 +412,7 @@ template <typename GraphT> class TarjanSCC
                 const NodeID v = currentFrame.v;
                 recursion_stack.pop();
 
-                const bool before_recursion = processing_node_before_recursion[v];
+                const bool before_recursion = tarjan_node_list[v].before_recursion;
 
                 if (before_recursion && tarjan_node_list[v].index != UINT_MAX)
                 {
@@ -97,7 +423,7 @@ template <typename GraphT> class TarjanSCC
                 {
                     // Mark frame to handle tail of recursion
                     recursion_stack.emplace(currentFrame);
-                    processing_node_before_recursion[v] = false;
+                    tarjan_node_list[v].before_recursion = false;
 
                     // Mark essential information for SCC
                     tarjan_node_list[v].index = index;
@@ -106,9 +432,10 @@ template <typename GraphT> class TarjanSCC
                     tarjan_node_list[v].on_stack = true;
                     ++index;
 
-                    for (const auto current_edge : m_graph.GetAdjacentEdgeRange(v))
-                    {
-                        const auto vprime = m_graph.GetTarget(current_edge);
+                    ForEachTarget(v, [&](const NodeID vprime) {
+                        // edges to other classes leave the part
+                        if (node_class[vprime] != node_class[v])
+                            return;
 
                         if (SPECIAL_NODEID == tarjan_node_list[vprime].index)
                         {
@@ -122,11 +449,11 @@ template <typename GraphT> class TarjanSCC
                                 tarjan_node_list[v].low_link = tarjan_node_list[vprime].index;
                             }
                         }
-                    }
+                    });
                 }
                 else
                 {
-                    processing_node_before_recursion[v] = true;
+                    tarjan_node_list[v].before_recursion = true;
                     tarjan_node_list[u].low_link =
                         std::min(tarjan_node_list[u].low_link, tarjan_node_list[v].low_link);
                     // after recursion, lets do cycle checking
@@ -139,46 +466,40 @@ template <typename GraphT> class TarjanSCC
                             vprime = tarjan_stack.top();
                             tarjan_stack.pop();
                             tarjan_node_list[vprime].on_stack = false;
-                            components_index[vprime] = component_index;
-                            ++size_of_current_component;
+                            labels[vprime] = v;
                         } while (v != vprime);
-
-                        component_size_vector.emplace_back(size_of_current_component);
-
-                        if (size_of_current_component > 1000)
-                        {
-                            ++large_component_count;
-                            util::Log(logDEBUG) << "large component [" << component_index
-                                                << "]=" << size_of_current_component;
-                        }
-
-                        ++component_index;
-                        size_of_current_component = 0;
                     }
                 }
             }
         }
-
-        TIMER_STOP(SCC_RUN);
-        util::Log() << "Found " << component_index << " SCC (" << large_component_count
-                    << " large, " << (component_index - large_component_count) << " small)";
-        util::Log() << "SCC run took: " << TIMER_MSEC(SCC_RUN) / 1000. << "s";
-
-        size_one_counter = std::count_if(component_size_vector.begin(),
-                                         component_size_vector.end(),
-                                         [](unsigned value) { return 1 == value; });
     }
 
-    std::size_t GetNumberOfComponents() const { return component_size_vector.size(); }
-
-    std::size_t GetSizeOneCount() const { return size_one_counter; }
-
-    unsigned GetComponentSize(const unsigned component_id) const
+    // Numbers the components by their smallest node, independent of the labels
+    void NumberComponents()
     {
-        return component_size_vector[component_id];
-    }
+        std::vector<unsigned> component_by_label(node_class.size(), SPECIAL_NODEID);
+        for (const auto node : util::irange<NodeID>(0, node_class.size()))
+        {
+            BOOST_ASSERT(labels[node] != SPECIAL_NODEID);
+            auto &component = component_by_label[labels[node]];
+            if (component == SPECIAL_NODEID)
+            {
+                component = component_size_vector.size();
+                component_size_vector.emplace_back(0);
+            }
+            components_index[node] = component;
+            ++component_size_vector[component];
+        }
 
-    unsigned GetComponentID(const NodeID node) const { return components_index[node]; }
+        for (const auto component : util::irange<std::size_t>(0, component_size_vector.size()))
+        {
+            if (component_size_vector[component] > 1000)
+            {
+                util::Log(logDEBUG) << "large component [" << component
+                                    << "]=" << component_size_vector[component];
+            }
+        }
+    }
 };
 }
 }
@@ -8,6 +8,7 @@
 #include "storage/shared_memory_ownership.hpp"
 
 #include "util/guidance/turn_bearing.hpp"
+#include "util/prefetch.hpp"
 #include "util/vector_view.hpp"
 
 #include "util/typedefs.hpp"
@@ -31,6 +32,7 @@ void write(storage::io::FileWriter &writer,
            const detail::TurnDataContainerImpl<Ownership> &turn_data);
 }
 
+// The guidance data of a turn, stored together so route assembly reads one record per turn
 struct TurnData
 {
     extractor::guidance::TurnInstruction turn_instruction;
@@ -39,6 +41,7 @@ struct TurnData
     util::guidance::TurnBearing pre_turn_bearing;
     util::guidance::TurnBearing post_turn_bearing;
 };
+static_assert(sizeof(TurnData) == 8, "TurnData should be packed into 8 bytes");
 
 namespace detail
 {
@@ -49,48 +52,39 @@ template <storage::Ownership Ownership> class TurnDataContainerImpl
   public:
     TurnDataContainerImpl() = default;
 
-    TurnDataContainerImpl(Vector<extractor::guidance::TurnInstruction> turn_instructions,
-                          Vector<LaneDataID> lane_data_ids,
-                          Vector<EntryClassID> entry_class_ids,
-                          Vector<util::guidance::TurnBearing> pre_turn_bearings,
-                          Vector<util::guidance::TurnBearing> post_turn_bearings)
-        : turn_instructions(std::move(turn_instructions)), lane_data_ids(std::move(lane_data_ids)),
-          entry_class_ids(std::move(entry_class_ids)),
-          pre_turn_bearings(std::move(pre_turn_bearings)),
-          post_turn_bearings(std::move(post_turn_bearings))
-    {
-    }
+    TurnDataContainerImpl(Vector<TurnData> turns) : turns(std::move(turns)) {}
 
-    EntryClassID GetEntryClassID(const EdgeID id) const { return entry_class_ids[id]; }
+    EntryClassID GetEntryClassID(const EdgeID id) const { return turns[id].entry_class_id; }
 
     util::guidance::TurnBearing GetPreTurnBearing(const EdgeID id) const
     {
-        return pre_turn_bearings[id];
+        return turns[id].pre_turn_bearing;
     }
 
     util::guidance::TurnBearing GetPostTurnBearing(const EdgeID id) const
     {
-        return post_turn_bearings[id];
+        return turns[id].post_turn_bearing;
     }
 
-    LaneDataID GetLaneDataID(const EdgeID id) const { return lane_data_ids[id]; }
+    LaneDataID GetLaneDataID(const EdgeID id) const { return turns[id].lane_data_id; }
 
-    bool HasLaneData(const EdgeID id) const { return INVALID_LANE_DATAID != lane_data_ids[id]; }
+    bool HasLaneData(const EdgeID id) const
+    {
+        return INVALID_LANE_DATAID != turns[id].lane_data_id;
+    }
 
     extractor::guidance::TurnInstruction GetTurnInstruction(const EdgeID id) const
     {
-        return turn_instructions[id];
+        return turns[id].turn_instruction;
     }
 
+    void Prefetch(const EdgeID id) const { util::prefetch(&turns[id]); }
+
     // Used by EdgeBasedGraphFactory to fill data structure
     template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
     void push_back(const TurnData &data)
     {
-        turn_instructions.push_back(data.turn_instruction);
-        lane_data_ids.push_back(data.lane_data_id);
-        entry_class_ids.push_back(data.entry_class_id);
-        pre_turn_bearings.push_back(data.pre_turn_bearing);
-        post_turn_bearings.push_back(data.post_turn_bearing);
+        turns.push_back(data);
     }
 
     template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
@@ -106,11 +100,7 @@ template <storage::Ownership Ownership> class TurnDataContainerImpl
                                                 const TurnDataContainerImpl &turn_data_container);
 
   private:
-    Vector<extractor::guidance::TurnInstruction> turn_instructions;
-    Vector<LaneDataID> lane_data_ids;
-    Vector<EntryClassID> entry_class_ids;
-    Vector<util::guidance::TurnBearing> pre_turn_bearings;
-    Vector<util::guidance::TurnBearing> post_turn_bearings;
+    Vector<TurnData> turns;
 };
 }
 
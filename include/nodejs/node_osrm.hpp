@@ -5,11 +5,14 @@
 
 #include <nan.h>
 
+#include <cstddef>
 #include <memory>
 
 namespace node_osrm
 {
 
+class WorkerPool;
+
 struct Engine final : public Nan::ObjectWrap
 {
     using Base = Nan::ObjectWrap;
@@ -24,14 +27,19 @@ struct Engine final : public Nan::ObjectWrap
     static NAN_METHOD(tile);
     static NAN_METHOD(match);
     static NAN_METHOD(trip);
+    static NAN_METHOD(batch);
+    static NAN_METHOD(matchBatch);
 
-    Engine(osrm::EngineConfig &config);
+    Engine(osrm::EngineConfig &config, std::size_t pool_size);
 
     // Thread-safe singleton accessor
     static Nan::Persistent<v8::Function> &constructor();
 
     // Ref-counted OSRM alive even after shutdown until last callback is done
     std::shared_ptr<osrm::OSRM> this_;
+
+    // Runs the queries if the `threads` option was given, otherwise they go to libuv's pool
+    std::shared_ptr<WorkerPool> pool;
 };
 
 } // ns node_osrm
@@ -2,6 +2,8 @@
 #define OSRM_BINDINGS_NODE_SUPPORT_HPP
 
 #include "nodejs/json_v8_renderer.hpp"
+#include "util/json_binary_renderer.hpp"
+#include "util/json_renderer.hpp"
 
 #include "osrm/approach.hpp"
 #include "osrm/bearing.hpp"
@@ -14,6 +16,7 @@
 #include "osrm/route_parameters.hpp"
 #include "osrm/status.hpp"
 #include "osrm/storage_config.hpp"
+#include "osrm/table_matrices.hpp"
 #include "osrm/table_parameters.hpp"
 #include "osrm/tile_parameters.hpp"
 #include "osrm/trip_parameters.hpp"
@@ -22,6 +25,7 @@
 #include <boost/optional.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <string>
@@ -49,6 +53,11 @@ template <> v8::Local<v8::Value> inline render(const std::string &result)
     return Nan::CopyBuffer(result.data(), result.size()).ToLocalChecked();
 }
 
+template <> v8::Local<v8::Value> inline render(const std::vector<char> &result)
+{
+    return Nan::CopyBuffer(result.data(), result.size()).ToLocalChecked();
+}
+
 template <> v8::Local<v8::Value> inline render(const osrm::json::Object &result)
 {
     v8::Local<v8::Value> value;
@@ -56,6 +65,36 @@ template <> v8::Local<v8::Value> inline render(const osrm::json::Object &result)
     return value;
 }
 
+// The response object with the matrices as one Float64Array each, rows and columns give their
+// dimensions
+template <> v8::Local<v8::Value> inline render(const osrm::TableMatrices &result)
+{
+    v8::Local<v8::Value> value;
+    renderToV8(value, result.response);
+    v8::Local<v8::Object> object = Nan::To<v8::Object>(value).ToLocalChecked();
+
+    const auto make_array = [](const std::vector<double> &matrix) {
+        const auto size = matrix.size() * sizeof(double);
+        auto buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), size);
+        std::memcpy(buffer->GetContents().Data(), matrix.data(), size);
+        return v8::Float64Array::New(buffer, 0, matrix.size());
+    };
+
+    object->Set(Nan::New("rows").ToLocalChecked(),
+                Nan::New(static_cast<double>(result.number_of_sources)));
+    object->Set(Nan::New("columns").ToLocalChecked(),
+                Nan::New(static_cast<double>(result.number_of_destinations)));
+    if (!result.durations.empty())
+    {
+        object->Set(Nan::New("durations").ToLocalChecked(), make_array(result.durations));
+    }
+    if (!result.distances.empty())
+    {
+        object->Set(Nan::New("distances").ToLocalChecked(), make_array(result.distances));
+    }
+    return object;
+}
+
 inline void ParseResult(const osrm::Status &result_status, osrm::json::Object &result)
 {
     const auto code_iter = result.values.find("code");
@@ -78,6 +117,55 @@ inline void ParseResult(const osrm::Status &result_status, osrm::json::Object &r
 
 inline void ParseResult(const osrm::Status & /*result_status*/, const std::string & /*unused*/) {}
 
+inline void ParseResult(const osrm::Status &result_status, osrm::TableMatrices &result)
+{
+    ParseResult(result_status, result.response);
+}
+
+// Options of the bindings themselves, passed as optional second argument to the services
+struct PluginParameters
+{
+    // Hand back a Buffer with the rendered JSON instead of building a Javascript object
+    bool render_json_buffer = false;
+    // Hand back the table matrices as typed arrays instead of arrays of arrays
+    bool typed_arrays = false;
+};
+
+// Renders the result on the worker thread if the query asked for output_format 'binary' or
+// format 'json_buffer', the callback then only has to copy the buffer
+template <typename ParamPtr>
+inline void renderToBuffer(const ParamPtr &params,
+                           const PluginParameters &plugin_params,
+                           const osrm::json::Object &result,
+                           std::vector<char> &buffer)
+{
+    if (params->output_format == osrm::engine::api::BaseParameters::OutputFormatType::Binary)
+    {
+        osrm::util::json::renderBinary(buffer, result);
+    }
+    else if (plugin_params.render_json_buffer)
+    {
+        osrm::util::json::render(buffer, result);
+    }
+}
+
+// The typed arrays are copied in the callback
+template <typename ParamPtr>
+inline void renderToBuffer(const ParamPtr & /*unused*/,
+                           const PluginParameters & /*unused*/,
+                           const osrm::TableMatrices & /*unused*/,
+                           std::vector<char> & /*unused*/)
+{
+}
+
+// Tiles are a Buffer already
+inline void renderToBuffer(const tile_parameters_ptr & /*unused*/,
+                           const PluginParameters & /*unused*/,
+                           const std::string & /*unused*/,
+                           std::vector<char> & /*unused*/)
+{
+}
+
 inline engine_config_ptr argumentsToEngineConfig(const Nan::FunctionCallbackInfo<v8::Value> &args)
 {
     Nan::HandleScope scope;
@@ -164,15 +252,20 @@ inline engine_config_ptr argumentsToEngineConfig(const Nan::FunctionCallbackInfo
         {
             engine_config->algorithm = osrm::EngineConfig::Algorithm::MLD;
         }
+        else if (*v8::String::Utf8Value(algorithm_str) == std::string("CCH"))
+        {
+            engine_config->algorithm = osrm::EngineConfig::Algorithm::CCH;
+        }
         else
         {
-            Nan::ThrowError("algorithm option must be one of 'CH', 'CoreCH', or 'MLD'.");
+            Nan::ThrowError("algorithm option must be one of 'CH', 'CoreCH', 'MLD', or 'CCH'.");
             return engine_config_ptr();
         }
     }
     else if (!algorithm->IsUndefined())
     {
-        Nan::ThrowError("algorithm option must be a string and one of 'CH', 'CoreCH', or 'MLD'.");
+        Nan::ThrowError(
+            "algorithm option must be a string and one of 'CH', 'CoreCH', 'MLD', or 'CCH'.");
         return engine_config_ptr();
     }
 
@@ -237,6 +330,37 @@ inline engine_config_ptr argumentsToEngineConfig(const Nan::FunctionCallbackInfo
     return engine_config;
 }
 
+// Size of the thread pool of an OSRM object, 0 runs queries on libuv's thread pool
+inline bool argumentsToWorkerPoolSize(const Nan::FunctionCallbackInfo<v8::Value> &args,
+                                      std::size_t &pool_size)
+{
+    Nan::HandleScope scope;
+    pool_size = 0;
+
+    if (args.Length() != 1 || !args[0]->IsObject())
+    {
+        return true;
+    }
+
+    auto params = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+    auto threads = params->Get(Nan::New("threads").ToLocalChecked());
+    if (threads.IsEmpty())
+        return false;
+
+    if (threads->IsUndefined())
+    {
+        return true;
+    }
+    if (!threads->IsUint32())
+    {
+        Nan::ThrowError("threads must be a non-negative integral number");
+        return false;
+    }
+
+    pool_size = threads->Uint32Value();
+    return true;
+}
+
 inline boost::optional<std::vector<osrm::Coordinate>>
 parseCoordinateArray(const v8::Local<v8::Array> &coordinates_array)
 {
@@ -293,27 +417,73 @@ parseCoordinateArray(const v8::Local<v8::Array> &coordinates_array)
     return resulting_coordinates;
 }
 
+// Parses the optional plugin configuration between the query options and the callback, the
+// format 'typed' is only known to the services that pass allow_typed_arrays
+inline bool argumentsToPluginParameters(const Nan::FunctionCallbackInfo<v8::Value> &args,
+                                        PluginParameters &plugin_params,
+                                        const bool allow_typed_arrays = false)
+{
+    const auto formats =
+        allow_typed_arrays ? "[object, json_buffer, typed]" : "[object, json_buffer]";
+
+    if (args.Length() < 3 || !args[1]->IsObject())
+    {
+        return true;
+    }
+
+    v8::Local<v8::Object> obj = Nan::To<v8::Object>(args[1]).ToLocalChecked();
+    if (obj->Has(Nan::New("format").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> format = obj->Get(Nan::New("format").ToLocalChecked());
+        if (format.IsEmpty())
+            return false;
+
+        if (!format->IsString())
+        {
+            Nan::ThrowError((std::string("format must be a string: ") + formats).c_str());
+            return false;
+        }
+
+        const Nan::Utf8String format_utf8str(format);
+        std::string format_str{*format_utf8str, *format_utf8str + format_utf8str.length()};
+
+        if (format_str == "object")
+        {
+            plugin_params.render_json_buffer = false;
+        }
+        else if (format_str == "json_buffer")
+        {
+            plugin_params.render_json_buffer = true;
+        }
+        else if (allow_typed_arrays && format_str == "typed")
+        {
+            plugin_params.typed_arrays = true;
+        }
+        else
+        {
+            Nan::ThrowError((std::string("'format' param must be one of ") + formats).c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
 // Parses all the non-service specific parameters
 template <typename ParamType>
-inline bool argumentsToParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
+inline bool argumentsToParameter(const v8::Local<v8::Value> &options,
                                  ParamType &params,
                                  bool requires_multiple_coordinates)
 {
     Nan::HandleScope scope;
 
-    if (args.Length() < 2)
-    {
-        Nan::ThrowTypeError("Two arguments required");
-        return false;
-    }
-
-    if (!args[0]->IsObject())
+    if (!options->IsObject())
     {
         Nan::ThrowTypeError("First arg must be an object");
         return false;
     }
 
-    v8::Local<v8::Object> obj = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+    v8::Local<v8::Object> obj = Nan::To<v8::Object>(options).ToLocalChecked();
 
     v8::Local<v8::Value> coordinates = obj->Get(Nan::New("coordinates").ToLocalChecked());
     if (coordinates.IsEmpty())
@@ -513,8 +683,21 @@ inline bool argumentsToParameter(const Nan::FunctionCallbackInfo<v8::Value> &arg
                     return false;
                 }
 
-                params->hints.push_back(
-                    osrm::engine::Hint::FromBase64(*v8::String::Utf8Value(hint)));
+                const std::string encoded = *v8::String::Utf8Value(hint);
+                if (encoded.front() == osrm::engine::COMPACT_HINT_PREFIX)
+                {
+                    const auto decoded = osrm::engine::Hint::FromCompactBase64(encoded);
+                    if (!decoded)
+                    {
+                        Nan::ThrowError("Hint is not a valid compact hint");
+                        return false;
+                    }
+                    params->hints.push_back(*decoded);
+                }
+                else
+                {
+                    params->hints.push_back(osrm::engine::Hint::FromBase64(encoded));
+                }
             }
             else if (hint->IsNull())
             {
@@ -585,6 +768,52 @@ inline bool argumentsToParameter(const Nan::FunctionCallbackInfo<v8::Value> &arg
         params->generate_hints = generate_hints->BooleanValue();
     }
 
+    if (obj->Has(Nan::New("compact_hints").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> compact_hints = obj->Get(Nan::New("compact_hints").ToLocalChecked());
+        if (compact_hints.IsEmpty())
+            return false;
+
+        if (!compact_hints->IsBoolean())
+        {
+            Nan::ThrowError("compact_hints must be of type Boolean");
+            return false;
+        }
+
+        params->compact_hints = compact_hints->BooleanValue();
+    }
+
+    if (obj->Has(Nan::New("output_format").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> output_format = obj->Get(Nan::New("output_format").ToLocalChecked());
+        if (output_format.IsEmpty())
+            return false;
+
+        if (!output_format->IsString())
+        {
+            Nan::ThrowError("output_format must be a string: [json, binary]");
+            return false;
+        }
+
+        const Nan::Utf8String output_format_utf8str(output_format);
+        std::string output_format_str{*output_format_utf8str,
+                                      *output_format_utf8str + output_format_utf8str.length()};
+
+        if (output_format_str == "json")
+        {
+            params->output_format = osrm::engine::api::BaseParameters::OutputFormatType::JSON;
+        }
+        else if (output_format_str == "binary")
+        {
+            params->output_format = osrm::engine::api::BaseParameters::OutputFormatType::Binary;
+        }
+        else
+        {
+            Nan::ThrowError("'output_format' param must be one of [json, binary]");
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -743,15 +972,15 @@ inline bool parseCommonParameters(const v8::Local<v8::Object> &obj, ParamType &p
 }
 
 inline route_parameters_ptr
-argumentsToRouteParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
+argumentsToRouteParameter(const v8::Local<v8::Value> &options,
                           bool requires_multiple_coordinates)
 {
     route_parameters_ptr params = std::make_unique<osrm::RouteParameters>();
-    bool has_base_params = argumentsToParameter(args, params, requires_multiple_coordinates);
+    bool has_base_params = argumentsToParameter(options, params, requires_multiple_coordinates);
     if (!has_base_params)
         return route_parameters_ptr();
 
-    v8::Local<v8::Object> obj = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+    v8::Local<v8::Object> obj = Nan::To<v8::Object>(options).ToLocalChecked();
 
     if (obj->Has(Nan::New("continue_straight").ToLocalChecked()))
     {
@@ -803,23 +1032,17 @@ argumentsToRouteParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
 }
 
 inline tile_parameters_ptr
-argumentsToTileParameters(const Nan::FunctionCallbackInfo<v8::Value> &args, bool /*unused*/)
+argumentsToTileParameters(const v8::Local<v8::Value> &options, bool /*unused*/)
 {
     tile_parameters_ptr params = std::make_unique<osrm::TileParameters>();
 
-    if (args.Length() < 2)
-    {
-        Nan::ThrowTypeError("Coordinate object and callback required");
-        return tile_parameters_ptr();
-    }
-
-    if (!args[0]->IsArray())
+    if (!options->IsArray())
     {
         Nan::ThrowTypeError("Parameter must be an array [x, y, z]");
         return tile_parameters_ptr();
     }
 
-    v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(args[0]);
+    v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(options);
 
     if (array->Length() != 3)
     {
@@ -863,15 +1086,15 @@ argumentsToTileParameters(const Nan::FunctionCallbackInfo<v8::Value> &args, bool
 }
 
 inline nearest_parameters_ptr
-argumentsToNearestParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
+argumentsToNearestParameter(const v8::Local<v8::Value> &options,
                             bool requires_multiple_coordinates)
 {
     nearest_parameters_ptr params = std::make_unique<osrm::NearestParameters>();
-    bool has_base_params = argumentsToParameter(args, params, requires_multiple_coordinates);
+    bool has_base_params = argumentsToParameter(options, params, requires_multiple_coordinates);
     if (!has_base_params)
         return nearest_parameters_ptr();
 
-    v8::Local<v8::Object> obj = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+    v8::Local<v8::Object> obj = Nan::To<v8::Object>(options).ToLocalChecked();
     if (obj.IsEmpty())
         return nearest_parameters_ptr();
 
@@ -902,15 +1125,15 @@ argumentsToNearestParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
 }
 
 inline table_parameters_ptr
-argumentsToTableParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
+argumentsToTableParameter(const v8::Local<v8::Value> &options,
                           bool requires_multiple_coordinates)
 {
     table_parameters_ptr params = std::make_unique<osrm::TableParameters>();
-    bool has_base_params = argumentsToParameter(args, params, requires_multiple_coordinates);
+    bool has_base_params = argumentsToParameter(options, params, requires_multiple_coordinates);
     if (!has_base_params)
         return table_parameters_ptr();
 
-    v8::Local<v8::Object> obj = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+    v8::Local<v8::Object> obj = Nan::To<v8::Object>(options).ToLocalChecked();
     if (obj.IsEmpty())
         return table_parameters_ptr();
 
@@ -992,19 +1215,100 @@ argumentsToTableParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
         }
     }
 
+    if (obj->Has(Nan::New("annotations").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> annotations = obj->Get(Nan::New("annotations").ToLocalChecked());
+        if (annotations.IsEmpty())
+            return table_parameters_ptr();
+
+        if (!annotations->IsArray())
+        {
+            Nan::ThrowError("Annotations must be an array containing 'duration' and/or 'distance'");
+            return table_parameters_ptr();
+        }
+
+        params->annotations = osrm::TableParameters::AnnotationsType::None;
+
+        v8::Local<v8::Array> annotations_array = v8::Local<v8::Array>::Cast(annotations);
+        for (std::size_t i = 0; i < annotations_array->Length(); ++i)
+        {
+            const Nan::Utf8String annotations_utf8str(annotations_array->Get(i));
+            std::string annotations_str{*annotations_utf8str,
+                                        *annotations_utf8str + annotations_utf8str.length()};
+
+            if (annotations_str == "duration")
+            {
+                params->annotations =
+                    params->annotations | osrm::TableParameters::AnnotationsType::Duration;
+            }
+            else if (annotations_str == "distance")
+            {
+                params->annotations =
+                    params->annotations | osrm::TableParameters::AnnotationsType::Distance;
+            }
+            else
+            {
+                Nan::ThrowError("this 'annotations' param is not supported");
+                return table_parameters_ptr();
+            }
+        }
+    }
+
+    if (obj->Has(Nan::New("paths").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> paths = obj->Get(Nan::New("paths").ToLocalChecked());
+        if (paths.IsEmpty())
+            return table_parameters_ptr();
+
+        if (!paths->IsArray())
+        {
+            Nan::ThrowError("Paths must be an array of [source, destination] pairs");
+            return table_parameters_ptr();
+        }
+
+        v8::Local<v8::Array> paths_array = v8::Local<v8::Array>::Cast(paths);
+        for (uint32_t i = 0; i < paths_array->Length(); ++i)
+        {
+            v8::Local<v8::Value> path = paths_array->Get(i);
+            if (path.IsEmpty())
+                return table_parameters_ptr();
+
+            if (!path->IsArray() || v8::Local<v8::Array>::Cast(path)->Length() != 2)
+            {
+                Nan::ThrowError("Path must be an array of [source, destination]");
+                return table_parameters_ptr();
+            }
+
+            v8::Local<v8::Array> path_array = v8::Local<v8::Array>::Cast(path);
+            v8::Local<v8::Value> source = path_array->Get(0);
+            v8::Local<v8::Value> destination = path_array->Get(1);
+            if (source.IsEmpty() || destination.IsEmpty())
+                return table_parameters_ptr();
+
+            if (!source->IsUint32() || !destination->IsUint32())
+            {
+                Nan::ThrowError("Path source and destination must be integers");
+                return table_parameters_ptr();
+            }
+
+            params->paths.emplace_back(static_cast<size_t>(source->NumberValue()),
+                                       static_cast<size_t>(destination->NumberValue()));
+        }
+    }
+
     return params;
 }
 
 inline trip_parameters_ptr
-argumentsToTripParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
+argumentsToTripParameter(const v8::Local<v8::Value> &options,
                          bool requires_multiple_coordinates)
 {
     trip_parameters_ptr params = std::make_unique<osrm::TripParameters>();
-    bool has_base_params = argumentsToParameter(args, params, requires_multiple_coordinates);
+    bool has_base_params = argumentsToParameter(options, params, requires_multiple_coordinates);
     if (!has_base_params)
         return trip_parameters_ptr();
 
-    v8::Local<v8::Object> obj = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+    v8::Local<v8::Object> obj = Nan::To<v8::Object>(options).ToLocalChecked();
 
     bool parsedSuccessfully = parseCommonParameters(obj, params);
     if (!parsedSuccessfully)
@@ -1091,15 +1395,15 @@ argumentsToTripParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
 }
 
 inline match_parameters_ptr
-argumentsToMatchParameter(const Nan::FunctionCallbackInfo<v8::Value> &args,
+argumentsToMatchParameter(const v8::Local<v8::Value> &options,
                           bool requires_multiple_coordinates)
 {
     match_parameters_ptr params = std::make_unique<osrm::MatchParameters>();
-    bool has_base_params = argumentsToParameter(args, params, requires_multiple_coordinates);
+    bool has_base_params = argumentsToParameter(options, params, requires_multiple_coordinates);
     if (!has_base_params)
         return match_parameters_ptr();
 
-    v8::Local<v8::Object> obj = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+    v8::Local<v8::Object> obj = Nan::To<v8::Object>(options).ToLocalChecked();
 
     if (obj->Has(Nan::New("timestamps").ToLocalChecked()))
     {
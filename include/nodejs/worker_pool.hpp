@@ -0,0 +1,149 @@
+#ifndef OSRM_BINDINGS_NODE_WORKER_POOL_HPP
+#define OSRM_BINDINGS_NODE_WORKER_POOL_HPP
+
+#include <nan.h>
+#include <uv.h>
+
+#include <boost/assert.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace node_osrm
+{
+
+// Runs Nan::AsyncWorkers on threads of its own instead of on libuv's thread pool, which node
+// shares with file system and DNS work. Execute() runs on one of the pool threads, completed
+// workers are posted back to the event loop through an uv_async_t handle and get their
+// callbacks called there.
+//
+// Queue() has to be called from the event loop thread. While work is in flight the pool keeps
+// itself and the event loop alive, an idle pool does not keep node from exiting.
+class WorkerPool final : public std::enable_shared_from_this<WorkerPool>
+{
+  public:
+    explicit WorkerPool(const std::size_t num_threads) : async(new uv_async_t)
+    {
+        BOOST_ASSERT(num_threads > 0);
+        uv_async_init(uv_default_loop(), async, &WorkerPool::OnCompleted);
+        async->data = this;
+        uv_unref(reinterpret_cast<uv_handle_t *>(async));
+
+        threads.reserve(num_threads);
+        for (std::size_t index = 0; index < num_threads; ++index)
+        {
+            threads.emplace_back([this] { Run(); });
+        }
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    ~WorkerPool()
+    {
+        BOOST_ASSERT(in_flight == 0);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued_condition.notify_all();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        // libuv still references the handle until the close callback ran
+        uv_close(reinterpret_cast<uv_handle_t *>(async),
+                 [](uv_handle_t *handle) { delete reinterpret_cast<uv_async_t *>(handle); });
+    }
+
+    void Queue(Nan::AsyncWorker *worker)
+    {
+        if (in_flight++ == 0)
+        {
+            uv_ref(reinterpret_cast<uv_handle_t *>(async));
+            keep_alive = shared_from_this();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued.push_back(worker);
+        }
+        queued_condition.notify_one();
+    }
+
+  private:
+    void Run()
+    {
+        while (true)
+        {
+            Nan::AsyncWorker *worker;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queued_condition.wait(lock, [this] { return stopping || !queued.empty(); });
+                if (queued.empty())
+                {
+                    return;
+                }
+                worker = queued.front();
+                queued.pop_front();
+            }
+
+            worker->Execute();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                completed.push_back(worker);
+            }
+            // libuv coalesces sends, OnCompleted picks up everything completed so far
+            uv_async_send(async);
+        }
+    }
+
+    static void OnCompleted(uv_async_t *handle)
+    {
+        auto *pool = static_cast<WorkerPool *>(handle->data);
+
+        std::vector<Nan::AsyncWorker *> done;
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            done.swap(pool->completed);
+        }
+
+        for (auto *worker : done)
+        {
+            worker->WorkComplete();
+            worker->Destroy();
+        }
+
+        BOOST_ASSERT(pool->in_flight >= done.size());
+        pool->in_flight -= done.size();
+        if (pool->in_flight == 0 && !done.empty())
+        {
+            uv_unref(reinterpret_cast<uv_handle_t *>(handle));
+            // drops what may be the last reference, the pool must not be touched afterwards
+            const auto last_reference = std::move(pool->keep_alive);
+        }
+    }
+
+    uv_async_t *const async;
+    std::vector<std::thread> threads;
+
+    // only touched from the event loop thread
+    std::size_t in_flight = 0;
+    std::shared_ptr<WorkerPool> keep_alive;
+
+    std::mutex mutex;
+    std::condition_variable queued_condition;
+    std::deque<Nan::AsyncWorker *> queued;
+    std::vector<Nan::AsyncWorker *> completed;
+    bool stopping = false;
+};
+}
+
+#endif
@@ -31,19 +31,26 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "osrm/osrm_fwd.hpp"
 #include "osrm/status.hpp"
 
+#include <exception>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
 namespace json = util::json;
 using engine::EngineConfig;
+using engine::EngineStatistics;
 using engine::api::RouteParameters;
 using engine::api::TableParameters;
+using engine::api::TableMatrices;
+using engine::api::TableWriter;
 using engine::api::NearestParameters;
 using engine::api::TripParameters;
 using engine::api::MatchParameters;
 using engine::api::TileParameters;
+using engine::api::IsochroneParameters;
 
 /**
  * Represents a Open Source Routing Machine with access to its services.
@@ -56,8 +63,12 @@ using engine::api::TileParameters;
  *  - Trip: shortest round trip between coordinates
  *  - Match: snaps noisy coordinate traces to the road network
  *  - Tile: vector tiles with internal graph representation
+ *  - Isochrone: what can be reached from a coordinate within given durations
  *
  *  All services take service-specific parameters, fill a JSON object, and return a status code.
+ *
+ *  The asynchronous variants of the services return right away and run the query on an executor
+ *  of EngineConfig::async_threads threads, which calls the callback with the outcome.
  */
 class OSRM final
 {
@@ -76,6 +87,15 @@ class OSRM final
     OSRM(OSRM &&) noexcept;
     OSRM &operator=(OSRM &&) noexcept;
 
+    /**
+     * Completion callback of the asynchronous services, called on a thread of the executor.
+     *
+     * If the query threw, error holds the exception and status and result are to be ignored.
+     * The callback must not throw and must not destroy the OSRM instance it was passed to.
+     */
+    template <typename ResultT>
+    using Callback = std::function<void(std::exception_ptr error, Status status, ResultT result)>;
+
     /**
      * Shortest path queries for coordinates.
      *
@@ -94,6 +114,43 @@ class OSRM final
      */
     Status Table(const TableParameters &parameters, json::Object &result) const;
 
+    /**
+     * Distance tables for coordinates, rendered as JSON right into the buffer.
+     *
+     * Skips building the json::Object representation of the matrix, which takes far more memory
+     * than the rendered response for large tables. Errors are rendered as well.
+     *
+     * \param parameters table query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status and TableParameters
+     */
+    Status Table(const TableParameters &parameters, std::vector<char> &result) const;
+
+    /**
+     * Distance tables for coordinates, with the matrices as flat arrays of numbers.
+     *
+     * Fills the matrices right from the search result, only the waypoints and paths are built as
+     * JSON. Errors are reported in the response of the result.
+     *
+     * \param parameters table query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, TableParameters and TableMatrices
+     */
+    Status Table(const TableParameters &parameters, TableMatrices &result) const;
+
+    /**
+     * Distance tables for coordinates, rendered as JSON in pieces while they are searched.
+     *
+     * The sources are searched result.rows_per_chunk at a time and every chunk of rows is handed
+     * to result.write, so the response can be sent before the whole matrix is known. Errors are
+     * rendered into result.error.
+     *
+     * \param parameters table query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, TableParameters and TableWriter
+     */
+    Status Table(const TableParameters &parameters, TableWriter &result) const;
+
     /**
      * Nearest street segment for coordinate.
      *
@@ -121,6 +178,18 @@ class OSRM final
      */
     Status Match(const MatchParameters &parameters, json::Object &result) const;
 
+    /**
+     * MatchBatch: matches many traces on their own, spread over all cores
+     *
+     * \param parameters the match query of every trace
+     * \param results the response of every trace in the order of the traces, traces that failed
+     *        have the error code and message in their response
+     * \return Status::Ok if every trace matched, Status::Error otherwise
+     * \see Status, MatchParameters and json::Object
+     */
+    Status MatchBatch(const std::vector<MatchParameters> &parameters,
+                      std::vector<json::Object> &results) const;
+
     /**
      * Tile: vector tiles with internal graph representation
      *
@@ -130,8 +199,53 @@ class OSRM final
      */
     Status Tile(const TileParameters &parameters, std::string &result) const;
 
+    /**
+     * Isochrone: the areas or road segments reachable from a coordinate within the contours
+     *
+     * \param parameters isochrone query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, IsochroneParameters and json::Object
+     */
+    Status Isochrone(const IsochroneParameters &parameters, json::Object &result) const;
+
+    /**
+     * Isochrone: the contours as a vector tile of the parameters' tile, errors are rendered as
+     * JSON into the buffer.
+     *
+     * \param parameters isochrone query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status and IsochroneParameters
+     */
+    Status Isochrone(const IsochroneParameters &parameters, std::string &result) const;
+
+    /**
+     * Statistics of the caches kept between queries, safe to call while queries run.
+     *
+     * \return hits, misses and sizes of the caches
+     * \see EngineStatistics
+     */
+    EngineStatistics GetStatistics() const;
+
+    /**
+     * Asynchronous variants of the services above, the parameters are copied for the query.
+     *
+     * Return right away, the callback gets the status and result of the query once it ran on
+     * the executor. Destroying the OSRM instance waits for the queries in flight.
+     *
+     * \see Callback
+     */
+    void RouteAsync(RouteParameters parameters, Callback<json::Object> callback) const;
+    void TableAsync(TableParameters parameters, Callback<json::Object> callback) const;
+    void NearestAsync(NearestParameters parameters, Callback<json::Object> callback) const;
+    void TripAsync(TripParameters parameters, Callback<json::Object> callback) const;
+    void MatchAsync(MatchParameters parameters, Callback<json::Object> callback) const;
+    void TileAsync(TileParameters parameters, Callback<std::string> callback) const;
+    void IsochroneAsync(IsochroneParameters parameters, Callback<json::Object> callback) const;
+
   private:
     std::unique_ptr<engine::EngineInterface> engine_;
+    // destroyed first, so queries in flight finish before the engine goes away
+    std::unique_ptr<engine::AsyncExecutor> executor_;
 };
 }
 
@@ -48,14 +48,19 @@ namespace api
 {
 struct RouteParameters;
 struct TableParameters;
+struct TableMatrices;
+struct TableWriter;
 struct NearestParameters;
 struct TripParameters;
 struct MatchParameters;
 struct TileParameters;
+struct IsochroneParameters;
 } // ns api
 
 class EngineInterface;
+class AsyncExecutor;
 struct EngineConfig;
+struct EngineStatistics;
 } // ns engine
 } // ns osrm
 
@@ -0,0 +1,126 @@
+#ifndef OSRM_PARTITION_CELL_QUANTIZATION_HPP
+#define OSRM_PARTITION_CELL_QUANTIZATION_HPP
+
+#include "util/typedefs.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace partition
+{
+namespace quantization
+{
+
+// A quantized value is the base of its row plus a 16 bit code. Unreachable entries and values
+// that are too far above the base get codes of their own, the exact values of the latter are
+// kept in a side table in the order of their columns.
+using Code = std::uint16_t;
+using ExceptionOffset = std::uint32_t;
+
+constexpr Code INVALID_CODE = std::numeric_limits<Code>::max();
+constexpr Code EXCEPTION_CODE = INVALID_CODE - 1;
+constexpr Code MAX_OFFSET_CODE = EXCEPTION_CODE - 1;
+
+// The bases of the weights and durations of a row and the start of their exceptions
+struct QuantizedRow
+{
+    EdgeWeight weight_base;
+    EdgeDuration duration_base;
+    ExceptionOffset weight_exception_offset;
+    ExceptionOffset duration_exception_offset;
+};
+
+// Encodes a row of values into codes, the base is the smallest valid value of the row. Exceptions
+// are appended to exceptions, returns the base.
+template <typename ValueT>
+ValueT encodeRow(const ValueT *values,
+                 const std::size_t size,
+                 const ValueT invalid,
+                 Code *codes,
+                 std::vector<ValueT> &exceptions)
+{
+    ValueT base = invalid;
+    for (std::size_t column = 0; column < size; ++column)
+    {
+        if (values[column] != invalid)
+        {
+            base = std::min(base, values[column]);
+        }
+    }
+
+    for (std::size_t column = 0; column < size; ++column)
+    {
+        const auto value = values[column];
+        if (value == invalid)
+        {
+            codes[column] = INVALID_CODE;
+        }
+        else if (static_cast<std::int64_t>(value) - base <= MAX_OFFSET_CODE)
+        {
+            codes[column] = static_cast<Code>(value - base);
+        }
+        else
+        {
+            codes[column] = EXCEPTION_CODE;
+            exceptions.push_back(value);
+        }
+    }
+    return base;
+}
+
+// Decodes the value in column of a row, exceptions points to the first exception of the row
+template <typename ValueT>
+inline ValueT decodeValue(const Code *codes,
+                          const std::size_t column,
+                          const ValueT base,
+                          const ValueT *exceptions,
+                          const ValueT invalid)
+{
+    const auto code = codes[column];
+    if (code <= MAX_OFFSET_CODE)
+    {
+        return base + code;
+    }
+    if (code == INVALID_CODE)
+    {
+        return invalid;
+    }
+    // overflows are rare, they are only counted if there are any
+    return exceptions[std::count(codes, codes + column, EXCEPTION_CODE)];
+}
+
+template <typename ValueT>
+inline void decodeRow(const Code *codes,
+                      const std::size_t size,
+                      const ValueT base,
+                      const ValueT *exceptions,
+                      const ValueT invalid,
+                      ValueT *values)
+{
+    for (std::size_t column = 0; column < size; ++column)
+    {
+        const auto code = codes[column];
+        if (code <= MAX_OFFSET_CODE)
+        {
+            values[column] = base + code;
+        }
+        else if (code == INVALID_CODE)
+        {
+            values[column] = invalid;
+        }
+        else
+        {
+            values[column] = *exceptions++;
+        }
+    }
+}
+}
+}
+}
+
+#endif
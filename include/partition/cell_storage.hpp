@@ -1,10 +1,10 @@
 #ifndef OSRM_CUSTOMIZE_CELL_STORAGE_HPP
 #define OSRM_CUSTOMIZE_CELL_STORAGE_HPP
 
+#include "partition/cell_quantization.hpp"
 #include "partition/multi_level_partition.hpp"
 
 #include "util/assert.hpp"
-#include "util/for_each_range.hpp"
 #include "util/log.hpp"
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
@@ -14,10 +14,12 @@
 
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/range/iterator_range.hpp>
-#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 #include <algorithm>
 #include <numeric>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -37,6 +39,9 @@ namespace serialization
 template <storage::Ownership Ownership>
 inline void read(storage::io::FileReader &reader, detail::CellStorageImpl<Ownership> &storage);
 template <storage::Ownership Ownership>
+inline void readMetric(storage::io::FileReader &reader,
+                       detail::CellStorageImpl<Ownership> &storage);
+template <storage::Ownership Ownership>
 inline void write(storage::io::FileWriter &writer,
                   const detail::CellStorageImpl<Ownership> &storage);
 }
@@ -47,6 +52,7 @@ template <storage::Ownership Ownership> class CellStorageImpl
 {
   public:
     using ValueOffset = std::uint32_t;
+    using RowOffset = std::uint32_t;
     using BoundaryOffset = std::uint32_t;
     using BoundarySize = std::uint32_t;
     using SourceIndex = std::uint32_t;
@@ -54,6 +60,11 @@ template <storage::Ownership Ownership> class CellStorageImpl
 
     static constexpr auto INVALID_VALUE_OFFSET = std::numeric_limits<ValueOffset>::max();
     static constexpr auto INVALID_BOUNDARY_OFFSET = std::numeric_limits<BoundaryOffset>::max();
+    static constexpr auto INVALID_ROW_OFFSET = std::numeric_limits<RowOffset>::max();
+    // Quantize encodes the cells of this level and above
+    static constexpr LevelID MIN_QUANTIZED_LEVEL = 2;
+
+    using QuantizedRow = quantization::QuantizedRow;
 
     struct CellData
     {
@@ -62,35 +73,55 @@ template <storage::Ownership Ownership> class CellStorageImpl
         BoundaryOffset destination_boundary_offset = INVALID_BOUNDARY_OFFSET;
         BoundarySize num_source_nodes = 0;
         BoundarySize num_destination_nodes = 0;
+        // index of the first source row of the cell among the rows of all cells
+        RowOffset row_offset = INVALID_ROW_OFFSET;
+    };
+
+    // The codes, rows and exceptions of a quantized cell, all nullptr for cells that store their
+    // values as they are
+    struct QuantizedValues
+    {
+        const quantization::Code *weight_codes = nullptr;
+        const quantization::Code *duration_codes = nullptr;
+        const QuantizedRow *rows = nullptr;
+        // the weight and duration exceptions of all rows
+        const EdgeWeight *exceptions = nullptr;
     };
+    static_assert(std::is_same<EdgeWeight, EdgeDuration>::value,
+                  "weights and durations share the exceptions of quantized rows");
 
   private:
     template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
 
     // Implementation of the cell view. We need a template parameter here
     // because we need to derive a read-only and read-write view from this.
-    template <typename WeightValueT, typename DurationValueT> class CellImpl
+    template <typename WeightValueT, typename DurationValueT, typename DistanceValueT>
+    class CellImpl
     {
       private:
         using WeightPtrT = WeightValueT *;
         using DurationPtrT = DurationValueT *;
+        using DistancePtrT = DistanceValueT *;
         BoundarySize num_source_nodes;
         BoundarySize num_destination_nodes;
 
         WeightPtrT const weights;
         DurationPtrT const durations;
+        DistancePtrT const distances;
         const NodeID *const source_boundary;
         const NodeID *const destination_boundary;
+        const QuantizedValues quantized;
 
         using RowIterator = WeightPtrT;
         // Possibly replace with
         // http://www.boost.org/doc/libs/1_55_0/libs/range/doc/html/range/reference/adaptors/reference/strided.html
-        class ColumnIterator : public boost::iterator_facade<ColumnIterator,
-                                                             WeightValueT,
+        template <typename ValueT>
+        class ColumnIterator : public boost::iterator_facade<ColumnIterator<ValueT>,
+                                                             ValueT,
                                                              boost::random_access_traversal_tag>
         {
-            typedef boost::iterator_facade<ColumnIterator,
-                                           WeightValueT,
+            typedef boost::iterator_facade<ColumnIterator<ValueT>,
+                                           ValueT,
                                            boost::random_access_traversal_tag>
                 base_t;
 
@@ -102,7 +133,7 @@ template <storage::Ownership Ownership> class CellStorageImpl
 
             explicit ColumnIterator() : current(nullptr), stride(1) {}
 
-            explicit ColumnIterator(WeightPtrT begin, std::size_t row_length)
+            explicit ColumnIterator(ValueT *begin, std::size_t row_length)
                 : current(begin), stride(row_length)
             {
                 BOOST_ASSERT(begin != nullptr);
@@ -120,7 +151,7 @@ template <storage::Ownership Ownership> class CellStorageImpl
             }
 
             friend class ::boost::iterator_core_access;
-            WeightPtrT current;
+            ValueT *current;
             const std::size_t stride;
         };
 
@@ -138,26 +169,144 @@ template <storage::Ownership Ownership> class CellStorageImpl
 
         template <typename ValuePtr> auto GetInRange(const ValuePtr ptr, const NodeID node) const
         {
+            using Iterator = ColumnIterator<std::remove_pointer_t<ValuePtr>>;
             auto iter =
                 std::find(destination_boundary, destination_boundary + num_destination_nodes, node);
             if (iter == destination_boundary + num_destination_nodes)
-                return boost::make_iterator_range(ColumnIterator{}, ColumnIterator{});
+                return boost::make_iterator_range(Iterator{}, Iterator{});
 
             auto column = std::distance(destination_boundary, iter);
-            auto begin = ColumnIterator{ptr + column, num_destination_nodes};
-            auto end = ColumnIterator{ptr + column + num_source_nodes * num_destination_nodes,
-                                      num_destination_nodes};
+            auto begin = Iterator{ptr + column, num_destination_nodes};
+            auto end = Iterator{ptr + column + num_source_nodes * num_destination_nodes,
+                                num_destination_nodes};
             return boost::make_iterator_range(begin, end);
         }
 
+        // Rows and columns of quantized cells are decoded into a buffer of the thread, one for
+        // each kind of range so a weight and a duration range can be used side by side
+        enum DecodeBuffer
+        {
+            OUT_WEIGHT_BUFFER,
+            IN_WEIGHT_BUFFER,
+            OUT_DURATION_BUFFER,
+            IN_DURATION_BUFFER
+        };
+
+        template <DecodeBuffer BUFFER> static EdgeWeight *GetDecodeBuffer(const std::size_t size)
+        {
+            static thread_local std::vector<EdgeWeight> buffer;
+            if (buffer.size() < size)
+                buffer.resize(size);
+            return buffer.data();
+        }
+
+        template <DecodeBuffer BUFFER, typename ValuePtr, typename ValueT>
+        auto DecodeOutRange(const quantization::Code *codes,
+                            ValueT QuantizedRow::*base,
+                            quantization::ExceptionOffset QuantizedRow::*exception_offset,
+                            const ValueT invalid,
+                            const NodeID node) const
+        {
+            auto iter = std::find(source_boundary, source_boundary + num_source_nodes, node);
+            if (iter == source_boundary + num_source_nodes || num_destination_nodes == 0)
+                return boost::make_iterator_range(ValuePtr{}, ValuePtr{});
+
+            const auto row = std::distance(source_boundary, iter);
+            const auto &row_data = quantized.rows[row];
+            auto values = GetDecodeBuffer<BUFFER>(num_destination_nodes);
+            quantization::decodeRow(codes + num_destination_nodes * row,
+                                    num_destination_nodes,
+                                    row_data.*base,
+                                    quantized.exceptions + row_data.*exception_offset,
+                                    invalid,
+                                    values);
+            return boost::make_iterator_range(ValuePtr{values},
+                                              ValuePtr{values + num_destination_nodes});
+        }
+
+        template <DecodeBuffer BUFFER, typename ValuePtr, typename ValueT>
+        auto DecodeInRange(const quantization::Code *codes,
+                           ValueT QuantizedRow::*base,
+                           quantization::ExceptionOffset QuantizedRow::*exception_offset,
+                           const ValueT invalid,
+                           const NodeID node) const
+        {
+            using Iterator = ColumnIterator<std::remove_pointer_t<ValuePtr>>;
+            auto iter =
+                std::find(destination_boundary, destination_boundary + num_destination_nodes, node);
+            if (iter == destination_boundary + num_destination_nodes || num_source_nodes == 0)
+                return boost::make_iterator_range(Iterator{}, Iterator{});
+
+            const auto column = std::distance(destination_boundary, iter);
+            auto values = GetDecodeBuffer<BUFFER>(num_source_nodes);
+            for (std::size_t row = 0; row < num_source_nodes; ++row)
+            {
+                const auto &row_data = quantized.rows[row];
+                values[row] =
+                    quantization::decodeValue(codes + num_destination_nodes * row,
+                                              column,
+                                              row_data.*base,
+                                              quantized.exceptions + row_data.*exception_offset,
+                                              invalid);
+            }
+            return boost::make_iterator_range(Iterator{values, 1},
+                                              Iterator{values + num_source_nodes, 1});
+        }
+
       public:
-        auto GetOutWeight(NodeID node) const { return GetOutRange(weights, node); }
+        // The ranges of quantized cells stay valid until the same getter is called again on
+        // this thread
+        auto GetOutWeight(NodeID node) const
+        {
+            if (quantized.weight_codes == nullptr)
+                return GetOutRange(weights, node);
+            return DecodeOutRange<OUT_WEIGHT_BUFFER, WeightPtrT>(
+                quantized.weight_codes,
+                &QuantizedRow::weight_base,
+                &QuantizedRow::weight_exception_offset,
+                INVALID_EDGE_WEIGHT,
+                node);
+        }
 
-        auto GetInWeight(NodeID node) const { return GetInRange(weights, node); }
+        auto GetInWeight(NodeID node) const
+        {
+            if (quantized.weight_codes == nullptr)
+                return GetInRange(weights, node);
+            return DecodeInRange<IN_WEIGHT_BUFFER, WeightPtrT>(
+                quantized.weight_codes,
+                &QuantizedRow::weight_base,
+                &QuantizedRow::weight_exception_offset,
+                INVALID_EDGE_WEIGHT,
+                node);
+        }
 
-        auto GetOutDuration(NodeID node) const { return GetOutRange(durations, node); }
+        auto GetOutDuration(NodeID node) const
+        {
+            if (quantized.duration_codes == nullptr)
+                return GetOutRange(durations, node);
+            return DecodeOutRange<OUT_DURATION_BUFFER, DurationPtrT>(
+                quantized.duration_codes,
+                &QuantizedRow::duration_base,
+                &QuantizedRow::duration_exception_offset,
+                MAXIMAL_EDGE_DURATION,
+                node);
+        }
 
-        auto GetInDuration(NodeID node) const { return GetInRange(durations, node); }
+        auto GetInDuration(NodeID node) const
+        {
+            if (quantized.duration_codes == nullptr)
+                return GetInRange(durations, node);
+            return DecodeInRange<IN_DURATION_BUFFER, DurationPtrT>(
+                quantized.duration_codes,
+                &QuantizedRow::duration_base,
+                &QuantizedRow::duration_exception_offset,
+                MAXIMAL_EDGE_DURATION,
+                node);
+        }
+
+        auto GetOutDistance(NodeID node) const { return GetOutRange(distances, node); }
+
+        auto GetInDistance(NodeID node) const { return GetInRange(distances, node); }
 
         auto GetSourceNodes() const
         {
@@ -173,17 +322,22 @@ template <storage::Ownership Ownership> class CellStorageImpl
         CellImpl(const CellData &data,
                  WeightPtrT const all_weights,
                  DurationPtrT const all_durations,
+                 DistancePtrT const all_distances,
                  const NodeID *const all_sources,
-                 const NodeID *const all_destinations)
+                 const NodeID *const all_destinations,
+                 const QuantizedValues &quantized = {})
             : num_source_nodes{data.num_source_nodes},
               num_destination_nodes{data.num_destination_nodes},
-              weights{all_weights + data.value_offset},
-              durations{all_durations + data.value_offset},
+              weights{quantized.weight_codes ? nullptr : all_weights + data.value_offset},
+              durations{quantized.duration_codes ? nullptr : all_durations + data.value_offset},
+              distances{all_distances + data.value_offset},
               source_boundary{all_sources + data.source_boundary_offset},
-              destination_boundary{all_destinations + data.destination_boundary_offset}
+              destination_boundary{all_destinations + data.destination_boundary_offset},
+              quantized(quantized)
         {
-            BOOST_ASSERT(all_weights != nullptr);
-            BOOST_ASSERT(all_durations != nullptr);
+            BOOST_ASSERT(quantized.weight_codes != nullptr || all_weights != nullptr);
+            BOOST_ASSERT(quantized.duration_codes != nullptr || all_durations != nullptr);
+            BOOST_ASSERT(all_distances != nullptr);
             BOOST_ASSERT(num_source_nodes == 0 || all_sources != nullptr);
             BOOST_ASSERT(num_destination_nodes == 0 || all_destinations != nullptr);
         }
@@ -191,9 +345,76 @@ template <storage::Ownership Ownership> class CellStorageImpl
 
     std::size_t LevelIDToIndex(LevelID level) const { return level - 1; }
 
+    // Values of one metric including the unused last entry, cells are laid out in order
+    std::size_t GetDistanceMetricSize() const
+    {
+        if (cells.empty())
+        {
+            return 1;
+        }
+        const auto &last = cells.back();
+        return last.value_offset + last.num_source_nodes * last.num_destination_nodes + 1;
+    }
+
+    // The first cell on MIN_QUANTIZED_LEVEL, cells.size() if there is none
+    std::size_t GetFirstQuantizedCell() const
+    {
+        const auto level_index = LevelIDToIndex(MIN_QUANTIZED_LEVEL);
+        return level_index + 1 < level_to_cell_offset.size() ? level_to_cell_offset[level_index]
+                                                             : cells.size();
+    }
+
+    bool IsQuantized() const { return !weight_codes.empty(); }
+
+    // Weights and durations of one metric, only the ones of the unquantized cells if quantized
+    std::size_t GetMetricSize() const
+    {
+        if (!IsQuantized() || cells.empty())
+        {
+            return GetDistanceMetricSize();
+        }
+        return cells[GetFirstQuantizedCell()].value_offset + 1;
+    }
+
+    // Codes of the quantized cells of one metric including an unused last code
+    std::size_t GetCodeMetricSize() const
+    {
+        return GetDistanceMetricSize() - GetMetricSize() + 1;
+    }
+
+    std::size_t GetRowMetricSize() const
+    {
+        const auto first_cell = GetFirstQuantizedCell();
+        if (first_cell == cells.size())
+        {
+            return 0;
+        }
+        const auto &last = cells.back();
+        return last.row_offset + last.num_source_nodes - cells[first_cell].row_offset;
+    }
+
+    QuantizedValues GetQuantizedValues(const std::size_t cell_index) const
+    {
+        const auto first_cell = GetFirstQuantizedCell();
+        if (!IsQuantized() || cell_index < first_cell)
+        {
+            return {};
+        }
+        const auto &first = cells[first_cell];
+        const auto &cell = cells[cell_index];
+        const auto code_offset = code_metric_offset + cell.value_offset - first.value_offset;
+        QuantizedValues quantized;
+        quantized.weight_codes = weight_codes.data() + code_offset;
+        quantized.duration_codes = duration_codes.data() + code_offset;
+        quantized.rows =
+            quantized_rows.data() + row_metric_offset + cell.row_offset - first.row_offset;
+        quantized.exceptions = quantized_exceptions.data();
+        return quantized;
+    }
+
   public:
-    using Cell = CellImpl<EdgeWeight, EdgeDuration>;
-    using ConstCell = CellImpl<const EdgeWeight, const EdgeDuration>;
+    using Cell = CellImpl<EdgeWeight, EdgeDuration, EdgeDistance>;
+    using ConstCell = CellImpl<const EdgeWeight, const EdgeDuration, const EdgeDistance>;
 
     CellStorageImpl() {}
 
@@ -211,8 +432,12 @@ template <storage::Ownership Ownership> class CellStorageImpl
         level_to_cell_offset.push_back(number_of_cells);
         cells.resize(number_of_cells);
 
-        std::vector<std::pair<CellID, NodeID>> level_source_boundary;
-        std::vector<std::pair<CellID, NodeID>> level_destination_boundary;
+        const auto number_of_nodes = base_graph.GetNumberOfNodes();
+        const std::uint8_t SOURCE_BOUNDARY = 1, DESTINATION_BOUNDARY = 2, UNCONNECTED = 4;
+        std::vector<std::uint8_t> node_flags(number_of_nodes);
+        // the number of boundary nodes of every cell, turned into their insert positions
+        std::vector<BoundaryOffset> source_offsets;
+        std::vector<BoundaryOffset> destination_offsets;
 
         std::size_t number_of_unconneced = 0;
 
@@ -220,91 +445,101 @@ template <storage::Ownership Ownership> class CellStorageImpl
         {
             auto level_offset = level_to_cell_offset[LevelIDToIndex(level)];
 
-            level_source_boundary.clear();
-            level_destination_boundary.clear();
+            // The nodes are classified independently, this scans all edges once per level
+            tbb::parallel_for(
+                tbb::blocked_range<NodeID>(0, number_of_nodes),
+                [&](const tbb::blocked_range<NodeID> &range) {
+                    for (auto node = range.begin(); node != range.end(); ++node)
+                    {
+                        const CellID cell_id = partition.GetCell(level, node);
+                        bool is_source_node = false;
+                        bool is_destination_node = false;
+                        bool is_boundary_node = false;
+
+                        for (auto edge : base_graph.GetAdjacentEdgeRange(node))
+                        {
+                            auto other = base_graph.GetTarget(edge);
+                            const auto &data = base_graph.GetEdgeData(edge);
+
+                            is_boundary_node |= partition.GetCell(level, other) != cell_id;
+                            is_source_node |=
+                                partition.GetCell(level, other) == cell_id && data.forward;
+                            is_destination_node |=
+                                partition.GetCell(level, other) == cell_id && data.backward;
+                        }
+
+                        std::uint8_t flags = 0;
+                        if (is_boundary_node)
+                        {
+                            flags |= is_source_node ? SOURCE_BOUNDARY : 0;
+                            flags |= is_destination_node ? DESTINATION_BOUNDARY : 0;
+                            // if a node is unconnected we still need to keep it for correctness
+                            // this adds it to the destination array to form an "empty" column
+                            if (!is_source_node && !is_destination_node)
+                                flags |= DESTINATION_BOUNDARY | UNCONNECTED;
+                        }
+                        node_flags[node] = flags;
+                    }
+                });
 
-            for (auto node = 0u; node < base_graph.GetNumberOfNodes(); ++node)
+            // Count the boundary nodes of every cell, the prefix sums of the counts are the
+            // offsets of the cells into the boundary arrays
+            const auto number_of_cells = partition.GetNumberOfCells(level);
+            source_offsets.assign(number_of_cells, 0);
+            destination_offsets.assign(number_of_cells, 0);
+            for (auto node = 0u; node < number_of_nodes; ++node)
             {
+                const auto flags = node_flags[node];
                 const CellID cell_id = partition.GetCell(level, node);
-                bool is_source_node = false;
-                bool is_destination_node = false;
-                bool is_boundary_node = false;
+                source_offsets[cell_id] += (flags & SOURCE_BOUNDARY) != 0;
+                destination_offsets[cell_id] += (flags & DESTINATION_BOUNDARY) != 0;
 
-                for (auto edge : base_graph.GetAdjacentEdgeRange(node))
+                if (flags & UNCONNECTED)
                 {
-                    auto other = base_graph.GetTarget(edge);
-                    const auto &data = base_graph.GetEdgeData(edge);
-
-                    is_boundary_node |= partition.GetCell(level, other) != cell_id;
-                    is_source_node |= partition.GetCell(level, other) == cell_id && data.forward;
-                    is_destination_node |=
-                        partition.GetCell(level, other) == cell_id && data.backward;
+                    number_of_unconneced++;
+                    util::Log(logWARNING) << "Found unconnected boundary node " << node << "("
+                                          << cell_id << ") on level " << (int)level;
                 }
+            }
 
-                if (is_boundary_node)
+            // Only cells with boundary nodes get an offset
+            const auto set_offsets = [](auto &cell_counts, auto &boundary, auto set_cell_fn) {
+                BoundaryOffset offset = boundary.size();
+                for (CellID cell_id = 0; cell_id < cell_counts.size(); ++cell_id)
                 {
-                    if (is_source_node)
-                        level_source_boundary.emplace_back(cell_id, node);
-                    if (is_destination_node)
-                        level_destination_boundary.emplace_back(cell_id, node);
-
-                    // if a node is unconnected we still need to keep it for correctness
-                    // this adds it to the destination array to form an "empty" column
-                    if (!is_source_node && !is_destination_node)
-                    {
-                        number_of_unconneced++;
-                        util::Log(logWARNING) << "Found unconnected boundary node " << node << "("
-                                              << cell_id << ") on level " << (int)level;
-                        level_destination_boundary.emplace_back(cell_id, node);
-                    }
+                    const auto count = cell_counts[cell_id];
+                    if (count > 0)
+                        set_cell_fn(cell_id, offset, count);
+                    cell_counts[cell_id] = offset;
+                    offset += count;
                 }
-            }
-
-            tbb::parallel_sort(level_source_boundary.begin(), level_source_boundary.end());
-            tbb::parallel_sort(level_destination_boundary.begin(),
-                               level_destination_boundary.end());
-
-            const auto insert_cell_boundary = [this, level_offset](auto &boundary,
-                                                                   auto set_num_nodes_fn,
-                                                                   auto set_boundary_offset_fn,
-                                                                   auto begin,
-                                                                   auto end) {
-                BOOST_ASSERT(std::distance(begin, end) > 0);
-
-                const auto cell_id = begin->first;
-                BOOST_ASSERT(level_offset + cell_id < cells.size());
-                auto &cell = cells[level_offset + cell_id];
-                set_num_nodes_fn(cell, std::distance(begin, end));
-                set_boundary_offset_fn(cell, boundary.size());
-
-                std::transform(begin,
-                               end,
-                               std::back_inserter(boundary),
-                               [](const auto &cell_and_node) { return cell_and_node.second; });
+                boundary.resize(offset);
             };
-
-            util::for_each_range(
-                level_source_boundary.begin(),
-                level_source_boundary.end(),
-                [this, insert_cell_boundary](auto begin, auto end) {
-                    insert_cell_boundary(
+            set_offsets(source_offsets,
                         source_boundary,
-                        [](auto &cell, auto value) { cell.num_source_nodes = value; },
-                        [](auto &cell, auto value) { cell.source_boundary_offset = value; },
-                        begin,
-                        end);
-                });
-            util::for_each_range(
-                level_destination_boundary.begin(),
-                level_destination_boundary.end(),
-                [this, insert_cell_boundary](auto begin, auto end) {
-                    insert_cell_boundary(
+                        [&](const CellID cell_id, const BoundaryOffset offset, const auto count) {
+                            auto &cell = cells[level_offset + cell_id];
+                            cell.source_boundary_offset = offset;
+                            cell.num_source_nodes = count;
+                        });
+            set_offsets(destination_offsets,
                         destination_boundary,
-                        [](auto &cell, auto value) { cell.num_destination_nodes = value; },
-                        [](auto &cell, auto value) { cell.destination_boundary_offset = value; },
-                        begin,
-                        end);
-                });
+                        [&](const CellID cell_id, const BoundaryOffset offset, const auto count) {
+                            auto &cell = cells[level_offset + cell_id];
+                            cell.destination_boundary_offset = offset;
+                            cell.num_destination_nodes = count;
+                        });
+
+            // the nodes of a cell stay ordered by id
+            for (auto node = 0u; node < number_of_nodes; ++node)
+            {
+                const auto flags = node_flags[node];
+                const CellID cell_id = partition.GetCell(level, node);
+                if (flags & SOURCE_BOUNDARY)
+                    source_boundary[source_offsets[cell_id]++] = node;
+                if (flags & DESTINATION_BOUNDARY)
+                    destination_boundary[destination_offsets[cell_id]++] = node;
+            }
         }
 
         // a partition that contains boundary nodes that have no arcs going into
@@ -318,28 +553,214 @@ template <storage::Ownership Ownership> class CellStorageImpl
 
         // Set cell values offsets and calculate total storage size
         ValueOffset value_offset = 0;
+        RowOffset row_offset = 0;
         for (auto &cell : cells)
         {
             cell.value_offset = value_offset;
             value_offset += cell.num_source_nodes * cell.num_destination_nodes;
+            cell.row_offset = row_offset;
+            row_offset += cell.num_source_nodes;
         }
 
         weights.resize(value_offset + 1, INVALID_EDGE_WEIGHT);
         durations.resize(value_offset + 1, MAXIMAL_EDGE_DURATION);
+        distances.resize(value_offset + 1, INVALID_EDGE_DISTANCE);
     }
 
     template <typename = std::enable_if<Ownership == storage::Ownership::View>>
     CellStorageImpl(Vector<EdgeWeight> weights_,
                     Vector<EdgeDuration> durations_,
+                    Vector<EdgeDistance> distances_,
                     Vector<NodeID> source_boundary_,
                     Vector<NodeID> destination_boundary_,
                     Vector<CellData> cells_,
-                    Vector<std::uint64_t> level_to_cell_offset_)
+                    Vector<std::uint64_t> level_to_cell_offset_,
+                    Vector<quantization::Code> weight_codes_ = {},
+                    Vector<quantization::Code> duration_codes_ = {},
+                    Vector<QuantizedRow> quantized_rows_ = {},
+                    Vector<EdgeWeight> quantized_exceptions_ = {})
         : weights(std::move(weights_)), durations(std::move(durations_)),
+          distances(std::move(distances_)),
           source_boundary(std::move(source_boundary_)),
           destination_boundary(std::move(destination_boundary_)), cells(std::move(cells_)),
-          level_to_cell_offset(std::move(level_to_cell_offset_))
+          level_to_cell_offset(std::move(level_to_cell_offset_)),
+          weight_codes(std::move(weight_codes_)), duration_codes(std::move(duration_codes_)),
+          quantized_rows(std::move(quantized_rows_)),
+          quantized_exceptions(std::move(quantized_exceptions_))
+    {
+    }
+
+    // The weights, durations and distances hold one layer per metric, one after another. They
+    // share the cells and their boundary nodes, GetCell returns the values of the selected metric.
+    std::size_t GetNumberOfMetrics() const { return weights.size() / GetMetricSize(); }
+
+    // Bytes of the values of all metrics, the boundary nodes and the cells
+    std::size_t GetMemorySize() const
+    {
+        return weights.size() * sizeof(EdgeWeight) + durations.size() * sizeof(EdgeDuration) +
+               distances.size() * sizeof(EdgeDistance) +
+               (source_boundary.size() + destination_boundary.size()) * sizeof(NodeID) +
+               cells.size() * sizeof(CellData) +
+               level_to_cell_offset.size() * sizeof(std::uint64_t) +
+               (weight_codes.size() + duration_codes.size()) * sizeof(quantization::Code) +
+               quantized_rows.size() * sizeof(QuantizedRow) +
+               quantized_exceptions.size() * sizeof(EdgeWeight);
+    }
+
+    void SelectMetric(const std::size_t metric)
     {
+        BOOST_ASSERT(metric < GetNumberOfMetrics());
+        metric_offset = metric * GetMetricSize();
+        distance_metric_offset = metric * GetDistanceMetricSize();
+        if (IsQuantized())
+        {
+            code_metric_offset = metric * GetCodeMetricSize();
+            row_metric_offset = metric * GetRowMetricSize();
+        }
+    }
+
+    // Keeps the first metrics, added metrics start out invalid and need to be customized
+    template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
+    void SetNumberOfMetrics(const std::size_t num_metrics)
+    {
+        BOOST_ASSERT(!IsQuantized());
+        const auto metric_size = GetMetricSize();
+        weights.resize(num_metrics * metric_size, INVALID_EDGE_WEIGHT);
+        durations.resize(num_metrics * metric_size, MAXIMAL_EDGE_DURATION);
+        distances.resize(num_metrics * metric_size, INVALID_EDGE_DISTANCE);
+        if (metric_offset >= weights.size())
+        {
+            metric_offset = 0;
+            distance_metric_offset = 0;
+        }
+    }
+
+    // Stores the weights and durations of the cells from MIN_QUANTIZED_LEVEL on as 16 bit codes,
+    // offsets from the smallest value of their row. The few values that are too far above it
+    // are kept in a side table, so every value decodes to exactly what it was. The cells of
+    // the lower levels, which the queries relax the most, keep their values as they are.
+    template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
+    void Quantize()
+    {
+        const auto first_cell = GetFirstQuantizedCell();
+        if (IsQuantized() || first_cell == cells.size())
+        {
+            return;
+        }
+
+        const auto num_metrics = GetNumberOfMetrics();
+        const auto metric_size = GetMetricSize();
+        const auto exact_size = cells[first_cell].value_offset;
+        const auto code_size = metric_size - exact_size;
+        const auto row_size = GetRowMetricSize();
+
+        std::vector<EdgeWeight> exact_weights, exact_durations;
+        weight_codes.resize(num_metrics * code_size, quantization::INVALID_CODE);
+        duration_codes.resize(num_metrics * code_size, quantization::INVALID_CODE);
+        quantized_rows.resize(num_metrics * row_size);
+        for (std::size_t metric = 0; metric < num_metrics; ++metric)
+        {
+            const auto metric_weights = weights.data() + metric * metric_size;
+            const auto metric_durations = durations.data() + metric * metric_size;
+            exact_weights.insert(exact_weights.end(), metric_weights, metric_weights + exact_size);
+            exact_weights.push_back(INVALID_EDGE_WEIGHT);
+            exact_durations.insert(
+                exact_durations.end(), metric_durations, metric_durations + exact_size);
+            exact_durations.push_back(MAXIMAL_EDGE_DURATION);
+
+            for (auto cell_index = first_cell; cell_index < cells.size(); ++cell_index)
+            {
+                const auto &cell = cells[cell_index];
+                for (std::size_t row = 0; row < cell.num_source_nodes; ++row)
+                {
+                    const auto value_offset = cell.value_offset + row * cell.num_destination_nodes;
+                    const auto code_offset = metric * code_size + value_offset - exact_size;
+                    auto &row_data = quantized_rows[metric * row_size + cell.row_offset -
+                                                    cells[first_cell].row_offset + row];
+
+                    row_data.weight_exception_offset = quantized_exceptions.size();
+                    row_data.weight_base =
+                        quantization::encodeRow(metric_weights + value_offset,
+                                                cell.num_destination_nodes,
+                                                INVALID_EDGE_WEIGHT,
+                                                weight_codes.data() + code_offset,
+                                                quantized_exceptions);
+                    row_data.duration_exception_offset = quantized_exceptions.size();
+                    row_data.duration_base =
+                        quantization::encodeRow(metric_durations + value_offset,
+                                                cell.num_destination_nodes,
+                                                MAXIMAL_EDGE_DURATION,
+                                                duration_codes.data() + code_offset,
+                                                quantized_exceptions);
+                }
+            }
+        }
+        weights = std::move(exact_weights);
+        durations = std::move(exact_durations);
+        SelectMetric(0);
+    }
+
+    // Decodes the quantized cells into their exact values again, e.g. to customize them
+    template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
+    void Dequantize()
+    {
+        if (!IsQuantized())
+        {
+            return;
+        }
+
+        const auto num_metrics = GetNumberOfMetrics();
+        const auto first_cell = GetFirstQuantizedCell();
+        const auto exact_size = cells[first_cell].value_offset;
+        const auto code_size = GetCodeMetricSize() - 1;
+        const auto row_size = GetRowMetricSize();
+        const auto metric_size = exact_size + code_size + 1;
+
+        std::vector<EdgeWeight> all_weights(num_metrics * metric_size, INVALID_EDGE_WEIGHT);
+        std::vector<EdgeDuration> all_durations(num_metrics * metric_size, MAXIMAL_EDGE_DURATION);
+        for (std::size_t metric = 0; metric < num_metrics; ++metric)
+        {
+            const auto metric_weights = all_weights.data() + metric * metric_size;
+            const auto metric_durations = all_durations.data() + metric * metric_size;
+            std::copy_n(weights.data() + metric * (exact_size + 1), exact_size, metric_weights);
+            std::copy_n(
+                durations.data() + metric * (exact_size + 1), exact_size, metric_durations);
+
+            for (auto cell_index = first_cell; cell_index < cells.size(); ++cell_index)
+            {
+                const auto &cell = cells[cell_index];
+                for (std::size_t row = 0; row < cell.num_source_nodes; ++row)
+                {
+                    const auto value_offset = cell.value_offset + row * cell.num_destination_nodes;
+                    const auto code_offset = metric * (code_size + 1) + value_offset - exact_size;
+                    const auto &row_data = quantized_rows[metric * row_size + cell.row_offset -
+                                                          cells[first_cell].row_offset + row];
+                    quantization::decodeRow(
+                        weight_codes.data() + code_offset,
+                        cell.num_destination_nodes,
+                        row_data.weight_base,
+                        quantized_exceptions.data() + row_data.weight_exception_offset,
+                        INVALID_EDGE_WEIGHT,
+                        metric_weights + value_offset);
+                    quantization::decodeRow(
+                        duration_codes.data() + code_offset,
+                        cell.num_destination_nodes,
+                        row_data.duration_base,
+                        quantized_exceptions.data() + row_data.duration_exception_offset,
+                        MAXIMAL_EDGE_DURATION,
+                        metric_durations + value_offset);
+                }
+            }
+        }
+        weights = std::move(all_weights);
+        durations = std::move(all_durations);
+        weight_codes.clear();
+        duration_codes.clear();
+        quantized_rows.clear();
+        quantized_exceptions.clear();
+        code_metric_offset = 0;
+        row_metric_offset = 0;
+        SelectMetric(0);
     }
 
     ConstCell GetCell(LevelID level, CellID id) const
@@ -350,10 +771,12 @@ template <storage::Ownership Ownership> class CellStorageImpl
         const auto cell_index = offset + id;
         BOOST_ASSERT(cell_index < cells.size());
         return ConstCell{cells[cell_index],
-                         weights.data(),
-                         durations.data(),
+                         weights.data() + metric_offset,
+                         durations.data() + metric_offset,
+                         distances.data() + distance_metric_offset,
                          source_boundary.empty() ? nullptr : source_boundary.data(),
-                         destination_boundary.empty() ? nullptr : destination_boundary.data()};
+                         destination_boundary.empty() ? nullptr : destination_boundary.data(),
+                         GetQuantizedValues(cell_index)};
     }
 
     template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
@@ -364,25 +787,40 @@ template <storage::Ownership Ownership> class CellStorageImpl
         const auto offset = level_to_cell_offset[level_index];
         const auto cell_index = offset + id;
         BOOST_ASSERT(cell_index < cells.size());
+        // the values of quantized cells can not be written, Dequantize them first
+        BOOST_ASSERT(!IsQuantized());
         return Cell{cells[cell_index],
-                    weights.data(),
-                    durations.data(),
+                    weights.data() + metric_offset,
+                    durations.data() + metric_offset,
+                    distances.data() + distance_metric_offset,
                     source_boundary.data(),
                     destination_boundary.data()};
     }
 
     friend void serialization::read<Ownership>(storage::io::FileReader &reader,
                                                detail::CellStorageImpl<Ownership> &storage);
+    friend void serialization::readMetric<Ownership>(storage::io::FileReader &reader,
+                                                     detail::CellStorageImpl<Ownership> &storage);
     friend void serialization::write<Ownership>(storage::io::FileWriter &writer,
                                                 const detail::CellStorageImpl<Ownership> &storage);
 
   private:
     Vector<EdgeWeight> weights;
     Vector<EdgeDuration> durations;
+    Vector<EdgeDistance> distances;
     Vector<NodeID> source_boundary;
     Vector<NodeID> destination_boundary;
     Vector<CellData> cells;
     Vector<std::uint64_t> level_to_cell_offset;
+    // only set if quantized
+    Vector<quantization::Code> weight_codes;
+    Vector<quantization::Code> duration_codes;
+    Vector<QuantizedRow> quantized_rows;
+    Vector<EdgeWeight> quantized_exceptions;
+    std::size_t metric_offset = 0;
+    std::size_t distance_metric_offset = 0;
+    std::size_t code_metric_offset = 0;
+    std::size_t row_metric_offset = 0;
 };
 }
 }
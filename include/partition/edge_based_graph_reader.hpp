@@ -41,6 +41,7 @@ splitBidirectionalEdges(const std::vector<extractor::EdgeBasedEdge> &edges)
                               edge.target,
                               edge.data.turn_id,
                               std::max(edge.data.weight, 1),
+                              edge.data.distance,
                               edge.data.duration,
                               edge.data.forward,
                               edge.data.backward);
@@ -49,6 +50,7 @@ splitBidirectionalEdges(const std::vector<extractor::EdgeBasedEdge> &edges)
                               edge.source,
                               edge.data.turn_id,
                               std::max(edge.data.weight, 1),
+                              edge.data.distance,
                               edge.data.duration,
                               edge.data.backward,
                               edge.data.forward);
@@ -136,6 +138,154 @@ std::vector<OutputEdgeT> prepareEdgesForUsageInGraph(std::vector<extractor::Edge
     return output_edges;
 }
 
+// Prepares the edges of several metrics of the same graph, the input edges of all metrics are in
+// the same order and only differ in their data. Every metric yields the same edges in the same
+// order, so their graphs share the nodes and the edge targets. Forward and backward edges are only
+// merged if their weights are the same in all metrics. An edge that only exists in some metrics
+// has neither the forward nor the backward flag set in the others.
+template <typename OutputEdgeT>
+std::vector<std::vector<OutputEdgeT>>
+prepareMetricEdgesForUsageInGraph(const std::vector<std::vector<extractor::EdgeBasedEdge>> &metrics)
+{
+    BOOST_ASSERT(!metrics.empty());
+    const auto &edges = metrics.front();
+
+    struct DirectedEdge
+    {
+        NodeID source;
+        NodeID target;
+        std::size_t index;
+        bool reversed;
+    };
+
+    // Bidirectional (s,t) to (s,t) and (t,s) as in splitBidirectionalEdges
+    std::vector<DirectedEdge> directed;
+    directed.reserve(edges.size() * 2);
+    for (std::size_t index = 0; index < edges.size(); ++index)
+    {
+        const auto exists =
+            std::any_of(metrics.begin(), metrics.end(), [index](const auto &metric) {
+                return metric[index].data.weight != INVALID_EDGE_WEIGHT;
+            });
+        if (!exists || edges[index].source == edges[index].target)
+            continue;
+
+        directed.push_back(DirectedEdge{edges[index].source, edges[index].target, index, false});
+        directed.push_back(DirectedEdge{edges[index].target, edges[index].source, index, true});
+    }
+    std::sort(begin(directed), end(directed), [](const auto &lhs, const auto &rhs) {
+        return std::tie(lhs.source, lhs.target, lhs.index, lhs.reversed) <
+               std::tie(rhs.source, rhs.target, rhs.index, rhs.reversed);
+    });
+
+    const auto get_data = [](const extractor::EdgeBasedEdge &edge, const bool reversed) {
+        auto data = edge.data;
+        data.weight = std::max(data.weight, 1);
+        if (reversed)
+        {
+            const bool forward = data.forward;
+            data.forward = data.backward;
+            data.backward = forward;
+        }
+        return data;
+    };
+
+    std::vector<std::vector<OutputEdgeT>> output_edges(metrics.size());
+    for (auto &metric_edges : output_edges)
+    {
+        metric_edges.reserve(directed.size());
+    }
+
+    // smallest forward and backward edge of each metric, nullptr if there is none
+    std::vector<const DirectedEdge *> forward(metrics.size());
+    std::vector<const DirectedEdge *> backward(metrics.size());
+    std::vector<EdgeWeight> forward_weight(metrics.size());
+    std::vector<EdgeWeight> backward_weight(metrics.size());
+
+    for (auto begin_interval = directed.begin(); begin_interval != directed.end();)
+    {
+        const NodeID source = begin_interval->source;
+        const NodeID target = begin_interval->target;
+
+        auto end_interval =
+            std::find_if_not(begin_interval, directed.end(), [source, target](const auto &edge) {
+                return std::tie(edge.source, edge.target) == std::tie(source, target);
+            });
+        BOOST_ASSERT(begin_interval != end_interval);
+
+        for (std::size_t metric = 0; metric < metrics.size(); ++metric)
+        {
+            forward[metric] = nullptr;
+            backward[metric] = nullptr;
+            for (auto edge = begin_interval; edge != end_interval; ++edge)
+            {
+                const auto &input = metrics[metric][edge->index];
+                BOOST_ASSERT(input.source == edges[edge->index].source);
+                BOOST_ASSERT(input.target == edges[edge->index].target);
+                if (input.data.weight == INVALID_EDGE_WEIGHT)
+                    continue;
+
+                const auto data = get_data(input, edge->reversed);
+                BOOST_ASSERT_MSG(data.forward != data.backward,
+                                 "The forward and backward flag need to be mutally exclusive");
+                auto &smallest = data.forward ? forward[metric] : backward[metric];
+                auto &smallest_weight =
+                    data.forward ? forward_weight[metric] : backward_weight[metric];
+                if (smallest == nullptr || data.weight < smallest_weight)
+                {
+                    smallest = &*edge;
+                    smallest_weight = data.weight;
+                }
+            }
+        }
+
+        const auto is_null = [](const DirectedEdge *edge) { return edge == nullptr; };
+        const bool has_forward = !std::all_of(forward.begin(), forward.end(), is_null);
+        const bool has_backward = !std::all_of(backward.begin(), backward.end(), is_null);
+
+        bool merge = has_forward && has_backward;
+        for (std::size_t metric = 0; merge && metric < metrics.size(); ++metric)
+        {
+            merge = forward[metric] != nullptr && backward[metric] != nullptr &&
+                    forward_weight[metric] == backward_weight[metric];
+        }
+
+        // adds the smallest edges of every metric, or a disabled copy of the edge of another
+        // metric if a metric has none
+        const auto add_edges = [&](const std::vector<const DirectedEdge *> &smallest) {
+            const auto existing = *std::find_if_not(smallest.begin(), smallest.end(), is_null);
+            for (std::size_t metric = 0; metric < metrics.size(); ++metric)
+            {
+                if (smallest[metric] != nullptr)
+                {
+                    const auto &edge = *smallest[metric];
+                    output_edges[metric].push_back(OutputEdgeT{
+                        source, target, get_data(metrics[metric][edge.index], edge.reversed)});
+                    output_edges[metric].back().data.backward |= merge;
+                }
+                else
+                {
+                    output_edges[metric].push_back(OutputEdgeT{
+                        source,
+                        target,
+                        get_data(metrics[metric][existing->index], existing->reversed)});
+                    output_edges[metric].back().data.forward = false;
+                    output_edges[metric].back().data.backward = false;
+                }
+            }
+        };
+
+        if (has_forward)
+            add_edges(forward);
+        if (has_backward && !merge)
+            add_edges(backward);
+
+        begin_interval = end_interval;
+    }
+
+    return output_edges;
+}
+
 std::vector<extractor::EdgeBasedEdge> graphToEdges(const DynamicEdgeBasedGraph &edge_based_graph)
 {
     auto range = tbb::blocked_range<NodeID>(0, edge_based_graph.GetNumberOfNodes());
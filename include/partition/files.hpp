@@ -84,6 +84,20 @@ inline void readCells(const boost::filesystem::path &path, CellStorageT &storage
     serialization::read(reader, storage);
 }
 
+// reads the weights, durations and distances of .osrm.cells file
+template <typename CellStorageT>
+inline void readCellMetric(const boost::filesystem::path &path, CellStorageT &storage)
+{
+    static_assert(std::is_same<CellStorageView, CellStorageT>::value ||
+                      std::is_same<CellStorage, CellStorageT>::value,
+                  "");
+
+    const auto fingerprint = storage::io::FileReader::VerifyFingerprint;
+    storage::io::FileReader reader{path, fingerprint};
+
+    serialization::readMetric(reader, storage);
+}
+
 // writes .osrm.cells file
 template <typename CellStorageT>
 inline void writeCells(const boost::filesystem::path &path, CellStorageT &storage)
@@ -97,6 +111,24 @@ inline void writeCells(const boost::filesystem::path &path, CellStorageT &storag
 
     serialization::write(writer, storage);
 }
+
+// reads a subtree spilled by osrm-partition
+inline void readSubtree(const boost::filesystem::path &path, BisectionSubtree &subtree)
+{
+    const auto fingerprint = storage::io::FileReader::VerifyFingerprint;
+    storage::io::FileReader reader{path, fingerprint};
+
+    serialization::read(reader, subtree);
+}
+
+// writes a subtree spilled by osrm-partition
+inline void writeSubtree(const boost::filesystem::path &path, const BisectionSubtree &subtree)
+{
+    const auto fingerprint = storage::io::FileWriter::GenerateFingerprint;
+    storage::io::FileWriter writer{path, fingerprint};
+
+    serialization::write(writer, subtree);
+}
 }
 }
 }
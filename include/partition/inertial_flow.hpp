@@ -9,10 +9,19 @@ namespace osrm
 namespace partition
 {
 
-DinicMaxFlow::MinCut computeInertialFlowCut(const GraphView &view,
-                                            const std::size_t num_slopes,
-                                            const double balance,
-                                            const double source_sink_rate);
+// The max-flow algorithm computing the cut of every slope, both find a minimum cut
+enum class MaxFlowAlgorithm
+{
+    Dinic,
+    PushRelabel
+};
+
+DinicMaxFlow::MinCut
+computeInertialFlowCut(const GraphView &view,
+                       const std::size_t num_slopes,
+                       const double balance,
+                       const double source_sink_rate,
+                       const MaxFlowAlgorithm max_flow = MaxFlowAlgorithm::Dinic);
 
 } // namespace partition
 } // namespace osrm
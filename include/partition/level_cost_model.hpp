@@ -0,0 +1,145 @@
+#ifndef OSRM_PARTITION_LEVEL_COST_MODEL_HPP
+#define OSRM_PARTITION_LEVEL_COST_MODEL_HPP
+
+#include "partition/cell_storage.hpp"
+#include "partition/multi_level_partition.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace osrm
+{
+namespace partition
+{
+
+// Estimated costs of a level configuration, counted in arcs: the edges of the base graph and
+// the clique arcs between the boundary nodes of the cells.
+//
+// An MLD query settles the nodes of the level 1 cells of its source and target on the base
+// graph, and on every level l below the highest level where source and target differ the
+// boundary nodes of the level l cells that are inside the level l + 1 cell of source or target.
+// On the highest different level it crosses the level l cells of the cell that contains both.
+// The customization runs one search per source node of a cell, level 1 cells on the base graph
+// and higher cells on the clique arcs of their children.
+struct LevelCost
+{
+    // mean arcs a query relaxes, over random pairs of nodes
+    double query_arcs = 0;
+    double customization_arcs = 0;
+    std::size_t cell_storage_bytes = 0;
+};
+
+template <typename GraphT>
+LevelCost estimateLevelCost(const MultiLevelPartition &partition,
+                            const CellStorage &storage,
+                            const GraphT &graph,
+                            const std::size_t number_of_queries)
+{
+    const auto number_of_levels = partition.GetNumberOfLevels();
+    BOOST_ASSERT(number_of_levels > 1);
+
+    const auto arcs = [&](const LevelID level, const CellID cell) {
+        const auto data = storage.GetCell(level, cell);
+        return static_cast<double>(data.GetSourceNodes().size()) *
+               data.GetDestinationNodes().size();
+    };
+
+    // base graph edges per level 1 cell
+    std::vector<double> base_arcs(partition.GetNumberOfCells(1), 0);
+    for (const NodeID node : util::irange<NodeID>(0, graph.GetNumberOfNodes()))
+    {
+        base_arcs[partition.GetCell(1, node)] += graph.GetOutDegree(node);
+    }
+
+    // overlay_arcs[level][cell] are the clique arcs of the level cells inside the cell at
+    // level + 1, the top level has one entry for the whole graph
+    std::vector<std::vector<double>> overlay_arcs(number_of_levels);
+    for (const LevelID level : util::irange<LevelID>(1, number_of_levels))
+    {
+        if (level + 1 < number_of_levels)
+        {
+            overlay_arcs[level].resize(partition.GetNumberOfCells(level + 1), 0);
+            for (const CellID parent : util::irange<CellID>(0, overlay_arcs[level].size()))
+            {
+                for (const CellID child : util::irange(partition.BeginChildren(level + 1, parent),
+                                                       partition.EndChildren(level + 1, parent)))
+                {
+                    overlay_arcs[level][parent] += arcs(level, child);
+                }
+            }
+        }
+        else
+        {
+            overlay_arcs[level].resize(1, 0);
+            for (const CellID cell : util::irange<CellID>(0, partition.GetNumberOfCells(level)))
+            {
+                overlay_arcs[level][0] += arcs(level, cell);
+            }
+        }
+    }
+    const auto overlay = [&](const LevelID level, const NodeID node) {
+        return level + 1 < number_of_levels
+                   ? overlay_arcs[level][partition.GetCell(level + 1, node)]
+                   : overlay_arcs[level][0];
+    };
+
+    LevelCost cost;
+    cost.cell_storage_bytes = storage.GetMemorySize();
+
+    for (const LevelID level : util::irange<LevelID>(1, number_of_levels))
+    {
+        for (const CellID cell : util::irange<CellID>(0, partition.GetNumberOfCells(level)))
+        {
+            const auto sources = storage.GetCell(level, cell).GetSourceNodes().size();
+            cost.customization_arcs +=
+                sources * (level == 1 ? base_arcs[cell] : overlay_arcs[level - 1][cell]);
+        }
+    }
+
+    const auto number_of_nodes = graph.GetNumberOfNodes();
+    if (number_of_nodes == 0 || number_of_queries == 0)
+    {
+        return cost;
+    }
+
+    // the same pairs for every configuration
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<NodeID> random_node(0, number_of_nodes - 1);
+    double query_arcs = 0;
+    for (std::size_t query = 0; query < number_of_queries; ++query)
+    {
+        const auto source = random_node(generator);
+        const auto target = random_node(generator);
+        const auto highest_level = partition.GetHighestDifferentLevel(source, target);
+        query_arcs += base_arcs[partition.GetCell(1, source)];
+        if (highest_level == 0)
+        {
+            continue;
+        }
+
+        query_arcs += base_arcs[partition.GetCell(1, target)];
+        for (const LevelID level : util::irange<LevelID>(1, highest_level))
+        {
+            query_arcs += overlay(level, source) + overlay(level, target);
+        }
+        query_arcs += overlay(highest_level, source);
+    }
+    cost.query_arcs = query_arcs / number_of_queries;
+
+    return cost;
+}
+
+// The index of the configuration with the smallest sum of its costs relative to the smallest
+// cost of each kind among all configurations, query, customization and memory weigh the same
+std::size_t recommendLevelConfiguration(const std::vector<LevelCost> &costs);
+}
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "storage/io_fwd.hpp"
 #include "storage/shared_memory_ownership.hpp"
 
+#include "util/prefetch.hpp"
 #include "util/static_graph.hpp"
 #include "util/vector_view.hpp"
 
@@ -14,6 +15,8 @@
 #include <boost/iterator/permutation_iterator.hpp>
 #include <boost/range/combine.hpp>
 
+#include <algorithm>
+
 namespace osrm
 {
 
@@ -127,9 +130,46 @@ class MultiLevelGraph : public util::StaticGraph<EdgeDataT, Ownership>
         }
     }
 
+    // Prefetches the border edge offsets of the node as well
+    void PrefetchNode(const NodeID node) const
+    {
+        SuperT::PrefetchNode(node);
+        const auto index = node * GetNumberOfLevels();
+        if (index < node_to_edge_offset.size() - 1)
+        {
+            util::prefetch(&node_to_edge_offset[index]);
+        }
+    }
+
     // We save the level as sentinel at the end
     LevelID GetNumberOfLevels() const { return node_to_edge_offset.back(); }
 
+    // The edge array holds one layer of edges per metric, one after another. All layers share
+    // the nodes and the edge targets, only the edge data differs.
+    std::size_t GetNumberOfMetrics() const
+    {
+        return SuperT::number_of_edges == 0 ? 1
+                                            : SuperT::edge_array.size() / SuperT::number_of_edges;
+    }
+
+    // Appends the edges of the graph of another metric as a new layer. Both graphs need to be
+    // built from the same edges, only the data of the edges may differ.
+    template <typename = std::enable_if<Ownership == storage::Ownership::Container>>
+    void AddMetric(const MultiLevelGraph &other)
+    {
+        BOOST_ASSERT(other.GetNumberOfNodes() == SuperT::GetNumberOfNodes());
+        BOOST_ASSERT(other.GetNumberOfEdges() == SuperT::GetNumberOfEdges());
+        BOOST_ASSERT(std::equal(other.edge_array.begin(),
+                                other.edge_array.begin() + other.GetNumberOfEdges(),
+                                SuperT::edge_array.begin(),
+                                [](const auto &lhs, const auto &rhs) {
+                                    return lhs.target == rhs.target;
+                                }));
+        SuperT::edge_array.insert(SuperT::edge_array.end(),
+                                  other.edge_array.begin(),
+                                  other.edge_array.begin() + other.GetNumberOfEdges());
+    }
+
   private:
     template <typename ContainerT>
     auto GetHighestBorderLevel(const MultiLevelPartition &mlp, const ContainerT &edges) const
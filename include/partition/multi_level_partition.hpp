@@ -20,6 +20,8 @@
 
 #include <boost/range/adaptor/reversed.hpp>
 
+#include <tbb/parallel_sort.h>
+
 namespace osrm
 {
 namespace partition
@@ -261,14 +263,18 @@ template <storage::Ownership Ownership> class MultiLevelPartitionImpl final
         // level 0: 2 4 3 5 1 0
         // level 1: 3 3 4 4 1 2
         // level 2: 0 0 1 1 2 2 (< sorted)
-        for (const auto &partition : partitions)
-        {
-            std::stable_sort(permutation.begin(),
-                             permutation.end(),
-                             [&partition](const auto lhs, const auto rhs) {
-                                 return partition[lhs] < partition[rhs];
-                             });
-        }
+        //
+        // The rounds of stable sorts equal one sort by the cell ids from the top level down and
+        // the node id last, which runs in parallel.
+        tbb::parallel_sort(
+            permutation.begin(), permutation.end(), [&partitions](const auto lhs, const auto rhs) {
+                for (const auto &partition : boost::adaptors::reverse(partitions))
+                {
+                    if (partition[lhs] != partition[rhs])
+                        return partition[lhs] < partition[rhs];
+                }
+                return lhs < rhs;
+            });
 
         // top down assign new cell ids
         LevelID level = partitions.size();
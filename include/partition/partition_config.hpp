@@ -4,8 +4,11 @@
 #include <boost/filesystem/path.hpp>
 
 #include <array>
+#include <cstdint>
 #include <string>
+#include <vector>
 
+#include "partition/inertial_flow.hpp"
 #include "storage/io_config.hpp"
 
 namespace osrm
@@ -18,7 +21,7 @@ struct PartitionConfig final : storage::IOConfig
     PartitionConfig()
         : IOConfig(
               {".osrm", ".osrm.fileIndex", ".osrm.ebg_nodes"},
-              {".osrm.hsgr", ".osrm.cnbg"},
+              {".osrm.hsgr", ".osrm.cnbg", ".osrm.conditional_turn_masks"},
               {".osrm.ebg", ".osrm.cnbg", ".osrm.cnbg_to_ebg", ".osrm.partition", ".osrm.cells"}),
           requested_num_threads(0), balance(1.2), boundary_factor(0.25), num_optimizing_cuts(10),
           small_component_size(1000),
@@ -38,6 +41,20 @@ struct PartitionConfig final : storage::IOConfig
     std::size_t num_optimizing_cuts;
     std::size_t small_component_size;
     std::vector<std::size_t> max_cell_sizes;
+    MaxFlowAlgorithm max_flow = MaxFlowAlgorithm::Dinic;
+    // Bisection levels below the components bisected on the whole graph, the parts left are
+    // spilled to files and bisected one after another. 0 bisects the whole graph in memory.
+    std::size_t subtree_depth = 0;
+
+    // Candidate max_cell_sizes compared with the cost model of partition/level_cost_model.hpp
+    // on tune_number_of_queries random queries. Candidates with the same level 1 size share
+    // one bisection. Nothing is written unless tune_write, then the recommended one is.
+    std::vector<std::vector<std::size_t>> tune_max_cell_sizes;
+    std::size_t tune_number_of_queries = 10000;
+    bool tune_write = false;
+
+    // Logs how the top level cells would be split over this many shards, 0 doesn't plan shards
+    std::uint32_t num_shards = 0;
 };
 }
 }
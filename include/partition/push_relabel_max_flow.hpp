@@ -0,0 +1,35 @@
+#ifndef OSRM_PARTITION_PUSH_RELABEL_MAX_FLOW_HPP_
+#define OSRM_PARTITION_PUSH_RELABEL_MAX_FLOW_HPP_
+
+#include "partition/dinic_max_flow.hpp"
+#include "partition/graph_view.hpp"
+
+namespace osrm
+{
+namespace partition
+{
+
+// Alternative to DinicMaxFlow with the same interface. Computes the minimum cut with the highest
+// label push-relabel algorithm [1], using the global relabeling and gap heuristics [2]. Only the
+// first phase runs: the cut is known once no active node can reach the sink side anymore, the
+// excess left on the source side is never sent back.
+class PushRelabelMaxFlow
+{
+  public:
+    using MinCut = DinicMaxFlow::MinCut;
+    using SourceSinkNodes = DinicMaxFlow::SourceSinkNodes;
+
+    // The source side of the cut are the nodes that can not reach a sink in the residual graph
+    MinCut operator()(const GraphView &view,
+                      const SourceSinkNodes &source_nodes,
+                      const SourceSinkNodes &sink_nodes) const;
+};
+
+} // namespace partition
+} // namespace osrm
+
+// [1] Goldberg, Tarjan: A New Approach to the Maximum-Flow Problem. J. ACM 35(4), 1988
+// [2] Cherkassky, Goldberg: On Implementing the Push-Relabel Method for the Maximum Flow Problem.
+//     Algorithmica 19(4), 1997
+
+#endif // OSRM_PARTITION_PUSH_RELABEL_MAX_FLOW_HPP_
@@ -3,10 +3,13 @@
 
 #include "partition/bisection_graph.hpp"
 #include "partition/graph_view.hpp"
+#include "partition/inertial_flow.hpp"
 #include "partition/recursive_bisection_state.hpp"
+#include "util/coordinate.hpp"
 #include "util/typedefs.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace osrm
@@ -14,25 +17,78 @@ namespace osrm
 namespace partition
 {
 
+// A part of the graph that is bisected independently of the rest of the graph. All its nodes share
+// the bisection id bits above its depth.
+struct BisectionSubtree
+{
+    std::uint64_t depth;
+    BisectionID bisection_id;
+    std::vector<NodeID> original_ids;
+    std::vector<util::Coordinate> coordinates;
+    // the edges of node i are edge_targets[edge_offsets[i]] up to edge_targets[edge_offsets[i + 1]]
+    std::vector<EdgeID> edge_offsets;
+    std::vector<NodeID> edge_targets;
+};
+
 class RecursiveBisection
 {
   public:
+    // Bisects the big components. With a subtree_depth the bisection stops that many levels below
+    // the components, the remaining parts are left to be bisected as subtrees.
+    RecursiveBisection(BisectionGraph &bisection_graph,
+                       const std::size_t maximum_cell_size,
+                       const double balance,
+                       const double boundary_factor,
+                       const std::size_t num_optimizing_cuts,
+                       const std::size_t small_component_size,
+                       const MaxFlowAlgorithm max_flow = MaxFlowAlgorithm::Dinic,
+                       const std::size_t subtree_depth = 0);
+
+    // Continues the bisection of a subtree, the bisection graph holds only the subtree's nodes
     RecursiveBisection(BisectionGraph &bisection_graph,
+                       const BisectionSubtree &subtree,
+                       const std::uint32_t scc_depth,
                        const std::size_t maximum_cell_size,
                        const double balance,
                        const double boundary_factor,
                        const std::size_t num_optimizing_cuts,
-                       const std::size_t small_component_size);
+                       const MaxFlowAlgorithm max_flow = MaxFlowAlgorithm::Dinic);
 
     const std::vector<BisectionID> &BisectionIDs() const;
 
     std::uint32_t SCCDepth() const;
 
+    // Number of subtrees left when the bisection stopped at the subtree depth
+    std::size_t NumberOfSubtrees() const;
+
+    // Copies out a subtree, its node ids are the original ids of the bisection graph
+    BisectionSubtree GetSubtree(const std::size_t index) const;
+
   private:
+    struct TreeNode
+    {
+        GraphView graph;
+        std::uint64_t depth;
+    };
+
+    // Nodes at the subtree root depth are not bisected but left as subtrees
+    void Bisect(std::vector<TreeNode> forest, const std::uint64_t subtree_root_depth);
+
     BisectionGraph &bisection_graph;
     RecursiveBisectionState internal_state;
+
+    const std::size_t maximum_cell_size;
+    const double balance;
+    const double boundary_factor;
+    const std::size_t num_optimizing_cuts;
+    const MaxFlowAlgorithm max_flow;
+
+    std::vector<TreeNode> subtrees;
 };
 
+// Builds the bisection graph of a subtree, the node ids are the indices into the subtree
+BisectionGraph makeBisectionGraph(const BisectionSubtree &subtree);
+
 } // namespace partition
 } // namespace osrm
 
@@ -23,6 +23,11 @@ class RecursiveBisectionState
     using NodeIterator = BisectionGraph::ConstNodeIterator;
 
     RecursiveBisectionState(BisectionGraph &bisection_graph);
+    // Starts all nodes with the same bisection id, e.g. to continue the bisection of a subtree.
+    // The first scc_levels bits of the id are the component.
+    RecursiveBisectionState(BisectionGraph &bisection_graph,
+                            const BisectionID bisection_id,
+                            const std::uint32_t scc_levels);
     ~RecursiveBisectionState();
 
     BisectionID GetBisectionID(const NodeID node) const;
@@ -1,6 +1,7 @@
 #ifndef OSRM_PARTITION_RENUMBER_HPP
 #define OSRM_PARTITION_RENUMBER_HPP
 
+#include "extractor/conditional_turn_mask.hpp"
 #include "extractor/edge_based_node_segment.hpp"
 #include "extractor/node_data_container.hpp"
 
@@ -10,6 +11,9 @@
 #include "util/dynamic_graph.hpp"
 #include "util/static_graph.hpp"
 
+#include <algorithm>
+#include <tuple>
+
 namespace osrm
 {
 namespace partition
@@ -59,6 +63,20 @@ inline void renumber(util::vector_view<extractor::EdgeBasedNodeSegment> &segment
             segment.reverse_segment_id.id = permutation[segment.reverse_segment_id.id];
     }
 }
+
+inline void renumber(std::vector<extractor::ConditionalTurnMask> &masks,
+                     const std::vector<std::uint32_t> &permutation)
+{
+    for (auto &mask : masks)
+    {
+        mask.from = permutation[mask.from];
+        mask.to = permutation[mask.to];
+    }
+    // queries look the turns up by their nodes
+    std::sort(masks.begin(), masks.end(), [](const auto &lhs, const auto &rhs) {
+        return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+    });
+}
 }
 }
 
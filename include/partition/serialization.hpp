@@ -5,6 +5,7 @@
 #include "partition/edge_based_graph.hpp"
 #include "partition/multi_level_graph.hpp"
 #include "partition/multi_level_partition.hpp"
+#include "partition/recursive_bisection.hpp"
 
 #include "storage/io.hpp"
 #include "storage/serialization.hpp"
@@ -17,6 +18,26 @@ namespace partition
 namespace serialization
 {
 
+inline void read(storage::io::FileReader &reader, BisectionSubtree &subtree)
+{
+    reader.ReadInto(subtree.depth);
+    reader.ReadInto(subtree.bisection_id);
+    storage::serialization::read(reader, subtree.original_ids);
+    storage::serialization::read(reader, subtree.coordinates);
+    storage::serialization::read(reader, subtree.edge_offsets);
+    storage::serialization::read(reader, subtree.edge_targets);
+}
+
+inline void write(storage::io::FileWriter &writer, const BisectionSubtree &subtree)
+{
+    writer.WriteOne(subtree.depth);
+    writer.WriteOne(subtree.bisection_id);
+    storage::serialization::write(writer, subtree.original_ids);
+    storage::serialization::write(writer, subtree.coordinates);
+    storage::serialization::write(writer, subtree.edge_offsets);
+    storage::serialization::write(writer, subtree.edge_targets);
+}
+
 template <typename EdgeDataT, storage::Ownership Ownership>
 inline void read(storage::io::FileReader &reader, MultiLevelGraph<EdgeDataT, Ownership> &graph)
 {
@@ -56,18 +77,42 @@ inline void read(storage::io::FileReader &reader, detail::CellStorageImpl<Owners
 {
     storage::serialization::read(reader, storage.weights);
     storage::serialization::read(reader, storage.durations);
+    storage::serialization::read(reader, storage.distances);
+    storage::serialization::read(reader, storage.weight_codes);
+    storage::serialization::read(reader, storage.duration_codes);
+    storage::serialization::read(reader, storage.quantized_rows);
+    storage::serialization::read(reader, storage.quantized_exceptions);
     storage::serialization::read(reader, storage.source_boundary);
     storage::serialization::read(reader, storage.destination_boundary);
     storage::serialization::read(reader, storage.cells);
     storage::serialization::read(reader, storage.level_to_cell_offset);
 }
 
+// only reads the weights, durations, distances and their quantized codes, they come before the
+// cells
+template <storage::Ownership Ownership>
+inline void readMetric(storage::io::FileReader &reader, detail::CellStorageImpl<Ownership> &storage)
+{
+    storage::serialization::read(reader, storage.weights);
+    storage::serialization::read(reader, storage.durations);
+    storage::serialization::read(reader, storage.distances);
+    storage::serialization::read(reader, storage.weight_codes);
+    storage::serialization::read(reader, storage.duration_codes);
+    storage::serialization::read(reader, storage.quantized_rows);
+    storage::serialization::read(reader, storage.quantized_exceptions);
+}
+
 template <storage::Ownership Ownership>
 inline void write(storage::io::FileWriter &writer,
                   const detail::CellStorageImpl<Ownership> &storage)
 {
     storage::serialization::write(writer, storage.weights);
     storage::serialization::write(writer, storage.durations);
+    storage::serialization::write(writer, storage.distances);
+    storage::serialization::write(writer, storage.weight_codes);
+    storage::serialization::write(writer, storage.duration_codes);
+    storage::serialization::write(writer, storage.quantized_rows);
+    storage::serialization::write(writer, storage.quantized_exceptions);
     storage::serialization::write(writer, storage.source_boundary);
     storage::serialization::write(writer, storage.destination_boundary);
     storage::serialization::write(writer, storage.cells);
@@ -0,0 +1,117 @@
+#ifndef OSRM_PARTITION_SHARD_PLAN_HPP
+#define OSRM_PARTITION_SHARD_PLAN_HPP
+
+#include "partition/cell_storage.hpp"
+#include "partition/multi_level_partition.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace partition
+{
+
+// How the data would be split over shards along the cells of the highest level of the partition.
+// A shard owns a run of consecutive top level cells, the recursive bisection numbers cells that
+// are close to each other consecutively. A shard needs the base graph of its cells only, the
+// overlay of the boundary nodes and cell metrics is shared by all shards.
+struct ShardPlan
+{
+    // the shard of every top level cell
+    std::vector<std::uint32_t> cell_to_shard;
+    // base graph nodes and edges of every shard
+    std::vector<std::size_t> shard_nodes;
+    std::vector<std::size_t> shard_edges;
+    // boundary nodes of the top level cells, every shard keeps them
+    std::size_t overlay_nodes = 0;
+    std::size_t overlay_cell_storage_bytes = 0;
+};
+
+// Assigns the top level cells to shards with about the same number of edges,
+// throws if there are fewer top level cells than shards
+template <typename GraphT>
+ShardPlan planShards(const MultiLevelPartition &partition,
+                     const CellStorage &storage,
+                     const GraphT &graph,
+                     const std::uint32_t number_of_shards)
+{
+    const auto number_of_levels = partition.GetNumberOfLevels();
+    const LevelID top_level = number_of_levels - 1;
+    const auto number_of_cells = number_of_levels > 1 ? partition.GetNumberOfCells(top_level) : 1;
+    if (number_of_shards == 0 || number_of_shards > number_of_cells)
+    {
+        throw util::exception("Can't split " + std::to_string(number_of_cells) +
+                              " top level cells into " + std::to_string(number_of_shards) +
+                              " shards" + SOURCE_REF);
+    }
+
+    const auto cell_of = [&](const NodeID node) {
+        return number_of_levels > 1 ? partition.GetCell(top_level, node) : 0;
+    };
+
+    std::vector<std::size_t> cell_nodes(number_of_cells, 0);
+    std::vector<std::size_t> cell_edges(number_of_cells, 0);
+    std::size_t total_edges = 0;
+    for (const NodeID node : util::irange<NodeID>(0, graph.GetNumberOfNodes()))
+    {
+        cell_nodes[cell_of(node)]++;
+        cell_edges[cell_of(node)] += graph.GetOutDegree(node);
+        total_edges += graph.GetOutDegree(node);
+    }
+
+    ShardPlan plan;
+    plan.cell_to_shard.resize(number_of_cells);
+    plan.shard_nodes.resize(number_of_shards, 0);
+    plan.shard_edges.resize(number_of_shards, 0);
+
+    // a shard ends once it reached its share of the edges, or when the cells left are needed
+    // to give every following shard one
+    std::uint32_t shard = 0;
+    std::size_t assigned_edges = 0;
+    for (const CellID cell : util::irange<CellID>(0, number_of_cells))
+    {
+        plan.cell_to_shard[cell] = shard;
+        plan.shard_nodes[shard] += cell_nodes[cell];
+        plan.shard_edges[shard] += cell_edges[cell];
+        assigned_edges += cell_edges[cell];
+
+        const auto cells_left = number_of_cells - cell - 1;
+        const auto shards_left = number_of_shards - shard - 1;
+        if (shards_left > 0 &&
+            (assigned_edges * number_of_shards >= (shard + 1) * total_edges ||
+             cells_left == shards_left))
+        {
+            ++shard;
+        }
+    }
+
+    if (number_of_levels > 1)
+    {
+        std::vector<bool> is_boundary(graph.GetNumberOfNodes(), false);
+        for (const CellID cell : util::irange<CellID>(0, number_of_cells))
+        {
+            const auto data = storage.GetCell(top_level, cell);
+            for (const auto node : data.GetSourceNodes())
+                is_boundary[node] = true;
+            for (const auto node : data.GetDestinationNodes())
+                is_boundary[node] = true;
+        }
+        plan.overlay_nodes = std::count(is_boundary.begin(), is_boundary.end(), true);
+    }
+    plan.overlay_cell_storage_bytes = storage.GetMemorySize();
+
+    return plan;
+}
+}
+}
+
+#endif
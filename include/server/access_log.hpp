@@ -0,0 +1,94 @@
+#ifndef SERVER_ACCESS_LOG_HPP
+#define SERVER_ACCESS_LOG_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+// The fields of an access log line, formatted by the writer thread
+struct AccessRecord
+{
+    std::time_t time = 0;
+    double duration_ms = 0;
+    std::string endpoint;
+    std::string referrer;
+    std::string agent;
+    unsigned status = 0;
+    std::string request;
+};
+
+// Formats a record as the access log line of osrm-routed, without the log level prefix:
+//   DD-MM-YYYY HH:MM:SS <duration>ms <endpoint> <referrer or -> <agent or -> <status> <request>
+std::string formatAccessRecord(const AccessRecord &record);
+
+// Writes the access log on a thread of its own so the request threads neither format the lines
+// nor wait for the lock of util::Log. Every thread that logs gets a ring buffer that only it
+// writes and the writer thread reads, a record that does not fit into a full ring is dropped and
+// counted.
+class AccessLog
+{
+  public:
+    using Sink = std::function<void(const std::string &line)>;
+
+    // The default sink writes the lines with util::Log
+    explicit AccessLog(const std::size_t records_per_thread = 4096, Sink sink = {});
+    // Writes the records that are still buffered
+    ~AccessLog();
+
+    AccessLog(const AccessLog &) = delete;
+    AccessLog &operator=(const AccessLog &) = delete;
+
+    // Thread safe, never blocks on other request threads
+    void Log(AccessRecord record);
+
+    std::uint64_t GetDroppedRecords() const { return dropped; }
+
+  private:
+    // Single producer, single consumer
+    struct Ring
+    {
+        explicit Ring(const std::size_t capacity) : records(capacity) {}
+
+        std::vector<AccessRecord> records;
+        std::atomic<std::size_t> head{0};
+        std::atomic<std::size_t> tail{0};
+    };
+
+    Ring &GetThreadRing();
+    // Writes the buffered records, returns false if there were none
+    bool Drain();
+    void Run();
+
+    const std::size_t records_per_thread;
+    const std::uint64_t id;
+    Sink sink;
+    std::atomic<std::uint64_t> dropped{0};
+    std::uint64_t reported_dropped = 0;
+
+    std::mutex rings_mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::unordered_map<std::thread::id, Ring *> thread_rings;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    bool stop = false;
+    std::thread writer;
+};
+}
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef SERVER_ADMISSION_CONTROL_HPP
+#define SERVER_ADMISSION_CONTROL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace api
+{
+struct ParsedURL;
+}
+
+// Estimates the cost of a request by the number of coordinates it contains, without parsing
+// the parameters. Encoded polylines are approximated by their length.
+std::size_t EstimateRequestCost(const api::ParsedURL &parsed_url);
+
+// Bounds the work every service may have in flight. Each service gets a cost budget that is
+// shared by all concurrently running requests. Requests that do not fit wait in a bounded
+// queue for a limited time, after that (or if the queue is full) they are rejected so that
+// the server can answer with 503 instead of piling up work.
+//
+// Limits have to be configured before the server starts, services without limits are never
+// throttled.
+class AdmissionControl
+{
+    struct ServiceQueue;
+
+  public:
+    struct Limits
+    {
+        // max. summed cost of all running requests of the service
+        std::size_t max_cost;
+        // max. number of requests waiting for budget
+        std::size_t max_queued;
+        // max. time a request waits for budget
+        std::chrono::milliseconds max_wait;
+    };
+
+    class Ticket
+    {
+      public:
+        Ticket() = default;
+        Ticket(Ticket &&other) noexcept;
+        Ticket &operator=(Ticket &&other) noexcept;
+        Ticket(const Ticket &) = delete;
+        Ticket &operator=(const Ticket &) = delete;
+        ~Ticket();
+
+        bool IsAdmitted() const { return admitted; }
+
+      private:
+        friend class AdmissionControl;
+
+        void Release();
+
+        ServiceQueue *queue = nullptr;
+        std::size_t cost = 0;
+        bool admitted = false;
+    };
+
+    void SetLimits(const std::string &service, const Limits &limits);
+
+    // Blocks until the request fits into the service budget, or rejects it.
+    Ticket Admit(const std::string &service, std::size_t cost);
+
+  private:
+    std::unordered_map<std::string, std::unique_ptr<ServiceQueue>> queues;
+};
+
+struct AdmissionControl::ServiceQueue
+{
+    explicit ServiceQueue(const Limits &limits) : limits(limits) {}
+
+    const Limits limits;
+    std::mutex mutex;
+    std::condition_variable budget_released;
+    std::size_t running_cost = 0;
+    std::size_t num_queued = 0;
+};
+}
+}
+
+#endif
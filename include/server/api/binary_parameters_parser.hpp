@@ -0,0 +1,76 @@
+#ifndef SERVER_API_BINARY_PARAMETERS_PARSER_HPP
+#define SERVER_API_BINARY_PARAMETERS_PARSER_HPP
+
+#include "engine/api/base_parameters.hpp"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+// Content-Type of POST bodies that carry the coordinates of a query in binary form
+constexpr char BINARY_PARAMETERS_CONTENT_TYPE[] = "application/x-osrm-coordinates";
+
+// Optional sections of a binary body, in the order they follow the coordinates
+enum BinaryParametersSection : std::uint32_t
+{
+    BINARY_RADIUSES = 1 << 0,
+    BINARY_BEARINGS = 1 << 1,
+    BINARY_HINTS = 1 << 2
+};
+
+// Decodes the coordinates and per coordinate options of a query from a binary request body.
+// All values are little-endian, for n coordinates the body is laid out as:
+//
+//   uint32 n, uint32 sections               bitmask of BinaryParametersSection
+//   n x (int32 lon, int32 lat)              fixed-point, like util::Coordinate
+//   n x float64 radius                      if BINARY_RADIUSES, NaN for no radius
+//   n x (int16 bearing, int16 range)        if BINARY_BEARINGS, negative bearing for none
+//   n x 68 byte hint                        if BINARY_HINTS, the base64 decoded hint, all
+//                                            zero for none
+//
+// The coordinates are copied as is, there is no text to parse. Returns boost::none if the
+// body size does not match the announced sections.
+boost::optional<engine::api::BaseParameters> parseBinaryParameters(const std::string &body);
+
+// Content-Type of POST bodies that carry a batch of traces to match in binary form
+constexpr char BINARY_TRACES_CONTENT_TYPE[] = "application/x-osrm-traces";
+
+// Optional sections of every trace of a batch, following its coordinates body
+enum BinaryTracesSection : std::uint32_t
+{
+    BINARY_TIMESTAMPS = 1 << 0
+};
+
+// A trace of a batch, with the timestamps of its coordinates if the batch has timestamps
+struct BinaryTrace
+{
+    engine::api::BaseParameters parameters;
+    std::vector<unsigned> timestamps;
+};
+
+// Decodes the traces of a batch from a binary request body. All values are little-endian, for
+// m traces the body is laid out as:
+//
+//   uint32 m, uint32 sections               bitmask of BinaryTracesSection
+//   m x trace:
+//     uint32 size                           of the coordinates body that follows
+//     size bytes                            the coordinates, see parseBinaryParameters
+//     n x uint32 timestamp                  if BINARY_TIMESTAMPS, for the n coordinates
+//
+// Returns boost::none if a trace does not fit into the body or the body does not end with
+// the last trace.
+boost::optional<std::vector<BinaryTrace>> parseBinaryTraces(const std::string &body);
+}
+}
+}
+
+#endif
@@ -43,6 +43,37 @@ boost::optional<ParameterT> parseParameters(std::string options_string)
     return parseParameters<ParameterT>(first, last);
 }
 
+// Like parseParameters but without the coordinates part: [.json][?option(&option)*]
+template <typename ParameterT,
+          typename std::enable_if<std::is_base_of<engine::api::BaseParameters, ParameterT>::value,
+                                  int>::type = 0>
+boost::optional<ParameterT> parseOptions(std::string::iterator &iter,
+                                         const std::string::iterator end);
+
+// Parses the options of a query whose coordinates, hints, radiuses and bearings were sent
+// in a binary request body, see parseBinaryParameters. Sections of the body replace the
+// corresponding options of the query.
+template <typename ParameterT,
+          typename std::enable_if<std::is_base_of<engine::api::BaseParameters, ParameterT>::value,
+                                  int>::type = 0>
+boost::optional<ParameterT> parseParameters(std::string::iterator &iter,
+                                            const std::string::iterator end,
+                                            engine::api::BaseParameters &&body_parameters)
+{
+    auto parameters = parseOptions<ParameterT>(iter, end);
+    if (parameters)
+    {
+        parameters->coordinates = std::move(body_parameters.coordinates);
+        if (!body_parameters.hints.empty())
+            parameters->hints = std::move(body_parameters.hints);
+        if (!body_parameters.radiuses.empty())
+            parameters->radiuses = std::move(body_parameters.radiuses);
+        if (!body_parameters.bearings.empty())
+            parameters->bearings = std::move(body_parameters.bearings);
+    }
+    return parameters;
+}
+
 } // ns api
 } // ns server
 } // ns osrm
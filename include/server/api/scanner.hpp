@@ -0,0 +1,389 @@
+#ifndef SERVER_API_SCANNER_HPP
+#define SERVER_API_SCANNER_HPP
+
+#include "util/string_view.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+// Raised at the points where the input can not be valid anymore, e.g. a parameter name was
+// followed by a malformed value. Carries the position that is reported back to the client.
+struct ScanError
+{
+    std::string::iterator position;
+};
+
+// Minimal single pass scanner used by the URL and query parameter parsers.
+//
+// All Parse* / Skip* functions are "soft": they return false and leave the position untouched if
+// the input does not match. Expect() turns a soft failure into a ScanError at the current
+// position, which mirrors the expectation points of the spirit grammars we replaced.
+class Scanner
+{
+  public:
+    using Iterator = std::string::iterator;
+
+    Scanner(Iterator begin, Iterator end) : position(begin), end(end) {}
+
+    Iterator Position() const { return position; }
+    void Rewind(const Iterator to) { position = to; }
+    bool AtEnd() const { return position == end; }
+    char Peek() const { return *position; }
+
+    void Expect(const bool matched) const
+    {
+        if (!matched)
+        {
+            throw ScanError{position};
+        }
+    }
+
+    bool SkipChar(const char expected)
+    {
+        if (position != end && *position == expected)
+        {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    template <std::size_t N> bool SkipLiteral(const char (&literal)[N])
+    {
+        return SkipLiteral(literal, N - 1);
+    }
+
+    bool SkipLiteral(const char *literal, const std::size_t length)
+    {
+        if (static_cast<std::size_t>(end - position) < length ||
+            std::memcmp(&*position, literal, length) != 0)
+        {
+            return false;
+        }
+        position += length;
+        return true;
+    }
+
+    // Appends the longest non-empty run of characters accepted by the predicate
+    template <typename Predicate> bool ParseRun(Predicate predicate, std::string &output)
+    {
+        util::StringView run;
+        if (!ParseRun(predicate, run))
+        {
+            return false;
+        }
+        output.append(run.begin(), run.end());
+        return true;
+    }
+
+    // Same as above, but points into the input instead of copying the run
+    template <typename Predicate> bool ParseRun(Predicate predicate, util::StringView &run)
+    {
+        auto run_end = position;
+        while (run_end != end && predicate(*run_end))
+        {
+            ++run_end;
+        }
+        if (run_end == position)
+        {
+            return false;
+        }
+        run = util::StringView(&*position, run_end - position);
+        position = run_end;
+        return true;
+    }
+
+    // Exactly `count` characters accepted by the predicate, more may follow
+    template <typename Predicate>
+    bool ParseFixed(Predicate predicate, const std::size_t count, std::string &output)
+    {
+        if (static_cast<std::size_t>(end - position) < count)
+        {
+            return false;
+        }
+        for (auto iter = position; iter != position + count; ++iter)
+        {
+            if (!predicate(*iter))
+            {
+                return false;
+            }
+        }
+        output.assign(position, position + count);
+        position += count;
+        return true;
+    }
+
+    bool ParseBool(bool &value)
+    {
+        if (SkipLiteral("true"))
+        {
+            value = true;
+            return true;
+        }
+        if (SkipLiteral("false"))
+        {
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    // Decimal number without sign, fails on overflow
+    template <typename T> bool ParseUnsigned(T &value)
+    {
+        static_assert(std::is_unsigned<T>::value, "use ParseSigned for signed types");
+        auto iter = position;
+        T result = 0;
+        for (; iter != end && IsDigit(*iter); ++iter)
+        {
+            const T digit = *iter - '0';
+            if (result > (std::numeric_limits<T>::max() - digit) / 10)
+            {
+                return false;
+            }
+            result = result * 10 + digit;
+        }
+        if (iter == position)
+        {
+            return false;
+        }
+        value = result;
+        position = iter;
+        return true;
+    }
+
+    // Decimal number with an optional sign, fails on overflow
+    template <typename T> bool ParseSigned(T &value)
+    {
+        static_assert(std::is_signed<T>::value, "use ParseUnsigned for unsigned types");
+        auto iter = position;
+        const bool negative = iter != end && *iter == '-';
+        if (iter != end && (*iter == '-' || *iter == '+'))
+        {
+            ++iter;
+        }
+        const auto digits_begin = iter;
+        // accumulate towards the sign so the most negative value does not overflow
+        T result = 0;
+        for (; iter != end && IsDigit(*iter); ++iter)
+        {
+            const T digit = *iter - '0';
+            if (negative)
+            {
+                if (result < (std::numeric_limits<T>::min() + digit) / 10)
+                    return false;
+                result = result * 10 - digit;
+            }
+            else
+            {
+                if (result > (std::numeric_limits<T>::max() - digit) / 10)
+                    return false;
+                result = result * 10 + digit;
+            }
+        }
+        if (iter == digits_begin)
+        {
+            return false;
+        }
+        value = result;
+        position = iter;
+        return true;
+    }
+
+    enum class RealFormat
+    {
+        // plain decimal numbers, a dot followed by "json" belongs to the ".json" suffix
+        Coordinate,
+        // additionally accepts exponents, nan and inf(inity)
+        Generic
+    };
+
+    // Shares the accepted syntax with spirit's real parsers: optional sign, leading and trailing
+    // dots are allowed as long as there is at least one digit.
+    bool ParseReal(double &value, const RealFormat format)
+    {
+        auto iter = position;
+        const bool negative = iter != end && *iter == '-';
+        if (iter != end && (*iter == '-' || *iter == '+'))
+        {
+            ++iter;
+        }
+
+        double accumulator = 0;
+        bool has_integer_digits = false;
+        for (; iter != end && IsDigit(*iter); ++iter)
+        {
+            accumulator = accumulator * 10 + (*iter - '0');
+            has_integer_digits = true;
+        }
+
+        if (!has_integer_digits && format == RealFormat::Generic &&
+            ParseNonFinite(iter, accumulator))
+        {
+            value = negative ? -accumulator : accumulator;
+            position = iter;
+            return true;
+        }
+
+        int exponent = 0;
+        const bool has_dot = iter != end && *iter == '.' &&
+                             !(format == RealFormat::Coordinate && end - iter > 4 &&
+                               std::memcmp(&*(iter + 1), "json", 4) == 0);
+        if (has_dot)
+        {
+            ++iter;
+            for (; iter != end && IsDigit(*iter); ++iter)
+            {
+                accumulator = accumulator * 10 + (*iter - '0');
+                --exponent;
+            }
+            if (!has_integer_digits && exponent == 0)
+            {
+                return false;
+            }
+        }
+        else if (!has_integer_digits)
+        {
+            return false;
+        }
+
+        if (format == RealFormat::Generic && iter != end && (*iter == 'e' || *iter == 'E'))
+        {
+            // an exponent marker without digits is not part of the number
+            Scanner exponent_scanner(iter + 1, end);
+            int explicit_exponent;
+            if (exponent_scanner.ParseSigned(explicit_exponent))
+            {
+                if (explicit_exponent > std::numeric_limits<double>::max_exponent10 + exponent)
+                {
+                    return false;
+                }
+                exponent += explicit_exponent;
+                iter = exponent_scanner.Position();
+            }
+        }
+
+        if (exponent > 0)
+        {
+            accumulator *= PowerOfTen(exponent);
+        }
+        else if (exponent < 0)
+        {
+            accumulator /= PowerOfTen(-exponent);
+        }
+
+        value = negative ? -accumulator : accumulator;
+        position = iter;
+        return true;
+    }
+
+    // Longest match from a table of {name, value} pairs
+    template <typename T, std::size_t N>
+    bool ParseSymbol(const std::pair<const char *, T> (&symbols)[N], T &value)
+    {
+        std::size_t best_length = 0;
+        for (const auto &symbol : symbols)
+        {
+            const auto length = std::strlen(symbol.first);
+            if (length > best_length && static_cast<std::size_t>(end - position) >= length &&
+                std::memcmp(&*position, symbol.first, length) == 0)
+            {
+                best_length = length;
+                value = symbol.second;
+            }
+        }
+        position += best_length;
+        return best_length > 0;
+    }
+
+    static bool IsDigit(const char c) { return c >= '0' && c <= '9'; }
+
+    static bool IsAlphaNumeral(const char c)
+    {
+        return IsDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    static int HexValue(const char c)
+    {
+        if (IsDigit(c))
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+  private:
+    static double PowerOfTen(const int exponent)
+    {
+        // exactly representable, covers every coordinate and radius we see in practice
+        static constexpr double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                            1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        if (exponent < static_cast<int>(sizeof(powers) / sizeof(powers[0])))
+        {
+            return powers[exponent];
+        }
+        return std::pow(10., exponent);
+    }
+
+    bool ParseNonFinite(Iterator &iter, double &value) const
+    {
+        const auto skip_caseless = [this](Iterator &current, const char *lower) {
+            auto probe = current;
+            for (; *lower; ++lower, ++probe)
+            {
+                if (probe == end || (*probe | 0x20) != *lower)
+                    return false;
+            }
+            current = probe;
+            return true;
+        };
+
+        auto probe = iter;
+        if (skip_caseless(probe, "nan"))
+        {
+            // nan(...) carries an optional payload we ignore
+            if (probe != end && *probe == '(')
+            {
+                auto closing = probe;
+                while (++closing != end && *closing != ')')
+                    ;
+                if (closing == end)
+                    return false;
+                probe = closing + 1;
+            }
+            value = std::numeric_limits<double>::quiet_NaN();
+            iter = probe;
+            return true;
+        }
+        if (skip_caseless(probe, "inf"))
+        {
+            skip_caseless(probe, "inity");
+            value = std::numeric_limits<double>::infinity();
+            iter = probe;
+            return true;
+        }
+        return false;
+    }
+
+    Iterator position;
+    const Iterator end;
+};
+}
+}
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "server/api/base_parameters_grammar.hpp"
 #include "engine/api/table_parameters.hpp"
 
+#include <boost/fusion/include/std_pair.hpp>
 #include <boost/spirit/include/phoenix.hpp>
 #include <boost/spirit/include/qi.hpp>
 
@@ -48,7 +49,33 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
             (qi::lit("all") |
              (size_t_ % ';')[ph::bind(&engine::api::TableParameters::sources, qi::_r1) = qi::_1]);
 
-        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1);
+        using AnnotationsType = engine::api::TableParameters::AnnotationsType;
+
+        // the listed annotations replace the default of durations only
+        const auto set_annotations = [](engine::api::TableParameters &table_parameters,
+                                        const std::vector<AnnotationsType> &annotations) {
+            table_parameters.annotations = AnnotationsType::None;
+            for (const auto annotation : annotations)
+            {
+                table_parameters.annotations = table_parameters.annotations | annotation;
+            }
+        };
+
+        annotations_type.add("duration", AnnotationsType::Duration)("distance",
+                                                                    AnnotationsType::Distance);
+
+        annotations_rule =
+            qi::lit("annotations=") >
+            (annotations_type % ',')[ph::bind(set_annotations, qi::_r1, qi::_1)];
+
+        path_ = size_t_ > ',' > size_t_;
+
+        paths_rule =
+            qi::lit("paths=") >
+            (path_ % ';')[ph::bind(&engine::api::TableParameters::paths, qi::_r1) = qi::_1];
+
+        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1) |
+                     annotations_rule(qi::_r1) | paths_rule(qi::_r1);
 
         root_rule = BaseGrammar::query_rule(qi::_r1) > -qi::lit(".json") >
                     -('?' > (table_rule(qi::_r1) | BaseGrammar::base_rule(qi::_r1)) % '&');
@@ -59,7 +86,11 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
     qi::rule<Iterator, Signature> table_rule;
     qi::rule<Iterator, Signature> sources_rule;
     qi::rule<Iterator, Signature> destinations_rule;
+    qi::rule<Iterator, Signature> annotations_rule;
+    qi::rule<Iterator, Signature> paths_rule;
     qi::rule<Iterator, std::size_t()> size_t_;
+    qi::rule<Iterator, std::pair<std::size_t, std::size_t>()> path_;
+    qi::symbols<char, engine::api::TableParameters::AnnotationsType> annotations_type;
 };
 }
 }
@@ -2,6 +2,7 @@
 #define CONNECTION_HPP
 
 #include "server/http/compression_type.hpp"
+#include "server/http/compressor.hpp"
 #include "server/http/reply.hpp"
 #include "server/http/request.hpp"
 #include "server/request_parser.hpp"
@@ -12,6 +13,7 @@
 #include <boost/version.hpp>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 // workaround for incomplete std::shared_ptr compatibility in old boost versions
@@ -33,15 +35,19 @@ namespace server
 
 class RequestHandler;
 
-/// Represents a single connection from a client.
+/// Represents a single connection from a client, over TCP or a unix domain socket.
 class Connection : public std::enable_shared_from_this<Connection>
 {
   public:
-    explicit Connection(boost::asio::io_service &io_service, RequestHandler &handler);
+    explicit Connection(boost::asio::io_service &io_service,
+                        RequestHandler &handler,
+                        const unsigned keepalive_timeout,
+                        const unsigned keepalive_max_requests,
+                        const http::compression_levels compression_levels = {});
     Connection(const Connection &) = delete;
     Connection &operator=(const Connection &) = delete;
 
-    boost::asio::ip::tcp::socket &socket();
+    boost::asio::generic::stream_protocol::socket &socket();
 
     /// Start the first asynchronous operation for the connection.
     void start();
@@ -49,21 +55,55 @@ class Connection : public std::enable_shared_from_this<Connection>
   private:
     void handle_read(const boost::system::error_code &e, std::size_t bytes_transferred);
 
+    /// Parses the buffered range [begin, end) and either answers a complete request or
+    /// continues reading from the socket.
+    void handle_request(char *begin, char *end);
+
+    /// Adds the connection headers to the complete reply, compresses and sends it.
+    void handle_reply();
+
     /// Handle completion of a write operation.
     void handle_write(const boost::system::error_code &e);
 
-    std::vector<char> compress_buffers(const std::vector<char> &uncompressed_data,
-                                       const http::compression_type compression_type);
+    /// Continues reading the request body once '100 Continue' was sent.
+    void handle_continue_write(const boost::system::error_code &e);
+
+    /// Compresses and sends the next chunk of a chunked reply, or finishes the reply.
+    void handle_chunk_write(const boost::system::error_code &e);
+
+    /// Sends the next piece of a streamed reply as a chunk once it was produced.
+    void handle_stream_write(const boost::system::error_code &e);
+
+    /// Closes idle persistent connections once the keep-alive timeout expired.
+    void handle_timeout(const boost::system::error_code &e);
+
+    void handle_shutdown();
 
     boost::asio::io_service::strand strand;
-    boost::asio::ip::tcp::socket TCP_socket;
+    boost::asio::generic::stream_protocol::socket stream_socket;
+    boost::asio::deadline_timer timer;
     RequestHandler &request_handler;
     RequestParser request_parser;
     boost::array<char, 8192> incoming_data_buffer;
+    // unparsed bytes of pipelined requests that followed the current one in the read buffer
+    char *pipelined_begin;
+    char *pipelined_end;
+    const unsigned keepalive_timeout;
+    const unsigned keepalive_max_requests;
+    unsigned processed_requests;
+    bool keep_alive;
     http::request current_request;
     http::reply current_reply;
+    http::compression_type reply_compression_type;
+    // compressed replies are streamed in chunks of at most this size
+    static const constexpr std::size_t MAX_CHUNK_SIZE = 64 * 1024;
+    http::compressor compressor;
     std::vector<char> compressed_output;
-    // Header compression_header;
+    std::string chunk_header;
+    // piece of a streamed reply that is being sent
+    std::vector<char> stream_piece;
+    // size of the reply body as written to the socket, for metrics
+    std::size_t sent_body_bytes;
     std::vector<boost::asio::const_buffer> output_buffer;
 };
 }
@@ -0,0 +1,63 @@
+#ifndef BODY_STREAM_HPP
+#define BODY_STREAM_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace http
+{
+
+// The body of a reply that is sent while it is produced. The producer writes pieces from its
+// thread, the connection reads them on its strand and sends each piece as a chunk. The producer
+// blocks while max_pieces are waiting to be sent, so the memory of a reply depends on the size
+// of its pieces instead of the size of the body.
+class body_stream
+{
+  public:
+    enum class read_result
+    {
+        piece,
+        pending,
+        finished,
+        failed
+    };
+
+    // 0 never blocks the producer, for producers that run on the threads of the connection
+    explicit body_stream(const std::size_t max_pieces);
+
+    // Queues the piece and takes its buffer, false once the connection gave up on the reply
+    bool write(std::vector<char> &piece);
+
+    // No more pieces follow, a body that did not succeed is cut off instead of completed
+    void finish(const bool succeeded);
+
+    // Takes the next piece. If there is none yet, ready is called once there is one or the body
+    // ended, from the thread of the producer.
+    read_result read(std::vector<char> &piece, std::function<void()> ready);
+
+    // The client is gone, the waiting and all further pieces are dropped
+    void cancel();
+
+  private:
+    const std::size_t max_pieces;
+    std::mutex mutex;
+    std::condition_variable space_available;
+    std::deque<std::vector<char>> pieces;
+    std::function<void()> ready;
+    bool finished;
+    bool succeeded;
+    bool cancelled;
+};
+}
+}
+}
+
+#endif // BODY_STREAM_HPP
@@ -12,7 +12,17 @@ enum compression_type
 {
     no_compression,
     gzip_rfc1952,
-    deflate_rfc1951
+    deflate_rfc1951,
+    brotli_rfc7932,
+    zstd_rfc8478
+};
+
+// Per codec compression levels, the defaults trade size for speed
+struct compression_levels
+{
+    int zlib = 1;   // Z_BEST_SPEED
+    int brotli = 4; // 0 - 11
+    int zstd = 3;   // 1 - 22
 };
 }
 }
@@ -0,0 +1,80 @@
+#ifndef COMPRESSOR_HPP
+#define COMPRESSOR_HPP
+
+#include "server/http/compression_type.hpp"
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifdef USE_BROTLI_LIBRARY
+struct BrotliEncoderStateStruct;
+#endif
+#ifdef USE_ZSTD_LIBRARY
+struct ZSTD_CCtx_s;
+#endif
+
+namespace osrm
+{
+namespace server
+{
+namespace http
+{
+
+// Returns true if support for the compression type was compiled in.
+bool is_supported(const compression_type type);
+
+// Value of the Content-Encoding header for the compression type.
+const char *content_encoding(const compression_type type);
+
+// Picks the best supported codec from an Accept-Encoding header value. Codecs with a higher
+// q-value win, ties are broken in the order br, zstd, gzip, deflate.
+compression_type negotiate_compression(const std::string &accept_encoding);
+
+// Incremental compressor for all supported content encodings. Codec state is kept between
+// replies and only reset, so persistent connections do not re-allocate it.
+class compressor
+{
+  public:
+    explicit compressor(const compression_levels levels = {});
+    ~compressor();
+    compressor(const compressor &) = delete;
+    compressor &operator=(const compressor &) = delete;
+
+    // Prepares compressing input. The input has to stay valid until the stream is finished.
+    // Returns false if the codec could not be initialized for the requested type.
+    bool reset(const compression_type type, const std::vector<char> &input);
+
+    // Replaces output with the next compressed chunk of at most max_chunk_size bytes.
+    // Returns true once all input was compressed and the stream trailer was written.
+    bool compress_chunk(std::vector<char> &output, const std::size_t max_chunk_size);
+
+    // Compresses all remaining input and appends it to output.
+    void compress_all(std::vector<char> &output);
+
+  private:
+    // compresses into [output, output + capacity) and reports the number of bytes written
+    bool compress(char *output, const std::size_t capacity, std::size_t &written);
+
+    compression_levels levels;
+    compression_type type;
+    const char *input_begin;
+    const char *input_end;
+
+    z_stream zlib_stream;
+    int zlib_window_bits;
+    bool zlib_initialized;
+#ifdef USE_BROTLI_LIBRARY
+    BrotliEncoderStateStruct *brotli_state;
+#endif
+#ifdef USE_ZSTD_LIBRARY
+    ZSTD_CCtx_s *zstd_context;
+#endif
+};
+}
+}
+}
+
+#endif // COMPRESSOR_HPP
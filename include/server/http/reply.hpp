@@ -1,10 +1,13 @@
 #ifndef REPLY_HPP
 #define REPLY_HPP
 
+#include "server/http/body_stream.hpp"
 #include "server/http/header.hpp"
 
 #include <boost/asio.hpp>
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -21,16 +24,23 @@ class reply
     {
         ok = 200,
         bad_request = 400,
-        internal_server_error = 500
+        internal_server_error = 500,
+        service_unavailable = 503
     } status;
 
     std::vector<header> headers;
     std::vector<boost::asio::const_buffer> to_buffers();
     std::vector<boost::asio::const_buffer> headers_to_buffers();
     std::vector<char> content;
+    // set instead of the content if the body is sent in chunks while it is produced
+    std::shared_ptr<body_stream> stream;
+    // name of the service that produced the reply, only used for metrics
+    std::string service;
     static reply stock_reply(const status_type status);
     void set_size(const std::size_t size);
     void set_uncompressed_size();
+    // resets status and headers but keeps the allocated content buffer for reuse
+    void clear();
 
     reply();
 
@@ -1,6 +1,7 @@
 #ifndef REQUEST_HPP
 #define REQUEST_HPP
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/asio.hpp>
 
 #include <string>
@@ -14,10 +15,31 @@ namespace http
 
 struct request
 {
+    std::string method;
     std::string uri;
     std::string referrer;
     std::string agent;
+    std::string connection;
+    std::string timeout;
+    std::string content_type;
+    // only filled for requests that announced a Content-Length
+    std::string body;
+    // the client waits for '100 Continue' before it sends the body
+    bool expect_continue = false;
+    unsigned http_version_major = 1;
+    unsigned http_version_minor = 0;
     boost::asio::ip::address endpoint;
+
+    // HTTP/1.1 connections are persistent unless the client asks us to close them,
+    // HTTP/1.0 clients have to explicitly opt in via 'Connection: keep-alive'.
+    bool keep_alive() const
+    {
+        if (http_version_major > 1 || (http_version_major == 1 && http_version_minor >= 1))
+        {
+            return !boost::icontains(connection, "close");
+        }
+        return boost::icontains(connection, "keep-alive");
+    }
 };
 }
 }
@@ -0,0 +1,91 @@
+#ifndef SERVER_METRICS_HPP
+#define SERVER_METRICS_HPP
+
+#include "engine/engine_statistics.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+// Per-service request metrics exported in the Prometheus text format.
+//
+// All counters are relaxed atomics split into cache-line sized shards. Every thread writes to
+// its own shard, so recording a request never takes a lock and rarely shares a cache line with
+// another thread. Shards are only summed up when the metrics are rendered.
+class Metrics
+{
+  public:
+    enum class RequestStatus : std::uint8_t
+    {
+        Ok,
+        Error,
+        Rejected
+    };
+
+    // Upper bounds of the latency histogram buckets in milliseconds, an implicit +Inf bucket
+    // catches everything above.
+    static const constexpr std::array<std::uint32_t, 13> LATENCY_BUCKETS_MS = {
+        {1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000}};
+
+    // Requests for services not in the list are accounted as 'other'.
+    explicit Metrics(std::vector<std::string> service_names);
+    ~Metrics();
+
+    // Index of the service used by the recording functions below.
+    std::size_t ServiceIndex(const std::string &service) const;
+
+    void RequestStarted(const std::size_t service);
+    void RequestFinished(const std::size_t service,
+                         const RequestStatus status,
+                         const std::chrono::steady_clock::duration duration);
+    void ReplySent(const std::size_t service,
+                   const std::size_t content_bytes,
+                   const std::size_t sent_bytes);
+
+    std::string RenderPrometheus() const;
+    // The cache counters of the engine, labeled by cache
+    static std::string RenderPrometheus(const engine::EngineStatistics &statistics);
+
+  private:
+    enum Counter
+    {
+        REQUESTS_OK,
+        REQUESTS_ERROR,
+        REQUESTS_REJECTED,
+        IN_FLIGHT,
+        LATENCY_SUM_US,
+        CONTENT_BYTES,
+        SENT_BYTES,
+        LATENCY_BUCKET_BEGIN,
+        NUM_REQUEST_STATUS = REQUESTS_REJECTED - REQUESTS_OK + 1,
+        NUM_COUNTERS = LATENCY_BUCKET_BEGIN + LATENCY_BUCKETS_MS.size() + 1
+    };
+
+    static const constexpr std::size_t NUM_SHARDS = 16;
+
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<std::int64_t>, NUM_COUNTERS> counters;
+    };
+
+    std::atomic<std::int64_t> &Get(const std::size_t service, const Counter counter);
+    std::int64_t Sum(const std::size_t service, const std::size_t counter) const;
+
+    std::vector<std::string> service_names;
+    // NUM_SHARDS shards for every service, allocated once
+    std::unique_ptr<Shard[]> shards;
+};
+}
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef SERVER_QUERY_LOG_HPP
+#define SERVER_QUERY_LOG_HPP
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace osrm
+{
+namespace server
+{
+
+// A request as osrm-routed received it. The decoded URL and the body are what the parsers see,
+// so replaying them reproduces the parsed parameters.
+struct QueryRecord
+{
+    // microseconds since the UNIX epoch when the request arrived
+    std::uint64_t timestamp_us = 0;
+    // from the arrival of the request until its reply was ready
+    std::uint32_t latency_us = 0;
+    std::uint16_t status = 0;
+    // the X-OSRM-Timeout of the request in milliseconds, 0 for none
+    std::uint32_t timeout_ms = 0;
+    std::string url;
+    // the binary coordinates of POST requests, empty for GET requests
+    std::string body;
+};
+
+// The binary query log written by osrm-routed --query-log, in host byte order:
+//
+//   char[8] "OSRMQLOG", uint32 version
+//   per request: uint64 timestamp_us, uint32 latency_us, uint16 status, uint32 timeout_ms,
+//                uint32 url size, uint32 body size, url, body
+class QueryLogWriter
+{
+  public:
+    // Records about `sample_rate` of all requests, spread evenly over them
+    QueryLogWriter(const boost::filesystem::path &path, const double sample_rate);
+    ~QueryLogWriter();
+
+    // Tells whether the next request is recorded, thread safe
+    bool Sample();
+
+    // Thread safe
+    void Write(const QueryRecord &record);
+
+  private:
+    const double sample_rate;
+    std::atomic<std::uint64_t> seen{0};
+
+    std::mutex mutex;
+    boost::filesystem::ofstream out;
+    std::uint64_t written = 0;
+};
+
+class QueryLogReader
+{
+  public:
+    explicit QueryLogReader(const boost::filesystem::path &path);
+
+    // False at the end of the log, throws on a truncated record
+    bool Next(QueryRecord &record);
+
+  private:
+    boost::filesystem::path path;
+    boost::filesystem::ifstream in;
+};
+}
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SERVER_QUERY_REPLAY_HPP
+#define SERVER_QUERY_REPLAY_HPP
+
+#include "server/query_log.hpp"
+#include "server/service_handler.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace osrm
+{
+namespace server
+{
+
+// Runs a recorded request like the request handler of osrm-routed does, returns the HTTP status
+std::uint16_t runRecordedQuery(ServiceHandlerInterface &handler, const QueryRecord &record);
+
+struct WarmUpResult
+{
+    std::size_t requests = 0;
+    std::size_t errors = 0;
+    double seconds = 0;
+};
+
+// Runs the requests of a query log as fast as possible on the threads before a server starts,
+// so the first real requests find the pages of the data they touch mapped and the caches of
+// the engine filled
+WarmUpResult warmUp(ServiceHandlerInterface &handler,
+                    const boost::filesystem::path &query_log,
+                    const unsigned threads);
+}
+}
+
+#endif
@@ -1,9 +1,17 @@
 #ifndef REQUEST_HANDLER_HPP
 #define REQUEST_HANDLER_HPP
 
+#include "server/access_log.hpp"
+#include "server/admission_control.hpp"
+#include "server/metrics.hpp"
+#include "server/query_log.hpp"
+#include "server/service_executor.hpp"
 #include "server/service_handler.hpp"
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -12,6 +20,7 @@ namespace server
 
 namespace http
 {
+class body_stream;
 class reply;
 struct request;
 }
@@ -20,16 +29,72 @@ class RequestHandler
 {
 
   public:
-    RequestHandler() = default;
+    // Writes the access log unless the DISABLE_ACCESS_LOGGING environment variable is set
+    RequestHandler();
     RequestHandler(const RequestHandler &) = delete;
     RequestHandler &operator=(const RequestHandler &) = delete;
 
     void RegisterServiceHandler(std::unique_ptr<ServiceHandlerInterface> service_handler);
 
-    void HandleRequest(const http::request &current_request, http::reply &current_reply);
+    // Needs to be called before the server starts handling requests
+    void SetAdmissionLimits(const std::string &service, const AdmissionControl::Limits &limits);
+
+    // Collects per-service metrics and serves them on /metrics. Needs to be called after the
+    // service handler was registered and before the server starts handling requests.
+    void EnableMetrics();
+
+    // Records `sample_rate` of the requests to a query log for osrm-replay. Needs to be called
+    // before the server starts handling requests.
+    void EnableQueryLog(const boost::filesystem::path &path, const double sample_rate);
+
+    // Runs the requests on worker pools by service instead of the IO threads, see
+    // ServiceExecutor. Needs to be called after the service handler was registered and before
+    // the server starts handling requests, like the pool and priority settings.
+    void EnableServiceExecutor(const unsigned default_threads);
+    bool AddServicePool(const std::vector<std::string> &services, const unsigned threads);
+    bool SetServicePriority(const std::string &service, const int priority);
+
+    // Start and stop the worker threads of the service executor, if there is one
+    void StartWorkers();
+    void StopWorkers();
+
+    // Sends table responses in chunks of rows_per_chunk rows while the rest is still computed.
+    // Every chunk repeats the searches from the destinations, so this trades throughput for the
+    // time to the first byte of large tables. Needs to be called before the server starts
+    // handling requests.
+    void EnableTableStreaming(const std::size_t rows_per_chunk);
+
+    // done is called once the reply can be sent. Streamed replies are handed over before their
+    // body is complete and finish once the last piece was written.
+    void HandleRequest(const http::request &current_request,
+                       http::reply &current_reply,
+                       const std::function<void()> &done);
+
+    // Handles the request on a worker thread of its service, or right away without a service
+    // executor. done is called once the reply is complete, on the thread that completed it.
+    void DispatchRequest(const http::request &current_request,
+                         http::reply &current_reply,
+                         std::function<void()> done);
+
+    // Called by the connection once the reply was written, sent_bytes is the body size on the
+    // wire after compression.
+    void ReplySent(const http::reply &sent_reply, const std::size_t sent_bytes);
 
   private:
+    void HandleMetricsRequest(http::reply &current_reply);
+    // Returns false if the body of a streamed reply could not be completed
+    bool AnswerRequest(const http::request &current_request,
+                       http::reply &current_reply,
+                       const std::function<void()> &done,
+                       std::shared_ptr<http::body_stream> &stream);
+
     std::unique_ptr<ServiceHandlerInterface> service_handler;
+    AdmissionControl admission_control;
+    std::unique_ptr<Metrics> metrics;
+    std::unique_ptr<QueryLogWriter> query_log;
+    std::unique_ptr<ServiceExecutor> service_executor;
+    std::unique_ptr<AccessLog> access_log;
+    std::size_t table_stream_rows = 0;
 };
 }
 }
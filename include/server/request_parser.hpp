@@ -4,6 +4,7 @@
 #include "server/http/compression_type.hpp"
 #include "server/http/header.hpp"
 
+#include <cstddef>
 #include <tuple>
 
 namespace osrm
@@ -28,7 +29,13 @@ class RequestParser
         indeterminate
     };
 
-    std::tuple<RequestStatus, http::compression_type>
+    // Larger request bodies are rejected as invalid
+    static const constexpr std::size_t MAX_BODY_SIZE = 64 * 1024 * 1024;
+
+    // Consumes input until a complete request was parsed or the input is exhausted.
+    // The returned pointer marks the first byte not consumed, so pipelined requests
+    // following in the same buffer can be handed to a fresh parser.
+    std::tuple<RequestStatus, http::compression_type, char *>
     parse(http::request &current_request, char *begin, char *end);
 
   private:
@@ -64,11 +71,14 @@ class RequestParser
         space_before_header_value,
         header_value,
         expecting_newline_2,
-        expecting_newline_3
+        expecting_newline_3,
+        body
     } state;
 
     http::header current_header;
     http::compression_type selected_compression;
+    std::size_t content_length;
+    bool expect_continue;
 };
 }
 }
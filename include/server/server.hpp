@@ -2,11 +2,15 @@
 #define SERVER_HPP
 
 #include "server/connection.hpp"
+#include "server/http/compressor.hpp"
 #include "server/request_handler.hpp"
 #include "server/service_handler.hpp"
 
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/numa.hpp"
 
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
@@ -15,7 +19,14 @@
 
 #ifndef _WIN32
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
 #endif
 
 #include <functional>
@@ -33,81 +44,282 @@ class Server
 {
   public:
     // Note: returns a shared instead of a unique ptr as it is captured in a lambda somewhere else
-    static std::shared_ptr<Server>
-    CreateServer(std::string &ip_address, int ip_port, unsigned requested_num_threads)
+    static std::shared_ptr<Server> CreateServer(std::string &ip_address,
+                                                int ip_port,
+                                                unsigned requested_num_threads,
+                                                unsigned keepalive_timeout,
+                                                unsigned keepalive_max_requests,
+                                                bool use_sharding = false,
+                                                http::compression_levels compression_levels = {})
     {
-        util::Log() << "http 1.1 compression handled by zlib version " << zlibVersion();
+        util::Log() << "http 1.1 compression handled by zlib version " << zlibVersion()
+                    << (http::is_supported(http::brotli_rfc7932) ? ", brotli" : "")
+                    << (http::is_supported(http::zstd_rfc8478) ? ", zstd" : "");
         const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
         const unsigned real_num_threads = std::min(hardware_threads, requested_num_threads);
-        return std::make_shared<Server>(ip_address, ip_port, real_num_threads);
+        return std::make_shared<Server>(ip_address,
+                                        ip_port,
+                                        real_num_threads,
+                                        keepalive_timeout,
+                                        keepalive_max_requests,
+                                        use_sharding,
+                                        compression_levels);
     }
 
-    explicit Server(const std::string &address, const int port, const unsigned thread_pool_size)
-        : thread_pool_size(thread_pool_size), acceptor(io_service),
-          new_connection(std::make_shared<Connection>(io_service, request_handler))
+    // With sharding enabled every thread runs its own io_service and acceptor. All acceptors
+    // bind the same port with SO_REUSEPORT and the kernel balances incoming connections
+    // between them, so no reactor state is shared between threads.
+    // An empty address does not listen on TCP at all, see ListenOnUnixSocket.
+    explicit Server(const std::string &address,
+                    const int port,
+                    const unsigned thread_pool_size,
+                    const unsigned keepalive_timeout,
+                    const unsigned keepalive_max_requests,
+                    const bool use_sharding = false,
+                    const http::compression_levels compression_levels = {})
+        : thread_pool_size(thread_pool_size), keepalive_timeout(keepalive_timeout),
+          keepalive_max_requests(keepalive_max_requests), use_sharding(use_sharding),
+          compression_levels(compression_levels)
     {
-        const auto port_string = std::to_string(port);
+#ifndef SO_REUSEPORT
+        if (use_sharding)
+        {
+            util::Log(logWARNING) << "SO_REUSEPORT is not supported on this platform, "
+                                     "falling back to a single acceptor";
+            this->use_sharding = false;
+        }
+#endif
+        const auto num_listeners = this->use_sharding ? thread_pool_size : 1u;
+        for (unsigned i = 0; i < num_listeners; ++i)
+        {
+            listeners.push_back(std::make_unique<Listener>());
+            if (!address.empty())
+            {
+                Listen(*listeners.back(), address, port);
+            }
+        }
+    }
 
-        boost::asio::ip::tcp::resolver resolver(io_service);
-        boost::asio::ip::tcp::resolver::query query(address, port_string);
-        boost::asio::ip::tcp::endpoint endpoint = *resolver.resolve(query);
+    // Co-located clients skip the TCP/IP stack on a unix domain socket at path. Its
+    // connections are served like TCP connections by the threads of the first listener, a
+    // stale socket file of a previous run is replaced.
+    void ListenOnUnixSocket(const std::string &path)
+    {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        struct stat status;
+        if (::stat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+        {
+            ::unlink(path.c_str());
+        }
 
+        auto &listener = *listeners.front();
+        listener.acceptors.push_back(std::make_unique<Acceptor>(listener.io_service));
+        auto &acceptor = listener.acceptors.back()->acceptor;
+        const boost::asio::local::stream_protocol::endpoint endpoint(path);
         acceptor.open(endpoint.protocol());
-#ifdef SO_REUSEPORT
-        const int option = 1;
-        setsockopt(acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option));
-#endif
-        acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
         acceptor.bind(endpoint);
         acceptor.listen();
 
-        util::Log() << "Listening on: " << acceptor.local_endpoint();
+        util::Log() << "Listening on unix domain socket: " << path;
 
-        acceptor.async_accept(
-            new_connection->socket(),
-            boost::bind(&Server::HandleAccept, this, boost::asio::placeholders::error));
+        StartAccept(listener, *listener.acceptors.back());
+#else
+        throw util::exception("Unix domain sockets are not supported on this platform: " + path +
+                              SOURCE_REF);
+#endif
     }
 
     void Run()
     {
+        request_handler.StartWorkers();
+
         std::vector<std::shared_ptr<std::thread>> threads;
-        for (unsigned i = 0; i < thread_pool_size; ++i)
+        if (use_sharding)
         {
-            std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
-                boost::bind(&boost::asio::io_service::run, &io_service));
-            threads.push_back(thread);
+            for (const auto index : util::irange<std::size_t>(0, listeners.size()))
+            {
+                auto &listener_io_service = listeners[index]->io_service;
+                threads.push_back(std::make_shared<std::thread>([&listener_io_service, index] {
+                    PinToCore(index);
+                    listener_io_service.run();
+                }));
+            }
+        }
+        else if (pin_to_numa_nodes)
+        {
+            // Threads are spread evenly over the nodes, so every replica of the data serves the
+            // same share of the requests
+            const auto nodes = util::numa::getNodes();
+            auto &io_service = listeners.front()->io_service;
+            for (unsigned i = 0; i < thread_pool_size; ++i)
+            {
+                const auto &node = nodes[i % nodes.size()];
+                threads.push_back(std::make_shared<std::thread>([&io_service, &node, i] {
+                    if (!util::numa::pinThreadToNode(node))
+                    {
+                        util::Log(logWARNING) << "Could not pin server thread " << i
+                                              << " to NUMA node " << node.id;
+                    }
+                    io_service.run();
+                }));
+            }
+        }
+        else
+        {
+            for (unsigned i = 0; i < thread_pool_size; ++i)
+            {
+                std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
+                    boost::bind(&boost::asio::io_service::run, &listeners.front()->io_service));
+                threads.push_back(thread);
+            }
         }
         for (auto thread : threads)
         {
             thread->join();
         }
+
+        request_handler.StopWorkers();
     }
 
-    void Stop() { io_service.stop(); }
+    void Stop()
+    {
+        for (auto &listener : listeners)
+        {
+            listener->io_service.stop();
+        }
+    }
 
     void RegisterServiceHandler(std::unique_ptr<ServiceHandlerInterface> service_handler_)
     {
         request_handler.RegisterServiceHandler(std::move(service_handler_));
     }
 
+    void EnableMetrics() { request_handler.EnableMetrics(); }
+
+    void EnableQueryLog(const boost::filesystem::path &path, const double sample_rate)
+    {
+        request_handler.EnableQueryLog(path, sample_rate);
+    }
+
+    void EnableTableStreaming(const std::size_t rows_per_chunk)
+    {
+        request_handler.EnableTableStreaming(rows_per_chunk);
+    }
+
+    // Without sharded acceptors, where every thread has a core of its own
+    void PinThreadsToNUMANodes() { pin_to_numa_nodes = true; }
+
+    // The IO threads only parse requests and hand them to worker pools by service. Needs to be
+    // called after the service handler was registered, like the pool and priority settings.
+    void EnableServiceExecutor(const unsigned default_threads)
+    {
+        request_handler.EnableServiceExecutor(default_threads);
+    }
+
+    bool AddServicePool(const std::vector<std::string> &services, const unsigned threads)
+    {
+        return request_handler.AddServicePool(services, threads);
+    }
+
+    bool SetServicePriority(const std::string &service, const int priority)
+    {
+        return request_handler.SetServicePriority(service, priority);
+    }
+
+    void SetAdmissionLimits(const std::string &service, const AdmissionControl::Limits &limits)
+    {
+        request_handler.SetAdmissionLimits(service, limits);
+    }
+
   private:
-    void HandleAccept(const boost::system::error_code &e)
+    // The acceptors are generic, so TCP and unix domain socket connections share Connection
+    struct Acceptor
+    {
+        explicit Acceptor(boost::asio::io_service &io_service) : acceptor(io_service) {}
+
+        boost::asio::basic_socket_acceptor<boost::asio::generic::stream_protocol> acceptor;
+        std::shared_ptr<Connection> new_connection;
+    };
+
+    struct Listener
+    {
+        boost::asio::io_service io_service;
+        std::vector<std::unique_ptr<Acceptor>> acceptors;
+    };
+
+    void Listen(Listener &listener, const std::string &address, const int port)
+    {
+        const auto port_string = std::to_string(port);
+
+        boost::asio::ip::tcp::resolver resolver(listener.io_service);
+        boost::asio::ip::tcp::resolver::query query(address, port_string);
+        boost::asio::ip::tcp::endpoint tcp_endpoint = *resolver.resolve(query);
+
+        listener.acceptors.push_back(std::make_unique<Acceptor>(listener.io_service));
+        auto &acceptor = listener.acceptors.back()->acceptor;
+        const boost::asio::generic::stream_protocol::endpoint endpoint(tcp_endpoint);
+        acceptor.open(endpoint.protocol());
+#ifdef SO_REUSEPORT
+        const int option = 1;
+        setsockopt(acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option));
+#endif
+        acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+
+        util::Log() << "Listening on: " << tcp_endpoint;
+
+        StartAccept(listener, *listener.acceptors.back());
+    }
+
+    void StartAccept(Listener &listener, Acceptor &acceptor)
+    {
+        acceptor.new_connection = std::make_shared<Connection>(listener.io_service,
+                                                               request_handler,
+                                                               keepalive_timeout,
+                                                               keepalive_max_requests,
+                                                               compression_levels);
+        acceptor.acceptor.async_accept(acceptor.new_connection->socket(),
+                                       boost::bind(&Server::HandleAccept,
+                                                   this,
+                                                   boost::ref(listener),
+                                                   boost::ref(acceptor),
+                                                   boost::asio::placeholders::error));
+    }
+
+    void HandleAccept(Listener &listener, Acceptor &acceptor, const boost::system::error_code &e)
     {
         if (!e)
         {
-            new_connection->start();
-            new_connection = std::make_shared<Connection>(io_service, request_handler);
-            acceptor.async_accept(
-                new_connection->socket(),
-                boost::bind(&Server::HandleAccept, this, boost::asio::placeholders::error));
+            acceptor.new_connection->start();
+            StartAccept(listener, acceptor);
         }
     }
 
+    static void PinToCore(const std::size_t index)
+    {
+#ifdef __linux__
+        const auto num_cores = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(index % num_cores, &cpu_set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+        {
+            util::Log(logWARNING) << "Could not pin server thread " << index << " to a core";
+        }
+#else
+        (void)index;
+#endif
+    }
+
     unsigned thread_pool_size;
-    boost::asio::io_service io_service;
-    boost::asio::ip::tcp::acceptor acceptor;
-    std::shared_ptr<Connection> new_connection;
+    unsigned keepalive_timeout;
+    unsigned keepalive_max_requests;
+    bool use_sharding;
+    bool pin_to_numa_nodes = false;
+    http::compression_levels compression_levels;
     RequestHandler request_handler;
+    std::vector<std::unique_ptr<Listener>> listeners;
 };
 }
 }
@@ -1,12 +1,18 @@
 #ifndef SERVER_SERVICE_BASE_SERVICE_HPP
 #define SERVER_SERVICE_BASE_SERVICE_HPP
 
+#include "engine/api/base_parameters.hpp"
+#include "engine/api/table_writer.hpp"
 #include "engine/status.hpp"
 #include "osrm/osrm.hpp"
+#include "server/api/binary_parameters_parser.hpp"
 #include "util/coordinate.hpp"
+#include "util/json_binary_renderer.hpp"
 
+#include <boost/optional.hpp>
 #include <mapbox/variant.hpp>
 
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -17,20 +23,72 @@ namespace server
 namespace service
 {
 
+// A response in the format of util/json_binary_renderer.hpp
+struct BinaryResult
+{
+    std::vector<char> content;
+};
+
+// Put into the result by callers that send a table while it is searched. The table service then
+// writes JSON tables to the writer and keeps the StreamedTable, other results replace it.
+struct StreamedTable
+{
+    engine::api::TableWriter writer;
+};
+
 class BaseService
 {
   public:
-    using ResultT = mapbox::util::variant<util::json::Object, std::string>;
+    // A json::Object to render, a binary tile, an already rendered JSON response or a binary one
+    using ResultT = mapbox::util::
+        variant<util::json::Object, std::string, std::vector<char>, BinaryResult, StreamedTable>;
 
     BaseService(OSRM &routing_machine) : routing_machine(routing_machine) {}
     virtual ~BaseService() = default;
 
-    virtual engine::Status
-    RunQuery(std::size_t prefix_length, std::string &query, ResultT &result) = 0;
+    using TimeoutT = boost::optional<std::chrono::milliseconds>;
+    using BodyT = boost::optional<engine::api::BaseParameters>;
+    using TracesT = std::vector<api::BinaryTrace>;
+
+    // The body holds the coordinates of queries that were POSTed in binary, the query string
+    // then only carries the options. The timeout is the deadline the client asked for, it is
+    // handed to the engine as is.
+    virtual engine::Status RunQuery(std::size_t prefix_length,
+                                    std::string &query,
+                                    BodyT &body,
+                                    const TimeoutT &timeout,
+                                    ResultT &result) = 0;
+
+    // Runs the query once per trace of a batch that was POSTed in binary, the query string
+    // carries the options of all traces. Only services that match traces take batches.
+    virtual engine::Status RunBatchQuery(std::size_t /*prefix_length*/,
+                                         std::string & /*query*/,
+                                         TracesT & /*traces*/,
+                                         const TimeoutT & /*timeout*/,
+                                         ResultT &result)
+    {
+        result = util::json::Object();
+        auto &json_result = result.get<util::json::Object>();
+        json_result.values["code"] = "InvalidBody";
+        json_result.values["message"] = "Only the match service takes batches of traces";
+        return engine::Status::Error;
+    }
 
     virtual unsigned GetVersion() = 0;
 
   protected:
+    // Replaces the json::Object of a query by its binary encoding if the client asked for it
+    static void ApplyOutputFormat(const engine::api::BaseParameters &parameters, ResultT &result)
+    {
+        if (parameters.output_format == engine::api::BaseParameters::OutputFormatType::Binary &&
+            result.is<util::json::Object>())
+        {
+            BinaryResult binary;
+            util::json::renderBinary(binary.content, result.get<util::json::Object>());
+            result = std::move(binary);
+        }
+    }
+
     OSRM &routing_machine;
 };
 }
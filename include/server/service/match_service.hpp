@@ -22,8 +22,19 @@ class MatchService final : public BaseService
   public:
     MatchService(OSRM &routing_machine) : BaseService(routing_machine) {}
 
-    engine::Status
-    RunQuery(std::size_t prefix_length, std::string &query, ResultT &result) final override;
+    engine::Status RunQuery(std::size_t prefix_length,
+                            std::string &query,
+                            BodyT &body,
+                            const TimeoutT &timeout,
+                            ResultT &result) final override;
+
+    // Answers with the binary encoding of {"code": "Ok", "results": [...]}, a response per trace
+    // in the order of the traces. Traces that failed have their error in their response.
+    engine::Status RunBatchQuery(std::size_t prefix_length,
+                                 std::string &query,
+                                 TracesT &traces,
+                                 const TimeoutT &timeout,
+                                 ResultT &result) final override;
 
     unsigned GetVersion() final override { return 1; }
 };
@@ -0,0 +1,98 @@
+#ifndef SERVER_SERVICE_EXECUTOR_HPP
+#define SERVER_SERVICE_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+// Runs requests on worker pools by service, so the IO threads only parse and dispatch them.
+//
+// Every service runs on the default pool unless it was added to a pool of its own, e.g. to keep
+// a few heavy match requests from taking all threads of cheap route requests. Within a pool
+// requests of services with a higher priority run first, requests of the same priority in the
+// order they arrived.
+//
+// Pools and priorities have to be configured before the executor is started.
+class ServiceExecutor
+{
+  public:
+    using Job = std::function<void()>;
+
+    // Requests for services not in the list are accounted as 'other'
+    ServiceExecutor(std::vector<std::string> service_names, const unsigned default_threads);
+    ~ServiceExecutor();
+
+    ServiceExecutor(const ServiceExecutor &) = delete;
+    ServiceExecutor &operator=(const ServiceExecutor &) = delete;
+
+    // Returns false if a service is unknown or already has a pool of its own
+    bool AddPool(const std::vector<std::string> &services, const unsigned threads);
+    // Returns false if the service is unknown
+    bool SetPriority(const std::string &service, const int priority);
+
+    void Start();
+    // Drops the requests still waiting and joins the workers
+    void Stop();
+
+    // The service is the first segment of the request path
+    void Post(const std::string &service, Job job);
+
+    // Waiting requests by service and busy threads by pool
+    std::string RenderPrometheus() const;
+
+  private:
+    struct Task
+    {
+        int priority;
+        std::uint64_t sequence;
+        std::size_t service;
+        Job job;
+
+        bool operator<(const Task &other) const
+        {
+            // std::priority_queue pops the largest task first
+            return priority < other.priority ||
+                   (priority == other.priority && sequence > other.sequence);
+        }
+    };
+
+    struct Pool
+    {
+        std::string name;
+        unsigned num_threads;
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable task_posted;
+        std::priority_queue<Task> tasks;
+        std::uint64_t next_sequence = 0;
+        std::size_t busy_threads = 0;
+        bool stopped = false;
+    };
+
+    std::size_t ServiceIndex(const std::string &service) const;
+    void Work(Pool &pool);
+
+    std::vector<std::string> service_names;
+    // pools.front() is the default pool
+    std::vector<std::unique_ptr<Pool>> pools;
+    std::vector<std::size_t> service_pools;
+    std::vector<int> service_priorities;
+    std::unique_ptr<std::atomic<std::int64_t>[]> queued;
+};
+}
+}
+
+#endif
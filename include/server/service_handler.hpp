@@ -3,9 +3,12 @@
 
 #include "server/service/base_service.hpp"
 
+#include "osrm/engine_statistics.hpp"
 #include "osrm/osrm.hpp"
 
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace osrm
 {
@@ -28,7 +31,16 @@ class ServiceHandlerInterface
   public:
     virtual ~ServiceHandlerInterface() {}
     virtual engine::Status RunQuery(api::ParsedURL parsed_url,
+                                    service::BaseService::BodyT &body,
+                                    const service::BaseService::TimeoutT &timeout,
                                     service::BaseService::ResultT &result) = 0;
+    virtual engine::Status RunBatchQuery(api::ParsedURL parsed_url,
+                                         service::BaseService::TracesT &traces,
+                                         const service::BaseService::TimeoutT &timeout,
+                                         service::BaseService::ResultT &result) = 0;
+
+    virtual std::vector<std::string> GetServiceNames() const = 0;
+    virtual engine::EngineStatistics GetEngineStatistics() const = 0;
 };
 
 class ServiceHandler final : public ServiceHandlerInterface
@@ -37,12 +49,57 @@ class ServiceHandler final : public ServiceHandlerInterface
     ServiceHandler(osrm::EngineConfig &config);
     using ResultT = service::BaseService::ResultT;
 
-    virtual engine::Status RunQuery(api::ParsedURL parsed_url, ResultT &result) override;
+    using BodyT = service::BaseService::BodyT;
+    using TracesT = service::BaseService::TracesT;
+    using TimeoutT = service::BaseService::TimeoutT;
+
+    virtual engine::Status RunQuery(api::ParsedURL parsed_url,
+                                    BodyT &body,
+                                    const TimeoutT &timeout,
+                                    ResultT &result) override;
+    virtual engine::Status RunBatchQuery(api::ParsedURL parsed_url,
+                                         TracesT &traces,
+                                         const TimeoutT &timeout,
+                                         ResultT &result) override;
+
+    virtual std::vector<std::string> GetServiceNames() const override;
+    virtual engine::EngineStatistics GetEngineStatistics() const override;
 
   private:
+    // nullptr and an error in the result if there is no such service in the version of the URL
+    service::BaseService *FindService(const api::ParsedURL &parsed_url, ResultT &result) const;
+
     std::unordered_map<std::string, std::unique_ptr<service::BaseService>> service_map;
     OSRM routing_machine;
 };
+
+// Serves several datasets from one server, picked by the profile of the URL, e.g. /route/v1/bike.
+// Profiles without a dataset of their own are served by the default handler, if there is one.
+// The statistics are summed over all datasets.
+class ProfileServiceHandler final : public ServiceHandlerInterface
+{
+  public:
+    ProfileServiceHandler(std::unique_ptr<ServiceHandlerInterface> default_handler);
+
+    // all handlers have to offer the same services
+    void AddProfile(const std::string &profile, std::unique_ptr<ServiceHandlerInterface> handler);
+
+    virtual engine::Status RunQuery(api::ParsedURL parsed_url,
+                                    service::BaseService::BodyT &body,
+                                    const service::BaseService::TimeoutT &timeout,
+                                    service::BaseService::ResultT &result) override;
+    virtual engine::Status RunBatchQuery(api::ParsedURL parsed_url,
+                                         service::BaseService::TracesT &traces,
+                                         const service::BaseService::TimeoutT &timeout,
+                                         service::BaseService::ResultT &result) override;
+
+    virtual std::vector<std::string> GetServiceNames() const override;
+    virtual engine::EngineStatistics GetEngineStatistics() const override;
+
+  private:
+    std::unique_ptr<ServiceHandlerInterface> default_handler;
+    std::unordered_map<std::string, std::unique_ptr<ServiceHandlerInterface>> profile_handlers;
+};
 }
 }
 
@@ -0,0 +1,98 @@
+#ifndef SERVER_TABLE_COORDINATOR_HPP
+#define SERVER_TABLE_COORDINATOR_HPP
+
+#include "engine/hint.hpp"
+#include "util/coordinate.hpp"
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+// An osrm-routed that searches blocks of a distributed table
+struct TableBackend
+{
+    std::string host;
+    std::string port;
+};
+
+// Consecutive rows of a distributed table, from first_row on
+struct TableBlock
+{
+    std::size_t first_row;
+    std::size_t number_of_rows;
+};
+
+// The rows of a block as a backend answered them, row-major with one column per coordinate and
+// NaN for no route. hints holds the snapped destinations of the block.
+struct TableBlockResult
+{
+    std::string code;
+    std::string message;
+    std::vector<double> durations;
+    std::vector<double> distances;
+    std::vector<boost::optional<engine::Hint>> hints;
+};
+
+struct TableCoordinatorConfig
+{
+    std::vector<TableBackend> backends;
+    std::string profile = "driving";
+    std::size_t rows_per_block = 64;
+    // requests a backend works on at once, every other block waits until one of them is done
+    unsigned requests_per_backend = 2;
+    // a block that failed this often fails the table
+    unsigned max_attempts = 3;
+    // X-OSRM-Timeout of the block requests in milliseconds, 0 for the default of the backends
+    unsigned block_timeout = 0;
+    bool distances = false;
+};
+
+std::vector<TableBlock> planTableBlocks(const std::size_t number_of_rows,
+                                        const std::size_t rows_per_block);
+
+// The application/x-osrm-coordinates body of the block requests, with a hints section if there
+// are hints
+std::string encodeTableBody(const std::vector<util::Coordinate> &coordinates,
+                            const std::vector<boost::optional<engine::Hint>> &hints);
+
+std::string makeTableTarget(const TableCoordinatorConfig &config, const TableBlock &block);
+
+// Reads a binary response to a block request. Returns false if it is malformed or the matrices
+// do not have the rows of the block, errors of the backend only set the code.
+bool decodeTableBlock(const std::string &response,
+                      const TableBlock &block,
+                      const std::size_t number_of_columns,
+                      TableBlockResult &result);
+
+// Computes the table of all coordinates to all coordinates on a set of osrm-routed backends,
+// a block of source rows per request. The first block snaps the coordinates, the others send
+// the hints of the snapped coordinates along so the backends skip the snapping. Failed blocks
+// are retried on the next free backend, overloaded backends (TooBusy) and timeouts back off
+// before the next attempt.
+class TableCoordinator
+{
+  public:
+    // Called with every block that was searched, on the thread that searched it but never for
+    // two blocks at once. Blocks arrive in no particular order.
+    using BlockHandler = std::function<void(const TableBlock &, const TableBlockResult &)>;
+
+    explicit TableCoordinator(TableCoordinatorConfig config);
+
+    // Throws a util::exception if a block failed max_attempts times or with a permanent error
+    void Run(const std::vector<util::Coordinate> &coordinates, const BlockHandler &handle_block);
+
+  private:
+    TableCoordinatorConfig config;
+};
+}
+}
+
+#endif
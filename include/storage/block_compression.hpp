@@ -0,0 +1,69 @@
+#ifndef OSRM_STORAGE_BLOCK_COMPRESSION_HPP_
+#define OSRM_STORAGE_BLOCK_COMPRESSION_HPP_
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace osrm
+{
+namespace storage
+{
+namespace io
+{
+
+// The blocks of compressed files are zlib streams with the fastest compression level, which is
+// the library every OSRM tool links already. Intermediate files are read back once, so a fast
+// level that halves the bytes on disk saves more time on slow disks than a better ratio.
+//
+// A compressed file has the fingerprint of the file, if any, followed by the magic, then the
+// blocks and a block of size 0 at the end:
+//   char[8] BLOCK_COMPRESSION_MAGIC
+//   per block: uint32 uncompressed size, uint32 compressed size, compressed bytes
+const constexpr char BLOCK_COMPRESSION_MAGIC[8] = {'O', 'S', 'R', 'M', 'B', 'L', 'K', 'Z'};
+const constexpr std::size_t COMPRESSION_BLOCK_SIZE = 4 * 1024 * 1024;
+
+inline std::string compressBlock(const std::string &block)
+{
+    std::string compressed;
+    boost::iostreams::filtering_ostream stream;
+    stream.push(boost::iostreams::zlib_compressor(
+        boost::iostreams::zlib_params(boost::iostreams::zlib::best_speed)));
+    stream.push(boost::iostreams::back_inserter(compressed));
+    stream.write(block.data(), block.size());
+    stream.reset();
+    return compressed;
+}
+
+// Returns false if the data does not decompress to uncompressed_size bytes
+inline bool decompressBlock(const char *data,
+                            const std::size_t size,
+                            const std::size_t uncompressed_size,
+                            std::string &block)
+{
+    block.clear();
+    block.reserve(uncompressed_size);
+    try
+    {
+        boost::iostreams::filtering_istream stream;
+        stream.push(boost::iostreams::zlib_decompressor());
+        stream.push(boost::iostreams::array_source(data, size));
+        boost::iostreams::copy(stream, boost::iostreams::back_inserter(block));
+    }
+    catch (const boost::iostreams::zlib_error &)
+    {
+        return false;
+    }
+    return block.size() == uncompressed_size;
+}
+}
+}
+}
+
+#endif
@@ -3,19 +3,34 @@
 
 #include "osrm/error_codes.hpp"
 
+#include "storage/block_compression.hpp"
+
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/fingerprint.hpp"
 #include "util/log.hpp"
 #include "util/version.hpp"
 
+#include <boost/assert.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/iostreams/seek.hpp>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
 #include <cerrno>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace osrm
 {
@@ -43,13 +58,35 @@ class FileReader
         HasNoFingerprint
     };
 
-    FileReader(const std::string &filename, const FingerprintFlag flag)
-        : FileReader(boost::filesystem::path(filename), flag)
+    // How reads of at least BULK_READ_SIZE bytes are done, smaller reads always go through the
+    // buffered stream. Platforms without pread only support StreamRead.
+    enum ReadMode
+    {
+        // through the buffered stream
+        StreamRead,
+        // with large reads straight into the destination
+        BulkRead,
+        // with large O_DIRECT reads that bypass the page cache, copied from an aligned buffer
+        // into the destination. Falls back to BulkRead if the file system has no O_DIRECT.
+        DirectRead
+    };
+
+    static constexpr std::size_t BULK_READ_SIZE = 1024 * 1024;
+    static constexpr std::size_t BULK_CHUNK_SIZE = 64 * 1024 * 1024;
+    static constexpr std::size_t DIRECT_CHUNK_SIZE = 8 * 1024 * 1024;
+    static constexpr std::size_t DIRECT_ALIGNMENT = 4096;
+
+    FileReader(const std::string &filename,
+               const FingerprintFlag flag,
+               const ReadMode read_mode = BulkRead)
+        : FileReader(boost::filesystem::path(filename), flag, read_mode)
     {
     }
 
-    FileReader(const boost::filesystem::path &filepath_, const FingerprintFlag flag)
-        : filepath(filepath_), fingerprint(flag)
+    FileReader(const boost::filesystem::path &filepath_,
+               const FingerprintFlag flag,
+               const ReadMode read_mode_ = BulkRead)
+        : filepath(filepath_), fingerprint(flag), read_mode(read_mode_)
     {
         input_stream.open(filepath, std::ios::binary);
 
@@ -63,10 +100,24 @@ class FileReader
         {
             throw util::RuntimeError(filepath.string(), ErrorCode::InvalidFingerprint, SOURCE_REF);
         }
+
+        // only files with a fingerprint can be compressed, see FileWriter::CompressBlocks
+        if (flag == VerifyFingerprint)
+        {
+            DetectCompression();
+        }
     }
 
     std::size_t GetSize()
     {
+        if (compressed)
+        {
+            throw util::RuntimeError("Unable to determine the uncompressed size of " +
+                                         std::string(filepath.string()),
+                                     ErrorCode::FileIOError,
+                                     SOURCE_REF);
+        }
+
         const boost::filesystem::ifstream::pos_type positon = input_stream.tellg();
         input_stream.seekg(0, std::ios::end);
         const boost::filesystem::ifstream::pos_type file_size = input_stream.tellg();
@@ -105,6 +156,20 @@ class FileReader
         if (count == 0)
             return;
 
+        if (compressed)
+        {
+            ReadCompressed(reinterpret_cast<char *>(dest), count * sizeof(T));
+            return;
+        }
+
+#ifndef _WIN32
+        if (read_mode != StreamRead && count * sizeof(T) >= BULK_READ_SIZE)
+        {
+            ReadBulk(reinterpret_cast<char *>(dest), count * sizeof(T));
+            return;
+        }
+#endif
+
         const auto &result = input_stream.read(reinterpret_cast<char *>(dest), count * sizeof(T));
         const std::size_t bytes_read = input_stream.gcount();
 
@@ -136,6 +201,11 @@ class FileReader
 
     template <typename T> void Skip(const std::size_t element_count)
     {
+        if (compressed)
+        {
+            ReadCompressed(nullptr, element_count * sizeof(T));
+            return;
+        }
         boost::iostreams::seek(input_stream, element_count * sizeof(T), BOOST_IOS::cur);
     }
 
@@ -176,9 +246,193 @@ class FileReader
     }
 
   private:
+    void DetectCompression()
+    {
+        const auto position = input_stream.tellg();
+        char magic[sizeof(BLOCK_COMPRESSION_MAGIC)];
+        if (input_stream.read(magic, sizeof(magic)) &&
+            std::memcmp(magic, BLOCK_COMPRESSION_MAGIC, sizeof(magic)) == 0)
+        {
+            compressed = true;
+            return;
+        }
+        input_stream.clear();
+        input_stream.seekg(position, std::ios::beg);
+    }
+
+    // Copies the next size bytes of the decompressed blocks to dest, or skips them without dest
+    void ReadCompressed(char *dest, std::size_t size)
+    {
+        while (size > 0)
+        {
+            if (block_position == block.size())
+            {
+                ReadBlock();
+            }
+            const auto copied = std::min(size, block.size() - block_position);
+            if (dest)
+            {
+                std::memcpy(dest, block.data() + block_position, copied);
+                dest += copied;
+            }
+            block_position += copied;
+            size -= copied;
+        }
+    }
+
+    void ReadBlock()
+    {
+        std::uint32_t sizes[2];
+        if (!input_stream.read(reinterpret_cast<char *>(sizes), sizeof(sizes)) || sizes[0] == 0)
+        {
+            throw util::RuntimeError(
+                filepath.string(), ErrorCode::UnexpectedEndOfFile, SOURCE_REF);
+        }
+        compressed_block.resize(sizes[1]);
+        if (!input_stream.read(&compressed_block[0], sizes[1]) ||
+            !decompressBlock(compressed_block.data(), sizes[1], sizes[0], block))
+        {
+            throw util::RuntimeError(filepath.string(),
+                                     ErrorCode::FileReadError,
+                                     SOURCE_REF,
+                                     "corrupt compressed block");
+        }
+        block_position = 0;
+    }
+
+#ifndef _WIN32
+    struct FileDescriptor
+    {
+        ~FileDescriptor()
+        {
+            if (descriptor >= 0)
+                ::close(descriptor);
+        }
+
+        int descriptor = -1;
+    };
+
+    // Reads size bytes at the position of the stream and moves the stream past them
+    void ReadBulk(char *dest, std::size_t size)
+    {
+        const auto position = input_stream.tellg();
+        if (position == boost::filesystem::ifstream::pos_type(-1))
+        {
+            throw util::RuntimeError(
+                filepath.string(), ErrorCode::FileReadError, SOURCE_REF, std::strerror(errno));
+        }
+        auto offset = static_cast<off_t>(position);
+
+        // the descriptors are only opened for the first bulk read, most readers never do one
+        if (!bulk_file)
+        {
+            bulk_file = std::make_unique<FileDescriptor>();
+            bulk_file->descriptor = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (bulk_file->descriptor < 0)
+            {
+                throw util::RuntimeError(filepath.string(),
+                                         ErrorCode::FileOpenError,
+                                         SOURCE_REF,
+                                         std::strerror(errno));
+            }
+#ifdef O_DIRECT
+            if (read_mode == DirectRead)
+            {
+                direct_file = std::make_unique<FileDescriptor>();
+                direct_file->descriptor =
+                    ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+            }
+#endif
+        }
+
+        if (direct_file && direct_file->descriptor >= 0)
+        {
+            ReadDirect(dest, size, offset);
+        }
+        else
+        {
+            while (size > 0)
+            {
+                const auto bytes_read = ::pread(bulk_file->descriptor,
+                                                dest,
+                                                std::min(size, std::size_t{BULK_CHUNK_SIZE}),
+                                                offset);
+                CheckBulkRead(bytes_read);
+                dest += bytes_read;
+                size -= bytes_read;
+                offset += bytes_read;
+            }
+        }
+
+        input_stream.seekg(offset, std::ios::beg);
+    }
+
+    // O_DIRECT needs aligned offsets, sizes and memory, so whole aligned chunks around the
+    // requested bytes are read into a buffer
+    void ReadDirect(char *dest, std::size_t size, off_t &offset)
+    {
+        if (!direct_buffer)
+        {
+            void *buffer = nullptr;
+            if (::posix_memalign(&buffer, DIRECT_ALIGNMENT, DIRECT_CHUNK_SIZE) != 0)
+            {
+                throw std::bad_alloc();
+            }
+            direct_buffer = std::unique_ptr<char, decltype(&std::free)>(
+                static_cast<char *>(buffer), &std::free);
+        }
+
+        while (size > 0)
+        {
+            const auto aligned_offset = offset - offset % DIRECT_ALIGNMENT;
+            const std::size_t skipped = offset - aligned_offset;
+            const auto bytes_read = ::pread(direct_file->descriptor,
+                                            direct_buffer.get(),
+                                            DIRECT_CHUNK_SIZE,
+                                            aligned_offset);
+            CheckBulkRead(bytes_read);
+            if (static_cast<std::size_t>(bytes_read) <= skipped)
+            {
+                throw util::RuntimeError(
+                    filepath.string(), ErrorCode::UnexpectedEndOfFile, SOURCE_REF);
+            }
+
+            const auto copied = std::min(size, static_cast<std::size_t>(bytes_read) - skipped);
+            std::memcpy(dest, direct_buffer.get() + skipped, copied);
+            dest += copied;
+            size -= copied;
+            offset += copied;
+        }
+    }
+
+    void CheckBulkRead(const ssize_t bytes_read)
+    {
+        if (bytes_read < 0)
+        {
+            throw util::RuntimeError(
+                filepath.string(), ErrorCode::FileReadError, SOURCE_REF, std::strerror(errno));
+        }
+        if (bytes_read == 0)
+        {
+            throw util::RuntimeError(
+                filepath.string(), ErrorCode::UnexpectedEndOfFile, SOURCE_REF);
+        }
+    }
+#endif
+
     const boost::filesystem::path filepath;
     boost::filesystem::ifstream input_stream;
     FingerprintFlag fingerprint;
+    ReadMode read_mode;
+#ifndef _WIN32
+    std::unique_ptr<FileDescriptor> bulk_file;
+    std::unique_ptr<FileDescriptor> direct_file;
+    std::unique_ptr<char, decltype(&std::free)> direct_buffer{nullptr, &std::free};
+#endif
+    bool compressed = false;
+    std::string compressed_block;
+    std::string block;
+    std::size_t block_position = 0;
 };
 
 class FileWriter
@@ -190,12 +444,26 @@ class FileWriter
         HasNoFingerprint
     };
 
-    FileWriter(const std::string &filename, const FingerprintFlag flag)
-        : FileWriter(boost::filesystem::path(filename), flag)
+    // Files that are only written and read back by the tools of the pipeline can be compressed
+    // in blocks, see storage/block_compression.hpp. The blocks are compressed on as many threads
+    // as there are cores while the writer fills the next ones. Compressed files can not be
+    // seeked in and need a fingerprint, FileReader recognizes them.
+    enum CompressionFlag
+    {
+        NoCompression,
+        CompressBlocks
+    };
+
+    FileWriter(const std::string &filename,
+               const FingerprintFlag flag,
+               const CompressionFlag compression = NoCompression)
+        : FileWriter(boost::filesystem::path(filename), flag, compression)
     {
     }
 
-    FileWriter(const boost::filesystem::path &filepath_, const FingerprintFlag flag)
+    FileWriter(const boost::filesystem::path &filepath_,
+               const FingerprintFlag flag,
+               const CompressionFlag compression = NoCompression)
         : filepath(filepath_), fingerprint(flag)
     {
         output_stream.open(filepath, std::ios::binary);
@@ -209,6 +477,42 @@ class FileWriter
         {
             WriteFingerprint();
         }
+
+        if (compression == CompressBlocks)
+        {
+            BOOST_ASSERT(flag == GenerateFingerprint);
+            WriteBytes(BLOCK_COMPRESSION_MAGIC, sizeof(BLOCK_COMPRESSION_MAGIC));
+            compressed = true;
+            compression_threads = std::max(1u, std::thread::hardware_concurrency());
+            block.reserve(COMPRESSION_BLOCK_SIZE);
+        }
+    }
+
+    FileWriter(FileWriter &&) = default;
+
+    // Writes the remaining blocks of compressed files
+    ~FileWriter()
+    {
+        if (!compressed)
+            return;
+
+        try
+        {
+            if (!block.empty())
+            {
+                CompressBlock();
+            }
+            while (!pending_blocks.empty())
+            {
+                WritePendingBlock();
+            }
+            const std::uint32_t end[2] = {0, 0};
+            WriteBytes(reinterpret_cast<const char *>(end), sizeof(end));
+        }
+        catch (const std::exception &e)
+        {
+            util::Log(logERROR) << e.what();
+        }
     }
 
     /* Write count objects of type T from pointer src to output stream */
@@ -222,14 +526,13 @@ class FileWriter
         if (count == 0)
             return;
 
-        const auto &result =
-            output_stream.write(reinterpret_cast<const char *>(src), count * sizeof(T));
-
-        if (!result)
+        if (compressed)
         {
-            throw util::RuntimeError(
-                filepath.string(), ErrorCode::FileWriteError, SOURCE_REF, std::strerror(errno));
+            WriteCompressed(reinterpret_cast<const char *>(src), count * sizeof(T));
+            return;
         }
+
+        WriteBytes(reinterpret_cast<const char *>(src), count * sizeof(T));
     }
 
     template <typename T> void WriteFrom(const std::vector<T> &src)
@@ -251,11 +554,13 @@ class FileWriter
 
     template <typename T> void Skip(const std::size_t element_count)
     {
+        CheckSeekable();
         boost::iostreams::seek(output_stream, element_count * sizeof(T), BOOST_IOS::cur);
     }
 
     void SkipToBeginning()
     {
+        CheckSeekable();
         boost::iostreams::seek(output_stream, 0, std::ios::beg);
 
         // If we wrote a Fingerprint, skip over it
@@ -266,9 +571,73 @@ class FileWriter
     }
 
   private:
+    void WriteBytes(const char *data, const std::size_t size)
+    {
+        if (!output_stream.write(data, size))
+        {
+            throw util::RuntimeError(
+                filepath.string(), ErrorCode::FileWriteError, SOURCE_REF, std::strerror(errno));
+        }
+    }
+
+    void WriteCompressed(const char *data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            const auto copied = std::min(size, COMPRESSION_BLOCK_SIZE - block.size());
+            block.append(data, copied);
+            data += copied;
+            size -= copied;
+            if (block.size() == COMPRESSION_BLOCK_SIZE)
+            {
+                CompressBlock();
+            }
+        }
+    }
+
+    // Hands the block to a compression thread, writes the oldest block first if all are busy
+    void CompressBlock()
+    {
+        if (pending_blocks.size() >= compression_threads)
+        {
+            WritePendingBlock();
+        }
+        const auto size = static_cast<std::uint32_t>(block.size());
+        auto compressing = std::async(std::launch::async, [uncompressed = std::move(block)] {
+            return compressBlock(uncompressed);
+        });
+        pending_blocks.emplace_back(size, std::move(compressing));
+        block = std::string();
+        block.reserve(COMPRESSION_BLOCK_SIZE);
+    }
+
+    void WritePendingBlock()
+    {
+        const auto compressed_block = pending_blocks.front().second.get();
+        const std::uint32_t sizes[2] = {pending_blocks.front().first,
+                                        static_cast<std::uint32_t>(compressed_block.size())};
+        pending_blocks.pop_front();
+        WriteBytes(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+        WriteBytes(compressed_block.data(), compressed_block.size());
+    }
+
+    void CheckSeekable() const
+    {
+        if (compressed)
+        {
+            throw util::exception("Can not seek in compressed file " + filepath.string() +
+                                  SOURCE_REF);
+        }
+    }
+
     const boost::filesystem::path filepath;
     boost::filesystem::ofstream output_stream;
     FingerprintFlag fingerprint;
+
+    bool compressed = false;
+    unsigned compression_threads = 0;
+    std::string block;
+    std::deque<std::pair<std::uint32_t, std::future<std::string>>> pending_blocks;
 };
 } // ns io
 } // ns storage
@@ -8,6 +8,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/path.hpp>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -35,6 +36,20 @@ struct IOConfig
         return {base_path.string() + fileName};
     }
 
+    // The paths of all required and optional input files, whether they exist or not
+    std::vector<boost::filesystem::path> GetInputPaths() const
+    {
+        std::vector<boost::filesystem::path> paths;
+        for (const auto &files : {required_input_files, optional_input_files})
+        {
+            for (const auto &file : files)
+            {
+                paths.push_back(base_path.string() + file.string());
+            }
+        }
+        return paths;
+    }
+
     boost::filesystem::path base_path;
 
   protected:
@@ -0,0 +1,70 @@
+#ifndef OSRM_STORAGE_MEMORY_FILE_HPP
+#define OSRM_STORAGE_MEMORY_FILE_HPP
+
+#include "storage/shared_datatype.hpp"
+#include "storage/storage_config.hpp"
+
+#include "util/fingerprint.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace osrm
+{
+namespace storage
+{
+
+// Entry of the table of contents of a memory file, offsets are relative to the start of the file
+struct MemoryFileBlock
+{
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t checksum;
+};
+
+// A memory file holds all blocks of a dataset in a single file, in the layout of the shared
+// memory so it can be mapped or copied into shared memory without parsing the .osrm files.
+// The header is written at the start of the file, the data follows at data_offset. The table of
+// contents describes every block, so blocks can be read and checked one by one.
+struct MemoryFileHeader
+{
+    static constexpr std::uint32_t FORMAT = 1;
+
+    util::FingerPrint fingerprint;
+    std::uint64_t data_offset;
+    DataLayout layout;
+    // 0 in files written before the table of contents was added
+    std::uint32_t format;
+    MemoryFileBlock blocks[DataLayout::NUM_BLOCKS];
+};
+static_assert(std::is_trivially_copyable<MemoryFileHeader>::value,
+              "MemoryFileHeader is copied into the file as is");
+
+// True if the memory file exists and none of the .osrm files it is written from is newer
+bool isMemoryFileCurrent(const StorageConfig &config, const boost::filesystem::path &memory_file);
+
+// Reads the header of a memory file of the given size and checks that it fits this version of
+// OSRM and that the file holds all its blocks, false otherwise
+bool readMemoryFileHeader(const char *file, const std::size_t size, MemoryFileHeader &header);
+
+// Writes the memory file from the .osrm files of config next to its final path and moves it
+// there once it is complete, other processes never map a partial file
+void writeMemoryFile(const StorageConfig &config, const boost::filesystem::path &memory_file);
+
+// Maps the memory file read-only and reads its header. The file is written first if it is
+// missing, older than the .osrm files or incompatible. Throws if it can not be mapped.
+void openMemoryFile(const StorageConfig &config,
+                    const boost::filesystem::path &memory_file,
+                    boost::iostreams::mapped_file_source &mapped_memory,
+                    MemoryFileHeader &header);
+
+// The checksum of the bytes of a block that is stored in the table of contents
+std::uint32_t checksumBlock(const char *begin, const std::uint64_t size);
+}
+}
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "storage/io.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 
@@ -31,36 +32,37 @@ namespace serialization
 template <typename T>
 inline void read(storage::io::FileReader &reader, util::DeallocatingVector<T> &vec)
 {
-    vec.current_size = reader.ReadElementCount64(vec.current_size);
-    std::size_t num_blocks =
-        std::ceil(vec.current_size / util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK);
+    constexpr auto ELEMENTS_PER_BLOCK = util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK;
+    vec.clear();
+    vec.current_size = reader.ReadElementCount64();
+    // as many blocks as a resize would keep, the last one can be partial or empty
+    const std::size_t num_blocks = 1 + vec.current_size / ELEMENTS_PER_BLOCK;
     vec.bucket_list.resize(num_blocks);
-    // Read all but the last block which can be partital
-    for (auto bucket_index : util::irange<std::size_t>(0, num_blocks - 1))
+    for (auto bucket_index : util::irange<std::size_t>(0, num_blocks))
     {
-        vec.bucket_list[bucket_index] = new T[util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK];
-        reader.ReadInto(vec.bucket_list[bucket_index],
-                        util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK);
+        vec.bucket_list[bucket_index] = util::detail::allocateBucket<T>();
+        const std::size_t block_size =
+            std::min(ELEMENTS_PER_BLOCK, vec.current_size - bucket_index * ELEMENTS_PER_BLOCK);
+        reader.ReadInto(vec.bucket_list[bucket_index], block_size);
     }
-    std::size_t last_block_size =
-        vec.current_size % util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK;
-    vec.bucket_list.back() = new T[util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK];
-    reader.ReadInto(vec.bucket_list.back(), last_block_size);
 }
 
 template <typename T>
 inline void write(storage::io::FileWriter &writer, const util::DeallocatingVector<T> &vec)
 {
+    constexpr auto ELEMENTS_PER_BLOCK = util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK;
     writer.WriteElementCount64(vec.current_size);
-    // Write all but the last block which can be partially filled
-    for (auto bucket_index : util::irange<std::size_t>(0, vec.bucket_list.size() - 1))
+    // Write all full blocks, the last one can be partially filled
+    const std::size_t full_blocks = vec.current_size / ELEMENTS_PER_BLOCK;
+    for (auto bucket_index : util::irange<std::size_t>(0, full_blocks))
     {
-        writer.WriteFrom(vec.bucket_list[bucket_index],
-                         util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK);
+        writer.WriteFrom(vec.bucket_list[bucket_index], ELEMENTS_PER_BLOCK);
+    }
+    const std::size_t last_block_size = vec.current_size % ELEMENTS_PER_BLOCK;
+    if (last_block_size > 0)
+    {
+        writer.WriteFrom(vec.bucket_list[full_blocks], last_block_size);
     }
-    std::size_t last_block_size =
-        vec.current_size % util::DeallocatingVector<T>::ELEMENTS_PER_BLOCK;
-    writer.WriteFrom(vec.bucket_list.back(), last_block_size);
 }
 
 #if USE_STXXL_LIBRARY
@@ -26,14 +26,16 @@ const constexpr char *block_id_to_name[] = {"NAME_CHAR_DATA",
                                             "CLASSES_LIST",
                                             "CH_GRAPH_NODE_LIST",
                                             "CH_GRAPH_EDGE_LIST",
+                                            "CH_GRAPH_SEARCH_EDGE_LIST",
                                             "COORDINATE_LIST",
                                             "OSM_NODE_ID_LIST",
-                                            "TURN_INSTRUCTION",
-                                            "ENTRY_CLASSID",
+                                            "TURN_DATA",
                                             "R_SEARCH_TREE",
                                             "R_SEARCH_TREE_LEVELS",
                                             "GEOMETRIES_INDEX",
                                             "GEOMETRIES_NODE_LIST",
+                                            "GEOMETRIES_NODE_BLOCKS",
+                                            "GEOMETRIES_NODE_DELTAS",
                                             "GEOMETRIES_FWD_WEIGHT_LIST",
                                             "GEOMETRIES_REV_WEIGHT_LIST",
                                             "GEOMETRIES_FWD_DURATION_LIST",
@@ -48,12 +50,8 @@ const constexpr char *block_id_to_name[] = {"NAME_CHAR_DATA",
                                             "PROPERTIES",
                                             "BEARING_CLASSID",
                                             "BEARING_OFFSETS",
-                                            "BEARING_BLOCKS",
                                             "BEARING_VALUES",
                                             "ENTRY_CLASS",
-                                            "LANE_DATA_ID",
-                                            "PRE_TURN_BEARING",
-                                            "POST_TURN_BEARING",
                                             "TURN_LANE_DATA",
                                             "LANE_DESCRIPTION_OFFSETS",
                                             "LANE_DESCRIPTION_MASKS",
@@ -64,13 +62,21 @@ const constexpr char *block_id_to_name[] = {"NAME_CHAR_DATA",
                                             "MLD_CELL_TO_CHILDREN",
                                             "MLD_CELL_WEIGHTS",
                                             "MLD_CELL_DURATIONS",
+                                            "MLD_CELL_DISTANCES",
+                                            "MLD_CELL_WEIGHT_CODES",
+                                            "MLD_CELL_DURATION_CODES",
+                                            "MLD_CELL_QUANTIZED_ROWS",
+                                            "MLD_CELL_QUANTIZED_EXCEPTIONS",
                                             "MLD_CELL_SOURCE_BOUNDARY",
                                             "MLD_CELL_DESTINATION_BOUNDARY",
                                             "MLD_CELLS",
                                             "MLD_CELL_LEVEL_OFFSETS",
                                             "MLD_GRAPH_NODE_LIST",
                                             "MLD_GRAPH_EDGE_LIST",
-                                            "MLD_GRAPH_NODE_TO_OFFSET"};
+                                            "MLD_GRAPH_SEARCH_EDGE_LIST",
+                                            "MLD_GRAPH_NODE_TO_OFFSET",
+                                            "CONDITIONAL_TURN_MASKS",
+                                            "MLD_LANDMARKS"};
 
 struct DataLayout
 {
@@ -84,14 +90,16 @@ struct DataLayout
         CLASSES_LIST,
         CH_GRAPH_NODE_LIST,
         CH_GRAPH_EDGE_LIST,
+        CH_GRAPH_SEARCH_EDGE_LIST,
         COORDINATE_LIST,
         OSM_NODE_ID_LIST,
-        TURN_INSTRUCTION,
-        ENTRY_CLASSID,
+        TURN_DATA,
         R_SEARCH_TREE,
         R_SEARCH_TREE_LEVELS,
         GEOMETRIES_INDEX,
         GEOMETRIES_NODE_LIST,
+        GEOMETRIES_NODE_BLOCKS,
+        GEOMETRIES_NODE_DELTAS,
         GEOMETRIES_FWD_WEIGHT_LIST,
         GEOMETRIES_REV_WEIGHT_LIST,
         GEOMETRIES_FWD_DURATION_LIST,
@@ -106,12 +114,8 @@ struct DataLayout
         PROPERTIES,
         BEARING_CLASSID,
         BEARING_OFFSETS,
-        BEARING_BLOCKS,
         BEARING_VALUES,
         ENTRY_CLASS,
-        LANE_DATA_ID,
-        PRE_TURN_BEARING,
-        POST_TURN_BEARING,
         TURN_LANE_DATA,
         LANE_DESCRIPTION_OFFSETS,
         LANE_DESCRIPTION_MASKS,
@@ -122,16 +126,73 @@ struct DataLayout
         MLD_CELL_TO_CHILDREN,
         MLD_CELL_WEIGHTS,
         MLD_CELL_DURATIONS,
+        MLD_CELL_DISTANCES,
+        MLD_CELL_WEIGHT_CODES,
+        MLD_CELL_DURATION_CODES,
+        MLD_CELL_QUANTIZED_ROWS,
+        MLD_CELL_QUANTIZED_EXCEPTIONS,
         MLD_CELL_SOURCE_BOUNDARY,
         MLD_CELL_DESTINATION_BOUNDARY,
         MLD_CELLS,
         MLD_CELL_LEVEL_OFFSETS,
         MLD_GRAPH_NODE_LIST,
         MLD_GRAPH_EDGE_LIST,
+        MLD_GRAPH_SEARCH_EDGE_LIST,
         MLD_GRAPH_NODE_TO_OFFSET,
+        CONDITIONAL_TURN_MASKS,
+        MLD_LANDMARKS,
         NUM_BLOCKS
     };
 
+    // The blocks are split in two parts: the metric part holds all blocks that are rewritten by
+    // traffic updates, the static part everything else. Each part has its own memory, so a new
+    // metric part can be loaded next to the static part that is in use.
+    enum Part
+    {
+        STATIC_PART = 0,
+        METRIC_PART,
+        NUM_PARTS
+    };
+
+    // Start of the memory of each part, nullptr if the part isn't loaded
+    using Memory = std::array<char *, NUM_PARTS>;
+
+    static Part GetPart(BlockID bid)
+    {
+        switch (bid)
+        {
+        case HSGR_CHECKSUM:
+        case CH_GRAPH_NODE_LIST:
+        case CH_GRAPH_EDGE_LIST:
+        case CH_GRAPH_SEARCH_EDGE_LIST:
+        case CH_CORE_MARKER:
+        case GEOMETRIES_FWD_WEIGHT_LIST:
+        case GEOMETRIES_REV_WEIGHT_LIST:
+        case GEOMETRIES_FWD_DURATION_LIST:
+        case GEOMETRIES_REV_DURATION_LIST:
+        case GEOMETRIES_FWD_DATASOURCES_LIST:
+        case GEOMETRIES_REV_DATASOURCES_LIST:
+        case DATASOURCES_NAMES:
+        case TURN_WEIGHT_PENALTIES:
+        case TURN_DURATION_PENALTIES:
+        case MLD_CELL_WEIGHTS:
+        case MLD_CELL_DURATIONS:
+        case MLD_CELL_DISTANCES:
+        case MLD_CELL_WEIGHT_CODES:
+        case MLD_CELL_DURATION_CODES:
+        case MLD_CELL_QUANTIZED_ROWS:
+        case MLD_CELL_QUANTIZED_EXCEPTIONS:
+        case MLD_GRAPH_NODE_LIST:
+        case MLD_GRAPH_EDGE_LIST:
+        case MLD_GRAPH_SEARCH_EDGE_LIST:
+        case MLD_GRAPH_NODE_TO_OFFSET:
+        case MLD_LANDMARKS:
+            return METRIC_PART;
+        default:
+            return STATIC_PART;
+        }
+    }
+
     std::array<std::uint64_t, NUM_BLOCKS> num_entries;
     std::array<std::size_t, NUM_BLOCKS> entry_size;
     std::array<std::size_t, NUM_BLOCKS> entry_align;
@@ -158,17 +219,30 @@ struct DataLayout
         return num_entries[bid] * entry_size[bid];
     }
 
-    inline uint64_t GetSizeOfLayout() const
+    inline uint64_t GetSizeOfPart(Part part) const
     {
         uint64_t result = 0;
         for (auto i = 0; i < NUM_BLOCKS; i++)
         {
+            if (GetPart((BlockID)i) != part)
+                continue;
             BOOST_ASSERT(entry_align[i] > 0);
             result += 2 * sizeof(CANARY) + GetBlockSize((BlockID)i) + entry_align[i];
         }
         return result;
     }
 
+    inline uint64_t GetSizeOfLayout() const
+    {
+        return GetSizeOfPart(STATIC_PART) + GetSizeOfPart(METRIC_PART);
+    }
+
+    // The memory of the parts if they are stored one after another, static part first
+    inline Memory GetContiguousMemory(char *memory) const
+    {
+        return Memory{{memory, memory + GetSizeOfPart(STATIC_PART)}};
+    }
+
     // \brief Fit aligned storage in buffer.
     // Interface Similar to [ptr.align] but omits space computation.
     // The method can be removed and changed directly to an std::align
@@ -180,10 +254,13 @@ struct DataLayout
         return ptr = reinterpret_cast<void *>(aligned);
     }
 
+    // ptr is the start of the memory of the part of the block
     inline void *GetAlignedBlockPtr(void *ptr, BlockID bid) const
     {
         for (auto i = 0; i < bid; i++)
         {
+            if (GetPart((BlockID)i) != GetPart(bid))
+                continue;
             ptr = static_cast<char *>(ptr) + sizeof(CANARY);
             ptr = align(entry_align[i], entry_size[i], ptr);
             ptr = static_cast<char *>(ptr) + GetBlockSize((BlockID)i);
@@ -195,16 +272,17 @@ struct DataLayout
         return ptr;
     }
 
-    template <typename T> inline T *GetBlockEnd(char *shared_memory, BlockID bid) const
+    template <typename T> inline T *GetBlockEnd(const Memory &memory, BlockID bid) const
     {
-        auto begin = GetBlockPtr<T>(shared_memory, bid);
+        auto begin = GetBlockPtr<T>(memory, bid);
         return begin + GetBlockEntries(bid);
     }
 
     template <typename T, bool WRITE_CANARY = false>
-    inline T *GetBlockPtr(char *shared_memory, BlockID bid) const
+    inline T *GetBlockPtr(const Memory &memory, BlockID bid) const
     {
-        char *ptr = (char *)GetAlignedBlockPtr(shared_memory, bid);
+        BOOST_ASSERT_MSG(memory[GetPart(bid)] != nullptr, "part of the block is not loaded");
+        char *ptr = (char *)GetAlignedBlockPtr(memory[GetPart(bid)], bid);
         if (WRITE_CANARY)
         {
             char *start_canary_ptr = ptr - sizeof(CANARY);
@@ -234,23 +312,54 @@ struct DataLayout
     }
 };
 
+// REGION_1 and REGION_2 take turns holding the static part of the data, REGION_3 and REGION_4
+// the metric part
 enum SharedDataType
 {
     REGION_NONE,
     REGION_1,
-    REGION_2
+    REGION_2,
+    REGION_3,
+    REGION_4
+};
+
+inline bool isMetricRegion(const SharedDataType region)
+{
+    return region == REGION_3 || region == REGION_4;
+}
+
+// A shared memory segment osrm-datastore published. Marking a segment for removal frees its
+// region id right away, the segment itself lives on until the last process detached it, so
+// clients can still be draining any number of older generations while a new one is published.
+struct SharedSegment
+{
+    int segment_id;
+    SharedDataType region;
+    // of the update that published the segment
+    unsigned timestamp;
+    std::uint64_t size;
 };
 
 struct SharedDataTimestamp
 {
-    explicit SharedDataTimestamp(SharedDataType region, unsigned timestamp)
-        : region(region), timestamp(timestamp)
+    explicit SharedDataTimestamp(SharedDataType static_region,
+                                 SharedDataType metric_region,
+                                 unsigned timestamp)
+        : static_region(static_region), metric_region(metric_region), timestamp(timestamp),
+          segments(), num_segments(0)
     {
     }
 
-    SharedDataType region;
+    SharedDataType static_region;
+    SharedDataType metric_region;
     unsigned timestamp;
 
+    // The segments published by earlier updates that may still exist, the ones in use included,
+    // oldest first. Destroyed segments are only dropped by the next update.
+    static constexpr std::size_t MAX_SEGMENTS = 32;
+    std::array<SharedSegment, MAX_SEGMENTS> segments;
+    std::size_t num_segments;
+
     static constexpr const char *name = "osrm-region";
 };
 
@@ -262,6 +371,10 @@ inline std::string regionToString(const SharedDataType region)
         return "REGION_1";
     case REGION_2:
         return "REGION_2";
+    case REGION_3:
+        return "REGION_3";
+    case REGION_4:
+        return "REGION_4";
     case REGION_NONE:
         return "REGION_NONE";
     default:
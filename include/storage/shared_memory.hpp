@@ -3,6 +3,7 @@
 
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
+#include "util/huge_pages.hpp"
 #include "util/log.hpp"
 
 #include <boost/filesystem.hpp>
@@ -19,7 +20,21 @@
 #include <sys/shm.h>
 #endif
 
+#if defined(OSRM_POSIX_SHARED_MEMORY) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/magic.h>
+#include <sys/vfs.h>
+#endif
+#endif
+
+#include <cerrno>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 #include <algorithm>
 #include <exception>
@@ -42,11 +57,12 @@ struct OSRMLockFile
     }
 };
 
-#ifndef _WIN32
+#if !defined(_WIN32) && !defined(OSRM_POSIX_SHARED_MEMORY)
 class SharedMemory
 {
   public:
     void *Ptr() const { return region.get_address(); }
+    std::size_t Size() const { return region.get_size(); }
 
     SharedMemory(const SharedMemory &) = delete;
     SharedMemory &operator=(const SharedMemory &) = delete;
@@ -54,7 +70,9 @@ class SharedMemory
     template <typename IdentifierT>
     SharedMemory(const boost::filesystem::path &lock_file,
                  const IdentifierT id,
-                 const uint64_t size = 0)
+                 const uint64_t size = 0,
+                 const bool use_huge_pages = false,
+                 const bool lock_memory = true)
         : key(lock_file.string().c_str(), id)
     {
         // open only
@@ -69,20 +87,47 @@ class SharedMemory
         // open or create
         else
         {
+            bool has_huge_pages = false;
+#ifdef __linux__
+            // boost can not create segments of huge pages, so it opens the one we created
+            if (use_huge_pages)
+            {
+                const auto huge_pages_size = util::roundToHugePages(size);
+                has_huge_pages =
+                    -1 != ::shmget(key.get_key(), huge_pages_size, IPC_CREAT | SHM_HUGETLB | 0644);
+                if (!has_huge_pages)
+                {
+                    util::Log(logWARNING) << "could not allocate " << huge_pages_size
+                                          << " bytes of huge pages for shared memory: "
+                                          << std::strerror(errno)
+                                          << ", falling back to transparent huge pages";
+                }
+            }
+#endif
             shm = boost::interprocess::xsi_shared_memory(
                 boost::interprocess::open_or_create, key, size);
             util::Log(logDEBUG) << "opening/creating " << shm.get_shmid() << " from id " << id
                                 << " with size " << size;
 #ifdef __linux__
-            if (-1 == shmctl(shm.get_shmid(), SHM_LOCK, nullptr))
+            // the limit of locked memory applies to all segments the user locked together
+            if (lock_memory && -1 == shmctl(shm.get_shmid(), SHM_LOCK, nullptr))
             {
-                if (ENOMEM == errno)
-                {
-                    util::Log(logWARNING) << "could not lock shared memory to RAM";
-                }
+                util::Log(logWARNING) << "could not lock " << size
+                                      << " bytes of shared memory to RAM: " << std::strerror(errno)
+                                      << ". The limit of locked memory is "
+                                      << util::describeLockedMemoryLimit()
+                                      << ", raise RLIMIT_MEMLOCK with ulimit -l or LimitMEMLOCK= "
+                                         "of a systemd unit";
             }
 #endif
             region = boost::interprocess::mapped_region(shm, boost::interprocess::read_write);
+
+            if (use_huge_pages && !has_huge_pages &&
+                !util::adviseHugePages(region.get_address(), region.get_size()))
+            {
+                util::Log(logWARNING) << "transparent huge pages are not available for shared "
+                                         "memory, using regular pages";
+            }
         }
     }
 
@@ -109,55 +154,22 @@ class SharedMemory
         return Remove(key);
     }
 
+    int SegmentID() const { return shm.get_shmid(); }
+
 #ifdef __linux__
-    void WaitForDetach()
+    // The size of the segment, 0 once the last process detached from a removed segment
+    static std::uint64_t SegmentSize(const int segment_id)
     {
-        auto shmid = shm.get_shmid();
         ::shmid_ds xsi_ds;
-        const auto errorToMessage = [](int error) -> std::string {
-            switch (error)
-            {
-            case EPERM:
-                return "EPERM";
-                break;
-            case EACCES:
-                return "ACCESS";
-                break;
-            case EINVAL:
-                return "EINVAL";
-                break;
-            case EFAULT:
-                return "EFAULT";
-                break;
-            default:
-                return "Unknown Error " + std::to_string(error);
-                break;
-            }
-        };
-
-        do
+        if (::shmctl(segment_id, IPC_STAT, &xsi_ds) < 0)
         {
-            // On OSX this returns EINVAL for whatever reason, hence we need to disable it
-            int ret = ::shmctl(shmid, IPC_STAT, &xsi_ds);
-            if (ret < 0)
-            {
-                auto error_code = errno;
-                throw util::exception("shmctl encountered an error: " + errorToMessage(error_code) +
-                                      SOURCE_REF);
-            }
-            BOOST_ASSERT(ret >= 0);
-
-            std::this_thread::sleep_for(std::chrono::microseconds(100));
-        } while (xsi_ds.shm_nattch > 1);
+            return 0;
+        }
+        return xsi_ds.shm_segsz;
     }
 #else
-    void WaitForDetach()
-    {
-        util::Log(logDEBUG)
-            << "Shared memory support for non-Linux systems does not wait for clients to "
-               "dettach. Going to sleep for 50ms.";
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
+    // On OSX IPC_STAT returns EINVAL, segments are reported as destroyed
+    static std::uint64_t SegmentSize(const int) { return 0; }
 #endif
 
   private:
@@ -191,6 +203,144 @@ class SharedMemory
     boost::interprocess::xsi_shared_memory shm;
     boost::interprocess::mapped_region region;
 };
+#elif !defined(_WIN32)
+// Shared memory in files of /dev/shm or of the directory in OSRM_SHARED_MEMORY_DIR, e.g. a
+// hugetlbfs mount or a memory backed volume of a container. Unlike System V segments they are not
+// limited by kernel.shmmax and can be listed and removed like any file. Removing a file frees its
+// name right away and its memory once the last process unmapped it.
+class SharedMemory
+{
+  public:
+    void *Ptr() const { return address; }
+    std::size_t Size() const { return size; }
+
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    template <typename IdentifierT>
+    SharedMemory(const boost::filesystem::path &,
+                 const IdentifierT id,
+                 const uint64_t size = 0,
+                 const bool use_huge_pages = false,
+                 const bool lock_memory = true)
+    {
+        const auto path = RegionPath(id);
+        // open only, readers can not write to the file
+        if (0 == size)
+        {
+            const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct ::stat status;
+            if (file < 0 || ::fstat(file, &status) < 0)
+            {
+                Fail(file, "could not open shared memory " + path);
+            }
+            util::Log(logDEBUG) << "opening " << path;
+            Map(file, status.st_size, PROT_READ);
+        }
+        // open or create
+        else
+        {
+            // the size of a file on hugetlbfs has to be a whole number of huge pages
+            const bool has_huge_pages = IsHugeTLBFS(Directory());
+            const uint64_t file_size = has_huge_pages ? util::roundToHugePages(size) : size;
+            const int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (file < 0 || ::ftruncate(file, file_size) < 0)
+            {
+                Fail(file, "could not allocate " + std::to_string(file_size) +
+                               " bytes of shared memory in " + path);
+            }
+            util::Log(logDEBUG) << "opening/creating " << path << " with size " << file_size;
+            Map(file, file_size, PROT_READ | PROT_WRITE);
+
+            if (use_huge_pages && !has_huge_pages && !util::adviseHugePages(address, this->size))
+            {
+                util::Log(logWARNING) << "transparent huge pages are not available for shared "
+                                         "memory, using regular pages. Point "
+                                         "OSRM_SHARED_MEMORY_DIR to a hugetlbfs mount to use "
+                                         "reserved huge pages";
+            }
+            // pages of a file can only be locked while a process maps them
+            if (lock_memory)
+            {
+                util::Log(logDEBUG) << "shared memory in files is not locked to RAM";
+            }
+        }
+    }
+
+    ~SharedMemory()
+    {
+        if (address != nullptr)
+        {
+            ::munmap(address, size);
+        }
+    }
+
+    template <typename IdentifierT> static bool RegionExists(const IdentifierT id)
+    {
+        struct ::stat status;
+        return ::stat(RegionPath(id).c_str(), &status) == 0;
+    }
+
+    template <typename IdentifierT> static bool Remove(const IdentifierT id)
+    {
+        util::Log(logDEBUG) << "deallocating prev memory " << RegionPath(id);
+        return ::unlink(RegionPath(id).c_str()) == 0;
+    }
+
+    // Removed files can not be looked up, so they are reported as destroyed
+    int SegmentID() const { return -1; }
+    static std::uint64_t SegmentSize(const int) { return 0; }
+
+  private:
+    static std::string Directory()
+    {
+        const auto directory = std::getenv("OSRM_SHARED_MEMORY_DIR");
+        return directory != nullptr ? directory : "/dev/shm";
+    }
+
+    template <typename IdentifierT> static std::string RegionPath(const IdentifierT id)
+    {
+        return Directory() + "/osrm-region-" + std::to_string(static_cast<int>(id));
+    }
+
+    static bool IsHugeTLBFS(const std::string &directory)
+    {
+#ifdef __linux__
+        struct ::statfs status;
+        return ::statfs(directory.c_str(), &status) == 0 &&
+               static_cast<unsigned long>(status.f_type) == HUGETLBFS_MAGIC;
+#else
+        (void)directory;
+        return false;
+#endif
+    }
+
+    [[noreturn]] static void Fail(const int file, const std::string &message)
+    {
+        const auto error = std::strerror(errno);
+        if (file >= 0)
+        {
+            ::close(file);
+        }
+        throw util::exception(message + ": " + error + SOURCE_REF);
+    }
+
+    // the mapping stays valid once the file is closed
+    void Map(const int file, const uint64_t file_size, const int protection)
+    {
+        const auto mapping = ::mmap(nullptr, file_size, protection, MAP_SHARED, file, 0);
+        if (mapping == MAP_FAILED)
+        {
+            Fail(file, "could not map " + std::to_string(file_size) + " bytes of shared memory");
+        }
+        ::close(file);
+        address = mapping;
+        size = file_size;
+    }
+
+    void *address = nullptr;
+    std::size_t size = 0;
+};
 #else
 // Windows - specific code
 class SharedMemory
@@ -200,9 +350,19 @@ class SharedMemory
 
   public:
     void *Ptr() const { return region.get_address(); }
+    std::size_t Size() const { return region.get_size(); }
 
-    SharedMemory(const boost::filesystem::path &lock_file, const int id, const uint64_t size = 0)
+    SharedMemory(const boost::filesystem::path &lock_file,
+                 const int id,
+                 const uint64_t size = 0,
+                 const bool use_huge_pages = false,
+                 const bool lock_memory = true)
     {
+        (void)lock_memory;
+        if (use_huge_pages)
+        {
+            util::Log(logWARNING) << "Huge pages are not supported for shared memory on Windows";
+        }
         sprintf(key, "%s.%d", "osrm.lock", id);
         if (0 == size)
         { // read_only
@@ -244,13 +404,9 @@ class SharedMemory
         return Remove(k);
     }
 
-    void WaitForDetach()
-    {
-        // FIXME this needs an implementation for Windows
-        util::Log(logDEBUG) << "Shared memory support for Windows does not wait for clients to "
-                               "dettach. Going to sleep for 50ms.";
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
+    // Named shared memory has no segment ids, segments are reported as destroyed
+    int SegmentID() const { return -1; }
+    static std::uint64_t SegmentSize(const int) { return 0; }
 
   private:
     static void build_key(int id, char *key) { sprintf(key, "%s.%d", "osrm.lock", id); }
@@ -283,7 +439,10 @@ class SharedMemory
 #endif
 
 template <typename IdentifierT, typename LockFileT = OSRMLockFile>
-std::unique_ptr<SharedMemory> makeSharedMemory(const IdentifierT &id, const uint64_t size = 0)
+std::unique_ptr<SharedMemory> makeSharedMemory(const IdentifierT &id,
+                                               const uint64_t size = 0,
+                                               const bool use_huge_pages = false,
+                                               const bool lock_memory = true)
 {
     try
     {
@@ -299,7 +458,8 @@ std::unique_ptr<SharedMemory> makeSharedMemory(const IdentifierT &id, const uint
                 boost::filesystem::ofstream ofs(lock_file());
             }
         }
-        return std::make_unique<SharedMemory>(lock_file(), id, size);
+        return std::make_unique<SharedMemory>(
+            lock_file(), id, size, use_huge_pages, lock_memory);
     }
     catch (const boost::interprocess::interprocess_exception &e)
     {
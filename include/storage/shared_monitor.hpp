@@ -54,6 +54,15 @@ template <typename Data> struct SharedMonitor
         }
         else
         {
+            // a block created by an older version has a different layout
+            if (size != internal_size + sizeof(Data))
+            {
+                auto message = boost::format("Wrong shared memory block '%1%' size %2%, expected "
+                                             "%3% bytes, remove it with osrm-datastore "
+                                             "--remove-locks") %
+                               (const char *)Data::name % size % (internal_size + sizeof(Data));
+                throw util::exception(message.str() + SOURCE_REF);
+            }
             region = bi::mapped_region(shmem, bi::read_write);
         }
     }
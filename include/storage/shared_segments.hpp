@@ -0,0 +1,74 @@
+#ifndef OSRM_STORAGE_SHARED_SEGMENTS_HPP
+#define OSRM_STORAGE_SHARED_SEGMENTS_HPP
+
+#include "storage/shared_datatype.hpp"
+#include "storage/shared_memory.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace storage
+{
+
+// The datasets in shared memory that still have a segment, either because they are in use or
+// because some process has not detached from them yet, and the bytes of all their segments
+struct SharedGenerations
+{
+    std::uint64_t generations = 0;
+    std::uint64_t bytes = 0;
+};
+
+// A segment id can be given to a new segment once the old one is destroyed, the size tells them
+// apart in most cases
+inline bool segmentExists(const SharedSegment &segment)
+{
+    return SharedMemory::SegmentSize(segment.segment_id) == segment.size;
+}
+
+// Every update publishes a new metric segment, so there is one per generation
+inline SharedGenerations countGenerations(const SharedDataTimestamp &data)
+{
+    SharedGenerations result;
+    for (std::size_t index = 0; index < data.num_segments; ++index)
+    {
+        const auto &segment = data.segments[index];
+        if (segmentExists(segment))
+        {
+            result.generations += isMetricRegion(segment.region);
+            result.bytes += segment.size;
+        }
+    }
+    return result;
+}
+
+// Drops the destroyed segments and appends the new ones, if they do not fit the oldest ones are
+// dropped as well. Returns false if a segment that still exists had to be dropped.
+inline bool recordSegments(SharedDataTimestamp &data, const std::vector<SharedSegment> &segments)
+{
+    const auto end = std::remove_if(data.segments.begin(),
+                                    data.segments.begin() + data.num_segments,
+                                    [](const SharedSegment &segment) {
+                                        return !segmentExists(segment);
+                                    });
+    data.num_segments = end - data.segments.begin();
+
+    bool complete = true;
+    for (const auto &segment : segments)
+    {
+        if (data.num_segments == SharedDataTimestamp::MAX_SEGMENTS)
+        {
+            complete = false;
+            std::copy(data.segments.begin() + 1, data.segments.end(), data.segments.begin());
+            --data.num_segments;
+        }
+        data.segments[data.num_segments++] = segment;
+    }
+    return complete;
+}
+}
+}
+
+#endif
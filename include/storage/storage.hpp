@@ -44,12 +44,22 @@ class Storage
   public:
     Storage(StorageConfig config);
 
-    int Run(int max_wait);
+    // With only_metric a new metric region is loaded next to the static region in use. With
+    // lock_memory the regions are locked into RAM.
+    int Run(int max_wait,
+            bool use_huge_pages,
+            bool interleave_numa_nodes,
+            bool only_metric,
+            bool lock_memory);
 
+    // Both read the memory file of the config instead of the .osrm files if it has one
     void PopulateLayout(DataLayout &layout);
-    void PopulateData(const DataLayout &layout, char *memory_ptr);
+    // Loads the metric part and, if memory of it is given, the static part
+    void PopulateData(const DataLayout &layout, const DataLayout::Memory &memory);
 
   private:
+    void PopulateDataFromMemoryFile(const DataLayout &layout, const DataLayout::Memory &memory);
+
     StorageConfig config;
 };
 }
@@ -65,14 +65,25 @@ struct StorageConfig final : IOConfig
                     ".osrm.nbg_nodes",
                     ".osrm.ebg_nodes",
                     ".osrm.core",
+                    ".osrm.cch",
                     ".osrm.cells",
                     ".osrm.mldgr",
                     ".osrm.tld",
                     ".osrm.tls",
-                    ".osrm.partition"},
+                    ".osrm.partition",
+                    ".osrm.conditional_turn_masks",
+                    ".osrm.landmarks"},
                    {})
     {
     }
+
+    // Store the node ids of the geometries delta encoded, which saves memory at the cost of
+    // decoding them on every access, see util::DeltaVector
+    bool compress_geometry = false;
+
+    // Read the data from this memory file instead of the .osrm files, which is written from them
+    // first when it is missing or older than them, see storage::writeMemoryFile
+    boost::filesystem::path memory_file;
 };
 }
 }
@@ -0,0 +1,64 @@
+#ifndef OSRM_UPDATER_BINARY_SOURCE_HPP
+#define OSRM_UPDATER_BINARY_SOURCE_HPP
+
+#include "updater/source.hpp"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace osrm
+{
+namespace updater
+{
+namespace binary
+{
+
+// A binary segment speed file starts with this header in the byte order of the machine. The
+// datasource name follows with name_length bytes, padded with zeros to a multiple of 8 bytes,
+// then num_records records sorted by ascending (from, to) without duplicates.
+struct SegmentFileHeader
+{
+    static constexpr std::uint32_t VERSION = 1;
+
+    // "OSRMSPD" followed by a zero
+    char magic[8];
+    std::uint32_t version;
+    // an empty name uses the file name as datasource name
+    std::uint32_t name_length;
+    std::uint64_t num_records;
+};
+static_assert(sizeof(SegmentFileHeader) == 24, "SegmentFileHeader is part of the file format");
+
+// Speed in km/h and the optional rate of a segment, NaN if there is none
+struct SegmentRecord
+{
+    std::uint64_t from;
+    std::uint64_t to;
+    std::uint32_t speed;
+    std::uint32_t reserved;
+    double rate;
+};
+static_assert(sizeof(SegmentRecord) == 32, "SegmentRecord is part of the file format");
+static_assert(std::is_trivially_copyable<SegmentRecord>::value,
+              "SegmentRecord is mapped from the file as is");
+
+// True if the file starts with the header of a binary segment speed file
+bool isSegmentFile(const std::string &path);
+
+// The datasource name stored in a binary segment speed file, empty if it has none
+std::string readSegmentFileName(const std::string &path);
+
+// Maps a binary segment speed file and tags its values with the source. Records in file order
+// are only copied, files that are not sorted are sorted with the last record of a key winning.
+SegmentLookupTable readSegmentValues(const std::string &path, const std::uint8_t source);
+
+// Writes the values of the lookup as binary segment speed file with the datasource name
+void writeSegmentValues(const std::string &path,
+                        const std::string &name,
+                        const SegmentLookupTable &lookup);
+}
+}
+}
+
+#endif
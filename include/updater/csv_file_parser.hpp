@@ -6,36 +6,181 @@
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/log.hpp"
+#include "util/msb.hpp"
 
 #include <tbb/parallel_for.h>
-#include <tbb/parallel_sort.h>
-#include <tbb/spin_mutex.h>
+#include <tbb/task_scheduler_init.h>
 
+#include <boost/assert.hpp>
 #include <boost/exception/diagnostic_information.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/format.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
-#include <boost/spirit/include/phoenix.hpp>
-#include <boost/spirit/include/qi.hpp>
+#include <boost/spirit/include/qi_parse.hpp>
+#include <boost/spirit/include/qi_real.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osrm
 {
 namespace updater
 {
+namespace csv
+{
+namespace detail
+{
+// The eight bytes at first with the first one in the lowest byte, regardless of the byte order
+inline std::uint64_t loadChunk(const char *first)
+{
+    std::uint64_t chunk = 0;
+    for (std::size_t index = 0; index < 8; ++index)
+    {
+        chunk |= std::uint64_t{static_cast<unsigned char>(first[index])} << (8 * index);
+    }
+    return chunk;
+}
+
+// Number of digits at the start of a chunk after '0' was subtracted from every byte. The high
+// bit of a byte is set if it is no digit, the borrows and carries of the subtraction and
+// addition only spoil the bytes after the first one that is no digit.
+inline std::size_t countLeadingDigits(const std::uint64_t values)
+{
+    const auto non_digits = ((values + 0x7676767676767676) | values) & 0x8080808080808080;
+    if (non_digits == 0)
+    {
+        return 8;
+    }
+    return util::msb(non_digits & (~non_digits + 1)) / 8;
+}
+
+// Value of the leading digits of a chunk after '0' was subtracted from every byte. The digits
+// are moved to the top so the bytes below become leading zeros, then neighbouring bytes,
+// half-words and words are combined with one multiplication each.
+inline std::uint64_t convertDigits(std::uint64_t values, const std::size_t num_digits)
+{
+    BOOST_ASSERT(num_digits > 0 && num_digits <= 8);
+    values <<= 8 * (8 - num_digits);
+    values = ((values & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+    values = ((values & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+    return ((values & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+}
+
+inline bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+
+inline bool isEndOfLine(const char *first, const char *last)
+{
+    return first == last || *first == '\n' || *first == '\r';
+}
+}
+
+// Parses an unsigned number without sign, eight digits at a time where the input is long enough.
+// Fails without consuming input if there is no digit or the number does not fit into T.
+template <typename T> bool parseUnsigned(const char *&first, const char *last, T &value)
+{
+    static_assert(std::is_unsigned<T>::value, "only unsigned numbers are parsed");
+    static const std::uint64_t powers_of_ten[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+    auto iter = first;
+    std::uint64_t result = 0;
+    while (last - iter >= 8)
+    {
+        const auto values = detail::loadChunk(iter) - 0x3030303030303030;
+        const auto num_digits = detail::countLeadingDigits(values);
+        if (num_digits == 0)
+        {
+            break;
+        }
+        result = result * powers_of_ten[num_digits] + detail::convertDigits(values, num_digits);
+        iter += num_digits;
+        if (num_digits < 8)
+        {
+            break;
+        }
+    }
+    for (; iter != last && detail::isDigit(*iter); ++iter)
+    {
+        result = result * 10 + (*iter - '0');
+    }
+
+    const auto num_digits = static_cast<std::size_t>(iter - first);
+    if (num_digits == 0)
+    {
+        return false;
+    }
+    // the result may have wrapped around, check the overflow digit by digit
+    if (num_digits > static_cast<std::size_t>(std::numeric_limits<std::uint64_t>::digits10))
+    {
+        result = 0;
+        for (auto digit = first; digit != iter; ++digit)
+        {
+            const std::uint64_t digit_value = *digit - '0';
+            if (result > (std::numeric_limits<std::uint64_t>::max() - digit_value) / 10)
+            {
+                return false;
+            }
+            result = result * 10 + digit_value;
+        }
+    }
+    if (result > std::numeric_limits<T>::max())
+    {
+        return false;
+    }
+
+    value = static_cast<T>(result);
+    first = iter;
+    return true;
+}
+
+// Parses a real number in the format of boost::spirit::qi::double_
+inline bool parseReal(const char *&first, const char *last, double &value)
+{
+    return boost::spirit::qi::parse(first, last, boost::spirit::qi::double_, value);
+}
+
+inline bool skipChar(const char *&first, const char *last, const char expected)
+{
+    if (first == last || *first != expected)
+    {
+        return false;
+    }
+    ++first;
+    return true;
+}
+
+// Parses ",<real>" into value if the input continues with it, a comma followed by something
+// else is left for the comment
+inline bool parseOptionalReal(const char *&first, const char *last, double &value)
+{
+    auto iter = first;
+    if (skipChar(iter, last, ',') && parseReal(iter, last, value))
+    {
+        first = iter;
+    }
+    return true;
+}
 
-// Functor to parse a list of CSV files using "key,value,comment" grammar.
-// Key and Value structures must be a model of Random Access Sequence.
-// Also the Value structure must have source member that will be filled
-// with the corresponding file index in the CSV filenames vector.
+// Functor to parse a list of CSV files of "key,value[,comment]" lines, the line parser reads
+// the key and the value of a line. The files are memory mapped and cut into chunks at line
+// boundaries that are parsed and sorted in parallel, the sorted runs are merged pairwise.
+// Keys that are in several lines take the value of the last line of the last file.
+// The Value structure must have source member that will be filled with the corresponding file
+// index in the CSV filenames vector.
 template <typename Key, typename Value> struct CSVFilesParser
 {
-    using Iterator = boost::iostreams::mapped_file_source::iterator;
-    using KeyRule = boost::spirit::qi::rule<Iterator, Key()>;
-    using ValueRule = boost::spirit::qi::rule<Iterator, Value()>;
+    using Entry = std::pair<Key, Value>;
+    using LineParser = bool (*)(const char *&first, const char *last, Entry &entry);
 
-    CSVFilesParser(std::size_t start_index, const KeyRule &key_rule, const ValueRule &value_rule)
-        : start_index(start_index), key_rule(key_rule), value_rule(value_rule)
+    CSVFilesParser(std::size_t start_index, LineParser parse_line)
+        : start_index(start_index), parse_line(parse_line)
     {
     }
 
@@ -44,99 +189,176 @@ template <typename Key, typename Value> struct CSVFilesParser
     {
         try
         {
-            tbb::spin_mutex mutex;
-            std::vector<std::pair<Key, Value>> lookup;
-            tbb::parallel_for(std::size_t{0},
-                              csv_filenames.size(),
-                              [&](const std::size_t idx) {
-                                  auto local = ParseCSVFile(csv_filenames[idx], start_index + idx);
-
-                                  { // Merge local CSV results into a flat global vector
-                                      tbb::spin_mutex::scoped_lock _{mutex};
-                                      lookup.insert(end(lookup),
-                                                    std::make_move_iterator(begin(local)),
-                                                    std::make_move_iterator(end(local)));
-                                  }
-                              });
-
-            // With flattened map-ish view of all the files, make a stable sort on key and source
-            // and unique them on key to keep only the value with the largest file index
-            // and the largest line number in a file.
-            // The operands order is swapped to make descending ordering on (key, source)
-            tbb::parallel_sort(begin(lookup), end(lookup), [](const auto &lhs, const auto &rhs) {
-                return std::tie(rhs.first, rhs.second.source) <
-                       std::tie(lhs.first, lhs.second.source);
+            std::vector<boost::iostreams::mapped_file_source> files(csv_filenames.size());
+            std::size_t total_size = 0;
+            for (std::size_t index = 0; index < csv_filenames.size(); ++index)
+            {
+                if (boost::filesystem::file_size(csv_filenames[index]) > 0)
+                {
+                    files[index].open(csv_filenames[index]);
+                    total_size += files[index].size();
+                }
+            }
+
+            auto chunks = SplitIntoChunks(files, total_size);
+            std::vector<std::vector<Entry>> runs(chunks.size());
+            tbb::parallel_for(std::size_t{0}, chunks.size(), [&](const std::size_t index) {
+                auto &chunk = chunks[index];
+                runs[index] = ParseChunk(csv_filenames[chunk.file],
+                                         files[chunk.file],
+                                         chunk.begin,
+                                         chunk.end,
+                                         chunk.file,
+                                         chunk.num_values);
             });
 
-            // Unique only on key to take the source precedence into account and remove duplicates.
-            const auto it =
-                std::unique(begin(lookup), end(lookup), [](const auto &lhs, const auto &rhs) {
-                    return lhs.first == rhs.first;
+            std::vector<std::size_t> file_values(files.size(), 0);
+            for (std::size_t index = 0; index < chunks.size(); ++index)
+            {
+                file_values[chunks[index].file] += chunks[index].num_values;
+            }
+            for (std::size_t index = 0; index < files.size(); ++index)
+            {
+                util::Log() << "Loaded " << csv_filenames[index] << " with " << file_values[index]
+                            << " values";
+            }
+
+            // The runs are in the order of the files and lines, merging neighbours keeps it
+            while (runs.size() > 1)
+            {
+                std::vector<std::vector<Entry>> merged((runs.size() + 1) / 2);
+                tbb::parallel_for(std::size_t{0}, merged.size(), [&](const std::size_t index) {
+                    if (2 * index + 1 < runs.size())
+                    {
+                        merged[index] = mergeLookupValues(runs[2 * index], runs[2 * index + 1]);
+                        std::vector<Entry>().swap(runs[2 * index]);
+                        std::vector<Entry>().swap(runs[2 * index + 1]);
+                    }
+                    else
+                    {
+                        merged[index] = std::move(runs[2 * index]);
+                    }
                 });
-            lookup.erase(it, end(lookup));
+                runs = std::move(merged);
+            }
+
+            std::vector<Entry> lookup;
+            if (!runs.empty())
+            {
+                lookup = std::move(runs.front());
+            }
 
             util::Log() << "In total loaded " << csv_filenames.size() << " file(s) with a total of "
                         << lookup.size() << " unique values";
 
-            return LookupTable<Key, Value>{lookup};
+            return LookupTable<Key, Value>{std::move(lookup)};
         }
         catch (const tbb::captured_exception &e)
         {
             throw util::exception(e.what() + SOURCE_REF);
         }
+        catch (const boost::exception &e)
+        {
+            const auto message =
+                boost::format("exception in loading CSV files:\n %1%") %
+                boost::diagnostic_information(e);
+            throw util::exception(message.str() + SOURCE_REF);
+        }
     }
 
   private:
-    // Parse a single CSV file and return result as a vector<Key, Value>
-    auto ParseCSVFile(const std::string &filename, std::size_t file_id) const
+    struct Chunk
     {
-        namespace qi = boost::spirit::qi;
+        std::size_t file;
+        const char *begin;
+        const char *end;
+        std::size_t num_values;
+    };
 
-        std::vector<std::pair<Key, Value>> result;
-        try
+    // Cuts the files into a few chunks per thread that end after a newline
+    static std::vector<Chunk>
+    SplitIntoChunks(const std::vector<boost::iostreams::mapped_file_source> &files,
+                    const std::size_t total_size)
+    {
+        const auto num_threads =
+            static_cast<std::size_t>(tbb::task_scheduler_init::default_num_threads());
+        // chunks are at least 1 MiB so small files are not split
+        const auto chunk_size = std::max<std::size_t>(1 << 20, total_size / (4 * num_threads));
+
+        std::vector<Chunk> chunks;
+        for (std::size_t index = 0; index < files.size(); ++index)
         {
-            if (boost::filesystem::file_size(filename) == 0)
-                return result;
+            if (!files[index].is_open())
+            {
+                continue;
+            }
+            const auto file_end = files[index].data() + files[index].size();
+            for (auto begin = files[index].data(); begin != file_end;)
+            {
+                auto end = begin + std::min<std::size_t>(chunk_size, file_end - begin);
+                end = std::find(end, file_end, '\n');
+                end = end == file_end ? end : end + 1;
+                chunks.push_back(Chunk{index, begin, end, 0});
+                begin = end;
+            }
+        }
+        return chunks;
+    }
 
-            boost::iostreams::mapped_file_source mmap(filename);
-            auto first = mmap.begin(), last = mmap.end();
+    // Parses the lines of a chunk and sorts them by descending key as LookupTable expects it,
+    // of the lines with the same key only the last one is kept. num_values counts all lines.
+    std::vector<Entry> ParseChunk(const std::string &filename,
+                                  const boost::iostreams::mapped_file_source &file,
+                                  const char *first,
+                                  const char *last,
+                                  const std::size_t file_index,
+                                  std::size_t &num_values) const
+    {
+        BOOST_ASSERT(start_index + file_index <= std::numeric_limits<std::uint8_t>::max());
+        const auto source = static_cast<std::uint8_t>(start_index + file_index);
 
-            BOOST_ASSERT(file_id <= std::numeric_limits<std::uint8_t>::max());
-            ValueRule value_source =
-                value_rule[qi::_val = qi::_1, bind(&Value::source, qi::_val) = file_id];
-            qi::rule<Iterator, std::pair<Key, Value>()> csv_line =
-                (key_rule >> ',' >> value_source) >> -(',' >> *(qi::char_ - qi::eol));
-            const auto ok = qi::parse(first, last, -(csv_line % qi::eol) >> *qi::eol, result);
+        std::vector<Entry> result;
+        while (first != last)
+        {
+            // empty lines are skipped
+            if (*first == '\n' || *first == '\r')
+            {
+                ++first;
+                continue;
+            }
 
-            if (!ok || first != last)
+            const auto begin_of_line = first;
+            Entry entry;
+            bool ok = parse_line(first, last, entry);
+            if (ok && skipChar(first, last, ','))
+            {
+                first = std::find_if(
+                    first, last, [](const char c) { return c == '\n' || c == '\r'; });
+            }
+            ok = ok && detail::isEndOfLine(first, last);
+            if (!ok)
             {
-                auto begin_of_line = first - 1;
-                while (begin_of_line >= mmap.begin() && *begin_of_line != '\n')
-                    --begin_of_line;
-                auto line_number = std::count(mmap.begin(), first, '\n') + 1;
+                const auto line_number = std::count(file.data(), begin_of_line, '\n') + 1;
+                const auto end_of_line = std::find(begin_of_line, last, '\n');
                 const auto message = boost::format("CSV file %1% malformed on line %2%:\n %3%\n") %
                                      filename % std::to_string(line_number) %
-                                     std::string(begin_of_line + 1, std::find(first, last, '\n'));
+                                     std::string(begin_of_line, end_of_line);
                 throw util::exception(message.str() + SOURCE_REF);
             }
-
-            util::Log() << "Loaded " << filename << " with " << result.size() << "values";
-
-            return std::move(result);
-        }
-        catch (const boost::exception &e)
-        {
-            const auto message = boost::format("exception in loading %1%:\n %2%") % filename %
-                                 boost::diagnostic_information(e);
-            throw util::exception(message.str() + SOURCE_REF);
+            entry.second.source = source;
+            result.push_back(entry);
         }
+
+        num_values = result.size();
+        sortLookupValues(result);
+        return result;
     }
 
     const std::size_t start_index;
-    const KeyRule key_rule;
-    const ValueRule value_rule;
+    const LineParser parse_line;
 };
 }
 }
+}
 
 #endif
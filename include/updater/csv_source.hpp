@@ -3,13 +3,19 @@
 
 #include "updater/source.hpp"
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
 namespace osrm
 {
 namespace updater
 {
 namespace csv
 {
-SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths);
+// The values of the files are tagged with their index plus start_index as datasource
+SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths,
+                                     const std::size_t start_index = 1);
 TurnLookupTable readTurnValues(const std::vector<std::string> &paths);
 }
 }
@@ -0,0 +1,181 @@
+#ifndef OSRM_UPDATER_SEGMENT_INDEX_HPP
+#define OSRM_UPDATER_SEGMENT_INDEX_HPP
+
+#include "updater/source.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/msb.hpp"
+
+#include <tbb/parallel_for.h>
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace updater
+{
+namespace detail
+{
+// Finalizer of MurmurHash3, spreads the bits of the OSM ids over the whole hash
+inline std::uint64_t mixBits(std::uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccd;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53;
+    value ^= value >> 33;
+    return value;
+}
+
+inline std::uint64_t hashSegment(const std::uint64_t from, const std::uint64_t to)
+{
+    return mixBits(from * 0x9e3779b97f4a7c15 + to);
+}
+
+inline std::uint64_t hashKey(const Segment &segment)
+{
+    return hashSegment(segment.from, segment.to);
+}
+
+inline std::uint64_t hashKey(const Turn &turn)
+{
+    return mixBits(hashSegment(turn.from, turn.via) * 0x9e3779b97f4a7c15 + turn.to);
+}
+
+// The nodes a key is found by with HasNode: both ends of a segment, the via node of a turn
+template <typename F> void forEachNode(const Segment &segment, F &&f)
+{
+    f(segment.from);
+    f(segment.to);
+}
+
+template <typename F> void forEachNode(const Turn &turn, F &&f) { f(turn.via); }
+
+// Power of two with at least one and a half times the number of entries
+inline std::size_t tableSize(const std::size_t num_entries)
+{
+    const auto min_size = std::max<std::size_t>(num_entries + num_entries / 2, 2);
+    return std::size_t{1} << (util::msb(min_size - 1) + 1);
+}
+}
+
+// Open addressing hash index of the values of a segment speed or turn penalty lookup, the lookup
+// has to outlive it. A slot holds the upper half of the hash of a key as tag and its index in the
+// lookup, so a probe only reads the lookup entry if the tags match. The index also knows the OSM
+// nodes of all keys, so segments and turns without any update can be skipped without looking
+// them up. Both tables are filled in parallel with linear probing.
+template <typename Key, typename Value> class LookupIndex
+{
+  public:
+    explicit LookupIndex(const LookupTable<Key, Value> &lookup)
+        : values(lookup.lookup), key_slots(detail::tableSize(lookup.lookup.size())),
+          // every key adds at most two nodes
+          node_slots(detail::tableSize(2 * lookup.lookup.size()))
+    {
+        if (lookup.lookup.size() >= std::numeric_limits<std::uint32_t>::max())
+        {
+            throw util::exception("Too many values for the lookup index" + SOURCE_REF);
+        }
+
+        tbb::parallel_for(std::size_t{0}, lookup.lookup.size(), [&](const std::size_t index) {
+            const auto &key = lookup.lookup[index].first;
+            InsertKey(key, index);
+            detail::forEachNode(key, [this](const std::uint64_t node) { InsertNode(node); });
+        });
+    }
+
+    boost::optional<Value> operator()(const Key &key) const
+    {
+        const auto hash = detail::hashKey(key);
+        const auto tag = hash >> 32;
+        const auto mask = key_slots.size() - 1;
+        for (auto position = hash & mask;; position = (position + 1) & mask)
+        {
+            const auto slot = key_slots[position].load(std::memory_order_relaxed);
+            if (slot == EMPTY_SLOT)
+            {
+                return boost::none;
+            }
+            if ((slot >> 32) == tag)
+            {
+                const auto &entry = values[(slot & 0xffffffff) - 1];
+                if (entry.first == key)
+                {
+                    return entry.second;
+                }
+            }
+        }
+    }
+
+    // True if the OSM node is the start or the end of a segment or the via node of a turn in the
+    // lookup
+    bool HasNode(const std::uint64_t node) const
+    {
+        const auto mask = node_slots.size() - 1;
+        for (auto position = detail::mixBits(node) & mask;; position = (position + 1) & mask)
+        {
+            const auto slot = node_slots[position].load(std::memory_order_relaxed);
+            if (slot == EMPTY_SLOT)
+            {
+                return false;
+            }
+            if (slot == node + 1)
+            {
+                return true;
+            }
+        }
+    }
+
+  private:
+    static constexpr std::uint64_t EMPTY_SLOT = 0;
+
+    // The keys of the lookup are unique, a claimed slot never holds the same key
+    void InsertKey(const Key &key, const std::size_t index)
+    {
+        const auto hash = detail::hashKey(key);
+        const auto slot = (hash >> 32 << 32) | (index + 1);
+        const auto mask = key_slots.size() - 1;
+        for (auto position = hash & mask;; position = (position + 1) & mask)
+        {
+            auto expected = EMPTY_SLOT;
+            if (key_slots[position].compare_exchange_strong(expected, slot))
+            {
+                return;
+            }
+        }
+    }
+
+    // Nodes are shared by keys, a node that is already in the table is not added again
+    void InsertNode(const std::uint64_t node)
+    {
+        const auto mask = node_slots.size() - 1;
+        for (auto position = detail::mixBits(node) & mask;; position = (position + 1) & mask)
+        {
+            auto expected = EMPTY_SLOT;
+            if (node_slots[position].compare_exchange_strong(expected, node + 1) ||
+                expected == node + 1)
+            {
+                return;
+            }
+        }
+    }
+
+    const std::vector<std::pair<Key, Value>> &values;
+    std::vector<std::atomic<std::uint64_t>> key_slots;
+    std::vector<std::atomic<std::uint64_t>> node_slots;
+};
+
+using SegmentIndex = LookupIndex<Segment, SpeedSource>;
+using TurnIndex = LookupIndex<Turn, PenaltySource>;
+}
+}
+
+#endif
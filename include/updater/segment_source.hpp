@@ -0,0 +1,25 @@
+#ifndef OSRM_UPDATER_SEGMENT_SOURCE_HPP
+#define OSRM_UPDATER_SEGMENT_SOURCE_HPP
+
+#include "updater/source.hpp"
+
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace updater
+{
+
+// Reads segment speed files in the CSV or in the binary format, the format is detected per
+// file. Values of later files override the ones of earlier files and are tagged with the index
+// of their file plus one as datasource.
+SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths);
+
+// The datasource name of a segment speed file, the name in the header of a binary file or the
+// file name without directory and extension
+std::string readSegmentSourceName(const std::string &path);
+}
+}
+
+#endif
@@ -5,6 +5,12 @@
 
 #include <boost/optional.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -27,6 +33,59 @@ template <typename Key, typename Value> struct LookupTable
     std::vector<std::pair<Key, Value>> lookup;
 };
 
+// Sorts values by descending key as LookupTable expects them, of the values with the same key
+// only the last one is kept
+template <typename Key, typename Value>
+void sortLookupValues(std::vector<std::pair<Key, Value>> &values)
+{
+    std::stable_sort(values.begin(), values.end(), [](const auto &lhs, const auto &rhs) {
+        return rhs.first < lhs.first;
+    });
+
+    auto output = values.begin();
+    for (auto iter = values.begin(); iter != values.end(); ++iter)
+    {
+        const auto next = std::next(iter);
+        if (next == values.end() || !(next->first == iter->first))
+        {
+            *output++ = *iter;
+        }
+    }
+    values.erase(output, values.end());
+}
+
+// Merges two value lists sorted by descending key, for keys in both the later one wins
+template <typename Key, typename Value>
+std::vector<std::pair<Key, Value>>
+mergeLookupValues(const std::vector<std::pair<Key, Value>> &earlier,
+                  const std::vector<std::pair<Key, Value>> &later)
+{
+    std::vector<std::pair<Key, Value>> merged;
+    merged.reserve(earlier.size() + later.size());
+
+    auto lhs = earlier.begin();
+    auto rhs = later.begin();
+    while (lhs != earlier.end() && rhs != later.end())
+    {
+        if (rhs->first < lhs->first)
+        {
+            merged.push_back(*lhs++);
+        }
+        else if (lhs->first < rhs->first)
+        {
+            merged.push_back(*rhs++);
+        }
+        else
+        {
+            merged.push_back(*rhs++);
+            ++lhs;
+        }
+    }
+    merged.insert(merged.end(), lhs, earlier.end());
+    merged.insert(merged.end(), rhs, later.end());
+    return merged;
+}
+
 struct Segment final
 {
     std::uint64_t from, to;
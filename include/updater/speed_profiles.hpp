@@ -0,0 +1,56 @@
+#ifndef OSRM_UPDATER_SPEED_PROFILES_HPP
+#define OSRM_UPDATER_SPEED_PROFILES_HPP
+
+#include "updater/source.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace updater
+{
+
+struct ProfileSource final
+{
+    ProfileSource() : profile(0) {}
+    std::uint32_t profile;
+    std::uint8_t source;
+};
+
+using SegmentProfileLookupTable = LookupTable<Segment, ProfileSource>;
+
+// Typical speeds of segments over the day, split into time slots of equal length from midnight
+// UTC. Segments share profiles that hold one speed in km/h per slot, quantized to whole km/h
+// up to 255 so a profile of 96 slots takes 96 bytes.
+//
+// The speed profile file has lines `profile_id,speed_0,...,speed_n` with the same number of
+// speeds on every line, the segment profile file `from_osm_id,to_osm_id,profile_id`.
+class SpeedProfiles
+{
+  public:
+    SpeedProfiles(const std::string &speed_profile_path, const std::string &segment_profile_path);
+
+    std::size_t GetNumberOfSlots() const { return num_slots; }
+    std::size_t GetNumberOfProfiles() const
+    {
+        return num_slots == 0 ? 0 : speeds.size() / num_slots;
+    }
+    std::size_t GetNumberOfSegments() const { return segments.lookup.size(); }
+
+    // The speeds of all segments with a profile in the time slot, tagged as datasource 1
+    SegmentLookupTable GetSlotSpeeds(const std::size_t slot) const;
+
+  private:
+    std::size_t num_slots;
+    // speeds of profile p in slots p * num_slots to (p + 1) * num_slots
+    std::vector<std::uint8_t> speeds;
+    // profiles are numbered in the order of the speed profile file
+    SegmentProfileLookupTable segments;
+};
+}
+}
+
+#endif
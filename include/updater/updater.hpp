@@ -1,10 +1,13 @@
 #ifndef OSRM_UPDATER_UPDATER_HPP
 #define OSRM_UPDATER_UPDATER_HPP
 
+#include "updater/source.hpp"
 #include "updater/updater_config.hpp"
 
 #include "extractor/edge_based_edge.hpp"
 
+#include <boost/optional.hpp>
+
 #include <chrono>
 #include <vector>
 
@@ -17,15 +20,31 @@ class Updater
   public:
     Updater(UpdaterConfig config_) : config(std::move(config_)) {}
 
+    // Applies the speeds instead of the ones of config.segment_speed_lookup_paths, the paths
+    // still name the datasources of the speeds in the logs
+    Updater(UpdaterConfig config_, SegmentLookupTable segment_speeds_)
+        : config(std::move(config_)), segment_speeds(std::move(segment_speeds_))
+    {
+    }
+
     using NumNodesAndEdges = std::tuple<EdgeID, std::vector<extractor::EdgeBasedEdge>>;
     NumNodesAndEdges LoadAndUpdateEdgeExpandedGraph() const;
 
+    // Also returns the sorted source and target nodes of the edges that got a new weight
+    NumNodesAndEdges LoadAndUpdateEdgeExpandedGraph(std::vector<NodeID> &updated_nodes) const;
+
     EdgeID
     LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
                                    std::vector<EdgeWeight> &node_weights) const;
 
+    EdgeID
+    LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+                                   std::vector<EdgeWeight> &node_weights,
+                                   std::vector<NodeID> &updated_nodes) const;
+
   private:
     UpdaterConfig config;
+    boost::optional<SegmentLookupTable> segment_speeds;
 };
 }
 }
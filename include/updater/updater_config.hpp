@@ -71,6 +71,9 @@ struct UpdaterConfig final : storage::IOConfig
 
     double log_edge_updates_factor;
     std::time_t valid_now;
+    // False to only update the edges in memory, .osrm.geometry, the turn penalties and the
+    // datasource names are left as they are. Used for the additional metrics of osrm-customize.
+    bool save_updates = true;
 
     std::vector<std::string> segment_speed_lookup_paths;
     std::vector<std::string> turn_penalty_lookup_paths;
@@ -0,0 +1,49 @@
+#ifndef OSRM_UTIL_ALLOCATION_STATISTICS_HPP
+#define OSRM_UTIL_ALLOCATION_STATISTICS_HPP
+
+#include <cstdint>
+
+// Replaces the global operator new to count the allocations of every thread, set by the
+// ENABLE_ALLOCATION_STATISTICS CMake option. Without it the counts stay zero.
+#ifndef OSRM_ALLOCATION_STATISTICS
+#define OSRM_ALLOCATION_STATISTICS 0
+#endif
+
+namespace osrm
+{
+namespace util
+{
+
+constexpr bool allocation_statistics_enabled = OSRM_ALLOCATION_STATISTICS != 0;
+
+// The allocations by operator new on a thread so far, frees are not counted.
+//
+//   const auto before = util::GetThreadAllocationStatistics();
+//   osrm.Route(parameters, result);
+//   const auto query = util::GetThreadAllocationStatistics() - before;
+struct AllocationStatistics
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+
+    AllocationStatistics &operator+=(const AllocationStatistics &other)
+    {
+        allocations += other.allocations;
+        bytes += other.bytes;
+        return *this;
+    }
+
+    AllocationStatistics operator-(const AllocationStatistics &other) const
+    {
+        AllocationStatistics difference;
+        difference.allocations = allocations - other.allocations;
+        difference.bytes = bytes - other.bytes;
+        return difference;
+    }
+};
+
+AllocationStatistics GetThreadAllocationStatistics();
+}
+}
+
+#endif
@@ -1,10 +1,16 @@
 #ifndef CAST_HPP
 #define CAST_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/trim.hpp>
@@ -42,6 +48,96 @@ template <typename T, int Precision = 6> inline std::string to_string_with_preci
 
     return rv;
 }
+
+namespace detail
+{
+constexpr double power_of_ten(const int exponent)
+{
+    return exponent == 0 ? 1. : 10. * power_of_ten(exponent - 1);
+}
+
+inline void append_trimmed(std::vector<char> &out, const char *begin, const char *end)
+{
+    // same trimming as in to_string_with_precision
+    const char *dot = std::find(begin, end, '.');
+    if (dot != end)
+    {
+        while (end - 1 != dot && *(end - 1) == '0')
+            --end;
+        if (end - 1 == dot)
+            --end;
+    }
+    out.insert(out.end(), begin, end);
+}
+}
+
+// Appends x exactly like to_string_with_precision<double, Precision> would, without the
+// stream and the string allocation.
+//
+// The fast path rounds x * 10^Precision to an integer. The product is off by at most half an
+// ulp, so whenever it is further than that from a tie the rounding equals printf's rounding of
+// the exact binary value. The rare values next to a tie, huge values and nan/inf go through
+// snprintf.
+template <int Precision = 6>
+inline void append_with_precision(std::vector<char> &out, const double x)
+{
+    static_assert(Precision > 0 && Precision < 16, "precision out of range");
+    constexpr double scale = detail::power_of_ten(Precision);
+    // below this limit the scaled value and its fraction are exact in a double
+    constexpr double limit = 9007199254740992. / scale;
+
+    const double magnitude = std::abs(x);
+    if (magnitude < limit)
+    {
+        const double scaled = magnitude * scale;
+        const double whole = std::floor(scaled);
+        const double fraction = scaled - whole;
+        if (std::abs(fraction - 0.5) > scaled * std::numeric_limits<double>::epsilon())
+        {
+            auto value = static_cast<std::uint64_t>(whole) + (fraction > 0.5 ? 1 : 0);
+
+            // sign, 53 bit integer part, dot and fraction digits
+            char buffer[1 + 16 + 1 + Precision];
+            char *end = buffer + sizeof(buffer);
+            char *begin = end;
+            bool trailing = true;
+            for (int digit = 0; digit < Precision; ++digit)
+            {
+                const char character = '0' + value % 10;
+                value /= 10;
+                if (trailing && character == '0')
+                {
+                    --end;
+                }
+                else
+                {
+                    trailing = false;
+                }
+                *--begin = character;
+            }
+            if (!trailing)
+            {
+                *--begin = '.';
+            }
+            do
+            {
+                *--begin = '0' + value % 10;
+                value /= 10;
+            } while (value > 0);
+            // printf keeps the sign of negative values that round to zero
+            if (std::signbit(x))
+            {
+                *--begin = '-';
+            }
+            out.insert(out.end(), begin, end);
+            return;
+        }
+    }
+
+    char buffer[std::numeric_limits<double>::max_exponent10 + 4 + Precision];
+    const auto length = std::snprintf(buffer, sizeof(buffer), "%.*f", Precision, x);
+    detail::append_trimmed(out, buffer, buffer + std::min<std::size_t>(length, sizeof(buffer) - 1));
+}
 }
 }
 }
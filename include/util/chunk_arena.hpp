@@ -0,0 +1,51 @@
+#ifndef OSRM_UTIL_CHUNK_ARENA_HPP
+#define OSRM_UTIL_CHUNK_ARENA_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Hands out memory in chunks of CHUNK_SIZE bytes for the blocks of DeallocatingVector. On Linux
+// every chunk is a mapping of its own that is aligned to and backed by transparent huge pages if
+// the kernel supports them, so a freed chunk goes back to the system at once instead of staying
+// in the heap of the process. A few freed chunks are kept for reuse, because the edge lists of
+// extraction and contraction are built and torn down over and over.
+class ChunkArena
+{
+  public:
+    // a whole number of 2 MiB huge pages
+    static constexpr std::size_t CHUNK_SIZE = 8 * 1024 * 1024;
+    static constexpr std::size_t DEFAULT_MAX_CACHED_CHUNKS = 4;
+
+    static ChunkArena &GetInstance();
+
+    explicit ChunkArena(const std::size_t max_cached_chunks = DEFAULT_MAX_CACHED_CHUNKS);
+    ~ChunkArena();
+
+    ChunkArena(const ChunkArena &) = delete;
+    ChunkArena &operator=(const ChunkArena &) = delete;
+
+    // Memory of a new chunk is zeroed, a reused chunk keeps the content it was freed with.
+    // Throws std::bad_alloc if the system has no memory left.
+    void *Allocate();
+    void Free(void *chunk);
+
+    // Returns all chunks kept for reuse to the system, e.g. at the end of a phase
+    void Release();
+
+    std::size_t GetCachedChunks() const;
+
+  private:
+    const std::size_t max_cached_chunks;
+    mutable std::mutex cached_chunks_mutex;
+    std::vector<void *> cached_chunks;
+};
+}
+}
+
+#endif
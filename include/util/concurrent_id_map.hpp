@@ -1,10 +1,13 @@
 #ifndef CONCURRENT_ID_MAP_HPP
 #define CONCURRENT_ID_MAP_HPP
 
-#include <boost/interprocess/sync/interprocess_upgradable_mutex.hpp>
-#include <boost/interprocess/sync/scoped_lock.hpp>
-#include <boost/interprocess/sync/sharable_lock.hpp>
+#include <tbb/spin_rw_mutex.h>
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
 #include <unordered_map>
 
 namespace osrm
@@ -14,64 +17,85 @@ namespace util
 
 /**
  * This is a special purpose map for caching incrementing IDs
+ *
+ * The keys are spread over shards by their hash, each with its own reader-writer spin lock, so
+ * lookups from many threads rarely wait for each other. Found keys only take a reader lock, new
+ * keys take the next ID while holding the lock of their shard.
  */
 template <typename KeyType, typename ValueType, typename HashType = std::hash<KeyType>>
-struct ConcurrentIDMap
+class ConcurrentIDMap
 {
     static_assert(std::is_unsigned<ValueType>::value, "Only unsigned integer types are supported.");
 
-    using UpgradableMutex = boost::interprocess::interprocess_upgradable_mutex;
-    using ScopedReaderLock = boost::interprocess::sharable_lock<UpgradableMutex>;
-    using ScopedWriterLock = boost::interprocess::scoped_lock<UpgradableMutex>;
+    static const constexpr std::size_t NUMBER_OF_SHARDS = 64;
 
-    std::unordered_map<KeyType, ValueType, HashType> data;
-    mutable UpgradableMutex mutex;
+    using Mutex = tbb::spin_rw_mutex;
 
-    ConcurrentIDMap() = default;
-    ConcurrentIDMap(ConcurrentIDMap &&other)
+    struct Shard
     {
-        if (this != &other)
-        {
-            ScopedWriterLock other_lock{other.mutex};
-            ScopedWriterLock lock{mutex};
+        std::unordered_map<KeyType, ValueType, HashType> data;
+        Mutex mutex;
+    };
 
-            data = std::move(other.data);
-        }
-    }
-    ConcurrentIDMap &operator=(ConcurrentIDMap &&other)
+    struct Shards
     {
-        if (this != &other)
-        {
-            ScopedWriterLock other_lock{other.mutex};
-            ScopedWriterLock lock{mutex};
+        std::array<Shard, NUMBER_OF_SHARDS> shards;
+        std::atomic<ValueType> next_id{0};
+    };
 
-            data = std::move(other.data);
-        }
-        return *this;
+    Shard &GetShard(const KeyType &key)
+    {
+        // mix in the high bits, hashes of integers often are the integers themselves
+        const auto hash = HashType{}(key);
+        return sharded->shards[(hash ^ (hash >> 17)) % NUMBER_OF_SHARDS];
     }
 
+    std::unique_ptr<Shards> sharded;
+
+  public:
+    ConcurrentIDMap() : sharded(std::make_unique<Shards>()) {}
+    ConcurrentIDMap(ConcurrentIDMap &&) = default;
+    ConcurrentIDMap &operator=(ConcurrentIDMap &&) = default;
+
     const ValueType ConcurrentFindOrAdd(const KeyType &key)
     {
+        auto &shard = GetShard(key);
         {
-            ScopedReaderLock sentry{mutex};
-            const auto result = data.find(key);
-            if (result != data.end())
+            Mutex::scoped_lock sentry{shard.mutex, false};
+            const auto result = shard.data.find(key);
+            if (result != shard.data.end())
             {
                 return result->second;
             }
         }
         {
-            ScopedWriterLock sentry{mutex};
-            const auto result = data.find(key);
-            if (result != data.end())
+            Mutex::scoped_lock sentry{shard.mutex, true};
+            const auto result = shard.data.find(key);
+            if (result != shard.data.end())
             {
                 return result->second;
             }
-            const auto id = static_cast<ValueType>(data.size());
-            data[key] = id;
+            const auto id = sharded->next_id.fetch_add(1);
+            shard.data.emplace(key, id);
             return id;
         }
     }
+
+    // The number of IDs handed out, must not run concurrently to ConcurrentFindOrAdd
+    std::size_t size() const { return sharded->next_id.load(); }
+
+    // Calls callback with every key and its ID in no particular order, must not run
+    // concurrently to ConcurrentFindOrAdd
+    template <typename Callback> void ForEach(Callback &&callback) const
+    {
+        for (const auto &shard : sharded->shards)
+        {
+            for (const auto &entry : shard.data)
+            {
+                callback(entry.first, entry.second);
+            }
+        }
+    }
 };
 
 } // util
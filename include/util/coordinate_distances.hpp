@@ -0,0 +1,188 @@
+#ifndef OSRM_UTIL_COORDINATE_DISTANCES_HPP
+#define OSRM_UTIL_COORDINATE_DISTANCES_HPP
+
+#include "util/coordinate.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/double_lanes.hpp"
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cstddef>
+
+namespace osrm
+{
+namespace util
+{
+namespace coordinate_calculation
+{
+
+// Batched versions of haversineDistance and greatCircleDistance for many pairs of coordinates,
+// e.g. all segments of a geometry. On targets with double lanes a whole vector of distances is
+// computed at once with polynomial approximations of sin, cos and asin. Their truncation errors
+// are below 1e-15, the distances differ from the ones of the scalar functions by less than 1e-12
+// relative plus the rounding of the arithmetic, far below a millimeter. Without double lanes the
+// scalar functions are called.
+namespace detail
+{
+// Taylor series in x^2, for |x| <= pi/2: x^21/21! < 3e-16 and x^20/20! < 4e-15
+const constexpr double SIN_COEFFICIENTS[] = {1.,
+                                             -1. / 6.,
+                                             1. / 120.,
+                                             -1. / 5040.,
+                                             1. / 362880.,
+                                             -1. / 39916800.,
+                                             1. / 6227020800.,
+                                             -1. / 1307674368000.,
+                                             1. / 355687428096000.,
+                                             -1. / 121645100408832000.};
+const constexpr double COS_COEFFICIENTS[] = {1.,
+                                             -1. / 2.,
+                                             1. / 24.,
+                                             -1. / 720.,
+                                             1. / 40320.,
+                                             -1. / 3628800.,
+                                             1. / 479001600.,
+                                             -1. / 87178291200.,
+                                             1. / 20922789888000.,
+                                             -1. / 6402373705728000.};
+// Taylor series of asin(x)/x in x^2, (2k)!/(4^k k!^2 (2k+1)) for k < 8. Haversines of up to
+// HAVERSINE_APPROX_MAX have a sqrt below 0.1 where the next term is below 1e-17, larger ones
+// are about 1270km apart and are computed by haversineDistance.
+const constexpr double ASIN_COEFFICIENTS[] = {1.,
+                                              1. / 6.,
+                                              3. / 40.,
+                                              5. / 112.,
+                                              35. / 1152.,
+                                              63. / 2816.,
+                                              231. / 13312.,
+                                              143. / 10240.};
+const constexpr double HAVERSINE_APPROX_MAX = 0.01;
+
+#ifdef OSRM_HAS_DOUBLE_LANES
+using util::detail::DoubleLanes;
+
+// for |x| <= pi/2
+inline DoubleLanes sinLanes(const DoubleLanes x)
+{
+    return x * util::detail::horner(x * x, SIN_COEFFICIENTS);
+}
+
+// for |x| <= pi/2
+inline DoubleLanes cosLanes(const DoubleLanes x)
+{
+    return util::detail::horner(x * x, COS_COEFFICIENTS);
+}
+
+// sin(x)^2 for |x| <= pi, mirrored into [0, pi/2] by sin(x)^2 == sin(pi - |x|)^2
+inline DoubleLanes squaredSinLanes(const DoubleLanes x)
+{
+    using namespace boost::math::constants;
+    const auto zero = util::detail::broadcastLanes(0.);
+    const auto absolute = util::detail::selectLess(x, zero, zero - x, x);
+    const auto pi_lanes = util::detail::broadcastLanes(pi<double>());
+    const auto half_pi_lanes = util::detail::broadcastLanes(half_pi<double>());
+    const auto mirrored =
+        util::detail::selectLess(half_pi_lanes, absolute, pi_lanes - absolute, absolute);
+    const auto sin = sinLanes(mirrored);
+    return sin * sin;
+}
+
+// Converts the fixed point coordinates of a vector into radians
+inline void loadRadians(const Coordinate *const coordinates, DoubleLanes &lon, DoubleLanes &lat)
+{
+    double lons[DoubleLanes::SIZE];
+    double lats[DoubleLanes::SIZE];
+    for (std::size_t lane = 0; lane < DoubleLanes::SIZE; ++lane)
+    {
+        lons[lane] = static_cast<int>(coordinates[lane].lon) / COORDINATE_PRECISION;
+        lats[lane] = static_cast<int>(coordinates[lane].lat) / COORDINATE_PRECISION;
+    }
+    const auto degree_to_rad = util::detail::broadcastLanes(degToRad(1.));
+    lon = util::detail::loadLanes(lons) * degree_to_rad;
+    lat = util::detail::loadLanes(lats) * degree_to_rad;
+}
+#endif
+}
+
+// distances[i] = haversineDistance(from[i], to[i]) for all i < size. The ranges may overlap,
+// from = line and to = line + 1 are the lengths of the segments of a line.
+inline void haversineDistances(const Coordinate *const from,
+                               const Coordinate *const to,
+                               const std::size_t size,
+                               double *const distances)
+{
+    std::size_t index = 0;
+
+#ifdef OSRM_HAS_DOUBLE_LANES
+    using namespace util::detail;
+    using coordinate_calculation::detail::DoubleLanes;
+    const auto half = broadcastLanes(.5);
+    const auto earth_diameter = broadcastLanes(2. * detail::EARTH_RADIUS);
+    for (; index + DoubleLanes::SIZE <= size; index += DoubleLanes::SIZE)
+    {
+        DoubleLanes from_lon, from_lat, to_lon, to_lat;
+        detail::loadRadians(from + index, from_lon, from_lat);
+        detail::loadRadians(to + index, to_lon, to_lat);
+
+        const auto haversine =
+            detail::squaredSinLanes((from_lat - to_lat) * half) +
+            detail::cosLanes(from_lat) * detail::cosLanes(to_lat) *
+                detail::squaredSinLanes((from_lon - to_lon) * half);
+        double haversines[DoubleLanes::SIZE];
+        storeLanes(haversines, haversine);
+
+        const auto root = sqrtLanes(haversine);
+        storeLanes(distances + index,
+                   earth_diameter * root * horner(haversine, detail::ASIN_COEFFICIENTS));
+
+        for (std::size_t lane = 0; lane < DoubleLanes::SIZE; ++lane)
+        {
+            if (!(haversines[lane] <= detail::HAVERSINE_APPROX_MAX))
+            {
+                distances[index + lane] = haversineDistance(from[index + lane], to[index + lane]);
+            }
+        }
+    }
+#endif
+
+    for (; index < size; ++index)
+    {
+        distances[index] = haversineDistance(from[index], to[index]);
+    }
+}
+
+// distances[i] = greatCircleDistance(from[i], to[i]) for all i < size, the ranges may overlap
+inline void greatCircleDistances(const Coordinate *const from,
+                                 const Coordinate *const to,
+                                 const std::size_t size,
+                                 double *const distances)
+{
+    std::size_t index = 0;
+
+#ifdef OSRM_HAS_DOUBLE_LANES
+    using namespace util::detail;
+    using coordinate_calculation::detail::DoubleLanes;
+    const auto half = broadcastLanes(.5);
+    const auto earth_radius = broadcastLanes(detail::EARTH_RADIUS);
+    for (; index + DoubleLanes::SIZE <= size; index += DoubleLanes::SIZE)
+    {
+        DoubleLanes from_lon, from_lat, to_lon, to_lat;
+        detail::loadRadians(from + index, from_lon, from_lat);
+        detail::loadRadians(to + index, to_lon, to_lat);
+
+        const auto x = (to_lon - from_lon) * detail::cosLanes((from_lat + to_lat) * half);
+        const auto y = to_lat - from_lat;
+        storeLanes(distances + index, sqrtLanes(x * x + y * y) * earth_radius);
+    }
+#endif
+
+    for (; index < size; ++index)
+    {
+        distances[index] = greatCircleDistance(from[index], to[index]);
+    }
+}
+}
+}
+}
+
+#endif
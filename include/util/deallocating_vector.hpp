@@ -2,11 +2,14 @@
 #define DEALLOCATING_VECTOR_HPP
 
 #include "storage/io_fwd.hpp"
+#include "util/chunk_arena.hpp"
 #include "util/integer_range.hpp"
 
 #include <boost/iterator/iterator_facade.hpp>
 
 #include <limits>
+#include <new>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -31,6 +34,41 @@ inline void write(storage::io::FileWriter &writer, const util::DeallocatingVecto
 
 namespace util
 {
+namespace detail
+{
+// Buckets are chunks of the ChunkArena, so they go back to the system once they are freed
+template <typename ElementT> ElementT *allocateBucket()
+{
+    constexpr std::size_t ELEMENTS_PER_BLOCK = ChunkArena::CHUNK_SIZE / sizeof(ElementT);
+    auto bucket = static_cast<ElementT *>(ChunkArena::GetInstance().Allocate());
+    if (!std::is_trivially_default_constructible<ElementT>::value)
+    {
+        for (const auto index : irange<std::size_t>(0, ELEMENTS_PER_BLOCK))
+        {
+            new (bucket + index) ElementT;
+        }
+    }
+    return bucket;
+}
+
+template <typename ElementT> void deallocateBucket(ElementT *bucket)
+{
+    constexpr std::size_t ELEMENTS_PER_BLOCK = ChunkArena::CHUNK_SIZE / sizeof(ElementT);
+    if (nullptr == bucket)
+    {
+        return;
+    }
+    if (!std::is_trivially_destructible<ElementT>::value)
+    {
+        for (const auto index : irange<std::size_t>(0, ELEMENTS_PER_BLOCK))
+        {
+            bucket[index].~ElementT();
+        }
+    }
+    ChunkArena::GetInstance().Free(bucket);
+}
+}
+
 template <typename ElementT> struct ConstDeallocatingVectorIteratorState
 {
     ConstDeallocatingVectorIteratorState()
@@ -207,11 +245,8 @@ class DeallocatingVectorRemoveIterator
         if (old_bucket != new_bucket)
         {
             // delete old bucket entry
-            if (nullptr != current_state.bucket_list->at(old_bucket))
-            {
-                delete[] current_state.bucket_list->at(old_bucket);
-                current_state.bucket_list->at(old_bucket) = nullptr;
-            }
+            detail::deallocateBucket(current_state.bucket_list->at(old_bucket));
+            current_state.bucket_list->at(old_bucket) = nullptr;
         }
     }
 
@@ -237,7 +272,7 @@ template <typename T> void swap(DeallocatingVector<T> &lhs, DeallocatingVector<T
 
 template <typename ElementT> class DeallocatingVector
 {
-    static constexpr std::size_t ELEMENTS_PER_BLOCK = 8388608 / sizeof(ElementT);
+    static constexpr std::size_t ELEMENTS_PER_BLOCK = ChunkArena::CHUNK_SIZE / sizeof(ElementT);
     std::size_t current_size;
     std::vector<ElementT *> bucket_list;
 
@@ -251,7 +286,7 @@ template <typename ElementT> class DeallocatingVector
 
     DeallocatingVector() : current_size(0)
     {
-        bucket_list.emplace_back(new ElementT[ELEMENTS_PER_BLOCK]);
+        bucket_list.emplace_back(detail::allocateBucket<ElementT>());
     }
 
     // copying is not safe since this would only do a shallow copy
@@ -277,14 +312,10 @@ template <typename ElementT> class DeallocatingVector
 
     void clear()
     {
-        // Delete[]'ing ptr's to all Buckets
+        // Return all buckets to the arena
         for (auto bucket : bucket_list)
         {
-            if (nullptr != bucket)
-            {
-                delete[] bucket;
-                bucket = nullptr;
-            }
+            detail::deallocateBucket(bucket);
         }
         bucket_list.clear();
         bucket_list.shrink_to_fit();
@@ -296,7 +327,7 @@ template <typename ElementT> class DeallocatingVector
         const std::size_t current_capacity = capacity();
         if (current_size == current_capacity)
         {
-            bucket_list.push_back(new ElementT[ELEMENTS_PER_BLOCK]);
+            bucket_list.push_back(detail::allocateBucket<ElementT>());
         }
 
         std::size_t current_index = size() % ELEMENTS_PER_BLOCK;
@@ -309,7 +340,7 @@ template <typename ElementT> class DeallocatingVector
         const std::size_t current_capacity = capacity();
         if (current_size == current_capacity)
         {
-            bucket_list.push_back(new ElementT[ELEMENTS_PER_BLOCK]);
+            bucket_list.push_back(detail::allocateBucket<ElementT>());
         }
 
         const std::size_t current_index = size() % ELEMENTS_PER_BLOCK;
@@ -325,7 +356,7 @@ template <typename ElementT> class DeallocatingVector
         {
             while (capacity() < new_size)
             {
-                bucket_list.push_back(new ElementT[ELEMENTS_PER_BLOCK]);
+                bucket_list.push_back(detail::allocateBucket<ElementT>());
             }
         }
         else
@@ -333,10 +364,7 @@ template <typename ElementT> class DeallocatingVector
             const std::size_t number_of_necessary_buckets = 1 + (new_size / ELEMENTS_PER_BLOCK);
             for (const auto bucket_index : irange(number_of_necessary_buckets, bucket_list.size()))
             {
-                if (nullptr != bucket_list[bucket_index])
-                {
-                    delete[] bucket_list[bucket_index];
-                }
+                detail::deallocateBucket(bucket_list[bucket_index]);
             }
             bucket_list.resize(number_of_necessary_buckets);
         }
@@ -0,0 +1,284 @@
+#ifndef OSRM_UTIL_DELTA_VECTOR_HPP
+#define OSRM_UTIL_DELTA_VECTOR_HPP
+
+#include "util/vector_view.hpp"
+
+#include "storage/shared_memory_ownership.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+namespace detail
+{
+
+// Stores unsigned integers as varint encoded differences to their predecessor.
+//
+// The values are split into blocks of BLOCK_ELEMENTS, the first value of a block is stored as
+// is and the block offsets allow to start decoding at any block. Sequences of close values like
+// the node ids of a geometry shrink to one or two bytes per value. Iterating forward or backward
+// decodes one value per step, random access decodes up to BLOCK_ELEMENTS values.
+//
+// A view can also be constructed from values that are not encoded at all, which lets users
+// decide at load time whether they want the smaller or the faster representation.
+template <typename T, storage::Ownership Ownership> class DeltaVector
+{
+    static_assert(std::is_unsigned<T>::value, "T must be an unsigned integral type.");
+    static_assert(sizeof(T) <= sizeof(std::uint64_t), "Maximum size of type T is 8 bytes");
+
+    template <typename U> using Vector = util::ViewOrVector<U, Ownership>;
+
+  public:
+    static constexpr std::size_t BLOCK_ELEMENTS = 32;
+
+    class const_iterator
+        : public boost::iterator_facade<const_iterator, T, boost::random_access_traversal_tag, T>
+    {
+        typedef boost::iterator_facade<const_iterator,
+                                       T,
+                                       boost::random_access_traversal_tag,
+                                       T>
+            base_t;
+
+      public:
+        typedef typename base_t::value_type value_type;
+        typedef typename base_t::difference_type difference_type;
+        typedef typename base_t::reference reference;
+        typedef std::random_access_iterator_tag iterator_category;
+
+        explicit const_iterator()
+            : container(nullptr), index(std::numeric_limits<std::size_t>::max()), position(0),
+              next_position(0), value(0), decoded(false)
+        {
+        }
+
+        // The value of iterators that end a range is only decoded once they are moved, as most
+        // of them are only compared against.
+        explicit const_iterator(const DeltaVector *container,
+                                const std::size_t index,
+                                const bool decode = true)
+            : container(container), index(index), position(0), next_position(0), value(0),
+              decoded(false)
+        {
+            if (decode)
+                seek(index);
+        }
+
+      private:
+        void increment()
+        {
+            if (!decoded)
+            {
+                seek(index + 1);
+                return;
+            }
+
+            ++index;
+            if (container->IsEncoded() && index < container->size())
+            {
+                position = next_position;
+                if (index % BLOCK_ELEMENTS == 0)
+                    value = static_cast<T>(container->decode(position, next_position));
+                else
+                    value = static_cast<T>(value + container->decodeDelta(position, next_position));
+            }
+        }
+
+        void decrement()
+        {
+            if (!decoded || !container->IsEncoded() || index % BLOCK_ELEMENTS == 0 ||
+                index >= container->size())
+            {
+                seek(index - 1);
+                return;
+            }
+
+            // undo the delta of the current value and find the start of the previous varint,
+            // which is the first byte after the end of the one before it
+            std::size_t end_position;
+            value = static_cast<T>(value - container->decodeDelta(position, end_position));
+            next_position = position;
+            --position;
+            while (position > 0 && (container->deltas[position - 1] & CONTINUATION_BIT))
+                --position;
+            --index;
+        }
+
+        void advance(difference_type offset)
+        {
+            if (offset == 1)
+                increment();
+            else if (offset == -1)
+                decrement();
+            else if (offset != 0)
+                seek(index + offset);
+        }
+
+        bool equal(const const_iterator &other) const { return index == other.index; }
+
+        T dereference() const
+        {
+            BOOST_ASSERT(index < container->size());
+            BOOST_ASSERT(decoded || !container->IsEncoded());
+            return container->IsEncoded() ? value : container->values[index];
+        }
+
+        difference_type distance_to(const const_iterator &other) const
+        {
+            return other.index - index;
+        }
+
+        void seek(const std::size_t new_index)
+        {
+            index = new_index;
+            decoded = true;
+            if (!container->IsEncoded() || index >= container->size())
+                return;
+
+            const auto block = index / BLOCK_ELEMENTS;
+            position = container->block_offsets[block];
+            value = static_cast<T>(container->decode(position, next_position));
+            for (std::size_t element = block * BLOCK_ELEMENTS; element < index; ++element)
+            {
+                position = next_position;
+                value = static_cast<T>(value + container->decodeDelta(position, next_position));
+            }
+        }
+
+        const DeltaVector *container;
+        std::size_t index;
+        // first byte of the current value and first byte of the next one
+        std::size_t position;
+        std::size_t next_position;
+        T value;
+        bool decoded;
+
+        friend class ::boost::iterator_core_access;
+    };
+
+    DeltaVector() = default;
+
+    // views values encoded by another DeltaVector
+    DeltaVector(Vector<std::uint64_t> block_offsets_,
+                Vector<std::uint8_t> deltas_,
+                const std::size_t num_elements)
+        : block_offsets(std::move(block_offsets_)), deltas(std::move(deltas_)),
+          num_elements(num_elements)
+    {
+        BOOST_ASSERT(block_offsets.size() == (num_elements + BLOCK_ELEMENTS - 1) / BLOCK_ELEMENTS);
+    }
+
+    // views plain values, nothing is encoded
+    explicit DeltaVector(Vector<T> values_) : values(std::move(values_)), encoded(false)
+    {
+        num_elements = values.size();
+    }
+
+    template <bool enabled = (Ownership == storage::Ownership::View)>
+    void push_back(typename std::enable_if<!enabled, const T>::type new_value)
+    {
+        BOOST_ASSERT(encoded);
+        if (num_elements % BLOCK_ELEMENTS == 0)
+        {
+            block_offsets.push_back(deltas.size());
+            encode(new_value);
+        }
+        else
+        {
+            const auto delta =
+                static_cast<std::int64_t>(new_value) - static_cast<std::int64_t>(last);
+            // zig-zag encoding maps small negative and positive deltas to small numbers
+            encode((static_cast<std::uint64_t>(delta) << 1) ^
+                   static_cast<std::uint64_t>(delta >> 63));
+        }
+        last = new_value;
+        num_elements++;
+    }
+
+    T operator[](const std::size_t index) const { return *const_iterator(this, index); }
+
+    std::size_t size() const { return num_elements; }
+
+    bool empty() const { return num_elements == 0; }
+
+    bool IsEncoded() const { return encoded; }
+
+    auto begin() const { return const_iterator(this, 0); }
+    auto end() const { return const_iterator(this, num_elements, false); }
+    auto cbegin() const { return const_iterator(this, 0); }
+    auto cend() const { return const_iterator(this, num_elements, false); }
+
+    // the values [first, last), cheaper than offsetting begin()
+    auto GetRange(const std::size_t first, const std::size_t last) const
+    {
+        BOOST_ASSERT(first <= last && last <= num_elements);
+        return boost::make_iterator_range(const_iterator(this, first),
+                                          const_iterator(this, last, false));
+    }
+
+    // the encoded data, use it to construct a view of this vector
+    const Vector<std::uint64_t> &GetBlockOffsets() const { return block_offsets; }
+    const Vector<std::uint8_t> &GetDeltas() const { return deltas; }
+
+  private:
+    static constexpr std::uint8_t CONTINUATION_BIT = 0x80;
+
+    template <bool enabled = (Ownership == storage::Ownership::View)>
+    void encode(typename std::enable_if<!enabled, std::uint64_t>::type number)
+    {
+        while (number >= CONTINUATION_BIT)
+        {
+            deltas.push_back(static_cast<std::uint8_t>(number | CONTINUATION_BIT));
+            number >>= 7;
+        }
+        deltas.push_back(static_cast<std::uint8_t>(number));
+    }
+
+    std::uint64_t decode(const std::size_t position, std::size_t &next_position) const
+    {
+        std::uint64_t number = 0;
+        unsigned shift = 0;
+        next_position = position;
+        std::uint8_t byte;
+        do
+        {
+            byte = deltas[next_position++];
+            number |= static_cast<std::uint64_t>(byte & ~CONTINUATION_BIT) << shift;
+            shift += 7;
+        } while (byte & CONTINUATION_BIT);
+        return number;
+    }
+
+    std::int64_t decodeDelta(const std::size_t position, std::size_t &next_position) const
+    {
+        const auto number = decode(position, next_position);
+        return static_cast<std::int64_t>(number >> 1) ^ -static_cast<std::int64_t>(number & 1);
+    }
+
+    Vector<std::uint64_t> block_offsets;
+    Vector<std::uint8_t> deltas;
+    Vector<T> values;
+    std::size_t num_elements = 0;
+    bool encoded = true;
+    // only used while encoding
+    T last = 0;
+};
+}
+
+template <typename T> using DeltaVector = detail::DeltaVector<T, storage::Ownership::Container>;
+template <typename T> using DeltaVectorView = detail::DeltaVector<T, storage::Ownership::View>;
+}
+}
+
+#endif
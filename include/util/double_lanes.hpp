@@ -0,0 +1,167 @@
+#ifndef OSRM_UTIL_DOUBLE_LANES_HPP
+#define OSRM_UTIL_DOUBLE_LANES_HPP
+
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define OSRM_HAS_DOUBLE_LANES
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OSRM_HAS_DOUBLE_LANES
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define OSRM_HAS_DOUBLE_LANES
+#endif
+
+namespace osrm
+{
+namespace util
+{
+
+// A vector of doubles with the arithmetic the batched geometry functions need, for targets with
+// AVX, SSE2 or AArch64 NEON. OSRM_HAS_DOUBLE_LANES is only defined if one of them is available,
+// callers fall back to scalar code otherwise.
+namespace detail
+{
+#if defined(__AVX__)
+struct DoubleLanes
+{
+    static constexpr std::size_t SIZE = 4;
+    __m256d value;
+};
+inline DoubleLanes loadLanes(const double *values) { return {_mm256_loadu_pd(values)}; }
+inline void storeLanes(double *values, const DoubleLanes lanes)
+{
+    _mm256_storeu_pd(values, lanes.value);
+}
+inline DoubleLanes broadcastLanes(const double value) { return {_mm256_set1_pd(value)}; }
+inline DoubleLanes operator+(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {_mm256_add_pd(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator-(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {_mm256_sub_pd(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator*(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {_mm256_mul_pd(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator/(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {_mm256_div_pd(lhs.value, rhs.value)};
+}
+inline DoubleLanes sqrtLanes(const DoubleLanes lanes) { return {_mm256_sqrt_pd(lanes.value)}; }
+// lanes of if_less where lhs < rhs, lanes of otherwise everywhere else
+inline DoubleLanes selectLess(const DoubleLanes lhs,
+                              const DoubleLanes rhs,
+                              const DoubleLanes if_less,
+                              const DoubleLanes otherwise)
+{
+    return {_mm256_blendv_pd(
+        otherwise.value, if_less.value, _mm256_cmp_pd(lhs.value, rhs.value, _CMP_LT_OQ))};
+}
+// rounds half way cases to even, unlike std::round
+inline DoubleLanes roundLanes(const DoubleLanes lanes)
+{
+    return {_mm256_round_pd(lanes.value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+struct DoubleLanes
+{
+    static constexpr std::size_t SIZE = 2;
+    __m128d value;
+};
+inline DoubleLanes loadLanes(const double *values) { return {_mm_loadu_pd(values)}; }
+inline void storeLanes(double *values, const DoubleLanes lanes)
+{
+    _mm_storeu_pd(values, lanes.value);
+}
+inline DoubleLanes broadcastLanes(const double value) { return {_mm_set1_pd(value)}; }
+inline DoubleLanes operator+(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {_mm_add_pd(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator-(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {_mm_sub_pd(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator*(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {_mm_mul_pd(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator/(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {_mm_div_pd(lhs.value, rhs.value)};
+}
+inline DoubleLanes sqrtLanes(const DoubleLanes lanes) { return {_mm_sqrt_pd(lanes.value)}; }
+inline DoubleLanes selectLess(const DoubleLanes lhs,
+                              const DoubleLanes rhs,
+                              const DoubleLanes if_less,
+                              const DoubleLanes otherwise)
+{
+    const auto mask = _mm_cmplt_pd(lhs.value, rhs.value);
+    return {_mm_or_pd(_mm_and_pd(mask, if_less.value), _mm_andnot_pd(mask, otherwise.value))};
+}
+// adding and subtracting 1.5 * 2^52 drops the fraction of every value below 2^51
+inline DoubleLanes roundLanes(const DoubleLanes lanes)
+{
+    const auto shift = _mm_set1_pd(6755399441055744.);
+    return {_mm_sub_pd(_mm_add_pd(lanes.value, shift), shift)};
+}
+#elif defined(__aarch64__)
+struct DoubleLanes
+{
+    static constexpr std::size_t SIZE = 2;
+    float64x2_t value;
+};
+inline DoubleLanes loadLanes(const double *values) { return {vld1q_f64(values)}; }
+inline void storeLanes(double *values, const DoubleLanes lanes) { vst1q_f64(values, lanes.value); }
+inline DoubleLanes broadcastLanes(const double value) { return {vdupq_n_f64(value)}; }
+inline DoubleLanes operator+(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {vaddq_f64(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator-(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {vsubq_f64(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator*(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {vmulq_f64(lhs.value, rhs.value)};
+}
+inline DoubleLanes operator/(const DoubleLanes lhs, const DoubleLanes rhs)
+{
+    return {vdivq_f64(lhs.value, rhs.value)};
+}
+inline DoubleLanes sqrtLanes(const DoubleLanes lanes) { return {vsqrtq_f64(lanes.value)}; }
+inline DoubleLanes selectLess(const DoubleLanes lhs,
+                              const DoubleLanes rhs,
+                              const DoubleLanes if_less,
+                              const DoubleLanes otherwise)
+{
+    return {vbslq_f64(vcltq_f64(lhs.value, rhs.value), if_less.value, otherwise.value)};
+}
+inline DoubleLanes roundLanes(const DoubleLanes lanes) { return {vrndnq_f64(lanes.value)}; }
+#endif
+
+#ifdef OSRM_HAS_DOUBLE_LANES
+// Same order of operations as web_mercator::horner
+template <std::size_t N>
+inline DoubleLanes horner(const DoubleLanes x, const double (&coefficients)[N])
+{
+    auto result = broadcastLanes(coefficients[N - 1]);
+    for (std::size_t degree = N - 1; degree > 0; --degree)
+    {
+        result = result * x + broadcastLanes(coefficients[degree - 1]);
+    }
+    return result;
+}
+#endif
+}
+
+}
+}
+
+#endif
@@ -26,10 +26,10 @@ template <typename EdgeDataT> class DynamicGraph;
 
 namespace serialization
 {
-template <typename EdgeDataT, bool UseSharedMemory>
+template <typename EdgeDataT>
 void read(storage::io::FileReader &reader, DynamicGraph<EdgeDataT> &graph);
 
-template <typename EdgeDataT, bool UseSharedMemory>
+template <typename EdgeDataT>
 void write(storage::io::FileWriter &writer, const DynamicGraph<EdgeDataT> &graph);
 }
 
@@ -41,6 +41,11 @@ template <typename EdgeDataT> class DynamicGraph
     using EdgeIterator = std::uint32_t;
     using EdgeRange = range<EdgeIterator>;
 
+    friend void serialization::read<EdgeDataT>(storage::io::FileReader &reader,
+                                               DynamicGraph<EdgeDataT> &graph);
+    friend void serialization::write<EdgeDataT>(storage::io::FileWriter &writer,
+                                                const DynamicGraph<EdgeDataT> &graph);
+
     class InputEdge
     {
       public:
@@ -144,6 +149,9 @@ template <typename EdgeDataT> class DynamicGraph
 
     unsigned GetNumberOfEdges() const { return number_of_edges; }
 
+    // Inserting edges moves the edges of a node to the end and leaves dummies behind
+    std::size_t GetNumberOfEdgeSlots() const { return edge_list.size(); }
+
     unsigned GetOutDegree(const NodeIterator n) const { return node_array[n].edges; }
 
     unsigned GetDirectedOutDegree(const NodeIterator n) const
@@ -362,7 +370,68 @@ template <typename EdgeDataT> class DynamicGraph
         util::inplacePermutation(edge_list.begin(), edge_list.end(), old_to_new_edge);
     }
 
+    // Drops the nodes without a new id together with their edges and renumbers the others to
+    // old_to_new_node, the targets of their edges need a new id as well. The edges keep their
+    // order in the edge list, so they are moved to the front in place and the memory of the
+    // dummies behind them is freed.
+    void Compact(const std::vector<NodeID> &old_to_new_node)
+    {
+        BOOST_ASSERT(old_to_new_node.size() == number_of_nodes);
+        CompactEdges([&old_to_new_node](const NodeIterator node) { return old_to_new_node[node]; });
+    }
+
+    // Removes all dummies and keeps the node ids
+    void Compact()
+    {
+        CompactEdges([](const NodeIterator node) { return node; });
+    }
+
   protected:
+    template <typename NewNodeID> void CompactEdges(NewNodeID new_node_id)
+    {
+        std::vector<NodeIterator> kept_nodes;
+        for (const auto node : irange(0u, number_of_nodes))
+        {
+            if (new_node_id(node) != SPECIAL_NODEID)
+            {
+                kept_nodes.push_back(node);
+            }
+            else
+            {
+                number_of_edges -= node_array[node].edges;
+            }
+        }
+        std::sort(kept_nodes.begin(), kept_nodes.end(), [this](const auto lhs, const auto rhs) {
+            return node_array[lhs].first_edge < node_array[rhs].first_edge;
+        });
+
+        std::vector<Node> new_node_array(kept_nodes.size() + 1);
+        EdgeIterator position = 0;
+        for (const auto node : kept_nodes)
+        {
+            const auto new_node = new_node_id(node);
+            BOOST_ASSERT(new_node < kept_nodes.size());
+            new_node_array[new_node].first_edge = position;
+            new_node_array[new_node].edges = node_array[node].edges;
+            // the ranges are disjoint and visited in order, the position never passes the edge
+            for (const auto edge : GetAdjacentEdgeRange(node))
+            {
+                BOOST_ASSERT(position <= edge);
+                const auto target = edge_list[edge].target;
+                edge_list[position] = edge_list[edge];
+                edge_list[position].target = new_node_id(target);
+                BOOST_ASSERT(edge_list[position].target < kept_nodes.size());
+                ++position;
+            }
+        }
+        new_node_array.back().first_edge = position;
+
+        number_of_nodes = kept_nodes.size();
+        node_array.swap(new_node_array);
+        edge_list.resize(position);
+        BOOST_ASSERT(number_of_edges == position);
+    }
+
     bool isDummy(const EdgeIterator edge) const
     {
         return edge_list[edge].target == (std::numeric_limits<NodeIterator>::max)();
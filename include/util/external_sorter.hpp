@@ -0,0 +1,219 @@
+#ifndef OSRM_UTIL_EXTERNAL_SORTER_HPP
+#define OSRM_UTIL_EXTERNAL_SORTER_HPP
+
+#include "storage/io.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/filesystem.hpp>
+
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Sorts more elements than fit into memory. The elements are collected in a buffer, every full
+// buffer is sorted in parallel and written to a temporary file as a sorted run while the next
+// buffer fills up. Reading the elements merges all runs at once. As long as the elements fit
+// into one buffer nothing is written to disk.
+//
+// The memory budget covers the buffer that fills up and the one that is written, and during the
+// merge the blocks read from every run.
+template <typename T, typename Compare = std::less<T>> class ExternalSorter
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "runs are written bytewise and require a trivially copyable type");
+
+  public:
+    ExternalSorter(boost::filesystem::path directory_,
+                   const std::size_t memory_bytes,
+                   Compare compare_ = Compare{})
+        : directory(std::move(directory_)), compare(std::move(compare_)),
+          memory_size(std::max<std::size_t>(memory_bytes / sizeof(T), 2))
+    {
+        buffer.reserve(memory_size / 2);
+    }
+
+    ExternalSorter(const ExternalSorter &) = delete;
+    ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+    ~ExternalSorter()
+    {
+        if (spilling.valid())
+        {
+            spilling.wait();
+        }
+        for (const auto &run : runs)
+        {
+            boost::system::error_code ignored;
+            boost::filesystem::remove(run.path, ignored);
+        }
+    }
+
+    void push_back(const T &value)
+    {
+        if (buffer.size() == memory_size / 2)
+        {
+            Spill();
+        }
+        buffer.push_back(value);
+        ++number_of_elements;
+    }
+
+    std::size_t size() const { return number_of_elements; }
+    std::size_t NumberOfRuns() const { return runs.size(); }
+
+    // Calls callback with all elements in sorted order. Elements that compare equal are not
+    // returned in a defined order.
+    template <typename Callback> void ForEach(Callback &&callback)
+    {
+        if (spilling.valid())
+        {
+            spilling.get();
+        }
+
+        tbb::parallel_sort(buffer.begin(), buffer.end(), compare);
+        if (runs.empty())
+        {
+            for (const auto &value : buffer)
+            {
+                callback(value);
+            }
+            return;
+        }
+
+        // the buffer is merged as a run that is already in memory
+        const std::size_t block_size =
+            std::max<std::size_t>((memory_size - buffer.size()) / runs.size(), 1);
+        std::vector<std::unique_ptr<RunReader>> readers;
+        readers.reserve(runs.size());
+        for (const auto &run : runs)
+        {
+            readers.push_back(std::make_unique<RunReader>(run, block_size));
+        }
+
+        using Head = std::pair<T, std::size_t>;
+        const auto greater = [this](const Head &lhs, const Head &rhs) {
+            return compare(rhs.first, lhs.first);
+        };
+        std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+        for (auto index = 0u; index < readers.size(); ++index)
+        {
+            heads.push(Head{readers[index]->Next(), index});
+        }
+        const std::size_t buffer_index = readers.size();
+        std::size_t buffer_position = 0;
+        if (!buffer.empty())
+        {
+            heads.push(Head{buffer[buffer_position++], buffer_index});
+        }
+
+        while (!heads.empty())
+        {
+            const auto head = heads.top();
+            heads.pop();
+            callback(head.first);
+
+            if (head.second == buffer_index)
+            {
+                if (buffer_position < buffer.size())
+                {
+                    heads.push(Head{buffer[buffer_position++], buffer_index});
+                }
+            }
+            else if (!readers[head.second]->Done())
+            {
+                heads.push(Head{readers[head.second]->Next(), head.second});
+            }
+        }
+    }
+
+  private:
+    struct Run
+    {
+        boost::filesystem::path path;
+        std::size_t size;
+    };
+
+    // Reads a run block by block
+    class RunReader
+    {
+      public:
+        RunReader(const Run &run, const std::size_t block_size_)
+            : reader(run.path,
+                     storage::io::FileReader::HasNoFingerprint,
+                     storage::io::FileReader::StreamRead),
+              remaining(run.size), block_size(block_size_)
+        {
+            BOOST_ASSERT(run.size > 0);
+        }
+
+        bool Done() const { return position == block.size() && remaining == 0; }
+
+        T Next()
+        {
+            BOOST_ASSERT(!Done());
+            if (position == block.size())
+            {
+                block.resize(std::min(block_size, remaining));
+                reader.ReadInto(block);
+                remaining -= block.size();
+                position = 0;
+            }
+            return block[position++];
+        }
+
+      private:
+        storage::io::FileReader reader;
+        std::vector<T> block;
+        std::size_t position = 0;
+        std::size_t remaining;
+        std::size_t block_size;
+    };
+
+    void Spill()
+    {
+        // only one buffer is written at a time
+        if (spilling.valid())
+        {
+            spilling.get();
+        }
+
+        runs.push_back(
+            Run{directory / boost::filesystem::unique_path("osrm-sort-%%%%-%%%%-%%%%.tmp"),
+                buffer.size()});
+        auto full_buffer = std::make_shared<std::vector<T>>(std::move(buffer));
+        spilling = std::async(std::launch::async, [this, full_buffer, path = runs.back().path]() {
+            tbb::parallel_sort(full_buffer->begin(), full_buffer->end(), compare);
+            storage::io::FileWriter writer(path, storage::io::FileWriter::HasNoFingerprint);
+            writer.WriteFrom(*full_buffer);
+        });
+
+        buffer = std::vector<T>();
+        buffer.reserve(memory_size / 2);
+    }
+
+    const boost::filesystem::path directory;
+    const Compare compare;
+    const std::size_t memory_size;
+
+    std::vector<T> buffer;
+    std::vector<Run> runs;
+    std::future<void> spilling;
+    std::size_t number_of_elements = 0;
+};
+}
+}
+
+#endif
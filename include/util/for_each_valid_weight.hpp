@@ -0,0 +1,118 @@
+#ifndef OSRM_UTIL_FOR_EACH_VALID_WEIGHT_HPP
+#define OSRM_UTIL_FOR_EACH_VALID_WEIGHT_HPP
+
+#include "util/typedefs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace osrm
+{
+namespace util
+{
+
+namespace detail
+{
+// Calls f for the lanes set in valid_mask, lane i of candidates belongs to row[offset + i]
+template <std::size_t LANES, typename Func>
+inline void for_each_valid_lane(const std::uint32_t valid_mask,
+                                const EdgeWeight (&candidates)[LANES],
+                                const std::size_t offset,
+                                Func &f)
+{
+    for (std::size_t lane = 0; lane < LANES; ++lane)
+    {
+        if (valid_mask & (1u << lane))
+        {
+            f(offset + lane, candidates[lane]);
+        }
+    }
+}
+}
+
+// Calls f(index, weight + row[index]) in order for every weight of the row that is not
+// INVALID_EDGE_WEIGHT. On targets with AVX2, SSE2 or AArch64 NEON the sums and the validity of a
+// whole vector of the row are computed at once, only valid entries are passed on to f.
+template <typename Func>
+inline void for_each_valid_weight(const EdgeWeight *const row,
+                                  const std::size_t size,
+                                  const EdgeWeight weight,
+                                  Func f)
+{
+    std::size_t index = 0;
+
+#if defined(__AVX2__)
+    constexpr std::size_t LANES = 8;
+    const auto invalid = _mm256_set1_epi32(INVALID_EDGE_WEIGHT);
+    const auto offset = _mm256_set1_epi32(weight);
+    for (; index + LANES <= size; index += LANES)
+    {
+        const auto weights = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + index));
+        const auto invalid_mask = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(weights, invalid)));
+        const std::uint32_t valid_mask = ~invalid_mask & 0xff;
+        if (valid_mask == 0)
+            continue;
+
+        EdgeWeight candidates[LANES];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(candidates),
+                            _mm256_add_epi32(weights, offset));
+        detail::for_each_valid_lane(valid_mask, candidates, index, f);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    constexpr std::size_t LANES = 4;
+    const auto invalid = _mm_set1_epi32(INVALID_EDGE_WEIGHT);
+    const auto offset = _mm_set1_epi32(weight);
+    for (; index + LANES <= size; index += LANES)
+    {
+        const auto weights = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + index));
+        const auto invalid_mask =
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(weights, invalid)));
+        const std::uint32_t valid_mask = ~invalid_mask & 0xf;
+        if (valid_mask == 0)
+            continue;
+
+        EdgeWeight candidates[LANES];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(candidates), _mm_add_epi32(weights, offset));
+        detail::for_each_valid_lane(valid_mask, candidates, index, f);
+    }
+#elif defined(__aarch64__)
+    constexpr std::size_t LANES = 4;
+    const auto invalid = vdupq_n_s32(INVALID_EDGE_WEIGHT);
+    const auto offset = vdupq_n_s32(weight);
+    const std::uint32_t lane_bits[LANES] = {1, 2, 4, 8};
+    const auto bits = vld1q_u32(lane_bits);
+    for (; index + LANES <= size; index += LANES)
+    {
+        const auto weights = vld1q_s32(row + index);
+        const auto valid = vmvnq_u32(vceqq_s32(weights, invalid));
+        const std::uint32_t valid_mask = vaddvq_u32(vandq_u32(valid, bits));
+        if (valid_mask == 0)
+            continue;
+
+        EdgeWeight candidates[LANES];
+        vst1q_s32(candidates, vaddq_s32(weights, offset));
+        detail::for_each_valid_lane(valid_mask, candidates, index, f);
+    }
+#endif
+
+    for (; index < size; ++index)
+    {
+        if (row[index] != INVALID_EDGE_WEIGHT)
+        {
+            f(index, weight + row[index]);
+        }
+    }
+}
+}
+}
+
+#endif
@@ -41,6 +41,12 @@ class BearingClass
   public:
     BearingClass();
 
+    // A class of the sorted bearings in [begin, end)
+    template <typename BearingIter>
+    BearingClass(BearingIter begin, BearingIter end) : available_bearings(begin, end)
+    {
+    }
+
     // Add a bearing to the set
     void add(const DiscreteBearing bearing);
 
@@ -6,6 +6,7 @@
 #include "extractor/suffix_table.hpp"
 #include "util/attributes.hpp"
 #include "util/name_table.hpp"
+#include "util/string_view.hpp"
 #include "util/typedefs.hpp"
 
 #include <algorithm>
@@ -25,30 +26,41 @@ namespace guidance
 // Name Change Logic
 // Used both during Extraction as well as during Post-Processing
 
-inline std::pair<std::string, std::string> getPrefixAndSuffix(const std::string &data)
+inline std::pair<std::string, std::string> getPrefixAndSuffix(const StringView data)
 {
     const auto suffix_pos = data.find_last_of(' ');
-    if (suffix_pos == std::string::npos)
+    if (suffix_pos == StringView::npos)
         return {};
 
     const auto prefix_pos = data.find_first_of(' ');
-    auto result = std::make_pair(data.substr(0, prefix_pos), data.substr(suffix_pos + 1));
+    auto result = std::make_pair(data.substr(0, prefix_pos).to_string(),
+                                 data.substr(suffix_pos + 1).to_string());
     boost::to_lower(result.first);
     boost::to_lower(result.second);
     return result;
 }
 
+// The first and the last word of a name as views into it, both are empty for a single word
+inline std::pair<StringView, StringView> getFirstAndLastWord(const StringView data)
+{
+    const auto last_pos = data.find_last_of(' ');
+    if (last_pos == StringView::npos)
+        return {};
+
+    return std::make_pair(data.substr(0, data.find_first_of(' ')), data.substr(last_pos + 1));
+}
+
 // Note: there is an overload without suffix checking below.
 // (that's the reason we template the suffix table here)
 template <typename SuffixTable>
-inline bool requiresNameAnnounced(const std::string &from_name,
-                                  const std::string &from_ref,
-                                  const std::string &from_pronunciation,
-                                  const std::string &from_exits,
-                                  const std::string &to_name,
-                                  const std::string &to_ref,
-                                  const std::string &to_pronunciation,
-                                  const std::string &to_exits,
+inline bool requiresNameAnnounced(const StringView from_name,
+                                  const StringView from_ref,
+                                  const StringView from_pronunciation,
+                                  const StringView from_exits,
+                                  const StringView to_name,
+                                  const StringView to_ref,
+                                  const StringView to_pronunciation,
+                                  const StringView to_exits,
                                   const SuffixTable &suffix_table)
 {
     // first is empty and the second is not
@@ -65,17 +77,17 @@ inline bool requiresNameAnnounced(const std::string &from_name,
         boost::starts_with(from_name, to_name) || boost::starts_with(to_name, from_name);
 
     const auto checkForPrefixOrSuffixChange = [](
-        const std::string &first, const std::string &second, const SuffixTable &suffix_table) {
+        const StringView first, const StringView second, const SuffixTable &suffix_table) {
 
-        const auto first_prefix_and_suffixes = getPrefixAndSuffix(first);
-        const auto second_prefix_and_suffixes = getPrefixAndSuffix(second);
+        // the suffix table ignores the case, the words are looked up without copying them
+        const auto first_prefix_and_suffixes = getFirstAndLastWord(first);
+        const auto second_prefix_and_suffixes = getFirstAndLastWord(second);
 
-        // reverse strings, get suffices and reverse them to get prefixes
-        const auto checkTable = [&](const std::string &str) {
+        const auto checkTable = [&](const StringView str) {
             return str.empty() || suffix_table.isSuffix(str);
         };
 
-        const auto getOffset = [](const std::string &str) -> std::size_t {
+        const auto getOffset = [](const StringView str) -> std::size_t {
             if (str.empty())
                 return 0;
             else
@@ -87,11 +99,8 @@ inline bool requiresNameAnnounced(const std::string &from_name,
                 return false;
             if (!checkTable(second_prefix_and_suffixes.first))
                 return false;
-            return !first.compare(getOffset(first_prefix_and_suffixes.first),
-                                  std::string::npos,
-                                  second,
-                                  getOffset(second_prefix_and_suffixes.first),
-                                  std::string::npos);
+            return first.substr(getOffset(first_prefix_and_suffixes.first)) ==
+                   second.substr(getOffset(second_prefix_and_suffixes.first));
         }();
 
         const bool is_suffix_change = [&]() -> bool {
@@ -99,11 +108,9 @@ inline bool requiresNameAnnounced(const std::string &from_name,
                 return false;
             if (!checkTable(second_prefix_and_suffixes.second))
                 return false;
-            return !first.compare(0,
-                                  first.length() - getOffset(first_prefix_and_suffixes.second),
-                                  second,
-                                  0,
-                                  second.length() - getOffset(second_prefix_and_suffixes.second));
+            return first.substr(0, first.length() - getOffset(first_prefix_and_suffixes.second)) ==
+                   second.substr(0,
+                                 second.length() - getOffset(second_prefix_and_suffixes.second));
         }();
 
         return is_prefix_change || is_suffix_change;
@@ -116,7 +123,7 @@ inline bool requiresNameAnnounced(const std::string &from_name,
     const auto refs_are_empty = from_ref.empty() && to_ref.empty();
     const auto ref_is_contained =
         from_ref.empty() || to_ref.empty() ||
-        (from_ref.find(to_ref) != std::string::npos || to_ref.find(from_ref) != std::string::npos);
+        (from_ref.find(to_ref) != StringView::npos || to_ref.find(from_ref) != StringView::npos);
     const auto ref_is_removed = !from_ref.empty() && to_ref.empty();
 
     const auto obvious_change =
@@ -151,21 +158,21 @@ inline bool requiresNameAnnounced(const std::string &from_name,
 }
 
 // Overload without suffix checking
-inline bool requiresNameAnnounced(const std::string &from_name,
-                                  const std::string &from_ref,
-                                  const std::string &from_pronunciation,
-                                  const std::string &from_exits,
-                                  const std::string &to_name,
-                                  const std::string &to_ref,
-                                  const std::string &to_pronunciation,
-                                  const std::string &to_exits)
+inline bool requiresNameAnnounced(const StringView from_name,
+                                  const StringView from_ref,
+                                  const StringView from_pronunciation,
+                                  const StringView from_exits,
+                                  const StringView to_name,
+                                  const StringView to_ref,
+                                  const StringView to_pronunciation,
+                                  const StringView to_exits)
 {
     // Dummy since we need to provide a SuffixTable but do not have the data for it.
     // (Guidance Post-Processing does not keep the suffix table around at the moment)
     struct NopSuffixTable final
     {
         NopSuffixTable() {}
-        bool isSuffix(const std::string &) const { return false; }
+        bool isSuffix(const StringView) const { return false; }
     } static const table;
 
     return requiresNameAnnounced(from_name,
@@ -186,19 +193,36 @@ inline bool requiresNameAnnounced(const NameID from_name_id,
 {
     if (from_name_id == to_name_id)
         return false;
-    else
-        return requiresNameAnnounced(name_table.GetNameForID(from_name_id).to_string(),
-                                     name_table.GetRefForID(from_name_id).to_string(),
-                                     name_table.GetPronunciationForID(from_name_id).to_string(),
-                                     name_table.GetExitsForID(from_name_id).to_string(),
-                                     //
-                                     name_table.GetNameForID(to_name_id).to_string(),
-                                     name_table.GetRefForID(to_name_id).to_string(),
-                                     name_table.GetPronunciationForID(to_name_id).to_string(),
-                                     name_table.GetExitsForID(to_name_id).to_string(),
-                                     //
-                                     suffix_table);
-    // FIXME: converts StringViews to strings since the name change heuristics mutates in place
+
+    const auto from_name = name_table.GetNameForID(from_name_id);
+    const auto from_ref = name_table.GetRefForID(from_name_id);
+    const auto from_pronunciation = name_table.GetPronunciationForID(from_name_id);
+    const auto from_exits = name_table.GetExitsForID(from_name_id);
+    const auto to_name = name_table.GetNameForID(to_name_id);
+    const auto to_ref = name_table.GetRefForID(to_name_id);
+    const auto to_pronunciation = name_table.GetPronunciationForID(to_name_id);
+    const auto to_exits = name_table.GetExitsForID(to_name_id);
+
+    // Ids that only differ in their destinations are common along motorways. The name table
+    // stores repeated strings once, so equal strings mostly compare as equal pointers here.
+    const auto same = [](const StringView lhs, const StringView rhs) {
+        return lhs.size() == rhs.size() && (lhs.data() == rhs.data() || lhs == rhs);
+    };
+    if (same(from_name, to_name) && same(from_ref, to_ref) &&
+        same(from_pronunciation, to_pronunciation) && same(from_exits, to_exits))
+        return false;
+
+    return requiresNameAnnounced(from_name,
+                                 from_ref,
+                                 from_pronunciation,
+                                 from_exits,
+                                 //
+                                 to_name,
+                                 to_ref,
+                                 to_pronunciation,
+                                 to_exits,
+                                 //
+                                 suffix_table);
 }
 
 inline bool requiresNameAnnounced(const NameID from_name_id,
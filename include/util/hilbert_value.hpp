@@ -3,8 +3,12 @@
 
 #include "osrm/coordinate.hpp"
 
+#include <algorithm>
 #include <climits>
+#include <cstddef>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
@@ -69,6 +73,24 @@ inline std::uint64_t GetHilbertCode(const Coordinate &coordinate)
                             static_cast<std::int32_t>(90 * COORDINATE_PRECISION);
     return HilbertToLinear(x, y);
 }
+
+// Indexes of the coordinates in the order they lie on the Hilbert curve, coordinates close to each
+// other follow each other. Searches for them in that order find the data they share in cache.
+inline std::vector<std::size_t> GetHilbertOrder(const std::vector<Coordinate> &coordinates)
+{
+    std::vector<std::pair<std::uint64_t, std::size_t>> codes(coordinates.size());
+    for (std::size_t index = 0; index < coordinates.size(); ++index)
+    {
+        codes[index] = std::make_pair(GetHilbertCode(coordinates[index]), index);
+    }
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<std::size_t> order(coordinates.size());
+    std::transform(codes.begin(), codes.end(), order.begin(), [](const auto &code) {
+        return code.second;
+    });
+    return order;
+}
 }
 }
 
@@ -0,0 +1,59 @@
+#ifndef OSRM_UTIL_HUGE_PAGES_HPP
+#define OSRM_UTIL_HUGE_PAGES_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace osrm
+{
+namespace util
+{
+
+// Size of the default huge pages of the system in bytes, 0 if it has none
+std::size_t getHugePageSize();
+
+// Rounds size up to a whole number of huge pages, unchanged if the system has none
+std::size_t roundToHugePages(const std::size_t size);
+
+// Asks the kernel to back a page aligned range with transparent huge pages, false if it can not
+bool adviseHugePages(void *address, const std::size_t size);
+
+// Faults in all pages of a mapped range so later reads do not wait for the kernel, in parallel
+// unless the system can populate the range itself
+void prefaultPages(const void *address, const std::size_t size);
+
+// Locks the pages of a range into RAM so the kernel does not evict them, false with errno set if
+// the limit of locked memory is too low or the system can not lock memory
+bool lockPages(const void *address, const std::size_t size);
+
+// Describes the limit of locked memory of the process, e.g. "65536 bytes", for error messages
+std::string describeLockedMemoryLimit();
+
+// Describes the pages backing the mapping that contains address, e.g. "2048 kB pages", for logs
+std::string describePages(const void *address);
+
+// Zero initialized memory of the process. On Linux it is mapped, so its pages are only allocated
+// once they are first touched. With use_huge_pages it is allocated from the reserved huge pages of
+// the system, or else backed by transparent huge pages if the kernel supports them. Otherwise, or
+// if both fail, it uses regular pages.
+class ProcessMemory
+{
+  public:
+    ProcessMemory(const std::size_t size, const bool use_huge_pages);
+    ~ProcessMemory();
+
+    ProcessMemory(const ProcessMemory &) = delete;
+    ProcessMemory &operator=(const ProcessMemory &) = delete;
+
+    char *Get() const { return memory; }
+
+  private:
+    char *memory;
+    // start and size of the mapping holding memory, nullptr if it was allocated with new[]
+    void *mapping;
+    std::size_t mapping_size;
+};
+}
+}
+
+#endif
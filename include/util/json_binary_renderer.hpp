@@ -0,0 +1,208 @@
+#ifndef JSON_BINARY_RENDERER_HPP
+#define JSON_BINARY_RENDERER_HPP
+
+#include "osrm/json_container.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+namespace json
+{
+
+// Binary encoding of a json::Object that clients can navigate in place, without parsing. All
+// integers are little-endian and every offset is counted from the start of the buffer:
+//
+//   char[4] "OSRM"             magic
+//   uint32 version             BINARY_FORMAT_VERSION
+//   slot                       the root object, at offset 8
+//
+// A slot is 16 bytes at an 8 byte aligned offset:
+//
+//   uint32 type, uint32 size, uint64 payload
+//
+//   BINARY_NULL, FALSE, TRUE   size and payload are 0
+//   BINARY_NUMBER              payload holds the bits of the float64 value
+//   BINARY_STRING              size bytes of UTF-8 at offset payload, NUL terminated
+//   BINARY_ARRAY               size slots at offset payload
+//   BINARY_OBJECT              size (key, value) slot pairs at offset payload, the
+//                              keys are BINARY_STRING slots in insertion order
+//   BINARY_NUMBER_ARRAY        size float64 at offset payload, NaN for null
+//
+// Arrays of numbers - durations, coordinates, annotations - make up most of a response, they are
+// packed as plain float64 so a client can map them onto a double array straight away. An array
+// only becomes a BINARY_NUMBER_ARRAY if it holds at least one number and nothing but numbers and
+// nulls.
+constexpr std::uint32_t BINARY_FORMAT_VERSION = 1;
+
+enum BinaryValueType : std::uint32_t
+{
+    BINARY_NULL = 0,
+    BINARY_FALSE = 1,
+    BINARY_TRUE = 2,
+    BINARY_NUMBER = 3,
+    BINARY_STRING = 4,
+    BINARY_ARRAY = 5,
+    BINARY_OBJECT = 6,
+    BINARY_NUMBER_ARRAY = 7
+};
+
+namespace detail
+{
+
+class BinaryRenderer
+{
+  public:
+    static constexpr std::size_t HEADER_SIZE = 8;
+    static constexpr std::size_t SLOT_SIZE = 16;
+
+    explicit BinaryRenderer(std::vector<char> &out) : out(out) {}
+
+    void Render(const Object &object)
+    {
+        BOOST_ASSERT(out.empty());
+        const std::uint32_t version = BINARY_FORMAT_VERSION;
+        out.insert(out.end(), {'O', 'S', 'R', 'M'});
+        Append(&version, sizeof(version));
+        BOOST_ASSERT(out.size() == HEADER_SIZE);
+        (*this)(ReserveSlots(1), object);
+    }
+
+    // Fills the slot at the given offset, the buffer may grow in between so we never hold on
+    // to pointers into it
+    void operator()(const std::size_t slot, const String &string)
+    {
+        WriteString(slot, string.value);
+    }
+
+    void operator()(const std::size_t slot, const Number &number)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &number.value, sizeof(bits));
+        SetSlot(slot, BINARY_NUMBER, 0, bits);
+    }
+
+    void operator()(const std::size_t slot, const Object &object)
+    {
+        const auto members = ReserveSlots(2 * object.values.size());
+        auto current = members;
+        for (const auto &member : object.values)
+        {
+            WriteString(current, member.first);
+            Visit(current + SLOT_SIZE, member.second);
+            current += 2 * SLOT_SIZE;
+        }
+        SetSlot(slot, BINARY_OBJECT, object.values.size(), members);
+    }
+
+    void operator()(const std::size_t slot, const Array &array)
+    {
+        if (IsNumberArray(array))
+        {
+            Align();
+            const auto offset = out.size();
+            for (const auto &value : array.values)
+            {
+                const double number = value.is<Number>() ? value.get<Number>().value
+                                                         : std::numeric_limits<double>::quiet_NaN();
+                Append(&number, sizeof(number));
+            }
+            SetSlot(slot, BINARY_NUMBER_ARRAY, array.values.size(), offset);
+            return;
+        }
+
+        const auto elements = ReserveSlots(array.values.size());
+        auto current = elements;
+        for (const auto &value : array.values)
+        {
+            Visit(current, value);
+            current += SLOT_SIZE;
+        }
+        SetSlot(slot, BINARY_ARRAY, array.values.size(), elements);
+    }
+
+    void operator()(const std::size_t slot, const True &) { SetSlot(slot, BINARY_TRUE, 0, 0); }
+
+    void operator()(const std::size_t slot, const False &) { SetSlot(slot, BINARY_FALSE, 0, 0); }
+
+    void operator()(const std::size_t slot, const Null &) { SetSlot(slot, BINARY_NULL, 0, 0); }
+
+  private:
+    void Visit(const std::size_t slot, const Value &value)
+    {
+        mapbox::util::apply_visitor(
+            [this, slot](const auto &alternative) { (*this)(slot, alternative); }, value);
+    }
+
+    void WriteString(const std::size_t slot, const std::string &value)
+    {
+        const auto offset = out.size();
+        out.insert(out.end(), value.begin(), value.end());
+        out.push_back('\0');
+        SetSlot(slot, BINARY_STRING, value.size(), offset);
+    }
+
+    static bool IsNumberArray(const Array &array)
+    {
+        bool has_number = false;
+        for (const auto &value : array.values)
+        {
+            if (value.is<Number>())
+                has_number = true;
+            else if (!value.is<Null>())
+                return false;
+        }
+        return has_number;
+    }
+
+    void Append(const void *data, const std::size_t size)
+    {
+        const auto *bytes = static_cast<const char *>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    void Align() { out.resize((out.size() + 7) & ~std::size_t{7}); }
+
+    std::size_t ReserveSlots(const std::size_t count)
+    {
+        Align();
+        const auto offset = out.size();
+        out.resize(offset + count * SLOT_SIZE);
+        return offset;
+    }
+
+    void SetSlot(const std::size_t slot,
+                 const std::uint32_t type,
+                 const std::size_t size,
+                 const std::uint64_t payload)
+    {
+        BOOST_ASSERT(size <= std::numeric_limits<std::uint32_t>::max());
+        const auto size_32 = static_cast<std::uint32_t>(size);
+        std::memcpy(&out[slot], &type, sizeof(type));
+        std::memcpy(&out[slot + 4], &size_32, sizeof(size_32));
+        std::memcpy(&out[slot + 8], &payload, sizeof(payload));
+    }
+
+    std::vector<char> &out;
+};
+}
+
+// Offsets are counted from the start of out, so it has to be empty
+inline void renderBinary(std::vector<char> &out, const Object &object)
+{
+    detail::BinaryRenderer(out).Render(object);
+}
+
+} // namespace json
+} // namespace util
+} // namespace osrm
+
+#endif // JSON_BINARY_RENDERER_HPP
@@ -33,8 +33,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <mapbox/variant.hpp>
 
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -127,14 +129,132 @@ using Value = mapbox::util::variant<String,
                                     False,
                                     Null>;
 
+/**
+ * Key-value pairs of an Object in insertion order.
+ *
+ * Response objects only hold a handful of keys: a linear scan over one flat vector is as fast
+ * as hashing and needs a single allocation per object instead of one per key. Offers the subset
+ * of the std::unordered_map interface we use, iteration yields std::pair<std::string, Value>.
+ */
+class Members
+{
+  public:
+    using value_type = std::pair<std::string, Value>;
+    using container_type = std::vector<value_type>;
+    using iterator = container_type::iterator;
+    using const_iterator = container_type::const_iterator;
+    using size_type = container_type::size_type;
+
+    Members() = default;
+    Members(std::initializer_list<value_type> init) : members(init) {}
+
+    Value &operator[](const std::string &key)
+    {
+        auto iter = find(key);
+        if (iter != members.end())
+        {
+            return iter->second;
+        }
+        members.emplace_back(key, Value{});
+        return members.back().second;
+    }
+
+    Value &operator[](std::string &&key)
+    {
+        auto iter = find(key);
+        if (iter != members.end())
+        {
+            return iter->second;
+        }
+        members.emplace_back(std::move(key), Value{});
+        return members.back().second;
+    }
+
+    Value &at(const std::string &key)
+    {
+        auto iter = find(key);
+        if (iter == members.end())
+        {
+            throw std::out_of_range("json::Object has no key " + key);
+        }
+        return iter->second;
+    }
+
+    const Value &at(const std::string &key) const
+    {
+        auto iter = find(key);
+        if (iter == members.end())
+        {
+            throw std::out_of_range("json::Object has no key " + key);
+        }
+        return iter->second;
+    }
+
+    iterator find(const std::string &key)
+    {
+        return std::find_if(members.begin(), members.end(), [&key](const value_type &member) {
+            return member.first == key;
+        });
+    }
+
+    const_iterator find(const std::string &key) const
+    {
+        return std::find_if(members.begin(), members.end(), [&key](const value_type &member) {
+            return member.first == key;
+        });
+    }
+
+    size_type count(const std::string &key) const { return find(key) == members.end() ? 0 : 1; }
+
+    std::pair<iterator, bool> emplace(std::string key, Value value)
+    {
+        auto iter = find(key);
+        if (iter != members.end())
+        {
+            return std::make_pair(iter, false);
+        }
+        members.emplace_back(std::move(key), std::move(value));
+        return std::make_pair(members.end() - 1, true);
+    }
+
+    iterator erase(iterator position) { return members.erase(position); }
+
+    size_type erase(const std::string &key)
+    {
+        auto iter = find(key);
+        if (iter == members.end())
+        {
+            return 0;
+        }
+        members.erase(iter);
+        return 1;
+    }
+
+    iterator begin() { return members.begin(); }
+    iterator end() { return members.end(); }
+    const_iterator begin() const { return members.begin(); }
+    const_iterator end() const { return members.end(); }
+    const_iterator cbegin() const { return members.cbegin(); }
+    const_iterator cend() const { return members.cend(); }
+
+    size_type size() const { return members.size(); }
+    bool empty() const { return members.empty(); }
+    void clear() { members.clear(); }
+    void reserve(const size_type capacity) { members.reserve(capacity); }
+
+  private:
+    container_type members;
+};
+
 /**
  * Typed Object.
  *
- * Unwrap the key-value pairs holding type via its values member attribute.
+ * Unwrap the key-value pairs holding type via its values member attribute. Keys are rendered in
+ * the order they were inserted.
  */
 struct Object
 {
-    std::unordered_map<std::string, Value> values;
+    Members values;
 };
 
 /**
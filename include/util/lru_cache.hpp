@@ -0,0 +1,160 @@
+#ifndef OSRM_UTIL_LRU_CACHE_HPP
+#define OSRM_UTIL_LRU_CACHE_HPP
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+struct CacheStatistics
+{
+    std::uint64_t hits;
+    std::uint64_t misses;
+    // entries dropped to make room for new ones, clearing the cache does not count
+    std::uint64_t evictions;
+    // entries currently cached
+    std::uint64_t entries;
+    std::uint64_t capacity;
+};
+
+// A thread safe cache that keeps the most recently used values of up to capacity keys.
+//
+// The keys are split into shards by their hash, each shard is a LRU list of its own with its own
+// lock. Concurrent lookups of different keys rarely wait for each other and the critical section
+// of a lookup is a hash map search and a list splice. Values are shared immutable objects, a
+// value is never copied under a lock and stays valid after it was evicted.
+template <typename Key, typename Value, typename Hash = std::hash<Key>> class ShardedLRUCache
+{
+  public:
+    using ValuePtr = std::shared_ptr<const Value>;
+
+    explicit ShardedLRUCache(const std::size_t capacity, const std::size_t number_of_shards = 16)
+        // every shard holds at least one entry, small caches use fewer shards
+        : capacity(capacity),
+          shards(std::max<std::size_t>(1, std::min(number_of_shards, capacity)))
+    {
+        BOOST_ASSERT(capacity > 0);
+        const auto shard_capacity = (capacity + shards.size() - 1) / shards.size();
+        for (auto &shard : shards)
+        {
+            shard.capacity = shard_capacity;
+        }
+    }
+
+    ShardedLRUCache(const ShardedLRUCache &) = delete;
+    ShardedLRUCache &operator=(const ShardedLRUCache &) = delete;
+
+    // Returns nullptr if the key is not cached
+    ValuePtr Get(const Key &key)
+    {
+        auto &shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto position = shard.index.find(key);
+        if (position == shard.index.end())
+        {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        shard.entries.splice(shard.entries.begin(), shard.entries, position->second);
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return position->second->second;
+    }
+
+    // Replaces the value of a cached key, evicts the least recently used key of the shard if full
+    void Insert(const Key &key, ValuePtr value)
+    {
+        auto &shard = GetShard(key);
+        // the evicted value is destroyed outside of the lock
+        ValuePtr evicted;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto position = shard.index.find(key);
+        if (position != shard.index.end())
+        {
+            evicted = std::move(position->second->second);
+            position->second->second = std::move(value);
+            shard.entries.splice(shard.entries.begin(), shard.entries, position->second);
+            return;
+        }
+
+        if (shard.entries.size() >= shard.capacity)
+        {
+            evicted = std::move(shard.entries.back().second);
+            shard.index.erase(shard.entries.back().first);
+            shard.entries.pop_back();
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.entries.emplace_front(key, std::move(value));
+        shard.index.emplace(key, shard.entries.begin());
+    }
+
+    void Clear()
+    {
+        for (auto &shard : shards)
+        {
+            std::list<std::pair<Key, ValuePtr>> entries;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.index.clear();
+                entries.swap(shard.entries);
+            }
+        }
+    }
+
+    CacheStatistics GetStatistics() const
+    {
+        std::uint64_t entries = 0;
+        for (const auto &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            entries += shard.entries.size();
+        }
+        return CacheStatistics{hits.load(std::memory_order_relaxed),
+                               misses.load(std::memory_order_relaxed),
+                               evictions.load(std::memory_order_relaxed),
+                               entries,
+                               capacity};
+    }
+
+  private:
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::size_t capacity = 0;
+        // most recently used first
+        std::list<std::pair<Key, ValuePtr>> entries;
+        std::unordered_map<Key, typename std::list<std::pair<Key, ValuePtr>>::iterator, Hash>
+            index;
+    };
+
+    Shard &GetShard(const Key &key)
+    {
+        // the low bits select the bucket of the shard's hash map, mix before using them again
+        const std::uint64_t hash = Hash()(key);
+        return shards[(hash * 0x9E3779B97F4A7C15ull >> 32) % shards.size()];
+    }
+
+    const std::size_t capacity;
+    std::vector<Shard> shards;
+
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> evictions{0};
+};
+}
+}
+
+#endif
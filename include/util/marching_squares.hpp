@@ -0,0 +1,74 @@
+#ifndef OSRM_UTIL_MARCHING_SQUARES_HPP
+#define OSRM_UTIL_MARCHING_SQUARES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+namespace marching_squares
+{
+
+// A raster of cells that are either set or not, rows go from the bottom to the top
+class Grid
+{
+  public:
+    Grid(const std::size_t width, const std::size_t height)
+        : width(width), height(height), cells(width * height, false)
+    {
+    }
+
+    std::size_t GetWidth() const { return width; }
+    std::size_t GetHeight() const { return height; }
+
+    void Set(const std::size_t x, const std::size_t y) { cells[y * width + x] = true; }
+
+    // cells outside of the grid are never set
+    bool IsSet(const std::int64_t x, const std::int64_t y) const
+    {
+        return x >= 0 && y >= 0 && x < static_cast<std::int64_t>(width) &&
+               y < static_cast<std::int64_t>(height) && cells[y * width + x];
+    }
+
+    // Morphological closing with a 3x3 neighbourhood: fills the gaps of one cell between set
+    // cells. Nothing is lost at the borders as long as the outermost cells are unset.
+    void Close();
+
+  private:
+    std::size_t width;
+    std::size_t height;
+    std::vector<bool> cells;
+};
+
+// Points are in doubled grid coordinates: cell (x, y) is centered on (2x, 2y), the contours run
+// through the midpoints between neighbouring cells
+struct Point
+{
+    std::int32_t x;
+    std::int32_t y;
+
+    bool operator==(const Point &other) const { return x == other.x && y == other.y; }
+};
+
+// A ring is closed implicitly, its last point connects to the first one
+using Ring = std::vector<Point>;
+
+struct Polygon
+{
+    // counter-clockwise
+    Ring outer;
+    // clockwise
+    std::vector<Ring> holes;
+};
+
+// The outlines of the set cells. Cells that only touch at a corner end up in different polygons,
+// points on straight lines are dropped.
+std::vector<Polygon> traceContours(const Grid &grid);
+}
+}
+}
+
+#endif
@@ -5,7 +5,10 @@
 #include "util/string_view.hpp"
 #include "util/typedefs.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -15,6 +18,10 @@ namespace util
 // While this could, theoretically, hold any names in the fitting format,
 // the NameTable allows access to a part of the Datafacade to allow
 // processing based on name indices.
+//
+// Strings that repeat an earlier string of the table can be stored as a reference to it, a NUL
+// byte followed by the index of the earlier string. The accessors resolve references, so the
+// returned views always point to the characters of the first occurrence.
 class NameTable
 {
   public:
@@ -39,7 +46,16 @@ class NameTable
     util::StringView GetRefForID(const NameID id) const;
     util::StringView GetPronunciationForID(const NameID id) const;
 
+    static constexpr std::size_t STRING_REFERENCE_SIZE = 1 + sizeof(std::uint32_t);
+
+    // Replaces the strings [offsets[i], offsets[i + 1]) of data that repeat an earlier string and
+    // are longer than a reference by a reference to the earlier string.
+    static void InternStrings(std::vector<std::uint32_t> &offsets,
+                              std::vector<unsigned char> &data);
+
   private:
+    util::StringView Resolve(const util::StringView string) const;
+
     using BufferType = std::unique_ptr<ValueType, std::function<void(void *)>>;
 
     BufferType m_buffer;
@@ -0,0 +1,59 @@
+#ifndef OSRM_UTIL_NUMA_HPP
+#define OSRM_UTIL_NUMA_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+namespace numa
+{
+
+struct Node
+{
+    unsigned id;
+    std::vector<unsigned> cpus; // empty if unknown, the node then spans all CPUs
+};
+
+// The online NUMA nodes of the system, a single node 0 if it has none or they are unknown
+std::vector<Node> getNodes();
+
+// The node the calling thread currently runs on, 0 if that is unknown
+unsigned getCurrentNode();
+
+// Restricts the calling thread to the CPUs of node, returns false if that failed
+bool pinThreadToNode(const Node &node);
+
+// Spreads the pages of a page aligned range over all nodes with memory, round robin, as they are
+// first touched. Returns false if the system has no NUMA support or a single node.
+bool interleaveMemory(void *address, const std::size_t size);
+
+// Allocates the pages of a page aligned range on node as they are first touched, by whichever
+// thread, falling back to other nodes if it runs out of memory. Returns false if the system has
+// no NUMA support or a single node.
+bool bindMemory(void *address, const std::size_t size, const unsigned node);
+
+// Spreads the pages the calling thread allocates over all nodes with memory while it exists,
+// inherited by the threads it starts meanwhile
+class ThreadInterleave
+{
+  public:
+    ThreadInterleave();
+    ~ThreadInterleave();
+
+    ThreadInterleave(const ThreadInterleave &) = delete;
+    ThreadInterleave &operator=(const ThreadInterleave &) = delete;
+
+    // false if the system has no NUMA support or a single node
+    bool IsActive() const { return active; }
+
+  private:
+    bool active;
+};
+}
+}
+}
+
+#endif
@@ -10,10 +10,14 @@
 
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/iterator/reverse_iterator.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <tbb/atomic.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -105,6 +109,8 @@ template <typename T, std::size_t Bits, storage::Ownership Ownership> class Pack
     // number of words per block
     static constexpr std::size_t BLOCK_WORDS = (Bits * BLOCK_ELEMENTS) / WORD_BITS;
 
+    static constexpr WordT VALUE_MASK = ~WordT{0} >> (WORD_BITS - Bits);
+
     // C++14 does not allow operator[] to be constexpr, this is fixed in C++17.
     static /* constexpr */ std::array<WordT, BLOCK_ELEMENTS> initialize_lower_mask()
     {
@@ -318,6 +324,42 @@ template <typename T, std::size_t Bits, storage::Ownership Ownership> class Pack
         friend class ::boost::iterator_core_access;
     };
 
+    // Decodes the block of an element when it first dereferences an element of it, scans over
+    // long ranges decode every block at once instead of every element on its own.
+    class unpacking_iterator : public boost::iterator_facade<unpacking_iterator,
+                                                             const T,
+                                                             boost::forward_traversal_tag,
+                                                             T>
+    {
+      public:
+        unpacking_iterator() : container(nullptr), index(0) {}
+        explicit unpacking_iterator(const PackedVector *container, const std::size_t index)
+            : container(container), index(index)
+        {
+        }
+
+      private:
+        void increment() { ++index; }
+        bool equal(const unpacking_iterator &other) const { return index == other.index; }
+        T dereference() const
+        {
+            const auto block = index / BLOCK_ELEMENTS;
+            if (block != decoded_block)
+            {
+                container->unpack_block(block * BLOCK_WORDS, decoded.data());
+                decoded_block = block;
+            }
+            return decoded[index % BLOCK_ELEMENTS];
+        }
+
+        const PackedVector *container;
+        std::size_t index;
+        mutable std::size_t decoded_block = std::numeric_limits<std::size_t>::max();
+        mutable std::array<T, BLOCK_ELEMENTS> decoded;
+
+        friend class ::boost::iterator_core_access;
+    };
+
     using iterator = iterator_impl<T, PackedVector>;
     using const_iterator = iterator_impl<const T, const PackedVector, T>;
     using reverse_iterator = boost::reverse_iterator<iterator>;
@@ -445,6 +487,69 @@ template <typename T, std::size_t Bits, storage::Ownership Ownership> class Pack
         vec.reserve(num_blocks * BLOCK_WORDS + 1);
     }
 
+    // Decodes the elements [first, last) to out, whole blocks are decoded at once.
+    template <typename OutputIter>
+    OutputIter unpack(std::size_t first, const std::size_t last, OutputIter out) const
+    {
+        BOOST_ASSERT(first <= last && last <= num_elements);
+
+        for (; first < last && first % BLOCK_ELEMENTS != 0; ++first)
+            *out++ = get_value(get_internal_index(first));
+
+        std::array<T, BLOCK_ELEMENTS> block;
+        for (; first + BLOCK_ELEMENTS <= last; first += BLOCK_ELEMENTS)
+        {
+            unpack_block(BLOCK_WORDS * (first / BLOCK_ELEMENTS), block.data());
+            out = std::copy(block.begin(), block.end(), out);
+        }
+
+        for (; first < last; ++first)
+            *out++ = get_value(get_internal_index(first));
+
+        return out;
+    }
+
+    // The elements [first, last) for one pass over them, see unpacking_iterator
+    auto unpacked(const std::size_t first, const std::size_t last) const
+    {
+        BOOST_ASSERT(first <= last && last <= num_elements);
+        return boost::make_iterator_range(unpacking_iterator(this, first),
+                                          unpacking_iterator(this, last));
+    }
+
+    // Encodes the values [begin, end) to the elements starting at first. Whole blocks are
+    // encoded at once and written without the CAS loop of set_value, parallel calls for
+    // disjoint elements are still allowed since blocks never share a word.
+    template <typename InputIter>
+    void pack(std::size_t first, InputIter begin, const InputIter end)
+    {
+        for (; begin != end && first % BLOCK_ELEMENTS != 0; ++begin, ++first)
+        {
+            BOOST_ASSERT(first < num_elements);
+            set_value(get_internal_index(first), *begin);
+        }
+
+        std::array<T, BLOCK_ELEMENTS> block;
+        while (begin != end)
+        {
+            std::size_t count = 0;
+            for (; begin != end && count < BLOCK_ELEMENTS; ++begin, ++count)
+                block[count] = *begin;
+
+            BOOST_ASSERT(first + count <= num_elements);
+            if (count == BLOCK_ELEMENTS)
+            {
+                pack_block(BLOCK_WORDS * (first / BLOCK_ELEMENTS), block.data());
+            }
+            else
+            {
+                for (const auto element : util::irange<std::size_t>(0, count))
+                    set_value(get_internal_index(first + element), block[element]);
+            }
+            first += count;
+        }
+    }
+
     friend void serialization::read<T, Bits, Ownership>(storage::io::FileReader &reader,
                                                         PackedVector &vec);
 
@@ -480,6 +585,51 @@ template <typename T, std::size_t Bits, storage::Ownership Ownership> class Pack
         }
     }
 
+    // Decodes the BLOCK_ELEMENTS elements of the block that starts at block_word
+    inline void unpack_block(const std::size_t block_word, T *out) const
+    {
+        const WordT *words = vec.data() + block_word;
+        unpack_elements(words, out, std::make_index_sequence<BLOCK_ELEMENTS>{});
+    }
+
+    // The words and shifts of every element are constants, the compiler decodes the block
+    // without branches and vectorizes it where the target allows
+    template <std::size_t... Elements>
+    static void unpack_elements(const WordT *words, T *out, std::index_sequence<Elements...>)
+    {
+        (void)std::initializer_list<int>{(out[Elements] = unpack_element<Elements>(words), 0)...};
+    }
+
+    template <std::size_t Element> static T unpack_element(const WordT *words)
+    {
+        constexpr auto word = Element * Bits / WORD_BITS;
+        constexpr auto offset = Element * Bits % WORD_BITS;
+        // the last element ends with the block, so the next word is only read within it
+        const auto upper =
+            offset + Bits > WORD_BITS ? words[word + 1] << ((WORD_BITS - offset) % WORD_BITS) : 0;
+        return get_lower_half_value<WordT, T>((words[word] >> offset) | upper, VALUE_MASK, 0);
+    }
+
+    inline void pack_block(const std::size_t block_word, const T *values)
+    {
+        std::array<WordT, BLOCK_WORDS> words{};
+        for (std::size_t element = 0; element < BLOCK_ELEMENTS; ++element)
+        {
+            BOOST_ASSERT_MSG(values[element] <= T{VALUE_MASK},
+                             "Value too big for packed storage.");
+            const auto value = static_cast<WordT>(values[element]);
+            const auto bit = element * Bits;
+            const auto word = bit / WORD_BITS;
+            const auto offset = bit % WORD_BITS;
+            words[word] |= value << offset;
+            if (offset + Bits > WORD_BITS)
+                words[word + 1] |= value >> (WORD_BITS - offset);
+        }
+
+        for (const auto word : util::irange<std::size_t>(0, BLOCK_WORDS))
+            vec[block_word + word] = words[word];
+    }
+
     inline T get_value(const InternalIndex internal_index) const
     {
         const auto lower_word = vec[internal_index.lower_word];
@@ -0,0 +1,78 @@
+#ifndef OSRM_UTIL_PERF_COUNTERS_HPP
+#define OSRM_UTIL_PERF_COUNTERS_HPP
+
+#include "util/json_container.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace osrm
+{
+namespace util
+{
+
+// Hardware events counted by PerfCounters, in user space only
+struct PerfCounterValues
+{
+    enum Event
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        LLC_MISSES,
+        DTLB_MISSES,
+        BRANCH_MISSES,
+        NUMBER_OF_EVENTS
+    };
+
+    std::array<std::uint64_t, NUMBER_OF_EVENTS> values{};
+
+    PerfCounterValues &operator+=(const PerfCounterValues &other)
+    {
+        for (std::size_t event = 0; event < NUMBER_OF_EVENTS; ++event)
+            values[event] += other.values[event];
+        return *this;
+    }
+
+    PerfCounterValues operator-(const PerfCounterValues &other) const
+    {
+        PerfCounterValues difference;
+        for (std::size_t event = 0; event < NUMBER_OF_EVENTS; ++event)
+            difference.values[event] = values[event] - other.values[event];
+        return difference;
+    }
+};
+
+// Counts the hardware events of the calling thread with perf_event_open. Events the kernel or
+// the CPU does not support, for example in virtual machines or with a perf_event_paranoid
+// above 2, are not counted. Outside of Linux no event is.
+//
+//   util::PerfCounters counters;
+//   const auto before = counters.Read();
+//   ...
+//   const auto region = counters.Read() - before;
+class PerfCounters
+{
+  public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool Available(const PerfCounterValues::Event event) const { return fds[event] >= 0; }
+    bool AnyAvailable() const;
+
+    // Scaled to the full time when the kernel had to multiplex the counters
+    PerfCounterValues Read() const;
+
+    // {"cycles": ..., "instructions": ..., "ipc": ..., ...} of the available events divided by
+    // `count`, for example per query
+    util::json::Object ToJSON(const PerfCounterValues &values, const double count = 1.) const;
+
+  private:
+    std::array<int, PerfCounterValues::NUMBER_OF_EVENTS> fds;
+};
+}
+}
+
+#endif
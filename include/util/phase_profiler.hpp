@@ -0,0 +1,108 @@
+#ifndef OSRM_UTIL_PHASE_PROFILER_HPP
+#define OSRM_UTIL_PHASE_PROFILER_HPP
+
+#include <boost/filesystem/path.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// The resources the process has used so far
+struct ResourceUsage
+{
+    std::chrono::steady_clock::time_point time;
+    // user and system time of all threads
+    double cpu_seconds;
+    // high-water mark of the resident set
+    std::uint64_t peak_rss_bytes;
+    // by read and write system calls, this includes reads served by the page cache but not
+    // accesses to memory mapped files. Zero where /proc/self/io is not available.
+    std::uint64_t bytes_read;
+    std::uint64_t bytes_written;
+};
+
+ResourceUsage GetResourceUsage();
+
+struct PhaseRecord
+{
+    std::string name;
+    // number of phases the phase is nested in
+    std::uint32_t depth;
+    double wall_seconds;
+    double cpu_seconds;
+    std::uint64_t peak_rss_bytes;
+    // how much the phase raised the high-water mark of the resident set
+    std::uint64_t peak_rss_delta_bytes;
+    std::uint64_t bytes_read;
+    std::uint64_t bytes_written;
+};
+
+// Collects the phases of the process in the order they started, so nested phases follow the
+// phase they are nested in. Phases are expected to be started and stopped by one thread.
+class PhaseProfiler
+{
+  public:
+    static PhaseProfiler &GetInstance();
+
+    std::size_t Begin(std::string name);
+    void End(const std::size_t phase, const ResourceUsage &begin, const ResourceUsage &end);
+
+    std::vector<PhaseRecord> GetPhases() const;
+
+    // {"tool": <tool>, "phases": [{"name": ..., "depth": ..., "wall_time": ..., ...}, ...]}
+    void Write(const boost::filesystem::path &path, const std::string &tool) const;
+
+  private:
+    PhaseProfiler() = default;
+
+    mutable std::mutex mutex;
+    std::vector<PhaseRecord> phases;
+    std::uint32_t depth = 0;
+};
+
+// Records the resources used from its construction until Stop is called or it goes out of scope.
+//
+//   util::ProfilePhase phase("parsing");
+//   ...
+//   phase.Stop();
+class ProfilePhase
+{
+  public:
+    explicit ProfilePhase(std::string name);
+    ~ProfilePhase();
+
+    ProfilePhase(const ProfilePhase &) = delete;
+    ProfilePhase &operator=(const ProfilePhase &) = delete;
+
+    void Stop();
+
+  private:
+    std::size_t phase;
+    ResourceUsage begin;
+    bool stopped = false;
+};
+
+// The run of a tool, it is recorded as a phase named after the tool and all phases are written
+// as JSON to `path` when it goes out of scope. Nothing is written if `path` is empty.
+class PhaseReport
+{
+  public:
+    PhaseReport(std::string tool, boost::filesystem::path path);
+    ~PhaseReport();
+
+  private:
+    std::string tool;
+    boost::filesystem::path path;
+    ProfilePhase run;
+};
+}
+}
+
+#endif
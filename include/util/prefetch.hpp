@@ -0,0 +1,39 @@
+#ifndef OSRM_UTIL_PREFETCH_HPP
+#define OSRM_UTIL_PREFETCH_HPP
+
+#include <cstddef>
+
+// Experimental software prefetching in the edge relaxation of the searches. Relaxing an edge
+// reads the heap index slot of its target and later the edge offsets of the target, both are
+// random accesses into arrays the size of the graph. With a distance of n > 0 the relaxation of
+// an edge prefetches them for the edge n positions further in the adjacency list. Set through
+// the PREFETCH_DISTANCE CMake option, 0 disables prefetching.
+#ifndef OSRM_PREFETCH_DISTANCE
+#define OSRM_PREFETCH_DISTANCE 0
+#endif
+
+namespace osrm
+{
+namespace util
+{
+
+static constexpr std::size_t PREFETCH_DISTANCE = OSRM_PREFETCH_DISTANCE;
+
+// Route assembly looks up the data of the nodes and turns of a path in passes over the path that
+// prefetch the data of the node this many positions ahead. Unlike in the searches the lookups
+// don't depend on each other, so their cache misses overlap.
+static constexpr std::size_t ASSEMBLY_PREFETCH_DISTANCE = 8;
+
+// Hint to load the cache line of address for reading, keeping it in all cache levels
+inline void prefetch(const void *address)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(address, 0, 3);
+#else
+    (void)address;
+#endif
+}
+}
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef OSRM_UTIL_PROJECT_POINT_ON_SEGMENTS_HPP
+#define OSRM_UTIL_PROJECT_POINT_ON_SEGMENTS_HPP
+
+#include "util/coordinate.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/double_lanes.hpp"
+#include "util/web_mercator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace osrm
+{
+namespace util
+{
+
+// Batched versions of web_mercator::latToYapprox and coordinate_calculation::projectPointOnSegment
+// on arrays of doubles, e.g. for all segments of a rtree leaf. On targets with double lanes a
+// whole vector of values is computed at once, the results are the same as the ones of the scalar
+// functions.
+namespace web_mercator
+{
+// Replaces every latitude by latToYapprox(latitude)
+inline void latToYapprox(double *const latitudes, const std::size_t size)
+{
+    std::size_t index = 0;
+
+#ifdef OSRM_HAS_DOUBLE_LANES
+    using util::detail::DoubleLanes;
+    for (; index + DoubleLanes::SIZE <= size; index += DoubleLanes::SIZE)
+    {
+        double original[DoubleLanes::SIZE];
+        std::copy(latitudes + index, latitudes + index + DoubleLanes::SIZE, original);
+
+        const auto x = util::detail::loadLanes(original);
+        util::detail::storeLanes(
+            latitudes + index,
+            util::detail::horner(x, detail::LAT_TO_Y_APPROX_NUMERATOR) /
+                util::detail::horner(x, detail::LAT_TO_Y_APPROX_DENOMINATOR));
+
+        // the approximation only holds away from the poles, they need the exact projection
+        for (std::size_t lane = 0; lane < DoubleLanes::SIZE; ++lane)
+        {
+            const auto latitude = FloatLatitude{original[lane]};
+            if (latitude < FloatLatitude{-detail::LAT_TO_Y_APPROX_MAX_LATITUDE} ||
+                latitude > FloatLatitude{detail::LAT_TO_Y_APPROX_MAX_LATITUDE})
+            {
+                latitudes[index + lane] = latToY(latitude);
+            }
+        }
+    }
+#endif
+
+    for (; index < size; ++index)
+    {
+        latitudes[index] = latToYapprox(FloatLatitude{latitudes[index]});
+    }
+}
+}
+
+namespace coordinate_calculation
+{
+// Writes the point of every segment source[i] -> target[i] closest to coordinate to nearest[i],
+// all coordinates are in the same projection.
+inline void projectPointOnSegments(const FloatCoordinate &coordinate,
+                                   const double *const source_lon,
+                                   const double *const source_lat,
+                                   const double *const target_lon,
+                                   const double *const target_lat,
+                                   const std::size_t size,
+                                   double *const nearest_lon,
+                                   double *const nearest_lat)
+{
+    std::size_t index = 0;
+
+#ifdef OSRM_HAS_DOUBLE_LANES
+    using namespace util::detail;
+    const auto coordinate_lon = broadcastLanes(static_cast<double>(coordinate.lon));
+    const auto coordinate_lat = broadcastLanes(static_cast<double>(coordinate.lat));
+    const auto epsilon = broadcastLanes(std::numeric_limits<double>::epsilon());
+    const auto zero = broadcastLanes(0.);
+    const auto one = broadcastLanes(1.);
+    for (; index + DoubleLanes::SIZE <= size; index += DoubleLanes::SIZE)
+    {
+        const auto from_lon = loadLanes(source_lon + index);
+        const auto from_lat = loadLanes(source_lat + index);
+        const auto to_lon = loadLanes(target_lon + index);
+        const auto to_lat = loadLanes(target_lat + index);
+
+        const auto slope_lon = to_lon - from_lon;
+        const auto slope_lat = to_lat - from_lat;
+        const auto rel_lon = coordinate_lon - from_lon;
+        const auto rel_lat = coordinate_lat - from_lat;
+        const auto unnormed_ratio = slope_lon * rel_lon + slope_lat * rel_lat;
+        const auto squared_length = slope_lon * slope_lon + slope_lat * slope_lat;
+
+        // degenerated segments are projected to their source, like a ratio of 0
+        const auto normed_ratio = unnormed_ratio / squared_length;
+        const auto clamped_ratio =
+            selectLess(squared_length,
+                       epsilon,
+                       zero,
+                       selectLess(one,
+                                  normed_ratio,
+                                  one,
+                                  selectLess(normed_ratio, zero, zero, normed_ratio)));
+
+        const auto source_ratio = one - clamped_ratio;
+        storeLanes(nearest_lon + index, source_ratio * from_lon + to_lon * clamped_ratio);
+        storeLanes(nearest_lat + index, source_ratio * from_lat + to_lat * clamped_ratio);
+    }
+#endif
+
+    for (; index < size; ++index)
+    {
+        const FloatCoordinate source{FloatLongitude{source_lon[index]},
+                                     FloatLatitude{source_lat[index]}};
+        const FloatCoordinate target{FloatLongitude{target_lon[index]},
+                                     FloatLatitude{target_lat[index]}};
+        const auto nearest = projectPointOnSegment(source, target, coordinate).second;
+        nearest_lon[index] = static_cast<double>(nearest.lon);
+        nearest_lat[index] = static_cast<double>(nearest.lat);
+    }
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef OSRM_UTIL_QUANTIZED_RECTANGLE_HPP
+#define OSRM_UTIL_QUANTIZED_RECTANGLE_HPP
+
+#include "util/rectangle.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <type_traits>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * A rectangle stored with BITS per coordinate inside of a frame rectangle, e.g. the box of a
+ * tree node inside the box of its parent.
+ *
+ * The frame is divided into 2^BITS - 1 steps per axis, minimums are rounded down and maximums
+ * up to the next step. The decoded rectangle always contains the encoded one. With 32 bits the
+ * rectangle is stored as is and the frame is ignored.
+ */
+template <std::uint32_t BITS> class QuantizedRectangle
+{
+    static_assert(BITS == 8 || BITS == 16 || BITS == 32, "BITS has to be 8, 16 or 32");
+
+    using Offset = typename std::conditional<
+        BITS == 8,
+        std::uint8_t,
+        typename std::conditional<BITS == 16, std::uint16_t, std::int32_t>::type>::type;
+    static constexpr std::int64_t STEPS = (std::int64_t{1} << BITS) - 1;
+
+  public:
+    QuantizedRectangle() = default;
+
+    QuantizedRectangle(const RectangleInt2D &frame, const RectangleInt2D &rectangle)
+        : min_lon(Encode<false>(static_cast<std::int32_t>(frame.min_lon),
+                                static_cast<std::int32_t>(frame.max_lon),
+                                static_cast<std::int32_t>(rectangle.min_lon))),
+          max_lon(Encode<true>(static_cast<std::int32_t>(frame.min_lon),
+                               static_cast<std::int32_t>(frame.max_lon),
+                               static_cast<std::int32_t>(rectangle.max_lon))),
+          min_lat(Encode<false>(static_cast<std::int32_t>(frame.min_lat),
+                                static_cast<std::int32_t>(frame.max_lat),
+                                static_cast<std::int32_t>(rectangle.min_lat))),
+          max_lat(Encode<true>(static_cast<std::int32_t>(frame.min_lat),
+                               static_cast<std::int32_t>(frame.max_lat),
+                               static_cast<std::int32_t>(rectangle.max_lat)))
+    {
+    }
+
+    RectangleInt2D Decode(const RectangleInt2D &frame) const
+    {
+        return RectangleInt2D{
+            FixedLongitude{Decode<false>(static_cast<std::int32_t>(frame.min_lon),
+                                         static_cast<std::int32_t>(frame.max_lon),
+                                         min_lon)},
+            FixedLongitude{Decode<true>(static_cast<std::int32_t>(frame.min_lon),
+                                        static_cast<std::int32_t>(frame.max_lon),
+                                        max_lon)},
+            FixedLatitude{Decode<false>(static_cast<std::int32_t>(frame.min_lat),
+                                        static_cast<std::int32_t>(frame.max_lat),
+                                        min_lat)},
+            FixedLatitude{Decode<true>(static_cast<std::int32_t>(frame.min_lat),
+                                       static_cast<std::int32_t>(frame.max_lat),
+                                       max_lat)}};
+    }
+
+  private:
+    template <bool ROUND_UP>
+    static Offset
+    Encode(const std::int32_t lower, const std::int32_t upper, const std::int32_t value)
+    {
+        if (BITS == 32)
+            return static_cast<Offset>(value);
+
+        BOOST_ASSERT(lower <= value && value <= upper);
+        const std::int64_t width = std::int64_t{upper} - lower;
+        if (width == 0)
+            return 0;
+
+        const std::int64_t scaled = (std::int64_t{value} - lower) * STEPS;
+        return static_cast<Offset>(ROUND_UP ? (scaled + width - 1) / width : scaled / width);
+    }
+
+    template <bool ROUND_UP>
+    static std::int32_t
+    Decode(const std::int32_t lower, const std::int32_t upper, const Offset step)
+    {
+        if (BITS == 32)
+            return static_cast<std::int32_t>(step);
+
+        const std::int64_t width = std::int64_t{upper} - lower;
+        const std::int64_t scaled = std::int64_t{step} * width;
+        const std::int64_t offset = ROUND_UP ? (scaled + STEPS - 1) / STEPS : scaled / STEPS;
+        return static_cast<std::int32_t>(lower + offset);
+    }
+
+    Offset min_lon;
+    Offset max_lon;
+    Offset min_lat;
+    Offset max_lat;
+};
+}
+}
+
+#endif
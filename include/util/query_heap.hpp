@@ -1,13 +1,20 @@
 #ifndef OSRM_UTIL_QUERY_HEAP_HPP
 #define OSRM_UTIL_QUERY_HEAP_HPP
 
+#include "util/msb.hpp"
+#include "util/prefetch.hpp"
+
 #include <boost/assert.hpp>
 #include <boost/heap/d_ary_heap.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <limits>
 #include <map>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -15,19 +22,29 @@ namespace osrm
 namespace util
 {
 
+// Index storages map a node to its position in the heap. Every thread keeps a few heaps around
+// for the life time of the process, so this is a trade-off between lookup speed and memory:
+//  - ArrayStorage is a plain array lookup that needs sizeof(Key) bytes per node of the graph and
+//    heap. QueryHeap::WasInserted() verifies the positions left behind by earlier queries, so
+//    clearing it is free.
+//  - GenerationArrayStorage additionally stores a generation per node, so peek_index() only
+//    returns positions of the current query. Clearing is O(1) except on generation overflow.
+//  - UnorderedMapStorage and MapStorage only need memory for the nodes a query touched, but
+//    every lookup is a hash lookup or tree search.
+// prefetch() hints that the node is looked up soon, only the array storages implement it.
 template <typename NodeID, typename Key> class GenerationArrayStorage
 {
     using GenerationCounter = std::uint16_t;
 
   public:
     explicit GenerationArrayStorage(std::size_t size)
-        : positions(size, 0), generation(1), generations(size, 0)
+        : generation(1), generations(size, 0), positions(size, 0)
     {
     }
 
     Key &operator[](NodeID node)
     {
-        generation[node] = generation;
+        generations[node] = generation;
         return positions[node];
     }
 
@@ -40,6 +57,12 @@ template <typename NodeID, typename Key> class GenerationArrayStorage
         return positions[node];
     }
 
+    void prefetch(const NodeID node) const
+    {
+        util::prefetch(&generations[node]);
+        util::prefetch(&positions[node]);
+    }
+
     void Clear()
     {
         generation++;
@@ -68,6 +91,8 @@ template <typename NodeID, typename Key> class ArrayStorage
 
     Key peek_index(const NodeID node) const { return positions[node]; }
 
+    void prefetch(const NodeID node) const { util::prefetch(&positions[node]); }
+
     void Clear() {}
 
   private:
@@ -83,6 +108,8 @@ template <typename NodeID, typename Key> class MapStorage
 
     void Clear() { nodes.clear(); }
 
+    void prefetch(const NodeID) const {}
+
     Key peek_index(const NodeID node) const
     {
         const auto iter = nodes.find(node);
@@ -120,42 +147,420 @@ template <typename NodeID, typename Key> class UnorderedMapStorage
         return iter->second;
     }
 
+    void prefetch(const NodeID) const {}
+
     void Clear() { nodes.clear(); }
 
   private:
     std::unordered_map<NodeID, Key> nodes;
 };
 
+// Heap containers order the entries of a QueryHeap by weight. QueryHeap numbers its entries in
+// insertion order, the containers are addressed by that dense index:
+//  - BoostHeapContainer is a mutable boost::heap::d_ary_heap. Its handles point to separately
+//    allocated nodes, so every decrease-key and sift chases pointers.
+//  - DAryHeapContainer is an implicit d-ary heap that keeps weights and indices next to each
+//    other in one array, the position of an entry is a lookup in a second dense array.
+//  - RadixHeapContainer buckets entries by the highest bit in which their weight differs from
+//    the last minimum, it needs integral weights and monotone queries: while the heap is not
+//    empty no entry may be inserted or decreased below the last minimum it returned. Dijkstra
+//    with non-negative edge weights guarantees that once all sources are inserted. Entries of the
+//    same weight come out in no particular order.
+template <typename Weight, typename Key> class BoostHeapContainer
+{
+  public:
+    void Clear()
+    {
+        heap.clear();
+        handles.clear();
+    }
+
+    void RemoveAll()
+    {
+        heap.clear();
+        std::fill(handles.begin(), handles.end(), HeapHandle{});
+    }
+
+    std::size_t Size() const { return heap.size(); }
+
+    void Push(const Key index, const Weight weight)
+    {
+        BOOST_ASSERT(static_cast<std::size_t>(index) == handles.size());
+        handles.push_back(heap.push(std::make_pair(weight, index)));
+    }
+
+    Key Min() const { return heap.top().second; }
+
+    Weight MinWeight() const { return heap.top().first; }
+
+    void Pop()
+    {
+        handles[heap.top().second] = HeapHandle{};
+        heap.pop();
+    }
+
+    void Decrease(const Key index, const Weight weight)
+    {
+        heap.increase(handles[index], std::make_pair(weight, index));
+    }
+
+    bool Removed(const Key index) const { return handles[index] == HeapHandle{}; }
+
+  private:
+    using HeapData = std::pair<Weight, Key>;
+    using HeapContainer = boost::heap::d_ary_heap<HeapData,
+                                                  boost::heap::arity<4>,
+                                                  boost::heap::mutable_<true>,
+                                                  boost::heap::compare<std::greater<HeapData>>>;
+    using HeapHandle = typename HeapContainer::handle_type;
+
+    HeapContainer heap;
+    std::vector<HeapHandle> handles;
+};
+
+template <typename Weight, typename Key, unsigned Arity = 4> class DAryHeapContainer
+{
+    static_assert(Arity >= 2, "a heap needs at least two children per node");
+
+  public:
+    void Clear()
+    {
+        heap.clear();
+        positions.clear();
+    }
+
+    void RemoveAll()
+    {
+        heap.clear();
+        std::fill(positions.begin(), positions.end(), REMOVED);
+    }
+
+    std::size_t Size() const { return heap.size(); }
+
+    void Push(const Key index, const Weight weight)
+    {
+        BOOST_ASSERT(static_cast<std::size_t>(index) == positions.size());
+        positions.push_back(static_cast<Key>(heap.size()));
+        heap.push_back(Entry{weight, index});
+        SiftUp(heap.size() - 1);
+    }
+
+    Key Min() const { return heap.front().index; }
+
+    Weight MinWeight() const { return heap.front().weight; }
+
+    void Pop()
+    {
+        positions[heap.front().index] = REMOVED;
+        if (heap.size() > 1)
+        {
+            heap.front() = heap.back();
+            positions[heap.front().index] = 0;
+            heap.pop_back();
+            SiftDown(0);
+        }
+        else
+        {
+            heap.pop_back();
+        }
+    }
+
+    void Decrease(const Key index, const Weight weight)
+    {
+        const std::size_t position = positions[index];
+        BOOST_ASSERT(!(heap[position].weight < weight));
+        heap[position].weight = weight;
+        SiftUp(position);
+    }
+
+    bool Removed(const Key index) const { return positions[index] == REMOVED; }
+
+  private:
+    static constexpr Key REMOVED = std::numeric_limits<Key>::max();
+
+    struct Entry
+    {
+        Weight weight;
+        Key index;
+    };
+
+    // same order as the pairs of BoostHeapContainer, ties are broken by insertion
+    static bool Less(const Entry &lhs, const Entry &rhs)
+    {
+        return lhs.weight < rhs.weight || (!(rhs.weight < lhs.weight) && lhs.index < rhs.index);
+    }
+
+    void SiftUp(std::size_t position)
+    {
+        const auto entry = heap[position];
+        while (position > 0)
+        {
+            const auto parent = (position - 1) / Arity;
+            if (!Less(entry, heap[parent]))
+            {
+                break;
+            }
+            Move(parent, position);
+            position = parent;
+        }
+        Place(entry, position);
+    }
+
+    void SiftDown(std::size_t position)
+    {
+        const auto entry = heap[position];
+        while (true)
+        {
+            const auto first_child = position * Arity + 1;
+            if (first_child >= heap.size())
+            {
+                break;
+            }
+            const auto last_child = std::min<std::size_t>(first_child + Arity, heap.size());
+            auto best_child = first_child;
+            for (auto child = first_child + 1; child < last_child; ++child)
+            {
+                if (Less(heap[child], heap[best_child]))
+                {
+                    best_child = child;
+                }
+            }
+            if (!Less(heap[best_child], entry))
+            {
+                break;
+            }
+            Move(best_child, position);
+            position = best_child;
+        }
+        Place(entry, position);
+    }
+
+    void Move(const std::size_t from, const std::size_t to)
+    {
+        heap[to] = heap[from];
+        positions[heap[to].index] = static_cast<Key>(to);
+    }
+
+    void Place(const Entry &entry, const std::size_t position)
+    {
+        heap[position] = entry;
+        positions[entry.index] = static_cast<Key>(position);
+    }
+
+    std::vector<Entry> heap;
+    std::vector<Key> positions;
+};
+
+template <typename Weight, typename Key, unsigned Arity>
+constexpr Key DAryHeapContainer<Weight, Key, Arity>::REMOVED;
+
+template <typename Weight, typename Key> class RadixHeapContainer
+{
+    static_assert(std::is_integral<Weight>::value, "radix heaps need integral weights");
+    using Bits = typename std::make_unsigned<Weight>::type;
+    static constexpr std::size_t NUM_BITS = std::numeric_limits<Bits>::digits;
+
+  public:
+    void Clear()
+    {
+        states.clear();
+        Reset();
+    }
+
+    void RemoveAll()
+    {
+        for (auto &state : states)
+        {
+            state.removed = true;
+        }
+        Reset();
+    }
+
+    std::size_t Size() const { return live_entries; }
+
+    void Push(const Key index, const Weight weight)
+    {
+        BOOST_ASSERT(static_cast<std::size_t>(index) == states.size());
+        states.push_back(State{weight, false});
+        Bucket(weight).push_back(Entry{weight, index});
+        ++live_entries;
+    }
+
+    Key Min() const
+    {
+        Normalize();
+        return buckets[0].back().index;
+    }
+
+    Weight MinWeight() const
+    {
+        Normalize();
+        return buckets[0].back().weight;
+    }
+
+    void Pop()
+    {
+        Normalize();
+        states[buckets[0].back().index].removed = true;
+        buckets[0].pop_back();
+        if (--live_entries == 0)
+        {
+            // only stale entries are left, an empty heap accepts any weight again
+            Reset();
+        }
+    }
+
+    // The old entry stays in its bucket and is skipped once it comes up
+    void Decrease(const Key index, const Weight weight)
+    {
+        BOOST_ASSERT(!states[index].removed && !(states[index].weight < weight));
+        states[index].weight = weight;
+        Bucket(weight).push_back(Entry{weight, index});
+    }
+
+    bool Removed(const Key index) const { return states[index].removed; }
+
+  private:
+    struct Entry
+    {
+        Weight weight;
+        Key index;
+    };
+
+    struct State
+    {
+        Weight weight;
+        bool removed;
+    };
+
+    // Order preserving mapping onto unsigned integers, flips the sign bit of signed weights
+    static Bits ToBits(const Weight weight)
+    {
+        const Bits sign_bit = std::is_signed<Weight>::value ? Bits{1} << (NUM_BITS - 1) : 0;
+        return static_cast<Bits>(weight) ^ sign_bit;
+    }
+
+    std::vector<Entry> &Bucket(const Weight weight) const
+    {
+        const auto bits = ToBits(weight);
+        BOOST_ASSERT_MSG(bits >= last_minimum, "radix heaps only support monotone queries");
+        return buckets[bits == last_minimum ? 0 : msb(bits ^ last_minimum) + 1];
+    }
+
+    void Reset()
+    {
+        for (auto &bucket : buckets)
+        {
+            bucket.clear();
+        }
+        live_entries = 0;
+        last_minimum = 0;
+    }
+
+    bool IsStale(const Entry &entry) const
+    {
+        const auto &state = states[entry.index];
+        return state.removed || state.weight != entry.weight;
+    }
+
+    // Moves the minimum into bucket 0 if it is not there yet. Logically const, but it advances
+    // the minimum and redistributes the bucket it came from.
+    void Normalize() const
+    {
+        BOOST_ASSERT(live_entries > 0);
+        auto &first = buckets[0];
+        while (!first.empty() && IsStale(first.back()))
+        {
+            first.pop_back();
+        }
+        if (!first.empty())
+        {
+            return;
+        }
+
+        for (std::size_t bucket_index = 1; bucket_index < buckets.size(); ++bucket_index)
+        {
+            auto &bucket = buckets[bucket_index];
+            bucket.erase(std::remove_if(bucket.begin(),
+                                        bucket.end(),
+                                        [this](const Entry &entry) { return IsStale(entry); }),
+                         bucket.end());
+            if (bucket.empty())
+            {
+                continue;
+            }
+
+            const auto minimum = std::min_element(
+                bucket.begin(), bucket.end(), [](const Entry &lhs, const Entry &rhs) {
+                    return lhs.weight < rhs.weight;
+                });
+            last_minimum = ToBits(minimum->weight);
+
+            // every entry lands in a lower bucket, at least the minimum in bucket 0
+            std::vector<Entry> redistributed;
+            redistributed.swap(bucket);
+            for (const auto &entry : redistributed)
+            {
+                Bucket(entry.weight).push_back(entry);
+            }
+            // hand the memory back so the bucket does not need to grow again
+            redistributed.clear();
+            bucket.swap(redistributed);
+            return;
+        }
+        BOOST_ASSERT_MSG(false, "live entries have to be in a bucket");
+    }
+
+    mutable std::array<std::vector<Entry>, NUM_BITS + 1> buckets;
+    mutable Bits last_minimum = 0;
+    std::vector<State> states;
+    std::size_t live_entries = 0;
+};
+
 template <typename NodeID,
           typename Key,
           typename Weight,
           typename Data,
-          typename IndexStorage = ArrayStorage<NodeID, NodeID>>
+          typename IndexStorage = ArrayStorage<NodeID, NodeID>,
+          typename HeapContainer = BoostHeapContainer<Weight, Key>>
 class QueryHeap
 {
   public:
     using WeightType = Weight;
     using DataType = Data;
 
-    explicit QueryHeap(std::size_t maxID) : node_index(maxID) { Clear(); }
+    // Operations since the statistics were taken last, clearing the heap keeps them
+    struct Statistics
+    {
+        // nodes removed by DeleteMin
+        std::uint64_t settled_nodes = 0;
+        // inserted nodes and decreased keys, the edges that improved a tentative weight
+        std::uint64_t relaxed_edges = 0;
+    };
+
+    explicit QueryHeap(std::size_t maxID) : max_id(maxID), node_index(maxID) { Clear(); }
+
+    // Node ids have to be smaller than this, array storages are sized by it
+    std::size_t MaxID() const { return max_id; }
 
     void Clear()
     {
-        heap.clear();
+        heap.Clear();
         inserted_nodes.clear();
         node_index.Clear();
     }
 
-    std::size_t Size() const { return heap.size(); }
+    std::size_t Size() const { return heap.Size(); }
 
     bool Empty() const { return 0 == Size(); }
 
     void Insert(NodeID node, Weight weight, const Data &data)
     {
         const auto index = static_cast<Key>(inserted_nodes.size());
-        const auto handle = heap.push(std::make_pair(weight, index));
-        inserted_nodes.emplace_back(HeapNode{handle, node, weight, data});
+        inserted_nodes.emplace_back(HeapNode{node, weight, data});
+        heap.Push(index, weight);
         node_index[node] = index;
+        ++statistics.relaxed_edges;
     }
 
     Data &GetData(NodeID node)
@@ -180,7 +585,7 @@ class QueryHeap
     {
         BOOST_ASSERT(WasInserted(node));
         const Key index = node_index.peek_index(node);
-        return inserted_nodes[index].handle == HeapHandle{};
+        return heap.Removed(index);
     }
 
     bool WasInserted(const NodeID node) const
@@ -193,63 +598,61 @@ class QueryHeap
         return inserted_nodes[index].node == node;
     }
 
+    // The node is probably looked up soon, see util/prefetch.hpp
+    void Prefetch(const NodeID node) const { node_index.prefetch(node); }
+
     NodeID Min() const
     {
-        BOOST_ASSERT(!heap.empty());
-        return inserted_nodes[heap.top().second].node;
+        BOOST_ASSERT(!Empty());
+        return inserted_nodes[heap.Min()].node;
     }
 
     Weight MinKey() const
     {
-        BOOST_ASSERT(!heap.empty());
-        return heap.top().first;
+        BOOST_ASSERT(!Empty());
+        return heap.MinWeight();
     }
 
     NodeID DeleteMin()
     {
-        BOOST_ASSERT(!heap.empty());
-        const Key removedIndex = heap.top().second;
-        heap.pop();
-        inserted_nodes[removedIndex].handle = HeapHandle{};
+        BOOST_ASSERT(!Empty());
+        const Key removedIndex = heap.Min();
+        heap.Pop();
+        ++statistics.settled_nodes;
         return inserted_nodes[removedIndex].node;
     }
 
-    void DeleteAll()
-    {
-        std::for_each(inserted_nodes.begin(), inserted_nodes.end(), [](auto &node) {
-            node.handle = HeapHandle();
-        });
-        heap.clear();
-    }
+    void DeleteAll() { heap.RemoveAll(); }
 
     void DecreaseKey(NodeID node, Weight weight)
     {
         BOOST_ASSERT(!WasRemoved(node));
         const auto index = node_index.peek_index(node);
-        auto &reference = inserted_nodes[index];
-        reference.weight = weight;
-        heap.increase(reference.handle, std::make_pair(weight, index));
+        inserted_nodes[index].weight = weight;
+        heap.Decrease(index, weight);
+        ++statistics.relaxed_edges;
     }
 
-  private:
-    using HeapData = std::pair<Weight, Key>;
-    using HeapContainer = boost::heap::d_ary_heap<HeapData,
-                                                  boost::heap::arity<4>,
-                                                  boost::heap::mutable_<true>,
-                                                  boost::heap::compare<std::greater<HeapData>>>;
-    using HeapHandle = typename HeapContainer::handle_type;
+    Statistics TakeStatistics()
+    {
+        const auto taken = statistics;
+        statistics = Statistics{};
+        return taken;
+    }
 
+  private:
     struct HeapNode
     {
-        HeapHandle handle;
         NodeID node;
         Weight weight;
         Data data;
     };
 
+    std::size_t max_id;
     std::vector<HeapNode> inserted_nodes;
     HeapContainer heap;
     IndexStorage node_index;
+    Statistics statistics;
 };
 }
 }
@@ -0,0 +1,59 @@
+#ifndef OSRM_UTIL_SEARCH_EDGE_HPP
+#define OSRM_UTIL_SEARCH_EDGE_HPP
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/typedefs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace osrm
+{
+namespace util
+{
+
+// the weights have as many bits as the durations of the edge data
+const constexpr EdgeWeight MAX_SEARCH_EDGE_WEIGHT = (1 << 29) - 1;
+
+// The part of an edge of a query graph that a search relaxes. The data facades keep these in an
+// array of their own next to the edge array of the graph, so the searches stream 8 bytes per
+// edge instead of the whole entry. Durations, distances and turn ids stay in the edge array and
+// are only read for the edges of a result.
+struct SearchEdge
+{
+    SearchEdge() : target(SPECIAL_NODEID), weight(0), forward(false), backward(false) {}
+
+    template <typename EdgeArrayEntryT>
+    explicit SearchEdge(const EdgeArrayEntryT &edge)
+        : target(edge.target), weight(edge.data.weight), forward(edge.data.forward),
+          backward(edge.data.backward)
+    {
+    }
+
+    NodeID target;
+    EdgeWeight weight : 30;
+    std::uint32_t forward : 1;
+    std::uint32_t backward : 1;
+};
+
+static_assert(sizeof(SearchEdge) == 8, "SearchEdge is not packed");
+
+// Fills the search edges of the edge array, throws if a weight doesn't fit
+template <typename EdgeIter, typename SearchEdgeIter>
+void fillSearchEdges(EdgeIter edges_begin, EdgeIter edges_end, SearchEdgeIter search_edges)
+{
+    std::transform(edges_begin, edges_end, search_edges, [](const auto &edge) {
+        if (edge.data.weight > MAX_SEARCH_EDGE_WEIGHT)
+        {
+            throw util::exception("Edge weight " + std::to_string(edge.data.weight) +
+                                  " is too large for the search edges" + SOURCE_REF);
+        }
+        return SearchEdge(edge);
+    });
+}
+}
+}
+
+#endif
@@ -62,29 +62,23 @@ inline void write(storage::io::FileWriter &writer, const StaticGraph<EdgeDataT,
     storage::serialization::write(writer, graph.edge_array);
 }
 
+// The edge list is stored with its dummies, so the graph can take new edges where it left off
 template <typename EdgeDataT>
 inline void read(storage::io::FileReader &reader, DynamicGraph<EdgeDataT> &graph)
 {
+    graph.number_of_nodes = reader.ReadElementCount64();
     storage::serialization::read(reader, graph.node_array);
-    const auto num_edges = reader.ReadElementCount64();
-    graph.edge_list.resize(num_edges);
-    for (auto index : irange<std::size_t>(0, num_edges))
-    {
-        reader.ReadOne(graph.edge_list[index]);
-    }
-    graph.number_of_nodes = graph.node_array.size();
-    graph.number_of_edges = num_edges;
+    graph.number_of_edges = reader.ReadElementCount64();
+    storage::serialization::read(reader, graph.edge_list);
 }
 
 template <typename EdgeDataT>
 inline void write(storage::io::FileWriter &writer, const DynamicGraph<EdgeDataT> &graph)
 {
+    writer.WriteElementCount64(graph.number_of_nodes);
     storage::serialization::write(writer, graph.node_array);
     writer.WriteElementCount64(graph.number_of_edges);
-    for (auto index : irange<std::size_t>(0, graph.number_of_edges))
-    {
-        writer.WriteOne(graph.edge_list[index]);
-    }
+    storage::serialization::write(writer, graph.edge_list);
 }
 }
 }
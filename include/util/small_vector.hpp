@@ -0,0 +1,31 @@
+#ifndef OSRM_SMALL_VECTOR_HPP
+#define OSRM_SMALL_VECTOR_HPP
+
+#include <boost/version.hpp>
+
+#include <cstddef>
+
+// boost::container::small_vector is only available from Boost 1.58 on
+#if BOOST_VERSION >= 105800
+#include <boost/container/small_vector.hpp>
+#else
+#include <vector>
+#endif
+
+namespace osrm
+{
+namespace util
+{
+// Convenience typedef: a vector that keeps up to InlineCapacity elements without allocating,
+// falls back to std::vector for older Boost versions
+#if BOOST_VERSION >= 105800
+template <typename T, std::size_t InlineCapacity>
+using SmallVector = boost::container::small_vector<T, InlineCapacity>;
+#else
+template <typename T, std::size_t InlineCapacity> using SmallVector = std::vector<T>;
+#endif
+
+} // namespace util
+} // namespace osrm
+
+#endif /* OSRM_SMALL_VECTOR_HPP */
@@ -5,6 +5,7 @@
 #include "util/integer_range.hpp"
 #include "util/percent.hpp"
 #include "util/permutation.hpp"
+#include "util/prefetch.hpp"
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
 
@@ -175,6 +176,9 @@ class StaticGraph
         return EdgeIterator(node_array.at(n + 1).first_edge);
     }
 
+    // The edges of the node are probably looked up soon, see util/prefetch.hpp
+    void PrefetchNode(const NodeIterator n) const { util::prefetch(&node_array[n]); }
+
     // searches for a specific edge
     EdgeIterator FindEdge(const NodeIterator from, const NodeIterator to) const
     {
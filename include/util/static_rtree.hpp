@@ -6,9 +6,12 @@
 #include "util/coordinate_calculation.hpp"
 #include "util/deallocating_vector.hpp"
 #include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/hilbert_value.hpp"
 #include "util/integer_range.hpp"
 #include "util/mmap_file.hpp"
+#include "util/project_point_on_segments.hpp"
+#include "util/quantized_rectangle.hpp"
 #include "util/rectangle.hpp"
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
@@ -29,9 +32,12 @@
 #include <algorithm>
 #include <array>
 #include <limits>
+#include <numeric>
 #include <memory>
 #include <queue>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // An extended alignment is implementation-defined, so use compiler attributes
@@ -44,21 +50,44 @@
 #define ALIGNED(x)
 #endif
 
+// Bits per coordinate of the boxes in the tree nodes, see the RTREE_NODE_BOX_BITS CMake option
+#ifndef OSRM_RTREE_NODE_BOX_BITS
+#define OSRM_RTREE_NODE_BOX_BITS 32
+#endif
+
 namespace osrm
 {
 namespace util
 {
 
+namespace detail
+{
+// Leaf records with the members projected_u and projected_v carry the coordinates of u and v
+// projected to web mercator
+template <typename EdgeDataT, typename = void> struct HasProjectedCoordinates : std::false_type
+{
+};
+
+template <typename EdgeDataT>
+struct HasProjectedCoordinates<EdgeDataT, decltype(void(std::declval<EdgeDataT>().projected_u))>
+    : std::true_type
+{
+};
+}
+
 /***
  * Static RTree for serving nearest neighbour queries
  * // All coordinates are pojected first to Web Mercator before the bounding boxes
  * // are computed, this means the internal distance metric doesn not represent meters!
+ * // With NODE_BOX_BITS of 8 or 16 the box of a tree node is stored quantized inside the
+ * // box of its parent node, see QuantizedRectangle.
  */
 
 template <class EdgeDataT,
           storage::Ownership Ownership = storage::Ownership::Container,
           std::uint32_t BRANCHING_FACTOR = 64,
-          std::uint32_t LEAF_PAGE_SIZE = 4096>
+          std::uint32_t LEAF_PAGE_SIZE = 4096,
+          std::uint32_t NODE_BOX_BITS = OSRM_RTREE_NODE_BOX_BITS>
 class StaticRTree
 {
     /**********************************************************
@@ -169,10 +198,26 @@ class StaticRTree
      */
     struct TreeNode
     {
-        Rectangle minimum_bounding_rectangle;
+        // relative to the decoded box of the parent node, the root is relative to WorldBox()
+        QuantizedRectangle<NODE_BOX_BITS> minimum_bounding_rectangle;
     };
 
   private:
+    using InlineCoordinates = detail::HasProjectedCoordinates<EdgeDataT>;
+
+    // Traversals keep the decoded boxes of the inner nodes they still have to explore, their
+    // children are stored relative to them. Boxes stored as is don't need to be kept.
+    static constexpr bool RELATIVE_NODE_BOXES = NODE_BOX_BITS < 32;
+
+    // All projected coordinates are inside of this box
+    static Rectangle WorldBox()
+    {
+        return Rectangle{FloatLongitude{-180.},
+                         FloatLongitude{180.},
+                         FloatLatitude{-180.},
+                         FloatLatitude{180.}};
+    }
+
     /**
      * A lightweight wrapper for the Hilbert Code for each EdgeDataT object
      * A vector of these is used to sort the EdgeDataT input onto the
@@ -202,9 +247,11 @@ class StaticRTree
 
     struct QueryCandidate
     {
-        QueryCandidate(std::uint64_t squared_min_dist, TreeIndex tree_index)
+        QueryCandidate(std::uint64_t squared_min_dist,
+                       TreeIndex tree_index,
+                       std::uint32_t box_index = 0)
             : squared_min_dist(squared_min_dist), tree_index(tree_index),
-              segment_index(std::numeric_limits<std::uint32_t>::max())
+              segment_index(std::numeric_limits<std::uint32_t>::max()), box_index(box_index)
         {
         }
 
@@ -213,7 +260,7 @@ class StaticRTree
                        std::uint32_t segment_index,
                        const Coordinate &coordinate)
             : squared_min_dist(squared_min_dist), tree_index(tree_index),
-              fixed_projected_coordinate(coordinate), segment_index(segment_index)
+              fixed_projected_coordinate(coordinate), segment_index(segment_index), box_index(0)
         {
         }
 
@@ -233,6 +280,70 @@ class StaticRTree
         TreeIndex tree_index;
         Coordinate fixed_projected_coordinate;
         std::uint32_t segment_index;
+        // decoded box of an inner node in the queue, see CandidateQueue::GetBox
+        std::uint32_t box_index;
+    };
+
+    /**
+     * The priority queue of a nearest neighbour query on top of storage that outlives the query.
+     * Every thread keeps one, so consecutive queries, e.g. for all coordinates of a table, reuse
+     * its memory instead of growing a new queue from scratch. Next to the candidates it holds the
+     * decoded boxes of the inner nodes in the queue.
+     */
+    class CandidateQueue
+    {
+      public:
+        // a query that pushed more candidates frees them instead of keeping them for the next one
+        static constexpr std::size_t MAX_KEPT_CAPACITY = 1 << 16;
+
+        CandidateQueue(std::vector<QueryCandidate> &storage_, std::vector<Rectangle> &boxes_)
+            : storage(storage_), boxes(boxes_)
+        {
+            storage.clear();
+            boxes.clear();
+        }
+
+        ~CandidateQueue()
+        {
+            if (storage.capacity() > MAX_KEPT_CAPACITY)
+            {
+                std::vector<QueryCandidate>().swap(storage);
+            }
+            if (boxes.capacity() > MAX_KEPT_CAPACITY)
+            {
+                std::vector<Rectangle>().swap(boxes);
+            }
+        }
+
+        bool empty() const { return storage.empty(); }
+
+        // same order as std::priority_queue, the closest candidate is on top
+        const QueryCandidate &top() const { return storage.front(); }
+
+        void push(QueryCandidate candidate)
+        {
+            storage.push_back(std::move(candidate));
+            std::push_heap(storage.begin(), storage.end());
+        }
+
+        void pop()
+        {
+            std::pop_heap(storage.begin(), storage.end());
+            storage.pop_back();
+        }
+
+        // boxes stay until the end of the query, an index is valid for the whole query
+        std::uint32_t AddBox(const Rectangle &box)
+        {
+            boxes.push_back(box);
+            return static_cast<std::uint32_t>(boxes.size() - 1);
+        }
+
+        const Rectangle &GetBox(const std::uint32_t box_index) const { return boxes[box_index]; }
+
+      private:
+        std::vector<QueryCandidate> &storage;
+        std::vector<Rectangle> &boxes;
     };
 
     // We use a const view type when we don't own the data, otherwise
@@ -302,6 +413,10 @@ class StaticRTree
 
         // sort the hilbert-value representatives
         tbb::parallel_sort(input_wrapper_vector.begin(), input_wrapper_vector.end());
+
+        // The exact boxes of the tree nodes, they are encoded into m_search_tree once the tree
+        // has its final order
+        std::vector<Rectangle> node_boxes;
         {
             storage::io::FileWriter leaf_node_file(leaf_node_filename,
                                                    storage::io::FileWriter::HasNoFingerprint);
@@ -316,7 +431,7 @@ class StaticRTree
             std::size_t wrapped_element_index = 0;
             while (wrapped_element_index < element_count)
             {
-                TreeNode current_node;
+                Rectangle current_box;
 
                 std::array<EdgeDataT, LEAF_NODE_SIZE> objects;
                 std::uint32_t object_count = 0;
@@ -339,6 +454,8 @@ class StaticRTree
                         web_mercator::fromWGS84(Coordinate{m_coordinate_list[object.u]})};
                     Coordinate projected_v{
                         web_mercator::fromWGS84(Coordinate{m_coordinate_list[object.v]})};
+                    SetLeafCoordinates(
+                        objects[object_index], projected_u, projected_v, InlineCoordinates{});
 
                     BOOST_ASSERT(std::abs(toFloating(projected_u.lon).operator double()) <= 180.);
                     BOOST_ASSERT(std::abs(toFloating(projected_u.lat).operator double()) <= 180.);
@@ -357,13 +474,13 @@ class StaticRTree
                         std::max(rectangle.max_lat, std::max(projected_u.lat, projected_v.lat));
 
                     BOOST_ASSERT(rectangle.IsValid());
-                    current_node.minimum_bounding_rectangle.MergeBoundingBoxes(rectangle);
+                    current_box.MergeBoundingBoxes(rectangle);
                 }
 
                 // Write out our EdgeDataT block to the leaf node file
                 leaf_node_file.WriteFrom(objects.data(), object_count);
 
-                m_search_tree.emplace_back(current_node);
+                node_boxes.emplace_back(current_box);
             }
 
             // leaf_node_file wil be RAII closed at this point
@@ -371,14 +488,14 @@ class StaticRTree
 
         // Should hold the number of nodes at the lowest level of the graph (closest
         // to the data)
-        std::uint32_t nodes_in_previous_level = m_search_tree.size();
+        std::uint32_t nodes_in_previous_level = node_boxes.size();
         m_tree_level_sizes.push_back(nodes_in_previous_level);
 
         // Now, repeatedly create levels of nodes that contain BRANCHING_FACTOR
         // nodes from the previous level.
         while (nodes_in_previous_level > 1)
         {
-            auto previous_level_start_pos = m_search_tree.size() - nodes_in_previous_level;
+            auto previous_level_start_pos = node_boxes.size() - nodes_in_previous_level;
 
             // We can calculate how many nodes will be in this level, we divide by
             // BRANCHING_FACTOR
@@ -388,7 +505,7 @@ class StaticRTree
 
             for (auto current_node_idx : irange<std::size_t>(0, nodes_in_current_level))
             {
-                TreeNode parent_node;
+                Rectangle parent_box;
                 auto first_child_index =
                     current_node_idx * BRANCHING_FACTOR + previous_level_start_pos;
                 auto last_child_index =
@@ -401,10 +518,9 @@ class StaticRTree
                 // level, then save that box as a new TreeNode in the new level.
                 for (auto child_node_idx : irange<std::size_t>(first_child_index, last_child_index))
                 {
-                    parent_node.minimum_bounding_rectangle.MergeBoundingBoxes(
-                        m_search_tree[child_node_idx].minimum_bounding_rectangle);
+                    parent_box.MergeBoundingBoxes(node_boxes[child_node_idx]);
                 }
-                m_search_tree.emplace_back(parent_node);
+                node_boxes.emplace_back(parent_box);
             }
             nodes_in_previous_level = nodes_in_current_level;
             m_tree_level_sizes.push_back(nodes_in_previous_level);
@@ -415,7 +531,7 @@ class StaticRTree
 
         // Flip the tree so that the root node is at 0.
         // This just makes our math during search a bit more intuitive
-        std::reverse(m_search_tree.begin(), m_search_tree.end());
+        std::reverse(node_boxes.begin(), node_boxes.end());
 
         // Same for the level sizes - root node / base level is at 0
         std::reverse(m_tree_level_sizes.begin(), m_tree_level_sizes.end());
@@ -439,8 +555,27 @@ class StaticRTree
         // searches
         for (auto i : irange<std::size_t>(0, m_tree_level_sizes.size()))
         {
-            std::reverse(m_search_tree.begin() + m_tree_level_starts[i],
-                         m_search_tree.begin() + m_tree_level_starts[i] + m_tree_level_sizes[i]);
+            std::reverse(node_boxes.begin() + m_tree_level_starts[i],
+                         node_boxes.begin() + m_tree_level_starts[i] + m_tree_level_sizes[i]);
+        }
+
+        // Encode the boxes level by level, every box relative to the decoded box of its parent.
+        // The decoded boxes contain the exact ones, so do the decoded boxes of all children.
+        std::vector<Rectangle> decoded_boxes(node_boxes.size());
+        m_search_tree.resize(node_boxes.size());
+        for (auto level : irange<std::size_t>(0, m_tree_level_sizes.size()))
+        {
+            for (auto offset : irange<std::size_t>(0, m_tree_level_sizes[level]))
+            {
+                const auto index = m_tree_level_starts[level] + offset;
+                const auto frame =
+                    level == 0 ? WorldBox()
+                               : decoded_boxes[m_tree_level_starts[level - 1] +
+                                               offset / BRANCHING_FACTOR];
+                const QuantizedRectangle<NODE_BOX_BITS> box{frame, node_boxes[index]};
+                m_search_tree[index].minimum_bounding_rectangle = box;
+                decoded_boxes[index] = box.Decode(frame);
+            }
         }
 
         // Write all the TreeNode data to disk
@@ -480,6 +615,7 @@ class StaticRTree
         const auto levels_array_size = tree_node_file.ReadElementCount64();
         m_tree_level_sizes.resize(levels_array_size);
         tree_node_file.ReadInto(m_tree_level_sizes);
+        CheckLevelSizes();
 
         // The first level always starts at 0
         m_tree_level_starts = {0};
@@ -506,6 +642,8 @@ class StaticRTree
         : m_search_tree(tree_node_ptr, number_of_nodes), m_coordinate_list(coordinate_list),
           m_tree_level_sizes(level_sizes_ptr, level_sizes_ptr + number_of_levels)
     {
+        CheckLevelSizes();
+
         // The first level starts at 0
         m_tree_level_starts = {0};
         // The remaining levels start at the partial sum of the preceeding level sizes
@@ -528,12 +666,15 @@ class StaticRTree
                 web_mercator::latToY(toFloating(FixedLatitude(search_rectangle.max_lat)))})};
         std::vector<EdgeDataT> results;
 
-        std::queue<TreeIndex> traversal_queue;
-        traversal_queue.push(TreeIndex{});
+        // the tree nodes to explore with their decoded boxes
+        std::queue<std::pair<TreeIndex, Rectangle>> traversal_queue;
+        traversal_queue.emplace(TreeIndex{},
+                                m_search_tree[0].minimum_bounding_rectangle.Decode(WorldBox()));
 
         while (!traversal_queue.empty())
         {
-            auto const current_tree_index = traversal_queue.front();
+            auto const current_tree_index = traversal_queue.front().first;
+            auto const current_box = traversal_queue.front().second;
             traversal_queue.pop();
 
             // If we're at the bottom of the tree, we need to explore the
@@ -571,14 +712,16 @@ class StaticRTree
 
                 for (const auto child_index : child_indexes(current_tree_index))
                 {
-                    const auto &child_rectangle =
-                        m_search_tree[child_index].minimum_bounding_rectangle;
+                    const auto child_rectangle =
+                        m_search_tree[child_index].minimum_bounding_rectangle.Decode(current_box);
 
                     if (child_rectangle.Intersects(projected_rectangle))
                     {
-                        traversal_queue.push(TreeIndex(
-                            current_tree_index.level + 1,
-                            child_index - m_tree_level_starts[current_tree_index.level + 1]));
+                        traversal_queue.emplace(
+                            TreeIndex(current_tree_index.level + 1,
+                                      child_index -
+                                          m_tree_level_starts[current_tree_index.level + 1]),
+                            child_rectangle);
                     }
                 }
             }
@@ -602,13 +745,37 @@ class StaticRTree
     std::vector<EdgeDataT> Nearest(const Coordinate input_coordinate,
                                    const FilterT filter,
                                    const TerminationT terminate) const
+    {
+        return Nearest(input_coordinate,
+                       std::numeric_limits<double>::infinity(),
+                       [](const EdgeDataT &) { return true; },
+                       filter,
+                       terminate);
+    }
+
+    // Like above, but the traversal does not queue what can't be a result: subtrees and segments
+    // that are farther than max_distance meters away, and segments rejected by accept_segment.
+    // The filter and terminator are only called for the remaining segments.
+    template <typename AcceptT, typename FilterT, typename TerminationT>
+    std::vector<EdgeDataT> Nearest(const Coordinate input_coordinate,
+                                   const double max_distance,
+                                   const AcceptT accept_segment,
+                                   const FilterT filter,
+                                   const TerminationT terminate) const
     {
         std::vector<EdgeDataT> results;
         auto projected_coordinate = web_mercator::fromWGS84(input_coordinate);
         Coordinate fixed_projected_coordinate{projected_coordinate};
-        // initialize queue with root element
-        std::priority_queue<QueryCandidate> traversal_queue;
-        traversal_queue.push(QueryCandidate{0, TreeIndex{}});
+        const auto max_squared_distance =
+            MaxSquaredProjectedDistance(input_coordinate, max_distance);
+        // initialize queue with root element, the filter and terminator must not search this tree
+        // again as the queue storage is shared by all queries of the thread
+        thread_local std::vector<QueryCandidate> queue_storage;
+        thread_local std::vector<Rectangle> box_storage;
+        CandidateQueue traversal_queue(queue_storage, box_storage);
+        const auto root_box = m_search_tree[0].minimum_bounding_rectangle.Decode(WorldBox());
+        traversal_queue.push(QueryCandidate{
+            0, TreeIndex{}, RELATIVE_NODE_BOXES ? traversal_queue.AddBox(root_box) : 0});
 
         while (!traversal_queue.empty())
         {
@@ -623,12 +790,17 @@ class StaticRTree
                     ExploreLeafNode(current_tree_index,
                                     fixed_projected_coordinate,
                                     projected_coordinate,
+                                    max_squared_distance,
+                                    accept_segment,
                                     traversal_queue);
                 }
                 else
                 {
-                    ExploreTreeNode(
-                        current_tree_index, fixed_projected_coordinate, traversal_queue);
+                    ExploreTreeNode(current_tree_index,
+                                    current_query_node.box_index,
+                                    fixed_projected_coordinate,
+                                    max_squared_distance,
+                                    traversal_queue);
                 }
             }
             else
@@ -663,42 +835,139 @@ class StaticRTree
     }
 
   private:
+    /**
+     * An upper bound of the squared distance in projected fixed point coordinates of all points
+     * that are at most max_distance meters away from the input coordinate. Web mercator stretches
+     * distances by 1 / cos(latitude), so the bound uses the largest stretch of the latitudes
+     * within max_distance and leaves some room for the rounding of the projection.
+     */
+    static std::uint64_t MaxSquaredProjectedDistance(const Coordinate input_coordinate,
+                                                     const double max_distance)
+    {
+        const auto no_bound = std::numeric_limits<std::uint64_t>::max();
+        if (!(max_distance < std::numeric_limits<double>::infinity()))
+        {
+            return no_bound;
+        }
+
+        const double max_distance_degree = max_distance /
+                                           coordinate_calculation::detail::EARTH_RADIUS *
+                                           coordinate_calculation::detail::RAD_TO_DEGREE;
+        const double max_latitude =
+            std::abs(static_cast<double>(toFloating(input_coordinate.lat))) + max_distance_degree;
+        if (max_latitude >= web_mercator::detail::EPSG3857_MAX_LATITUDE)
+        {
+            return no_bound;
+        }
+
+        const double max_projected_distance =
+            1.01 * COORDINATE_PRECISION * max_distance_degree /
+                std::cos(coordinate_calculation::detail::degToRad(max_latitude)) +
+            2.;
+        return static_cast<std::uint64_t>(max_projected_distance * max_projected_distance);
+    }
+
+    static void SetLeafCoordinates(EdgeDataT &object,
+                                   const Coordinate projected_u,
+                                   const Coordinate projected_v,
+                                   std::true_type)
+    {
+        object.projected_u = projected_u;
+        object.projected_v = projected_v;
+    }
+
+    static void
+    SetLeafCoordinates(EdgeDataT &, const Coordinate, const Coordinate, std::false_type)
+    {
+    }
+
+    // The coordinates of u and v as stored in the leaf record, projected to web mercator
+    static std::array<Coordinate, 2> LeafCoordinates(const EdgeDataT &object, std::true_type)
+    {
+        return {{object.projected_u, object.projected_v}};
+    }
+
+    // The coordinates of u and v from the coordinate list, the latitudes are not projected yet
+    std::array<Coordinate, 2> LeafCoordinates(const EdgeDataT &object, std::false_type) const
+    {
+        return {{m_coordinate_list[object.u], m_coordinate_list[object.v]}};
+    }
+
     /**
      * Iterates over all the objects in a leaf node and inserts them into our
      * search priority queue.  The speed of this function is very much governed
      * by the value of LEAF_NODE_SIZE, as we'll calculate the euclidean distance
      * for every child of each leaf node visited.
+     * The coordinates of the accepted segments are gathered into arrays first, the
+     * projections and nearest points of a whole vector of segments are then
+     * computed at once. Leaf records with projected coordinates need neither the
+     * coordinate list nor the projection. Segments farther away than max_squared_distance are not queued.
      */
-    template <typename QueueT>
+    template <typename AcceptT, typename QueueT>
     void ExploreLeafNode(const TreeIndex &leaf_id,
                          const Coordinate &projected_input_coordinate_fixed,
                          const FloatCoordinate &projected_input_coordinate,
+                         const std::uint64_t max_squared_distance,
+                         const AcceptT &accept_segment,
                          QueueT &traversal_queue) const
     {
         // Check that we're actually looking at the bottom level of the tree
         BOOST_ASSERT(is_leaf(leaf_id));
 
-        for (const auto i : child_indexes(leaf_id))
-        {
-            const auto &current_edge = m_objects[i];
+        const auto indexes = child_indexes(leaf_id);
+        const auto first_index = *indexes.begin();
+        BOOST_ASSERT(indexes.size() <= LEAF_NODE_SIZE);
 
-            const auto projected_u = web_mercator::fromWGS84(m_coordinate_list[current_edge.u]);
-            const auto projected_v = web_mercator::fromWGS84(m_coordinate_list[current_edge.v]);
-
-            FloatCoordinate projected_nearest;
-            std::tie(std::ignore, projected_nearest) =
-                coordinate_calculation::projectPointOnSegment(
-                    projected_u, projected_v, projected_input_coordinate);
+        std::array<std::uint32_t, LEAF_NODE_SIZE> offsets;
+        std::array<double, LEAF_NODE_SIZE> u_lon, u_lat, v_lon, v_lat;
+        std::size_t size = 0;
+        for (const auto offset : irange<std::uint32_t>(0, indexes.size()))
+        {
+            const auto &current_edge = m_objects[first_index + offset];
+            if (!accept_segment(current_edge))
+            {
+                continue;
+            }
+            const auto coordinates = LeafCoordinates(current_edge, InlineCoordinates{});
+            offsets[size] = offset;
+            u_lon[size] = static_cast<double>(toFloating(coordinates[0].lon));
+            u_lat[size] = static_cast<double>(toFloating(coordinates[0].lat));
+            v_lon[size] = static_cast<double>(toFloating(coordinates[1].lon));
+            v_lat[size] = static_cast<double>(toFloating(coordinates[1].lat));
+            ++size;
+        }
+        if (!InlineCoordinates::value)
+        {
+            web_mercator::latToYapprox(u_lat.data(), size);
+            web_mercator::latToYapprox(v_lat.data(), size);
+        }
 
+        std::array<double, LEAF_NODE_SIZE> nearest_lon, nearest_lat;
+        coordinate_calculation::projectPointOnSegments(projected_input_coordinate,
+                                                       u_lon.data(),
+                                                       u_lat.data(),
+                                                       v_lon.data(),
+                                                       v_lat.data(),
+                                                       size,
+                                                       nearest_lon.data(),
+                                                       nearest_lat.data());
+
+        for (const auto position : irange<std::size_t>(0, size))
+        {
+            const Coordinate projected_nearest{FloatLongitude{nearest_lon[position]},
+                                               FloatLatitude{nearest_lat[position]}};
             const auto squared_distance = coordinate_calculation::squaredEuclideanDistance(
                 projected_input_coordinate_fixed, projected_nearest);
             // distance must be non-negative
             BOOST_ASSERT(0. <= squared_distance);
+            if (squared_distance > max_squared_distance)
+            {
+                continue;
+            }
+            const auto i = first_index + offsets[position];
             BOOST_ASSERT(i < std::numeric_limits<std::uint32_t>::max());
-            traversal_queue.push(QueryCandidate{squared_distance,
-                                                leaf_id,
-                                                static_cast<std::uint32_t>(i),
-                                                Coordinate{projected_nearest}});
+            traversal_queue.push(QueryCandidate{
+                squared_distance, leaf_id, static_cast<std::uint32_t>(i), projected_nearest});
         }
     }
 
@@ -708,10 +977,13 @@ class StaticRTree
      * priority metric.
      * The closests distance to a box from our point is also the closest distance
      * to the closest line in that box (assuming the boxes hug their contents).
+     * Children farther away than max_squared_distance are pruned.
      */
     template <class QueueT>
     void ExploreTreeNode(const TreeIndex &parent,
+                         const std::uint32_t parent_box_index,
                          const Coordinate &fixed_projected_input_coordinate,
+                         const std::uint64_t max_squared_distance,
                          QueueT &traversal_queue) const
     {
         // Figure out which_id level the parent is on, and it's offset
@@ -719,17 +991,32 @@ class StaticRTree
         // Check that we're actually looking at the bottom level of the tree
         BOOST_ASSERT(!is_leaf(parent));
 
+        // copied, adding boxes may move the stored ones
+        const auto parent_box =
+            RELATIVE_NODE_BOXES ? traversal_queue.GetBox(parent_box_index) : Rectangle{};
+        const TreeIndex first_child(parent.level + 1, 0);
+        const bool children_are_leaves = is_leaf(first_child);
+
         for (const auto child_index : child_indexes(parent))
         {
-            const auto &child = m_search_tree[child_index];
+            const auto child_box =
+                m_search_tree[child_index].minimum_bounding_rectangle.Decode(parent_box);
 
             const auto squared_lower_bound_to_element =
-                child.minimum_bounding_rectangle.GetMinSquaredDist(
-                    fixed_projected_input_coordinate);
+                child_box.GetMinSquaredDist(fixed_projected_input_coordinate);
+            if (squared_lower_bound_to_element > max_squared_distance)
+            {
+                continue;
+            }
 
+            // the children of leaves are segments, their boxes are not needed
+            const auto child_box_index = RELATIVE_NODE_BOXES && !children_are_leaves
+                                             ? traversal_queue.AddBox(child_box)
+                                             : 0;
             traversal_queue.push(QueryCandidate{
                 squared_lower_bound_to_element,
-                TreeIndex(parent.level + 1, child_index - m_tree_level_starts[parent.level + 1])});
+                TreeIndex(parent.level + 1, child_index - m_tree_level_starts[parent.level + 1]),
+                child_box_index});
         }
     }
 
@@ -784,6 +1071,21 @@ class StaticRTree
     {
         return treeindex.level == m_tree_level_starts.size() - 1;
     }
+
+    // The level sizes add up to the number of nodes unless the nodes were written with a
+    // different size, i.e. by a build with other RTREE_NODE_BOX_BITS
+    void CheckLevelSizes() const
+    {
+        const auto number_of_nodes = std::accumulate(
+            m_tree_level_sizes.begin(), m_tree_level_sizes.end(), std::uint64_t{0});
+        if (m_tree_level_sizes.empty() || number_of_nodes != m_search_tree.size())
+        {
+            throw util::exception("The " + std::to_string(m_search_tree.size()) +
+                                  " nodes of the rtree don't match its levels, the data was " +
+                                  "prepared with a different RTREE_NODE_BOX_BITS setting" +
+                                  SOURCE_REF);
+        }
+    }
 };
 
 //[1] "On Packing R-Trees"; I. Kamel, C. Faloutsos; 1993; DOI: 10.1145/170088.170403
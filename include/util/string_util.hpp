@@ -58,44 +58,57 @@ template <int length, int precision> char *printInt(char *buffer, int value)
     return buffer;
 }
 
-inline std::string escape_JSON(const std::string &input)
+// Appends the escaped input to any container with range insert (std::string, std::vector<char>).
+// Runs of characters that need no escaping are copied in one go.
+template <typename Output> void escape_JSON(const std::string &input, Output &output)
 {
-    // escape and skip reallocations if possible
-    std::string output;
-    output.reserve(input.size() + 4); // +4 assumes two backslashes on avg
-    for (const char letter : input)
+    const char *run_begin = input.data();
+    const char *const input_end = input.data() + input.size();
+    for (const char *iter = run_begin; iter != input_end; ++iter)
     {
-        switch (letter)
+        const char *replacement;
+        switch (*iter)
         {
         case '\\':
-            output += "\\\\";
+            replacement = "\\\\";
             break;
         case '"':
-            output += "\\\"";
+            replacement = "\\\"";
             break;
         case '/':
-            output += "\\/";
+            replacement = "\\/";
             break;
         case '\b':
-            output += "\\b";
+            replacement = "\\b";
             break;
         case '\f':
-            output += "\\f";
+            replacement = "\\f";
             break;
         case '\n':
-            output += "\\n";
+            replacement = "\\n";
             break;
         case '\r':
-            output += "\\r";
+            replacement = "\\r";
             break;
         case '\t':
-            output += "\\t";
+            replacement = "\\t";
             break;
         default:
-            output.append(1, letter);
-            break;
+            continue;
         }
+        output.insert(output.end(), run_begin, iter);
+        output.insert(output.end(), replacement, replacement + 2);
+        run_begin = iter + 1;
     }
+    output.insert(output.end(), run_begin, input_end);
+}
+
+inline std::string escape_JSON(const std::string &input)
+{
+    // escape and skip reallocations if possible
+    std::string output;
+    output.reserve(input.size() + 4); // +4 assumes two backslashes on avg
+    escape_JSON(input, output);
     return output;
 }
 
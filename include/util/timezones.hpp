@@ -5,45 +5,83 @@
 
 #include <boost/filesystem/path.hpp>
 #include <boost/geometry.hpp>
-#include <boost/geometry/index/rtree.hpp>
 #include <boost/optional.hpp>
 
 #include <rapidjson/document.h>
 
 #include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace osrm
 {
 namespace updater
 {
 
-// Time zone shape polygons loaded in R-tree
+// Time zone shape polygons
 // local_time_t is a pair of a time zone shape polygon and the corresponding local time
-// rtree_t is a lookup R-tree that maps a geographic point to an index in a local_time_t vector
 using point_t = boost::geometry::model::
     point<double, 2, boost::geometry::cs::spherical_equatorial<boost::geometry::degree>>;
 using polygon_t = boost::geometry::model::polygon<point_t>;
 using box_t = boost::geometry::model::box<point_t>;
-using rtree_t =
-    boost::geometry::index::rtree<std::pair<box_t, size_t>, boost::geometry::index::rstar<8>>;
 using local_time_t = std::pair<polygon_t, struct tm>;
 
+// Answers lookups with a grid of `cell_size` degrees over the bounding box of the zones. Cells
+// that lie inside of one zone return its local time directly, only the cells on the boundaries
+// of zones test the point against the polygons that touch them.
 class Timezoner
 {
   public:
+    static constexpr double DEFAULT_CELL_SIZE = 0.1;
+
     Timezoner() = default;
 
-    Timezoner(const char geojson[], std::time_t utc_time_now);
-    Timezoner(const boost::filesystem::path &tz_shapes_filename, std::time_t utc_time_now);
+    Timezoner(const char geojson[],
+              std::time_t utc_time_now,
+              const double cell_size = DEFAULT_CELL_SIZE);
+    // Loads a GeoJSON file or a grid index written by Write
+    Timezoner(const boost::filesystem::path &tz_shapes_filename,
+              std::time_t utc_time_now,
+              const double cell_size = DEFAULT_CELL_SIZE);
 
     boost::optional<struct tm> operator()(const point_t &point) const;
 
+    // Writes the zones and the grid, loading them needs no GeoJSON parsing or grid building
+    void Write(const boost::filesystem::path &index_filename) const;
+
+    std::size_t GetNumberOfCells() const { return cells.size(); }
+    // The number of cells that test the point against polygons, excludes the empty cells
+    std::size_t GetNumberOfBoundaryCells() const;
+
   private:
-    void LoadLocalTimesRTree(rapidjson::Document &geojson, std::time_t utc_time);
+    // cells inside of a zone store its polygon with this flag, the other cells their index into
+    // boundary_offsets
+    static constexpr std::uint32_t INSIDE_ZONE = 0x80000000u;
+
+    void LoadLocalTimes(rapidjson::Document &geojson, std::time_t utc_time);
+    void LoadIndex(const boost::filesystem::path &index_filename, std::time_t utc_time);
+    void BuildGrid(const double cell_size);
+    boost::optional<std::size_t> GetCell(const point_t &point) const;
 
-    rtree_t rtree;
     std::vector<local_time_t> local_times;
+    // time zone name of every polygon, to write the index
+    std::vector<std::string> tz_names;
+
+    double min_lon = 0.;
+    double min_lat = 0.;
+    double cell_size = DEFAULT_CELL_SIZE;
+    std::uint32_t columns = 0;
+    std::uint32_t rows = 0;
+    std::vector<std::uint32_t> cells;
+    // the polygons that touch the cells not inside of a zone, such a cell with the value i tests
+    // the range [boundary_offsets[i], boundary_offsets[i + 1]) of boundary_polygons
+    std::vector<std::uint32_t> boundary_offsets;
+    std::vector<std::uint32_t> boundary_polygons;
 };
+
+// true if the file starts with the magic of a grid index written by Timezoner::Write
+bool isTimezoneIndexFile(const boost::filesystem::path &path);
 }
 }
 
@@ -25,6 +25,7 @@ const constexpr std::uint32_t FEATURE_GEOMETRIES_TAG = 4;
 
 const constexpr std::uint32_t GEOMETRY_TYPE_POINT = 1;
 const constexpr std::uint32_t GEOMETRY_TYPE_LINE = 2;
+const constexpr std::uint32_t GEOMETRY_TYPE_POLYGON = 3;
 
 const constexpr std::uint32_t VARIANT_TYPE_STRING = 1;
 const constexpr std::uint32_t VARIANT_TYPE_FLOAT = 2;
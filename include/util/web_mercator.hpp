@@ -5,6 +5,8 @@
 
 #include <boost/math/constants/constants.hpp>
 
+#include <cstddef>
+
 namespace osrm
 {
 namespace util
@@ -22,6 +24,36 @@ const constexpr double MAXEXTENT = EARTH_RADIUS_WGS84 * boost::math::constants::
 // ^ math functions are not constexpr since they have side-effects (setting errno) :(
 const constexpr double EPSG3857_MAX_LATITUDE = 85.051128779806592378; // 90(4*atan(exp(pi))/pi-1)
 const constexpr double MAX_LONGITUDE = 180.0;
+// Approximate the inverse Gudermannian function with the Padé approximant [11/11]: deg → deg
+// Coefficients are computed for the argument range [-70°,70°] by Remez algorithm
+// |err|_∞=3.387e-12
+const constexpr double LAT_TO_Y_APPROX_MAX_LATITUDE = 70.;
+const constexpr double LAT_TO_Y_APPROX_NUMERATOR[] = {
+    0.00000000000000000000000000e+00,
+    1.00000000000089108431373566e+00,
+    2.34439410386997223035693483e-06,
+    -3.21291701673364717170998957e-04,
+    -6.62778508496089940141103135e-10,
+    3.68188055470304769936079078e-08,
+    6.31192702320492485752941578e-14,
+    -1.77274453235716299127325443e-12,
+    -2.24563810831776747318521450e-18,
+    3.13524754818073129982475171e-17,
+    2.09014225025314211415458228e-23,
+    -9.82938075991732185095509716e-23};
+const constexpr double LAT_TO_Y_APPROX_DENOMINATOR[] = {
+    1.00000000000000000000000000e+00,
+    2.34439410398970701719081061e-06,
+    -3.72061271627251952928813333e-04,
+    -7.81802389685429267252612620e-10,
+    5.18418724186576447072888605e-08,
+    9.37468561198098681003717477e-14,
+    -3.30833288607921773936702558e-12,
+    -4.78446279888774903983338274e-18,
+    9.32999229169156878168234191e-17,
+    9.17695141954265959600965170e-23,
+    -8.72130728982012387640166055e-22,
+    -3.23083224835967391884404730e-28};
 }
 
 // Converts projected mercator degrees to PX
@@ -58,48 +90,26 @@ inline double latToY(const FloatLatitude latitude)
     return detail::RAD_TO_DEGREE * 0.5 * std::log((1 + f) / (1 - f));
 }
 
-template <typename T> constexpr double horner(double, T an) { return an; }
-
-template <typename T, typename... U> constexpr double horner(double x, T an, U... a)
+// Evaluates the polynomial with the coefficients of increasing degree at x
+template <std::size_t N> inline double horner(const double x, const double (&coefficients)[N])
 {
-    return horner(x, a...) * x + an;
+    double result = coefficients[N - 1];
+    for (std::size_t degree = N - 1; degree > 0; --degree)
+    {
+        result = result * x + coefficients[degree - 1];
+    }
+    return result;
 }
 
 inline double latToYapprox(const FloatLatitude latitude)
 {
-    if (latitude < FloatLatitude{-70.} || latitude > FloatLatitude{70.})
+    if (latitude < FloatLatitude{-detail::LAT_TO_Y_APPROX_MAX_LATITUDE} ||
+        latitude > FloatLatitude{detail::LAT_TO_Y_APPROX_MAX_LATITUDE})
         return latToY(latitude);
 
-    // Approximate the inverse Gudermannian function with the Padé approximant [11/11]: deg → deg
-    // Coefficients are computed for the argument range [-70°,70°] by Remez algorithm
-    // |err|_∞=3.387e-12
     const auto x = static_cast<double>(latitude);
-    return horner(x,
-                  0.00000000000000000000000000e+00,
-                  1.00000000000089108431373566e+00,
-                  2.34439410386997223035693483e-06,
-                  -3.21291701673364717170998957e-04,
-                  -6.62778508496089940141103135e-10,
-                  3.68188055470304769936079078e-08,
-                  6.31192702320492485752941578e-14,
-                  -1.77274453235716299127325443e-12,
-                  -2.24563810831776747318521450e-18,
-                  3.13524754818073129982475171e-17,
-                  2.09014225025314211415458228e-23,
-                  -9.82938075991732185095509716e-23) /
-           horner(x,
-                  1.00000000000000000000000000e+00,
-                  2.34439410398970701719081061e-06,
-                  -3.72061271627251952928813333e-04,
-                  -7.81802389685429267252612620e-10,
-                  5.18418724186576447072888605e-08,
-                  9.37468561198098681003717477e-14,
-                  -3.30833288607921773936702558e-12,
-                  -4.78446279888774903983338274e-18,
-                  9.32999229169156878168234191e-17,
-                  9.17695141954265959600965170e-23,
-                  -8.72130728982012387640166055e-22,
-                  -3.23083224835967391884404730e-28);
+    return horner(x, detail::LAT_TO_Y_APPROX_NUMERATOR) /
+           horner(x, detail::LAT_TO_Y_APPROX_DENOMINATOR);
 }
 
 inline void pixelToDegree(const double shift, double &x, double &y)
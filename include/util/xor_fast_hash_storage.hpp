@@ -1,6 +1,7 @@
 #ifndef XOR_FAST_HASH_STORAGE_HPP
 #define XOR_FAST_HASH_STORAGE_HPP
 
+#include "util/prefetch.hpp"
 #include "util/xor_fast_hash.hpp"
 
 #include <limits>
@@ -63,6 +64,9 @@ class XORFastHashStorage
         return positions[position].key;
     }
 
+    // the first cell probed for the node
+    void prefetch(const NodeID node) const { util::prefetch(&positions[fast_hasher(node)]); }
+
     void Clear()
     {
         ++current_timestamp;
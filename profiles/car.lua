@@ -25,6 +25,8 @@ function setup()
       continue_straight_at_waypoint  = true,
       use_turn_restrictions          = true,
       traffic_light_penalty          = 2,
+      -- process_way only reads the tags, ways with the same tags share its result
+      way_function_depends_on_tags_only = true,
     },
 
     default_mode              = mode.driving,
@@ -43,6 +45,13 @@ function setup()
       'N', 'NE', 'E', 'SE', 'S', 'SW', 'W', 'NW', 'North', 'South', 'West', 'East'
     },
 
+    -- classes that MLD queries can exclude with exclude=, every combination adds a metric
+    excludable = Sequence {
+      Set {'toll'},
+      Set {'motorway'},
+      Set {'ferry'}
+    },
+
     barrier_whitelist = Set {
       'cattle_grid',
       'border_control',
@@ -100,6 +109,13 @@ function setup()
       'vehicle'
     },
 
+    -- process_way ignores ways without one of these keys, osrm-extract --two-pass-parsing
+    -- skips the nodes of all other ways
+    way_prefilter_keys = Sequence {
+      'highway',
+      'route'
+    },
+
     avoid = Set {
       'area',
       -- 'toll',    -- uncomment this to avoid tolls
@@ -0,0 +1,102 @@
+#!/usr/bin/env node
+
+// Compares the --phase-report files of osrm-extract, osrm-partition, osrm-customize and
+// osrm-contract with a stored baseline. Exits with 1 if the wall time, CPU time or peak memory
+// of a phase grew by more than the threshold.
+//
+//   compare_phases.js --baseline baseline.json [--threshold 0.1] report.json...
+//   compare_phases.js --baseline baseline.json --write report.json...
+
+'use strict'
+
+var fs = require('fs');
+
+var METRICS = ['wall_time', 'cpu_time', 'peak_rss'];
+// phases below these are too short or small to compare reliably
+var MIN_VALUES = {wall_time: 1, cpu_time: 1, peak_rss: 64 * 1024 * 1024};
+
+function usage() {
+    console.error('Usage: compare_phases.js --baseline <baseline.json> [--threshold <fraction>] [--write] <report.json>...');
+    process.exit(2);
+}
+
+var baseline_path;
+var threshold = 0.1;
+var write = false;
+var reports = [];
+for (var i = 2; i < process.argv.length; ++i) {
+    var arg = process.argv[i];
+    if (arg === '--baseline') baseline_path = process.argv[++i];
+    else if (arg === '--threshold') threshold = parseFloat(process.argv[++i]);
+    else if (arg === '--write') write = true;
+    else reports.push(arg);
+}
+if (!baseline_path || reports.length === 0 || isNaN(threshold)) usage();
+
+// {"<tool>/<phase>/<nested phase>": {"wall_time": ..., "cpu_time": ..., "peak_rss": ...}}
+function loadPhases(paths) {
+    var phases = {};
+    paths.forEach((path) => {
+        var report = JSON.parse(fs.readFileSync(path, 'utf-8'));
+        var names = [];
+        report.phases.forEach((phase) => {
+            names.length = phase.depth;
+            names.push(phase.name);
+            var key = names.join('/');
+            if (phase.depth === 0 && phase.name !== report.tool) key = report.tool + '/' + key;
+            // phases that run more than once are added up
+            var entry = phases[key] || (phases[key] = {wall_time: 0, cpu_time: 0, peak_rss: 0});
+            entry.wall_time += phase.wall_time;
+            entry.cpu_time += phase.cpu_time;
+            entry.peak_rss = Math.max(entry.peak_rss, phase.peak_rss);
+        });
+    });
+    return phases;
+}
+
+var current = loadPhases(reports);
+
+if (write) {
+    fs.writeFileSync(baseline_path, JSON.stringify({phases: current}, null, 2) + '\n', 'utf-8');
+    console.log(`Wrote the baseline of ${Object.keys(current).length} phases to ${baseline_path}`);
+    process.exit(0);
+}
+
+if (!fs.existsSync(baseline_path)) {
+    console.error(`No baseline ${baseline_path}, create it with --write`);
+    process.exit(2);
+}
+var baseline = JSON.parse(fs.readFileSync(baseline_path, 'utf-8')).phases;
+
+function format(metric, value) {
+    return metric === 'peak_rss' ? `${(value / 1024 / 1024).toFixed(1)} MiB` : `${value.toFixed(2)} s`;
+}
+
+var regressions = 0;
+Object.keys(current).forEach((key) => {
+    var before = baseline[key];
+    if (!before) {
+        console.log(`${key}\tnew phase`);
+        return;
+    }
+    METRICS.forEach((metric) => {
+        var old_value = before[metric];
+        var new_value = current[key][metric];
+        if (!(old_value >= MIN_VALUES[metric]) && !(new_value >= MIN_VALUES[metric])) return;
+
+        var change = old_value > 0 ? new_value / old_value - 1 : Infinity;
+        var regressed = change > threshold;
+        if (regressed) ++regressions;
+        console.log(`${regressed ? 'REGRESSION' : 'ok'}\t${key}\t${metric}\t` +
+                    `${format(metric, old_value)} -> ${format(metric, new_value)}\t` +
+                    `${change >= 0 ? '+' : ''}${(change * 100).toFixed(1)}%`);
+    });
+});
+Object.keys(baseline).filter((key) => !current[key]).forEach((key) => {
+    console.log(`${key}\tmissing from the reports`);
+});
+
+if (regressions > 0) {
+    console.error(`${regressions} regressions beyond ${(threshold * 100).toFixed(0)}%`);
+    process.exit(1);
+}
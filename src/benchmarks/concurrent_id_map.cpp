@@ -0,0 +1,94 @@
+#include "util/concurrent_id_map.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+
+#include <boost/interprocess/sync/interprocess_upgradable_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/interprocess/sync/sharable_lock.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+// The map behind a single upgradable mutex, as ConcurrentIDMap was implemented before
+template <typename KeyType, typename ValueType> struct LockedIDMap
+{
+    using UpgradableMutex = boost::interprocess::interprocess_upgradable_mutex;
+    using ScopedReaderLock = boost::interprocess::sharable_lock<UpgradableMutex>;
+    using ScopedWriterLock = boost::interprocess::scoped_lock<UpgradableMutex>;
+
+    std::unordered_map<KeyType, ValueType> data;
+    UpgradableMutex mutex;
+
+    ValueType ConcurrentFindOrAdd(const KeyType &key)
+    {
+        {
+            ScopedReaderLock sentry{mutex};
+            const auto result = data.find(key);
+            if (result != data.end())
+                return result->second;
+        }
+        ScopedWriterLock sentry{mutex};
+        const auto result = data.find(key);
+        if (result != data.end())
+            return result->second;
+        const auto id = static_cast<ValueType>(data.size());
+        data[key] = id;
+        return id;
+    }
+};
+
+// Looks up all keys from all threads, few of them are new like the classes of the guidance
+template <typename Map> double benchmark(const std::vector<std::uint64_t> &keys)
+{
+    Map map;
+    std::atomic<std::uint64_t> checksum{0};
+
+    TIMER_START(lookups);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, keys.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          std::uint64_t sum = 0;
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                              sum += map.ConcurrentFindOrAdd(keys[index]);
+                          checksum += sum;
+                      });
+    TIMER_STOP(lookups);
+
+    if (checksum == 0)
+        std::exit(EXIT_FAILURE);
+    return TIMER_MSEC(lookups);
+}
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    const std::size_t num_lookups = 20000000;
+    const std::uint64_t num_keys = 10000;
+
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<std::uint64_t> key_distribution(0, num_keys - 1);
+    std::vector<std::uint64_t> keys(num_lookups);
+    for (auto &key : keys)
+        key = key_distribution(generator);
+
+    util::Log() << num_lookups << " lookups of " << num_keys << " keys on "
+                << tbb::task_scheduler_init::default_num_threads() << " threads";
+    util::Log() << "upgradable mutex: "
+                << benchmark<LockedIDMap<std::uint64_t, std::uint32_t>>(keys) << "ms";
+    util::Log() << "sharded: "
+                << benchmark<util::ConcurrentIDMap<std::uint64_t, std::uint32_t>>(keys) << "ms";
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,182 @@
+#include "customizer/cell_customizer.hpp"
+#include "partition/cell_storage.hpp"
+#include "partition/multi_level_graph.hpp"
+#include "partition/multi_level_partition.hpp"
+
+#include "util/static_graph.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <tbb/task_scheduler_init.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+struct EdgeData
+{
+    EdgeWeight weight;
+    EdgeDuration duration;
+    EdgeDistance distance;
+    bool forward;
+    bool backward;
+};
+using Graph = partition::MultiLevelGraph<EdgeData, storage::Ownership::Container>;
+
+// Nested square cells of a grid, the cells of a level are cell_sizes[level] nodes wide
+partition::MultiLevelPartition makePartition(const std::size_t side,
+                                             const std::vector<std::size_t> &cell_sizes)
+{
+    std::vector<std::vector<CellID>> partitions;
+    std::vector<std::uint32_t> num_cells;
+    for (const auto cell_size : cell_sizes)
+    {
+        const auto cells_per_row = (side + cell_size - 1) / cell_size;
+        std::vector<CellID> cells(side * side);
+        for (std::size_t row = 0; row < side; ++row)
+        {
+            for (std::size_t column = 0; column < side; ++column)
+            {
+                cells[row * side + column] =
+                    (row / cell_size) * cells_per_row + column / cell_size;
+            }
+        }
+        partitions.push_back(std::move(cells));
+        num_cells.push_back(cells_per_row * cells_per_row);
+    }
+    return partition::MultiLevelPartition{partitions, num_cells};
+}
+
+// Grid with edges between neighbours in both directions and random weights
+Graph makeGraph(const partition::MultiLevelPartition &mlp, const std::size_t side)
+{
+    using Edge = util::static_graph_details::SortableEdgeWithData<EdgeData>;
+
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<EdgeWeight> random_weight(1, 100);
+
+    std::vector<Edge> edges;
+    const auto add_edge = [&](const NodeID from, const NodeID to) {
+        const auto weight = random_weight(generator);
+        const EdgeDuration duration = random_weight(generator);
+        const EdgeDistance distance = 1.5f * weight;
+        edges.push_back(Edge{from, to, weight, duration, distance, true, false});
+        edges.push_back(Edge{to, from, weight, duration, distance, false, true});
+    };
+    for (std::size_t row = 0; row < side; ++row)
+    {
+        for (std::size_t column = 0; column < side; ++column)
+        {
+            const NodeID node = row * side + column;
+            if (column + 1 < side)
+            {
+                add_edge(node, node + 1);
+                add_edge(node + 1, node);
+            }
+            if (row + 1 < side)
+            {
+                add_edge(node, node + side);
+                add_edge(node + side, node);
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return Graph(mlp, side * side, edges);
+}
+
+// Returns the number of cell entries that differ in weight and in duration or distance
+std::pair<std::size_t, std::size_t> compare(const partition::MultiLevelPartition &mlp,
+                                            const partition::CellStorage &lhs,
+                                            const partition::CellStorage &rhs)
+{
+    std::size_t different_weights = 0;
+    std::size_t different_values = 0;
+    for (LevelID level = 1; level < mlp.GetNumberOfLevels(); ++level)
+    {
+        for (CellID id = 0; id < mlp.GetNumberOfCells(level); ++id)
+        {
+            const auto lhs_cell = lhs.GetCell(level, id);
+            const auto rhs_cell = rhs.GetCell(level, id);
+            for (const auto node : lhs_cell.GetSourceNodes())
+            {
+                const auto lhs_weights = lhs_cell.GetOutWeight(node);
+                const auto lhs_durations = lhs_cell.GetOutDuration(node);
+                const auto lhs_distances = lhs_cell.GetOutDistance(node);
+                const auto rhs_weights = rhs_cell.GetOutWeight(node);
+                const auto rhs_durations = rhs_cell.GetOutDuration(node);
+                const auto rhs_distances = rhs_cell.GetOutDistance(node);
+                for (std::size_t index = 0; index < lhs_weights.size(); ++index)
+                {
+                    different_weights += lhs_weights[index] != rhs_weights[index];
+                    different_values += lhs_durations[index] != rhs_durations[index] ||
+                                        lhs_distances[index] != rhs_distances[index];
+                }
+            }
+        }
+    }
+    return std::make_pair(different_weights, different_values);
+}
+}
+
+// Times the customization of a grid with the Dijkstra and the matrix kernel on the levels above
+// the first one and checks that both compute the same metric
+int main(int argc, const char *argv[]) try
+{
+    const std::size_t side = argc > 1 ? std::stoul(argv[1]) : 512;
+    const int num_threads = argc > 2 ? std::stoi(argv[2]) : 1;
+    tbb::task_scheduler_init init(num_threads);
+
+    std::vector<std::size_t> cell_sizes;
+    for (int arg = 3; arg < argc; ++arg)
+    {
+        cell_sizes.push_back(std::stoul(argv[arg]));
+    }
+    if (cell_sizes.empty())
+    {
+        cell_sizes = {8, 32, 128};
+    }
+
+    const auto mlp = makePartition(side, cell_sizes);
+    const auto graph = makeGraph(mlp, side);
+    std::cout << "Grid of " << graph.GetNumberOfNodes() << " nodes and "
+              << graph.GetNumberOfEdges() << " edges, " << num_threads << " threads" << std::endl;
+
+    using Kernel = customizer::CellCustomizer::Kernel;
+    const auto customize = [&](const Kernel kernel, const std::string &name) {
+        partition::CellStorage storage(mlp, graph);
+        TIMER_START(customize);
+        customizer::CellCustomizer(mlp, kernel).Customize(graph, storage);
+        TIMER_STOP(customize);
+        std::cout << name << ": " << TIMER_MSEC(customize) << "ms" << std::endl;
+        return storage;
+    };
+
+    const auto dijkstra = customize(Kernel::Dijkstra, "dijkstra");
+    const auto matrix = customize(Kernel::Matrix, "matrix");
+    const auto automatic = customize(Kernel::Automatic, "automatic");
+
+    // durations and distances may differ where several paths have the same weight
+    const auto matrix_differences = compare(mlp, dijkstra, matrix);
+    const auto automatic_differences = compare(mlp, dijkstra, automatic);
+    std::cout << "matrix: " << matrix_differences.first << " different weights, "
+              << matrix_differences.second << " different durations or distances" << std::endl;
+    std::cout << "automatic: " << automatic_differences.first << " different weights, "
+              << automatic_differences.second << " different durations or distances"
+              << std::endl;
+
+    return matrix_differences.first == 0 && automatic_differences.first == 0 ? EXIT_SUCCESS
+                                                                             : EXIT_FAILURE;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,134 @@
+#include "engine/douglas_peucker.hpp"
+#include "util/coordinate.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+#include "util/web_mercator.hpp"
+
+#include <cstdlib>
+#include <random>
+#include <stack>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+// Simplifies the way douglasPeucker did before the geometry was projected into arrays, one
+// perpendicular distance after the other
+std::vector<util::Coordinate> simplifyPerPoint(const std::vector<util::Coordinate> &geometry,
+                                               const unsigned zoom_level)
+{
+    const auto threshold = engine::detail::DOUGLAS_PEUCKER_THRESHOLDS[zoom_level];
+    std::vector<util::FloatCoordinate> projected;
+    for (const auto coordinate : geometry)
+    {
+        projected.push_back(util::web_mercator::fromWGS84(coordinate));
+    }
+
+    std::vector<bool> is_necessary(geometry.size(), false);
+    is_necessary.front() = true;
+    is_necessary.back() = true;
+    std::stack<std::pair<std::size_t, std::size_t>> ranges;
+    ranges.emplace(0, geometry.size() - 1);
+    while (!ranges.empty())
+    {
+        const auto range = ranges.top();
+        ranges.pop();
+
+        std::uint64_t max_distance = 0;
+        auto farthest = range.second;
+        for (auto index = range.first + 1; index < range.second; ++index)
+        {
+            const auto nearest =
+                util::coordinate_calculation::projectPointOnSegment(
+                    projected[range.first], projected[range.second], projected[index])
+                    .second;
+            const auto distance =
+                util::coordinate_calculation::squaredEuclideanDistance(projected[index], nearest);
+            if (distance > max_distance && distance > threshold)
+            {
+                farthest = index;
+                max_distance = distance;
+            }
+        }
+
+        if (max_distance > threshold)
+        {
+            is_necessary[farthest] = true;
+            ranges.emplace(range.first, farthest);
+            ranges.emplace(farthest, range.second);
+        }
+    }
+
+    std::vector<util::Coordinate> simplified;
+    for (auto index : util::irange<std::size_t>(0, geometry.size()))
+    {
+        if (is_necessary[index])
+        {
+            simplified.push_back(geometry[index]);
+        }
+    }
+    return simplified;
+}
+
+// A trace with a point every few meters, like the full overview of a long route or match
+std::vector<util::Coordinate> makeGeometry(const std::size_t size)
+{
+    std::mt19937 generator(1337);
+    std::normal_distribution<> step(0, 0.0002);
+    std::vector<util::Coordinate> geometry;
+    double lon = 13.4, lat = 52.5;
+    for (auto index : util::irange<std::size_t>(0, size))
+    {
+        (void)index;
+        lon += step(generator) + 0.00005;
+        lat += step(generator);
+        geometry.push_back(util::Coordinate{util::FloatLongitude{lon}, util::FloatLatitude{lat}});
+    }
+    return geometry;
+}
+
+bool benchmark(const std::size_t size, const unsigned zoom_level)
+{
+    const auto geometry = makeGeometry(size);
+
+    TIMER_START(per_point);
+    const auto reference = simplifyPerPoint(geometry, zoom_level);
+    TIMER_STOP(per_point);
+
+    TIMER_START(projected);
+    const auto simplified = engine::douglasPeucker(geometry, zoom_level);
+    TIMER_STOP(projected);
+
+    if (simplified != reference)
+        return false;
+
+    util::Log() << size << " points at z" << zoom_level << " to " << simplified.size()
+                << ": per point " << TIMER_MSEC(per_point) << "ms, projected "
+                << TIMER_MSEC(projected) << "ms";
+    return true;
+}
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    for (const std::size_t size : {1000, 100000, 1000000})
+    {
+        for (const unsigned zoom_level : {5, 12, 18})
+        {
+            if (!benchmark(size, zoom_level))
+            {
+                util::Log(logERROR) << "Simplified geometries differ";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
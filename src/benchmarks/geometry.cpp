@@ -0,0 +1,123 @@
+#include "storage/io.hpp"
+
+#include "util/delta_vector.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include "osrm/route_parameters.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cstdlib>
+
+// Compares the memory of the plain and the delta encoded geometry nodes and the /route latency
+// with either of them, see StorageConfig::compress_geometry
+int main(int argc, const char *argv[]) try
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " data.osrm [ch|mld] [routes]\n";
+        return EXIT_FAILURE;
+    }
+
+    using namespace osrm;
+
+    const std::string base_path = argv[1];
+    const auto algorithm = argc > 2 && std::string{argv[2]} == "mld"
+                               ? EngineConfig::Algorithm::MLD
+                               : EngineConfig::Algorithm::CH;
+    const std::size_t num_routes = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+    {
+        storage::io::FileReader reader(base_path + ".geometry",
+                                       storage::io::FileReader::VerifyFingerprint);
+        reader.ReadVectorSize<unsigned>(); // index
+        std::vector<NodeID> nodes(reader.ReadElementCount64());
+        reader.ReadInto(nodes);
+
+        TIMER_START(encode);
+        util::DeltaVector<NodeID> encoded_nodes;
+        for (const auto node : nodes)
+        {
+            encoded_nodes.push_back(node);
+        }
+        TIMER_STOP(encode);
+
+        const auto plain_bytes = nodes.size() * sizeof(NodeID);
+        const auto encoded_bytes = encoded_nodes.GetDeltas().size() +
+                                   encoded_nodes.GetBlockOffsets().size() * sizeof(std::uint64_t);
+        std::cout << nodes.size() << " geometry nodes: " << plain_bytes << " bytes plain, "
+                  << encoded_bytes << " bytes encoded ("
+                  << (100. * encoded_bytes / std::max<std::size_t>(plain_bytes, 1))
+                  << "%), encoded in " << TIMER_MSEC(encode) << "ms" << std::endl;
+    }
+
+    using osrm::util::FloatCoordinate;
+    using osrm::util::FloatLatitude;
+    using osrm::util::FloatLongitude;
+
+    // Routes all over monaco, with the full geometry so every node is decoded
+    const auto benchmark = [&](const bool compress_geometry) {
+        EngineConfig config;
+        config.storage_config = {base_path};
+        config.storage_config.compress_geometry = compress_geometry;
+        config.use_shared_memory = false;
+        config.algorithm = algorithm;
+        OSRM osrm{config};
+
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> longitude(7.410, 7.440);
+        std::uniform_real_distribution<double> latitude(43.725, 43.750);
+
+        RouteParameters params;
+        params.steps = true;
+        params.overview = RouteParameters::OverviewType::Full;
+        params.annotations = true;
+        params.annotations_type = RouteParameters::AnnotationsType::All;
+
+        std::size_t failed_routes = 0;
+        TIMER_START(routes);
+        for (std::size_t index = 0; index < num_routes; ++index)
+        {
+            params.coordinates = {
+                FloatCoordinate{FloatLongitude{longitude(generator)},
+                                FloatLatitude{latitude(generator)}},
+                FloatCoordinate{FloatLongitude{longitude(generator)},
+                                FloatLatitude{latitude(generator)}}};
+
+            // random points may not be connected, those are timed all the same
+            json::Object result;
+            if (osrm.Route(params, result) != Status::Ok)
+            {
+                ++failed_routes;
+            }
+        }
+        TIMER_STOP(routes);
+        std::cout << (compress_geometry ? "encoded" : "plain") << " geometry: "
+                  << (TIMER_MSEC(routes) / num_routes) << "ms/req, " << failed_routes << " of "
+                  << num_routes << " routes failed" << std::endl;
+    };
+
+    benchmark(false);
+    benchmark(true);
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
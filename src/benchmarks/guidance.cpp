@@ -0,0 +1,164 @@
+#include "engine/api/json_factory.hpp"
+#include "engine/guidance/collapse_turns.hpp"
+#include "engine/guidance/lane_processing.hpp"
+#include "engine/guidance/post_processing.hpp"
+#include "engine/guidance/route_step.hpp"
+#include "engine/guidance/verbosity_reduction.hpp"
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/string_view.hpp"
+#include "util/timing_util.hpp"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+std::size_t allocations = 0;
+}
+
+// counts every allocation of the benchmark, it runs on a single thread
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *memory = std::malloc(size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+namespace
+{
+using namespace engine::guidance;
+using namespace extractor::guidance;
+
+// The name data of a facade, steps refer to it
+const std::vector<std::string> names = {"Boulevard Saint-Germain",
+                                        "Rue de Rivoli (Ouest)",
+                                        "Avenue des Champs-Elysees",
+                                        "Quai Francois Mauriac"};
+
+IntermediateIntersection makeIntersection(const std::size_t index)
+{
+    return {util::Coordinate{util::FloatLongitude{2.3 + index * 0.001},
+                             util::FloatLatitude{48.8}},
+            {0, 90, 180, 270},
+            {true, false, true, true},
+            0,
+            2,
+            util::guidance::LaneTuple(),
+            {},
+            {}};
+}
+
+// A leg as assembleSteps returns it: a step per turn, every one with a single intersection and
+// the names of the facade
+std::vector<RouteStep> makeSteps(const std::size_t number_of_turns)
+{
+    const auto make_step = [](const std::size_t index,
+                              const TurnInstruction instruction,
+                              const WaypointType waypoint_type) {
+        const util::StringView name = names[(index / 3) % names.size()];
+        auto intersection = makeIntersection(index);
+        if (waypoint_type != WaypointType::None)
+        {
+            intersection.bearings = {90};
+            intersection.entry = {true};
+            intersection.in = waypoint_type == WaypointType::Arrive ? 0 : intersection.NO_INDEX;
+            intersection.out = waypoint_type == WaypointType::Depart ? 0 : intersection.NO_INDEX;
+        }
+        return RouteStep{static_cast<unsigned>((index / 3) % names.size() + 1),
+                         name,
+                         "D 906",
+                         "",
+                         "",
+                         "",
+                         "",
+                         "",
+                         10.,
+                         150.,
+                         10.,
+                         TRAVEL_MODE_DRIVING,
+                         {intersection.location, 90, 90, instruction, waypoint_type, 0},
+                         index,
+                         index + 2,
+                         {intersection}};
+    };
+
+    std::vector<RouteStep> steps;
+    steps.push_back(make_step(0, TurnInstruction::NO_TURN(), WaypointType::Depart));
+    for (const auto index : util::irange<std::size_t>(1, number_of_turns + 1))
+    {
+        const TurnInstruction turns[] = {{TurnType::Turn, DirectionModifier::Right},
+                                         {TurnType::Suppressed, DirectionModifier::Straight},
+                                         {TurnType::NewName, DirectionModifier::Straight},
+                                         {TurnType::Continue, DirectionModifier::SlightLeft}};
+        steps.push_back(make_step(index, turns[index % 4], WaypointType::None));
+    }
+    auto arrive = make_step(number_of_turns + 1, TurnInstruction::NO_TURN(), WaypointType::Arrive);
+    arrive.geometry_end = arrive.geometry_begin + 1;
+    steps.push_back(std::move(arrive));
+    return steps;
+}
+
+struct Counts
+{
+    std::size_t assembly = 0;
+    std::size_t post_processing = 0;
+    std::size_t rendering = 0;
+};
+
+void benchmark(const std::size_t number_of_turns, const std::size_t iterations)
+{
+    Counts counts;
+    TIMER_START(guidance);
+    for (const auto iteration : util::irange<std::size_t>(0, iterations))
+    {
+        (void)iteration;
+        auto before = allocations;
+        auto steps = makeSteps(number_of_turns);
+        counts.assembly += allocations - before;
+
+        // the post-processing of RouteAPI
+        before = allocations;
+        steps = postProcess(std::move(steps));
+        steps = collapseTurnInstructions(std::move(steps));
+        steps = anticipateLaneChange(std::move(steps));
+        steps = buildIntersections(std::move(steps));
+        steps = suppressShortNameSegments(std::move(steps));
+        counts.post_processing += allocations - before;
+
+        before = allocations;
+        for (auto &step : steps)
+        {
+            engine::api::json::makeRouteStep(std::move(step), util::json::Null());
+        }
+        counts.rendering += allocations - before;
+    }
+    TIMER_STOP(guidance);
+
+    util::Log() << number_of_turns << " turns: " << TIMER_MSEC(guidance) / iterations
+                << "ms per leg, allocations for assembly " << counts.assembly / iterations
+                << ", post-processing " << counts.post_processing / iterations << ", rendering "
+                << counts.rendering / iterations;
+}
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    benchmark(10, 10000);
+    benchmark(100, 1000);
+    benchmark(1000, 100);
+
+    return EXIT_SUCCESS;
+}
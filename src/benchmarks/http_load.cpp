@@ -0,0 +1,677 @@
+// osrm-http-bench replays the requests of a URL log against a running osrm-routed over real
+// sockets and reports throughput, latency histograms and error rates as JSON.
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
+#include "util/version.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/asio.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <istream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+struct BenchmarkConfig
+{
+    boost::filesystem::path log_path;
+    std::string host = "127.0.0.1";
+    std::string port = "5000";
+    unsigned connections = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t requests = 0;
+    std::size_t warmup = 0;
+    bool keepalive = true;
+    bool shuffle = false;
+    std::uint32_t seed = 42;
+    std::string compression = "none";
+    boost::filesystem::path output = "-";
+};
+
+// Latencies in microseconds with a relative error below 1/SUB_BUCKETS, like HdrHistogram: all
+// values below 2 * SUB_BUCKETS are counted exactly, every larger power of two is split into
+// SUB_BUCKETS linear buckets
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram() : counts(2 * SUB_BUCKETS + MAX_EXPONENT * SUB_BUCKETS, 0) {}
+
+    void Record(const std::uint64_t value)
+    {
+        ++counts[Index(value)];
+        ++total;
+        max_value = std::max(max_value, value);
+    }
+
+    LatencyHistogram &operator+=(const LatencyHistogram &other)
+    {
+        for (std::size_t index = 0; index < counts.size(); ++index)
+            counts[index] += other.counts[index];
+        total += other.total;
+        max_value = std::max(max_value, other.max_value);
+        return *this;
+    }
+
+    std::uint64_t Count() const { return total; }
+
+    // The highest value of the bucket of the value at this fraction of all values
+    std::uint64_t Percentile(const double fraction) const
+    {
+        if (total == 0)
+            return 0;
+        const auto rank = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(total))));
+        std::uint64_t seen = 0;
+        for (std::size_t index = 0; index < counts.size(); ++index)
+        {
+            seen += counts[index];
+            if (seen >= rank)
+                return std::min(UpperBound(index), max_value);
+        }
+        return max_value;
+    }
+
+    // [[<upper bound in ms>, <count>], ...] of the buckets that were hit
+    util::json::Array ToJSON() const
+    {
+        util::json::Array buckets;
+        for (std::size_t index = 0; index < counts.size(); ++index)
+        {
+            if (counts[index] == 0)
+                continue;
+            util::json::Array bucket;
+            bucket.values.push_back(std::min(UpperBound(index), max_value) / 1000.);
+            bucket.values.push_back(static_cast<double>(counts[index]));
+            buckets.values.push_back(std::move(bucket));
+        }
+        return buckets;
+    }
+
+  private:
+    static constexpr std::uint64_t SUB_BUCKETS = 128;
+    static constexpr unsigned SUB_BUCKET_BITS = 7;
+    static constexpr unsigned MAX_EXPONENT = 64 - SUB_BUCKET_BITS - 1;
+
+    static unsigned HighestBit(std::uint64_t value)
+    {
+        unsigned bit = 0;
+        while (value >>= 1)
+            ++bit;
+        return bit;
+    }
+
+    static std::size_t Index(const std::uint64_t value)
+    {
+        if (value < 2 * SUB_BUCKETS)
+            return value;
+        // value >> shift is in [SUB_BUCKETS, 2 * SUB_BUCKETS)
+        const auto shift = HighestBit(value) - SUB_BUCKET_BITS;
+        return shift * SUB_BUCKETS + (value >> shift);
+    }
+
+    static std::uint64_t UpperBound(const std::size_t index)
+    {
+        if (index < 2 * SUB_BUCKETS)
+            return index;
+        const auto shift = index / SUB_BUCKETS - 1;
+        const auto sub_bucket = index - shift * SUB_BUCKETS;
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total = 0;
+    std::uint64_t max_value = 0;
+};
+
+constexpr std::uint64_t LatencyHistogram::SUB_BUCKETS;
+constexpr unsigned LatencyHistogram::SUB_BUCKET_BITS;
+constexpr unsigned LatencyHistogram::MAX_EXPONENT;
+
+// What the requests of one service saw
+struct ServiceReport
+{
+    LatencyHistogram latencies;
+    std::uint64_t requests = 0;
+    // answered with another status than 200
+    std::uint64_t http_errors = 0;
+    // the connection failed before the full reply was read
+    std::uint64_t connection_errors = 0;
+    std::uint64_t bytes_received = 0;
+    std::map<unsigned, std::uint64_t> statuses;
+
+    ServiceReport &operator+=(const ServiceReport &other)
+    {
+        latencies += other.latencies;
+        requests += other.requests;
+        http_errors += other.http_errors;
+        connection_errors += other.connection_errors;
+        bytes_received += other.bytes_received;
+        for (const auto &status : other.statuses)
+            statuses[status.first] += status.second;
+        return *this;
+    }
+
+    util::json::Object ToJSON(const double wall_time) const
+    {
+        const auto ms = [](const std::uint64_t us) { return us / 1000.; };
+        util::json::Object latency;
+        latency.values["p50"] = ms(latencies.Percentile(0.5));
+        latency.values["p90"] = ms(latencies.Percentile(0.9));
+        latency.values["p99"] = ms(latencies.Percentile(0.99));
+        latency.values["p999"] = ms(latencies.Percentile(0.999));
+        latency.values["max"] = ms(latencies.Percentile(1.));
+        latency.values["histogram"] = latencies.ToJSON();
+
+        util::json::Object status_counts;
+        for (const auto &status : statuses)
+            status_counts.values[std::to_string(status.first)] =
+                static_cast<double>(status.second);
+
+        const auto failed = http_errors + connection_errors;
+        util::json::Object report;
+        report.values["requests"] = static_cast<double>(requests);
+        report.values["http_errors"] = static_cast<double>(http_errors);
+        report.values["connection_errors"] = static_cast<double>(connection_errors);
+        report.values["error_rate"] = requests > 0 ? failed / static_cast<double>(requests) : 0.;
+        report.values["throughput"] = wall_time > 0 ? requests / wall_time : 0.;
+        report.values["bytes_received"] = static_cast<double>(bytes_received);
+        report.values["statuses"] = std::move(status_counts);
+        report.values["latency_ms"] = std::move(latency);
+        return report;
+    }
+};
+
+struct Request
+{
+    // the first path segment, /route/v1/... is counted as route
+    std::string service;
+    std::string target;
+};
+
+// Takes the URL of a log line. A line is either a request target like /route/v1/driving/...,
+// optionally after the method as in access logs, or a JSON object with a "url" string as in
+// .jsonl request files. Returns an empty string for lines without a URL.
+std::string parseLogLine(std::string line)
+{
+    boost::algorithm::trim(line);
+    if (line.empty() || line.front() == '#')
+        return {};
+
+    if (line.front() == '{')
+    {
+        const auto key = line.find("\"url\"");
+        if (key == std::string::npos)
+            return {};
+        const auto begin = line.find('"', line.find(':', key + 5));
+        if (begin == std::string::npos)
+            return {};
+        std::string url;
+        for (auto current = begin + 1; current < line.size() && line[current] != '"'; ++current)
+        {
+            if (line[current] == '\\' && current + 1 < line.size())
+                ++current;
+            url.push_back(line[current]);
+        }
+        line = std::move(url);
+    }
+    else if (boost::algorithm::starts_with(line, "GET "))
+    {
+        line = line.substr(4);
+        line = line.substr(0, line.find(' '));
+    }
+
+    // absolute URLs are sent to the configured server
+    const auto scheme = line.find("://");
+    if (scheme != std::string::npos)
+    {
+        const auto path = line.find('/', scheme + 3);
+        line = path == std::string::npos ? "/" : line.substr(path);
+    }
+
+    if (line.empty() || line.front() != '/')
+        return {};
+    return line;
+}
+
+std::vector<Request> readLog(const boost::filesystem::path &path)
+{
+    boost::filesystem::ifstream in(path);
+    if (!in)
+        throw util::exception("Could not open " + path.string() + " for reading" + SOURCE_REF);
+
+    std::vector<Request> requests;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        auto target = parseLogLine(line);
+        if (target.empty())
+            continue;
+        const auto end = target.find_first_of("/?", 1);
+        auto service = target.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+        requests.push_back({std::move(service), std::move(target)});
+    }
+    if (requests.empty())
+        throw util::exception(path.string() + " has no request URLs" + SOURCE_REF);
+    return requests;
+}
+
+// One HTTP/1.1 connection to the server, reopened whenever the server or the configuration
+// closes it
+class Connection
+{
+  public:
+    Connection(const BenchmarkConfig &config,
+               const std::vector<boost::asio::ip::tcp::endpoint> &endpoints)
+        : config(config), endpoints(endpoints), socket(io_service)
+    {
+    }
+
+    // Sends the request and reads the full reply, returns the status and the body size. Throws
+    // boost::system::system_error if the connection fails.
+    std::pair<unsigned, std::size_t> Send(const std::string &target)
+    {
+        if (socket.is_open())
+        {
+            // the server may have closed the idle connection, such requests are sent again on a
+            // new one
+            try
+            {
+                return Exchange(target);
+            }
+            catch (const boost::system::system_error &)
+            {
+                Reset();
+            }
+        }
+        boost::asio::connect(socket, endpoints.begin(), endpoints.end());
+        socket.set_option(boost::asio::ip::tcp::no_delay(true));
+        return Exchange(target);
+    }
+
+    void Reset()
+    {
+        boost::system::error_code ignored;
+        socket.close(ignored);
+        buffer.consume(buffer.size());
+    }
+
+  private:
+    struct Reply
+    {
+        unsigned status = 0;
+        std::size_t body_size = 0;
+        bool close = false;
+    };
+
+    std::pair<unsigned, std::size_t> Exchange(const std::string &target)
+    {
+
+        std::string request = "GET " + target + " HTTP/1.1\r\nHost: " + config.host + "\r\n";
+        if (config.compression != "none")
+            request += "Accept-Encoding: " + config.compression + "\r\n";
+        request += config.keepalive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+        boost::asio::write(socket, boost::asio::buffer(request));
+
+        const auto reply = ReadReply();
+        if (!config.keepalive || reply.close)
+        {
+            boost::system::error_code ignored;
+            socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+            Reset();
+        }
+        return {reply.status, reply.body_size};
+    }
+
+    Reply ReadReply()
+    {
+        Reply reply;
+        const auto header_size = boost::asio::read_until(socket, buffer, "\r\n\r\n");
+        std::string headers(boost::asio::buffers_begin(buffer.data()),
+                            boost::asio::buffers_begin(buffer.data()) + header_size);
+        buffer.consume(header_size);
+
+        std::istringstream lines(headers);
+        std::string line;
+        std::getline(lines, line);
+        // HTTP/1.1 200 OK
+        const auto status = line.find(' ');
+        if (status == std::string::npos)
+            throw boost::system::system_error(boost::asio::error::invalid_argument);
+        reply.status = std::strtoul(line.c_str() + status + 1, nullptr, 10);
+        reply.close = boost::algorithm::starts_with(line, "HTTP/1.0");
+
+        bool chunked = false;
+        std::size_t content_length = 0;
+        while (std::getline(lines, line))
+        {
+            const auto colon = line.find(':');
+            if (colon == std::string::npos)
+                continue;
+            auto name = boost::algorithm::to_lower_copy(line.substr(0, colon));
+            auto value = boost::algorithm::to_lower_copy(line.substr(colon + 1));
+            boost::algorithm::trim(value);
+            if (name == "content-length")
+                content_length = std::strtoull(value.c_str(), nullptr, 10);
+            else if (name == "transfer-encoding")
+                chunked = value.find("chunked") != std::string::npos;
+            else if (name == "connection")
+                reply.close = value == "close";
+        }
+
+        if (chunked)
+        {
+            for (;;)
+            {
+                const auto size_line = boost::asio::read_until(socket, buffer, "\r\n");
+                std::string size(boost::asio::buffers_begin(buffer.data()),
+                                 boost::asio::buffers_begin(buffer.data()) + size_line);
+                buffer.consume(size_line);
+                const auto chunk_size = std::strtoull(size.c_str(), nullptr, 16);
+                // the chunk and its CRLF, the last chunk has no data but a CRLF
+                Skip(chunk_size + 2);
+                reply.body_size += chunk_size;
+                if (chunk_size == 0)
+                    break;
+            }
+        }
+        else
+        {
+            Skip(content_length);
+            reply.body_size = content_length;
+        }
+        return reply;
+    }
+
+    void Skip(const std::size_t bytes)
+    {
+        if (buffer.size() < bytes)
+            boost::asio::read(
+                socket, buffer, boost::asio::transfer_exactly(bytes - buffer.size()));
+        buffer.consume(bytes);
+    }
+
+    const BenchmarkConfig &config;
+    const std::vector<boost::asio::ip::tcp::endpoint> &endpoints;
+    boost::asio::io_service io_service;
+    boost::asio::ip::tcp::socket socket;
+    boost::asio::streambuf buffer;
+};
+
+util::json::Object runBenchmark(const BenchmarkConfig &config, const std::vector<Request> &log)
+{
+    boost::asio::io_service io_service;
+    boost::asio::ip::tcp::resolver resolver(io_service);
+    const std::vector<boost::asio::ip::tcp::endpoint> endpoints(
+        resolver.resolve({config.host, config.port}), {});
+
+    // the order the requests are sent in, the log is repeated to reach the number of requests
+    const auto total = config.warmup + (config.requests > 0 ? config.requests : log.size());
+    std::vector<std::size_t> order(total);
+    for (std::size_t index = 0; index < total; ++index)
+        order[index] = index % log.size();
+    if (config.shuffle)
+        std::shuffle(order.begin(), order.end(), std::mt19937(config.seed));
+
+    std::map<std::string, std::size_t> service_ids;
+    for (const auto &request : log)
+        service_ids.emplace(request.service, service_ids.size());
+    std::vector<std::size_t> request_services(log.size());
+    for (std::size_t index = 0; index < log.size(); ++index)
+        request_services[index] = service_ids.at(log[index].service);
+
+    std::atomic<std::size_t> next_request{0};
+    std::atomic<std::size_t> warmed_up{0};
+    std::vector<std::vector<ServiceReport>> reports(
+        config.connections, std::vector<ServiceReport>(service_ids.size()));
+
+    // the measurement starts when the last warmup request is answered
+    std::atomic<std::int64_t> start_ns{0};
+    const auto now_ns = [] {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    };
+    if (config.warmup == 0)
+        start_ns = now_ns();
+
+    std::vector<std::thread> threads;
+    for (unsigned connection_id = 0; connection_id < config.connections; ++connection_id)
+    {
+        threads.emplace_back([&, connection_id] {
+            Connection connection(config, endpoints);
+            auto &connection_reports = reports[connection_id];
+            for (auto position = next_request++; position < total; position = next_request++)
+            {
+                const auto &request = log[order[position]];
+                const auto request_start = std::chrono::steady_clock::now();
+                unsigned status = 0;
+                std::size_t body_size = 0;
+                bool failed = false;
+                try
+                {
+                    std::tie(status, body_size) = connection.Send(request.target);
+                }
+                catch (const boost::system::system_error &)
+                {
+                    connection.Reset();
+                    failed = true;
+                }
+                const auto request_end = std::chrono::steady_clock::now();
+
+                if (position < config.warmup)
+                {
+                    if (++warmed_up == config.warmup)
+                        start_ns = now_ns();
+                    continue;
+                }
+
+                auto &report = connection_reports[request_services[order[position]]];
+                ++report.requests;
+                report.latencies.Record(
+                    std::chrono::duration_cast<std::chrono::microseconds>(request_end -
+                                                                          request_start)
+                        .count());
+                if (failed)
+                {
+                    ++report.connection_errors;
+                    continue;
+                }
+                ++report.statuses[status];
+                report.bytes_received += body_size;
+                if (status != 200)
+                    ++report.http_errors;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    const auto wall_time = (now_ns() - start_ns.load()) / 1e9;
+
+    ServiceReport all;
+    util::json::Object services;
+    for (const auto &service : service_ids)
+    {
+        ServiceReport merged;
+        for (const auto &connection_reports : reports)
+            merged += connection_reports[service.second];
+        all += merged;
+        services.values[service.first] = merged.ToJSON(wall_time);
+    }
+
+    util::Log() << all.requests << " requests in " << wall_time << " s, "
+                << all.requests / std::max(wall_time, 1e-9) << " requests/s, "
+                << all.http_errors + all.connection_errors << " errors, p50 "
+                << all.latencies.Percentile(0.5) / 1000. << " ms, p99 "
+                << all.latencies.Percentile(0.99) / 1000. << " ms";
+
+    auto report = all.ToJSON(wall_time);
+    report.values["wall_time"] = wall_time;
+    report.values["services"] = std::move(services);
+    return report;
+}
+
+bool parseArguments(int argc, char *argv[], BenchmarkConfig &config)
+{
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    bool no_keepalive = false;
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options()(
+        "host",
+        boost::program_options::value<std::string>(&config.host)->default_value(config.host),
+        "Host of the osrm-routed to load")(
+        "port,p",
+        boost::program_options::value<std::string>(&config.port)->default_value(config.port),
+        "Port of the osrm-routed to load")(
+        "connections,c",
+        boost::program_options::value<unsigned>(&config.connections)
+            ->default_value(config.connections),
+        "Number of connections sending requests at the same time")(
+        "requests,n",
+        boost::program_options::value<std::size_t>(&config.requests)->default_value(0),
+        "Number of measured requests, the log is repeated as often as needed. 0 sends every "
+        "request of the log once")(
+        "warmup",
+        boost::program_options::value<std::size_t>(&config.warmup)->default_value(0),
+        "Number of requests to send before measuring")(
+        "no-keepalive",
+        boost::program_options::bool_switch(&no_keepalive)->default_value(false),
+        "Open a new connection for every request")(
+        "compression",
+        boost::program_options::value<std::string>(&config.compression)->default_value("none"),
+        "Accept-Encoding of the requests: none, gzip, deflate, br or zstd")(
+        "shuffle",
+        boost::program_options::bool_switch(&config.shuffle)->default_value(false),
+        "Send the requests in random order instead of the order of the log")(
+        "seed",
+        boost::program_options::value<std::uint32_t>(&config.seed)->default_value(42),
+        "Seed of the shuffled order")(
+        "output,o",
+        boost::program_options::value<boost::filesystem::path>(&config.output)
+            ->default_value("-"),
+        "File to write the JSON report to, - for standard output");
+
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "log", boost::program_options::value<boost::filesystem::path>(&config.log_path),
+        "file with one request URL per line");
+
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("log", 1);
+
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() + " <urls.log> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    boost::program_options::variables_map option_variables;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                      .options(cmdline_options)
+                                      .positional(positional_options)
+                                      .run(),
+                                  option_variables);
+
+    if (option_variables.count("version"))
+    {
+        std::cout << OSRM_VERSION << std::endl;
+        return false;
+    }
+
+    if (option_variables.count("help") || !option_variables.count("log"))
+    {
+        std::cout << visible_options;
+        return false;
+    }
+
+    boost::program_options::notify(option_variables);
+
+    config.keepalive = !no_keepalive;
+    config.connections = std::max(1u, config.connections);
+    boost::to_lower(config.compression);
+    if (config.compression != "none" && config.compression != "gzip" &&
+        config.compression != "deflate" && config.compression != "br" &&
+        config.compression != "zstd")
+        throw util::exception("Unknown compression " + config.compression + SOURCE_REF);
+
+    return true;
+}
+}
+
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    BenchmarkConfig config;
+    if (!parseArguments(argc, argv, config))
+        return EXIT_SUCCESS;
+
+    // the report goes to standard output, so does the log
+    if (config.output == "-")
+        util::LogPolicy::GetInstance().Mute();
+
+    const auto log = readLog(config.log_path);
+    auto results = runBenchmark(config, log);
+
+    util::json::Object report;
+    report.values["log"] = config.log_path.string();
+    report.values["server"] = config.host + ":" + config.port;
+    report.values["connections"] = static_cast<double>(config.connections);
+    if (config.keepalive)
+        report.values["keepalive"] = util::json::True();
+    else
+        report.values["keepalive"] = util::json::False();
+    report.values["compression"] = config.compression;
+    report.values["warmup"] = static_cast<double>(config.warmup);
+    report.values["results"] = std::move(results);
+
+    if (config.output == "-")
+    {
+        util::json::render(std::cout, report);
+        std::cout << std::endl;
+    }
+    else
+    {
+        boost::filesystem::ofstream out(config.output);
+        if (!out)
+            throw util::exception("Could not open " + config.output.string() + " for writing" +
+                                  SOURCE_REF);
+        util::json::render(out, report);
+        out << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    util::LogPolicy::GetInstance().Unmute();
+    util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,120 @@
+#include "util/cast.hpp"
+#include "util/integer_range.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+// Renders numbers the way ArrayRenderer did before append_with_precision
+void renderWithStream(std::vector<char> &out, const std::vector<double> &numbers)
+{
+    for (const auto number : numbers)
+    {
+        const std::string number_string = util::cast::to_string_with_precision(number);
+        out.insert(out.end(), number_string.begin(), number_string.end());
+        out.push_back(',');
+    }
+}
+
+void renderWithAppend(std::vector<char> &out, const std::vector<double> &numbers)
+{
+    for (const auto number : numbers)
+    {
+        util::cast::append_with_precision(out, number);
+        out.push_back(',');
+    }
+}
+
+bool benchmark(const std::string &name, const std::vector<double> &numbers)
+{
+    std::vector<char> stream_output;
+    TIMER_START(stream);
+    renderWithStream(stream_output, numbers);
+    TIMER_STOP(stream);
+
+    std::vector<char> append_output;
+    TIMER_START(append);
+    renderWithAppend(append_output, numbers);
+    TIMER_STOP(append);
+
+    if (stream_output != append_output)
+        return false;
+
+    util::Log() << name << " (" << numbers.size() << " numbers): stringstream "
+                << TIMER_MSEC(stream) << "ms, append_with_precision " << TIMER_MSEC(append)
+                << "ms";
+    return true;
+}
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    std::mt19937 generator(1337);
+    const std::size_t count = 1000000;
+
+    // table durations are deci-seconds
+    std::uniform_int_distribution<int> duration(0, 36000 * 10);
+    std::vector<double> durations;
+    for (auto index : util::irange<std::size_t>(0, count))
+    {
+        (void)index;
+        durations.push_back(duration(generator) / 10.);
+    }
+
+    // coordinates have six digits after the dot, like util::toFloating
+    std::uniform_int_distribution<int> fixed_coordinate(-180000000, 180000000);
+    std::vector<double> coordinates;
+    for (auto index : util::irange<std::size_t>(0, count))
+    {
+        (void)index;
+        coordinates.push_back(fixed_coordinate(generator) / 1e6);
+    }
+
+    // distances and weights with arbitrary fractions
+    std::uniform_real_distribution<double> distance(0, 100000);
+    std::vector<double> distances;
+    for (auto index : util::irange<std::size_t>(0, count))
+    {
+        (void)index;
+        distances.push_back(distance(generator));
+    }
+
+    if (!benchmark("durations", durations) || !benchmark("coordinates", coordinates) ||
+        !benchmark("distances", distances))
+    {
+        util::Log(logERROR) << "Number formatting differs";
+        return EXIT_FAILURE;
+    }
+
+    // a whole 1000x1000 table response
+    util::json::Array rows;
+    for (auto row : util::irange<std::size_t>(0, 1000))
+    {
+        util::json::Array columns;
+        columns.values.assign(durations.begin() + row * 1000, durations.begin() + (row + 1) * 1000);
+        rows.values.push_back(std::move(columns));
+    }
+    util::json::Object table;
+    table.values["durations"] = std::move(rows);
+
+    std::vector<char> rendered;
+    TIMER_START(table);
+    util::json::render(rendered, table);
+    TIMER_STOP(table);
+    util::Log() << "table (1000x1000): " << TIMER_MSEC(table) << "ms, " << rendered.size()
+                << " bytes";
+
+    return EXIT_SUCCESS;
+}
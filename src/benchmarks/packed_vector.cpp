@@ -62,6 +62,88 @@ auto measure_random_access()
     return Measurement{TIMER_MSEC(write), TIMER_MSEC(read)};
 }
 
+struct BulkMeasurement
+{
+    double element_write_ms;
+    double pack_ms;
+    double element_read_ms;
+    double unpack_ms;
+    double unpacked_ms;
+};
+
+template <std::size_t num_rounds, std::size_t num_entries, typename T, std::size_t Bits>
+auto measure_bulk_access()
+{
+    const std::uint64_t mask = (1ULL << Bits) - 1;
+    std::vector<T> values(num_entries);
+    std::mt19937_64 g(1337);
+    std::generate(values.begin(), values.end(), [&] { return T{g() & mask}; });
+
+    util::PackedVector<T, Bits> vector(num_entries);
+
+    TIMER_START(element_write);
+    for (auto round : util::irange<std::size_t>(0, num_rounds))
+    {
+        dont_optimize_away(round);
+        std::copy(values.begin(), values.end(), vector.begin());
+    }
+    TIMER_STOP(element_write);
+
+    TIMER_START(pack);
+    for (auto round : util::irange<std::size_t>(0, num_rounds))
+    {
+        dont_optimize_away(round);
+        vector.pack(0, values.begin(), values.end());
+    }
+    TIMER_STOP(pack);
+
+    std::uint64_t sum = 0;
+    TIMER_START(element_read);
+    for (auto round : util::irange<std::size_t>(0, num_rounds))
+    {
+        sum = round;
+        for (const T value : vector)
+            sum += static_cast<std::uint64_t>(value);
+        dont_optimize_away(sum);
+    }
+    TIMER_STOP(element_read);
+
+    std::vector<T> unpacked(num_entries);
+    TIMER_START(unpack);
+    for (auto round : util::irange<std::size_t>(0, num_rounds))
+    {
+        dont_optimize_away(round);
+        vector.unpack(0, num_entries, unpacked.begin());
+        dont_optimize_away(unpacked.back());
+    }
+    TIMER_STOP(unpack);
+
+    TIMER_START(unpacked);
+    for (auto round : util::irange<std::size_t>(0, num_rounds))
+    {
+        sum = round;
+        for (const auto value : vector.unpacked(0, num_entries))
+            sum += static_cast<std::uint64_t>(value);
+        dont_optimize_away(sum);
+    }
+    TIMER_STOP(unpacked);
+
+    return BulkMeasurement{TIMER_MSEC(element_write),
+                           TIMER_MSEC(pack),
+                           TIMER_MSEC(element_read),
+                           TIMER_MSEC(unpack),
+                           TIMER_MSEC(unpacked)};
+}
+
+void log_bulk_measurement(const std::string &name, const BulkMeasurement &result)
+{
+    util::Log() << name << " sequential write: element-wise " << result.element_write_ms
+                << " ms, pack " << result.pack_ms << " ms.";
+    util::Log() << name << " sequential read: element-wise " << result.element_read_ms
+                << " ms, unpack " << result.unpack_ms << " ms, unpacked range "
+                << result.unpacked_ms << " ms.";
+}
+
 int main(int, char **)
 {
     util::LogPolicy::GetInstance().Unmute();
@@ -78,4 +160,8 @@ int main(int, char **)
     util::Log() << "random read: std::vector " << result_plain.random_read_ms
                 << " ms, util::packed_vector " << result_packed.random_read_ms << " ms. "
                 << read_slowdown;
+
+    log_bulk_measurement("22 bit weights",
+                         measure_bulk_access<1000, 1000000, std::uint32_t, 22>());
+    log_bulk_measurement("33 bit OSM ids", measure_bulk_access<1000, 1000000, OSMNodeID, 33>());
 }
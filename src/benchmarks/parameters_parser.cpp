@@ -0,0 +1,136 @@
+#include "server/api/parameters_parser.hpp"
+
+#include "server/api/match_parameter_grammar.hpp"
+#include "server/api/route_parameters_grammar.hpp"
+#include "server/api/table_parameter_grammar.hpp"
+
+#include "engine/api/match_parameters.hpp"
+#include "engine/api/route_parameters.hpp"
+#include "engine/api/table_parameters.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace osrm;
+
+namespace
+{
+
+// The spirit based implementation parseParameters used before the hand-written parser
+template <typename ParameterT, typename GrammarT>
+boost::optional<ParameterT> parseWithGrammar(std::string &query)
+{
+    static const GrammarT grammar;
+
+    auto iter = query.begin();
+    ParameterT parameters;
+    try
+    {
+        const auto ok = boost::spirit::qi::parse(
+            iter, query.end(), grammar(boost::phoenix::ref(parameters)));
+        if (ok && iter == query.end())
+            return std::move(parameters);
+    }
+    catch (const boost::spirit::qi::expectation_failure<std::string::iterator> &)
+    {
+    }
+    return boost::none;
+}
+
+std::string makeCoordinates(std::mt19937 &generator, const std::size_t count)
+{
+    std::uniform_real_distribution<double> lon(7.40, 7.44);
+    std::uniform_real_distribution<double> lat(43.72, 43.75);
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(6);
+    for (auto index : util::irange<std::size_t>(0, count))
+    {
+        out << (index == 0 ? "" : ";") << lon(generator) << "," << lat(generator);
+    }
+    return out.str();
+}
+
+std::string makeList(const std::size_t count, const std::string &item)
+{
+    std::string list;
+    for (auto index : util::irange<std::size_t>(0, count))
+    {
+        list += (index == 0 ? "" : ";") + item;
+    }
+    return list;
+}
+
+template <typename ParameterT, typename GrammarT>
+bool benchmark(const std::string &name, const std::string &query, const int num_rounds)
+{
+    std::size_t spirit_coordinates = 0;
+    TIMER_START(spirit);
+    for (auto round : util::irange(0, num_rounds))
+    {
+        (void)round;
+        auto copy = query;
+        const auto parameters = parseWithGrammar<ParameterT, GrammarT>(copy);
+        if (!parameters)
+            return false;
+        spirit_coordinates += parameters->coordinates.size();
+    }
+    TIMER_STOP(spirit);
+
+    std::size_t handwritten_coordinates = 0;
+    TIMER_START(handwritten);
+    for (auto round : util::irange(0, num_rounds))
+    {
+        (void)round;
+        const auto parameters = server::api::parseParameters<ParameterT>(query);
+        if (!parameters)
+            return false;
+        handwritten_coordinates += parameters->coordinates.size();
+    }
+    TIMER_STOP(handwritten);
+
+    if (spirit_coordinates != handwritten_coordinates)
+        return false;
+
+    util::Log() << name << " (" << query.size() << " bytes): spirit "
+                << TIMER_USEC(spirit) / num_rounds << "us, hand-written "
+                << TIMER_USEC(handwritten) / num_rounds << "us per query";
+    return true;
+}
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    std::mt19937 generator(1337);
+    const int num_rounds = 100;
+
+    const auto route_query = makeCoordinates(generator, 25) +
+                             "?steps=true&overview=full&annotations=duration,distance,nodes"
+                             "&bearings=" +
+                             makeList(25, "90,20") + "&radiuses=" + makeList(25, "20.5");
+    const auto table_query = makeCoordinates(generator, 2000) + "?sources=" +
+                             makeList(1000, "42") + "&radiuses=" + makeList(2000, "unlimited");
+    const auto match_query = makeCoordinates(generator, 2000) + "?timestamps=" +
+                             makeList(2000, "1424684612") + "&radiuses=" + makeList(2000, "5.0");
+
+    using namespace server::api;
+    using namespace engine::api;
+    if (!benchmark<RouteParameters, RouteParametersGrammar<>>("route", route_query, num_rounds) ||
+        !benchmark<TableParameters, TableParametersGrammar<>>("table", table_query, num_rounds) ||
+        !benchmark<MatchParameters, MatchParametersGrammar<>>("match", match_query, num_rounds))
+    {
+        util::Log(logERROR) << "Parsers disagree";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
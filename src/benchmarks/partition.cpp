@@ -0,0 +1,145 @@
+#include "partition/bisection_graph.hpp"
+#include "partition/graph_view.hpp"
+#include "partition/inertial_flow.hpp"
+
+#include "util/coordinate.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <tbb/task_scheduler_init.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+struct InputEdge
+{
+    NodeID source;
+    NodeID target;
+
+    bool operator<(const InputEdge &other) const
+    {
+        return std::tie(source, target) < std::tie(other.source, other.target);
+    }
+};
+
+// Grid with jittered coordinates, a part of the grid edges removed and a few shortcuts between
+// nearby nodes, so the cuts are not all straight lines through the grid
+partition::BisectionGraph makeGraph(const std::size_t side)
+{
+    std::mt19937 generator(1337);
+    std::uniform_real_distribution<double> jitter(-0.4, 0.4);
+    std::uniform_real_distribution<double> probability(0, 1);
+    std::uniform_int_distribution<int> offset(-3, 3);
+
+    std::vector<util::Coordinate> coordinates;
+    for (std::size_t row = 0; row < side; ++row)
+    {
+        for (std::size_t column = 0; column < side; ++column)
+        {
+            coordinates.push_back(
+                util::Coordinate{util::FloatLongitude{(column + jitter(generator)) * 0.001},
+                                 util::FloatLatitude{(row + jitter(generator)) * 0.001}});
+        }
+    }
+
+    std::vector<InputEdge> edges;
+    const auto add_edge = [&](const NodeID from, const NodeID to) {
+        edges.push_back(InputEdge{from, to});
+        edges.push_back(InputEdge{to, from});
+    };
+    for (std::size_t row = 0; row < side; ++row)
+    {
+        for (std::size_t column = 0; column < side; ++column)
+        {
+            const NodeID node = row * side + column;
+            if (column + 1 < side && probability(generator) < 0.9)
+                add_edge(node, node + 1);
+            if (row + 1 < side && probability(generator) < 0.9)
+                add_edge(node, node + side);
+            if (probability(generator) < 0.05)
+            {
+                const auto other_row = static_cast<int>(row) + offset(generator);
+                const auto other_column = static_cast<int>(column) + offset(generator);
+                if (other_row >= 0 && other_row < static_cast<int>(side) &&
+                    other_column >= 0 && other_column < static_cast<int>(side))
+                {
+                    const NodeID other = other_row * side + other_column;
+                    if (other != node)
+                        add_edge(node, other);
+                }
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end(),
+                            [](const InputEdge &lhs, const InputEdge &rhs) {
+                                return lhs.source == rhs.source && lhs.target == rhs.target;
+                            }),
+                edges.end());
+
+    return partition::makeBisectionGraph(coordinates,
+                                         partition::adaptToBisectionEdge(std::move(edges)));
+}
+}
+
+// Times the inertial flow bisection of a grid like graph with both max-flow algorithms and
+// compares the size and the balance of the cuts they find
+int main(int argc, const char *argv[]) try
+{
+    const std::size_t side = argc > 1 ? std::stoul(argv[1]) : 300;
+    const std::size_t num_slopes = argc > 2 ? std::stoul(argv[2]) : 10;
+    const int num_threads = argc > 3 ? std::stoi(argv[3]) : 1;
+    const std::size_t num_runs = 3;
+    tbb::task_scheduler_init init(num_threads);
+
+    const auto graph = makeGraph(side);
+    const partition::GraphView view(graph);
+    std::cout << "Graph of " << graph.NumberOfNodes() << " nodes, " << num_slopes << " slopes, "
+              << num_threads << " threads" << std::endl;
+
+    using partition::MaxFlowAlgorithm;
+    const auto bisect = [&](const MaxFlowAlgorithm max_flow, const std::string &name) {
+        partition::DinicMaxFlow::MinCut cut;
+        TIMER_START(bisect);
+        for (std::size_t run = 0; run < num_runs; ++run)
+        {
+            cut = partition::computeInertialFlowCut(view, num_slopes, 1.2, 0.25, max_flow);
+        }
+        TIMER_STOP(bisect);
+
+        const auto smaller_side =
+            std::min(cut.num_nodes_source, view.NumberOfNodes() - cut.num_nodes_source);
+        std::cout << name << ": " << TIMER_MSEC(bisect) / num_runs << "ms per bisection, "
+                  << cut.num_edges << " cut edges, "
+                  << smaller_side / static_cast<double>(view.NumberOfNodes())
+                  << " nodes on the smaller side" << std::endl;
+        return cut;
+    };
+
+    const auto dinic = bisect(MaxFlowAlgorithm::Dinic, "dinic");
+    const auto push_relabel = bisect(MaxFlowAlgorithm::PushRelabel, "push-relabel");
+
+    // both find a minimum cut of every slope, but the sides of the cuts and with them the choice
+    // of the best slope may differ
+    if (dinic.num_edges != push_relabel.num_edges)
+    {
+        std::cout << "the cuts differ in size" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
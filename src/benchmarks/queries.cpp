@@ -0,0 +1,755 @@
+// osrm-bench replays generated workloads of the route, table, match, trip and nearest services
+// against one loaded dataset and reports their throughput and latency as JSON.
+
+#include "engine/search_statistics.hpp"
+#include "extractor/files.hpp"
+#include "extractor/node_based_edge.hpp"
+#include "extractor/packed_osm_ids.hpp"
+#include "storage/io.hpp"
+#include "util/allocation_statistics.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/graph_loader.hpp"
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
+#include "util/perf_counters.hpp"
+#include "util/prefetch.hpp"
+#include "util/query_heap.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+#include "util/version.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/match_parameters.hpp"
+#include "osrm/nearest_parameters.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/route_parameters.hpp"
+#include "osrm/status.hpp"
+#include "osrm/table_parameters.hpp"
+#include "osrm/trip_parameters.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/function_output_iterator.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+struct BenchmarkConfig
+{
+    boost::filesystem::path base_path;
+    std::string algorithm = "ch";
+    bool use_shared_memory = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t queries = 1000;
+    std::uint32_t seed = 42;
+    std::vector<std::string> workloads;
+    std::vector<std::size_t> table_sizes;
+    std::size_t trace_length = 50;
+    double trace_interval = 50.;
+    double trace_noise = 5.;
+    std::size_t trip_size = 10;
+    bool perf_counters = false;
+    boost::filesystem::path output = "-";
+};
+
+EngineConfig::Algorithm stringToAlgorithm(std::string algorithm)
+{
+    boost::to_lower(algorithm);
+
+    if (algorithm == "ch")
+        return EngineConfig::Algorithm::CH;
+    if (algorithm == "corech")
+        return EngineConfig::Algorithm::CoreCH;
+    if (algorithm == "mld")
+        return EngineConfig::Algorithm::MLD;
+    if (algorithm == "cch")
+        return EngineConfig::Algorithm::CCH;
+    throw util::exception("Unknown algorithm " + algorithm + SOURCE_REF);
+}
+
+// The queries of a workload, run(i) answers query i. Runs are timed one by one.
+struct Workload
+{
+    std::string name;
+    // describes the generated queries in the report
+    util::json::Object parameters;
+    std::size_t size;
+    std::function<Status(const std::size_t)> run;
+};
+
+// Draws the coordinates of queries from the nodes of the node based graph, they lie on the road
+// network and are spread like the roads are
+class CoordinateSampler
+{
+  public:
+    CoordinateSampler(std::vector<util::Coordinate> coordinates_, std::uint32_t seed)
+        : coordinates(std::move(coordinates_)), generator(seed),
+          node(0, coordinates.empty() ? 0 : coordinates.size() - 1)
+    {
+        if (coordinates.empty())
+            throw util::exception("The dataset has no nodes to sample queries from" +
+                                  SOURCE_REF);
+    }
+
+    util::Coordinate Random() { return coordinates[node(generator)]; }
+
+    // Moves a coordinate by a gaussian offset with the given deviation in meters
+    util::Coordinate Jitter(const util::Coordinate coordinate, const double deviation)
+    {
+        std::normal_distribution<double> offset(0., deviation);
+        const auto lat = static_cast<double>(util::toFloating(coordinate.lat));
+        const auto lon = static_cast<double>(util::toFloating(coordinate.lon));
+        const auto lat_offset = offset(generator) / METERS_PER_DEGREE;
+        const auto lon_offset =
+            offset(generator) /
+            (METERS_PER_DEGREE * std::cos(util::coordinate_calculation::detail::degToRad(lat)));
+        return util::Coordinate(util::FloatLongitude{lon + lon_offset},
+                                util::FloatLatitude{lat + lat_offset});
+    }
+
+    // The count nodes closest to a random node among a sample of the nodes, the sample keeps
+    // the clusters of big datasets about as dense as the ones of small datasets
+    std::vector<util::Coordinate> Cluster(const std::size_t count)
+    {
+        const auto sample_size = std::min(coordinates.size(), CLUSTER_SAMPLE_SIZE);
+        std::vector<util::Coordinate> sample(sample_size);
+        std::generate(sample.begin(), sample.end(), [this] { return Random(); });
+
+        const auto center = Random();
+        const auto size = std::min(count, sample.size());
+        std::nth_element(sample.begin(),
+                         sample.begin() + (size - 1),
+                         sample.end(),
+                         [center](const auto lhs, const auto rhs) {
+                             return util::coordinate_calculation::squaredEuclideanDistance(
+                                        center, lhs) <
+                                    util::coordinate_calculation::squaredEuclideanDistance(
+                                        center, rhs);
+                         });
+        sample.resize(size);
+        return sample;
+    }
+
+  private:
+    static constexpr double METERS_PER_DEGREE = 111320.;
+    static constexpr std::size_t CLUSTER_SAMPLE_SIZE = 100000;
+
+    std::vector<util::Coordinate> coordinates;
+    std::mt19937 generator;
+    std::uniform_int_distribution<std::size_t> node;
+};
+
+constexpr double CoordinateSampler::METERS_PER_DEGREE;
+constexpr std::size_t CoordinateSampler::CLUSTER_SAMPLE_SIZE;
+
+util::json::Array &getArray(util::json::Object &object, const std::string &key)
+{
+    return object.values.at(key).get<util::json::Array>();
+}
+
+double percentile(const std::vector<double> &sorted, const double fraction)
+{
+    if (sorted.empty())
+        return 0.;
+    const auto index = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, index == 0 ? 0 : index - 1)];
+}
+
+util::json::Object
+runWorkload(const Workload &workload, const unsigned num_threads, const bool perf_counters)
+{
+    std::vector<double> latencies(workload.size);
+    std::atomic<std::size_t> next_query{0};
+    std::atomic<std::size_t> errors{0};
+    std::atomic<std::uint64_t> settled_nodes{0};
+    std::atomic<std::uint64_t> relaxed_edges{0};
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> allocated_bytes{0};
+    // tells which events every thread can count
+    const auto counters = perf_counters ? std::make_unique<util::PerfCounters>() : nullptr;
+    std::mutex counted_mutex;
+    util::PerfCounterValues counted;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned thread = 0; thread < num_threads; ++thread)
+    {
+        threads.emplace_back([&] {
+            const auto before = engine::GetThreadSearchStatistics();
+            const auto allocated_before = util::GetThreadAllocationStatistics();
+            const auto thread_counters =
+                perf_counters ? std::make_unique<util::PerfCounters>() : nullptr;
+            const auto counted_before =
+                thread_counters ? thread_counters->Read() : util::PerfCounterValues{};
+            for (auto query = next_query++; query < workload.size; query = next_query++)
+            {
+                const auto query_start = std::chrono::steady_clock::now();
+                const auto status = workload.run(query);
+                const auto query_end = std::chrono::steady_clock::now();
+                latencies[query] =
+                    std::chrono::duration<double, std::milli>(query_end - query_start).count();
+                if (status != Status::Ok)
+                    ++errors;
+            }
+            const auto searched = engine::GetThreadSearchStatistics() - before;
+            settled_nodes += searched.settled_nodes;
+            relaxed_edges += searched.relaxed_edges;
+            const auto allocated = util::GetThreadAllocationStatistics() - allocated_before;
+            allocations += allocated.allocations;
+            allocated_bytes += allocated.bytes;
+            if (thread_counters)
+            {
+                const auto thread_counted = thread_counters->Read() - counted_before;
+                std::lock_guard<std::mutex> lock(counted_mutex);
+                counted += thread_counted;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    const auto wall_time =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto mean =
+        latencies.empty()
+            ? 0.
+            : std::accumulate(latencies.begin(), latencies.end(), 0.) / latencies.size();
+
+    util::json::Object latency;
+    latency.values["mean"] = mean;
+    latency.values["p50"] = percentile(latencies, 0.5);
+    latency.values["p90"] = percentile(latencies, 0.9);
+    latency.values["p99"] = percentile(latencies, 0.99);
+    latency.values["max"] = latencies.empty() ? 0. : latencies.back();
+
+    // per query, searches on the worker threads of the engine are not counted
+    const auto queries = static_cast<double>(std::max<std::size_t>(1, workload.size));
+    util::json::Object search;
+    search.values["settled_nodes"] = settled_nodes.load() / queries;
+    search.values["relaxed_edges"] = relaxed_edges.load() / queries;
+
+    util::json::Object report;
+    report.values["name"] = workload.name;
+    report.values["parameters"] = workload.parameters;
+    report.values["queries"] = static_cast<double>(workload.size);
+    report.values["errors"] = static_cast<double>(errors.load());
+    report.values["wall_time"] = wall_time;
+    report.values["throughput"] = wall_time > 0 ? workload.size / wall_time : 0.;
+    report.values["latency_ms"] = std::move(latency);
+    report.values["search"] = std::move(search);
+    // per query, like the search statistics only of the threads sending the queries
+    if (util::allocation_statistics_enabled)
+    {
+        util::json::Object allocation;
+        allocation.values["allocations"] = allocations.load() / queries;
+        allocation.values["bytes"] = allocated_bytes.load() / queries;
+        report.values["allocation"] = std::move(allocation);
+    }
+    // per query, of the threads sending the queries as well
+    if (counters)
+        report.values["perf"] = counters->ToJSON(counted, queries);
+
+    std::ostringstream parameters;
+    util::json::render(parameters, workload.parameters);
+    util::Log() << workload.name << " " << parameters.str() << ": " << workload.size
+                << " queries, " << errors.load() << " errors, "
+                << workload.size / std::max(wall_time, 1e-9) << " queries/s, p50 "
+                << percentile(latencies, 0.5) << " ms, p99 " << percentile(latencies, 0.99)
+                << " ms, " << settled_nodes.load() / queries << " settled nodes";
+
+    return report;
+}
+
+std::vector<Workload> nearestWorkloads(const OSRM &osrm,
+                                       CoordinateSampler &sampler,
+                                       const BenchmarkConfig &config)
+{
+    std::vector<NearestParameters> queries(config.queries);
+    for (auto &parameters : queries)
+        parameters.coordinates.push_back(sampler.Jitter(sampler.Random(), 25.));
+
+    auto size = queries.size();
+    return {Workload{"nearest", {}, size, [&osrm, queries = std::move(queries)](const auto index) {
+                         util::json::Object result;
+                         return osrm.Nearest(queries[index], result);
+                     }}};
+}
+
+struct RankEdgeData
+{
+    EdgeWeight weight;
+};
+using RankGraph = util::StaticGraph<RankEdgeData>;
+
+// The node based graph of the .osrm file, without turn restrictions and turn penalties
+RankGraph loadRankGraph(const boost::filesystem::path &path,
+                        std::vector<util::Coordinate> &coordinates)
+{
+    storage::io::FileReader file_reader(path, storage::io::FileReader::VerifyFingerprint);
+
+    auto nop = boost::make_function_output_iterator([](auto) {});
+    extractor::PackedOSMIDs osm_node_ids;
+    const auto number_of_nodes =
+        util::loadNodesFromFile(file_reader, nop, nop, coordinates, osm_node_ids);
+
+    std::vector<extractor::NodeBasedEdge> edge_list;
+    util::loadEdgesFromFile(file_reader, edge_list);
+
+    std::vector<util::static_graph_details::SortableEdgeWithData<RankEdgeData>> edges;
+    for (const auto &edge : edge_list)
+    {
+        if (edge.source == edge.target)
+            continue;
+        if (edge.forward)
+            edges.emplace_back(edge.source, edge.target, edge.weight);
+        if (edge.backward)
+            edges.emplace_back(edge.target, edge.source, edge.weight);
+    }
+    std::sort(edges.begin(), edges.end());
+
+    return RankGraph(number_of_nodes, edges);
+}
+
+// Pairs by their Dijkstra rank: a plain Dijkstra from a random source settles the nodes in the
+// order of their weight from it, the target of rank 2^k is the 2^k-th settled node. One workload
+// is generated for every power of two, so each query of a workload searches a comparable part of
+// the network no matter how dense it is.
+std::vector<Workload> routeWorkloads(const OSRM &osrm,
+                                     const boost::filesystem::path &graph_path,
+                                     const BenchmarkConfig &config)
+{
+    std::vector<util::Coordinate> coordinates;
+    const auto graph = loadRankGraph(graph_path, coordinates);
+    const auto num_nodes = graph.GetNumberOfNodes();
+    if (num_nodes == 0)
+        throw util::exception("The dataset has no nodes to route between" + SOURCE_REF);
+
+    std::mt19937 generator(config.seed);
+    std::uniform_int_distribution<NodeID> node(0, num_nodes - 1);
+    std::vector<NodeID> sources(config.queries);
+    std::generate(sources.begin(), sources.end(), [&] { return node(generator); });
+
+    // targets of every source by the base 2 logarithm of their rank
+    std::vector<std::vector<NodeID>> targets(sources.size());
+    std::atomic<std::size_t> next_source{0};
+    std::vector<std::thread> threads;
+    for (unsigned thread = 0; thread < config.threads; ++thread)
+    {
+        threads.emplace_back([&] {
+            struct RankHeapData
+            {
+            };
+            util::QueryHeap<NodeID,
+                            NodeID,
+                            EdgeWeight,
+                            RankHeapData,
+                            util::ArrayStorage<NodeID, NodeID>>
+                heap(num_nodes);
+
+            for (auto index = next_source++; index < sources.size(); index = next_source++)
+            {
+                heap.Clear();
+                heap.Insert(sources[index], 0, {});
+                std::size_t settled = 0;
+                std::size_t next_rank = 1;
+                while (!heap.Empty())
+                {
+                    const auto weight = heap.MinKey();
+                    const auto settled_node = heap.DeleteMin();
+                    if (++settled == next_rank)
+                    {
+                        targets[index].push_back(settled_node);
+                        next_rank *= 2;
+                    }
+
+                    for (const auto edge : graph.GetAdjacentEdgeRange(settled_node))
+                    {
+                        const auto target = graph.GetTarget(edge);
+                        const auto target_weight = weight + graph.GetEdgeData(edge).weight;
+                        if (!heap.WasInserted(target))
+                            heap.Insert(target, target_weight, {});
+                        else if (!heap.WasRemoved(target) && target_weight < heap.GetKey(target))
+                            heap.DecreaseKey(target, target_weight);
+                    }
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    std::vector<std::vector<RouteParameters>> queries_by_rank;
+    for (std::size_t index = 0; index < sources.size(); ++index)
+    {
+        // the source itself has rank 1
+        for (std::size_t rank = 1; rank < targets[index].size(); ++rank)
+        {
+            if (queries_by_rank.size() <= rank)
+                queries_by_rank.resize(rank + 1);
+
+            RouteParameters route;
+            route.overview = RouteParameters::OverviewType::False;
+            route.coordinates = {coordinates[sources[index]], coordinates[targets[index][rank]]};
+            queries_by_rank[rank].push_back(std::move(route));
+        }
+    }
+
+    std::vector<Workload> workloads;
+    for (std::size_t rank = 1; rank < queries_by_rank.size(); ++rank)
+    {
+        util::json::Object parameters;
+        parameters.values["dijkstra_rank"] = std::pow(2., rank);
+        auto size = queries_by_rank[rank].size();
+        workloads.push_back(Workload{
+            "route",
+            std::move(parameters),
+            size,
+            [&osrm, queries = std::move(queries_by_rank[rank])](const auto index) {
+                util::json::Object result;
+                return osrm.Route(queries[index], result);
+            }});
+    }
+    return workloads;
+}
+
+std::vector<Workload> tableWorkloads(const OSRM &osrm,
+                                     CoordinateSampler &sampler,
+                                     const BenchmarkConfig &config)
+{
+    std::vector<Workload> workloads;
+    for (const auto table_size : config.table_sizes)
+    {
+        std::vector<TableParameters> queries(config.queries);
+        for (auto &parameters : queries)
+            parameters.coordinates = sampler.Cluster(table_size);
+
+        util::json::Object parameters;
+        parameters.values["size"] = static_cast<double>(table_size);
+        auto size = queries.size();
+        workloads.push_back(
+            Workload{"table",
+                     std::move(parameters),
+                     size,
+                     [&osrm, queries = std::move(queries)](const auto index) {
+                         util::json::Object result;
+                         return osrm.Table(queries[index], result);
+                     }});
+    }
+    return workloads;
+}
+
+// Traces along routes between nearby nodes: points every trace_interval meters of the route
+// geometry, moved by gaussian noise and a second apart per 10 meters
+std::vector<Workload> matchWorkloads(const OSRM &osrm,
+                                     CoordinateSampler &sampler,
+                                     const BenchmarkConfig &config)
+{
+    const auto max_tries = 10 * config.queries;
+    std::vector<MatchParameters> queries;
+    for (std::size_t tries = 0; tries < max_tries && queries.size() < config.queries; ++tries)
+    {
+        RouteParameters route;
+        route.overview = RouteParameters::OverviewType::Full;
+        route.geometries = RouteParameters::GeometriesType::GeoJSON;
+        route.coordinates = sampler.Cluster(100);
+        route.coordinates = {route.coordinates.front(), route.coordinates.back()};
+
+        util::json::Object result;
+        if (osrm.Route(route, result) != Status::Ok)
+            continue;
+
+        auto &geometry = getArray(result, "routes")
+                             .values.front()
+                             .get<util::json::Object>()
+                             .values.at("geometry")
+                             .get<util::json::Object>();
+        std::vector<util::Coordinate> line;
+        for (const auto &point : getArray(geometry, "coordinates").values)
+        {
+            const auto &lon_lat = point.get<util::json::Array>().values;
+            line.push_back(
+                util::Coordinate(util::FloatLongitude{lon_lat[0].get<util::json::Number>().value},
+                                 util::FloatLatitude{lon_lat[1].get<util::json::Number>().value}));
+        }
+
+        MatchParameters match;
+        match.overview = RouteParameters::OverviewType::False;
+        double position = 0.;
+        for (std::size_t segment = 0; segment + 1 < line.size(); ++segment)
+        {
+            const auto length =
+                util::coordinate_calculation::haversineDistance(line[segment], line[segment + 1]);
+            for (; position <= length && match.coordinates.size() < config.trace_length;
+                 position += config.trace_interval)
+            {
+                const auto point = util::coordinate_calculation::interpolateLinear(
+                    length > 0 ? position / length : 0., line[segment], line[segment + 1]);
+                match.coordinates.push_back(sampler.Jitter(point, config.trace_noise));
+                const auto seconds = static_cast<unsigned>(std::ceil(config.trace_interval / 10.));
+                match.timestamps.push_back(
+                    match.timestamps.empty() ? 0 : match.timestamps.back() + seconds);
+            }
+            position -= length;
+        }
+
+        if (match.coordinates.size() >= 2)
+            queries.push_back(std::move(match));
+    }
+
+    util::json::Object parameters;
+    parameters.values["trace_length"] = static_cast<double>(config.trace_length);
+    parameters.values["interval"] = config.trace_interval;
+    parameters.values["noise"] = config.trace_noise;
+    auto size = queries.size();
+    return {Workload{"match",
+                     std::move(parameters),
+                     size,
+                     [&osrm, queries = std::move(queries)](const auto index) {
+                         util::json::Object result;
+                         return osrm.Match(queries[index], result);
+                     }}};
+}
+
+std::vector<Workload> tripWorkloads(const OSRM &osrm,
+                                    CoordinateSampler &sampler,
+                                    const BenchmarkConfig &config)
+{
+    std::vector<TripParameters> queries(config.queries);
+    for (auto &parameters : queries)
+    {
+        parameters.overview = RouteParameters::OverviewType::False;
+        parameters.coordinates = sampler.Cluster(config.trip_size);
+    }
+
+    util::json::Object parameters;
+    parameters.values["size"] = static_cast<double>(config.trip_size);
+    auto size = queries.size();
+    return {Workload{"trip",
+                     std::move(parameters),
+                     size,
+                     [&osrm, queries = std::move(queries)](const auto index) {
+                         util::json::Object result;
+                         return osrm.Trip(queries[index], result);
+                     }}};
+}
+
+bool parseArguments(int argc, char *argv[], BenchmarkConfig &config)
+{
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    std::string table_sizes;
+    std::string workloads;
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options()(
+        "algorithm,a",
+        boost::program_options::value<std::string>(&config.algorithm)->default_value("ch"),
+        "Algorithm to use for the data. Can be CH, CoreCH, MLD or CCH.")(
+        "shared-memory,s",
+        boost::program_options::bool_switch(&config.use_shared_memory)->default_value(false),
+        "Use the data loaded by osrm-datastore, the .osrm files are still needed to sample "
+        "the queries")("threads,t",
+                       boost::program_options::value<unsigned>(&config.threads)
+                           ->default_value(config.threads),
+                       "Number of threads that send queries")(
+        "queries,q",
+        boost::program_options::value<std::size_t>(&config.queries)->default_value(1000),
+        "Number of queries per workload, route generates this many sources and a query of "
+        "every power of two Dijkstra rank from each")(
+        "seed",
+        boost::program_options::value<std::uint32_t>(&config.seed)->default_value(42),
+        "Seed of the generated queries")(
+        "workloads",
+        boost::program_options::value<std::string>(&workloads)->default_value(
+            "nearest,route,table,match,trip"),
+        "Comma separated workloads to run")(
+        "table-sizes",
+        boost::program_options::value<std::string>(&table_sizes)->default_value("10,100"),
+        "Comma separated numbers of coordinates of the clustered tables")(
+        "trace-length",
+        boost::program_options::value<std::size_t>(&config.trace_length)->default_value(50),
+        "Maximal number of coordinates of a trace")(
+        "trace-interval",
+        boost::program_options::value<double>(&config.trace_interval)->default_value(50.),
+        "Distance of the coordinates of a trace in meters")(
+        "trace-noise",
+        boost::program_options::value<double>(&config.trace_noise)->default_value(5.),
+        "Standard deviation of the noise of trace coordinates in meters")(
+        "trip-size",
+        boost::program_options::value<std::size_t>(&config.trip_size)->default_value(10),
+        "Number of coordinates of a trip")(
+        "perf-counters",
+        boost::program_options::bool_switch(&config.perf_counters)->default_value(false),
+        "Count cycles, instructions, LLC, dTLB and branch misses per query with "
+        "perf_event_open")(
+        "output,o",
+        boost::program_options::value<boost::filesystem::path>(&config.output)
+            ->default_value("-"),
+        "File to write the JSON report to, - for standard output");
+
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "base,b",
+        boost::program_options::value<boost::filesystem::path>(&config.base_path),
+        "base path to .osrm file");
+
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("base", 1);
+
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() + " <base.osrm> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    boost::program_options::variables_map option_variables;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                      .options(cmdline_options)
+                                      .positional(positional_options)
+                                      .run(),
+                                  option_variables);
+
+    if (option_variables.count("version"))
+    {
+        std::cout << OSRM_VERSION << std::endl;
+        return false;
+    }
+
+    if (option_variables.count("help") || !option_variables.count("base"))
+    {
+        std::cout << visible_options;
+        return false;
+    }
+
+    boost::program_options::notify(option_variables);
+
+    const auto split = [](const std::string &list) {
+        std::vector<std::string> values;
+        std::string value;
+        std::istringstream stream(list);
+        while (std::getline(stream, value, ','))
+        {
+            if (!value.empty())
+                values.push_back(value);
+        }
+        return values;
+    };
+
+    config.workloads = split(workloads);
+    for (const auto &size : split(table_sizes))
+        config.table_sizes.push_back(std::stoul(size));
+    config.threads = std::max(1u, config.threads);
+
+    return true;
+}
+}
+
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    BenchmarkConfig config;
+    if (!parseArguments(argc, argv, config))
+        return EXIT_SUCCESS;
+
+    // the report goes to standard output, so does the log
+    if (config.output == "-")
+        util::LogPolicy::GetInstance().Mute();
+
+    EngineConfig engine_config;
+    engine_config.storage_config = {config.base_path};
+    engine_config.use_shared_memory = config.use_shared_memory;
+    engine_config.algorithm = stringToAlgorithm(config.algorithm);
+    const OSRM osrm{engine_config};
+
+    std::vector<util::Coordinate> coordinates;
+    extractor::PackedOSMIDs osm_node_ids;
+    extractor::files::readNodes(
+        engine_config.storage_config.GetPath(".osrm.nbg_nodes"), coordinates, osm_node_ids);
+    CoordinateSampler sampler(std::move(coordinates), config.seed);
+
+    util::json::Array reports;
+    for (const auto &name : config.workloads)
+    {
+        std::vector<Workload> workloads;
+        if (name == "nearest")
+            workloads = nearestWorkloads(osrm, sampler, config);
+        else if (name == "route")
+            workloads = routeWorkloads(osrm, engine_config.storage_config.GetPath(".osrm"), config);
+        else if (name == "table")
+            workloads = tableWorkloads(osrm, sampler, config);
+        else if (name == "match")
+            workloads = matchWorkloads(osrm, sampler, config);
+        else if (name == "trip")
+            workloads = tripWorkloads(osrm, sampler, config);
+        else
+            throw util::exception("Unknown workload " + name + SOURCE_REF);
+
+        for (const auto &workload : workloads)
+            reports.values.push_back(runWorkload(workload, config.threads, config.perf_counters));
+    }
+
+    util::json::Object report;
+    report.values["dataset"] = config.base_path.string();
+    report.values["algorithm"] = config.algorithm;
+    if (config.use_shared_memory)
+        report.values["shared_memory"] = util::json::True();
+    else
+        report.values["shared_memory"] = util::json::False();
+    report.values["threads"] = static_cast<double>(config.threads);
+    report.values["seed"] = static_cast<double>(config.seed);
+    // builds with different PREFETCH_DISTANCE options are compared on datasets of several sizes
+    report.values["prefetch_distance"] = static_cast<double>(util::PREFETCH_DISTANCE);
+    report.values["workloads"] = std::move(reports);
+
+    if (config.output == "-")
+    {
+        util::json::render(std::cout, report);
+        std::cout << std::endl;
+    }
+    else
+    {
+        boost::filesystem::ofstream out(config.output);
+        if (!out)
+            throw util::exception("Could not open " + config.output.string() + " for writing" +
+                                  SOURCE_REF);
+        util::json::render(out, report);
+        out << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    util::LogPolicy::GetInstance().Unmute();
+    util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,245 @@
+#include "util/allocation_statistics.hpp"
+#include "util/integer_range.hpp"
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
+#include "util/perf_counters.hpp"
+#include "util/query_heap.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+// Counts the heap memory of this process, every block carries its size in front of it. Builds
+// with ENABLE_ALLOCATION_STATISTICS already replace operator new and report no peak memory.
+namespace
+{
+constexpr std::size_t BLOCK_HEADER = alignof(std::max_align_t);
+std::atomic<std::size_t> allocated_bytes{0};
+std::atomic<std::size_t> peak_bytes{0};
+
+#if !OSRM_ALLOCATION_STATISTICS
+void *allocate(const std::size_t size)
+{
+    auto *block = static_cast<char *>(std::malloc(size + BLOCK_HEADER));
+    if (block == nullptr)
+        throw std::bad_alloc();
+    *reinterpret_cast<std::size_t *>(block) = size;
+    const auto current = allocated_bytes += size;
+    auto peak = peak_bytes.load();
+    while (peak < current && !peak_bytes.compare_exchange_weak(peak, current))
+        ;
+    return block + BLOCK_HEADER;
+}
+
+void deallocate(void *pointer)
+{
+    if (pointer == nullptr)
+        return;
+    auto *block = static_cast<char *>(pointer) - BLOCK_HEADER;
+    allocated_bytes -= *reinterpret_cast<std::size_t *>(block);
+    std::free(block);
+}
+#endif
+}
+
+#if !OSRM_ALLOCATION_STATISTICS
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void *pointer) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer) noexcept { deallocate(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { deallocate(pointer); }
+#endif
+
+namespace
+{
+struct HeapData
+{
+    NodeID parent;
+};
+
+// Implicit grid graph with pseudo random weights, big enough to stand in for a continental
+// network without having to load one. Each node is connected to its four neighbours.
+class GridGraph
+{
+  public:
+    explicit GridGraph(const NodeID side) : side(side) {}
+
+    NodeID NumberOfNodes() const { return side * side; }
+
+    template <typename Callback> void ForEachEdge(const NodeID node, Callback callback) const
+    {
+        const auto row = node / side, column = node % side;
+        if (column > 0)
+            callback(node - 1, Weight(node, node - 1));
+        if (column + 1 < side)
+            callback(node + 1, Weight(node, node + 1));
+        if (row > 0)
+            callback(node - side, Weight(node, node - side));
+        if (row + 1 < side)
+            callback(node + side, Weight(node, node + side));
+    }
+
+  private:
+    static EdgeWeight Weight(const NodeID from, const NodeID to)
+    {
+        // symmetric so the graph is undirected
+        auto hash = std::min(from, to) * 2654435761u ^ std::max(from, to);
+        hash ^= hash >> 15;
+        return 10 + hash % 90;
+    }
+
+    const NodeID side;
+};
+
+struct Result
+{
+    double query_usec;
+    std::size_t peak_bytes;
+    std::size_t settled;
+    util::PerfCounterValues counted;
+};
+
+// With prefetch the index slots of the neighbours of a settled node are prefetched before any of
+// them is relaxed, like the relaxation of the searches with a PREFETCH_DISTANCE does
+template <typename Storage, typename Container, bool prefetch>
+Result benchmark(const GridGraph &graph,
+                 const std::vector<NodeID> &sources,
+                 const std::size_t settle_limit)
+{
+    using Heap = util::QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, Storage, Container>;
+
+    const auto bytes_before = allocated_bytes.load();
+    peak_bytes = bytes_before;
+
+    Heap heap(graph.NumberOfNodes());
+    std::size_t settled = 0;
+
+    const util::PerfCounters counters;
+    const auto counted_before = counters.Read();
+    TIMER_START(queries);
+    for (const auto source : sources)
+    {
+        heap.Clear();
+        heap.Insert(source, 0, {source});
+        for (std::size_t count = 0; count < settle_limit && !heap.Empty(); ++count, ++settled)
+        {
+            const auto node = heap.DeleteMin();
+            const auto weight = heap.GetKey(node);
+            if (prefetch)
+            {
+                graph.ForEachEdge(node, [&](const NodeID target, const EdgeWeight) {
+                    heap.Prefetch(target);
+                });
+            }
+            graph.ForEachEdge(node, [&](const NodeID target, const EdgeWeight edge_weight) {
+                const auto to_weight = weight + edge_weight;
+                if (!heap.WasInserted(target))
+                {
+                    heap.Insert(target, to_weight, {node});
+                }
+                else if (!heap.WasRemoved(target) && to_weight < heap.GetKey(target))
+                {
+                    heap.GetData(target).parent = node;
+                    heap.DecreaseKey(target, to_weight);
+                }
+            });
+        }
+    }
+    TIMER_STOP(queries);
+    const auto counted = counters.Read() - counted_before;
+
+    return {TIMER_USEC(queries) / static_cast<double>(sources.size()),
+            peak_bytes - bytes_before,
+            settled,
+            counted};
+}
+
+template <typename Storage,
+          typename Container = util::BoostHeapContainer<EdgeWeight, NodeID>,
+          bool prefetch = false>
+void report(const std::string &name,
+            const GridGraph &graph,
+            const std::vector<NodeID> &sources,
+            const std::size_t settle_limit)
+{
+    const auto result = benchmark<Storage, Container, prefetch>(graph, sources, settle_limit);
+    util::Log() << name << ": " << result.query_usec << "us per query, "
+                << result.peak_bytes / (1024. * 1024.) << "MiB peak heap memory, "
+                << result.settled / sources.size() << " nodes settled per query";
+
+    // where the kernel allows perf_event_open
+    const util::PerfCounters counters;
+    if (counters.AnyAvailable())
+    {
+        std::ostringstream counted;
+        util::json::render(counted, counters.ToJSON(result.counted, sources.size()));
+        util::Log() << name << ": " << counted.str() << " per query";
+    }
+}
+}
+
+int main(int argc, char **argv)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    if (argc > 4)
+    {
+        util::Log(logERROR) << "usage: " << argv[0] << " [grid side] [settled nodes] [queries]";
+        return EXIT_FAILURE;
+    }
+
+    // 25M nodes and a settle limit in the range of a cross country CH query by default
+    const NodeID side = argc > 1 ? std::stoul(argv[1]) : 5000;
+    const std::size_t settle_limit = argc > 2 ? std::stoul(argv[2]) : 5000;
+    const std::size_t num_queries = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+    const GridGraph graph(side);
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<NodeID> node(0, graph.NumberOfNodes() - 1);
+    std::vector<NodeID> sources;
+    for (auto index : util::irange<std::size_t>(0, num_queries))
+    {
+        (void)index;
+        sources.push_back(node(generator));
+    }
+
+    util::Log() << graph.NumberOfNodes() << " nodes, " << num_queries << " queries settling up to "
+                << settle_limit << " nodes";
+
+    report<util::UnorderedMapStorage<NodeID, int>>("unordered_map", graph, sources, settle_limit);
+    report<util::ArrayStorage<NodeID, int>>("array", graph, sources, settle_limit);
+    report<util::GenerationArrayStorage<NodeID, int>>(
+        "generation_array", graph, sources, settle_limit);
+
+    // prefetching the index slots only pays off once the arrays do not fit the caches, compare
+    // with grid sides from 100 to 5000
+    using DefaultContainer = util::BoostHeapContainer<EdgeWeight, NodeID>;
+    report<util::ArrayStorage<NodeID, int>, DefaultContainer, true>(
+        "array + prefetch", graph, sources, settle_limit);
+    report<util::GenerationArrayStorage<NodeID, int>, DefaultContainer, true>(
+        "generation_array + prefetch", graph, sources, settle_limit);
+
+    // the priority queues, on top of the default storage
+    using DefaultStorage = util::UnorderedMapStorage<NodeID, int>;
+    report<DefaultStorage, util::DAryHeapContainer<EdgeWeight, NodeID>>(
+        "unordered_map + d_ary", graph, sources, settle_limit);
+    report<DefaultStorage, util::RadixHeapContainer<EdgeWeight, NodeID>>(
+        "unordered_map + radix", graph, sources, settle_limit);
+    report<util::ArrayStorage<NodeID, int>, util::DAryHeapContainer<EdgeWeight, NodeID>>(
+        "array + d_ary", graph, sources, settle_limit);
+    report<util::ArrayStorage<NodeID, int>, util::RadixHeapContainer<EdgeWeight, NodeID>>(
+        "array + radix", graph, sources, settle_limit);
+
+    return EXIT_SUCCESS;
+}
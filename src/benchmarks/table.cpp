@@ -0,0 +1,139 @@
+#include "util/timing_util.hpp"
+
+#include "osrm/table_parameters.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <cstdlib>
+
+int main(int argc, const char *argv[]) try
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " data.osrm [ch|mld] [table size]\n";
+        return EXIT_FAILURE;
+    }
+
+    using namespace osrm;
+
+    // Configure based on a .osrm base path, and no datasets in shared mem from osrm-datastore
+    EngineConfig config;
+    config.storage_config = {argv[1]};
+    config.use_shared_memory = false;
+    config.algorithm = argc > 2 && std::string{argv[2]} == "mld" ? EngineConfig::Algorithm::MLD
+                                                                 : EngineConfig::Algorithm::CH;
+    const std::size_t size = argc > 3 ? std::stoul(argv[3]) : 100;
+
+    OSRM osrm{config};
+
+    using osrm::util::FloatCoordinate;
+    using osrm::util::FloatLatitude;
+    using osrm::util::FloatLongitude;
+
+    // Sources all over monaco, destinations either all over monaco as well or within a few
+    // hundred meters around the casino
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform_longitude(7.410, 7.440);
+    std::uniform_real_distribution<double> uniform_latitude(43.725, 43.750);
+    std::uniform_real_distribution<double> clustered_longitude(7.425, 7.430);
+    std::uniform_real_distribution<double> clustered_latitude(43.737, 43.741);
+
+    const auto benchmark = [&](const std::string &name,
+                               std::uniform_real_distribution<double> &longitude,
+                               std::uniform_real_distribution<double> &latitude) {
+        TableParameters params;
+        for (std::size_t index = 0; index < size; ++index)
+        {
+            params.coordinates.push_back(FloatCoordinate{
+                FloatLongitude{uniform_longitude(generator)},
+                FloatLatitude{uniform_latitude(generator)}});
+            params.sources.push_back(index);
+        }
+        for (std::size_t index = 0; index < size; ++index)
+        {
+            params.coordinates.push_back(FloatCoordinate{FloatLongitude{longitude(generator)},
+                                                         FloatLatitude{latitude(generator)}});
+            params.destinations.push_back(size + index);
+        }
+
+        TIMER_START(tables);
+        const auto NUM = 10;
+        for (int i = 0; i < NUM; ++i)
+        {
+            json::Object result;
+            const auto rc = osrm.Table(params, result);
+            if (rc != Status::Ok)
+            {
+                return false;
+            }
+        }
+        TIMER_STOP(tables);
+        std::cout << name << ": " << (TIMER_MSEC(tables) / NUM) << "ms/req at " << size << "x"
+                  << size << " table" << std::endl;
+        return true;
+    };
+
+    // The same square table with the backward and forward search of every coordinate in one pass
+    // and in two separate passes
+    const auto square_benchmark = [&]() {
+        TableParameters params;
+        for (std::size_t index = 0; index < size; ++index)
+        {
+            params.coordinates.push_back(FloatCoordinate{
+                FloatLongitude{uniform_longitude(generator)},
+                FloatLatitude{uniform_latitude(generator)}});
+        }
+
+        auto separate_config = config;
+        separate_config.min_fused_table_size = -1;
+        OSRM separate{separate_config};
+
+        const auto NUM = 10;
+        double msecs[2];
+        for (const auto fused : {true, false})
+        {
+            const auto &engine = fused ? osrm : separate;
+            TIMER_START(tables);
+            for (int i = 0; i < NUM; ++i)
+            {
+                json::Object result;
+                const auto rc = engine.Table(params, result);
+                if (rc != Status::Ok)
+                {
+                    return false;
+                }
+            }
+            TIMER_STOP(tables);
+            msecs[fused ? 0 : 1] = TIMER_MSEC(tables) / NUM;
+        }
+        std::cout << "square fused: " << msecs[0] << "ms/req, separate: " << msecs[1]
+                  << "ms/req (" << (msecs[1] / msecs[0]) << "x) at " << size << "x" << size
+                  << " table" << std::endl;
+        return true;
+    };
+
+    if (!benchmark("uniform destinations", uniform_longitude, uniform_latitude) ||
+        !benchmark("clustered destinations", clustered_longitude, clustered_latitude) ||
+        !square_benchmark())
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -1,13 +1,21 @@
 #include "contractor/contractor.hpp"
 #include "contractor/crc32_processor.hpp"
+#include "contractor/customizable_contraction.hpp"
 #include "contractor/files.hpp"
 #include "contractor/graph_contractor.hpp"
 #include "contractor/graph_contractor_adaptors.hpp"
+#include "contractor/query_benchmark.hpp"
+#include "contractor/renumber.hpp"
 
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/edge_based_graph_factory.hpp"
+#include "extractor/files.hpp"
 #include "extractor/node_based_edge.hpp"
 
+#include "partition/files.hpp"
+#include "partition/multi_level_partition.hpp"
+#include "partition/renumber.hpp"
+
 #include "storage/io.hpp"
 
 #include "updater/updater.hpp"
@@ -17,13 +25,18 @@
 #include "util/graph_loader.hpp"
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/mmap_file.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/static_graph.hpp"
 #include "util/string_util.hpp"
 #include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
 
+#include <boost/filesystem/operations.hpp>
+
 #include <algorithm>
 #include <bitset>
+#include <chrono>
 #include <cstdint>
 #include <fstream>
 #include <iterator>
@@ -35,6 +48,30 @@ namespace osrm
 namespace contractor
 {
 
+namespace
+{
+// The effort per round is a debug message, the sums are enough to compare runs
+void logWitnessSearches(const std::vector<ContractionRoundStats> &round_stats)
+{
+    WitnessSearchStats total;
+    for (const auto round : util::irange<std::size_t>(0, round_stats.size()))
+    {
+        const auto &stats = round_stats[round];
+        util::Log(logDEBUG) << "round " << round << ": contracted " << stats.contracted_nodes
+                            << " of " << stats.remaining_nodes << " nodes, hop limit "
+                            << stats.witness_hop_limit << ", " << stats.witness_searches.searches
+                            << " witness searches settled " << stats.witness_searches.settled_nodes
+                            << " nodes, " << stats.witness_searches.exhausted_searches
+                            << " reached the node limit, average degree afterwards "
+                            << stats.average_degree;
+        total += stats.witness_searches;
+    }
+    util::Log() << total.searches << " witness searches in " << round_stats.size()
+                << " rounds settled " << total.settled_nodes << " nodes, "
+                << total.exhausted_searches << " reached the node limit";
+}
+}
+
 int Contractor::Run()
 {
     if (config.core_factor > 1.0 || config.core_factor < 0)
@@ -43,6 +80,7 @@ int Contractor::Run()
     }
 
     TIMER_START(preparing);
+    util::ProfilePhase loading_phase("loading graph");
 
     util::Log() << "Reading node weights.";
     std::vector<EdgeWeight> node_weights;
@@ -59,10 +97,32 @@ int Contractor::Run()
 
     updater::Updater updater(config.updater_config);
     EdgeID max_edge_id = updater.LoadAndUpdateEdgeExpandedGraph(edge_based_edge_list, node_weights);
+    loading_phase.Stop();
+
+    if (config.use_cch)
+    {
+        RunCCH(max_edge_id + 1, edge_based_edge_list);
+
+        TIMER_STOP(preparing);
+        util::Log() << "Preprocessing : " << TIMER_SEC(preparing) << " seconds";
+        util::Log() << "finished preprocessing";
+        return 0;
+    }
+
+    if (!config.tune_core_factors.empty())
+    {
+        RunTuneCore(max_edge_id + 1, std::move(edge_based_edge_list), node_weights);
+
+        TIMER_STOP(preparing);
+        util::Log() << "Preprocessing : " << TIMER_SEC(preparing) << " seconds";
+        util::Log() << "finished tuning";
+        return 0;
+    }
 
     // Contracting the edge-expanded graph
 
     TIMER_START(contraction);
+    util::ProfilePhase contraction_phase("contraction");
     std::vector<bool> is_core_node;
     std::vector<float> node_levels;
     if (config.use_cached_priority)
@@ -74,18 +134,48 @@ int Contractor::Run()
     { // own scope to not keep the contractor around
         GraphContractor graph_contractor(max_edge_id + 1,
                                          adaptToContractorInput(std::move(edge_based_edge_list)),
-                                         std::move(node_levels),
+                                         node_levels,
                                          std::move(node_weights));
-        graph_contractor.Run(config.core_factor);
+        if (config.checkpoint_interval > 0 || config.resume_from_checkpoint)
+        {
+            graph_contractor.UseCheckpoint(config.GetPath(".osrm.checkpoint"),
+                                           std::chrono::minutes(config.checkpoint_interval),
+                                           config.resume_from_checkpoint);
+        }
+        graph_contractor.Run(config.core_factor, config.use_fixed_order);
+        logWitnessSearches(graph_contractor.GetRoundStats());
 
         contracted_edge_list = graph_contractor.GetEdges<QueryEdge>();
         is_core_node = graph_contractor.GetCoreMarker();
-        node_levels = graph_contractor.GetNodeLevels();
+        if (!config.use_cached_priority)
+        {
+            node_levels = graph_contractor.GetNodeLevels();
+        }
     }
     TIMER_STOP(contraction);
+    contraction_phase.Stop();
 
     util::Log() << "Contraction took " << TIMER_SEC(contraction) << " sec";
 
+    bool renumbered = false;
+    if (config.renumber_nodes)
+    {
+        if (boost::filesystem::exists(config.GetPath(".osrm.partition")))
+        {
+            util::Log() << "Keeping the cell order of osrm-partition, not renumbering";
+        }
+        else
+        {
+            TIMER_START(renumber);
+            util::ProfilePhase renumber_phase("renumbering");
+            RenumberNodes(contracted_edge_list, is_core_node, node_levels);
+            renumbered = true;
+            TIMER_STOP(renumber);
+            util::Log() << "Renumbered data in " << TIMER_SEC(renumber) << " seconds";
+        }
+    }
+
+    util::ProfilePhase writing_phase("writing graph");
     {
         RangebasedCRC32 crc32_calculator;
         const unsigned checksum = crc32_calculator(contracted_edge_list);
@@ -96,10 +186,13 @@ int Contractor::Run()
     }
 
     files::writeCoreMarker(config.GetPath(".osrm.core"), is_core_node);
-    if (!config.use_cached_priority)
+    if (!config.use_cached_priority || renumbered)
     {
         files::writeLevels(config.GetPath(".osrm.level"), node_levels);
     }
+    // all output is written, a restart does not need the checkpoint anymore
+    boost::filesystem::remove(config.GetPath(".osrm.checkpoint"));
+    writing_phase.Stop();
 
     TIMER_STOP(preparing);
 
@@ -110,5 +203,190 @@ int Contractor::Run()
     return 0;
 }
 
+void Contractor::RunCCH(const NodeID number_of_nodes,
+                        const std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list) const
+{
+    CCHTopology topology;
+    if (config.use_cached_priority && boost::filesystem::exists(config.GetPath(".osrm.cch")))
+    {
+        util::Log() << "Reading the contraction order and arcs of the last run";
+        files::readCCHTopology(config.GetPath(".osrm.cch"), topology);
+        if (topology.GetNumberOfNodes() != number_of_nodes)
+        {
+            throw util::exception(config.GetPath(".osrm.cch").string() + " has " +
+                                  std::to_string(topology.GetNumberOfNodes()) +
+                                  " nodes but the graph " + std::to_string(number_of_nodes) +
+                                  ", run osrm-contract without --level-cache" + SOURCE_REF);
+        }
+    }
+    else
+    {
+        TIMER_START(order);
+        util::ProfilePhase order_phase("CCH ordering");
+        partition::MultiLevelPartition mlp;
+        partition::files::readPartition(config.GetPath(".osrm.partition"), mlp);
+        topology = contractTopology(
+            computeNestedDissectionOrder(mlp, edge_based_edge_list, number_of_nodes),
+            edge_based_edge_list);
+        files::writeCCHTopology(config.GetPath(".osrm.cch"), topology);
+        TIMER_STOP(order);
+        util::Log() << "Ordering and contracting took " << TIMER_SEC(order) << " sec";
+    }
+
+    TIMER_START(customization);
+    util::ProfilePhase customization_phase("CCH customization");
+    auto contracted_edge_list = customizeTopology(topology, edge_based_edge_list);
+    TIMER_STOP(customization);
+    customization_phase.Stop();
+    util::Log() << "Customization took " << TIMER_SEC(customization) << " sec";
+
+    RangebasedCRC32 crc32_calculator;
+    const unsigned checksum = crc32_calculator(contracted_edge_list);
+    files::writeGraph(config.GetPath(".osrm.hsgr"),
+                      checksum,
+                      QueryGraph{number_of_nodes, std::move(contracted_edge_list)});
+
+    // there is no core, the engine must not upgrade the dataset to CoreCH
+    files::writeCoreMarker(config.GetPath(".osrm.core"), std::vector<bool>{});
+}
+
+void Contractor::RenumberNodes(util::DeallocatingVector<QueryEdge> &contracted_edge_list,
+                               std::vector<bool> &is_core_node,
+                               std::vector<float> &node_levels) const
+{
+    std::vector<NodeID> permutation;
+    {
+        std::vector<util::Coordinate> coordinates;
+        extractor::PackedOSMIDs osm_node_ids;
+        extractor::files::readNodes(config.GetPath(".osrm.nbg_nodes"), coordinates, osm_node_ids);
+
+        boost::iostreams::mapped_file segment_region;
+        auto segments = util::mmapFile<extractor::EdgeBasedNodeSegment>(
+            config.GetPath(".osrm.fileIndex"), segment_region);
+        const auto hilbert_codes = getNodeHilbertCodes(
+            node_levels.size(),
+            util::vector_view<const extractor::EdgeBasedNodeSegment>(segments.data(),
+                                                                     segments.size()),
+            coordinates);
+        permutation = makeLocalityPermutation(node_levels, is_core_node, hilbert_codes);
+        partition::renumber(segments, permutation);
+    }
+
+    renumber(contracted_edge_list, permutation);
+    renumber(is_core_node, permutation);
+    util::inplacePermutation(node_levels.begin(), node_levels.end(), permutation);
+
+    {
+        extractor::EdgeBasedNodeDataContainer node_data;
+        extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
+        partition::renumber(node_data, permutation);
+        extractor::files::writeNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
+    }
+    {
+        // the weights and edges of the files, not the ones the updater changed
+        std::vector<EdgeWeight> node_weights;
+        {
+            storage::io::FileReader reader(config.GetPath(".osrm.enw"),
+                                           storage::io::FileReader::VerifyFingerprint);
+            storage::serialization::read(reader, node_weights);
+        }
+        util::inplacePermutation(node_weights.begin(), node_weights.end(), permutation);
+        storage::io::FileWriter writer(config.GetPath(".osrm.enw"),
+                                       storage::io::FileWriter::GenerateFingerprint);
+        storage::serialization::write(writer, node_weights);
+    }
+    {
+        EdgeID max_edge_id = 0;
+        std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
+        extractor::files::readEdgeBasedGraph(
+            config.GetPath(".osrm.ebg"), max_edge_id, edge_based_edge_list);
+        for (auto &edge : edge_based_edge_list)
+        {
+            edge.source = permutation[edge.source];
+            edge.target = permutation[edge.target];
+        }
+        extractor::files::writeEdgeBasedGraph(
+            config.GetPath(".osrm.ebg"), max_edge_id, edge_based_edge_list);
+    }
+    {
+        std::vector<extractor::NBGToEBG> mapping;
+        extractor::files::readNBGMapping(config.GetPath(".osrm.cnbg_to_ebg"), mapping);
+        for (auto &entry : mapping)
+        {
+            entry.forward_ebg_node = permutation[entry.forward_ebg_node];
+            if (entry.backward_ebg_node != SPECIAL_NODEID)
+                entry.backward_ebg_node = permutation[entry.backward_ebg_node];
+        }
+        extractor::files::writeNBGMapping(config.GetPath(".osrm.cnbg_to_ebg"), mapping);
+    }
+
+    if (boost::filesystem::exists(config.GetPath(".osrm.cch")))
+    {
+        util::Log(logWARNING) << "Found existing .osrm.cch file in the old node order, removing.";
+        boost::filesystem::remove(config.GetPath(".osrm.cch"));
+    }
+}
+
+void Contractor::RunTuneCore(const NodeID number_of_nodes,
+                             std::vector<extractor::EdgeBasedEdge> edge_based_edge_list,
+                             const std::vector<EdgeWeight> &node_weights) const
+{
+    const auto contractor_edges = adaptToContractorInput(std::move(edge_based_edge_list));
+
+    std::vector<float> node_levels;
+    if (config.use_cached_priority)
+    {
+        files::readLevels(config.GetPath(".osrm.level"), node_levels);
+    }
+    else
+    {
+        util::Log() << "Contracting the whole graph once for its node order";
+        TIMER_START(order);
+        GraphContractor graph_contractor(
+            number_of_nodes, contractor_edges, std::vector<float>{}, node_weights);
+        graph_contractor.Run();
+        node_levels = graph_contractor.GetNodeLevels();
+        TIMER_STOP(order);
+        util::Log() << "Ordering took " << TIMER_SEC(order) << " sec";
+    }
+
+    for (const auto core_factor : config.tune_core_factors)
+    {
+        TIMER_START(contraction);
+        util::DeallocatingVector<QueryEdge> contracted_edge_list;
+        std::vector<bool> is_core_node;
+        {
+            GraphContractor graph_contractor(
+                number_of_nodes, contractor_edges, node_levels, node_weights);
+            graph_contractor.Run(core_factor, true);
+            contracted_edge_list = graph_contractor.GetEdges<QueryEdge>();
+            is_core_node = graph_contractor.GetCoreMarker();
+        }
+        TIMER_STOP(contraction);
+
+        const auto number_of_core_nodes =
+            std::count(is_core_node.begin(), is_core_node.end(), true);
+        const auto number_of_edges = contracted_edge_list.size();
+        const QueryGraph graph{number_of_nodes, std::move(contracted_edge_list)};
+        const auto result =
+            benchmarkQueries(graph, config.tune_number_of_routes, config.tune_table_size);
+
+        util::Log() << "core " << core_factor << ": contraction " << TIMER_SEC(contraction)
+                    << " sec, " << number_of_core_nodes << " core nodes, " << number_of_edges
+                    << " edges, " << (number_of_edges * sizeof(QueryEdge) >> 20)
+                    << " MiB of edges, route " << result.route_milliseconds << " ms settling "
+                    << result.route_settled_nodes << " nodes, " << config.tune_table_size << "x"
+                    << config.tune_table_size << " table " << result.table_milliseconds
+                    << " ms";
+
+        const PackedQueryGraph packed_graph{graph};
+        const auto packed_result =
+            benchmarkQueries(packed_graph, config.tune_number_of_routes, config.tune_table_size);
+        util::Log() << "core " << core_factor << " packed: " << (packed_graph.GetMemorySize() >> 20)
+                    << " MiB, route " << packed_result.route_milliseconds << " ms, table "
+                    << packed_result.table_milliseconds << " ms";
+    }
+}
+
 } // namespace contractor
 } // namespace osrm
@@ -10,36 +10,46 @@ ContractorDijkstra::ContractorDijkstra(const std::size_t heap_size) : heap(heap_
 void ContractorDijkstra::Run(const unsigned number_of_targets,
                              const int node_limit,
                              const EdgeWeight weight_limit,
+                             const short hop_limit,
                              const NodeID forbidden_node,
                              const ContractorGraph &graph)
 {
+    ++stats.searches;
     int nodes = 0;
     unsigned number_of_targets_found = 0;
     while (!heap.Empty())
     {
         const NodeID node = heap.DeleteMin();
         const auto node_weight = heap.GetKey(node);
-        if (++nodes > node_limit)
+        if (nodes >= node_limit)
         {
-            return;
+            ++stats.exhausted_searches;
+            break;
         }
+        ++nodes;
         if (node_weight > weight_limit)
         {
-            return;
+            break;
         }
 
         // Destination settled?
-        if (heap.GetData(node).target)
+        const auto &data = heap.GetData(node);
+        if (data.target)
         {
             ++number_of_targets_found;
             if (number_of_targets_found >= number_of_targets)
             {
-                return;
+                break;
             }
         }
 
-        RelaxNode(node, node_weight, forbidden_node, graph);
+        // a longer path is no witness, the targets it reaches get a shortcut
+        if (data.hop < hop_limit)
+        {
+            RelaxNode(node, node_weight, forbidden_node, graph);
+        }
     }
+    stats.settled_nodes += nodes;
 }
 
 void ContractorDijkstra::RelaxNode(const NodeID node,
@@ -0,0 +1,354 @@
+#include "contractor/customizable_contraction.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace osrm
+{
+namespace contractor
+{
+namespace
+{
+// Weight of one direction of an arc, id is the middle node of a shortcut or the turn id
+struct ArcMetric
+{
+    EdgeWeight weight = INVALID_EDGE_WEIGHT;
+    EdgeWeight duration = 0;
+    EdgeDistance distance = 0;
+    NodeID id = SPECIAL_NODEID;
+    bool shortcut = false;
+
+    void Relax(const EdgeWeight weight_,
+               const EdgeWeight duration_,
+               const EdgeDistance distance_,
+               const NodeID id_,
+               const bool shortcut_)
+    {
+        if (weight_ < weight)
+        {
+            weight = weight_;
+            duration = duration_;
+            distance = distance_;
+            id = id_;
+            shortcut = shortcut_;
+        }
+    }
+
+    // the arc from first to second and then on to the head of second
+    void Relax(const ArcMetric &first, const ArcMetric &second, const NodeID middle)
+    {
+        if (first.weight != INVALID_EDGE_WEIGHT && second.weight != INVALID_EDGE_WEIGHT)
+        {
+            Relax(first.weight + second.weight,
+                  first.duration + second.duration,
+                  first.distance + second.distance,
+                  middle,
+                  true);
+        }
+    }
+
+    bool operator==(const ArcMetric &other) const
+    {
+        return std::tie(weight, duration, distance, id, shortcut) ==
+               std::tie(other.weight, other.duration, other.distance, other.id, other.shortcut);
+    }
+};
+
+EdgeID findArc(const CCHTopology &topology, const NodeID lower, const NodeID upper)
+{
+    const auto begin = topology.arc_head.begin() + topology.first_arc[lower];
+    const auto end = topology.arc_head.begin() + topology.first_arc[lower + 1];
+    const auto arc = std::lower_bound(begin, end, upper);
+    BOOST_ASSERT(arc != end && *arc == upper);
+    return std::distance(topology.arc_head.begin(), arc);
+}
+
+QueryEdge makeQueryEdge(const NodeID source,
+                        const NodeID target,
+                        const ArcMetric &metric,
+                        const bool forward,
+                        const bool backward)
+{
+    QueryEdge edge;
+    edge.source = source;
+    edge.target = target;
+    edge.data.weight = metric.weight;
+    edge.data.duration = metric.duration;
+    edge.data.distance = metric.distance;
+    edge.data.turn_id = metric.id;
+    edge.data.shortcut = metric.shortcut;
+    edge.data.forward = forward;
+    edge.data.backward = backward;
+    return edge;
+}
+}
+
+std::vector<NodeID> computeNestedDissectionOrder(const partition::MultiLevelPartition &mlp,
+                                                 const std::vector<extractor::EdgeBasedEdge> &edges,
+                                                 const NodeID number_of_nodes)
+{
+    // one node of a cut edge is enough for a separator, it is the one in the cell with the lower id
+    std::vector<LevelID> separator_level(number_of_nodes, 0);
+    for (const auto &edge : edges)
+    {
+        BOOST_ASSERT(edge.source < number_of_nodes && edge.target < number_of_nodes);
+        const auto level = mlp.GetHighestDifferentLevel(edge.source, edge.target);
+        if (level == 0)
+        {
+            continue;
+        }
+        const auto node = mlp.GetCell(level, edge.source) < mlp.GetCell(level, edge.target)
+                              ? edge.source
+                              : edge.target;
+        separator_level[node] = std::max(separator_level[node], level);
+    }
+
+    // the nodes of a level are grouped by the cell of the next level they are in
+    const auto number_of_levels = mlp.GetNumberOfLevels();
+    const auto key = [&](const NodeID node) {
+        const LevelID level = separator_level[node];
+        const CellID cell = level + 1 < number_of_levels ? mlp.GetCell(level + 1, node) : 0;
+        return std::make_tuple(level, cell, node);
+    };
+
+    std::vector<NodeID> rank_to_node(number_of_nodes);
+    std::iota(rank_to_node.begin(), rank_to_node.end(), 0);
+    tbb::parallel_sort(rank_to_node.begin(),
+                       rank_to_node.end(),
+                       [&](const NodeID lhs, const NodeID rhs) { return key(lhs) < key(rhs); });
+
+    std::vector<NodeID> node_to_rank(number_of_nodes);
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        node_to_rank[rank_to_node[rank]] = rank;
+    }
+    return node_to_rank;
+}
+
+CCHTopology contractTopology(std::vector<NodeID> node_to_rank,
+                             const std::vector<extractor::EdgeBasedEdge> &edges)
+{
+    CCHTopology topology;
+    const NodeID number_of_nodes = node_to_rank.size();
+
+    // upward neighbors by rank, the contraction of lower nodes inserts more of them
+    std::vector<std::vector<NodeID>> neighbors(number_of_nodes);
+    for (const auto &edge : edges)
+    {
+        const auto source = node_to_rank[edge.source];
+        const auto target = node_to_rank[edge.target];
+        if (source != target)
+        {
+            neighbors[std::min(source, target)].push_back(std::max(source, target));
+        }
+    }
+
+    topology.first_arc.reserve(number_of_nodes + 1);
+    topology.first_arc.push_back(0);
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        auto &upward = neighbors[rank];
+        std::sort(upward.begin(), upward.end());
+        upward.erase(std::unique(upward.begin(), upward.end()), upward.end());
+
+        // Contracting the node connects all its upward neighbors. It is enough to add them to the
+        // lowest one, its parent in the elimination tree, which passes them on when it is
+        // contracted itself.
+        if (!upward.empty())
+        {
+            auto &parent = neighbors[upward.front()];
+            parent.insert(parent.end(), upward.begin() + 1, upward.end());
+        }
+
+        topology.arc_head.insert(topology.arc_head.end(), upward.begin(), upward.end());
+        if (topology.arc_head.size() >= SPECIAL_EDGEID)
+        {
+            throw util::exception("The contraction hierarchy has too many arcs" + SOURCE_REF);
+        }
+        topology.first_arc.push_back(topology.arc_head.size());
+        std::vector<NodeID>().swap(upward);
+    }
+
+    topology.rank_to_node.resize(number_of_nodes);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        topology.rank_to_node[node_to_rank[node]] = node;
+    }
+    topology.node_to_rank = std::move(node_to_rank);
+
+    util::Log() << "Contracted " << number_of_nodes << " nodes to " << topology.GetNumberOfArcs()
+                << " arcs for " << edges.size() << " edges";
+
+    return topology;
+}
+
+util::DeallocatingVector<QueryEdge>
+customizeTopology(const CCHTopology &topology, const std::vector<extractor::EdgeBasedEdge> &edges)
+{
+    const auto number_of_nodes = topology.GetNumberOfNodes();
+    const auto number_of_arcs = topology.GetNumberOfArcs();
+
+    // forward is the direction from the lower to the upper node of an arc
+    std::vector<ArcMetric> forward(number_of_arcs);
+    std::vector<ArcMetric> backward(number_of_arcs);
+    for (const auto &edge : edges)
+    {
+        if (edge.data.weight == INVALID_EDGE_WEIGHT)
+        {
+            continue;
+        }
+
+        const auto source = topology.node_to_rank[edge.source];
+        const auto target = topology.node_to_rank[edge.target];
+        if (source == target)
+        {
+            continue;
+        }
+
+        const auto arc = findArc(topology, std::min(source, target), std::max(source, target));
+        const auto weight = std::max(edge.data.weight, 1);
+        if (edge.data.forward)
+        {
+            auto &metric = source < target ? forward[arc] : backward[arc];
+            metric.Relax(weight, edge.data.duration, edge.data.distance, edge.data.turn_id, false);
+        }
+        if (edge.data.backward)
+        {
+            auto &metric = source < target ? backward[arc] : forward[arc];
+            metric.Relax(weight, edge.data.duration, edge.data.distance, edge.data.turn_id, false);
+        }
+    }
+
+    // the lower nodes of every node with the arc from them
+    std::vector<EdgeID> first_lower(number_of_nodes + 1, 0);
+    for (const auto head : topology.arc_head)
+    {
+        ++first_lower[head + 1];
+    }
+    std::partial_sum(first_lower.begin(), first_lower.end(), first_lower.begin());
+    std::vector<std::pair<NodeID, EdgeID>> lower_arcs(number_of_arcs);
+    {
+        auto next_lower = first_lower;
+        for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+        {
+            const auto arcs = util::irange(topology.first_arc[rank], topology.first_arc[rank + 1]);
+            for (const auto arc : arcs)
+            {
+                lower_arcs[next_lower[topology.arc_head[arc]]++] = std::make_pair(rank, arc);
+            }
+        }
+    }
+
+    // The lower triangles of the arcs of a node only use arcs of its descendants in the
+    // elimination tree, which are on lower levels of the tree.
+    std::vector<std::uint32_t> tree_level(number_of_nodes, 0);
+    std::uint32_t number_of_tree_levels = 0;
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        number_of_tree_levels = std::max(number_of_tree_levels, tree_level[rank] + 1);
+        if (topology.first_arc[rank] != topology.first_arc[rank + 1])
+        {
+            const auto parent = topology.arc_head[topology.first_arc[rank]];
+            tree_level[parent] = std::max(tree_level[parent], tree_level[rank] + 1);
+        }
+    }
+    std::vector<std::uint32_t> first_on_level(number_of_tree_levels + 1, 0);
+    for (const auto level : tree_level)
+    {
+        ++first_on_level[level + 1];
+    }
+    std::partial_sum(first_on_level.begin(), first_on_level.end(), first_on_level.begin());
+    std::vector<NodeID> nodes_by_level(number_of_nodes);
+    {
+        auto next_on_level = first_on_level;
+        for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+        {
+            nodes_by_level[next_on_level[tree_level[rank]]++] = rank;
+        }
+    }
+
+    // arc of the customized node to every upper node, reset after each node
+    tbb::enumerable_thread_specific<std::vector<EdgeID>> arc_to_head(
+        std::vector<EdgeID>(number_of_nodes, SPECIAL_EDGEID));
+    for (const auto level : util::irange<std::uint32_t>(0, number_of_tree_levels))
+    {
+        tbb::parallel_for(first_on_level[level], first_on_level[level + 1], [&](const auto index) {
+            const auto node = nodes_by_level[index];
+            const auto arcs = util::irange(topology.first_arc[node], topology.first_arc[node + 1]);
+            auto &arc_to = arc_to_head.local();
+            for (const auto arc : arcs)
+            {
+                arc_to[topology.arc_head[arc]] = arc;
+            }
+
+            for (const auto lower : util::irange(first_lower[node], first_lower[node + 1]))
+            {
+                const auto middle = lower_arcs[lower].first;
+                const auto to_node = lower_arcs[lower].second;
+                const auto middle_node = topology.rank_to_node[middle];
+
+                // the arcs of the middle node are sorted, the ones after to_node go above node
+                const auto end = topology.first_arc[middle + 1];
+                for (auto to_head = to_node + 1; to_head < end; ++to_head)
+                {
+                    const auto arc = arc_to[topology.arc_head[to_head]];
+                    BOOST_ASSERT(arc != SPECIAL_EDGEID);
+                    forward[arc].Relax(backward[to_node], forward[to_head], middle_node);
+                    backward[arc].Relax(backward[to_head], forward[to_node], middle_node);
+                }
+            }
+
+            for (const auto arc : arcs)
+            {
+                arc_to[topology.arc_head[arc]] = SPECIAL_EDGEID;
+            }
+        });
+    }
+
+    util::DeallocatingVector<QueryEdge> query_edges;
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        const auto source = topology.rank_to_node[rank];
+        for (const auto arc : util::irange(topology.first_arc[rank], topology.first_arc[rank + 1]))
+        {
+            const auto target = topology.rank_to_node[topology.arc_head[arc]];
+            const auto has_forward = forward[arc].weight != INVALID_EDGE_WEIGHT;
+            const auto has_backward = backward[arc].weight != INVALID_EDGE_WEIGHT;
+            if (has_forward && has_backward && forward[arc] == backward[arc])
+            {
+                query_edges.push_back(makeQueryEdge(source, target, forward[arc], true, true));
+                continue;
+            }
+            if (has_forward)
+            {
+                query_edges.push_back(makeQueryEdge(source, target, forward[arc], true, false));
+            }
+            if (has_backward)
+            {
+                query_edges.push_back(makeQueryEdge(source, target, backward[arc], false, true));
+            }
+        }
+    }
+    tbb::parallel_sort(query_edges.begin(), query_edges.end());
+
+    util::Log() << "Customized " << number_of_arcs << " arcs on " << number_of_tree_levels
+                << " levels of the elimination tree to " << query_edges.size() << " edges";
+
+    return query_edges;
+}
+}
+}
@@ -1,5 +1,16 @@
 #include "contractor/graph_contractor.hpp"
 
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/serialization.hpp"
+
+#include "storage/io.hpp"
+#include "storage/serialization.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <string>
+
 namespace osrm
 {
 namespace contractor
@@ -40,6 +51,7 @@ GraphContractor::GraphContractor(int nodes,
         forward_edge.data.originalEdges = reverse_edge.data.originalEdges = 1;
         forward_edge.data.weight = reverse_edge.data.weight = INVALID_EDGE_WEIGHT;
         forward_edge.data.duration = reverse_edge.data.duration = MAXIMAL_EDGE_DURATION;
+        forward_edge.data.distance = reverse_edge.data.distance = INVALID_EDGE_DISTANCE;
         // remove parallel edges
         while (i < edges.size() && edges[i].source == source && edges[i].target == target)
         {
@@ -48,12 +60,16 @@ GraphContractor::GraphContractor(int nodes,
                 forward_edge.data.weight = std::min(edges[i].data.weight, forward_edge.data.weight);
                 forward_edge.data.duration =
                     std::min(edges[i].data.duration, forward_edge.data.duration);
+                forward_edge.data.distance =
+                    std::min(edges[i].data.distance, forward_edge.data.distance);
             }
             if (edges[i].data.backward)
             {
                 reverse_edge.data.weight = std::min(edges[i].data.weight, reverse_edge.data.weight);
                 reverse_edge.data.duration =
                     std::min(edges[i].data.duration, reverse_edge.data.duration);
+                reverse_edge.data.distance =
+                    std::min(edges[i].data.distance, reverse_edge.data.distance);
             }
             ++i;
         }
@@ -94,9 +110,6 @@ void GraphContractor::FlushDataAndRebuildContractorGraph(
     std::vector<RemainingNodeData> &remaining_nodes,
     std::vector<float> &node_priorities)
 {
-    util::DeallocatingVector<ContractorEdge> new_edge_set; // this one is not explicitely
-                                                           // cleared since it goes out of
-                                                           // scope anywa
     // Delete old heap data to free memory that we need for the coming operations
     thread_data_list.data.clear();
     // Create new priority array
@@ -126,30 +139,22 @@ void GraphContractor::FlushDataAndRebuildContractorGraph(
         new_node_id_from_orig_id_map[node.id] = new_node_id;
         node.id = new_node_id;
     }
-    // walk over all nodes
+    // walk over all nodes, the edges of contracted nodes are final
     for (const auto source : util::irange<NodeID>(0UL, contractor_graph->GetNumberOfNodes()))
     {
+        const bool is_contracted = SPECIAL_NODEID == new_node_id_from_orig_id_map[source];
         for (auto current_edge : contractor_graph->GetAdjacentEdgeRange(source))
         {
             ContractorGraph::EdgeData &data = contractor_graph->GetEdgeData(current_edge);
-            const NodeID target = contractor_graph->GetTarget(current_edge);
-            if (SPECIAL_NODEID == new_node_id_from_orig_id_map[source])
+            if (is_contracted)
             {
-                external_edge_list.push_back({source, target, data});
+                external_edge_list.push_back(
+                    {source, contractor_graph->GetTarget(current_edge), data});
             }
             else
             {
-                // node is not yet contracted.
-                // add (renumbered) outgoing edges to new util::DynamicGraph.
-                ContractorEdge new_edge = {new_node_id_from_orig_id_map[source],
-                                           new_node_id_from_orig_id_map[target],
-                                           data};
-                new_edge.data.is_original_via_node_ID = true;
-                BOOST_ASSERT_MSG(SPECIAL_NODEID != new_node_id_from_orig_id_map[source],
-                                 "new source id not resolveable");
-                BOOST_ASSERT_MSG(SPECIAL_NODEID != new_node_id_from_orig_id_map[target],
-                                 "new target id not resolveable");
-                new_edge_set.push_back(new_edge);
+                // node is not yet contracted, its edges are renumbered
+                data.is_original_via_node_ID = true;
             }
         }
     }
@@ -157,18 +162,16 @@ void GraphContractor::FlushDataAndRebuildContractorGraph(
     node_priorities.swap(new_node_priority);
     // Delete old node_priorities vector
     node_weights.swap(new_node_weights);
-    // old Graph is removed
-    contractor_graph.reset();
-    // create new graph
-    tbb::parallel_sort(new_edge_set.begin(), new_edge_set.end());
-    contractor_graph = std::make_shared<ContractorGraph>(remaining_nodes.size(), new_edge_set);
-    new_edge_set.clear();
+    // Renumber the remaining graph in place instead of copying its edges into a new one, so the
+    // flush does not need memory for a second graph
+    contractor_graph->Compact(new_node_id_from_orig_id_map);
+    BOOST_ASSERT(contractor_graph->GetNumberOfNodes() == remaining_nodes.size());
     // INFO: MAKE SURE THIS IS THE LAST OPERATION OF THE FLUSH!
     // reinitialize heaps and ThreadData objects with appropriate size
     thread_data_list.number_of_nodes = contractor_graph->GetNumberOfNodes();
 }
 
-void GraphContractor::Run(double core_factor)
+void GraphContractor::Run(double core_factor, bool fixed_order)
 {
     // for the preperation we can use a big grain size, which is much faster (probably cache)
     const constexpr size_t InitGrainSize = 100000;
@@ -182,61 +185,102 @@ void GraphContractor::Run(double core_factor)
     const constexpr size_t DeleteGrainSize = 1;
 
     const NodeID number_of_nodes = contractor_graph->GetNumberOfNodes();
+    const EdgeID number_of_edges = contractor_graph->GetNumberOfEdges();
 
     ThreadDataContainer thread_data_list(number_of_nodes);
 
     NodeID number_of_contracted_nodes = 0;
+    unsigned current_level = 0;
+    bool flushed_contractor = false;
     std::vector<NodeDepth> node_depth;
     std::vector<float> node_priorities;
-    is_core_node.resize(number_of_nodes, false);
-
-    std::vector<RemainingNodeData> remaining_nodes(number_of_nodes);
-    // initialize priorities in parallel
-    tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes, InitGrainSize),
-                      [this, &remaining_nodes](const tbb::blocked_range<NodeID> &range) {
-                          for (auto x = range.begin(), end = range.end(); x != end; ++x)
-                          {
-                              remaining_nodes[x].id = x;
-                          }
-                      });
-
+    std::vector<RemainingNodeData> remaining_nodes;
     bool use_cached_node_priorities = !node_levels.empty();
-    if (use_cached_node_priorities)
+
+    if (resume_from_checkpoint && boost::filesystem::exists(checkpoint_path))
     {
         util::UnbufferedLog log;
-        log << "using cached node priorities ...";
-        node_priorities.swap(node_levels);
-        log << "ok";
+        log << "resuming from checkpoint " << checkpoint_path.string() << " ...";
+        const auto progress = ReadCheckpoint(
+            number_of_nodes, number_of_edges, remaining_nodes, node_priorities, node_depth);
+        number_of_contracted_nodes = progress.number_of_contracted_nodes;
+        current_level = progress.current_level;
+        flushed_contractor = progress.flushed_contractor;
+        use_cached_node_priorities = progress.use_cached_node_priorities;
+        fixed_order = progress.fixed_order;
+        log << "ok, " << number_of_contracted_nodes << " nodes contracted";
     }
     else
     {
-        node_depth.resize(number_of_nodes, 0);
-        node_priorities.resize(number_of_nodes);
-        node_levels.resize(number_of_nodes);
+        is_core_node.resize(number_of_nodes, false);
 
-        util::UnbufferedLog log;
-        log << "initializing elimination PQ ...";
-        tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes, PQGrainSize),
-                          [this, &node_priorities, &node_depth, &thread_data_list](
-                              const tbb::blocked_range<NodeID> &range) {
-                              ContractorThreadData *data = thread_data_list.GetThreadData();
+        remaining_nodes.resize(number_of_nodes);
+        // initialize priorities in parallel
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes, InitGrainSize),
+                          [this, &remaining_nodes](const tbb::blocked_range<NodeID> &range) {
                               for (auto x = range.begin(), end = range.end(); x != end; ++x)
                               {
-                                  node_priorities[x] =
-                                      this->EvaluateNodePriority(data, node_depth[x], x);
+                                  remaining_nodes[x].id = x;
                               }
                           });
-        log << "ok";
+
+        round_stats.clear();
+        witness_hop_limit = 1;
+        UpdateWitnessHopLimit(remaining_nodes);
+
+        if (use_cached_node_priorities)
+        {
+            util::UnbufferedLog log;
+            log << "using cached node priorities ...";
+            node_priorities.swap(node_levels);
+            log << "ok";
+        }
+        else
+        {
+            node_depth.resize(number_of_nodes, 0);
+            node_priorities.resize(number_of_nodes);
+            node_levels.resize(number_of_nodes);
+
+            util::UnbufferedLog log;
+            log << "initializing elimination PQ ...";
+            tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes, PQGrainSize),
+                              [this, &node_priorities, &node_depth, &thread_data_list](
+                                  const tbb::blocked_range<NodeID> &range) {
+                                  ContractorThreadData *data = thread_data_list.GetThreadData();
+                                  for (auto x = range.begin(), end = range.end(); x != end; ++x)
+                                  {
+                                      node_priorities[x] =
+                                          this->EvaluateNodePriority(data, node_depth[x], x);
+                                  }
+                              });
+            log << "ok";
+        }
+        BOOST_ASSERT(node_priorities.size() == number_of_nodes);
+
+        // The cached levels are the rounds of the last contraction. Sorted by descending level
+        // the nodes of the next rounds are at the end of the remaining nodes.
+        fixed_order = fixed_order && use_cached_node_priorities;
+        if (fixed_order)
+        {
+            tbb::parallel_sort(remaining_nodes.begin(),
+                               remaining_nodes.end(),
+                               [&node_priorities](const auto lhs, const auto rhs) {
+                                   return node_priorities[lhs.id] > node_priorities[rhs.id];
+                               });
+        }
     }
-    BOOST_ASSERT(node_priorities.size() == number_of_nodes);
 
     util::Log() << "preprocessing " << number_of_nodes << " nodes ...";
 
     util::UnbufferedLog log;
     util::Percent p(log, number_of_nodes);
 
-    unsigned current_level = 0;
-    bool flushed_contractor = false;
+    for (auto &data : thread_data_list.data)
+    {
+        data->dijkstra.ResetStats();
+    }
+
+    auto next_checkpoint = std::chrono::steady_clock::now() + checkpoint_interval;
     while (remaining_nodes.size() > 1 &&
            number_of_contracted_nodes < static_cast<NodeID>(number_of_nodes * core_factor))
     {
@@ -250,8 +294,26 @@ void GraphContractor::Run(double core_factor)
             flushed_contractor = true;
         }
 
+        // In the fixed order only the nodes of the lowest level and the one above it can be
+        // independent, all others have a neighbour of lower level or wait for their own round.
+        // A node of the lowest level is left over if the new shortcuts connect it to another one.
+        NodeID begin_candidates = 0;
+        if (fixed_order)
+        {
+            const float last_candidate_level = node_priorities[remaining_nodes.back().id] + 1;
+            begin_candidates =
+                std::distance(remaining_nodes.begin(),
+                              std::partition_point(remaining_nodes.begin(),
+                                                   remaining_nodes.end(),
+                                                   [&](const RemainingNodeData node_data) {
+                                                       return node_priorities[node_data.id] >
+                                                              last_candidate_level;
+                                                   }));
+        }
+
         tbb::parallel_for(
-            tbb::blocked_range<NodeID>(0, remaining_nodes.size(), IndependentGrainSize),
+            tbb::blocked_range<NodeID>(
+                begin_candidates, remaining_nodes.size(), IndependentGrainSize),
             [this, &node_priorities, &remaining_nodes, &thread_data_list](
                 const tbb::blocked_range<NodeID> &range) {
                 ContractorThreadData *data = thread_data_list.GetThreadData();
@@ -266,7 +328,7 @@ void GraphContractor::Run(double core_factor)
 
         // sort all remaining nodes to the beginning of the sequence
         const auto begin_independent_nodes =
-            stable_partition(remaining_nodes.begin(),
+            stable_partition(remaining_nodes.begin() + begin_candidates,
                              remaining_nodes.end(),
                              [](RemainingNodeData node_data) { return !node_data.is_independent; });
         auto begin_independent_nodes_idx =
@@ -362,6 +424,13 @@ void GraphContractor::Run(double core_factor)
             data->inserted_edges.clear();
         }
 
+        // Nodes that outgrow their edges move them to the end of the edge list, remove the
+        // dummies they leave behind once they take as much memory as the edges
+        if (contractor_graph->GetNumberOfEdgeSlots() > 2 * contractor_graph->GetNumberOfEdges())
+        {
+            contractor_graph->Compact();
+        }
+
         if (!use_cached_node_priorities)
         {
             tbb::parallel_for(
@@ -382,10 +451,41 @@ void GraphContractor::Run(double core_factor)
         // remove contracted nodes from the pool
         BOOST_ASSERT(end_independent_nodes_idx - begin_independent_nodes_idx > 0);
         number_of_contracted_nodes += end_independent_nodes_idx - begin_independent_nodes_idx;
+
+        ContractionRoundStats round{static_cast<NodeID>(remaining_nodes.size()),
+                                    static_cast<NodeID>(end_independent_nodes_idx -
+                                                        begin_independent_nodes_idx),
+                                    0,
+                                    witness_hop_limit,
+                                    {}};
+        for (auto &data : thread_data_list.data)
+        {
+            round.witness_searches += data->dijkstra.GetStats();
+            data->dijkstra.ResetStats();
+        }
+
         remaining_nodes.resize(begin_independent_nodes_idx);
+        round.average_degree = UpdateWitnessHopLimit(remaining_nodes);
+        round_stats.push_back(round);
 
         p.PrintStatus(number_of_contracted_nodes);
         ++current_level;
+
+        if (!checkpoint_path.empty() && std::chrono::steady_clock::now() >= next_checkpoint)
+        {
+            log << " [checkpoint " << number_of_contracted_nodes << " nodes] ";
+            WriteCheckpoint({number_of_nodes,
+                             number_of_edges,
+                             number_of_contracted_nodes,
+                             current_level,
+                             flushed_contractor,
+                             use_cached_node_priorities,
+                             fixed_order},
+                            remaining_nodes,
+                            node_priorities,
+                            node_depth);
+            next_checkpoint = std::chrono::steady_clock::now() + checkpoint_interval;
+        }
     }
 
     if (remaining_nodes.size() > 2)
@@ -427,6 +527,108 @@ void GraphContractor::Run(double core_factor)
     thread_data_list.data.clear();
 }
 
+float GraphContractor::UpdateWitnessHopLimit(const std::vector<RemainingNodeData> &remaining_nodes)
+{
+    // The stages of Geisberger et al.: while the graph is sparse most witnesses are a single edge
+    // or a path of two, denser graphs need full searches that are only bounded by the settled
+    // nodes to avoid adding too many shortcuts
+    const constexpr float ONE_HOP_MAX_DEGREE = 3.3;
+    const constexpr float TWO_HOPS_MAX_DEGREE = 10;
+
+    if (remaining_nodes.empty())
+    {
+        return 0;
+    }
+    std::uint64_t degree = 0;
+    for (const auto node_data : remaining_nodes)
+    {
+        degree += contractor_graph->GetOutDegree(node_data.id);
+    }
+    const float average_degree = static_cast<float>(degree) / remaining_nodes.size();
+
+    short stage_limit = std::numeric_limits<short>::max();
+    if (average_degree < ONE_HOP_MAX_DEGREE)
+    {
+        stage_limit = 1;
+    }
+    else if (average_degree < TWO_HOPS_MAX_DEGREE)
+    {
+        stage_limit = 2;
+    }
+    witness_hop_limit = std::max(witness_hop_limit, stage_limit);
+    return average_degree;
+}
+
+void GraphContractor::UseCheckpoint(boost::filesystem::path path,
+                                    std::chrono::seconds interval,
+                                    bool resume)
+{
+    checkpoint_path = std::move(path);
+    checkpoint_interval = interval;
+    resume_from_checkpoint = resume;
+}
+
+void GraphContractor::WriteCheckpoint(const ContractionProgress &progress,
+                                      const std::vector<RemainingNodeData> &remaining_nodes,
+                                      const std::vector<float> &node_priorities,
+                                      const std::vector<NodeDepth> &node_depth) const
+{
+    // a preemption while writing must not destroy the last checkpoint
+    auto temporary_path = checkpoint_path;
+    temporary_path += ".tmp";
+    {
+        storage::io::FileWriter writer(temporary_path,
+                                       storage::io::FileWriter::GenerateFingerprint);
+        writer.WriteOne(progress);
+        writer.WriteOne(witness_hop_limit);
+        storage::serialization::write(writer, remaining_nodes);
+        storage::serialization::write(writer, node_priorities);
+        storage::serialization::write(writer, node_depth);
+        storage::serialization::write(writer, node_levels);
+        storage::serialization::write(writer, node_weights);
+        storage::serialization::write(writer, is_core_node);
+        storage::serialization::write(writer, orig_node_id_from_new_node_id_map);
+        storage::serialization::write(writer, external_edge_list);
+        storage::serialization::write(writer, round_stats);
+        util::serialization::write(writer, *contractor_graph);
+    }
+    boost::filesystem::rename(temporary_path, checkpoint_path);
+}
+
+GraphContractor::ContractionProgress
+GraphContractor::ReadCheckpoint(const NodeID number_of_nodes,
+                                const EdgeID number_of_edges,
+                                std::vector<RemainingNodeData> &remaining_nodes,
+                                std::vector<float> &node_priorities,
+                                std::vector<NodeDepth> &node_depth)
+{
+    storage::io::FileReader reader(checkpoint_path, storage::io::FileReader::VerifyFingerprint);
+    const auto progress = reader.ReadOne<ContractionProgress>();
+    if (progress.number_of_nodes != number_of_nodes || progress.number_of_edges != number_of_edges)
+    {
+        throw util::exception("Checkpoint " + checkpoint_path.string() + " of a graph with " +
+                              std::to_string(progress.number_of_nodes) + " nodes and " +
+                              std::to_string(progress.number_of_edges) +
+                              " edges does not fit the graph with " +
+                              std::to_string(number_of_nodes) + " nodes and " +
+                              std::to_string(number_of_edges) + " edges" + SOURCE_REF);
+    }
+    reader.ReadInto(witness_hop_limit);
+    storage::serialization::read(reader, remaining_nodes);
+    storage::serialization::read(reader, node_priorities);
+    storage::serialization::read(reader, node_depth);
+    storage::serialization::read(reader, node_levels);
+    storage::serialization::read(reader, node_weights);
+    // the core marker is not resized by the read
+    is_core_node.resize(number_of_nodes);
+    storage::serialization::read(reader, is_core_node);
+    storage::serialization::read(reader, orig_node_id_from_new_node_id_map);
+    storage::serialization::read(reader, external_edge_list);
+    storage::serialization::read(reader, round_stats);
+    util::serialization::read(reader, *contractor_graph);
+    return progress;
+}
+
 // Can only be called once because it invalides the marker
 std::vector<bool> GraphContractor::GetCoreMarker() { return std::move(is_core_node); }
 
@@ -0,0 +1,231 @@
+#include "contractor/query_benchmark.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/query_heap.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/range/iterator_range.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+namespace
+{
+using Heap =
+    util::QueryHeap<NodeID, NodeID, EdgeWeight, NodeID, util::ArrayStorage<NodeID, NodeID>>;
+
+// same seed for every hierarchy, so they answer the same queries
+const constexpr unsigned WORKLOAD_SEED = 42;
+
+template <bool FORWARD> auto getEdgeRange(const QueryGraph &graph, const NodeID node)
+{
+    return graph.GetAdjacentEdgeRange(node);
+}
+
+template <bool FORWARD> auto getEdgeRange(const PackedQueryGraph &graph, const NodeID node)
+{
+    return FORWARD ? graph.GetForwardEdgeRange(node) : graph.GetBackwardEdgeRange(node);
+}
+
+template <bool FORWARD, typename GraphT>
+void relaxEdges(const GraphT &graph, Heap &heap, const NodeID node, const EdgeWeight weight)
+{
+    for (const auto edge : getEdgeRange<FORWARD>(graph, node))
+    {
+        const auto &data = graph.GetEdgeData(edge);
+        if (FORWARD ? !data.forward : !data.backward)
+        {
+            continue;
+        }
+        const NodeID to = graph.GetTarget(edge);
+        const EdgeWeight to_weight = weight + data.weight;
+        if (!heap.WasInserted(to))
+        {
+            heap.Insert(to, to_weight, node);
+        }
+        else if (to_weight < heap.GetKey(to))
+        {
+            heap.GetData(to) = node;
+            heap.DecreaseKey(to, to_weight);
+        }
+    }
+}
+
+// Settles the next node of the heap and updates the best weight if the other search reached it
+template <bool FORWARD, typename GraphT>
+void routingStep(const GraphT &graph, Heap &heap, const Heap &other_heap, EdgeWeight &best)
+{
+    const NodeID node = heap.DeleteMin();
+    const EdgeWeight weight = heap.GetKey(node);
+    if (other_heap.WasInserted(node))
+    {
+        best = std::min(best, weight + other_heap.GetKey(node));
+    }
+    relaxEdges<FORWARD>(graph, heap, node, weight);
+}
+
+template <typename GraphT>
+std::size_t route(const GraphT &graph,
+                  Heap &forward_heap,
+                  Heap &backward_heap,
+                  const NodeID source,
+                  const NodeID target)
+{
+    forward_heap.Clear();
+    backward_heap.Clear();
+    forward_heap.Insert(source, 0, source);
+    backward_heap.Insert(target, 0, target);
+
+    EdgeWeight best = INVALID_EDGE_WEIGHT;
+    std::size_t settled_nodes = 0;
+    // a search can stop once it only settles nodes behind the best path
+    while (true)
+    {
+        const bool forward = !forward_heap.Empty() && forward_heap.MinKey() < best;
+        const bool backward = !backward_heap.Empty() && backward_heap.MinKey() < best;
+        if (!forward && !backward)
+        {
+            break;
+        }
+        if (forward)
+        {
+            routingStep<true>(graph, forward_heap, backward_heap, best);
+            ++settled_nodes;
+        }
+        if (backward)
+        {
+            routingStep<false>(graph, backward_heap, forward_heap, best);
+            ++settled_nodes;
+        }
+    }
+    return settled_nodes;
+}
+
+struct Bucket
+{
+    NodeID node;
+    std::uint32_t target_index;
+    EdgeWeight weight;
+
+    bool operator<(const Bucket &other) const { return node < other.node; }
+};
+
+// Returns the number of connected pairs
+template <typename GraphT>
+std::size_t table(const GraphT &graph, Heap &heap, const std::vector<NodeID> &nodes)
+{
+    std::vector<Bucket> buckets;
+    for (const auto target_index : util::irange<std::uint32_t>(0, nodes.size()))
+    {
+        heap.Clear();
+        heap.Insert(nodes[target_index], 0, nodes[target_index]);
+        while (!heap.Empty())
+        {
+            const NodeID node = heap.DeleteMin();
+            const EdgeWeight weight = heap.GetKey(node);
+            buckets.push_back({node, target_index, weight});
+            relaxEdges<false>(graph, heap, node, weight);
+        }
+    }
+    std::sort(buckets.begin(), buckets.end());
+
+    std::vector<EdgeWeight> weights(nodes.size() * nodes.size(), INVALID_EDGE_WEIGHT);
+    for (const auto source_index : util::irange<std::size_t>(0, nodes.size()))
+    {
+        heap.Clear();
+        heap.Insert(nodes[source_index], 0, nodes[source_index]);
+        while (!heap.Empty())
+        {
+            const NodeID node = heap.DeleteMin();
+            const EdgeWeight weight = heap.GetKey(node);
+            const auto range =
+                std::equal_range(buckets.begin(), buckets.end(), Bucket{node, 0, 0});
+            for (const auto &bucket : boost::make_iterator_range(range.first, range.second))
+            {
+                auto &table_weight = weights[source_index * nodes.size() + bucket.target_index];
+                table_weight = std::min(table_weight, weight + bucket.weight);
+            }
+            relaxEdges<true>(graph, heap, node, weight);
+        }
+    }
+    return std::count_if(weights.begin(), weights.end(), [](const EdgeWeight weight) {
+        return weight != INVALID_EDGE_WEIGHT;
+    });
+}
+
+template <typename GraphT>
+QueryBenchmarkResult benchmarkQueriesOn(const GraphT &graph,
+                                        const std::size_t number_of_routes,
+                                        const std::size_t table_size)
+{
+    QueryBenchmarkResult result{0, 0, 0, 0};
+    const auto number_of_nodes = graph.GetNumberOfNodes();
+    if (number_of_nodes == 0)
+    {
+        return result;
+    }
+
+    std::mt19937 generator(WORKLOAD_SEED);
+    std::uniform_int_distribution<NodeID> random_node(0, number_of_nodes - 1);
+    Heap forward_heap(number_of_nodes);
+    Heap backward_heap(number_of_nodes);
+
+    if (number_of_routes > 0)
+    {
+        std::vector<std::pair<NodeID, NodeID>> routes(number_of_routes);
+        for (auto &pair : routes)
+        {
+            pair = std::make_pair(random_node(generator), random_node(generator));
+        }
+
+        std::size_t settled_nodes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto &pair : routes)
+        {
+            settled_nodes += route(graph, forward_heap, backward_heap, pair.first, pair.second);
+        }
+        const std::chrono::duration<double, std::milli> duration =
+            std::chrono::steady_clock::now() - start;
+        result.route_milliseconds = duration.count() / number_of_routes;
+        result.route_settled_nodes = static_cast<double>(settled_nodes) / number_of_routes;
+    }
+
+    if (table_size > 0)
+    {
+        std::vector<NodeID> nodes(table_size);
+        std::generate(nodes.begin(), nodes.end(), [&] { return random_node(generator); });
+
+        const auto start = std::chrono::steady_clock::now();
+        result.table_connected_pairs = table(graph, forward_heap, nodes);
+        const std::chrono::duration<double, std::milli> duration =
+            std::chrono::steady_clock::now() - start;
+        result.table_milliseconds = duration.count();
+    }
+
+    return result;
+}
+}
+
+QueryBenchmarkResult benchmarkQueries(const QueryGraph &graph,
+                                      const std::size_t number_of_routes,
+                                      const std::size_t table_size)
+{
+    return benchmarkQueriesOn(graph, number_of_routes, table_size);
+}
+
+QueryBenchmarkResult benchmarkQueries(const PackedQueryGraph &graph,
+                                      const std::size_t number_of_routes,
+                                      const std::size_t table_size)
+{
+    return benchmarkQueriesOn(graph, number_of_routes, table_size);
+}
+}
+}
@@ -0,0 +1,94 @@
+#include "contractor/renumber.hpp"
+
+#include "util/hilbert_value.hpp"
+#include "util/integer_range.hpp"
+
+#include <tbb/parallel_sort.h>
+
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace osrm
+{
+namespace contractor
+{
+
+std::vector<std::uint64_t>
+getNodeHilbertCodes(const NodeID number_of_nodes,
+                    const util::vector_view<const extractor::EdgeBasedNodeSegment> &segments,
+                    const std::vector<util::Coordinate> &coordinates)
+{
+    const auto NO_CODE = std::numeric_limits<std::uint64_t>::max();
+    std::vector<std::uint64_t> codes(number_of_nodes, NO_CODE);
+    const auto set_code = [&](const SegmentID segment_id, const NodeID coordinate_id) {
+        if (segment_id.enabled && codes[segment_id.id] == NO_CODE)
+        {
+            codes[segment_id.id] = util::GetHilbertCode(coordinates[coordinate_id]);
+        }
+    };
+    for (const auto &segment : segments)
+    {
+        set_code(segment.forward_segment_id, segment.u);
+        set_code(segment.reverse_segment_id, segment.v);
+    }
+    return codes;
+}
+
+std::vector<NodeID> makeLocalityPermutation(const std::vector<float> &node_levels,
+                                            const std::vector<bool> &is_core_node,
+                                            const std::vector<std::uint64_t> &hilbert_codes)
+{
+    BOOST_ASSERT(node_levels.size() == hilbert_codes.size());
+    BOOST_ASSERT(is_core_node.empty() || is_core_node.size() == hilbert_codes.size());
+
+    std::vector<NodeID> ordering(hilbert_codes.size());
+    std::iota(ordering.begin(), ordering.end(), 0);
+
+    const auto key = [&](const NodeID node) {
+        const bool is_core = !is_core_node.empty() && is_core_node[node];
+        return std::make_tuple(!is_core, -node_levels[node], hilbert_codes[node], node);
+    };
+    tbb::parallel_sort(ordering.begin(), ordering.end(), [&](const NodeID lhs, const NodeID rhs) {
+        return key(lhs) < key(rhs);
+    });
+
+    std::vector<NodeID> permutation(ordering.size());
+    for (const auto index : util::irange<NodeID>(0, ordering.size()))
+        permutation[ordering[index]] = index;
+
+    return permutation;
+}
+
+void renumber(util::DeallocatingVector<QueryEdge> &edges, const std::vector<NodeID> &permutation)
+{
+    for (auto &edge : edges)
+    {
+        edge.source = permutation[edge.source];
+        edge.target = permutation[edge.target];
+        // the turn id of a shortcut is the node it bypasses
+        if (edge.data.shortcut)
+        {
+            edge.data.turn_id = permutation[edge.data.turn_id];
+        }
+    }
+    tbb::parallel_sort(edges.begin(), edges.end());
+}
+
+void renumber(std::vector<bool> &is_core_node, const std::vector<NodeID> &permutation)
+{
+    if (is_core_node.empty())
+    {
+        return;
+    }
+
+    BOOST_ASSERT(is_core_node.size() == permutation.size());
+    std::vector<bool> renumbered(is_core_node.size());
+    for (const auto node : util::irange<NodeID>(0, is_core_node.size()))
+    {
+        renumbered[permutation[node]] = is_core_node[node];
+    }
+    is_core_node = std::move(renumbered);
+}
+}
+}
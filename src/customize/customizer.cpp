@@ -1,6 +1,13 @@
 #include "customizer/customizer.hpp"
 #include "customizer/cell_customizer.hpp"
 #include "customizer/edge_based_graph.hpp"
+#include "customizer/files.hpp"
+#include "customizer/landmarks.hpp"
+
+#include "extractor/class_data.hpp"
+#include "extractor/files.hpp"
+#include "extractor/node_data_container.hpp"
+#include "extractor/profile_properties.hpp"
 
 #include "partition/cell_storage.hpp"
 #include "partition/edge_based_graph_reader.hpp"
@@ -9,11 +16,20 @@
 
 #include "storage/shared_memory_ownership.hpp"
 
+#include "updater/speed_profiles.hpp"
 #include "updater/updater.hpp"
 
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/log.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/timing_util.hpp"
 
+#include <boost/filesystem/operations.hpp>
+#include <boost/scope_exit.hpp>
+
+#include <future>
+
 namespace osrm
 {
 namespace customizer
@@ -72,13 +88,15 @@ void CellStorageStatistics(const Graph &graph,
 }
 
 auto LoadAndUpdateEdgeExpandedGraph(const CustomizationConfig &config,
-                                    const partition::MultiLevelPartition &mlp)
+                                    const partition::MultiLevelPartition &mlp,
+                                    std::vector<NodeID> &updated_nodes)
 {
     updater::Updater updater(config.updater_config);
 
     EdgeID num_nodes;
     std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
-    std::tie(num_nodes, edge_based_edge_list) = updater.LoadAndUpdateEdgeExpandedGraph();
+    std::tie(num_nodes, edge_based_edge_list) =
+        updater.LoadAndUpdateEdgeExpandedGraph(updated_nodes);
 
     auto directed = partition::splitBidirectionalEdges(edge_based_edge_list);
     auto tidied =
@@ -93,36 +111,254 @@ auto LoadAndUpdateEdgeExpandedGraph(const CustomizationConfig &config,
     return edge_based_graph;
 }
 
+// The edges of the metric without the edges that leave or enter nodes of the excluded classes
+std::vector<extractor::EdgeBasedEdge>
+ExcludeClasses(std::vector<extractor::EdgeBasedEdge> edges,
+               const extractor::EdgeBasedNodeDataContainer &node_data,
+               const extractor::ClassData excluded_classes)
+{
+    for (auto &edge : edges)
+    {
+        if ((node_data.GetClassData(edge.source) & excluded_classes) != 0 ||
+            (node_data.GetClassData(edge.target) & excluded_classes) != 0)
+        {
+            edge.data.weight = INVALID_EDGE_WEIGHT;
+        }
+    }
+    return edges;
+}
+
+// One graph per metric, their edges only differ in the edge data. The additional metrics are
+// updated first and do not save their updates, so all metrics start from the same .osrm files.
+// The time slots of the speed profiles follow them, then the metrics that exclude classes. These
+// are metric 0 without the excluded edges, in the order of ProfileProperties::excludable_classes.
+auto LoadAndUpdateMetricGraphs(const CustomizationConfig &config,
+                               const partition::MultiLevelPartition &mlp,
+                               const std::vector<extractor::ClassData> &excludable_classes,
+                               const updater::SpeedProfiles *speed_profiles,
+                               std::vector<NodeID> &updated_nodes)
+{
+    std::vector<std::vector<extractor::EdgeBasedEdge>> metric_edges(
+        config.metric_speed_lookup_paths.size() + 1);
+
+    EdgeID num_nodes = 0;
+    for (std::size_t metric = 1; metric < metric_edges.size(); ++metric)
+    {
+        auto metric_config = config.updater_config;
+        metric_config.segment_speed_lookup_paths = config.metric_speed_lookup_paths[metric - 1];
+        metric_config.save_updates = false;
+
+        std::vector<NodeID> metric_updated_nodes;
+        std::tie(num_nodes, metric_edges[metric]) =
+            updater::Updater(metric_config).LoadAndUpdateEdgeExpandedGraph(metric_updated_nodes);
+    }
+
+    const auto num_slots = speed_profiles ? speed_profiles->GetNumberOfSlots() : 0;
+    for (std::size_t slot = 0; slot < num_slots; ++slot)
+    {
+        // the segment profile file is the only datasource of the slot speeds
+        auto slot_config = config.updater_config;
+        slot_config.segment_speed_lookup_paths = {config.segment_profile_path};
+        slot_config.save_updates = false;
+
+        util::Log() << "Updating the metric of time slot " << slot << " of " << num_slots;
+        std::vector<NodeID> slot_updated_nodes;
+        std::vector<extractor::EdgeBasedEdge> slot_edges;
+        std::tie(num_nodes, slot_edges) =
+            updater::Updater(slot_config, speed_profiles->GetSlotSpeeds(slot))
+                .LoadAndUpdateEdgeExpandedGraph(slot_updated_nodes);
+        metric_edges.push_back(std::move(slot_edges));
+    }
+    std::tie(num_nodes, metric_edges.front()) =
+        updater::Updater(config.updater_config).LoadAndUpdateEdgeExpandedGraph(updated_nodes);
+
+    if (!excludable_classes.empty())
+    {
+        extractor::EdgeBasedNodeDataContainer node_data;
+        extractor::files::readNodeData(config.updater_config.GetPath(".osrm.ebg_nodes"),
+                                       node_data);
+        for (const auto classes : excludable_classes)
+        {
+            metric_edges.push_back(ExcludeClasses(metric_edges.front(), node_data, classes));
+        }
+    }
+
+    auto tidied =
+        partition::prepareMetricEdgesForUsageInGraph<StaticEdgeBasedGraphEdge>(metric_edges);
+    metric_edges.clear();
+
+    std::vector<std::unique_ptr<customizer::MultiLevelEdgeBasedGraph>> graphs;
+    for (auto &edges : tidied)
+    {
+        graphs.push_back(
+            std::make_unique<customizer::MultiLevelEdgeBasedGraph>(mlp, num_nodes, edges));
+        edges.clear();
+        edges.shrink_to_fit();
+    }
+
+    util::Log() << "Loaded edge based graph of " << graphs.size()
+                << " metrics for mapping partition ids: " << graphs.front()->GetNumberOfEdges()
+                << " edges, " << graphs.front()->GetNumberOfNodes() << " nodes";
+
+    return graphs;
+}
+
 int Customizer::Run(const CustomizationConfig &config)
 {
     TIMER_START(loading_data);
+    util::ProfilePhase loading_data_phase("loading data");
 
     partition::MultiLevelPartition mlp;
     partition::files::readPartition(config.GetPath(".osrm.partition"), mlp);
 
-    auto edge_based_graph = LoadAndUpdateEdgeExpandedGraph(config, mlp);
-
+    // The cells are read while the updater parses the speed files and updates the graph, and
+    // written while the landmarks are computed and the graph is written. Makes sure both are
+    // done before the storage goes out of scope.
     partition::CellStorage storage;
-    partition::files::readCells(config.GetPath(".osrm.cells"), storage);
+    std::future<void> cells_reading;
+    std::future<void> cells_writing;
+    BOOST_SCOPE_EXIT_ALL(&)
+    {
+        if (cells_reading.valid())
+            cells_reading.wait();
+        if (cells_writing.valid())
+            cells_writing.wait();
+    };
+
+    cells_reading = std::async(std::launch::async, [&] {
+        partition::files::readCells(config.GetPath(".osrm.cells"), storage);
+        storage.Dequantize();
+    });
+
+    extractor::ProfileProperties properties;
+    extractor::files::readProfileProperties(config.updater_config.GetPath(".osrm.properties"),
+                                            properties);
+    const auto excludable_classes = properties.GetExcludableClasses();
+
+    std::unique_ptr<updater::SpeedProfiles> speed_profiles;
+    if (!config.speed_profile_path.empty())
+    {
+        speed_profiles = std::make_unique<updater::SpeedProfiles>(config.speed_profile_path,
+                                                                  config.segment_profile_path);
+    }
+    const std::uint32_t num_time_slots = speed_profiles ? speed_profiles->GetNumberOfSlots() : 0;
+
+    std::vector<NodeID> updated_nodes;
+    std::vector<std::unique_ptr<customizer::MultiLevelEdgeBasedGraph>> graphs;
+    if (config.metric_speed_lookup_paths.empty() && excludable_classes.empty() &&
+        num_time_slots == 0)
+    {
+        graphs.push_back(LoadAndUpdateEdgeExpandedGraph(config, mlp, updated_nodes));
+    }
+    else
+    {
+        graphs = LoadAndUpdateMetricGraphs(
+            config, mlp, excludable_classes, speed_profiles.get(), updated_nodes);
+    }
+    speed_profiles.reset();
+
+    // queries find the metrics of the time slots by their number
+    if (properties.num_time_slots != num_time_slots)
+    {
+        properties.num_time_slots = num_time_slots;
+        extractor::files::writeProfileProperties(
+            config.updater_config.GetPath(".osrm.properties"), properties);
+    }
+    auto &edge_based_graph = graphs.front();
+
+    cells_reading.get();
+    if (config.incremental && storage.GetNumberOfMetrics() != graphs.size())
+    {
+        throw util::exception("The cells hold " + std::to_string(storage.GetNumberOfMetrics()) +
+                              " metrics instead of " + std::to_string(graphs.size()) +
+                              ", incremental customization needs a full run first" + SOURCE_REF);
+    }
+    storage.SetNumberOfMetrics(graphs.size());
     TIMER_STOP(loading_data);
+    loading_data_phase.Stop();
     util::Log() << "Loading partition data took " << TIMER_SEC(loading_data) << " seconds";
 
     TIMER_START(cell_customize);
+    util::ProfilePhase cell_customize_phase("cell customization");
     CellCustomizer customizer(mlp);
-    customizer.Customize(*edge_based_graph, storage);
+    if (config.incremental)
+    {
+        // the metrics that exclude classes are updated at the same nodes as metric 0
+        std::size_t num_customized = 0;
+        for (std::size_t metric = 0; metric < graphs.size(); ++metric)
+        {
+            storage.SelectMetric(metric);
+            num_customized += customizer.Customize(*graphs[metric], storage, updated_nodes);
+        }
+        storage.SelectMetric(0);
+        util::Log() << "Customized " << num_customized << " cells of " << graphs.size()
+                    << " metrics with " << updated_nodes.size() << " updated nodes";
+    }
+    else
+    {
+        for (std::size_t metric = 0; metric < graphs.size(); ++metric)
+        {
+            storage.SelectMetric(metric);
+            customizer.Customize(*graphs[metric], storage);
+        }
+        storage.SelectMetric(0);
+    }
     TIMER_STOP(cell_customize);
+    cell_customize_phase.Stop();
     util::Log() << "Cells customization took " << TIMER_SEC(cell_customize) << " seconds";
 
     TIMER_START(writing_mld_data);
-    partition::files::writeCells(config.GetPath(".osrm.cells"), storage);
-    TIMER_STOP(writing_mld_data);
-    util::Log() << "MLD customization writing took " << TIMER_SEC(writing_mld_data) << " seconds";
+    util::ProfilePhase writing_mld_data_phase("writing MLD data");
+    if (config.quantize_cell_metrics)
+    {
+        const auto exact_size = storage.GetMemorySize();
+        storage.Quantize();
+        util::Log() << "Quantized the cell metrics from " << exact_size << " to "
+                    << storage.GetMemorySize() << " bytes";
+    }
+    // the landmarks and the graph writing are nested in this phase, it ends once the cells are
+    // written
+    cells_writing = std::async(std::launch::async, [&] {
+        partition::files::writeCells(config.GetPath(".osrm.cells"), storage);
+    });
+
+    // landmarks of an earlier metric 0 would no longer bound the weights
+    TIMER_START(landmarks);
+    util::ProfilePhase landmarks_phase("landmarks");
+    if (config.num_landmarks > 0)
+    {
+        const auto landmarks = computeLandmarks(*edge_based_graph, config.num_landmarks);
+        files::writeLandmarks(config.GetPath(".osrm.landmarks"), landmarks);
+    }
+    else if (boost::filesystem::exists(config.GetPath(".osrm.landmarks")))
+    {
+        boost::filesystem::remove(config.GetPath(".osrm.landmarks"));
+    }
+    TIMER_STOP(landmarks);
+    landmarks_phase.Stop();
+    if (config.num_landmarks > 0)
+    {
+        util::Log() << "Computing " << config.num_landmarks << " landmarks took "
+                    << TIMER_SEC(landmarks) << " seconds";
+    }
 
     TIMER_START(writing_graph);
+    util::ProfilePhase writing_graph_phase("writing graph");
+    for (std::size_t metric = 1; metric < graphs.size(); ++metric)
+    {
+        edge_based_graph->AddMetric(*graphs[metric]);
+        graphs[metric].reset();
+    }
     partition::files::writeGraph(config.GetPath(".osrm.mldgr"), *edge_based_graph);
     TIMER_STOP(writing_graph);
+    writing_graph_phase.Stop();
     util::Log() << "Graph writing took " << TIMER_SEC(writing_graph) << " seconds";
 
+    cells_writing.get();
+    TIMER_STOP(writing_mld_data);
+    writing_mld_data_phase.Stop();
+    util::Log() << "MLD customization writing took " << TIMER_SEC(writing_mld_data) << " seconds";
+
     CellStorageStatistics(*edge_based_graph, mlp, storage);
 
     return 0;
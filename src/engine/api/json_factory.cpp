@@ -174,6 +174,7 @@ std::string modeToString(const extractor::TravelMode mode)
 util::json::Object makeStepManeuver(const guidance::StepManeuver &maneuver)
 {
     util::json::Object step_maneuver;
+    step_maneuver.values.reserve(6);
 
     std::string maneuver_type;
 
@@ -203,6 +204,7 @@ util::json::Object makeStepManeuver(const guidance::StepManeuver &maneuver)
 util::json::Object makeIntersection(const guidance::IntermediateIntersection &intersection)
 {
     util::json::Object result;
+    result.values.reserve(7);
     util::json::Array bearings;
     util::json::Array entry;
 
@@ -224,8 +226,8 @@ util::json::Object makeIntersection(const guidance::IntermediateIntersection &in
                    });
 
     result.values["location"] = detail::coordinateToLonLat(intersection.location);
-    result.values["bearings"] = bearings;
-    result.values["entry"] = entry;
+    result.values["bearings"] = std::move(bearings);
+    result.values["entry"] = std::move(entry);
     if (intersection.in != guidance::IntermediateIntersection::NO_INDEX)
         result.values["in"] = intersection.in;
     if (intersection.out != guidance::IntermediateIntersection::NO_INDEX)
@@ -252,24 +254,25 @@ util::json::Object makeIntersection(const guidance::IntermediateIntersection &in
 util::json::Object makeRouteStep(guidance::RouteStep step, util::json::Value geometry)
 {
     util::json::Object route_step;
+    route_step.values.reserve(14);
     route_step.values["distance"] = std::round(step.distance * 10) / 10.;
     route_step.values["duration"] = step.duration;
     route_step.values["weight"] = step.weight;
-    route_step.values["name"] = std::move(step.name);
+    route_step.values["name"] = step.name.to_string();
     if (!step.ref.empty())
-        route_step.values["ref"] = std::move(step.ref);
+        route_step.values["ref"] = step.ref.to_string();
     if (!step.pronunciation.empty())
-        route_step.values["pronunciation"] = std::move(step.pronunciation);
+        route_step.values["pronunciation"] = step.pronunciation.to_string();
     if (!step.destinations.empty())
-        route_step.values["destinations"] = std::move(step.destinations);
+        route_step.values["destinations"] = step.destinations.to_string();
     if (!step.exits.empty())
-        route_step.values["exits"] = std::move(step.exits);
+        route_step.values["exits"] = step.exits.to_string();
     if (!step.rotary_name.empty())
     {
-        route_step.values["rotary_name"] = std::move(step.rotary_name);
+        route_step.values["rotary_name"] = step.rotary_name.to_string();
         if (!step.rotary_pronunciation.empty())
         {
-            route_step.values["rotary_pronunciation"] = std::move(step.rotary_pronunciation);
+            route_step.values["rotary_pronunciation"] = step.rotary_pronunciation.to_string();
         }
     }
 
@@ -314,10 +317,13 @@ util::json::Object makeWaypoint(const util::Coordinate location, std::string nam
     return waypoint;
 }
 
-util::json::Object makeWaypoint(const util::Coordinate location, std::string name, const Hint &hint)
+util::json::Object makeWaypoint(const util::Coordinate location,
+                                std::string name,
+                                const Hint &hint,
+                                const bool compact_hint)
 {
     auto waypoint = makeWaypoint(location, name);
-    waypoint.values["hint"] = hint.ToBase64();
+    waypoint.values["hint"] = compact_hint ? hint.ToCompactBase64() : hint.ToBase64();
     return waypoint;
 }
 
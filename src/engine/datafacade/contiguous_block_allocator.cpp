@@ -0,0 +1,55 @@
+#include "engine/datafacade/contiguous_block_allocator.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/huge_pages.hpp"
+#include "util/log.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace osrm
+{
+namespace engine
+{
+namespace datafacade
+{
+
+void lockBlocks(ContiguousBlockAllocator &allocator)
+{
+    const auto &layout = allocator.GetLayout();
+    const auto memory = allocator.GetMemory();
+
+    std::uint64_t locked_bytes = 0;
+    for (auto block = 0; block < storage::DataLayout::NUM_BLOCKS; ++block)
+    {
+        const auto id = static_cast<storage::DataLayout::BlockID>(block);
+        const auto size = layout.GetBlockSize(id);
+        if (size == 0)
+        {
+            continue;
+        }
+
+        const auto begin = layout.GetAlignedBlockPtr(memory[storage::DataLayout::GetPart(id)], id);
+        if (!util::lockPages(begin, size))
+        {
+            const std::string error = std::strerror(errno);
+            throw util::exception(
+                "Could not lock the " + std::to_string(size) + " bytes of " +
+                storage::block_id_to_name[block] + " into RAM after locking " +
+                std::to_string(locked_bytes) + " bytes: " + error +
+                ". The limit of locked memory is " + util::describeLockedMemoryLimit() +
+                ", raise RLIMIT_MEMLOCK with ulimit -l or LimitMEMLOCK= of a systemd unit" +
+                SOURCE_REF);
+        }
+        util::Log() << "Locked " << size << " bytes of " << storage::block_id_to_name[block];
+        locked_bytes += size;
+    }
+    util::Log() << "Locked " << locked_bytes << " bytes of data into RAM";
+}
+
+} // namespace datafacade
+} // namespace engine
+} // namespace osrm
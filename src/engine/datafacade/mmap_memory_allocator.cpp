@@ -0,0 +1,122 @@
+#include "engine/datafacade/mmap_memory_allocator.hpp"
+#include "storage/memory_file.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+
+#include <boost/assert.hpp>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+namespace osrm
+{
+namespace engine
+{
+namespace datafacade
+{
+
+namespace
+{
+void adviseBlock(const storage::DataLayout &layout,
+                 char *memory,
+                 const storage::DataLayout::BlockID block,
+                 const EngineConfig::MemoryAdvice advice)
+{
+#ifndef _WIN32
+    const auto part = storage::DataLayout::GetPart(block);
+    const auto begin = reinterpret_cast<std::uintptr_t>(
+        layout.GetAlignedBlockPtr(layout.GetContiguousMemory(memory)[part], block));
+    const auto end = begin + layout.GetBlockSize(block);
+    const std::uintptr_t page_size = boost::iostreams::mapped_file::alignment();
+    const auto page_begin = begin / page_size * page_size;
+    if (begin == end)
+    {
+        return;
+    }
+
+    int posix_advice = POSIX_MADV_NORMAL;
+    switch (advice)
+    {
+    case EngineConfig::MemoryAdvice::Normal:
+        posix_advice = POSIX_MADV_NORMAL;
+        break;
+    case EngineConfig::MemoryAdvice::Random:
+        posix_advice = POSIX_MADV_RANDOM;
+        break;
+    case EngineConfig::MemoryAdvice::Sequential:
+        posix_advice = POSIX_MADV_SEQUENTIAL;
+        break;
+    case EngineConfig::MemoryAdvice::WillNeed:
+        posix_advice = POSIX_MADV_WILLNEED;
+        break;
+    }
+
+    const auto result =
+        posix_madvise(reinterpret_cast<void *>(page_begin), end - page_begin, posix_advice);
+    if (result != 0)
+    {
+        util::Log(logWARNING) << "Could not advise the kernel on block "
+                              << storage::block_id_to_name[block] << ": "
+                              << std::strerror(result);
+    }
+#else
+    (void)layout;
+    (void)memory;
+    (void)advice;
+    util::Log(logWARNING) << "Memory advice is not supported, ignoring it for block "
+                          << storage::block_id_to_name[block];
+#endif
+}
+}
+
+MMapMemoryAllocator::MMapMemoryAllocator(
+    const storage::StorageConfig &config,
+    const boost::filesystem::path &memory_file,
+    const std::map<std::string, EngineConfig::MemoryAdvice> &memory_advice)
+{
+    storage::MemoryFileHeader header;
+    storage::openMemoryFile(config, memory_file, mapped_memory, header);
+    layout = header.layout;
+    // mapped read-only, the facades never write to their memory
+    memory = const_cast<char *>(mapped_memory.data()) + header.data_offset;
+    BOOST_ASSERT(header.data_offset % boost::iostreams::mapped_file::alignment() == 0);
+
+    for (const auto &advice : memory_advice)
+    {
+        const auto name = std::find(std::begin(storage::block_id_to_name),
+                                    std::end(storage::block_id_to_name),
+                                    advice.first);
+        if (name == std::end(storage::block_id_to_name))
+        {
+            throw util::exception("Unknown block " + advice.first + " in memory advice" +
+                                  SOURCE_REF);
+        }
+        adviseBlock(layout,
+                    memory,
+                    static_cast<storage::DataLayout::BlockID>(
+                        std::distance(std::begin(storage::block_id_to_name), name)),
+                    advice.second);
+    }
+
+    util::Log() << "Mapped " << layout.GetSizeOfLayout() << " bytes of data from " << memory_file;
+}
+
+MMapMemoryAllocator::~MMapMemoryAllocator() {}
+
+storage::DataLayout &MMapMemoryAllocator::GetLayout() { return layout; }
+storage::DataLayout::Memory MMapMemoryAllocator::GetMemory()
+{
+    return layout.GetContiguousMemory(memory);
+}
+
+} // namespace datafacade
+} // namespace engine
+} // namespace osrm
@@ -1,5 +1,7 @@
 #include "engine/datafacade/process_memory_allocator.hpp"
 #include "storage/storage.hpp"
+#include "util/log.hpp"
+#include "util/numa.hpp"
 
 #include "boost/assert.hpp"
 
@@ -10,7 +12,10 @@ namespace engine
 namespace datafacade
 {
 
-ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &config)
+ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &config,
+                                               const bool use_huge_pages,
+                                               const EngineConfig::NUMAPlacement numa_placement,
+                                               const unsigned numa_node)
 {
     storage::Storage storage(config);
 
@@ -19,14 +24,37 @@ ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &con
     storage.PopulateLayout(*internal_layout);
 
     // Allocate the memory block, then load data from files into it
-    internal_memory = std::make_unique<char[]>(internal_layout->GetSizeOfLayout());
-    storage.PopulateData(*internal_layout, internal_memory.get());
+    internal_memory = std::make_unique<util::ProcessMemory>(internal_layout->GetSizeOfLayout(),
+                                                            use_huge_pages);
+    // The files are loaded by worker threads on any node, so the placement can't be left to
+    // the first touch of the calling thread
+    if (numa_placement == EngineConfig::NUMAPlacement::Interleave &&
+        util::numa::interleaveMemory(internal_memory->Get(), internal_layout->GetSizeOfLayout()))
+    {
+        util::Log() << "Process memory is interleaved over all NUMA nodes";
+    }
+    if (numa_placement == EngineConfig::NUMAPlacement::Replicate)
+    {
+        util::numa::bindMemory(
+            internal_memory->Get(), internal_layout->GetSizeOfLayout(), numa_node);
+    }
+    storage.PopulateData(*internal_layout,
+                         internal_layout->GetContiguousMemory(internal_memory->Get()));
+
+    if (use_huge_pages)
+    {
+        util::Log() << "Process memory is backed by "
+                    << util::describePages(internal_memory->Get());
+    }
 }
 
 ProcessMemoryAllocator::~ProcessMemoryAllocator() {}
 
 storage::DataLayout &ProcessMemoryAllocator::GetLayout() { return *internal_layout.get(); }
-char *ProcessMemoryAllocator::GetMemory() { return internal_memory.get(); }
+storage::DataLayout::Memory ProcessMemoryAllocator::GetMemory()
+{
+    return internal_layout->GetContiguousMemory(internal_memory->Get());
+}
 
 } // namespace datafacade
 } // namespace engine
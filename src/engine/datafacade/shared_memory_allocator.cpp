@@ -1,4 +1,6 @@
 #include "engine/datafacade/shared_memory_allocator.hpp"
+#include "util/huge_pages.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
 
 #include "boost/assert.hpp"
@@ -10,23 +12,45 @@ namespace engine
 namespace datafacade
 {
 
-SharedMemoryAllocator::SharedMemoryAllocator(storage::SharedDataType data_region)
+SharedMemoryAllocator::SharedMemoryAllocator(storage::SharedDataType static_region,
+                                             storage::SharedDataType metric_region)
 {
-    util::Log(logDEBUG) << "Loading new data for region " << regionToString(data_region);
+    util::Log(logDEBUG) << "Loading new data for regions " << regionToString(static_region)
+                        << " and " << regionToString(metric_region);
 
-    BOOST_ASSERT(storage::SharedMemory::RegionExists(data_region));
-    m_large_memory = storage::makeSharedMemory(data_region);
+    BOOST_ASSERT(storage::SharedMemory::RegionExists(static_region));
+    BOOST_ASSERT(storage::SharedMemory::RegionExists(metric_region));
+    m_static_memory = storage::makeSharedMemory(static_region);
+    m_metric_memory = storage::makeSharedMemory(metric_region);
+
+    m_layout = *reinterpret_cast<storage::DataLayout *>(m_static_memory->Ptr());
+    const auto &metric_layout = *reinterpret_cast<storage::DataLayout *>(m_metric_memory->Ptr());
+    for (const auto block : util::irange<std::size_t>(0, storage::DataLayout::NUM_BLOCKS))
+    {
+        if (storage::DataLayout::GetPart(static_cast<storage::DataLayout::BlockID>(block)) ==
+            storage::DataLayout::METRIC_PART)
+        {
+            m_layout.num_entries[block] = metric_layout.num_entries[block];
+            m_layout.entry_size[block] = metric_layout.entry_size[block];
+            m_layout.entry_align[block] = metric_layout.entry_align[block];
+        }
+    }
 }
 
 SharedMemoryAllocator::~SharedMemoryAllocator() {}
 
-storage::DataLayout &SharedMemoryAllocator::GetLayout()
+storage::DataLayout &SharedMemoryAllocator::GetLayout() { return m_layout; }
+storage::DataLayout::Memory SharedMemoryAllocator::GetMemory()
 {
-    return *reinterpret_cast<storage::DataLayout *>(m_large_memory->Ptr());
+    return storage::DataLayout::Memory{
+        {reinterpret_cast<char *>(m_static_memory->Ptr()) + sizeof(storage::DataLayout),
+         reinterpret_cast<char *>(m_metric_memory->Ptr()) + sizeof(storage::DataLayout)}};
 }
-char *SharedMemoryAllocator::GetMemory()
+
+void SharedMemoryAllocator::Prefault() const
 {
-    return reinterpret_cast<char *>(m_large_memory->Ptr()) + sizeof(storage::DataLayout);
+    util::prefaultPages(m_static_memory->Ptr(), m_static_memory->Size());
+    util::prefaultPages(m_metric_memory->Ptr(), m_metric_memory->Size());
 }
 
 } // namespace datafacade
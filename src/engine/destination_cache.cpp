@@ -0,0 +1,36 @@
+#include "engine/destination_cache.hpp"
+
+#include "util/std_hash.hpp"
+
+namespace osrm
+{
+namespace engine
+{
+
+std::size_t DestinationCache::KeyHash::operator()(const Key &key) const
+{
+    std::size_t seed = std::hash<std::uint64_t>()(key.generation);
+    for (const auto word : key.words)
+    {
+        hash_combine(seed, word);
+    }
+    return seed;
+}
+
+DestinationCache::DestinationCache(const std::size_t capacity) : cache(capacity) {}
+
+DestinationCache::Key DestinationCache::MakeKey(const std::shared_ptr<const void> &dataset,
+                                                const PhantomNode &target_phantom)
+{
+    // everything the reverse search starts from
+    const std::int32_t flags =
+        target_phantom.IsValidForwardTarget() | (target_phantom.IsValidReverseTarget() << 1);
+    return Key{generation.Get(dataset, [this]() { cache.Clear(); }),
+               {static_cast<std::int32_t>(target_phantom.forward_segment_id.id),
+                static_cast<std::int32_t>(target_phantom.reverse_segment_id.id),
+                flags,
+                target_phantom.forward_weight_offset + target_phantom.forward_weight,
+                target_phantom.reverse_weight_offset + target_phantom.reverse_weight}};
+}
+}
+}
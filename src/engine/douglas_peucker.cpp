@@ -2,6 +2,7 @@
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
 #include "util/integer_range.hpp"
+#include "util/project_point_on_segments.hpp"
 #include "util/web_mercator.hpp"
 
 #include <boost/assert.hpp>
@@ -9,7 +10,9 @@
 #include <algorithm>
 #include <cmath>
 #include <iterator>
+#include <limits>
 #include <stack>
+#include <tuple>
 #include <utility>
 
 namespace osrm
@@ -31,6 +34,153 @@ std::uint64_t fastPerpendicularDistance(const util::FloatCoordinate &projected_s
     return squared_distance;
 }
 
+namespace
+{
+// The geometry in web mercator as separate arrays of longitudes and latitudes, next to the fixed
+// point coordinates they round to as the thresholds are given in those
+struct ProjectedGeometry
+{
+    ProjectedGeometry(std::vector<util::Coordinate>::const_iterator begin,
+                      std::vector<util::Coordinate>::const_iterator end)
+    {
+        const std::size_t size = std::distance(begin, end);
+        lon.reserve(size);
+        lat.reserve(size);
+        std::for_each(begin, end, [this](const util::Coordinate coordinate) {
+            lon.push_back(static_cast<double>(util::toFloating(coordinate.lon)));
+            lat.push_back(static_cast<double>(util::toFloating(coordinate.lat)));
+        });
+        util::web_mercator::latToYapprox(lat.data(), size);
+
+        fixed_lon.reserve(size);
+        fixed_lat.reserve(size);
+        for (auto index : util::irange<std::size_t>(0UL, size))
+        {
+            const util::Coordinate fixed{(*this)[index]};
+            fixed_lon.push_back(static_cast<std::int32_t>(fixed.lon));
+            fixed_lat.push_back(static_cast<std::int32_t>(fixed.lat));
+        }
+    }
+
+    util::FloatCoordinate operator[](const std::size_t index) const
+    {
+        return {util::FloatLongitude{lon[index]}, util::FloatLatitude{lat[index]}};
+    }
+
+    std::vector<double> lon;
+    std::vector<double> lat;
+    std::vector<double> fixed_lon;
+    std::vector<double> fixed_lat;
+};
+
+// The first point strictly between first and last with the largest distance to the segment
+// between them and its distance, last if all points lie on the segment.
+//
+// With double lanes a vector of points is projected at once and every lane keeps the farthest of
+// its points, the lanes are reduced at the end. The distances are the ones of
+// fastPerpendicularDistance, except for rounding half way cases to even and for distances beyond
+// 2^53 that are only compared to the thresholds.
+std::pair<std::size_t, std::uint64_t> findFarthestPoint(const ProjectedGeometry &geometry,
+                                                        const std::size_t first,
+                                                        const std::size_t last)
+{
+    const auto source = geometry[first];
+    const auto target = geometry[last];
+
+    std::size_t farthest_index = last;
+    std::uint64_t max_distance = 0;
+    std::size_t index = first + 1;
+
+#ifdef OSRM_HAS_DOUBLE_LANES
+    using namespace util::detail;
+    // the same operations as projectPointOnSegment, in the same order
+    const auto slope_lon = static_cast<double>(target.lon - source.lon);
+    const auto slope_lat = static_cast<double>(target.lat - source.lat);
+    const auto squared_length = slope_lon * slope_lon + slope_lat * slope_lat;
+    const bool is_degenerated = squared_length < std::numeric_limits<double>::epsilon();
+
+    const auto source_lon = broadcastLanes(static_cast<double>(source.lon));
+    const auto source_lat = broadcastLanes(static_cast<double>(source.lat));
+    const auto target_lon = broadcastLanes(static_cast<double>(target.lon));
+    const auto target_lat = broadcastLanes(static_cast<double>(target.lat));
+    const auto slope_lon_lanes = broadcastLanes(slope_lon);
+    const auto slope_lat_lanes = broadcastLanes(slope_lat);
+    const auto squared_length_lanes = broadcastLanes(squared_length);
+    const auto precision = broadcastLanes(COORDINATE_PRECISION);
+    const auto zero = broadcastLanes(0.);
+    const auto one = broadcastLanes(1.);
+
+    double first_indices[DoubleLanes::SIZE];
+    for (std::size_t lane = 0; lane < DoubleLanes::SIZE; ++lane)
+    {
+        first_indices[lane] = static_cast<double>(index + lane);
+    }
+    auto indices = loadLanes(first_indices);
+    const auto step = broadcastLanes(static_cast<double>(DoubleLanes::SIZE));
+    auto lane_distances = zero;
+    auto lane_indices = broadcastLanes(static_cast<double>(last));
+
+    for (; index + DoubleLanes::SIZE <= last; index += DoubleLanes::SIZE)
+    {
+        const auto lon = loadLanes(geometry.lon.data() + index);
+        const auto lat = loadLanes(geometry.lat.data() + index);
+
+        auto ratio = zero;
+        if (!is_degenerated)
+        {
+            const auto unnormed_ratio =
+                slope_lon_lanes * (lon - source_lon) + slope_lat_lanes * (lat - source_lat);
+            const auto normed_ratio = unnormed_ratio / squared_length_lanes;
+            ratio = selectLess(
+                one, normed_ratio, one, selectLess(normed_ratio, zero, zero, normed_ratio));
+        }
+        const auto source_ratio = one - ratio;
+        const auto nearest_lon = source_ratio * source_lon + target_lon * ratio;
+        const auto nearest_lat = source_ratio * source_lat + target_lat * ratio;
+
+        const auto delta_lon =
+            loadLanes(geometry.fixed_lon.data() + index) - roundLanes(nearest_lon * precision);
+        const auto delta_lat =
+            loadLanes(geometry.fixed_lat.data() + index) - roundLanes(nearest_lat * precision);
+        const auto distances = delta_lon * delta_lon + delta_lat * delta_lat;
+
+        // strictly farther points only, every lane keeps its first farthest point
+        lane_indices = selectLess(lane_distances, distances, indices, lane_indices);
+        lane_distances = selectLess(lane_distances, distances, distances, lane_distances);
+        indices = indices + step;
+    }
+
+    double distances[DoubleLanes::SIZE];
+    double farthest_indices[DoubleLanes::SIZE];
+    storeLanes(distances, lane_distances);
+    storeLanes(farthest_indices, lane_indices);
+    for (std::size_t lane = 0; lane < DoubleLanes::SIZE; ++lane)
+    {
+        const auto distance = static_cast<std::uint64_t>(distances[lane]);
+        const auto lane_index = static_cast<std::size_t>(farthest_indices[lane]);
+        if (distance > max_distance || (distance == max_distance && lane_index < farthest_index))
+        {
+            farthest_index = lane_index;
+            max_distance = distance;
+        }
+    }
+#endif
+
+    // points behind the last full vector come after all of the lanes
+    for (; index < last; ++index)
+    {
+        const auto distance = fastPerpendicularDistance(source, target, geometry[index]);
+        if (distance > max_distance)
+        {
+            farthest_index = index;
+            max_distance = distance;
+        }
+    }
+
+    return {farthest_index, max_distance};
+}
+}
+
 std::vector<util::Coordinate> douglasPeucker(std::vector<util::Coordinate>::const_iterator begin,
                                              std::vector<util::Coordinate>::const_iterator end,
                                              const unsigned zoom_level)
@@ -44,10 +194,8 @@ std::vector<util::Coordinate> douglasPeucker(std::vector<util::Coordinate>::cons
         return {};
     }
 
-    std::vector<util::FloatCoordinate> projected_coordinates(size);
-    std::transform(begin, end, projected_coordinates.begin(), [](const util::Coordinate coord) {
-        return util::web_mercator::fromWGS84(coord);
-    });
+    // projected once for all ranges
+    const ProjectedGeometry projected_geometry(begin, end);
 
     std::vector<bool> is_necessary(size, false);
     BOOST_ASSERT(is_necessary.size() >= 2);
@@ -71,24 +219,10 @@ std::vector<util::Coordinate> douglasPeucker(std::vector<util::Coordinate>::cons
         BOOST_ASSERT_MSG(pair.second < size, "right border outside of geometry");
         BOOST_ASSERT_MSG(pair.first <= pair.second, "left border on the wrong side");
 
-        std::uint64_t max_distance = 0;
-        auto farthest_entry_index = pair.second;
-
-        // sweep over range to find the maximum
-        for (auto idx = pair.first + 1; idx != pair.second; ++idx)
-        {
-            using namespace util::coordinate_calculation;
-            const auto distance = fastPerpendicularDistance(projected_coordinates[pair.first],
-                                                            projected_coordinates[pair.second],
-                                                            projected_coordinates[idx]);
-            // found new feasible maximum?
-            if (distance > max_distance &&
-                distance > detail::DOUGLAS_PEUCKER_THRESHOLDS[zoom_level])
-            {
-                farthest_entry_index = idx;
-                max_distance = distance;
-            }
-        }
+        std::size_t farthest_entry_index;
+        std::uint64_t max_distance;
+        std::tie(farthest_entry_index, max_distance) =
+            findFarthestPoint(projected_geometry, pair.first, pair.second);
 
         // check if maximum violates a zoom level dependent threshold
         if (max_distance > detail::DOUGLAS_PEUCKER_THRESHOLDS[zoom_level])
@@ -1,5 +1,12 @@
 #include "engine/engine_config.hpp"
 
+#include "storage/shared_datatype.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <iterator>
+
 namespace osrm
 {
 namespace engine
@@ -20,9 +27,34 @@ bool EngineConfig::IsValid() const
                               unlimited_or_more_than(max_locations_trip, 2) &&
                               unlimited_or_more_than(max_locations_viaroute, 2) &&
                               unlimited_or_more_than(max_results_nearest, 0) &&
-                              max_alternatives >= 0;
+                              unlimited_or_more_than(max_isochrone_duration, 0) &&
+                              max_alternatives >= 0 && unlimited_or_more_than(default_timeout, 0) &&
+                              unlimited_or_more_than(max_cached_heaps, -1) &&
+                              max_cached_routes >= 0 && max_reroute_destinations >= 0 &&
+                              max_cached_snappings >= 0 && max_cached_unpackings >= 0 &&
+                              max_cached_tiles >= 0 &&
+                              max_matching_sessions >= 0 && matching_session_ttl > 0 &&
+                              unlimited_or_more_than(min_parallel_table_size, 0) &&
+                              unlimited_or_more_than(min_rphast_table_size, 0) &&
+                              unlimited_or_more_than(min_fused_table_size, -1) &&
+                              unlimited_or_more_than(min_parallel_match_size, 0) &&
+                              unlimited_or_more_than(min_parallel_route_size, 0) &&
+                              unlimited_or_more_than(min_parallel_search_distance, -1);
+
+    const bool advice_valid =
+        std::all_of(memory_advice.begin(), memory_advice.end(), [](const auto &advice) {
+            return std::find(std::begin(storage::block_id_to_name),
+                             std::end(storage::block_id_to_name),
+                             advice.first) != std::end(storage::block_id_to_name);
+        });
+
+    // a memory file holds all the data, it only needs the .osrm files to be written
+    const bool has_memory_file = !use_shared_memory && !memory_file.empty() &&
+                                 boost::filesystem::exists(memory_file);
 
-    return ((use_shared_memory && all_path_are_empty) || storage_config.IsValid()) && limits_valid;
+    return ((use_shared_memory && all_path_are_empty) || has_memory_file ||
+            storage_config.IsValid()) &&
+           limits_valid && advice_valid;
 }
 }
 }
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <ostream>
 #include <tuple>
 
@@ -14,15 +15,133 @@ namespace osrm
 namespace engine
 {
 
+namespace
+{
+// Segment ids and position of a decoded phantom node, as expected by its constructor
+struct HintSegment
+{
+    SegmentID forward_segment_id;
+    SegmentID reverse_segment_id;
+    unsigned short fwd_segment_position;
+};
+
+enum HintFlags : std::uint8_t
+{
+    FORWARD_ENABLED = 1 << 0,
+    REVERSE_ENABLED = 1 << 1,
+    TINY_COMPONENT = 1 << 2,
+    VALID_FORWARD_SOURCE = 1 << 3,
+    VALID_FORWARD_TARGET = 1 << 4,
+    VALID_REVERSE_SOURCE = 1 << 5,
+    VALID_REVERSE_TARGET = 1 << 6
+};
+
+void writeVarint(std::string &bytes, std::uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<char>(value));
+}
+
+void writeSignedVarint(std::string &bytes, const std::int32_t value)
+{
+    // zigzag encoding keeps small negative numbers short
+    writeVarint(bytes,
+                (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31));
+}
+
+// Reads the fields written above and fails on truncated or overlong input
+class VarintReader
+{
+  public:
+    VarintReader(const std::string &bytes_, const std::size_t position_)
+        : bytes(bytes_), position(position_)
+    {
+    }
+
+    bool Read(std::uint32_t &value)
+    {
+        value = 0;
+        for (unsigned shift = 0; shift < 35; shift += 7)
+        {
+            if (position == bytes.size())
+                return false;
+            const auto byte = static_cast<std::uint8_t>(bytes[position++]);
+            if (shift == 28 && byte > 0x0f)
+                return false;
+            value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool ReadSigned(std::int32_t &value)
+    {
+        std::uint32_t zigzag;
+        if (!Read(zigzag))
+            return false;
+        value = static_cast<std::int32_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+        return true;
+    }
+
+    // segment ids are stored incremented by one, zero is SPECIAL_SEGMENTID
+    bool ReadSegmentID(NodeID &id)
+    {
+        std::uint32_t value;
+        if (!Read(value) || value > SPECIAL_SEGMENTID)
+            return false;
+        id = value == 0 ? SPECIAL_SEGMENTID : value - 1;
+        return true;
+    }
+
+    bool AtEnd() const { return position == bytes.size(); }
+
+  private:
+    const std::string &bytes;
+    std::size_t position;
+};
+}
+
 bool Hint::IsValid(const util::Coordinate new_input_coordinates,
                    const datafacade::BaseDataFacade &facade) const
 {
     auto is_same_input_coordinate = new_input_coordinates.lon == phantom.input_location.lon &&
                                     new_input_coordinates.lat == phantom.input_location.lat;
-    // FIXME this does not use the number of nodes to validate the phantom because
-    // GetNumberOfNodes()
-    // depends on the graph which is algorithm dependent
-    return is_same_input_coordinate && phantom.IsValid() && facade.GetCheckSum() == data_checksum;
+    if (!is_same_input_coordinate || !phantom.IsValid() || facade.GetCheckSum() != data_checksum)
+    {
+        return false;
+    }
+
+    // Hints come from clients and are used instead of snapping, so their segments have to exist
+    // before the routing algorithms index with them. The checks touch one geometry and component
+    // entry per segment id and the geometry size, independent of the size of the dataset.
+    const auto &forward = phantom.forward_segment_id;
+    const auto &reverse = phantom.reverse_segment_id;
+    const auto number_of_nodes = facade.GetNumberOfEdgeBasedNodes();
+    if ((!forward.enabled && !reverse.enabled) || forward.id >= number_of_nodes)
+    {
+        return false;
+    }
+
+    const auto geometry_id = facade.GetGeometryIndex(forward.id).id;
+    if (reverse.id != SPECIAL_SEGMENTID && reverse.id >= number_of_nodes)
+    {
+        return false;
+    }
+    if (reverse.enabled &&
+        (reverse.id == SPECIAL_SEGMENTID || facade.GetGeometryIndex(reverse.id).id != geometry_id))
+    {
+        return false;
+    }
+
+    const auto component = facade.GetComponentID(forward.id);
+    return component.id == phantom.component.id &&
+           component.is_tiny == phantom.component.is_tiny &&
+           phantom.fwd_segment_position < facade.GetNumberOfGeometrySegments(geometry_id);
 }
 
 std::string Hint::ToBase64() const
@@ -50,6 +169,119 @@ Hint Hint::FromBase64(const std::string &base64Hint)
     return decodeBase64Bytewise<Hint>(encoded);
 }
 
+std::string Hint::ToCompactBase64() const
+{
+    std::string bytes;
+    bytes.reserve(sizeof(Hint));
+
+    const auto segment_id = [](const SegmentID segment) {
+        return segment.id == SPECIAL_SEGMENTID ? 0 : segment.id + 1;
+    };
+    bytes.push_back(static_cast<char>(
+        (phantom.forward_segment_id.enabled ? FORWARD_ENABLED : 0) |
+        (phantom.reverse_segment_id.enabled ? REVERSE_ENABLED : 0) |
+        (phantom.component.is_tiny ? TINY_COMPONENT : 0) |
+        (phantom.IsValidForwardSource() ? VALID_FORWARD_SOURCE : 0) |
+        (phantom.IsValidForwardTarget() ? VALID_FORWARD_TARGET : 0) |
+        (phantom.IsValidReverseSource() ? VALID_REVERSE_SOURCE : 0) |
+        (phantom.IsValidReverseTarget() ? VALID_REVERSE_TARGET : 0)));
+    writeVarint(bytes, segment_id(phantom.forward_segment_id));
+    writeVarint(bytes, segment_id(phantom.reverse_segment_id));
+    writeVarint(bytes, phantom.fwd_segment_position);
+    writeVarint(bytes, phantom.component.id);
+    for (const auto value : {phantom.forward_weight,
+                             phantom.reverse_weight,
+                             phantom.forward_weight_offset,
+                             phantom.reverse_weight_offset,
+                             phantom.forward_duration,
+                             phantom.reverse_duration,
+                             phantom.forward_duration_offset,
+                             phantom.reverse_duration_offset})
+    {
+        writeSignedVarint(bytes, value);
+    }
+
+    const auto lon = static_cast<std::int32_t>(phantom.location.lon);
+    const auto lat = static_cast<std::int32_t>(phantom.location.lat);
+    writeSignedVarint(bytes, lon);
+    writeSignedVarint(bytes, lat);
+    // the input coordinate is close to the snapped one
+    writeSignedVarint(bytes, static_cast<std::int32_t>(phantom.input_location.lon) - lon);
+    writeSignedVarint(bytes, static_cast<std::int32_t>(phantom.input_location.lat) - lat);
+    writeVarint(bytes, data_checksum);
+
+    return COMPACT_HINT_PREFIX +
+           encodeBase64URL(reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size());
+}
+
+boost::optional<Hint> Hint::FromCompactBase64(const std::string &base64Hint)
+{
+    std::string bytes;
+    if (base64Hint.size() < 2 || base64Hint.front() != COMPACT_HINT_PREFIX ||
+        !decodeBase64URL(base64Hint.substr(1), bytes) || bytes.empty())
+    {
+        return boost::none;
+    }
+
+    // the flags are followed by the varints
+    const auto flags = static_cast<std::uint8_t>(bytes.front());
+    VarintReader reader{bytes, 1};
+
+    NodeID forward_id, reverse_id;
+    std::uint32_t fwd_segment_position, component_id;
+    std::int32_t weights[8];
+    std::int32_t lon, lat, input_lon_delta, input_lat_delta;
+    std::uint32_t data_checksum;
+
+    bool read = reader.ReadSegmentID(forward_id) && reader.ReadSegmentID(reverse_id) &&
+                reader.Read(fwd_segment_position) && reader.Read(component_id);
+    for (auto &weight : weights)
+    {
+        read = read && reader.ReadSigned(weight);
+    }
+    read = read && reader.ReadSigned(lon) && reader.ReadSigned(lat) &&
+           reader.ReadSigned(input_lon_delta) && reader.ReadSigned(input_lat_delta) &&
+           reader.Read(data_checksum) && reader.AtEnd();
+
+    const bool forward_enabled = (flags & FORWARD_ENABLED) != 0;
+    const bool reverse_enabled = (flags & REVERSE_ENABLED) != 0;
+    if (!read || fwd_segment_position > std::numeric_limits<unsigned short>::max() ||
+        component_id > std::numeric_limits<std::int32_t>::max() ||
+        (forward_enabled && forward_id == SPECIAL_SEGMENTID) ||
+        (reverse_enabled && reverse_id == SPECIAL_SEGMENTID))
+    {
+        return boost::none;
+    }
+
+    const HintSegment segment{SegmentID{forward_id, forward_enabled},
+                              SegmentID{reverse_id, reverse_enabled},
+                              static_cast<unsigned short>(fwd_segment_position)};
+    const ComponentID component{component_id, (flags & TINY_COMPONENT) != 0};
+
+    const util::Coordinate location{util::FixedLongitude{lon}, util::FixedLatitude{lat}};
+    const util::Coordinate input_location{
+        util::FixedLongitude{static_cast<std::int32_t>(std::int64_t{lon} + input_lon_delta)},
+        util::FixedLatitude{static_cast<std::int32_t>(std::int64_t{lat} + input_lat_delta)}};
+
+    return Hint{PhantomNode{segment,
+                            component,
+                            weights[0],
+                            weights[1],
+                            weights[2],
+                            weights[3],
+                            weights[4],
+                            weights[5],
+                            weights[6],
+                            weights[7],
+                            (flags & VALID_FORWARD_SOURCE) != 0,
+                            (flags & VALID_FORWARD_TARGET) != 0,
+                            (flags & VALID_REVERSE_SOURCE) != 0,
+                            (flags & VALID_REVERSE_TARGET) != 0,
+                            location,
+                            input_location},
+                data_checksum};
+}
+
 bool operator==(const Hint &lhs, const Hint &rhs)
 {
     return std::tie(lhs.phantom, lhs.data_checksum) == std::tie(rhs.phantom, rhs.data_checksum);
@@ -0,0 +1,62 @@
+#include "engine/matching_sessions.hpp"
+
+#include <boost/assert.hpp>
+
+#include <iterator>
+
+namespace osrm
+{
+namespace engine
+{
+
+MatchingSessions::MatchingSessions(const std::size_t capacity,
+                                   const std::chrono::seconds time_to_live)
+    : capacity(capacity), time_to_live(time_to_live)
+{
+    BOOST_ASSERT(capacity > 0);
+}
+
+std::shared_ptr<MatchingSessions::Session>
+MatchingSessions::Get(const std::string &id,
+                      const std::shared_ptr<const void> &dataset,
+                      const Clock::time_point now)
+{
+    // the dropped sessions are destroyed outside of the lock
+    std::list<Entry> dropped;
+    std::lock_guard<std::mutex> lock(mutex);
+    generation.Get(dataset, [&]() {
+        index.clear();
+        dropped.splice(dropped.end(), entries);
+    });
+
+    while (!entries.empty() && now - entries.back().last_used > time_to_live)
+    {
+        index.erase(entries.back().id);
+        dropped.splice(dropped.end(), entries, std::prev(entries.end()));
+    }
+
+    const auto position = index.find(id);
+    if (position != index.end())
+    {
+        position->second->last_used = now;
+        entries.splice(entries.begin(), entries, position->second);
+        return position->second->session;
+    }
+
+    if (entries.size() >= capacity)
+    {
+        index.erase(entries.back().id);
+        dropped.splice(dropped.end(), entries, std::prev(entries.end()));
+    }
+    entries.push_front(Entry{id, std::make_shared<Session>(), now});
+    index.emplace(id, entries.begin());
+    return entries.front().session;
+}
+
+std::size_t MatchingSessions::Size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+}
+}
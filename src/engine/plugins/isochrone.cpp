@@ -0,0 +1,771 @@
+#include "engine/plugins/isochrone.hpp"
+
+#include "engine/api/base_api.hpp"
+#include "engine/api/json_factory.hpp"
+
+#include "util/coordinate_calculation.hpp"
+#include "util/marching_squares.hpp"
+#include "util/vector_tile.hpp"
+#include "util/web_mercator.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/geometries.hpp>
+#include <boost/geometry/multi/geometries/multi_linestring.hpp>
+#include <boost/geometry/multi/geometries/multi_polygon.hpp>
+
+#include <protozero/pbf_writer.hpp>
+#include <protozero/varint.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+namespace
+{
+
+// The search and the geometry count in deciseconds, the contours in seconds
+const constexpr double DECISECONDS_PER_SECOND = 10.;
+
+// The grid the areas are traced on has square cells of at least MIN_CELL_SIZE meters and at
+// most MAX_GRID_SIZE cells along the longer side of the reached lines, plus a margin.
+const constexpr double MIN_CELL_SIZE = 100.;
+const constexpr double MAX_GRID_SIZE = 512.;
+const constexpr std::int64_t GRID_MARGIN = 2;
+
+// A polyline along the road segments that is reached between two contours
+struct ReachedLine
+{
+    std::size_t contour; // index of the first contour that contains it
+    double duration;     // at the first coordinate, in deciseconds
+    std::vector<util::Coordinate> coordinates;
+};
+
+// A polygon of an area within a contour, with closed rings
+struct ContourPolygon
+{
+    std::vector<util::Coordinate> outer;
+    std::vector<std::vector<util::Coordinate>> holes;
+};
+
+// Splits the geometry of the reached nodes at the contours. The search only knows the duration
+// at the start of a node, within a node the durations of its segments are added up and the
+// coordinates interpolated linearly within a segment.
+std::vector<ReachedLine> getReachedLines(const datafacade::BaseDataFacade &facade,
+                                         const std::vector<routing_algorithms::ReachedNode> &nodes,
+                                         const std::vector<unsigned> &contours)
+{
+    std::vector<double> bounds(contours.size());
+    std::transform(contours.begin(), contours.end(), bounds.begin(), [](const unsigned contour) {
+        return contour * DECISECONDS_PER_SECOND;
+    });
+    const auto limit = bounds.back();
+    // the contour the road after this point in time belongs to
+    const auto contour_after = [&bounds](const double time) {
+        return static_cast<std::size_t>(std::upper_bound(bounds.begin(), bounds.end(), time) -
+                                        bounds.begin());
+    };
+
+    std::vector<ReachedLine> lines;
+    for (const auto &node : nodes)
+    {
+        const auto geometry_index = facade.GetGeometryIndex(node.node);
+        std::vector<NodeID> geometry;
+        std::vector<double> durations;
+        if (geometry_index.forward)
+        {
+            const auto range = facade.GetUncompressedForwardGeometry(geometry_index.id);
+            geometry.assign(range.begin(), range.end());
+            const auto duration_range = facade.GetUncompressedForwardDurations(geometry_index.id);
+            durations.assign(duration_range.begin(), duration_range.end());
+        }
+        else
+        {
+            const auto range = facade.GetUncompressedReverseGeometry(geometry_index.id);
+            geometry.assign(range.begin(), range.end());
+            const auto duration_range = facade.GetUncompressedReverseDurations(geometry_index.id);
+            durations.assign(duration_range.begin(), duration_range.end());
+        }
+        BOOST_ASSERT(geometry.size() == durations.size() + 1);
+
+        // the last line is extended as long as the road stays within the same contour
+        bool extending = false;
+        const auto add_piece = [&](const std::size_t contour,
+                                   const double duration,
+                                   const util::Coordinate from,
+                                   const util::Coordinate to) {
+            if (extending && lines.back().contour == contour)
+            {
+                lines.back().coordinates.push_back(to);
+            }
+            else
+            {
+                lines.push_back({contour, duration, {from, to}});
+                extending = true;
+            }
+        };
+
+        // negative for the node the source is on, the part behind the source is skipped
+        double time = node.duration;
+        for (std::size_t segment = 0; segment < durations.size() && time < limit; ++segment)
+        {
+            const auto begin = time;
+            const auto end = time + durations[segment];
+            time = end;
+            if (begin < 0 && end <= 0)
+            {
+                continue;
+            }
+
+            const auto from = facade.GetCoordinateOfNode(geometry[segment]);
+            const auto to = facade.GetCoordinateOfNode(geometry[segment + 1]);
+            if (end == begin)
+            {
+                add_piece(contour_after(begin), begin, from, to);
+                continue;
+            }
+
+            const auto interpolate = [&](const double at) {
+                return util::coordinate_calculation::interpolateLinear(
+                    (at - begin) / (end - begin), from, to);
+            };
+            auto piece_begin = std::max(begin, 0.);
+            const auto piece_limit = std::min(end, limit);
+            while (piece_begin < piece_limit)
+            {
+                const auto contour = contour_after(piece_begin);
+                BOOST_ASSERT(contour < bounds.size());
+                const auto piece_end = std::min(piece_limit, bounds[contour]);
+                add_piece(contour,
+                          piece_begin,
+                          piece_begin == begin ? from : interpolate(piece_begin),
+                          piece_end == end ? to : interpolate(piece_end));
+                piece_begin = piece_end;
+            }
+        }
+    }
+
+    return lines;
+}
+
+// Maps the bounding box of the reached lines onto the cells of a marching squares grid
+class ContourGrid
+{
+  public:
+    explicit ContourGrid(const std::vector<ReachedLine> &lines)
+    {
+        double min_lon = 180., max_lon = -180., min_lat = 90., max_lat = -90.;
+        for (const auto &line : lines)
+        {
+            for (const auto coordinate : line.coordinates)
+            {
+                const auto lon = static_cast<double>(util::toFloating(coordinate.lon));
+                const auto lat = static_cast<double>(util::toFloating(coordinate.lat));
+                min_lon = std::min(min_lon, lon);
+                max_lon = std::max(max_lon, lon);
+                min_lat = std::min(min_lat, lat);
+                max_lat = std::max(max_lat, lat);
+            }
+        }
+        BOOST_ASSERT(min_lon <= max_lon && min_lat <= max_lat);
+
+        // the cells are square in meters around the middle of the box
+        const auto center_lat = (min_lat + max_lat) / 2.;
+        const auto meters_per_lon = util::coordinate_calculation::haversineDistance(
+            util::Coordinate{util::FloatLongitude{0.}, util::FloatLatitude{center_lat}},
+            util::Coordinate{util::FloatLongitude{1.}, util::FloatLatitude{center_lat}});
+        const auto meters_per_lat = util::coordinate_calculation::haversineDistance(
+            util::Coordinate{util::FloatLongitude{0.}, util::FloatLatitude{0.}},
+            util::Coordinate{util::FloatLongitude{0.}, util::FloatLatitude{1.}});
+        const auto extent = std::max((max_lon - min_lon) * meters_per_lon,
+                                     (max_lat - min_lat) * meters_per_lat);
+        const auto cell_size = std::max(extent / MAX_GRID_SIZE, MIN_CELL_SIZE);
+        cell_lon = cell_size / std::max(meters_per_lon, 1.);
+        cell_lat = cell_size / meters_per_lat;
+
+        origin_lon = min_lon - GRID_MARGIN * cell_lon;
+        origin_lat = min_lat - GRID_MARGIN * cell_lat;
+        width = static_cast<std::size_t>((max_lon - min_lon) / cell_lon) + 2 * GRID_MARGIN + 1;
+        height = static_cast<std::size_t>((max_lat - min_lat) / cell_lat) + 2 * GRID_MARGIN + 1;
+    }
+
+    util::marching_squares::Grid MakeGrid() const
+    {
+        return util::marching_squares::Grid(width, height);
+    }
+
+    // Sets every cell the line passes, sampled twice per cell. Cells that only touch at a
+    // corner get a common neighbour, the outlines would keep them apart.
+    void Rasterize(util::marching_squares::Grid &grid, const ReachedLine &line) const
+    {
+        for (std::size_t index = 1; index < line.coordinates.size(); ++index)
+        {
+            const auto from_x = ToX(line.coordinates[index - 1]);
+            const auto from_y = ToY(line.coordinates[index - 1]);
+            const auto to_x = ToX(line.coordinates[index]);
+            const auto to_y = ToY(line.coordinates[index]);
+            const auto steps = std::max(
+                1., std::ceil(2 * std::max(std::abs(to_x - from_x), std::abs(to_y - from_y))));
+            auto previous_x = static_cast<std::size_t>(from_x);
+            auto previous_y = static_cast<std::size_t>(from_y);
+            for (double step = 0; step <= steps; ++step)
+            {
+                const auto x = from_x + (to_x - from_x) * step / steps;
+                const auto y = from_y + (to_y - from_y) * step / steps;
+                BOOST_ASSERT(x >= 0 && x < width && y >= 0 && y < height);
+                const auto cell_x = static_cast<std::size_t>(x);
+                const auto cell_y = static_cast<std::size_t>(y);
+                if (cell_x != previous_x && cell_y != previous_y)
+                {
+                    grid.Set(cell_x, previous_y);
+                }
+                grid.Set(cell_x, cell_y);
+                previous_x = cell_x;
+                previous_y = cell_y;
+            }
+        }
+    }
+
+    // Closes a ring of marching squares points, which lie on a grid of half cells
+    std::vector<util::Coordinate> ToCoordinates(const util::marching_squares::Ring &ring) const
+    {
+        std::vector<util::Coordinate> coordinates;
+        coordinates.reserve(ring.size() + 1);
+        for (const auto point : ring)
+        {
+            coordinates.emplace_back(
+                util::FloatLongitude{origin_lon + (point.x / 2. + .5) * cell_lon},
+                util::FloatLatitude{origin_lat + (point.y / 2. + .5) * cell_lat});
+        }
+        if (!coordinates.empty())
+        {
+            coordinates.push_back(coordinates.front());
+        }
+        return coordinates;
+    }
+
+  private:
+    double ToX(const util::Coordinate coordinate) const
+    {
+        return (static_cast<double>(util::toFloating(coordinate.lon)) - origin_lon) / cell_lon;
+    }
+
+    double ToY(const util::Coordinate coordinate) const
+    {
+        return (static_cast<double>(util::toFloating(coordinate.lat)) - origin_lat) / cell_lat;
+    }
+
+    double origin_lon;
+    double origin_lat;
+    double cell_lon;
+    double cell_lat;
+    std::size_t width;
+    std::size_t height;
+};
+
+// The areas within each contour. A contour contains the lines of all smaller ones, the gaps
+// between roads closer than a cell are closed.
+std::vector<std::vector<ContourPolygon>>
+getContourPolygons(const std::vector<ReachedLine> &lines, const std::size_t number_of_contours)
+{
+    std::vector<std::vector<ContourPolygon>> contour_polygons(number_of_contours);
+    if (lines.empty())
+    {
+        return contour_polygons;
+    }
+
+    const ContourGrid contour_grid(lines);
+    auto reached = contour_grid.MakeGrid();
+    for (std::size_t contour = 0; contour < number_of_contours; ++contour)
+    {
+        for (const auto &line : lines)
+        {
+            if (line.contour == contour)
+            {
+                contour_grid.Rasterize(reached, line);
+            }
+        }
+
+        auto closed = reached;
+        closed.Close();
+        for (const auto &polygon : util::marching_squares::traceContours(closed))
+        {
+            ContourPolygon contour_polygon;
+            contour_polygon.outer = contour_grid.ToCoordinates(polygon.outer);
+            for (const auto &hole : polygon.holes)
+            {
+                contour_polygon.holes.push_back(contour_grid.ToCoordinates(hole));
+            }
+            contour_polygons[contour].push_back(std::move(contour_polygon));
+        }
+    }
+
+    return contour_polygons;
+}
+
+util::json::Array makeCoordinates(const std::vector<util::Coordinate> &line)
+{
+    util::json::Array coordinates;
+    coordinates.values.reserve(line.size());
+    std::transform(line.begin(),
+                   line.end(),
+                   std::back_inserter(coordinates.values),
+                   &api::json::detail::coordinateToLonLat);
+    return coordinates;
+}
+
+util::json::Object makeFeature(util::json::Object properties, util::json::Object geometry)
+{
+    util::json::Object feature;
+    feature.values["type"] = "Feature";
+    feature.values["properties"] = std::move(properties);
+    feature.values["geometry"] = std::move(geometry);
+    return feature;
+}
+
+void makeGeoJSON(const std::vector<ReachedLine> &lines,
+                 const api::IsochroneParameters &params,
+                 util::json::Array &features)
+{
+    if (params.polygons)
+    {
+        const auto contour_polygons = getContourPolygons(lines, params.contours.size());
+        for (std::size_t contour = 0; contour < contour_polygons.size(); ++contour)
+        {
+            util::json::Array coordinates;
+            for (const auto &polygon : contour_polygons[contour])
+            {
+                util::json::Array rings;
+                rings.values.push_back(makeCoordinates(polygon.outer));
+                for (const auto &hole : polygon.holes)
+                {
+                    rings.values.push_back(makeCoordinates(hole));
+                }
+                coordinates.values.push_back(std::move(rings));
+            }
+
+            util::json::Object properties;
+            properties.values["contour"] = params.contours[contour];
+            util::json::Object geometry;
+            geometry.values["type"] = "MultiPolygon";
+            geometry.values["coordinates"] = std::move(coordinates);
+            features.values.push_back(makeFeature(std::move(properties), std::move(geometry)));
+        }
+    }
+    else
+    {
+        for (const auto &line : lines)
+        {
+            util::json::Object properties;
+            properties.values["contour"] = params.contours[line.contour];
+            properties.values["duration"] = line.duration / DECISECONDS_PER_SECOND;
+            util::json::Object geometry;
+            geometry.values["type"] = "LineString";
+            geometry.values["coordinates"] = makeCoordinates(line.coordinates);
+            features.values.push_back(makeFeature(std::move(properties), std::move(geometry)));
+        }
+    }
+}
+
+// boost::geometry clips the lines and areas to the tile, in tile coordinates
+typedef boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian> point_t;
+typedef boost::geometry::model::linestring<point_t> linestring_t;
+typedef boost::geometry::model::multi_linestring<linestring_t> multi_linestring_t;
+typedef boost::geometry::model::polygon<point_t> polygon_t;
+typedef boost::geometry::model::multi_polygon<polygon_t> multi_polygon_t;
+typedef boost::geometry::model::box<point_t> box_t;
+const static box_t clip_box(point_t(-util::vector_tile::BUFFER, -util::vector_tile::BUFFER),
+                            point_t(util::vector_tile::EXTENT + util::vector_tile::BUFFER,
+                                    util::vector_tile::EXTENT + util::vector_tile::BUFFER));
+
+struct TilePoint
+{
+    std::int32_t x;
+    std::int32_t y;
+
+    bool operator==(const TilePoint &other) const { return x == other.x && y == other.y; }
+};
+
+// Projects lon/lat into the pixels of a tile
+class TileProjection
+{
+  public:
+    explicit TileProjection(const api::TileParameters &tile)
+    {
+        util::web_mercator::xyzToMercator(tile.x, tile.y, tile.z, min_x, min_y, max_x, max_y);
+    }
+
+    point_t operator()(const util::Coordinate coordinate) const
+    {
+        const auto x = static_cast<double>(util::toFloating(coordinate.lon)) *
+                       util::web_mercator::DEGREE_TO_PX;
+        const auto y = util::web_mercator::latToY(util::toFloating(coordinate.lat)) *
+                       util::web_mercator::DEGREE_TO_PX;
+        return point_t((x - min_x) / (max_x - min_x) * util::vector_tile::EXTENT,
+                       (max_y - y) / (max_y - min_y) * util::vector_tile::EXTENT);
+    }
+
+  private:
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+};
+
+// Rounds a clipped line or ring and drops the points that end up on top of each other
+template <typename RangeT> std::vector<TilePoint> roundPoints(const RangeT &points)
+{
+    std::vector<TilePoint> rounded;
+    for (const auto &point : points)
+    {
+        const TilePoint tile_point{static_cast<std::int32_t>(std::round(point.template get<0>())),
+                                   static_cast<std::int32_t>(std::round(point.template get<1>()))};
+        if (rounded.empty() || !(rounded.back() == tile_point))
+        {
+            rounded.push_back(tile_point);
+        }
+    }
+    return rounded;
+}
+
+// twice the signed area with the surveyor's formula, positive for exterior rings of vector tiles
+std::int64_t doubledArea(const std::vector<TilePoint> &ring)
+{
+    std::int64_t area = 0;
+    for (std::size_t index = 0; index < ring.size(); ++index)
+    {
+        const auto &from = ring[index];
+        const auto &to = ring[(index + 1) % ring.size()];
+        area += static_cast<std::int64_t>(from.x) * to.y - static_cast<std::int64_t>(to.x) * from.y;
+    }
+    return area;
+}
+
+// Encodes the points with a MoveTo and a LineTo command, see
+// https://github.com/mapbox/vector-tile-spec/tree/master/2.1#43-geometry-encoding
+void encodePoints(const std::vector<TilePoint> &points,
+                  protozero::packed_field_uint32 &geometry,
+                  TilePoint &cursor)
+{
+    BOOST_ASSERT(points.size() > 1);
+    const constexpr unsigned MOVETO_COMMAND = 9;
+    const auto lineto_command = (static_cast<unsigned>(points.size() - 1) << 3u) | 2u;
+    for (std::size_t index = 0; index < points.size(); ++index)
+    {
+        if (index < 2)
+        {
+            geometry.add_element(index == 0 ? MOVETO_COMMAND : lineto_command);
+        }
+        geometry.add_element(protozero::encode_zigzag32(points[index].x - cursor.x));
+        geometry.add_element(protozero::encode_zigzag32(points[index].y - cursor.y));
+        cursor = points[index];
+    }
+}
+
+// Exterior rings are encoded with a positive area, holes with a negative one
+void encodeRing(std::vector<TilePoint> ring,
+                const bool exterior,
+                protozero::packed_field_uint32 &geometry,
+                TilePoint &cursor)
+{
+    // the ClosePath command repeats the first point
+    if (ring.size() > 1 && ring.front() == ring.back())
+    {
+        ring.pop_back();
+    }
+    if (ring.size() < 3)
+    {
+        return;
+    }
+    const auto area = doubledArea(ring);
+    if (area == 0)
+    {
+        return;
+    }
+    if ((area > 0) != exterior)
+    {
+        std::reverse(ring.begin(), ring.end());
+    }
+
+    const constexpr unsigned CLOSEPATH_COMMAND = 15;
+    encodePoints(ring, geometry, cursor);
+    geometry.add_element(CLOSEPATH_COMMAND);
+}
+
+// Looks up the index of a value in the table of the layer
+class TileValues
+{
+  public:
+    std::uint32_t Use(const std::uint64_t value)
+    {
+        return indexes.emplace(value, static_cast<std::uint32_t>(indexes.size())).first->second;
+    }
+
+    void Encode(protozero::pbf_writer &layer_writer) const
+    {
+        std::vector<std::uint64_t> values(indexes.size());
+        for (const auto &value_index : indexes)
+        {
+            values[value_index.second] = value_index.first;
+        }
+        for (const auto value : values)
+        {
+            protozero::pbf_writer values_writer(layer_writer, util::vector_tile::VARIANT_TAG);
+            values_writer.add_uint64(util::vector_tile::VARIANT_TYPE_UINT64, value);
+        }
+    }
+
+  private:
+    std::map<std::uint64_t, std::uint32_t> indexes;
+};
+
+const constexpr std::uint32_t CONTOUR_KEY = 0;
+const constexpr std::uint32_t DURATION_KEY = 1;
+
+void encodeVectorTile(const std::vector<ReachedLine> &lines,
+                      const api::IsochroneParameters &params,
+                      std::string &pbf_buffer)
+{
+    BOOST_ASSERT(params.tile);
+    const TileProjection project(*params.tile);
+
+    std::string layer;
+    {
+        protozero::pbf_writer layer_writer(layer);
+        layer_writer.add_uint32(util::vector_tile::VERSION_TAG, 2);
+        layer_writer.add_string(util::vector_tile::NAME_TAG, "isochrone");
+        layer_writer.add_uint32(util::vector_tile::EXTENT_TAG, util::vector_tile::EXTENT);
+
+        TileValues values;
+        std::uint64_t id = 1;
+        if (params.polygons)
+        {
+            const auto contour_polygons = getContourPolygons(lines, params.contours.size());
+            for (std::size_t contour = 0; contour < contour_polygons.size(); ++contour)
+            {
+                multi_polygon_t clipped;
+                for (const auto &polygon : contour_polygons[contour])
+                {
+                    polygon_t unclipped;
+                    for (const auto coordinate : polygon.outer)
+                    {
+                        boost::geometry::append(unclipped.outer(), project(coordinate));
+                    }
+                    for (const auto &hole : polygon.holes)
+                    {
+                        unclipped.inners().emplace_back();
+                        for (const auto coordinate : hole)
+                        {
+                            boost::geometry::append(unclipped.inners().back(), project(coordinate));
+                        }
+                    }
+                    boost::geometry::correct(unclipped);
+                    multi_polygon_t clipped_polygon;
+                    boost::geometry::intersection(clip_box, unclipped, clipped_polygon);
+                    clipped.insert(clipped.end(), clipped_polygon.begin(), clipped_polygon.end());
+                }
+                if (clipped.empty())
+                {
+                    continue;
+                }
+
+                protozero::pbf_writer feature_writer(layer_writer,
+                                                     util::vector_tile::FEATURE_TAG);
+                feature_writer.add_enum(util::vector_tile::GEOMETRY_TAG,
+                                        util::vector_tile::GEOMETRY_TYPE_POLYGON);
+                feature_writer.add_uint64(util::vector_tile::ID_TAG, id++);
+                {
+                    protozero::packed_field_uint32 field(
+                        feature_writer, util::vector_tile::FEATURE_ATTRIBUTES_TAG);
+                    field.add_element(CONTOUR_KEY);
+                    field.add_element(values.Use(params.contours[contour]));
+                }
+                {
+                    protozero::packed_field_uint32 geometry(
+                        feature_writer, util::vector_tile::FEATURE_GEOMETRIES_TAG);
+                    TilePoint cursor{0, 0};
+                    for (const auto &polygon : clipped)
+                    {
+                        encodeRing(roundPoints(polygon.outer()), true, geometry, cursor);
+                        for (const auto &hole : polygon.inners())
+                        {
+                            encodeRing(roundPoints(hole), false, geometry, cursor);
+                        }
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (const auto &line : lines)
+            {
+                linestring_t unclipped;
+                for (const auto coordinate : line.coordinates)
+                {
+                    boost::geometry::append(unclipped, project(coordinate));
+                }
+                multi_linestring_t clipped;
+                boost::geometry::intersection(clip_box, unclipped, clipped);
+
+                std::vector<std::vector<TilePoint>> parts;
+                for (const auto &part : clipped)
+                {
+                    auto points = roundPoints(part);
+                    if (points.size() > 1)
+                    {
+                        parts.push_back(std::move(points));
+                    }
+                }
+                if (parts.empty())
+                {
+                    continue;
+                }
+
+                protozero::pbf_writer feature_writer(layer_writer,
+                                                     util::vector_tile::FEATURE_TAG);
+                feature_writer.add_enum(util::vector_tile::GEOMETRY_TAG,
+                                        util::vector_tile::GEOMETRY_TYPE_LINE);
+                feature_writer.add_uint64(util::vector_tile::ID_TAG, id++);
+                {
+                    protozero::packed_field_uint32 field(
+                        feature_writer, util::vector_tile::FEATURE_ATTRIBUTES_TAG);
+                    field.add_element(CONTOUR_KEY);
+                    field.add_element(values.Use(params.contours[line.contour]));
+                    field.add_element(DURATION_KEY);
+                    field.add_element(values.Use(static_cast<std::uint64_t>(
+                        std::round(line.duration / DECISECONDS_PER_SECOND))));
+                }
+                {
+                    protozero::packed_field_uint32 geometry(
+                        feature_writer, util::vector_tile::FEATURE_GEOMETRIES_TAG);
+                    TilePoint cursor{0, 0};
+                    for (const auto &part : parts)
+                    {
+                        encodePoints(part, geometry, cursor);
+                    }
+                }
+            }
+        }
+
+        layer_writer.add_string(util::vector_tile::KEY_TAG, "contour");
+        layer_writer.add_string(util::vector_tile::KEY_TAG, "duration");
+        values.Encode(layer_writer);
+    }
+
+    protozero::pbf_writer tile_writer{pbf_buffer};
+    tile_writer.add_message(util::vector_tile::LAYER_TAG, layer);
+}
+}
+
+IsochronePlugin::IsochronePlugin(const int max_isochrone_duration,
+                                 std::shared_ptr<SnappingCache> snapping_cache)
+    : max_isochrone_duration(max_isochrone_duration), snapping_cache(std::move(snapping_cache))
+{
+}
+
+template <typename ResultT>
+Status IsochronePlugin::Search(const RoutingAlgorithmsInterface &algorithms,
+                               const api::IsochroneParameters &params,
+                               ResultT &result,
+                               PhantomNode &source,
+                               std::vector<routing_algorithms::ReachedNode> &reached) const
+{
+    if (!algorithms.HasOneToAllSearch())
+    {
+        return Error("NotImplemented",
+                     "One to all search is not implemented for the chosen search algorithm.",
+                     result);
+    }
+
+    BOOST_ASSERT(params.IsValid());
+
+    if (!CheckAllCoordinates(params.coordinates))
+    {
+        return Error("InvalidOptions", "Coordinates are invalid", result);
+    }
+
+    if (max_isochrone_duration > 0 &&
+        params.contours.back() > static_cast<unsigned>(max_isochrone_duration))
+    {
+        return Error("TooBig",
+                     "Contour of " + std::to_string(params.contours.back()) +
+                         " seconds is longer than current maximum (" +
+                         std::to_string(max_isochrone_duration) + ")",
+                     result);
+    }
+
+    const auto &facade = algorithms.GetFacade();
+    auto phantom_nodes = GetPhantomNodes(
+        facade,
+        params,
+        snapping_cache ? snapping_cache->ForDataset(algorithms.GetDataset())
+                       : SnappingCache::Handle{});
+    if (phantom_nodes.empty())
+    {
+        return Error("NoSegment", "Could not find a matching segment for coordinate", result);
+    }
+
+    source = SnapPhantomNodes(phantom_nodes).front();
+    reached = algorithms.OneToAllSearch(
+        source, static_cast<EdgeDuration>(params.contours.back() * DECISECONDS_PER_SECOND));
+    return Status::Ok;
+}
+
+Status IsochronePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                      const api::IsochroneParameters &params,
+                                      util::json::Object &result) const
+{
+    PhantomNode source;
+    std::vector<routing_algorithms::ReachedNode> reached;
+    const auto status = Search(algorithms, params, result, source, reached);
+    if (status != Status::Ok)
+    {
+        return status;
+    }
+
+    const auto &facade = algorithms.GetFacade();
+    util::json::Array features;
+    makeGeoJSON(getReachedLines(facade, reached, params.contours), params, features);
+
+    util::json::Array waypoints;
+    waypoints.values.push_back(api::BaseAPI(facade, params).MakeWaypoint(source));
+
+    result.values["code"] = "Ok";
+    result.values["type"] = "FeatureCollection";
+    result.values["features"] = std::move(features);
+    result.values["waypoints"] = std::move(waypoints);
+    return Status::Ok;
+}
+
+Status IsochronePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                      const api::IsochroneParameters &params,
+                                      std::string &pbf_buffer) const
+{
+    BOOST_ASSERT(params.tile);
+
+    PhantomNode source;
+    std::vector<routing_algorithms::ReachedNode> reached;
+    const auto status = Search(algorithms, params, pbf_buffer, source, reached);
+    if (status != Status::Ok)
+    {
+        return status;
+    }
+
+    encodeVectorTile(
+        getReachedLines(algorithms.GetFacade(), reached, params.contours), params, pbf_buffer);
+    return Status::Ok;
+}
+}
+}
+}
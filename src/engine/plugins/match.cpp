@@ -17,6 +17,7 @@
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -27,6 +28,32 @@ namespace engine
 namespace plugins
 {
 
+// Keeps the nearest candidate of every pair of forward and reverse segment ids, the segments of
+// one edge-based node would only add duplicate states to the matching
+void removeDuplicateCandidates(std::vector<SegmentCandidate> &candidates)
+{
+    // sort by forward id, then by reverse id and then by distance
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const SegmentCandidate &lhs, const SegmentCandidate &rhs) {
+                  return lhs.data.forward_segment_id.id < rhs.data.forward_segment_id.id ||
+                         (lhs.data.forward_segment_id.id == rhs.data.forward_segment_id.id &&
+                          (lhs.data.reverse_segment_id.id < rhs.data.reverse_segment_id.id ||
+                           (lhs.data.reverse_segment_id.id == rhs.data.reverse_segment_id.id &&
+                            lhs.distance < rhs.distance)));
+              });
+
+    auto new_end = std::unique(candidates.begin(),
+                               candidates.end(),
+                               [](const SegmentCandidate &lhs, const SegmentCandidate &rhs) {
+                                   return lhs.data.forward_segment_id.id ==
+                                              rhs.data.forward_segment_id.id &&
+                                          lhs.data.reverse_segment_id.id ==
+                                              rhs.data.reverse_segment_id.id;
+                               });
+    candidates.erase(new_end, candidates.end());
+}
+
 // Filters PhantomNodes to obtain a set of viable candiates
 void filterCandidates(const std::vector<util::Coordinate> &coordinates,
                       MatchPlugin::CandidateLists &candidates_lists)
@@ -55,32 +82,6 @@ void filterCandidates(const std::vector<util::Coordinate> &coordinates,
             continue;
         }
 
-        // sort by forward id, then by reverse id and then by distance
-        std::sort(candidates.begin(),
-                  candidates.end(),
-                  [](const PhantomNodeWithDistance &lhs, const PhantomNodeWithDistance &rhs) {
-                      return lhs.phantom_node.forward_segment_id.id <
-                                 rhs.phantom_node.forward_segment_id.id ||
-                             (lhs.phantom_node.forward_segment_id.id ==
-                                  rhs.phantom_node.forward_segment_id.id &&
-                              (lhs.phantom_node.reverse_segment_id.id <
-                                   rhs.phantom_node.reverse_segment_id.id ||
-                               (lhs.phantom_node.reverse_segment_id.id ==
-                                    rhs.phantom_node.reverse_segment_id.id &&
-                                lhs.distance < rhs.distance)));
-                  });
-
-        auto new_end =
-            std::unique(candidates.begin(),
-                        candidates.end(),
-                        [](const PhantomNodeWithDistance &lhs, const PhantomNodeWithDistance &rhs) {
-                            return lhs.phantom_node.forward_segment_id.id ==
-                                       rhs.phantom_node.forward_segment_id.id &&
-                                   lhs.phantom_node.reverse_segment_id.id ==
-                                       rhs.phantom_node.reverse_segment_id.id;
-                        });
-        candidates.resize(new_end - candidates.begin());
-
         if (!allow_uturn)
         {
             const auto compact_size = candidates.size();
@@ -109,6 +110,101 @@ void filterCandidates(const std::vector<util::Coordinate> &coordinates,
     }
 }
 
+// The candidates of every coordinate, filtered and sorted by distance
+MatchPlugin::CandidateLists
+MatchPlugin::GetCandidateLists(const datafacade::BaseDataFacade &facade,
+                               const api::MatchParameters &parameters) const
+{
+    // assuming radius is the standard deviation of a normal distribution
+    // that models GPS noise (in this model), x3 should give us the correct
+    // search radius with > 99% confidence
+    std::vector<double> search_radiuses;
+    if (parameters.radiuses.empty())
+    {
+        search_radiuses.resize(parameters.coordinates.size(),
+                               routing_algorithms::DEFAULT_GPS_PRECISION * RADIUS_MULTIPLIER);
+    }
+    else
+    {
+        search_radiuses.resize(parameters.coordinates.size());
+        std::transform(parameters.radiuses.begin(),
+                       parameters.radiuses.end(),
+                       search_radiuses.begin(),
+                       [](const boost::optional<double> &maybe_radius) {
+                           if (maybe_radius)
+                           {
+                               return *maybe_radius * RADIUS_MULTIPLIER;
+                           }
+                           else
+                           {
+                               return routing_algorithms::DEFAULT_GPS_PRECISION * RADIUS_MULTIPLIER;
+                           }
+
+                       });
+    }
+
+    // phantom nodes are only built for the candidates that remain after removing duplicates
+    CandidateLists candidates_lists(parameters.coordinates.size());
+    for (const auto i : util::irange<std::size_t>(0UL, candidates_lists.size()))
+    {
+        if (const auto hinted = GetHintedPhantomNode(facade, parameters, i))
+        {
+            candidates_lists[i].push_back(*hinted);
+            continue;
+        }
+
+        auto candidates = GetCandidatesInRange(facade, parameters, i, search_radiuses[i]);
+        removeDuplicateCandidates(candidates);
+        candidates_lists[i].reserve(candidates.size());
+        for (const auto &candidate : candidates)
+        {
+            candidates_lists[i].push_back(
+                facade.MakePhantomNode(parameters.coordinates[i], candidate));
+        }
+    }
+
+    filterCandidates(parameters.coordinates, candidates_lists);
+    return candidates_lists;
+}
+
+// The routes along the matched positions, for their geometry
+std::vector<InternalRouteResult>
+MatchPlugin::RouteSubMatchings(const RoutingAlgorithmsInterface &algorithms,
+                               const SubMatchingList &sub_matchings) const
+{
+    std::vector<InternalRouteResult> sub_routes(sub_matchings.size());
+    for (auto index : util::irange<std::size_t>(0UL, sub_matchings.size()))
+    {
+        BOOST_ASSERT(!sub_matchings[index].nodes.empty());
+
+        // FIXME we only run this to obtain the geometry
+        // The clean way would be to get this directly from the map matching plugin
+        PhantomNodes current_phantom_node_pair;
+        for (unsigned i = 0; i < sub_matchings[index].nodes.size() - 1; ++i)
+        {
+            current_phantom_node_pair.source_phantom = sub_matchings[index].nodes[i];
+            current_phantom_node_pair.target_phantom = sub_matchings[index].nodes[i + 1];
+            BOOST_ASSERT(current_phantom_node_pair.source_phantom.IsValid());
+            BOOST_ASSERT(current_phantom_node_pair.target_phantom.IsValid());
+            sub_routes[index].segment_end_coordinates.emplace_back(current_phantom_node_pair);
+        }
+        // only the matchings of sessions consist of a single position, an empty route to itself
+        if (sub_matchings[index].nodes.size() == 1)
+        {
+            const auto &position = sub_matchings[index].nodes.front();
+            sub_routes[index].segment_end_coordinates.push_back(PhantomNodes{position, position});
+        }
+        // force uturns to be on, since we split the phantom nodes anyway and only have
+        // bi-directional
+        // phantom nodes for possible uturns
+        sub_routes[index] = algorithms.ShortestPathSearch(
+            sub_routes[index].segment_end_coordinates, {false}, false);
+        BOOST_ASSERT(sub_routes[index].shortest_path_weight != INVALID_EDGE_WEIGHT);
+    }
+
+    return sub_routes;
+}
+
 Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                   const api::MatchParameters &parameters,
                                   util::json::Object &json_result) const
@@ -147,6 +243,11 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
             "InvalidValue", "Timestamps need to be monotonically increasing.", json_result);
     }
 
+    if (!parameters.session.empty())
+    {
+        return HandleSessionRequest(algorithms, parameters, json_result);
+    }
+
     SubMatchingList sub_matchings;
     api::tidy::Result tidied;
     if (parameters.tidy)
@@ -160,37 +261,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
         tidied = api::tidy::keep_all(parameters);
     }
 
-    // assuming radius is the standard deviation of a normal distribution
-    // that models GPS noise (in this model), x3 should give us the correct
-    // search radius with > 99% confidence
-    std::vector<double> search_radiuses;
-    if (tidied.parameters.radiuses.empty())
-    {
-        search_radiuses.resize(tidied.parameters.coordinates.size(),
-                               routing_algorithms::DEFAULT_GPS_PRECISION * RADIUS_MULTIPLIER);
-    }
-    else
-    {
-        search_radiuses.resize(tidied.parameters.coordinates.size());
-        std::transform(tidied.parameters.radiuses.begin(),
-                       tidied.parameters.radiuses.end(),
-                       search_radiuses.begin(),
-                       [](const boost::optional<double> &maybe_radius) {
-                           if (maybe_radius)
-                           {
-                               return *maybe_radius * RADIUS_MULTIPLIER;
-                           }
-                           else
-                           {
-                               return routing_algorithms::DEFAULT_GPS_PRECISION * RADIUS_MULTIPLIER;
-                           }
-
-                       });
-    }
-
-    auto candidates_lists = GetPhantomNodesInRange(facade, tidied.parameters, search_radiuses);
-
-    filterCandidates(tidied.parameters.coordinates, candidates_lists);
+    auto candidates_lists = GetCandidateLists(facade, tidied.parameters);
     if (std::all_of(candidates_lists.begin(),
                     candidates_lists.end(),
                     [](const std::vector<PhantomNodeWithDistance> &candidates) {
@@ -203,43 +274,72 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     }
 
     // call the actual map matching
+    const bool parallel = min_parallel_match_size != -1 &&
+                          tidied.parameters.coordinates.size() >=
+                              static_cast<std::size_t>(min_parallel_match_size);
     sub_matchings =
         algorithms.MapMatching(candidates_lists,
                                tidied.parameters.coordinates,
                                tidied.parameters.timestamps,
                                tidied.parameters.radiuses,
-                               parameters.gaps == api::MatchParameters::GapsType::Split);
+                               parameters.gaps == api::MatchParameters::GapsType::Split,
+                               parallel);
 
     if (sub_matchings.size() == 0)
     {
         return Error("NoMatch", "Could not match the trace.", json_result);
     }
 
-    std::vector<InternalRouteResult> sub_routes(sub_matchings.size());
-    for (auto index : util::irange<std::size_t>(0UL, sub_matchings.size()))
+    const auto sub_routes = RouteSubMatchings(algorithms, sub_matchings);
+
+    api::MatchAPI match_api{facade, parameters, tidied};
+    match_api.MakeResponse(sub_matchings, sub_routes, json_result);
+
+    return Status::Ok;
+}
+// Extends the trace of the session by the coordinates of the request. The response has the same
+// format as the one of a whole trace, its matching leads from the last position the session
+// matched before, if the path to the new positions runs through it.
+Status MatchPlugin::HandleSessionRequest(const RoutingAlgorithmsInterface &algorithms,
+                                         const api::MatchParameters &parameters,
+                                         util::json::Object &json_result) const
+{
+    if (!sessions)
     {
-        BOOST_ASSERT(sub_matchings[index].nodes.size() > 1);
+        return Error("InvalidOptions", "Matching sessions are disabled.", json_result);
+    }
 
-        // FIXME we only run this to obtain the geometry
-        // The clean way would be to get this directly from the map matching plugin
-        PhantomNodes current_phantom_node_pair;
-        for (unsigned i = 0; i < sub_matchings[index].nodes.size() - 1; ++i)
-        {
-            current_phantom_node_pair.source_phantom = sub_matchings[index].nodes[i];
-            current_phantom_node_pair.target_phantom = sub_matchings[index].nodes[i + 1];
-            BOOST_ASSERT(current_phantom_node_pair.source_phantom.IsValid());
-            BOOST_ASSERT(current_phantom_node_pair.target_phantom.IsValid());
-            sub_routes[index].segment_end_coordinates.emplace_back(current_phantom_node_pair);
-        }
-        // force uturns to be on, since we split the phantom nodes anyway and only have
-        // bi-directional
-        // phantom nodes for possible uturns
-        sub_routes[index] =
-            algorithms.ShortestPathSearch(sub_routes[index].segment_end_coordinates, {false});
-        BOOST_ASSERT(sub_routes[index].shortest_path_weight != INVALID_EDGE_WEIGHT);
+    const auto session = sessions->Get(parameters.session, algorithms.GetDataset());
+    // requests of the same session extend it one after another
+    std::lock_guard<std::mutex> lock(session->mutex);
+    auto &state = session->state;
+
+    if (!parameters.timestamps.empty() && state.timestamp &&
+        parameters.timestamps.front() < *state.timestamp)
+    {
+        return Error("InvalidValue",
+                     "Timestamps need to be monotonically increasing across the session.",
+                     json_result);
     }
 
-    api::MatchAPI match_api{facade, parameters, tidied};
+    const auto tidied = api::tidy::keep_all(parameters);
+    const auto candidates_lists = GetCandidateLists(algorithms.GetFacade(), tidied.parameters);
+    const auto matching =
+        algorithms.ExtendMapMatching(state,
+                                     candidates_lists,
+                                     tidied.parameters.coordinates,
+                                     tidied.parameters.timestamps,
+                                     tidied.parameters.radiuses,
+                                     parameters.gaps == api::MatchParameters::GapsType::Split);
+    if (matching.nodes.empty())
+    {
+        return Error("NoMatch", "Could not match the trace.", json_result);
+    }
+
+    const SubMatchingList sub_matchings = {matching};
+    const auto sub_routes = RouteSubMatchings(algorithms, sub_matchings);
+
+    api::MatchAPI match_api{algorithms.GetFacade(), parameters, tidied};
     match_api.MakeResponse(sub_matchings, sub_routes, json_result);
 
     return Status::Ok;
@@ -44,16 +44,22 @@ Status NearestPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms
         return Error("InvalidOptions", "Only one input coordinate is supported", json_result);
     }
 
-    auto phantom_nodes = GetPhantomNodes(facade, params, params.number_of_results);
+    api::NearestAPI nearest_api(facade, params);
 
-    if (phantom_nodes.front().size() == 0)
+    if (const auto hinted = GetHintedPhantomNode(facade, params, 0))
+    {
+        nearest_api.MakeResponse({{*hinted}}, json_result);
+        return Status::Ok;
+    }
+
+    // the phantom nodes of the candidates are only built for their hints
+    const auto candidates = GetCandidates(facade, params, 0, params.number_of_results);
+    if (candidates.empty())
     {
         return Error("NoSegment", "Could not find a matching segments for coordinate", json_result);
     }
-    BOOST_ASSERT(phantom_nodes.front().size() > 0);
 
-    api::NearestAPI nearest_api(facade, params);
-    nearest_api.MakeResponse(phantom_nodes, json_result);
+    nearest_api.MakeResponse(candidates, json_result);
 
     return Status::Ok;
 }
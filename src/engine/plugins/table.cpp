@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -23,14 +24,23 @@ namespace engine
 namespace plugins
 {
 
-TablePlugin::TablePlugin(const int max_locations_distance_table)
-    : max_locations_distance_table(max_locations_distance_table)
+TablePlugin::TablePlugin(const int max_locations_distance_table,
+                         const int min_parallel_table_size,
+                         const int min_rphast_table_size,
+                         const int min_fused_table_size,
+                         std::shared_ptr<SnappingCache> snapping_cache)
+    : max_locations_distance_table(max_locations_distance_table),
+      min_parallel_table_size(min_parallel_table_size),
+      min_rphast_table_size(min_rphast_table_size), min_fused_table_size(min_fused_table_size),
+      snapping_cache(std::move(snapping_cache))
 {
 }
 
-Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
-                                  const api::TableParameters &params,
-                                  util::json::Object &result) const
+template <typename ResultT>
+Status TablePlugin::SnapCoordinates(const RoutingAlgorithmsInterface &algorithms,
+                                    const api::TableParameters &params,
+                                    std::vector<PhantomNode> &snapped_phantoms,
+                                    ResultT &result) const
 {
     if (!algorithms.HasManyToManySearch())
     {
@@ -39,6 +49,13 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                      result);
     }
 
+    if (!params.paths.empty() && !algorithms.HasManyToManyPaths())
+    {
+        return Error("NotImplemented",
+                     "Paths of table entries are not implemented for the chosen search algorithm.",
+                     result);
+    }
+
     BOOST_ASSERT(params.IsValid());
 
     if (!CheckAllCoordinates(params.coordinates))
@@ -53,7 +70,6 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     }
 
     // Empty sources or destinations means the user wants all of them included, respectively
-    // The ManyToMany routing algorithm we dispatch to below already handles this perfectly.
     const auto num_sources =
         params.sources.empty() ? params.coordinates.size() : params.sources.size();
     const auto num_destinations =
@@ -67,7 +83,11 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     }
 
     const auto &facade = algorithms.GetFacade();
-    auto phantom_nodes = GetPhantomNodes(facade, params);
+    auto phantom_nodes = GetPhantomNodes(
+        facade,
+        params,
+        snapping_cache ? snapping_cache->ForDataset(algorithms.GetDataset())
+                       : SnappingCache::Handle{});
 
     if (phantom_nodes.size() != params.coordinates.size())
     {
@@ -77,17 +97,153 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                      result);
     }
 
-    auto snapped_phantoms = SnapPhantomNodes(phantom_nodes);
-    auto result_table =
-        algorithms.ManyToManySearch(snapped_phantoms, params.sources, params.destinations);
+    snapped_phantoms = SnapPhantomNodes(phantom_nodes);
+    return Status::Ok;
+}
 
-    if (result_table.empty())
+routing_algorithms::ManyToManyOptions
+TablePlugin::MakeOptions(const api::TableParameters &params,
+                         const std::size_t number_of_entries) const
+{
+    const auto at_least = [number_of_entries](const int min_table_size) {
+        return min_table_size != -1 &&
+               number_of_entries >= static_cast<std::size_t>(min_table_size);
+    };
+    routing_algorithms::ManyToManyOptions options;
+    options.parallel = at_least(min_parallel_table_size);
+    options.rphast = at_least(min_rphast_table_size);
+    options.fuse_square = at_least(min_fused_table_size);
+    options.distances = params.annotations & api::TableParameters::AnnotationsType::Distance;
+    options.paths = params.paths;
+    return options;
+}
+
+template <typename ResultT>
+Status TablePlugin::ComputeTable(const RoutingAlgorithmsInterface &algorithms,
+                                 const api::TableParameters &params,
+                                 ResultT &result) const
+{
+    std::vector<PhantomNode> snapped_phantoms;
+    const auto status = SnapCoordinates(algorithms, params, snapped_phantoms, result);
+    if (status != Status::Ok)
+    {
+        return status;
+    }
+
+    const auto num_sources =
+        params.sources.empty() ? params.coordinates.size() : params.sources.size();
+    const auto num_destinations =
+        params.destinations.empty() ? params.coordinates.size() : params.destinations.size();
+    const auto options = MakeOptions(params, num_sources * num_destinations);
+    std::vector<InternalRouteResult> paths;
+    auto result_tables = algorithms.ManyToManySearch(
+        snapped_phantoms, params.sources, params.destinations, options, paths);
+
+    if (result_tables.first.empty())
     {
         return Error("NoTable", "No table found", result);
     }
 
-    api::TableAPI table_api{facade, params};
-    table_api.MakeResponse(result_table, snapped_phantoms, result);
+    api::TableAPI table_api{algorithms.GetFacade(), params};
+    table_api.MakeResponse(result_tables, snapped_phantoms, paths, result);
+
+    return Status::Ok;
+}
+
+Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                  const api::TableParameters &params,
+                                  util::json::Object &result) const
+{
+    return ComputeTable(algorithms, params, result);
+}
+
+Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                  const api::TableParameters &params,
+                                  std::vector<char> &result) const
+{
+    return ComputeTable(algorithms, params, result);
+}
+
+Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                  const api::TableParameters &params,
+                                  api::TableMatrices &result) const
+{
+    return ComputeTable(algorithms, params, result);
+}
+
+Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                  const api::TableParameters &params,
+                                  api::TableWriter &writer) const
+{
+    // the paths of the entries are traced through the search spaces of the whole table
+    if (!params.paths.empty())
+    {
+        std::vector<char> rendered;
+        const auto status = ComputeTable(algorithms, params, rendered);
+        if (status != Status::Ok)
+        {
+            writer.error = std::move(rendered);
+            return status;
+        }
+        if (!writer.write(rendered))
+        {
+            return Error("Cancelled", "The table was cancelled while it was written", writer);
+        }
+        return Status::Ok;
+    }
+
+    std::vector<PhantomNode> snapped_phantoms;
+    const auto status = SnapCoordinates(algorithms, params, snapped_phantoms, writer);
+    if (status != Status::Ok)
+    {
+        return status;
+    }
+
+    std::vector<std::size_t> sources = params.sources;
+    if (sources.empty())
+    {
+        sources.resize(params.coordinates.size());
+        std::iota(sources.begin(), sources.end(), 0);
+    }
+    const auto num_destinations =
+        params.destinations.empty() ? params.coordinates.size() : params.destinations.size();
+    const auto rows_per_chunk = std::max<std::size_t>(1, writer.rows_per_chunk);
+
+    api::TableAPI table_api{algorithms.GetFacade(), params};
+    std::vector<char> piece;
+    std::vector<char> deferred_rows;
+    table_api.MakeResponseHead(snapped_phantoms, piece);
+    for (std::size_t first_row = 0; first_row < sources.size(); first_row += rows_per_chunk)
+    {
+        const auto num_rows = std::min(rows_per_chunk, sources.size() - first_row);
+        // a table of a single chunk is searched exactly like the other overloads do
+        const auto chunk_sources =
+            num_rows == sources.size()
+                ? params.sources
+                : std::vector<std::size_t>(sources.begin() + first_row,
+                                           sources.begin() + first_row + num_rows);
+        const auto result_tables =
+            algorithms.ManyToManySearch(snapped_phantoms,
+                                        chunk_sources,
+                                        params.destinations,
+                                        MakeOptions(params, num_rows * num_destinations));
+        if (result_tables.first.empty())
+        {
+            return Error("NoTable", "No table found", writer);
+        }
+
+        table_api.MakeResponseRows(
+            result_tables, first_row, num_rows, num_destinations, piece, deferred_rows);
+        if (first_row + num_rows == sources.size())
+        {
+            table_api.MakeResponseTail(deferred_rows, piece);
+        }
+        if (!writer.write(piece))
+        {
+            return Error("Cancelled", "The table was cancelled while it was written", writer);
+        }
+        piece.clear();
+    }
 
     return Status::Ok;
 }
@@ -4,6 +4,8 @@
 #include "engine/api/trip_parameters.hpp"
 #include "engine/trip/trip_brute_force.hpp"
 #include "engine/trip/trip_farthest_insertion.hpp"
+#include "engine/trip/trip_held_karp.hpp"
+#include "engine/trip/trip_local_search.hpp"
 #include "engine/trip/trip_nearest_neighbour.hpp"
 #include "util/dist_table_wrapper.hpp" // to access the dist table more easily
 #include "util/json_container.hpp"
@@ -85,7 +87,7 @@ InternalRouteResult TripPlugin::ComputeRoute(const RoutingAlgorithmsInterface &a
         BOOST_ASSERT(min_route.segment_end_coordinates.size() == trip.size() - 1);
     }
 
-    min_route = algorithms.ShortestPathSearch(min_route.segment_end_coordinates, {false});
+    min_route = algorithms.ShortestPathSearch(min_route.segment_end_coordinates, {false}, false);
     BOOST_ASSERT_MSG(min_route.shortest_path_weight < INVALID_EDGE_WEIGHT, "unroutable route");
     return min_route;
 }
@@ -192,7 +194,11 @@ Status TripPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     }
 
     const auto &facade = algorithms.GetFacade();
-    auto phantom_node_pairs = GetPhantomNodes(facade, parameters);
+    auto phantom_node_pairs = GetPhantomNodes(
+        facade,
+        parameters,
+        snapping_cache ? snapping_cache->ForDataset(algorithms.GetDataset())
+                       : SnappingCache::Handle{});
     if (phantom_node_pairs.size() != number_of_locations)
     {
         return Error("NoSegment",
@@ -214,7 +220,7 @@ Status TripPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
 
     // compute the duration table of all phantom nodes
     auto result_table = util::DistTableWrapper<EdgeWeight>(
-        algorithms.ManyToManySearch(snapped_phantoms, {}, {}), number_of_locations);
+        algorithms.ManyToManySearch(snapped_phantoms, {}, {}, {}).first, number_of_locations);
 
     if (result_table.size() == 0)
     {
@@ -222,6 +228,7 @@ Status TripPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     }
 
     const constexpr std::size_t BF_MAX_FEASABLE = 10;
+    const constexpr std::size_t HK_MAX_FEASABLE = 16;
     BOOST_ASSERT_MSG(result_table.size() == number_of_locations * number_of_locations,
                      "Distance Table has wrong size");
 
@@ -242,9 +249,14 @@ Status TripPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     {
         trip = trip::BruteForceTrip(number_of_locations, result_table);
     }
+    else if (number_of_locations <= HK_MAX_FEASABLE)
+    {
+        trip = trip::HeldKarpTrip(number_of_locations, result_table);
+    }
     else
     {
-        trip = trip::FarthestInsertionTrip(number_of_locations, result_table);
+        trip = trip::LocalSearchTrip(
+            trip::FarthestInsertionTrip(number_of_locations, result_table), result_table);
     }
 
     // rotate result such that roundtrip starts at node with index 0
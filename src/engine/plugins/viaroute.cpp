@@ -3,6 +3,7 @@
 #include "engine/routing_algorithms.hpp"
 #include "engine/status.hpp"
 
+#include "util/coordinate_calculation.hpp"
 #include "util/for_each_pair.hpp"
 #include "util/integer_range.hpp"
 #include "util/json_container.hpp"
@@ -21,11 +22,48 @@ namespace engine
 namespace plugins
 {
 
-ViaRoutePlugin::ViaRoutePlugin(int max_locations_viaroute, int max_alternatives)
-    : max_locations_viaroute(max_locations_viaroute), max_alternatives(max_alternatives)
+ViaRoutePlugin::ViaRoutePlugin(int max_locations_viaroute,
+                               int max_alternatives,
+                               int max_cached_routes,
+                               int max_reroute_destinations,
+                               int min_parallel_route_size,
+                               int min_parallel_search_distance,
+                               std::shared_ptr<SnappingCache> snapping_cache)
+    : max_locations_viaroute(max_locations_viaroute), max_alternatives(max_alternatives),
+      min_parallel_route_size(min_parallel_route_size),
+      min_parallel_search_distance(min_parallel_search_distance),
+      route_cache(max_cached_routes > 0 ? std::make_unique<RouteCache>(max_cached_routes)
+                                        : nullptr),
+      destination_cache(max_reroute_destinations > 0
+                            ? std::make_unique<DestinationCache>(max_reroute_destinations)
+                            : nullptr),
+      snapping_cache(std::move(snapping_cache))
 {
 }
 
+util::CacheStatistics ViaRoutePlugin::GetCacheStatistics() const
+{
+    if (!route_cache)
+    {
+        return util::CacheStatistics{0, 0, 0, 0, 0};
+    }
+    return route_cache->GetStatistics();
+}
+
+InternalManyRoutesResult ViaRoutePlugin::RerouteSearch(const RoutingAlgorithmsInterface &algorithms,
+                                                       const PhantomNodes &phantom_nodes) const
+{
+    auto key = destination_cache->MakeKey(algorithms.GetDataset(), phantom_nodes.target_phantom);
+    auto destination = destination_cache->Get(key);
+    if (!destination)
+    {
+        destination = std::make_shared<const DestinationCache::SearchSpace>(
+            algorithms.DestinationSearch(phantom_nodes.target_phantom));
+        destination_cache->Insert(std::move(key), destination);
+    }
+    return algorithms.RerouteSearch(phantom_nodes, *destination);
+}
+
 Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                      const api::RouteParameters &route_parameters,
                                      util::json::Object &json_result) const
@@ -74,7 +112,11 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
     }
 
     const auto &facade = algorithms.GetFacade();
-    auto phantom_node_pairs = GetPhantomNodes(facade, route_parameters);
+    auto phantom_node_pairs = GetPhantomNodes(
+        facade,
+        route_parameters,
+        snapping_cache ? snapping_cache->ForDataset(algorithms.GetDataset())
+                       : SnappingCache::Handle{});
     if (phantom_node_pairs.size() != route_parameters.coordinates.size())
     {
         return Error("NoSegment",
@@ -93,7 +135,10 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
     };
     util::for_each_pair(snapped_phantoms, build_phantom_pairs);
 
-    api::RouteAPI route_api{facade, route_parameters};
+    const bool parallel = min_parallel_route_size != -1 &&
+                          route_parameters.coordinates.size() >=
+                              static_cast<std::size_t>(min_parallel_route_size);
+    api::RouteAPI route_api{facade, route_parameters, parallel};
 
     InternalManyRoutesResult routes;
 
@@ -104,20 +149,64 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
         (route_parameters.alternatives || route_parameters.number_of_alternatives > 0);
     const auto number_of_alternatives = std::max(1u, route_parameters.number_of_alternatives);
 
+    // routes between two coordinates avoid the conditional turn restrictions of the departure
+    // time, these routes depend on it and are not cached
+    const auto avoids_conditional_turns = route_parameters.departure_time &&
+                                          algorithms.HasConditionalDirectShortestPathSearch() &&
+                                          1 == start_end_nodes.size() && !wants_alternatives;
+
+    boost::optional<RouteCache::Key> cache_key;
+    boost::optional<InternalManyRoutesResult> cached_routes;
+    if (route_cache && !avoids_conditional_turns)
+    {
+        cache_key = route_cache->MakeKey(algorithms.GetDataset(),
+                                         start_end_nodes,
+                                         wants_alternatives ? number_of_alternatives : 0,
+                                         route_parameters.continue_straight);
+        cached_routes = route_cache->Get(*cache_key, start_end_nodes);
+    }
+
     // Alternatives do not support vias, only direct s,t queries supported
     // See the implementation notes and high-level outline.
     // https://github.com/Project-OSRM/osrm-backend/issues/3905
-    if (1 == start_end_nodes.size() && algorithms.HasAlternativePathSearch() && wants_alternatives)
+    if (cached_routes)
+    {
+        routes = std::move(*cached_routes);
+    }
+    else if (1 == start_end_nodes.size() && algorithms.HasAlternativePathSearch() &&
+             wants_alternatives)
     {
         routes = algorithms.AlternativePathSearch(start_end_nodes.front(), number_of_alternatives);
     }
+    else if (route_parameters.reroute && destination_cache && 1 == start_end_nodes.size() &&
+             algorithms.HasRerouteSearch() && !wants_alternatives && !avoids_conditional_turns)
+    {
+        routes = RerouteSearch(algorithms, start_end_nodes.front());
+    }
+    else if (avoids_conditional_turns)
+    {
+        routes = algorithms.ConditionalDirectShortestPathSearch(start_end_nodes.front(),
+                                                                *route_parameters.departure_time);
+    }
     else if (1 == start_end_nodes.size() && algorithms.HasDirectShortestPathSearch())
     {
-        routes = algorithms.DirectShortestPathSearch(start_end_nodes.front());
+        const auto &phantom_nodes = start_end_nodes.front();
+        const bool parallel_search =
+            min_parallel_search_distance != -1 &&
+            util::coordinate_calculation::greatCircleDistance(
+                phantom_nodes.source_phantom.location, phantom_nodes.target_phantom.location) >=
+                min_parallel_search_distance;
+        routes = algorithms.DirectShortestPathSearch(phantom_nodes, parallel_search);
     }
     else
     {
-        routes = algorithms.ShortestPathSearch(start_end_nodes, route_parameters.continue_straight);
+        routes = algorithms.ShortestPathSearch(
+            start_end_nodes, route_parameters.continue_straight, parallel);
+    }
+
+    if (cache_key && !cached_routes)
+    {
+        route_cache->Insert(std::move(*cache_key), routes);
     }
 
     // The post condition for all path searches is we have at least one route in our result.
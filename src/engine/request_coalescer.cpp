@@ -0,0 +1,109 @@
+#include "engine/request_coalescer.hpp"
+
+#include "util/std_hash.hpp"
+
+#include <type_traits>
+
+namespace osrm
+{
+namespace engine
+{
+
+namespace
+{
+template <typename T> void Append(std::string &encoded, const T &value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values can be appended");
+    encoded.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// A presence byte followed by the value, so that a missing value can not look like a present one
+template <typename T, typename AppendValue>
+void AppendOptional(std::string &encoded, const boost::optional<T> &value, AppendValue append)
+{
+    encoded.push_back(value ? 1 : 0);
+    if (value)
+    {
+        append(*value);
+    }
+}
+
+void AppendBase(std::string &encoded, const api::BaseParameters &parameters)
+{
+    Append(encoded, parameters.coordinates.size());
+    for (const auto &coordinate : parameters.coordinates)
+    {
+        Append(encoded, static_cast<std::int32_t>(coordinate.lon));
+        Append(encoded, static_cast<std::int32_t>(coordinate.lat));
+    }
+
+    Append(encoded, parameters.hints.size());
+    for (const auto &hint : parameters.hints)
+    {
+        AppendOptional(encoded, hint, [&](const Hint &value) { encoded += value.ToBase64(); });
+    }
+
+    Append(encoded, parameters.radiuses.size());
+    for (const auto &radius : parameters.radiuses)
+    {
+        AppendOptional(encoded, radius, [&](const double value) { Append(encoded, value); });
+    }
+
+    Append(encoded, parameters.bearings.size());
+    for (const auto &bearing : parameters.bearings)
+    {
+        AppendOptional(encoded, bearing, [&](const Bearing &value) {
+            Append(encoded, value.bearing);
+            Append(encoded, value.range);
+        });
+    }
+
+    Append(encoded, parameters.approaches.size());
+    for (const auto &approach : parameters.approaches)
+    {
+        AppendOptional(encoded, approach, [&](const Approach value) { Append(encoded, value); });
+    }
+
+    Append(encoded, parameters.generate_hints);
+    Append(encoded, parameters.compact_hints);
+    // the statistics are part of the result
+    Append(encoded, parameters.debug_stats);
+    // the deadline can abort the computation
+    AppendOptional(encoded, parameters.timeout, [&](const std::chrono::milliseconds value) {
+        Append(encoded, value.count());
+    });
+}
+}
+
+std::string EncodeRequest(const api::RouteParameters &parameters)
+{
+    std::string encoded;
+    AppendBase(encoded, parameters);
+    Append(encoded, parameters.steps);
+    Append(encoded, parameters.alternatives);
+    Append(encoded, parameters.number_of_alternatives);
+    Append(encoded, parameters.annotations);
+    Append(encoded, parameters.annotations_type);
+    Append(encoded, parameters.geometries);
+    Append(encoded, parameters.overview);
+    AppendOptional(encoded, parameters.continue_straight, [&](const bool value) {
+        Append(encoded, value);
+    });
+    return encoded;
+}
+
+std::string EncodeRequest(const api::TileParameters &parameters)
+{
+    std::string encoded;
+    Append(encoded, parameters.x);
+    Append(encoded, parameters.y);
+    Append(encoded, parameters.z);
+    return encoded;
+}
+
+std::size_t RequestCoalescerBase::KeyHash::operator()(const Key &key) const
+{
+    return hash_val(key.generation, key.request);
+}
+}
+}
@@ -0,0 +1,96 @@
+#include "engine/route_cache.hpp"
+
+#include "util/std_hash.hpp"
+
+#include <boost/assert.hpp>
+
+#include <utility>
+
+namespace osrm
+{
+namespace engine
+{
+
+namespace
+{
+// Everything of a phantom node the path search looks at
+void AppendPhantomNode(std::vector<std::int32_t> &words, const PhantomNode &phantom)
+{
+    const std::int32_t flags = (phantom.IsValidForwardSource() << 0) |
+                               (phantom.IsValidForwardTarget() << 1) |
+                               (phantom.IsValidReverseSource() << 2) |
+                               (phantom.IsValidReverseTarget() << 3) |
+                               (phantom.forward_segment_id.enabled << 4) |
+                               (phantom.reverse_segment_id.enabled << 5);
+    words.insert(words.end(),
+                 {static_cast<std::int32_t>(phantom.forward_segment_id.id),
+                  static_cast<std::int32_t>(phantom.reverse_segment_id.id),
+                  flags,
+                  phantom.fwd_segment_position,
+                  phantom.forward_weight,
+                  phantom.reverse_weight,
+                  phantom.forward_weight_offset,
+                  phantom.reverse_weight_offset,
+                  phantom.forward_duration,
+                  phantom.reverse_duration,
+                  phantom.forward_duration_offset,
+                  phantom.reverse_duration_offset,
+                  static_cast<std::int32_t>(phantom.location.lon),
+                  static_cast<std::int32_t>(phantom.location.lat)});
+}
+}
+
+std::size_t RouteCache::KeyHash::operator()(const Key &key) const
+{
+    std::size_t seed = std::hash<std::uint64_t>()(key.generation);
+    for (const auto word : key.words)
+    {
+        hash_combine(seed, word);
+    }
+    return seed;
+}
+
+RouteCache::RouteCache(const std::size_t capacity) : cache(capacity) {}
+
+RouteCache::Key RouteCache::MakeKey(const std::shared_ptr<const void> &dataset,
+                                    const std::vector<PhantomNodes> &start_end_nodes,
+                                    const unsigned number_of_alternatives,
+                                    const boost::optional<bool> continue_straight)
+{
+    Key key{generation.Get(dataset, [this]() { cache.Clear(); }), {}};
+    key.words.reserve(2 + start_end_nodes.size() * 28);
+    key.words.push_back(number_of_alternatives);
+    key.words.push_back(continue_straight ? *continue_straight : -1);
+    for (const auto &phantoms : start_end_nodes)
+    {
+        AppendPhantomNode(key.words, phantoms.source_phantom);
+        AppendPhantomNode(key.words, phantoms.target_phantom);
+    }
+    return key;
+}
+
+boost::optional<InternalManyRoutesResult>
+RouteCache::Get(const Key &key, const std::vector<PhantomNodes> &start_end_nodes)
+{
+    const auto cached = cache.Get(key);
+    if (!cached)
+    {
+        return boost::none;
+    }
+
+    auto routes = *cached;
+    for (auto &route : routes.routes)
+    {
+        BOOST_ASSERT(route.segment_end_coordinates.size() == start_end_nodes.size());
+        route.segment_end_coordinates = start_end_nodes;
+    }
+    return std::move(routes);
+}
+
+void RouteCache::Insert(Key key, InternalManyRoutesResult routes)
+{
+    cache.Insert(std::move(key),
+                 std::make_shared<const InternalManyRoutesResult>(std::move(routes)));
+}
+}
+}
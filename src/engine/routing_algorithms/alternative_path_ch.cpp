@@ -5,7 +5,12 @@
 
 #include <boost/assert.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
 #include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <memory>
 #include <unordered_set>
@@ -62,6 +67,8 @@ void alternativeRoutingStep(const DataFacade<Algorithm> &facade,
     QueryHeap &forward_heap = DIRECTION == FORWARD_DIRECTION ? heap1 : heap2;
     QueryHeap &reverse_heap = DIRECTION == FORWARD_DIRECTION ? heap2 : heap1;
 
+    SearchTracing::Settled(forward_heap.Size());
+
     const NodeID node = forward_heap.DeleteMin();
     const EdgeWeight weight = forward_heap.GetKey(node);
 
@@ -107,6 +114,7 @@ void alternativeRoutingStep(const DataFacade<Algorithm> &facade,
         const auto &data = facade.GetEdgeData(edge);
         if (DIRECTION == FORWARD_DIRECTION ? data.forward : data.backward)
         {
+            SearchTracing::Relaxed();
             const NodeID to = facade.GetTarget(edge);
             const EdgeWeight edge_weight = data.weight;
 
@@ -152,19 +160,20 @@ void retrievePackedAlternatePath(const QueryHeap &forward_heap1,
 // TODO: reorder parameters
 // compute and unpack <s,..,v> and <v,..,t> by exploring search spaces
 // from v and intersecting against queues. only half-searches have to be
-// done at this stage
+// done at this stage. The existing heaps are only read, the searches from v run on the second
+// heaps of engine_working_data.
 void computeWeightAndSharingOfViaPath(SearchEngineData<Algorithm> &engine_working_data,
                                       const DataFacade<Algorithm> &facade,
+                                      QueryHeap &existing_forward_heap,
+                                      QueryHeap &existing_reverse_heap,
                                       const NodeID via_node,
                                       EdgeWeight *real_weight_of_via_path,
                                       EdgeWeight *sharing_of_via_path,
                                       const std::vector<NodeID> &packed_shortest_path,
                                       const EdgeWeight min_edge_offset)
 {
-    engine_working_data.InitializeOrClearSecondThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearSecondHeaps(facade.GetNumberOfNodes());
 
-    auto &existing_forward_heap = *engine_working_data.forward_heap_1;
-    auto &existing_reverse_heap = *engine_working_data.reverse_heap_1;
     auto &new_forward_heap = *engine_working_data.forward_heap_2;
     auto &new_reverse_heap = *engine_working_data.reverse_heap_2;
 
@@ -237,11 +246,13 @@ void computeWeightAndSharingOfViaPath(SearchEngineData<Algorithm> &engine_workin
                 unpackEdge(facade,
                            packed_s_v_path[current_node],
                            packed_s_v_path[current_node + 1],
-                           partially_unpacked_via_path);
+                           partially_unpacked_via_path,
+                           engine_working_data.unpacking_cache);
                 unpackEdge(facade,
                            packed_shortest_path[current_node],
                            packed_shortest_path[current_node + 1],
-                           partially_unpacked_shortest_path);
+                           partially_unpacked_shortest_path,
+                           engine_working_data.unpacking_cache);
                 break;
             }
         }
@@ -283,11 +294,13 @@ void computeWeightAndSharingOfViaPath(SearchEngineData<Algorithm> &engine_workin
                 unpackEdge(facade,
                            packed_v_t_path[via_path_index - 1],
                            packed_v_t_path[via_path_index],
-                           partially_unpacked_via_path);
+                           partially_unpacked_via_path,
+                           engine_working_data.unpacking_cache);
                 unpackEdge(facade,
                            packed_shortest_path[shortest_path_index - 1],
                            packed_shortest_path[shortest_path_index],
-                           partially_unpacked_shortest_path);
+                           partially_unpacked_shortest_path,
+                           engine_working_data.unpacking_cache);
                 break;
             }
         }
@@ -521,7 +534,7 @@ bool viaNodeCandidatePassesTTest(SearchEngineData<Algorithm> &engine_working_dat
 
     t_test_path_weight += unpacked_until_weight;
     // Run actual T-Test query and compare if weight equal.
-    engine_working_data.InitializeOrClearThirdThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearThirdHeaps(facade.GetNumberOfNodes());
 
     QueryHeap &forward_heap3 = *engine_working_data.forward_heap_3;
     QueryHeap &reverse_heap3 = *engine_working_data.reverse_heap_3;
@@ -577,14 +590,10 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
     std::vector<SearchSpaceEdge> reverse_search_space;
 
     // Init queues, semi-expensive because access to TSS invokes a sys-call
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
-    engine_working_data.InitializeOrClearSecondThreadLocalStorage(facade.GetNumberOfNodes());
-    engine_working_data.InitializeOrClearThirdThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
 
     auto &forward_heap1 = *engine_working_data.forward_heap_1;
     auto &reverse_heap1 = *engine_working_data.reverse_heap_1;
-    auto &forward_heap2 = *engine_working_data.forward_heap_2;
-    auto &reverse_heap2 = *engine_working_data.reverse_heap_2;
 
     EdgeWeight upper_bound_to_shortest_path_weight = INVALID_EDGE_WEIGHT;
     NodeID middle_node = SPECIAL_NODEID;
@@ -601,6 +610,7 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
     // search from s and t till new_min/(1+epsilon) > weight_of_shortest_path
     while (0 < (forward_heap1.Size() + reverse_heap1.Size()))
     {
+        engine_working_data.deadline.Check();
         if (0 < forward_heap1.Size())
         {
             alternativeRoutingStep<FORWARD_DIRECTION>(facade,
@@ -745,51 +755,118 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
         packed_shortest_path.insert(
             packed_shortest_path.end(), packed_reverse_path.begin(), packed_reverse_path.end());
     }
-    std::vector<RankedCandidateNode> ranked_candidates_list;
+    // The candidates are inspected in parallel. Every task searches from the via nodes with
+    // heaps of its own, leased from the pool of the engine, the heaps of the searches from s and
+    // t are only read and shared by all tasks.
+    tbb::enumerable_thread_specific<std::unique_ptr<SearchEngineData<Algorithm>>> task_data(
+        [&engine_working_data] {
+            auto data = std::make_unique<SearchEngineData<Algorithm>>(
+                engine_working_data.GetHeapPool(), engine_working_data.deadline);
+            data->unpacking_cache = engine_working_data.unpacking_cache;
+            return data;
+        });
+    const auto trace = SearchTracing::Current();
 
     // prioritizing via nodes for deep inspection
-    for (const NodeID node : preselected_node_list)
-    {
-        EdgeWeight weight_of_via_path = 0, sharing_of_via_path = 0;
-        computeWeightAndSharingOfViaPath(engine_working_data,
-                                         facade,
-                                         node,
-                                         &weight_of_via_path,
-                                         &sharing_of_via_path,
-                                         packed_shortest_path,
-                                         min_edge_offset);
-        const EdgeWeight maximum_allowed_sharing =
-            static_cast<EdgeWeight>(upper_bound_to_shortest_path_weight * VIAPATH_GAMMA);
-        if (sharing_of_via_path <= maximum_allowed_sharing &&
-            weight_of_via_path <= upper_bound_to_shortest_path_weight * (1 + VIAPATH_EPSILON))
-        {
-            ranked_candidates_list.emplace_back(node, weight_of_via_path, sharing_of_via_path);
-        }
-    }
+    const EdgeWeight maximum_allowed_sharing =
+        static_cast<EdgeWeight>(upper_bound_to_shortest_path_weight * VIAPATH_GAMMA);
+    std::vector<RankedCandidateNode> inspected_candidates(
+        preselected_node_list.size(),
+        RankedCandidateNode(SPECIAL_NODEID, INVALID_EDGE_WEIGHT, INVALID_EDGE_WEIGHT));
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, preselected_node_list.size()),
+        [&](const tbb::blocked_range<std::size_t> &range) {
+            SearchTracing::WorkerScope trace_scope(trace);
+            auto &data = *task_data.local();
+            for (auto index = range.begin(); index != range.end(); ++index)
+            {
+                const NodeID node = preselected_node_list[index];
+                EdgeWeight weight_of_via_path = 0, sharing_of_via_path = 0;
+                computeWeightAndSharingOfViaPath(data,
+                                                 facade,
+                                                 forward_heap1,
+                                                 reverse_heap1,
+                                                 node,
+                                                 &weight_of_via_path,
+                                                 &sharing_of_via_path,
+                                                 packed_shortest_path,
+                                                 min_edge_offset);
+                if (sharing_of_via_path <= maximum_allowed_sharing &&
+                    weight_of_via_path <=
+                        upper_bound_to_shortest_path_weight * (1 + VIAPATH_EPSILON))
+                {
+                    inspected_candidates[index] =
+                        RankedCandidateNode(node, weight_of_via_path, sharing_of_via_path);
+                }
+            }
+        });
+
+    std::vector<RankedCandidateNode> ranked_candidates_list;
+    std::copy_if(inspected_candidates.begin(),
+                 inspected_candidates.end(),
+                 std::back_inserter(ranked_candidates_list),
+                 [](const RankedCandidateNode &candidate) {
+                     return candidate.node != SPECIAL_NODEID;
+                 });
     std::sort(ranked_candidates_list.begin(), ranked_candidates_list.end());
 
+    // The first admissible candidate in rank order is selected. Tasks skip the candidates
+    // ranked after the best admissible one found so far, so the search ends about as soon as
+    // for a serial scan but tests the candidates in front of it at the same time.
+    const auto number_of_ranked_candidates = ranked_candidates_list.size();
+    std::atomic<std::size_t> first_admissible{number_of_ranked_candidates};
+    std::vector<EdgeWeight> weights_of_via_paths(number_of_ranked_candidates,
+                                                 INVALID_EDGE_WEIGHT);
+    std::vector<std::vector<NodeID>> packed_alternate_paths(number_of_ranked_candidates);
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, number_of_ranked_candidates, 1),
+        [&](const tbb::blocked_range<std::size_t> &range) {
+            SearchTracing::WorkerScope trace_scope(trace);
+            auto &data = *task_data.local();
+            data.InitializeOrClearSecondHeaps(facade.GetNumberOfNodes());
+            for (auto index = range.begin();
+                 index != range.end() && index < first_admissible.load();
+                 ++index)
+            {
+                NodeID s_v_middle = SPECIAL_NODEID, v_t_middle = SPECIAL_NODEID;
+                if (viaNodeCandidatePassesTTest(data,
+                                                facade,
+                                                forward_heap1,
+                                                reverse_heap1,
+                                                *data.forward_heap_2,
+                                                *data.reverse_heap_2,
+                                                ranked_candidates_list[index],
+                                                upper_bound_to_shortest_path_weight,
+                                                &weights_of_via_paths[index],
+                                                &s_v_middle,
+                                                &v_t_middle,
+                                                min_edge_offset))
+                {
+                    // retrieve alternate path while the heaps of the task still hold it
+                    retrievePackedAlternatePath(forward_heap1,
+                                                reverse_heap1,
+                                                *data.forward_heap_2,
+                                                *data.reverse_heap_2,
+                                                s_v_middle,
+                                                v_t_middle,
+                                                packed_alternate_paths[index]);
+
+                    auto known = first_admissible.load();
+                    while (index < known &&
+                           !first_admissible.compare_exchange_weak(known, index))
+                    {
+                    }
+                    break;
+                }
+            }
+        });
+
     NodeID selected_via_node = SPECIAL_NODEID;
     EdgeWeight weight_of_via_path = INVALID_EDGE_WEIGHT;
-    NodeID s_v_middle = SPECIAL_NODEID, v_t_middle = SPECIAL_NODEID;
-    for (const RankedCandidateNode &candidate : ranked_candidates_list)
-    {
-        if (viaNodeCandidatePassesTTest(engine_working_data,
-                                        facade,
-                                        forward_heap1,
-                                        reverse_heap1,
-                                        forward_heap2,
-                                        reverse_heap2,
-                                        candidate,
-                                        upper_bound_to_shortest_path_weight,
-                                        &weight_of_via_path,
-                                        &s_v_middle,
-                                        &v_t_middle,
-                                        min_edge_offset))
-        {
-            // select first admissable
-            selected_via_node = candidate.node;
-            break;
-        }
+    if (first_admissible < number_of_ranked_candidates)
+    {
+        selected_via_node = ranked_candidates_list[first_admissible].node;
+        weight_of_via_path = weights_of_via_paths[first_admissible];
     }
 
     // Unpack shortest path and alternative, if they exist
@@ -810,21 +887,14 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
                    // -- start of route
                    phantom_node_pair,
                    // -- unpacked output
-                   primary_route.unpacked_path_segments.front());
+                   primary_route.unpacked_path_segments.front(),
+                   engine_working_data.unpacking_cache);
         primary_route.shortest_path_weight = upper_bound_to_shortest_path_weight;
     }
 
     if (SPECIAL_NODEID != selected_via_node)
     {
-        std::vector<NodeID> packed_alternate_path;
-        // retrieve alternate path
-        retrievePackedAlternatePath(forward_heap1,
-                                    reverse_heap1,
-                                    forward_heap2,
-                                    reverse_heap2,
-                                    s_v_middle,
-                                    v_t_middle,
-                                    packed_alternate_path);
+        const auto &packed_alternate_path = packed_alternate_paths[first_admissible];
 
         secondary_route.unpacked_path_segments.resize(1);
         secondary_route.source_traversed_in_reverse.push_back(
@@ -839,7 +909,8 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
                    packed_alternate_path.begin(),
                    packed_alternate_path.end(),
                    phantom_node_pair,
-                   secondary_route.unpacked_path_segments.front());
+                   secondary_route.unpacked_path_segments.front(),
+                   engine_working_data.unpacking_cache);
 
         secondary_route.shortest_path_weight = weight_of_via_path;
     }
@@ -5,6 +5,10 @@
 
 #include <boost/assert.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
 #include <algorithm>
 #include <iterator>
 #include <memory>
@@ -548,7 +552,7 @@ void unpackPackedPaths(InputIt first,
             std::move(unpacked_nodes),
             std::move(unpacked_edges)};
 
-        out = std::move(unpacked_path);
+        *out = std::move(unpacked_path);
     }
 }
 
@@ -592,6 +596,8 @@ makeCandidateVias(SearchEngineData<Algorithm> &search_engine_data,
 
     while (forward_heap.Size() + reverse_heap.Size() > 0)
     {
+        search_engine_data.deadline.Check();
+
         if (shortest_path_weight != INVALID_EDGE_WEIGHT)
             overlap_weight = shortest_path_weight * kSearchSpaceOverlapFactor;
 
@@ -776,7 +782,7 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &sear
     const Partition &partition = facade.GetMultiLevelPartition();
 
     // Prepare heaps for usage below. The searches will modify them in-place.
-    search_engine_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
+    search_engine_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
 
     Heap &forward_heap = *search_engine_data.forward_heap_1;
     Heap &reverse_heap = *search_engine_data.reverse_heap_1;
@@ -827,7 +833,7 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &sear
     const auto number_of_candidate_vias = candidate_vias_last - candidate_vias_first;
 
     // Reconstruct packed paths from the heaps.
-    // The recursive path unpacking below destructs heaps.
+    // The recursive path unpacking below runs on heaps of its own tasks.
     // We need to save all packed paths from the heaps upfront.
 
     const auto extract_packed_path_from_heaps = [&](WeightedViaNode via) {
@@ -850,9 +856,18 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &sear
     const auto last_filtered = filterViaCandidatesByViaNotOnPath(
         weighted_packed_paths[0], candidate_vias_first + 1, candidate_vias_last);
 
-    // Store all alternative packed paths (if there are any).
-    auto into = std::back_inserter(weighted_packed_paths);
-    std::transform(begin(candidate_vias) + 1, last_filtered, into, extract_packed_path_from_heaps);
+    // Store all alternative packed paths (if there are any). The heaps are only read from here,
+    // so the paths are extracted in parallel.
+    const auto number_of_alternative_vias = last_filtered - (candidate_vias_first + 1);
+    weighted_packed_paths.resize(1 + number_of_alternative_vias);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_alternative_vias),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              weighted_packed_paths[1 + index] =
+                                  extract_packed_path_from_heaps(candidate_vias_first[1 + index]);
+                          }
+                      });
 
     // Filter packed paths with heuristics
 
@@ -878,32 +893,66 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &sear
     const auto paths_last = begin(weighted_packed_paths) + 1 + number_of_filtered_alternative_paths;
     const auto number_of_packed_paths = paths_last - paths_first;
 
+    // Every task unpacks with heaps of its own, leased from the pool of the engine.
+    tbb::enumerable_thread_specific<std::unique_ptr<SearchEngineData<Algorithm>>> task_data(
+        [&search_engine_data] {
+            return std::make_unique<SearchEngineData<Algorithm>>(
+                search_engine_data.GetHeapPool(), search_engine_data.deadline);
+        });
+    const auto trace = SearchTracing::Current();
+
     std::vector<WeightedViaNodeUnpackedPath> unpacked_paths;
     unpacked_paths.reserve(number_of_packed_paths);
 
-    // Note: re-uses (read: destroys) heaps; we don't need them from here on anyway.
-    unpackPackedPaths(paths_first,
-                      paths_last,
-                      std::back_inserter(unpacked_paths),
-                      search_engine_data,
-                      facade,
-                      phantom_node_pair);
-
     //
-    // Filter and rank a second time. This time instead of being fast and doing
-    // heuristics on the packed path only we now have the detailed unpacked path.
+    // Unpack in waves of as many paths as alternatives are still missing and filter a second
+    // time after each wave. This time instead of being fast and doing heuristics on the packed
+    // path only we now have the detailed unpacked path. The sharing filter only compares a path
+    // with the paths ranked before it, so once enough paths passed the remaining ones can't
+    // change the result and are never unpacked.
     //
 
-    auto unpacked_paths_last = end(unpacked_paths);
-
-    unpacked_paths_last = filterUnpackedPathsBySharing(begin(unpacked_paths), end(unpacked_paths));
+    auto packed_paths_first = paths_first;
+    while (packed_paths_first != paths_last &&
+           unpacked_paths.size() < max_number_of_alternatives + 1)
+    {
+        const auto missing_paths = max_number_of_alternatives + 1 - unpacked_paths.size();
+        const auto wave_size = std::min(
+            missing_paths, static_cast<std::size_t>(paths_last - packed_paths_first));
+        const auto wave_offset = unpacked_paths.size();
+        unpacked_paths.resize(wave_offset + wave_size);
+
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, wave_size, 1),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                SearchTracing::WorkerScope trace_scope(trace);
+                auto &data = *task_data.local();
+                data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
+
+                auto position = wave_offset + range.begin();
+                const auto into = boost::make_function_output_iterator(
+                    [&](WeightedViaNodeUnpackedPath path) {
+                        unpacked_paths[position++] = std::move(path);
+                    });
+                unpackPackedPaths(packed_paths_first + range.begin(),
+                                  packed_paths_first + range.end(),
+                                  into,
+                                  data,
+                                  facade,
+                                  phantom_node_pair);
+            });
+        packed_paths_first += wave_size;
+
+        unpacked_paths.erase(
+            filterUnpackedPathsBySharing(begin(unpacked_paths), end(unpacked_paths)),
+            end(unpacked_paths));
+    }
 
     const auto unpacked_paths_first = begin(unpacked_paths);
-    const auto number_of_unpacked_paths =
-        std::min(static_cast<std::size_t>(max_number_of_alternatives) + 1,
-                 static_cast<std::size_t>(unpacked_paths_last - unpacked_paths_first));
+    const auto unpacked_paths_last = end(unpacked_paths);
+    const auto number_of_unpacked_paths = unpacked_paths.size();
     BOOST_ASSERT(number_of_unpacked_paths >= 1);
-    unpacked_paths_last = unpacked_paths_first + number_of_unpacked_paths;
+    BOOST_ASSERT(number_of_unpacked_paths <= max_number_of_alternatives + 1);
 
     //
     // Annotate the unpacked path and transform to proper internal route result.
@@ -4,6 +4,9 @@
 #include "engine/routing_algorithms/routing_base_ch.hpp"
 #include "engine/routing_algorithms/routing_base_mld.hpp"
 
+#include <algorithm>
+#include <functional>
+
 namespace osrm
 {
 namespace engine
@@ -11,6 +14,39 @@ namespace engine
 namespace routing_algorithms
 {
 
+namespace
+{
+template <typename Algorithm>
+InternalRouteResult unpackRoute(SearchEngineData<Algorithm> &engine_working_data,
+                                const DataFacade<Algorithm> &facade,
+                                const EdgeWeight weight,
+                                const std::vector<NodeID> &packed_leg,
+                                const PhantomNodes &phantom_nodes)
+{
+    std::vector<NodeID> unpacked_nodes;
+    std::vector<EdgeID> unpacked_edges;
+
+    if (!packed_leg.empty())
+    {
+        unpacked_nodes.reserve(packed_leg.size());
+        unpacked_edges.reserve(packed_leg.size());
+        unpacked_nodes.push_back(packed_leg.front());
+        ch::unpackPath(facade,
+                       engine_working_data.unpacking_cache,
+                       packed_leg.begin(),
+                       packed_leg.end(),
+                       [&unpacked_nodes, &unpacked_edges](std::pair<NodeID, NodeID> &edge,
+                                                          const auto &edge_id) {
+                           BOOST_ASSERT(edge.first == unpacked_nodes.back());
+                           unpacked_nodes.push_back(edge.second);
+                           unpacked_edges.push_back(edge_id);
+                       });
+    }
+
+    return extractRoute(facade, weight, phantom_nodes, unpacked_nodes, unpacked_edges);
+}
+}
+
 /// This is a striped down version of the general shortest path algorithm.
 /// The general algorithm always computes two queries for each leg. This is only
 /// necessary in case of vias, where the directions of the start node is constrainted
@@ -22,7 +58,7 @@ InternalRouteResult directShortestPathSearch(SearchEngineData<Algorithm> &engine
                                              const DataFacade<Algorithm> &facade,
                                              const PhantomNodes &phantom_nodes)
 {
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
     auto &forward_heap = *engine_working_data.forward_heap_1;
     auto &reverse_heap = *engine_working_data.reverse_heap_1;
     forward_heap.Clear();
@@ -42,26 +78,7 @@ InternalRouteResult directShortestPathSearch(SearchEngineData<Algorithm> &engine
            DO_NOT_FORCE_LOOPS,
            phantom_nodes);
 
-    std::vector<NodeID> unpacked_nodes;
-    std::vector<EdgeID> unpacked_edges;
-
-    if (!packed_leg.empty())
-    {
-        unpacked_nodes.reserve(packed_leg.size());
-        unpacked_edges.reserve(packed_leg.size());
-        unpacked_nodes.push_back(packed_leg.front());
-        ch::unpackPath(facade,
-                       packed_leg.begin(),
-                       packed_leg.end(),
-                       [&unpacked_nodes, &unpacked_edges](std::pair<NodeID, NodeID> &edge,
-                                                          const auto &edge_id) {
-                           BOOST_ASSERT(edge.first == unpacked_nodes.back());
-                           unpacked_nodes.push_back(edge.second);
-                           unpacked_edges.push_back(edge_id);
-                       });
-    }
-
-    return extractRoute(facade, weight, phantom_nodes, unpacked_nodes, unpacked_edges);
+    return unpackRoute(engine_working_data, facade, weight, packed_leg, phantom_nodes);
 }
 
 template InternalRouteResult
@@ -74,18 +91,108 @@ directShortestPathSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
                          const DataFacade<ch::Algorithm> &facade,
                          const PhantomNodes &phantom_nodes);
 
+namespace
+{
+template <typename... Args>
+mld::UnpackedPath searchMLD(SearchEngineData<mld::Algorithm> &engine_working_data,
+                            const DataFacade<mld::Algorithm> &facade,
+                            const bool parallel,
+                            const PhantomNodes &phantom_nodes,
+                            Args... args)
+{
+    auto &forward_heap = *engine_working_data.forward_heap_1;
+    auto &reverse_heap = *engine_working_data.reverse_heap_1;
+    if (parallel)
+    {
+        return mld::parallelSearch(engine_working_data,
+                                   facade,
+                                   forward_heap,
+                                   reverse_heap,
+                                   INVALID_EDGE_WEIGHT,
+                                   phantom_nodes,
+                                   args...);
+    }
+    return mld::search(engine_working_data,
+                       facade,
+                       forward_heap,
+                       reverse_heap,
+                       DO_NOT_FORCE_LOOPS,
+                       DO_NOT_FORCE_LOOPS,
+                       INVALID_EDGE_WEIGHT,
+                       phantom_nodes,
+                       args...);
+}
+
+InternalRouteResult directMLDSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                    const DataFacade<mld::Algorithm> &facade,
+                                    const PhantomNodes &phantom_nodes,
+                                    const bool parallel)
+{
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
+    auto &forward_heap = *engine_working_data.forward_heap_1;
+    auto &reverse_heap = *engine_working_data.reverse_heap_1;
+
+    // TODO: when structured bindings will be allowed change to
+    // auto [weight, source_node, target_node, unpacked_edges] = ...
+    EdgeWeight weight = INVALID_EDGE_WEIGHT;
+    std::vector<NodeID> unpacked_nodes;
+    std::vector<EdgeID> unpacked_edges;
+    if (facade.GetLandmarks().Empty())
+    {
+        insertNodesInHeaps(forward_heap, reverse_heap, phantom_nodes);
+        std::tie(weight, unpacked_nodes, unpacked_edges) =
+            searchMLD(engine_working_data, facade, parallel, phantom_nodes);
+    }
+    else
+    {
+        // the landmarks direct the search towards the target
+        const mld::LandmarkPotentials potentials(facade.GetLandmarks(), phantom_nodes);
+        mld::insertNodesInHeaps(forward_heap, reverse_heap, potentials);
+        std::tie(weight, unpacked_nodes, unpacked_edges) =
+            searchMLD(engine_working_data, facade, parallel, phantom_nodes, std::cref(potentials));
+    }
+
+    return extractRoute(facade, weight, phantom_nodes, unpacked_nodes, unpacked_edges);
+}
+}
+
 template <>
 InternalRouteResult directShortestPathSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
                                              const DataFacade<mld::Algorithm> &facade,
                                              const PhantomNodes &phantom_nodes)
 {
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
+    return directMLDSearch(engine_working_data, facade, phantom_nodes, false);
+}
+
+InternalRouteResult
+parallelDirectShortestPathSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                 const DataFacade<mld::Algorithm> &facade,
+                                 const PhantomNodes &phantom_nodes)
+{
+    return directMLDSearch(engine_working_data, facade, phantom_nodes, true);
+}
+
+InternalRouteResult directShortestPathSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                             const DataFacade<mld::Algorithm> &facade,
+                                             const PhantomNodes &phantom_nodes,
+                                             const std::uint64_t departure_time)
+{
+    const mld::RestrictedTurns restricted_turns(
+        facade.GetMultiLevelPartition(),
+        facade.GetConditionalTurnMasks(),
+        extractor::ConditionalTurnMask::MinuteOfWeek(departure_time));
+
+    // the search that skips restricted turns is only instantiated for queries that need it
+    if (restricted_turns.Empty())
+    {
+        return directMLDSearch(engine_working_data, facade, phantom_nodes, false);
+    }
+
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
     auto &forward_heap = *engine_working_data.forward_heap_1;
     auto &reverse_heap = *engine_working_data.reverse_heap_1;
     insertNodesInHeaps(forward_heap, reverse_heap, phantom_nodes);
 
-    // TODO: when structured bindings will be allowed change to
-    // auto [weight, source_node, target_node, unpacked_edges] = ...
     EdgeWeight weight = INVALID_EDGE_WEIGHT;
     std::vector<NodeID> unpacked_nodes;
     std::vector<EdgeID> unpacked_edges;
@@ -96,11 +203,162 @@ InternalRouteResult directShortestPathSearch(SearchEngineData<mld::Algorithm> &e
                                                                    DO_NOT_FORCE_LOOPS,
                                                                    DO_NOT_FORCE_LOOPS,
                                                                    INVALID_EDGE_WEIGHT,
-                                                                   phantom_nodes);
+                                                                   phantom_nodes,
+                                                                   std::cref(restricted_turns));
 
     return extractRoute(facade, weight, phantom_nodes, unpacked_nodes, unpacked_edges);
 }
 
+const DestinationSearchSpace::Label *DestinationSearchSpace::Find(const NodeID node) const
+{
+    const auto label = std::lower_bound(
+        labels.begin(), labels.end(), node, [](const Label &label, const NodeID node) {
+            return label.node < node;
+        });
+    return label != labels.end() && label->node == node ? &*label : nullptr;
+}
+
+DestinationSearchSpace destinationSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                         const DataFacade<ch::Algorithm> &facade,
+                                         const PhantomNode &target_phantom)
+{
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
+    auto &reverse_heap = *engine_working_data.reverse_heap_1;
+    reverse_heap.Clear();
+
+    if (target_phantom.IsValidForwardTarget())
+    {
+        reverse_heap.Insert(target_phantom.forward_segment_id.id,
+                            target_phantom.GetForwardWeightPlusOffset(),
+                            target_phantom.forward_segment_id.id);
+    }
+    if (target_phantom.IsValidReverseTarget())
+    {
+        reverse_heap.Insert(target_phantom.reverse_segment_id.id,
+                            target_phantom.GetReverseWeightPlusOffset(),
+                            target_phantom.reverse_segment_id.id);
+    }
+
+    // without a forward search to meet there is no bound, the search settles the whole upward
+    // search space of the target
+    DestinationSearchSpace destination;
+    while (!reverse_heap.Empty())
+    {
+        engine_working_data.deadline.Check();
+        SearchTracing::Settled(reverse_heap.Size());
+        const NodeID node = reverse_heap.DeleteMin();
+        const EdgeWeight weight = reverse_heap.GetKey(node);
+        destination.labels.push_back({node, weight, reverse_heap.GetData(node).parent});
+
+        if (ch::stallAtNode<REVERSE_DIRECTION>(facade, node, weight, reverse_heap))
+        {
+            continue;
+        }
+        ch::relaxOutgoingEdges<REVERSE_DIRECTION>(facade, node, weight, reverse_heap);
+    }
+
+    using Label = DestinationSearchSpace::Label;
+    std::sort(destination.labels.begin(),
+              destination.labels.end(),
+              [](const Label &lhs, const Label &rhs) { return lhs.node < rhs.node; });
+    return destination;
+}
+
+InternalRouteResult rerouteSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                  const DataFacade<ch::Algorithm> &facade,
+                                  const PhantomNodes &phantom_nodes,
+                                  const DestinationSearchSpace &destination)
+{
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
+    auto &forward_heap = *engine_working_data.forward_heap_1;
+    forward_heap.Clear();
+
+    const auto &source = phantom_nodes.source_phantom;
+    if (source.IsValidForwardSource())
+    {
+        forward_heap.Insert(source.forward_segment_id.id,
+                            -source.GetForwardWeightPlusOffset(),
+                            source.forward_segment_id.id);
+    }
+    if (source.IsValidReverseSource())
+    {
+        forward_heap.Insert(source.reverse_segment_id.id,
+                            -source.GetReverseWeightPlusOffset(),
+                            source.reverse_segment_id.id);
+    }
+
+    EdgeWeight weight = INVALID_EDGE_WEIGHT;
+    NodeID middle = SPECIAL_NODEID;
+    const auto min_edge_offset = forward_heap.Empty() ? 0 : std::min(0, forward_heap.MinKey());
+
+    // the forward steps of ch::search, the labels of the destination take the place of the
+    // reverse heap
+    while (!forward_heap.Empty())
+    {
+        engine_working_data.deadline.Check();
+        SearchTracing::Settled(forward_heap.Size());
+        const NodeID node = forward_heap.DeleteMin();
+        const EdgeWeight node_weight = forward_heap.GetKey(node);
+
+        if (const auto label = destination.Find(node))
+        {
+            const EdgeWeight path_weight = node_weight + label->weight;
+            if (path_weight >= 0 && path_weight < weight)
+            {
+                middle = node;
+                weight = path_weight;
+            }
+            // source and target on the same segment, the target lies behind the source
+            else if (path_weight < 0)
+            {
+                const auto loop_weight = ch::getLoopWeight<false>(facade, node);
+                if (loop_weight != INVALID_EDGE_WEIGHT && path_weight + loop_weight >= 0 &&
+                    path_weight + loop_weight < weight)
+                {
+                    middle = node;
+                    weight = path_weight + loop_weight;
+                }
+            }
+        }
+
+        if (node_weight + min_edge_offset > weight)
+        {
+            break;
+        }
+
+        if (ch::stallAtNode<FORWARD_DIRECTION>(facade, node, node_weight, forward_heap))
+        {
+            continue;
+        }
+        ch::relaxOutgoingEdges<FORWARD_DIRECTION>(facade, node, node_weight, forward_heap);
+    }
+
+    std::vector<NodeID> packed_leg;
+    if (middle == SPECIAL_NODEID)
+    {
+        weight = INVALID_EDGE_WEIGHT;
+    }
+    else if (weight != forward_heap.GetKey(middle) + destination.Find(middle)->weight)
+    {
+        // self loop makes up the full path
+        packed_leg = {middle, middle};
+    }
+    else
+    {
+        ch::retrievePackedPathFromSingleHeap(forward_heap, middle, packed_leg);
+        std::reverse(packed_leg.begin(), packed_leg.end());
+        packed_leg.push_back(middle);
+        for (auto label = destination.Find(middle); label->parent != label->node;)
+        {
+            label = destination.Find(label->parent);
+            BOOST_ASSERT(label);
+            packed_leg.push_back(label->node);
+        }
+    }
+
+    return unpackRoute(engine_working_data, facade, weight, packed_leg, phantom_nodes);
+}
+
 } // namespace routing_algorithms
 } // namespace engine
 } // namespace osrm
@@ -1,11 +1,26 @@
 #include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/routing_base_ch.hpp"
+#include "engine/routing_algorithms/routing_base_mld.hpp"
+#include "engine/search_trace.hpp"
+#include "util/for_each_valid_weight.hpp"
+#include "util/integer_range.hpp"
 
 #include <boost/assert.hpp>
+#include <boost/optional.hpp>
+#include <boost/range/iterator_range_core.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <memory>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -19,22 +34,50 @@ namespace
 {
 struct NodeBucket
 {
+    NodeID middle_node;
     unsigned target_id; // essentially a row in the weight matrix
     EdgeWeight weight;
     EdgeWeight duration;
-    NodeBucket(const unsigned target_id, const EdgeWeight weight, const EdgeWeight duration)
-        : target_id(target_id), weight(weight), duration(duration)
+    EdgeDistance distance;
+    NodeBucket(const NodeID middle_node,
+               const unsigned target_id,
+               const EdgeWeight weight,
+               const EdgeWeight duration,
+               const EdgeDistance distance)
+        : middle_node(middle_node), target_id(target_id), weight(weight), duration(duration),
+          distance(distance)
+    {
+    }
+
+    // sorts the buckets of a node next to each other, in column order
+    bool operator<(const NodeBucket &rhs) const
     {
+        return std::tie(middle_node, target_id) < std::tie(rhs.middle_node, rhs.target_id);
     }
+
+    struct ByMiddleNode
+    {
+        bool operator()(const NodeBucket &bucket, const NodeID node) const
+        {
+            return bucket.middle_node < node;
+        }
+        bool operator()(const NodeID node, const NodeBucket &bucket) const
+        {
+            return node < bucket.middle_node;
+        }
+    };
 };
 
-// FIXME This should be replaced by an std::unordered_multimap, though this needs benchmarking
-using SearchSpaceWithBuckets = std::unordered_map<NodeID, std::vector<NodeBucket>>;
+// The backward searches append to one flat vector that is sorted by node before the forward
+// searches look up their buckets by binary search: no allocation per settled node and the
+// buckets of a node share a cache line.
+using SearchSpaceWithBuckets = std::vector<NodeBucket>;
 
 inline bool addLoopWeight(const DataFacade<ch::Algorithm> &facade,
                           const NodeID node,
                           EdgeWeight &weight,
-                          EdgeDuration &duration)
+                          EdgeDuration &duration,
+                          EdgeDistance &distance)
 { // Special case for CH when contractor creates a loop edge node->node
     BOOST_ASSERT(weight < 0);
 
@@ -46,6 +89,7 @@ inline bool addLoopWeight(const DataFacade<ch::Algorithm> &facade,
         {
             weight = new_weight_with_loop;
             duration += ch::getLoopWeight<true>(facade, node);
+            distance += ch::getLoopDistance(facade, node);
             return true;
         }
     }
@@ -54,24 +98,34 @@ inline bool addLoopWeight(const DataFacade<ch::Algorithm> &facade,
     return false;
 }
 
+// CH stall-on-demand: a node is stalled if a node above it that the search already reached
+// reaches it lighter. Its weight is not the one of a shortest path, so the steps neither leave or
+// scan buckets at it nor relax its edges.
+template <bool DIRECTION>
+bool stallAtNode(const DataFacade<ch::Algorithm> &facade,
+                 const NodeID node,
+                 const EdgeWeight weight,
+                 const typename SearchEngineData<ch::Algorithm>::ManyToManyQueryHeap &query_heap,
+                 const PhantomNode &)
+{
+    return ch::stallAtNode<DIRECTION>(facade, node, weight, query_heap);
+}
+
 template <bool DIRECTION>
 void relaxOutgoingEdges(const DataFacade<ch::Algorithm> &facade,
                         const NodeID node,
                         const EdgeWeight weight,
                         const EdgeDuration duration,
+                        const EdgeDistance distance,
                         typename SearchEngineData<ch::Algorithm>::ManyToManyQueryHeap &query_heap,
                         const PhantomNode &)
 {
-    if (ch::stallAtNode<DIRECTION>(facade, node, weight, query_heap))
-    {
-        return;
-    }
-
     for (auto edge : facade.GetAdjacentEdgeRange(node))
     {
         const auto &data = facade.GetEdgeData(edge);
         if (DIRECTION == FORWARD_DIRECTION ? data.forward : data.backward)
         {
+            SearchTracing::Relaxed();
             const NodeID to = facade.GetTarget(edge);
             const EdgeWeight edge_weight = data.weight;
             const EdgeWeight edge_duration = data.duration;
@@ -79,108 +133,254 @@ void relaxOutgoingEdges(const DataFacade<ch::Algorithm> &facade,
             BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
             const EdgeWeight to_weight = weight + edge_weight;
             const EdgeWeight to_duration = duration + edge_duration;
+            const EdgeDistance to_distance = distance + data.distance;
 
             // New Node discovered -> Add to Heap + Node Info Storage
             if (!query_heap.WasInserted(to))
             {
-                query_heap.Insert(to, to_weight, {node, to_duration});
+                query_heap.Insert(to, to_weight, {node, to_duration, to_distance});
             }
             // Found a shorter Path -> Update weight
             else if (to_weight < query_heap.GetKey(to))
             {
                 // new parent
-                query_heap.GetData(to) = {node, to_duration};
+                query_heap.GetData(to) = {node, to_duration, to_distance};
                 query_heap.DecreaseKey(to, to_weight);
             }
         }
     }
 }
 
-inline bool
-addLoopWeight(const DataFacade<mld::Algorithm> &, const NodeID, EdgeWeight &, EdgeDuration &)
-{ // MLD overlay does not introduce loop edges
+// Tags the steps of a Core-CH search through the core, which is not contracted
+struct CoreSearch
+{
+};
+
+// A Dijkstra search never reaches a node it settles lighter through another one, stall checks
+// in the core would only scan the incoming edges of every node for nothing
+template <bool DIRECTION>
+bool stallAtNode(const DataFacade<ch::Algorithm> &,
+                 const NodeID,
+                 const EdgeWeight,
+                 const typename SearchEngineData<ch::Algorithm>::ManyToManyQueryHeap &,
+                 const PhantomNode &,
+                 const CoreSearch &)
+{
     return false;
 }
 
 template <bool DIRECTION>
-void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
+void relaxOutgoingEdges(const DataFacade<ch::Algorithm> &facade,
                         const NodeID node,
                         const EdgeWeight weight,
                         const EdgeDuration duration,
-                        typename SearchEngineData<mld::Algorithm>::ManyToManyQueryHeap &query_heap,
-                        const PhantomNode &phantom_node)
+                        const EdgeDistance distance,
+                        typename SearchEngineData<ch::Algorithm>::ManyToManyQueryHeap &query_heap,
+                        const PhantomNode &phantom_node,
+                        const CoreSearch &)
 {
-    const auto &partition = facade.GetMultiLevelPartition();
-    const auto &cells = facade.GetCellStorage();
+    relaxOutgoingEdges<DIRECTION>(
+        facade, node, weight, duration, distance, query_heap, phantom_node);
+}
+
+inline bool addLoopWeight(const DataFacade<mld::Algorithm> &,
+                          const NodeID,
+                          EdgeWeight &,
+                          EdgeDuration &,
+                          EdgeDistance &)
+{ // MLD overlay does not introduce loop edges
+    return false;
+}
+
+// MLD searches have no hierarchy to stall in
+template <bool DIRECTION, typename... Args>
+bool stallAtNode(const DataFacade<mld::Algorithm> &,
+                 const NodeID,
+                 const EdgeWeight,
+                 const typename SearchEngineData<mld::Algorithm>::ManyToManyQueryHeap &,
+                 const Args &...)
+{
+    return false;
+}
+
+// The cells of all targets of a table on every level of the partition, collected once per
+// request. A node that shares no cell of a level with any target is at least that level away from
+// all of them.
+class TargetCells
+{
+  public:
+    TargetCells(const partition::MultiLevelPartitionView &partition,
+                const std::vector<PhantomNode> &phantom_nodes,
+                const std::vector<std::size_t> &target_indices)
+        : partition(partition), cells(partition.GetNumberOfLevels()), separating_level(0)
+    {
+        for (LevelID level = 1; level < partition.GetNumberOfLevels(); ++level)
+        {
+            cells[level].resize(partition.GetNumberOfCells(level), false);
+        }
+
+        const auto add_segment = [this, &partition](const SegmentID &segment) {
+            if (!segment.enabled)
+                return;
+            for (LevelID level = 1; level < partition.GetNumberOfLevels(); ++level)
+            {
+                cells[level][partition.GetCell(level, segment.id)] = true;
+            }
+        };
+        const auto add_target = [&](const PhantomNode &phantom_node) {
+            add_segment(phantom_node.forward_segment_id);
+            add_segment(phantom_node.reverse_segment_id);
+        };
+        if (target_indices.empty())
+        {
+            std::for_each(phantom_nodes.begin(), phantom_nodes.end(), add_target);
+        }
+        for (const auto index : target_indices)
+        {
+            add_target(phantom_nodes[index]);
+        }
+
+        for (LevelID level = 1; level < partition.GetNumberOfLevels(); ++level)
+        {
+            if (std::count(cells[level].begin(), cells[level].end(), true) > 1)
+            {
+                separating_level = level;
+            }
+        }
+    }
+
+    // The same as the minimum of GetHighestDifferentLevel(target, node) over all targets: the
+    // level below the highest one on which the node shares a cell with a target
+    LevelID GetQueryLevel(const NodeID node) const
+    {
+        auto level = static_cast<LevelID>(cells.size() - 1);
+        while (level > 0 && cells[level][partition.GetCell(level, node)])
+        {
+            --level;
+        }
+        return level;
+    }
 
+    // The highest level on which the targets lie in different cells, 0 if they all share a cell
+    // of the lowest level
+    LevelID GetSeparatingLevel() const { return separating_level; }
+
+  private:
+    const partition::MultiLevelPartitionView &partition;
+    std::vector<std::vector<bool>> cells;
+    LevelID separating_level;
+};
+
+// Searches from or to a single phantom node never leave it on a lower level than the highest one
+// that separates it from the node
+inline LevelID getNodeQueryLevel(const partition::MultiLevelPartitionView &partition,
+                                 const NodeID node,
+                                 const PhantomNode &phantom_node)
+{
     auto highest_diffrent_level = [&partition, node](const SegmentID &phantom_node) {
         if (phantom_node.enabled)
             return partition.GetHighestDifferentLevel(phantom_node.id, node);
         return INVALID_LEVEL_ID;
     };
-    const auto level = std::min(highest_diffrent_level(phantom_node.forward_segment_id),
-                                highest_diffrent_level(phantom_node.reverse_segment_id));
+    return std::min(highest_diffrent_level(phantom_node.forward_segment_id),
+                    highest_diffrent_level(phantom_node.reverse_segment_id));
+}
+
+// A search from a source that settles the targets itself has to descend into their cells as well
+inline LevelID getNodeQueryLevel(const partition::MultiLevelPartitionView &partition,
+                                 const NodeID node,
+                                 const PhantomNode &phantom_node,
+                                 const TargetCells &target_cells)
+{
+    return std::min(getNodeQueryLevel(partition, node, phantom_node),
+                    target_cells.GetQueryLevel(node));
+}
+
+template <bool DIRECTION, typename... Args>
+void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
+                        const NodeID node,
+                        const EdgeWeight weight,
+                        const EdgeDuration duration,
+                        const EdgeDistance distance,
+                        typename SearchEngineData<mld::Algorithm>::ManyToManyQueryHeap &query_heap,
+                        const Args &... args)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    const auto &cells = facade.GetCellStorage();
+
+    const auto level = getNodeQueryLevel(partition, node, args...);
 
     const auto &node_data = query_heap.GetData(node);
 
     if (level >= 1 && !node_data.from_clique_arc)
     {
+        SearchTracing::CellCrossed(level);
         const auto &cell = cells.GetCell(level, partition.GetCell(level, node));
         if (DIRECTION == FORWARD_DIRECTION)
-        { // Shortcuts in forward direction
-            auto destination = cell.GetDestinationNodes().begin();
-            auto shortcut_durations = cell.GetOutDuration(node);
-            for (auto shortcut_weight : cell.GetOutWeight(node))
-            {
-                BOOST_ASSERT(destination != cell.GetDestinationNodes().end());
-                BOOST_ASSERT(!shortcut_durations.empty());
-                const NodeID to = *destination;
-                if (shortcut_weight != INVALID_EDGE_WEIGHT && node != to)
-                {
-                    const auto to_weight = weight + shortcut_weight;
-                    const auto to_duration = duration + shortcut_durations.front();
+        { // Shortcuts in forward direction, a row of the cell is contiguous
+            const auto destinations = cell.GetDestinationNodes();
+            const auto shortcut_weights = cell.GetOutWeight(node);
+            const auto shortcut_durations = cell.GetOutDuration(node);
+            const auto shortcut_distances = cell.GetOutDistance(node);
+            BOOST_ASSERT(shortcut_weights.size() == shortcut_durations.size());
+            BOOST_ASSERT(shortcut_weights.size() == shortcut_distances.size());
+            util::for_each_valid_weight(
+                shortcut_weights.begin(),
+                shortcut_weights.size(),
+                weight,
+                [&](const std::size_t index, const EdgeWeight to_weight) {
+                    const NodeID to = destinations[index];
+                    if (node == to)
+                    {
+                        return;
+                    }
+                    SearchTracing::Relaxed();
+                    const auto to_duration = duration + shortcut_durations[index];
+                    const auto to_distance = distance + shortcut_distances[index];
                     if (!query_heap.WasInserted(to))
                     {
-                        query_heap.Insert(to, to_weight, {node, true, to_duration});
+                        query_heap.Insert(to, to_weight, {node, true, to_duration, to_distance});
                     }
                     else if (to_weight < query_heap.GetKey(to))
                     {
-                        query_heap.GetData(to) = {node, true, to_duration};
+                        query_heap.GetData(to) = {node, true, to_duration, to_distance};
                         query_heap.DecreaseKey(to, to_weight);
                     }
-                }
-                ++destination;
-                shortcut_durations.advance_begin(1);
-            }
-            BOOST_ASSERT(shortcut_durations.empty());
+                });
         }
         else
         { // Shortcuts in backward direction
             auto source = cell.GetSourceNodes().begin();
             auto shortcut_durations = cell.GetInDuration(node);
+            auto shortcut_distances = cell.GetInDistance(node);
             for (auto shortcut_weight : cell.GetInWeight(node))
             {
                 BOOST_ASSERT(source != cell.GetSourceNodes().end());
                 BOOST_ASSERT(!shortcut_durations.empty());
+                BOOST_ASSERT(!shortcut_distances.empty());
                 const NodeID to = *source;
                 if (shortcut_weight != INVALID_EDGE_WEIGHT && node != to)
                 {
+                    SearchTracing::Relaxed();
                     const auto to_weight = weight + shortcut_weight;
                     const auto to_duration = duration + shortcut_durations.front();
+                    const auto to_distance = distance + shortcut_distances.front();
                     if (!query_heap.WasInserted(to))
                     {
-                        query_heap.Insert(to, to_weight, {node, true, to_duration});
+                        query_heap.Insert(to, to_weight, {node, true, to_duration, to_distance});
                     }
                     else if (to_weight < query_heap.GetKey(to))
                     {
-                        query_heap.GetData(to) = {node, true, to_duration};
+                        query_heap.GetData(to) = {node, true, to_duration, to_distance};
                         query_heap.DecreaseKey(to, to_weight);
                     }
                 }
                 ++source;
                 shortcut_durations.advance_begin(1);
+                shortcut_distances.advance_begin(1);
             }
             BOOST_ASSERT(shortcut_durations.empty());
+            BOOST_ASSERT(shortcut_distances.empty());
         }
     }
 
@@ -189,6 +389,7 @@ void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
         const auto &data = facade.GetEdgeData(edge);
         if (DIRECTION == FORWARD_DIRECTION ? data.forward : data.backward)
         {
+            SearchTracing::Relaxed();
             const NodeID to = facade.GetTarget(edge);
             const EdgeWeight edge_weight = data.weight;
             const EdgeWeight edge_duration = data.duration;
@@ -196,75 +397,162 @@ void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
             BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
             const EdgeWeight to_weight = weight + edge_weight;
             const EdgeWeight to_duration = duration + edge_duration;
+            const EdgeDistance to_distance = distance + data.distance;
 
             // New Node discovered -> Add to Heap + Node Info Storage
             if (!query_heap.WasInserted(to))
             {
-                query_heap.Insert(to, to_weight, {node, false, to_duration});
+                query_heap.Insert(to, to_weight, {node, false, to_duration, to_distance});
             }
             // Found a shorter Path -> Update weight
             else if (to_weight < query_heap.GetKey(to))
             {
                 // new parent
-                query_heap.GetData(to) = {node, false, to_duration};
+                query_heap.GetData(to) = {node, false, to_duration, to_distance};
                 query_heap.DecreaseKey(to, to_weight);
             }
         }
     }
 }
 
+// Joins the path of a source to a node with the buckets of the node, entries that get lighter
+// through the node note it as their middle node. Returns whether the node had buckets.
 template <typename Algorithm>
-void forwardRoutingStep(const DataFacade<Algorithm> &facade,
+bool scanBuckets(const DataFacade<Algorithm> &facade,
+                 const unsigned row_idx,
+                 const unsigned number_of_targets,
+                 const NodeID node,
+                 const EdgeWeight source_weight,
+                 const EdgeWeight source_duration,
+                 const EdgeDistance source_distance,
+                 const SearchSpaceWithBuckets &search_space_with_buckets,
+                 std::vector<EdgeWeight> &weights_table,
+                 std::vector<EdgeWeight> &durations_table,
+                 std::vector<EdgeDistance> &distances_table,
+                 std::vector<NodeID> &middles_table)
+{
+    // iterate the buckets of the node, they are sorted next to each other
+    const auto bucket_list = std::equal_range(search_space_with_buckets.begin(),
+                                              search_space_with_buckets.end(),
+                                              node,
+                                              NodeBucket::ByMiddleNode());
+    for (const NodeBucket &current_bucket : boost::make_iterator_range(bucket_list))
+    {
+        // get target id from bucket entry
+        const unsigned column_idx = current_bucket.target_id;
+        const EdgeWeight target_weight = current_bucket.weight;
+        const EdgeWeight target_duration = current_bucket.duration;
+        const EdgeDistance target_distance = current_bucket.distance;
+
+        const auto entry = row_idx * number_of_targets + column_idx;
+        auto &current_weight = weights_table[entry];
+        auto &current_duration = durations_table[entry];
+
+        // check if new weight is better
+        auto new_weight = source_weight + target_weight;
+        auto new_duration = source_duration + target_duration;
+        auto new_distance = source_distance + target_distance;
+
+        // the distances and middles tables are empty unless distances or paths were asked for
+        if (new_weight < 0)
+        {
+            if (addLoopWeight(facade, node, new_weight, new_duration, new_distance))
+            {
+                if (!middles_table.empty() && new_weight < current_weight)
+                    middles_table[entry] = node;
+                current_weight = std::min(current_weight, new_weight);
+                current_duration = std::min(current_duration, new_duration);
+                if (!distances_table.empty())
+                    distances_table[entry] = std::min(distances_table[entry], new_distance);
+            }
+        }
+        else if (new_weight < current_weight)
+        {
+            current_weight = new_weight;
+            current_duration = new_duration;
+            if (!distances_table.empty())
+                distances_table[entry] = new_distance;
+            if (!middles_table.empty())
+                middles_table[entry] = node;
+        }
+    }
+
+    return bucket_list.first != bucket_list.second;
+}
+
+// Returns whether the settled node had buckets, stalled nodes have none
+template <typename Algorithm, typename... Args>
+bool forwardRoutingStep(const DataFacade<Algorithm> &facade,
                         const unsigned row_idx,
                         const unsigned number_of_targets,
                         typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
                         const SearchSpaceWithBuckets &search_space_with_buckets,
                         std::vector<EdgeWeight> &weights_table,
                         std::vector<EdgeWeight> &durations_table,
-                        const PhantomNode &phantom_node)
+                        std::vector<EdgeDistance> &distances_table,
+                        std::vector<NodeID> &middles_table,
+                        const Args &... args)
 {
+    SearchTracing::Settled(query_heap.Size());
     const NodeID node = query_heap.DeleteMin();
     const EdgeWeight source_weight = query_heap.GetKey(node);
+    if (stallAtNode<FORWARD_DIRECTION>(facade, node, source_weight, query_heap, args...))
+    {
+        return false;
+    }
+
     const EdgeWeight source_duration = query_heap.GetData(node).duration;
+    const EdgeDistance source_distance = query_heap.GetData(node).distance;
+    const bool has_buckets = scanBuckets(facade,
+                                         row_idx,
+                                         number_of_targets,
+                                         node,
+                                         source_weight,
+                                         source_duration,
+                                         source_distance,
+                                         search_space_with_buckets,
+                                         weights_table,
+                                         durations_table,
+                                         distances_table,
+                                         middles_table);
 
-    // check if each encountered node has an entry
-    const auto bucket_iterator = search_space_with_buckets.find(node);
-    // iterate bucket if there exists one
-    if (bucket_iterator != search_space_with_buckets.end())
-    {
-        const std::vector<NodeBucket> &bucket_list = bucket_iterator->second;
-        for (const NodeBucket &current_bucket : bucket_list)
-        {
-            // get target id from bucket entry
-            const unsigned column_idx = current_bucket.target_id;
-            const EdgeWeight target_weight = current_bucket.weight;
-            const EdgeWeight target_duration = current_bucket.duration;
+    relaxOutgoingEdges<FORWARD_DIRECTION>(
+        facade, node, source_weight, source_duration, source_distance, query_heap, args...);
 
-            auto &current_weight = weights_table[row_idx * number_of_targets + column_idx];
-            auto &current_duration = durations_table[row_idx * number_of_targets + column_idx];
+    return has_buckets;
+}
 
-            // check if new weight is better
-            auto new_weight = source_weight + target_weight;
-            auto new_duration = source_duration + target_duration;
+// A node the forward search of a square table settled, its buckets are scanned once all backward
+// searches are done
+struct SettledNode
+{
+    NodeID node;
+    EdgeWeight weight;
+    EdgeWeight duration;
+    EdgeDistance distance;
+};
 
-            if (new_weight < 0)
-            {
-                if (addLoopWeight(facade, node, new_weight, new_duration))
-                {
-                    current_weight = std::min(current_weight, new_weight);
-                    current_duration = std::min(current_duration, new_duration);
-                }
-            }
-            else if (new_weight < current_weight)
-            {
-                current_weight = new_weight;
-                current_duration = new_duration;
-            }
-        }
+// Settles the next node of a forward search like forwardRoutingStep, but only notes the node
+template <typename Algorithm, typename... Args>
+void forwardRecordingStep(const DataFacade<Algorithm> &facade,
+                          typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
+                          std::vector<SettledNode> &settled_nodes,
+                          const Args &... args)
+{
+    SearchTracing::Settled(query_heap.Size());
+    const NodeID node = query_heap.DeleteMin();
+    const EdgeWeight source_weight = query_heap.GetKey(node);
+    if (stallAtNode<FORWARD_DIRECTION>(facade, node, source_weight, query_heap, args...))
+    {
+        return;
     }
 
+    const EdgeWeight source_duration = query_heap.GetData(node).duration;
+    const EdgeDistance source_distance = query_heap.GetData(node).distance;
+    settled_nodes.push_back({node, source_weight, source_duration, source_distance});
+
     relaxOutgoingEdges<FORWARD_DIRECTION>(
-        facade, node, source_weight, source_duration, query_heap, phantom_node);
+        facade, node, source_weight, source_duration, source_distance, query_heap, args...);
 }
 
 template <typename Algorithm>
@@ -274,124 +562,1475 @@ void backwardRoutingStep(const DataFacade<Algorithm> &facade,
                          SearchSpaceWithBuckets &search_space_with_buckets,
                          const PhantomNode &phantom_node)
 {
+    SearchTracing::Settled(query_heap.Size());
     const NodeID node = query_heap.DeleteMin();
     const EdgeWeight target_weight = query_heap.GetKey(node);
+    if (stallAtNode<REVERSE_DIRECTION>(facade, node, target_weight, query_heap, phantom_node))
+    {
+        return;
+    }
+
     const EdgeWeight target_duration = query_heap.GetData(node).duration;
+    const EdgeDistance target_distance = query_heap.GetData(node).distance;
 
     // store settled nodes in search space bucket
-    search_space_with_buckets[node].emplace_back(column_idx, target_weight, target_duration);
+    search_space_with_buckets.emplace_back(
+        node, column_idx, target_weight, target_duration, target_distance);
 
     relaxOutgoingEdges<REVERSE_DIRECTION>(
-        facade, node, target_weight, target_duration, query_heap, phantom_node);
-}
+        facade, node, target_weight, target_duration, target_distance, query_heap, phantom_node);
 }
 
-template <typename Algorithm>
-std::vector<EdgeWeight> manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
-                                         const DataFacade<Algorithm> &facade,
-                                         const std::vector<PhantomNode> &phantom_nodes,
-                                         const std::vector<std::size_t> &source_indices,
-                                         const std::vector<std::size_t> &target_indices)
+// Every task leases its own heaps from the pool of the engine, they are shared by all tasks a
+// thread runs and handed back when the search is done. Tasks trace into the trace of the request.
+template <typename Algorithm> class TaskHeaps
 {
-    const auto number_of_sources =
-        source_indices.empty() ? phantom_nodes.size() : source_indices.size();
-    const auto number_of_targets =
-        target_indices.empty() ? phantom_nodes.size() : target_indices.size();
-    const auto number_of_entries = number_of_sources * number_of_targets;
+  public:
+    TaskHeaps(SearchEngineData<Algorithm> &engine_working_data, const std::size_t number_of_nodes)
+        : task_data([&engine_working_data] {
+              return std::make_unique<SearchEngineData<Algorithm>>(
+                  engine_working_data.GetHeapPool(), engine_working_data.deadline);
+          }),
+          number_of_nodes(number_of_nodes), trace(SearchTracing::Current())
+    {
+    }
 
-    std::vector<EdgeWeight> weights_table(number_of_entries, INVALID_EDGE_WEIGHT);
-    std::vector<EdgeWeight> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
+    SearchTrace *Trace() const { return trace; }
 
-    engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(facade.GetNumberOfNodes());
+    SearchEngineData<Algorithm> &Local()
+    {
+        auto &data = *task_data.local();
+        if (!data.many_to_many_heap)
+        {
+            data.InitializeOrClearManyToManyHeaps(number_of_nodes);
+        }
+        return data;
+    }
 
-    auto &query_heap = *(engine_working_data.many_to_many_heap);
+  private:
+    tbb::enumerable_thread_specific<std::unique_ptr<SearchEngineData<Algorithm>>> task_data;
+    const std::size_t number_of_nodes;
+    SearchTrace *const trace;
+};
 
-    SearchSpaceWithBuckets search_space_with_buckets;
+// The packed path of a table entry runs from the source to the middle node through the search
+// tree of its row, which the heap still holds after the forward search, and on to the target
+// through the search tree of its column, kept from the backward search. CH adds the loop edge
+// at the middle node for a target before the source on its segment.
+InternalRouteResult
+unpackEntryPath(SearchEngineData<ch::Algorithm> &,
+                const DataFacade<ch::Algorithm> &facade,
+                const SearchEngineData<ch::Algorithm>::ManyToManyQueryHeap &query_heap,
+                const std::unordered_map<NodeID, ManyToManyHeapData> &column_tree,
+                const NodeID middle,
+                const EdgeWeight weight,
+                const bool loop,
+                const PhantomNodes &phantom_nodes,
+                const PhantomNode &)
+{
+    std::vector<NodeID> packed_path{middle};
+    while (query_heap.GetData(packed_path.back()).parent != packed_path.back())
+    {
+        packed_path.push_back(query_heap.GetData(packed_path.back()).parent);
+    }
+    std::reverse(packed_path.begin(), packed_path.end());
+    if (loop)
+    {
+        packed_path.push_back(middle);
+    }
+    for (auto node = column_tree.find(middle);
+         node != column_tree.end() && node->second.parent != node->first;
+         node = column_tree.find(node->second.parent))
+    {
+        packed_path.push_back(node->second.parent);
+    }
 
-    unsigned column_idx = 0;
-    const auto search_target_phantom = [&](const PhantomNode &phantom) {
-        // clear heap and insert target nodes
-        query_heap.Clear();
-        insertTargetInHeap(query_heap, phantom);
+    std::vector<NodeID> unpacked_nodes{packed_path.front()};
+    std::vector<EdgeID> unpacked_edges;
+    ch::unpackPath(facade,
+                   packed_path.begin(),
+                   packed_path.end(),
+                   [&](const std::pair<NodeID, NodeID> &edge, const EdgeID edge_id) {
+                       unpacked_nodes.push_back(edge.second);
+                       unpacked_edges.push_back(edge_id);
+                   });
+    return extractRoute(facade, weight, phantom_nodes, unpacked_nodes, unpacked_edges);
+}
 
-        // explore search space
-        while (!query_heap.Empty())
+// The overlay edges of an MLD path are unpacked on the level the search that relaxed them took
+// them on: the forward search of the row chose it by its args, the backward search of the column
+// by the target alone.
+template <typename... Args>
+InternalRouteResult
+unpackEntryPath(SearchEngineData<mld::Algorithm> &engine_working_data,
+                const DataFacade<mld::Algorithm> &facade,
+                const SearchEngineData<mld::Algorithm>::ManyToManyQueryHeap &query_heap,
+                const std::unordered_map<NodeID, ManyToManyMultiLayerDijkstraHeapData> &column_tree,
+                const NodeID middle,
+                const EdgeWeight weight,
+                const bool,
+                const PhantomNodes &phantom_nodes,
+                const Args &... args)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+
+    // {from, to, from_clique_arc, level}
+    std::vector<std::tuple<NodeID, NodeID, bool, LevelID>> packed_path;
+    for (auto node = middle; query_heap.GetData(node).parent != node;
+         node = query_heap.GetData(node).parent)
+    {
+        const auto &data = query_heap.GetData(node);
+        packed_path.emplace_back(data.parent,
+                                 node,
+                                 data.from_clique_arc,
+                                 getNodeQueryLevel(partition, data.parent, args...));
+    }
+    std::reverse(packed_path.begin(), packed_path.end());
+    for (auto node = column_tree.find(middle);
+         node != column_tree.end() && node->second.parent != node->first;
+         node = column_tree.find(node->second.parent))
+    {
+        packed_path.emplace_back(
+            node->first,
+            node->second.parent,
+            node->second.from_clique_arc,
+            getNodeQueryLevel(partition, node->second.parent, phantom_nodes.target_phantom));
+    }
+
+    SearchTracing::UnpackingTimer unpacking_timer;
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
+    std::vector<NodeID> unpacked_nodes{packed_path.empty() ? middle
+                                                           : std::get<0>(packed_path.front())};
+    std::vector<EdgeID> unpacked_edges;
+    for (const auto &packed_edge : packed_path)
+    {
+        NodeID from, to;
+        bool overlay_edge;
+        LevelID level;
+        std::tie(from, to, overlay_edge, level) = packed_edge;
+        if (!overlay_edge)
         {
-            backwardRoutingStep(facade, column_idx, query_heap, search_space_with_buckets, phantom);
+            unpacked_nodes.push_back(to);
+            unpacked_edges.push_back(facade.FindEdge(from, to));
         }
-        ++column_idx;
-    };
+        else
+        {
+            mld::unpackOverlayEdge(engine_working_data,
+                                   facade,
+                                   *engine_working_data.forward_heap_1,
+                                   *engine_working_data.reverse_heap_1,
+                                   DO_NOT_FORCE_LOOPS,
+                                   DO_NOT_FORCE_LOOPS,
+                                   from,
+                                   to,
+                                   level,
+                                   unpacked_nodes,
+                                   unpacked_edges);
+        }
+    }
+    return extractRoute(facade, weight, phantom_nodes, unpacked_nodes, unpacked_edges);
+}
 
-    // for each source do forward search
-    unsigned row_idx = 0;
-    const auto search_source_phantom = [&](const PhantomNode &phantom) {
-        // clear heap and insert source nodes
-        query_heap.Clear();
-        insertSourceInHeap(query_heap, phantom);
+// The entries of a table whose paths are asked for. The backward searches of their columns keep
+// their search trees, the forward searches of their rows note the middle node of every entry and
+// unpack the paths of the row as soon as they are done.
+template <typename Algorithm> class TablePaths
+{
+  public:
+    using QueryHeap = typename SearchEngineData<Algorithm>::ManyToManyQueryHeap;
+    using SearchTree = std::unordered_map<NodeID, typename QueryHeap::DataType>;
 
-        // explore search space
-        while (!query_heap.Empty())
+    TablePaths(const std::vector<std::pair<std::size_t, std::size_t>> &entries,
+               const std::vector<PhantomNode> &phantom_nodes,
+               const std::vector<std::size_t> &source_indices,
+               const std::vector<std::size_t> &target_indices,
+               std::vector<InternalRouteResult> &paths)
+        : entries(entries), phantom_nodes(phantom_nodes), source_indices(source_indices),
+          target_indices(target_indices), paths(paths)
+    {
+        paths.assign(entries.size(), InternalRouteResult{});
+        if (entries.empty())
         {
-            forwardRoutingStep(facade,
-                               row_idx,
-                               number_of_targets,
-                               query_heap,
-                               search_space_with_buckets,
-                               weights_table,
-                               durations_table,
-                               phantom);
+            return;
         }
-        ++row_idx;
-    };
 
-    if (target_indices.empty())
-    {
-        for (const auto &phantom : phantom_nodes)
+        const auto number_of_sources =
+            source_indices.empty() ? phantom_nodes.size() : source_indices.size();
+        number_of_targets = target_indices.empty() ? phantom_nodes.size() : target_indices.size();
+        row_entries.resize(number_of_sources);
+        column_trees.resize(number_of_targets);
+        has_column.resize(number_of_targets, false);
+        middles_table.resize(number_of_sources * number_of_targets, SPECIAL_NODEID);
+        for (const auto index : util::irange<std::size_t>(0, entries.size()))
         {
-            search_target_phantom(phantom);
+            row_entries[entries[index].first].push_back(index);
+            has_column[entries[index].second] = true;
         }
     }
-    else
+
+    // empty unless paths are asked for
+    std::vector<NodeID> &GetMiddlesTable() { return middles_table; }
+
+    // Keeps the search tree of a finished backward search, the nodes of its buckets
+    void AddColumn(const unsigned column_idx,
+                   const QueryHeap &query_heap,
+                   const SearchSpaceWithBuckets::const_iterator buckets_begin,
+                   const SearchSpaceWithBuckets::const_iterator buckets_end)
     {
-        for (const auto index : target_indices)
+        if (has_column.empty() || !has_column[column_idx])
+        {
+            return;
+        }
+        auto &tree = column_trees[column_idx];
+        for (auto bucket = buckets_begin; bucket != buckets_end; ++bucket)
         {
-            const auto &phantom = phantom_nodes[index];
-            search_target_phantom(phantom);
+            tree.emplace(bucket->middle_node, query_heap.GetData(bucket->middle_node));
         }
     }
 
-    if (source_indices.empty())
+    // Unpacks the paths of a row after its forward search, args are the ones it relaxed with
+    template <typename... Args>
+    void UnpackRow(SearchEngineData<Algorithm> &engine_working_data,
+                   const DataFacade<Algorithm> &facade,
+                   const unsigned row_idx,
+                   const QueryHeap &query_heap,
+                   const SearchSpaceWithBuckets &buckets,
+                   const std::vector<EdgeWeight> &weights_table,
+                   const Args &... args)
     {
-        for (const auto &phantom : phantom_nodes)
+        if (row_entries.empty())
         {
-            search_source_phantom(phantom);
+            return;
+        }
+
+        const auto &source_phantom =
+            phantom_nodes[source_indices.empty() ? row_idx : source_indices[row_idx]];
+        for (const auto index : row_entries[row_idx])
+        {
+            const auto column_idx = static_cast<unsigned>(entries[index].second);
+            const auto &target_phantom =
+                phantom_nodes[target_indices.empty() ? column_idx : target_indices[column_idx]];
+            const PhantomNodes entry_phantoms{source_phantom, target_phantom};
+
+            const auto entry = row_idx * number_of_targets + column_idx;
+            const auto middle = middles_table[entry];
+            if (middle == SPECIAL_NODEID)
+            {
+                paths[index].segment_end_coordinates = {entry_phantoms};
+                continue;
+            }
+
+            // the sum of the weights the middle node was reached with is negative for a loop
+            const auto bucket = std::lower_bound(
+                buckets.begin(), buckets.end(), NodeBucket(middle, column_idx, 0, 0, 0));
+            BOOST_ASSERT(bucket != buckets.end() && bucket->middle_node == middle);
+            const bool loop = query_heap.GetKey(middle) + bucket->weight < 0;
+
+            paths[index] = unpackEntryPath(engine_working_data,
+                                           facade,
+                                           query_heap,
+                                           column_trees[column_idx],
+                                           middle,
+                                           weights_table[entry],
+                                           loop,
+                                           entry_phantoms,
+                                           args...);
         }
     }
-    else
+
+  private:
+    const std::vector<std::pair<std::size_t, std::size_t>> &entries;
+    const std::vector<PhantomNode> &phantom_nodes;
+    const std::vector<std::size_t> &source_indices;
+    const std::vector<std::size_t> &target_indices;
+    std::vector<InternalRouteResult> &paths;
+
+    std::size_t number_of_targets = 0;
+    // indices of the entries by row, the search trees and a flag of the columns with entries
+    std::vector<std::vector<std::size_t>> row_entries;
+    std::vector<SearchTree> column_trees;
+    std::vector<bool> has_column;
+    std::vector<NodeID> middles_table;
+};
+
+// The searches start a phantom node's distance into its segments, looked up only if distances are
+// asked for
+template <typename Algorithm>
+std::vector<PhantomDistances> getAllPhantomDistances(const DataFacade<Algorithm> &facade,
+                                                     const std::vector<PhantomNode> &phantom_nodes,
+                                                     const bool distances)
+{
+    std::vector<PhantomDistances> phantom_distances(phantom_nodes.size());
+    if (distances)
+    {
+        std::transform(phantom_nodes.begin(),
+                       phantom_nodes.end(),
+                       phantom_distances.begin(),
+                       [&facade](const PhantomNode &phantom_node) {
+                           return getPhantomDistances(facade, phantom_node);
+                       });
+    }
+    return phantom_distances;
+}
+
+// RPHAST: all targets share one restricted graph, the part of the hierarchy their backward
+// searches would explore. The weights from a source to all of its nodes follow from the upward
+// search of the source and one sweep over the restricted graph from the top down, no matter how
+// many targets there are.
+struct RestrictedGraph
+{
+    struct Edge
     {
-        for (const auto index : source_indices)
+        unsigned parent; // the higher node the weight is pulled from
+        EdgeWeight weight;
+        EdgeWeight duration;
+        EdgeDistance distance;
+    };
+
+    // the edges of node i are [edge_offsets[i], edge_offsets[i + 1]), a node comes after all of
+    // the nodes it pulls from
+    std::vector<std::size_t> edge_offsets;
+    std::vector<Edge> edges;
+    std::unordered_map<NodeID, unsigned> node_index;
+
+    std::size_t NumberOfNodes() const { return edge_offsets.size() - 1; }
+};
+
+// A node a backward search of a target starts from
+struct TargetNode
+{
+    unsigned column_idx;
+    NodeID node;
+    EdgeWeight weight;
+    EdgeWeight duration;
+    EdgeDistance distance;
+};
+
+RestrictedGraph buildRestrictedGraph(const DataFacade<ch::Algorithm> &facade,
+                                     const std::vector<TargetNode> &target_nodes)
+{
+    RestrictedGraph graph;
+    graph.edge_offsets.push_back(0);
+
+    // nodes are numbered in depth first post-order: by the time a node is done all nodes it
+    // pulls from have a number
+    constexpr unsigned UNFINISHED = std::numeric_limits<unsigned>::max();
+    const auto finish = [&](const NodeID node) {
+        for (const auto edge : facade.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = facade.GetEdgeData(edge);
+            const NodeID to = facade.GetTarget(edge);
+            if (data.backward && to != node)
+            {
+                const auto parent = graph.node_index.at(to);
+                BOOST_ASSERT(parent != UNFINISHED);
+                graph.edges.push_back({parent, data.weight, data.duration, data.distance});
+            }
+        }
+        graph.node_index[node] = graph.NumberOfNodes();
+        graph.edge_offsets.push_back(graph.edges.size());
+    };
+
+    // the nodes on the path from the root to the top of the stack with their next edge
+    std::vector<std::pair<NodeID, EdgeID>> stack;
+    for (const auto &target_node : target_nodes)
+    {
+        if (!graph.node_index.emplace(target_node.node, UNFINISHED).second)
         {
-            const auto &phantom = phantom_nodes[index];
-            search_source_phantom(phantom);
+            continue;
+        }
+        stack.emplace_back(target_node.node, facade.GetAdjacentEdgeRange(target_node.node).front());
+
+        while (!stack.empty())
+        {
+            const NodeID node = stack.back().first;
+            const EdgeID edge = stack.back().second;
+            if (edge == *facade.GetAdjacentEdgeRange(node).end())
+            {
+                finish(node);
+                stack.pop_back();
+                continue;
+            }
+            stack.back().second++;
+
+            const NodeID to = facade.GetTarget(edge);
+            if (facade.GetEdgeData(edge).backward && to != node &&
+                graph.node_index.emplace(to, UNFINISHED).second)
+            {
+                stack.emplace_back(to, facade.GetAdjacentEdgeRange(to).front());
+            }
         }
     }
 
-    return durations_table;
+    return graph;
 }
 
-template std::vector<EdgeWeight>
+// Sources are swept in batches. The weights of the sources of a batch are kept next to each other
+// per node, the sweep relaxes an edge for all of them at once.
+constexpr std::size_t RPHAST_BATCH_SIZE = 8;
+
+struct BatchWeights
+{
+    std::vector<EdgeWeight> weights;
+    std::vector<EdgeWeight> durations;
+    // empty unless distances are asked for
+    std::vector<EdgeDistance> distances;
+};
+
+template <bool DISTANCES>
+void sweepRestrictedGraph(const RestrictedGraph &graph, BatchWeights &batch)
+{
+    EdgeWeight *const weights = batch.weights.data();
+    EdgeWeight *const durations = batch.durations.data();
+    EdgeDistance *const distances = batch.distances.data();
+
+    for (const auto node : util::irange<std::size_t>(0, graph.NumberOfNodes()))
+    {
+        EdgeWeight *const node_weights = weights + node * RPHAST_BATCH_SIZE;
+        EdgeWeight *const node_durations = durations + node * RPHAST_BATCH_SIZE;
+        EdgeDistance *const node_distances =
+            DISTANCES ? distances + node * RPHAST_BATCH_SIZE : nullptr;
+
+        for (auto edge = graph.edge_offsets[node]; edge != graph.edge_offsets[node + 1]; ++edge)
+        {
+            const auto &pull = graph.edges[edge];
+            BOOST_ASSERT(pull.parent < node);
+            const EdgeWeight *const parent_weights = weights + pull.parent * RPHAST_BATCH_SIZE;
+            const EdgeWeight *const parent_durations = durations + pull.parent * RPHAST_BATCH_SIZE;
+            const EdgeDistance *const parent_distances =
+                DISTANCES ? distances + pull.parent * RPHAST_BATCH_SIZE : nullptr;
+
+            // Branch free so that the compiler vectorizes it across the batch. The sums are
+            // unsigned as they overflow for unreached parents, which are not taken anyway.
+            for (std::size_t lane = 0; lane < RPHAST_BATCH_SIZE; ++lane)
+            {
+                const auto weight = static_cast<EdgeWeight>(
+                    static_cast<std::uint32_t>(parent_weights[lane]) +
+                    static_cast<std::uint32_t>(pull.weight));
+                const auto duration = static_cast<EdgeWeight>(
+                    static_cast<std::uint32_t>(parent_durations[lane]) +
+                    static_cast<std::uint32_t>(pull.duration));
+                const bool better =
+                    parent_weights[lane] != INVALID_EDGE_WEIGHT && weight < node_weights[lane];
+                node_weights[lane] = better ? weight : node_weights[lane];
+                node_durations[lane] = better ? duration : node_durations[lane];
+                if (DISTANCES)
+                {
+                    const auto distance = parent_distances[lane] + pull.distance;
+                    node_distances[lane] = better ? distance : node_distances[lane];
+                }
+            }
+        }
+    }
+}
+
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+rphastSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+             const DataFacade<ch::Algorithm> &facade,
+             const std::vector<PhantomNode> &phantom_nodes,
+             const std::vector<std::size_t> &source_indices,
+             const std::vector<std::size_t> &target_indices,
+             const ManyToManyOptions &options)
+{
+    BOOST_ASSERT(options.weight_upper_bound == INVALID_EDGE_WEIGHT);
+
+    const auto number_of_sources =
+        source_indices.empty() ? phantom_nodes.size() : source_indices.size();
+    const auto number_of_targets =
+        target_indices.empty() ? phantom_nodes.size() : target_indices.size();
+    const auto number_of_entries = number_of_sources * number_of_targets;
+
+    std::vector<EdgeWeight> weights_table(number_of_entries, INVALID_EDGE_WEIGHT);
+    std::vector<EdgeWeight> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
+    std::vector<EdgeDistance> distances_table(options.distances ? number_of_entries : 0,
+                                              INVALID_EDGE_DISTANCE);
+    const auto phantom_distances =
+        getAllPhantomDistances(facade, phantom_nodes, options.distances);
+
+    const auto source_index = [&](const std::size_t row_idx) {
+        return source_indices.empty() ? row_idx : source_indices[row_idx];
+    };
+    const auto target_index = [&](const std::size_t column_idx) {
+        return target_indices.empty() ? column_idx : target_indices[column_idx];
+    };
+
+    std::vector<TargetNode> target_nodes;
+    for (const auto column_idx : util::irange<unsigned>(0, number_of_targets))
+    {
+        const auto &phantom = phantom_nodes[target_index(column_idx)];
+        const auto &distances = phantom_distances[target_index(column_idx)];
+        if (phantom.IsValidForwardTarget())
+        {
+            target_nodes.push_back({column_idx,
+                                    phantom.forward_segment_id.id,
+                                    phantom.GetForwardWeightPlusOffset(),
+                                    phantom.GetForwardDuration(),
+                                    distances.forward});
+        }
+        if (phantom.IsValidReverseTarget())
+        {
+            target_nodes.push_back({column_idx,
+                                    phantom.reverse_segment_id.id,
+                                    phantom.GetReverseWeightPlusOffset(),
+                                    phantom.GetReverseDuration(),
+                                    distances.reverse});
+        }
+    }
+
+    const auto graph = buildRestrictedGraph(facade, target_nodes);
+    std::vector<std::size_t> target_node_offsets;
+    for (const auto &target_node : target_nodes)
+    {
+        target_node_offsets.push_back(graph.node_index.at(target_node.node) * RPHAST_BATCH_SIZE);
+    }
+
+    // Pairs with a negative weight start and end on the same segment, they need the loop edge
+    // handling of the bucket search
+    using Pairs = std::vector<std::pair<unsigned, unsigned>>;
+    using QueryHeap = SearchEngineData<ch::Algorithm>::ManyToManyQueryHeap;
+    const auto search_batch = [&](QueryHeap &query_heap,
+                                  Deadline &deadline,
+                                  BatchWeights &batch,
+                                  Pairs &same_segment_pairs,
+                                  const unsigned first_row_idx) {
+        const unsigned last_row_idx =
+            std::min<std::size_t>(first_row_idx + RPHAST_BATCH_SIZE, number_of_sources);
+
+        batch.weights.assign(graph.NumberOfNodes() * RPHAST_BATCH_SIZE, INVALID_EDGE_WEIGHT);
+        batch.durations.assign(graph.NumberOfNodes() * RPHAST_BATCH_SIZE, MAXIMAL_EDGE_DURATION);
+        if (options.distances)
+        {
+            batch.distances.assign(graph.NumberOfNodes() * RPHAST_BATCH_SIZE,
+                                   INVALID_EDGE_DISTANCE);
+        }
+
+        // the upward searches of the sources seed the restricted graph
+        for (const auto row_idx : util::irange<unsigned>(first_row_idx, last_row_idx))
+        {
+            const auto lane = row_idx - first_row_idx;
+            const auto &phantom = phantom_nodes[source_index(row_idx)];
+
+            query_heap.Clear();
+            insertSourceInHeap(query_heap, phantom, phantom_distances[source_index(row_idx)]);
+
+            while (!query_heap.Empty())
+            {
+                deadline.Check();
+                SearchTracing::Settled(query_heap.Size());
+                const NodeID node = query_heap.DeleteMin();
+                const EdgeWeight weight = query_heap.GetKey(node);
+                const EdgeWeight duration = query_heap.GetData(node).duration;
+                const EdgeDistance distance = query_heap.GetData(node).distance;
+
+                // stalled nodes are reached lighter from above, which the sweep relaxes
+                if (ch::stallAtNode<FORWARD_DIRECTION>(facade, node, weight, query_heap))
+                {
+                    continue;
+                }
+
+                const auto index = graph.node_index.find(node);
+                if (index != graph.node_index.end())
+                {
+                    batch.weights[index->second * RPHAST_BATCH_SIZE + lane] = weight;
+                    batch.durations[index->second * RPHAST_BATCH_SIZE + lane] = duration;
+                    if (options.distances)
+                        batch.distances[index->second * RPHAST_BATCH_SIZE + lane] = distance;
+                }
+
+                relaxOutgoingEdges<FORWARD_DIRECTION>(
+                    facade, node, weight, duration, distance, query_heap, phantom);
+            }
+        }
+
+        if (options.distances)
+            sweepRestrictedGraph<true>(graph, batch);
+        else
+            sweepRestrictedGraph<false>(graph, batch);
+
+        for (const auto row_idx : util::irange<unsigned>(first_row_idx, last_row_idx))
+        {
+            const auto lane = row_idx - first_row_idx;
+            for (const auto target_idx : util::irange<std::size_t>(0, target_nodes.size()))
+            {
+                const auto &target_node = target_nodes[target_idx];
+                const auto source_weight = batch.weights[target_node_offsets[target_idx] + lane];
+                if (source_weight == INVALID_EDGE_WEIGHT)
+                {
+                    continue;
+                }
+
+                const auto new_weight = source_weight + target_node.weight;
+                if (new_weight < 0)
+                {
+                    same_segment_pairs.emplace_back(row_idx, target_node.column_idx);
+                    continue;
+                }
+
+                const auto entry = row_idx * number_of_targets + target_node.column_idx;
+                const auto offset = target_node_offsets[target_idx] + lane;
+                if (new_weight < weights_table[entry])
+                {
+                    weights_table[entry] = new_weight;
+                    durations_table[entry] = batch.durations[offset] + target_node.duration;
+                    if (options.distances)
+                        distances_table[entry] = batch.distances[offset] + target_node.distance;
+                }
+            }
+        }
+    };
+
+    const auto number_of_batches =
+        (number_of_sources + RPHAST_BATCH_SIZE - 1) / RPHAST_BATCH_SIZE;
+    Pairs same_segment_pairs;
+    if (!options.parallel)
+    {
+        engine_working_data.InitializeOrClearManyToManyHeaps(facade.GetNumberOfNodes());
+        BatchWeights batch;
+        for (const auto batch_idx : util::irange<std::size_t>(0, number_of_batches))
+        {
+            search_batch(*engine_working_data.many_to_many_heap,
+                         engine_working_data.deadline,
+                         batch,
+                         same_segment_pairs,
+                         batch_idx * RPHAST_BATCH_SIZE);
+        }
+    }
+    else
+    {
+        // batches write rows of their own, the restricted graph is only read
+        TaskHeaps<ch::Algorithm> task_heaps(engine_working_data, facade.GetNumberOfNodes());
+        tbb::enumerable_thread_specific<BatchWeights> task_batches;
+        tbb::enumerable_thread_specific<Pairs> task_same_segment_pairs;
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_batches),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              SearchTracing::WorkerScope trace_scope(task_heaps.Trace());
+                              auto &data = task_heaps.Local();
+                              for (auto batch_idx = range.begin(); batch_idx != range.end();
+                                   ++batch_idx)
+                              {
+                                  search_batch(*data.many_to_many_heap,
+                                               data.deadline,
+                                               task_batches.local(),
+                                               task_same_segment_pairs.local(),
+                                               batch_idx * RPHAST_BATCH_SIZE);
+                              }
+                          });
+        for (const auto &pairs : task_same_segment_pairs)
+        {
+            same_segment_pairs.insert(same_segment_pairs.end(), pairs.begin(), pairs.end());
+        }
+    }
+
+    std::sort(same_segment_pairs.begin(), same_segment_pairs.end());
+    same_segment_pairs.erase(std::unique(same_segment_pairs.begin(), same_segment_pairs.end()),
+                             same_segment_pairs.end());
+    ManyToManyOptions pair_options;
+    pair_options.distances = options.distances;
+    for (const auto &pair : same_segment_pairs)
+    {
+        const auto tables = manyToManySearch(engine_working_data,
+                                             facade,
+                                             phantom_nodes,
+                                             {source_index(pair.first)},
+                                             {target_index(pair.second)},
+                                             pair_options);
+        const auto entry = pair.first * number_of_targets + pair.second;
+        durations_table[entry] = tables.first.front();
+        if (options.distances)
+            distances_table[entry] = tables.second.front();
+    }
+
+    return std::make_pair(std::move(durations_table), std::move(distances_table));
+}
+
+// MLD has no hierarchy to sweep, its tables always use buckets
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+rphastSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+             const DataFacade<mld::Algorithm> &facade,
+             const std::vector<PhantomNode> &phantom_nodes,
+             const std::vector<std::size_t> &source_indices,
+             const std::vector<std::size_t> &target_indices,
+             const ManyToManyOptions &options)
+{
+    auto bucket_options = options;
+    bucket_options.rphast = false;
+    return manyToManySearch(
+        engine_working_data, facade, phantom_nodes, source_indices, target_indices, bucket_options);
+}
+
+using Tables = std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>;
+
+// CH has no cells to prune by
+boost::optional<Tables> targetCellsSearch(SearchEngineData<ch::Algorithm> &,
+                                          const DataFacade<ch::Algorithm> &,
+                                          const std::vector<PhantomNode> &,
+                                          const std::vector<std::size_t> &,
+                                          const std::vector<std::size_t> &,
+                                          const ManyToManyOptions &,
+                                          std::vector<InternalRouteResult> &)
+{
+    return boost::none;
+}
+
+// Tables with a single source or with targets that share a cell of the highest level: one
+// forward search per source settles the targets by itself, no backward searches explore the
+// whole overlay for buckets. Every node takes the shortcuts of the highest level that separates
+// it from the source and from all targets, so the search only descends into the cells of the
+// targets once it reaches them, and it stops as soon as every target node is settled.
+boost::optional<Tables> targetCellsSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                          const DataFacade<mld::Algorithm> &facade,
+                                          const std::vector<PhantomNode> &phantom_nodes,
+                                          const std::vector<std::size_t> &source_indices,
+                                          const std::vector<std::size_t> &target_indices,
+                                          const ManyToManyOptions &options,
+                                          std::vector<InternalRouteResult> &paths)
+{
+    const auto number_of_sources =
+        source_indices.empty() ? phantom_nodes.size() : source_indices.size();
+    const auto number_of_targets =
+        target_indices.empty() ? phantom_nodes.size() : target_indices.size();
+
+    const auto &partition = facade.GetMultiLevelPartition();
+    const TargetCells target_cells(partition, phantom_nodes, target_indices);
+    const auto highest_level = partition.GetNumberOfLevels() - 1;
+    if (number_of_sources > 1 && target_cells.GetSeparatingLevel() >= highest_level)
+    {
+        return boost::none;
+    }
+
+    // entries only take paths lighter than the bound
+    const auto number_of_entries = number_of_sources * number_of_targets;
+    std::vector<EdgeWeight> weights_table(number_of_entries, options.weight_upper_bound);
+    std::vector<EdgeWeight> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
+    std::vector<EdgeDistance> distances_table(options.distances ? number_of_entries : 0,
+                                              INVALID_EDGE_DISTANCE);
+    const auto phantom_distances =
+        getAllPhantomDistances(facade, phantom_nodes, options.distances);
+    TablePaths<mld::Algorithm> table_paths(
+        options.paths, phantom_nodes, source_indices, target_indices, paths);
+
+    const auto source_index = [&](const std::size_t row_idx) {
+        return source_indices.empty() ? row_idx : source_indices[row_idx];
+    };
+    const auto target_index = [&](const std::size_t column_idx) {
+        return target_indices.empty() ? column_idx : target_indices[column_idx];
+    };
+
+    // the nodes of the targets are the only buckets, with the weights a backward search would
+    // have started them with
+    SearchSpaceWithBuckets target_buckets;
+    for (const auto column_idx : util::irange<unsigned>(0, number_of_targets))
+    {
+        const auto &phantom = phantom_nodes[target_index(column_idx)];
+        const auto &distances = phantom_distances[target_index(column_idx)];
+        if (phantom.IsValidForwardTarget())
+        {
+            target_buckets.emplace_back(phantom.forward_segment_id.id,
+                                        column_idx,
+                                        phantom.GetForwardWeightPlusOffset(),
+                                        phantom.GetForwardDuration(),
+                                        distances.forward);
+        }
+        if (phantom.IsValidReverseTarget())
+        {
+            target_buckets.emplace_back(phantom.reverse_segment_id.id,
+                                        column_idx,
+                                        phantom.GetReverseWeightPlusOffset(),
+                                        phantom.GetReverseDuration(),
+                                        distances.reverse);
+        }
+    }
+    std::sort(target_buckets.begin(), target_buckets.end());
+    std::size_t number_of_target_nodes = 0;
+    for (auto bucket = target_buckets.begin(); bucket != target_buckets.end(); ++bucket)
+    {
+        if (bucket == target_buckets.begin() || bucket->middle_node != (bucket - 1)->middle_node)
+        {
+            ++number_of_target_nodes;
+        }
+    }
+
+    const auto search_source_phantom = [&](SearchEngineData<mld::Algorithm> &data,
+                                           const unsigned row_idx) {
+        const auto &phantom = phantom_nodes[source_index(row_idx)];
+        auto &query_heap = *data.many_to_many_heap;
+
+        query_heap.Clear();
+        insertSourceInHeap(query_heap, phantom, phantom_distances[source_index(row_idx)]);
+
+        // a settled node is final, once all target nodes are settled the row is complete
+        auto unsettled_target_nodes = number_of_target_nodes;
+        while (!query_heap.Empty() && unsettled_target_nodes > 0 &&
+               query_heap.MinKey() < options.weight_upper_bound)
+        {
+            data.deadline.Check();
+            if (forwardRoutingStep(facade,
+                                   row_idx,
+                                   number_of_targets,
+                                   query_heap,
+                                   target_buckets,
+                                   weights_table,
+                                   durations_table,
+                                   distances_table,
+                                   table_paths.GetMiddlesTable(),
+                                   phantom,
+                                   target_cells))
+            {
+                --unsettled_target_nodes;
+            }
+        }
+
+        table_paths.UnpackRow(data,
+                              facade,
+                              row_idx,
+                              query_heap,
+                              target_buckets,
+                              weights_table,
+                              phantom,
+                              target_cells);
+    };
+
+    if (!options.parallel)
+    {
+        engine_working_data.InitializeOrClearManyToManyHeaps(facade.GetNumberOfNodes());
+        for (const auto row_idx : util::irange<unsigned>(0, number_of_sources))
+        {
+            search_source_phantom(engine_working_data, row_idx);
+        }
+        return Tables(std::move(durations_table), std::move(distances_table));
+    }
+
+    TaskHeaps<mld::Algorithm> task_heaps(engine_working_data, facade.GetNumberOfNodes());
+    tbb::parallel_for(tbb::blocked_range<unsigned>(0, number_of_sources),
+                      [&](const tbb::blocked_range<unsigned> &range) {
+                          SearchTracing::WorkerScope trace_scope(task_heaps.Trace());
+                          auto &data = task_heaps.Local();
+                          for (auto row_idx = range.begin(); row_idx != range.end(); ++row_idx)
+                          {
+                              search_source_phantom(data, row_idx);
+                          }
+                      });
+
+    return Tables(std::move(durations_table), std::move(distances_table));
+}
+}
+
+template <typename Algorithm>
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                 const DataFacade<Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options)
+{
+    std::vector<InternalRouteResult> paths;
+    return manyToManySearch(engine_working_data,
+                            facade,
+                            phantom_nodes,
+                            source_indices,
+                            target_indices,
+                            options,
+                            paths);
+}
+
+template <typename Algorithm>
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                 const DataFacade<Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options,
+                 std::vector<InternalRouteResult> &paths)
+{
+    // the sweep of RPHAST keeps no search trees to trace paths back through
+    if (options.rphast && options.paths.empty())
+    {
+        paths.clear();
+        return rphastSearch(
+            engine_working_data, facade, phantom_nodes, source_indices, target_indices, options);
+    }
+
+    if (auto tables = targetCellsSearch(engine_working_data,
+                                        facade,
+                                        phantom_nodes,
+                                        source_indices,
+                                        target_indices,
+                                        options,
+                                        paths))
+    {
+        return std::move(*tables);
+    }
+
+    const auto number_of_sources =
+        source_indices.empty() ? phantom_nodes.size() : source_indices.size();
+    const auto number_of_targets =
+        target_indices.empty() ? phantom_nodes.size() : target_indices.size();
+    const auto number_of_entries = number_of_sources * number_of_targets;
+
+    std::vector<EdgeWeight> weights_table(number_of_entries, options.weight_upper_bound);
+    std::vector<EdgeWeight> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
+    std::vector<EdgeDistance> distances_table(options.distances ? number_of_entries : 0,
+                                              INVALID_EDGE_DISTANCE);
+    const auto phantom_distances =
+        getAllPhantomDistances(facade, phantom_nodes, options.distances);
+    TablePaths<Algorithm> table_paths(
+        options.paths, phantom_nodes, source_indices, target_indices, paths);
+
+    const auto source_index = [&](const std::size_t row_idx) {
+        return source_indices.empty() ? row_idx : source_indices[row_idx];
+    };
+    const auto target_index = [&](const std::size_t column_idx) {
+        return target_indices.empty() ? column_idx : target_indices[column_idx];
+    };
+
+    // forward searches start at minus the offset of their source into its segment, a bucket can
+    // be part of a path lighter than the bound only up to the bound plus the largest offset
+    auto backward_upper_bound = options.weight_upper_bound;
+    if (options.weight_upper_bound != INVALID_EDGE_WEIGHT)
+    {
+        EdgeWeight source_offset = 0;
+        for (const auto row_idx : util::irange<std::size_t>(0, number_of_sources))
+        {
+            const auto &phantom = phantom_nodes[source_index(row_idx)];
+            if (phantom.IsValidForwardSource())
+                source_offset = std::max(source_offset, phantom.GetForwardWeightPlusOffset());
+            if (phantom.IsValidReverseSource())
+                source_offset = std::max(source_offset, phantom.GetReverseWeightPlusOffset());
+        }
+        backward_upper_bound += source_offset;
+    }
+
+    // the deadline is passed along as every task checks a copy of its own
+    using QueryHeap = typename SearchEngineData<Algorithm>::ManyToManyQueryHeap;
+    const auto search_target_phantom = [&](QueryHeap &query_heap,
+                                           Deadline &deadline,
+                                           SearchSpaceWithBuckets &search_space_with_buckets,
+                                           const unsigned column_idx) {
+        const auto &phantom = phantom_nodes[target_index(column_idx)];
+
+        // clear heap and insert target nodes
+        query_heap.Clear();
+        insertTargetInHeap(query_heap, phantom, phantom_distances[target_index(column_idx)]);
+
+        // explore search space
+        const auto first_bucket = search_space_with_buckets.size();
+        while (!query_heap.Empty() && query_heap.MinKey() < backward_upper_bound)
+        {
+            deadline.Check();
+            backwardRoutingStep(facade, column_idx, query_heap, search_space_with_buckets, phantom);
+        }
+        table_paths.AddColumn(column_idx,
+                              query_heap,
+                              search_space_with_buckets.begin() + first_bucket,
+                              search_space_with_buckets.end());
+    };
+
+    // for each source do forward search
+    const auto search_source_phantom = [&](SearchEngineData<Algorithm> &data,
+                                           const SearchSpaceWithBuckets &search_space_with_buckets,
+                                           const unsigned row_idx) {
+        const auto &phantom = phantom_nodes[source_index(row_idx)];
+        auto &query_heap = *data.many_to_many_heap;
+
+        // clear heap and insert source nodes
+        query_heap.Clear();
+        insertSourceInHeap(query_heap, phantom, phantom_distances[source_index(row_idx)]);
+
+        // explore search space
+        while (!query_heap.Empty() && query_heap.MinKey() < options.weight_upper_bound)
+        {
+            data.deadline.Check();
+            forwardRoutingStep(facade,
+                               row_idx,
+                               number_of_targets,
+                               query_heap,
+                               search_space_with_buckets,
+                               weights_table,
+                               durations_table,
+                               distances_table,
+                               table_paths.GetMiddlesTable(),
+                               phantom);
+        }
+
+        table_paths.UnpackRow(
+            data, facade, row_idx, query_heap, search_space_with_buckets, weights_table, phantom);
+    };
+
+    // Square tables have a phantom node for every row and column. The backward and the forward
+    // search of a phantom node run back to back on the same heap in a single pass, the forward
+    // search only notes the nodes it settles. The buckets are scanned for the noted nodes in the
+    // order they were settled once all buckets are there, the entries come out like above.
+    // Tables with paths need the search tree of a row while it is unpacked.
+    if (options.fuse_square && options.paths.empty() && source_indices == target_indices)
+    {
+        std::vector<std::vector<SettledNode>> settled_nodes(number_of_sources);
+        const auto search_phantom = [&](QueryHeap &query_heap,
+                                        Deadline &deadline,
+                                        SearchSpaceWithBuckets &search_space_with_buckets,
+                                        const unsigned idx) {
+            search_target_phantom(query_heap, deadline, search_space_with_buckets, idx);
+
+            const auto &phantom = phantom_nodes[source_index(idx)];
+            query_heap.Clear();
+            insertSourceInHeap(query_heap, phantom, phantom_distances[source_index(idx)]);
+            while (!query_heap.Empty() && query_heap.MinKey() < options.weight_upper_bound)
+            {
+                deadline.Check();
+                forwardRecordingStep(facade, query_heap, settled_nodes[idx], phantom);
+            }
+        };
+        std::vector<NodeID> no_middles;
+        const auto scan_row = [&](const SearchSpaceWithBuckets &search_space_with_buckets,
+                                  const unsigned row_idx) {
+            for (const auto &settled : settled_nodes[row_idx])
+            {
+                scanBuckets(facade,
+                            row_idx,
+                            number_of_targets,
+                            settled.node,
+                            settled.weight,
+                            settled.duration,
+                            settled.distance,
+                            search_space_with_buckets,
+                            weights_table,
+                            durations_table,
+                            distances_table,
+                            no_middles);
+            }
+            std::vector<SettledNode>().swap(settled_nodes[row_idx]);
+        };
+
+        if (!options.parallel)
+        {
+            engine_working_data.InitializeOrClearManyToManyHeaps(facade.GetNumberOfNodes());
+            SearchSpaceWithBuckets search_space_with_buckets;
+            for (const auto idx : util::irange<unsigned>(0, number_of_sources))
+            {
+                search_phantom(*engine_working_data.many_to_many_heap,
+                               engine_working_data.deadline,
+                               search_space_with_buckets,
+                               idx);
+            }
+            std::sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+            for (const auto row_idx : util::irange<unsigned>(0, number_of_sources))
+            {
+                scan_row(search_space_with_buckets, row_idx);
+            }
+            return std::make_pair(std::move(durations_table), std::move(distances_table));
+        }
+
+        TaskHeaps<Algorithm> task_heaps(engine_working_data, facade.GetNumberOfNodes());
+        tbb::enumerable_thread_specific<SearchSpaceWithBuckets> task_search_spaces;
+        tbb::parallel_for(tbb::blocked_range<unsigned>(0, number_of_sources),
+                          [&](const tbb::blocked_range<unsigned> &range) {
+                              SearchTracing::WorkerScope trace_scope(task_heaps.Trace());
+                              auto &data = task_heaps.Local();
+                              auto &search_space_with_buckets = task_search_spaces.local();
+                              for (auto idx = range.begin(); idx != range.end(); ++idx)
+                              {
+                                  search_phantom(*data.many_to_many_heap,
+                                                 data.deadline,
+                                                 search_space_with_buckets,
+                                                 idx);
+                              }
+                          });
+
+        SearchSpaceWithBuckets search_space_with_buckets;
+        for (auto &task_search_space : task_search_spaces)
+        {
+            search_space_with_buckets.insert(search_space_with_buckets.end(),
+                                             task_search_space.begin(),
+                                             task_search_space.end());
+        }
+        tbb::parallel_sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+
+        // the scans of a row only write the row
+        tbb::parallel_for(tbb::blocked_range<unsigned>(0, number_of_sources),
+                          [&](const tbb::blocked_range<unsigned> &range) {
+                              for (auto row_idx = range.begin(); row_idx != range.end(); ++row_idx)
+                              {
+                                  scan_row(search_space_with_buckets, row_idx);
+                              }
+                          });
+        return std::make_pair(std::move(durations_table), std::move(distances_table));
+    }
+
+    if (!options.parallel)
+    {
+        engine_working_data.InitializeOrClearManyToManyHeaps(facade.GetNumberOfNodes());
+        auto &query_heap = *(engine_working_data.many_to_many_heap);
+        auto &deadline = engine_working_data.deadline;
+
+        SearchSpaceWithBuckets search_space_with_buckets;
+        for (const auto column_idx : util::irange<unsigned>(0, number_of_targets))
+        {
+            search_target_phantom(query_heap, deadline, search_space_with_buckets, column_idx);
+        }
+        std::sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+
+        for (const auto row_idx : util::irange<unsigned>(0, number_of_sources))
+        {
+            search_source_phantom(engine_working_data, search_space_with_buckets, row_idx);
+        }
+        return std::make_pair(std::move(durations_table), std::move(distances_table));
+    }
+
+    TaskHeaps<Algorithm> task_heaps(engine_working_data, facade.GetNumberOfNodes());
+
+    // backward searches fill buckets of their own, merged before the forward searches start
+    tbb::enumerable_thread_specific<SearchSpaceWithBuckets> task_search_spaces;
+    tbb::parallel_for(tbb::blocked_range<unsigned>(0, number_of_targets),
+                      [&](const tbb::blocked_range<unsigned> &range) {
+                          SearchTracing::WorkerScope trace_scope(task_heaps.Trace());
+                          auto &data = task_heaps.Local();
+                          auto &search_space_with_buckets = task_search_spaces.local();
+                          for (auto column_idx = range.begin(); column_idx != range.end();
+                               ++column_idx)
+                          {
+                              search_target_phantom(*data.many_to_many_heap,
+                                                    data.deadline,
+                                                    search_space_with_buckets,
+                                                    column_idx);
+                          }
+                      });
+
+    SearchSpaceWithBuckets search_space_with_buckets;
+    for (auto &task_search_space : task_search_spaces)
+    {
+        if (search_space_with_buckets.empty())
+        {
+            search_space_with_buckets = std::move(task_search_space);
+            continue;
+        }
+        search_space_with_buckets.insert(search_space_with_buckets.end(),
+                                         task_search_space.begin(),
+                                         task_search_space.end());
+    }
+    tbb::parallel_sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+
+    // forward searches only read the buckets and write rows of their own
+    tbb::parallel_for(tbb::blocked_range<unsigned>(0, number_of_sources),
+                      [&](const tbb::blocked_range<unsigned> &range) {
+                          SearchTracing::WorkerScope trace_scope(task_heaps.Trace());
+                          auto &data = task_heaps.Local();
+                          for (auto row_idx = range.begin(); row_idx != range.end(); ++row_idx)
+                          {
+                              search_source_phantom(data, search_space_with_buckets, row_idx);
+                          }
+                      });
+
+    return std::make_pair(std::move(durations_table), std::move(distances_table));
+}
+
+// Core-CH contracts all nodes but the ones of its core, the searches of a table climb the hierarchy
+// as in CH and stop at the core. The backward searches of the targets leave their last buckets at
+// the core nodes they reach. The forward search of a source collects the nodes it enters the core
+// at and continues from all of them with one Dijkstra search through the core, which scans the
+// buckets of every core node it settles: the core is searched once per source, not once per entry.
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<corech::Algorithm> &engine_working_data,
+                 const DataFacade<corech::Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options)
+{
+    const DataFacade<ch::Algorithm> &ch_facade = facade;
+
+    const auto number_of_sources =
+        source_indices.empty() ? phantom_nodes.size() : source_indices.size();
+    const auto number_of_targets =
+        target_indices.empty() ? phantom_nodes.size() : target_indices.size();
+    const auto number_of_entries = number_of_sources * number_of_targets;
+
+    std::vector<EdgeWeight> weights_table(number_of_entries, options.weight_upper_bound);
+    std::vector<EdgeWeight> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
+    std::vector<EdgeDistance> distances_table(options.distances ? number_of_entries : 0,
+                                              INVALID_EDGE_DISTANCE);
+    // no paths are unpacked, no middle nodes are noted
+    std::vector<NodeID> middles_table;
+    const auto phantom_distances =
+        getAllPhantomDistances(ch_facade, phantom_nodes, options.distances);
+
+    const auto source_index = [&](const std::size_t row_idx) {
+        return source_indices.empty() ? row_idx : source_indices[row_idx];
+    };
+    const auto target_index = [&](const std::size_t column_idx) {
+        return target_indices.empty() ? column_idx : target_indices[column_idx];
+    };
+
+    // forward searches start at minus the offset of their source into its segment, a bucket can
+    // be part of a path lighter than the bound only up to the bound plus the largest offset
+    auto backward_upper_bound = options.weight_upper_bound;
+    if (options.weight_upper_bound != INVALID_EDGE_WEIGHT)
+    {
+        EdgeWeight source_offset = 0;
+        for (const auto row_idx : util::irange<std::size_t>(0, number_of_sources))
+        {
+            const auto &phantom = phantom_nodes[source_index(row_idx)];
+            if (phantom.IsValidForwardSource())
+                source_offset = std::max(source_offset, phantom.GetForwardWeightPlusOffset());
+            if (phantom.IsValidReverseSource())
+                source_offset = std::max(source_offset, phantom.GetReverseWeightPlusOffset());
+        }
+        backward_upper_bound += source_offset;
+    }
+
+    using QueryHeap = SearchEngineData<corech::Algorithm>::ManyToManyQueryHeap;
+    const auto search_target_phantom = [&](QueryHeap &query_heap,
+                                           Deadline &deadline,
+                                           SearchSpaceWithBuckets &search_space_with_buckets,
+                                           const unsigned column_idx) {
+        const auto &phantom = phantom_nodes[target_index(column_idx)];
+
+        query_heap.Clear();
+        insertTargetInHeap(query_heap, phantom, phantom_distances[target_index(column_idx)]);
+
+        while (!query_heap.Empty() && query_heap.MinKey() < backward_upper_bound)
+        {
+            deadline.Check();
+            if (!facade.IsCoreNode(query_heap.Min()))
+            {
+                backwardRoutingStep(
+                    ch_facade, column_idx, query_heap, search_space_with_buckets, phantom);
+                continue;
+            }
+
+            // core nodes keep the bucket but the search does not go on from them
+            SearchTracing::Settled(query_heap.Size());
+            const NodeID node = query_heap.DeleteMin();
+            const auto &data = query_heap.GetData(node);
+            search_space_with_buckets.emplace_back(
+                node, column_idx, query_heap.GetKey(node), data.duration, data.distance);
+        }
+    };
+
+    // the lightest bucket of every target at a core node, a path through the core to the target
+    // is at least that much heavier than the weight the core search settled it at
+    std::vector<EdgeWeight> core_bucket_weights(number_of_targets, INVALID_EDGE_WEIGHT);
+
+    const auto search_source_phantom = [&](SearchEngineData<corech::Algorithm> &data,
+                                           const SearchSpaceWithBuckets &search_space_with_buckets,
+                                           const unsigned row_idx) {
+        const auto &phantom = phantom_nodes[source_index(row_idx)];
+        auto &query_heap = *data.many_to_many_heap;
+
+        query_heap.Clear();
+        insertSourceInHeap(query_heap, phantom, phantom_distances[source_index(row_idx)]);
+
+        // up the hierarchy to the core
+        std::vector<std::tuple<NodeID, EdgeWeight, ManyToManyHeapData>> core_entry_points;
+        while (!query_heap.Empty() && query_heap.MinKey() < options.weight_upper_bound)
+        {
+            data.deadline.Check();
+            if (!facade.IsCoreNode(query_heap.Min()))
+            {
+                forwardRoutingStep(ch_facade,
+                                   row_idx,
+                                   number_of_targets,
+                                   query_heap,
+                                   search_space_with_buckets,
+                                   weights_table,
+                                   durations_table,
+                                   distances_table,
+                                   middles_table,
+                                   phantom);
+                continue;
+            }
+
+            SearchTracing::Settled(query_heap.Size());
+            const NodeID node = query_heap.DeleteMin();
+            core_entry_points.emplace_back(node, query_heap.GetKey(node), query_heap.GetData(node));
+        }
+
+        if (core_entry_points.empty())
+        {
+            return;
+        }
+
+        // no target gets lighter once the core search is past the weight of the row minus the
+        // lightest core bucket of the target for all of them
+        const auto row_bound = [&] {
+            auto bound = std::numeric_limits<std::int64_t>::min();
+            for (const auto column_idx : util::irange<std::size_t>(0, number_of_targets))
+            {
+                if (core_bucket_weights[column_idx] != INVALID_EDGE_WEIGHT)
+                {
+                    bound = std::max<std::int64_t>(
+                        bound,
+                        std::int64_t{weights_table[row_idx * number_of_targets + column_idx]} -
+                            core_bucket_weights[column_idx]);
+                }
+            }
+            return bound;
+        };
+
+        // through the core from all of its entry points at once
+        query_heap.Clear();
+        for (const auto &entry_point : core_entry_points)
+        {
+            query_heap.Insert(
+                std::get<0>(entry_point), std::get<1>(entry_point), std::get<2>(entry_point));
+        }
+        auto core_bound = row_bound();
+        while (!query_heap.Empty() && query_heap.MinKey() < options.weight_upper_bound)
+        {
+            // the bound only gets tighter while the search goes on, it is updated when reached
+            if (query_heap.MinKey() >= core_bound)
+            {
+                core_bound = row_bound();
+                if (query_heap.MinKey() >= core_bound)
+                    break;
+            }
+
+            data.deadline.Check();
+            forwardRoutingStep(ch_facade,
+                               row_idx,
+                               number_of_targets,
+                               query_heap,
+                               search_space_with_buckets,
+                               weights_table,
+                               durations_table,
+                               distances_table,
+                               middles_table,
+                               phantom,
+                               CoreSearch{});
+        }
+    };
+
+    const auto find_core_bucket_weights = [&](const SearchSpaceWithBuckets &search_space) {
+        for (const auto &bucket : search_space)
+        {
+            if (facade.IsCoreNode(bucket.middle_node))
+            {
+                auto &weight = core_bucket_weights[bucket.target_id];
+                weight = std::min(weight, bucket.weight);
+            }
+        }
+    };
+
+    if (!options.parallel)
+    {
+        engine_working_data.InitializeOrClearManyToManyHeaps(facade.GetNumberOfNodes());
+        auto &query_heap = *(engine_working_data.many_to_many_heap);
+        auto &deadline = engine_working_data.deadline;
+
+        SearchSpaceWithBuckets search_space_with_buckets;
+        for (const auto column_idx : util::irange<unsigned>(0, number_of_targets))
+        {
+            search_target_phantom(query_heap, deadline, search_space_with_buckets, column_idx);
+        }
+        std::sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+        find_core_bucket_weights(search_space_with_buckets);
+
+        for (const auto row_idx : util::irange<unsigned>(0, number_of_sources))
+        {
+            search_source_phantom(engine_working_data, search_space_with_buckets, row_idx);
+        }
+        return std::make_pair(std::move(durations_table), std::move(distances_table));
+    }
+
+    TaskHeaps<corech::Algorithm> task_heaps(engine_working_data, facade.GetNumberOfNodes());
+
+    tbb::enumerable_thread_specific<SearchSpaceWithBuckets> task_search_spaces;
+    tbb::parallel_for(tbb::blocked_range<unsigned>(0, number_of_targets),
+                      [&](const tbb::blocked_range<unsigned> &range) {
+                          SearchTracing::WorkerScope trace_scope(task_heaps.Trace());
+                          auto &data = task_heaps.Local();
+                          auto &search_space_with_buckets = task_search_spaces.local();
+                          for (auto column_idx = range.begin(); column_idx != range.end();
+                               ++column_idx)
+                          {
+                              search_target_phantom(*data.many_to_many_heap,
+                                                    data.deadline,
+                                                    search_space_with_buckets,
+                                                    column_idx);
+                          }
+                      });
+
+    SearchSpaceWithBuckets search_space_with_buckets;
+    for (auto &task_search_space : task_search_spaces)
+    {
+        if (search_space_with_buckets.empty())
+        {
+            search_space_with_buckets = std::move(task_search_space);
+            continue;
+        }
+        search_space_with_buckets.insert(search_space_with_buckets.end(),
+                                         task_search_space.begin(),
+                                         task_search_space.end());
+    }
+    tbb::parallel_sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+    find_core_bucket_weights(search_space_with_buckets);
+
+    tbb::parallel_for(tbb::blocked_range<unsigned>(0, number_of_sources),
+                      [&](const tbb::blocked_range<unsigned> &range) {
+                          SearchTracing::WorkerScope trace_scope(task_heaps.Trace());
+                          auto &data = task_heaps.Local();
+                          for (auto row_idx = range.begin(); row_idx != range.end(); ++row_idx)
+                          {
+                              search_source_phantom(data, search_space_with_buckets, row_idx);
+                          }
+                      });
+
+    return std::make_pair(std::move(durations_table), std::move(distances_table));
+}
+
+// Core-CH keeps no search trees of the core to trace paths back through
+std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<corech::Algorithm> &engine_working_data,
+                 const DataFacade<corech::Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options,
+                 std::vector<InternalRouteResult> &paths)
+{
+    if (!options.paths.empty())
+    {
+        throw util::exception("Paths of table entries are not implemented for CoreCH");
+    }
+
+    paths.clear();
+    return manyToManySearch(
+        engine_working_data, facade, phantom_nodes, source_indices, target_indices, options);
+}
+
+template std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                 const DataFacade<ch::Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options);
+
+template std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                 const DataFacade<mld::Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options);
+
+template std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
 manyToManySearch(SearchEngineData<ch::Algorithm> &engine_working_data,
                  const DataFacade<ch::Algorithm> &facade,
                  const std::vector<PhantomNode> &phantom_nodes,
                  const std::vector<std::size_t> &source_indices,
-                 const std::vector<std::size_t> &target_indices);
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options,
+                 std::vector<InternalRouteResult> &paths);
 
-template std::vector<EdgeWeight>
+template std::pair<std::vector<EdgeWeight>, std::vector<EdgeDistance>>
 manyToManySearch(SearchEngineData<mld::Algorithm> &engine_working_data,
                  const DataFacade<mld::Algorithm> &facade,
                  const std::vector<PhantomNode> &phantom_nodes,
                  const std::vector<std::size_t> &source_indices,
-                 const std::vector<std::size_t> &target_indices);
+                 const std::vector<std::size_t> &target_indices,
+                 const ManyToManyOptions &options,
+                 std::vector<InternalRouteResult> &paths);
 
 } // namespace routing_algorithms
 } // namespace engine
@@ -1,20 +1,29 @@
 #include "engine/routing_algorithms/map_matching.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/routing_base_ch.hpp"
 #include "engine/routing_algorithms/routing_base_mld.hpp"
 
 #include "engine/map_matching/hidden_markov_model.hpp"
 #include "engine/map_matching/matching_confidence.hpp"
 #include "engine/map_matching/sub_matching.hpp"
+#include "engine/search_trace.hpp"
 
 #include "util/coordinate_calculation.hpp"
-#include "util/for_each_pair.hpp"
+#include "util/coordinate_distances.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
 
 #include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <iomanip>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <numeric>
+#include <type_traits>
 #include <utility>
 
 namespace osrm
@@ -31,6 +40,8 @@ using HMM = map_matching::HiddenMarkovModel<CandidateLists>;
 constexpr static const unsigned MAX_BROKEN_STATES = 10;
 constexpr static const double MATCHING_BETA = 10;
 constexpr static const double MAX_DISTANCE_DELTA = 2000.;
+// sample times of the last steps of a session that are kept for their median
+constexpr static const std::size_t SESSION_SAMPLE_TIMES = 15;
 
 unsigned getMedianSampleTime(const std::vector<unsigned> &timestamps)
 {
@@ -46,16 +57,68 @@ unsigned getMedianSampleTime(const std::vector<unsigned> &timestamps)
     std::nth_element(first_elem, median, sample_times.end());
     return *median;
 }
+
+// The network distances from the given candidates of one timestamp to all candidates of the
+// next one, row by row. One search per source settles all targets at once, up to the weight
+// bound, instead of a bidirectional search per pair.
+template <typename Algorithm>
+std::vector<double> getNetworkDistances(SearchEngineData<Algorithm> &engine_working_data,
+                                        const DataFacade<Algorithm> &facade,
+                                        const CandidateList &source_candidates,
+                                        const std::vector<std::size_t> &sources,
+                                        const CandidateList &target_candidates,
+                                        const EdgeWeight weight_upper_bound)
+{
+    // empty indices would select all phantom nodes
+    if (sources.empty() || target_candidates.empty())
+    {
+        return {};
+    }
+
+    std::vector<PhantomNode> phantom_nodes;
+    std::vector<std::size_t> source_indices;
+    std::vector<std::size_t> target_indices;
+    phantom_nodes.reserve(sources.size() + target_candidates.size());
+    for (const auto s : sources)
+    {
+        source_indices.push_back(phantom_nodes.size());
+        phantom_nodes.push_back(source_candidates[s].phantom_node);
+    }
+    for (const auto &candidate : target_candidates)
+    {
+        target_indices.push_back(phantom_nodes.size());
+        phantom_nodes.push_back(candidate.phantom_node);
+    }
+
+    ManyToManyOptions options;
+    options.distances = true;
+    options.weight_upper_bound = weight_upper_bound;
+    const auto tables = manyToManySearch(
+        engine_working_data, facade, phantom_nodes, source_indices, target_indices, options);
+
+    std::vector<double> network_distances(tables.second.size());
+    std::transform(tables.second.begin(),
+                   tables.second.end(),
+                   network_distances.begin(),
+                   [](const EdgeDistance distance) {
+                       return distance == INVALID_EDGE_DISTANCE
+                                  ? std::numeric_limits<double>::max()
+                                  : static_cast<double>(distance);
+                   });
+    return network_distances;
 }
 
+// One Viterbi sweep over the whole trace, the median sample time is the one of the full trace
+// even if this is only a part of it
 template <typename Algorithm>
-SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
-                            const DataFacade<Algorithm> &facade,
-                            const CandidateLists &candidates_list,
-                            const std::vector<util::Coordinate> &trace_coordinates,
-                            const std::vector<unsigned> &trace_timestamps,
-                            const std::vector<boost::optional<double>> &trace_gps_precision,
-                            const bool allow_splitting)
+SubMatchingList matchTrace(SearchEngineData<Algorithm> &engine_working_data,
+                           const DataFacade<Algorithm> &facade,
+                           const CandidateLists &candidates_list,
+                           const std::vector<util::Coordinate> &trace_coordinates,
+                           const std::vector<unsigned> &trace_timestamps,
+                           const std::vector<boost::optional<double>> &trace_gps_precision,
+                           const bool allow_splitting,
+                           const unsigned median_sample_time)
 {
     map_matching::MatchingConfidence confidence;
     map_matching::EmissionLogProbability default_emission_log_probability(DEFAULT_GPS_PRECISION);
@@ -67,76 +130,41 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
     BOOST_ASSERT(candidates_list.size() > 1);
 
     const bool use_timestamps = trace_timestamps.size() > 1;
-
-    const auto median_sample_time = [&] {
-        if (use_timestamps)
-        {
-            return std::max(1u, getMedianSampleTime(trace_timestamps));
-        }
-        else
-        {
-            return 1u;
-        }
-    }();
     const auto max_broken_time = median_sample_time * MAX_BROKEN_STATES;
 
-    std::vector<std::vector<double>> emission_log_probabilities(trace_coordinates.size());
-    if (trace_gps_precision.empty())
+    // matchTrace does not wait for other tasks, so no other matching runs on the thread while
+    // it uses the model
+    thread_local HMM model;
+    model.Reset(candidates_list);
+
+    // the distances of all candidates first, then their probabilities in one batch per timestamp
+    for (const auto t : util::irange<std::size_t>(0UL, candidates_list.size()))
     {
-        for (auto t = 0UL; t < candidates_list.size(); ++t)
-        {
-            emission_log_probabilities[t].resize(candidates_list[t].size());
-            std::transform(candidates_list[t].begin(),
-                           candidates_list[t].end(),
-                           emission_log_probabilities[t].begin(),
-                           [&](const PhantomNodeWithDistance &candidate) {
-                               return default_emission_log_probability(candidate.distance);
-                           });
-        }
+        std::transform(candidates_list[t].begin(),
+                       candidates_list[t].end(),
+                       model.Emissions(t).begin(),
+                       [](const PhantomNodeWithDistance &candidate) { return candidate.distance; });
     }
-    else
+    for (const auto t : util::irange<std::size_t>(0UL, candidates_list.size()))
     {
-        for (auto t = 0UL; t < candidates_list.size(); ++t)
+        const auto emissions = model.Emissions(t);
+        if (!trace_gps_precision.empty() && trace_gps_precision[t])
         {
-            emission_log_probabilities[t].resize(candidates_list[t].size());
-            if (trace_gps_precision[t])
-            {
-                map_matching::EmissionLogProbability emission_log_probability(
-                    *trace_gps_precision[t]);
-                std::transform(
-                    candidates_list[t].begin(),
-                    candidates_list[t].end(),
-                    emission_log_probabilities[t].begin(),
-                    [&emission_log_probability](const PhantomNodeWithDistance &candidate) {
-                        return emission_log_probability(candidate.distance);
-                    });
-            }
-            else
-            {
-                std::transform(candidates_list[t].begin(),
-                               candidates_list[t].end(),
-                               emission_log_probabilities[t].begin(),
-                               [&](const PhantomNodeWithDistance &candidate) {
-                                   return default_emission_log_probability(candidate.distance);
-                               });
-            }
+            map_matching::EmissionLogProbability emission_log_probability(*trace_gps_precision[t]);
+            emission_log_probability(emissions.data(), emissions.data() + emissions.size());
+        }
+        else
+        {
+            default_emission_log_probability(emissions.data(), emissions.data() + emissions.size());
         }
     }
 
-    HMM model(candidates_list, emission_log_probabilities);
-
     std::size_t initial_timestamp = model.initialize(0);
     if (initial_timestamp == map_matching::INVALID_STATE)
     {
         return sub_matchings;
     }
 
-    const auto nodes_number = facade.GetNumberOfNodes();
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(nodes_number);
-
-    auto &forward_heap = *engine_working_data.forward_heap_1;
-    auto &reverse_heap = *engine_working_data.reverse_heap_1;
-
     std::size_t breakage_begin = map_matching::INVALID_STATE;
     std::vector<std::size_t> split_points;
     std::vector<std::size_t> prev_unbroken_timestamps;
@@ -185,15 +213,16 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
             BOOST_ASSERT(!prev_unbroken_timestamps.empty());
             const std::size_t prev_unbroken_timestamp = prev_unbroken_timestamps.back();
 
-            const auto &prev_viterbi = model.viterbi[prev_unbroken_timestamp];
-            const auto &prev_pruned = model.pruned[prev_unbroken_timestamp];
+            const auto prev_viterbi = model.Viterbi(prev_unbroken_timestamp);
+            const auto prev_pruned = model.Pruned(prev_unbroken_timestamp);
             const auto &prev_unbroken_timestamps_list = candidates_list[prev_unbroken_timestamp];
             const auto &prev_coordinate = trace_coordinates[prev_unbroken_timestamp];
 
-            auto &current_viterbi = model.viterbi[t];
-            auto &current_pruned = model.pruned[t];
-            auto &current_parents = model.parents[t];
-            auto &current_lengths = model.path_distances[t];
+            auto current_viterbi = model.Viterbi(t);
+            auto current_pruned = model.Pruned(t);
+            auto current_parents = model.Parents(t);
+            auto current_lengths = model.PathDistances(t);
+            const auto current_emissions = model.Emissions(t);
             const auto &current_timestamps_list = candidates_list[t];
             const auto &current_coordinate = trace_coordinates[t];
 
@@ -203,31 +232,36 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
             const EdgeWeight weight_upper_bound =
                 ((haversine_distance + max_distance_delta) / 4.) * facade.GetWeightMultiplier();
 
-            // compute d_t for this timestamp and the next one
+            std::vector<std::size_t> prev_unpruned;
             for (const auto s : util::irange<std::size_t>(0UL, prev_viterbi.size()))
             {
-                if (prev_pruned[s])
+                if (!prev_pruned[s])
                 {
-                    continue;
+                    prev_unpruned.push_back(s);
                 }
+            }
+            const auto network_distances = getNetworkDistances(engine_working_data,
+                                                               facade,
+                                                               prev_unbroken_timestamps_list,
+                                                               prev_unpruned,
+                                                               current_timestamps_list,
+                                                               weight_upper_bound);
 
+            // compute d_t for this timestamp and the next one
+            for (const auto row : util::irange<std::size_t>(0UL, prev_unpruned.size()))
+            {
+                const auto s = prev_unpruned[row];
                 for (const auto s_prime : util::irange<std::size_t>(0UL, current_viterbi.size()))
                 {
-                    const double emission_pr = emission_log_probabilities[t][s_prime];
+                    const double emission_pr = current_emissions[s_prime];
                     double new_value = prev_viterbi[s] + emission_pr;
                     if (current_viterbi[s_prime] > new_value)
                     {
                         continue;
                     }
 
-                    double network_distance =
-                        getNetworkDistance(engine_working_data,
-                                           facade,
-                                           forward_heap,
-                                           reverse_heap,
-                                           prev_unbroken_timestamps_list[s].phantom_node,
-                                           current_timestamps_list[s_prime].phantom_node,
-                                           weight_upper_bound);
+                    const double network_distance =
+                        network_distances[row * current_viterbi.size() + s_prime];
 
                     // get distance diff between loc1/2 and locs/s_prime
                     const auto d_t = std::abs(network_distance - haversine_distance);
@@ -333,19 +367,18 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
         }
 
         // loop through the columns, and only compare the last entry
-        const auto max_element_iter =
-            std::max_element(model.viterbi[parent_timestamp_index].begin(),
-                             model.viterbi[parent_timestamp_index].end());
+        const auto last_viterbi = model.Viterbi(parent_timestamp_index);
+        const auto max_element_iter = std::max_element(last_viterbi.begin(), last_viterbi.end());
 
-        std::size_t parent_candidate_index =
-            std::distance(model.viterbi[parent_timestamp_index].begin(), max_element_iter);
+        std::size_t parent_candidate_index = std::distance(last_viterbi.begin(), max_element_iter);
 
         std::deque<std::pair<std::size_t, std::size_t>> reconstructed_indices;
         while (parent_timestamp_index > sub_matching_begin)
         {
             reconstructed_indices.emplace_front(parent_timestamp_index, parent_candidate_index);
-            model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
-            const auto &next = model.parents[parent_timestamp_index][parent_candidate_index];
+            const auto state = model.State(parent_timestamp_index, parent_candidate_index);
+            model.viterbi_reachable[state] = true;
+            const auto &next = model.parents[state];
             // make sure we can never get stuck in this loop
             if (parent_timestamp_index == next.first)
             {
@@ -355,7 +388,7 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
             parent_candidate_index = next.second;
         }
         reconstructed_indices.emplace_front(parent_timestamp_index, parent_candidate_index);
-        model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
+        model.viterbi_reachable[model.State(parent_timestamp_index, parent_candidate_index)] = true;
         if (reconstructed_indices.size() < 2)
         {
             sub_matching_begin = sub_matching_end;
@@ -364,23 +397,24 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
 
         // fill viterbi reachability matrix
         for (const auto s_last :
-             util::irange<std::size_t>(0UL, model.viterbi[sub_matching_last_timestamp].size()))
+             util::irange<std::size_t>(0UL, model.NumberOfCandidates(sub_matching_last_timestamp)))
         {
             parent_timestamp_index = sub_matching_last_timestamp;
             parent_candidate_index = s_last;
             while (parent_timestamp_index > sub_matching_begin)
             {
-                if (model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] ||
-                    model.pruned[parent_timestamp_index][parent_candidate_index])
+                const auto state = model.State(parent_timestamp_index, parent_candidate_index);
+                if (model.viterbi_reachable[state] || model.pruned[state])
                 {
                     break;
                 }
-                model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
-                const auto &next = model.parents[parent_timestamp_index][parent_candidate_index];
+                model.viterbi_reachable[state] = true;
+                const auto &next = model.parents[state];
                 parent_timestamp_index = next.first;
                 parent_candidate_index = next.second;
             }
-            model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
+            model.viterbi_reachable[model.State(parent_timestamp_index, parent_candidate_index)] =
+                true;
         }
 
         auto matching_distance = 0.0;
@@ -394,22 +428,27 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
 
             matching.indices.push_back(timestamp_index);
             matching.nodes.push_back(candidates_list[timestamp_index][location_index].phantom_node);
-            auto const routes_count =
-                std::accumulate(model.viterbi_reachable[timestamp_index].begin(),
-                                model.viterbi_reachable[timestamp_index].end(),
-                                0);
+            const auto reachable = model.ViterbiReachable(timestamp_index);
+            auto const routes_count = std::accumulate(reachable.begin(), reachable.end(), 0);
             BOOST_ASSERT(routes_count > 0);
             // we don't count the current route in the "alternatives_count" parameter
             matching.alternatives_count.push_back(routes_count - 1);
-            matching_distance += model.path_distances[timestamp_index][location_index];
+            matching_distance += model.path_distances[model.State(timestamp_index, location_index)];
         }
-        util::for_each_pair(
-            reconstructed_indices,
-            [&trace_distance, &trace_coordinates](const std::pair<std::size_t, std::size_t> &prev,
-                                                  const std::pair<std::size_t, std::size_t> &curr) {
-                trace_distance += util::coordinate_calculation::haversineDistance(
-                    trace_coordinates[prev.first], trace_coordinates[curr.first]);
-            });
+        std::vector<util::Coordinate> matched_coordinates;
+        matched_coordinates.reserve(reconstructed_indices.size());
+        for (const auto &idx : reconstructed_indices)
+        {
+            matched_coordinates.push_back(trace_coordinates[idx.first]);
+        }
+        std::vector<double> trace_segment_distances(
+            matched_coordinates.empty() ? 0 : matched_coordinates.size() - 1);
+        util::coordinate_calculation::haversineDistances(matched_coordinates.data(),
+                                                         matched_coordinates.data() + 1,
+                                                         trace_segment_distances.size(),
+                                                         trace_segment_distances.data());
+        trace_distance = std::accumulate(
+            trace_segment_distances.begin(), trace_segment_distances.end(), trace_distance);
 
         matching.confidence = confidence(trace_distance, matching_distance);
 
@@ -419,6 +458,347 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
 
     return sub_matchings;
 }
+}
+
+template <typename Algorithm>
+map_matching::SubMatching
+extendMapMatching(SearchEngineData<Algorithm> &engine_working_data,
+                  const DataFacade<Algorithm> &facade,
+                  map_matching::MatchingSession &session,
+                  const CandidateLists &candidates_list,
+                  const std::vector<util::Coordinate> &trace_coordinates,
+                  const std::vector<unsigned> &trace_timestamps,
+                  const std::vector<boost::optional<double>> &trace_gps_precision,
+                  const bool allow_splitting)
+{
+    map_matching::MatchingConfidence confidence;
+    map_matching::EmissionLogProbability default_emission_log_probability(DEFAULT_GPS_PRECISION);
+    map_matching::TransitionLogProbability transition_log_probability(MATCHING_BETA);
+
+    BOOST_ASSERT(candidates_list.size() == trace_coordinates.size());
+    BOOST_ASSERT(trace_timestamps.empty() || trace_timestamps.size() == trace_coordinates.size());
+
+    // The states of the frontier the request starts from and of every coordinate that moved it,
+    // the parents of a layer are candidates of the one before
+    struct Layer
+    {
+        unsigned index;
+        const CandidateList *candidates;
+        util::Coordinate coordinate;
+        std::vector<double> viterbi;
+        std::vector<std::size_t> parents;
+        std::vector<double> path_distances;
+    };
+    std::vector<Layer> layers;
+    if (!session.Empty())
+    {
+        const auto num_candidates = session.candidates.size();
+        layers.push_back(
+            Layer{map_matching::FRONTIER_INDEX,
+                  &session.candidates,
+                  session.coordinate,
+                  session.viterbi,
+                  std::vector<std::size_t>(num_candidates, map_matching::INVALID_STATE),
+                  std::vector<double>(num_candidates, 0.)});
+    }
+
+    for (const auto t : util::irange<std::size_t>(0UL, candidates_list.size()))
+    {
+        const auto &candidates = candidates_list[t];
+        if (candidates.empty())
+        {
+            ++session.broken_steps;
+            continue;
+        }
+
+        std::vector<double> emissions(candidates.size());
+        std::transform(candidates.begin(),
+                       candidates.end(),
+                       emissions.begin(),
+                       [](const PhantomNodeWithDistance &candidate) { return candidate.distance; });
+        if (!trace_gps_precision.empty() && trace_gps_precision[t])
+        {
+            map_matching::EmissionLogProbability emission_log_probability(*trace_gps_precision[t]);
+            emission_log_probability(emissions.data(), emissions.data() + emissions.size());
+        }
+        else
+        {
+            default_emission_log_probability(emissions.data(), emissions.data() + emissions.size());
+        }
+
+        const bool use_timestamps = !trace_timestamps.empty() && session.timestamp;
+        const auto step_time = use_timestamps ? trace_timestamps[t] - *session.timestamp : 1u;
+        const auto max_distance_delta =
+            use_timestamps ? step_time * facade.GetMapMatchingMaxSpeed() : MAX_DISTANCE_DELTA;
+        const bool gap_in_trace = [&] {
+            if (layers.empty())
+            {
+                return true;
+            }
+            if (use_timestamps && allow_splitting && !session.sample_times.empty())
+            {
+                std::vector<unsigned> sample_times(session.sample_times.begin(),
+                                                   session.sample_times.end());
+                const auto median = sample_times.begin() + sample_times.size() / 2;
+                std::nth_element(sample_times.begin(), median, sample_times.end());
+                return step_time > std::max(1u, *median) * MAX_BROKEN_STATES;
+            }
+            return session.broken_steps + 1 > MAX_BROKEN_STATES;
+        }();
+
+        Layer layer{static_cast<unsigned>(t),
+                    &candidates,
+                    trace_coordinates[t],
+                    std::vector<double>(candidates.size(), map_matching::IMPOSSIBLE_LOG_PROB),
+                    std::vector<std::size_t>(candidates.size(), map_matching::INVALID_STATE),
+                    std::vector<double>(candidates.size(), 0.)};
+
+        if (gap_in_trace)
+        {
+            // a new path starts at the coordinate
+            layer.viterbi = emissions;
+        }
+        else
+        {
+            const auto &prev = layers.back();
+            const auto haversine_distance =
+                util::coordinate_calculation::haversineDistance(prev.coordinate, layer.coordinate);
+            // assumes minumum of 4 m/s
+            const EdgeWeight weight_upper_bound =
+                ((haversine_distance + max_distance_delta) / 4.) * facade.GetWeightMultiplier();
+
+            std::vector<std::size_t> prev_unpruned;
+            for (const auto s : util::irange<std::size_t>(0UL, prev.viterbi.size()))
+            {
+                if (prev.viterbi[s] >= map_matching::MINIMAL_LOG_PROB)
+                {
+                    prev_unpruned.push_back(s);
+                }
+            }
+            const auto network_distances = getNetworkDistances(engine_working_data,
+                                                               facade,
+                                                               *prev.candidates,
+                                                               prev_unpruned,
+                                                               candidates,
+                                                               weight_upper_bound);
+
+            for (const auto row : util::irange<std::size_t>(0UL, prev_unpruned.size()))
+            {
+                const auto s = prev_unpruned[row];
+                for (const auto s_prime : util::irange<std::size_t>(0UL, candidates.size()))
+                {
+                    double new_value = prev.viterbi[s] + emissions[s_prime];
+                    if (layer.viterbi[s_prime] > new_value)
+                    {
+                        continue;
+                    }
+
+                    const double network_distance =
+                        network_distances[row * candidates.size() + s_prime];
+                    const auto d_t = std::abs(network_distance - haversine_distance);
+                    if (d_t >= max_distance_delta)
+                    {
+                        continue;
+                    }
+
+                    new_value += transition_log_probability(d_t);
+                    if (new_value > layer.viterbi[s_prime])
+                    {
+                        layer.viterbi[s_prime] = new_value;
+                        layer.parents[s_prime] = s;
+                        layer.path_distances[s_prime] = network_distance;
+                    }
+                }
+            }
+        }
+
+        const auto best = std::max_element(layer.viterbi.begin(), layer.viterbi.end());
+        if (*best < map_matching::MINIMAL_LOG_PROB)
+        {
+            ++session.broken_steps;
+            continue;
+        }
+
+        if (!gap_in_trace && use_timestamps)
+        {
+            session.sample_times.push_back(step_time);
+            if (session.sample_times.size() > SESSION_SAMPLE_TIMES)
+            {
+                session.sample_times.pop_front();
+            }
+        }
+        session.coordinate = trace_coordinates[t];
+        session.timestamp = trace_timestamps.empty() ? boost::none
+                                                     : boost::make_optional(trace_timestamps[t]);
+        session.broken_steps = 0;
+
+        // the log probabilities of long traces would only ever decrease, only their differences
+        // matter
+        const auto best_value = *best;
+        for (auto &value : layer.viterbi)
+        {
+            value -= best_value;
+        }
+        layers.push_back(std::move(layer));
+    }
+
+    map_matching::SubMatching matching;
+    if (layers.empty() || layers.back().index == map_matching::FRONTIER_INDEX)
+    {
+        return matching;
+    }
+
+    // follow the best path back from the most probable candidate of the new frontier
+    std::vector<std::size_t> path;
+    const auto &last_viterbi = layers.back().viterbi;
+    auto candidate = static_cast<std::size_t>(std::distance(
+        last_viterbi.begin(), std::max_element(last_viterbi.begin(), last_viterbi.end())));
+    auto layer = layers.size() - 1;
+    while (true)
+    {
+        path.push_back(candidate);
+        const auto parent = layers[layer].parents[candidate];
+        if (parent == map_matching::INVALID_STATE)
+        {
+            break;
+        }
+        BOOST_ASSERT(layer > 0);
+        candidate = parent;
+        --layer;
+    }
+    std::reverse(path.begin(), path.end());
+
+    auto matching_distance = 0.0;
+    auto trace_distance = 0.0;
+    for (const auto step : util::irange<std::size_t>(0UL, path.size()))
+    {
+        const auto &path_layer = layers[layer + step];
+        const auto s = path[step];
+        matching.nodes.push_back((*path_layer.candidates)[s].phantom_node);
+        matching.indices.push_back(path_layer.index);
+        const auto routes_count = std::count_if(
+            path_layer.viterbi.begin(), path_layer.viterbi.end(), [](const double value) {
+                return value >= map_matching::MINIMAL_LOG_PROB;
+            });
+        matching.alternatives_count.push_back(routes_count - 1);
+        if (step > 0)
+        {
+            matching_distance += path_layer.path_distances[s];
+            trace_distance += util::coordinate_calculation::haversineDistance(
+                layers[layer + step - 1].coordinate, path_layer.coordinate);
+        }
+    }
+    matching.confidence = confidence(trace_distance, matching_distance);
+
+    session.candidates = *layers.back().candidates;
+    session.viterbi = std::move(layers.back().viterbi);
+
+    return matching;
+}
+
+template <typename Algorithm>
+SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
+                            const DataFacade<Algorithm> &facade,
+                            const CandidateLists &candidates_list,
+                            const std::vector<util::Coordinate> &trace_coordinates,
+                            const std::vector<unsigned> &trace_timestamps,
+                            const std::vector<boost::optional<double>> &trace_gps_precision,
+                            const bool allow_splitting,
+                            const bool parallel)
+{
+    BOOST_ASSERT(candidates_list.size() == trace_coordinates.size());
+    BOOST_ASSERT(candidates_list.size() > 1);
+
+    const bool use_timestamps = trace_timestamps.size() > 1;
+    const auto median_sample_time =
+        use_timestamps ? std::max(1u, getMedianSampleTime(trace_timestamps)) : 1u;
+
+    // A time gap larger than the sweep bridges splits the trace for good: the sweep starts over
+    // after it and nothing before the gap depends on what comes after. The parts in between can
+    // be matched on their own.
+    std::vector<std::size_t> chunk_begins = {0};
+    if (parallel && use_timestamps && allow_splitting)
+    {
+        const auto max_broken_time = median_sample_time * MAX_BROKEN_STATES;
+        for (const auto t : util::irange<std::size_t>(1UL, trace_timestamps.size()))
+        {
+            if (trace_timestamps[t] - trace_timestamps[t - 1] > max_broken_time)
+            {
+                chunk_begins.push_back(t);
+            }
+        }
+    }
+    if (chunk_begins.size() == 1)
+    {
+        return matchTrace(engine_working_data,
+                          facade,
+                          candidates_list,
+                          trace_coordinates,
+                          trace_timestamps,
+                          trace_gps_precision,
+                          allow_splitting,
+                          median_sample_time);
+    }
+    chunk_begins.push_back(candidates_list.size());
+
+    const auto slice = [&chunk_begins](const auto &values, const std::size_t chunk) {
+        using Values = std::remove_const_t<std::remove_reference_t<decltype(values)>>;
+        if (values.empty())
+        {
+            return Values{};
+        }
+        return Values(values.begin() + chunk_begins[chunk],
+                      values.begin() + chunk_begins[chunk + 1]);
+    };
+
+    // every task searches with heaps of its own, leased from the pool of the engine
+    tbb::enumerable_thread_specific<std::unique_ptr<SearchEngineData<Algorithm>>> task_data(
+        [&engine_working_data] {
+            return std::make_unique<SearchEngineData<Algorithm>>(
+                engine_working_data.GetHeapPool(), engine_working_data.deadline);
+        });
+
+    const auto number_of_chunks = chunk_begins.size() - 1;
+    std::vector<SubMatchingList> chunk_matchings(number_of_chunks);
+    const auto trace = SearchTracing::Current();
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, number_of_chunks, 1),
+        [&](const tbb::blocked_range<std::size_t> &range) {
+            SearchTracing::WorkerScope trace_scope(trace);
+            auto &data = *task_data.local();
+            for (auto chunk = range.begin(); chunk != range.end(); ++chunk)
+            {
+                // a single point never matches
+                if (chunk_begins[chunk + 1] - chunk_begins[chunk] < 2)
+                {
+                    continue;
+                }
+
+                chunk_matchings[chunk] = matchTrace(data,
+                                                    facade,
+                                                    slice(candidates_list, chunk),
+                                                    slice(trace_coordinates, chunk),
+                                                    slice(trace_timestamps, chunk),
+                                                    slice(trace_gps_precision, chunk),
+                                                    allow_splitting,
+                                                    median_sample_time);
+                for (auto &matching : chunk_matchings[chunk])
+                {
+                    for (auto &index : matching.indices)
+                    {
+                        index += static_cast<unsigned>(chunk_begins[chunk]);
+                    }
+                }
+            }
+        });
+
+    SubMatchingList sub_matchings;
+    for (auto &matchings : chunk_matchings)
+    {
+        std::move(matchings.begin(), matchings.end(), std::back_inserter(sub_matchings));
+    }
+    return sub_matchings;
+}
 
 template SubMatchingList
 mapMatching(SearchEngineData<ch::Algorithm> &engine_working_data,
@@ -427,7 +807,8 @@ mapMatching(SearchEngineData<ch::Algorithm> &engine_working_data,
             const std::vector<util::Coordinate> &trace_coordinates,
             const std::vector<unsigned> &trace_timestamps,
             const std::vector<boost::optional<double>> &trace_gps_precision,
-            const bool allow_splitting);
+            const bool allow_splitting,
+            const bool parallel);
 
 template SubMatchingList
 mapMatching(SearchEngineData<corech::Algorithm> &engine_working_data,
@@ -436,7 +817,8 @@ mapMatching(SearchEngineData<corech::Algorithm> &engine_working_data,
             const std::vector<util::Coordinate> &trace_coordinates,
             const std::vector<unsigned> &trace_timestamps,
             const std::vector<boost::optional<double>> &trace_gps_precision,
-            const bool allow_splitting);
+            const bool allow_splitting,
+            const bool parallel);
 
 template SubMatchingList
 mapMatching(SearchEngineData<mld::Algorithm> &engine_working_data,
@@ -445,7 +827,38 @@ mapMatching(SearchEngineData<mld::Algorithm> &engine_working_data,
             const std::vector<util::Coordinate> &trace_coordinates,
             const std::vector<unsigned> &trace_timestamps,
             const std::vector<boost::optional<double>> &trace_gps_precision,
-            const bool allow_splitting);
+            const bool allow_splitting,
+            const bool parallel);
+
+template map_matching::SubMatching
+extendMapMatching(SearchEngineData<ch::Algorithm> &engine_working_data,
+                  const DataFacade<ch::Algorithm> &facade,
+                  map_matching::MatchingSession &session,
+                  const CandidateLists &candidates_list,
+                  const std::vector<util::Coordinate> &trace_coordinates,
+                  const std::vector<unsigned> &trace_timestamps,
+                  const std::vector<boost::optional<double>> &trace_gps_precision,
+                  const bool allow_splitting);
+
+template map_matching::SubMatching
+extendMapMatching(SearchEngineData<corech::Algorithm> &engine_working_data,
+                  const DataFacade<corech::Algorithm> &facade,
+                  map_matching::MatchingSession &session,
+                  const CandidateLists &candidates_list,
+                  const std::vector<util::Coordinate> &trace_coordinates,
+                  const std::vector<unsigned> &trace_timestamps,
+                  const std::vector<boost::optional<double>> &trace_gps_precision,
+                  const bool allow_splitting);
+
+template map_matching::SubMatching
+extendMapMatching(SearchEngineData<mld::Algorithm> &engine_working_data,
+                  const DataFacade<mld::Algorithm> &facade,
+                  map_matching::MatchingSession &session,
+                  const CandidateLists &candidates_list,
+                  const std::vector<util::Coordinate> &trace_coordinates,
+                  const std::vector<unsigned> &trace_timestamps,
+                  const std::vector<boost::optional<double>> &trace_gps_precision,
+                  const bool allow_splitting);
 
 } // namespace routing_algorithms
 } // namespace engine
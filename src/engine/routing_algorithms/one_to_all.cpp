@@ -0,0 +1,205 @@
+#include "engine/routing_algorithms/one_to_all.hpp"
+#include "engine/routing_algorithms/routing_base_ch.hpp"
+#include "engine/routing_algorithms/routing_base_mld.hpp"
+#include "engine/search_trace.hpp"
+
+#include <boost/assert.hpp>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+namespace
+{
+// Numbers the nodes in depth first post-order over the downward edges, like the restricted graph
+// of RPHAST tables but for the whole hierarchy: a node comes after all nodes above it.
+SweepOrderCache::SweepOrder computeSweepOrder(const DataFacade<ch::Algorithm> &facade)
+{
+    const auto number_of_nodes = facade.GetNumberOfNodes();
+    SweepOrderCache::SweepOrder order;
+    order.reserve(number_of_nodes);
+
+    std::vector<bool> visited(number_of_nodes, false);
+    // the nodes on the path from the root to the top of the stack with their next edge
+    std::vector<std::pair<NodeID, EdgeID>> stack;
+    for (NodeID root = 0; root < number_of_nodes; ++root)
+    {
+        if (visited[root])
+        {
+            continue;
+        }
+        visited[root] = true;
+        stack.emplace_back(root, facade.GetAdjacentEdgeRange(root).front());
+
+        while (!stack.empty())
+        {
+            const NodeID node = stack.back().first;
+            const EdgeID edge = stack.back().second;
+            if (edge == *facade.GetAdjacentEdgeRange(node).end())
+            {
+                order.push_back(node);
+                stack.pop_back();
+                continue;
+            }
+            stack.back().second++;
+
+            const NodeID to = facade.GetTarget(edge);
+            if (facade.GetEdgeData(edge).backward && to != node && !visited[to])
+            {
+                visited[to] = true;
+                stack.emplace_back(to, facade.GetAdjacentEdgeRange(to).front());
+            }
+        }
+    }
+
+    return order;
+}
+}
+
+// PHAST: the upward search of the source settles the top of the hierarchy, one sweep pulls the
+// weights down to all other nodes. The sweep touches every edge no matter how small the bound
+// is, but it is a linear scan and there is nothing to prune a CH search by.
+std::vector<ReachedNode> oneToAllSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                        const DataFacade<ch::Algorithm> &facade,
+                                        const PhantomNode &source,
+                                        const EdgeDuration max_duration)
+{
+    const auto number_of_nodes = facade.GetNumberOfNodes();
+    const auto order = engine_working_data.sweep_order_cache
+                           ? engine_working_data.sweep_order_cache.Get(
+                                 [&facade]() { return computeSweepOrder(facade); })
+                           : std::make_shared<const SweepOrderCache::SweepOrder>(
+                                 computeSweepOrder(facade));
+    BOOST_ASSERT(order->size() == number_of_nodes);
+
+    std::vector<EdgeWeight> weights(number_of_nodes, INVALID_EDGE_WEIGHT);
+    std::vector<EdgeWeight> durations(number_of_nodes, MAXIMAL_EDGE_DURATION);
+
+    engine_working_data.InitializeOrClearManyToManyHeaps(number_of_nodes);
+    auto &query_heap = *engine_working_data.many_to_many_heap;
+    insertSourceInHeap(query_heap, source, PhantomDistances{});
+    while (!query_heap.Empty())
+    {
+        engine_working_data.deadline.Check();
+        SearchTracing::Settled(query_heap.Size());
+        const NodeID node = query_heap.DeleteMin();
+        const EdgeWeight weight = query_heap.GetKey(node);
+        const EdgeWeight duration = query_heap.GetData(node).duration;
+        weights[node] = weight;
+        durations[node] = duration;
+
+        // stalled nodes keep their weight, the sweep corrects it
+        if (ch::stallAtNode<FORWARD_DIRECTION>(facade, node, weight, query_heap))
+        {
+            continue;
+        }
+
+        for (const auto edge : facade.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = facade.GetEdgeData(edge);
+            if (data.forward)
+            {
+                SearchTracing::Relaxed();
+                const NodeID to = facade.GetTarget(edge);
+                const EdgeWeight to_weight = weight + data.weight;
+                const EdgeWeight to_duration = duration + data.duration;
+                if (!query_heap.WasInserted(to))
+                {
+                    query_heap.Insert(to, to_weight, {node, to_duration, 0});
+                }
+                else if (to_weight < query_heap.GetKey(to))
+                {
+                    query_heap.GetData(to) = {node, to_duration, 0};
+                    query_heap.DecreaseKey(to, to_weight);
+                }
+            }
+        }
+    }
+
+    for (const auto node : *order)
+    {
+        engine_working_data.deadline.Check();
+        for (const auto edge : facade.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = facade.GetEdgeData(edge);
+            const NodeID to = facade.GetTarget(edge);
+            if (data.backward && to != node && weights[to] != INVALID_EDGE_WEIGHT &&
+                weights[to] + data.weight < weights[node])
+            {
+                weights[node] = weights[to] + data.weight;
+                durations[node] = durations[to] + data.duration;
+            }
+        }
+    }
+
+    std::vector<ReachedNode> reached;
+    for (NodeID node = 0; node < number_of_nodes; ++node)
+    {
+        if (weights[node] != INVALID_EDGE_WEIGHT && durations[node] <= max_duration)
+        {
+            reached.push_back({node, weights[node], durations[node]});
+        }
+    }
+    return reached;
+}
+
+// The cells of the overlay do not help: every node within the bound is part of the result, so
+// the search has to settle all of them on the base graph. A settled node beyond the bound is
+// not expanded, nodes behind it are only reported if a heavier path reaches them in time.
+std::vector<ReachedNode> oneToAllSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                        const DataFacade<mld::Algorithm> &facade,
+                                        const PhantomNode &source,
+                                        const EdgeDuration max_duration)
+{
+    engine_working_data.InitializeOrClearManyToManyHeaps(facade.GetNumberOfNodes());
+    auto &query_heap = *engine_working_data.many_to_many_heap;
+    insertSourceInHeap(query_heap, source, PhantomDistances{});
+
+    std::vector<ReachedNode> reached;
+    while (!query_heap.Empty())
+    {
+        engine_working_data.deadline.Check();
+        SearchTracing::Settled(query_heap.Size());
+        const NodeID node = query_heap.DeleteMin();
+        const EdgeWeight weight = query_heap.GetKey(node);
+        const EdgeWeight duration = query_heap.GetData(node).duration;
+        if (duration > max_duration)
+        {
+            continue;
+        }
+        reached.push_back({node, weight, duration});
+
+        for (const auto edge : facade.GetBorderEdgeRange(0, node))
+        {
+            const auto &data = facade.GetEdgeData(edge);
+            if (data.forward)
+            {
+                SearchTracing::Relaxed();
+                const NodeID to = facade.GetTarget(edge);
+                const EdgeWeight to_weight = weight + data.weight;
+                const EdgeWeight to_duration = duration + data.duration;
+                if (!query_heap.WasInserted(to))
+                {
+                    query_heap.Insert(to, to_weight, {node, false, to_duration, 0});
+                }
+                else if (to_weight < query_heap.GetKey(to))
+                {
+                    query_heap.GetData(to) = {node, false, to_duration, 0};
+                    query_heap.DecreaseKey(to, to_weight);
+                }
+            }
+        }
+    }
+    return reached;
+}
+
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
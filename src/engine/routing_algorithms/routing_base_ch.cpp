@@ -15,14 +15,17 @@ namespace ch
  * @param from the node the CH edge starts at
  * @param to the node the CH edge finishes at
  * @param unpacked_path the sequence of original NodeIDs that make up the expanded CH edge
+ * @param unpacking_cache the cache to look the edge up in if it is a shortcut
  */
 void unpackEdge(const DataFacade<Algorithm> &facade,
                 const NodeID from,
                 const NodeID to,
-                std::vector<NodeID> &unpacked_path)
+                std::vector<NodeID> &unpacked_path,
+                const UnpackingCache::Handle &unpacking_cache)
 {
     std::array<NodeID, 2> path{{from, to}};
     unpackPath(facade,
+               unpacking_cache,
                path.begin(),
                path.end(),
                [&unpacked_path](const std::pair<NodeID, NodeID> &edge, const auto & /* data */) {
@@ -71,7 +74,7 @@ void retrievePackedPathFromSingleHeap(const SearchEngineData<Algorithm>::QueryHe
 // && source_phantom.GetForwardWeightPlusOffset() > target_phantom.GetForwardWeightPlusOffset())
 // requires
 // a force loop, if the heaps have been initialized with positive offsets.
-void search(SearchEngineData<Algorithm> & /*engine_working_data*/,
+void search(SearchEngineData<Algorithm> &engine_working_data,
             const DataFacade<Algorithm> &facade,
             SearchEngineData<Algorithm>::QueryHeap &forward_heap,
             SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
@@ -100,6 +103,7 @@ void search(SearchEngineData<Algorithm> & /*engine_working_data*/,
     // run two-Target Dijkstra routing step.
     while (0 < (forward_heap.Size() + reverse_heap.Size()))
     {
+        engine_working_data.deadline.Check();
         if (!forward_heap.Empty())
         {
             routingStep<FORWARD_DIRECTION>(facade,
@@ -186,7 +190,8 @@ double getNetworkDistance(SearchEngineData<Algorithm> &engine_working_data,
                packed_path.begin(),
                packed_path.end(),
                {source_phantom, target_phantom},
-               unpacked_path);
+               unpacked_path,
+               engine_working_data.unpacking_cache);
 
     return getPathDistance(facade, unpacked_path, source_phantom, target_phantom);
 }
@@ -229,10 +234,12 @@ void search(SearchEngineData<Algorithm> &engine_working_data,
     // run two-Target Dijkstra routing step.
     while (0 < (forward_heap.Size() + reverse_heap.Size()))
     {
+        engine_working_data.deadline.Check();
         if (!forward_heap.Empty())
         {
             if (facade.IsCoreNode(forward_heap.Min()))
             {
+                SearchTracing::Settled(forward_heap.Size());
                 const NodeID node = forward_heap.DeleteMin();
                 const EdgeWeight key = forward_heap.GetKey(node);
                 forward_entry_points.emplace_back(node, key, forward_heap.GetData(node).parent);
@@ -253,6 +260,7 @@ void search(SearchEngineData<Algorithm> &engine_working_data,
         {
             if (facade.IsCoreNode(reverse_heap.Min()))
             {
+                SearchTracing::Settled(reverse_heap.Size());
                 const NodeID node = reverse_heap.DeleteMin();
                 const EdgeWeight key = reverse_heap.GetKey(node);
                 reverse_entry_points.emplace_back(node, key, reverse_heap.GetData(node).parent);
@@ -280,7 +288,7 @@ void search(SearchEngineData<Algorithm> &engine_working_data,
         core_heap.Insert(id, weight, parent);
     };
 
-    engine_working_data.InitializeOrClearSecondThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearSecondHeaps(facade.GetNumberOfNodes());
 
     auto &forward_core_heap = *engine_working_data.forward_heap_2;
     auto &reverse_core_heap = *engine_working_data.reverse_heap_2;
@@ -307,10 +315,13 @@ void search(SearchEngineData<Algorithm> &engine_working_data,
     }
     BOOST_ASSERT(min_core_edge_offset <= 0);
 
-    // run two-target Dijkstra routing step on core with termination criterion
+    // run two-target Dijkstra routing step on core with termination criterion. The core is not
+    // contracted, a Dijkstra search never reaches a node it settles lighter through a neighbour:
+    // stall checks would scan the incoming edges of every core node for nothing
     while (0 < forward_core_heap.Size() && 0 < reverse_core_heap.Size() &&
            weight > (forward_core_heap.MinKey() + reverse_core_heap.MinKey()))
     {
+        engine_working_data.deadline.Check();
         ch::routingStep<FORWARD_DIRECTION, ch::DISABLE_STALLING>(facade,
                                                                  forward_core_heap,
                                                                  reverse_core_heap,
@@ -417,7 +428,8 @@ double getNetworkDistance(SearchEngineData<Algorithm> &engine_working_data,
                    packed_path.begin(),
                    packed_path.end(),
                    {source_phantom, target_phantom},
-                   unpacked_path);
+                   unpacked_path,
+                   engine_working_data.unpacking_cache);
 
     return getPathDistance(facade, unpacked_path, source_phantom, target_phantom);
 }
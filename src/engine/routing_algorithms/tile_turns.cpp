@@ -1,5 +1,10 @@
 #include "engine/routing_algorithms/tile_turns.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
 namespace osrm
 {
 namespace engine
@@ -9,89 +14,122 @@ namespace routing_algorithms
 
 namespace
 {
-// Struct to hold info on all the EdgeBasedNodes that are visible in our tile
-// When we create these, we insure that (source, target) and packed_geometry_id
-// are all pointed in the same direction.
-struct EdgeBasedNodeInfo
+// A directed segment of the node based graph that is visible in our tile
+struct SegmentData
 {
-    bool is_geometry_forward; // Is the geometry forward or reverse?
-    unsigned packed_geometry_id;
+    NodeID source_node;
+    NodeID target_node;
+    NodeID edge_based_node_id;
 };
 
-struct SegmentData
+// The edge-based edge that represents the turn from approach_node onto exit_node
+struct TurnEdge
 {
-    NodeID target_node;
-    EdgeID edge_based_node_id;
+    NodeID approach_node;
+    NodeID exit_node;
+    NodeID turn_id;
 };
 
+// Collects the turns between the edge-based nodes of a tile. find_edges is called once with the
+// sorted nodes of the tile and adds a TurnEdge for every turn between them, scanning the adjacency
+// of every node once and adding the turns of a pair in order of preference. The result is sorted
+// by (approach_node, exit_node) with only the preferred turn of every pair.
+template <typename edge_extractor>
+std::vector<TurnEdge> getTurnEdges(const std::vector<NodeID> &tile_nodes,
+                                   edge_extractor const &find_edges)
+{
+    std::vector<TurnEdge> turn_edges;
+    turn_edges.reserve(tile_nodes.size() * 4);
+    find_edges(tile_nodes, turn_edges);
+
+    // stable, so the first turn found for a pair is the preferred one
+    std::stable_sort(turn_edges.begin(), turn_edges.end(), [](const auto &lhs, const auto &rhs) {
+        return std::tie(lhs.approach_node, lhs.exit_node) <
+               std::tie(rhs.approach_node, rhs.exit_node);
+    });
+    turn_edges.erase(std::unique(turn_edges.begin(),
+                                 turn_edges.end(),
+                                 [](const auto &lhs, const auto &rhs) {
+                                     return lhs.approach_node == rhs.approach_node &&
+                                            lhs.exit_node == rhs.exit_node;
+                                 }),
+                     turn_edges.end());
+    return turn_edges;
+}
+
 template <typename edge_extractor, typename datafacade>
 std::vector<TurnData> generateTurns(const datafacade &facade,
                                     const std::vector<RTreeLeaf> &edges,
                                     const std::vector<std::size_t> &sorted_edge_indexes,
-                                    edge_extractor const &find_edge)
+                                    edge_extractor const &find_edges)
 {
-    // Lookup table for edge-based-nodes
-    std::unordered_map<NodeID, EdgeBasedNodeInfo> edge_based_node_info;
-    std::unordered_map<NodeID, std::vector<SegmentData>> directed_graph;
-
-    // Reserve enough space for unique edge-based-nodes on every edge.
-    // Only a tile with all unique edges will use this much, but
-    // it saves us a bunch of re-allocations during iteration.
-    directed_graph.reserve(edges.size() * 2);
-
-    const auto get_geometry_id = [&facade](auto edge) {
-        return facade.GetGeometryIndex(edge.forward_segment_id.id).id;
-    };
-
     // To build a tile, we can only rely on the r-tree to quickly find all data visible within the
     // tile itself. The Rtree returns a series of segments that may or may not offer turns
     // associated with them. To be able to extract turn penalties, we extract a node based graph
     // from our edge based representation.
+    std::vector<SegmentData> directed_graph;
+    directed_graph.reserve(edges.size() * 2);
     for (const auto &edge_index : sorted_edge_indexes)
     {
         const auto &edge = edges[edge_index];
         if (edge.forward_segment_id.enabled)
         {
-            // operator[] will construct an empty vector at [edge.u] if there is no value.
-            directed_graph[edge.u].push_back({edge.v, edge.forward_segment_id.id});
-            if (edge_based_node_info.count(edge.forward_segment_id.id) == 0)
-            {
-                edge_based_node_info[edge.forward_segment_id.id] = {true, get_geometry_id(edge)};
-            }
-            else
-            {
-                BOOST_ASSERT(edge_based_node_info[edge.forward_segment_id.id].is_geometry_forward ==
-                             true);
-                BOOST_ASSERT(edge_based_node_info[edge.forward_segment_id.id].packed_geometry_id ==
-                             get_geometry_id(edge));
-            }
+            directed_graph.push_back({edge.u, edge.v, edge.forward_segment_id.id});
         }
         if (edge.reverse_segment_id.enabled)
         {
-            directed_graph[edge.v].push_back({edge.u, edge.reverse_segment_id.id});
-            if (edge_based_node_info.count(edge.reverse_segment_id.id) == 0)
+            directed_graph.push_back({edge.v, edge.u, edge.reverse_segment_id.id});
+        }
+    }
+
+    // Make sure we traverse the startnodes in a consistent order to ensure identical PBF
+    // encoding on all platforms. Stable, the segments of a node keep the order of the r-tree.
+    std::stable_sort(
+        directed_graph.begin(), directed_graph.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.source_node < rhs.source_node;
+        });
+    const auto outgoing_segments = [&directed_graph](const NodeID node) {
+        struct ByNode
+        {
+            bool operator()(const SegmentData &segment, const NodeID node) const
             {
-                edge_based_node_info[edge.reverse_segment_id.id] = {false, get_geometry_id(edge)};
+                return segment.source_node < node;
             }
-            else
+            bool operator()(const NodeID node, const SegmentData &segment) const
             {
-                BOOST_ASSERT(edge_based_node_info[edge.reverse_segment_id.id].is_geometry_forward ==
-                             false);
-                BOOST_ASSERT(edge_based_node_info[edge.reverse_segment_id.id].packed_geometry_id ==
-                             get_geometry_id(edge));
+                return node < segment.source_node;
             }
-        }
-    }
+        };
+        return std::equal_range(directed_graph.begin(), directed_graph.end(), node, ByNode{});
+    };
 
-    // Make sure we traverse the startnodes in a consistent order
-    // to ensure identical PBF encoding on all platforms.
-    std::vector<NodeID> sorted_startnodes;
-    sorted_startnodes.reserve(directed_graph.size());
+    // All turns between the edge-based nodes of the tile, looked up in one pass
+    std::vector<NodeID> tile_nodes;
+    tile_nodes.reserve(directed_graph.size());
     std::transform(directed_graph.begin(),
                    directed_graph.end(),
-                   std::back_inserter(sorted_startnodes),
-                   [](auto const &node) { return node.first; });
-    std::sort(sorted_startnodes.begin(), sorted_startnodes.end());
+                   std::back_inserter(tile_nodes),
+                   [](const auto &segment) { return segment.edge_based_node_id; });
+    std::sort(tile_nodes.begin(), tile_nodes.end());
+    tile_nodes.erase(std::unique(tile_nodes.begin(), tile_nodes.end()), tile_nodes.end());
+    const auto turn_edges = getTurnEdges(tile_nodes, find_edges);
+
+    const auto find_turn = [&turn_edges](const NodeID approach_node, const NodeID exit_node) {
+        const auto turn = std::lower_bound(
+            turn_edges.begin(),
+            turn_edges.end(),
+            std::make_pair(approach_node, exit_node),
+            [](const TurnEdge &edge, const std::pair<NodeID, NodeID> &nodes) {
+                return std::tie(edge.approach_node, edge.exit_node) <
+                       std::tie(nodes.first, nodes.second);
+            });
+        if (turn == turn_edges.end() || turn->approach_node != approach_node ||
+            turn->exit_node != exit_node)
+        {
+            return SPECIAL_NODEID;
+        }
+        return turn->turn_id;
+    };
 
     std::vector<TurnData> all_turn_data;
 
@@ -101,123 +139,67 @@ std::vector<TurnData> generateTurns(const datafacade &facade,
     //         w
     //  uv is the "approach"
     //  vw is the "exit"
-    std::vector<EdgeWeight> approach_weight_vector;
-    std::vector<EdgeWeight> approach_duration_vector;
 
-    // Look at every node in the directed graph we created
-    for (const auto &startnode : sorted_startnodes)
+    // Look at every directed segment of the graph we created
+    for (const auto &approachedge : directed_graph)
     {
-        BOOST_ASSERT(directed_graph.find(startnode) != directed_graph.end());
-        const auto &nodedata = directed_graph.find(startnode)->second;
-        // For all the outgoing edges from the node
-        for (const auto &approachedge : nodedata)
+        // If the target of this edge has no outgoing segments, it's probably outside the tile,
+        // and the range is empty
+        const auto exit_edges = outgoing_segments(approachedge.target_node);
+
+        // For each of the outgoing edges from our target coordinate
+        for (auto exit_edge = exit_edges.first; exit_edge != exit_edges.second; ++exit_edge)
         {
-            // If the target of this edge doesn't exist in our directed
-            // graph, it's probably outside the tile, so we can skip it
-            if (directed_graph.count(approachedge.target_node) == 0)
+            // If the next edge has the same edge_based_node_id, then it's
+            // not a turn, so skip it
+            if (approachedge.edge_based_node_id == exit_edge->edge_based_node_id)
                 continue;
 
-            // For each of the outgoing edges from our target coordinate
-            for (const auto &exit_edge : directed_graph.find(approachedge.target_node)->second)
-            {
-                // If the next edge has the same edge_based_node_id, then it's
-                // not a turn, so skip it
-                if (approachedge.edge_based_node_id == exit_edge.edge_based_node_id)
-                    continue;
-
-                // Skip u-turns
-                if (startnode == exit_edge.target_node)
-                    continue;
-
-                // Find the connection between our source road and the target node
-                // Since we only want to find direct edges, we cannot check shortcut edges here.
-                // Otherwise we might find a forward edge even though a shorter backward edge
-                // exists (due to oneways).
-                //
-                // a > - > - > - b
-                // |             |
-                // |------ c ----|
-                //
-                // would offer a backward edge at `b` to `a` (due to the oneway from a to b)
-                // but could also offer a shortcut (b-c-a) from `b` to `a` which is longer.
-                EdgeID edge_based_edge_id =
-                    find_edge(approachedge.edge_based_node_id, exit_edge.edge_based_node_id);
-
-                if (edge_based_edge_id != SPECIAL_EDGEID)
-                {
-                    const auto &data = facade.GetEdgeData(edge_based_edge_id);
-
-                    // Now, calculate the sum of the weight of all the segments.
-                    if (edge_based_node_info.find(approachedge.edge_based_node_id)
-                            ->second.is_geometry_forward)
-                    {
-                        approach_weight_vector = facade.GetUncompressedForwardWeights(
-                            edge_based_node_info.find(approachedge.edge_based_node_id)
-                                ->second.packed_geometry_id);
-                        approach_duration_vector = facade.GetUncompressedForwardDurations(
-                            edge_based_node_info.find(approachedge.edge_based_node_id)
-                                ->second.packed_geometry_id);
-                    }
-                    else
-                    {
-                        approach_weight_vector = facade.GetUncompressedReverseWeights(
-                            edge_based_node_info.find(approachedge.edge_based_node_id)
-                                ->second.packed_geometry_id);
-                        approach_duration_vector = facade.GetUncompressedReverseDurations(
-                            edge_based_node_info.find(approachedge.edge_based_node_id)
-                                ->second.packed_geometry_id);
-                    }
-                    const auto sum_node_weight = std::accumulate(approach_weight_vector.begin(),
-                                                                 approach_weight_vector.end(),
-                                                                 EdgeWeight{0});
-                    const auto sum_node_duration = std::accumulate(approach_duration_vector.begin(),
-                                                                   approach_duration_vector.end(),
-                                                                   EdgeWeight{0});
-
-                    // The edge.weight is the whole edge weight, which includes the turn
-                    // cost.
-                    // The turn cost is the edge.weight minus the sum of the individual road
-                    // segment weights.  This might not be 100% accurate, because some
-                    // intersections include stop signs, traffic signals and other
-                    // penalties, but at this stage, we can't divide those out, so we just
-                    // treat the whole lot as the "turn cost" that we'll stick on the map.
-                    const auto turn_weight = data.weight - sum_node_weight;
-                    const auto turn_duration = data.duration - sum_node_duration;
-
-                    // Find the three nodes that make up the turn movement)
-                    const auto node_from = startnode;
-                    const auto node_via = approachedge.target_node;
-                    const auto node_to = exit_edge.target_node;
-
-                    const auto coord_from = facade.GetCoordinateOfNode(node_from);
-                    const auto coord_via = facade.GetCoordinateOfNode(node_via);
-                    const auto coord_to = facade.GetCoordinateOfNode(node_to);
-
-                    // Calculate the bearing that we approach the intersection at
-                    const auto angle_in = static_cast<int>(
-                        util::coordinate_calculation::bearing(coord_from, coord_via));
-
-                    const auto exit_bearing = static_cast<int>(
-                        util::coordinate_calculation::bearing(coord_via, coord_to));
+            // Skip u-turns
+            if (approachedge.source_node == exit_edge->target_node)
+                continue;
 
-                    // Figure out the angle of the turn
-                    auto turn_angle = exit_bearing - angle_in;
-                    while (turn_angle > 180)
-                    {
-                        turn_angle -= 360;
-                    }
-                    while (turn_angle < -180)
-                    {
-                        turn_angle += 360;
-                    }
+            const auto turn_id =
+                find_turn(approachedge.edge_based_node_id, exit_edge->edge_based_node_id);
+            if (turn_id == SPECIAL_NODEID)
+                continue;
 
-                    // Save everything we need to later add all the points to the tile.
-                    // We need the coordinate of the intersection, the angle in, the turn
-                    // angle and the turn cost.
-                    all_turn_data.push_back(
-                        TurnData{coord_via, angle_in, turn_angle, turn_weight, turn_duration});
-                }
+            // The turn cost is the penalty the edge-based edge adds on top of the weight of
+            // the approach segments. This might not be 100% accurate, because some
+            // intersections include stop signs, traffic signals and other penalties, but at
+            // this stage, we can't divide those out, so we just treat the whole lot as the
+            // "turn cost" that we'll stick on the map.
+            const EdgeWeight turn_weight = facade.GetWeightPenaltyForEdgeID(turn_id);
+            const EdgeWeight turn_duration = facade.GetDurationPenaltyForEdgeID(turn_id);
+
+            // Find the three nodes that make up the turn movement)
+            const auto coord_from = facade.GetCoordinateOfNode(approachedge.source_node);
+            const auto coord_via = facade.GetCoordinateOfNode(approachedge.target_node);
+            const auto coord_to = facade.GetCoordinateOfNode(exit_edge->target_node);
+
+            // Calculate the bearing that we approach the intersection at
+            const auto angle_in =
+                static_cast<int>(util::coordinate_calculation::bearing(coord_from, coord_via));
+
+            const auto exit_bearing =
+                static_cast<int>(util::coordinate_calculation::bearing(coord_via, coord_to));
+
+            // Figure out the angle of the turn
+            auto turn_angle = exit_bearing - angle_in;
+            while (turn_angle > 180)
+            {
+                turn_angle -= 360;
+            }
+            while (turn_angle < -180)
+            {
+                turn_angle += 360;
             }
+
+            // Save everything we need to later add all the points to the tile.
+            // We need the coordinate of the intersection, the angle in, the turn
+            // angle and the turn cost.
+            all_turn_data.push_back(
+                TurnData{coord_via, angle_in, turn_angle, turn_weight, turn_duration});
         }
     }
 
@@ -231,51 +213,65 @@ std::vector<TurnData> getTileTurns(const DataFacade<ch::Algorithm> &facade,
                                    const std::vector<RTreeLeaf> &edges,
                                    const std::vector<std::size_t> &sorted_edge_indexes)
 {
-    // Define how to find the representative edge between two edge based nodes for a CH
-    struct EdgeFinderCH
-    {
-        EdgeFinderCH(const DataFacade<ch::Algorithm> &facade) : facade(facade) {}
-        const DataFacade<ch::Algorithm> &facade;
-
-        EdgeID operator()(const NodeID approach_node, const NodeID exit_node) const
+    // Find the connections between our source road and the target node
+    // Since we only want to find direct edges, we cannot check shortcut edges here.
+    // Otherwise we might find a forward edge even though a shorter backward edge
+    // exists (due to oneways).
+    //
+    // a > - > - > - b
+    // |             |
+    // |------ c ----|
+    //
+    // would offer a backward edge at `b` to `a` (due to the oneway from a to b)
+    // but could also offer a shortcut (b-c-a) from `b` to `a` which is longer.
+    //
+    // Depending on how the graph is constructed, we might have to look for
+    // a backwards edge instead.  They're equivalent, just one is available for
+    // a forward routing search, and one is used for the backwards dijkstra
+    // steps. Forward edges are preferred, the smallest one of either kind is used.
+    const auto find_edges = [&facade](const std::vector<NodeID> &tile_nodes,
+                                      std::vector<TurnEdge> &turn_edges) {
+        struct Candidate
         {
-            // Find the connection between our source road and the target node
-            // Since we only want to find direct edges, we cannot check shortcut edges here.
-            // Otherwise we might find a forward edge even though a shorter backward edge
-            // exists (due to oneways).
-            //
-            // a > - > - > - b
-            // |             |
-            // |------ c ----|
-            //
-            // would offer a backward edge at `b` to `a` (due to the oneway from a to b)
-            // but could also offer a shortcut (b-c-a) from `b` to `a` which is longer.
-            EdgeID edge_id = facade.FindSmallestEdge(
-                approach_node, exit_node, [](const contractor::QueryEdge::EdgeData &data) {
-                    return data.forward && !data.shortcut;
-                });
-
-            // Depending on how the graph is constructed, we might have to look for
-            // a backwards edge instead.  They're equivalent, just one is available for
-            // a forward routing search, and one is used for the backwards dijkstra
-            // steps.  Their weight should be the same, we can use either one.
-            // If we didn't find a forward edge, try for a backward one
-            if (SPECIAL_EDGEID == edge_id)
+            TurnEdge turn;
+            EdgeWeight weight;
+            EdgeID edge;
+        };
+        std::vector<Candidate> candidates;
+        std::vector<Candidate> backward_candidates;
+        for (const auto node : tile_nodes)
+        {
+            for (const auto edge : facade.GetAdjacentEdgeRange(node))
             {
-                edge_id = facade.FindSmallestEdge(
-                    exit_node, approach_node, [](const contractor::QueryEdge::EdgeData &data) {
-                        return data.backward && !data.shortcut;
-                    });
+                const auto &data = facade.GetEdgeData(edge);
+                const auto target = facade.GetTarget(edge);
+                if (data.shortcut ||
+                    !std::binary_search(tile_nodes.begin(), tile_nodes.end(), target))
+                    continue;
+                if (data.forward)
+                    candidates.push_back({{node, target, data.turn_id}, data.weight, edge});
+                if (data.backward)
+                    backward_candidates.push_back(
+                        {{target, node, data.turn_id}, data.weight, edge});
             }
-
-            BOOST_ASSERT_MSG(edge_id == SPECIAL_EDGEID || !facade.GetEdgeData(edge_id).shortcut,
-                             "Connecting edge must not be a shortcut");
-            return edge_id;
         }
+
+        // all forward edges of a pair come before its backward ones, the smallest first
+        const auto by_weight = [](const auto &lhs, const auto &rhs) {
+            return std::tie(lhs.weight, lhs.edge) < std::tie(rhs.weight, rhs.edge);
+        };
+        std::sort(candidates.begin(), candidates.end(), by_weight);
+        std::sort(backward_candidates.begin(), backward_candidates.end(), by_weight);
+        const auto turn = [](const auto &candidate) { return candidate.turn; };
+        std::transform(
+            candidates.begin(), candidates.end(), std::back_inserter(turn_edges), turn);
+        std::transform(backward_candidates.begin(),
+                       backward_candidates.end(),
+                       std::back_inserter(turn_edges),
+                       turn);
     };
 
-    EdgeFinderCH edge_finder(facade);
-    return generateTurns(facade, edges, sorted_edge_indexes, edge_finder);
+    return generateTurns(facade, edges, sorted_edge_indexes, find_edges);
 }
 
 // MLD version to find all turns
@@ -283,21 +279,23 @@ std::vector<TurnData> getTileTurns(const DataFacade<mld::Algorithm> &facade,
                                    const std::vector<RTreeLeaf> &edges,
                                    const std::vector<std::size_t> &sorted_edge_indexes)
 {
-    // Define how to find the representative edge between two edge-based-nodes for a MLD
-    struct EdgeFinderMLD
-    {
-        EdgeFinderMLD(const DataFacade<mld::Algorithm> &facade) : facade(facade) {}
-        const DataFacade<mld::Algorithm> &facade;
-
-        EdgeID operator()(const NodeID approach_node, const NodeID exit_node) const
+    // The first edge between two edge-based-nodes represents their turn for a MLD
+    const auto find_edges = [&facade](const std::vector<NodeID> &tile_nodes,
+                                      std::vector<TurnEdge> &turn_edges) {
+        for (const auto node : tile_nodes)
         {
-            return facade.FindEdge(approach_node, exit_node);
+            for (const auto edge : facade.GetAdjacentEdgeRange(node))
+            {
+                const auto target = facade.GetTarget(edge);
+                if (std::binary_search(tile_nodes.begin(), tile_nodes.end(), target))
+                {
+                    turn_edges.push_back({node, target, facade.GetEdgeData(edge).turn_id});
+                }
+            }
         }
     };
 
-    EdgeFinderMLD edge_finder(facade);
-
-    return generateTurns(facade, edges, sorted_edge_indexes, edge_finder);
+    return generateTurns(facade, edges, sorted_edge_indexes, find_edges);
 }
 
 } // namespace routing_algorithms
@@ -5,128 +5,104 @@ namespace osrm
 namespace engine
 {
 
-// CH heaps
-using CH = routing_algorithms::ch::Algorithm;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_1;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_1;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_2;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_2;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_3;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_3;
-SearchEngineData<CH>::ManyToManyHeapPtr SearchEngineData<CH>::many_to_many_heap;
-
-void SearchEngineData<CH>::InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes)
+namespace
 {
-    if (forward_heap_1.get())
+// Pooled heaps outlive the data they were created for, array storages have to grow with the
+// graph if a larger dataset gets loaded into shared memory
+template <typename Heap>
+void InitializeOrClear(std::unique_ptr<Heap> &heap, const unsigned number_of_nodes)
+{
+    if (heap.get() && heap->MaxID() >= number_of_nodes)
     {
-        forward_heap_1->Clear();
+        heap->Clear();
     }
     else
     {
-        forward_heap_1.reset(new QueryHeap(number_of_nodes));
+        heap = std::make_unique<Heap>(number_of_nodes);
     }
+}
 
-    if (reverse_heap_1.get())
-    {
-        reverse_heap_1->Clear();
-    }
-    else
+template <typename Heap>
+void TakeStatistics(const std::unique_ptr<Heap> &heap, SearchStatistics &statistics)
+{
+    if (heap)
     {
-        reverse_heap_1.reset(new QueryHeap(number_of_nodes));
+        const auto taken = heap->TakeStatistics();
+        statistics.settled_nodes += taken.settled_nodes;
+        statistics.relaxed_edges += taken.relaxed_edges;
     }
 }
+}
+
+// CH heaps
+using CH = routing_algorithms::ch::Algorithm;
 
-void SearchEngineData<CH>::InitializeOrClearSecondThreadLocalStorage(unsigned number_of_nodes)
+SearchEngineData<CH>::~SearchEngineData()
 {
-    if (forward_heap_2.get())
-    {
-        forward_heap_2->Clear();
-    }
-    else
-    {
-        forward_heap_2.reset(new QueryHeap(number_of_nodes));
-    }
+    SearchStatistics statistics;
+    TakeStatistics(forward_heap_1, statistics);
+    TakeStatistics(reverse_heap_1, statistics);
+    TakeStatistics(forward_heap_2, statistics);
+    TakeStatistics(reverse_heap_2, statistics);
+    TakeStatistics(forward_heap_3, statistics);
+    TakeStatistics(reverse_heap_3, statistics);
+    TakeStatistics(many_to_many_heap, statistics);
+    AddThreadSearchStatistics(statistics);
 
-    if (reverse_heap_2.get())
-    {
-        reverse_heap_2->Clear();
-    }
-    else
-    {
-        reverse_heap_2.reset(new QueryHeap(number_of_nodes));
-    }
+    pool.Release(std::move(heaps));
 }
 
-void SearchEngineData<CH>::InitializeOrClearThirdThreadLocalStorage(unsigned number_of_nodes)
+void SearchEngineData<CH>::InitializeOrClearFirstHeaps(unsigned number_of_nodes)
 {
-    if (forward_heap_3.get())
-    {
-        forward_heap_3->Clear();
-    }
-    else
-    {
-        forward_heap_3.reset(new QueryHeap(number_of_nodes));
-    }
+    InitializeOrClear(forward_heap_1, number_of_nodes);
+    InitializeOrClear(reverse_heap_1, number_of_nodes);
+}
 
-    if (reverse_heap_3.get())
-    {
-        reverse_heap_3->Clear();
-    }
-    else
-    {
-        reverse_heap_3.reset(new QueryHeap(number_of_nodes));
-    }
+void SearchEngineData<CH>::InitializeOrClearSecondHeaps(unsigned number_of_nodes)
+{
+    InitializeOrClear(forward_heap_2, number_of_nodes);
+    InitializeOrClear(reverse_heap_2, number_of_nodes);
 }
 
-void SearchEngineData<CH>::InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes)
+void SearchEngineData<CH>::InitializeOrClearThirdHeaps(unsigned number_of_nodes)
 {
-    if (many_to_many_heap.get())
-    {
-        many_to_many_heap->Clear();
-    }
-    else
-    {
-        many_to_many_heap.reset(new ManyToManyQueryHeap(number_of_nodes));
-    }
+    InitializeOrClear(forward_heap_3, number_of_nodes);
+    InitializeOrClear(reverse_heap_3, number_of_nodes);
+}
+
+void SearchEngineData<CH>::InitializeOrClearManyToManyHeaps(unsigned number_of_nodes)
+{
+    InitializeOrClear(many_to_many_heap, number_of_nodes);
 }
 
 // MLD
 using MLD = routing_algorithms::mld::Algorithm;
-SearchEngineData<MLD>::SearchEngineHeapPtr SearchEngineData<MLD>::forward_heap_1;
-SearchEngineData<MLD>::SearchEngineHeapPtr SearchEngineData<MLD>::reverse_heap_1;
-SearchEngineData<MLD>::ManyToManyHeapPtr SearchEngineData<MLD>::many_to_many_heap;
 
-void SearchEngineData<MLD>::InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes)
+SearchEngineData<MLD>::~SearchEngineData()
 {
-    if (forward_heap_1.get())
-    {
-        forward_heap_1->Clear();
-    }
-    else
-    {
-        forward_heap_1.reset(new QueryHeap(number_of_nodes));
-    }
+    SearchStatistics statistics;
+    TakeStatistics(forward_heap_1, statistics);
+    TakeStatistics(reverse_heap_1, statistics);
+    TakeStatistics(many_to_many_heap, statistics);
+    AddThreadSearchStatistics(statistics);
 
-    if (reverse_heap_1.get())
-    {
-        reverse_heap_1->Clear();
-    }
-    else
-    {
-        reverse_heap_1.reset(new QueryHeap(number_of_nodes));
-    }
+    pool.Release(std::move(heaps));
 }
 
-void SearchEngineData<MLD>::InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes)
+void SearchEngineData<MLD>::InitializeOrClearFirstHeaps(unsigned number_of_nodes)
 {
-    if (many_to_many_heap.get())
-    {
-        many_to_many_heap->Clear();
-    }
-    else
-    {
-        many_to_many_heap.reset(new ManyToManyQueryHeap(number_of_nodes));
-    }
+    InitializeOrClear(forward_heap_1, number_of_nodes);
+    InitializeOrClear(reverse_heap_1, number_of_nodes);
+}
+
+void SearchEngineData<MLD>::InitializeOrClearManyToManyHeaps(unsigned number_of_nodes)
+{
+    InitializeOrClear(many_to_many_heap, number_of_nodes);
+}
+
+void SearchEngineData<MLD>::InitializeOrClearMeetingLabels(unsigned number_of_nodes)
+{
+    InitializeOrClear(meeting_labels, number_of_nodes);
 }
 }
 }
@@ -0,0 +1,20 @@
+#include "engine/search_statistics.hpp"
+
+namespace osrm
+{
+namespace engine
+{
+
+namespace
+{
+thread_local SearchStatistics thread_statistics;
+}
+
+SearchStatistics GetThreadSearchStatistics() { return thread_statistics; }
+
+void AddThreadSearchStatistics(const SearchStatistics &statistics)
+{
+    thread_statistics += statistics;
+}
+}
+}
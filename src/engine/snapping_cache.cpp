@@ -0,0 +1,72 @@
+#include "engine/snapping_cache.hpp"
+
+#include "util/std_hash.hpp"
+
+#include <boost/assert.hpp>
+
+#include <functional>
+
+namespace osrm
+{
+namespace engine
+{
+
+std::size_t SnappingCache::KeyHash::operator()(const Key &key) const
+{
+    return hash_val(key.generation,
+                    key.longitude,
+                    key.latitude,
+                    key.bearing,
+                    key.bearing_range,
+                    key.radius,
+                    static_cast<int>(key.approach));
+}
+
+SnappingCache::SnappingCache(const std::size_t capacity) : cache(capacity) {}
+
+SnappingCache::Handle SnappingCache::ForDataset(const std::shared_ptr<const void> &dataset)
+{
+    return Handle{this, generation.Get(dataset, [this]() { cache.Clear(); })};
+}
+
+SnappingCache::Key SnappingCache::Handle::MakeKey(const util::Coordinate coordinate,
+                                                  const boost::optional<double> radius,
+                                                  const boost::optional<Bearing> bearing,
+                                                  const Approach approach) const
+{
+    return Key{generation,
+               static_cast<std::int32_t>(coordinate.lon),
+               static_cast<std::int32_t>(coordinate.lat),
+               bearing ? bearing->bearing : -1,
+               bearing ? bearing->range : -1,
+               radius ? *radius : -1.,
+               approach};
+}
+
+boost::optional<PhantomNodePair>
+SnappingCache::Handle::Get(const util::Coordinate coordinate,
+                           const boost::optional<double> radius,
+                           const boost::optional<Bearing> bearing,
+                           const Approach approach) const
+{
+    BOOST_ASSERT(cache);
+    const auto cached = cache->cache.Get(MakeKey(coordinate, radius, bearing, approach));
+    if (!cached)
+    {
+        return boost::none;
+    }
+    return *cached;
+}
+
+void SnappingCache::Handle::Insert(const util::Coordinate coordinate,
+                                   const boost::optional<double> radius,
+                                   const boost::optional<Bearing> bearing,
+                                   const Approach approach,
+                                   const PhantomNodePair &phantom_nodes) const
+{
+    BOOST_ASSERT(cache);
+    cache->cache.Insert(MakeKey(coordinate, radius, bearing, approach),
+                        std::make_shared<const PhantomNodePair>(phantom_nodes));
+}
+}
+}
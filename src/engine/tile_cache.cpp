@@ -0,0 +1,150 @@
+#include "engine/tile_cache.hpp"
+
+#include "util/log.hpp"
+#include "util/std_hash.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <utility>
+
+namespace osrm
+{
+namespace engine
+{
+
+std::size_t TileCache::KeyHash::operator()(const Key &key) const
+{
+    return hash_val(key.generation, key.x, key.y, key.z);
+}
+
+TileCache::TileCache(const std::size_t capacity, boost::filesystem::path directory_)
+    : cache(capacity > 0
+                ? std::make_unique<util::ShardedLRUCache<Key, std::string, KeyHash>>(capacity)
+                : nullptr),
+      directory(std::move(directory_))
+{
+}
+
+TileCache::Key TileCache::MakeKey(const std::shared_ptr<const void> &dataset,
+                                  const api::TileParameters &parameters)
+{
+    return Key{generation.Get(dataset,
+                              [this]() {
+                                  if (cache)
+                                      cache->Clear();
+                              }),
+               parameters.x,
+               parameters.y,
+               parameters.z};
+}
+
+std::shared_ptr<const std::string> TileCache::Get(const Key &key, const std::string &timestamp)
+{
+    if (cache)
+    {
+        if (auto cached = cache->Get(key))
+        {
+            return cached;
+        }
+    }
+
+    if (directory.empty())
+    {
+        return nullptr;
+    }
+
+    const auto path = GetTilePath(directory, timestamp, api::TileParameters{key.x, key.y, key.z});
+    boost::filesystem::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return nullptr;
+    }
+    auto tile = std::make_shared<const std::string>(std::istreambuf_iterator<char>(file),
+                                                    std::istreambuf_iterator<char>());
+    if (file.bad())
+    {
+        return nullptr;
+    }
+
+    if (cache)
+    {
+        cache->Insert(key, tile);
+    }
+    return std::move(tile);
+}
+
+void TileCache::Insert(const Key &key, const std::string &timestamp, std::string tile)
+{
+    auto shared_tile = std::make_shared<const std::string>(std::move(tile));
+
+    if (!directory.empty())
+    {
+        WriteTile(GetTilePath(directory, timestamp, api::TileParameters{key.x, key.y, key.z}),
+                  *shared_tile);
+    }
+
+    if (cache)
+    {
+        cache->Insert(key, std::move(shared_tile));
+    }
+}
+
+bool TileCache::WriteTile(const boost::filesystem::path &path, const std::string &tile)
+{
+    // Written to a file of its own first, a concurrent or interrupted write never leaves a
+    // partial tile behind
+    try
+    {
+        boost::filesystem::create_directories(path.parent_path());
+        auto temporary = path;
+        temporary += boost::filesystem::unique_path(".%%%%-%%%%-%%%%.tmp");
+        boost::filesystem::ofstream file(temporary, std::ios::binary);
+        file.write(tile.data(), tile.size());
+        file.close();
+        if (!file)
+        {
+            util::Log(logWARNING) << "Tile cache: could not write " << temporary;
+            boost::filesystem::remove(temporary);
+            return false;
+        }
+        boost::filesystem::rename(temporary, path);
+        return true;
+    }
+    catch (const boost::filesystem::filesystem_error &error)
+    {
+        util::Log(logWARNING) << "Tile cache: " << error.what();
+        return false;
+    }
+}
+
+util::CacheStatistics TileCache::GetStatistics() const
+{
+    if (!cache)
+    {
+        return util::CacheStatistics{0, 0, 0, 0, 0};
+    }
+    return cache->GetStatistics();
+}
+
+boost::filesystem::path TileCache::GetTilePath(const boost::filesystem::path &directory,
+                                               const std::string &timestamp,
+                                               const api::TileParameters &parameters)
+{
+    // timestamps are ISO 8601 dates or arbitrary strings, keep them from leaving directory
+    std::string dataset = timestamp.empty() ? "_" : timestamp;
+    std::replace_if(dataset.begin(),
+                    dataset.end(),
+                    [](const unsigned char character) {
+                        return !std::isalnum(character) && character != '-' && character != '_';
+                    },
+                    '_');
+
+    return directory / dataset / std::to_string(parameters.z) / std::to_string(parameters.x) /
+           (std::to_string(parameters.y) + ".mvt");
+}
+}
+}
@@ -0,0 +1,39 @@
+#include "engine/unpacking_cache.hpp"
+
+#include "util/std_hash.hpp"
+
+#include <boost/assert.hpp>
+
+namespace osrm
+{
+namespace engine
+{
+
+std::size_t UnpackingCache::KeyHash::operator()(const Key &key) const
+{
+    return hash_val(key.generation, key.shortcut, key.reversed);
+}
+
+UnpackingCache::UnpackingCache(const std::size_t capacity) : cache(capacity) {}
+
+UnpackingCache::Handle UnpackingCache::ForDataset(const std::shared_ptr<const void> &dataset)
+{
+    return Handle{this, generation.Get(dataset, [this]() { cache.Clear(); })};
+}
+
+UnpackingCache::UnpackedShortcutPtr UnpackingCache::Handle::Get(const EdgeID shortcut,
+                                                                const bool reversed) const
+{
+    BOOST_ASSERT(cache);
+    return cache->cache.Get(Key{generation, shortcut, reversed});
+}
+
+void UnpackingCache::Handle::Insert(const EdgeID shortcut,
+                                    const bool reversed,
+                                    UnpackedShortcutPtr edges) const
+{
+    BOOST_ASSERT(cache);
+    cache->cache.Insert(Key{generation, shortcut, reversed}, std::move(edges));
+}
+}
+}
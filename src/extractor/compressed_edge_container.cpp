@@ -1,4 +1,5 @@
 #include "extractor/compressed_edge_container.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
 
 #include <boost/assert.hpp>
@@ -16,26 +17,88 @@ namespace osrm
 namespace extractor
 {
 
-CompressedEdgeContainer::CompressedEdgeContainer()
+CompressedEdgeContainer::CompressedEdgeContainer() {}
+
+std::size_t CompressedEdgeContainer::ChunkSizeClass(const std::uint32_t size)
+{
+    BOOST_ASSERT(size > 0);
+    std::size_t size_class = 0;
+    while ((1u << size_class) < size)
+        ++size_class;
+    return size_class;
+}
+
+std::uint32_t CompressedEdgeContainer::AllocateChunk(const std::uint32_t size)
+{
+    const auto size_class = ChunkSizeClass(size);
+    if (size_class >= m_free_chunks.size())
+        m_free_chunks.resize(size_class + 1);
+
+    auto &free_chunks = m_free_chunks[size_class];
+    if (!free_chunks.empty())
+    {
+        const auto offset = free_chunks.back();
+        free_chunks.pop_back();
+        return offset;
+    }
+
+    // the pool grows like a vector, segments of an edge are never split
+    const auto offset = m_segment_nodes.size();
+    const auto pool_size = offset + (std::size_t{1} << size_class);
+    BOOST_ASSERT(pool_size <= std::numeric_limits<std::uint32_t>::max());
+    m_segment_nodes.resize(pool_size, SPECIAL_NODEID);
+    m_segment_weights.resize(pool_size);
+    m_segment_durations.resize(pool_size);
+    return offset;
+}
+
+void CompressedEdgeContainer::FreeChunk(const Bucket &bucket)
 {
-    m_free_list.reserve(100);
-    IncreaseFreeList();
+    BOOST_ASSERT(bucket.size > 0);
+    m_free_chunks[ChunkSizeClass(bucket.size)].push_back(bucket.offset);
 }
 
-void CompressedEdgeContainer::IncreaseFreeList()
+CompressedEdgeContainer::Bucket &
+CompressedEdgeContainer::ReserveSegments(const EdgeID edge_id,
+                                         const std::uint32_t additional_segments)
 {
-    m_compressed_oneway_geometries.resize(m_compressed_oneway_geometries.size() + 100);
-    for (unsigned i = 100; i > 0; --i)
+    if (edge_id >= m_buckets.size())
+        m_buckets.resize(edge_id + 1, Bucket{0, 0});
+
+    const auto bucket = m_buckets[edge_id];
+    const auto new_size = bucket.size + additional_segments;
+    if (bucket.size > 0 && ChunkSizeClass(new_size) == ChunkSizeClass(bucket.size))
+        return m_buckets[edge_id];
+
+    const auto offset = AllocateChunk(new_size);
+    for (const auto index : util::irange<std::uint32_t>(0, bucket.size))
     {
-        m_free_list.emplace_back(free_list_maximum);
-        ++free_list_maximum;
+        m_segment_nodes[offset + index] = m_segment_nodes[bucket.offset + index];
+        m_segment_weights[offset + index] = m_segment_weights.peek(bucket.offset + index);
+        m_segment_durations[offset + index] = m_segment_durations.peek(bucket.offset + index);
     }
+    if (bucket.size > 0)
+        FreeChunk(bucket);
+
+    m_buckets[edge_id].offset = offset;
+    return m_buckets[edge_id];
+}
+
+void CompressedEdgeContainer::AppendSegment(Bucket &bucket,
+                                            const NodeID node_id,
+                                            const SegmentWeight weight,
+                                            const SegmentDuration duration)
+{
+    const auto position = bucket.offset + bucket.size;
+    m_segment_nodes[position] = node_id;
+    m_segment_weights[position] = weight;
+    m_segment_durations[position] = duration;
+    ++bucket.size;
 }
 
 bool CompressedEdgeContainer::HasEntryForID(const EdgeID edge_id) const
 {
-    auto iter = m_edge_id_to_list_index_map.find(edge_id);
-    return iter != m_edge_id_to_list_index_map.end();
+    return edge_id < m_buckets.size() && m_buckets[edge_id].size > 0;
 }
 
 bool CompressedEdgeContainer::HasZippedEntryForForwardID(const EdgeID edge_id) const
@@ -50,14 +113,6 @@ bool CompressedEdgeContainer::HasZippedEntryForReverseID(const EdgeID edge_id) c
     return iter != m_reverse_edge_id_to_zipped_index_map.end();
 }
 
-unsigned CompressedEdgeContainer::GetPositionForID(const EdgeID edge_id) const
-{
-    auto map_iterator = m_edge_id_to_list_index_map.find(edge_id);
-    BOOST_ASSERT(map_iterator != m_edge_id_to_list_index_map.end());
-    BOOST_ASSERT(map_iterator->second < m_compressed_oneway_geometries.size());
-    return map_iterator->second;
-}
-
 unsigned CompressedEdgeContainer::GetZippedPositionForForwardID(const EdgeID edge_id) const
 {
     auto map_iterator = m_forward_edge_id_to_zipped_index_map.find(edge_id);
@@ -130,78 +185,58 @@ void CompressedEdgeContainer::CompressEdge(
     // 1. append via node id to list of edge_id_1
     // 2. find list for edge_id_2, if yes add all elements and delete it
 
-    // Add via node id. List is created if it does not exist
-    if (!HasEntryForID(edge_id_1))
-    {
-        // create a new entry in the map
-        if (0 == m_free_list.size())
-        {
-            // make sure there is a place to put the entries
-            IncreaseFreeList();
-        }
-        BOOST_ASSERT(!m_free_list.empty());
-        m_edge_id_to_list_index_map[edge_id_1] = m_free_list.back();
-        m_free_list.pop_back();
-    }
-
-    // find bucket index
-    const auto iter = m_edge_id_to_list_index_map.find(edge_id_1);
-    BOOST_ASSERT(iter != m_edge_id_to_list_index_map.end());
-    const unsigned edge_bucket_id1 = iter->second;
-    BOOST_ASSERT(edge_bucket_id1 == GetPositionForID(edge_id_1));
-    BOOST_ASSERT(edge_bucket_id1 < m_compressed_oneway_geometries.size());
-
-    std::vector<OnewayCompressedEdge> &edge_bucket_list1 =
-        m_compressed_oneway_geometries[edge_bucket_id1];
+    const bool was_empty = !HasEntryForID(edge_id_1);
+    const bool has_penalty = node_weight_penalty && node_duration_penalty;
+    const bool is_atomic = !HasEntryForID(edge_id_2);
+    const std::uint32_t additional_segments =
+        was_empty + has_penalty + (is_atomic ? 1 : m_buckets[edge_id_2].size);
 
-    bool was_empty = edge_bucket_list1.empty();
+    // moves the segments of edge_id_1 if they don't fit into their chunk
+    auto &edge_bucket1 = ReserveSegments(edge_id_1, additional_segments);
 
     // note we don't save the start coordinate: it is implicitly given by edge 1
     // weight1 is the distance to the (currently) last coordinate in the bucket
     if (was_empty)
     {
-        edge_bucket_list1.emplace_back(
-            OnewayCompressedEdge{via_node_id, ClipWeight(weight1), ClipDuration(duration1)});
+        AppendSegment(edge_bucket1, via_node_id, ClipWeight(weight1), ClipDuration(duration1));
     }
 
-    BOOST_ASSERT(0 < edge_bucket_list1.size());
-    BOOST_ASSERT(!edge_bucket_list1.empty());
+    BOOST_ASSERT(0 < edge_bucket1.size);
 
     // if the via-node offers a penalty, we add the weight of the penalty as an artificial
     // segment that references SPECIAL_NODEID
-    if (node_weight_penalty && node_duration_penalty)
+    if (has_penalty)
     {
-        edge_bucket_list1.emplace_back(OnewayCompressedEdge{
-            via_node_id, ClipWeight(*node_weight_penalty), ClipDuration(*node_duration_penalty)});
+        AppendSegment(edge_bucket1,
+                      via_node_id,
+                      ClipWeight(*node_weight_penalty),
+                      ClipDuration(*node_duration_penalty));
     }
 
-    if (HasEntryForID(edge_id_2))
+    if (!is_atomic)
     {
         // second edge is not atomic anymore
-        const unsigned list_to_remove_index = GetPositionForID(edge_id_2);
-        BOOST_ASSERT(list_to_remove_index < m_compressed_oneway_geometries.size());
-
-        std::vector<OnewayCompressedEdge> &edge_bucket_list2 =
-            m_compressed_oneway_geometries[list_to_remove_index];
+        auto &edge_bucket2 = m_buckets[edge_id_2];
 
         // found an existing list, append it to the list of edge_id_1
-        edge_bucket_list1.insert(
-            edge_bucket_list1.end(), edge_bucket_list2.begin(), edge_bucket_list2.end());
+        for (const auto position :
+             util::irange(edge_bucket2.offset, edge_bucket2.offset + edge_bucket2.size))
+        {
+            AppendSegment(edge_bucket1,
+                          m_segment_nodes[position],
+                          m_segment_weights.peek(position),
+                          m_segment_durations.peek(position));
+        }
 
         // remove the list of edge_id_2
-        m_edge_id_to_list_index_map.erase(edge_id_2);
-        BOOST_ASSERT(m_edge_id_to_list_index_map.end() ==
-                     m_edge_id_to_list_index_map.find(edge_id_2));
-        edge_bucket_list2.clear();
-        BOOST_ASSERT(0 == edge_bucket_list2.size());
-        m_free_list.emplace_back(list_to_remove_index);
-        BOOST_ASSERT(list_to_remove_index == m_free_list.back());
+        FreeChunk(edge_bucket2);
+        edge_bucket2 = Bucket{0, 0};
+        BOOST_ASSERT(!HasEntryForID(edge_id_2));
     }
     else
     {
         // we are certain that the second edge is atomic.
-        edge_bucket_list1.emplace_back(
-            OnewayCompressedEdge{target_node_id, ClipWeight(weight2), ClipDuration(duration2)});
+        AppendSegment(edge_bucket1, target_node_id, ClipWeight(weight2), ClipDuration(duration2));
     }
 }
 
@@ -215,57 +250,33 @@ void CompressedEdgeContainer::AddUncompressedEdge(const EdgeID edge_id,
     BOOST_ASSERT(SPECIAL_NODEID != target_node_id);
     BOOST_ASSERT(INVALID_EDGE_WEIGHT != weight);
 
-    // Add via node id. List is created if it does not exist
-    if (!HasEntryForID(edge_id))
-    {
-        // create a new entry in the map
-        if (0 == m_free_list.size())
-        {
-            // make sure there is a place to put the entries
-            IncreaseFreeList();
-        }
-        BOOST_ASSERT(!m_free_list.empty());
-        m_edge_id_to_list_index_map[edge_id] = m_free_list.back();
-        m_free_list.pop_back();
-    }
-
-    // find bucket index
-    const auto iter = m_edge_id_to_list_index_map.find(edge_id);
-    BOOST_ASSERT(iter != m_edge_id_to_list_index_map.end());
-    const unsigned edge_bucket_id = iter->second;
-    BOOST_ASSERT(edge_bucket_id == GetPositionForID(edge_id));
-    BOOST_ASSERT(edge_bucket_id < m_compressed_oneway_geometries.size());
-
-    std::vector<OnewayCompressedEdge> &edge_bucket_list =
-        m_compressed_oneway_geometries[edge_bucket_id];
-
     // note we don't save the start coordinate: it is implicitly given by edge_id
     // weight is the distance to the (currently) last coordinate in the bucket
     // Don't re-add this if it's already in there.
-    if (edge_bucket_list.empty())
+    if (!HasEntryForID(edge_id))
     {
-        edge_bucket_list.emplace_back(
-            OnewayCompressedEdge{target_node_id, ClipWeight(weight), ClipDuration(duration)});
+        auto &edge_bucket = ReserveSegments(edge_id, 1);
+        AppendSegment(edge_bucket, target_node_id, ClipWeight(weight), ClipDuration(duration));
     }
 }
 
 void CompressedEdgeContainer::InitializeBothwayVector()
 {
     segment_data = std::make_unique<SegmentDataContainer>();
-    segment_data->index.reserve(m_compressed_oneway_geometries.size());
-    segment_data->nodes.reserve(m_compressed_oneway_geometries.size());
-    segment_data->fwd_weights.reserve(m_compressed_oneway_geometries.size());
-    segment_data->rev_weights.reserve(m_compressed_oneway_geometries.size());
-    segment_data->fwd_durations.reserve(m_compressed_oneway_geometries.size());
-    segment_data->rev_durations.reserve(m_compressed_oneway_geometries.size());
-    segment_data->fwd_datasources.reserve(m_compressed_oneway_geometries.size());
-    segment_data->rev_datasources.reserve(m_compressed_oneway_geometries.size());
+    segment_data->index.reserve(m_buckets.size());
+    segment_data->nodes.reserve(m_buckets.size());
+    segment_data->fwd_weights.reserve(m_buckets.size());
+    segment_data->rev_weights.reserve(m_buckets.size());
+    segment_data->fwd_durations.reserve(m_buckets.size());
+    segment_data->rev_durations.reserve(m_buckets.size());
+    segment_data->fwd_datasources.reserve(m_buckets.size());
+    segment_data->rev_datasources.reserve(m_buckets.size());
 }
 
 unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID r_edge_id)
 {
-    const auto &forward_bucket = GetBucketReference(f_edge_id);
-    const auto &reverse_bucket = GetBucketReference(r_edge_id);
+    const auto forward_bucket = GetBucketReference(f_edge_id);
+    const auto reverse_bucket = GetBucketReference(r_edge_id);
 
     BOOST_ASSERT(forward_bucket.size() == reverse_bucket.size());
 
@@ -275,7 +286,7 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
 
     segment_data->index.emplace_back(segment_data->nodes.size());
 
-    const auto &first_node = reverse_bucket.back();
+    const auto first_node = reverse_bucket.back();
 
     constexpr DatasourceID LUA_SOURCE = 0;
 
@@ -289,8 +300,8 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
 
     for (std::size_t i = 0; i < forward_bucket.size() - 1; ++i)
     {
-        const auto &fwd_node = forward_bucket.at(i);
-        const auto &rev_node = reverse_bucket.at(reverse_bucket.size() - 2 - i);
+        const auto fwd_node = forward_bucket[i];
+        const auto rev_node = reverse_bucket[reverse_bucket.size() - 2 - i];
 
         BOOST_ASSERT(fwd_node.node_id == rev_node.node_id);
 
@@ -303,7 +314,7 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
         segment_data->rev_datasources.emplace_back(LUA_SOURCE);
     }
 
-    const auto &last_node = forward_bucket.back();
+    const auto last_node = forward_bucket.back();
 
     segment_data->nodes.emplace_back(last_node.node_id);
     segment_data->fwd_weights.emplace_back(last_node.weight);
@@ -318,16 +329,14 @@ unsigned CompressedEdgeContainer::ZipEdges(const EdgeID f_edge_id, const EdgeID
 
 void CompressedEdgeContainer::PrintStatistics() const
 {
-    const uint64_t compressed_edges = m_compressed_oneway_geometries.size();
-    BOOST_ASSERT(0 == compressed_edges % 2);
-    BOOST_ASSERT(m_compressed_oneway_geometries.size() + m_free_list.size() > 0);
-
+    uint64_t compressed_edges = 0;
     uint64_t compressed_geometries = 0;
     uint64_t longest_chain_length = 0;
-    for (const std::vector<OnewayCompressedEdge> &current_vector : m_compressed_oneway_geometries)
+    for (const auto &bucket : m_buckets)
     {
-        compressed_geometries += current_vector.size();
-        longest_chain_length = std::max(longest_chain_length, (uint64_t)current_vector.size());
+        compressed_edges += bucket.size > 0;
+        compressed_geometries += bucket.size;
+        longest_chain_length = std::max(longest_chain_length, (uint64_t)bucket.size);
     }
 
     if (clipped_weights > 0)
@@ -347,14 +356,16 @@ void CompressedEdgeContainer::PrintStatistics() const
                 << "\n  longest chain length: " << longest_chain_length << "\n  cmpr ratio: "
                 << ((float)compressed_edges / std::max(compressed_geometries, (uint64_t)1))
                 << "\n  avg chain length: "
-                << (float)compressed_geometries / std::max((uint64_t)1, compressed_edges);
+                << (float)compressed_geometries / std::max((uint64_t)1, compressed_edges)
+                << "\n  segment pool size: " << m_segment_nodes.size();
 }
 
-const CompressedEdgeContainer::OnewayEdgeBucket &
+CompressedEdgeContainer::OnewayEdgeBucket
 CompressedEdgeContainer::GetBucketReference(const EdgeID edge_id) const
 {
-    const unsigned index = m_edge_id_to_list_index_map.at(edge_id);
-    return m_compressed_oneway_geometries.at(index);
+    BOOST_ASSERT(HasEntryForID(edge_id));
+    const auto &bucket = m_buckets[edge_id];
+    return OnewayEdgeBucket(this, bucket.offset, bucket.size);
 }
 
 // Since all edges are technically in the compressed geometry container,
@@ -363,25 +374,25 @@ CompressedEdgeContainer::GetBucketReference(const EdgeID edge_id) const
 // that only contain one original segment
 bool CompressedEdgeContainer::IsTrivial(const EdgeID edge_id) const
 {
-    const auto &bucket = GetBucketReference(edge_id);
+    const auto bucket = GetBucketReference(edge_id);
     return bucket.size() == 1;
 }
 
 NodeID CompressedEdgeContainer::GetFirstEdgeTargetID(const EdgeID edge_id) const
 {
-    const auto &bucket = GetBucketReference(edge_id);
+    const auto bucket = GetBucketReference(edge_id);
     BOOST_ASSERT(bucket.size() >= 1);
     return bucket.front().node_id;
 }
 NodeID CompressedEdgeContainer::GetLastEdgeTargetID(const EdgeID edge_id) const
 {
-    const auto &bucket = GetBucketReference(edge_id);
+    const auto bucket = GetBucketReference(edge_id);
     BOOST_ASSERT(bucket.size() >= 1);
     return bucket.back().node_id;
 }
 NodeID CompressedEdgeContainer::GetLastEdgeSourceID(const EdgeID edge_id) const
 {
-    const auto &bucket = GetBucketReference(edge_id);
+    const auto bucket = GetBucketReference(edge_id);
     BOOST_ASSERT(bucket.size() >= 2);
     return bucket[bucket.size() - 2].node_id;
 }
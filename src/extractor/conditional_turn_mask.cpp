@@ -0,0 +1,43 @@
+#include "extractor/conditional_turn_mask.hpp"
+
+#include <algorithm>
+#include <ctime>
+
+namespace osrm
+{
+namespace extractor
+{
+
+constexpr std::uint32_t ConditionalTurnMask::MINUTES_PER_STEP;
+constexpr std::uint32_t ConditionalTurnMask::MINUTES_PER_WEEK;
+constexpr std::uint32_t ConditionalTurnMask::NUMBER_OF_STEPS;
+
+bool compileConditionalTurnMask(const std::vector<util::OpeningHours> &conditions,
+                                ConditionalTurnMask &mask)
+{
+    const auto depends_on_dates =
+        std::any_of(conditions.begin(), conditions.end(), [](const auto &opening_hours) {
+            return !opening_hours.monthdays.empty();
+        });
+    if (depends_on_dates)
+        return false;
+
+    mask.steps.fill(0);
+    for (std::uint32_t step = 0; step < ConditionalTurnMask::NUMBER_OF_STEPS; ++step)
+    {
+        const auto minute_of_week = step * ConditionalTurnMask::MINUTES_PER_STEP;
+
+        // without month-day ranges only the weekday and the time of day are checked
+        struct tm time = {};
+        time.tm_wday = minute_of_week / (24 * 60);
+        time.tm_hour = minute_of_week / 60 % 24;
+        time.tm_min = minute_of_week % 60;
+
+        if (util::CheckOpeningHours(conditions, time))
+            mask.SetActive(step);
+    }
+    return true;
+}
+
+} // namespace extractor
+} // namespace osrm
@@ -32,6 +32,7 @@
 #include <limits>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 
 #include <tbb/blocked_range.h>
@@ -58,6 +59,45 @@ namespace osrm
 namespace extractor
 {
 
+namespace
+{
+// Writes a vector in the format of storage::serialization::write while its elements are
+// generated, the element count in front of them is only written once all are known
+template <typename T> class VectorStreamWriter
+{
+  public:
+    explicit VectorStreamWriter(const std::string &filename)
+        : writer(filename, storage::io::FileWriter::GenerateFingerprint)
+    {
+        writer.WriteElementCount64(0);
+    }
+
+    void Append(const std::vector<T> &data)
+    {
+        writer.WriteFrom(data);
+        count += data.size();
+    }
+
+    void Append(const T &value)
+    {
+        writer.WriteFrom(value);
+        ++count;
+    }
+
+    std::uint64_t Size() const { return count; }
+
+    void Finish()
+    {
+        writer.SkipToBeginning();
+        writer.WriteElementCount64(count);
+    }
+
+  private:
+    storage::io::FileWriter writer;
+    std::uint64_t count = 0;
+};
+}
+
 // Configuration to find representative candidate for turn angle calculations
 EdgeBasedGraphFactory::EdgeBasedGraphFactory(
     std::shared_ptr<util::NodeBasedDynamicGraph> node_based_graph,
@@ -193,12 +233,17 @@ NBGToEBG EdgeBasedGraphFactory::InsertEdgeBasedNode(const NodeID node_u, const N
 
         BOOST_ASSERT(current_edge_target_coordinate_id != current_edge_source_coordinate_id);
 
-        // build edges
-        m_edge_based_node_segments.emplace_back(edge_id_to_segment_id(forward_data.edge_id),
-                                                edge_id_to_segment_id(reverse_data.edge_id),
-                                                current_edge_source_coordinate_id,
-                                                current_edge_target_coordinate_id,
-                                                i);
+        // build edges, the bearing lets nearest queries filter segments without coordinates
+        const auto forward_bearing = util::coordinate_calculation::bearing(
+            m_coordinates[current_edge_source_coordinate_id],
+            m_coordinates[current_edge_target_coordinate_id]);
+        m_edge_based_node_segments.emplace_back(
+            edge_id_to_segment_id(forward_data.edge_id),
+            edge_id_to_segment_id(reverse_data.edge_id),
+            current_edge_source_coordinate_id,
+            current_edge_target_coordinate_id,
+            i,
+            static_cast<unsigned short>(std::round(forward_bearing)));
 
         m_edge_based_node_is_startpoint.push_back(
             (forward_data.startpoint || reverse_data.startpoint));
@@ -218,6 +263,7 @@ void EdgeBasedGraphFactory::Run(ScriptingEnvironment &scripting_environment,
                                 const std::string &turn_penalties_index_filename,
                                 const std::string &cnbg_ebg_mapping_path,
                                 const std::string &conditional_penalties_filename,
+                                const std::string &conditional_turn_masks_filename,
                                 const RestrictionMap &node_restriction_map,
                                 const ConditionalRestrictionMap &conditional_node_restriction_map,
                                 const WayRestrictionMap &way_restriction_map)
@@ -241,6 +287,7 @@ void EdgeBasedGraphFactory::Run(ScriptingEnvironment &scripting_environment,
                               turn_duration_penalties_filename,
                               turn_penalties_index_filename,
                               conditional_penalties_filename,
+                              conditional_turn_masks_filename,
                               node_restriction_map,
                               conditional_node_restriction_map,
                               way_restriction_map);
@@ -407,6 +454,7 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
     const std::string &turn_duration_penalties_filename,
     const std::string &turn_penalties_index_filename,
     const std::string &conditional_penalties_filename,
+    const std::string &conditional_turn_masks_filename,
     const RestrictionMap &node_restriction_map,
     const ConditionalRestrictionMap &conditional_restriction_map,
     const WayRestrictionMap &way_restriction_map)
@@ -444,9 +492,9 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
     bearing_class_by_node_based_node.resize(m_node_based_graph->GetNumberOfNodes(),
                                             std::numeric_limits<std::uint32_t>::max());
 
-    // FIXME these need to be tuned in pre-allocated size
-    std::vector<TurnPenalty> turn_weight_penalties;
-    std::vector<TurnPenalty> turn_duration_penalties;
+    // the penalties of every turn are written as the edges are generated
+    VectorStreamWriter<TurnPenalty> turn_weight_penalties(turn_weight_penalties_filename);
+    VectorStreamWriter<TurnPenalty> turn_duration_penalties(turn_duration_penalties_filename);
 
     const auto weight_multiplier =
         scripting_environment.GetProfileProperties().GetWeightMultiplier();
@@ -596,12 +644,25 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
             auto weight = boost::numeric_cast<EdgeWeight>(edge_data1.weight + weight_penalty);
             auto duration = boost::numeric_cast<EdgeWeight>(edge_data1.duration + duration_penalty);
 
+            // the length of the road the turn comes from, along its geometry
+            EdgeDistance distance = 0;
+            auto previous_coordinate = m_coordinates[node_along_road_entering];
+            for (const auto &segment :
+                 m_compressed_edge_container.GetBucketReference(node_based_edge_from))
+            {
+                const auto coordinate = m_coordinates[segment.node_id];
+                distance += util::coordinate_calculation::haversineDistance(previous_coordinate,
+                                                                            coordinate);
+                previous_coordinate = coordinate;
+            }
+
             EdgeBasedEdge edge_based_edge = {
                 edge_based_node_from,
                 edge_based_node_to,
                 SPECIAL_NODEID, // This will be updated once the main loop
                                 // completes!
                 weight,
+                distance,
                 duration,
                 true,
                 false};
@@ -646,6 +707,9 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                 if (buffer->nodes_processed == 0)
                     return buffer;
 
+                // intersections computed for an earlier block are unlikely to be seen again
+                turn_analysis.GetIntersectionGenerator().ClearCache();
+
                 for (auto node_at_center_of_intersection = intersection_node_range.begin(),
                           end = intersection_node_range.end();
                      node_at_center_of_intersection < end;
@@ -915,16 +979,17 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                 // for readability
                 const auto &data = buffer->continuous_data;
                 // NOTE: potential overflow here if we hit 2^32 routable edges
-                m_edge_based_edge_list.append(data.edges_list.begin(), data.edges_list.end());
+                // The turn id of an edge is its position in m_edge_based_edge_list
+                for (auto edge : data.edges_list)
+                {
+                    edge.data.turn_id = m_edge_based_edge_list.size();
+                    m_edge_based_edge_list.push_back(edge);
+                }
 
                 BOOST_ASSERT(m_edge_based_edge_list.size() <= std::numeric_limits<NodeID>::max());
 
-                turn_weight_penalties.insert(turn_weight_penalties.end(),
-                                             data.turn_weight_penalties.begin(),
-                                             data.turn_weight_penalties.end());
-                turn_duration_penalties.insert(turn_duration_penalties.end(),
-                                               data.turn_duration_penalties.begin(),
-                                               data.turn_duration_penalties.end());
+                turn_weight_penalties.Append(data.turn_weight_penalties);
+                turn_duration_penalties.Append(data.turn_duration_penalties);
                 turn_data_container.append(data.turn_data_container);
                 turn_indexes_write_buffer.insert(turn_indexes_write_buffer.end(),
                                                  data.turn_indexes.begin(),
@@ -957,9 +1022,11 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
             return lhs.edge.source < rhs.edge.source;
         });
         auto const transfer_data = [&](auto const &edge_with_data) {
-            m_edge_based_edge_list.push_back(edge_with_data.edge);
-            turn_weight_penalties.push_back(edge_with_data.turn_weight_penalty);
-            turn_duration_penalties.push_back(edge_with_data.turn_duration_penalty);
+            auto edge = edge_with_data.edge;
+            edge.data.turn_id = m_edge_based_edge_list.size();
+            m_edge_based_edge_list.push_back(edge);
+            turn_weight_penalties.Append(edge_with_data.turn_weight_penalty);
+            turn_duration_penalties.Append(edge_with_data.turn_duration_penalty);
             turn_data_container.push_back(edge_with_data.turn_data);
             turn_indexes_write_buffer.push_back(edge_with_data.turn_index);
         };
@@ -974,16 +1041,11 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
         }
     }
 
-    util::Log() << "Reunmbering turns";
-    // Now, update the turn_id property on every EdgeBasedEdge - it will equal the
-    // position in the m_edge_based_edge_list array for each object.
-    tbb::parallel_for(tbb::blocked_range<NodeID>(0, m_edge_based_edge_list.size()),
-                      [this](const tbb::blocked_range<NodeID> &range) {
-                          for (auto x = range.begin(), end = range.end(); x != end; ++x)
-                          {
-                              m_edge_based_edge_list[x].data.turn_id = x;
-                          }
-                      });
+    {
+        const auto masks = CompileConditionalTurnMasks(conditionals);
+        util::Log() << "Writing " << masks.size() << " weekly conditional turn masks...";
+        files::writeConditionalTurnMasks(conditional_turn_masks_filename, masks);
+    }
 
     // re-hash conditionals to ocnnect to their respective edge-based edges. Due to the
     // ordering, we
@@ -999,32 +1061,24 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
         extractor::serialization::write(writer, indexed_conditionals);
     }
 
-    // write weight penalties per turn
-    BOOST_ASSERT(turn_weight_penalties.size() == turn_duration_penalties.size());
-    {
-        storage::io::FileWriter writer(turn_weight_penalties_filename,
-                                       storage::io::FileWriter::GenerateFingerprint);
-        storage::serialization::write(writer, turn_weight_penalties);
-    }
+    // the weight and duration penalties per turn were written already
+    BOOST_ASSERT(turn_weight_penalties.Size() == turn_duration_penalties.Size());
+    BOOST_ASSERT(turn_weight_penalties.Size() == m_edge_based_edge_list.size());
+    turn_weight_penalties.Finish();
+    turn_duration_penalties.Finish();
 
-    {
-        storage::io::FileWriter writer(turn_duration_penalties_filename,
-                                       storage::io::FileWriter::GenerateFingerprint);
-        storage::serialization::write(writer, turn_duration_penalties);
-    }
-
-    util::Log() << "Created " << entry_class_hash.data.size() << " entry classes and "
-                << bearing_class_hash.data.size() << " Bearing Classes";
+    util::Log() << "Created " << entry_class_hash.size() << " entry classes and "
+                << bearing_class_hash.size() << " Bearing Classes";
 
     util::Log() << "Writing Turn Lane Data to File...";
     {
         storage::io::FileWriter writer(turn_lane_data_filename,
                                        storage::io::FileWriter::GenerateFingerprint);
 
-        std::vector<util::guidance::LaneTupleIdPair> lane_data(lane_data_map.data.size());
+        std::vector<util::guidance::LaneTupleIdPair> lane_data(lane_data_map.size());
         // extract lane data sorted by ID
-        for (auto itr : lane_data_map.data)
-            lane_data[itr.second] = itr.first;
+        lane_data_map.ForEach(
+            [&](const auto &lane_tuple, const auto id) { lane_data[id] = lane_tuple; });
 
         storage::serialization::write(writer, lane_data);
     }
@@ -1041,6 +1095,15 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                 << node_restriction_map.Size() << " restrictions";
     util::Log() << "  skips " << skipped_uturns_counter << " U turns";
     util::Log() << "  skips " << skipped_barrier_turns_counter << " turns over barriers";
+
+    const auto cache_statistics = turn_analysis.GetIntersectionGenerator().GetCacheStatistics();
+    const auto requested_intersections = cache_statistics.hits + cache_statistics.misses;
+    util::Log() << "Computed " << cache_statistics.misses << " of " << requested_intersections
+                << " requested intersections ("
+                << (requested_intersections == 0
+                        ? 0.
+                        : 100. * cache_statistics.hits / requested_intersections)
+                << "% cached)";
 }
 
 std::vector<ConditionalTurnPenalty>
@@ -1068,14 +1131,33 @@ EdgeBasedGraphFactory::IndexConditionals(std::vector<Conditional> &&conditionals
     return indexed_restrictions;
 }
 
-std::vector<util::guidance::BearingClass> EdgeBasedGraphFactory::GetBearingClasses() const
+std::vector<ConditionalTurnMask> EdgeBasedGraphFactory::CompileConditionalTurnMasks(
+    const std::vector<Conditional> &conditionals) const
 {
-    std::vector<util::guidance::BearingClass> result(bearing_class_hash.data.size());
-    for (const auto &pair : bearing_class_hash.data)
+    std::vector<ConditionalTurnMask> masks;
+    for (const auto &conditional : conditionals)
     {
-        BOOST_ASSERT(pair.second < result.size());
-        result[pair.second] = pair.first;
+        ConditionalTurnMask mask;
+        mask.from = conditional.from_node;
+        mask.to = conditional.to_node;
+        if (compileConditionalTurnMask(conditional.penalty.conditions, mask))
+            masks.push_back(mask);
     }
+
+    // sorted by the turn for the lookups of the queries
+    std::sort(masks.begin(), masks.end(), [](const auto &lhs, const auto &rhs) {
+        return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+    });
+    return masks;
+}
+
+std::vector<util::guidance::BearingClass> EdgeBasedGraphFactory::GetBearingClasses() const
+{
+    std::vector<util::guidance::BearingClass> result(bearing_class_hash.size());
+    bearing_class_hash.ForEach([&](const auto &bearing_class, const auto id) {
+        BOOST_ASSERT(id < result.size());
+        result[id] = bearing_class;
+    });
     return result;
 }
 
@@ -1091,12 +1173,11 @@ std::vector<BearingClassID> &EdgeBasedGraphFactory::GetBearingClassIds()
 
 std::vector<util::guidance::EntryClass> EdgeBasedGraphFactory::GetEntryClasses() const
 {
-    std::vector<util::guidance::EntryClass> result(entry_class_hash.data.size());
-    for (const auto &pair : entry_class_hash.data)
-    {
-        BOOST_ASSERT(pair.second < result.size());
-        result[pair.second] = pair.first;
-    }
+    std::vector<util::guidance::EntryClass> result(entry_class_hash.size());
+    entry_class_hash.ForEach([&](const auto &entry_class, const auto id) {
+        BOOST_ASSERT(id < result.size());
+        result[id] = entry_class;
+    });
     return result;
 }
 
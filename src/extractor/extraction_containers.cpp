@@ -19,8 +19,11 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/numeric/conversion/cast.hpp>
+#include <boost/optional.hpp>
 #include <boost/ref.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_sort.h>
 
 #include <chrono>
@@ -135,6 +138,10 @@ void ExtractionContainers::PrepareData(ScriptingEnvironment &scripting_environme
     PrepareEdges(scripting_environment);
     all_nodes_list.clear(); // free all_nodes_list before allocation of normal_edges
     all_nodes_list.shrink_to_fit();
+    if (node_locations)
+    {
+        node_locations->Clear();
+    }
     WriteEdges(file_out);
 
     PrepareRestrictions();
@@ -148,11 +155,16 @@ void ExtractionContainers::WriteCharData(const std::string &file_name)
     TIMER_START(write_index);
     storage::io::FileWriter file(file_name, storage::io::FileWriter::GenerateFingerprint);
 
+    // the same names, refs and destinations are used by many ways with different other strings
+    const auto uninterned_size = name_char_data.size();
+    util::NameTable::InternStrings(name_offsets, name_char_data);
+
     const util::NameTable::IndexedData indexed_data;
     indexed_data.write(file, name_offsets.begin(), name_offsets.end(), name_char_data.begin());
 
     TIMER_STOP(write_index);
-    log << "ok, after " << TIMER_SEC(write_index) << "s";
+    log << "ok, interned " << uninterned_size << " to " << name_char_data.size()
+        << " bytes, after " << TIMER_SEC(write_index) << "s";
 }
 
 void ExtractionContainers::PrepareNodes()
@@ -176,6 +188,41 @@ void ExtractionContainers::PrepareNodes()
         log << "ok, after " << TIMER_SEC(erasing_dups) << "s";
     }
 
+    if (node_locations)
+    {
+        util::UnbufferedLog log;
+        log << "Building node id map      ... " << std::flush;
+        TIMER_START(id_map);
+        // keep the nodes that were referenced and that we actually have
+        used_node_id_list.erase(std::remove_if(used_node_id_list.begin(),
+                                               used_node_id_list.end(),
+                                               [this](const OSMNodeID id) {
+                                                   return !node_locations->Has(id);
+                                               }),
+                                used_node_id_list.end());
+        TIMER_STOP(id_map);
+        log << "ok, after " << TIMER_SEC(id_map) << "s";
+    }
+    else if (sorted_nodes)
+    {
+        util::UnbufferedLog log;
+        log << "Merging sorted nodes      ... " << std::flush;
+        TIMER_START(merging_nodes);
+        // only the nodes that were referenced are kept, they arrive ordered by id
+        auto ref_iter = used_node_id_list.begin();
+        const auto used_node_id_list_end = used_node_id_list.end();
+        sorted_nodes->ForEach([&](const QueryNode &node) {
+            while (ref_iter != used_node_id_list_end && *ref_iter < node.node_id)
+                ref_iter++;
+            if (ref_iter != used_node_id_list_end && *ref_iter == node.node_id)
+                all_nodes_list.push_back(node);
+        });
+        const auto number_of_runs = sorted_nodes->NumberOfRuns();
+        sorted_nodes.reset();
+        TIMER_STOP(merging_nodes);
+        log << "ok, " << number_of_runs << " runs after " << TIMER_SEC(merging_nodes) << "s";
+    }
+    else
     {
         util::UnbufferedLog log;
         log << "Sorting all nodes         ... " << std::flush;
@@ -188,6 +235,7 @@ void ExtractionContainers::PrepareNodes()
         log << "ok, after " << TIMER_SEC(sorting_nodes) << "s";
     }
 
+    if (!node_locations)
     {
         util::UnbufferedLog log;
         log << "Building node id map      ... " << std::flush;
@@ -218,23 +266,26 @@ void ExtractionContainers::PrepareNodes()
             ref_iter++;
         }
 
-        // Remove unused nodes and check maximal internal node id
+        // Remove unused nodes
         used_node_id_list.resize(std::distance(used_node_id_list.begin(), used_nodes_iter));
-        if (used_node_id_list.size() > std::numeric_limits<NodeID>::max())
-        {
-            throw util::exception("There are too many nodes remaining after filtering, OSRM only "
-                                  "supports 2^32 unique nodes, but there were " +
-                                  std::to_string(used_node_id_list.size()) + SOURCE_REF);
-        }
-        max_internal_node_id = boost::numeric_cast<std::uint64_t>(used_node_id_list.size());
         TIMER_STOP(id_map);
         log << "ok, after " << TIMER_SEC(id_map) << "s";
     }
+
+    // check maximal internal node id
+    if (used_node_id_list.size() > std::numeric_limits<NodeID>::max())
+    {
+        throw util::exception("There are too many nodes remaining after filtering, OSRM only "
+                              "supports 2^32 unique nodes, but there were " +
+                              std::to_string(used_node_id_list.size()) + SOURCE_REF);
+    }
+    max_internal_node_id = boost::numeric_cast<std::uint64_t>(used_node_id_list.size());
 }
 
 void ExtractionContainers::PrepareEdges(ScriptingEnvironment &scripting_environment)
 {
-    // Sort edges by start.
+    // Sort edges by start, the node locations look up the coordinates without sorting.
+    if (!node_locations)
     {
         util::UnbufferedLog log;
         log << "Sorting edges by start    ... " << std::flush;
@@ -244,6 +295,50 @@ void ExtractionContainers::PrepareEdges(ScriptingEnvironment &scripting_environm
         log << "ok, after " << TIMER_SEC(sort_edges_by_start) << "s";
     }
 
+    if (node_locations)
+    {
+        util::UnbufferedLog log;
+        log << "Setting start coords      ... " << std::flush;
+        TIMER_START(set_start_coords);
+        // Every edge looks up the location of its start node
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, all_edges_list.size()),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                for (auto index = range.begin(); index != range.end(); ++index)
+                {
+                    auto &edge = all_edges_list[index];
+                    const auto coordinate = node_locations->Get(edge.result.osm_source_id);
+                    if (!coordinate)
+                    {
+                        util::Log(logDEBUG) << "Found invalid node reference "
+                                            << edge.result.source;
+                        edge.result.source = SPECIAL_NODEID;
+                        continue;
+                    }
+
+                    // remove loops
+                    if (edge.result.osm_source_id == edge.result.osm_target_id)
+                    {
+                        edge.result.source = SPECIAL_NODEID;
+                        edge.result.target = SPECIAL_NODEID;
+                        continue;
+                    }
+
+                    // assign new node id
+                    const auto node_id = mapExternalToInternalNodeID(used_node_id_list.begin(),
+                                                                     used_node_id_list.end(),
+                                                                     edge.result.osm_source_id);
+                    BOOST_ASSERT(node_id != SPECIAL_NODEID);
+                    edge.result.source = node_id;
+
+                    edge.source_coordinate.lat = coordinate->lat;
+                    edge.source_coordinate.lon = coordinate->lon;
+                }
+            });
+        TIMER_STOP(set_start_coords);
+        log << "ok, after " << TIMER_SEC(set_start_coords) << "s";
+    }
+    else
     {
         util::UnbufferedLog log;
         log << "Setting start coords      ... " << std::flush;
@@ -305,6 +400,7 @@ void ExtractionContainers::PrepareEdges(ScriptingEnvironment &scripting_environm
         log << "ok, after " << TIMER_SEC(set_start_coords) << "s";
     }
 
+    if (!node_locations)
     {
         // Sort Edges by target
         util::UnbufferedLog log;
@@ -320,89 +416,108 @@ void ExtractionContainers::PrepareEdges(ScriptingEnvironment &scripting_environm
         util::UnbufferedLog log;
         log << "Computing edge weights    ... " << std::flush;
         TIMER_START(compute_weights);
-        auto node_iterator = all_nodes_list.begin();
-        auto edge_iterator = all_edges_list.begin();
-        const auto all_edges_list_end_ = all_edges_list.end();
-        const auto all_nodes_list_end_ = all_nodes_list.end();
-
         const auto weight_multiplier =
             scripting_environment.GetProfileProperties().GetWeightMultiplier();
 
-        while (edge_iterator != all_edges_list_end_ && node_iterator != all_nodes_list_end_)
-        {
-            // skip all invalid edges
-            if (edge_iterator->result.source == SPECIAL_NODEID)
-            {
-                ++edge_iterator;
-                continue;
-            }
-
-            if (edge_iterator->result.osm_target_id < node_iterator->node_id)
-            {
-                util::Log(logDEBUG) << "Found invalid node reference "
-                                    << static_cast<uint64_t>(edge_iterator->result.osm_target_id);
-                edge_iterator->result.target = SPECIAL_NODEID;
-                ++edge_iterator;
-                continue;
-            }
-            if (edge_iterator->result.osm_target_id > node_iterator->node_id)
-            {
-                ++node_iterator;
-                continue;
-            }
-
-            BOOST_ASSERT(edge_iterator->result.osm_target_id == node_iterator->node_id);
-            BOOST_ASSERT(edge_iterator->source_coordinate.lat !=
-                         util::FixedLatitude{std::numeric_limits<std::int32_t>::min()});
-            BOOST_ASSERT(edge_iterator->source_coordinate.lon !=
-                         util::FixedLongitude{std::numeric_limits<std::int32_t>::min()});
-
-            util::Coordinate source_coord(edge_iterator->source_coordinate);
-            util::Coordinate target_coord{node_iterator->lon, node_iterator->lat};
-
-            // flip source and target coordinates if segment is in backward direction only
-            if (!edge_iterator->result.forward && edge_iterator->result.backward)
-                std::swap(source_coord, target_coord);
-
-            const auto distance =
-                util::coordinate_calculation::greatCircleDistance(source_coord, target_coord);
-            const auto weight = edge_iterator->weight_data(distance);
-            const auto duration = edge_iterator->duration_data(distance);
-
-            ExtractionSegment segment(source_coord, target_coord, distance, weight, duration);
-            scripting_environment.ProcessSegment(segment);
-
-            auto &edge = edge_iterator->result;
-            edge.weight = std::max<EdgeWeight>(1, std::round(segment.weight * weight_multiplier));
-            edge.duration = std::max<EdgeWeight>(1, std::round(segment.duration * 10.));
-
-            // assign new node id
-            const auto node_id = mapExternalToInternalNodeID(
-                used_node_id_list.begin(), used_node_id_list.end(), node_iterator->node_id);
-            BOOST_ASSERT(node_id != SPECIAL_NODEID);
-            edge.target = node_id;
-
-            // orient edges consistently: source id < target id
-            // important for multi-edge removal
-            if (edge.source > edge.target)
-            {
-                std::swap(edge.source, edge.target);
-
-                // std::swap does not work with bit-fields
-                bool temp = edge.forward;
-                edge.forward = edge.backward;
-                edge.backward = temp;
-            }
-            ++edge_iterator;
-        }
-
-        // Remove all remaining edges. They are invalid because there are no corresponding nodes for
-        // them. This happens when using osmosis with bbox or polygon to extract smaller areas.
-        auto markTargetsInvalid = [](InternalExtractorEdge &edge) {
-            util::Log(logDEBUG) << "Found invalid node reference " << edge.result.target;
+        const auto markTargetInvalid = [](InternalExtractorEdge &edge) {
+            util::Log(logDEBUG) << "Found invalid node reference "
+                                << static_cast<uint64_t>(edge.result.osm_target_id);
             edge.result.target = SPECIAL_NODEID;
         };
-        std::for_each(edge_iterator, all_edges_list_end_, markTargetsInvalid);
+
+        // The edges are sorted by target like the nodes by id, so every range of edges merges
+        // with the nodes from the first one its targets can refer to. With the node locations
+        // the targets are looked up directly. The segment function runs in the Lua context of
+        // the thread processing the range.
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, all_edges_list.size()),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                auto node_iterator = std::lower_bound(
+                    all_nodes_list.begin(),
+                    all_nodes_list.end(),
+                    all_edges_list[range.begin()].result.osm_target_id,
+                    [](const QueryNode &node, const OSMNodeID id) { return node.node_id < id; });
+                const auto all_nodes_list_end_ = all_nodes_list.end();
+
+                for (auto index = range.begin(); index != range.end(); ++index)
+                {
+                    auto edge_iterator = all_edges_list.begin() + index;
+
+                    // skip all invalid edges
+                    if (edge_iterator->result.source == SPECIAL_NODEID)
+                        continue;
+
+                    // Edges without a node are invalid. This happens when using osmosis
+                    // with bbox or polygon to extract smaller areas.
+                    boost::optional<util::Coordinate> target;
+                    if (node_locations)
+                    {
+                        target = node_locations->Get(edge_iterator->result.osm_target_id);
+                    }
+                    else
+                    {
+                        while (node_iterator != all_nodes_list_end_ &&
+                               node_iterator->node_id < edge_iterator->result.osm_target_id)
+                            ++node_iterator;
+
+                        if (node_iterator != all_nodes_list_end_ &&
+                            edge_iterator->result.osm_target_id == node_iterator->node_id)
+                            target = util::Coordinate{node_iterator->lon, node_iterator->lat};
+                    }
+                    if (!target)
+                    {
+                        markTargetInvalid(*edge_iterator);
+                        continue;
+                    }
+
+                    BOOST_ASSERT(edge_iterator->source_coordinate.lat !=
+                                 util::FixedLatitude{std::numeric_limits<std::int32_t>::min()});
+                    BOOST_ASSERT(edge_iterator->source_coordinate.lon !=
+                                 util::FixedLongitude{std::numeric_limits<std::int32_t>::min()});
+
+                    util::Coordinate source_coord(edge_iterator->source_coordinate);
+                    util::Coordinate target_coord = *target;
+
+                    // flip source and target coordinates if segment is in backward direction only
+                    if (!edge_iterator->result.forward && edge_iterator->result.backward)
+                        std::swap(source_coord, target_coord);
+
+                    const auto distance = util::coordinate_calculation::greatCircleDistance(
+                        source_coord, target_coord);
+                    const auto weight = edge_iterator->weight_data(distance);
+                    const auto duration = edge_iterator->duration_data(distance);
+
+                    ExtractionSegment segment(
+                        source_coord, target_coord, distance, weight, duration);
+                    scripting_environment.ProcessSegment(segment);
+
+                    auto &edge = edge_iterator->result;
+                    edge.weight =
+                        std::max<EdgeWeight>(1, std::round(segment.weight * weight_multiplier));
+                    edge.duration = std::max<EdgeWeight>(1, std::round(segment.duration * 10.));
+
+                    // assign new node id
+                    const auto node_id =
+                        mapExternalToInternalNodeID(used_node_id_list.begin(),
+                                                    used_node_id_list.end(),
+                                                    edge_iterator->result.osm_target_id);
+                    BOOST_ASSERT(node_id != SPECIAL_NODEID);
+                    edge.target = node_id;
+
+                    // orient edges consistently: source id < target id
+                    // important for multi-edge removal
+                    if (edge.source > edge.target)
+                    {
+                        std::swap(edge.source, edge.target);
+
+                        // std::swap does not work with bit-fields
+                        bool temp = edge.forward;
+                        edge.forward = edge.backward;
+                        edge.backward = temp;
+                    }
+                }
+            });
+
         TIMER_STOP(compute_weights);
         log << "ok, after " << TIMER_SEC(compute_weights) << "s";
     }
@@ -563,30 +678,43 @@ void ExtractionContainers::WriteNodes(storage::io::FileWriter &file_out) const
         util::UnbufferedLog log;
         log << "Confirming/Writing used nodes     ... ";
         TIMER_START(write_nodes);
-        // identify all used nodes by a merging step of two sorted lists
-        auto node_iterator = all_nodes_list.begin();
-        auto node_id_iterator = used_node_id_list.begin();
-        const auto used_node_id_list_end = used_node_id_list.end();
-        const auto all_nodes_list_end = all_nodes_list.end();
-
-        while (node_id_iterator != used_node_id_list_end && node_iterator != all_nodes_list_end)
+        if (node_locations)
         {
-            if (*node_id_iterator < node_iterator->node_id)
+            // all used nodes have a location
+            for (const auto id : used_node_id_list)
             {
-                ++node_id_iterator;
-                continue;
+                const auto coordinate = node_locations->Get(id);
+                BOOST_ASSERT(coordinate);
+                file_out.WriteOne(QueryNode{coordinate->lon, coordinate->lat, id});
             }
-            if (*node_id_iterator > node_iterator->node_id)
+        }
+        else
+        {
+            // identify all used nodes by a merging step of two sorted lists
+            auto node_iterator = all_nodes_list.begin();
+            auto node_id_iterator = used_node_id_list.begin();
+            const auto used_node_id_list_end = used_node_id_list.end();
+            const auto all_nodes_list_end = all_nodes_list.end();
+
+            while (node_id_iterator != used_node_id_list_end && node_iterator != all_nodes_list_end)
             {
-                ++node_iterator;
-                continue;
-            }
-            BOOST_ASSERT(*node_id_iterator == node_iterator->node_id);
+                if (*node_id_iterator < node_iterator->node_id)
+                {
+                    ++node_id_iterator;
+                    continue;
+                }
+                if (*node_id_iterator > node_iterator->node_id)
+                {
+                    ++node_iterator;
+                    continue;
+                }
+                BOOST_ASSERT(*node_id_iterator == node_iterator->node_id);
 
-            file_out.WriteOne((*node_iterator));
+                file_out.WriteOne((*node_iterator));
 
-            ++node_id_iterator;
-            ++node_iterator;
+                ++node_id_iterator;
+                ++node_iterator;
+            }
         }
         TIMER_STOP(write_nodes);
         log << "ok, after " << TIMER_SEC(write_nodes) << "s";
@@ -6,9 +6,11 @@
 #include "extractor/extraction_way.hpp"
 #include "extractor/extractor_callbacks.hpp"
 #include "extractor/files.hpp"
+#include "extractor/osm_changes.hpp"
 #include "extractor/raster_source.hpp"
 #include "extractor/restriction_filter.hpp"
 #include "extractor/restriction_parser.hpp"
+#include "extractor/routable_node_filter.hpp"
 #include "extractor/scripting_environment.hpp"
 
 #include "storage/io.hpp"
@@ -19,6 +21,7 @@
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
 #include "util/name_table.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/range_table.hpp"
 #include "util/timing_util.hpp"
 
@@ -40,6 +43,7 @@
 #include <boost/scope_exit.hpp>
 
 #include <osmium/io/any_input.hpp>
+#include <osmium/osm/entity_bits.hpp>
 
 #include <tbb/pipeline.h>
 #include <tbb/task_scheduler_init.h>
@@ -78,6 +82,43 @@ void SetClassNames(const ExtractorCallbacks::ClassesMap &classes_map,
         profile_properties.SetClassName(range.front(), pair.first);
     }
 }
+
+// Converts the excludable class names of the profile into class masks, combinations with
+// classes that no way uses are dropped
+void SetExcludableClasses(const ExtractorCallbacks::ClassesMap &classes_map,
+                          const std::vector<std::vector<std::string>> &excludable_classes,
+                          ProfileProperties &profile_properties)
+{
+    std::size_t index = 0;
+    for (const auto &classes : excludable_classes)
+    {
+        ClassData mask = 0;
+        bool known = !classes.empty();
+        for (const auto &name : classes)
+        {
+            const auto iter = classes_map.find(name);
+            if (iter == classes_map.end())
+            {
+                util::Log(logWARNING) << "Unknown class name " << name
+                                      << " in excludable classes, ignoring the combination";
+                known = false;
+                break;
+            }
+            mask |= iter->second;
+        }
+        if (!known)
+        {
+            continue;
+        }
+        if (index == ProfileProperties::MAX_EXCLUDABLE_CLASSES)
+        {
+            util::Log(logWARNING)
+                << "Too many combinations of excludable classes, ignoring the remaining ones";
+            break;
+        }
+        profile_properties.SetExcludableClasses(index++, mask);
+    }
+}
 }
 
 /**
@@ -120,6 +161,7 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
     util::Log() << "Generating edge-expanded graph representation";
 
     TIMER_START(expansion);
+    util::ProfilePhase expansion_phase("edge expansion");
 
     EdgeBasedNodeDataContainer edge_based_nodes_container;
     std::vector<EdgeBasedNodeSegment> edge_based_node_segments;
@@ -146,35 +188,51 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
     auto max_edge_id = graph_size.second - 1;
 
     TIMER_STOP(expansion);
+    expansion_phase.Stop();
 
     util::Log() << "Saving edge-based node weights to file.";
     TIMER_START(timer_write_node_weights);
     {
+        util::ProfilePhase phase("writing node weights");
         storage::io::FileWriter writer(config.GetPath(".osrm.enw"),
-                                       storage::io::FileWriter::GenerateFingerprint);
+                                       storage::io::FileWriter::GenerateFingerprint,
+                                       IntermediateCompression());
         storage::serialization::write(writer, edge_based_node_weights);
     }
     TIMER_STOP(timer_write_node_weights);
     util::Log() << "Done writing. (" << TIMER_SEC(timer_write_node_weights) << ")";
 
     util::Log() << "Computing strictly connected components ...";
-    FindComponents(
-        max_edge_id, edge_based_edge_list, edge_based_node_segments, edge_based_nodes_container);
+    {
+        util::ProfilePhase phase("components");
+        FindComponents(max_edge_id,
+                       edge_based_edge_list,
+                       edge_based_node_segments,
+                       edge_based_nodes_container);
+    }
 
     util::Log() << "Building r-tree ...";
     TIMER_START(rtree);
-    BuildRTree(std::move(edge_based_node_segments), std::move(node_is_startpoint), coordinates);
-
+    {
+        util::ProfilePhase phase("r-tree");
+        BuildRTree(
+            std::move(edge_based_node_segments), std::move(node_is_startpoint), coordinates);
+    }
     TIMER_STOP(rtree);
 
+    util::ProfilePhase writing_phase("writing graphs");
     util::Log() << "Writing nodes for nodes-based and edges-based graphs ...";
     files::writeNodes(config.GetPath(".osrm.nbg_nodes"), coordinates, osm_node_ids);
     files::writeNodeData(config.GetPath(".osrm.ebg_nodes"), edge_based_nodes_container);
 
     util::Log() << "Writing edge-based-graph edges       ... " << std::flush;
     TIMER_START(write_edges);
-    files::writeEdgeBasedGraph(config.GetPath(".osrm.ebg"), max_edge_id, edge_based_edge_list);
+    files::writeEdgeBasedGraph(config.GetPath(".osrm.ebg"),
+                               max_edge_id,
+                               edge_based_edge_list,
+                               IntermediateCompression());
     TIMER_STOP(write_edges);
+    writing_phase.Stop();
     util::Log() << "ok, after " << TIMER_SEC(write_edges) << "s";
 
     util::Log() << "Processed " << edge_based_edge_list.size() << " edges";
@@ -199,6 +257,7 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
                         const unsigned number_of_threads)
 {
     TIMER_START(extracting);
+    util::ProfilePhase extracting_phase("extraction");
 
     util::Log() << "Input file: " << config.input_path.filename().string();
     if (!config.profile_path.empty())
@@ -214,14 +273,81 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
 
     const osmium::io::Header header = reader.header();
 
+    std::unique_ptr<OSMChanges> changes;
+    if (!config.change_paths.empty())
+    {
+        TIMER_START(reading_changes);
+        util::ProfilePhase phase("reading changes");
+        changes = std::make_unique<OSMChanges>(readChangeFiles(config.change_paths));
+        TIMER_STOP(reading_changes);
+        util::Log() << "Read " << changes->NumberOfChanges() << " changed objects from "
+                    << config.change_paths.size() << " change files after "
+                    << TIMER_SEC(reading_changes) << "s";
+    }
+
+    std::unique_ptr<RoutableNodeFilter> node_filter;
+    if (config.two_pass_parsing)
+    {
+        TIMER_START(reading_ways);
+        util::ProfilePhase phase("reading ways");
+        node_filter =
+            std::make_unique<RoutableNodeFilter>(scripting_environment.GetWayPrefilterKeys());
+
+        // applying the changes consumes them, the second pass applies its own copy
+        std::unique_ptr<OSMChanges> way_changes;
+        if (!config.change_paths.empty())
+        {
+            way_changes = std::make_unique<OSMChanges>(readChangeFiles(config.change_paths));
+        }
+        const auto add_ways = [&](const osmium::memory::Buffer &buffer) {
+            for (const auto &way : buffer.select<osmium::Way>())
+            {
+                node_filter->AddWay(way);
+            }
+        };
+        osmium::io::Reader way_reader(
+            input_file, osmium::osm_entity_bits::way, osmium::io::read_meta::no);
+        while (auto buffer = way_reader.read())
+        {
+            if (way_changes)
+            {
+                add_ways(way_changes->Apply(std::move(buffer)));
+            }
+            else
+            {
+                add_ways(buffer);
+            }
+        }
+        if (way_changes)
+        {
+            add_ways(way_changes->Remaining());
+        }
+        way_reader.close();
+
+        TIMER_STOP(reading_ways);
+        util::Log() << "Found " << node_filter->NumberOfReferencedNodes()
+                    << " nodes of routable ways after " << TIMER_SEC(reading_ways) << "s";
+    }
+
     unsigned number_of_nodes = 0;
     unsigned number_of_ways = 0;
     unsigned number_of_relations = 0;
 
     util::Log() << "Parsing in progress..";
     TIMER_START(parsing);
+    util::ProfilePhase parsing_phase("parsing");
 
     ExtractionContainers extraction_containers;
+    if (config.use_dense_node_locations)
+    {
+        extraction_containers.node_locations = std::make_unique<NodeLocations>();
+    }
+    else if (config.external_sort_memory > 0)
+    {
+        extraction_containers.sorted_nodes = std::make_unique<ExtractionContainers::NodeSorter>(
+            boost::filesystem::absolute(config.GetPath(".osrm")).parent_path(),
+            static_cast<std::size_t>(config.external_sort_memory) * 1024 * 1024);
+    }
     ExtractorCallbacks::ClassesMap classes_map;
     guidance::LaneDescriptionMap turn_lane_map;
     auto extractor_callbacks =
@@ -265,15 +391,27 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
         SharedBuffer buffer;
         std::vector<std::pair<const osmium::Node &, ExtractionNode>> resulting_nodes;
         std::vector<std::pair<const osmium::Way &, ExtractionWay>> resulting_ways;
+        std::vector<std::size_t> resulting_way_names_hashes;
         std::vector<InputConditionalTurnRestriction> resulting_restrictions;
     };
 
+    bool read_remaining_changes = false;
     tbb::filter_t<void, SharedBuffer> buffer_reader(
         tbb::filter::serial_in_order, [&](tbb::flow_control &fc) {
             if (auto buffer = reader.read())
             {
+                if (changes)
+                {
+                    buffer = changes->Apply(std::move(buffer));
+                }
                 return std::make_shared<const osmium::memory::Buffer>(std::move(buffer));
             }
+            else if (changes && !read_remaining_changes)
+            {
+                // objects created after the last object of the input
+                read_remaining_changes = true;
+                return std::make_shared<const osmium::memory::Buffer>(changes->Remaining());
+            }
             else
             {
                 fc.stop();
@@ -286,12 +424,25 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
                 return std::shared_ptr<ParsedBuffer>{};
 
             auto parsed_buffer = std::make_shared<ParsedBuffer>();
-            parsed_buffer->buffer = buffer;
-            scripting_environment.ProcessElements(*buffer,
+            // the results refer to the objects of the buffer, so it has to outlive them
+            parsed_buffer->buffer =
+                node_filter
+                    ? std::make_shared<const osmium::memory::Buffer>(node_filter->Filter(*buffer))
+                    : buffer;
+            scripting_environment.ProcessElements(*parsed_buffer->buffer,
                                                   restriction_parser,
                                                   parsed_buffer->resulting_nodes,
                                                   parsed_buffer->resulting_ways,
                                                   parsed_buffer->resulting_restrictions);
+
+            // hash the names here, the serial storage stage only compares them
+            parsed_buffer->resulting_way_names_hashes.reserve(
+                parsed_buffer->resulting_ways.size());
+            for (const auto &result : parsed_buffer->resulting_ways)
+            {
+                parsed_buffer->resulting_way_names_hashes.push_back(
+                    ExtractorCallbacks::HashNames(result.second));
+            }
             return parsed_buffer;
         });
     tbb::filter_t<std::shared_ptr<ParsedBuffer>, void> buffer_storage(
@@ -306,9 +457,12 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
                 extractor_callbacks->ProcessNode(result.first, result.second);
             }
             number_of_ways += parsed_buffer->resulting_ways.size();
-            for (const auto &result : parsed_buffer->resulting_ways)
+            const auto &ways = parsed_buffer->resulting_ways;
+            for (const auto index : util::irange<std::size_t>(0, ways.size()))
             {
-                extractor_callbacks->ProcessWay(result.first, result.second);
+                extractor_callbacks->ProcessWay(ways[index].first,
+                                                ways[index].second,
+                                                parsed_buffer->resulting_way_names_hashes[index]);
             }
             number_of_relations += parsed_buffer->resulting_restrictions.size();
             for (const auto &result : parsed_buffer->resulting_restrictions)
@@ -322,6 +476,7 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
                            buffer_reader & buffer_transform & buffer_storage);
 
     TIMER_STOP(parsing);
+    parsing_phase.Stop();
     util::Log() << "Parsing finished after " << TIMER_SEC(parsing) << " seconds";
 
     util::Log() << "Raw input contains " << number_of_nodes << " nodes, " << number_of_ways
@@ -335,12 +490,17 @@ Extractor::ParseOSMData(ScriptingEnvironment &scripting_environment,
                               SOURCE_REF);
     }
 
-    extraction_containers.PrepareData(scripting_environment,
-                                      config.GetPath(".osrm").string(),
-                                      config.GetPath(".osrm.names").string());
+    {
+        util::ProfilePhase phase("preparing data");
+        extraction_containers.PrepareData(scripting_environment,
+                                          config.GetPath(".osrm").string(),
+                                          config.GetPath(".osrm.names").string());
+    }
 
     auto profile_properties = scripting_environment.GetProfileProperties();
     SetClassNames(classes_map, profile_properties);
+    SetExcludableClasses(
+        classes_map, scripting_environment.GetExcludableClasses(), profile_properties);
     files::writeProfileProperties(config.GetPath(".osrm.properties").string(), profile_properties);
 
     TIMER_STOP(extracting);
@@ -465,14 +625,17 @@ std::pair<std::size_t, EdgeID> Extractor::BuildEdgeExpandedGraph(
         LoadNodeBasedGraph(barrier_nodes, traffic_signals, coordinates, osm_node_ids);
 
     CompressedEdgeContainer compressed_edge_container;
-    GraphCompressor graph_compressor;
-    graph_compressor.Compress(barrier_nodes,
-                              traffic_signals,
-                              scripting_environment,
-                              turn_restrictions,
-                              conditional_turn_restrictions,
-                              *node_based_graph,
-                              compressed_edge_container);
+    {
+        util::ProfilePhase phase("graph compression");
+        GraphCompressor graph_compressor;
+        graph_compressor.Compress(barrier_nodes,
+                                  traffic_signals,
+                                  scripting_environment,
+                                  turn_restrictions,
+                                  conditional_turn_restrictions,
+                                  *node_based_graph,
+                                  compressed_edge_container);
+    }
 
     conditional_turn_restrictions =
         removeInvalidRestrictions(std::move(conditional_turn_restrictions), *node_based_graph);
@@ -516,13 +679,16 @@ std::pair<std::size_t, EdgeID> Extractor::BuildEdgeExpandedGraph(
                                      config.GetPath(".osrm.turn_penalties_index").string(),
                                      config.GetPath(".osrm.cnbg_to_ebg").string(),
                                      config.GetPath(".osrm.restrictions").string(),
+                                     config.GetPath(".osrm.conditional_turn_masks").string(),
                                      via_node_restriction_map,
                                      conditional_node_restriction_map,
                                      via_way_restriction_map);
         return edge_based_graph_factory.GetNumberOfEdgeBasedNodes();
     };
 
+    util::ProfilePhase edge_based_graph_phase("edge-based graph");
     const auto number_of_edge_based_nodes = create_edge_based_edges();
+    edge_based_graph_phase.Stop();
     compressed_edge_container.PrintStatistics();
 
     // The osrm-partition tool requires the compressed node based graph with an embedding.
@@ -543,8 +709,10 @@ std::pair<std::size_t, EdgeID> Extractor::BuildEdgeExpandedGraph(
     };
 
     compressed_node_based_graph_writing = std::async(std::launch::async, [&] {
-        WriteCompressedNodeBasedGraph(
-            config.GetPath(".osrm.cnbg").string(), *node_based_graph, coordinates);
+        WriteCompressedNodeBasedGraph(config.GetPath(".osrm.cnbg").string(),
+                                      *node_based_graph,
+                                      coordinates,
+                                      IntermediateCompression());
     });
 
     {
@@ -625,13 +793,15 @@ void Extractor::BuildRTree(std::vector<EdgeBasedNodeSegment> edge_based_node_seg
     util::Log() << "finished r-tree construction in " << TIMER_SEC(construction) << " seconds";
 }
 
-void Extractor::WriteCompressedNodeBasedGraph(const std::string &path,
-                                              const util::NodeBasedDynamicGraph &graph,
-                                              const std::vector<util::Coordinate> &coordinates)
+void Extractor::WriteCompressedNodeBasedGraph(
+    const std::string &path,
+    const util::NodeBasedDynamicGraph &graph,
+    const std::vector<util::Coordinate> &coordinates,
+    const storage::io::FileWriter::CompressionFlag compression)
 {
     const auto fingerprint = storage::io::FileWriter::GenerateFingerprint;
 
-    storage::io::FileWriter writer{path, fingerprint};
+    storage::io::FileWriter writer{path, fingerprint, compression};
 
     // Writes:  | Fingerprint | #e | #n | edges | coordinates |
     // - uint64: number of edges (from, to) pairs
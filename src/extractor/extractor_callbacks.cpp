@@ -9,8 +9,10 @@
 
 #include "util/for_each_pair.hpp"
 #include "util/guidance/turn_lanes.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
 
+#include <boost/functional/hash.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/optional/optional.hpp>
 #include <boost/tokenizer.hpp>
@@ -19,10 +21,12 @@
 
 #include "osrm/coordinate.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <iterator>
 #include <limits>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace osrm
@@ -43,8 +47,76 @@ ExtractorCallbacks::ExtractorCallbacks(ExtractionContainers &extraction_containe
       force_split_edges(properties.force_split_edges)
 {
     // we reserved 0, 1, 2, 3, 4 for the empty case
-    string_map[MapKey("", "", "", "", "")] = 0;
-    lane_description_map.data[TurnLaneDescription()] = 0;
+    name_ids.emplace(HashNames(ExtractionWay{}), 0);
+    const auto empty_lanes_id = lane_description_map.ConcurrentFindOrAdd(TurnLaneDescription());
+    BOOST_ASSERT(empty_lanes_id == 0);
+    (void)empty_lanes_id;
+}
+
+std::size_t ExtractorCallbacks::HashNames(const ExtractionWay &parsed_way)
+{
+    std::size_t seed = 0;
+    boost::hash_combine(seed, parsed_way.name);
+    boost::hash_combine(seed, parsed_way.destinations);
+    boost::hash_combine(seed, parsed_way.ref);
+    boost::hash_combine(seed, parsed_way.pronunciation);
+    boost::hash_combine(seed, parsed_way.exits);
+    return seed;
+}
+
+// Deduplicates street names, refs, destinations, pronunciation, exits.
+// In case we do not already store the strings, stores them and returns the new id.
+// Otherwise returns the id of the stored strings.
+NameID ExtractorCallbacks::GetNameID(const ExtractionWay &parsed_way, const std::size_t names_hash)
+{
+    // the name data of an id holds these strings in this order
+    // (name [name_id], destination [+1], pronunciation [+2], ref [+3], exits [+4])
+    const std::string *const strings[] = {&parsed_way.name,
+                                          &parsed_way.destinations,
+                                          &parsed_way.pronunciation,
+                                          &parsed_way.ref,
+                                          &parsed_way.exits};
+
+    const auto &name_data = external_memory.name_char_data;
+    const auto &name_offsets = external_memory.name_offsets;
+    const auto is_stored_as = [&](const NameID name_id) {
+        for (const auto index : util::irange<std::size_t>(0, std::extent<decltype(strings)>::value))
+        {
+            const auto begin = name_data.begin() + name_offsets[name_id + index];
+            const auto end = name_data.begin() + name_offsets[name_id + index + 1];
+            if (!std::equal(begin,
+                            end,
+                            strings[index]->begin(),
+                            strings[index]->end(),
+                            [](const unsigned char stored, const char character) {
+                                return stored == static_cast<unsigned char>(character);
+                            }))
+                return false;
+        }
+        return true;
+    };
+
+    const auto candidates = name_ids.equal_range(names_hash);
+    const auto stored = std::find_if(candidates.first, candidates.second, [&](const auto &entry) {
+        return is_stored_as(entry.second);
+    });
+    if (stored != candidates.second)
+    {
+        return stored->second;
+    }
+
+    // name_offsets has a sentinel element with the total name data size
+    // take the sentinels index as the name id of the new name data pack
+    const NameID name_id = name_offsets.size() - 1;
+    for (const auto string : strings)
+    {
+        std::copy(string->begin(),
+                  string->end(),
+                  std::back_inserter(external_memory.name_char_data));
+        external_memory.name_offsets.push_back(external_memory.name_char_data.size());
+    }
+    name_ids.emplace(names_hash, name_id);
+    return name_id;
 }
 
 /**
@@ -58,10 +130,20 @@ void ExtractorCallbacks::ProcessNode(const osmium::Node &input_node,
 {
     const auto id = OSMNodeID{static_cast<std::uint64_t>(input_node.id())};
 
-    external_memory.all_nodes_list.push_back(
-        QueryNode{util::toFixed(util::UnsafeFloatLongitude{input_node.location().lon()}),
-                  util::toFixed(util::UnsafeFloatLatitude{input_node.location().lat()}),
-                  id});
+    const auto lon = util::toFixed(util::UnsafeFloatLongitude{input_node.location().lon()});
+    const auto lat = util::toFixed(util::UnsafeFloatLatitude{input_node.location().lat()});
+    if (external_memory.node_locations)
+    {
+        external_memory.node_locations->Set(id, util::Coordinate{lon, lat});
+    }
+    else if (external_memory.sorted_nodes)
+    {
+        external_memory.sorted_nodes->push_back(QueryNode{lon, lat, id});
+    }
+    else
+    {
+        external_memory.all_nodes_list.push_back(QueryNode{lon, lat, id});
+    }
 
     if (result_node.barrier)
     {
@@ -88,7 +170,9 @@ void ExtractorCallbacks::ProcessRestriction(const InputConditionalTurnRestrictio
  *
  * warning: caller needs to take care of synchronization!
  */
-void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const ExtractionWay &parsed_way)
+void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way,
+                                    const ExtractionWay &parsed_way,
+                                    const std::size_t names_hash)
 {
     if ((parsed_way.forward_travel_mode == TRAVEL_MODE_INACCESSIBLE ||
          parsed_way.forward_speed <= 0) &&
@@ -300,56 +384,7 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
     const auto road_classification = parsed_way.road_classification;
 
     // Get the unique identifier for the street name, destination, and ref
-    const auto name_iterator = string_map.find(MapKey(parsed_way.name,
-                                                      parsed_way.destinations,
-                                                      parsed_way.ref,
-                                                      parsed_way.pronunciation,
-                                                      parsed_way.exits));
-    NameID name_id = EMPTY_NAMEID;
-    if (string_map.end() == name_iterator)
-    {
-        // name_offsets has a sentinel element with the total name data size
-        // take the sentinels index as the name id of the new name data pack
-        // (name [name_id], destination [+1], pronunciation [+2], ref [+3], exits [+4])
-        name_id = external_memory.name_offsets.size() - 1;
-
-        std::copy(parsed_way.name.begin(),
-                  parsed_way.name.end(),
-                  std::back_inserter(external_memory.name_char_data));
-        external_memory.name_offsets.push_back(external_memory.name_char_data.size());
-
-        std::copy(parsed_way.destinations.begin(),
-                  parsed_way.destinations.end(),
-                  std::back_inserter(external_memory.name_char_data));
-        external_memory.name_offsets.push_back(external_memory.name_char_data.size());
-
-        std::copy(parsed_way.pronunciation.begin(),
-                  parsed_way.pronunciation.end(),
-                  std::back_inserter(external_memory.name_char_data));
-        external_memory.name_offsets.push_back(external_memory.name_char_data.size());
-
-        std::copy(parsed_way.ref.begin(),
-                  parsed_way.ref.end(),
-                  std::back_inserter(external_memory.name_char_data));
-        external_memory.name_offsets.push_back(external_memory.name_char_data.size());
-
-        std::copy(parsed_way.exits.begin(),
-                  parsed_way.exits.end(),
-                  std::back_inserter(external_memory.name_char_data));
-        external_memory.name_offsets.push_back(external_memory.name_char_data.size());
-
-        auto k = MapKey{parsed_way.name,
-                        parsed_way.destinations,
-                        parsed_way.ref,
-                        parsed_way.pronunciation,
-                        parsed_way.exits};
-        auto v = MapVal{name_id};
-        string_map.emplace(std::move(k), std::move(v));
-    }
-    else
-    {
-        name_id = name_iterator->second;
-    }
+    const auto name_id = GetNameID(parsed_way, names_hash);
 
     const bool in_forward_direction =
         (parsed_way.forward_speed > 0 || parsed_way.forward_rate > 0 || parsed_way.duration > 0 ||
@@ -13,13 +13,448 @@
 #include "util/log.hpp"
 
 #include <boost/assert.hpp>
+#include <boost/optional.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
 namespace extractor
 {
 
+namespace
+{
+using EdgeData = util::NodeBasedDynamicGraph::EdgeData;
+
+// The arguments of CompressedEdgeContainer::CompressEdge
+struct CompressedEdge
+{
+    EdgeID surviving_edge;
+    EdgeID removed_edge;
+    NodeID via_node;
+    NodeID target_node;
+    EdgeWeight weight1;
+    EdgeWeight weight2;
+    EdgeDuration duration1;
+    EdgeDuration duration2;
+    boost::optional<EdgeWeight> node_weight_penalty;
+    boost::optional<EdgeDuration> node_duration_penalty;
+};
+
+// The compression of u - v - w into u - w, the graph has already been updated
+struct NodeCompression
+{
+    NodeID node_u;
+    NodeID node_v;
+    NodeID node_w;
+    CompressedEdge forward;
+    CompressedEdge reverse;
+};
+
+// A maximal path of nodes that may be compressed, or a cycle of them. The nodes of a chain only
+// have edges to each other and to the two end points outside of the chain, so chains can be
+// compressed independently of each other. Only the compression of the last node of a path joins
+// its end points, whether it happens depends on the other chains between them.
+struct Chain
+{
+    // ordered by id, the order in which they are compressed
+    std::vector<NodeID> nodes;
+    // the edges from the end points into the chain ordered by id, they keep their ids while the
+    // chain is compressed
+    std::vector<std::pair<NodeID, EdgeID>> end_edges;
+    // to apply to the geometries and restrictions once all chains are compressed
+    std::vector<NodeCompression> compressions;
+    // the node whose compression joins the end points, SPECIAL_NODEID if there is none
+    NodeID joining_node = SPECIAL_NODEID;
+};
+
+enum class CompressionResult
+{
+    Compressed,
+    Skipped,
+    Deferred
+};
+
+void applyCompression(const NodeCompression &compression,
+                      RestrictionCompressor &restriction_compressor,
+                      CompressedEdgeContainer &geometry_compressor)
+{
+    // update any involved turn restrictions
+    restriction_compressor.Compress(compression.node_u, compression.node_v, compression.node_w);
+
+    // store compressed geometry in container
+    for (const auto &edge : {compression.forward, compression.reverse})
+    {
+        geometry_compressor.CompressEdge(edge.surviving_edge,
+                                         edge.removed_edge,
+                                         edge.via_node,
+                                         edge.target_node,
+                                         edge.weight1,
+                                         edge.weight2,
+                                         edge.duration1,
+                                         edge.duration2,
+                                         edge.node_weight_penalty,
+                                         edge.node_duration_penalty);
+    }
+}
+
+// Compresses the degree two node v into the edges between its neighbours if they are compatible.
+// `find_edge` looks up edges like graph.FindEdge, `is_deferred` returns true if the compression of
+// u - v - w has to wait for the other chains.
+template <typename FindEdge, typename IsDeferred>
+CompressionResult compressNode(const NodeID node_v,
+                               const std::unordered_set<NodeID> &traffic_signals,
+                               ScriptingEnvironment &scripting_environment,
+                               const double weight_multiplier,
+                               util::NodeBasedDynamicGraph &graph,
+                               FindEdge find_edge,
+                               IsDeferred is_deferred,
+                               NodeCompression &compression)
+{
+    //    reverse_e2   forward_e2
+    // u <---------- v -----------> w
+    //    ----------> <-----------
+    //    forward_e1   reverse_e1
+    //
+    // Will be compressed to:
+    //
+    //    reverse_e1
+    // u <---------- w
+    //    ---------->
+    //    forward_e1
+    //
+    // If the edges are compatible.
+    const bool reverse_edge_order = graph.GetEdgeData(graph.BeginEdges(node_v)).reversed;
+    const EdgeID forward_e2 = graph.BeginEdges(node_v) + reverse_edge_order;
+    BOOST_ASSERT(SPECIAL_EDGEID != forward_e2);
+    BOOST_ASSERT(forward_e2 >= graph.BeginEdges(node_v) && forward_e2 < graph.EndEdges(node_v));
+    const EdgeID reverse_e2 = graph.BeginEdges(node_v) + 1 - reverse_edge_order;
+    BOOST_ASSERT(SPECIAL_EDGEID != reverse_e2);
+    BOOST_ASSERT(reverse_e2 >= graph.BeginEdges(node_v) && reverse_e2 < graph.EndEdges(node_v));
+
+    const EdgeData &fwd_edge_data2 = graph.GetEdgeData(forward_e2);
+    const EdgeData &rev_edge_data2 = graph.GetEdgeData(reverse_e2);
+
+    const NodeID node_w = graph.GetTarget(forward_e2);
+    BOOST_ASSERT(SPECIAL_NODEID != node_w);
+    BOOST_ASSERT(node_v != node_w);
+    const NodeID node_u = graph.GetTarget(reverse_e2);
+    BOOST_ASSERT(SPECIAL_NODEID != node_u);
+    BOOST_ASSERT(node_u != node_v);
+
+    if (is_deferred(node_u, node_w))
+    {
+        return CompressionResult::Deferred;
+    }
+
+    const EdgeID forward_e1 = find_edge(node_u, node_v);
+    BOOST_ASSERT(SPECIAL_EDGEID != forward_e1);
+    BOOST_ASSERT(node_v == graph.GetTarget(forward_e1));
+    const EdgeID reverse_e1 = find_edge(node_w, node_v);
+    BOOST_ASSERT(SPECIAL_EDGEID != reverse_e1);
+    BOOST_ASSERT(node_v == graph.GetTarget(reverse_e1));
+
+    const EdgeData &fwd_edge_data1 = graph.GetEdgeData(forward_e1);
+    const EdgeData &rev_edge_data1 = graph.GetEdgeData(reverse_e1);
+
+    if (find_edge(node_u, node_w) != SPECIAL_EDGEID || find_edge(node_w, node_u) != SPECIAL_EDGEID)
+    {
+        return CompressionResult::Skipped;
+    }
+
+    // this case can happen if two ways with different names overlap
+    if (fwd_edge_data1.name_id != rev_edge_data1.name_id ||
+        fwd_edge_data2.name_id != rev_edge_data2.name_id)
+    {
+        return CompressionResult::Skipped;
+    }
+
+    if (!fwd_edge_data1.CanCombineWith(fwd_edge_data2) ||
+        !rev_edge_data1.CanCombineWith(rev_edge_data2))
+    {
+        return CompressionResult::Skipped;
+    }
+
+    BOOST_ASSERT(graph.GetEdgeData(forward_e1).name_id == graph.GetEdgeData(reverse_e1).name_id);
+    BOOST_ASSERT(graph.GetEdgeData(forward_e2).name_id == graph.GetEdgeData(reverse_e2).name_id);
+
+    /*
+     * Remember Lane Data for compressed parts. This handles scenarios where lane-data is
+     * only kept up until a traffic light.
+     *
+     *                |    |
+     * ----------------    |
+     *         -^ |        |
+     * -----------         |
+     *         -v |        |
+     * ---------------     |
+     *                |    |
+     *
+     *  u ------- v ---- w
+     *
+     * Since the edge is compressable, we can transfer:
+     * "left|right" (uv) and "" (uw) into a string with "left|right" (uw) for the compressed
+     * edge.
+     * Doing so, we might mess up the point from where the lanes are shown. It should be
+     * reasonable, since the announcements have to come early anyhow. So there is a
+     * potential danger in here, but it saves us from adding a lot of additional edges for
+     * turn-lanes. Without this,we would have to treat any turn-lane beginning/ending just
+     * like a barrier.
+     */
+    const auto selectLaneID = [](const LaneDescriptionID front, const LaneDescriptionID back) {
+        // A lane has tags: u - (front) - v - (back) - w
+        // During contraction, we keep only one of the tags. Usually the one closer to the
+        // intersection is preferred. If its empty, however, we keep the non-empty one
+        if (back == INVALID_LANE_DESCRIPTIONID)
+            return front;
+        return back;
+    };
+    graph.GetEdgeData(forward_e1).lane_description_id =
+        selectLaneID(fwd_edge_data1.lane_description_id, fwd_edge_data2.lane_description_id);
+    graph.GetEdgeData(reverse_e1).lane_description_id =
+        selectLaneID(rev_edge_data1.lane_description_id, rev_edge_data2.lane_description_id);
+    graph.GetEdgeData(forward_e2).lane_description_id =
+        selectLaneID(fwd_edge_data2.lane_description_id, fwd_edge_data1.lane_description_id);
+    graph.GetEdgeData(reverse_e2).lane_description_id =
+        selectLaneID(rev_edge_data2.lane_description_id, rev_edge_data1.lane_description_id);
+
+    /*
+    // Do not compress edge if it crosses a traffic signal.
+    // This can't be done in CanCombineWith, becase we only store the
+    // traffic signals in the `traffic signal` list, which EdgeData
+    // doesn't have access to.
+    */
+    const bool has_node_penalty = traffic_signals.find(node_v) != traffic_signals.end();
+    boost::optional<EdgeDuration> node_duration_penalty = boost::none;
+    boost::optional<EdgeWeight> node_weight_penalty = boost::none;
+    if (has_node_penalty)
+    {
+        // generate an artifical turn for the turn penalty generation
+        ExtractionTurn extraction_turn(true);
+
+        extraction_turn.source_restricted = fwd_edge_data1.restricted;
+        extraction_turn.target_restricted = fwd_edge_data2.restricted;
+
+        // we cannot handle this as node penalty, if it depends on turn direction
+        if (extraction_turn.source_restricted != extraction_turn.target_restricted)
+            return CompressionResult::Skipped;
+
+        // the scripting environment keeps a context per thread
+        scripting_environment.ProcessTurn(extraction_turn);
+        node_duration_penalty = extraction_turn.duration * 10;
+        node_weight_penalty = extraction_turn.weight * weight_multiplier;
+    }
+
+    // Get weights before graph is modified
+    const auto forward_weight1 = fwd_edge_data1.weight;
+    const auto forward_weight2 = fwd_edge_data2.weight;
+    const auto forward_duration1 = fwd_edge_data1.duration;
+    const auto forward_duration2 = fwd_edge_data2.duration;
+
+    BOOST_ASSERT(0 != forward_weight1);
+    BOOST_ASSERT(0 != forward_weight2);
+
+    const auto reverse_weight1 = rev_edge_data1.weight;
+    const auto reverse_weight2 = rev_edge_data2.weight;
+    const auto reverse_duration1 = rev_edge_data1.duration;
+    const auto reverse_duration2 = rev_edge_data2.duration;
+
+    BOOST_ASSERT(0 != reverse_weight1);
+    BOOST_ASSERT(0 != reverse_weight2);
+
+    // add weight of e2's to e1
+    graph.GetEdgeData(forward_e1).weight += forward_weight2;
+    graph.GetEdgeData(reverse_e1).weight += reverse_weight2;
+
+    // add duration of e2's to e1
+    graph.GetEdgeData(forward_e1).duration += forward_duration2;
+    graph.GetEdgeData(reverse_e1).duration += reverse_duration2;
+
+    if (node_weight_penalty && node_duration_penalty)
+    {
+        graph.GetEdgeData(forward_e1).weight += *node_weight_penalty;
+        graph.GetEdgeData(reverse_e1).weight += *node_weight_penalty;
+        graph.GetEdgeData(forward_e1).duration += *node_duration_penalty;
+        graph.GetEdgeData(reverse_e1).duration += *node_duration_penalty;
+    }
+
+    // extend e1's to targets of e2's
+    graph.SetTarget(forward_e1, node_w);
+    graph.SetTarget(reverse_e1, node_u);
+
+    // remove e2's (if bidir, otherwise only one)
+    graph.DeleteEdge(node_v, forward_e2);
+    graph.DeleteEdge(node_v, reverse_e2);
+
+    compression = NodeCompression{node_u,
+                                  node_v,
+                                  node_w,
+                                  CompressedEdge{forward_e1,
+                                                 forward_e2,
+                                                 node_v,
+                                                 node_w,
+                                                 forward_weight1,
+                                                 forward_weight2,
+                                                 forward_duration1,
+                                                 forward_duration2,
+                                                 node_weight_penalty,
+                                                 node_duration_penalty},
+                                  CompressedEdge{reverse_e1,
+                                                 reverse_e2,
+                                                 node_v,
+                                                 node_u,
+                                                 reverse_weight1,
+                                                 reverse_weight2,
+                                                 reverse_duration1,
+                                                 reverse_duration2,
+                                                 node_weight_penalty,
+                                                 node_duration_penalty}};
+    return CompressionResult::Compressed;
+}
+
+// Finds the chains of the nodes that may be compressed, node_chain is set to the index of the
+// chain of every node in a chain
+std::vector<Chain> findChains(const util::NodeBasedDynamicGraph &graph,
+                              const std::vector<std::uint8_t> &is_candidate,
+                              std::vector<std::uint32_t> &node_chain)
+{
+    const NodeID number_of_nodes = graph.GetNumberOfNodes();
+    const auto NO_CHAIN = std::numeric_limits<std::uint32_t>::max();
+
+    // the neighbour of a candidate that is not `previous`
+    const auto next = [&](const NodeID node, const NodeID previous) {
+        const auto first = graph.BeginEdges(node);
+        return graph.GetTarget(graph.GetTarget(first) == previous ? first + 1 : first);
+    };
+
+    // paths start at candidates next to a node that is no candidate
+    std::vector<std::uint8_t> is_start(number_of_nodes, false);
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                      [&](const tbb::blocked_range<NodeID> &range) {
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                          {
+                              const auto first = graph.BeginEdges(node);
+                              is_start[node] = is_candidate[node] &&
+                                               (!is_candidate[graph.GetTarget(first)] ||
+                                                !is_candidate[graph.GetTarget(first + 1)]);
+                          }
+                      });
+    std::vector<NodeID> starts;
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        if (is_start[node])
+            starts.push_back(node);
+    }
+
+    // every path is walked from both of its ends, the walk from the smaller end keeps it
+    std::vector<Chain> chains(starts.size());
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, starts.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              const auto start = starts[index];
+                              const auto first = graph.BeginEdges(start);
+                              auto previous = is_candidate[graph.GetTarget(first)]
+                                                  ? graph.GetTarget(first + 1)
+                                                  : graph.GetTarget(first);
+                              auto &nodes = chains[index].nodes;
+                              for (auto node = start; is_candidate[node];)
+                              {
+                                  nodes.push_back(node);
+                                  BOOST_ASSERT(nodes.size() <= number_of_nodes);
+                                  const auto next_node = next(node, previous);
+                                  previous = node;
+                                  node = next_node;
+                              }
+                              if (nodes.back() < start)
+                                  nodes.clear();
+                          }
+                      });
+    chains.erase(std::remove_if(chains.begin(),
+                                chains.end(),
+                                [](const auto &chain) { return chain.nodes.empty(); }),
+                 chains.end());
+
+    node_chain.assign(number_of_nodes, NO_CHAIN);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chains.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              for (const auto node : chains[index].nodes)
+                                  node_chain[node] = index;
+                          }
+                      });
+
+    // the remaining candidates are on cycles without an end point, they are rare
+    for (const auto start : util::irange(0u, number_of_nodes))
+    {
+        if (!is_candidate[start] || node_chain[start] != NO_CHAIN)
+            continue;
+
+        Chain cycle;
+        auto previous = graph.GetTarget(graph.BeginEdges(start) + 1);
+        auto node = start;
+        do
+        {
+            BOOST_ASSERT(is_candidate[node] && node_chain[node] == NO_CHAIN);
+            cycle.nodes.push_back(node);
+            node_chain[node] = chains.size();
+            const auto next_node = next(node, previous);
+            previous = node;
+            node = next_node;
+        } while (node != start);
+        chains.push_back(std::move(cycle));
+    }
+
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chains.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              auto &chain = chains[index];
+                              std::sort(chain.nodes.begin(), chain.nodes.end());
+                              for (const auto node : chain.nodes)
+                              {
+                                  for (const auto edge : graph.GetAdjacentEdgeRange(node))
+                                  {
+                                      const auto end_point = graph.GetTarget(edge);
+                                      if (node_chain[end_point] == index)
+                                          continue;
+                                      for (const auto end_edge :
+                                           graph.GetAdjacentEdgeRange(end_point))
+                                      {
+                                          if (graph.GetTarget(end_edge) == node)
+                                              chain.end_edges.emplace_back(end_point, end_edge);
+                                      }
+                                  }
+                              }
+                              std::sort(chain.end_edges.begin(),
+                                        chain.end_edges.end(),
+                                        [](const auto &lhs, const auto &rhs) {
+                                            return lhs.second < rhs.second;
+                                        });
+                              chain.end_edges.erase(
+                                  std::unique(chain.end_edges.begin(), chain.end_edges.end()),
+                                  chain.end_edges.end());
+                          }
+                      });
+
+    return chains;
+}
+}
+
+// Degree two nodes are compressed in the order of their ids. They form chains that only share
+// their end points, so chains are found and compressed in parallel. The geometries and
+// restrictions are updated in a serial pass over the chains afterwards. The compressions that join
+// the end points of a chain happen last in the order of their nodes, so the graph is the same as
+// compressing all nodes one after the other.
 void GraphCompressor::Compress(
     const std::unordered_set<NodeID> &barrier_nodes,
     const std::unordered_set<NodeID> &traffic_signals,
@@ -60,231 +495,105 @@ void GraphCompressor::Compress(
     {
         const auto weight_multiplier =
             scripting_environment.GetProfileProperties().GetWeightMultiplier();
-        util::UnbufferedLog log;
-        util::Percent progress(log, original_number_of_nodes);
-
-        for (const NodeID node_v : util::irange(0u, original_number_of_nodes))
-        {
-            progress.PrintStatus(node_v);
 
-            // only contract degree 2 vertices
-            if (2 != graph.GetOutDegree(node_v))
-            {
-                continue;
-            }
-
-            // don't contract barrier node
-            if (barrier_nodes.end() != barrier_nodes.find(node_v))
-            {
-                continue;
-            }
-
-            // check if v is a via node for a turn restriction, i.e. a 'directed' barrier node
-            if (restriction_via_nodes.count(node_v))
-            {
-                continue;
-            }
+        // only contract degree 2 vertices, don't contract barrier nodes and via nodes of turn
+        // restrictions, i.e. 'directed' barrier nodes
+        std::vector<std::uint8_t> is_candidate(original_number_of_nodes);
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, original_number_of_nodes),
+                          [&](const tbb::blocked_range<NodeID> &range) {
+                              for (auto node = range.begin(); node != range.end(); ++node)
+                              {
+                                  is_candidate[node] = 2 == graph.GetOutDegree(node) &&
+                                                       !barrier_nodes.count(node) &&
+                                                       !restriction_via_nodes.count(node);
+                              }
+                          });
+
+        std::vector<std::uint32_t> node_chain;
+        auto chains = findChains(graph, is_candidate, node_chain);
+        util::Log() << "Compressing " << chains.size() << " chains of degree two nodes";
+
+        // A chain only reads and writes the edges of its nodes and its end edges. Edges of the
+        // end points are looked up in the end edges, the other chains change the rest of them.
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, chains.size()),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                for (auto index = range.begin(); index != range.end(); ++index)
+                {
+                    auto &chain = chains[index];
+                    const auto in_chain = [&](const NodeID node) {
+                        return node_chain[node] == index;
+                    };
+                    const auto find_edge = [&](const NodeID from, const NodeID to) {
+                        if (in_chain(from))
+                            return graph.FindEdge(from, to);
+                        for (const auto &end_edge : chain.end_edges)
+                        {
+                            if (end_edge.first == from && graph.GetTarget(end_edge.second) == to)
+                                return end_edge.second;
+                        }
+                        return SPECIAL_EDGEID;
+                    };
+                    const auto joins_end_points = [&](const NodeID node_u, const NodeID node_w) {
+                        return !in_chain(node_u) && !in_chain(node_w);
+                    };
+
+                    for (const auto node_v : chain.nodes)
+                    {
+                        NodeCompression compression;
+                        const auto result = compressNode(node_v,
+                                                         traffic_signals,
+                                                         scripting_environment,
+                                                         weight_multiplier,
+                                                         graph,
+                                                         find_edge,
+                                                         joins_end_points,
+                                                         compression);
+                        if (result == CompressionResult::Compressed)
+                        {
+                            chain.compressions.push_back(compression);
+                        }
+                        else if (result == CompressionResult::Deferred)
+                        {
+                            // all other nodes of the chain are compressed already
+                            BOOST_ASSERT(chain.compressions.size() + 1 == chain.nodes.size());
+                            chain.joining_node = node_v;
+                        }
+                    }
+                }
+            });
 
-            //    reverse_e2   forward_e2
-            // u <---------- v -----------> w
-            //    ----------> <-----------
-            //    forward_e1   reverse_e1
-            //
-            // Will be compressed to:
-            //
-            //    reverse_e1
-            // u <---------- w
-            //    ---------->
-            //    forward_e1
-            //
-            // If the edges are compatible.
-            const bool reverse_edge_order = graph.GetEdgeData(graph.BeginEdges(node_v)).reversed;
-            const EdgeID forward_e2 = graph.BeginEdges(node_v) + reverse_edge_order;
-            BOOST_ASSERT(SPECIAL_EDGEID != forward_e2);
-            BOOST_ASSERT(forward_e2 >= graph.BeginEdges(node_v) &&
-                         forward_e2 < graph.EndEdges(node_v));
-            const EdgeID reverse_e2 = graph.BeginEdges(node_v) + 1 - reverse_edge_order;
-            BOOST_ASSERT(SPECIAL_EDGEID != reverse_e2);
-            BOOST_ASSERT(reverse_e2 >= graph.BeginEdges(node_v) &&
-                         reverse_e2 < graph.EndEdges(node_v));
-
-            const EdgeData &fwd_edge_data2 = graph.GetEdgeData(forward_e2);
-            const EdgeData &rev_edge_data2 = graph.GetEdgeData(reverse_e2);
-
-            const NodeID node_w = graph.GetTarget(forward_e2);
-            BOOST_ASSERT(SPECIAL_NODEID != node_w);
-            BOOST_ASSERT(node_v != node_w);
-            const NodeID node_u = graph.GetTarget(reverse_e2);
-            BOOST_ASSERT(SPECIAL_NODEID != node_u);
-            BOOST_ASSERT(node_u != node_v);
-
-            const EdgeID forward_e1 = graph.FindEdge(node_u, node_v);
-            BOOST_ASSERT(SPECIAL_EDGEID != forward_e1);
-            BOOST_ASSERT(node_v == graph.GetTarget(forward_e1));
-            const EdgeID reverse_e1 = graph.FindEdge(node_w, node_v);
-            BOOST_ASSERT(SPECIAL_EDGEID != reverse_e1);
-            BOOST_ASSERT(node_v == graph.GetTarget(reverse_e1));
-
-            const EdgeData &fwd_edge_data1 = graph.GetEdgeData(forward_e1);
-            const EdgeData &rev_edge_data1 = graph.GetEdgeData(reverse_e1);
-
-            if (graph.FindEdgeInEitherDirection(node_u, node_w) != SPECIAL_EDGEID)
+        std::vector<NodeID> joining_nodes;
+        for (const auto &chain : chains)
+        {
+            for (const auto &compression : chain.compressions)
             {
-                continue;
+                applyCompression(compression, restriction_compressor, geometry_compressor);
             }
-
-            // this case can happen if two ways with different names overlap
-            if (fwd_edge_data1.name_id != rev_edge_data1.name_id ||
-                fwd_edge_data2.name_id != rev_edge_data2.name_id)
+            if (chain.joining_node != SPECIAL_NODEID)
             {
-                continue;
+                joining_nodes.push_back(chain.joining_node);
             }
+        }
 
-            if (fwd_edge_data1.CanCombineWith(fwd_edge_data2) &&
-                rev_edge_data1.CanCombineWith(rev_edge_data2))
+        // Several chains can join the same end points, the first one in the order of the
+        // nodes is compressed
+        std::sort(joining_nodes.begin(), joining_nodes.end());
+        for (const auto node_v : joining_nodes)
+        {
+            NodeCompression compression;
+            const auto result = compressNode(
+                node_v,
+                traffic_signals,
+                scripting_environment,
+                weight_multiplier,
+                graph,
+                [&](const NodeID from, const NodeID to) { return graph.FindEdge(from, to); },
+                [](const NodeID, const NodeID) { return false; },
+                compression);
+            if (result == CompressionResult::Compressed)
             {
-                BOOST_ASSERT(graph.GetEdgeData(forward_e1).name_id ==
-                             graph.GetEdgeData(reverse_e1).name_id);
-                BOOST_ASSERT(graph.GetEdgeData(forward_e2).name_id ==
-                             graph.GetEdgeData(reverse_e2).name_id);
-
-                /*
-                 * Remember Lane Data for compressed parts. This handles scenarios where lane-data
-                 * is
-                 * only kept up until a traffic light.
-                 *
-                 *                |    |
-                 * ----------------    |
-                 *         -^ |        |
-                 * -----------         |
-                 *         -v |        |
-                 * ---------------     |
-                 *                |    |
-                 *
-                 *  u ------- v ---- w
-                 *
-                 * Since the edge is compressable, we can transfer:
-                 * "left|right" (uv) and "" (uw) into a string with "left|right" (uw) for the
-                 * compressed
-                 * edge.
-                 * Doing so, we might mess up the point from where the lanes are shown. It should be
-                 * reasonable, since the announcements have to come early anyhow. So there is a
-                 * potential danger in here, but it saves us from adding a lot of additional edges
-                 * for
-                 * turn-lanes. Without this,we would have to treat any turn-lane beginning/ending
-                 * just
-                 * like a barrier.
-                 */
-                const auto selectLaneID = [](const LaneDescriptionID front,
-                                             const LaneDescriptionID back) {
-                    // A lane has tags: u - (front) - v - (back) - w
-                    // During contraction, we keep only one of the tags. Usually the one closer to
-                    // the
-                    // intersection is preferred. If its empty, however, we keep the non-empty one
-                    if (back == INVALID_LANE_DESCRIPTIONID)
-                        return front;
-                    return back;
-                };
-                graph.GetEdgeData(forward_e1).lane_description_id = selectLaneID(
-                    fwd_edge_data1.lane_description_id, fwd_edge_data2.lane_description_id);
-                graph.GetEdgeData(reverse_e1).lane_description_id = selectLaneID(
-                    rev_edge_data1.lane_description_id, rev_edge_data2.lane_description_id);
-                graph.GetEdgeData(forward_e2).lane_description_id = selectLaneID(
-                    fwd_edge_data2.lane_description_id, fwd_edge_data1.lane_description_id);
-                graph.GetEdgeData(reverse_e2).lane_description_id = selectLaneID(
-                    rev_edge_data2.lane_description_id, rev_edge_data1.lane_description_id);
-
-                /*
-                // Do not compress edge if it crosses a traffic signal.
-                // This can't be done in CanCombineWith, becase we only store the
-                // traffic signals in the `traffic signal` list, which EdgeData
-                // doesn't have access to.
-                */
-                const bool has_node_penalty = traffic_signals.find(node_v) != traffic_signals.end();
-                boost::optional<EdgeDuration> node_duration_penalty = boost::none;
-                boost::optional<EdgeWeight> node_weight_penalty = boost::none;
-                if (has_node_penalty)
-                {
-                    // generate an artifical turn for the turn penalty generation
-                    ExtractionTurn extraction_turn(true);
-
-                    extraction_turn.source_restricted = fwd_edge_data1.restricted;
-                    extraction_turn.target_restricted = fwd_edge_data2.restricted;
-
-                    // we cannot handle this as node penalty, if it depends on turn direction
-                    if (extraction_turn.source_restricted != extraction_turn.target_restricted)
-                        continue;
-
-                    scripting_environment.ProcessTurn(extraction_turn);
-                    node_duration_penalty = extraction_turn.duration * 10;
-                    node_weight_penalty = extraction_turn.weight * weight_multiplier;
-                }
-
-                // Get weights before graph is modified
-                const auto forward_weight1 = fwd_edge_data1.weight;
-                const auto forward_weight2 = fwd_edge_data2.weight;
-                const auto forward_duration1 = fwd_edge_data1.duration;
-                const auto forward_duration2 = fwd_edge_data2.duration;
-
-                BOOST_ASSERT(0 != forward_weight1);
-                BOOST_ASSERT(0 != forward_weight2);
-
-                const auto reverse_weight1 = rev_edge_data1.weight;
-                const auto reverse_weight2 = rev_edge_data2.weight;
-                const auto reverse_duration1 = rev_edge_data1.duration;
-                const auto reverse_duration2 = rev_edge_data2.duration;
-
-                BOOST_ASSERT(0 != reverse_weight1);
-                BOOST_ASSERT(0 != reverse_weight2);
-
-                // add weight of e2's to e1
-                graph.GetEdgeData(forward_e1).weight += forward_weight2;
-                graph.GetEdgeData(reverse_e1).weight += reverse_weight2;
-
-                // add duration of e2's to e1
-                graph.GetEdgeData(forward_e1).duration += forward_duration2;
-                graph.GetEdgeData(reverse_e1).duration += reverse_duration2;
-
-                if (node_weight_penalty && node_duration_penalty)
-                {
-                    graph.GetEdgeData(forward_e1).weight += *node_weight_penalty;
-                    graph.GetEdgeData(reverse_e1).weight += *node_weight_penalty;
-                    graph.GetEdgeData(forward_e1).duration += *node_duration_penalty;
-                    graph.GetEdgeData(reverse_e1).duration += *node_duration_penalty;
-                }
-
-                // extend e1's to targets of e2's
-                graph.SetTarget(forward_e1, node_w);
-                graph.SetTarget(reverse_e1, node_u);
-
-                // remove e2's (if bidir, otherwise only one)
-                graph.DeleteEdge(node_v, forward_e2);
-                graph.DeleteEdge(node_v, reverse_e2);
-
-                // update any involved turn restrictions
-                restriction_compressor.Compress(node_u, node_v, node_w);
-
-                // store compressed geometry in container
-                geometry_compressor.CompressEdge(forward_e1,
-                                                 forward_e2,
-                                                 node_v,
-                                                 node_w,
-                                                 forward_weight1,
-                                                 forward_weight2,
-                                                 forward_duration1,
-                                                 forward_duration2,
-                                                 node_weight_penalty,
-                                                 node_duration_penalty);
-                geometry_compressor.CompressEdge(reverse_e1,
-                                                 reverse_e2,
-                                                 node_v,
-                                                 node_u,
-                                                 reverse_weight1,
-                                                 reverse_weight2,
-                                                 reverse_duration1,
-                                                 reverse_duration2,
-                                                 node_weight_penalty,
-                                                 node_duration_penalty);
+                applyCompression(compression, restriction_compressor, geometry_compressor);
             }
         }
     }
@@ -29,6 +29,9 @@ namespace
 const constexpr bool USE_LOW_PRECISION_MODE = true;
 // the inverse of use low precision mode
 const constexpr bool USE_HIGH_PRECISION_MODE = !USE_LOW_PRECISION_MODE;
+
+// bounds the memory of a cache that is never cleared
+const constexpr std::size_t MAX_CACHED_INTERSECTIONS = 1 << 14;
 }
 
 IntersectionGenerator::IntersectionGenerator(
@@ -173,9 +176,38 @@ IntersectionView IntersectionGenerator::GetConnectedRoads(const NodeID from_node
         return range.front() <= via_eid && via_eid <= range.back();
     }(from_node, via_eid));
 
+    // the via edge starts at from_node, so it is all that's needed to identify the view
+    auto &cache = intersection_cache.local();
+    const std::uint64_t key = (static_cast<std::uint64_t>(via_eid) << 1) | use_low_precision_angles;
+    const auto cached = cache.views.find(key);
+    if (cached != cache.views.end())
+    {
+        ++cache.statistics.hits;
+        return cached->second;
+    }
+    ++cache.statistics.misses;
+
     auto intersection = ComputeIntersectionShape(
         node_based_graph.GetTarget(via_eid), boost::none, use_low_precision_angles);
-    return TransformIntersectionShapeIntoView(from_node, via_eid, std::move(intersection));
+    auto view = TransformIntersectionShapeIntoView(from_node, via_eid, std::move(intersection));
+
+    if (cache.views.size() >= MAX_CACHED_INTERSECTIONS)
+        cache.views.clear();
+    cache.views.emplace(key, view);
+    return view;
+}
+
+void IntersectionGenerator::ClearCache() const { intersection_cache.local().views.clear(); }
+
+IntersectionCacheStatistics IntersectionGenerator::GetCacheStatistics() const
+{
+    IntersectionCacheStatistics statistics;
+    for (const auto &cache : intersection_cache)
+    {
+        statistics.hits += cache.statistics.hits;
+        statistics.misses += cache.statistics.misses;
+    }
+    return statistics;
 }
 
 IntersectionGenerationParameters
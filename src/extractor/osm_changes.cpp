@@ -0,0 +1,129 @@
+#include "extractor/osm_changes.hpp"
+
+#include <osmium/io/any_input.hpp>
+#include <osmium/osm/entity_bits.hpp>
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <tuple>
+
+namespace osrm
+{
+namespace extractor
+{
+
+namespace
+{
+// The order of the objects in sorted OSM files, which osmium uses as well
+auto typeAndID(const osmium::OSMObject &object)
+{
+    return std::make_tuple(object.type(), object.positive_id(), object.id() < 0);
+}
+
+const osmium::OSMObject *lastObject(const osmium::memory::Buffer &buffer)
+{
+    const osmium::OSMObject *last = nullptr;
+    for (const auto &object : buffer.select<osmium::OSMObject>())
+    {
+        last = &object;
+    }
+    return last;
+}
+}
+
+OSMChanges::OSMChanges(osmium::memory::Buffer changes_) : changes(std::move(changes_))
+{
+    for (const auto &object : changes.select<osmium::OSMObject>())
+    {
+        objects.push_back(&object);
+    }
+
+    // the changes of an object are applied in the order they were read, the last one wins
+    std::stable_sort(objects.begin(),
+                     objects.end(),
+                     [](const osmium::OSMObject *lhs, const osmium::OSMObject *rhs) {
+                         return typeAndID(*lhs) < typeAndID(*rhs);
+                     });
+    std::reverse(objects.begin(), objects.end());
+    objects.erase(std::unique(objects.begin(),
+                              objects.end(),
+                              [](const osmium::OSMObject *lhs, const osmium::OSMObject *rhs) {
+                                  return typeAndID(*lhs) == typeAndID(*rhs);
+                              }),
+                  objects.end());
+    std::reverse(objects.begin(), objects.end());
+}
+
+void OSMChanges::AddChange(osmium::memory::Buffer &buffer,
+                           const osmium::OSMObject &change) const
+{
+    // deleted objects are not visible
+    if (change.visible())
+    {
+        buffer.add_item(change);
+        buffer.commit();
+    }
+}
+
+osmium::memory::Buffer OSMChanges::Apply(osmium::memory::Buffer buffer)
+{
+    const auto last = lastObject(buffer);
+    if (last == nullptr || next_change == objects.size() ||
+        typeAndID(*last) < typeAndID(*objects[next_change]))
+    {
+        return buffer;
+    }
+
+    osmium::memory::Buffer result(buffer.committed(), osmium::memory::Buffer::auto_grow::yes);
+    for (const auto &object : buffer.select<osmium::OSMObject>())
+    {
+        // created objects in front of this one
+        while (next_change < objects.size() &&
+               typeAndID(*objects[next_change]) < typeAndID(object))
+        {
+            AddChange(result, *objects[next_change++]);
+        }
+
+        if (next_change < objects.size() &&
+            typeAndID(*objects[next_change]) == typeAndID(object))
+        {
+            AddChange(result, *objects[next_change++]);
+        }
+        else
+        {
+            result.add_item(object);
+            result.commit();
+        }
+    }
+
+    return result;
+}
+
+osmium::memory::Buffer OSMChanges::Remaining()
+{
+    osmium::memory::Buffer result(1024 * 1024, osmium::memory::Buffer::auto_grow::yes);
+    while (next_change < objects.size())
+    {
+        AddChange(result, *objects[next_change++]);
+    }
+    return result;
+}
+
+osmium::memory::Buffer readChangeFiles(const std::vector<boost::filesystem::path> &paths)
+{
+    osmium::memory::Buffer changes(1024 * 1024, osmium::memory::Buffer::auto_grow::yes);
+    for (const auto &path : paths)
+    {
+        osmium::io::Reader reader(osmium::io::File(path.string()), osmium::osm_entity_bits::object);
+        while (auto buffer = reader.read())
+        {
+            changes.add_buffer(buffer);
+            changes.commit();
+        }
+        reader.close();
+    }
+    return changes;
+}
+}
+}
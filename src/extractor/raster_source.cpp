@@ -6,13 +6,120 @@
 #include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
 
+#include <boost/filesystem/fstream.hpp>
+
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 namespace osrm
 {
 namespace extractor
 {
 
+namespace
+{
+const char RASTER_FILE_MAGIC[8] = {'O', 'S', 'R', 'M', 'R', 'S', 'T', 0};
+
+bool readHeader(const boost::filesystem::path &path, RasterFileHeader &header)
+{
+    boost::filesystem::ifstream file(path, std::ios::binary);
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    return file && std::memcmp(header.magic, RASTER_FILE_MAGIC, sizeof(header.magic)) == 0;
+}
+
+std::uint64_t numberOfTiles(const std::uint64_t size, const std::uint32_t tile_size)
+{
+    return (size + tile_size - 1) / tile_size;
+}
+}
+
+RasterGrid::RasterGrid(const boost::filesystem::path &filepath)
+    : region(std::make_shared<boost::iostreams::mapped_file_source>(filepath))
+{
+    RasterFileHeader header;
+    if (region->size() < sizeof(header))
+    {
+        throw util::exception(filepath.string() + " is no binary raster file" + SOURCE_REF);
+    }
+    std::memcpy(&header, region->data(), sizeof(header));
+    if (std::memcmp(header.magic, RASTER_FILE_MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw util::exception(filepath.string() + " is no binary raster file" + SOURCE_REF);
+    }
+    if (header.version != RasterFileHeader::VERSION)
+    {
+        throw util::exception(filepath.string() + " has version " +
+                              std::to_string(header.version) + " of the binary raster format, " +
+                              "expected " + std::to_string(RasterFileHeader::VERSION) +
+                              SOURCE_REF);
+    }
+    if (header.tile_size == 0 || header.width == 0 || header.height == 0 ||
+        (region->size() - sizeof(header)) / sizeof(std::int32_t) !=
+            numberOfTiles(header.width, header.tile_size) *
+                numberOfTiles(header.height, header.tile_size) * header.tile_size *
+                header.tile_size)
+    {
+        throw util::exception(filepath.string() + " is truncated or has trailing data" +
+                              SOURCE_REF);
+    }
+
+    // the mapping is page aligned and the values start right after the header
+    mapped_data = reinterpret_cast<const std::int32_t *>(region->data() + sizeof(header));
+    xdim = header.width;
+    ydim = header.height;
+    tile_size = header.tile_size;
+}
+
+bool isRasterFile(const boost::filesystem::path &path)
+{
+    RasterFileHeader header;
+    return readHeader(path, header);
+}
+
+void writeRasterFile(const boost::filesystem::path &path,
+                     const RasterGrid &grid,
+                     const std::uint32_t tile_size)
+{
+    BOOST_ASSERT(tile_size > 0);
+
+    RasterFileHeader header;
+    std::memcpy(header.magic, RASTER_FILE_MAGIC, sizeof(header.magic));
+    header.version = RasterFileHeader::VERSION;
+    header.tile_size = tile_size;
+    header.width = grid.Width();
+    header.height = grid.Height();
+
+    boost::filesystem::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    // one tile at a time, the padding repeats the last value of the row or column
+    std::vector<std::int32_t> tile(tile_size * tile_size);
+    for (std::uint64_t tile_y = 0; tile_y < numberOfTiles(header.height, tile_size); ++tile_y)
+    {
+        for (std::uint64_t tile_x = 0; tile_x < numberOfTiles(header.width, tile_size); ++tile_x)
+        {
+            for (std::uint32_t y = 0; y < tile_size; ++y)
+            {
+                for (std::uint32_t x = 0; x < tile_size; ++x)
+                {
+                    tile[y * tile_size + x] =
+                        grid(std::min<std::uint64_t>(tile_x * tile_size + x, header.width - 1),
+                             std::min<std::uint64_t>(tile_y * tile_size + y, header.height - 1));
+                }
+            }
+            file.write(reinterpret_cast<const char *>(tile.data()),
+                       tile.size() * sizeof(std::int32_t));
+        }
+    }
+
+    file.close();
+    if (!file)
+    {
+        throw util::exception("Could not write " + path.string() + SOURCE_REF);
+    }
+}
+
 RasterSource::RasterSource(RasterGrid _raster_data,
                            std::size_t _width,
                            std::size_t _height,
@@ -78,7 +185,7 @@ RasterDatum RasterSource::GetRasterInterpolate(const int lon, const int lat) con
                                       raster_data(right, bottom) * (fromLeft * fromTop))};
 }
 
-// Load raster source into memory
+// Load raster source into memory, binary raster files are memory mapped
 int RasterContainer::LoadRasterSource(const std::string &path_string,
                                       double xmin,
                                       double xmax,
@@ -112,7 +219,16 @@ int RasterContainer::LoadRasterSource(const std::string &path_string,
             path_string, ErrorCode::FileOpenError, SOURCE_REF, "File not found");
     }
 
-    RasterGrid rasterData{filepath, ncols, nrows};
+    // binary rasters are mapped instead of parsed, they know their size
+    RasterGrid rasterData = isRasterFile(filepath) ? RasterGrid{filepath}
+                                                   : RasterGrid{filepath, ncols, nrows};
+    if (rasterData.Width() != ncols || rasterData.Height() != nrows)
+    {
+        throw util::exception(path_string + " has " + std::to_string(rasterData.Height()) +
+                              " rows and " + std::to_string(rasterData.Width()) +
+                              " columns instead of " + std::to_string(nrows) + " and " +
+                              std::to_string(ncols) + SOURCE_REF);
+    }
 
     RasterSource source{std::move(rasterData), ncols, nrows, _xmin, _xmax, _ymin, _ymax};
     TIMER_STOP(loading_source);
@@ -0,0 +1,76 @@
+#include "extractor/routable_node_filter.hpp"
+
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/relation.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace osrm
+{
+namespace extractor
+{
+
+RoutableNodeFilter::RoutableNodeFilter(std::vector<std::string> way_keys_)
+    : way_keys(std::move(way_keys_))
+{
+}
+
+bool RoutableNodeFilter::IsCandidate(const osmium::Way &way) const
+{
+    if (!way.visible())
+        return false;
+    if (way_keys.empty())
+        return true;
+
+    return std::any_of(way.tags().begin(), way.tags().end(), [this](const osmium::Tag &tag) {
+        return std::any_of(way_keys.begin(), way_keys.end(), [&tag](const std::string &key) {
+            return std::strcmp(tag.key(), key.c_str()) == 0;
+        });
+    });
+}
+
+void RoutableNodeFilter::AddWay(const osmium::Way &way)
+{
+    if (!IsCandidate(way))
+        return;
+
+    for (const auto &node_ref : way.nodes())
+    {
+        // negative ids of created objects share the bit of the positive id, which only keeps
+        // a node that is not needed
+        referenced_nodes.set(node_ref.positive_ref());
+    }
+}
+
+osmium::memory::Buffer RoutableNodeFilter::Filter(const osmium::memory::Buffer &buffer) const
+{
+    osmium::memory::Buffer filtered(std::max<std::size_t>(buffer.committed(), 1024),
+                                    osmium::memory::Buffer::auto_grow::yes);
+    for (const auto &item : buffer)
+    {
+        bool keep = false;
+        switch (item.type())
+        {
+        case osmium::item_type::node:
+            keep = IsReferenced(static_cast<const osmium::Node &>(item));
+            break;
+        case osmium::item_type::way:
+            keep = IsCandidate(static_cast<const osmium::Way &>(item));
+            break;
+        case osmium::item_type::relation:
+            keep = true;
+            break;
+        default:
+            break;
+        }
+        if (keep)
+        {
+            filtered.add_item(item);
+            filtered.commit();
+        }
+    }
+    return filtered;
+}
+}
+}
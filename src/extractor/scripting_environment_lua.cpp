@@ -12,6 +12,7 @@
 #include "extractor/restriction_parser.hpp"
 #include "util/coordinate.hpp"
 #include "util/exception.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
 #include "util/lua_util.hpp"
 #include "util/typedefs.hpp"
@@ -249,7 +250,9 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
         "force_split_edges",
         &ProfileProperties::force_split_edges,
         "call_tagless_node_function",
-        &ProfileProperties::call_tagless_node_function);
+        &ProfileProperties::call_tagless_node_function,
+        "way_function_depends_on_tags_only",
+        &ProfileProperties::way_function_depends_on_tags_only);
 
     context.state.new_usertype<std::vector<std::string>>(
         "vector",
@@ -459,6 +462,7 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
     // version-dependent parts of the api
     switch (context.api_version)
     {
+    case 3:
     case 2:
     {
         // clear global not used in v2
@@ -542,6 +546,12 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
             sol::optional<bool> force_split_edges = properties["force_split_edges"];
             if (force_split_edges != sol::nullopt)
                 context.properties.force_split_edges = force_split_edges.value();
+
+            sol::optional<bool> way_function_depends_on_tags_only =
+                properties["way_function_depends_on_tags_only"];
+            if (way_function_depends_on_tags_only != sol::nullopt)
+                context.properties.way_function_depends_on_tags_only =
+                    way_function_depends_on_tags_only.value();
         }
         break;
     }
@@ -600,11 +610,13 @@ const ProfileProperties &Sol2ScriptingEnvironment::GetProfileProperties()
 
 LuaScriptingContext &Sol2ScriptingEnvironment::GetSol2Context()
 {
-    std::lock_guard<std::mutex> lock(init_mutex);
+    // the thread local lookup is thread safe, only the initialization of a context is locked
+    // so per segment calls from many threads do not serialize on the mutex
     bool initialized = false;
     auto &ref = script_contexts.local(initialized);
     if (!initialized)
     {
+        std::lock_guard<std::mutex> lock(init_mutex);
         ref = std::make_unique<LuaScriptingContext>();
         InitContext(*ref);
     }
@@ -619,9 +631,20 @@ void Sol2ScriptingEnvironment::ProcessElements(
     std::vector<std::pair<const osmium::Way &, ExtractionWay>> &resulting_ways,
     std::vector<InputConditionalTurnRestriction> &resulting_restrictions)
 {
+    auto &local_context = this->GetSol2Context();
+    if (local_context.api_version == 3)
+    {
+        ProcessElementBatches(local_context,
+                              buffer,
+                              restriction_parser,
+                              resulting_nodes,
+                              resulting_ways,
+                              resulting_restrictions);
+        return;
+    }
+
     ExtractionNode result_node;
     ExtractionWay result_way;
-    auto &local_context = this->GetSol2Context();
 
     for (auto entity = buffer.cbegin(), end = buffer.cend(); entity != end; ++entity)
     {
@@ -642,7 +665,16 @@ void Sol2ScriptingEnvironment::ProcessElements(
             result_way.clear();
             if (local_context.has_way_function)
             {
-                local_context.ProcessWay(static_cast<const osmium::Way &>(*entity), result_way);
+                if (local_context.properties.way_function_depends_on_tags_only)
+                {
+                    local_context.ProcessWayCached(static_cast<const osmium::Way &>(*entity),
+                                                   result_way);
+                }
+                else
+                {
+                    local_context.ProcessWay(static_cast<const osmium::Way &>(*entity),
+                                             result_way);
+                }
             }
             resulting_ways.push_back(std::pair<const osmium::Way &, ExtractionWay>(
                 static_cast<const osmium::Way &>(*entity), std::move(result_way)));
@@ -663,6 +695,100 @@ void Sol2ScriptingEnvironment::ProcessElements(
     }
 }
 
+void Sol2ScriptingEnvironment::ProcessElementBatches(
+    LuaScriptingContext &context,
+    const osmium::memory::Buffer &buffer,
+    const RestrictionParser &restriction_parser,
+    std::vector<std::pair<const osmium::Node &, ExtractionNode>> &resulting_nodes,
+    std::vector<std::pair<const osmium::Way &, ExtractionWay>> &resulting_ways,
+    std::vector<InputConditionalTurnRestriction> &resulting_restrictions)
+{
+    BOOST_ASSERT(context.api_version == 3);
+
+    // The results are only passed to Lua once all elements of the buffer were added, so the
+    // vectors do not grow anymore. Ways with a cached tag set are not passed at all.
+    std::vector<std::size_t> node_batch;
+    std::vector<std::size_t> way_batch;
+    for (auto entity = buffer.cbegin(), end = buffer.cend(); entity != end; ++entity)
+    {
+        switch (entity->type())
+        {
+        case osmium::item_type::node:
+        {
+            const auto &node = static_cast<const osmium::Node &>(*entity);
+            if (context.has_node_function &&
+                (!node.tags().empty() || context.properties.call_tagless_node_function))
+            {
+                node_batch.push_back(resulting_nodes.size());
+            }
+            resulting_nodes.push_back(
+                std::pair<const osmium::Node &, ExtractionNode>(node, ExtractionNode{}));
+        }
+        break;
+        case osmium::item_type::way:
+        {
+            const auto &way = static_cast<const osmium::Way &>(*entity);
+            resulting_ways.push_back(
+                std::pair<const osmium::Way &, ExtractionWay>(way, ExtractionWay{}));
+            if (context.has_way_function &&
+                !(context.properties.way_function_depends_on_tags_only &&
+                  context.GetCachedWay(way, resulting_ways.back().second)))
+            {
+                way_batch.push_back(resulting_ways.size() - 1);
+            }
+        }
+        break;
+        case osmium::item_type::relation:
+        {
+            auto result_res =
+                restriction_parser.TryParse(static_cast<const osmium::Relation &>(*entity));
+            if (result_res)
+            {
+                resulting_restrictions.push_back(*result_res);
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    // the elements and results are passed as sequences of references
+    if (!node_batch.empty())
+    {
+        sol::table nodes = context.state.create_table(node_batch.size(), 0);
+        sol::table results = context.state.create_table(node_batch.size(), 0);
+        for (const auto index : util::irange<std::size_t>(0, node_batch.size()))
+        {
+            auto &element = resulting_nodes[node_batch[index]];
+            nodes[index + 1] = &element.first;
+            results[index + 1] = &element.second;
+        }
+        context.node_function(context.profile_table, nodes, results);
+    }
+
+    if (!way_batch.empty())
+    {
+        sol::table ways = context.state.create_table(way_batch.size(), 0);
+        sol::table results = context.state.create_table(way_batch.size(), 0);
+        for (const auto index : util::irange<std::size_t>(0, way_batch.size()))
+        {
+            auto &element = resulting_ways[way_batch[index]];
+            ways[index + 1] = &element.first;
+            results[index + 1] = &element.second;
+        }
+        context.way_function(context.profile_table, ways, results);
+
+        if (context.properties.way_function_depends_on_tags_only)
+        {
+            for (const auto index : way_batch)
+            {
+                context.CacheWay(resulting_ways[index].first, resulting_ways[index].second);
+            }
+        }
+    }
+}
+
 std::vector<std::string>
 Sol2ScriptingEnvironment::GetStringListFromFunction(const std::string &function_name)
 {
@@ -699,6 +825,7 @@ std::vector<std::string> Sol2ScriptingEnvironment::GetNameSuffixList()
     auto &context = GetSol2Context();
     switch (context.api_version)
     {
+    case 3:
     case 2:
         return Sol2ScriptingEnvironment::GetStringListFromTable("suffix_list");
     case 1:
@@ -713,6 +840,7 @@ std::vector<std::string> Sol2ScriptingEnvironment::GetRestrictions()
     auto &context = GetSol2Context();
     switch (context.api_version)
     {
+    case 3:
     case 2:
         return Sol2ScriptingEnvironment::GetStringListFromTable("restrictions");
     case 1:
@@ -722,12 +850,54 @@ std::vector<std::string> Sol2ScriptingEnvironment::GetRestrictions()
     }
 }
 
+std::vector<std::string> Sol2ScriptingEnvironment::GetWayPrefilterKeys()
+{
+    auto &context = GetSol2Context();
+    switch (context.api_version)
+    {
+    case 3:
+    case 2:
+        return Sol2ScriptingEnvironment::GetStringListFromTable("way_prefilter_keys");
+    default:
+        return {};
+    }
+}
+
+std::vector<std::vector<std::string>> Sol2ScriptingEnvironment::GetExcludableClasses()
+{
+    auto &context = GetSol2Context();
+    BOOST_ASSERT(context.state.lua_state() != nullptr);
+
+    // 'excludable' is a sequence of sets of class names, only api version 2 and later know it
+    std::vector<std::vector<std::string>> excludable_classes;
+    if (context.api_version < 2)
+    {
+        return excludable_classes;
+    }
+    sol::table excludable_table = context.profile_table["excludable"];
+    if (excludable_table.valid())
+    {
+        for (auto &&pair : excludable_table)
+        {
+            std::vector<std::string> classes;
+            sol::table classes_table = pair.second.as<sol::table>();
+            for (auto &&class_pair : classes_table)
+            {
+                classes.push_back(class_pair.first.as<std::string>());
+            }
+            excludable_classes.push_back(std::move(classes));
+        }
+    }
+    return excludable_classes;
+}
+
 void Sol2ScriptingEnvironment::ProcessTurn(ExtractionTurn &turn)
 {
     auto &context = GetSol2Context();
 
     switch (context.api_version)
     {
+    case 3:
     case 2:
         if (context.has_turn_penalty_function)
         {
@@ -794,7 +964,8 @@ void Sol2ScriptingEnvironment::ProcessSegment(ExtractionSegment &segment)
     {
         switch (context.api_version)
         {
-        case 2:
+        case 3:
+    case 2:
             context.segment_function(context.profile_table, segment);
             break;
         case 1:
@@ -812,6 +983,8 @@ void Sol2ScriptingEnvironment::ProcessSegment(ExtractionSegment &segment)
 void LuaScriptingContext::ProcessNode(const osmium::Node &node, ExtractionNode &result)
 {
     BOOST_ASSERT(state.lua_state() != nullptr);
+    // version 3 profiles get batches of elements
+    BOOST_ASSERT(api_version < 3);
 
     switch (api_version)
     {
@@ -828,6 +1001,8 @@ void LuaScriptingContext::ProcessNode(const osmium::Node &node, ExtractionNode &
 void LuaScriptingContext::ProcessWay(const osmium::Way &way, ExtractionWay &result)
 {
     BOOST_ASSERT(state.lua_state() != nullptr);
+    // version 3 profiles get batches of elements
+    BOOST_ASSERT(api_version < 3);
 
     switch (api_version)
     {
@@ -840,5 +1015,47 @@ void LuaScriptingContext::ProcessWay(const osmium::Way &way, ExtractionWay &resu
         break;
     }
 }
+
+void LuaScriptingContext::ProcessWayCached(const osmium::Way &way, ExtractionWay &result)
+{
+    if (!GetCachedWay(way, result))
+    {
+        ProcessWay(way, result);
+        CacheWay(way, result);
+    }
+}
+
+namespace
+{
+void setWayCacheKey(const osmium::Way &way, std::string &key)
+{
+    // keys and values can not contain a null character
+    key.clear();
+    for (const auto &tag : way.tags())
+    {
+        key.append(tag.key());
+        key.push_back('\0');
+        key.append(tag.value());
+        key.push_back('\0');
+    }
+}
+}
+
+bool LuaScriptingContext::GetCachedWay(const osmium::Way &way, ExtractionWay &result)
+{
+    setWayCacheKey(way, way_cache_key);
+    if (const auto cached = way_cache.Get(way_cache_key))
+    {
+        result = *cached;
+        return true;
+    }
+    return false;
+}
+
+void LuaScriptingContext::CacheWay(const osmium::Way &way, const ExtractionWay &result)
+{
+    setWayCacheKey(way, way_cache_key);
+    way_cache.Insert(way_cache_key, std::make_shared<const ExtractionWay>(result));
+}
 }
 }
@@ -2,25 +2,81 @@
 #include "extractor/scripting_environment.hpp"
 
 #include <algorithm>
-#include <iterator>
+#include <utility>
 
-#include <boost/algorithm/string.hpp>
+#include <boost/assert.hpp>
 
 namespace osrm
 {
 namespace extractor
 {
 
+namespace
+{
+inline char toLower(const char character)
+{
+    return character >= 'A' && character <= 'Z' ? character - 'A' + 'a' : character;
+}
+
+// slots per suffix, more slots make it easier to find a seed without collisions
+const constexpr std::size_t SLOTS_PER_SUFFIX = 2;
+// seeds tried before the number of slots is doubled
+const constexpr std::uint32_t SEEDS_PER_SIZE = 64;
+}
+
 SuffixTable::SuffixTable(ScriptingEnvironment &scripting_environment)
+    : SuffixTable(scripting_environment.GetNameSuffixList())
 {
-    suffixes = scripting_environment.GetNameSuffixList();
+}
 
+SuffixTable::SuffixTable(std::vector<std::string> suffixes_) : suffixes(std::move(suffixes_))
+{
     for (auto &suffix : suffixes)
-        boost::algorithm::to_lower(suffix);
+        std::transform(suffix.begin(), suffix.end(), suffix.begin(), toLower);
+
+    std::sort(suffixes.begin(), suffixes.end());
+    suffixes.erase(std::unique(suffixes.begin(), suffixes.end()), suffixes.end());
 
-    auto into = std::inserter(suffix_set, end(suffix_set));
-    auto to_view = [](const auto &s) { return util::StringView{s}; };
-    std::transform(begin(suffixes), end(suffixes), into, to_view);
+    for (const auto &suffix : suffixes)
+        max_length = std::max(max_length, suffix.size());
+
+    // The suffixes are distinct, so there always is a number of slots and a seed that maps all
+    // of them to different slots. Profiles have a few dozen suffixes, this takes a few tries.
+    std::size_t num_slots = 1;
+    while (num_slots < SLOTS_PER_SUFFIX * suffixes.size())
+        num_slots *= 2;
+
+    for (seed = 0;; ++seed)
+    {
+        if (seed > 0 && seed % SEEDS_PER_SIZE == 0)
+            num_slots *= 2;
+
+        slots.assign(num_slots, 0);
+        std::uint32_t index = 0;
+        for (; index < suffixes.size(); ++index)
+        {
+            auto &slot = slots[hash(suffixes[index]) & (num_slots - 1)];
+            if (slot != 0)
+                break;
+            slot = index + 1;
+        }
+
+        if (index == suffixes.size())
+            break;
+    }
+}
+
+std::uint32_t SuffixTable::hash(util::StringView string) const
+{
+    // FNV-1a of the lower-cased characters
+    std::uint32_t value = 2166136261u ^ seed;
+    for (const auto character : string)
+    {
+        value ^= static_cast<unsigned char>(toLower(character));
+        value *= 16777619u;
+    }
+    // the slot index is taken from the low bits, mix the high bits into them
+    return value ^ (value >> 15);
 }
 
 bool SuffixTable::isSuffix(const std::string &possible_suffix) const
@@ -30,7 +86,20 @@ bool SuffixTable::isSuffix(const std::string &possible_suffix) const
 
 bool SuffixTable::isSuffix(util::StringView possible_suffix) const
 {
-    return suffix_set.count(possible_suffix) > 0;
+    if (possible_suffix.size() > max_length || suffixes.empty())
+        return false;
+
+    const auto slot = slots[hash(possible_suffix) & (slots.size() - 1)];
+    if (slot == 0)
+        return false;
+
+    BOOST_ASSERT(slot <= suffixes.size());
+    const auto &suffix = suffixes[slot - 1];
+    return suffix.size() == possible_suffix.size() &&
+           std::equal(suffix.begin(),
+                      suffix.end(),
+                      possible_suffix.begin(),
+                      [](const char lhs, const char rhs) { return lhs == toLower(rhs); });
 }
 
 } /* namespace extractor */
@@ -4,21 +4,63 @@
 #include "osrm/match_parameters.hpp"
 #include "osrm/nearest_parameters.hpp"
 #include "osrm/route_parameters.hpp"
+#include "osrm/table_matrices.hpp"
 #include "osrm/table_parameters.hpp"
 #include "osrm/tile_parameters.hpp"
 #include "osrm/trip_parameters.hpp"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
 #include <exception>
-#include <type_traits>
+#include <functional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "nodejs/node_osrm.hpp"
 #include "nodejs/node_osrm_support.hpp"
+#include "nodejs/worker_pool.hpp"
 
 namespace node_osrm
 {
 
-Engine::Engine(osrm::EngineConfig &config) : Base(), this_(std::make_shared<osrm::OSRM>(config)) {}
+// OSRM::Table is overloaded for pre-rendered JSON, the bindings want the json::Object or the
+// flat matrices for format 'typed'
+using TableMemFn = osrm::Status (osrm::OSRM::*)(const osrm::TableParameters &,
+                                               osrm::json::Object &) const;
+using TypedTableMemFn = osrm::Status (osrm::OSRM::*)(const osrm::TableParameters &,
+                                                    osrm::TableMatrices &) const;
+
+// The result type a service fills
+template <typename ServiceMemFn> struct ServiceResult;
+template <typename ParametersT, typename ResultT>
+struct ServiceResult<osrm::Status (osrm::OSRM::*)(const ParametersT &, ResultT &) const>
+{
+    using type = ResultT;
+};
+
+Engine::Engine(osrm::EngineConfig &config, std::size_t pool_size)
+    : Base(), this_(std::make_shared<osrm::OSRM>(config)),
+      pool(pool_size > 0 ? std::make_shared<WorkerPool>(pool_size) : nullptr)
+{
+}
+
+// Runs the worker on the pool of the engine if it has one, on libuv's thread pool otherwise
+inline void queueWorker(const Engine &self, Nan::AsyncWorker *worker)
+{
+    if (self.pool)
+    {
+        self.pool->Queue(worker);
+    }
+    else
+    {
+        Nan::AsyncQueueWorker(worker);
+    }
+}
 
 Nan::Persistent<v8::Function> &Engine::constructor()
 {
@@ -40,6 +82,8 @@ NAN_MODULE_INIT(Engine::Init)
     SetPrototypeMethod(fnTp, "tile", tile);
     SetPrototypeMethod(fnTp, "match", match);
     SetPrototypeMethod(fnTp, "trip", trip);
+    SetPrototypeMethod(fnTp, "batch", batch);
+    SetPrototypeMethod(fnTp, "matchBatch", matchBatch);
 
     const auto fn = Nan::GetFunction(fnTp).ToLocalChecked();
 
@@ -67,7 +111,7 @@ NAN_MODULE_INIT(Engine::Init)
  * ```
  *
  * @param {Object|String} [options={shared_memory: true}] Options for creating an OSRM object or string to the `.osrm` file.
- * @param {String} [options.algorithm] The algorithm to use for routing. Can be 'CH', 'CoreCH' or 'MLD'. Default is 'CH'.
+ * @param {String} [options.algorithm] The algorithm to use for routing. Can be 'CH', 'CoreCH', 'MLD' or 'CCH'. Default is 'CH'.
  *        Make sure you prepared the dataset with the correct toolchain.
  * @param {Boolean} [options.shared_memory] Connects to the persistent shared memory datastore.
  *        This requires you to run `osrm-datastore` prior to creating an `OSRM` object.
@@ -78,6 +122,8 @@ NAN_MODULE_INIT(Engine::Init)
  * @param {Number} [options.max_locations_map_matching] Max. locations supported in map-matching query (default: unlimited).
  * @param {Number} [options.max_results_nearest] Max. results supported in nearest query (default: unlimited).
  * @param {Number} [options.max_alternatives] Max.number of alternatives supported in alternative routes query (default: 3).
+ * @param {Number} [options.threads] Run queries on a pool of this many threads owned by the OSRM object instead of on libuv's thread pool,
+ *        which node shares with file system and DNS work. By default or if `0` queries use libuv's thread pool (see `UV_THREADPOOL_SIZE`).
  *
  * @class OSRM
  *
@@ -93,7 +139,11 @@ NAN_METHOD(Engine::New)
             if (!config)
                 return;
 
-            auto *const self = new Engine(*config);
+            std::size_t pool_size;
+            if (!argumentsToWorkerPoolSize(info, pool_size))
+                return;
+
+            auto *const self = new Engine(*config, pool_size);
             self->Wrap(info.This());
         }
         catch (const std::exception &ex)
@@ -114,9 +164,13 @@ template <typename ParameterParser, typename ServiceMemFn>
 inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
                   ParameterParser argsToParams,
                   ServiceMemFn service,
-                  bool requires_multiple_coordinates)
+                  bool requires_multiple_coordinates,
+                  const PluginParameters &plugin_params)
 {
-    auto params = argsToParams(info, requires_multiple_coordinates);
+    if (info.Length() < 2)
+        return Nan::ThrowTypeError("Two arguments required");
+
+    auto params = argsToParams(info[0], requires_multiple_coordinates);
     if (!params)
         return;
 
@@ -134,10 +188,11 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
 
         Worker(std::shared_ptr<osrm::OSRM> osrm_,
                ParamPtr params_,
+               PluginParameters plugin_params_,
                ServiceMemFn service,
                Nan::Callback *callback)
             : Base(callback), osrm{std::move(osrm_)}, service{std::move(service)},
-              params{std::move(params_)}
+              params{std::move(params_)}, plugin_params{plugin_params_}
         {
         }
 
@@ -145,6 +200,7 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
         {
             const auto status = ((*osrm).*(service))(*params, result);
             ParseResult(status, result);
+            renderToBuffer(params, plugin_params, result, buffer);
         }
         catch (const std::exception &e)
         {
@@ -156,7 +212,8 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
             Nan::HandleScope scope;
 
             const constexpr auto argc = 2u;
-            v8::Local<v8::Value> argv[argc] = {Nan::Null(), render(result)};
+            v8::Local<v8::Value> argv[argc] = {Nan::Null(),
+                                               buffer.empty() ? render(result) : render(buffer)};
 
             callback->Call(argc, argv);
         }
@@ -165,18 +222,30 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
         std::shared_ptr<osrm::OSRM> osrm;
         ServiceMemFn service;
         const ParamPtr params;
+        const PluginParameters plugin_params;
 
-        // All services return json::Object .. except for Tile!
-        using ObjectOrString =
-            typename std::conditional<std::is_same<ParamPtr, tile_parameters_ptr>::value,
-                                      std::string,
-                                      osrm::json::Object>::type;
-
-        ObjectOrString result;
+        // All services return json::Object .. except for Tile and typed tables!
+        typename ServiceResult<ServiceMemFn>::type result;
+        // Rendered on the worker thread for output_format 'binary' and format 'json_buffer'
+        std::vector<char> buffer;
     };
 
     auto *callback = new Nan::Callback{info[info.Length() - 1].As<v8::Function>()};
-    Nan::AsyncQueueWorker(new Worker{self->this_, std::move(params), service, callback});
+    queueWorker(*self,
+                new Worker{self->this_, std::move(params), plugin_params, service, callback});
+}
+
+template <typename ParameterParser, typename ServiceMemFn>
+inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
+                  ParameterParser argsToParams,
+                  ServiceMemFn service,
+                  bool requires_multiple_coordinates)
+{
+    PluginParameters plugin_params;
+    if (!argumentsToPluginParameters(info, plugin_params))
+        return;
+
+    async(info, argsToParams, service, requires_multiple_coordinates, plugin_params);
 }
 
 // clang-format off
@@ -191,6 +260,7 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
  *                                   Can be `null` or an array of `[{value},{range}]` with `integer 0 .. 360,integer 0 .. 180`.
  * @param {Array} [options.radiuses] Limits the coordinate snapping to streets in the given radius in meters. Can be `null` (unlimited, default) or `double >= 0`.
  * @param {Array} [options.hints] Hints for the coordinate snapping. Array of base64 encoded strings.
+ * @param {String} [options.output_format=json] Return the result as object (`json`) or as Buffer in the [binary response format](../http.md#binary-responses) (`binary`).
  * @param {Boolean} [options.alternatives=false] Search for alternative routes.
  * @param {Number} [options.alternatives=0] Search for up to this many alternative routes.
  * *Please note that even if alternative routes are requested, a result cannot be guaranteed.*
@@ -201,6 +271,9 @@ inline void async(const Nan::FunctionCallbackInfo<v8::Value> &info,
  * @param {Boolean} [options.continue_straight] Forces the route to keep going straight at waypoints and don't do a uturn even if it would be faster. Default value depends on the profile.
  * @param {Array} [options.approaches] Keep waypoints on curb side. Can be `null` (unrestricted, default) or `curb`.
  *                  `null`/`true`/`false`
+ * @param {Object} [plugin_config] Configuration of the bindings for this call.
+ * @param {String} [plugin_config.format=object] `object` returns a Javascript object as described below, `json_buffer`
+ *        returns a Buffer holding the JSON encoded result. The Buffer is rendered on the worker thread and does not block the event loop.
  * @param {Function} callback
  *
  * @returns {Object} An array of [Waypoint](#waypoint) objects representing all waypoints in order AND an array of [`Route`](#route) objects ordered by descending recommendation rank.
@@ -233,9 +306,13 @@ NAN_METHOD(Engine::route) //
  *                                   Can be `null` or an array of `[{value},{range}]` with `integer 0 .. 360,integer 0 .. 180`.
  * @param {Array} [options.radiuses] Limits the coordinate snapping to streets in the given radius in meters. Can be `null` (unlimited, default) or `double >= 0`.
  * @param {Array} [options.hints] Hints for the coordinate snapping. Array of base64 encoded strings.
+ * @param {String} [options.output_format=json] Return the result as object (`json`) or as Buffer in the [binary response format](../http.md#binary-responses) (`binary`).
  * @param {Number} [options.number=1] Number of nearest segments that should be returned.
  * Must be an integer greater than or equal to `1`.
  * @param {Array} [options.approaches] Keep waypoints on curb side. Can be `null` (unrestricted, default) or `curb`.
+ * @param {Object} [plugin_config] Configuration of the bindings for this call.
+ * @param {String} [plugin_config.format=object] `object` returns a Javascript object as described below, `json_buffer`
+ *        returns a Buffer holding the JSON encoded result. The Buffer is rendered on the worker thread and does not block the event loop.
  * @param {Function} callback
  *
  * @returns {Object} containing `waypoints`.
@@ -272,17 +349,27 @@ NAN_METHOD(Engine::nearest) //
  *                                   Can be `null` or an array of `[{value},{range}]` with `integer 0 .. 360,integer 0 .. 180`.
  * @param {Array} [options.radiuses] Limits the coordinate snapping to streets in the given radius in meters. Can be `null` (unlimited, default) or `double >= 0`.
  * @param {Array} [options.hints] Hints for the coordinate snapping. Array of base64 encoded strings.
+ * @param {String} [options.output_format=json] Return the result as object (`json`) or as Buffer in the [binary response format](../http.md#binary-responses) (`binary`).
  * @param {Array} [options.sources] An array of `index` elements (`0 <= integer < #coordinates`) to
  * use
  * location with given index as source. Default is to use all.
  * @param {Array} [options.destinations] An array of `index` elements (`0 <= integer <
  * #coordinates`) to use location with given index as destination. Default is to use all.
  * @param {Array} [options.approaches] Keep waypoints on curb side. Can be `null` (unrestricted, default) or `curb`.
+ * @param {Array} [options.annotations] Return the requested table or tables in response. Can be `['duration']` (default), `['distance']` or `['duration', 'distance']`.
+ * @param {Object} [plugin_config] Configuration of the bindings for this call.
+ * @param {String} [plugin_config.format=object] `object` returns a Javascript object as described below, `json_buffer`
+ *        returns a Buffer holding the JSON encoded result. The Buffer is rendered on the worker thread and does not block the event loop.
+ *        `typed` returns `durations` and `distances` as one `Float64Array` each in row-major order with `rows` and `columns` giving
+ *        their dimensions, entries without a route are `NaN`. The matrices are filled on the worker thread without building JSON,
+ *        `output_format` is ignored.
  * @param {Function} callback
  *
- * @returns {Object} containing `durations`, `sources`, and `destinations`.
+ * @returns {Object} containing `durations`, `distances`, `sources`, and `destinations`.
  * **`durations`**: array of arrays that stores the matrix in row-major order. `durations[i][j]` gives the travel time from the i-th waypoint to the j-th waypoint.
  *                  Values are given in seconds.
+ * **`distances`**: array of arrays that stores the matrix in row-major order. `distances[i][j]` gives the distance of the fastest route from the i-th waypoint to the j-th waypoint.
+ *                  Values are given in meters and only returned if requested.
  * **`sources`**: array of [`Ẁaypoint`](#waypoint) objects describing all sources in order.
  * **`destinations`**: array of [`Ẁaypoint`](#waypoint) objects describing all destinations in order.
  *
@@ -300,11 +387,33 @@ NAN_METHOD(Engine::nearest) //
  *   console.log(response.sources); // array of Waypoint objects
  *   console.log(response.destinations); // array of Waypoint objects
  * });
+ * osrm.table(options, {format: 'typed'}, function(err, response) {
+ *   console.log(response.durations[1 * response.columns + 2]); // duration from the second to the third waypoint
+ * });
  */
 // clang-format on
 NAN_METHOD(Engine::table) //
 {
-    async(info, &argumentsToTableParameter, &osrm::OSRM::Table, true);
+    PluginParameters plugin_params;
+    if (!argumentsToPluginParameters(info, plugin_params, true))
+        return;
+
+    if (plugin_params.typed_arrays)
+    {
+        async(info,
+              &argumentsToTableParameter,
+              static_cast<TypedTableMemFn>(&osrm::OSRM::Table),
+              true,
+              plugin_params);
+    }
+    else
+    {
+        async(info,
+              &argumentsToTableParameter,
+              static_cast<TableMemFn>(&osrm::OSRM::Table),
+              true,
+              plugin_params);
+    }
 }
 
 // clang-format off
@@ -353,6 +462,7 @@ NAN_METHOD(Engine::tile)
  * @param {Array} [options.bearings] Limits the search to segments with given bearing in degrees towards true north in clockwise direction.
  *                                   Can be `null` or an array of `[{value},{range}]` with `integer 0 .. 360,integer 0 .. 180`.
  * @param {Array} [options.hints] Hints for the coordinate snapping. Array of base64 encoded strings.
+ * @param {String} [options.output_format=json] Return the result as object (`json`) or as Buffer in the [binary response format](../http.md#binary-responses) (`binary`).
  * @param {Boolean} [options.steps=false] Return route steps for each route.
  * @param {Array|Boolean} [options.annotations=false] An array with strings of `duration`, `nodes`, `distance`, `weight`, `datasources`, `speed` or boolean for enabling/disabling all.
  * @param {String} [options.geometries=polyline] Returned route geometry format (influences overview and per step). Can also be `geojson`.
@@ -362,6 +472,9 @@ NAN_METHOD(Engine::tile)
  * @param {String} [options.gaps] Allows the input track splitting based on huge timestamp gaps between points. Either `split` or `ignore` (optional, default `split`).
  * @param {Boolean} [options.tidy] Allows the input track modification to obtain better matching quality for noisy tracks (optional, default `false`).
  *
+ * @param {Object} [plugin_config] Configuration of the bindings for this call.
+ * @param {String} [plugin_config.format=object] `object` returns a Javascript object as described below, `json_buffer`
+ *        returns a Buffer holding the JSON encoded result. The Buffer is rendered on the worker thread and does not block the event loop.
  * @param {Function} callback
  *
  * @returns {Object} containing `tracepoints` and `matchings`.
@@ -422,10 +535,14 @@ NAN_METHOD(Engine::match) //
  *                                   Can be `null` or an array of `[{value},{range}]` with `integer 0 .. 360,integer 0 .. 180`.
  * @param {Array} [options.radiuses] Limits the coordinate snapping to streets in the given radius in meters. Can be `double >= 0` or `null` (unlimited, default).
  * @param {Array} [options.hints] Hints for the coordinate snapping. Array of base64 encoded strings.
+ * @param {String} [options.output_format=json] Return the result as object (`json`) or as Buffer in the [binary response format](../http.md#binary-responses) (`binary`).
  * @param {Boolean} [options.steps=false] Return route steps for each route.
  * @param {Array|Boolean} [options.annotations=false] An array with strings of `duration`, `nodes`, `distance`, `weight`, `datasources`, `speed` or boolean for enabling/disabling all.
  * @param {String} [options.geometries=polyline] Returned route geometry format (influences overview and per step). Can also be `geojson`.
  * @param {String} [options.overview=simplified] Add overview geometry either `full`, `simplified`
+ * @param {Object} [plugin_config] Configuration of the bindings for this call.
+ * @param {String} [plugin_config.format=object] `object` returns a Javascript object as described below, `json_buffer`
+ *        returns a Buffer holding the JSON encoded result. The Buffer is rendered on the worker thread and does not block the event loop.
  * @param {Function} callback
  * @param {Boolean} [options.roundtrip=true] Return route is a roundtrip.
  * @param {String} [options.source=any] Return route starts at `any` or `first` coordinate.
@@ -462,6 +579,328 @@ NAN_METHOD(Engine::trip) //
     async(info, &argumentsToTripParameter, &osrm::OSRM::Trip, true);
 }
 
+// A parsed query of a batch, runs the service and renders its result
+struct BatchResult
+{
+    osrm::json::Object object;
+    // Rendered for output_format 'binary' and format 'json_buffer'
+    std::vector<char> buffer;
+    // Set if the query failed, the other results of the batch are not affected
+    std::string error;
+};
+
+using BatchQuery = std::function<void(const osrm::OSRM &, const PluginParameters &, BatchResult &)>;
+
+// An Error in place of every query that failed
+inline v8::Local<v8::Array> renderBatchResults(const std::vector<BatchResult> &results)
+{
+    v8::Local<v8::Array> rendered = Nan::New<v8::Array>(results.size());
+    for (std::uint32_t index = 0; index < results.size(); ++index)
+    {
+        const auto &result = results[index];
+        if (!result.error.empty())
+            rendered->Set(index, Nan::Error(result.error.c_str()));
+        else if (!result.buffer.empty())
+            rendered->Set(index, render(result.buffer));
+        else
+            rendered->Set(index, render(result.object));
+    }
+    return rendered;
+}
+
+template <typename ParamPtr, typename ServiceMemFn>
+inline BatchQuery makeBatchQuery(ParamPtr params, ServiceMemFn service)
+{
+    BOOST_ASSERT(params->IsValid());
+    std::shared_ptr<typename ParamPtr::element_type> shared_params = std::move(params);
+
+    return [shared_params, service](const osrm::OSRM &osrm,
+                                    const PluginParameters &plugin_params,
+                                    BatchResult &result) {
+        const auto status = (osrm.*(service))(*shared_params, result.object);
+        ParseResult(status, result.object);
+        renderToBuffer(shared_params, plugin_params, result.object, result.buffer);
+    };
+}
+
+// Parses one {service, params} entry of a batch, throws a javascript exception on failure
+inline boost::optional<BatchQuery> argumentsToBatchQuery(const v8::Local<v8::Value> &query)
+{
+    if (!query->IsObject())
+    {
+        Nan::ThrowTypeError("Batch queries must be objects of {service, params}");
+        return boost::none;
+    }
+    v8::Local<v8::Object> obj = Nan::To<v8::Object>(query).ToLocalChecked();
+
+    v8::Local<v8::Value> service = obj->Get(Nan::New("service").ToLocalChecked());
+    if (service.IsEmpty())
+        return boost::none;
+    if (!service->IsString())
+    {
+        Nan::ThrowTypeError("Batch query service must be a string");
+        return boost::none;
+    }
+    const Nan::Utf8String service_utf8str(service);
+    const std::string service_str{*service_utf8str, *service_utf8str + service_utf8str.length()};
+
+    v8::Local<v8::Value> options = obj->Get(Nan::New("params").ToLocalChecked());
+    if (options.IsEmpty())
+        return boost::none;
+
+    const auto make = [](auto params, auto service_fn) -> boost::optional<BatchQuery> {
+        if (!params)
+            return boost::none;
+        return makeBatchQuery(std::move(params), service_fn);
+    };
+
+    if (service_str == "route")
+        return make(argumentsToRouteParameter(options, true), &osrm::OSRM::Route);
+    if (service_str == "nearest")
+        return make(argumentsToNearestParameter(options, false), &osrm::OSRM::Nearest);
+    if (service_str == "table")
+        return make(argumentsToTableParameter(options, true),
+                    static_cast<TableMemFn>(&osrm::OSRM::Table));
+    if (service_str == "match")
+        return make(argumentsToMatchParameter(options, true), &osrm::OSRM::Match);
+    if (service_str == "trip")
+        return make(argumentsToTripParameter(options, true), &osrm::OSRM::Trip);
+
+    Nan::ThrowTypeError("Batch query service must be one of [route, nearest, table, match, trip]");
+    return boost::none;
+}
+
+// clang-format off
+/**
+ * Runs several queries in one go and returns all their results in a single callback.
+ * The queries of a batch are spread over a TBB thread pool instead of queueing one libuv work item per query,
+ * the search heaps of each thread are reused from query to query.
+ *
+ * @name batch
+ * @memberof OSRM
+ * @param {Array} queries Array of `{service, params}` objects. `service` is one of `route`, `nearest`, `table`, `match` or `trip`,
+ *        `params` are the options the corresponding method takes.
+ * @param {Object} [plugin_config] Configuration of the bindings for this call, applies to all queries.
+ * @param {String} [plugin_config.format=object] `object` returns Javascript objects, `json_buffer` a Buffer holding the JSON encoded result of each query.
+ * @param {Function} callback
+ *
+ * @returns {Array} The result of each query in the order of `queries`. A query that failed yields an `Error` in its place, the other
+ *          queries are not affected.
+ *
+ * @example
+ * var osrm = new OSRM('network.osrm');
+ * var queries = [
+ *   {service: 'route', params: {coordinates: [[13.438640,52.519930], [13.415852,52.513191]]}},
+ *   {service: 'table', params: {coordinates: [[13.438640,52.519930], [13.415852,52.513191]]}}
+ * ];
+ * osrm.batch(queries, function(err, results) {
+ *   if (err) throw err;
+ *   console.log(results[0].routes); // array of Route objects
+ *   console.log(results[1].durations); // array of arrays
+ * });
+ */
+// clang-format on
+NAN_METHOD(Engine::batch) //
+{
+    if (info.Length() < 2)
+        return Nan::ThrowTypeError("Two arguments required");
+
+    if (!info[0]->IsArray())
+        return Nan::ThrowTypeError("First arg must be an array of queries");
+
+    const auto queries_array = v8::Local<v8::Array>::Cast(info[0]);
+    std::vector<BatchQuery> queries;
+    queries.reserve(queries_array->Length());
+    for (std::uint32_t index = 0; index < queries_array->Length(); ++index)
+    {
+        auto query = argumentsToBatchQuery(queries_array->Get(index));
+        if (!query)
+            return;
+        queries.push_back(std::move(*query));
+    }
+
+    PluginParameters plugin_params;
+    if (!argumentsToPluginParameters(info, plugin_params))
+        return;
+
+    if (!info[info.Length() - 1]->IsFunction())
+        return Nan::ThrowTypeError("last argument must be a callback function");
+
+    auto *const self = Nan::ObjectWrap::Unwrap<Engine>(info.Holder());
+
+    struct Worker final : Nan::AsyncWorker
+    {
+        using Base = Nan::AsyncWorker;
+
+        Worker(std::shared_ptr<osrm::OSRM> osrm_,
+               std::vector<BatchQuery> queries_,
+               PluginParameters plugin_params_,
+               Nan::Callback *callback)
+            : Base(callback), osrm{std::move(osrm_)}, queries{std::move(queries_)},
+              plugin_params{plugin_params_}, results(queries.size())
+        {
+        }
+
+        void Execute() override
+        {
+            // TBB keeps its worker threads alive, so every thread reuses its search heaps
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, queries.size()),
+                              [this](const tbb::blocked_range<std::size_t> &range) {
+                                  for (auto index = range.begin(); index != range.end(); ++index)
+                                  {
+                                      try
+                                      {
+                                          queries[index](*osrm, plugin_params, results[index]);
+                                      }
+                                      catch (const std::exception &e)
+                                      {
+                                          results[index].error = e.what();
+                                      }
+                                  }
+                              });
+        }
+
+        void HandleOKCallback() override
+        {
+            Nan::HandleScope scope;
+
+            v8::Local<v8::Value> rendered = renderBatchResults(results);
+
+            const constexpr auto argc = 2u;
+            v8::Local<v8::Value> argv[argc] = {Nan::Null(), rendered};
+
+            callback->Call(argc, argv);
+        }
+
+        // Keeps the OSRM object alive even after shutdown until we're done with callback
+        std::shared_ptr<osrm::OSRM> osrm;
+        const std::vector<BatchQuery> queries;
+        const PluginParameters plugin_params;
+        std::vector<BatchResult> results;
+    };
+
+    auto *callback = new Nan::Callback{info[info.Length() - 1].As<v8::Function>()};
+    queueWorker(*self, new Worker{self->this_, std::move(queries), plugin_params, callback});
+}
+
+// clang-format off
+/**
+ * Matches many traces in one go. The traces are spread over all cores by libosrm, every thread keeps its
+ * search heaps and map matching state from trace to trace and the results of all traces come back in a single callback.
+ *
+ * @name matchBatch
+ * @memberof OSRM
+ * @param {Array} traces Array of the options objects `match` takes, one per trace.
+ * @param {Object} [plugin_config] Configuration of the bindings for this call, applies to all traces.
+ * @param {String} [plugin_config.format=object] `object` returns Javascript objects, `json_buffer` a Buffer holding the JSON encoded result of each trace.
+ * @param {Function} callback
+ *
+ * @returns {Array} The result of each trace in the order of `traces`, like `match` returns it. A trace that failed yields an `Error`
+ *          in its place, the other traces are not affected.
+ *
+ * @example
+ * var osrm = new OSRM('network.osrm');
+ * var traces = [
+ *   {coordinates: [[13.393252,52.542648],[13.39478,52.543079],[13.397389,52.542107]], timestamps: [1424684612, 1424684616, 1424684620]},
+ *   {coordinates: [[13.438640,52.519930],[13.415852,52.513191]]}
+ * ];
+ * osrm.matchBatch(traces, function(err, results) {
+ *   if (err) throw err;
+ *   console.log(results[0].matchings); // array of Route objects
+ * });
+ */
+// clang-format on
+NAN_METHOD(Engine::matchBatch) //
+{
+    if (info.Length() < 2)
+        return Nan::ThrowTypeError("Two arguments required");
+
+    if (!info[0]->IsArray())
+        return Nan::ThrowTypeError("First arg must be an array of traces");
+
+    const auto traces_array = v8::Local<v8::Array>::Cast(info[0]);
+    std::vector<osrm::MatchParameters> traces;
+    traces.reserve(traces_array->Length());
+    for (std::uint32_t index = 0; index < traces_array->Length(); ++index)
+    {
+        auto params = argumentsToMatchParameter(traces_array->Get(index), true);
+        if (!params)
+            return;
+        traces.push_back(std::move(*params));
+    }
+
+    PluginParameters plugin_params;
+    if (!argumentsToPluginParameters(info, plugin_params))
+        return;
+
+    if (!info[info.Length() - 1]->IsFunction())
+        return Nan::ThrowTypeError("last argument must be a callback function");
+
+    auto *const self = Nan::ObjectWrap::Unwrap<Engine>(info.Holder());
+
+    struct Worker final : Nan::AsyncWorker
+    {
+        using Base = Nan::AsyncWorker;
+
+        Worker(std::shared_ptr<osrm::OSRM> osrm_,
+               std::vector<osrm::MatchParameters> traces_,
+               PluginParameters plugin_params_,
+               Nan::Callback *callback)
+            : Base(callback), osrm{std::move(osrm_)}, traces{std::move(traces_)},
+              plugin_params{plugin_params_}, results(traces.size())
+        {
+        }
+
+        void Execute() override try
+        {
+            std::vector<osrm::json::Object> objects;
+            osrm->MatchBatch(traces, objects);
+            for (std::size_t index = 0; index < objects.size(); ++index)
+            {
+                auto &result = results[index];
+                result.object = std::move(objects[index]);
+                const auto &code = result.object.values.at("code").get<osrm::json::String>().value;
+                if (code != "Ok")
+                {
+                    result.error = code;
+                    continue;
+                }
+                ParseResult(osrm::Status::Ok, result.object);
+                if (traces[index].output_format ==
+                    osrm::engine::api::BaseParameters::OutputFormatType::Binary)
+                    osrm::util::json::renderBinary(result.buffer, result.object);
+                else if (plugin_params.render_json_buffer)
+                    osrm::util::json::render(result.buffer, result.object);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            SetErrorMessage(e.what());
+        }
+
+        void HandleOKCallback() override
+        {
+            Nan::HandleScope scope;
+
+            v8::Local<v8::Value> rendered = renderBatchResults(results);
+
+            const constexpr auto argc = 2u;
+            v8::Local<v8::Value> argv[argc] = {Nan::Null(), rendered};
+
+            callback->Call(argc, argv);
+        }
+
+        // Keeps the OSRM object alive even after shutdown until we're done with callback
+        std::shared_ptr<osrm::OSRM> osrm;
+        const std::vector<osrm::MatchParameters> traces;
+        const PluginParameters plugin_params;
+        std::vector<BatchResult> results;
+    };
+
+    auto *callback = new Nan::Callback{info[info.Length() - 1].As<v8::Function>()};
+    queueWorker(*self, new Worker{self->this_, std::move(traces), plugin_params, callback});
+}
+
 /**
  * Responses
  * @class Responses
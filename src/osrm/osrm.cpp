@@ -1,19 +1,56 @@
 #include "osrm/osrm.hpp"
 #include "engine/algorithm.hpp"
+#include "engine/api/isochrone_parameters.hpp"
 #include "engine/api/match_parameters.hpp"
 #include "engine/api/nearest_parameters.hpp"
 #include "engine/api/route_parameters.hpp"
+#include "engine/api/table_matrices.hpp"
 #include "engine/api/table_parameters.hpp"
+#include "engine/api/table_writer.hpp"
+#include "engine/api/tile_parameters.hpp"
 #include "engine/api/trip_parameters.hpp"
+#include "engine/async_executor.hpp"
 #include "engine/engine.hpp"
 #include "engine/engine_config.hpp"
+#include "engine/engine_statistics.hpp"
 #include "engine/status.hpp"
 
+#include <exception>
 #include <memory>
+#include <utility>
 
 namespace osrm
 {
 
+namespace
+{
+// Runs service(parameters, result) of the engine on the executor and hands the outcome to the
+// callback, the parameters live in the task until it ran
+template <typename ResultT, typename ParametersT, typename ServiceT>
+void runAsync(engine::AsyncExecutor &executor,
+              ParametersT parameters,
+              OSRM::Callback<ResultT> callback,
+              ServiceT service)
+{
+    executor.Post([parameters = std::move(parameters),
+                   callback = std::move(callback),
+                   service = std::move(service)]() {
+        ResultT result;
+        Status status;
+        try
+        {
+            status = service(parameters, result);
+        }
+        catch (...)
+        {
+            callback(std::current_exception(), Status::Error, ResultT{});
+            return;
+        }
+        callback(nullptr, status, std::move(result));
+    });
+}
+}
+
 // Pimpl idiom
 
 OSRM::OSRM(engine::EngineConfig &config)
@@ -21,6 +58,7 @@ OSRM::OSRM(engine::EngineConfig &config)
     using CH = engine::routing_algorithms::ch::Algorithm;
     using CoreCH = engine::routing_algorithms::corech::Algorithm;
     using MLD = engine::routing_algorithms::mld::Algorithm;
+    using CCH = engine::routing_algorithms::cch::Algorithm;
 
     // First, check that necessary core data is available
     if (!config.use_shared_memory && !config.storage_config.IsValid())
@@ -34,7 +72,7 @@ OSRM::OSRM(engine::EngineConfig &config)
         using mutex_type = typename decltype(barrier)::mutex_type;
         boost::interprocess::scoped_lock<mutex_type> current_region_lock(barrier.get_mutex());
 
-        auto mem = storage::makeSharedMemory(barrier.data().region);
+        auto mem = storage::makeSharedMemory(barrier.data().static_region);
         auto layout = reinterpret_cast<storage::DataLayout *>(mem->Ptr());
         if (layout->GetBlockSize(storage::DataLayout::NAME_CHAR_DATA) == 0)
             throw util::exception(
@@ -77,6 +115,13 @@ OSRM::OSRM(engine::EngineConfig &config)
             throw util::exception("Dataset is not compatible with MLD.");
         }
     }
+    else if (config.algorithm == EngineConfig::Algorithm::CCH)
+    {
+        if (!engine::Engine<CCH>::CheckCompability(config))
+        {
+            throw util::exception("Dataset is not compatible with CCH.");
+        }
+    }
 
     switch (config.algorithm)
     {
@@ -89,13 +134,24 @@ OSRM::OSRM(engine::EngineConfig &config)
     case EngineConfig::Algorithm::MLD:
         engine_ = std::make_unique<engine::Engine<MLD>>(config);
         break;
+    case EngineConfig::Algorithm::CCH:
+        engine_ = std::make_unique<engine::Engine<CCH>>(config);
+        break;
     default:
         util::exception("Algorithm not implemented!");
     }
+
+    executor_ = std::make_unique<engine::AsyncExecutor>(config.async_threads);
 }
 OSRM::~OSRM() = default;
 OSRM::OSRM(OSRM &&) noexcept = default;
-OSRM &OSRM::operator=(OSRM &&) noexcept = default;
+OSRM &OSRM::operator=(OSRM &&other) noexcept
+{
+    // waits for the queries in flight on the old engine before destroying it
+    executor_ = std::move(other.executor_);
+    engine_ = std::move(other.engine_);
+    return *this;
+}
 
 // Forward to implementation
 
@@ -110,6 +166,24 @@ engine::Status OSRM::Table(const engine::api::TableParameters &params, json::Obj
     return engine_->Table(params, result);
 }
 
+engine::Status OSRM::Table(const engine::api::TableParameters &params,
+                           std::vector<char> &result) const
+{
+    return engine_->Table(params, result);
+}
+
+engine::Status OSRM::Table(const engine::api::TableParameters &params,
+                           engine::api::TableMatrices &result) const
+{
+    return engine_->Table(params, result);
+}
+
+engine::Status OSRM::Table(const engine::api::TableParameters &params,
+                           engine::api::TableWriter &result) const
+{
+    return engine_->Table(params, result);
+}
+
 engine::Status OSRM::Nearest(const engine::api::NearestParameters &params,
                              json::Object &result) const
 {
@@ -126,9 +200,117 @@ engine::Status OSRM::Match(const engine::api::MatchParameters &params, json::Obj
     return engine_->Match(params, result);
 }
 
+engine::Status OSRM::MatchBatch(const std::vector<engine::api::MatchParameters> &params,
+                                std::vector<json::Object> &results) const
+{
+    return engine_->MatchBatch(params, results);
+}
+
 engine::Status OSRM::Tile(const engine::api::TileParameters &params, std::string &result) const
 {
     return engine_->Tile(params, result);
 }
 
+engine::Status OSRM::Isochrone(const engine::api::IsochroneParameters &params,
+                               json::Object &result) const
+{
+    return engine_->Isochrone(params, result);
+}
+
+engine::Status OSRM::Isochrone(const engine::api::IsochroneParameters &params,
+                               std::string &result) const
+{
+    return engine_->Isochrone(params, result);
+}
+
+engine::EngineStatistics OSRM::GetStatistics() const { return engine_->GetStatistics(); }
+
+// Run the implementation on the executor
+
+void OSRM::RouteAsync(engine::api::RouteParameters params, Callback<json::Object> callback) const
+{
+    const auto engine = engine_.get();
+    runAsync<json::Object>(
+        *executor_,
+        std::move(params),
+        std::move(callback),
+        [engine](const engine::api::RouteParameters &params, json::Object &result) {
+            return engine->Route(params, result);
+        });
+}
+
+void OSRM::TableAsync(engine::api::TableParameters params, Callback<json::Object> callback) const
+{
+    const auto engine = engine_.get();
+    runAsync<json::Object>(
+        *executor_,
+        std::move(params),
+        std::move(callback),
+        [engine](const engine::api::TableParameters &params, json::Object &result) {
+            return engine->Table(params, result);
+        });
+}
+
+void OSRM::NearestAsync(engine::api::NearestParameters params,
+                        Callback<json::Object> callback) const
+{
+    const auto engine = engine_.get();
+    runAsync<json::Object>(
+        *executor_,
+        std::move(params),
+        std::move(callback),
+        [engine](const engine::api::NearestParameters &params, json::Object &result) {
+            return engine->Nearest(params, result);
+        });
+}
+
+void OSRM::TripAsync(engine::api::TripParameters params, Callback<json::Object> callback) const
+{
+    const auto engine = engine_.get();
+    runAsync<json::Object>(
+        *executor_,
+        std::move(params),
+        std::move(callback),
+        [engine](const engine::api::TripParameters &params, json::Object &result) {
+            return engine->Trip(params, result);
+        });
+}
+
+void OSRM::MatchAsync(engine::api::MatchParameters params, Callback<json::Object> callback) const
+{
+    const auto engine = engine_.get();
+    runAsync<json::Object>(
+        *executor_,
+        std::move(params),
+        std::move(callback),
+        [engine](const engine::api::MatchParameters &params, json::Object &result) {
+            return engine->Match(params, result);
+        });
+}
+
+void OSRM::TileAsync(engine::api::TileParameters params, Callback<std::string> callback) const
+{
+    const auto engine = engine_.get();
+    runAsync<std::string>(
+        *executor_,
+        std::move(params),
+        std::move(callback),
+        [engine](const engine::api::TileParameters &params, std::string &result) {
+            return engine->Tile(params, result);
+        });
+}
+
+void OSRM::IsochroneAsync(engine::api::IsochroneParameters params,
+                          Callback<json::Object> callback) const
+{
+    const auto engine = engine_.get();
+    runAsync<json::Object>(
+        *executor_,
+        std::move(params),
+        std::move(callback),
+        [engine](const engine::api::IsochroneParameters &params, json::Object &result) {
+            return engine->Isochrone(params, result);
+        });
+}
+
 } // ns osrm
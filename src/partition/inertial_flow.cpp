@@ -1,10 +1,12 @@
 #include "partition/inertial_flow.hpp"
 #include "partition/bisection_graph.hpp"
+#include "partition/push_relabel_max_flow.hpp"
 #include "partition/reorder_first_last.hpp"
 
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <mutex>
 #include <set>
@@ -30,47 +32,64 @@ struct SpatialOrder
     std::unordered_set<NodeID> sinks;
 };
 
-// Creates a spatial order of n * sources "first" and n * sink "last" node ids.
-// The slope determines the spatial order for sorting node coordinates.
-SpatialOrder makeSpatialOrder(const GraphView &view, const double ratio, const double slope)
+// Coordinates of the nodes in the GraphView as separate arrays, so the projections of all nodes
+// are computed in a loop the compiler can vectorize.
+struct NodeCoordinates
 {
-    struct NodeWithCoordinate
+    explicit NodeCoordinates(const GraphView &view)
     {
-        NodeWithCoordinate(NodeID nid_, util::Coordinate coordinate_)
-            : nid{nid_}, coordinate{std::move(coordinate_)}
+        lons.reserve(view.NumberOfNodes());
+        lats.reserve(view.NumberOfNodes());
+        for (const auto &node : view.Nodes())
         {
+            lons.push_back(static_cast<std::int32_t>(node.coordinate.lon));
+            lats.push_back(static_cast<std::int32_t>(node.coordinate.lat));
         }
+    }
 
-        NodeID nid;
-        util::Coordinate coordinate;
-    };
+    std::size_t size() const { return lons.size(); }
 
-    using Embedding = std::vector<NodeWithCoordinate>;
+    std::vector<double> lons;
+    std::vector<double> lats;
+};
 
-    Embedding embedding;
-    embedding.reserve(view.NumberOfNodes());
+// Creates a spatial order of n * sources "first" and n * sink "last" node ids.
+// The slope determines the spatial order for sorting node coordinates.
+SpatialOrder
+makeSpatialOrder(const NodeCoordinates &coordinates, const double ratio, const double slope)
+{
+    struct NodeWithProjection
+    {
+        double projection;
+        NodeID nid;
+    };
 
-    // adress of the very first node
-    const auto node_zero = &(*view.Begin());
+    // Reused by all slopes and bisections running on this thread
+    thread_local std::vector<double> projections;
+    thread_local std::vector<NodeWithProjection> embedding;
 
-    std::transform(view.Begin(), view.End(), std::back_inserter(embedding), [&](const auto &node) {
-        const auto node_id = static_cast<NodeID>(&node - node_zero);
-        return NodeWithCoordinate{node_id, node.coordinate};
-    });
+    const auto num_nodes = coordinates.size();
+    const auto lon_factor = slope;
+    const auto lat_factor = 1. - std::fabs(slope);
 
-    const auto project = [slope](const auto &each) {
-        auto lon = static_cast<std::int32_t>(each.coordinate.lon);
-        auto lat = static_cast<std::int32_t>(each.coordinate.lat);
+    projections.resize(num_nodes);
+    const auto *lons = coordinates.lons.data();
+    const auto *lats = coordinates.lats.data();
+    auto *projected = projections.data();
+    for (std::size_t index = 0; index < num_nodes; ++index)
+        projected[index] = lon_factor * lons[index] + lat_factor * lats[index];
 
-        return slope * lon + (1. - std::fabs(slope)) * lat;
-    };
+    embedding.resize(num_nodes);
+    for (std::size_t index = 0; index < num_nodes; ++index)
+        embedding[index] = NodeWithProjection{projected[index], static_cast<NodeID>(index)};
 
-    const auto spatially = [&](const auto &lhs, const auto &rhs) {
-        return project(lhs) < project(rhs);
+    const auto spatially = [](const auto &lhs, const auto &rhs) {
+        return lhs.projection < rhs.projection;
     };
 
     const std::size_t n = ratio * embedding.size();
 
+    // Only the n first and last nodes are selected, the nodes in between stay unsorted
     reorderFirstLast(embedding, n, spatially);
 
     SpatialOrder order;
@@ -88,8 +107,11 @@ SpatialOrder makeSpatialOrder(const GraphView &view, const double ratio, const d
 }
 
 // Makes n cuts with different spatial orders and returns the best.
-DinicMaxFlow::MinCut
-bestMinCut(const GraphView &view, const std::size_t n, const double ratio, const double balance)
+DinicMaxFlow::MinCut bestMinCut(const GraphView &view,
+                                const std::size_t n,
+                                const double ratio,
+                                const double balance,
+                                const MaxFlowAlgorithm max_flow)
 {
     DinicMaxFlow::MinCut best;
     best.num_edges = -1;
@@ -110,6 +132,8 @@ bestMinCut(const GraphView &view, const std::size_t n, const double ratio, const
 
     std::mutex lock;
 
+    const NodeCoordinates coordinates(view);
+
     tbb::blocked_range<std::size_t> range{0, n, 1};
 
     const auto balance_delta = [&view](const auto num_nodes_source) {
@@ -123,8 +147,10 @@ bestMinCut(const GraphView &view, const std::size_t n, const double ratio, const
         {
             const auto slope = -1. + round * (2. / n);
 
-            auto order = makeSpatialOrder(view, ratio, slope);
-            auto cut = DinicMaxFlow()(view, order.sources, order.sinks);
+            auto order = makeSpatialOrder(coordinates, ratio, slope);
+            auto cut = max_flow == MaxFlowAlgorithm::Dinic
+                           ? DinicMaxFlow()(view, order.sources, order.sinks)
+                           : PushRelabelMaxFlow()(view, order.sources, order.sinks);
             auto cut_balance = get_balance(cut.num_nodes_source);
 
             {
@@ -150,9 +176,10 @@ bestMinCut(const GraphView &view, const std::size_t n, const double ratio, const
 DinicMaxFlow::MinCut computeInertialFlowCut(const GraphView &view,
                                             const std::size_t num_slopes,
                                             const double balance,
-                                            const double source_sink_rate)
+                                            const double source_sink_rate,
+                                            const MaxFlowAlgorithm max_flow)
 {
-    return bestMinCut(view, num_slopes, source_sink_rate, balance);
+    return bestMinCut(view, num_slopes, source_sink_rate, balance, max_flow);
 }
 
 } // namespace partition
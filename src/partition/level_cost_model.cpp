@@ -0,0 +1,47 @@
+#include "partition/level_cost_model.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace osrm
+{
+namespace partition
+{
+
+std::size_t recommendLevelConfiguration(const std::vector<LevelCost> &costs)
+{
+    BOOST_ASSERT(!costs.empty());
+
+    auto min_query = std::numeric_limits<double>::max();
+    auto min_customization = std::numeric_limits<double>::max();
+    auto min_bytes = std::numeric_limits<double>::max();
+    for (const auto &cost : costs)
+    {
+        min_query = std::min(min_query, cost.query_arcs);
+        min_customization = std::min(min_customization, cost.customization_arcs);
+        min_bytes = std::min(min_bytes, static_cast<double>(cost.cell_storage_bytes));
+    }
+
+    // a cost of 0 on a tiny graph makes every configuration equal in that cost
+    const auto relative = [](const double value, const double minimum) {
+        return minimum > 0 ? value / minimum : 1.;
+    };
+
+    std::size_t best = 0;
+    auto best_score = std::numeric_limits<double>::max();
+    for (std::size_t index = 0; index < costs.size(); ++index)
+    {
+        const auto &cost = costs[index];
+        const auto score = relative(cost.query_arcs, min_query) +
+                           relative(cost.customization_arcs, min_customization) +
+                           relative(cost.cell_storage_bytes, min_bytes);
+        if (score < best_score)
+        {
+            best = index;
+            best_score = score;
+        }
+    }
+    return best;
+}
+}
+}
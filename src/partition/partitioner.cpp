@@ -5,10 +5,12 @@
 #include "partition/compressed_node_based_graph_reader.hpp"
 #include "partition/edge_based_graph_reader.hpp"
 #include "partition/files.hpp"
+#include "partition/level_cost_model.hpp"
 #include "partition/multi_level_partition.hpp"
 #include "partition/recursive_bisection.hpp"
 #include "partition/remove_unconnected.hpp"
 #include "partition/renumber.hpp"
+#include "partition/shard_plan.hpp"
 
 #include "extractor/files.hpp"
 
@@ -19,9 +21,13 @@
 #include "util/json_container.hpp"
 #include "util/log.hpp"
 #include "util/mmap_file.hpp"
+#include "util/phase_profiler.hpp"
 
 #include <algorithm>
 #include <iterator>
+#include <map>
+#include <sstream>
+#include <tuple>
 #include <vector>
 
 #include <boost/assert.hpp>
@@ -95,7 +101,7 @@ void LogGeojson(const std::string &filename, const std::vector<std::uint32_t> &b
     }
 }
 
-auto getGraphBisection(const PartitionConfig &config)
+BisectionGraph loadBisectionGraph(const PartitionConfig &config)
 {
     auto compressed_node_based_graph =
         LoadCompressedNodeBasedGraph(config.GetPath(".osrm.cnbg").string());
@@ -107,47 +113,89 @@ auto getGraphBisection(const PartitionConfig &config)
     groupEdgesBySource(begin(compressed_node_based_graph.edges),
                        end(compressed_node_based_graph.edges));
 
-    auto graph =
-        makeBisectionGraph(compressed_node_based_graph.coordinates,
-                           adaptToBisectionEdge(std::move(compressed_node_based_graph.edges)));
+    return makeBisectionGraph(compressed_node_based_graph.coordinates,
+                              adaptToBisectionEdge(std::move(compressed_node_based_graph.edges)));
+}
+
+std::vector<BisectionID> getGraphBisection(const PartitionConfig &config)
+{
+    auto graph = loadBisectionGraph(config);
 
     util::Log() << " running partition: " << config.max_cell_sizes.front() << " " << config.balance
                 << " " << config.boundary_factor << " " << config.num_optimizing_cuts << " "
-                << config.small_component_size
-                << " # max_cell_size balance boundary cuts small_component_size";
-    RecursiveBisection recursive_bisection(graph,
-                                           config.max_cell_sizes.front(),
-                                           config.balance,
-                                           config.boundary_factor,
-                                           config.num_optimizing_cuts,
-                                           config.small_component_size);
-
-    // Return bisection ids, keyed by node based graph nodes
-    return recursive_bisection.BisectionIDs();
-}
+                << config.small_component_size << " "
+                << (config.max_flow == MaxFlowAlgorithm::Dinic ? "dinic" : "push-relabel")
+                << " # max_cell_size balance boundary cuts small_component_size max_flow";
 
-int Partitioner::Run(const PartitionConfig &config)
-{
-    const std::vector<BisectionID> &node_based_partition_ids = getGraphBisection(config);
+    std::vector<BisectionID> bisection_ids;
+    std::uint32_t scc_depth;
+    std::vector<boost::filesystem::path> subtree_paths;
+    {
+        RecursiveBisection recursive_bisection(graph,
+                                               config.max_cell_sizes.front(),
+                                               config.balance,
+                                               config.boundary_factor,
+                                               config.num_optimizing_cuts,
+                                               config.small_component_size,
+                                               config.max_flow,
+                                               config.subtree_depth);
+
+        // Spill the subtrees left below the subtree depth next to the partition file
+        const auto num_subtrees = recursive_bisection.NumberOfSubtrees();
+        for (const auto index : util::irange<std::size_t>(0, num_subtrees))
+        {
+            auto path = config.GetPath(".osrm.partition");
+            path += ".subtree." + std::to_string(index);
+            files::writeSubtree(path, recursive_bisection.GetSubtree(index));
+            subtree_paths.push_back(std::move(path));
+        }
 
-    // Up until now we worked on the compressed node based graph.
-    // But what we actually need is a partition for the edge based graph to work on.
-    // The following loads a mapping from node based graph to edge based graph.
-    // Then loads the edge based graph tanslates the partition and modifies it.
-    // For details see #3205
+        bisection_ids = recursive_bisection.BisectionIDs();
+        scc_depth = recursive_bisection.SCCDepth();
+    }
 
-    std::vector<extractor::NBGToEBG> mapping;
-    extractor::files::readNBGMapping(config.GetPath(".osrm.cnbg_to_ebg").string(), mapping);
-    util::Log() << "Loaded node based graph to edge based graph mapping";
+    if (subtree_paths.empty())
+    {
+        // Return bisection ids, keyed by node based graph nodes
+        return bisection_ids;
+    }
 
-    auto edge_based_graph = LoadEdgeBasedGraph(config.GetPath(".osrm.ebg").string());
-    util::Log() << "Loaded edge based graph for mapping partition ids: "
-                << edge_based_graph.GetNumberOfEdges() << " edges, "
-                << edge_based_graph.GetNumberOfNodes() << " nodes";
+    // Only one subtree is in memory from here on
+    graph = BisectionGraph({}, {});
+    util::Log() << "Spilled " << subtree_paths.size() << " subtrees";
+
+    for (const auto &path : subtree_paths)
+    {
+        BisectionSubtree subtree;
+        files::readSubtree(path, subtree);
+
+        auto subtree_graph = makeBisectionGraph(subtree);
+        RecursiveBisection recursive_bisection(subtree_graph,
+                                               subtree,
+                                               scc_depth,
+                                               config.max_cell_sizes.front(),
+                                               config.balance,
+                                               config.boundary_factor,
+                                               config.num_optimizing_cuts,
+                                               config.max_flow);
+
+        const auto &subtree_ids = recursive_bisection.BisectionIDs();
+        for (const auto node : util::irange<std::size_t>(0, subtree.original_ids.size()))
+            bisection_ids[subtree.original_ids[node]] = subtree_ids[node];
+
+        boost::filesystem::remove(path);
+    }
 
-    // Partition ids, keyed by edge based graph nodes
-    std::vector<NodeID> edge_based_partition_ids(edge_based_graph.GetNumberOfNodes(),
-                                                 SPECIAL_NODEID);
+    return bisection_ids;
+}
+
+// Partition ids keyed by edge based graph nodes
+std::vector<NodeID>
+getEdgeBasedPartitionIDs(const std::vector<extractor::NBGToEBG> &mapping,
+                         const std::vector<BisectionID> &node_based_partition_ids,
+                         const NodeID number_of_nodes)
+{
+    std::vector<NodeID> edge_based_partition_ids(number_of_nodes, SPECIAL_NODEID);
 
     // Only resolve all easy cases in the first pass
     for (const auto &entry : mapping)
@@ -164,10 +212,18 @@ int Partitioner::Run(const PartitionConfig &config)
             edge_based_partition_ids[backward_node] = node_based_partition_ids[v];
     }
 
+    return edge_based_partition_ids;
+}
+
+std::tuple<std::vector<Partition>, std::vector<std::uint32_t>>
+makeLevels(const DynamicEdgeBasedGraph &edge_based_graph,
+           const std::vector<NodeID> &edge_based_partition_ids,
+           const std::vector<std::size_t> &max_cell_sizes)
+{
     std::vector<Partition> partitions;
     std::vector<std::uint32_t> level_to_num_cells;
     std::tie(partitions, level_to_num_cells) =
-        bisectionToPartition(edge_based_partition_ids, config.max_cell_sizes);
+        bisectionToPartition(edge_based_partition_ids, max_cell_sizes);
 
     auto num_unconnected = removeUnconnectedBoundaryNodes(edge_based_graph, partitions);
     util::Log() << "Fixed " << num_unconnected << " unconnected nodes";
@@ -179,7 +235,43 @@ int Partitioner::Run(const PartitionConfig &config)
                     << " bit size " << std::ceil(std::log2(level_to_num_cells[level] + 1));
     }
 
+    return std::make_tuple(std::move(partitions), std::move(level_to_num_cells));
+}
+
+void logShardPlan(const MultiLevelPartition &mlp,
+                  const CellStorage &storage,
+                  const DynamicEdgeBasedGraph &edge_based_graph,
+                  const std::uint32_t num_shards)
+{
+    const auto top_level = mlp.GetNumberOfLevels() - 1;
+    if (top_level < 1 || mlp.GetNumberOfCells(top_level) < num_shards)
+    {
+        util::Log(logWARNING) << "Can't plan " << num_shards << " shards, the partition has only "
+                              << (top_level < 1 ? 1 : mlp.GetNumberOfCells(top_level))
+                              << " top level cells";
+        return;
+    }
+
+    const auto plan = planShards(mlp, storage, edge_based_graph, num_shards);
+    for (const auto shard : util::irange<std::uint32_t>(0, num_shards))
+    {
+        const auto cells = std::count(plan.cell_to_shard.begin(), plan.cell_to_shard.end(), shard);
+        util::Log() << "Shard " << shard << ": " << cells << " top level cells, "
+                    << plan.shard_nodes[shard] << " nodes, " << plan.shard_edges[shard]
+                    << " edges";
+    }
+    util::Log() << "Overlay shared by all shards: " << plan.overlay_nodes
+                << " boundary nodes of the top level cells, "
+                << (plan.overlay_cell_storage_bytes >> 20) << " MiB of cell storage";
+}
+
+int writeMLDData(const PartitionConfig &config,
+                 DynamicEdgeBasedGraph &edge_based_graph,
+                 std::vector<Partition> &partitions,
+                 const std::vector<std::uint32_t> &level_to_num_cells)
+{
     TIMER_START(renumber);
+    util::ProfilePhase renumber_phase("renumbering");
     auto permutation = makePermutation(edge_based_graph, partitions);
     renumber(edge_based_graph, permutation);
     renumber(partitions, permutation);
@@ -195,6 +287,15 @@ int Partitioner::Run(const PartitionConfig &config)
         renumber(node_data, permutation);
         extractor::files::writeNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
     }
+    if (boost::filesystem::exists(config.GetPath(".osrm.conditional_turn_masks")))
+    {
+        std::vector<extractor::ConditionalTurnMask> masks;
+        extractor::files::readConditionalTurnMasks(config.GetPath(".osrm.conditional_turn_masks"),
+                                                   masks);
+        renumber(masks, permutation);
+        extractor::files::writeConditionalTurnMasks(
+            config.GetPath(".osrm.conditional_turn_masks"), masks);
+    }
     if (boost::filesystem::exists(config.GetPath(".osrm.hsgr")))
     {
         util::Log(logWARNING) << "Found existing .osrm.hsgr file, removing. You need to re-run "
@@ -202,29 +303,145 @@ int Partitioner::Run(const PartitionConfig &config)
         boost::filesystem::remove(config.GetPath(".osrm.hsgr"));
     }
     TIMER_STOP(renumber);
+    renumber_phase.Stop();
     util::Log() << "Renumbered data in " << TIMER_SEC(renumber) << " seconds";
 
     TIMER_START(packed_mlp);
+    util::ProfilePhase mlp_phase("multi-level partition");
     MultiLevelPartition mlp{partitions, level_to_num_cells};
+    mlp_phase.Stop();
     TIMER_STOP(packed_mlp);
     util::Log() << "MultiLevelPartition constructed in " << TIMER_SEC(packed_mlp) << " seconds";
 
     TIMER_START(cell_storage);
+    util::ProfilePhase cell_storage_phase("cell storage");
     CellStorage storage(mlp, edge_based_graph);
+    cell_storage_phase.Stop();
     TIMER_STOP(cell_storage);
     util::Log() << "CellStorage constructed in " << TIMER_SEC(cell_storage) << " seconds";
 
     TIMER_START(writing_mld_data);
+    util::ProfilePhase writing_phase("writing MLD data");
     files::writePartition(config.GetPath(".osrm.partition"), mlp);
     files::writeCells(config.GetPath(".osrm.cells"), storage);
     extractor::files::writeEdgeBasedGraph(config.GetPath(".osrm.ebg"),
                                           edge_based_graph.GetNumberOfNodes() - 1,
                                           graphToEdges(edge_based_graph));
     TIMER_STOP(writing_mld_data);
+    writing_phase.Stop();
     util::Log() << "MLD data writing took " << TIMER_SEC(writing_mld_data) << " seconds";
 
+    if (config.num_shards > 0)
+    {
+        logShardPlan(mlp, storage, edge_based_graph, config.num_shards);
+    }
+
     return 0;
 }
 
+int tuneLevels(const PartitionConfig &config)
+{
+    std::vector<extractor::NBGToEBG> mapping;
+    extractor::files::readNBGMapping(config.GetPath(".osrm.cnbg_to_ebg").string(), mapping);
+    auto edge_based_graph = LoadEdgeBasedGraph(config.GetPath(".osrm.ebg").string());
+    util::Log() << "Loaded edge based graph: " << edge_based_graph.GetNumberOfEdges()
+                << " edges, " << edge_based_graph.GetNumberOfNodes() << " nodes";
+
+    const auto to_string = [](const std::vector<std::size_t> &max_cell_sizes) {
+        std::ostringstream sizes;
+        for (const auto size : max_cell_sizes)
+            sizes << (sizes.tellp() > 0 ? "," : "") << size;
+        return sizes.str();
+    };
+
+    // the bisection only depends on the level 1 size
+    std::map<std::size_t, std::vector<NodeID>> bisections;
+    std::vector<LevelCost> costs;
+    for (const auto &max_cell_sizes : config.tune_max_cell_sizes)
+    {
+        auto bisection = bisections.find(max_cell_sizes.front());
+        if (bisection == bisections.end())
+        {
+            auto bisection_config = config;
+            bisection_config.max_cell_sizes = max_cell_sizes;
+            bisection = bisections
+                            .emplace(max_cell_sizes.front(),
+                                     getEdgeBasedPartitionIDs(mapping,
+                                                              getGraphBisection(bisection_config),
+                                                              edge_based_graph.GetNumberOfNodes()))
+                            .first;
+        }
+
+        std::vector<Partition> partitions;
+        std::vector<std::uint32_t> level_to_num_cells;
+        std::tie(partitions, level_to_num_cells) =
+            makeLevels(edge_based_graph, bisection->second, max_cell_sizes);
+        const MultiLevelPartition mlp{partitions, level_to_num_cells};
+        const CellStorage storage(mlp, edge_based_graph);
+        costs.push_back(
+            estimateLevelCost(mlp, storage, edge_based_graph, config.tune_number_of_queries));
+
+        const auto &cost = costs.back();
+        util::Log() << "max cell sizes " << to_string(max_cell_sizes) << ": " << cost.query_arcs
+                    << " arcs per query, " << cost.customization_arcs
+                    << " arcs to customize, " << (cost.cell_storage_bytes >> 20)
+                    << " MiB of cell storage";
+    }
+
+    const auto &best = config.tune_max_cell_sizes[recommendLevelConfiguration(costs)];
+    util::Log() << "Recommended: --max-cell-sizes " << to_string(best);
+    if (!config.tune_write)
+    {
+        return 0;
+    }
+
+    std::vector<Partition> partitions;
+    std::vector<std::uint32_t> level_to_num_cells;
+    std::tie(partitions, level_to_num_cells) =
+        makeLevels(edge_based_graph, bisections[best.front()], best);
+    return writeMLDData(config, edge_based_graph, partitions, level_to_num_cells);
+}
+
+int Partitioner::Run(const PartitionConfig &config)
+{
+    if (!config.tune_max_cell_sizes.empty())
+    {
+        return tuneLevels(config);
+    }
+
+    util::ProfilePhase bisection_phase("bisection");
+    const std::vector<BisectionID> node_based_partition_ids = getGraphBisection(config);
+    bisection_phase.Stop();
+
+    util::ProfilePhase annotation_phase("edge-based graph annotation");
+
+    // Up until now we worked on the compressed node based graph.
+    // But what we actually need is a partition for the edge based graph to work on.
+    // The following loads a mapping from node based graph to edge based graph.
+    // Then loads the edge based graph tanslates the partition and modifies it.
+    // For details see #3205
+
+    std::vector<extractor::NBGToEBG> mapping;
+    extractor::files::readNBGMapping(config.GetPath(".osrm.cnbg_to_ebg").string(), mapping);
+    util::Log() << "Loaded node based graph to edge based graph mapping";
+
+    auto edge_based_graph = LoadEdgeBasedGraph(config.GetPath(".osrm.ebg").string());
+    util::Log() << "Loaded edge based graph for mapping partition ids: "
+                << edge_based_graph.GetNumberOfEdges() << " edges, "
+                << edge_based_graph.GetNumberOfNodes() << " nodes";
+
+    const auto edge_based_partition_ids = getEdgeBasedPartitionIDs(
+        mapping, node_based_partition_ids, edge_based_graph.GetNumberOfNodes());
+
+    std::vector<Partition> partitions;
+    std::vector<std::uint32_t> level_to_num_cells;
+    std::tie(partitions, level_to_num_cells) =
+        makeLevels(edge_based_graph, edge_based_partition_ids, config.max_cell_sizes);
+
+    annotation_phase.Stop();
+
+    return writeMLDData(config, edge_based_graph, partitions, level_to_num_cells);
+}
+
 } // namespace partition
 } // namespace osrm
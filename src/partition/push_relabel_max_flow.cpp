@@ -0,0 +1,406 @@
+#include "partition/push_relabel_max_flow.hpp"
+#include "util/integer_range.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace osrm
+{
+namespace partition
+{
+
+namespace
+{
+using Label = std::uint32_t;
+using Capacity = std::int32_t;
+
+const auto constexpr INVALID_NODE = std::numeric_limits<NodeID>::max();
+
+enum class NodeType : std::uint8_t
+{
+    Inner,
+    Source,
+    Sink
+};
+
+// Every edge of the view is an arc with a capacity of one, paired with an arc in the opposite
+// direction. Arcs without an opposite edge get an opposite arc without capacity.
+struct ResidualGraph
+{
+    std::vector<EdgeID> first_arc;
+    std::vector<NodeID> head;
+    std::vector<EdgeID> reverse;
+    std::vector<Capacity> capacity;
+
+    NodeID NumberOfNodes() const { return first_arc.size() - 1; }
+    auto Arcs(const NodeID node) const
+    {
+        return util::irange(first_arc[node], first_arc[node + 1]);
+    }
+};
+
+ResidualGraph makeResidualGraph(const GraphView &view)
+{
+    const NodeID number_of_nodes = view.NumberOfNodes();
+
+    // the k-th edge from u to v is paired with the k-th edge from v to u
+    const auto find_opposite = [&view](const NodeID from, const NodeID to, std::size_t occurrence) {
+        std::size_t index = 0;
+        for (const auto &edge : view.Edges(to))
+        {
+            if (edge.target == from && occurrence-- == 0)
+                return index;
+            ++index;
+        }
+        return std::numeric_limits<std::size_t>::max();
+    };
+    const auto occurrence_of = [&view](const NodeID from, const std::size_t edge_index) {
+        const auto begin = view.BeginEdges(from);
+        const auto target = (begin + edge_index)->target;
+        return static_cast<std::size_t>(
+            std::count_if(begin, begin + edge_index, [target](const auto &edge) {
+                return edge.target == target;
+            }));
+    };
+
+    // edges without an opposite edge need an extra arc at their target
+    std::vector<EdgeID> number_of_arcs(number_of_nodes, 0);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        std::size_t index = 0;
+        for (const auto &edge : view.Edges(node))
+        {
+            BOOST_ASSERT(edge.target < number_of_nodes);
+            ++number_of_arcs[node];
+            if (find_opposite(node, edge.target, occurrence_of(node, index)) ==
+                std::numeric_limits<std::size_t>::max())
+                ++number_of_arcs[edge.target];
+            ++index;
+        }
+    }
+
+    ResidualGraph graph;
+    graph.first_arc.resize(number_of_nodes + 1, 0);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        graph.first_arc[node + 1] = graph.first_arc[node] + number_of_arcs[node];
+    const auto total_arcs = graph.first_arc.back();
+    graph.head.resize(total_arcs);
+    graph.reverse.resize(total_arcs, SPECIAL_EDGEID);
+    graph.capacity.resize(total_arcs, 0);
+
+    // the edges of the view come first, extra arcs are appended behind them
+    std::vector<EdgeID> next_extra_arc(number_of_nodes);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        const auto degree = std::distance(view.BeginEdges(node), view.EndEdges(node));
+        next_extra_arc[node] = graph.first_arc[node] + degree;
+        EdgeID arc = graph.first_arc[node];
+        for (const auto &edge : view.Edges(node))
+        {
+            graph.head[arc] = edge.target;
+            graph.capacity[arc] = 1;
+            ++arc;
+        }
+    }
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        std::size_t index = 0;
+        for (const auto &edge : view.Edges(node))
+        {
+            const EdgeID arc = graph.first_arc[node] + index;
+            const auto opposite = find_opposite(node, edge.target, occurrence_of(node, index));
+            if (opposite == std::numeric_limits<std::size_t>::max())
+            {
+                const EdgeID extra_arc = next_extra_arc[edge.target]++;
+                graph.head[extra_arc] = node;
+                graph.reverse[extra_arc] = arc;
+                graph.reverse[arc] = extra_arc;
+            }
+            else
+            {
+                graph.reverse[arc] = graph.first_arc[edge.target] + opposite;
+            }
+            ++index;
+        }
+    }
+    BOOST_ASSERT(std::find(graph.reverse.begin(), graph.reverse.end(), SPECIAL_EDGEID) ==
+                 graph.reverse.end());
+
+    return graph;
+}
+
+class PushRelabel
+{
+  public:
+    PushRelabel(ResidualGraph graph_,
+                const DinicMaxFlow::SourceSinkNodes &source_nodes,
+                const DinicMaxFlow::SourceSinkNodes &sink_nodes)
+        : graph(std::move(graph_)), number_of_nodes(graph.NumberOfNodes()),
+          type(number_of_nodes, NodeType::Inner), label(number_of_nodes, 0),
+          excess(number_of_nodes, 0),
+          current_arc(graph.first_arc.begin(), graph.first_arc.end() - 1),
+          active_first(number_of_nodes + 1, INVALID_NODE), active_next(number_of_nodes),
+          bucket_first(number_of_nodes + 1, INVALID_NODE), bucket_next(number_of_nodes),
+          bucket_previous(number_of_nodes)
+    {
+        for (const auto node : source_nodes)
+            type[node] = NodeType::Source;
+        for (const auto node : sink_nodes)
+            type[node] = NodeType::Sink;
+
+        // saturate all arcs that leave the source side
+        for (const auto node : source_nodes)
+        {
+            for (const auto arc : graph.Arcs(node))
+            {
+                const auto target = graph.head[arc];
+                if (type[target] != NodeType::Source && graph.capacity[arc] > 0)
+                {
+                    Push(arc, node, graph.capacity[arc]);
+                }
+            }
+        }
+        GlobalRelabel();
+    }
+
+    void Run()
+    {
+        while (true)
+        {
+            while (highest_active > 0 && active_first[highest_active] == INVALID_NODE)
+                --highest_active;
+            if (highest_active == 0)
+                break;
+
+            const auto node = active_first[highest_active];
+            active_first[highest_active] = active_next[node];
+            // nodes cut off by a gap are left in the lists
+            if (label[node] == highest_active && excess[node] > 0)
+                Discharge(node);
+        }
+    }
+
+    // The nodes that can not reach the sink side are the source side of a minimum cut
+    DinicMaxFlow::MinCut MakeCut()
+    {
+        const auto reached = ReverseBreadthFirstSearch();
+        std::vector<bool> flags(number_of_nodes);
+        std::size_t num_nodes_source = 0;
+        std::size_t flow_value = 0;
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            flags[node] = reached[node] == number_of_nodes;
+            num_nodes_source += flags[node];
+            if (type[node] == NodeType::Sink)
+                flow_value += excess[node];
+        }
+        return {num_nodes_source, flow_value, std::move(flags)};
+    }
+
+  private:
+    void Push(const EdgeID arc, const NodeID from, const Capacity amount)
+    {
+        const auto to = graph.head[arc];
+        graph.capacity[arc] -= amount;
+        graph.capacity[graph.reverse[arc]] += amount;
+        excess[from] -= amount;
+        if (type[to] == NodeType::Inner && excess[to] == 0 && label[to] < number_of_nodes)
+            Activate(to);
+        excess[to] += amount;
+    }
+
+    void Activate(const NodeID node)
+    {
+        active_next[node] = active_first[label[node]];
+        active_first[label[node]] = node;
+        highest_active = std::max(highest_active, label[node]);
+    }
+
+    void AddToBucket(const NodeID node)
+    {
+        const auto node_label = label[node];
+        bucket_previous[node] = INVALID_NODE;
+        bucket_next[node] = bucket_first[node_label];
+        if (bucket_first[node_label] != INVALID_NODE)
+            bucket_previous[bucket_first[node_label]] = node;
+        bucket_first[node_label] = node;
+        highest_label = std::max(highest_label, node_label);
+    }
+
+    void RemoveFromBucket(const NodeID node)
+    {
+        if (bucket_previous[node] != INVALID_NODE)
+            bucket_next[bucket_previous[node]] = bucket_next[node];
+        else
+            bucket_first[label[node]] = bucket_next[node];
+        if (bucket_next[node] != INVALID_NODE)
+            bucket_previous[bucket_next[node]] = bucket_previous[node];
+    }
+
+    void Discharge(const NodeID node)
+    {
+        while (true)
+        {
+            const auto end_arc = graph.first_arc[node + 1];
+            for (auto &arc = current_arc[node]; arc != end_arc; ++arc)
+            {
+                const auto target = graph.head[arc];
+                if (graph.capacity[arc] > 0 && label[node] == label[target] + 1)
+                {
+                    Push(arc, node, std::min(excess[node], graph.capacity[arc]));
+                    if (excess[node] == 0)
+                        return;
+                }
+            }
+
+            if (!Relabel(node))
+                return;
+        }
+    }
+
+    // Returns whether the node can be discharged further
+    bool Relabel(const NodeID node)
+    {
+        const auto old_label = label[node];
+        RemoveFromBucket(node);
+
+        Label new_label = number_of_nodes;
+        for (const auto arc : graph.Arcs(node))
+        {
+            if (graph.capacity[arc] > 0)
+                new_label = std::min(new_label, label[graph.head[arc]] + 1);
+        }
+        work += graph.first_arc[node + 1] - graph.first_arc[node] + RELABEL_WORK;
+
+        // gap: no node with the old label is left, so no node above it can reach the sink side
+        if (bucket_first[old_label] == INVALID_NODE)
+        {
+            for (const auto gap_label : util::irange<Label>(old_label + 1, highest_label + 1))
+            {
+                for (auto gap_node = bucket_first[gap_label]; gap_node != INVALID_NODE;
+                     gap_node = bucket_next[gap_node])
+                    label[gap_node] = number_of_nodes;
+                bucket_first[gap_label] = INVALID_NODE;
+            }
+            highest_label = old_label - 1;
+            label[node] = number_of_nodes;
+            return false;
+        }
+
+        label[node] = new_label;
+        current_arc[node] = graph.first_arc[node];
+        if (new_label >= number_of_nodes)
+            return false;
+        AddToBucket(node);
+
+        if (work > GLOBAL_RELABEL_FREQUENCY * number_of_nodes + graph.head.size())
+        {
+            // the node is active again after the relabel
+            GlobalRelabel();
+            return false;
+        }
+        return true;
+    }
+
+    // Hops of all nodes to the sink side in the residual graph, number_of_nodes if there are none
+    std::vector<Label> ReverseBreadthFirstSearch() const
+    {
+        std::vector<Label> distance(number_of_nodes, number_of_nodes);
+        std::queue<NodeID> queue;
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            if (type[node] == NodeType::Sink)
+            {
+                distance[node] = 0;
+                queue.push(node);
+            }
+        }
+        while (!queue.empty())
+        {
+            const auto node = queue.front();
+            queue.pop();
+            for (const auto arc : graph.Arcs(node))
+            {
+                const auto from = graph.head[arc];
+                if (type[from] == NodeType::Inner && distance[from] == number_of_nodes &&
+                    graph.capacity[graph.reverse[arc]] > 0)
+                {
+                    distance[from] = distance[node] + 1;
+                    queue.push(from);
+                }
+            }
+        }
+        return distance;
+    }
+
+    void GlobalRelabel()
+    {
+        work = 0;
+        std::fill(active_first.begin(), active_first.end(), INVALID_NODE);
+        std::fill(bucket_first.begin(), bucket_first.end(), INVALID_NODE);
+        highest_active = 0;
+        highest_label = 0;
+
+        const auto distance = ReverseBreadthFirstSearch();
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            if (type[node] != NodeType::Inner)
+            {
+                label[node] = type[node] == NodeType::Sink ? 0 : number_of_nodes;
+                continue;
+            }
+            label[node] = distance[node];
+            current_arc[node] = graph.first_arc[node];
+            if (label[node] < number_of_nodes)
+            {
+                AddToBucket(node);
+                if (excess[node] > 0)
+                    Activate(node);
+            }
+        }
+    }
+
+    // relabeling a node is counted like scanning a few more arcs
+    static const constexpr std::size_t RELABEL_WORK = 12;
+    static const constexpr std::size_t GLOBAL_RELABEL_FREQUENCY = 6;
+
+    ResidualGraph graph;
+    const Label number_of_nodes;
+    std::vector<NodeType> type;
+    std::vector<Label> label;
+    std::vector<Capacity> excess;
+    std::vector<EdgeID> current_arc;
+
+    // active nodes per label
+    std::vector<NodeID> active_first;
+    std::vector<NodeID> active_next;
+    Label highest_active = 0;
+
+    // all inner nodes per label that can still reach the sink side, for the gap heuristic
+    std::vector<NodeID> bucket_first;
+    std::vector<NodeID> bucket_next;
+    std::vector<NodeID> bucket_previous;
+    Label highest_label = 0;
+
+    std::size_t work = 0;
+};
+} // end namespace
+
+PushRelabelMaxFlow::MinCut PushRelabelMaxFlow::operator()(const GraphView &view,
+                                                          const SourceSinkNodes &source_nodes,
+                                                          const SourceSinkNodes &sink_nodes) const
+{
+    BOOST_ASSERT(DinicMaxFlow().Validate(view, source_nodes, sink_nodes));
+
+    PushRelabel push_relabel(makeResidualGraph(view), source_nodes, sink_nodes);
+    push_relabel.Run();
+    return push_relabel.MakeCut();
+}
+
+} // namespace partition
+} // namespace osrm
@@ -13,6 +13,8 @@
 #include <climits> // for CHAR_BIT
 #include <cstddef>
 #include <iterator>
+#include <limits>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -23,12 +25,16 @@ namespace partition
 {
 
 RecursiveBisection::RecursiveBisection(BisectionGraph &bisection_graph_,
-                                       const std::size_t maximum_cell_size,
-                                       const double balance,
-                                       const double boundary_factor,
-                                       const std::size_t num_optimizing_cuts,
-                                       const std::size_t small_component_size)
-    : bisection_graph(bisection_graph_), internal_state(bisection_graph_)
+                                       const std::size_t maximum_cell_size_,
+                                       const double balance_,
+                                       const double boundary_factor_,
+                                       const std::size_t num_optimizing_cuts_,
+                                       const std::size_t small_component_size,
+                                       const MaxFlowAlgorithm max_flow_,
+                                       const std::size_t subtree_depth)
+    : bisection_graph(bisection_graph_), internal_state(bisection_graph_),
+      maximum_cell_size(maximum_cell_size_), balance(balance_), boundary_factor(boundary_factor_),
+      num_optimizing_cuts(num_optimizing_cuts_), max_flow(max_flow_)
 {
     auto components = internal_state.PrePartitionWithSCC(small_component_size);
     BOOST_ASSERT(!components.empty());
@@ -44,12 +50,6 @@ RecursiveBisection::RecursiveBisection(BisectionGraph &bisection_graph_,
     //
     // https://www.threadingbuildingblocks.org/docs/help/index.htm#reference/algorithms/parallel_do_func.html
 
-    struct TreeNode
-    {
-        GraphView graph;
-        std::uint64_t depth;
-    };
-
     // Build a recursive bisection tree for all big components independently in parallel.
     // Last GraphView is all small components: skip for bisection.
     auto first = begin(components);
@@ -64,14 +64,45 @@ RecursiveBisection::RecursiveBisection(BisectionGraph &bisection_graph_,
         return TreeNode{std::move(graph), internal_state.SCCDepth()};
     });
 
+    const auto subtree_root_depth = subtree_depth == 0
+                                        ? std::numeric_limits<std::uint64_t>::max()
+                                        : internal_state.SCCDepth() + subtree_depth;
+    Bisect(std::move(forest), subtree_root_depth);
+}
+
+RecursiveBisection::RecursiveBisection(BisectionGraph &bisection_graph_,
+                                       const BisectionSubtree &subtree,
+                                       const std::uint32_t scc_depth,
+                                       const std::size_t maximum_cell_size_,
+                                       const double balance_,
+                                       const double boundary_factor_,
+                                       const std::size_t num_optimizing_cuts_,
+                                       const MaxFlowAlgorithm max_flow_)
+    : bisection_graph(bisection_graph_),
+      internal_state(bisection_graph_, subtree.bisection_id, scc_depth),
+      maximum_cell_size(maximum_cell_size_), balance(balance_), boundary_factor(boundary_factor_),
+      num_optimizing_cuts(num_optimizing_cuts_), max_flow(max_flow_)
+{
+    BOOST_ASSERT(bisection_graph.NumberOfNodes() == subtree.original_ids.size());
+
+    std::vector<TreeNode> forest;
+    forest.push_back(TreeNode{GraphView(bisection_graph), subtree.depth});
+    Bisect(std::move(forest), std::numeric_limits<std::uint64_t>::max());
+}
+
+void RecursiveBisection::Bisect(std::vector<TreeNode> forest,
+                                const std::uint64_t subtree_root_depth)
+{
     using Feeder = tbb::parallel_do_feeder<TreeNode>;
 
+    std::mutex subtrees_lock;
+
     TIMER_START(bisection);
 
     // Bisect graph into two parts. Get partition point and recurse left and right in parallel.
     tbb::parallel_do(begin(forest), end(forest), [&](const TreeNode &node, Feeder &feeder) {
-        const auto cut =
-            computeInertialFlowCut(node.graph, num_optimizing_cuts, balance, boundary_factor);
+        const auto cut = computeInertialFlowCut(
+            node.graph, num_optimizing_cuts, balance, boundary_factor, max_flow);
         const auto center = internal_state.ApplyBisection(
             node.graph.Begin(), node.graph.End(), node.depth, cut.flags);
 
@@ -82,22 +113,33 @@ RecursiveBisection::RecursiveBisection(BisectionGraph &bisection_graph_,
             return too_small || too_deep;
         };
 
-        GraphView left_graph{bisection_graph, node.graph.Begin(), center};
-        TreeNode left_node{std::move(left_graph), node.depth + 1};
-
-        if (!terminal(left_node))
-            feeder.add(std::move(left_node));
-
-        GraphView right_graph{bisection_graph, center, node.graph.End()};
-        TreeNode right_node{std::move(right_graph), node.depth + 1};
+        // Below the subtree depth the bisection continues on a copy of the subgraph
+        const auto descend = [&](TreeNode child) {
+            if (terminal(child))
+                return;
+
+            if (child.depth < subtree_root_depth)
+            {
+                feeder.add(std::move(child));
+            }
+            else
+            {
+                std::lock_guard<std::mutex> guard{subtrees_lock};
+                subtrees.push_back(std::move(child));
+            }
+        };
 
-        if (!terminal(right_node))
-            feeder.add(std::move(right_node));
+        descend(TreeNode{GraphView{bisection_graph, node.graph.Begin(), center}, node.depth + 1});
+        descend(TreeNode{GraphView{bisection_graph, center, node.graph.End()}, node.depth + 1});
     });
 
     TIMER_STOP(bisection);
 
-    util::Log() << "Full bisection done in " << TIMER_SEC(bisection) << "s";
+    if (subtrees.empty())
+        util::Log() << "Full bisection done in " << TIMER_SEC(bisection) << "s";
+    else
+        util::Log() << "Bisection down to " << subtrees.size() << " subtrees done in "
+                    << TIMER_SEC(bisection) << "s";
 }
 
 const std::vector<BisectionID> &RecursiveBisection::BisectionIDs() const
@@ -107,5 +149,55 @@ const std::vector<BisectionID> &RecursiveBisection::BisectionIDs() const
 
 std::uint32_t RecursiveBisection::SCCDepth() const { return internal_state.SCCDepth(); }
 
+std::size_t RecursiveBisection::NumberOfSubtrees() const { return subtrees.size(); }
+
+BisectionSubtree RecursiveBisection::GetSubtree(const std::size_t index) const
+{
+    BOOST_ASSERT(index < subtrees.size());
+    const auto &node = subtrees[index];
+
+    BisectionSubtree subtree;
+    subtree.depth = node.depth;
+    subtree.bisection_id = internal_state.GetBisectionID(node.graph.Begin()->original_id);
+
+    const auto num_nodes = node.graph.NumberOfNodes();
+    subtree.original_ids.reserve(num_nodes);
+    subtree.coordinates.reserve(num_nodes);
+    subtree.edge_offsets.reserve(num_nodes + 1);
+
+    // the edges of the subgraph were remapped to the ids inside the subgraph by the bisection
+    subtree.edge_offsets.push_back(0);
+    for (const auto &graph_node : node.graph.Nodes())
+    {
+        subtree.original_ids.push_back(graph_node.original_id);
+        subtree.coordinates.push_back(graph_node.coordinate);
+        for (const auto &edge : node.graph.Edges(graph_node))
+            subtree.edge_targets.push_back(edge.target);
+        subtree.edge_offsets.push_back(subtree.edge_targets.size());
+    }
+
+    return subtree;
+}
+
+BisectionGraph makeBisectionGraph(const BisectionSubtree &subtree)
+{
+    BOOST_ASSERT(subtree.edge_offsets.size() == subtree.coordinates.size() + 1);
+
+    std::vector<BisectionGraph::NodeT> nodes;
+    nodes.reserve(subtree.coordinates.size());
+    for (std::size_t node_id = 0; node_id < subtree.coordinates.size(); ++node_id)
+    {
+        nodes.emplace_back(subtree.edge_offsets[node_id],
+                           subtree.edge_offsets[node_id + 1],
+                           subtree.coordinates[node_id],
+                           node_id);
+    }
+
+    std::vector<BisectionGraph::EdgeT> edges(subtree.edge_targets.begin(),
+                                             subtree.edge_targets.end());
+
+    return BisectionGraph(std::move(nodes), std::move(edges));
+}
+
 } // namespace partition
 } // namespace osrm
@@ -19,6 +19,14 @@ RecursiveBisectionState::RecursiveBisectionState(BisectionGraph &bisection_graph
     bisection_ids.resize(bisection_graph.NumberOfNodes(), BisectionID{0});
 }
 
+RecursiveBisectionState::RecursiveBisectionState(BisectionGraph &bisection_graph_,
+                                                 const BisectionID bisection_id,
+                                                 const std::uint32_t scc_levels_)
+    : scc_levels(scc_levels_), bisection_graph(bisection_graph_)
+{
+    bisection_ids.resize(bisection_graph.NumberOfNodes(), bisection_id);
+}
+
 RecursiveBisectionState::~RecursiveBisectionState() {}
 
 BisectionID RecursiveBisectionState::GetBisectionID(const NodeID node) const
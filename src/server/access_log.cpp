@@ -0,0 +1,152 @@
+#include "server/access_log.hpp"
+
+#include "util/log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+// how often the writer thread looks for records when it found none
+const constexpr auto WRITER_INTERVAL = std::chrono::milliseconds(10);
+
+std::atomic<std::uint64_t> next_access_log_id{0};
+}
+
+std::string formatAccessRecord(const AccessRecord &record)
+{
+    std::tm time_stamp;
+#ifdef _WIN32
+    localtime_s(&time_stamp, &record.time);
+#else
+    localtime_r(&record.time, &time_stamp);
+#endif
+
+    std::ostringstream line;
+    line << std::setfill('0') << std::setw(2) << time_stamp.tm_mday << "-" << std::setw(2)
+         << time_stamp.tm_mon + 1 << "-" << 1900 + time_stamp.tm_year << " " << std::setw(2)
+         << time_stamp.tm_hour << ":" << std::setw(2) << time_stamp.tm_min << ":"
+         << std::setw(2) << time_stamp.tm_sec << std::setfill(' ') << " " << record.duration_ms
+         << "ms " << record.endpoint << " " << record.referrer
+         << (record.referrer.empty() ? "- " : " ") << record.agent
+         << (record.agent.empty() ? "- " : " ") << record.status << " " << record.request;
+    return line.str();
+}
+
+AccessLog::AccessLog(const std::size_t records_per_thread_, Sink sink_)
+    : records_per_thread(std::max<std::size_t>(1, records_per_thread_)),
+      id(next_access_log_id++), sink(std::move(sink_))
+{
+    if (!sink)
+    {
+        sink = [](const std::string &line) { util::Log() << line; };
+    }
+    writer = std::thread([this] { Run(); });
+}
+
+AccessLog::~AccessLog()
+{
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stop = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void AccessLog::Log(AccessRecord record)
+{
+    auto &ring = GetThreadRing();
+    const auto tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail - ring.head.load(std::memory_order_acquire) == ring.records.size())
+    {
+        ++dropped;
+        return;
+    }
+    ring.records[tail % ring.records.size()] = std::move(record);
+    ring.tail.store(tail + 1, std::memory_order_release);
+}
+
+AccessLog::Ring &AccessLog::GetThreadRing()
+{
+    // the ring of the access log this thread used last, only looked up when it changes
+    thread_local std::uint64_t cached_id = std::numeric_limits<std::uint64_t>::max();
+    thread_local Ring *cached_ring = nullptr;
+    if (cached_id == id)
+    {
+        return *cached_ring;
+    }
+
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    auto &ring = thread_rings[std::this_thread::get_id()];
+    if (!ring)
+    {
+        rings.push_back(std::make_unique<Ring>(records_per_thread));
+        ring = rings.back().get();
+    }
+    cached_id = id;
+    cached_ring = ring;
+    return *ring;
+}
+
+bool AccessLog::Drain()
+{
+    std::vector<Ring *> current_rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        for (const auto &ring : rings)
+            current_rings.push_back(ring.get());
+    }
+
+    bool found = false;
+    for (auto *ring : current_rings)
+    {
+        const auto tail = ring->tail.load(std::memory_order_acquire);
+        auto head = ring->head.load(std::memory_order_relaxed);
+        for (; head != tail; ++head)
+        {
+            auto &record = ring->records[head % ring->records.size()];
+            sink(formatAccessRecord(record));
+            // frees the strings of the record before the slot goes back to the request thread
+            record = AccessRecord{};
+            ring->head.store(head + 1, std::memory_order_release);
+            found = true;
+        }
+    }
+
+    const std::uint64_t current_dropped = dropped;
+    if (current_dropped != reported_dropped)
+    {
+        util::Log(logWARNING) << "Access log dropped " << current_dropped - reported_dropped
+                              << " records of requests faster than it could write them";
+        reported_dropped = current_dropped;
+    }
+    return found;
+}
+
+void AccessLog::Run()
+{
+    std::unique_lock<std::mutex> lock(wake_mutex);
+    while (!stop)
+    {
+        lock.unlock();
+        const bool found = Drain();
+        lock.lock();
+        if (!found)
+        {
+            wake.wait_for(lock, WRITER_INTERVAL, [this] { return stop; });
+        }
+    }
+    lock.unlock();
+    Drain();
+}
+}
+}
@@ -0,0 +1,126 @@
+#include "server/admission_control.hpp"
+
+#include "server/api/parsed_url.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+// an encoded polyline coordinate pair takes roughly this many characters
+const constexpr std::size_t POLYLINE_CHARS_PER_COORDINATE = 8;
+}
+
+std::size_t EstimateRequestCost(const api::ParsedURL &parsed_url)
+{
+    const auto &query = parsed_url.query;
+    const auto coordinates_end = std::find(query.begin(), query.end(), '?');
+
+    const std::string polyline_prefix = "polyline(";
+    if (static_cast<std::size_t>(std::distance(query.begin(), coordinates_end)) >
+            polyline_prefix.size() &&
+        std::equal(polyline_prefix.begin(), polyline_prefix.end(), query.begin()))
+    {
+        const auto length = std::distance(query.begin(), coordinates_end) - polyline_prefix.size();
+        return std::max<std::size_t>(1, length / POLYLINE_CHARS_PER_COORDINATE);
+    }
+
+    return 1 + std::count(query.begin(), coordinates_end, ';');
+}
+
+AdmissionControl::Ticket::Ticket(Ticket &&other) noexcept : queue(other.queue),
+                                                             cost(other.cost),
+                                                             admitted(other.admitted)
+{
+    other.queue = nullptr;
+    other.admitted = false;
+}
+
+AdmissionControl::Ticket &AdmissionControl::Ticket::operator=(Ticket &&other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        queue = other.queue;
+        cost = other.cost;
+        admitted = other.admitted;
+        other.queue = nullptr;
+        other.admitted = false;
+    }
+    return *this;
+}
+
+AdmissionControl::Ticket::~Ticket() { Release(); }
+
+void AdmissionControl::Ticket::Release()
+{
+    if (queue && admitted)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            BOOST_ASSERT(queue->running_cost >= cost);
+            queue->running_cost -= cost;
+        }
+        queue->budget_released.notify_all();
+    }
+    queue = nullptr;
+    admitted = false;
+}
+
+void AdmissionControl::SetLimits(const std::string &service, const Limits &limits)
+{
+    BOOST_ASSERT(limits.max_cost > 0);
+    queues[service] = std::make_unique<ServiceQueue>(limits);
+}
+
+AdmissionControl::Ticket AdmissionControl::Admit(const std::string &service, std::size_t cost)
+{
+    Ticket ticket;
+
+    const auto queue_iter = queues.find(service);
+    if (queue_iter == queues.end())
+    {
+        // unlimited service
+        ticket.admitted = true;
+        return ticket;
+    }
+
+    auto &queue = *queue_iter->second;
+    // a single request larger than the budget may still run, but only on its own
+    cost = std::min(std::max<std::size_t>(cost, 1), queue.limits.max_cost);
+    const auto fits = [&queue, cost] { return queue.running_cost + cost <= queue.limits.max_cost; };
+
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    if (queue.num_queued == 0 && fits())
+    {
+        queue.running_cost += cost;
+    }
+    else if (queue.num_queued >= queue.limits.max_queued)
+    {
+        return ticket;
+    }
+    else
+    {
+        ++queue.num_queued;
+        const bool admitted = queue.budget_released.wait_for(lock, queue.limits.max_wait, fits);
+        --queue.num_queued;
+        if (!admitted)
+        {
+            return ticket;
+        }
+        queue.running_cost += cost;
+    }
+
+    ticket.queue = &queue;
+    ticket.cost = cost;
+    ticket.admitted = true;
+    return ticket;
+}
+}
+}
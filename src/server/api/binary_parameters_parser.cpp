@@ -0,0 +1,191 @@
+#include "server/api/binary_parameters_parser.hpp"
+
+#include "engine/bearing.hpp"
+#include "engine/hint.hpp"
+#include "util/coordinate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+namespace
+{
+static_assert(sizeof(util::Coordinate) == 2 * sizeof(std::int32_t),
+              "binary coordinates are mapped directly onto util::Coordinate");
+static_assert(std::is_trivially_copyable<util::Coordinate>::value,
+              "binary coordinates are mapped directly onto util::Coordinate");
+static_assert(std::is_trivially_copyable<engine::Hint>::value,
+              "binary hints are mapped directly onto engine::Hint");
+
+const constexpr std::size_t HEADER_SIZE = 2 * sizeof(std::uint32_t);
+const constexpr std::size_t BEARING_SIZE = 2 * sizeof(std::int16_t);
+
+template <typename T> T Read(const char *&cursor)
+{
+    T value;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+
+boost::optional<engine::api::BaseParameters> parseParameters(const char *const data,
+                                                             const std::size_t size)
+{
+    if (size < HEADER_SIZE)
+    {
+        return boost::none;
+    }
+
+    const char *cursor = data;
+    const std::size_t count = Read<std::uint32_t>(cursor);
+    const auto sections = Read<std::uint32_t>(cursor);
+    if ((sections & ~(BINARY_RADIUSES | BINARY_BEARINGS | BINARY_HINTS)) != 0)
+    {
+        return boost::none;
+    }
+
+    std::size_t record_size = sizeof(util::Coordinate);
+    if (sections & BINARY_RADIUSES)
+        record_size += sizeof(double);
+    if (sections & BINARY_BEARINGS)
+        record_size += BEARING_SIZE;
+    if (sections & BINARY_HINTS)
+        record_size += sizeof(engine::Hint);
+
+    // checked by division so a huge count can not wrap around
+    if ((size - HEADER_SIZE) % record_size != 0 ||
+        (size - HEADER_SIZE) / record_size != count)
+    {
+        return boost::none;
+    }
+
+    engine::api::BaseParameters parameters;
+
+    parameters.coordinates.resize(count);
+    std::memcpy(parameters.coordinates.data(), cursor, count * sizeof(util::Coordinate));
+    cursor += count * sizeof(util::Coordinate);
+
+    if (sections & BINARY_RADIUSES)
+    {
+        parameters.radiuses.reserve(count);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            const auto radius = Read<double>(cursor);
+            if (std::isnan(radius))
+                parameters.radiuses.emplace_back(boost::none);
+            else
+                parameters.radiuses.emplace_back(radius);
+        }
+    }
+
+    if (sections & BINARY_BEARINGS)
+    {
+        parameters.bearings.reserve(count);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            const auto bearing = Read<std::int16_t>(cursor);
+            const auto range = Read<std::int16_t>(cursor);
+            if (bearing < 0)
+                parameters.bearings.emplace_back(boost::none);
+            else
+                parameters.bearings.emplace_back(engine::Bearing{bearing, range});
+        }
+    }
+
+    if (sections & BINARY_HINTS)
+    {
+        parameters.hints.reserve(count);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            if (std::all_of(
+                    cursor, cursor + sizeof(engine::Hint), [](const char c) { return c == 0; }))
+            {
+                parameters.hints.emplace_back(boost::none);
+                cursor += sizeof(engine::Hint);
+            }
+            else
+            {
+                parameters.hints.emplace_back(Read<engine::Hint>(cursor));
+            }
+        }
+    }
+
+    return std::move(parameters);
+}
+}
+
+boost::optional<engine::api::BaseParameters> parseBinaryParameters(const std::string &body)
+{
+    return parseParameters(body.data(), body.size());
+}
+
+boost::optional<std::vector<BinaryTrace>> parseBinaryTraces(const std::string &body)
+{
+    if (body.size() < HEADER_SIZE)
+    {
+        return boost::none;
+    }
+
+    const char *cursor = body.data();
+    const char *const end = body.data() + body.size();
+    const std::size_t count = Read<std::uint32_t>(cursor);
+    const auto sections = Read<std::uint32_t>(cursor);
+    if ((sections & ~BINARY_TIMESTAMPS) != 0 ||
+        count > (body.size() - HEADER_SIZE) / sizeof(std::uint32_t))
+    {
+        return boost::none;
+    }
+
+    std::vector<BinaryTrace> traces(count);
+    for (auto &trace : traces)
+    {
+        if (static_cast<std::size_t>(end - cursor) < sizeof(std::uint32_t))
+        {
+            return boost::none;
+        }
+        const std::size_t size = Read<std::uint32_t>(cursor);
+        if (static_cast<std::size_t>(end - cursor) < size)
+        {
+            return boost::none;
+        }
+        auto parameters = parseParameters(cursor, size);
+        if (!parameters)
+        {
+            return boost::none;
+        }
+        cursor += size;
+        trace.parameters = std::move(*parameters);
+
+        if (sections & BINARY_TIMESTAMPS)
+        {
+            const auto number_of_coordinates = trace.parameters.coordinates.size();
+            if (static_cast<std::size_t>(end - cursor) / sizeof(std::uint32_t) <
+                number_of_coordinates)
+            {
+                return boost::none;
+            }
+            trace.timestamps.reserve(number_of_coordinates);
+            for (std::size_t index = 0; index < number_of_coordinates; ++index)
+            {
+                trace.timestamps.push_back(Read<std::uint32_t>(cursor));
+            }
+        }
+    }
+
+    if (cursor != end)
+    {
+        return boost::none;
+    }
+    return std::move(traces);
+}
+}
+}
+}
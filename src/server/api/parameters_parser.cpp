@@ -1,13 +1,22 @@
 #include "server/api/parameters_parser.hpp"
+#include "server/api/scanner.hpp"
 
-#include "server/api/match_parameter_grammar.hpp"
-#include "server/api/nearest_parameter_grammar.hpp"
-#include "server/api/route_parameters_grammar.hpp"
-#include "server/api/table_parameter_grammar.hpp"
-#include "server/api/tile_parameter_grammar.hpp"
-#include "server/api/trip_parameter_grammar.hpp"
+#include "engine/api/isochrone_parameters.hpp"
+#include "engine/api/match_parameters.hpp"
+#include "engine/api/nearest_parameters.hpp"
+#include "engine/api/route_parameters.hpp"
+#include "engine/api/table_parameters.hpp"
+#include "engine/api/tile_parameters.hpp"
+#include "engine/api/trip_parameters.hpp"
+#include "engine/hint.hpp"
+#include "engine/polyline_compressor.hpp"
 
-#include <type_traits>
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
 
 namespace osrm
 {
@@ -16,44 +25,655 @@ namespace server
 namespace api
 {
 
-namespace detail
+// The parsers below accept exactly the language of the spirit grammars in *_grammar.hpp (which
+// are kept as reference for the parameters benchmark) and report errors at the same positions.
+// The isochrone service came later and has no grammar.
+//
+// Every Parse*Option function either returns false without consuming input, if the option name
+// is not known to the service, or consumes the whole option and its value.
+namespace
+{
+using engine::api::BaseParameters;
+using engine::api::IsochroneParameters;
+using engine::api::MatchParameters;
+using engine::api::NearestParameters;
+using engine::api::RouteParameters;
+using engine::api::TableParameters;
+using engine::api::TileParameters;
+using engine::api::TripParameters;
+
+bool IsPolylineChar(const char c)
+{
+    if (Scanner::IsAlphaNumeral(c))
+        return true;
+    switch (c)
+    {
+    case '%':
+    case '-':
+    case '?':
+    case '@':
+    case '[':
+    case '\\':
+    case ']':
+    case '^':
+    case '_':
+    case '`':
+    case '{':
+    case '|':
+    case '}':
+    case '~':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool IsBase64Char(const char c)
+{
+    return Scanner::IsAlphaNumeral(c) || c == '-' || c == '_' || c == '=';
+}
+
+bool IsClassNameChar(const char c) { return Scanner::IsAlphaNumeral(c) || c == '_'; }
+
+bool IsSessionChar(const char c)
+{
+    return Scanner::IsAlphaNumeral(c) || c == '-' || c == '_';
+}
+
+bool ParseLocation(Scanner &scanner, util::Coordinate &coordinate)
+{
+    double lon, lat;
+    if (!scanner.ParseReal(lon, Scanner::RealFormat::Coordinate))
+    {
+        return false;
+    }
+    scanner.Expect(scanner.SkipChar(','));
+    scanner.Expect(scanner.ParseReal(lat, Scanner::RealFormat::Coordinate));
+
+    coordinate = util::Coordinate(util::toFixed(util::UnsafeFloatLongitude{lon}),
+                                  util::toFixed(util::UnsafeFloatLatitude{lat}));
+    return true;
+}
+
+// Parses `item` separated by `separator`, backing off a separator that is not followed by an item
+template <typename ItemParser> bool ParseList(Scanner &scanner, char separator, ItemParser item)
+{
+    if (!item())
+    {
+        return false;
+    }
+    while (true)
+    {
+        const auto before_separator = scanner.Position();
+        if (!scanner.SkipChar(separator))
+        {
+            break;
+        }
+        if (!item())
+        {
+            scanner.Rewind(before_separator);
+            break;
+        }
+    }
+    return true;
+}
+
+// Same as above for items that may be empty: those never fail and always yield an entry
+template <typename ItemParser>
+void ParseOptionalList(Scanner &scanner, char separator, ItemParser item)
+{
+    do
+    {
+        item();
+    } while (scanner.SkipChar(separator));
+}
+
+bool ParseCoordinates(Scanner &scanner, BaseParameters &parameters)
+{
+    parameters.coordinates.clear();
+    const bool is_list = ParseList(scanner, ';', [&] {
+        util::Coordinate coordinate;
+        if (!ParseLocation(scanner, coordinate))
+        {
+            return false;
+        }
+        parameters.coordinates.push_back(coordinate);
+        return true;
+    });
+    if (is_list)
+    {
+        return true;
+    }
+
+    // decodes straight out of the request into the coordinates
+    const auto parse_polyline = [&](auto decode) {
+        util::StringView polyline;
+        scanner.Expect(scanner.ParseRun(IsPolylineChar, polyline));
+        scanner.Expect(scanner.SkipChar(')'));
+        parameters.coordinates.clear();
+        decode(polyline.data(), polyline.data() + polyline.size());
+        return true;
+    };
+
+    if (scanner.SkipLiteral("polyline("))
+    {
+        return parse_polyline([&](const char *first, const char *last) {
+            engine::decodePolyline(first, last, parameters.coordinates);
+        });
+    }
+    if (scanner.SkipLiteral("polyline6("))
+    {
+        return parse_polyline([&](const char *first, const char *last) {
+            engine::decodePolyline<1000000>(first, last, parameters.coordinates);
+        });
+    }
+    return false;
+}
+
+bool ParseBaseOption(Scanner &scanner, BaseParameters &parameters)
+{
+    if (scanner.SkipLiteral("radiuses="))
+    {
+        parameters.radiuses.clear();
+        ParseOptionalList(scanner, ';', [&] {
+            double radius;
+            if (scanner.ParseReal(radius, Scanner::RealFormat::Generic))
+            {
+                parameters.radiuses.emplace_back(radius);
+            }
+            else if (scanner.SkipLiteral("unlimited"))
+            {
+                parameters.radiuses.emplace_back(std::numeric_limits<double>::infinity());
+            }
+            else
+            {
+                parameters.radiuses.emplace_back(boost::none);
+            }
+        });
+        return true;
+    }
+
+    if (scanner.SkipLiteral("hints="))
+    {
+        ParseOptionalList(scanner, ';', [&] {
+            std::string hint;
+            if (scanner.SkipChar(engine::COMPACT_HINT_PREFIX))
+            {
+                hint.push_back(engine::COMPACT_HINT_PREFIX);
+                scanner.Expect(scanner.ParseRun(IsBase64Char, hint));
+                const auto decoded = engine::Hint::FromCompactBase64(hint);
+                scanner.Expect(static_cast<bool>(decoded));
+                parameters.hints.emplace_back(*decoded);
+            }
+            else if (scanner.ParseFixed(IsBase64Char, engine::ENCODED_HINT_SIZE, hint))
+            {
+                parameters.hints.emplace_back(engine::Hint::FromBase64(hint));
+            }
+            else
+            {
+                parameters.hints.emplace_back(boost::none);
+            }
+        });
+        return true;
+    }
+
+    if (scanner.SkipLiteral("bearings="))
+    {
+        ParseOptionalList(scanner, ';', [&] {
+            short bearing, range;
+            if (scanner.ParseSigned(bearing))
+            {
+                scanner.Expect(scanner.SkipChar(','));
+                scanner.Expect(scanner.ParseSigned(range));
+                parameters.bearings.emplace_back(engine::Bearing{bearing, range});
+            }
+            else
+            {
+                parameters.bearings.emplace_back(boost::none);
+            }
+        });
+        return true;
+    }
+
+    if (scanner.SkipLiteral("generate_hints="))
+    {
+        scanner.Expect(scanner.ParseBool(parameters.generate_hints));
+        return true;
+    }
+
+    if (scanner.SkipLiteral("compact_hints="))
+    {
+        scanner.Expect(scanner.ParseBool(parameters.compact_hints));
+        return true;
+    }
+
+    if (scanner.SkipLiteral("metric="))
+    {
+        scanner.Expect(scanner.ParseUnsigned(parameters.metric));
+        return true;
+    }
+
+    if (scanner.SkipLiteral("departure_time="))
+    {
+        std::uint64_t departure_time;
+        scanner.Expect(scanner.ParseUnsigned(departure_time));
+        parameters.departure_time = departure_time;
+        return true;
+    }
+
+    if (scanner.SkipLiteral("debug="))
+    {
+        scanner.Expect(scanner.SkipLiteral("stats"));
+        parameters.debug_stats = true;
+        return true;
+    }
+
+    if (scanner.SkipLiteral("exclude="))
+    {
+        parameters.exclude.clear();
+        scanner.Expect(ParseList(scanner, ',', [&] {
+            std::string name;
+            if (!scanner.ParseRun(IsClassNameChar, name))
+            {
+                return false;
+            }
+            parameters.exclude.push_back(std::move(name));
+            return true;
+        }));
+        return true;
+    }
+
+    if (scanner.SkipLiteral("output_format="))
+    {
+        static const std::pair<const char *, BaseParameters::OutputFormatType> formats[] = {
+            {"json", BaseParameters::OutputFormatType::JSON},
+            {"binary", BaseParameters::OutputFormatType::Binary}};
+
+        scanner.Expect(scanner.ParseSymbol(formats, parameters.output_format));
+        return true;
+    }
+
+    if (scanner.SkipLiteral("approaches="))
+    {
+        static const std::pair<const char *, engine::Approach> approaches[] = {
+            {"unrestricted", engine::Approach::UNRESTRICTED}, {"curb", engine::Approach::CURB}};
+
+        parameters.approaches.clear();
+        ParseOptionalList(scanner, ';', [&] {
+            engine::Approach approach;
+            if (scanner.ParseSymbol(approaches, approach))
+            {
+                parameters.approaches.emplace_back(approach);
+            }
+            else
+            {
+                parameters.approaches.emplace_back(boost::none);
+            }
+        });
+        return true;
+    }
+
+    return false;
+}
+
+// Options shared by route, trip and match
+bool ParseRouteOption(Scanner &scanner, RouteParameters &parameters)
+{
+    using AnnotationsType = RouteParameters::AnnotationsType;
+
+    if (ParseBaseOption(scanner, parameters))
+    {
+        return true;
+    }
+
+    if (scanner.SkipLiteral("steps="))
+    {
+        scanner.Expect(scanner.ParseBool(parameters.steps));
+        return true;
+    }
+
+    if (scanner.SkipLiteral("geometries="))
+    {
+        static const std::pair<const char *, RouteParameters::GeometriesType> geometries[] = {
+            {"geojson", RouteParameters::GeometriesType::GeoJSON},
+            {"polyline", RouteParameters::GeometriesType::Polyline},
+            {"polyline6", RouteParameters::GeometriesType::Polyline6}};
+
+        scanner.Expect(scanner.ParseSymbol(geometries, parameters.geometries));
+        return true;
+    }
+
+    if (scanner.SkipLiteral("overview="))
+    {
+        static const std::pair<const char *, RouteParameters::OverviewType> overviews[] = {
+            {"simplified", RouteParameters::OverviewType::Simplified},
+            {"full", RouteParameters::OverviewType::Full},
+            {"false", RouteParameters::OverviewType::False}};
+
+        scanner.Expect(scanner.ParseSymbol(overviews, parameters.overview));
+        return true;
+    }
+
+    if (scanner.SkipLiteral("annotations="))
+    {
+        static const std::pair<const char *, AnnotationsType> annotations[] = {
+            {"duration", AnnotationsType::Duration},
+            {"nodes", AnnotationsType::Nodes},
+            {"distance", AnnotationsType::Distance},
+            {"weight", AnnotationsType::Weight},
+            {"datasources", AnnotationsType::Datasources},
+            {"speed", AnnotationsType::Speed}};
+
+        const auto add_annotation = [&parameters](const AnnotationsType annotation) {
+            parameters.annotations_type = parameters.annotations_type | annotation;
+            parameters.annotations = parameters.annotations_type != AnnotationsType::None;
+        };
+
+        if (scanner.SkipLiteral("true"))
+        {
+            add_annotation(AnnotationsType::All);
+        }
+        else if (scanner.SkipLiteral("false"))
+        {
+            add_annotation(AnnotationsType::None);
+        }
+        else
+        {
+            scanner.Expect(ParseList(scanner, ',', [&] {
+                AnnotationsType annotation = AnnotationsType::None;
+                if (!scanner.ParseSymbol(annotations, annotation))
+                {
+                    return false;
+                }
+                add_annotation(annotation);
+                return true;
+            }));
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// Options only understood by the route service itself
+bool ParseRouteOnlyOption(Scanner &scanner, RouteParameters &parameters)
+{
+    if (scanner.SkipLiteral("alternatives="))
+    {
+        unsigned number;
+        bool enabled;
+        if (scanner.ParseUnsigned(number))
+        {
+            parameters.number_of_alternatives = number;
+            parameters.alternatives = number > 0;
+        }
+        else
+        {
+            scanner.Expect(scanner.ParseBool(enabled));
+            parameters.number_of_alternatives = enabled;
+            parameters.alternatives = enabled;
+        }
+        return true;
+    }
+
+    if (scanner.SkipLiteral("continue_straight="))
+    {
+        bool continue_straight;
+        if (!scanner.SkipLiteral("default"))
+        {
+            scanner.Expect(scanner.ParseBool(continue_straight));
+            parameters.continue_straight = continue_straight;
+        }
+        return true;
+    }
+
+    if (scanner.SkipLiteral("reroute="))
+    {
+        scanner.Expect(scanner.ParseBool(parameters.reroute));
+        return true;
+    }
+
+    return ParseRouteOption(scanner, parameters);
+}
+
+bool ParseIndices(Scanner &scanner, std::vector<std::size_t> &indices)
+{
+    if (scanner.SkipLiteral("all"))
+    {
+        return true;
+    }
+    indices.clear();
+    return ParseList(scanner, ';', [&] {
+        std::size_t index;
+        if (!scanner.ParseUnsigned(index))
+        {
+            return false;
+        }
+        indices.push_back(index);
+        return true;
+    });
+}
+
+bool ParseTableOption(Scanner &scanner, TableParameters &parameters)
+{
+    if (scanner.SkipLiteral("destinations="))
+    {
+        scanner.Expect(ParseIndices(scanner, parameters.destinations));
+        return true;
+    }
+    if (scanner.SkipLiteral("sources="))
+    {
+        scanner.Expect(ParseIndices(scanner, parameters.sources));
+        return true;
+    }
+    if (scanner.SkipLiteral("annotations="))
+    {
+        using AnnotationsType = TableParameters::AnnotationsType;
+        static const std::pair<const char *, AnnotationsType> annotations[] = {
+            {"duration", AnnotationsType::Duration}, {"distance", AnnotationsType::Distance}};
+
+        // the listed annotations replace the default of durations only
+        parameters.annotations = AnnotationsType::None;
+        scanner.Expect(ParseList(scanner, ',', [&] {
+            AnnotationsType annotation = AnnotationsType::None;
+            if (!scanner.ParseSymbol(annotations, annotation))
+            {
+                return false;
+            }
+            parameters.annotations = parameters.annotations | annotation;
+            return true;
+        }));
+        return true;
+    }
+    if (scanner.SkipLiteral("paths="))
+    {
+        parameters.paths.clear();
+        scanner.Expect(ParseList(scanner, ';', [&] {
+            std::size_t source, destination;
+            if (!scanner.ParseUnsigned(source))
+            {
+                return false;
+            }
+            scanner.Expect(scanner.SkipChar(','));
+            scanner.Expect(scanner.ParseUnsigned(destination));
+            parameters.paths.emplace_back(source, destination);
+            return true;
+        }));
+        return true;
+    }
+    return ParseBaseOption(scanner, parameters);
+}
+
+bool ParseNearestOption(Scanner &scanner, NearestParameters &parameters)
+{
+    if (scanner.SkipLiteral("number="))
+    {
+        scanner.Expect(scanner.ParseUnsigned(parameters.number_of_results));
+        return true;
+    }
+    return ParseBaseOption(scanner, parameters);
+}
+
+bool ParseTripOption(Scanner &scanner, TripParameters &parameters)
+{
+    if (scanner.SkipLiteral("roundtrip="))
+    {
+        scanner.Expect(scanner.ParseBool(parameters.roundtrip));
+        return true;
+    }
+    if (scanner.SkipLiteral("source="))
+    {
+        static const std::pair<const char *, TripParameters::SourceType> sources[] = {
+            {"any", TripParameters::SourceType::Any}, {"first", TripParameters::SourceType::First}};
+        scanner.Expect(scanner.ParseSymbol(sources, parameters.source));
+        return true;
+    }
+    if (scanner.SkipLiteral("destination="))
+    {
+        static const std::pair<const char *, TripParameters::DestinationType> destinations[] = {
+            {"any", TripParameters::DestinationType::Any},
+            {"last", TripParameters::DestinationType::Last}};
+        scanner.Expect(scanner.ParseSymbol(destinations, parameters.destination));
+        return true;
+    }
+    return ParseRouteOption(scanner, parameters);
+}
+
+bool ParseMatchOption(Scanner &scanner, MatchParameters &parameters)
+{
+    if (scanner.SkipLiteral("timestamps="))
+    {
+        parameters.timestamps.clear();
+        scanner.Expect(ParseList(scanner, ';', [&] {
+            unsigned timestamp;
+            if (!scanner.ParseUnsigned(timestamp))
+            {
+                return false;
+            }
+            parameters.timestamps.push_back(timestamp);
+            return true;
+        }));
+        return true;
+    }
+    if (scanner.SkipLiteral("gaps="))
+    {
+        static const std::pair<const char *, MatchParameters::GapsType> gaps[] = {
+            {"split", MatchParameters::GapsType::Split},
+            {"ignore", MatchParameters::GapsType::Ignore}};
+        scanner.Expect(scanner.ParseSymbol(gaps, parameters.gaps));
+        return true;
+    }
+    if (scanner.SkipLiteral("tidy="))
+    {
+        scanner.Expect(scanner.ParseBool(parameters.tidy));
+        return true;
+    }
+    if (scanner.SkipLiteral("session="))
+    {
+        // ids of up to 64 letters, digits, dashes and underscores
+        util::StringView session;
+        scanner.Expect(scanner.ParseRun(IsSessionChar, session) && session.size() <= 64);
+        parameters.session.assign(session.begin(), session.end());
+        return true;
+    }
+    return ParseRouteOption(scanner, parameters);
+}
+
+bool ParseIsochroneOption(Scanner &scanner, IsochroneParameters &parameters)
+{
+    if (scanner.SkipLiteral("contours="))
+    {
+        parameters.contours.clear();
+        scanner.Expect(ParseList(scanner, ';', [&] {
+            unsigned contour;
+            if (!scanner.ParseUnsigned(contour))
+            {
+                return false;
+            }
+            parameters.contours.push_back(contour);
+            return true;
+        }));
+        return true;
+    }
+    if (scanner.SkipLiteral("polygons="))
+    {
+        scanner.Expect(scanner.ParseBool(parameters.polygons));
+        return true;
+    }
+    if (scanner.SkipLiteral("tile="))
+    {
+        TileParameters tile;
+        scanner.Expect(scanner.ParseUnsigned(tile.x));
+        scanner.Expect(scanner.SkipChar(','));
+        scanner.Expect(scanner.ParseUnsigned(tile.y));
+        scanner.Expect(scanner.SkipChar(','));
+        scanner.Expect(scanner.ParseUnsigned(tile.z));
+        parameters.tile = tile;
+        return true;
+    }
+    return ParseBaseOption(scanner, parameters);
+}
+
+// [.json][?option(&option)*]
+template <typename ParameterT, typename OptionParser>
+bool ParseOptions(Scanner &scanner, ParameterT &parameters, OptionParser option)
 {
-template <typename T>
-using is_grammar_t =
-    std::integral_constant<bool,
-                           std::is_same<RouteParametersGrammar<>, T>::value ||
-                               std::is_same<TableParametersGrammar<>, T>::value ||
-                               std::is_same<NearestParametersGrammar<>, T>::value ||
-                               std::is_same<TripParametersGrammar<>, T>::value ||
-                               std::is_same<MatchParametersGrammar<>, T>::value ||
-                               std::is_same<TileParametersGrammar<>, T>::value>;
+    scanner.SkipLiteral(".json");
+
+    if (scanner.SkipChar('?'))
+    {
+        scanner.Expect(ParseList(scanner, '&', [&] { return option(scanner, parameters); }));
+    }
+    return true;
+}
 
-template <typename ParameterT,
-          typename GrammarT,
-          typename std::enable_if<detail::is_parameter_t<ParameterT>::value, int>::type = 0,
-          typename std::enable_if<detail::is_grammar_t<GrammarT>::value, int>::type = 0>
-boost::optional<ParameterT> parseParameters(std::string::iterator &iter,
-                                            const std::string::iterator end)
+// coordinates[.json][?option(&option)*]
+template <typename ParameterT, typename OptionParser>
+bool ParseQuery(Scanner &scanner, ParameterT &parameters, OptionParser option)
 {
-    using It = std::decay<decltype(iter)>::type;
+    if (!ParseCoordinates(scanner, parameters))
+    {
+        return false;
+    }
+    return ParseOptions(scanner, parameters, option);
+}
 
-    static const GrammarT grammar;
+bool ParseTile(Scanner &scanner, TileParameters &parameters)
+{
+    if (!scanner.SkipLiteral("tile("))
+    {
+        return false;
+    }
+    scanner.Expect(scanner.ParseUnsigned(parameters.x));
+    scanner.Expect(scanner.SkipChar(','));
+    scanner.Expect(scanner.ParseUnsigned(parameters.y));
+    scanner.Expect(scanner.SkipChar(','));
+    scanner.Expect(scanner.ParseUnsigned(parameters.z));
+    scanner.Expect(scanner.SkipLiteral(").mvt"));
+    return true;
+}
 
+template <typename ParameterT, typename ParserT>
+boost::optional<ParameterT>
+parseParametersWith(std::string::iterator &iter, const std::string::iterator end, ParserT parser)
+{
     try
     {
+        Scanner scanner(iter, end);
         ParameterT parameters;
-        const auto ok =
-            boost::spirit::qi::parse(iter, end, grammar(boost::phoenix::ref(parameters)));
+        if (!parser(scanner, parameters))
+        {
+            return boost::none;
+        }
 
+        iter = scanner.Position();
         // return move(a.b) is needed to move b out of a and then return the rvalue by implicit move
-        if (ok && iter == end)
+        if (iter == end)
             return std::move(parameters);
     }
-    catch (const qi::expectation_failure<It> &failure)
+    catch (const ScanError &error)
     {
-        // The grammar above using expectation parsers ">" does not automatically increment the
-        // iterator to the failing position. Extract the position from the exception ourselves.
-        iter = failure.first;
+        iter = error.position;
     }
     catch (const boost::numeric::bad_numeric_cast &)
     {
@@ -63,52 +683,133 @@ boost::optional<ParameterT> parseParameters(std::string::iterator &iter,
 
     return boost::none;
 }
-} // ns detail
+} // anon. ns
 
 template <>
 boost::optional<engine::api::RouteParameters> parseParameters(std::string::iterator &iter,
                                                               const std::string::iterator end)
 {
-    return detail::parseParameters<engine::api::RouteParameters, RouteParametersGrammar<>>(iter,
-                                                                                           end);
+    return parseParametersWith<RouteParameters>(
+        iter, end, [](Scanner &scanner, RouteParameters &parameters) {
+            return ParseQuery(scanner, parameters, ParseRouteOnlyOption);
+        });
 }
 
 template <>
 boost::optional<engine::api::TableParameters> parseParameters(std::string::iterator &iter,
                                                               const std::string::iterator end)
 {
-    return detail::parseParameters<engine::api::TableParameters, TableParametersGrammar<>>(iter,
-                                                                                           end);
+    return parseParametersWith<TableParameters>(
+        iter, end, [](Scanner &scanner, TableParameters &parameters) {
+            return ParseQuery(scanner, parameters, ParseTableOption);
+        });
 }
 
 template <>
 boost::optional<engine::api::NearestParameters> parseParameters(std::string::iterator &iter,
                                                                 const std::string::iterator end)
 {
-    return detail::parseParameters<engine::api::NearestParameters, NearestParametersGrammar<>>(iter,
-                                                                                               end);
+    return parseParametersWith<NearestParameters>(
+        iter, end, [](Scanner &scanner, NearestParameters &parameters) {
+            return ParseQuery(scanner, parameters, ParseNearestOption);
+        });
 }
 
 template <>
 boost::optional<engine::api::TripParameters> parseParameters(std::string::iterator &iter,
                                                              const std::string::iterator end)
 {
-    return detail::parseParameters<engine::api::TripParameters, TripParametersGrammar<>>(iter, end);
+    return parseParametersWith<TripParameters>(
+        iter, end, [](Scanner &scanner, TripParameters &parameters) {
+            return ParseQuery(scanner, parameters, ParseTripOption);
+        });
 }
 
 template <>
 boost::optional<engine::api::MatchParameters> parseParameters(std::string::iterator &iter,
                                                               const std::string::iterator end)
 {
-    return detail::parseParameters<engine::api::MatchParameters, MatchParametersGrammar<>>(iter,
-                                                                                           end);
+    return parseParametersWith<MatchParameters>(
+        iter, end, [](Scanner &scanner, MatchParameters &parameters) {
+            return ParseQuery(scanner, parameters, ParseMatchOption);
+        });
+}
+
+template <>
+boost::optional<engine::api::IsochroneParameters> parseParameters(std::string::iterator &iter,
+                                                                  const std::string::iterator end)
+{
+    return parseParametersWith<IsochroneParameters>(
+        iter, end, [](Scanner &scanner, IsochroneParameters &parameters) {
+            return ParseQuery(scanner, parameters, ParseIsochroneOption);
+        });
 }
 
 template <>
 boost::optional<engine::api::TileParameters> parseParameters(std::string::iterator &iter,
                                                              const std::string::iterator end)
 {
-    return detail::parseParameters<engine::api::TileParameters, TileParametersGrammar<>>(iter, end);
+    return parseParametersWith<TileParameters>(iter, end, ParseTile);
+}
+
+template <>
+boost::optional<engine::api::RouteParameters> parseOptions(std::string::iterator &iter,
+                                                           const std::string::iterator end)
+{
+    return parseParametersWith<RouteParameters>(
+        iter, end, [](Scanner &scanner, RouteParameters &parameters) {
+            return ParseOptions(scanner, parameters, ParseRouteOnlyOption);
+        });
+}
+
+template <>
+boost::optional<engine::api::TableParameters> parseOptions(std::string::iterator &iter,
+                                                           const std::string::iterator end)
+{
+    return parseParametersWith<TableParameters>(
+        iter, end, [](Scanner &scanner, TableParameters &parameters) {
+            return ParseOptions(scanner, parameters, ParseTableOption);
+        });
+}
+
+template <>
+boost::optional<engine::api::NearestParameters> parseOptions(std::string::iterator &iter,
+                                                             const std::string::iterator end)
+{
+    return parseParametersWith<NearestParameters>(
+        iter, end, [](Scanner &scanner, NearestParameters &parameters) {
+            return ParseOptions(scanner, parameters, ParseNearestOption);
+        });
+}
+
+template <>
+boost::optional<engine::api::TripParameters> parseOptions(std::string::iterator &iter,
+                                                          const std::string::iterator end)
+{
+    return parseParametersWith<TripParameters>(
+        iter, end, [](Scanner &scanner, TripParameters &parameters) {
+            return ParseOptions(scanner, parameters, ParseTripOption);
+        });
+}
+
+template <>
+boost::optional<engine::api::MatchParameters> parseOptions(std::string::iterator &iter,
+                                                           const std::string::iterator end)
+{
+    return parseParametersWith<MatchParameters>(
+        iter, end, [](Scanner &scanner, MatchParameters &parameters) {
+            return ParseOptions(scanner, parameters, ParseMatchOption);
+        });
+}
+
+template <>
+boost::optional<engine::api::IsochroneParameters> parseOptions(std::string::iterator &iter,
+                                                               const std::string::iterator end)
+{
+    return parseParametersWith<IsochroneParameters>(
+        iter, end, [](Scanner &scanner, IsochroneParameters &parameters) {
+            return ParseOptions(scanner, parameters, ParseIsochroneOption);
+        });
 }
 
 } // ns api
@@ -1,64 +1,72 @@
 #include "server/api/url_parser.hpp"
-#include "engine/polyline_compressor.hpp"
-
-#include <boost/fusion/include/adapt_struct.hpp>
-#include <boost/spirit/include/phoenix.hpp>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/spirit/repository/include/qi_iter_pos.hpp>
+#include "server/api/scanner.hpp"
 
 #include <string>
-#include <type_traits>
-
-BOOST_FUSION_ADAPT_STRUCT(osrm::server::api::ParsedURL,
-                          (std::string, service)(unsigned, version)(std::string,
-                                                                    profile)(std::string, query))
 
 // Keep impl. TU local
 namespace
 {
-namespace ph = boost::phoenix;
-namespace qi = boost::spirit::qi;
+using osrm::server::api::Scanner;
 
-template <typename Iterator, typename Into> //
-struct URLParser final : qi::grammar<Iterator, Into>
+bool IsQueryChar(const char c)
 {
-    URLParser() : URLParser::base_type(start)
+    if (Scanner::IsAlphaNumeral(c))
+        return true;
+    switch (c)
     {
-        using boost::spirit::repository::qi::iter_pos;
-
-        alpha_numeral = qi::char_("a-zA-Z0-9");
-        percent_encoding = qi::char_('%') > qi::uint_parser<char, 16, 2, 2>()[qi::_val = qi::_1];
-        polyline_chars = qi::char_("a-zA-Z0-9_.--[]{}@?|\\~`^") | percent_encoding;
-        all_chars = polyline_chars | qi::char_("=,;:&().");
-
-        service = +alpha_numeral;
-        version = qi::uint_;
-        profile = +alpha_numeral;
-        query = +all_chars;
-
-        // Example input: /route/v1/driving/7.416351,43.731205;7.420363,43.736189
-
-        start = qi::lit('/') > service > qi::lit('/') > qi::lit('v') > version > qi::lit('/') >
-                profile > qi::lit('/') >
-                qi::omit[iter_pos[ph::bind(&osrm::server::api::ParsedURL::prefix_length, qi::_val) =
-                                      qi::_1 - qi::_r1]] > query;
-
-        BOOST_SPIRIT_DEBUG_NODES((start)(service)(version)(profile)(query))
+    case '-':
+    case '?':
+    case '@':
+    case '[':
+    case '\\':
+    case ']':
+    case '^':
+    case '_':
+    case '`':
+    case '{':
+    case '|':
+    case '}':
+    case '~':
+    case '=':
+    case ',':
+    case ';':
+    case ':':
+    case '&':
+    case '(':
+    case ')':
+    case '.':
+        return true;
+    default:
+        return false;
     }
+}
 
-    qi::rule<Iterator, Into> start;
-
-    qi::rule<Iterator, std::string()> service;
-    qi::rule<Iterator, unsigned()> version;
-    qi::rule<Iterator, std::string()> profile;
-    qi::rule<Iterator, std::string()> query;
-
-    qi::rule<Iterator, char()> alpha_numeral;
-    qi::rule<Iterator, char()> all_chars;
-    qi::rule<Iterator, char()> polyline_chars;
-    qi::rule<Iterator, char()> percent_encoding;
-};
-
+// Appends query characters to the output, decoding %XX escapes on the way
+void ParseQuery(Scanner &scanner, std::string &query)
+{
+    while (!scanner.AtEnd())
+    {
+        const auto c = scanner.Peek();
+        if (IsQueryChar(c))
+        {
+            query.push_back(c);
+            scanner.SkipChar(c);
+        }
+        else if (c == '%')
+        {
+            scanner.SkipChar('%');
+            std::string digits;
+            scanner.Expect(scanner.ParseFixed(
+                [](const char digit) { return Scanner::HexValue(digit) >= 0; }, 2, digits));
+            query.push_back(static_cast<char>(Scanner::HexValue(digits[0]) * 16 +
+                                              Scanner::HexValue(digits[1])));
+        }
+        else
+        {
+            break;
+        }
+    }
+}
 } // anon.
 
 namespace osrm
@@ -68,25 +76,38 @@ namespace server
 namespace api
 {
 
+// Example input: /route/v1/driving/7.416351,43.731205;7.420363,43.736189
 boost::optional<ParsedURL> parseURL(std::string::iterator &iter, const std::string::iterator end)
 {
-    using It = std::decay<decltype(iter)>::type;
-
-    static URLParser<It, ParsedURL(It)> const parser;
+    Scanner scanner(iter, end);
     ParsedURL out;
 
     try
     {
-        const auto ok = boost::spirit::qi::parse(iter, end, parser(boost::phoenix::val(iter)), out);
-
-        if (ok && iter == end)
+        if (!scanner.SkipChar('/'))
+        {
+            return boost::none;
+        }
+        scanner.Expect(scanner.ParseRun(Scanner::IsAlphaNumeral, out.service));
+        scanner.Expect(scanner.SkipChar('/'));
+        scanner.Expect(scanner.SkipChar('v'));
+        scanner.Expect(scanner.ParseUnsigned(out.version));
+        scanner.Expect(scanner.SkipChar('/'));
+        scanner.Expect(scanner.ParseRun(Scanner::IsAlphaNumeral, out.profile));
+        scanner.Expect(scanner.SkipChar('/'));
+
+        out.prefix_length = scanner.Position() - iter;
+
+        scanner.Expect(!scanner.AtEnd() && (IsQueryChar(scanner.Peek()) || scanner.Peek() == '%'));
+        ParseQuery(scanner, out.query);
+
+        iter = scanner.Position();
+        if (iter == end)
             return boost::make_optional(out);
     }
-    catch (const qi::expectation_failure<It> &failure)
+    catch (const ScanError &error)
     {
-        // The grammar above using expectation parsers ">" does not automatically increment the
-        // iterator to the failing position. Extract the position from the exception ourselves.
-        iter = failure.first;
+        iter = error.position;
     }
 
     return boost::none;
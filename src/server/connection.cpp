@@ -4,10 +4,10 @@
 
 #include <boost/assert.hpp>
 #include <boost/bind.hpp>
-#include <boost/iostreams/filter/gzip.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
-
+#include <algorithm>
+#include <cstring>
 #include <iterator>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -16,93 +16,136 @@ namespace osrm
 namespace server
 {
 
-Connection::Connection(boost::asio::io_service &io_service, RequestHandler &handler)
-    : strand(io_service), TCP_socket(io_service), request_handler(handler)
+namespace
+{
+// Clients of the unix domain socket have no address and keep the unspecified one
+boost::asio::ip::address
+remoteAddress(const boost::asio::generic::stream_protocol::endpoint &remote)
 {
+    const auto family = remote.protocol().family();
+    if (family != AF_INET && family != AF_INET6)
+        return {};
+
+    boost::asio::ip::tcp::endpoint endpoint;
+    std::memcpy(endpoint.data(), remote.data(), remote.size());
+    endpoint.resize(remote.size());
+    return endpoint.address();
+}
 }
 
-boost::asio::ip::tcp::socket &Connection::socket() { return TCP_socket; }
+Connection::Connection(boost::asio::io_service &io_service,
+                       RequestHandler &handler,
+                       const unsigned keepalive_timeout,
+                       const unsigned keepalive_max_requests,
+                       const http::compression_levels compression_levels)
+    : strand(io_service), stream_socket(io_service), timer(io_service), request_handler(handler),
+      pipelined_begin(nullptr), pipelined_end(nullptr), keepalive_timeout(keepalive_timeout),
+      keepalive_max_requests(keepalive_max_requests), processed_requests(0), keep_alive(false),
+      reply_compression_type(http::no_compression), compressor(compression_levels),
+      sent_body_bytes(0)
+{
+}
+
+boost::asio::generic::stream_protocol::socket &Connection::socket() { return stream_socket; }
 
 /// Start the first asynchronous operation for the connection.
 void Connection::start()
 {
-    TCP_socket.async_read_some(
+    stream_socket.async_read_some(
         boost::asio::buffer(incoming_data_buffer),
         strand.wrap(boost::bind(&Connection::handle_read,
                                 this->shared_from_this(),
                                 boost::asio::placeholders::error,
                                 boost::asio::placeholders::bytes_transferred)));
+
+    if (keep_alive)
+    {
+        // we are waiting for a follow-up request on a persistent connection
+        timer.expires_from_now(boost::posix_time::seconds(keepalive_timeout));
+        timer.async_wait(strand.wrap(boost::bind(&Connection::handle_timeout,
+                                                 this->shared_from_this(),
+                                                 boost::asio::placeholders::error)));
+    }
 }
 
 void Connection::handle_read(const boost::system::error_code &error, std::size_t bytes_transferred)
 {
     if (error)
     {
+        // either the client went away or the read was canceled by the keep-alive timer
+        boost::system::error_code ignore_error;
+        timer.cancel(ignore_error);
         return;
     }
 
+    if (keep_alive)
+    {
+        // disarm the keep-alive timer while we are busy answering the request
+        boost::system::error_code ignore_error;
+        timer.expires_at(boost::posix_time::pos_infin, ignore_error);
+    }
+
+    handle_request(incoming_data_buffer.data(), incoming_data_buffer.data() + bytes_transferred);
+}
+
+void Connection::handle_request(char *begin, char *end)
+{
     // no error detected, let's parse the request
     http::compression_type compression_type(http::no_compression);
     RequestParser::RequestStatus result;
-    std::tie(result, compression_type) =
-        request_parser.parse(current_request,
-                             incoming_data_buffer.data(),
-                             incoming_data_buffer.data() + bytes_transferred);
+    char *parsed_end;
+    std::tie(result, compression_type, parsed_end) =
+        request_parser.parse(current_request, begin, end);
 
     // the request has been parsed
     if (result == RequestParser::RequestStatus::valid)
     {
-        current_request.endpoint = TCP_socket.remote_endpoint().address();
-        request_handler.HandleRequest(current_request, current_reply);
-
-        // compress the result w/ gzip/deflate if requested
-        switch (compression_type)
+        boost::system::error_code endpoint_error;
+        current_request.endpoint = remoteAddress(stream_socket.remote_endpoint(endpoint_error));
+        if (endpoint_error)
         {
-        case http::deflate_rfc1951:
-            // use deflate for compression
-            current_reply.headers.insert(current_reply.headers.begin(),
-                                         {"Content-Encoding", "deflate"});
-            compressed_output = compress_buffers(current_reply.content, compression_type);
-            current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
-            output_buffer = current_reply.headers_to_buffers();
-            output_buffer.push_back(boost::asio::buffer(compressed_output));
-            break;
-        case http::gzip_rfc1952:
-            // use gzip for compression
-            current_reply.headers.insert(current_reply.headers.begin(),
-                                         {"Content-Encoding", "gzip"});
-            compressed_output = compress_buffers(current_reply.content, compression_type);
-            current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
-            output_buffer = current_reply.headers_to_buffers();
-            output_buffer.push_back(boost::asio::buffer(compressed_output));
-            break;
-        case http::no_compression:
-            // don't use any compression
-            current_reply.set_uncompressed_size();
-            output_buffer = current_reply.to_buffers();
-            break;
+            // the client disconnected before we could answer
+            handle_shutdown();
+            return;
         }
-        // write result to stream
-        boost::asio::async_write(TCP_socket,
-                                 output_buffer,
-                                 strand.wrap(boost::bind(&Connection::handle_write,
-                                                         this->shared_from_this(),
-                                                         boost::asio::placeholders::error)));
+        reply_compression_type = compression_type;
+        pipelined_begin = parsed_end;
+        pipelined_end = end;
+        // the reply is completed on a worker thread with a service executor, the connection
+        // stays alive and does not read until it was sent
+        request_handler.DispatchRequest(
+            current_request, current_reply, [self = this->shared_from_this()]() {
+                self->strand.dispatch(boost::bind(&Connection::handle_reply, self));
+            });
     }
     else if (result == RequestParser::RequestStatus::invalid)
     { // request is not parseable
+        keep_alive = false;
         current_reply = http::reply::stock_reply(http::reply::bad_request);
+        current_reply.headers.emplace_back("Connection", "close");
+        sent_body_bytes = current_reply.content.size();
 
-        boost::asio::async_write(TCP_socket,
+        boost::asio::async_write(stream_socket,
                                  current_reply.to_buffers(),
                                  strand.wrap(boost::bind(&Connection::handle_write,
                                                          this->shared_from_this(),
                                                          boost::asio::placeholders::error)));
     }
+    else if (current_request.expect_continue)
+    {
+        // the client waits for our go before it sends the request body
+        current_request.expect_continue = false;
+        static const std::string continue_reply = "HTTP/1.1 100 Continue\r\n\r\n";
+        boost::asio::async_write(stream_socket,
+                                 boost::asio::buffer(continue_reply),
+                                 strand.wrap(boost::bind(&Connection::handle_continue_write,
+                                                         this->shared_from_this(),
+                                                         boost::asio::placeholders::error)));
+    }
     else
     {
         // we don't have a result yet, so continue reading
-        TCP_socket.async_read_some(
+        stream_socket.async_read_some(
             boost::asio::buffer(incoming_data_buffer),
             strand.wrap(boost::bind(&Connection::handle_read,
                                     this->shared_from_this(),
@@ -111,39 +154,270 @@ void Connection::handle_read(const boost::system::error_code &error, std::size_t
     }
 }
 
+void Connection::handle_reply()
+{
+    ++processed_requests;
+    keep_alive = keepalive_timeout > 0 && processed_requests < keepalive_max_requests &&
+                 current_request.keep_alive();
+    if (keep_alive)
+    {
+        current_reply.headers.emplace_back("Connection", "keep-alive");
+        current_reply.headers.emplace_back(
+            "Keep-Alive",
+            "timeout=" + std::to_string(keepalive_timeout) + ", max=" +
+                std::to_string(keepalive_max_requests - processed_requests));
+    }
+    else
+    {
+        current_reply.headers.emplace_back("Connection", "close");
+        pipelined_begin = pipelined_end = nullptr;
+    }
+
+    if (current_reply.stream)
+    {
+        // the body is not known in full, so it is sent as it is produced and not compressed
+        current_reply.headers.emplace_back("Transfer-Encoding", "chunked");
+        sent_body_bytes = 0;
+        output_buffer = current_reply.headers_to_buffers();
+        boost::asio::async_write(
+            stream_socket,
+            output_buffer,
+            strand.wrap(boost::bind(&Connection::handle_stream_write,
+                                    this->shared_from_this(),
+                                    boost::asio::placeholders::error)));
+        return;
+    }
+
+    // compress the result w/ the negotiated codec if requested
+    if (reply_compression_type != http::no_compression &&
+        compressor.reset(reply_compression_type, current_reply.content))
+    {
+        current_reply.headers.insert(
+            current_reply.headers.begin(),
+            {"Content-Encoding", http::content_encoding(reply_compression_type)});
+
+        // HTTP/1.0 clients do not understand chunked replies, compress them in one go
+        if (current_request.http_version_major == 1 && current_request.http_version_minor == 0)
+        {
+            compressed_output.clear();
+            compressor.compress_all(compressed_output);
+            current_reply.set_size(compressed_output.size());
+            sent_body_bytes = compressed_output.size();
+            output_buffer = current_reply.headers_to_buffers();
+            output_buffer.push_back(boost::asio::buffer(compressed_output));
+        }
+        else
+        {
+            // the size is unknown until compression finished, stream the reply instead
+            current_reply.headers.erase(
+                std::remove_if(
+                    current_reply.headers.begin(),
+                    current_reply.headers.end(),
+                    [](const http::header &h) { return h.name == "Content-Length"; }),
+                current_reply.headers.end());
+            current_reply.headers.emplace_back("Transfer-Encoding", "chunked");
+            sent_body_bytes = 0;
+            output_buffer = current_reply.headers_to_buffers();
+
+            boost::asio::async_write(
+                stream_socket,
+                output_buffer,
+                strand.wrap(boost::bind(&Connection::handle_chunk_write,
+                                        this->shared_from_this(),
+                                        boost::asio::placeholders::error)));
+            return;
+        }
+    }
+    else
+    {
+        // don't use any compression
+        current_reply.set_uncompressed_size();
+        sent_body_bytes = current_reply.content.size();
+        output_buffer = current_reply.to_buffers();
+    }
+    // write result to stream
+    boost::asio::async_write(stream_socket,
+                             output_buffer,
+                             strand.wrap(boost::bind(&Connection::handle_write,
+                                                     this->shared_from_this(),
+                                                     boost::asio::placeholders::error)));
+}
+
 /// Handle completion of a write operation.
 void Connection::handle_write(const boost::system::error_code &error)
 {
-    if (!error)
+    if (error)
     {
-        // Initiate graceful connection closure.
-        boost::system::error_code ignore_error;
-        TCP_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignore_error);
+        return;
+    }
+
+    request_handler.ReplySent(current_reply, sent_body_bytes);
+
+    if (!keep_alive)
+    {
+        handle_shutdown();
+        return;
+    }
+
+    // reset the per-request state and serve the next request on this connection
+    current_request = http::request();
+    current_reply.clear();
+    request_parser = RequestParser();
+    compressed_output.clear();
+    stream_piece.clear();
+    output_buffer.clear();
+
+    if (pipelined_begin != pipelined_end)
+    {
+        // the client already sent the next request alongside the previous one
+        char *begin = pipelined_begin;
+        char *end = pipelined_end;
+        pipelined_begin = pipelined_end = nullptr;
+        handle_request(begin, end);
+    }
+    else
+    {
+        start();
+    }
+}
+
+void Connection::handle_continue_write(const boost::system::error_code &error)
+{
+    if (error)
+    {
+        return;
+    }
+
+    stream_socket.async_read_some(
+        boost::asio::buffer(incoming_data_buffer),
+        strand.wrap(boost::bind(&Connection::handle_read,
+                                this->shared_from_this(),
+                                boost::asio::placeholders::error,
+                                boost::asio::placeholders::bytes_transferred)));
+}
+
+void Connection::handle_chunk_write(const boost::system::error_code &error)
+{
+    if (error)
+    {
+        return;
+    }
+
+    static const std::string last_chunk = "0\r\n\r\n";
+    static const std::string crlf = "\r\n";
+
+    const bool finished = compressor.compress_chunk(compressed_output, MAX_CHUNK_SIZE);
+
+    output_buffer.clear();
+    sent_body_bytes += compressed_output.size();
+    if (!compressed_output.empty())
+    {
+        std::stringstream size;
+        size << std::hex << compressed_output.size() << "\r\n";
+        chunk_header = size.str();
+        output_buffer.push_back(boost::asio::buffer(chunk_header));
+        output_buffer.push_back(boost::asio::buffer(compressed_output));
+        output_buffer.push_back(boost::asio::buffer(crlf));
+    }
+
+    if (finished)
+    {
+        output_buffer.push_back(boost::asio::buffer(last_chunk));
+        boost::asio::async_write(stream_socket,
+                                 output_buffer,
+                                 strand.wrap(boost::bind(&Connection::handle_write,
+                                                         this->shared_from_this(),
+                                                         boost::asio::placeholders::error)));
+    }
+    else
+    {
+        boost::asio::async_write(stream_socket,
+                                 output_buffer,
+                                 strand.wrap(boost::bind(&Connection::handle_chunk_write,
+                                                         this->shared_from_this(),
+                                                         boost::asio::placeholders::error)));
     }
 }
 
-std::vector<char> Connection::compress_buffers(const std::vector<char> &uncompressed_data,
-                                               const http::compression_type compression_type)
+void Connection::handle_stream_write(const boost::system::error_code &error)
 {
-    boost::iostreams::gzip_params compression_parameters;
+    if (error)
+    {
+        current_reply.stream->cancel();
+        return;
+    }
+
+    static const std::string last_chunk = "0\r\n\r\n";
+    static const std::string crlf = "\r\n";
+
+    auto self = this->shared_from_this();
+    const auto result = current_reply.stream->read(stream_piece, [self]() {
+        self->strand.dispatch(
+            boost::bind(&Connection::handle_stream_write, self, boost::system::error_code()));
+    });
+
+    output_buffer.clear();
+    switch (result)
+    {
+    case http::body_stream::read_result::pending:
+        // continued by the producer
+        return;
+    case http::body_stream::read_result::failed:
+        // cut the reply off, the client must not take it for a complete one
+        keep_alive = false;
+        handle_shutdown();
+        return;
+    case http::body_stream::read_result::finished:
+        output_buffer.push_back(boost::asio::buffer(last_chunk));
+        boost::asio::async_write(stream_socket,
+                                 output_buffer,
+                                 strand.wrap(boost::bind(&Connection::handle_write,
+                                                         this->shared_from_this(),
+                                                         boost::asio::placeholders::error)));
+        return;
+    case http::body_stream::read_result::piece:
+        break;
+    }
 
-    // there's a trade-off between speed and size. speed wins
-    compression_parameters.level = boost::iostreams::zlib::best_speed;
-    // check which compression flavor is used
-    if (http::deflate_rfc1951 == compression_type)
+    // an empty chunk would end the reply
+    if (stream_piece.empty())
     {
-        compression_parameters.noheader = true;
+        handle_stream_write(error);
+        return;
     }
 
-    std::vector<char> compressed_data;
-    // plug data into boost's compression stream
-    boost::iostreams::filtering_ostream gzip_stream;
-    gzip_stream.push(boost::iostreams::gzip_compressor(compression_parameters));
-    gzip_stream.push(boost::iostreams::back_inserter(compressed_data));
-    gzip_stream.write(&uncompressed_data[0], uncompressed_data.size());
-    boost::iostreams::close(gzip_stream);
+    sent_body_bytes += stream_piece.size();
+    std::stringstream size;
+    size << std::hex << stream_piece.size() << "\r\n";
+    chunk_header = size.str();
+    output_buffer.push_back(boost::asio::buffer(chunk_header));
+    output_buffer.push_back(boost::asio::buffer(stream_piece));
+    output_buffer.push_back(boost::asio::buffer(crlf));
+    boost::asio::async_write(stream_socket,
+                             output_buffer,
+                             strand.wrap(boost::bind(&Connection::handle_stream_write,
+                                                     this->shared_from_this(),
+                                                     boost::asio::placeholders::error)));
+}
+
+void Connection::handle_timeout(const boost::system::error_code &error)
+{
+    // the timer is canceled on every new request, only an expired timer closes the connection
+    if (error != boost::asio::error::operation_aborted &&
+        timer.expires_at() <= boost::asio::deadline_timer::traits_type::now())
+    {
+        keep_alive = false;
+        boost::system::error_code ignore_error;
+        stream_socket.cancel(ignore_error);
+        handle_shutdown();
+    }
+}
 
-    return compressed_data;
+void Connection::handle_shutdown()
+{
+    // Initiate graceful connection closure.
+    boost::system::error_code ignore_error;
+    stream_socket.shutdown(boost::asio::socket_base::shutdown_both, ignore_error);
 }
 }
 }
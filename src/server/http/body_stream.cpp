@@ -0,0 +1,79 @@
+#include "server/http/body_stream.hpp"
+
+#include <utility>
+
+namespace osrm
+{
+namespace server
+{
+namespace http
+{
+
+body_stream::body_stream(const std::size_t max_pieces)
+    : max_pieces(max_pieces), finished(false), succeeded(false), cancelled(false)
+{
+}
+
+bool body_stream::write(std::vector<char> &piece)
+{
+    std::function<void()> notify;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        space_available.wait(lock, [this] {
+            return cancelled || max_pieces == 0 || pieces.size() < max_pieces;
+        });
+        if (cancelled)
+            return false;
+
+        pieces.push_back(std::move(piece));
+        piece = std::vector<char>();
+        std::swap(notify, ready);
+    }
+    if (notify)
+        notify();
+    return true;
+}
+
+void body_stream::finish(const bool succeeded_)
+{
+    std::function<void()> notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+        succeeded = succeeded_;
+        std::swap(notify, ready);
+    }
+    if (notify)
+        notify();
+}
+
+body_stream::read_result body_stream::read(std::vector<char> &piece, std::function<void()> ready_)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pieces.empty())
+    {
+        piece = std::move(pieces.front());
+        pieces.pop_front();
+        space_available.notify_one();
+        return read_result::piece;
+    }
+    if (finished)
+        return succeeded ? read_result::finished : read_result::failed;
+
+    ready = std::move(ready_);
+    return read_result::pending;
+}
+
+void body_stream::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+        pieces.clear();
+        ready = nullptr;
+    }
+    space_available.notify_all();
+}
+}
+}
+}
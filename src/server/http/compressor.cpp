@@ -0,0 +1,353 @@
+#include "server/http/compressor.hpp"
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/assert.hpp>
+
+#ifdef USE_BROTLI_LIBRARY
+#include <brotli/encode.h>
+#endif
+#ifdef USE_ZSTD_LIBRARY
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+namespace osrm
+{
+namespace server
+{
+namespace http
+{
+
+namespace
+{
+// zlib's window bits select the container: negative values produce raw deflate (RFC 1951),
+// adding 16 wraps the stream into a gzip header and trailer (RFC 1952).
+const constexpr int DEFLATE_WINDOW_BITS = -MAX_WBITS;
+const constexpr int GZIP_WINDOW_BITS = MAX_WBITS + 16;
+const constexpr int MEMORY_LEVEL = 8;
+
+// higher rank wins if clients accept several codecs with the same q-value
+int preference(const compression_type type)
+{
+    switch (type)
+    {
+    case brotli_rfc7932:
+        return 4;
+    case zstd_rfc8478:
+        return 3;
+    case gzip_rfc1952:
+        return 2;
+    case deflate_rfc1951:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+compression_type parse_coding(const std::string &coding)
+{
+    if (boost::iequals(coding, "br"))
+        return brotli_rfc7932;
+    if (boost::iequals(coding, "zstd"))
+        return zstd_rfc8478;
+    if (boost::iequals(coding, "gzip") || boost::iequals(coding, "x-gzip"))
+        return gzip_rfc1952;
+    if (boost::iequals(coding, "deflate"))
+        return deflate_rfc1951;
+    return no_compression;
+}
+}
+
+bool is_supported(const compression_type type)
+{
+    switch (type)
+    {
+    case gzip_rfc1952:
+    case deflate_rfc1951:
+        return true;
+    case brotli_rfc7932:
+#ifdef USE_BROTLI_LIBRARY
+        return true;
+#else
+        return false;
+#endif
+    case zstd_rfc8478:
+#ifdef USE_ZSTD_LIBRARY
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+const char *content_encoding(const compression_type type)
+{
+    switch (type)
+    {
+    case gzip_rfc1952:
+        return "gzip";
+    case deflate_rfc1951:
+        return "deflate";
+    case brotli_rfc7932:
+        return "br";
+    case zstd_rfc8478:
+        return "zstd";
+    default:
+        return "identity";
+    }
+}
+
+compression_type negotiate_compression(const std::string &accept_encoding)
+{
+    std::vector<std::string> codings;
+    boost::split(codings, accept_encoding, boost::is_any_of(","));
+
+    compression_type best_type = no_compression;
+    double best_quality = 0.;
+    for (auto &coding : codings)
+    {
+        double quality = 1.;
+        const auto parameters_begin = coding.find(';');
+        if (parameters_begin != std::string::npos)
+        {
+            const auto q_begin = coding.find("q=", parameters_begin);
+            if (q_begin != std::string::npos)
+            {
+                quality = std::strtod(coding.c_str() + q_begin + 2, nullptr);
+            }
+            coding.resize(parameters_begin);
+        }
+        boost::trim(coding);
+
+        const auto type = parse_coding(coding);
+        if (quality <= 0. || !is_supported(type))
+        {
+            continue;
+        }
+
+        if (quality > best_quality ||
+            (quality == best_quality && preference(type) > preference(best_type)))
+        {
+            best_type = type;
+            best_quality = quality;
+        }
+    }
+    return best_type;
+}
+
+compressor::compressor(const compression_levels levels)
+    : levels(levels), type(no_compression), input_begin(nullptr), input_end(nullptr),
+      zlib_window_bits(0), zlib_initialized(false)
+#ifdef USE_BROTLI_LIBRARY
+      ,
+      brotli_state(nullptr)
+#endif
+#ifdef USE_ZSTD_LIBRARY
+      ,
+      zstd_context(nullptr)
+#endif
+{
+    zlib_stream.zalloc = Z_NULL;
+    zlib_stream.zfree = Z_NULL;
+    zlib_stream.opaque = Z_NULL;
+}
+
+compressor::~compressor()
+{
+    if (zlib_initialized)
+    {
+        deflateEnd(&zlib_stream);
+    }
+#ifdef USE_BROTLI_LIBRARY
+    if (brotli_state)
+    {
+        BrotliEncoderDestroyInstance(brotli_state);
+    }
+#endif
+#ifdef USE_ZSTD_LIBRARY
+    if (zstd_context)
+    {
+        ZSTD_freeCCtx(zstd_context);
+    }
+#endif
+}
+
+bool compressor::reset(const compression_type type_, const std::vector<char> &input)
+{
+    BOOST_ASSERT(type_ != no_compression);
+    type = type_;
+    input_begin = input.data();
+    input_end = input.data() + input.size();
+
+    switch (type)
+    {
+    case gzip_rfc1952:
+    case deflate_rfc1951:
+    {
+        const int requested_window_bits =
+            type == deflate_rfc1951 ? DEFLATE_WINDOW_BITS : GZIP_WINDOW_BITS;
+        if (zlib_initialized && requested_window_bits == zlib_window_bits)
+        {
+            zlib_initialized = deflateReset(&zlib_stream) == Z_OK;
+        }
+        else
+        {
+            if (zlib_initialized)
+            {
+                deflateEnd(&zlib_stream);
+            }
+            zlib_initialized = deflateInit2(&zlib_stream,
+                                            levels.zlib,
+                                            Z_DEFLATED,
+                                            requested_window_bits,
+                                            MEMORY_LEVEL,
+                                            Z_DEFAULT_STRATEGY) == Z_OK;
+            zlib_window_bits = requested_window_bits;
+        }
+        return zlib_initialized;
+    }
+#ifdef USE_BROTLI_LIBRARY
+    case brotli_rfc7932:
+        // brotli has no way to reset a finished encoder, so it is re-created for every reply
+        if (brotli_state)
+        {
+            BrotliEncoderDestroyInstance(brotli_state);
+        }
+        brotli_state = BrotliEncoderCreateInstance(nullptr, nullptr, nullptr);
+        if (!brotli_state)
+        {
+            return false;
+        }
+        BrotliEncoderSetParameter(brotli_state, BROTLI_PARAM_QUALITY, levels.brotli);
+        BrotliEncoderSetParameter(brotli_state,
+                                  BROTLI_PARAM_SIZE_HINT,
+                                  static_cast<std::uint32_t>(std::min<std::size_t>(
+                                      input.size(), std::numeric_limits<std::uint32_t>::max())));
+        return true;
+#endif
+#ifdef USE_ZSTD_LIBRARY
+    case zstd_rfc8478:
+        if (!zstd_context)
+        {
+            zstd_context = ZSTD_createCCtx();
+            if (!zstd_context)
+            {
+                return false;
+            }
+        }
+        ZSTD_CCtx_reset(zstd_context, ZSTD_reset_session_only);
+        ZSTD_CCtx_setParameter(zstd_context, ZSTD_c_compressionLevel, levels.zstd);
+        ZSTD_CCtx_setPledgedSrcSize(zstd_context, input.size());
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+bool compressor::compress(char *output, const std::size_t capacity, std::size_t &written)
+{
+    // all input is available up-front, so every call can finish as much as fits into output
+    switch (type)
+    {
+    case gzip_rfc1952:
+    case deflate_rfc1951:
+    {
+        BOOST_ASSERT(zlib_initialized);
+        const std::size_t remaining = input_end - input_begin;
+        const std::size_t max_avail = std::numeric_limits<uInt>::max();
+        zlib_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input_begin));
+        zlib_stream.avail_in = static_cast<uInt>(std::min(remaining, max_avail));
+        zlib_stream.next_out = reinterpret_cast<Bytef *>(output);
+        zlib_stream.avail_out = static_cast<uInt>(std::min(capacity, max_avail));
+        const auto avail_out = zlib_stream.avail_out;
+
+        const auto result = deflate(&zlib_stream, remaining <= max_avail ? Z_FINISH : Z_NO_FLUSH);
+        // zlib only reports a stream error for an inconsistent stream state
+        BOOST_ASSERT(result != Z_STREAM_ERROR);
+
+        input_begin = reinterpret_cast<const char *>(zlib_stream.next_in);
+        written = avail_out - zlib_stream.avail_out;
+        return result == Z_STREAM_END;
+    }
+#ifdef USE_BROTLI_LIBRARY
+    case brotli_rfc7932:
+    {
+        BOOST_ASSERT(brotli_state);
+        std::size_t available_in = input_end - input_begin;
+        auto next_in = reinterpret_cast<const std::uint8_t *>(input_begin);
+        std::size_t available_out = capacity;
+        auto next_out = reinterpret_cast<std::uint8_t *>(output);
+
+        const auto result = BrotliEncoderCompressStream(brotli_state,
+                                                        BROTLI_OPERATION_FINISH,
+                                                        &available_in,
+                                                        &next_in,
+                                                        &available_out,
+                                                        &next_out,
+                                                        nullptr);
+        BOOST_ASSERT(result == BROTLI_TRUE);
+        (void)result;
+
+        input_begin = reinterpret_cast<const char *>(next_in);
+        written = capacity - available_out;
+        return BrotliEncoderIsFinished(brotli_state) == BROTLI_TRUE;
+    }
+#endif
+#ifdef USE_ZSTD_LIBRARY
+    case zstd_rfc8478:
+    {
+        BOOST_ASSERT(zstd_context);
+        ZSTD_inBuffer in_buffer = {input_begin, static_cast<std::size_t>(input_end - input_begin), 0};
+        ZSTD_outBuffer out_buffer = {output, capacity, 0};
+
+        const auto remaining = ZSTD_compressStream2(zstd_context, &out_buffer, &in_buffer, ZSTD_e_end);
+        BOOST_ASSERT(!ZSTD_isError(remaining));
+
+        input_begin += in_buffer.pos;
+        written = out_buffer.pos;
+        return remaining == 0;
+    }
+#endif
+    default:
+        BOOST_ASSERT_MSG(false, "compressor was not reset");
+        written = 0;
+        return true;
+    }
+}
+
+bool compressor::compress_chunk(std::vector<char> &output, const std::size_t max_chunk_size)
+{
+    output.resize(max_chunk_size);
+    std::size_t written;
+    const bool finished = compress(output.data(), max_chunk_size, written);
+    output.resize(written);
+    return finished;
+}
+
+void compressor::compress_all(std::vector<char> &output)
+{
+    // start with a guess of the compressed size and grow if it turns out to be too small
+    std::size_t capacity = std::max<std::size_t>(4096, (input_end - input_begin) / 2);
+    bool finished = false;
+    while (!finished)
+    {
+        const auto offset = output.size();
+        output.resize(offset + capacity);
+        std::size_t written;
+        finished = compress(output.data() + offset, capacity, written);
+        output.resize(offset + written);
+    }
+}
+}
+}
+}
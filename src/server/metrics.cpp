@@ -0,0 +1,286 @@
+#include "server/metrics.hpp"
+#include "engine/search_trace.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace osrm
+{
+namespace server
+{
+
+const constexpr std::array<std::uint32_t, 13> Metrics::LATENCY_BUCKETS_MS;
+
+namespace
+{
+std::size_t shardIndex(const std::size_t num_shards)
+{
+    // spread threads round-robin over the shards by the order they first record a metric
+    static std::atomic<std::size_t> next_shard{0};
+    thread_local const std::size_t shard = next_shard++;
+    return shard % num_shards;
+}
+}
+
+Metrics::Metrics(std::vector<std::string> service_names_)
+    : service_names(std::move(service_names_))
+{
+    service_names.push_back("other");
+    shards = std::make_unique<Shard[]>(service_names.size() * NUM_SHARDS);
+    for (std::size_t index = 0; index < service_names.size() * NUM_SHARDS; ++index)
+    {
+        for (auto &counter : shards[index].counters)
+        {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+Metrics::~Metrics() = default;
+
+std::size_t Metrics::ServiceIndex(const std::string &service) const
+{
+    const auto iter = std::find(service_names.begin(), service_names.end() - 1, service);
+    return std::distance(service_names.begin(), iter);
+}
+
+std::atomic<std::int64_t> &Metrics::Get(const std::size_t service, const Counter counter)
+{
+    BOOST_ASSERT(service < service_names.size());
+    return shards[service * NUM_SHARDS + shardIndex(NUM_SHARDS)].counters[counter];
+}
+
+std::int64_t Metrics::Sum(const std::size_t service, const std::size_t counter) const
+{
+    std::int64_t sum = 0;
+    for (std::size_t shard = 0; shard < NUM_SHARDS; ++shard)
+    {
+        sum += shards[service * NUM_SHARDS + shard].counters[counter].load(
+            std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void Metrics::RequestStarted(const std::size_t service)
+{
+    Get(service, IN_FLIGHT).fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::RequestFinished(const std::size_t service,
+                              const RequestStatus status,
+                              const std::chrono::steady_clock::duration duration)
+{
+    // the gauge is the sum over all shards, so it may be decremented on another shard
+    Get(service, IN_FLIGHT).fetch_sub(1, std::memory_order_relaxed);
+    Get(service, static_cast<Counter>(REQUESTS_OK + static_cast<std::size_t>(status)))
+        .fetch_add(1, std::memory_order_relaxed);
+
+    const auto duration_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    Get(service, LATENCY_SUM_US).fetch_add(duration_us, std::memory_order_relaxed);
+
+    const auto bucket = std::distance(LATENCY_BUCKETS_MS.begin(),
+                                      std::lower_bound(LATENCY_BUCKETS_MS.begin(),
+                                                       LATENCY_BUCKETS_MS.end(),
+                                                       (duration_us + 999) / 1000));
+    Get(service, static_cast<Counter>(LATENCY_BUCKET_BEGIN + bucket))
+        .fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::ReplySent(const std::size_t service,
+                        const std::size_t content_bytes,
+                        const std::size_t sent_bytes)
+{
+    Get(service, CONTENT_BYTES).fetch_add(content_bytes, std::memory_order_relaxed);
+    Get(service, SENT_BYTES).fetch_add(sent_bytes, std::memory_order_relaxed);
+}
+
+std::string Metrics::RenderPrometheus() const
+{
+    std::stringstream out;
+    const auto label = [this](const std::size_t service) {
+        return "service=\"" + service_names[service] + "\"";
+    };
+    const auto num_services = service_names.size();
+
+    out << "# HELP osrm_requests_total Number of handled requests.\n"
+        << "# TYPE osrm_requests_total counter\n";
+    const char *status_names[] = {"ok", "error", "rejected"};
+    for (std::size_t service = 0; service < num_services; ++service)
+    {
+        for (std::size_t status = 0; status < NUM_REQUEST_STATUS; ++status)
+        {
+            out << "osrm_requests_total{" << label(service) << ",status=\""
+                << status_names[status] << "\"} " << Sum(service, REQUESTS_OK + status) << "\n";
+        }
+    }
+
+    out << "# HELP osrm_requests_in_flight Number of requests currently being processed.\n"
+        << "# TYPE osrm_requests_in_flight gauge\n";
+    for (std::size_t service = 0; service < num_services; ++service)
+    {
+        out << "osrm_requests_in_flight{" << label(service) << "} " << Sum(service, IN_FLIGHT)
+            << "\n";
+    }
+
+    out << "# HELP osrm_request_duration_seconds Time spent processing requests.\n"
+        << "# TYPE osrm_request_duration_seconds histogram\n";
+    for (std::size_t service = 0; service < num_services; ++service)
+    {
+        std::int64_t cumulative = 0;
+        for (std::size_t bucket = 0; bucket <= LATENCY_BUCKETS_MS.size(); ++bucket)
+        {
+            cumulative += Sum(service, LATENCY_BUCKET_BEGIN + bucket);
+            out << "osrm_request_duration_seconds_bucket{" << label(service) << ",le=\"";
+            if (bucket < LATENCY_BUCKETS_MS.size())
+                out << LATENCY_BUCKETS_MS[bucket] / 1000.;
+            else
+                out << "+Inf";
+            out << "\"} " << cumulative << "\n";
+        }
+        out << "osrm_request_duration_seconds_sum{" << label(service) << "} " << std::fixed
+            << std::setprecision(6) << Sum(service, LATENCY_SUM_US) / 1e6 << "\n"
+            << std::defaultfloat;
+        out << "osrm_request_duration_seconds_count{" << label(service) << "} " << cumulative
+            << "\n";
+    }
+
+    out << "# HELP osrm_response_bytes_total Uncompressed size of sent response bodies.\n"
+        << "# TYPE osrm_response_bytes_total counter\n";
+    for (std::size_t service = 0; service < num_services; ++service)
+    {
+        out << "osrm_response_bytes_total{" << label(service) << "} "
+            << Sum(service, CONTENT_BYTES) << "\n";
+    }
+
+    out << "# HELP osrm_sent_bytes_total Size of response bodies as sent on the wire.\n"
+        << "# TYPE osrm_sent_bytes_total counter\n";
+    for (std::size_t service = 0; service < num_services; ++service)
+    {
+        out << "osrm_sent_bytes_total{" << label(service) << "} " << Sum(service, SENT_BYTES)
+            << "\n";
+    }
+
+    out << "# HELP osrm_compression_ratio Ratio of sent to uncompressed response bytes.\n"
+        << "# TYPE osrm_compression_ratio gauge\n";
+    for (std::size_t service = 0; service < num_services; ++service)
+    {
+        const auto content_bytes = Sum(service, CONTENT_BYTES);
+        const auto ratio =
+            content_bytes > 0 ? static_cast<double>(Sum(service, SENT_BYTES)) / content_bytes : 1.;
+        out << "osrm_compression_ratio{" << label(service) << "} " << ratio << "\n";
+    }
+
+    return out.str();
+}
+
+std::string Metrics::RenderPrometheus(const engine::EngineStatistics &statistics)
+{
+    std::stringstream out;
+    const std::pair<const char *, const util::CacheStatistics &> caches[] = {
+        {"route", statistics.route_cache},
+        {"snapping", statistics.snapping_cache},
+        {"unpacking", statistics.unpacking_cache},
+        {"tile", statistics.tile_cache}};
+
+    const auto render = [&](const char *name,
+                            const char *type,
+                            const char *help,
+                            std::uint64_t util::CacheStatistics::*counter) {
+        out << "# HELP osrm_cache_" << name << " " << help << "\n"
+            << "# TYPE osrm_cache_" << name << " " << type << "\n";
+        for (const auto &cache : caches)
+        {
+            out << "osrm_cache_" << name << "{cache=\"" << cache.first << "\"} "
+                << cache.second.*counter << "\n";
+        }
+    };
+    render("hits_total",
+           "counter",
+           "Lookups that found a cached entry.",
+           &util::CacheStatistics::hits);
+    render("misses_total",
+           "counter",
+           "Lookups that found no cached entry.",
+           &util::CacheStatistics::misses);
+    render("evictions_total",
+           "counter",
+           "Entries dropped to make room for new ones.",
+           &util::CacheStatistics::evictions);
+    render("entries", "gauge", "Entries currently cached.", &util::CacheStatistics::entries);
+    render("capacity",
+           "gauge",
+           "Maximum number of cached entries, 0 if disabled.",
+           &util::CacheStatistics::capacity);
+
+    out << "# HELP osrm_coalesced_requests_total Requests that got the result of an identical "
+           "request in flight.\n"
+        << "# TYPE osrm_coalesced_requests_total counter\n"
+        << "osrm_coalesced_requests_total " << statistics.coalesced_requests << "\n";
+
+    const auto &updates = statistics.data_updates;
+    out << "# HELP osrm_data_update_seconds Time from the notification of a new dataset in shared "
+           "memory until queries use it.\n"
+        << "# TYPE osrm_data_update_seconds summary\n"
+        << "osrm_data_update_seconds_sum " << std::fixed << std::setprecision(6)
+        << updates.total_us / 1e6 << "\n"
+        << std::defaultfloat << "osrm_data_update_seconds_count " << updates.updates << "\n"
+        << "# HELP osrm_data_update_last_seconds Time the last dataset update took.\n"
+        << "# TYPE osrm_data_update_last_seconds gauge\n"
+        << "osrm_data_update_last_seconds " << std::fixed << std::setprecision(6)
+        << updates.last_us / 1e6 << "\n"
+        << std::defaultfloat
+        << "# HELP osrm_data_generations Datasets in shared memory, the current one and the ones "
+           "processes still use.\n"
+        << "# TYPE osrm_data_generations gauge\n"
+        << "osrm_data_generations " << updates.generations << "\n"
+        << "# HELP osrm_data_generation_bytes Shared memory of the datasets.\n"
+        << "# TYPE osrm_data_generation_bytes gauge\n"
+        << "osrm_data_generation_bytes " << updates.generation_bytes << "\n";
+
+    if (engine::SearchTracing::enabled)
+    {
+        const auto &searches = statistics.searches;
+        const auto &totals = searches.totals;
+        const auto counter = [&out](const char *name, const char *help, const std::uint64_t value) {
+            out << "# HELP osrm_search_" << name << " " << help << "\n"
+                << "# TYPE osrm_search_" << name << " counter\n"
+                << "osrm_search_" << name << " " << value << "\n";
+        };
+        counter("requests_total", "Requests whose searches were traced.", searches.requests);
+        counter("settled_nodes_total", "Nodes settled by the searches.", totals.settled_nodes);
+        counter("relaxed_edges_total", "Edges relaxed by the searches.", totals.relaxed_edges);
+        counter("stalled_nodes_total",
+                "Nodes the CH searches pruned by stall-on-demand.",
+                totals.stalled_nodes);
+
+        out << "# HELP osrm_search_max_heap_size The most nodes a heap of a search held.\n"
+            << "# TYPE osrm_search_max_heap_size gauge\n"
+            << "osrm_search_max_heap_size " << totals.max_heap_size << "\n";
+
+        out << "# HELP osrm_search_cells_crossed_total MLD cells whose shortcuts the searches "
+               "relaxed.\n"
+            << "# TYPE osrm_search_cells_crossed_total counter\n";
+        for (std::size_t level = 1; level < totals.cells_crossed.size(); ++level)
+        {
+            if (totals.cells_crossed[level] != 0)
+            {
+                out << "osrm_search_cells_crossed_total{level=\"" << level << "\"} "
+                    << totals.cells_crossed[level] << "\n";
+            }
+        }
+
+        out << "# HELP osrm_search_unpacking_seconds_total Time spent unpacking paths.\n"
+            << "# TYPE osrm_search_unpacking_seconds_total counter\n"
+            << "osrm_search_unpacking_seconds_total " << std::fixed << std::setprecision(6)
+            << std::chrono::duration<double>(totals.unpacking_time).count() << "\n"
+            << std::defaultfloat;
+    }
+
+    return out.str();
+}
+}
+}
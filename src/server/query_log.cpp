@@ -0,0 +1,120 @@
+#include "server/query_log.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cmath>
+#include <cstring>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+const constexpr char QUERY_LOG_MAGIC[8] = {'O', 'S', 'R', 'M', 'Q', 'L', 'O', 'G'};
+const constexpr std::uint32_t QUERY_LOG_VERSION = 1;
+// records between flushes, so a crashed server leaves most of its log behind
+const constexpr std::uint64_t FLUSH_INTERVAL = 1024;
+
+template <typename T> void writeValue(std::ostream &out, const T value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T> bool readValue(std::istream &in, T &value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+}
+
+QueryLogWriter::QueryLogWriter(const boost::filesystem::path &path, const double sample_rate)
+    : sample_rate(sample_rate), out(path, std::ios::binary | std::ios::trunc)
+{
+    if (!out)
+    {
+        throw util::exception("Could not open " + path.string() + " for writing" + SOURCE_REF);
+    }
+    out.write(QUERY_LOG_MAGIC, sizeof(QUERY_LOG_MAGIC));
+    writeValue(out, QUERY_LOG_VERSION);
+}
+
+QueryLogWriter::~QueryLogWriter()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    out.flush();
+}
+
+bool QueryLogWriter::Sample()
+{
+    if (sample_rate >= 1.)
+        return true;
+    // every request that moves the sampled count to the next integer is recorded
+    const auto count = seen++;
+    return std::floor((count + 1) * sample_rate) > std::floor(count * sample_rate);
+}
+
+void QueryLogWriter::Write(const QueryRecord &record)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    writeValue(out, record.timestamp_us);
+    writeValue(out, record.latency_us);
+    writeValue(out, record.status);
+    writeValue(out, record.timeout_ms);
+    writeValue(out, static_cast<std::uint32_t>(record.url.size()));
+    writeValue(out, static_cast<std::uint32_t>(record.body.size()));
+    out.write(record.url.data(), record.url.size());
+    out.write(record.body.data(), record.body.size());
+    if (++written % FLUSH_INTERVAL == 0)
+    {
+        out.flush();
+    }
+}
+
+QueryLogReader::QueryLogReader(const boost::filesystem::path &path_)
+    : path(path_), in(path, std::ios::binary)
+{
+    if (!in)
+    {
+        throw util::exception("Could not open " + path.string() + " for reading" + SOURCE_REF);
+    }
+    char magic[sizeof(QUERY_LOG_MAGIC)];
+    std::uint32_t version = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, QUERY_LOG_MAGIC, sizeof(magic)) != 0 || !readValue(in, version))
+    {
+        throw util::exception(path.string() + " is not a query log" + SOURCE_REF);
+    }
+    if (version != QUERY_LOG_VERSION)
+    {
+        throw util::exception(path.string() + " has query log version " +
+                              std::to_string(version) + ", expected " +
+                              std::to_string(QUERY_LOG_VERSION) + SOURCE_REF);
+    }
+}
+
+bool QueryLogReader::Next(QueryRecord &record)
+{
+    if (!readValue(in, record.timestamp_us))
+    {
+        return false;
+    }
+
+    std::uint32_t url_size = 0, body_size = 0;
+    if (readValue(in, record.latency_us) && readValue(in, record.status) &&
+        readValue(in, record.timeout_ms) && readValue(in, url_size) && readValue(in, body_size))
+    {
+        record.url.resize(url_size);
+        record.body.resize(body_size);
+        if (in.read(&record.url[0], url_size) && in.read(&record.body[0], body_size))
+        {
+            return true;
+        }
+    }
+    throw util::exception(path.string() + " ends in a truncated record" + SOURCE_REF);
+}
+}
+}
@@ -0,0 +1,93 @@
+#include "server/query_replay.hpp"
+#include "server/api/binary_parameters_parser.hpp"
+#include "server/api/parsed_url.hpp"
+#include "server/api/url_parser.hpp"
+
+#include "util/log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+std::uint16_t runRecordedQuery(ServiceHandlerInterface &handler, const QueryRecord &record)
+{
+    auto url = record.url;
+    auto iterator = url.begin();
+    auto parsed_url = api::parseURL(iterator, url.end());
+    if (!parsed_url || iterator != url.end())
+        return 400;
+
+    // the log has no content type, bodies that are no coordinates are tried as traces
+    ServiceHandler::BodyT body;
+    boost::optional<ServiceHandler::TracesT> traces;
+    if (!record.body.empty())
+    {
+        body = api::parseBinaryParameters(record.body);
+        if (!body)
+            traces = api::parseBinaryTraces(record.body);
+        if (!body && !traces)
+            return 400;
+    }
+
+    ServiceHandler::TimeoutT timeout;
+    if (record.timeout_ms > 0)
+        timeout = std::chrono::milliseconds(record.timeout_ms);
+
+    ServiceHandler::ResultT result;
+    const auto status =
+        traces ? handler.RunBatchQuery(*std::move(parsed_url), *traces, timeout, result)
+               : handler.RunQuery(*std::move(parsed_url), body, timeout, result);
+    return status == engine::Status::Ok ? 200 : 400;
+}
+
+WarmUpResult warmUp(ServiceHandlerInterface &handler,
+                    const boost::filesystem::path &query_log,
+                    const unsigned threads)
+{
+    std::vector<QueryRecord> records;
+    QueryLogReader reader(query_log);
+    for (QueryRecord record; reader.Next(record);)
+        records.push_back(std::move(record));
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next_record{0};
+    std::atomic<std::size_t> errors{0};
+    std::vector<std::thread> workers;
+    for (unsigned thread = 0; thread < std::max(1u, threads); ++thread)
+    {
+        workers.emplace_back([&] {
+            for (auto index = next_record++; index < records.size(); index = next_record++)
+            {
+                try
+                {
+                    if (runRecordedQuery(handler, records[index]) != 200)
+                        ++errors;
+                }
+                catch (const std::exception &e)
+                {
+                    util::Log(logWARNING) << e.what() << ", url: " << records[index].url;
+                    ++errors;
+                }
+            }
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    WarmUpResult result;
+    result.requests = records.size();
+    result.errors = errors;
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+}
+}
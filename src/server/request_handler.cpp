@@ -1,7 +1,11 @@
 #include "server/request_handler.hpp"
+#include "server/access_log.hpp"
 #include "server/service_handler.hpp"
 
+#include "server/api/binary_parameters_parser.hpp"
+#include "server/api/parsed_url.hpp"
 #include "server/api/url_parser.hpp"
+#include "server/http/body_stream.hpp"
 #include "server/http/reply.hpp"
 #include "server/http/request.hpp"
 
@@ -15,15 +19,18 @@
 #include "osrm/osrm.hpp"
 #include "util/json_container.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
 
+#include <chrono>
 #include <ctime>
 
 #include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <thread>
 
@@ -32,22 +39,283 @@ namespace osrm
 namespace server
 {
 
+RequestHandler::RequestHandler()
+{
+    if (!std::getenv("DISABLE_ACCESS_LOGGING"))
+    {
+        access_log = std::make_unique<AccessLog>();
+    }
+}
+
 void RequestHandler::RegisterServiceHandler(
     std::unique_ptr<ServiceHandlerInterface> service_handler_)
 {
     service_handler = std::move(service_handler_);
 }
 
-void RequestHandler::HandleRequest(const http::request &current_request, http::reply &current_reply)
+void RequestHandler::SetAdmissionLimits(const std::string &service,
+                                        const AdmissionControl::Limits &limits)
+{
+    admission_control.SetLimits(service, limits);
+}
+
+void RequestHandler::EnableMetrics()
+{
+    BOOST_ASSERT(service_handler);
+    metrics = std::make_unique<Metrics>(service_handler->GetServiceNames());
+}
+
+void RequestHandler::EnableQueryLog(const boost::filesystem::path &path, const double sample_rate)
+{
+    query_log = std::make_unique<QueryLogWriter>(path, sample_rate);
+}
+
+void RequestHandler::EnableTableStreaming(const std::size_t rows_per_chunk)
+{
+    table_stream_rows = rows_per_chunk;
+}
+
+void RequestHandler::EnableServiceExecutor(const unsigned default_threads)
+{
+    BOOST_ASSERT(service_handler);
+    service_executor =
+        std::make_unique<ServiceExecutor>(service_handler->GetServiceNames(), default_threads);
+}
+
+bool RequestHandler::AddServicePool(const std::vector<std::string> &services,
+                                    const unsigned threads)
+{
+    BOOST_ASSERT(service_executor);
+    return service_executor->AddPool(services, threads);
+}
+
+bool RequestHandler::SetServicePriority(const std::string &service, const int priority)
+{
+    BOOST_ASSERT(service_executor);
+    return service_executor->SetPriority(service, priority);
+}
+
+void RequestHandler::StartWorkers()
+{
+    if (service_executor)
+    {
+        service_executor->Start();
+    }
+}
+
+void RequestHandler::StopWorkers()
+{
+    if (service_executor)
+    {
+        service_executor->Stop();
+    }
+}
+
+void RequestHandler::ReplySent(const http::reply &sent_reply, const std::size_t sent_bytes)
+{
+    if (metrics)
+    {
+        metrics->ReplySent(
+            metrics->ServiceIndex(sent_reply.service), sent_reply.content.size(), sent_bytes);
+    }
+}
+
+void RequestHandler::HandleMetricsRequest(http::reply &current_reply)
+{
+    BOOST_ASSERT(metrics);
+    auto rendered = metrics->RenderPrometheus() +
+                    Metrics::RenderPrometheus(service_handler->GetEngineStatistics());
+    if (service_executor)
+    {
+        rendered += service_executor->RenderPrometheus();
+    }
+    current_reply.content.assign(rendered.begin(), rendered.end());
+    current_reply.headers.emplace_back("Content-Type", "text/plain; version=0.0.4");
+    current_reply.headers.emplace_back("Content-Length",
+                                       std::to_string(current_reply.content.size()));
+}
+
+namespace
+{
+// Content-Type of responses to queries with output_format=binary
+const constexpr char BINARY_RESPONSE_CONTENT_TYPE[] = "application/x-osrm-binary";
+
+// The first segment of the request path, without parsing the rest of the URL
+std::string ServiceName(const std::string &uri)
+{
+    const auto begin = uri.find_first_not_of('/');
+    if (begin == std::string::npos)
+    {
+        return {};
+    }
+    const auto end = uri.find_first_of("/?", begin);
+    return uri.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+// An absent header means no per-request deadline, anything but a positive integer is an error
+bool ParseTimeout(const std::string &header, ServiceHandler::TimeoutT &timeout)
+{
+    if (header.empty())
+    {
+        return true;
+    }
+    if (header.size() > 9 || !std::all_of(header.begin(), header.end(), [](const char c) {
+            return c >= '0' && c <= '9';
+        }))
+    {
+        return false;
+    }
+    const auto milliseconds = std::stoul(header);
+    if (milliseconds == 0)
+    {
+        return false;
+    }
+    timeout = std::chrono::milliseconds(milliseconds);
+    return true;
+}
+
+// Only POST requests have a body, it carries the coordinates of the query or a batch of traces
+// in binary form
+bool ParseBody(const http::request &request,
+               ServiceHandler::BodyT &body,
+               boost::optional<ServiceHandler::TracesT> &traces)
+{
+    if (request.method != "POST" || request.body.empty())
+    {
+        return true;
+    }
+    if (boost::istarts_with(request.content_type, api::BINARY_TRACES_CONTENT_TYPE))
+    {
+        traces = api::parseBinaryTraces(request.body);
+        return static_cast<bool>(traces);
+    }
+    if (!boost::istarts_with(request.content_type, api::BINARY_PARAMETERS_CONTENT_TYPE))
+    {
+        return false;
+    }
+    body = api::parseBinaryParameters(request.body);
+    return static_cast<bool>(body);
+}
+
+// Only HTTP/1.1 clients understand a body in chunks of unannounced length
+bool SupportsChunkedEncoding(const http::request &request)
+{
+    return request.http_version_major > 1 ||
+           (request.http_version_major == 1 && request.http_version_minor >= 1);
+}
+
+void AddCORSHeaders(http::reply &reply)
+{
+    reply.headers.emplace_back("Access-Control-Allow-Origin", "*");
+    reply.headers.emplace_back("Access-Control-Allow-Methods", "GET, POST");
+    reply.headers.emplace_back("Access-Control-Allow-Headers", "X-Requested-With, Content-Type");
+}
+
+void AddJSONHeaders(http::reply &reply)
+{
+    reply.headers.emplace_back("Content-Type", "application/json; charset=UTF-8");
+    reply.headers.emplace_back("Content-Disposition", "inline; filename=\"response.json\"");
+}
+
+// Pieces of a streamed table that may wait for the connection, which bounds the memory of
+// tables computed on worker threads. IO threads can't wait for themselves and queue them all.
+const constexpr std::size_t STREAMED_TABLE_PIECES = 4;
+
+// Holds back the first piece of a table, a table of a single piece is answered like any
+// other query. The second piece hands the reply over to the connection, which sends the
+// pieces as they are written to the stream.
+class TableStreamer
+{
+  public:
+    TableStreamer(http::reply &reply,
+                  const std::function<void()> &done,
+                  const std::size_t max_pieces,
+                  std::shared_ptr<http::body_stream> &stream)
+        : reply(reply), done(done), max_pieces(max_pieces), stream(stream)
+    {
+    }
+
+    bool Write(std::vector<char> &piece)
+    {
+        if (!stream && first_piece.empty())
+        {
+            first_piece.swap(piece);
+            return true;
+        }
+        if (!stream)
+        {
+            stream = std::make_shared<http::body_stream>(max_pieces);
+            stream->write(first_piece);
+            AddCORSHeaders(reply);
+            AddJSONHeaders(reply);
+            reply.stream = stream;
+            done();
+        }
+        return stream->write(piece);
+    }
+
+    std::vector<char> TakeFirstPiece() { return std::move(first_piece); }
+
+  private:
+    http::reply &reply;
+    const std::function<void()> &done;
+    const std::size_t max_pieces;
+    std::shared_ptr<http::body_stream> &stream;
+    std::vector<char> first_piece;
+};
+}
+
+void RequestHandler::DispatchRequest(const http::request &current_request,
+                                     http::reply &current_reply,
+                                     std::function<void()> done)
+{
+    // metrics are cheap and should be served even if all workers are busy
+    if (!service_executor || (metrics && current_request.uri == "/metrics"))
+    {
+        HandleRequest(current_request, current_reply, done);
+        return;
+    }
+
+    service_executor->Post(ServiceName(current_request.uri),
+                           [this, &current_request, &current_reply, done = std::move(done)]() {
+                               HandleRequest(current_request, current_reply, done);
+                           });
+}
+
+void RequestHandler::HandleRequest(const http::request &current_request,
+                                   http::reply &current_reply,
+                                   const std::function<void()> &done)
+{
+    std::shared_ptr<http::body_stream> stream;
+    const bool succeeded = AnswerRequest(current_request, current_reply, done, stream);
+    // A streamed reply was handed to the connection with its second piece already, finishing
+    // the stream last keeps the connection from reusing the request while it is still read.
+    if (stream)
+    {
+        stream->finish(succeeded);
+    }
+    else
+    {
+        done();
+    }
+}
+
+bool RequestHandler::AnswerRequest(const http::request &current_request,
+                                   http::reply &current_reply,
+                                   const std::function<void()> &done,
+                                   std::shared_ptr<http::body_stream> &stream)
 {
     if (!service_handler)
     {
         current_reply = http::reply::stock_reply(http::reply::internal_server_error);
         util::Log(logWARNING) << "No service handler registered." << std::endl;
-        return;
+        return true;
     }
 
     const auto tid = std::this_thread::get_id();
+    const auto request_start = std::chrono::steady_clock::now();
+    std::size_t metrics_service = 0;
+    engine::Status streamed_status = engine::Status::Ok;
 
     // parse command
     try
@@ -58,24 +326,113 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
 
         util::Log(logDEBUG) << "[req][" << tid << "] " << request_string;
 
+        if (metrics && request_string == "/metrics")
+        {
+            HandleMetricsRequest(current_reply);
+            return true;
+        }
+
         auto api_iterator = request_string.begin();
         auto maybe_parsed_url = api::parseURL(api_iterator, request_string.end());
         ServiceHandler::ResultT result;
+        ServiceHandler::BodyT body;
+        boost::optional<ServiceHandler::TracesT> traces;
+        ServiceHandler::TimeoutT timeout;
+
+        if (metrics)
+        {
+            current_reply.service = maybe_parsed_url ? maybe_parsed_url->service : "";
+            metrics_service = metrics->ServiceIndex(current_reply.service);
+            metrics->RequestStarted(metrics_service);
+        }
 
         // check if the was an error with the request
         if (maybe_parsed_url && api_iterator == request_string.end())
         {
-
-            const engine::Status status =
-                service_handler->RunQuery(*std::move(maybe_parsed_url), result);
-            if (status != engine::Status::Ok)
+            const bool valid_body = ParseBody(current_request, body, traces);
+            std::size_t cost = body ? std::max<std::size_t>(1, body->coordinates.size())
+                                    : EstimateRequestCost(*maybe_parsed_url);
+            if (traces)
+            {
+                cost = 1;
+                for (const auto &trace : *traces)
+                {
+                    cost += trace.parameters.coordinates.size();
+                }
+            }
+            const auto ticket = admission_control.Admit(maybe_parsed_url->service, cost);
+            if (!valid_body)
+            {
+                current_reply.status = http::reply::bad_request;
+                result = util::json::Object();
+                auto &json_result = result.get<util::json::Object>();
+                json_result.values["code"] = "InvalidBody";
+                json_result.values["message"] = std::string("Request body has to be of type ") +
+                                                api::BINARY_PARAMETERS_CONTENT_TYPE + " or " +
+                                                api::BINARY_TRACES_CONTENT_TYPE +
+                                                " and match the announced coordinates";
+            }
+            else if (!ticket.IsAdmitted())
+            {
+                // shed load early instead of queueing up more work for an overloaded service
+                current_reply.status = http::reply::service_unavailable;
+                result = util::json::Object();
+                auto &json_result = result.get<util::json::Object>();
+                json_result.values["code"] = "TooBusy";
+                json_result.values["message"] =
+                    "Service " + maybe_parsed_url->service + " is overloaded, try again later";
+            }
+            else if (!ParseTimeout(current_request.timeout, timeout))
             {
-                // 4xx bad request return code
                 current_reply.status = http::reply::bad_request;
+                result = util::json::Object();
+                auto &json_result = result.get<util::json::Object>();
+                json_result.values["code"] = "InvalidHeader";
+                json_result.values["message"] =
+                    "X-OSRM-Timeout has to be a positive number of milliseconds";
             }
             else
             {
-                BOOST_ASSERT(status == engine::Status::Ok);
+                TableStreamer streamer(current_reply,
+                                       done,
+                                       service_executor ? STREAMED_TABLE_PIECES : 0,
+                                       stream);
+                if (table_stream_rows > 0 && maybe_parsed_url->service == "table" && !traces &&
+                    SupportsChunkedEncoding(current_request))
+                {
+                    service::StreamedTable streamed;
+                    streamed.writer.rows_per_chunk = table_stream_rows;
+                    streamed.writer.write = [&streamer](std::vector<char> &piece) {
+                        return streamer.Write(piece);
+                    };
+                    result = std::move(streamed);
+                }
+
+                const engine::Status status =
+                    traces ? service_handler->RunBatchQuery(
+                                 *std::move(maybe_parsed_url), *traces, timeout, result)
+                           : service_handler->RunQuery(
+                                 *std::move(maybe_parsed_url), body, timeout, result);
+                if (result.is<service::StreamedTable>())
+                {
+                    if (stream)
+                    {
+                        streamed_status = status;
+                    }
+                    else if (status == engine::Status::Ok)
+                    {
+                        result = streamer.TakeFirstPiece();
+                    }
+                    else
+                    {
+                        result = std::move(result.get<service::StreamedTable>().writer.error);
+                    }
+                }
+                if (status != engine::Status::Ok && !stream)
+                {
+                    // 4xx bad request return code
+                    current_reply.status = http::reply::bad_request;
+                }
             }
         }
         else
@@ -98,72 +455,114 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
                                             std::to_string(position) + ": \"" + context + "\"";
         }
 
-        current_reply.headers.emplace_back("Access-Control-Allow-Origin", "*");
-        current_reply.headers.emplace_back("Access-Control-Allow-Methods", "GET");
-        current_reply.headers.emplace_back("Access-Control-Allow-Headers",
-                                           "X-Requested-With, Content-Type");
-        if (result.is<util::json::Object>())
+        if (stream)
         {
-            current_reply.headers.emplace_back("Content-Type", "application/json; charset=UTF-8");
-            current_reply.headers.emplace_back("Content-Disposition",
-                                               "inline; filename=\"response.json\"");
-
-            util::json::render(current_reply.content, result.get<util::json::Object>());
+            // the headers were sent with the first pieces and the body is still being written
+        }
+        else if (result.is<util::json::Object>() || result.is<std::vector<char>>())
+        {
+            AddCORSHeaders(current_reply);
+            AddJSONHeaders(current_reply);
+            if (result.is<util::json::Object>())
+            {
+                util::json::render(current_reply.content, result.get<util::json::Object>());
+            }
+            else
+            {
+                current_reply.content = std::move(result.get<std::vector<char>>());
+            }
+        }
+        else if (result.is<service::BinaryResult>())
+        {
+            AddCORSHeaders(current_reply);
+            current_reply.content = std::move(result.get<service::BinaryResult>().content);
+            current_reply.headers.emplace_back("Content-Type", BINARY_RESPONSE_CONTENT_TYPE);
         }
         else
         {
             BOOST_ASSERT(result.is<std::string>());
-            current_reply.content.resize(result.get<std::string>().size());
-            std::copy(result.get<std::string>().cbegin(),
-                      result.get<std::string>().cend(),
-                      current_reply.content.begin());
+            AddCORSHeaders(current_reply);
+            const auto &tile = result.get<std::string>();
+            current_reply.content.assign(tile.cbegin(), tile.cend());
 
             current_reply.headers.emplace_back("Content-Type", "application/x-protobuf");
         }
 
         // set headers
-        current_reply.headers.emplace_back("Content-Length",
-                                           std::to_string(current_reply.content.size()));
-
-        if (!std::getenv("DISABLE_ACCESS_LOGGING"))
-        {
-            // deactivated as GCC apparently does not implement that, not even in 4.9
-            // std::time_t t = std::time(nullptr);
-            // util::Log() << std::put_time(std::localtime(&t), "%m-%d-%Y
-            // %H:%M:%S") <<
-            //     " " << current_request.endpoint.to_string() << " " <<
-            //     current_request.referrer << ( 0 == current_request.referrer.length() ? "- " :" ")
-            //     <<
-            //     current_request.agent << ( 0 == current_request.agent.length() ? "- " :" ") <<
-            //     request;
-
-            time_t ltime;
-            struct tm *time_stamp;
-            TIMER_STOP(request_duration);
+        if (!stream)
+        {
+            current_reply.headers.emplace_back("Content-Length",
+                                               std::to_string(current_reply.content.size()));
+        }
+        // the reply belongs to the connection once streaming started, a table that failed
+        // half way is logged like any other failed query
+        const auto reply_status = stream && streamed_status != engine::Status::Ok
+                                      ? http::reply::bad_request
+                                      : stream ? http::reply::ok : current_reply.status;
+
+        if (query_log && query_log->Sample())
+        {
+            QueryRecord record;
+            const auto now = std::chrono::steady_clock::now();
+            const auto arrival = std::chrono::system_clock::now() - (now - request_start);
+            record.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      arrival.time_since_epoch())
+                                      .count();
+            record.latency_us =
+                std::chrono::duration_cast<std::chrono::microseconds>(now - request_start)
+                    .count();
+            record.status = reply_status;
+            record.timeout_ms = timeout ? timeout->count() : 0;
+            record.url = request_string;
+            if (current_request.method == "POST")
+            {
+                record.body = current_request.body;
+            }
+            query_log->Write(record);
+        }
 
-            ltime = time(nullptr);
-            time_stamp = localtime(&ltime);
-            // log timestamp
-            util::Log() << (time_stamp->tm_mday < 10 ? "0" : "") << time_stamp->tm_mday << "-"
-                        << (time_stamp->tm_mon + 1 < 10 ? "0" : "") << (time_stamp->tm_mon + 1)
-                        << "-" << 1900 + time_stamp->tm_year << " "
-                        << (time_stamp->tm_hour < 10 ? "0" : "") << time_stamp->tm_hour << ":"
-                        << (time_stamp->tm_min < 10 ? "0" : "") << time_stamp->tm_min << ":"
-                        << (time_stamp->tm_sec < 10 ? "0" : "") << time_stamp->tm_sec << " "
-                        << TIMER_MSEC(request_duration) << "ms "
-                        << current_request.endpoint.to_string() << " " << current_request.referrer
-                        << (0 == current_request.referrer.length() ? "- " : " ")
-                        << current_request.agent
-                        << (0 == current_request.agent.length() ? "- " : " ")
-                        << current_reply.status << " " //
-                        << request_string;
+        if (metrics)
+        {
+            const auto status =
+                reply_status == http::reply::ok
+                    ? Metrics::RequestStatus::Ok
+                    : reply_status == http::reply::service_unavailable
+                          ? Metrics::RequestStatus::Rejected
+                          : Metrics::RequestStatus::Error;
+            metrics->RequestFinished(
+                metrics_service, status, std::chrono::steady_clock::now() - request_start);
         }
+
+        if (access_log)
+        {
+            TIMER_STOP(request_duration);
+            AccessRecord record;
+            record.time = std::time(nullptr);
+            record.duration_ms = TIMER_MSEC(request_duration);
+            record.endpoint = current_request.endpoint.to_string();
+            record.referrer = current_request.referrer;
+            record.agent = current_request.agent;
+            record.status = reply_status;
+            record.request = std::move(request_string);
+            access_log->Log(std::move(record));
+        }
+        return streamed_status == engine::Status::Ok;
     }
     catch (const std::exception &e)
     {
-        current_reply = http::reply::stock_reply(http::reply::internal_server_error);
+        if (metrics)
+        {
+            metrics->RequestFinished(metrics_service,
+                                     Metrics::RequestStatus::Error,
+                                     std::chrono::steady_clock::now() - request_start);
+        }
+        if (!stream)
+        {
+            current_reply = http::reply::stock_reply(http::reply::internal_server_error);
+        }
         util::Log(logWARNING) << "[server error][" << tid << "] code: " << e.what()
                               << ", uri: " << current_request.uri;
+        return false;
     }
 }
 }
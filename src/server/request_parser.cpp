@@ -1,11 +1,13 @@
 #include "server/request_parser.hpp"
 
 #include "server/http/compression_type.hpp"
+#include "server/http/compressor.hpp"
 #include "server/http/header.hpp"
 #include "server/http/request.hpp"
 
 #include <boost/algorithm/string/predicate.hpp>
 
+#include <algorithm>
 #include <string>
 
 namespace osrm
@@ -15,24 +17,38 @@ namespace server
 
 RequestParser::RequestParser()
     : state(internal_state::method_start), current_header({"", ""}),
-      selected_compression(http::no_compression)
+      selected_compression(http::no_compression), content_length(0), expect_continue(false)
 {
 }
 
-std::tuple<RequestParser::RequestStatus, http::compression_type>
+std::tuple<RequestParser::RequestStatus, http::compression_type, char *>
 RequestParser::parse(http::request &current_request, char *begin, char *end)
 {
     while (begin != end)
     {
+        if (state == internal_state::body)
+        {
+            // the body is opaque to us, copy it in bulk instead of char by char
+            const auto missing = content_length - current_request.body.size();
+            const auto available = std::min<std::size_t>(missing, end - begin);
+            current_request.body.append(begin, available);
+            begin += available;
+            if (current_request.body.size() == content_length)
+            {
+                return std::make_tuple(RequestStatus::valid, selected_compression, begin);
+            }
+            continue;
+        }
+
         RequestStatus result = consume(current_request, *begin++);
         if (result != RequestStatus::indeterminate)
         {
-            return std::make_tuple(result, selected_compression);
+            return std::make_tuple(result, selected_compression, begin);
         }
     }
     RequestStatus result = RequestStatus::indeterminate;
 
-    return std::make_tuple(result, selected_compression);
+    return std::make_tuple(result, selected_compression, begin);
 }
 
 RequestParser::RequestStatus RequestParser::consume(http::request &current_request,
@@ -46,6 +62,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
             return RequestStatus::invalid;
         }
         state = internal_state::method;
+        current_request.method.push_back(input);
         return RequestStatus::indeterminate;
     case internal_state::method:
         if (input == ' ')
@@ -57,6 +74,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         {
             return RequestStatus::invalid;
         }
+        current_request.method.push_back(input);
         return RequestStatus::indeterminate;
     case internal_state::uri_start:
         if (is_CTL(input))
@@ -116,6 +134,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
     case internal_state::http_version_major_start:
         if (is_digit(input))
         {
+            current_request.http_version_major = input - '0';
             state = internal_state::http_version_major;
             return RequestStatus::indeterminate;
         }
@@ -128,12 +147,15 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         }
         if (is_digit(input))
         {
+            current_request.http_version_major =
+                current_request.http_version_major * 10 + input - '0';
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
     case internal_state::http_version_minor_start:
         if (is_digit(input))
         {
+            current_request.http_version_minor = input - '0';
             state = internal_state::http_version_minor;
             return RequestStatus::indeterminate;
         }
@@ -146,6 +168,8 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         }
         if (is_digit(input))
         {
+            current_request.http_version_minor =
+                current_request.http_version_minor * 10 + input - '0';
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
@@ -159,15 +183,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
     case internal_state::header_line_start:
         if (boost::iequals(current_header.name, "Accept-Encoding"))
         {
-            /* giving gzip precedence over deflate */
-            if (boost::icontains(current_header.value, "deflate"))
-            {
-                selected_compression = http::deflate_rfc1951;
-            }
-            if (boost::icontains(current_header.value, "gzip"))
-            {
-                selected_compression = http::gzip_rfc1952;
-            }
+            selected_compression = http::negotiate_compression(current_header.value);
         }
 
         if (boost::iequals(current_header.name, "Referer"))
@@ -180,6 +196,42 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
             current_request.agent = current_header.value;
         }
 
+        if (boost::iequals(current_header.name, "Connection"))
+        {
+            current_request.connection = current_header.value;
+        }
+
+        if (boost::iequals(current_header.name, "X-OSRM-Timeout"))
+        {
+            current_request.timeout = current_header.value;
+        }
+
+        if (boost::iequals(current_header.name, "Content-Type"))
+        {
+            current_request.content_type = current_header.value;
+        }
+
+        if (boost::iequals(current_header.name, "Content-Length"))
+        {
+            if (current_header.value.empty() || current_header.value.size() > 10 ||
+                !std::all_of(current_header.value.begin(),
+                             current_header.value.end(),
+                             [this](const char c) { return is_digit(c); }))
+            {
+                return RequestStatus::invalid;
+            }
+            content_length = std::stoull(current_header.value);
+            if (content_length > MAX_BODY_SIZE)
+            {
+                return RequestStatus::invalid;
+            }
+        }
+
+        if (boost::iequals(current_header.name, "Expect"))
+        {
+            expect_continue = boost::iequals(current_header.value, "100-continue");
+        }
+
         if (input == '\r')
         {
             state = internal_state::expecting_newline_3;
@@ -247,8 +299,19 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
-    default: // expecting_newline_3
-        return input == '\n' ? RequestStatus::valid : RequestStatus::invalid;
+    default: // expecting_newline_3, the body is consumed by parse()
+        if (input != '\n')
+        {
+            return RequestStatus::invalid;
+        }
+        if (content_length == 0)
+        {
+            return RequestStatus::valid;
+        }
+        state = internal_state::body;
+        current_request.body.reserve(content_length);
+        current_request.expect_continue = expect_continue;
+        return RequestStatus::indeterminate;
     }
 }
 
@@ -0,0 +1,105 @@
+#include "server/service/isochrone_service.hpp"
+#include "server/service/utils.hpp"
+
+#include "server/api/parameters_parser.hpp"
+#include "engine/api/isochrone_parameters.hpp"
+
+#include "util/json_container.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace service
+{
+
+namespace
+{
+std::string getWrongOptionHelp(const engine::api::IsochroneParameters &parameters)
+{
+    std::string help;
+
+    const auto coord_size = parameters.coordinates.size();
+
+    constrainParamSize(PARAMETER_SIZE_MISMATCH_MSG, "hints", parameters.hints, coord_size, help);
+    constrainParamSize(
+        PARAMETER_SIZE_MISMATCH_MSG, "bearings", parameters.bearings, coord_size, help);
+    constrainParamSize(
+        PARAMETER_SIZE_MISMATCH_MSG, "radiuses", parameters.radiuses, coord_size, help);
+    constrainParamSize(
+        PARAMETER_SIZE_MISMATCH_MSG, "approaches", parameters.approaches, coord_size, help);
+
+    if (help.empty() && coord_size != 1)
+    {
+        help = "Only one input coordinate is supported";
+    }
+    if (help.empty())
+    {
+        help = "Contours must be positive and ascending, tiles need x and y below 2^z";
+    }
+
+    return help;
+}
+} // anon. ns
+
+engine::Status IsochroneService::RunQuery(std::size_t prefix_length,
+                                          std::string &query,
+                                          BodyT &body,
+                                          const TimeoutT &timeout,
+                                          ResultT &result)
+{
+    result = util::json::Object();
+    auto &json_result = result.get<util::json::Object>();
+
+    auto query_iterator = query.begin();
+    auto parameters =
+        body ? api::parseParameters<engine::api::IsochroneParameters>(
+                   query_iterator, query.end(), std::move(*body))
+             : api::parseParameters<engine::api::IsochroneParameters>(query_iterator, query.end());
+    if (!parameters || query_iterator != query.end())
+    {
+        const auto position = std::distance(query.begin(), query_iterator);
+        json_result.values["code"] = "InvalidQuery";
+        json_result.values["message"] =
+            "Query string malformed close to position " + std::to_string(prefix_length + position);
+        return engine::Status::Error;
+    }
+    BOOST_ASSERT(parameters);
+
+    if (!parameters->IsValid())
+    {
+        json_result.values["code"] = "InvalidOptions";
+        json_result.values["message"] = getWrongOptionHelp(*parameters);
+        return engine::Status::Error;
+    }
+    BOOST_ASSERT(parameters->IsValid());
+
+    parameters->timeout = timeout;
+
+    if (parameters->tile)
+    {
+        std::string tile;
+        const auto status = BaseService::routing_machine.Isochrone(*parameters, tile);
+        // errors are rendered JSON, only tiles are sent as protobuf
+        if (status == engine::Status::Ok)
+        {
+            result = std::move(tile);
+        }
+        else
+        {
+            result = std::vector<char>(tile.begin(), tile.end());
+        }
+        return status;
+    }
+
+    const auto status = BaseService::routing_machine.Isochrone(*parameters, json_result);
+    ApplyOutputFormat(*parameters, result);
+    return status;
+}
+}
+}
+}
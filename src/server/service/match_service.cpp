@@ -4,6 +4,7 @@
 #include "server/service/utils.hpp"
 #include "engine/api/match_parameters.hpp"
 
+#include "util/integer_range.hpp"
 #include "util/json_container.hpp"
 
 #include <boost/format.hpp>
@@ -32,24 +33,33 @@ std::string getWrongOptionHelp(const engine::api::MatchParameters &parameters)
         constrainParamSize(
             PARAMETER_SIZE_MISMATCH_MSG, "timestamps", parameters.timestamps, coord_size, help);
 
-    if (!param_size_mismatch && parameters.coordinates.size() < 2)
+    if (!param_size_mismatch && parameters.session.empty() && parameters.coordinates.size() < 2)
     {
         help = "Number of coordinates needs to be at least two.";
     }
+    else if (!param_size_mismatch && !parameters.session.empty() && parameters.tidy)
+    {
+        help = "Traces of matching sessions can not be tidied.";
+    }
 
     return help;
 }
 } // anon. ns
 
-engine::Status
-MatchService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+engine::Status MatchService::RunQuery(std::size_t prefix_length,
+                                      std::string &query,
+                                      BodyT &body,
+                                      const TimeoutT &timeout,
+                                      ResultT &result)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
 
     auto query_iterator = query.begin();
     auto parameters =
-        api::parseParameters<engine::api::MatchParameters>(query_iterator, query.end());
+        body ? api::parseParameters<engine::api::MatchParameters>(
+                   query_iterator, query.end(), std::move(*body))
+             : api::parseParameters<engine::api::MatchParameters>(query_iterator, query.end());
     if (!parameters || query_iterator != query.end())
     {
         const auto position = std::distance(query.begin(), query_iterator);
@@ -68,7 +78,79 @@ MatchService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &r
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Match(*parameters, json_result);
+    parameters->timeout = timeout;
+
+    const auto status = BaseService::routing_machine.Match(*parameters, json_result);
+    ApplyOutputFormat(*parameters, result);
+    return status;
+}
+
+engine::Status MatchService::RunBatchQuery(std::size_t prefix_length,
+                                           std::string &query,
+                                           TracesT &traces,
+                                           const TimeoutT &timeout,
+                                           ResultT &result)
+{
+    result = util::json::Object();
+    auto &json_result = result.get<util::json::Object>();
+
+    // the options are parsed once and copied into every trace
+    auto query_iterator = query.begin();
+    auto options = api::parseOptions<engine::api::MatchParameters>(query_iterator, query.end());
+    if (!options || query_iterator != query.end())
+    {
+        const auto position = std::distance(query.begin(), query_iterator);
+        json_result.values["code"] = "InvalidQuery";
+        json_result.values["message"] =
+            "Query string malformed close to position " + std::to_string(prefix_length + position);
+        return engine::Status::Error;
+    }
+    if (!options->session.empty())
+    {
+        json_result.values["code"] = "InvalidOptions";
+        json_result.values["message"] = "Traces of a batch can not extend matching sessions.";
+        return engine::Status::Error;
+    }
+    options->timeout = timeout;
+
+    std::vector<engine::api::MatchParameters> parameters(traces.size(), *options);
+    for (const auto index : util::irange<std::size_t>(0, traces.size()))
+    {
+        auto &trace = traces[index].parameters;
+        parameters[index].coordinates = std::move(trace.coordinates);
+        if (!trace.hints.empty())
+            parameters[index].hints = std::move(trace.hints);
+        if (!trace.radiuses.empty())
+            parameters[index].radiuses = std::move(trace.radiuses);
+        if (!trace.bearings.empty())
+            parameters[index].bearings = std::move(trace.bearings);
+        if (!traces[index].timestamps.empty())
+            parameters[index].timestamps = std::move(traces[index].timestamps);
+    }
+
+    std::vector<util::json::Object> responses;
+    BaseService::routing_machine.MatchBatch(parameters, responses);
+
+    // invalid traces get the help of a single query if there is one
+    util::json::Array results;
+    results.values.reserve(responses.size());
+    for (const auto index : util::irange<std::size_t>(0, responses.size()))
+    {
+        if (!parameters[index].IsValid())
+        {
+            auto help = getWrongOptionHelp(parameters[index]);
+            if (!help.empty())
+                responses[index].values["message"] = std::move(help);
+        }
+        results.values.push_back(std::move(responses[index]));
+    }
+    json_result.values["code"] = "Ok";
+    json_result.values["results"] = std::move(results);
+
+    BinaryResult binary;
+    util::json::renderBinary(binary.content, json_result);
+    result = std::move(binary);
+    return engine::Status::Ok;
 }
 }
 }
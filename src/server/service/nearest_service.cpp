@@ -35,15 +35,20 @@ std::string getWrongOptionHelp(const engine::api::NearestParameters &parameters)
 }
 } // anon. ns
 
-engine::Status
-NearestService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+engine::Status NearestService::RunQuery(std::size_t prefix_length,
+                                        std::string &query,
+                                        BodyT &body,
+                                        const TimeoutT &timeout,
+                                        ResultT &result)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
 
     auto query_iterator = query.begin();
     auto parameters =
-        api::parseParameters<engine::api::NearestParameters>(query_iterator, query.end());
+        body ? api::parseParameters<engine::api::NearestParameters>(
+                   query_iterator, query.end(), std::move(*body))
+             : api::parseParameters<engine::api::NearestParameters>(query_iterator, query.end());
     if (!parameters || query_iterator != query.end())
     {
         const auto position = std::distance(query.begin(), query_iterator);
@@ -62,7 +67,11 @@ NearestService::RunQuery(std::size_t prefix_length, std::string &query, ResultT
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Nearest(*parameters, json_result);
+    parameters->timeout = timeout;
+
+    const auto status = BaseService::routing_machine.Nearest(*parameters, json_result);
+    ApplyOutputFormat(*parameters, result);
+    return status;
 }
 }
 }
@@ -39,15 +39,20 @@ std::string getWrongOptionHelp(const engine::api::RouteParameters &parameters)
 }
 } // anon. ns
 
-engine::Status
-RouteService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+engine::Status RouteService::RunQuery(std::size_t prefix_length,
+                                      std::string &query,
+                                      BodyT &body,
+                                      const TimeoutT &timeout,
+                                      ResultT &result)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
 
     auto query_iterator = query.begin();
     auto parameters =
-        api::parseParameters<engine::api::RouteParameters>(query_iterator, query.end());
+        body ? api::parseParameters<engine::api::RouteParameters>(
+                   query_iterator, query.end(), std::move(*body))
+             : api::parseParameters<engine::api::RouteParameters>(query_iterator, query.end());
     if (!parameters || query_iterator != query.end())
     {
         const auto position = std::distance(query.begin(), query_iterator);
@@ -66,7 +71,11 @@ RouteService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &r
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Route(*parameters, json_result);
+    parameters->timeout = timeout;
+
+    const auto status = BaseService::routing_machine.Route(*parameters, json_result);
+    ApplyOutputFormat(*parameters, result);
+    return status;
 }
 }
 }
@@ -60,15 +60,25 @@ std::string getWrongOptionHelp(const engine::api::TableParameters &parameters)
 }
 } // anon. ns
 
-engine::Status
-TableService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+engine::Status TableService::RunQuery(std::size_t prefix_length,
+                                      std::string &query,
+                                      BodyT &body,
+                                      const TimeoutT &timeout,
+                                      ResultT &result)
 {
+    boost::optional<StreamedTable> streamed;
+    if (result.is<StreamedTable>())
+    {
+        streamed = std::move(result.get<StreamedTable>());
+    }
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
 
     auto query_iterator = query.begin();
     auto parameters =
-        api::parseParameters<engine::api::TableParameters>(query_iterator, query.end());
+        body ? api::parseParameters<engine::api::TableParameters>(
+                   query_iterator, query.end(), std::move(*body))
+             : api::parseParameters<engine::api::TableParameters>(query_iterator, query.end());
     if (!parameters || query_iterator != query.end())
     {
         const auto position = std::distance(query.begin(), query_iterator);
@@ -87,7 +97,24 @@ TableService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &r
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Table(*parameters, json_result);
+    parameters->timeout = timeout;
+
+    if (parameters->output_format == engine::api::BaseParameters::OutputFormatType::Binary)
+    {
+        const auto status = BaseService::routing_machine.Table(*parameters, json_result);
+        ApplyOutputFormat(*parameters, result);
+        return status;
+    }
+
+    if (streamed)
+    {
+        result = std::move(*streamed);
+        return BaseService::routing_machine.Table(*parameters, result.get<StreamedTable>().writer);
+    }
+
+    // large matrices are rendered while they are read out, skipping the json::Object
+    result = std::vector<char>();
+    return BaseService::routing_machine.Table(*parameters, result.get<std::vector<char>>());
 }
 }
 }
@@ -15,7 +15,11 @@ namespace server
 namespace service
 {
 
-engine::Status TileService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+engine::Status TileService::RunQuery(std::size_t prefix_length,
+                                     std::string &query,
+                                     BodyT & /*body*/,
+                                     const TimeoutT & /*timeout*/,
+                                     ResultT &result)
 {
     auto query_iterator = query.begin();
     auto parameters =
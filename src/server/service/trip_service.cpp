@@ -41,14 +41,20 @@ std::string getWrongOptionHelp(const engine::api::TripParameters &parameters)
 }
 } // anon. ns
 
-engine::Status TripService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+engine::Status TripService::RunQuery(std::size_t prefix_length,
+                                     std::string &query,
+                                     BodyT &body,
+                                     const TimeoutT &timeout,
+                                     ResultT &result)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
 
     auto query_iterator = query.begin();
     auto parameters =
-        api::parseParameters<engine::api::TripParameters>(query_iterator, query.end());
+        body ? api::parseParameters<engine::api::TripParameters>(
+                   query_iterator, query.end(), std::move(*body))
+             : api::parseParameters<engine::api::TripParameters>(query_iterator, query.end());
     if (!parameters || query_iterator != query.end())
     {
         const auto position = std::distance(query.begin(), query_iterator);
@@ -69,7 +75,11 @@ engine::Status TripService::RunQuery(std::size_t prefix_length, std::string &que
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Trip(*parameters, json_result);
+    parameters->timeout = timeout;
+
+    const auto status = BaseService::routing_machine.Trip(*parameters, json_result);
+    ApplyOutputFormat(*parameters, result);
+    return status;
 }
 }
 }
@@ -0,0 +1,177 @@
+#include "server/service_executor.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+namespace osrm
+{
+namespace server
+{
+
+ServiceExecutor::ServiceExecutor(std::vector<std::string> service_names_,
+                                 const unsigned default_threads)
+    : service_names(std::move(service_names_))
+{
+    service_names.push_back("other");
+    pools.push_back(std::make_unique<Pool>());
+    pools.front()->name = "default";
+    pools.front()->num_threads = std::max(1u, default_threads);
+    service_pools.resize(service_names.size(), 0);
+    service_priorities.resize(service_names.size(), 0);
+    queued = std::make_unique<std::atomic<std::int64_t>[]>(service_names.size());
+    for (std::size_t service = 0; service < service_names.size(); ++service)
+    {
+        queued[service].store(0, std::memory_order_relaxed);
+    }
+}
+
+ServiceExecutor::~ServiceExecutor() { Stop(); }
+
+std::size_t ServiceExecutor::ServiceIndex(const std::string &service) const
+{
+    const auto iter = std::find(service_names.begin(), service_names.end() - 1, service);
+    return std::distance(service_names.begin(), iter);
+}
+
+bool ServiceExecutor::AddPool(const std::vector<std::string> &services, const unsigned threads)
+{
+    for (const auto &service : services)
+    {
+        const auto index = ServiceIndex(service);
+        if (index + 1 == service_names.size() || service_pools[index] != 0)
+        {
+            return false;
+        }
+    }
+
+    auto pool = std::make_unique<Pool>();
+    pool->num_threads = std::max(1u, threads);
+    for (const auto &service : services)
+    {
+        service_pools[ServiceIndex(service)] = pools.size();
+        pool->name += (pool->name.empty() ? "" : ",") + service;
+    }
+    pools.push_back(std::move(pool));
+    return true;
+}
+
+bool ServiceExecutor::SetPriority(const std::string &service, const int priority)
+{
+    const auto index = ServiceIndex(service);
+    if (index + 1 == service_names.size())
+    {
+        return false;
+    }
+    service_priorities[index] = priority;
+    return true;
+}
+
+void ServiceExecutor::Start()
+{
+    for (auto &pool : pools)
+    {
+        const auto pool_ptr = pool.get();
+        for (unsigned thread = 0; thread < pool->num_threads; ++thread)
+        {
+            pool->threads.emplace_back([this, pool_ptr]() { Work(*pool_ptr); });
+        }
+    }
+}
+
+void ServiceExecutor::Stop()
+{
+    for (auto &pool : pools)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            pool->stopped = true;
+        }
+        pool->task_posted.notify_all();
+    }
+    for (auto &pool : pools)
+    {
+        for (auto &thread : pool->threads)
+        {
+            thread.join();
+        }
+        pool->threads.clear();
+    }
+}
+
+void ServiceExecutor::Post(const std::string &service, Job job)
+{
+    const auto index = ServiceIndex(service);
+    auto &pool = *pools[service_pools[index]];
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.stopped)
+        {
+            return;
+        }
+        pool.tasks.push(
+            Task{service_priorities[index], pool.next_sequence++, index, std::move(job)});
+        queued[index].fetch_add(1, std::memory_order_relaxed);
+    }
+    pool.task_posted.notify_one();
+}
+
+void ServiceExecutor::Work(Pool &pool)
+{
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    while (true)
+    {
+        pool.task_posted.wait(lock, [&pool]() { return pool.stopped || !pool.tasks.empty(); });
+        if (pool.stopped)
+        {
+            return;
+        }
+
+        // the queue only hands out const references, the job is moved out before popping it
+        auto job = std::move(const_cast<Task &>(pool.tasks.top()).job);
+        const auto service = pool.tasks.top().service;
+        pool.tasks.pop();
+        queued[service].fetch_sub(1, std::memory_order_relaxed);
+        ++pool.busy_threads;
+        lock.unlock();
+
+        job();
+
+        lock.lock();
+        --pool.busy_threads;
+    }
+}
+
+std::string ServiceExecutor::RenderPrometheus() const
+{
+    std::stringstream out;
+
+    out << "# HELP osrm_requests_queued Number of requests waiting for a worker thread.\n"
+        << "# TYPE osrm_requests_queued gauge\n";
+    for (std::size_t service = 0; service < service_names.size(); ++service)
+    {
+        out << "osrm_requests_queued{service=\"" << service_names[service] << "\"} "
+            << queued[service].load(std::memory_order_relaxed) << "\n";
+    }
+
+    out << "# HELP osrm_worker_threads Number of worker threads of a pool.\n"
+        << "# TYPE osrm_worker_threads gauge\n";
+    for (const auto &pool : pools)
+    {
+        out << "osrm_worker_threads{pool=\"" << pool->name << "\"} " << pool->num_threads
+            << "\n";
+    }
+
+    out << "# HELP osrm_worker_threads_busy Number of worker threads running a request.\n"
+        << "# TYPE osrm_worker_threads_busy gauge\n";
+    for (const auto &pool : pools)
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        out << "osrm_worker_threads_busy{pool=\"" << pool->name << "\"} " << pool->busy_threads
+            << "\n";
+    }
+
+    return out.str();
+}
+}
+}
@@ -1,5 +1,6 @@
 #include "server/service_handler.hpp"
 
+#include "server/service/isochrone_service.hpp"
 #include "server/service/match_service.hpp"
 #include "server/service/nearest_service.hpp"
 #include "server/service/route_service.hpp"
@@ -8,9 +9,15 @@
 #include "server/service/trip_service.hpp"
 
 #include "server/api/parsed_url.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/json_util.hpp"
 
+#include <boost/assert.hpp>
+
+#include <algorithm>
 #include <memory>
+#include <utility>
 
 namespace osrm
 {
@@ -24,10 +31,27 @@ ServiceHandler::ServiceHandler(osrm::EngineConfig &config) : routing_machine(con
     service_map["trip"] = std::make_unique<service::TripService>(routing_machine);
     service_map["match"] = std::make_unique<service::MatchService>(routing_machine);
     service_map["tile"] = std::make_unique<service::TileService>(routing_machine);
+    service_map["isochrone"] = std::make_unique<service::IsochroneService>(routing_machine);
 }
 
-engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
-                                        service::BaseService::ResultT &result)
+std::vector<std::string> ServiceHandler::GetServiceNames() const
+{
+    std::vector<std::string> names;
+    for (const auto &service : service_map)
+    {
+        names.push_back(service.first);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+engine::EngineStatistics ServiceHandler::GetEngineStatistics() const
+{
+    return routing_machine.GetStatistics();
+}
+
+service::BaseService *ServiceHandler::FindService(const api::ParsedURL &parsed_url,
+                                                  ResultT &result) const
 {
     const auto &service_iter = service_map.find(parsed_url.service);
     if (service_iter == service_map.end())
@@ -36,7 +60,7 @@ engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
         auto &json_result = result.get<util::json::Object>();
         json_result.values["code"] = "InvalidService";
         json_result.values["message"] = "Service " + parsed_url.service + " not found!";
-        return engine::Status::Error;
+        return nullptr;
     }
     auto &service = service_iter->second;
 
@@ -46,10 +70,154 @@ engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
         auto &json_result = result.get<util::json::Object>();
         json_result.values["code"] = "InvalidVersion";
         json_result.values["message"] = "Service " + parsed_url.service + " not found!";
+        return nullptr;
+    }
+
+    return service.get();
+}
+
+engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
+                                        BodyT &body,
+                                        const TimeoutT &timeout,
+                                        service::BaseService::ResultT &result)
+{
+    auto *service = FindService(parsed_url, result);
+    if (!service)
+    {
+        return engine::Status::Error;
+    }
+    return service->RunQuery(parsed_url.prefix_length, parsed_url.query, body, timeout, result);
+}
+
+engine::Status ServiceHandler::RunBatchQuery(api::ParsedURL parsed_url,
+                                             TracesT &traces,
+                                             const TimeoutT &timeout,
+                                             service::BaseService::ResultT &result)
+{
+    auto *service = FindService(parsed_url, result);
+    if (!service)
+    {
         return engine::Status::Error;
     }
+    return service->RunBatchQuery(
+        parsed_url.prefix_length, parsed_url.query, traces, timeout, result);
+}
+
+ProfileServiceHandler::ProfileServiceHandler(
+    std::unique_ptr<ServiceHandlerInterface> default_handler_)
+    : default_handler(std::move(default_handler_))
+{
+}
+
+void ProfileServiceHandler::AddProfile(const std::string &profile,
+                                       std::unique_ptr<ServiceHandlerInterface> handler)
+{
+    BOOST_ASSERT(handler);
+    const auto &any_handler = default_handler ? default_handler
+                                              : profile_handlers.empty()
+                                                    ? handler
+                                                    : profile_handlers.begin()->second;
+    if (handler->GetServiceNames() != any_handler->GetServiceNames())
+    {
+        throw util::exception("The dataset of profile " + profile +
+                              " offers other services than the others" + SOURCE_REF);
+    }
+    if (!profile_handlers.emplace(profile, std::move(handler)).second)
+    {
+        throw util::exception("Profile " + profile + " has more than one dataset" + SOURCE_REF);
+    }
+}
+
+std::vector<std::string> ProfileServiceHandler::GetServiceNames() const
+{
+    if (default_handler)
+    {
+        return default_handler->GetServiceNames();
+    }
+    return profile_handlers.empty() ? std::vector<std::string>{}
+                                    : profile_handlers.begin()->second->GetServiceNames();
+}
+
+engine::EngineStatistics ProfileServiceHandler::GetEngineStatistics() const
+{
+    engine::EngineStatistics sum{};
+    const auto add_cache = [](util::CacheStatistics &total, const util::CacheStatistics &cache) {
+        total.hits += cache.hits;
+        total.misses += cache.misses;
+        total.evictions += cache.evictions;
+        total.entries += cache.entries;
+        total.capacity += cache.capacity;
+    };
+    const auto add = [&](const engine::EngineStatistics &statistics) {
+        add_cache(sum.route_cache, statistics.route_cache);
+        add_cache(sum.snapping_cache, statistics.snapping_cache);
+        add_cache(sum.unpacking_cache, statistics.unpacking_cache);
+        add_cache(sum.tile_cache, statistics.tile_cache);
+        sum.coalesced_requests += statistics.coalesced_requests;
+        sum.data_updates.updates += statistics.data_updates.updates;
+        sum.data_updates.total_us += statistics.data_updates.total_us;
+        sum.data_updates.last_us =
+            std::max(sum.data_updates.last_us, statistics.data_updates.last_us);
+        // all engines on shared memory see the same datasets
+        sum.data_updates.generations =
+            std::max(sum.data_updates.generations, statistics.data_updates.generations);
+        sum.data_updates.generation_bytes =
+            std::max(sum.data_updates.generation_bytes, statistics.data_updates.generation_bytes);
+    };
+
+    if (default_handler)
+    {
+        add(default_handler->GetEngineStatistics());
+    }
+    for (const auto &handler : profile_handlers)
+    {
+        add(handler.second->GetEngineStatistics());
+    }
+    return sum;
+}
+
+engine::Status ProfileServiceHandler::RunQuery(api::ParsedURL parsed_url,
+                                               service::BaseService::BodyT &body,
+                                               const service::BaseService::TimeoutT &timeout,
+                                               service::BaseService::ResultT &result)
+{
+    const auto handler = profile_handlers.find(parsed_url.profile);
+    if (handler != profile_handlers.end())
+    {
+        return handler->second->RunQuery(std::move(parsed_url), body, timeout, result);
+    }
+    if (default_handler)
+    {
+        return default_handler->RunQuery(std::move(parsed_url), body, timeout, result);
+    }
+
+    result = util::json::Object();
+    auto &json_result = result.get<util::json::Object>();
+    json_result.values["code"] = "InvalidService";
+    json_result.values["message"] = "Profile " + parsed_url.profile + " not found!";
+    return engine::Status::Error;
+}
+
+engine::Status ProfileServiceHandler::RunBatchQuery(api::ParsedURL parsed_url,
+                                                    service::BaseService::TracesT &traces,
+                                                    const service::BaseService::TimeoutT &timeout,
+                                                    service::BaseService::ResultT &result)
+{
+    const auto handler = profile_handlers.find(parsed_url.profile);
+    if (handler != profile_handlers.end())
+    {
+        return handler->second->RunBatchQuery(std::move(parsed_url), traces, timeout, result);
+    }
+    if (default_handler)
+    {
+        return default_handler->RunBatchQuery(std::move(parsed_url), traces, timeout, result);
+    }
 
-    return service->RunQuery(parsed_url.prefix_length, parsed_url.query, result);
+    result = util::json::Object();
+    auto &json_result = result.get<util::json::Object>();
+    json_result.values["code"] = "InvalidService";
+    json_result.values["message"] = "Profile " + parsed_url.profile + " not found!";
+    return engine::Status::Error;
 }
 }
 }
@@ -0,0 +1,587 @@
+#include "server/table_coordinator.hpp"
+#include "server/api/binary_parameters_parser.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/json_binary_renderer.hpp"
+#include "util/log.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+template <typename T> void Append(std::string &out, const T &value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T Read(const std::string &buffer, const std::size_t offset)
+{
+    T value;
+    std::memcpy(&value, buffer.data() + offset, sizeof(T));
+    return value;
+}
+
+// A slot of the binary response format, see util/json_binary_renderer.hpp
+struct BinarySlot
+{
+    std::uint32_t type;
+    std::uint32_t size;
+    std::uint64_t payload;
+};
+
+const constexpr std::size_t SLOT_SIZE = 16;
+
+bool ReadSlot(const std::string &buffer, const std::size_t offset, BinarySlot &slot)
+{
+    if (offset % 8 != 0 || offset > buffer.size() || buffer.size() - offset < SLOT_SIZE)
+        return false;
+    slot.type = Read<std::uint32_t>(buffer, offset);
+    slot.size = Read<std::uint32_t>(buffer, offset + 4);
+    slot.payload = Read<std::uint64_t>(buffer, offset + 8);
+    return true;
+}
+
+// Checks that size elements of element_size bytes at the payload of the slot are in the buffer
+bool HasPayload(const std::string &buffer, const BinarySlot &slot, const std::size_t element_size)
+{
+    return slot.payload <= buffer.size() &&
+           slot.size <= (buffer.size() - slot.payload) / element_size;
+}
+
+bool ReadString(const std::string &buffer, const BinarySlot &slot, std::string &value)
+{
+    if (slot.type != util::json::BINARY_STRING || !HasPayload(buffer, slot, 1))
+        return false;
+    value.assign(buffer.data() + slot.payload, slot.size);
+    return true;
+}
+
+bool FindMember(const std::string &buffer,
+                const BinarySlot &object,
+                const std::string &key,
+                BinarySlot &member)
+{
+    if (object.type != util::json::BINARY_OBJECT || !HasPayload(buffer, object, 2 * SLOT_SIZE))
+        return false;
+    for (std::size_t index = 0; index < object.size; ++index)
+    {
+        BinarySlot name;
+        std::string value;
+        const auto offset = object.payload + 2 * SLOT_SIZE * index;
+        if (ReadSlot(buffer, offset, name) && ReadString(buffer, name, value) && value == key)
+            return ReadSlot(buffer, offset + SLOT_SIZE, member);
+    }
+    return false;
+}
+
+// Rows without a single route are arrays of nulls instead of number arrays
+bool ReadMatrix(const std::string &buffer,
+                const BinarySlot &matrix,
+                const std::size_t number_of_rows,
+                const std::size_t number_of_columns,
+                std::vector<double> &values)
+{
+    if (matrix.type != util::json::BINARY_ARRAY || matrix.size != number_of_rows ||
+        !HasPayload(buffer, matrix, SLOT_SIZE))
+        return false;
+
+    values.resize(number_of_rows * number_of_columns);
+    for (std::size_t row = 0; row < number_of_rows; ++row)
+    {
+        BinarySlot slot;
+        if (!ReadSlot(buffer, matrix.payload + SLOT_SIZE * row, slot) ||
+            slot.size != number_of_columns)
+            return false;
+
+        auto *row_values = values.data() + row * number_of_columns;
+        if (slot.type == util::json::BINARY_NUMBER_ARRAY && HasPayload(buffer, slot, 8))
+        {
+            std::memcpy(row_values, buffer.data() + slot.payload, number_of_columns * 8);
+        }
+        else if (slot.type == util::json::BINARY_ARRAY && HasPayload(buffer, slot, SLOT_SIZE))
+        {
+            for (std::size_t column = 0; column < number_of_columns; ++column)
+            {
+                BinarySlot cell;
+                if (!ReadSlot(buffer, slot.payload + SLOT_SIZE * column, cell) ||
+                    cell.type != util::json::BINARY_NULL)
+                    return false;
+                row_values[column] = std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+boost::optional<engine::Hint> ParseHint(const std::string &encoded)
+{
+    if (!encoded.empty() && encoded.front() == engine::COMPACT_HINT_PREFIX)
+        return engine::Hint::FromCompactBase64(encoded);
+    if (encoded.size() == engine::ENCODED_HINT_SIZE)
+        return engine::Hint::FromBase64(encoded);
+    return boost::none;
+}
+
+// A persistent HTTP/1.1 connection to a backend, every thread of the coordinator has its own
+class BackendConnection
+{
+  public:
+    explicit BackendConnection(const TableBackend &backend) : backend(backend), socket(io_service)
+    {
+    }
+
+    // Returns the HTTP status of the reply, 0 if the backend could not be reached
+    unsigned Post(const std::string &target,
+                  const std::string &body,
+                  const unsigned timeout,
+                  std::string &response)
+    {
+        // the backend closes idle persistent connections, which only shows once we send
+        const bool reused = socket.is_open();
+        const auto status = Exchange(target, body, timeout, response);
+        if (status == 0 && reused)
+            return Exchange(target, body, timeout, response);
+        return status;
+    }
+
+  private:
+    unsigned Exchange(const std::string &target,
+                      const std::string &body,
+                      const unsigned timeout,
+                      std::string &response)
+    {
+        try
+        {
+            if (!socket.is_open())
+            {
+                boost::asio::ip::tcp::resolver resolver(io_service);
+                boost::asio::connect(socket, resolver.resolve({backend.host, backend.port}));
+                input.consume(input.size());
+            }
+
+            std::string head = "POST " + target + " HTTP/1.1\r\nHost: " + backend.host +
+                               "\r\nContent-Type: " + api::BINARY_PARAMETERS_CONTENT_TYPE +
+                               "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+            if (timeout > 0)
+                head += "X-OSRM-Timeout: " + std::to_string(timeout) + "\r\n";
+            head += "\r\n";
+            const std::array<boost::asio::const_buffer, 2> request = {
+                {boost::asio::buffer(head), boost::asio::buffer(body)}};
+            boost::asio::write(socket, request);
+
+            return ReadResponse(response);
+        }
+        catch (const std::exception &)
+        {
+            boost::system::error_code ignored;
+            socket.close(ignored);
+            return 0;
+        }
+    }
+
+    unsigned ReadResponse(std::string &response)
+    {
+        boost::asio::read_until(socket, input, "\r\n\r\n");
+        std::istream head(&input);
+        std::string version;
+        unsigned status = 0;
+        head >> version >> status;
+        if (!head || !boost::starts_with(version, "HTTP/"))
+            throw util::exception("Malformed reply of " + backend.host + SOURCE_REF);
+
+        std::size_t content_length = std::numeric_limits<std::size_t>::max();
+        bool chunked = false;
+        bool close = false;
+        std::string line;
+        std::getline(head, line);
+        while (std::getline(head, line) && line != "\r")
+        {
+            const auto colon = line.find(':');
+            if (colon == std::string::npos)
+                continue;
+            const auto name = line.substr(0, colon);
+            const auto value = boost::trim_copy(line.substr(colon + 1));
+            if (boost::iequals(name, "Content-Length"))
+                content_length = std::stoul(value);
+            else if (boost::iequals(name, "Transfer-Encoding"))
+                chunked = boost::icontains(value, "chunked");
+            else if (boost::iequals(name, "Connection"))
+                close = boost::icontains(value, "close");
+        }
+
+        response.clear();
+        if (chunked)
+        {
+            for (std::size_t size = 1; size > 0;)
+            {
+                boost::asio::read_until(socket, input, "\r\n");
+                std::getline(head, line);
+                size = std::stoul(line, nullptr, 16);
+                // the chunk is followed by a line break
+                ReadExactly(size + 2, response);
+                response.resize(response.size() - 2);
+            }
+        }
+        else if (content_length != std::numeric_limits<std::size_t>::max())
+        {
+            ReadExactly(content_length, response);
+        }
+        else
+        {
+            boost::system::error_code error;
+            boost::asio::read(socket, input, boost::asio::transfer_all(), error);
+            if (error != boost::asio::error::eof)
+                throw boost::system::system_error(error);
+            ReadExactly(input.size(), response);
+            close = true;
+        }
+
+        if (close)
+            socket.close();
+        return status;
+    }
+
+    void ReadExactly(const std::size_t size, std::string &out)
+    {
+        if (input.size() < size)
+            boost::asio::read(socket, input, boost::asio::transfer_exactly(size - input.size()));
+        out.append(boost::asio::buffer_cast<const char *>(input.data()), size);
+        input.consume(size);
+    }
+
+    const TableBackend &backend;
+    boost::asio::io_service io_service;
+    boost::asio::ip::tcp::socket socket;
+    boost::asio::streambuf input;
+};
+
+enum class BlockOutcome
+{
+    Done,
+    Retry,
+    Failed
+};
+
+BlockOutcome SearchBlock(BackendConnection &connection,
+                         const TableBackend &backend,
+                         const TableCoordinatorConfig &config,
+                         const std::string &body,
+                         const TableBlock &block,
+                         const std::size_t number_of_columns,
+                         TableBlockResult &result,
+                         std::string &error)
+{
+    const auto rows = "rows " + std::to_string(block.first_row) + " to " +
+                      std::to_string(block.first_row + block.number_of_rows - 1);
+    const auto name = backend.host + ":" + backend.port;
+
+    std::string response;
+    const auto status =
+        connection.Post(makeTableTarget(config, block), body, config.block_timeout, response);
+    if (status == 0)
+    {
+        error = "Could not reach " + name + " for " + rows;
+        return BlockOutcome::Retry;
+    }
+    // errors found before the options are parsed are answered in JSON
+    if (!decodeTableBlock(response, block, number_of_columns, result))
+    {
+        error = name + " answered " + rows + " with status " + std::to_string(status) + ": " +
+                response.substr(0, 200);
+        return status >= 500 ? BlockOutcome::Retry : BlockOutcome::Failed;
+    }
+    if (result.code == "Ok")
+        return BlockOutcome::Done;
+
+    error = name + " answered " + rows + " with " + result.code + ": " + result.message;
+    return result.code == "TooBusy" || result.code == "Timeout" ? BlockOutcome::Retry
+                                                                : BlockOutcome::Failed;
+}
+
+// Waits a little longer after every failed attempt, overloaded backends catch up in between
+void BackOff(const unsigned attempts)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(100 * attempts * attempts));
+}
+}
+
+std::vector<TableBlock> planTableBlocks(const std::size_t number_of_rows,
+                                        const std::size_t rows_per_block)
+{
+    const auto block_size = std::max<std::size_t>(1, rows_per_block);
+    std::vector<TableBlock> blocks;
+    blocks.reserve((number_of_rows + block_size - 1) / block_size);
+    for (std::size_t first_row = 0; first_row < number_of_rows; first_row += block_size)
+    {
+        blocks.push_back({first_row, std::min(block_size, number_of_rows - first_row)});
+    }
+    return blocks;
+}
+
+std::string encodeTableBody(const std::vector<util::Coordinate> &coordinates,
+                            const std::vector<boost::optional<engine::Hint>> &hints)
+{
+    const bool has_hints = std::any_of(
+        hints.begin(), hints.end(), [](const auto &hint) { return static_cast<bool>(hint); });
+    BOOST_ASSERT(!has_hints || hints.size() == coordinates.size());
+
+    std::string body;
+    body.reserve(2 * sizeof(std::uint32_t) +
+                 coordinates.size() *
+                     (sizeof(util::Coordinate) + (has_hints ? sizeof(engine::Hint) : 0)));
+    Append(body, static_cast<std::uint32_t>(coordinates.size()));
+    Append(body, static_cast<std::uint32_t>(has_hints ? api::BINARY_HINTS : 0));
+    for (const auto &coordinate : coordinates)
+    {
+        Append(body, coordinate);
+    }
+    if (has_hints)
+    {
+        for (const auto &hint : hints)
+        {
+            if (hint)
+                Append(body, *hint);
+            else
+                body.append(sizeof(engine::Hint), '\0');
+        }
+    }
+    return body;
+}
+
+std::string makeTableTarget(const TableCoordinatorConfig &config, const TableBlock &block)
+{
+    std::string target = "/table/v1/" + config.profile + "/.json?sources=";
+    for (std::size_t row = 0; row < block.number_of_rows; ++row)
+    {
+        if (row > 0)
+            target += ';';
+        target += std::to_string(block.first_row + row);
+    }
+    target += config.distances ? "&annotations=duration,distance" : "&annotations=duration";
+    // only the first block snaps the coordinates, its hints are sent along with the others
+    if (block.first_row > 0)
+        target += "&generate_hints=false";
+    target += "&output_format=binary";
+    return target;
+}
+
+bool decodeTableBlock(const std::string &response,
+                      const TableBlock &block,
+                      const std::size_t number_of_columns,
+                      TableBlockResult &result)
+{
+    result = TableBlockResult();
+
+    BinarySlot root;
+    if (response.size() < 8 || response.compare(0, 4, "OSRM") != 0 ||
+        Read<std::uint32_t>(response, 4) != util::json::BINARY_FORMAT_VERSION ||
+        !ReadSlot(response, 8, root))
+        return false;
+
+    BinarySlot code;
+    if (!FindMember(response, root, "code", code) || !ReadString(response, code, result.code))
+        return false;
+    if (result.code != "Ok")
+    {
+        BinarySlot message;
+        if (FindMember(response, root, "message", message))
+            ReadString(response, message, result.message);
+        return true;
+    }
+
+    BinarySlot durations;
+    if (!FindMember(response, root, "durations", durations) ||
+        !ReadMatrix(
+            response, durations, block.number_of_rows, number_of_columns, result.durations))
+        return false;
+
+    BinarySlot distances;
+    if (FindMember(response, root, "distances", distances) &&
+        !ReadMatrix(
+            response, distances, block.number_of_rows, number_of_columns, result.distances))
+        return false;
+
+    BinarySlot destinations;
+    if (FindMember(response, root, "destinations", destinations) &&
+        destinations.type == util::json::BINARY_ARRAY &&
+        destinations.size == number_of_columns && HasPayload(response, destinations, SLOT_SIZE))
+    {
+        result.hints.reserve(number_of_columns);
+        for (std::size_t column = 0; column < number_of_columns; ++column)
+        {
+            BinarySlot waypoint, hint;
+            std::string encoded;
+            if (ReadSlot(response, destinations.payload + SLOT_SIZE * column, waypoint) &&
+                FindMember(response, waypoint, "hint", hint) &&
+                ReadString(response, hint, encoded))
+                result.hints.push_back(ParseHint(encoded));
+            else
+                result.hints.push_back(boost::none);
+        }
+    }
+    return true;
+}
+
+TableCoordinator::TableCoordinator(TableCoordinatorConfig config_) : config(std::move(config_))
+{
+    if (config.backends.empty())
+        throw util::exception("A distributed table needs at least one backend" + SOURCE_REF);
+    config.requests_per_backend = std::max(1u, config.requests_per_backend);
+    config.max_attempts = std::max(1u, config.max_attempts);
+}
+
+void TableCoordinator::Run(const std::vector<util::Coordinate> &coordinates,
+                           const BlockHandler &handle_block)
+{
+    const auto blocks = planTableBlocks(coordinates.size(), config.rows_per_block);
+    if (blocks.empty())
+        return;
+    const auto number_of_columns = coordinates.size();
+
+    // The first block snaps all coordinates as its destinations, the backends take turns
+    std::string body = encodeTableBody(coordinates, {});
+    TableBlockResult first_result;
+    for (unsigned attempt = 0;; ++attempt)
+    {
+        const auto &backend = config.backends[attempt % config.backends.size()];
+        BackendConnection connection(backend);
+        std::string error;
+        const auto outcome = SearchBlock(connection,
+                                         backend,
+                                         config,
+                                         body,
+                                         blocks.front(),
+                                         number_of_columns,
+                                         first_result,
+                                         error);
+        if (outcome == BlockOutcome::Done)
+            break;
+        if (outcome == BlockOutcome::Failed || attempt + 1 >= config.max_attempts)
+            throw util::exception(error + SOURCE_REF);
+        util::Log(logWARNING) << error << ", retrying";
+        BackOff(attempt + 1);
+    }
+    if (first_result.hints.size() != coordinates.size())
+        throw util::exception("The first block of the table has no hints for the coordinates" +
+                              SOURCE_REF);
+    handle_block(blocks.front(), first_result);
+
+    body = encodeTableBody(coordinates, first_result.hints);
+    first_result = TableBlockResult();
+
+    struct PendingBlock
+    {
+        TableBlock block;
+        unsigned attempts;
+    };
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<PendingBlock> pending;
+    std::size_t in_flight = 0;
+    std::string failure;
+    std::exception_ptr handler_exception;
+    for (auto block = blocks.begin() + 1; block != blocks.end(); ++block)
+        pending.push_back({*block, 0});
+
+    // every backend works on requests_per_backend blocks at once, which keeps them busy
+    // without queueing up requests on a backend that is slower than the others
+    const auto work = [&](const TableBackend &backend) {
+        BackendConnection connection(backend);
+        unsigned backoff = 0;
+        while (true)
+        {
+            if (backoff > 0)
+                BackOff(backoff);
+
+            PendingBlock next;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] {
+                    return !failure.empty() || handler_exception || !pending.empty() ||
+                           in_flight == 0;
+                });
+                if (!failure.empty() || handler_exception || pending.empty())
+                    return;
+                next = pending.front();
+                pending.pop_front();
+                ++in_flight;
+            }
+
+            TableBlockResult result;
+            std::string error;
+            const auto outcome = SearchBlock(
+                connection, backend, config, body, next.block, number_of_columns, result, error);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            --in_flight;
+            backoff = 0;
+            if (outcome == BlockOutcome::Done)
+            {
+                try
+                {
+                    handle_block(next.block, result);
+                }
+                catch (...)
+                {
+                    handler_exception = std::current_exception();
+                }
+            }
+            else if (outcome == BlockOutcome::Retry && ++next.attempts < config.max_attempts)
+            {
+                util::Log(logWARNING) << error << ", retrying";
+                pending.push_back(next);
+                backoff = next.attempts;
+            }
+            else
+            {
+                failure = error;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (const auto &backend : config.backends)
+    {
+        for (unsigned request = 0; request < config.requests_per_backend; ++request)
+        {
+            workers.emplace_back(work, std::cref(backend));
+        }
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    if (handler_exception)
+        std::rethrow_exception(handler_exception);
+    if (!failure.empty())
+        throw util::exception(failure + SOURCE_REF);
+}
+}
+}
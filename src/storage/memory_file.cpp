@@ -0,0 +1,162 @@
+#include "storage/memory_file.hpp"
+#include "storage/storage.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+
+#include <boost/crc.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/format.hpp>
+
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace osrm
+{
+namespace storage
+{
+
+namespace
+{
+// Blocks are aligned relative to the address of the data, which has to be the same in every
+// mapping of the file
+std::uint64_t alignToPage(const std::uint64_t offset)
+{
+    const std::uint64_t page_size = boost::iostreams::mapped_file::alignment();
+    return (offset + page_size - 1) / page_size * page_size;
+}
+}
+
+bool isMemoryFileCurrent(const StorageConfig &config, const boost::filesystem::path &memory_file)
+{
+    if (!boost::filesystem::exists(memory_file))
+    {
+        return false;
+    }
+
+    const auto memory_file_time = boost::filesystem::last_write_time(memory_file);
+    const auto input_paths = config.GetInputPaths();
+    return std::none_of(input_paths.begin(), input_paths.end(), [&](const auto &path) {
+        return boost::filesystem::exists(path) &&
+               boost::filesystem::last_write_time(path) > memory_file_time;
+    });
+}
+
+bool readMemoryFileHeader(const char *file, const std::size_t size, MemoryFileHeader &header)
+{
+    if (size < sizeof(MemoryFileHeader))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, file, sizeof(header));
+    if (!header.fingerprint.IsValid() ||
+        !header.fingerprint.IsDataCompatible(util::FingerPrint::GetValid()) ||
+        header.format != MemoryFileHeader::FORMAT || header.data_offset < sizeof(header) ||
+        size < header.data_offset + header.layout.GetSizeOfLayout())
+    {
+        return false;
+    }
+    return std::all_of(std::begin(header.blocks), std::end(header.blocks), [&](const auto &block) {
+        return block.offset >= header.data_offset && block.offset + block.size <= size;
+    });
+}
+
+void writeMemoryFile(const StorageConfig &config, const boost::filesystem::path &memory_file)
+{
+    util::Log() << "Writing memory file " << memory_file;
+
+    // the data comes from the .osrm files even if config is set up to read this memory file
+    auto input_config = config;
+    input_config.memory_file.clear();
+    Storage storage(input_config);
+
+    MemoryFileHeader header;
+    header.fingerprint = util::FingerPrint::GetValid();
+    header.data_offset = alignToPage(sizeof(header));
+    storage.PopulateLayout(header.layout);
+    header.format = MemoryFileHeader::FORMAT;
+
+    auto temporary = memory_file;
+    temporary += boost::filesystem::unique_path(".%%%%-%%%%-%%%%.tmp");
+    try
+    {
+        boost::iostreams::mapped_file_params parameters(temporary.string());
+        parameters.flags = boost::iostreams::mapped_file::readwrite;
+        parameters.new_file_size = header.data_offset + header.layout.GetSizeOfLayout();
+
+        boost::iostreams::mapped_file region(parameters);
+        const auto memory = header.layout.GetContiguousMemory(region.data() + header.data_offset);
+        storage.PopulateData(header.layout, memory);
+
+        tbb::parallel_for(0, static_cast<int>(DataLayout::NUM_BLOCKS), [&](const int index) {
+            const auto block = static_cast<DataLayout::BlockID>(index);
+            const auto begin = static_cast<char *>(
+                header.layout.GetAlignedBlockPtr(memory[DataLayout::GetPart(block)], block));
+            header.blocks[block].offset = begin - region.data();
+            header.blocks[block].size = header.layout.GetBlockSize(block);
+            header.blocks[block].checksum = checksumBlock(begin, header.blocks[block].size);
+        });
+        std::memcpy(region.data(), &header, sizeof(header));
+        region.close();
+
+        boost::filesystem::rename(temporary, memory_file);
+    }
+    catch (const std::exception &exc)
+    {
+        boost::system::error_code ignored;
+        boost::filesystem::remove(temporary, ignored);
+        throw util::exception(boost::str(boost::format("Writing memory file %1% failed: %2%") %
+                                         memory_file % exc.what()) +
+                              SOURCE_REF);
+    }
+}
+
+void openMemoryFile(const StorageConfig &config,
+                    const boost::filesystem::path &memory_file,
+                    boost::iostreams::mapped_file_source &mapped_memory,
+                    MemoryFileHeader &header)
+{
+    const auto open = [&] {
+        try
+        {
+            mapped_memory.open(memory_file.string());
+        }
+        catch (const std::exception &exc)
+        {
+            throw util::exception(boost::str(boost::format("File %1% mapping failed: %2%") %
+                                             memory_file % exc.what()) +
+                                  SOURCE_REF);
+        }
+        return readMemoryFileHeader(mapped_memory.data(), mapped_memory.size(), header);
+    };
+
+    if (!isMemoryFileCurrent(config, memory_file))
+    {
+        writeMemoryFile(config, memory_file);
+    }
+    if (!open())
+    {
+        util::Log(logWARNING) << "Memory file " << memory_file
+                              << " is incompatible or truncated, writing it again";
+        mapped_memory.close();
+        writeMemoryFile(config, memory_file);
+        if (!open())
+        {
+            throw util::exception("Memory file " + memory_file.string() + " is invalid" +
+                                  SOURCE_REF);
+        }
+    }
+}
+
+std::uint32_t checksumBlock(const char *begin, const std::uint64_t size)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(begin, size);
+    return crc.checksum();
+}
+}
+}
@@ -1,18 +1,23 @@
 #include "storage/storage.hpp"
 
 #include "storage/io.hpp"
+#include "storage/memory_file.hpp"
 #include "storage/shared_datatype.hpp"
 #include "storage/shared_memory.hpp"
 #include "storage/shared_memory_ownership.hpp"
 #include "storage/shared_monitor.hpp"
+#include "storage/shared_segments.hpp"
 
 #include "contractor/files.hpp"
 #include "contractor/query_graph.hpp"
 
 #include "customizer/edge_based_graph.hpp"
+#include "customizer/files.hpp"
+#include "customizer/landmarks.hpp"
 
 #include "extractor/class_data.hpp"
 #include "extractor/compressed_edge_container.hpp"
+#include "extractor/conditional_turn_mask.hpp"
 #include "extractor/edge_based_edge.hpp"
 #include "extractor/files.hpp"
 #include "extractor/guidance/turn_instruction.hpp"
@@ -30,14 +35,20 @@
 #include "engine/datafacade/datafacade_base.hpp"
 
 #include "util/coordinate.hpp"
+#include "util/delta_vector.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/fingerprint.hpp"
+#include "util/huge_pages.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/numa.hpp"
 #include "util/packed_vector.hpp"
-#include "util/range_table.hpp"
+#include "util/phase_profiler.hpp"
+#include "util/search_edge.hpp"
 #include "util/static_graph.hpp"
 #include "util/static_rtree.hpp"
+#include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
 #include "util/vector_view.hpp"
 
@@ -51,13 +62,21 @@
 #include <boost/interprocess/sync/file_lock.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
 #include <cstdint>
+#include <exception>
 
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <new>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace osrm
 {
@@ -71,9 +90,26 @@ using EdgeBasedGraph = util::StaticGraph<extractor::EdgeBasedEdge::EdgeData>;
 
 using Monitor = SharedMonitor<SharedDataTimestamp>;
 
+namespace
+{
+util::DeltaVector<NodeID> encodeGeometryNodes(const std::vector<NodeID> &nodes)
+{
+    util::DeltaVector<NodeID> encoded_nodes;
+    for (const auto node : nodes)
+    {
+        encoded_nodes.push_back(node);
+    }
+    return encoded_nodes;
+}
+}
+
 Storage::Storage(StorageConfig config_) : config(std::move(config_)) {}
 
-int Storage::Run(int max_wait)
+int Storage::Run(int max_wait,
+                 bool use_huge_pages,
+                 bool interleave_numa_nodes,
+                 bool only_metric,
+                 bool lock_memory)
 {
     BOOST_ASSERT_MSG(config.IsValid(), "Invalid storage config");
 
@@ -106,41 +142,140 @@ int Storage::Run(int max_wait)
     }
 #endif
 
-    // Get the next region ID and time stamp without locking shared barriers.
+    // Get the next region IDs and time stamp without locking shared barriers.
     // Because of datastore_lock the only write operation can occur sequentially later.
-    Monitor monitor(SharedDataTimestamp{REGION_NONE, 0});
-    auto in_use_region = monitor.data().region;
+    Monitor monitor(SharedDataTimestamp{REGION_NONE, REGION_NONE, 0});
+    auto in_use_static_region = monitor.data().static_region;
+    auto in_use_metric_region = monitor.data().metric_region;
     auto next_timestamp = monitor.data().timestamp + 1;
-    auto next_region =
-        in_use_region == REGION_2 || in_use_region == REGION_NONE ? REGION_1 : REGION_2;
 
-    // ensure that the shared memory region we want to write to is really removed
-    // this is only needef for failure recovery because we actually wait for all clients
-    // to detach at the end of the function
-    if (storage::SharedMemory::RegionExists(next_region))
+    if (only_metric && (in_use_static_region == REGION_NONE ||
+                        !storage::SharedMemory::RegionExists(in_use_static_region)))
     {
-        util::Log(logWARNING) << "Old shared memory region " << regionToString(next_region)
-                              << " still exists.";
-        util::UnbufferedLog() << "Retrying removal... ";
-        storage::SharedMemory::Remove(next_region);
-        util::UnbufferedLog() << "ok.";
+        util::Log(logWARNING) << "No data is loaded yet, loading the static part as well";
+        only_metric = false;
     }
 
-    util::Log() << "Loading data into " << regionToString(next_region);
+    auto next_static_region = in_use_static_region == REGION_1 ? REGION_2 : REGION_1;
+    auto next_metric_region = in_use_metric_region == REGION_3 ? REGION_4 : REGION_3;
+    // A metric update keeps the static region that is in use
+    if (only_metric)
+    {
+        next_static_region = in_use_static_region;
+    }
+
+    // ensure that the shared memory regions we want to write to are really removed
+    // this is only needed for failure recovery because the old regions are marked for removal
+    // at the end of the function
+    const auto remove_old_region = [](const SharedDataType region) {
+        if (storage::SharedMemory::RegionExists(region))
+        {
+            util::Log(logWARNING) << "Old shared memory region " << regionToString(region)
+                                  << " still exists.";
+            util::UnbufferedLog() << "Retrying removal... ";
+            storage::SharedMemory::Remove(region);
+            util::UnbufferedLog() << "ok.";
+        }
+    };
+    if (!only_metric)
+    {
+        remove_old_region(next_static_region);
+    }
+    remove_old_region(next_metric_region);
 
     // Populate a memory layout into stack memory
     DataLayout layout;
-    PopulateLayout(layout);
+    {
+        util::ProfilePhase phase("layout");
+        PopulateLayout(layout);
+    }
 
-    // Allocate shared memory block
-    auto regions_size = sizeof(layout) + layout.GetSizeOfLayout();
-    util::Log() << "Allocating shared memory of " << regions_size << " bytes";
-    auto data_memory = makeSharedMemory(next_region, regions_size);
+    std::unique_ptr<storage::SharedMemory> static_memory;
+    if (only_metric)
+    {
+        // The sizes of the static blocks are the only thing that can be checked, the new metric
+        // has to be computed from the same static data
+        static_memory = makeSharedMemory(in_use_static_region);
+        const auto &static_layout = *reinterpret_cast<DataLayout *>(static_memory->Ptr());
+        for (const auto block : util::irange<std::size_t>(0, DataLayout::NUM_BLOCKS))
+        {
+            if (DataLayout::GetPart(static_cast<DataLayout::BlockID>(block)) ==
+                    DataLayout::STATIC_PART &&
+                (static_layout.num_entries[block] != layout.num_entries[block] ||
+                 static_layout.entry_size[block] != layout.entry_size[block]))
+            {
+                throw util::exception("Block " + std::string(block_id_to_name[block]) + " of " +
+                                      regionToString(in_use_static_region) +
+                                      " does not match the data files, the metric can only be "
+                                      "updated if the static data is unchanged" +
+                                      SOURCE_REF);
+            }
+        }
 
-    // Copy memory layout to shared memory and populate data
-    char *shared_memory_ptr = static_cast<char *>(data_memory->Ptr());
-    memcpy(shared_memory_ptr, &layout, sizeof(layout));
-    PopulateData(layout, shared_memory_ptr + sizeof(layout));
+        util::Log() << "Loading the metric into " << regionToString(next_metric_region)
+                    << ", keeping the static data in " << regionToString(in_use_static_region);
+    }
+    else
+    {
+        util::Log() << "Loading data into " << regionToString(next_static_region) << " and "
+                    << regionToString(next_metric_region);
+    }
+
+    // The policy of the thread covers pages locked when a region is mapped, the one of the
+    // region all pages touched later
+    auto interleave =
+        interleave_numa_nodes ? std::make_unique<util::numa::ThreadInterleave>() : nullptr;
+
+    // Allocate a shared memory block for a part, the layout is copied to its start
+    const auto allocate = [&](const SharedDataType region, const DataLayout::Part part) {
+        auto region_size = sizeof(layout) + layout.GetSizeOfPart(part);
+        util::Log() << "Allocating shared memory of " << region_size << " bytes for "
+                    << regionToString(region);
+        auto data_memory = makeSharedMemory(region, region_size, use_huge_pages, lock_memory);
+        if (interleave_numa_nodes)
+        {
+            if (interleave->IsActive() &&
+                util::numa::interleaveMemory(data_memory->Ptr(), region_size))
+            {
+                util::Log() << "Shared memory is interleaved over all NUMA nodes";
+            }
+            else
+            {
+                util::Log(logWARNING) << "Could not interleave shared memory over NUMA nodes";
+            }
+        }
+        memcpy(data_memory->Ptr(), &layout, sizeof(layout));
+        return data_memory;
+    };
+
+    util::ProfilePhase allocation_phase("allocation");
+    if (!only_metric)
+    {
+        static_memory = allocate(next_static_region, DataLayout::STATIC_PART);
+    }
+    auto metric_memory = allocate(next_metric_region, DataLayout::METRIC_PART);
+    allocation_phase.Stop();
+
+    // Without a new static region only the metric part is populated
+    DataLayout::Memory memory{
+        {only_metric ? nullptr : static_cast<char *>(static_memory->Ptr()) + sizeof(layout),
+         static_cast<char *>(metric_memory->Ptr()) + sizeof(layout)}};
+    {
+        util::ProfilePhase phase("loading data");
+        PopulateData(layout, memory);
+    }
+    interleave.reset();
+
+    if (use_huge_pages)
+    {
+        if (!only_metric)
+        {
+            util::Log() << "Static shared memory is backed by "
+                        << util::describePages(static_memory->Ptr());
+        }
+        util::Log() << "Metric shared memory is backed by "
+                    << util::describePages(metric_memory->Ptr());
+    }
 
     { // Lock for write access shared region mutex
         boost::interprocess::scoped_lock<Monitor::mutex_type> lock(monitor.get_mutex(),
@@ -156,8 +291,9 @@ int Storage::Run(int max_wait)
                     << " seconds. Removing locked block and creating a new one. All currently "
                        "attached processes will not receive notifications and must be restarted";
                 Monitor::remove();
-                in_use_region = REGION_NONE;
-                monitor = Monitor(SharedDataTimestamp{REGION_NONE, 0});
+                in_use_static_region = REGION_NONE;
+                in_use_metric_region = REGION_NONE;
+                monitor = Monitor(SharedDataTimestamp{REGION_NONE, REGION_NONE, 0});
             }
         }
         else
@@ -165,35 +301,63 @@ int Storage::Run(int max_wait)
             lock.lock();
         }
 
-        // Update the current region ID and timestamp
-        monitor.data().region = next_region;
+        // Update the current region IDs and timestamp
+        monitor.data().static_region = next_static_region;
+        monitor.data().metric_region = next_metric_region;
         monitor.data().timestamp = next_timestamp;
+
+        std::vector<SharedSegment> new_segments;
+        if (!only_metric)
+        {
+            new_segments.push_back(SharedSegment{static_memory->SegmentID(),
+                                                 next_static_region,
+                                                 next_timestamp,
+                                                 static_memory->Size()});
+        }
+        new_segments.push_back(SharedSegment{
+            metric_memory->SegmentID(), next_metric_region, next_timestamp, metric_memory->Size()});
+        if (!recordSegments(monitor.data(), new_segments))
+        {
+            util::Log(logWARNING) << "More than " << SharedDataTimestamp::MAX_SEGMENTS
+                                  << " shared memory segments are in use, the oldest ones are no "
+                                     "longer counted";
+        }
     }
 
     util::Log() << "All data loaded. Notify all client about new data in "
-                << regionToString(next_region) << " with timestamp " << next_timestamp;
+                << regionToString(next_static_region) << " and "
+                << regionToString(next_metric_region) << " with timestamp " << next_timestamp;
     monitor.notify_all();
 
     // SHMCTL(2): Mark the segment to be destroyed. The segment will actually be destroyed
-    // only after the last process detaches it.
-    if (in_use_region != REGION_NONE && storage::SharedMemory::RegionExists(in_use_region))
+    // only after the last process detaches it. Clients still answering queries on the old
+    // regions keep them alive while they drain, there is no need to wait for them here.
+    std::vector<SharedDataType> old_regions{in_use_metric_region};
+    if (!only_metric)
     {
-        util::UnbufferedLog() << "Marking old shared memory region "
-                              << regionToString(in_use_region) << " for removal... ";
-
-        // aquire a handle for the old shared memory region before we mark it for deletion
-        // we will need this to wait for all users to detach
-        auto in_use_shared_memory = makeSharedMemory(in_use_region);
-
-        storage::SharedMemory::Remove(in_use_region);
-        util::UnbufferedLog() << "ok.";
-
-        util::UnbufferedLog() << "Waiting for clients to detach... ";
-        in_use_shared_memory->WaitForDetach();
-        util::UnbufferedLog() << " ok.";
+        old_regions.push_back(in_use_static_region);
+    }
+    for (const auto region : old_regions)
+    {
+        if (region != REGION_NONE && storage::SharedMemory::RegionExists(region))
+        {
+            util::UnbufferedLog() << "Marking old shared memory region " << regionToString(region)
+                                  << " for removal... ";
+            storage::SharedMemory::Remove(region);
+            util::UnbufferedLog() << "ok.";
+        }
     }
 
-    util::Log() << "All clients switched.";
+    SharedGenerations generations;
+    {
+        boost::interprocess::scoped_lock<Monitor::mutex_type> lock(monitor.get_mutex());
+        generations = countGenerations(monitor.data());
+    }
+    // the new dataset is one of the generations
+    const auto draining = std::max<std::uint64_t>(generations.generations, 1) - 1;
+    util::Log() << "All data published, " << draining
+                << " older datasets are still in use by clients, " << generations.bytes
+                << " bytes of shared memory are in use.";
 
     return EXIT_SUCCESS;
 }
@@ -205,6 +369,15 @@ int Storage::Run(int max_wait)
  */
 void Storage::PopulateLayout(DataLayout &layout)
 {
+    if (!config.memory_file.empty())
+    {
+        boost::iostreams::mapped_file_source mapped_memory;
+        MemoryFileHeader header;
+        openMemoryFile(config, config.memory_file, mapped_memory, header);
+        layout = header.layout;
+        return;
+    }
+
     {
         auto absolute_file_index_path =
             boost::filesystem::absolute(config.GetPath(".osrm.fileIndex"));
@@ -235,15 +408,7 @@ void Storage::PopulateLayout(DataLayout &layout)
         io::FileReader edges_file(config.GetPath(".osrm.edges"), io::FileReader::VerifyFingerprint);
         const auto number_of_original_edges = edges_file.ReadElementCount64();
 
-        // note: settings this all to the same size is correct, we extract them from the same struct
-        layout.SetBlockSize<util::guidance::TurnBearing>(DataLayout::PRE_TURN_BEARING,
-                                                         number_of_original_edges);
-        layout.SetBlockSize<util::guidance::TurnBearing>(DataLayout::POST_TURN_BEARING,
-                                                         number_of_original_edges);
-        layout.SetBlockSize<extractor::guidance::TurnInstruction>(DataLayout::TURN_INSTRUCTION,
-                                                                  number_of_original_edges);
-        layout.SetBlockSize<LaneDataID>(DataLayout::LANE_DATA_ID, number_of_original_edges);
-        layout.SetBlockSize<EntryClassID>(DataLayout::ENTRY_CLASSID, number_of_original_edges);
+        layout.SetBlockSize<extractor::TurnData>(DataLayout::TURN_DATA, number_of_original_edges);
     }
 
     {
@@ -271,6 +436,7 @@ void Storage::PopulateLayout(DataLayout &layout)
                                                                     num_nodes);
         layout.SetBlockSize<contractor::QueryGraph::EdgeArrayEntry>(DataLayout::CH_GRAPH_EDGE_LIST,
                                                                     num_edges);
+        layout.SetBlockSize<util::SearchEdge>(DataLayout::CH_GRAPH_SEARCH_EDGE_LIST, num_edges);
     }
     else
     {
@@ -279,6 +445,7 @@ void Storage::PopulateLayout(DataLayout &layout)
                                                                     0);
         layout.SetBlockSize<contractor::QueryGraph::EdgeArrayEntry>(DataLayout::CH_GRAPH_EDGE_LIST,
                                                                     0);
+        layout.SetBlockSize<util::SearchEdge>(DataLayout::CH_GRAPH_SEARCH_EDGE_LIST, 0);
     }
 
     // load rsearch tree size
@@ -357,9 +524,28 @@ void Storage::PopulateLayout(DataLayout &layout)
         const auto number_of_geometries_indices = reader.ReadVectorSize<unsigned>();
         layout.SetBlockSize<unsigned>(DataLayout::GEOMETRIES_INDEX, number_of_geometries_indices);
 
-        const auto number_of_compressed_geometries = reader.ReadVectorSize<NodeID>();
-        layout.SetBlockSize<NodeID>(DataLayout::GEOMETRIES_NODE_LIST,
-                                    number_of_compressed_geometries);
+        std::size_t number_of_compressed_geometries;
+        if (config.compress_geometry)
+        {
+            std::vector<NodeID> nodes(reader.ReadElementCount64());
+            reader.ReadInto(nodes);
+            number_of_compressed_geometries = nodes.size();
+
+            const auto encoded_nodes = encodeGeometryNodes(nodes);
+            layout.SetBlockSize<NodeID>(DataLayout::GEOMETRIES_NODE_LIST, 0);
+            layout.SetBlockSize<std::uint64_t>(DataLayout::GEOMETRIES_NODE_BLOCKS,
+                                               encoded_nodes.GetBlockOffsets().size());
+            layout.SetBlockSize<std::uint8_t>(DataLayout::GEOMETRIES_NODE_DELTAS,
+                                              encoded_nodes.GetDeltas().size());
+        }
+        else
+        {
+            number_of_compressed_geometries = reader.ReadVectorSize<NodeID>();
+            layout.SetBlockSize<NodeID>(DataLayout::GEOMETRIES_NODE_LIST,
+                                        number_of_compressed_geometries);
+            layout.SetBlockSize<std::uint64_t>(DataLayout::GEOMETRIES_NODE_BLOCKS, 0);
+            layout.SetBlockSize<std::uint8_t>(DataLayout::GEOMETRIES_NODE_DELTAS, 0);
+        }
 
         reader.ReadElementCount64(); // number of segments
         const auto number_of_segment_weight_blocks =
@@ -403,15 +589,8 @@ void Storage::PopulateLayout(DataLayout &layout)
         auto num_bearing_classes = reader.ReadVectorSize<BearingClassID>();
         layout.SetBlockSize<BearingClassID>(DataLayout::BEARING_CLASSID, num_bearing_classes);
 
-        reader.Skip<std::uint32_t>(1); // sum_lengths
-        const auto bearing_blocks = reader.ReadVectorSize<unsigned>();
-        const auto bearing_offsets =
-            reader
-                .ReadVectorSize<typename util::RangeTable<16, storage::Ownership::View>::BlockT>();
-
-        layout.SetBlockSize<unsigned>(DataLayout::BEARING_OFFSETS, bearing_blocks);
-        layout.SetBlockSize<typename util::RangeTable<16, storage::Ownership::View>::BlockT>(
-            DataLayout::BEARING_BLOCKS, bearing_offsets);
+        const auto num_bearing_offsets = reader.ReadVectorSize<std::uint32_t>();
+        layout.SetBlockSize<std::uint32_t>(DataLayout::BEARING_OFFSETS, num_bearing_offsets);
 
         auto num_entry_classes = reader.ReadVectorSize<util::guidance::EntryClass>();
         layout.SetBlockSize<util::guidance::EntryClass>(DataLayout::ENTRY_CLASS, num_entry_classes);
@@ -457,6 +636,22 @@ void Storage::PopulateLayout(DataLayout &layout)
             layout.SetBlockSize<EdgeWeight>(DataLayout::MLD_CELL_WEIGHTS, weights_count);
             const auto durations_count = reader.ReadVectorSize<EdgeDuration>();
             layout.SetBlockSize<EdgeDuration>(DataLayout::MLD_CELL_DURATIONS, durations_count);
+            const auto distances_count = reader.ReadVectorSize<EdgeDistance>();
+            layout.SetBlockSize<EdgeDistance>(DataLayout::MLD_CELL_DISTANCES, distances_count);
+            const auto weight_codes_count = reader.ReadVectorSize<partition::quantization::Code>();
+            layout.SetBlockSize<partition::quantization::Code>(DataLayout::MLD_CELL_WEIGHT_CODES,
+                                                               weight_codes_count);
+            const auto duration_codes_count =
+                reader.ReadVectorSize<partition::quantization::Code>();
+            layout.SetBlockSize<partition::quantization::Code>(
+                DataLayout::MLD_CELL_DURATION_CODES, duration_codes_count);
+            const auto quantized_rows_count =
+                reader.ReadVectorSize<partition::quantization::QuantizedRow>();
+            layout.SetBlockSize<partition::quantization::QuantizedRow>(
+                DataLayout::MLD_CELL_QUANTIZED_ROWS, quantized_rows_count);
+            const auto quantized_exceptions_count = reader.ReadVectorSize<EdgeWeight>();
+            layout.SetBlockSize<EdgeWeight>(DataLayout::MLD_CELL_QUANTIZED_EXCEPTIONS,
+                                            quantized_exceptions_count);
             const auto source_node_count = reader.ReadVectorSize<NodeID>();
             layout.SetBlockSize<NodeID>(DataLayout::MLD_CELL_SOURCE_BOUNDARY, source_node_count);
             const auto destination_node_count = reader.ReadVectorSize<NodeID>();
@@ -473,6 +668,11 @@ void Storage::PopulateLayout(DataLayout &layout)
         {
             layout.SetBlockSize<char>(DataLayout::MLD_CELL_WEIGHTS, 0);
             layout.SetBlockSize<char>(DataLayout::MLD_CELL_DURATIONS, 0);
+            layout.SetBlockSize<char>(DataLayout::MLD_CELL_DISTANCES, 0);
+            layout.SetBlockSize<char>(DataLayout::MLD_CELL_WEIGHT_CODES, 0);
+            layout.SetBlockSize<char>(DataLayout::MLD_CELL_DURATION_CODES, 0);
+            layout.SetBlockSize<char>(DataLayout::MLD_CELL_QUANTIZED_ROWS, 0);
+            layout.SetBlockSize<char>(DataLayout::MLD_CELL_QUANTIZED_EXCEPTIONS, 0);
             layout.SetBlockSize<char>(DataLayout::MLD_CELL_SOURCE_BOUNDARY, 0);
             layout.SetBlockSize<char>(DataLayout::MLD_CELL_DESTINATION_BOUNDARY, 0);
             layout.SetBlockSize<char>(DataLayout::MLD_CELLS, 0);
@@ -494,6 +694,8 @@ void Storage::PopulateLayout(DataLayout &layout)
                 DataLayout::MLD_GRAPH_NODE_LIST, num_nodes);
             layout.SetBlockSize<customizer::MultiLevelEdgeBasedGraph::EdgeArrayEntry>(
                 DataLayout::MLD_GRAPH_EDGE_LIST, num_edges);
+            layout.SetBlockSize<util::SearchEdge>(DataLayout::MLD_GRAPH_SEARCH_EDGE_LIST,
+                                                  num_edges);
             layout.SetBlockSize<customizer::MultiLevelEdgeBasedGraph::EdgeOffset>(
                 DataLayout::MLD_GRAPH_NODE_TO_OFFSET, num_node_offsets);
         }
@@ -503,48 +705,150 @@ void Storage::PopulateLayout(DataLayout &layout)
                 DataLayout::MLD_GRAPH_NODE_LIST, 0);
             layout.SetBlockSize<customizer::MultiLevelEdgeBasedGraph::EdgeArrayEntry>(
                 DataLayout::MLD_GRAPH_EDGE_LIST, 0);
+            layout.SetBlockSize<util::SearchEdge>(DataLayout::MLD_GRAPH_SEARCH_EDGE_LIST, 0);
             layout.SetBlockSize<customizer::MultiLevelEdgeBasedGraph::EdgeOffset>(
                 DataLayout::MLD_GRAPH_NODE_TO_OFFSET, 0);
         }
+
+        if (boost::filesystem::exists(config.GetPath(".osrm.landmarks")))
+        {
+            io::FileReader reader(config.GetPath(".osrm.landmarks"),
+                                  io::FileReader::VerifyFingerprint);
+
+            reader.Skip<std::uint32_t>(1);
+            const auto weights_count = reader.ReadVectorSize<customizer::Landmarks::Weight>();
+            layout.SetBlockSize<customizer::Landmarks::Weight>(DataLayout::MLD_LANDMARKS,
+                                                               weights_count);
+        }
+        else
+        {
+            layout.SetBlockSize<customizer::Landmarks::Weight>(DataLayout::MLD_LANDMARKS, 0);
+        }
+    }
+
+    // Datasets extracted before the masks existed have no conditional turns to check at query time
+    if (boost::filesystem::exists(config.GetPath(".osrm.conditional_turn_masks")))
+    {
+        io::FileReader reader(config.GetPath(".osrm.conditional_turn_masks"),
+                              io::FileReader::VerifyFingerprint);
+        const auto masks_count = reader.ReadVectorSize<extractor::ConditionalTurnMask>();
+        layout.SetBlockSize<extractor::ConditionalTurnMask>(DataLayout::CONDITIONAL_TURN_MASKS,
+                                                            masks_count);
+    }
+    else
+    {
+        layout.SetBlockSize<extractor::ConditionalTurnMask>(DataLayout::CONDITIONAL_TURN_MASKS, 0);
     }
 }
 
-void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
+// The blocks are aligned relative to their address, so they are copied one by one. Only the
+// blocks of the parts in memory are copied and each of them is checked against its checksum.
+void Storage::PopulateDataFromMemoryFile(const DataLayout &layout,
+                                         const DataLayout::Memory &memory)
 {
-    BOOST_ASSERT(memory_ptr != nullptr);
-
-    // read actual data into shared memory object //
+    util::Log() << "Loading data from memory file " << config.memory_file;
+    TIMER_START(load);
 
-    // Load the HSGR file
-    if (boost::filesystem::exists(config.GetPath(".osrm.hsgr")))
+    boost::iostreams::mapped_file_source mapped_memory;
+    MemoryFileHeader header;
+    openMemoryFile(config, config.memory_file, mapped_memory, header);
+    if (std::memcmp(&header.layout, &layout, sizeof(layout)) != 0)
     {
-        auto graph_nodes_ptr = layout.GetBlockPtr<contractor::QueryGraphView::NodeArrayEntry, true>(
-            memory_ptr, storage::DataLayout::CH_GRAPH_NODE_LIST);
-        auto graph_edges_ptr = layout.GetBlockPtr<contractor::QueryGraphView::EdgeArrayEntry, true>(
-            memory_ptr, storage::DataLayout::CH_GRAPH_EDGE_LIST);
-        auto checksum = layout.GetBlockPtr<unsigned, true>(memory_ptr, DataLayout::HSGR_CHECKSUM);
+        throw util::exception("Memory file " + config.memory_file.string() +
+                              " changed while it was loaded" + SOURCE_REF);
+    }
 
-        util::vector_view<contractor::QueryGraphView::NodeArrayEntry> node_list(
-            graph_nodes_ptr, layout.num_entries[storage::DataLayout::CH_GRAPH_NODE_LIST]);
-        util::vector_view<contractor::QueryGraphView::EdgeArrayEntry> edge_list(
-            graph_edges_ptr, layout.num_entries[storage::DataLayout::CH_GRAPH_EDGE_LIST]);
+    tbb::parallel_for(0, static_cast<int>(DataLayout::NUM_BLOCKS), [&](const int index) {
+        const auto block = static_cast<DataLayout::BlockID>(index);
+        if (memory[DataLayout::GetPart(block)] == nullptr)
+        {
+            return;
+        }
+        const auto &entry = header.blocks[block];
+        BOOST_ASSERT(entry.size == layout.GetBlockSize(block));
+        auto destination = layout.GetBlockPtr<char, true>(memory, block);
+        std::copy_n(mapped_memory.data() + entry.offset, entry.size, destination);
+        if (checksumBlock(destination, entry.size) != entry.checksum)
+        {
+            throw util::exception("Block " + std::string(block_id_to_name[block]) +
+                                  " of memory file " + config.memory_file.string() +
+                                  " is corrupt" + SOURCE_REF);
+        }
+    });
 
-        contractor::QueryGraphView graph_view(std::move(node_list), std::move(edge_list));
-        contractor::files::readGraph(config.GetPath(".osrm.hsgr"), *checksum, graph_view);
-    }
-    else
+    TIMER_STOP(load);
+    util::Log() << "Loaded data from memory file in " << TIMER_SEC(load) << "s";
+}
+
+void Storage::PopulateData(const DataLayout &layout, const DataLayout::Memory &memory)
+{
+    BOOST_ASSERT(memory[DataLayout::METRIC_PART] != nullptr);
+    const bool has_static_part = memory[DataLayout::STATIC_PART] != nullptr;
+
+    if (!config.memory_file.empty())
     {
-        layout.GetBlockPtr<unsigned, true>(memory_ptr, DataLayout::HSGR_CHECKSUM);
-        layout.GetBlockPtr<contractor::QueryGraphView::NodeArrayEntry, true>(
-            memory_ptr, DataLayout::CH_GRAPH_NODE_LIST);
-        layout.GetBlockPtr<contractor::QueryGraphView::EdgeArrayEntry, true>(
-            memory_ptr, DataLayout::CH_GRAPH_EDGE_LIST);
+        PopulateDataFromMemoryFile(layout, memory);
+        return;
     }
 
+    // Every file is loaded by a task of its own, which only writes its own blocks. The tasks run
+    // in parallel, so reading and decoding the files is spread over all cores.
+    std::vector<std::pair<std::string, std::function<void()>>> tasks;
+    const auto load = [&tasks](std::string file, std::function<void()> task) {
+        tasks.emplace_back(std::move(file), std::move(task));
+    };
+    // files that only hold blocks of the static part
+    const auto load_static = [&](std::string file, std::function<void()> task) {
+        if (has_static_part)
+        {
+            load(std::move(file), std::move(task));
+        }
+    };
+
+    // Load the HSGR file
+    load(".osrm.hsgr", [&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.hsgr")))
+        {
+            auto graph_nodes_ptr =
+                layout.GetBlockPtr<contractor::QueryGraphView::NodeArrayEntry, true>(
+                    memory, storage::DataLayout::CH_GRAPH_NODE_LIST);
+            auto graph_edges_ptr =
+                layout.GetBlockPtr<contractor::QueryGraphView::EdgeArrayEntry, true>(
+                    memory, storage::DataLayout::CH_GRAPH_EDGE_LIST);
+            auto checksum =
+                layout.GetBlockPtr<unsigned, true>(memory, DataLayout::HSGR_CHECKSUM);
+
+            util::vector_view<contractor::QueryGraphView::NodeArrayEntry> node_list(
+                graph_nodes_ptr, layout.num_entries[storage::DataLayout::CH_GRAPH_NODE_LIST]);
+            util::vector_view<contractor::QueryGraphView::EdgeArrayEntry> edge_list(
+                graph_edges_ptr, layout.num_entries[storage::DataLayout::CH_GRAPH_EDGE_LIST]);
+
+            contractor::QueryGraphView graph_view(std::move(node_list), std::move(edge_list));
+            contractor::files::readGraph(config.GetPath(".osrm.hsgr"), *checksum, graph_view);
+
+            auto search_edges_ptr = layout.GetBlockPtr<util::SearchEdge, true>(
+                memory, DataLayout::CH_GRAPH_SEARCH_EDGE_LIST);
+            util::fillSearchEdges(graph_edges_ptr,
+                                  graph_edges_ptr +
+                                      layout.num_entries[DataLayout::CH_GRAPH_EDGE_LIST],
+                                  search_edges_ptr);
+        }
+        else
+        {
+            layout.GetBlockPtr<unsigned, true>(memory, DataLayout::HSGR_CHECKSUM);
+            layout.GetBlockPtr<contractor::QueryGraphView::NodeArrayEntry, true>(
+                memory, DataLayout::CH_GRAPH_NODE_LIST);
+            layout.GetBlockPtr<contractor::QueryGraphView::EdgeArrayEntry, true>(
+                memory, DataLayout::CH_GRAPH_EDGE_LIST);
+            layout.GetBlockPtr<util::SearchEdge, true>(memory,
+                                                       DataLayout::CH_GRAPH_SEARCH_EDGE_LIST);
+        }
+    });
+
     // store the filename of the on-disk portion of the RTree
-    {
+    load_static(".osrm.fileIndex", [&] {
         const auto file_index_path_ptr =
-            layout.GetBlockPtr<char, true>(memory_ptr, DataLayout::FILE_INDEX_PATH);
+            layout.GetBlockPtr<char, true>(memory, DataLayout::FILE_INDEX_PATH);
         // make sure we have 0 ending
         std::fill(file_index_path_ptr,
                   file_index_path_ptr + layout.GetBlockSize(DataLayout::FILE_INDEX_PATH),
@@ -555,22 +859,22 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
                      absolute_file_index_path.size());
         std::copy(
             absolute_file_index_path.begin(), absolute_file_index_path.end(), file_index_path_ptr);
-    }
+    });
 
     // Name data
-    {
+    load_static(".osrm.names", [&] {
         io::FileReader name_file(config.GetPath(".osrm.names"), io::FileReader::VerifyFingerprint);
         std::size_t name_file_size = name_file.GetSize();
 
         BOOST_ASSERT(name_file_size == layout.GetBlockSize(DataLayout::NAME_CHAR_DATA));
         const auto name_char_ptr =
-            layout.GetBlockPtr<char, true>(memory_ptr, DataLayout::NAME_CHAR_DATA);
+            layout.GetBlockPtr<char, true>(memory, DataLayout::NAME_CHAR_DATA);
 
         name_file.ReadInto<char>(name_char_ptr, name_file_size);
-    }
+    });
 
     // Turn lane data
-    {
+    load_static(".osrm.tld", [&] {
         io::FileReader lane_data_file(config.GetPath(".osrm.tld"),
                                       io::FileReader::VerifyFingerprint);
 
@@ -579,51 +883,51 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
         // Need to call GetBlockPtr -> it write the memory canary, even if no data needs to be
         // loaded.
         const auto turn_lane_data_ptr = layout.GetBlockPtr<util::guidance::LaneTupleIdPair, true>(
-            memory_ptr, DataLayout::TURN_LANE_DATA);
+            memory, DataLayout::TURN_LANE_DATA);
         BOOST_ASSERT(lane_tuple_count * sizeof(util::guidance::LaneTupleIdPair) ==
                      layout.GetBlockSize(DataLayout::TURN_LANE_DATA));
         lane_data_file.ReadInto(turn_lane_data_ptr, lane_tuple_count);
-    }
+    });
 
     // Turn lane descriptions
-    {
+    load_static(".osrm.tls", [&] {
         auto offsets_ptr = layout.GetBlockPtr<std::uint32_t, true>(
-            memory_ptr, storage::DataLayout::LANE_DESCRIPTION_OFFSETS);
+            memory, storage::DataLayout::LANE_DESCRIPTION_OFFSETS);
         util::vector_view<std::uint32_t> offsets(
             offsets_ptr, layout.num_entries[storage::DataLayout::LANE_DESCRIPTION_OFFSETS]);
 
         auto masks_ptr = layout.GetBlockPtr<extractor::guidance::TurnLaneType::Mask, true>(
-            memory_ptr, storage::DataLayout::LANE_DESCRIPTION_MASKS);
+            memory, storage::DataLayout::LANE_DESCRIPTION_MASKS);
         util::vector_view<extractor::guidance::TurnLaneType::Mask> masks(
             masks_ptr, layout.num_entries[storage::DataLayout::LANE_DESCRIPTION_MASKS]);
 
         extractor::files::readTurnLaneDescriptions(config.GetPath(".osrm.tls"), offsets, masks);
-    }
+    });
 
     // Load edge-based nodes data
-    {
+    load_static(".osrm.ebg_nodes", [&] {
         auto geometry_id_list_ptr =
-            layout.GetBlockPtr<GeometryID, true>(memory_ptr, storage::DataLayout::GEOMETRY_ID_LIST);
+            layout.GetBlockPtr<GeometryID, true>(memory, storage::DataLayout::GEOMETRY_ID_LIST);
         util::vector_view<GeometryID> geometry_ids(
             geometry_id_list_ptr, layout.num_entries[storage::DataLayout::GEOMETRY_ID_LIST]);
 
         auto name_id_list_ptr =
-            layout.GetBlockPtr<NameID, true>(memory_ptr, storage::DataLayout::NAME_ID_LIST);
+            layout.GetBlockPtr<NameID, true>(memory, storage::DataLayout::NAME_ID_LIST);
         util::vector_view<NameID> name_ids(name_id_list_ptr,
                                            layout.num_entries[storage::DataLayout::NAME_ID_LIST]);
 
         auto component_ids_ptr = layout.GetBlockPtr<ComponentID, true>(
-            memory_ptr, storage::DataLayout::COMPONENT_ID_LIST);
+            memory, storage::DataLayout::COMPONENT_ID_LIST);
         util::vector_view<ComponentID> component_ids(
             component_ids_ptr, layout.num_entries[storage::DataLayout::COMPONENT_ID_LIST]);
 
         auto travel_mode_list_ptr = layout.GetBlockPtr<extractor::TravelMode, true>(
-            memory_ptr, storage::DataLayout::TRAVEL_MODE_LIST);
+            memory, storage::DataLayout::TRAVEL_MODE_LIST);
         util::vector_view<extractor::TravelMode> travel_modes(
             travel_mode_list_ptr, layout.num_entries[storage::DataLayout::TRAVEL_MODE_LIST]);
 
         auto classes_list_ptr = layout.GetBlockPtr<extractor::ClassData, true>(
-            memory_ptr, storage::DataLayout::CLASSES_LIST);
+            memory, storage::DataLayout::CLASSES_LIST);
         util::vector_view<extractor::ClassData> classes(
             classes_list_ptr, layout.num_entries[storage::DataLayout::CLASSES_LIST]);
 
@@ -634,61 +938,55 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
                                                    std::move(classes));
 
         extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
-    }
+    });
 
     // Load original edge data
-    {
-        const auto lane_data_id_ptr =
-            layout.GetBlockPtr<LaneDataID, true>(memory_ptr, storage::DataLayout::LANE_DATA_ID);
-        util::vector_view<LaneDataID> lane_data_ids(
-            lane_data_id_ptr, layout.num_entries[storage::DataLayout::LANE_DATA_ID]);
-
-        const auto turn_instruction_list_ptr =
-            layout.GetBlockPtr<extractor::guidance::TurnInstruction, true>(
-                memory_ptr, storage::DataLayout::TURN_INSTRUCTION);
-        util::vector_view<extractor::guidance::TurnInstruction> turn_instructions(
-            turn_instruction_list_ptr, layout.num_entries[storage::DataLayout::TURN_INSTRUCTION]);
-
-        const auto entry_class_id_list_ptr =
-            layout.GetBlockPtr<EntryClassID, true>(memory_ptr, storage::DataLayout::ENTRY_CLASSID);
-        util::vector_view<EntryClassID> entry_class_ids(
-            entry_class_id_list_ptr, layout.num_entries[storage::DataLayout::ENTRY_CLASSID]);
-
-        const auto pre_turn_bearing_ptr = layout.GetBlockPtr<util::guidance::TurnBearing, true>(
-            memory_ptr, storage::DataLayout::PRE_TURN_BEARING);
-        util::vector_view<util::guidance::TurnBearing> pre_turn_bearings(
-            pre_turn_bearing_ptr, layout.num_entries[storage::DataLayout::PRE_TURN_BEARING]);
-
-        const auto post_turn_bearing_ptr = layout.GetBlockPtr<util::guidance::TurnBearing, true>(
-            memory_ptr, storage::DataLayout::POST_TURN_BEARING);
-        util::vector_view<util::guidance::TurnBearing> post_turn_bearings(
-            post_turn_bearing_ptr, layout.num_entries[storage::DataLayout::POST_TURN_BEARING]);
-
-        extractor::TurnDataView turn_data(std::move(turn_instructions),
-                                          std::move(lane_data_ids),
-                                          std::move(entry_class_ids),
-                                          std::move(pre_turn_bearings),
-                                          std::move(post_turn_bearings));
+    load_static(".osrm.edges", [&] {
+        const auto turn_data_ptr =
+            layout.GetBlockPtr<extractor::TurnData, true>(memory, storage::DataLayout::TURN_DATA);
+        util::vector_view<extractor::TurnData> turns(
+            turn_data_ptr, layout.num_entries[storage::DataLayout::TURN_DATA]);
+        extractor::TurnDataView turn_data(std::move(turns));
 
         extractor::files::readTurnData(config.GetPath(".osrm.edges"), turn_data);
-    }
+    });
 
     // load compressed geometry
-    {
-        auto geometries_index_ptr =
-            layout.GetBlockPtr<unsigned, true>(memory_ptr, storage::DataLayout::GEOMETRIES_INDEX);
-        util::vector_view<unsigned> geometry_begin_indices(
-            geometries_index_ptr, layout.num_entries[storage::DataLayout::GEOMETRIES_INDEX]);
-
-        auto num_entries = layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_LIST];
+    load(".osrm.geometry", [&] {
+        // there is one datasource per node, unlike the nodes they are never encoded
+        auto num_entries = layout.num_entries[storage::DataLayout::GEOMETRIES_FWD_DATASOURCES_LIST];
+        const auto compress_geometry =
+            layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_BLOCKS] > 0;
+
+        // the geometries belong to the static part, without it only the metric is read
+        util::vector_view<unsigned> geometry_begin_indices;
+        util::vector_view<NodeID> geometry_node_list;
+        // the nodes are read from the file before they are encoded into the data
+        std::vector<NodeID> nodes;
+        if (has_static_part)
+        {
+            auto geometries_index_ptr =
+                layout.GetBlockPtr<unsigned, true>(memory, storage::DataLayout::GEOMETRIES_INDEX);
+            geometry_begin_indices = util::vector_view<unsigned>(
+                geometries_index_ptr, layout.num_entries[storage::DataLayout::GEOMETRIES_INDEX]);
 
-        auto geometries_node_list_ptr =
-            layout.GetBlockPtr<NodeID, true>(memory_ptr, storage::DataLayout::GEOMETRIES_NODE_LIST);
-        util::vector_view<NodeID> geometry_node_list(geometries_node_list_ptr, num_entries);
+            if (compress_geometry)
+            {
+                nodes.resize(num_entries);
+                geometry_node_list = util::vector_view<NodeID>(nodes.data(), nodes.size());
+            }
+            else
+            {
+                auto geometries_node_list_ptr = layout.GetBlockPtr<NodeID, true>(
+                    memory, storage::DataLayout::GEOMETRIES_NODE_LIST);
+                geometry_node_list =
+                    util::vector_view<NodeID>(geometries_node_list_ptr, num_entries);
+            }
+        }
 
         auto geometries_fwd_weight_list_ptr =
             layout.GetBlockPtr<extractor::SegmentDataView::SegmentWeightVector::block_type, true>(
-                memory_ptr, storage::DataLayout::GEOMETRIES_FWD_WEIGHT_LIST);
+                memory, storage::DataLayout::GEOMETRIES_FWD_WEIGHT_LIST);
         extractor::SegmentDataView::SegmentWeightVector geometry_fwd_weight_list(
             util::vector_view<extractor::SegmentDataView::SegmentWeightVector::block_type>(
                 geometries_fwd_weight_list_ptr,
@@ -697,7 +995,7 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
 
         auto geometries_rev_weight_list_ptr =
             layout.GetBlockPtr<extractor::SegmentDataView::SegmentWeightVector::block_type, true>(
-                memory_ptr, storage::DataLayout::GEOMETRIES_REV_WEIGHT_LIST);
+                memory, storage::DataLayout::GEOMETRIES_REV_WEIGHT_LIST);
         extractor::SegmentDataView::SegmentWeightVector geometry_rev_weight_list(
             util::vector_view<extractor::SegmentDataView::SegmentWeightVector::block_type>(
                 geometries_rev_weight_list_ptr,
@@ -706,7 +1004,7 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
 
         auto geometries_fwd_duration_list_ptr =
             layout.GetBlockPtr<extractor::SegmentDataView::SegmentDurationVector::block_type, true>(
-                memory_ptr, storage::DataLayout::GEOMETRIES_FWD_DURATION_LIST);
+                memory, storage::DataLayout::GEOMETRIES_FWD_DURATION_LIST);
         extractor::SegmentDataView::SegmentDurationVector geometry_fwd_duration_list(
             util::vector_view<extractor::SegmentDataView::SegmentDurationVector::block_type>(
                 geometries_fwd_duration_list_ptr,
@@ -715,7 +1013,7 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
 
         auto geometries_rev_duration_list_ptr =
             layout.GetBlockPtr<extractor::SegmentDataView::SegmentDurationVector::block_type, true>(
-                memory_ptr, storage::DataLayout::GEOMETRIES_REV_DURATION_LIST);
+                memory, storage::DataLayout::GEOMETRIES_REV_DURATION_LIST);
         extractor::SegmentDataView::SegmentDurationVector geometry_rev_duration_list(
             util::vector_view<extractor::SegmentDataView::SegmentDurationVector::block_type>(
                 geometries_rev_duration_list_ptr,
@@ -723,13 +1021,13 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
             num_entries);
 
         auto geometries_fwd_datasources_list_ptr = layout.GetBlockPtr<DatasourceID, true>(
-            memory_ptr, storage::DataLayout::GEOMETRIES_FWD_DATASOURCES_LIST);
+            memory, storage::DataLayout::GEOMETRIES_FWD_DATASOURCES_LIST);
         util::vector_view<DatasourceID> geometry_fwd_datasources_list(
             geometries_fwd_datasources_list_ptr,
             layout.num_entries[storage::DataLayout::GEOMETRIES_FWD_DATASOURCES_LIST]);
 
         auto geometries_rev_datasources_list_ptr = layout.GetBlockPtr<DatasourceID, true>(
-            memory_ptr, storage::DataLayout::GEOMETRIES_REV_DATASOURCES_LIST);
+            memory, storage::DataLayout::GEOMETRIES_REV_DATASOURCES_LIST);
         util::vector_view<DatasourceID> geometry_rev_datasources_list(
             geometries_rev_datasources_list_ptr,
             layout.num_entries[storage::DataLayout::GEOMETRIES_REV_DATASOURCES_LIST]);
@@ -743,23 +1041,49 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
                                                 std::move(geometry_fwd_datasources_list),
                                                 std::move(geometry_rev_datasources_list)};
 
-        extractor::files::readSegmentData(config.GetPath(".osrm.geometry"), segment_data);
-    }
+        if (has_static_part)
+        {
+            extractor::files::readSegmentData(config.GetPath(".osrm.geometry"), segment_data);
 
-    {
+            if (compress_geometry)
+            {
+                const auto encoded_nodes = encodeGeometryNodes(nodes);
+                const auto &block_offsets = encoded_nodes.GetBlockOffsets();
+                const auto &deltas = encoded_nodes.GetDeltas();
+                BOOST_ASSERT(block_offsets.size() ==
+                             layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_BLOCKS]);
+                BOOST_ASSERT(deltas.size() ==
+                             layout.num_entries[storage::DataLayout::GEOMETRIES_NODE_DELTAS]);
+                std::copy(block_offsets.begin(),
+                          block_offsets.end(),
+                          layout.GetBlockPtr<std::uint64_t, true>(
+                              memory, storage::DataLayout::GEOMETRIES_NODE_BLOCKS));
+                std::copy(deltas.begin(),
+                          deltas.end(),
+                          layout.GetBlockPtr<std::uint8_t, true>(
+                              memory, storage::DataLayout::GEOMETRIES_NODE_DELTAS));
+            }
+        }
+        else
+        {
+            extractor::files::readSegmentMetric(config.GetPath(".osrm.geometry"), segment_data);
+        }
+    });
+
+    load(".osrm.datasource_names", [&] {
         const auto datasources_names_ptr = layout.GetBlockPtr<extractor::Datasources, true>(
-            memory_ptr, DataLayout::DATASOURCES_NAMES);
+            memory, DataLayout::DATASOURCES_NAMES);
         extractor::files::readDatasources(config.GetPath(".osrm.datasource_names"),
                                           *datasources_names_ptr);
-    }
+    });
 
     // Loading list of coordinates
-    {
+    load_static(".osrm.nbg_nodes", [&] {
         const auto coordinates_ptr =
-            layout.GetBlockPtr<util::Coordinate, true>(memory_ptr, DataLayout::COORDINATE_LIST);
+            layout.GetBlockPtr<util::Coordinate, true>(memory, DataLayout::COORDINATE_LIST);
         const auto osmnodeid_ptr =
             layout.GetBlockPtr<extractor::PackedOSMIDsView::block_type, true>(
-                memory_ptr, DataLayout::OSM_NODE_ID_LIST);
+                memory, DataLayout::OSM_NODE_ID_LIST);
         util::vector_view<util::Coordinate> coordinates(
             coordinates_ptr, layout.num_entries[DataLayout::COORDINATE_LIST]);
         extractor::PackedOSMIDsView osm_node_ids(
@@ -768,117 +1092,111 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
             layout.num_entries[DataLayout::COORDINATE_LIST]);
 
         extractor::files::readNodes(config.GetPath(".osrm.nbg_nodes"), coordinates, osm_node_ids);
-    }
+    });
 
     // load turn weight penalties
-    {
+    load(".osrm.turn_weight_penalties", [&] {
         io::FileReader turn_weight_penalties_file(config.GetPath(".osrm.turn_weight_penalties"),
                                                   io::FileReader::VerifyFingerprint);
         const auto number_of_penalties = turn_weight_penalties_file.ReadElementCount64();
         const auto turn_weight_penalties_ptr =
-            layout.GetBlockPtr<TurnPenalty, true>(memory_ptr, DataLayout::TURN_WEIGHT_PENALTIES);
+            layout.GetBlockPtr<TurnPenalty, true>(memory, DataLayout::TURN_WEIGHT_PENALTIES);
         turn_weight_penalties_file.ReadInto(turn_weight_penalties_ptr, number_of_penalties);
-    }
+    });
 
     // load turn duration penalties
-    {
+    load(".osrm.turn_duration_penalties", [&] {
         io::FileReader turn_duration_penalties_file(config.GetPath(".osrm.turn_duration_penalties"),
                                                     io::FileReader::VerifyFingerprint);
         const auto number_of_penalties = turn_duration_penalties_file.ReadElementCount64();
         const auto turn_duration_penalties_ptr =
-            layout.GetBlockPtr<TurnPenalty, true>(memory_ptr, DataLayout::TURN_DURATION_PENALTIES);
+            layout.GetBlockPtr<TurnPenalty, true>(memory, DataLayout::TURN_DURATION_PENALTIES);
         turn_duration_penalties_file.ReadInto(turn_duration_penalties_ptr, number_of_penalties);
-    }
+    });
 
     // store timestamp
-    {
+    load_static(".osrm.timestamp", [&] {
         io::FileReader timestamp_file(config.GetPath(".osrm.timestamp"),
                                       io::FileReader::VerifyFingerprint);
         const auto timestamp_size = timestamp_file.GetSize();
 
         const auto timestamp_ptr =
-            layout.GetBlockPtr<char, true>(memory_ptr, DataLayout::TIMESTAMP);
+            layout.GetBlockPtr<char, true>(memory, DataLayout::TIMESTAMP);
         BOOST_ASSERT(timestamp_size == layout.num_entries[DataLayout::TIMESTAMP]);
         timestamp_file.ReadInto(timestamp_ptr, timestamp_size);
-    }
+    });
 
     // store search tree portion of rtree
-    {
+    load_static(".osrm.ramIndex", [&] {
         io::FileReader tree_node_file(config.GetPath(".osrm.ramIndex"),
                                       io::FileReader::VerifyFingerprint);
         // perform this read so that we're at the right stream position for the next
         // read.
         tree_node_file.Skip<std::uint64_t>(1);
         const auto rtree_ptr =
-            layout.GetBlockPtr<RTreeNode, true>(memory_ptr, DataLayout::R_SEARCH_TREE);
+            layout.GetBlockPtr<RTreeNode, true>(memory, DataLayout::R_SEARCH_TREE);
 
         tree_node_file.ReadInto(rtree_ptr, layout.num_entries[DataLayout::R_SEARCH_TREE]);
 
         tree_node_file.Skip<std::uint64_t>(1);
         const auto rtree_levelsizes_ptr =
-            layout.GetBlockPtr<std::uint64_t, true>(memory_ptr, DataLayout::R_SEARCH_TREE_LEVELS);
+            layout.GetBlockPtr<std::uint64_t, true>(memory, DataLayout::R_SEARCH_TREE_LEVELS);
 
         tree_node_file.ReadInto(rtree_levelsizes_ptr,
                                 layout.num_entries[DataLayout::R_SEARCH_TREE_LEVELS]);
-    }
+    });
 
-    if (boost::filesystem::exists(config.GetPath(".osrm.core")))
-    {
-        auto core_marker_ptr =
-            layout.GetBlockPtr<unsigned, true>(memory_ptr, storage::DataLayout::CH_CORE_MARKER);
-        util::vector_view<bool> is_core_node(
-            core_marker_ptr, layout.num_entries[storage::DataLayout::CH_CORE_MARKER]);
+    load(".osrm.core", [&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.core")))
+        {
+            auto core_marker_ptr =
+                layout.GetBlockPtr<unsigned, true>(memory, storage::DataLayout::CH_CORE_MARKER);
+            util::vector_view<bool> is_core_node(
+                core_marker_ptr, layout.num_entries[storage::DataLayout::CH_CORE_MARKER]);
 
-        contractor::files::readCoreMarker(config.GetPath(".osrm.core"), is_core_node);
-    }
+            contractor::files::readCoreMarker(config.GetPath(".osrm.core"), is_core_node);
+        }
+    });
 
     // load profile properties
-    {
+    load_static(".osrm.properties", [&] {
         const auto profile_properties_ptr = layout.GetBlockPtr<extractor::ProfileProperties, true>(
-            memory_ptr, DataLayout::PROPERTIES);
+            memory, DataLayout::PROPERTIES);
         extractor::files::readProfileProperties(config.GetPath(".osrm.properties"),
                                                 *profile_properties_ptr);
-    }
+    });
 
     // Load intersection data
-    {
+    load_static(".osrm.icd", [&] {
         auto bearing_class_id_ptr = layout.GetBlockPtr<BearingClassID, true>(
-            memory_ptr, storage::DataLayout::BEARING_CLASSID);
+            memory, storage::DataLayout::BEARING_CLASSID);
         util::vector_view<BearingClassID> bearing_class_id(
             bearing_class_id_ptr, layout.num_entries[storage::DataLayout::BEARING_CLASSID]);
 
         auto bearing_values_ptr = layout.GetBlockPtr<DiscreteBearing, true>(
-            memory_ptr, storage::DataLayout::BEARING_VALUES);
+            memory, storage::DataLayout::BEARING_VALUES);
         util::vector_view<DiscreteBearing> bearing_values(
             bearing_values_ptr, layout.num_entries[storage::DataLayout::BEARING_VALUES]);
 
         auto offsets_ptr =
-            layout.GetBlockPtr<unsigned, true>(memory_ptr, storage::DataLayout::BEARING_OFFSETS);
-        auto blocks_ptr =
-            layout.GetBlockPtr<util::RangeTable<16, storage::Ownership::View>::BlockT, true>(
-                memory_ptr, storage::DataLayout::BEARING_BLOCKS);
-        util::vector_view<unsigned> bearing_offsets(
+            layout.GetBlockPtr<std::uint32_t, true>(memory, storage::DataLayout::BEARING_OFFSETS);
+        util::vector_view<std::uint32_t> bearing_offsets(
             offsets_ptr, layout.num_entries[storage::DataLayout::BEARING_OFFSETS]);
-        util::vector_view<util::RangeTable<16, storage::Ownership::View>::BlockT> bearing_blocks(
-            blocks_ptr, layout.num_entries[storage::DataLayout::BEARING_BLOCKS]);
-
-        util::RangeTable<16, storage::Ownership::View> bearing_range_table(
-            bearing_offsets, bearing_blocks, static_cast<unsigned>(bearing_values.size()));
 
         extractor::IntersectionBearingsView intersection_bearings_view{
-            std::move(bearing_values), std::move(bearing_class_id), std::move(bearing_range_table)};
+            std::move(bearing_values), std::move(bearing_class_id), std::move(bearing_offsets)};
 
         auto entry_class_ptr = layout.GetBlockPtr<util::guidance::EntryClass, true>(
-            memory_ptr, storage::DataLayout::ENTRY_CLASS);
+            memory, storage::DataLayout::ENTRY_CLASS);
         util::vector_view<util::guidance::EntryClass> entry_classes(
             entry_class_ptr, layout.num_entries[storage::DataLayout::ENTRY_CLASS]);
 
         extractor::files::readIntersections(
             config.GetPath(".osrm.icd"), intersection_bearings_view, entry_classes);
-    }
+    });
 
-    {
-        // Loading MLD Data
+    // Loading MLD Data
+    load_static(".osrm.partition", [&] {
         if (boost::filesystem::exists(config.GetPath(".osrm.partition")))
         {
             BOOST_ASSERT(layout.GetBlockSize(storage::DataLayout::MLD_LEVEL_DATA) > 0);
@@ -887,16 +1205,16 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
 
             auto level_data =
                 layout.GetBlockPtr<partition::MultiLevelPartitionView::LevelData, true>(
-                    memory_ptr, storage::DataLayout::MLD_LEVEL_DATA);
+                    memory, storage::DataLayout::MLD_LEVEL_DATA);
 
             auto mld_partition_ptr = layout.GetBlockPtr<PartitionID, true>(
-                memory_ptr, storage::DataLayout::MLD_PARTITION);
+                memory, storage::DataLayout::MLD_PARTITION);
             auto partition_entries_count =
                 layout.GetBlockEntries(storage::DataLayout::MLD_PARTITION);
             util::vector_view<PartitionID> partition(mld_partition_ptr, partition_entries_count);
 
             auto mld_chilren_ptr = layout.GetBlockPtr<CellID, true>(
-                memory_ptr, storage::DataLayout::MLD_CELL_TO_CHILDREN);
+                memory, storage::DataLayout::MLD_CELL_TO_CHILDREN);
             auto children_entries_count =
                 layout.GetBlockEntries(storage::DataLayout::MLD_CELL_TO_CHILDREN);
             util::vector_view<CellID> cell_to_children(mld_chilren_ptr, children_entries_count);
@@ -905,70 +1223,122 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
                 std::move(level_data), std::move(partition), std::move(cell_to_children)};
             partition::files::readPartition(config.GetPath(".osrm.partition"), mlp);
         }
+    });
 
+    load(".osrm.cells", [&] {
         if (boost::filesystem::exists(config.GetPath(".osrm.cells")))
         {
             BOOST_ASSERT(layout.GetBlockSize(storage::DataLayout::MLD_CELLS) > 0);
             BOOST_ASSERT(layout.GetBlockSize(storage::DataLayout::MLD_CELL_LEVEL_OFFSETS) > 0);
 
             auto mld_cell_weights_ptr = layout.GetBlockPtr<EdgeWeight, true>(
-                memory_ptr, storage::DataLayout::MLD_CELL_WEIGHTS);
+                memory, storage::DataLayout::MLD_CELL_WEIGHTS);
             auto mld_cell_duration_ptr = layout.GetBlockPtr<EdgeDuration, true>(
-                memory_ptr, storage::DataLayout::MLD_CELL_DURATIONS);
-            auto mld_source_boundary_ptr = layout.GetBlockPtr<NodeID, true>(
-                memory_ptr, storage::DataLayout::MLD_CELL_SOURCE_BOUNDARY);
-            auto mld_destination_boundary_ptr = layout.GetBlockPtr<NodeID, true>(
-                memory_ptr, storage::DataLayout::MLD_CELL_DESTINATION_BOUNDARY);
-            auto mld_cells_ptr = layout.GetBlockPtr<partition::CellStorageView::CellData, true>(
-                memory_ptr, storage::DataLayout::MLD_CELLS);
-            auto mld_cell_level_offsets_ptr = layout.GetBlockPtr<std::uint64_t, true>(
-                memory_ptr, storage::DataLayout::MLD_CELL_LEVEL_OFFSETS);
+                memory, storage::DataLayout::MLD_CELL_DURATIONS);
+            auto mld_cell_distance_ptr = layout.GetBlockPtr<EdgeDistance, true>(
+                memory, storage::DataLayout::MLD_CELL_DISTANCES);
 
             auto weight_entries_count =
                 layout.GetBlockEntries(storage::DataLayout::MLD_CELL_WEIGHTS);
             auto duration_entries_count =
                 layout.GetBlockEntries(storage::DataLayout::MLD_CELL_DURATIONS);
-            auto source_boundary_entries_count =
-                layout.GetBlockEntries(storage::DataLayout::MLD_CELL_SOURCE_BOUNDARY);
-            auto destination_boundary_entries_count =
-                layout.GetBlockEntries(storage::DataLayout::MLD_CELL_DESTINATION_BOUNDARY);
-            auto cells_entries_counts = layout.GetBlockEntries(storage::DataLayout::MLD_CELLS);
-            auto cell_level_offsets_entries_count =
-                layout.GetBlockEntries(storage::DataLayout::MLD_CELL_LEVEL_OFFSETS);
+            auto distance_entries_count =
+                layout.GetBlockEntries(storage::DataLayout::MLD_CELL_DISTANCES);
 
             util::vector_view<EdgeWeight> weights(mld_cell_weights_ptr, weight_entries_count);
             util::vector_view<EdgeDuration> durations(mld_cell_duration_ptr,
                                                       duration_entries_count);
-            util::vector_view<NodeID> source_boundary(mld_source_boundary_ptr,
-                                                      source_boundary_entries_count);
-            util::vector_view<NodeID> destination_boundary(mld_destination_boundary_ptr,
-                                                           destination_boundary_entries_count);
-            util::vector_view<partition::CellStorageView::CellData> cells(mld_cells_ptr,
-                                                                          cells_entries_counts);
-            util::vector_view<std::uint64_t> level_offsets(mld_cell_level_offsets_ptr,
-                                                           cell_level_offsets_entries_count);
+            util::vector_view<EdgeDistance> distances(mld_cell_distance_ptr,
+                                                      distance_entries_count);
+
+            // empty unless osrm-customize quantized the upper levels
+            util::vector_view<partition::quantization::Code> weight_codes(
+                layout.GetBlockPtr<partition::quantization::Code, true>(
+                    memory, storage::DataLayout::MLD_CELL_WEIGHT_CODES),
+                layout.GetBlockEntries(storage::DataLayout::MLD_CELL_WEIGHT_CODES));
+            util::vector_view<partition::quantization::Code> duration_codes(
+                layout.GetBlockPtr<partition::quantization::Code, true>(
+                    memory, storage::DataLayout::MLD_CELL_DURATION_CODES),
+                layout.GetBlockEntries(storage::DataLayout::MLD_CELL_DURATION_CODES));
+            util::vector_view<partition::quantization::QuantizedRow> quantized_rows(
+                layout.GetBlockPtr<partition::quantization::QuantizedRow, true>(
+                    memory, storage::DataLayout::MLD_CELL_QUANTIZED_ROWS),
+                layout.GetBlockEntries(storage::DataLayout::MLD_CELL_QUANTIZED_ROWS));
+            util::vector_view<EdgeWeight> quantized_exceptions(
+                layout.GetBlockPtr<EdgeWeight, true>(
+                    memory, storage::DataLayout::MLD_CELL_QUANTIZED_EXCEPTIONS),
+                layout.GetBlockEntries(storage::DataLayout::MLD_CELL_QUANTIZED_EXCEPTIONS));
+
+            // the boundaries and cells belong to the static part, without it only the metric is
+            // read
+            util::vector_view<NodeID> source_boundary;
+            util::vector_view<NodeID> destination_boundary;
+            util::vector_view<partition::CellStorageView::CellData> cells;
+            util::vector_view<std::uint64_t> level_offsets;
+            if (has_static_part)
+            {
+                auto mld_source_boundary_ptr = layout.GetBlockPtr<NodeID, true>(
+                    memory, storage::DataLayout::MLD_CELL_SOURCE_BOUNDARY);
+                auto mld_destination_boundary_ptr = layout.GetBlockPtr<NodeID, true>(
+                    memory, storage::DataLayout::MLD_CELL_DESTINATION_BOUNDARY);
+                auto mld_cells_ptr = layout.GetBlockPtr<partition::CellStorageView::CellData, true>(
+                    memory, storage::DataLayout::MLD_CELLS);
+                auto mld_cell_level_offsets_ptr = layout.GetBlockPtr<std::uint64_t, true>(
+                    memory, storage::DataLayout::MLD_CELL_LEVEL_OFFSETS);
+
+                auto source_boundary_entries_count =
+                    layout.GetBlockEntries(storage::DataLayout::MLD_CELL_SOURCE_BOUNDARY);
+                auto destination_boundary_entries_count =
+                    layout.GetBlockEntries(storage::DataLayout::MLD_CELL_DESTINATION_BOUNDARY);
+                auto cells_entries_counts = layout.GetBlockEntries(storage::DataLayout::MLD_CELLS);
+                auto cell_level_offsets_entries_count =
+                    layout.GetBlockEntries(storage::DataLayout::MLD_CELL_LEVEL_OFFSETS);
+
+                source_boundary = util::vector_view<NodeID>(mld_source_boundary_ptr,
+                                                            source_boundary_entries_count);
+                destination_boundary = util::vector_view<NodeID>(
+                    mld_destination_boundary_ptr, destination_boundary_entries_count);
+                cells = util::vector_view<partition::CellStorageView::CellData>(
+                    mld_cells_ptr, cells_entries_counts);
+                level_offsets = util::vector_view<std::uint64_t>(
+                    mld_cell_level_offsets_ptr, cell_level_offsets_entries_count);
+            }
 
             partition::CellStorageView storage{std::move(weights),
                                                std::move(durations),
+                                               std::move(distances),
                                                std::move(source_boundary),
                                                std::move(destination_boundary),
                                                std::move(cells),
-                                               std::move(level_offsets)};
-            partition::files::readCells(config.GetPath(".osrm.cells"), storage);
+                                               std::move(level_offsets),
+                                               std::move(weight_codes),
+                                               std::move(duration_codes),
+                                               std::move(quantized_rows),
+                                               std::move(quantized_exceptions)};
+            if (has_static_part)
+            {
+                partition::files::readCells(config.GetPath(".osrm.cells"), storage);
+            }
+            else
+            {
+                partition::files::readCellMetric(config.GetPath(".osrm.cells"), storage);
+            }
         }
+    });
 
+    load(".osrm.mldgr", [&] {
         if (boost::filesystem::exists(config.GetPath(".osrm.mldgr")))
         {
 
             auto graph_nodes_ptr =
                 layout.GetBlockPtr<customizer::MultiLevelEdgeBasedGraphView::NodeArrayEntry, true>(
-                    memory_ptr, storage::DataLayout::MLD_GRAPH_NODE_LIST);
+                    memory, storage::DataLayout::MLD_GRAPH_NODE_LIST);
             auto graph_edges_ptr =
                 layout.GetBlockPtr<customizer::MultiLevelEdgeBasedGraphView::EdgeArrayEntry, true>(
-                    memory_ptr, storage::DataLayout::MLD_GRAPH_EDGE_LIST);
+                    memory, storage::DataLayout::MLD_GRAPH_EDGE_LIST);
             auto graph_node_to_offset_ptr =
                 layout.GetBlockPtr<customizer::MultiLevelEdgeBasedGraphView::EdgeOffset, true>(
-                    memory_ptr, storage::DataLayout::MLD_GRAPH_NODE_TO_OFFSET);
+                    memory, storage::DataLayout::MLD_GRAPH_NODE_TO_OFFSET);
 
             util::vector_view<customizer::MultiLevelEdgeBasedGraphView::NodeArrayEntry> node_list(
                 graph_nodes_ptr, layout.num_entries[storage::DataLayout::MLD_GRAPH_NODE_LIST]);
@@ -981,7 +1351,77 @@ void Storage::PopulateData(const DataLayout &layout, char *memory_ptr)
             customizer::MultiLevelEdgeBasedGraphView graph_view(
                 std::move(node_list), std::move(edge_list), std::move(node_to_offset));
             partition::files::readGraph(config.GetPath(".osrm.mldgr"), graph_view);
+
+            // one layer of search edges per metric, like the edge list
+            auto search_edges_ptr = layout.GetBlockPtr<util::SearchEdge, true>(
+                memory, DataLayout::MLD_GRAPH_SEARCH_EDGE_LIST);
+            util::fillSearchEdges(graph_edges_ptr,
+                                  graph_edges_ptr +
+                                      layout.num_entries[DataLayout::MLD_GRAPH_EDGE_LIST],
+                                  search_edges_ptr);
+        }
+    });
+
+    load(".osrm.landmarks", [&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.landmarks")))
+        {
+            auto weights_ptr = layout.GetBlockPtr<customizer::Landmarks::Weight, true>(
+                memory, storage::DataLayout::MLD_LANDMARKS);
+            util::vector_view<customizer::Landmarks::Weight> weights(
+                weights_ptr, layout.num_entries[storage::DataLayout::MLD_LANDMARKS]);
+
+            customizer::LandmarksView landmarks(0, std::move(weights));
+            customizer::files::readLandmarks(config.GetPath(".osrm.landmarks"), landmarks);
+        }
+    });
+
+    load_static(".osrm.conditional_turn_masks", [&] {
+        if (boost::filesystem::exists(config.GetPath(".osrm.conditional_turn_masks")))
+        {
+            auto masks_ptr = layout.GetBlockPtr<extractor::ConditionalTurnMask, true>(
+                memory, storage::DataLayout::CONDITIONAL_TURN_MASKS);
+            util::vector_view<extractor::ConditionalTurnMask> masks(
+                masks_ptr, layout.num_entries[storage::DataLayout::CONDITIONAL_TURN_MASKS]);
+            extractor::files::readConditionalTurnMasks(
+                config.GetPath(".osrm.conditional_turn_masks"), masks);
         }
+    });
+
+    std::vector<double> seconds(tasks.size());
+    std::vector<std::exception_ptr> errors(tasks.size());
+    TIMER_START(populate);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, tasks.size(), 1),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto index = range.begin(); index < range.end(); ++index)
+                          {
+                              TIMER_START(task);
+                              try
+                              {
+                                  tasks[index].second();
+                              }
+                              catch (...)
+                              {
+                                  errors[index] = std::current_exception();
+                              }
+                              TIMER_STOP(task);
+                              seconds[index] = TIMER_SEC(task);
+                          }
+                      });
+    TIMER_STOP(populate);
+
+    // the first failing file in load order, as if they were loaded one after another
+    for (const auto &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    util::Log() << "Loaded all files in " << TIMER_SEC(populate) << "s";
+    for (const auto index : util::irange<std::size_t>(0, tasks.size()))
+    {
+        util::Log() << "  " << tasks[index].first << ": " << seconds[index] << "s";
     }
 }
 }
@@ -3,6 +3,7 @@
 #include "osrm/contractor_config.hpp"
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/timezones.hpp"
 #include "util/version.hpp"
 
@@ -28,11 +29,17 @@ enum class return_code : unsigned
     exit
 };
 
-return_code parseArguments(int argc, char *argv[], contractor::ContractorConfig &contractor_config)
+return_code parseArguments(int argc,
+                           char *argv[],
+                           contractor::ContractorConfig &contractor_config,
+                           boost::filesystem::path &phase_report_path)
 {
     // declare a group of options that will be allowed only on command line
     boost::program_options::options_description generic_options("Options");
-    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
 
     // declare a group of options that will be allowed on command line
     boost::program_options::options_description config_options("Configuration");
@@ -48,7 +55,8 @@ return_code parseArguments(int argc, char *argv[], contractor::ContractorConfig
         boost::program_options::value<std::vector<std::string>>(
             &contractor_config.updater_config.segment_speed_lookup_paths)
             ->composing(),
-        "Lookup files containing nodeA, nodeB, speed data to adjust edge weights")(
+        "Lookup files containing nodeA, nodeB, speed data to adjust edge weights, in the CSV "
+        "or the binary format of osrm-convert-speeds")(
         "turn-penalty-file",
         boost::program_options::value<std::vector<std::string>>(
             &contractor_config.updater_config.turn_penalty_lookup_paths)
@@ -58,6 +66,44 @@ return_code parseArguments(int argc, char *argv[], contractor::ContractorConfig
         boost::program_options::value<bool>(&contractor_config.use_cached_priority)
             ->default_value(false),
         "Use .level file to retain the contaction level for each node from the last run.")(
+        "cch",
+        boost::program_options::bool_switch(&contractor_config.use_cch)->default_value(false),
+        "Build a customizable contraction hierarchy in the order of the cells of osrm-partition. "
+        "With --level-cache the .osrm.cch file of the last run is customized again.")(
+        "fixed-order",
+        boost::program_options::bool_switch(&contractor_config.use_fixed_order)
+            ->default_value(false),
+        "Contract in the order of the .level file of the last run without updating node "
+        "priorities. Faster than --level-cache for weight updates.")(
+        "checkpoint-interval",
+        boost::program_options::value<unsigned>(&contractor_config.checkpoint_interval)
+            ->default_value(0),
+        "Minutes between two checkpoints of the contraction in the .checkpoint file, 0 writes "
+        "none")(
+        "resume",
+        boost::program_options::bool_switch(&contractor_config.resume_from_checkpoint)
+            ->default_value(false),
+        "Continue the contraction from the .checkpoint file of an interrupted run with the same "
+        "input files and options")(
+        "renumber-nodes",
+        boost::program_options::bool_switch(&contractor_config.renumber_nodes)
+            ->default_value(false),
+        "Number the nodes by level and along a Hilbert curve for faster queries, rewrites the "
+        "files of osrm-extract in the new order. Datasets of osrm-partition keep their cell "
+        "order.")(
+        "tune-core",
+        boost::program_options::value<std::vector<double>>(&contractor_config.tune_core_factors)
+            ->multitoken(),
+        "Compare core factors in (0..1] on one contraction order by their contraction and "
+        "query times, writes no files")(
+        "tune-routes",
+        boost::program_options::value<unsigned>(&contractor_config.tune_number_of_routes)
+            ->default_value(1000),
+        "Number of random routes per core factor of --tune-core")(
+        "tune-table-size",
+        boost::program_options::value<unsigned>(&contractor_config.tune_table_size)
+            ->default_value(100),
+        "Number of random sources and targets of the table per core factor of --tune-core")(
         "edge-weight-updates-over-factor",
         boost::program_options::value<double>(
             &contractor_config.updater_config.log_edge_updates_factor)
@@ -73,7 +119,7 @@ return_code parseArguments(int argc, char *argv[], contractor::ContractorConfig
         "time-zone-file",
         boost::program_options::value<std::string>(&contractor_config.updater_config.tz_file_path),
         "Required for conditional turn restriction parsing, provide a geojson file containing "
-        "time zone boundaries");
+        "time zone boundaries or its index written by osrm-convert-timezones");
 
     // hidden options, will be allowed on command line, but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -141,7 +187,8 @@ int main(int argc, char *argv[]) try
     util::LogPolicy::GetInstance().Unmute();
     contractor::ContractorConfig contractor_config;
 
-    const return_code result = parseArguments(argc, argv, contractor_config);
+    boost::filesystem::path phase_report_path;
+    const return_code result = parseArguments(argc, argv, contractor_config, phase_report_path);
 
     if (return_code::fail == result)
     {
@@ -176,11 +223,61 @@ int main(int argc, char *argv[]) try
         return EXIT_FAILURE;
     }
 
+    if (contractor_config.use_cch && contractor_config.core_factor < 1.0)
+    {
+        util::Log(logERROR) << "A customizable contraction hierarchy has no core, --core can not "
+                               "be combined with --cch";
+        return EXIT_FAILURE;
+    }
+
+    if (contractor_config.use_fixed_order)
+    {
+        if (!boost::filesystem::is_regular_file(contractor_config.GetPath(".osrm.level")))
+        {
+            util::Log(logERROR) << "--fixed-order needs the levels of the last run, "
+                                << contractor_config.GetPath(".osrm.level").string()
+                                << " not found!";
+            return EXIT_FAILURE;
+        }
+        contractor_config.use_cached_priority = true;
+    }
+
+    for (const auto core_factor : contractor_config.tune_core_factors)
+    {
+        if (core_factor <= 0 || core_factor > 1.0)
+        {
+            util::Log(logERROR) << "--tune-core factors must be in (0..1], got " << core_factor;
+            return EXIT_FAILURE;
+        }
+    }
+    if (contractor_config.renumber_nodes &&
+        (contractor_config.use_cch || !contractor_config.tune_core_factors.empty()))
+    {
+        util::Log(logERROR) << "--renumber-nodes can not be combined with --cch or --tune-core";
+        return EXIT_FAILURE;
+    }
+    if (!contractor_config.tune_core_factors.empty() && contractor_config.use_cch)
+    {
+        util::Log(logERROR) << "A customizable contraction hierarchy has no core, --tune-core "
+                               "can not be combined with --cch";
+        return EXIT_FAILURE;
+    }
+
+    if (contractor_config.use_cch &&
+        !boost::filesystem::is_regular_file(contractor_config.GetPath(".osrm.partition")))
+    {
+        util::Log(logERROR) << "--cch needs the cells of osrm-partition, "
+                            << contractor_config.GetPath(".osrm.partition").string()
+                            << " not found!";
+        return EXIT_FAILURE;
+    }
+
     util::Log() << "Input file: " << contractor_config.GetPath(".osrm").filename().string();
     util::Log() << "Threads: " << contractor_config.requested_num_threads;
 
     tbb::task_scheduler_init init(contractor_config.requested_num_threads);
 
+    util::PhaseReport phase_report("osrm-contract", phase_report_path);
     osrm::contract(contractor_config);
 
     util::DumpSTXXLStats();
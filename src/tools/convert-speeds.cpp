@@ -0,0 +1,180 @@
+#include "updater/binary_source.hpp"
+#include "updater/csv_source.hpp"
+
+#include "osrm/exception.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include <tbb/task_scheduler_init.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+struct ConvertConfig
+{
+    std::vector<std::string> input_paths;
+    boost::filesystem::path output_path;
+    std::string name;
+    unsigned int requested_num_threads;
+};
+
+return_code parseArguments(int argc, char *argv[], ConvertConfig &config)
+{
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    // declare a group of options that will be allowed both on command line
+    // as well as in a config file
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("output,o",
+         boost::program_options::value<boost::filesystem::path>(&config.output_path)->required(),
+         "Binary segment speed file to write") //
+        ("name",
+         boost::program_options::value<std::string>(&config.name)->default_value(""),
+         "Datasource name stored in the file, the file name is used if it is empty") //
+        ("threads,t",
+         boost::program_options::value<unsigned int>(&config.requested_num_threads)
+             ->default_value(tbb::task_scheduler_init::default_num_threads()),
+         "Number of threads to use");
+
+    // hidden options, will be allowed on command line, but will not be
+    // shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "input,i",
+        boost::program_options::value<std::vector<std::string>>(&config.input_paths)
+            ->composing(),
+        "Segment speed files in the CSV format of --segment-speed-file");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("input", -1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() +
+        " <speeds.csv> [<speeds.csv> ...] -o <speeds.bin> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+
+        if (option_variables.count("version"))
+        {
+            std::cout << OSRM_VERSION << std::endl;
+            return return_code::exit;
+        }
+
+        if (option_variables.count("help"))
+        {
+            std::cout << visible_options;
+            return return_code::exit;
+        }
+
+        boost::program_options::notify(option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (!option_variables.count("input"))
+    {
+        std::cout << visible_options;
+        return return_code::fail;
+    }
+
+    return return_code::ok;
+}
+}
+
+// Converts CSV segment speed files into one binary segment speed file. Later input files
+// override the speeds of earlier ones like in a list of --segment-speed-file options.
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+    ConvertConfig config;
+
+    const auto result = parseArguments(argc, argv, config);
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    if (1 > config.requested_num_threads)
+    {
+        util::Log(logERROR) << "Number of threads must be 1 or larger";
+        return EXIT_FAILURE;
+    }
+    // the datasource names of a dataset hold at most 254 characters
+    if (config.name.size() > 254)
+    {
+        util::Log(logERROR) << "The datasource name can have at most 254 characters";
+        return EXIT_FAILURE;
+    }
+    for (const auto &path : config.input_paths)
+    {
+        if (!boost::filesystem::is_regular_file(path))
+        {
+            util::Log(logERROR) << "Input file " << path << " not found!";
+            return EXIT_FAILURE;
+        }
+    }
+
+    tbb::task_scheduler_init init(config.requested_num_threads);
+
+    TIMER_START(convert);
+    const auto lookup = updater::csv::readSegmentValues(config.input_paths);
+    updater::binary::writeSegmentValues(config.output_path.string(), config.name, lookup);
+    TIMER_STOP(convert);
+
+    util::Log() << "Wrote " << lookup.lookup.size() << " segment speeds to "
+                << config.output_path.string() << " in " << TIMER_SEC(convert) << "s";
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,162 @@
+#include "osrm/exception.hpp"
+#include "util/log.hpp"
+#include "util/timezones.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <ctime>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace osrm;
+
+namespace
+{
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+struct ConvertConfig
+{
+    boost::filesystem::path input_path;
+    boost::filesystem::path output_path;
+    double cell_size;
+};
+
+return_code parseArguments(int argc, char *argv[], ConvertConfig &config)
+{
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    // declare a group of options that will be allowed both on command line
+    // as well as in a config file
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("output,o",
+         boost::program_options::value<boost::filesystem::path>(&config.output_path)->required(),
+         "Time zone index file to write") //
+        ("cell-size",
+         boost::program_options::value<double>(&config.cell_size)
+             ->default_value(updater::Timezoner::DEFAULT_CELL_SIZE),
+         "Size of the grid cells in degrees");
+
+    // hidden options, will be allowed on command line, but will not be
+    // shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "input,i",
+        boost::program_options::value<boost::filesystem::path>(&config.input_path),
+        "GeoJSON file of time zone polygons as for --time-zone-file");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("input", 1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() +
+        " <timezones.geojson> -o <timezones.index> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+
+        if (option_variables.count("version"))
+        {
+            std::cout << OSRM_VERSION << std::endl;
+            return return_code::exit;
+        }
+
+        if (option_variables.count("help"))
+        {
+            std::cout << visible_options;
+            return return_code::exit;
+        }
+
+        boost::program_options::notify(option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (!option_variables.count("input"))
+    {
+        std::cout << visible_options;
+        return return_code::fail;
+    }
+
+    return return_code::ok;
+}
+}
+
+// Converts time zone polygons into a grid index that osrm-contract and osrm-customize load
+// instead of parsing the GeoJSON and building the grid
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+    ConvertConfig config;
+
+    const auto result = parseArguments(argc, argv, config);
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    if (!(config.cell_size > 0.))
+    {
+        util::Log(logERROR) << "Cell size must be positive";
+        return EXIT_FAILURE;
+    }
+    if (!boost::filesystem::is_regular_file(config.input_path))
+    {
+        util::Log(logERROR) << "Input file " << config.input_path.string() << " not found!";
+        return EXIT_FAILURE;
+    }
+
+    TIMER_START(convert);
+    // the index stores no local times, any time works to load the zones
+    const updater::Timezoner timezoner{config.input_path, std::time(nullptr), config.cell_size};
+    timezoner.Write(config.output_path);
+    TIMER_STOP(convert);
+
+    util::Log() << "Wrote " << timezoner.GetNumberOfCells() << " cells, "
+                << timezoner.GetNumberOfBoundaryCells() << " on zone boundaries, to "
+                << config.output_path.string() << " in " << TIMER_SEC(convert) << "s";
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
@@ -3,14 +3,19 @@
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
 #include "util/meminfo.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/version.hpp"
 
 #include <tbb/task_scheduler_init.h>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <vector>
 
 using namespace osrm;
 
@@ -22,11 +27,19 @@ enum class return_code : unsigned
 };
 
 return_code
-parseArguments(int argc, char *argv[], customizer::CustomizationConfig &customization_config)
+parseArguments(int argc,
+               char *argv[],
+               customizer::CustomizationConfig &customization_config,
+               boost::filesystem::path &phase_report_path)
 {
+    std::vector<std::string> metrics;
+
     // declare a group of options that will be allowed only on command line
     boost::program_options::options_description generic_options("Options");
-    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -40,7 +53,8 @@ parseArguments(int argc, char *argv[], customizer::CustomizationConfig &customiz
             boost::program_options::value<std::vector<std::string>>(
                 &customization_config.updater_config.segment_speed_lookup_paths)
                 ->composing(),
-            "Lookup files containing nodeA, nodeB, speed data to adjust edge weights")(
+            "Lookup files containing nodeA, nodeB, speed data to adjust edge weights, in the "
+            "CSV or the binary format of osrm-convert-speeds")(
             "turn-penalty-file",
             boost::program_options::value<std::vector<std::string>>(
                 &customization_config.updater_config.turn_penalty_lookup_paths)
@@ -65,7 +79,41 @@ parseArguments(int argc, char *argv[], customizer::CustomizationConfig &customiz
                 &customization_config.updater_config.tz_file_path)
                 ->default_value(""),
             "Required for conditional turn restriction parsing, provide a geojson file containing "
-            "time zone boundaries");
+            "time zone boundaries or its index written by osrm-convert-timezones")(
+            "incremental",
+            boost::program_options::value<bool>(&customization_config.incremental)
+                ->implicit_value(true)
+                ->default_value(false),
+            "Only customize the cells touched by the updated segments and turns, starting from "
+            "the metric of the last run in .osrm.cells. The last run has to use the same files "
+            "except for the updated values")(
+            "quantize-cell-metrics",
+            boost::program_options::value<bool>(&customization_config.quantize_cell_metrics)
+                ->implicit_value(true)
+                ->default_value(false),
+            "Store the cell weights and durations from level 2 on as 16 bit offsets, exceptions "
+            "are kept exactly so routes do not change")(
+            "landmarks",
+            boost::program_options::value<unsigned>(&customization_config.num_landmarks)
+                ->default_value(0),
+            "Number of landmarks that direct the search of routes towards their target, their "
+            "weights take 8 bytes per landmark and edge based node. 0 for none")(
+            "metric",
+            boost::program_options::value<std::vector<std::string>>(&metrics)->composing(),
+            "Adds a metric with the speeds of a comma separated list of files in the format of "
+            "`--segment-speed-file`. Metrics are numbered from 1 in the order of the options, "
+            "metric 0 uses `--segment-speed-file`. Queries select one with `metric=`")(
+            "speed-profile-file",
+            boost::program_options::value<std::string>(&customization_config.speed_profile_path)
+                ->default_value(""),
+            "Typical speeds over the day, lines of profile_id,speed_0,...,speed_n in km/h. Every "
+            "time slot gets a metric, queries select one with `departure_time=`")(
+            "segment-profile-file",
+            boost::program_options::value<std::string>(
+                &customization_config.segment_profile_path)
+                ->default_value(""),
+            "Speed profiles of segments for `--speed-profile-file`, lines of "
+            "from_osm_id,to_osm_id,profile_id");
 
     // hidden options, will be allowed on command line, but will not be
     // shown to the user
@@ -118,6 +166,14 @@ parseArguments(int argc, char *argv[], customizer::CustomizationConfig &customiz
 
     boost::program_options::notify(option_variables);
 
+    for (const auto &metric : metrics)
+    {
+        std::vector<std::string> files;
+        boost::algorithm::split(files, metric, boost::is_any_of(","));
+        files.erase(std::remove(files.begin(), files.end(), ""), files.end());
+        customization_config.metric_speed_lookup_paths.push_back(std::move(files));
+    }
+
     if (!option_variables.count("input"))
     {
         std::cout << visible_options;
@@ -132,7 +188,8 @@ int main(int argc, char *argv[]) try
     util::LogPolicy::GetInstance().Unmute();
     customizer::CustomizationConfig customization_config;
 
-    const auto result = parseArguments(argc, argv, customization_config);
+    boost::filesystem::path phase_report_path;
+    const auto result = parseArguments(argc, argv, customization_config, phase_report_path);
 
     if (return_code::fail == result)
     {
@@ -153,6 +210,27 @@ int main(int argc, char *argv[]) try
         return EXIT_FAILURE;
     }
 
+    if (customization_config.incremental &&
+        !customization_config.metric_speed_lookup_paths.empty())
+    {
+        util::Log(logERROR) << "Incremental customization does not support --metric";
+        return EXIT_FAILURE;
+    }
+
+    if (customization_config.speed_profile_path.empty() !=
+        customization_config.segment_profile_path.empty())
+    {
+        util::Log(logERROR)
+            << "--speed-profile-file and --segment-profile-file have to be used together";
+        return EXIT_FAILURE;
+    }
+
+    if (customization_config.incremental && !customization_config.speed_profile_path.empty())
+    {
+        util::Log(logERROR) << "Incremental customization does not support speed profiles";
+        return EXIT_FAILURE;
+    }
+
     if (!boost::filesystem::is_regular_file(customization_config.GetPath(".osrm")))
     {
         util::Log(logERROR) << "Input file " << customization_config.GetPath(".osrm").string()
@@ -162,6 +240,7 @@ int main(int argc, char *argv[]) try
 
     tbb::task_scheduler_init init(customization_config.requested_num_threads);
 
+    util::PhaseReport phase_report("osrm-customize", phase_report_path);
     auto exitcode = customizer::Customizer().Run(customization_config);
 
     util::DumpMemoryStats();
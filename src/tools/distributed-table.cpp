@@ -0,0 +1,232 @@
+#include "server/table_coordinator.hpp"
+
+#include "util/coordinate.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+#include "util/version.hpp"
+
+#include "osrm/exception.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+struct DistributedTableConfig
+{
+    server::TableCoordinatorConfig coordinator;
+    boost::filesystem::path coordinates_path;
+    boost::filesystem::path output;
+};
+
+// One "longitude,latitude" per line, empty lines are skipped
+std::vector<util::Coordinate> readCoordinates(const boost::filesystem::path &path)
+{
+    boost::filesystem::ifstream in(path);
+    if (!in)
+        throw util::exception("Could not open " + path.string() + SOURCE_REF);
+
+    std::vector<util::Coordinate> coordinates;
+    std::string line;
+    for (std::size_t number = 1; std::getline(in, line); ++number)
+    {
+        if (line.empty() || line == "\r")
+            continue;
+        double lon, lat;
+        char comma;
+        std::istringstream fields(line);
+        if (!(fields >> lon >> comma >> lat) || comma != ',')
+            throw util::exception(path.string() + ":" + std::to_string(number) +
+                                  " is not a longitude,latitude pair" + SOURCE_REF);
+        coordinates.emplace_back(util::FloatLongitude{lon}, util::FloatLatitude{lat});
+        if (!coordinates.back().IsValid())
+            throw util::exception(path.string() + ":" + std::to_string(number) +
+                                  " is not a valid coordinate" + SOURCE_REF);
+    }
+    return coordinates;
+}
+
+// The matrix is written row by row as the blocks come in, the file has its final size from the
+// start so the rows of every block can be written at their offset
+class MatrixFile
+{
+  public:
+    MatrixFile(const boost::filesystem::path &path, const std::size_t size)
+        : path(path), row_bytes(size * sizeof(double))
+    {
+        boost::filesystem::ofstream(path, std::ios::binary | std::ios::trunc);
+        boost::filesystem::resize_file(path, size * row_bytes);
+        out.open(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (!out)
+            throw util::exception("Could not open " + path.string() + " for writing" +
+                                  SOURCE_REF);
+    }
+
+    void WriteRows(const std::size_t first_row, const std::vector<double> &rows)
+    {
+        out.seekp(first_row * row_bytes);
+        out.write(reinterpret_cast<const char *>(rows.data()), rows.size() * sizeof(double));
+        if (!out)
+            throw util::exception("Could not write to " + path.string() + SOURCE_REF);
+    }
+
+  private:
+    boost::filesystem::path path;
+    std::size_t row_bytes;
+    boost::filesystem::fstream out;
+};
+
+bool parseArguments(int argc, char *argv[], DistributedTableConfig &config)
+{
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    auto &coordinator = config.coordinator;
+    std::vector<std::string> backends;
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options()(
+        "backend,b",
+        boost::program_options::value<std::vector<std::string>>(&backends)
+            ->multitoken()
+            ->required(),
+        "host:port of an osrm-routed that searches blocks of the table, repeat for more "
+        "backends")(
+        "profile,p",
+        boost::program_options::value<std::string>(&coordinator.profile)
+            ->default_value("driving"),
+        "Profile of the table requests")(
+        "rows-per-block",
+        boost::program_options::value<std::size_t>(&coordinator.rows_per_block)
+            ->default_value(64),
+        "Number of source rows searched by a single request")(
+        "requests-per-backend",
+        boost::program_options::value<unsigned>(&coordinator.requests_per_backend)
+            ->default_value(2),
+        "Number of blocks a backend works on at once")(
+        "max-attempts",
+        boost::program_options::value<unsigned>(&coordinator.max_attempts)->default_value(3),
+        "Number of attempts of a block before the table fails")(
+        "block-timeout",
+        boost::program_options::value<unsigned>(&coordinator.block_timeout)->default_value(0),
+        "Deadline of a block request in milliseconds, 0 for the default of the backends")(
+        "distances",
+        boost::program_options::bool_switch(&coordinator.distances)->default_value(false),
+        "Compute the distance matrix, too")(
+        "output,o",
+        boost::program_options::value<boost::filesystem::path>(&config.output)->required(),
+        "Writes the matrices to <output>.durations and <output>.distances as row-major "
+        "little-endian float64, NaN for no route");
+
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "coordinates,c",
+        boost::program_options::value<boost::filesystem::path>(&config.coordinates_path),
+        "File with a longitude,latitude pair per line");
+
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("coordinates", 1);
+
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() +
+        " <coordinates.txt> --backend <host:port> --output <prefix> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    boost::program_options::variables_map option_variables;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                      .options(cmdline_options)
+                                      .positional(positional_options)
+                                      .run(),
+                                  option_variables);
+
+    if (option_variables.count("version"))
+    {
+        std::cout << OSRM_VERSION << std::endl;
+        return false;
+    }
+
+    if (option_variables.count("help") || !option_variables.count("coordinates"))
+    {
+        std::cout << visible_options;
+        return false;
+    }
+
+    boost::program_options::notify(option_variables);
+
+    for (const auto &backend : backends)
+    {
+        const auto separator = backend.rfind(':');
+        if (separator == std::string::npos || separator == 0 || separator + 1 == backend.size())
+            throw util::exception("Invalid backend " + backend + ", expected host:port" +
+                                  SOURCE_REF);
+        coordinator.backends.push_back(
+            {backend.substr(0, separator), backend.substr(separator + 1)});
+    }
+
+    return true;
+}
+}
+
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    DistributedTableConfig config;
+    if (!parseArguments(argc, argv, config))
+        return EXIT_SUCCESS;
+
+    const auto coordinates = readCoordinates(config.coordinates_path);
+    if (coordinates.size() < 2)
+        throw util::exception("A table needs at least two coordinates" + SOURCE_REF);
+
+    MatrixFile durations(config.output.string() + ".durations", coordinates.size());
+    std::unique_ptr<MatrixFile> distances;
+    if (config.coordinator.distances)
+        distances =
+            std::make_unique<MatrixFile>(config.output.string() + ".distances", coordinates.size());
+
+    util::Log() << "Computing a " << coordinates.size() << " x " << coordinates.size()
+                << " table on " << config.coordinator.backends.size() << " backends";
+    const auto start = std::chrono::steady_clock::now();
+
+    std::size_t rows_done = 0;
+    server::TableCoordinator coordinator(config.coordinator);
+    coordinator.Run(coordinates,
+                    [&](const server::TableBlock &block, const server::TableBlockResult &result) {
+                        durations.WriteRows(block.first_row, result.durations);
+                        if (distances)
+                            distances->WriteRows(block.first_row, result.distances);
+                        rows_done += block.number_of_rows;
+                    });
+
+    const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    util::Log() << rows_done << " rows in " << seconds.count() << " s";
+
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
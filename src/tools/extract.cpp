@@ -2,6 +2,7 @@
 #include "osrm/extractor.hpp"
 #include "osrm/extractor_config.hpp"
 #include "util/log.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/version.hpp"
 
 #include <tbb/task_scheduler_init.h>
@@ -24,11 +25,17 @@ enum class return_code : unsigned
     exit
 };
 
-return_code parseArguments(int argc, char *argv[], extractor::ExtractorConfig &extractor_config)
+return_code parseArguments(int argc,
+                           char *argv[],
+                           extractor::ExtractorConfig &extractor_config,
+                           boost::filesystem::path &phase_report_path)
 {
     // declare a group of options that will be allowed only on command line
     boost::program_options::options_description generic_options("Options");
-    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -56,7 +63,34 @@ return_code parseArguments(int argc, char *argv[], extractor::ExtractorConfig &e
             ->implicit_value(true)
             ->default_value(false),
         "Save conditional restrictions found during extraction to disk for use "
-        "during contraction");
+        "during contraction")(
+        "dense-node-locations",
+        boost::program_options::bool_switch(&extractor_config.use_dense_node_locations)
+            ->default_value(false),
+        "Store the node locations in a dense array indexed by the OSM node id instead of sorting "
+        "them (faster for planet sized extracts, needs 8 bytes for every id up to the largest "
+        "one).")(
+        "change-file",
+        boost::program_options::value<std::vector<boost::filesystem::path>>(
+            &extractor_config.change_paths)
+            ->composing(),
+        "OSM change file (.osc) applied to the input while it is read, can be given several "
+        "times and is applied in that order. The input has to be sorted by type and id.")(
+        "external-sort-memory",
+        boost::program_options::value<unsigned>(&extractor_config.external_sort_memory)
+            ->default_value(0),
+        "Sort the nodes through temporary files next to the output with this many MiB of "
+        "memory, only the nodes used by ways are kept in memory (0 keeps all nodes in memory).")(
+        "two-pass-parsing",
+        boost::program_options::bool_switch(&extractor_config.two_pass_parsing)
+            ->default_value(false),
+        "Read the ways of the input first and only parse the nodes of ways with one of the "
+        "way_prefilter_keys of the profile, skipping all other nodes and ways.")(
+        "compress-intermediate-files",
+        boost::program_options::bool_switch(&extractor_config.compress_intermediate_files)
+            ->default_value(false),
+        "Compress the files only read by osrm-contract and osrm-partition (.osrm.ebg, "
+        ".osrm.enw and .osrm.cnbg) in blocks, which saves time on slow disks.");
 
     bool dummy;
     // hidden options, will be allowed on command line, but will not be
@@ -128,7 +162,8 @@ int main(int argc, char *argv[]) try
     util::LogPolicy::GetInstance().Unmute();
     extractor::ExtractorConfig extractor_config;
 
-    const auto result = parseArguments(argc, argv, extractor_config);
+    boost::filesystem::path phase_report_path;
+    const auto result = parseArguments(argc, argv, extractor_config, phase_report_path);
 
     if (return_code::fail == result)
     {
@@ -155,6 +190,15 @@ int main(int argc, char *argv[]) try
         return EXIT_FAILURE;
     }
 
+    for (const auto &change_path : extractor_config.change_paths)
+    {
+        if (!boost::filesystem::is_regular_file(change_path))
+        {
+            util::Log(logERROR) << "Change file " << change_path.string() << " not found!";
+            return EXIT_FAILURE;
+        }
+    }
+
     if (!boost::filesystem::is_regular_file(extractor_config.profile_path))
     {
         util::Log(logERROR) << "Profile " << extractor_config.profile_path.string()
@@ -162,6 +206,7 @@ int main(int argc, char *argv[]) try
         return EXIT_FAILURE;
     }
 
+    util::PhaseReport phase_report("osrm-extract", phase_report_path);
     osrm::extract(extractor_config);
 
     util::DumpSTXXLStats();
@@ -1,3 +1,5 @@
+#include "storage/io.hpp"
+
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/log.hpp"
@@ -16,8 +18,11 @@
 #include <algorithm>
 #include <chrono>
 #include <iomanip>
+#include <memory>
 #include <numeric>
 #include <random>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -45,6 +50,46 @@ void runStatistics(std::vector<double> &timings_vector, Statistics &stats)
         timings_vector.begin(), timings_vector.end(), timings_vector.begin(), 0.0);
     stats.dev = std::sqrt(primary_sq_sum / timings_vector.size() - (stats.mean * stats.mean));
 }
+
+// Reads every file in one ReadInto with each read mode of the FileReader, like osrm-datastore
+// reads the large vectors of the .osrm files
+void benchmarkFileReader(const std::vector<boost::filesystem::path> &paths)
+{
+    using storage::io::FileReader;
+    const std::vector<std::pair<FileReader::ReadMode, const char *>> read_modes = {
+        {FileReader::StreamRead, "stream"},
+        {FileReader::BulkRead, "bulk"},
+        {FileReader::DirectRead, "direct"}};
+
+    for (const auto &path : paths)
+    {
+        for (const auto &read_mode : read_modes)
+        {
+#ifdef __linux__
+            // drop the cached pages of the file so every mode reads from the device
+            const auto file_desc = open(path.string().c_str(), O_RDONLY);
+            if (file_desc >= 0)
+            {
+                fdatasync(file_desc);
+                posix_fadvise(file_desc, 0, 0, POSIX_FADV_DONTNEED);
+                close(file_desc);
+            }
+#endif
+            FileReader reader(path, FileReader::HasNoFingerprint, read_mode.first);
+            const auto size = reader.GetSize();
+            std::unique_ptr<char[]> buffer(new char[size]);
+
+            TIMER_START(read_file);
+            reader.ReadInto(buffer.get(), size);
+            TIMER_STOP(read_file);
+
+            util::Log() << path.filename().string() << " " << read_mode.second << " read of "
+                        << size << " bytes: " << std::setprecision(5) << std::fixed
+                        << size / (1024. * 1024.) / std::max(TIMER_SEC(read_file), 1e-6)
+                        << "MB/sec";
+        }
+    }
+}
 }
 }
 
@@ -66,9 +111,18 @@ int main(int argc, char *argv[])
     if (1 == argc)
     {
         osrm::util::Log(logWARNING) << "usage: " << argv[0] << " /path/on/device";
+        osrm::util::Log(logWARNING) << "       " << argv[0] << " --files data.osrm.hsgr ...";
         return -1;
     }
 
+    // compare the read modes of the FileReader on real files
+    if (std::string(argv[1]) == "--files")
+    {
+        osrm::tools::benchmarkFileReader(
+            std::vector<boost::filesystem::path>(argv + 2, argv + argc));
+        return EXIT_SUCCESS;
+    }
+
     test_path = boost::filesystem::path(argv[1]);
     test_path /= "osrm.tst";
     osrm::util::Log(logDEBUG) << "temporary file: " << test_path.string();
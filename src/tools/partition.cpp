@@ -4,6 +4,7 @@
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
 #include "util/meminfo.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/timing_util.hpp"
 #include "util/version.hpp"
 
@@ -69,11 +70,19 @@ void validate(boost::any &v, const std::vector<std::string> &values, MaxCellSize
     v = boost::any(MaxCellSizesArgument{output});
 }
 
-return_code parseArguments(int argc, char *argv[], partition::PartitionConfig &config)
+return_code parseArguments(int argc,
+                           char *argv[],
+                           partition::PartitionConfig &config,
+                           boost::filesystem::path &phase_report_path)
 {
     // declare a group of options that will be allowed only on command line
     boost::program_options::options_description generic_options("Options");
-    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
+
+    std::string max_flow;
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -107,7 +116,37 @@ return_code parseArguments(int argc, char *argv[], partition::PartitionConfig &c
          boost::program_options::value<MaxCellSizesArgument>()->default_value(
              MaxCellSizesArgument{config.max_cell_sizes}),
          "Maximum cell sizes starting from the level 1. The first cell size value is a bisection "
-         "termination citerion");
+         "termination citerion")
+        //
+        ("max-flow",
+         boost::program_options::value<std::string>(&max_flow)->default_value("dinic"),
+         "Max-flow algorithm of the inertial flow cuts: dinic or push-relabel")
+        //
+        ("subtree-depth",
+         boost::program_options::value<std::size_t>(&config.subtree_depth)
+             ->default_value(config.subtree_depth),
+         "Number of bisection levels computed on the whole graph. The parts below are written "
+         "to temporary files and bisected one at a time to bound the memory use. 0 disables it.")
+        //
+        ("tune-max-cell-sizes",
+         boost::program_options::value<std::vector<MaxCellSizesArgument>>()->multitoken(),
+         "Compare these comma separated maximum cell sizes by the arcs of random queries, the "
+         "arcs of the customization and the memory of the cell storage, and recommend one. "
+         "Nothing is written unless --tune-write is given.")
+        //
+        ("tune-queries",
+         boost::program_options::value<std::size_t>(&config.tune_number_of_queries)
+             ->default_value(config.tune_number_of_queries),
+         "Number of random queries of --tune-max-cell-sizes")
+        //
+        ("tune-write",
+         boost::program_options::bool_switch(&config.tune_write)->default_value(false),
+         "Write the partition of the recommended --tune-max-cell-sizes")
+        //
+        ("shards",
+         boost::program_options::value<std::uint32_t>(&config.num_shards)->default_value(0),
+         "Log how the top level cells would be split over this many shards: the nodes and edges "
+         "of the base graph of every shard and the size of the overlay all shards share.");
 
     // hidden options, will be allowed on command line, but will not be
     // shown to the user
@@ -178,6 +217,42 @@ return_code parseArguments(int argc, char *argv[], partition::PartitionConfig &c
         }
     }
 
+    if (option_variables.count("tune-max-cell-sizes"))
+    {
+        for (const auto &candidate :
+             option_variables["tune-max-cell-sizes"].as<std::vector<MaxCellSizesArgument>>())
+        {
+            if (candidate.value.empty() ||
+                !std::is_sorted(candidate.value.begin(), candidate.value.end()))
+            {
+                util::Log(logERROR) << "The maximum cell sizes of --tune-max-cell-sizes must be "
+                                       "sorted in non-descending order.";
+                return return_code::fail;
+            }
+            config.tune_max_cell_sizes.push_back(candidate.value);
+        }
+    }
+    else if (config.tune_write)
+    {
+        util::Log(logERROR) << "--tune-write needs --tune-max-cell-sizes";
+        return return_code::fail;
+    }
+
+    if (max_flow == "dinic")
+    {
+        config.max_flow = partition::MaxFlowAlgorithm::Dinic;
+    }
+    else if (max_flow == "push-relabel")
+    {
+        config.max_flow = partition::MaxFlowAlgorithm::PushRelabel;
+    }
+    else
+    {
+        util::Log(logERROR) << "Unknown max-flow algorithm " << max_flow
+                            << ", use dinic or push-relabel.";
+        return return_code::fail;
+    }
+
     return return_code::ok;
 }
 
@@ -186,7 +261,8 @@ int main(int argc, char *argv[]) try
     util::LogPolicy::GetInstance().Unmute();
     partition::PartitionConfig partition_config;
 
-    const auto result = parseArguments(argc, argv, partition_config);
+    boost::filesystem::path phase_report_path;
+    const auto result = parseArguments(argc, argv, partition_config, phase_report_path);
 
     if (return_code::fail == result)
     {
@@ -230,6 +306,7 @@ int main(int argc, char *argv[]) try
     BOOST_ASSERT(init.is_active());
     util::Log() << "Computing recursive bisection";
 
+    util::PhaseReport phase_report("osrm-partition", phase_report_path);
     TIMER_START(bisect);
     auto exitcode = partition::Partitioner().Run(partition_config);
     TIMER_STOP(bisect);
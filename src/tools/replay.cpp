@@ -0,0 +1,382 @@
+#include "server/api/url_parser.hpp"
+#include "server/query_log.hpp"
+#include "server/query_replay.hpp"
+#include "server/service_handler.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
+#include "util/version.hpp"
+
+#include "osrm/engine_config.hpp"
+#include "osrm/exception.hpp"
+#include "osrm/storage_config.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+struct ReplayConfig
+{
+    boost::filesystem::path log_path;
+    EngineConfig engine_config;
+    std::string algorithm = "ch";
+    unsigned threads = 1;
+    // 0 replays as fast as possible, 1 at the pace of the log, 2 twice as fast
+    double speed = 0.;
+    boost::filesystem::path output = "-";
+};
+
+EngineConfig::Algorithm stringToAlgorithm(std::string algorithm)
+{
+    boost::to_lower(algorithm);
+
+    if (algorithm == "ch")
+        return EngineConfig::Algorithm::CH;
+    if (algorithm == "corech")
+        return EngineConfig::Algorithm::CoreCH;
+    if (algorithm == "mld")
+        return EngineConfig::Algorithm::MLD;
+    if (algorithm == "cch")
+        return EngineConfig::Algorithm::CCH;
+    throw util::RuntimeError(algorithm, ErrorCode::UnknownAlgorithm, SOURCE_REF);
+}
+
+// What the requests of one service took, in the log and in the replay
+struct ServiceReport
+{
+    std::vector<double> recorded_ms;
+    std::vector<double> replayed_ms;
+    // replies with another status than the recorded one
+    std::size_t status_mismatches = 0;
+    std::size_t errors = 0;
+};
+
+double percentile(const std::vector<double> &sorted, const double fraction)
+{
+    if (sorted.empty())
+        return 0.;
+    const auto index = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, index == 0 ? 0 : index - 1)];
+}
+
+util::json::Object latencyReport(std::vector<double> latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+    util::json::Object latency;
+    latency.values["p50"] = percentile(latencies, 0.5);
+    latency.values["p90"] = percentile(latencies, 0.9);
+    latency.values["p99"] = percentile(latencies, 0.99);
+    latency.values["max"] = latencies.empty() ? 0. : latencies.back();
+    return latency;
+}
+
+util::json::Object replay(const ReplayConfig &config)
+{
+    std::vector<server::QueryRecord> records;
+    server::QueryLogReader reader(config.log_path);
+    for (server::QueryRecord record; reader.Next(record);)
+        records.push_back(std::move(record));
+    if (records.empty())
+        throw util::exception(config.log_path.string() + " has no requests" + SOURCE_REF);
+    // requests are logged when they finish, they are replayed in the order they arrived
+    std::stable_sort(records.begin(), records.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.timestamp_us < rhs.timestamp_us;
+    });
+    util::Log() << "Replaying " << records.size() << " requests with " << config.threads
+                << " threads";
+
+    auto engine_config = config.engine_config;
+    server::ServiceHandler handler(engine_config);
+
+    std::vector<std::string> services(records.size());
+    for (std::size_t index = 0; index < records.size(); ++index)
+    {
+        const auto parsed_url = server::api::parseURL(records[index].url);
+        services[index] = parsed_url ? parsed_url->service : "invalid";
+    }
+
+    std::vector<double> replayed_ms(records.size());
+    std::vector<std::uint16_t> replayed_status(records.size());
+    // how much later than scheduled by the pace of the log the requests started
+    std::vector<double> lag_ms(records.size());
+
+    const auto first_timestamp = records.front().timestamp_us;
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next_record{0};
+    std::vector<std::thread> threads;
+    for (unsigned thread = 0; thread < config.threads; ++thread)
+    {
+        threads.emplace_back([&] {
+            for (auto index = next_record++; index < records.size(); index = next_record++)
+            {
+                const auto &record = records[index];
+                if (config.speed > 0)
+                {
+                    const auto offset_us = record.timestamp_us - first_timestamp;
+                    const auto scheduled =
+                        start + std::chrono::microseconds(
+                                    static_cast<std::int64_t>(offset_us / config.speed));
+                    std::this_thread::sleep_until(scheduled);
+                    lag_ms[index] = std::chrono::duration<double, std::milli>(
+                                        std::chrono::steady_clock::now() - scheduled)
+                                        .count();
+                }
+
+                const auto request_start = std::chrono::steady_clock::now();
+                try
+                {
+                    replayed_status[index] = server::runRecordedQuery(handler, record);
+                }
+                catch (const std::exception &e)
+                {
+                    util::Log(logWARNING) << e.what() << ", url: " << record.url;
+                    replayed_status[index] = 500;
+                }
+                replayed_ms[index] = std::chrono::duration<double, std::milli>(
+                                         std::chrono::steady_clock::now() - request_start)
+                                         .count();
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    const auto wall_time =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::map<std::string, ServiceReport> reports;
+    for (std::size_t index = 0; index < records.size(); ++index)
+    {
+        auto &report = reports[services[index]];
+        report.recorded_ms.push_back(records[index].latency_us / 1000.);
+        report.replayed_ms.push_back(replayed_ms[index]);
+        if (replayed_status[index] != records[index].status)
+            ++report.status_mismatches;
+        if (replayed_status[index] != 200)
+            ++report.errors;
+    }
+
+    util::json::Object services_json;
+    std::size_t status_mismatches = 0;
+    for (const auto &service : reports)
+    {
+        util::json::Object service_json;
+        service_json.values["requests"] = static_cast<double>(service.second.replayed_ms.size());
+        service_json.values["errors"] = static_cast<double>(service.second.errors);
+        service_json.values["status_mismatches"] =
+            static_cast<double>(service.second.status_mismatches);
+        service_json.values["recorded_latency_ms"] = latencyReport(service.second.recorded_ms);
+        service_json.values["replayed_latency_ms"] = latencyReport(service.second.replayed_ms);
+        services_json.values[service.first] = std::move(service_json);
+        status_mismatches += service.second.status_mismatches;
+    }
+
+    // the time the requests span in the log
+    const auto recorded_time = (records.back().timestamp_us - first_timestamp) / 1e6;
+
+    const auto statistics = handler.GetEngineStatistics();
+    util::json::Object report;
+    report.values["requests"] = static_cast<double>(records.size());
+    report.values["status_mismatches"] = static_cast<double>(status_mismatches);
+    report.values["wall_time"] = wall_time;
+    report.values["recorded_time"] = recorded_time;
+    report.values["throughput"] = wall_time > 0 ? records.size() / wall_time : 0.;
+    if (config.speed > 0)
+        report.values["lag_ms"] = latencyReport(lag_ms);
+    report.values["recorded_latency_ms"] = latencyReport(
+        [&] {
+            std::vector<double> latencies;
+            for (const auto &record : records)
+                latencies.push_back(record.latency_us / 1000.);
+            return latencies;
+        }());
+    report.values["replayed_latency_ms"] = latencyReport(replayed_ms);
+    // datasets osrm-datastore swapped in while replaying from shared memory
+    report.values["data_updates"] = static_cast<double>(statistics.data_updates.updates);
+    report.values["services"] = std::move(services_json);
+
+    util::Log() << records.size() << " requests in " << wall_time << " s, "
+                << records.size() / std::max(wall_time, 1e-9) << " requests/s, "
+                << status_mismatches << " replies with another status than recorded";
+
+    return report;
+}
+
+bool parseArguments(int argc, char *argv[], ReplayConfig &config)
+{
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    auto &engine_config = config.engine_config;
+    boost::filesystem::path base_path;
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options()(
+        "log,l",
+        boost::program_options::value<boost::filesystem::path>(&config.log_path)->required(),
+        "Query log written by osrm-routed --query-log")(
+        "algorithm,a",
+        boost::program_options::value<std::string>(&config.algorithm)->default_value("ch"),
+        "Algorithm to use for the data. Can be CH, CoreCH, MLD or CCH.")(
+        "shared-memory,s",
+        boost::program_options::bool_switch(&engine_config.use_shared_memory)
+            ->default_value(false),
+        "Use the data loaded by osrm-datastore, datasets it swaps in are picked up while "
+        "replaying")("threads,t",
+                     boost::program_options::value<unsigned>(&config.threads)->default_value(1),
+                     "Number of threads that replay requests")(
+        "speed",
+        boost::program_options::value<double>(&config.speed)->default_value(0.),
+        "Pace of the replay relative to the log, e.g. 1 at the original pace or 2 twice as "
+        "fast. 0 sends the requests as fast as possible")(
+        "max-viaroute-size",
+        boost::program_options::value<int>(&engine_config.max_locations_viaroute)
+            ->default_value(500),
+        "Max. locations supported in viaroute query")(
+        "max-trip-size",
+        boost::program_options::value<int>(&engine_config.max_locations_trip)
+            ->default_value(100),
+        "Max. locations supported in trip query")(
+        "max-table-size",
+        boost::program_options::value<int>(&engine_config.max_locations_distance_table)
+            ->default_value(100),
+        "Max. locations supported in distance table query")(
+        "max-matching-size",
+        boost::program_options::value<int>(&engine_config.max_locations_map_matching)
+            ->default_value(100),
+        "Max. locations supported in map matching query")(
+        "max-nearest-size",
+        boost::program_options::value<int>(&engine_config.max_results_nearest)
+            ->default_value(100),
+        "Max. results supported in nearest query")(
+        "max-isochrone-duration",
+        boost::program_options::value<int>(&engine_config.max_isochrone_duration)
+            ->default_value(3600),
+        "Max. duration in seconds of the contours of isochrone queries")(
+        "output,o",
+        boost::program_options::value<boost::filesystem::path>(&config.output)
+            ->default_value("-"),
+        "File to write the JSON report to, - for standard output");
+
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()("base,b",
+                                 boost::program_options::value<boost::filesystem::path>(&base_path),
+                                 "base path to .osrm file");
+
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("base", 1);
+
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() +
+        " [<base.osrm>] --log <queries.log> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    boost::program_options::variables_map option_variables;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                      .options(cmdline_options)
+                                      .positional(positional_options)
+                                      .run(),
+                                  option_variables);
+
+    if (option_variables.count("version"))
+    {
+        std::cout << OSRM_VERSION << std::endl;
+        return false;
+    }
+
+    // the data comes either from the base path or from shared memory
+    const bool shared_memory = option_variables["shared-memory"].as<bool>();
+    if (option_variables.count("help") || (option_variables.count("base") > 0) == shared_memory)
+    {
+        std::cout << visible_options;
+        return false;
+    }
+
+    boost::program_options::notify(option_variables);
+
+    if (!base_path.empty())
+        engine_config.storage_config = storage::StorageConfig(base_path);
+    engine_config.algorithm = stringToAlgorithm(config.algorithm);
+    config.threads = std::max(1u, config.threads);
+    if (config.speed < 0)
+        throw util::exception("The speed has to be at least 0" + SOURCE_REF);
+
+    return true;
+}
+}
+
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    ReplayConfig config;
+    if (!parseArguments(argc, argv, config))
+        return EXIT_SUCCESS;
+
+    if (!config.engine_config.IsValid())
+    {
+        util::Log(logERROR) << "Required files are missing, cannot continue";
+        return EXIT_FAILURE;
+    }
+
+    // the report goes to standard output, so does the log
+    if (config.output == "-")
+        util::LogPolicy::GetInstance().Mute();
+
+    auto report = replay(config);
+    report.values["log"] = config.log_path.string();
+    report.values["algorithm"] = config.algorithm;
+    report.values["threads"] = static_cast<double>(config.threads);
+    report.values["speed"] = config.speed;
+
+    if (config.output == "-")
+    {
+        util::json::render(std::cout, report);
+        std::cout << std::endl;
+    }
+    else
+    {
+        boost::filesystem::ofstream out(config.output);
+        if (!out)
+            throw util::exception("Could not open " + config.output.string() + " for writing" +
+                                  SOURCE_REF);
+        util::json::render(out, report);
+        out << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::LogPolicy::GetInstance().Unmute();
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const std::exception &e)
+{
+    util::LogPolicy::GetInstance().Unmute();
+    util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
@@ -1,3 +1,4 @@
+#include "server/query_replay.hpp"
 #include "server/server.hpp"
 #include "util/exception_utils.hpp"
 #include "util/log.hpp"
@@ -10,6 +11,8 @@
 #include "osrm/storage_config.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/any.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
@@ -18,6 +21,7 @@
 
 #include <signal.h>
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
 #include <future>
@@ -26,6 +30,7 @@
 #include <new>
 #include <string>
 #include <thread>
+#include <vector>
 
 #ifdef _WIN32
 boost::function0<void> console_ctrl_function;
@@ -62,6 +67,8 @@ static EngineConfig::Algorithm stringToAlgorithm(std::string algorithm)
         return EngineConfig::Algorithm::CoreCH;
     if (algorithm == "mld")
         return EngineConfig::Algorithm::MLD;
+    if (algorithm == "cch")
+        return EngineConfig::Algorithm::CCH;
     throw util::RuntimeError(algorithm, ErrorCode::UnknownAlgorithm, SOURCE_REF);
 }
 
@@ -71,8 +78,31 @@ inline unsigned generateServerProgramOptions(const int argc,
                                              boost::filesystem::path &base_path,
                                              std::string &ip_address,
                                              int &ip_port,
+                                             std::string &unix_socket,
+                                             bool &unix_socket_only,
                                              int &requested_num_threads,
+                                             int &keepalive_timeout,
+                                             int &keepalive_max_requests,
+                                             bool &use_sharding,
+                                             server::http::compression_levels &compression_levels,
+                                             std::vector<std::string> &service_cost_limits,
+                                             int &max_queued_requests,
+                                             int &max_queue_wait,
+                                             std::vector<std::string> &service_threads,
+                                             std::vector<std::string> &service_priorities,
+                                             int &io_threads,
+                                             bool &enable_metrics,
+                                             boost::filesystem::path &query_log,
+                                             double &query_log_sample_rate,
+                                             int &table_stream_rows,
                                              bool &use_shared_memory,
+                                             bool &use_huge_pages,
+                                             bool &lock_memory,
+                                             bool &compress_geometry,
+                                             std::string &numa_placement,
+                                             std::string &memory_file,
+                                             std::vector<std::string> &memory_advice,
+                                             std::vector<std::string> &profile_datasets,
                                              std::string &algorithm,
                                              bool &trial,
                                              int &max_locations_trip,
@@ -80,7 +110,27 @@ inline unsigned generateServerProgramOptions(const int argc,
                                              int &max_locations_distance_table,
                                              int &max_locations_map_matching,
                                              int &max_results_nearest,
-                                             int &max_alternatives)
+                                             int &max_alternatives,
+                                             int &max_isochrone_duration,
+                                             int &default_timeout,
+                                             int &max_cached_heaps,
+                                             bool &warmup,
+                                             boost::filesystem::path &warmup_query_log,
+                                             int &max_cached_routes,
+                                             int &max_reroute_destinations,
+                                             int &max_cached_snappings,
+                                             int &max_cached_unpackings,
+                                             int &max_cached_tiles,
+                                             std::string &tile_cache_directory,
+                                             int &max_matching_sessions,
+                                             int &matching_session_ttl,
+                                             int &min_parallel_table_size,
+                                             int &min_rphast_table_size,
+                                             int &min_fused_table_size,
+                                             int &min_parallel_match_size,
+                                             int &min_parallel_route_size,
+                                             int &min_parallel_search_distance,
+                                             bool &coalesce_requests)
 {
     using boost::program_options::value;
     using boost::filesystem::path;
@@ -100,15 +150,106 @@ inline unsigned generateServerProgramOptions(const int argc,
         ("port,p",
          value<int>(&ip_port)->default_value(5000),
          "TCP/IP port") //
+        ("unix-socket",
+         value<std::string>(&unix_socket),
+         "Also listen on a unix domain socket at this path, for clients on the same host") //
+        ("unix-socket-only",
+         value<bool>(&unix_socket_only)->implicit_value(true)->default_value(false),
+         "Only listen on the --unix-socket, not on TCP/IP") //
         ("threads,t",
          value<int>(&requested_num_threads)->default_value(8),
          "Number of threads to use") //
+        ("keepalive-timeout,k",
+         value<int>(&keepalive_timeout)->default_value(5),
+         "Seconds an idle persistent HTTP connection is kept open, 0 disables keep-alive") //
+        ("keepalive-requests",
+         value<int>(&keepalive_max_requests)->default_value(512),
+         "Max. number of requests served over a single persistent HTTP connection") //
+        ("sharded-acceptors",
+         value<bool>(&use_sharding)->implicit_value(true)->default_value(false),
+         "Run one io_service and SO_REUSEPORT acceptor per thread, pinned to a core") //
+        ("gzip-level",
+         value<int>(&compression_levels.zlib)->default_value(compression_levels.zlib),
+         "Compression level for gzip and deflate encoded replies (1-9)") //
+        ("brotli-level",
+         value<int>(&compression_levels.brotli)->default_value(compression_levels.brotli),
+         "Compression level for brotli encoded replies (0-11)") //
+        ("zstd-level",
+         value<int>(&compression_levels.zstd)->default_value(compression_levels.zstd),
+         "Compression level for zstd encoded replies (1-22)") //
+        ("max-service-cost",
+         value<std::vector<std::string>>(&service_cost_limits)->composing(),
+         "Limit the summed number of coordinates of concurrently running requests of a service, "
+         "e.g. table=2000. Can be given once per service, services are unlimited by default") //
+        ("max-queued-requests",
+         value<int>(&max_queued_requests)->default_value(64),
+         "Max. requests waiting for a limited service before it answers with 503") //
+        ("max-queue-wait",
+         value<int>(&max_queue_wait)->default_value(1000),
+         "Max. milliseconds a request waits for a limited service before it answers with 503") //
+        ("service-threads",
+         value<std::vector<std::string>>(&service_threads)->composing(),
+         "Run the requests of services on a worker pool of their own, e.g. match,trip=2. Can be "
+         "given once per pool, other services run on a default pool of --threads workers") //
+        ("service-priority",
+         value<std::vector<std::string>>(&service_priorities)->composing(),
+         "Run the requests of a service before those of services with a lower priority on the "
+         "same worker pool, e.g. route=10. Services have priority 0 by default") //
+        ("io-threads",
+         value<int>(&io_threads)->default_value(2),
+         "Number of threads parsing and dispatching requests to the worker pools, only used "
+         "with --service-threads or --service-priority") //
+        ("metrics",
+         value<bool>(&enable_metrics)->implicit_value(true)->default_value(false),
+         "Collect per-service metrics and serve them in Prometheus format on /metrics") //
+        ("query-log",
+         value<boost::filesystem::path>(&query_log),
+         "Record the requests with their arrival time, latency and status to this binary file "
+         "for osrm-replay") //
+        ("query-log-sample-rate",
+         value<double>(&query_log_sample_rate)->default_value(1.),
+         "Fraction of the requests to record to the query log") //
+        ("table-stream-rows",
+         value<int>(&table_stream_rows)->default_value(0),
+         "Send table responses in chunks of this many rows while the rest is computed, which "
+         "repeats the searches from the destinations for every chunk. 0 sends whole tables") //
         ("shared-memory,s",
          value<bool>(&use_shared_memory)->implicit_value(true)->default_value(false),
          "Load data from shared memory") //
+        ("huge-pages",
+         value<bool>(&use_huge_pages)->implicit_value(true)->default_value(false),
+         "Back the data read into memory with huge pages, or transparent huge pages if there "
+         "are none reserved") //
+        ("lock-memory",
+         value<bool>(&lock_memory)->implicit_value(true)->default_value(false),
+         "Lock the data read into memory or mapped from the memory file into RAM, needs an "
+         "RLIMIT_MEMLOCK (ulimit -l) of at least its size") //
+        ("compress-geometry",
+         value<bool>(&compress_geometry)->implicit_value(true)->default_value(false),
+         "Delta encode the nodes of the geometries read into memory, which saves memory but "
+         "decodes them on every access") //
+        ("numa",
+         value<std::string>(&numa_placement)->default_value("none"),
+         "Placement of the data read into memory on NUMA nodes. Can be none, interleave to "
+         "spread its pages over all nodes or replicate to load a copy on every node and pin "
+         "the server threads to the nodes") //
+        ("memory-file",
+         value<std::string>(&memory_file),
+         "Map the data from this file instead of reading it into memory. The file is written "
+         "from the .osrm files when it is missing or older than them") //
+        ("memory-advice",
+         value<std::vector<std::string>>(&memory_advice)->composing(),
+         "Advise the kernel how a block of the memory file is accessed, e.g. "
+         "CH_GRAPH_EDGE_LIST=random. Can be normal, random, sequential or willneed, given once "
+         "per block") //
+        ("dataset",
+         value<std::vector<std::string>>(&profile_datasets)->composing(),
+         "Serve the requests of a profile from another dataset, e.g. bike=/data/bike.osrm. Can "
+         "be given once per profile, other profiles are served from the base path or shared "
+         "memory") //
         ("algorithm,a",
          value<std::string>(&algorithm)->default_value("CH"),
-         "Algorithm to use for the data. Can be CH, CoreCH, MLD.") //
+         "Algorithm to use for the data. Can be CH, CoreCH, MLD, CCH.") //
         ("max-viaroute-size",
          value<int>(&max_locations_viaroute)->default_value(500),
          "Max. locations supported in viaroute query") //
@@ -126,7 +267,79 @@ inline unsigned generateServerProgramOptions(const int argc,
          "Max. results supported in nearest query") //
         ("max-alternatives",
          value<int>(&max_alternatives)->default_value(3),
-         "Max. number of alternatives supported in the MLD route query");
+         "Max. number of alternatives supported in the MLD route query") //
+        ("max-isochrone-duration",
+         value<int>(&max_isochrone_duration)->default_value(3600),
+         "Max. duration in seconds of the contours of isochrone queries, -1 for no limit") //
+        ("request-timeout",
+         value<int>(&default_timeout)->default_value(-1),
+         "Abort queries running longer than this many milliseconds, -1 for no limit. "
+         "Requests can lower it with the X-OSRM-Timeout header.") //
+        ("max-cached-heaps",
+         value<int>(&max_cached_heaps)->default_value(-1),
+         "Max. number of search heap sets kept for reuse between queries, -1 for no limit") //
+        ("warmup",
+         value<bool>(&warmup)->implicit_value(true)->default_value(false),
+         "Create the search heaps of all threads sized to the graph on startup") //
+        ("warmup-query-log",
+         value<boost::filesystem::path>(&warmup_query_log),
+         "Replay the requests of a query log written with --query-log on all threads before "
+         "reporting that the server is ready") //
+        ("max-cached-routes",
+         value<int>(&max_cached_routes)->default_value(0),
+         "Max. number of route query paths cached between snapped coordinates, 0 to disable") //
+        ("max-reroute-destinations",
+         value<int>(&max_reroute_destinations)->default_value(0),
+         "Max. number of destinations of CH route queries with reroute=true whose reverse "
+         "search space is cached for re-routes, 0 to disable") //
+        ("max-cached-snappings",
+         value<int>(&max_cached_snappings)->default_value(0),
+         "Max. number of coordinates whose snapping is cached for route, table and trip "
+         "queries, 0 to disable") //
+        ("max-cached-unpackings",
+         value<int>(&max_cached_unpackings)->default_value(0),
+         "Max. number of CH shortcuts whose original edges are cached for unpacking paths, "
+         "0 to disable") //
+        ("max-cached-tiles",
+         value<int>(&max_cached_tiles)->default_value(0),
+         "Max. number of rendered tiles kept in memory, 0 to disable") //
+        ("tile-cache-directory",
+         value<std::string>(&tile_cache_directory),
+         "Store rendered tiles below this directory by dataset timestamp and serve them from "
+         "there, even after a restart") //
+        ("max-matching-sessions",
+         value<int>(&max_matching_sessions)->default_value(0),
+         "Max. number of match sessions whose traces are kept between requests, 0 to disable") //
+        ("matching-session-ttl",
+         value<int>(&matching_session_ttl)->default_value(300),
+         "Drop match sessions that had no request for this many seconds") //
+        ("min-parallel-table-size",
+         value<int>(&min_parallel_table_size)->default_value(-1),
+         "Run the searches of tables with at least this many sources times destinations on all "
+         "cores, -1 to never") //
+        ("min-rphast-table-size",
+         value<int>(&min_rphast_table_size)->default_value(1000000),
+         "Sweep the downward graph of the destinations for CH tables with at least this many "
+         "sources times destinations, -1 to never") //
+        ("min-fused-table-size",
+         value<int>(&min_fused_table_size)->default_value(0),
+         "Search backward and forward from every coordinate in one pass for tables whose sources "
+         "are their destinations with at least this many entries, -1 to never") //
+        ("min-parallel-match-size",
+         value<int>(&min_parallel_match_size)->default_value(-1),
+         "Match the parts between the time gaps of traces with at least this many coordinates "
+         "on all cores, -1 to never") //
+        ("min-parallel-route-size",
+         value<int>(&min_parallel_route_size)->default_value(-1),
+         "Search and assemble the legs of routes with at least this many coordinates on all "
+         "cores, -1 to never") //
+        ("min-parallel-search-distance",
+         value<int>(&min_parallel_search_distance)->default_value(-1),
+         "Run the forward and the reverse search of MLD routes between two coordinates at least "
+         "this many meters apart on two threads, -1 to never") //
+        ("coalesce-requests",
+         value<bool>(&coalesce_requests)->implicit_value(true)->default_value(false),
+         "Compute identical route and tile requests running at the same time only once");
 
     // hidden options, will be allowed on command line, but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -199,18 +412,60 @@ int main(int argc, const char *argv[]) try
 
     bool trial_run = false;
     std::string ip_address;
-    int ip_port, requested_thread_num;
+    int ip_port, requested_thread_num, keepalive_timeout, keepalive_max_requests;
+    std::string unix_socket;
+    bool unix_socket_only = false;
+    bool use_sharding = false;
+    server::http::compression_levels compression_levels;
+    std::vector<std::string> service_cost_limits;
+    int max_queued_requests, max_queue_wait;
+    std::vector<std::string> service_threads;
+    std::vector<std::string> service_priorities;
+    int io_threads;
+    bool enable_metrics = false;
+    boost::filesystem::path query_log;
+    double query_log_sample_rate = 1.;
+    int table_stream_rows = 0;
+    bool warmup = false;
+    boost::filesystem::path warmup_query_log;
 
     EngineConfig config;
     boost::filesystem::path base_path;
     std::string algorithm;
+    std::string numa_placement;
+    bool compress_geometry = false;
+    std::vector<std::string> memory_advice;
+    std::vector<std::string> profile_datasets;
     const unsigned init_result = generateServerProgramOptions(argc,
                                                               argv,
                                                               base_path,
                                                               ip_address,
                                                               ip_port,
+                                                              unix_socket,
+                                                              unix_socket_only,
                                                               requested_thread_num,
+                                                              keepalive_timeout,
+                                                              keepalive_max_requests,
+                                                              use_sharding,
+                                                              compression_levels,
+                                                              service_cost_limits,
+                                                              max_queued_requests,
+                                                              max_queue_wait,
+                                                              service_threads,
+                                                              service_priorities,
+                                                              io_threads,
+                                                              enable_metrics,
+                                                              query_log,
+                                                              query_log_sample_rate,
+                                                              table_stream_rows,
                                                               config.use_shared_memory,
+                                                              config.use_huge_pages,
+                                                              config.lock_memory,
+                                                              compress_geometry,
+                                                              numa_placement,
+                                                              config.memory_file,
+                                                              memory_advice,
+                                                              profile_datasets,
                                                               algorithm,
                                                               trial_run,
                                                               config.max_locations_trip,
@@ -218,7 +473,27 @@ int main(int argc, const char *argv[]) try
                                                               config.max_locations_distance_table,
                                                               config.max_locations_map_matching,
                                                               config.max_results_nearest,
-                                                              config.max_alternatives);
+                                                              config.max_alternatives,
+                                                              config.max_isochrone_duration,
+                                                              config.default_timeout,
+                                                              config.max_cached_heaps,
+                                                              warmup,
+                                                              warmup_query_log,
+                                                              config.max_cached_routes,
+                                                              config.max_reroute_destinations,
+                                                              config.max_cached_snappings,
+                                                              config.max_cached_unpackings,
+                                                              config.max_cached_tiles,
+                                                              config.tile_cache_directory,
+                                                              config.max_matching_sessions,
+                                                              config.matching_session_ttl,
+                                                              config.min_parallel_table_size,
+                                                              config.min_rphast_table_size,
+                                                              config.min_fused_table_size,
+                                                              config.min_parallel_match_size,
+                                                              config.min_parallel_route_size,
+                                                              config.min_parallel_search_distance,
+                                                              config.coalesce_requests);
     if (init_result == INIT_OK_DO_NOT_START_ENGINE)
     {
         return EXIT_SUCCESS;
@@ -231,7 +506,44 @@ int main(int argc, const char *argv[]) try
     {
         config.storage_config = storage::StorageConfig(base_path);
     }
-    if (!config.use_shared_memory && !config.storage_config.IsValid())
+    config.storage_config.compress_geometry = compress_geometry;
+    boost::to_lower(numa_placement);
+    if (numa_placement == "none")
+        config.numa_placement = EngineConfig::NUMAPlacement::None;
+    else if (numa_placement == "interleave")
+        config.numa_placement = EngineConfig::NUMAPlacement::Interleave;
+    else if (numa_placement == "replicate")
+        config.numa_placement = EngineConfig::NUMAPlacement::Replicate;
+    else
+    {
+        util::Log(logERROR) << "Invalid NUMA placement " << numa_placement;
+        return EXIT_FAILURE;
+    }
+    for (const auto &block_advice : memory_advice)
+    {
+        const auto separator = block_advice.find('=');
+        const auto block = block_advice.substr(0, separator);
+        const auto advice = separator == std::string::npos
+                                ? std::string{}
+                                : boost::to_lower_copy(block_advice.substr(separator + 1));
+        if (advice == "normal")
+            config.memory_advice[block] = EngineConfig::MemoryAdvice::Normal;
+        else if (advice == "random")
+            config.memory_advice[block] = EngineConfig::MemoryAdvice::Random;
+        else if (advice == "sequential")
+            config.memory_advice[block] = EngineConfig::MemoryAdvice::Sequential;
+        else if (advice == "willneed")
+            config.memory_advice[block] = EngineConfig::MemoryAdvice::WillNeed;
+        else
+        {
+            util::Log(logERROR) << "Invalid memory advice " << block_advice;
+            return EXIT_FAILURE;
+        }
+    }
+    // a memory file holds all the data, it only needs the .osrm files to be written
+    const bool has_memory_file =
+        !config.memory_file.empty() && boost::filesystem::exists(config.memory_file);
+    if (!config.use_shared_memory && !has_memory_file && !config.storage_config.IsValid())
     {
         util::Log(logERROR) << "Required files are missing, cannot continue";
         return EXIT_FAILURE;
@@ -252,10 +564,25 @@ int main(int argc, const char *argv[]) try
     {
         util::Log() << "Loading from shared memory";
     }
+    else if (!config.memory_file.empty())
+    {
+        util::Log() << "Mapping data from " << config.memory_file;
+    }
 
-    util::Log() << "Threads: " << requested_thread_num;
-    util::Log() << "IP address: " << ip_address;
-    util::Log() << "IP port: " << ip_port;
+    util::Log() << "Threads: " << requested_thread_num
+                << (use_sharding ? " (one acceptor per thread)" : "");
+    if (unix_socket_only && unix_socket.empty())
+    {
+        util::Log(logERROR) << "--unix-socket-only requires a --unix-socket path";
+        return EXIT_FAILURE;
+    }
+    if (!unix_socket_only)
+    {
+        util::Log() << "IP address: " << ip_address;
+        util::Log() << "IP port: " << ip_port;
+    }
+    util::Log() << "Keep-alive timeout: " << keepalive_timeout << "s, max. requests "
+                << keepalive_max_requests;
 
 #ifndef _WIN32
     int sig = 0;
@@ -265,10 +592,175 @@ int main(int argc, const char *argv[]) try
     pthread_sigmask(SIG_BLOCK, &new_mask, &old_mask);
 #endif
 
-    auto service_handler = std::make_unique<server::ServiceHandler>(config);
-    auto routing_server = server::Server::CreateServer(ip_address, ip_port, requested_thread_num);
-
+    if (warmup)
+    {
+        config.warmup_heap_sets = std::max(1, requested_thread_num);
+    }
+    std::unique_ptr<server::ServiceHandlerInterface> service_handler =
+        std::make_unique<server::ServiceHandler>(config);
+    if (!profile_datasets.empty())
+    {
+        auto profile_handler =
+            std::make_unique<server::ProfileServiceHandler>(std::move(service_handler));
+        for (const auto &profile_dataset : profile_datasets)
+        {
+            const auto separator = profile_dataset.find('=');
+            const auto profile = profile_dataset.substr(0, separator);
+            if (profile.empty() || separator == std::string::npos)
+            {
+                util::Log(logERROR) << "Invalid dataset " << profile_dataset
+                                    << ", expected <profile>=<base path>";
+                return EXIT_FAILURE;
+            }
+
+            // the datasets share the settings and the server threads, but are always read into
+            // memory of their own
+            auto dataset_config = config;
+            dataset_config.storage_config =
+                storage::StorageConfig(profile_dataset.substr(separator + 1));
+            dataset_config.storage_config.compress_geometry = compress_geometry;
+            dataset_config.use_shared_memory = false;
+            dataset_config.memory_file.clear();
+            if (!dataset_config.IsValid())
+            {
+                util::Log(logERROR) << "Required files of dataset " << profile_dataset
+                                    << " are missing, cannot continue";
+                return EXIT_FAILURE;
+            }
+            util::Log() << "Serving profile " << profile << " from "
+                        << profile_dataset.substr(separator + 1);
+            profile_handler->AddProfile(
+                profile, std::make_unique<server::ServiceHandler>(dataset_config));
+        }
+        service_handler = std::move(profile_handler);
+    }
+    if (!warmup_query_log.empty())
+    {
+        if (!boost::filesystem::is_regular_file(warmup_query_log))
+        {
+            util::Log(logERROR) << "Warm-up query log " << warmup_query_log.string()
+                                << " does not exist";
+            return EXIT_FAILURE;
+        }
+        util::Log() << "Warming up with the requests of " << warmup_query_log.string();
+        const auto result = server::warmUp(
+            *service_handler, warmup_query_log, std::max(1, requested_thread_num));
+        util::Log() << "Warm-up ran " << result.requests << " requests in " << result.seconds
+                    << "s, " << result.errors << " failed";
+    }
+    // with worker pools the server threads only parse and dispatch requests
+    const bool use_service_executor = !service_threads.empty() || !service_priorities.empty();
+    // an empty address keeps the server off TCP/IP
+    std::string listen_address = unix_socket_only ? std::string() : ip_address;
+    auto routing_server = server::Server::CreateServer(listen_address,
+                                                       ip_port,
+                                                       use_service_executor
+                                                           ? std::max(1, io_threads)
+                                                           : requested_thread_num,
+                                                       std::max(0, keepalive_timeout),
+                                                       std::max(0, keepalive_max_requests),
+                                                       use_sharding,
+                                                       compression_levels);
+
+    if (!unix_socket.empty())
+    {
+        routing_server->ListenOnUnixSocket(unix_socket);
+    }
     routing_server->RegisterServiceHandler(std::move(service_handler));
+    if (config.numa_placement == EngineConfig::NUMAPlacement::Replicate && !use_sharding)
+    {
+        routing_server->PinThreadsToNUMANodes();
+    }
+    if (use_service_executor)
+    {
+        routing_server->EnableServiceExecutor(std::max(1, requested_thread_num));
+        for (const auto &pool : service_threads)
+        {
+            const auto separator = pool.find('=');
+            std::vector<std::string> services;
+            boost::split(services, pool.substr(0, separator), boost::is_any_of(","));
+            const auto threads =
+                separator == std::string::npos
+                    ? 0
+                    : std::strtoul(pool.c_str() + separator + 1, nullptr, 10);
+            if (threads == 0 || !routing_server->AddServicePool(services, threads))
+            {
+                util::Log(logERROR) << "Invalid service threads " << pool
+                                    << ", expected <service>[,<service>...]=<threads> of known "
+                                       "services without a pool";
+                return EXIT_FAILURE;
+            }
+            util::Log() << "Running " << pool.substr(0, separator) << " on " << threads
+                        << " worker threads";
+        }
+        for (const auto &service_priority : service_priorities)
+        {
+            const auto separator = service_priority.find('=');
+            const auto service = service_priority.substr(0, separator);
+            const char *priority_begin =
+                service_priority.c_str() + std::min(separator + 1, service_priority.size());
+            char *priority_end = nullptr;
+            const auto priority = std::strtol(priority_begin, &priority_end, 10);
+            if (separator == std::string::npos || priority_end == priority_begin ||
+                *priority_end != '\0' || !routing_server->SetServicePriority(service, priority))
+            {
+                util::Log(logERROR) << "Invalid service priority " << service_priority
+                                    << ", expected <known service>=<priority>";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    if (enable_metrics)
+    {
+        util::Log() << "Serving metrics on /metrics";
+        routing_server->EnableMetrics();
+    }
+    if (!query_log.empty())
+    {
+        if (!(query_log_sample_rate > 0. && query_log_sample_rate <= 1.))
+        {
+            util::Log(logERROR) << "Invalid query log sample rate " << query_log_sample_rate
+                                << ", expected a fraction in (0, 1]";
+            return EXIT_FAILURE;
+        }
+        util::Log() << "Recording " << query_log_sample_rate * 100 << "% of the requests to "
+                    << query_log.string();
+        routing_server->EnableQueryLog(query_log, query_log_sample_rate);
+    }
+    if (table_stream_rows < 0)
+    {
+        util::Log(logERROR) << "Invalid number of rows per table chunk " << table_stream_rows;
+        return EXIT_FAILURE;
+    }
+    if (table_stream_rows > 0)
+    {
+        util::Log() << "Streaming tables in chunks of " << table_stream_rows << " rows";
+        routing_server->EnableTableStreaming(table_stream_rows);
+    }
+
+    for (const auto &service_cost_limit : service_cost_limits)
+    {
+        const auto separator = service_cost_limit.find('=');
+        const auto service = service_cost_limit.substr(0, separator);
+        const auto max_cost = separator == std::string::npos
+                                  ? 0
+                                  : std::strtoul(service_cost_limit.c_str() + separator + 1,
+                                                 nullptr,
+                                                 10);
+        if (service.empty() || max_cost == 0)
+        {
+            util::Log(logERROR) << "Invalid service cost limit " << service_cost_limit
+                                << ", expected <service>=<max. coordinates>";
+            return EXIT_FAILURE;
+        }
+
+        util::Log() << "Limiting " << service << " to " << max_cost << " coordinates in flight";
+        routing_server->SetAdmissionLimits(
+            service,
+            {max_cost,
+             static_cast<std::size_t>(std::max(0, max_queued_requests)),
+             std::chrono::milliseconds(std::max(0, max_queue_wait))});
+    }
 
     if (trial_run)
     {
@@ -4,6 +4,7 @@
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
 #include "util/meminfo.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/typedefs.hpp"
 #include "util/version.hpp"
 
@@ -45,6 +46,8 @@ void springClean()
     {
         deleteRegion(storage::REGION_1);
         deleteRegion(storage::REGION_2);
+        deleteRegion(storage::REGION_3);
+        deleteRegion(storage::REGION_4);
         removeLocks();
     }
 }
@@ -53,21 +56,66 @@ void springClean()
 bool generateDataStoreOptions(const int argc,
                               const char *argv[],
                               boost::filesystem::path &base_path,
-                              int &max_wait)
+                              int &max_wait,
+                              bool &use_huge_pages,
+                              bool &interleave_numa_nodes,
+                              bool &only_metric,
+                              bool &compress_geometry,
+                              bool &lock_memory,
+                              boost::filesystem::path &memory_file,
+                              boost::filesystem::path &phase_report_path)
 {
     // declare a group of options that will be allowed only on command line
     boost::program_options::options_description generic_options("Options");
     generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message")(
         "remove-locks,r", "Remove locks")("spring-clean,s",
-                                          "Spring-cleaning all shared memory regions");
+                                          "Spring-cleaning all shared memory regions")(
+        "phase-report",
+        boost::program_options::value<boost::filesystem::path>(&phase_report_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     // as well as in a config file
     boost::program_options::options_description config_options("Configuration");
-    config_options.add_options()("max-wait",
-                                 boost::program_options::value<int>(&max_wait)->default_value(-1),
-                                 "Maximum number of seconds to wait on a running data update "
-                                 "before aquiring the lock by force.");
+    config_options.add_options() //
+        ("max-wait",
+         boost::program_options::value<int>(&max_wait)->default_value(-1),
+         "Maximum number of seconds to wait on a running data update "
+         "before aquiring the lock by force.") //
+        ("huge-pages",
+         boost::program_options::value<bool>(&use_huge_pages)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Back the shared memory with huge pages, or transparent huge pages if there are none "
+         "reserved.") //
+        ("numa-interleave",
+         boost::program_options::value<bool>(&interleave_numa_nodes)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Spread the pages of the shared memory over all NUMA nodes.") //
+        ("only-metric",
+         boost::program_options::value<bool>(&only_metric)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Only load the weights, durations and graphs that change with traffic updates and keep "
+         "the rest of the data that is in use.") //
+        ("compress-geometry",
+         boost::program_options::value<bool>(&compress_geometry)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Delta encode the nodes of the geometries, which saves memory but decodes them on every "
+         "access.") //
+        ("lock-memory",
+         boost::program_options::value<bool>(&lock_memory)
+             ->implicit_value(true)
+             ->default_value(true),
+         "Lock the shared memory into RAM, needs an RLIMIT_MEMLOCK (ulimit -l) of at least its "
+         "size. Use --lock-memory=false to let the kernel swap it out.") //
+        ("memory-file",
+         boost::program_options::value<boost::filesystem::path>(&memory_file),
+         "Copy the data from this memory file instead of reading the .osrm files, checking the "
+         "checksum of every block. The file is written from the .osrm files when it is missing "
+         "or older than them, osrm-routed --memory-file maps the same file.");
 
     // hidden options, will be allowed on command line but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -159,19 +207,40 @@ int main(const int argc, const char *argv[]) try
 
     boost::filesystem::path base_path;
     int max_wait = -1;
-    if (!generateDataStoreOptions(argc, argv, base_path, max_wait))
+    bool use_huge_pages = false;
+    bool interleave_numa_nodes = false;
+    bool only_metric = false;
+    bool compress_geometry = false;
+    bool lock_memory = true;
+    boost::filesystem::path memory_file;
+    boost::filesystem::path phase_report_path;
+    if (!generateDataStoreOptions(argc,
+                                  argv,
+                                  base_path,
+                                  max_wait,
+                                  use_huge_pages,
+                                  interleave_numa_nodes,
+                                  only_metric,
+                                  compress_geometry,
+                                  lock_memory,
+                                  memory_file,
+                                  phase_report_path))
     {
         return EXIT_SUCCESS;
     }
     storage::StorageConfig config(base_path);
-    if (!config.IsValid())
+    config.compress_geometry = compress_geometry;
+    config.memory_file = memory_file;
+    // a memory file holds all the data, it only needs the .osrm files to be written
+    if (!config.IsValid() && (memory_file.empty() || !boost::filesystem::exists(memory_file)))
     {
         util::Log(logERROR) << "Config contains invalid file paths. Exiting!";
         return EXIT_FAILURE;
     }
     storage::Storage storage(std::move(config));
 
-    return storage.Run(max_wait);
+    util::PhaseReport phase_report("osrm-datastore", phase_report_path);
+    return storage.Run(max_wait, use_huge_pages, interleave_numa_nodes, only_metric, lock_memory);
 }
 catch (const osrm::RuntimeError &e)
 {
@@ -0,0 +1,521 @@
+#include "engine/tile_cache.hpp"
+#include "extractor/files.hpp"
+#include "extractor/packed_osm_ids.hpp"
+#include "storage/io.hpp"
+#include "updater/csv_source.hpp"
+#include "updater/segment_source.hpp"
+#include "util/coordinate.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+#include "util/meminfo.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+#include "util/web_mercator.hpp"
+
+#include "osrm/engine_config.hpp"
+#include "osrm/exception.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+#include "osrm/storage_config.hpp"
+#include "osrm/tile_parameters.hpp"
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+// Tiles are only served for these zoom levels, see TileParameters::IsValid
+const constexpr unsigned MIN_ZOOM = 12;
+const constexpr unsigned MAX_ZOOM = 19;
+// The tile plugin fetches the edges of a tile with a buffer of 10% of the tile size
+const constexpr double TILE_BUFFER = 0.10;
+
+struct TilesConfig
+{
+    boost::filesystem::path base_path;
+    boost::filesystem::path output_path;
+    std::string algorithm;
+    std::string bbox;
+    unsigned min_zoom;
+    unsigned max_zoom;
+    unsigned requested_num_threads;
+    std::vector<std::string> segment_speed_lookup_paths;
+    std::vector<std::string> turn_penalty_lookup_paths;
+};
+
+struct BBox
+{
+    double min_lon;
+    double min_lat;
+    double max_lon;
+    double max_lat;
+};
+
+// The tiles of a zoom level from min to max, both inclusive
+struct TileRange
+{
+    unsigned min_x;
+    unsigned min_y;
+    unsigned max_x;
+    unsigned max_y;
+};
+
+EngineConfig::Algorithm stringToAlgorithm(std::string algorithm)
+{
+    boost::to_lower(algorithm);
+
+    if (algorithm == "ch")
+        return EngineConfig::Algorithm::CH;
+    if (algorithm == "corech")
+        return EngineConfig::Algorithm::CoreCH;
+    if (algorithm == "mld")
+        return EngineConfig::Algorithm::MLD;
+    if (algorithm == "cch")
+        return EngineConfig::Algorithm::CCH;
+    throw util::RuntimeError(algorithm, ErrorCode::UnknownAlgorithm, SOURCE_REF);
+}
+
+// Parses min_lon,min_lat,max_lon,max_lat
+bool parseBBox(const std::string &input, BBox &bbox)
+{
+    std::vector<std::string> values;
+    boost::split(values, input, boost::is_any_of(","));
+    if (values.size() != 4)
+    {
+        return false;
+    }
+    try
+    {
+        bbox = BBox{std::stod(values[0]),
+                    std::stod(values[1]),
+                    std::stod(values[2]),
+                    std::stod(values[3])};
+    }
+    catch (const std::logic_error &)
+    {
+        return false;
+    }
+    return bbox.min_lon <= bbox.max_lon && bbox.min_lat <= bbox.max_lat;
+}
+
+// The tiles of zoom level z that intersect bbox once the bbox is widened by buffer tiles
+TileRange getTileRange(const BBox &bbox, const unsigned z, const double buffer)
+{
+    const double tiles = 1u << z;
+    const auto to_x = [tiles](const double lon) { return (lon + 180.) / 360. * tiles; };
+    const auto to_y = [tiles](const double lat) {
+        return (180. - util::web_mercator::latToY(util::FloatLatitude{lat})) / 360. * tiles;
+    };
+    const auto to_index = [tiles](const double value) {
+        return static_cast<unsigned>(std::max(0., std::min(tiles - 1, std::floor(value))));
+    };
+
+    // tile rows are counted from the north
+    return TileRange{to_index(to_x(bbox.min_lon) - buffer),
+                     to_index(to_y(bbox.max_lat) - buffer),
+                     to_index(to_x(bbox.max_lon) + buffer),
+                     to_index(to_y(bbox.min_lat) + buffer)};
+}
+
+bool intersects(const TileRange &lhs, const TileRange &rhs)
+{
+    return lhs.min_x <= rhs.max_x && rhs.min_x <= lhs.max_x && lhs.min_y <= rhs.max_y &&
+           rhs.min_y <= lhs.max_y;
+}
+
+// The timestamp of the dataset, names the directory of its tiles like for osrm-routed
+std::string readTimestamp(const storage::StorageConfig &storage_config)
+{
+    storage::io::FileReader timestamp_file(storage_config.GetPath(".osrm.timestamp"),
+                                           storage::io::FileReader::VerifyFingerprint);
+    std::string timestamp(timestamp_file.GetSize(), '\0');
+    timestamp_file.ReadInto(&timestamp[0], timestamp.size());
+    return timestamp;
+}
+
+// The areas touched by the updates of the lookup files: a box per updated segment and one per
+// via node of an updated turn
+std::vector<BBox> getUpdatedAreas(const TilesConfig &config,
+                                  const storage::StorageConfig &storage_config)
+{
+    const auto segment_speeds = updater::readSegmentValues(config.segment_speed_lookup_paths);
+    const auto turn_penalties = updater::csv::readTurnValues(config.turn_penalty_lookup_paths);
+
+    // the lookup files refer to OSM node ids, only their coordinates are looked up
+    std::unordered_map<std::uint64_t, util::Coordinate> coordinates;
+    for (const auto &segment : segment_speeds.lookup)
+    {
+        coordinates.emplace(segment.first.from, util::Coordinate{});
+        coordinates.emplace(segment.first.to, util::Coordinate{});
+    }
+    for (const auto &turn : turn_penalties.lookup)
+    {
+        coordinates.emplace(turn.first.via, util::Coordinate{});
+    }
+
+    {
+        std::vector<util::Coordinate> node_coordinates;
+        extractor::PackedOSMIDs osm_node_ids;
+        extractor::files::readNodes(
+            storage_config.GetPath(".osrm.nbg_nodes"), node_coordinates, osm_node_ids);
+        for (std::size_t node = 0; node < node_coordinates.size(); ++node)
+        {
+            const OSMNodeID osm_node_id = osm_node_ids[node];
+            const auto found = coordinates.find(static_cast<std::uint64_t>(osm_node_id));
+            if (found != coordinates.end())
+            {
+                found->second = node_coordinates[node];
+            }
+        }
+    }
+
+    std::vector<BBox> areas;
+    const auto add_area = [&](const std::uint64_t first, const std::uint64_t second) {
+        const auto first_coordinate = coordinates.at(first);
+        const auto second_coordinate = coordinates.at(second);
+        // nodes that are not part of the dataset
+        if (!first_coordinate.IsValid() || !second_coordinate.IsValid())
+        {
+            return;
+        }
+        const auto first_lon = static_cast<double>(util::toFloating(first_coordinate.lon));
+        const auto first_lat = static_cast<double>(util::toFloating(first_coordinate.lat));
+        const auto second_lon = static_cast<double>(util::toFloating(second_coordinate.lon));
+        const auto second_lat = static_cast<double>(util::toFloating(second_coordinate.lat));
+        areas.push_back(BBox{std::min(first_lon, second_lon),
+                             std::min(first_lat, second_lat),
+                             std::max(first_lon, second_lon),
+                             std::max(first_lat, second_lat)});
+    };
+    for (const auto &segment : segment_speeds.lookup)
+    {
+        add_area(segment.first.from, segment.first.to);
+    }
+    for (const auto &turn : turn_penalties.lookup)
+    {
+        add_area(turn.first.via, turn.first.via);
+    }
+
+    util::Log() << "Found " << areas.size() << " updated segments and turns in "
+                << segment_speeds.lookup.size() + turn_penalties.lookup.size() << " updates";
+    return areas;
+}
+
+// The tiles of a zoom level covering any of the updated areas inside of bbox
+std::vector<TileParameters>
+getUpdatedTiles(const std::vector<BBox> &areas, const BBox &bbox, const unsigned z)
+{
+    const auto bbox_range = getTileRange(bbox, z, 0);
+    std::vector<TileParameters> tiles;
+    for (const auto &area : areas)
+    {
+        const auto range = getTileRange(area, z, TILE_BUFFER);
+        if (!intersects(range, bbox_range))
+        {
+            continue;
+        }
+        for (auto x = std::max(range.min_x, bbox_range.min_x);
+             x <= std::min(range.max_x, bbox_range.max_x);
+             ++x)
+        {
+            for (auto y = std::max(range.min_y, bbox_range.min_y);
+                 y <= std::min(range.max_y, bbox_range.max_y);
+                 ++y)
+            {
+                tiles.push_back(TileParameters{x, y, z});
+            }
+        }
+    }
+
+    std::sort(tiles.begin(), tiles.end(), [](const auto &lhs, const auto &rhs) {
+        return std::tie(lhs.x, lhs.y) < std::tie(rhs.x, rhs.y);
+    });
+    tiles.erase(std::unique(tiles.begin(),
+                            tiles.end(),
+                            [](const auto &lhs, const auto &rhs) {
+                                return lhs.x == rhs.x && lhs.y == rhs.y;
+                            }),
+                tiles.end());
+    return tiles;
+}
+
+return_code parseArguments(int argc, char *argv[], TilesConfig &config)
+{
+    using boost::program_options::value;
+
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    // declare a group of options that will be allowed both on command line
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("output,o",
+         value<boost::filesystem::path>(&config.output_path)->required(),
+         "Directory the tiles are written to as <timestamp>/<z>/<x>/<y>.mvt, osrm-routed "
+         "serves them with --tile-cache-directory") //
+        ("bbox,b",
+         value<std::string>(&config.bbox),
+         "Render the tiles intersecting min_lon,min_lat,max_lon,max_lat, required unless only "
+         "updated tiles are rendered") //
+        ("min-zoom",
+         value<unsigned>(&config.min_zoom)->default_value(MIN_ZOOM),
+         "Lowest zoom level to render, at least 12") //
+        ("max-zoom",
+         value<unsigned>(&config.max_zoom)->default_value(MAX_ZOOM),
+         "Highest zoom level to render, at most 19") //
+        ("algorithm,a",
+         value<std::string>(&config.algorithm)->default_value("CH"),
+         "Algorithm to use for the data. Can be CH, CoreCH, MLD, CCH.") //
+        ("threads,t",
+         value<unsigned>(&config.requested_num_threads)
+             ->default_value(tbb::task_scheduler_init::default_num_threads()),
+         "Number of threads to use") //
+        ("segment-speed-file",
+         value<std::vector<std::string>>(&config.segment_speed_lookup_paths)->composing(),
+         "Only re-render the tiles of the segments in these lookup files, e.g. the ones given "
+         "to osrm-customize") //
+        ("turn-penalty-file",
+         value<std::vector<std::string>>(&config.turn_penalty_lookup_paths)->composing(),
+         "Only re-render the tiles of the turns in these lookup files");
+
+    // hidden options, will be allowed on command line, but will not be
+    // shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "input,i", value<boost::filesystem::path>(&config.base_path), "Input file in .osrm format");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("input", 1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() +
+        " <input.osrm> --output <directory> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (option_variables.count("version"))
+    {
+        std::cout << OSRM_VERSION << std::endl;
+        return return_code::exit;
+    }
+
+    if (option_variables.count("help"))
+    {
+        std::cout << visible_options;
+        return return_code::exit;
+    }
+
+    try
+    {
+        boost::program_options::notify(option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (!option_variables.count("input"))
+    {
+        std::cout << visible_options;
+        return return_code::fail;
+    }
+
+    return return_code::ok;
+}
+}
+
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+    TilesConfig config;
+
+    const auto result = parseArguments(argc, argv, config);
+
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    if (1 > config.requested_num_threads)
+    {
+        util::Log(logERROR) << "Number of threads must be 1 or larger";
+        return EXIT_FAILURE;
+    }
+
+    if (config.min_zoom < MIN_ZOOM || config.max_zoom > MAX_ZOOM ||
+        config.min_zoom > config.max_zoom)
+    {
+        util::Log(logERROR) << "Zoom levels must be between " << MIN_ZOOM << " and " << MAX_ZOOM;
+        return EXIT_FAILURE;
+    }
+
+    const bool incremental =
+        !config.segment_speed_lookup_paths.empty() || !config.turn_penalty_lookup_paths.empty();
+
+    BBox bbox{-util::web_mercator::detail::MAX_LONGITUDE,
+              -util::web_mercator::detail::EPSG3857_MAX_LATITUDE,
+              util::web_mercator::detail::MAX_LONGITUDE,
+              util::web_mercator::detail::EPSG3857_MAX_LATITUDE};
+    if (config.bbox.empty() && !incremental)
+    {
+        util::Log(logERROR) << "A bbox is required to render all tiles";
+        return EXIT_FAILURE;
+    }
+    if (!config.bbox.empty() && !parseBBox(config.bbox, bbox))
+    {
+        util::Log(logERROR) << "Invalid bbox " << config.bbox
+                            << ", expected min_lon,min_lat,max_lon,max_lat";
+        return EXIT_FAILURE;
+    }
+
+    EngineConfig engine_config;
+    engine_config.storage_config = storage::StorageConfig(config.base_path);
+    engine_config.use_shared_memory = false;
+    engine_config.algorithm = stringToAlgorithm(config.algorithm);
+    if (!engine_config.storage_config.IsValid())
+    {
+        util::Log(logERROR) << "Required files are missing, cannot continue";
+        return EXIT_FAILURE;
+    }
+
+    tbb::task_scheduler_init init(config.requested_num_threads);
+
+    const auto updated_areas = incremental
+                                   ? getUpdatedAreas(config, engine_config.storage_config)
+                                   : std::vector<BBox>{};
+
+    // the dataset is loaded once and shared by all tiles
+    const OSRM osrm{engine_config};
+    const auto timestamp = readTimestamp(engine_config.storage_config);
+
+    std::atomic<std::size_t> failed_tiles{0};
+    const auto render = [&](const TileParameters &parameters) {
+        std::string tile;
+        if (osrm.Tile(parameters, tile) != Status::Ok ||
+            !engine::TileCache::WriteTile(
+                engine::TileCache::GetTilePath(config.output_path, timestamp, parameters), tile))
+        {
+            ++failed_tiles;
+        }
+    };
+
+    std::size_t total_tiles = 0;
+    for (auto z = config.min_zoom; z <= config.max_zoom; ++z)
+    {
+        TIMER_START(zoom);
+        std::size_t zoom_tiles = 0;
+        if (incremental)
+        {
+            const auto tiles = getUpdatedTiles(updated_areas, bbox, z);
+            zoom_tiles = tiles.size();
+            tbb::parallel_for(std::size_t{0}, tiles.size(), [&](const std::size_t index) {
+                render(tiles[index]);
+            });
+        }
+        else
+        {
+            // a column at a time, the tiles of a large box at high zoom levels do not fit into
+            // memory all at once
+            const auto range = getTileRange(bbox, z, 0);
+            zoom_tiles =
+                std::size_t{range.max_x - range.min_x + 1} * (range.max_y - range.min_y + 1);
+            tbb::parallel_for(range.min_x, range.max_x + 1, [&](const unsigned x) {
+                for (auto y = range.min_y; y <= range.max_y; ++y)
+                {
+                    render(TileParameters{x, y, z});
+                }
+            });
+        }
+        TIMER_STOP(zoom);
+        total_tiles += zoom_tiles;
+        util::Log() << "Rendered " << zoom_tiles << " tiles of zoom level " << z << " in "
+                    << TIMER_SEC(zoom) << "s";
+    }
+
+    if (failed_tiles > 0)
+    {
+        util::Log(logERROR) << failed_tiles << " of " << total_tiles << " tiles failed";
+        return EXIT_FAILURE;
+    }
+
+    util::Log() << "Wrote " << total_tiles << " tiles to " << config.output_path.string();
+    util::DumpMemoryStats();
+
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const std::bad_alloc &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logERROR) << "[exception] " << e.what();
+    util::Log(logERROR) << "Please provide more memory or consider using a larger swapfile";
+    return EXIT_FAILURE;
+}
+#ifdef _WIN32
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "[exception] " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
+#endif
@@ -0,0 +1,322 @@
+#include "customizer/customizer.hpp"
+#include "storage/storage.hpp"
+
+#include "osrm/exception.hpp"
+#include "util/log.hpp"
+#include "util/meminfo.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include <tbb/task_scheduler_init.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <ctime>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+std::atomic<bool> stop_requested{false};
+
+void requestStop(int) { stop_requested = true; }
+
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+struct TrafficConfig
+{
+    boost::filesystem::path watch_directory;
+    int poll_interval;
+    int max_wait;
+    bool once;
+};
+
+return_code parseArguments(int argc,
+                           char *argv[],
+                           customizer::CustomizationConfig &customization_config,
+                           TrafficConfig &traffic_config)
+{
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    // declare a group of options that will be allowed both on command line
+    // as well as in a config file
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("watch-directory,d",
+         boost::program_options::value<boost::filesystem::path>(&traffic_config.watch_directory)
+             ->required(),
+         "Directory that receives segment speed files in the format of --segment-speed-file. "
+         "Write them elsewhere and move them here, files ending in .tmp are ignored") //
+        ("poll-interval",
+         boost::program_options::value<int>(&traffic_config.poll_interval)->default_value(10),
+         "Seconds between two looks for new or changed speed files") //
+        ("max-wait",
+         boost::program_options::value<int>(&traffic_config.max_wait)->default_value(-1),
+         "Maximum number of seconds to wait on a running data update before aquiring the lock "
+         "by force") //
+        ("once",
+         boost::program_options::value<bool>(&traffic_config.once)
+             ->implicit_value(true)
+             ->default_value(false),
+         "Apply the speed files in the directory and exit instead of watching it") //
+        ("threads,t",
+         boost::program_options::value<unsigned int>(&customization_config.requested_num_threads)
+             ->default_value(tbb::task_scheduler_init::default_num_threads()),
+         "Number of threads to use") //
+        ("edge-weight-updates-over-factor",
+         boost::program_options::value<double>(
+             &customization_config.updater_config.log_edge_updates_factor)
+             ->default_value(0.0),
+         "Log edge weights updated by more than this factor");
+
+    // hidden options, will be allowed on command line, but will not be
+    // shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "input,i",
+        boost::program_options::value<boost::filesystem::path>(&customization_config.base_path),
+        "Input file in .osrm format");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("input", 1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(executable).filename().string() + " <input.osrm> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+
+        if (option_variables.count("version"))
+        {
+            std::cout << OSRM_VERSION << std::endl;
+            return return_code::exit;
+        }
+
+        if (option_variables.count("help"))
+        {
+            std::cout << visible_options;
+            return return_code::exit;
+        }
+
+        boost::program_options::notify(option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (!option_variables.count("input"))
+    {
+        std::cout << visible_options;
+        return return_code::fail;
+    }
+
+    return return_code::ok;
+}
+
+// Speed files that are new or changed since they were last applied, oldest first
+std::vector<std::string> findChangedFiles(const boost::filesystem::path &directory,
+                                          std::map<std::string, std::time_t> &applied)
+{
+    std::vector<std::pair<std::time_t, std::string>> changed;
+    for (const auto &entry : boost::filesystem::directory_iterator(directory))
+    {
+        const auto &path = entry.path();
+        if (!boost::filesystem::is_regular_file(path) || path.extension() == ".tmp")
+        {
+            continue;
+        }
+        const auto write_time = boost::filesystem::last_write_time(path);
+        const auto known = applied.find(path.string());
+        if (known == applied.end() || known->second != write_time)
+        {
+            changed.emplace_back(write_time, path.string());
+            applied[path.string()] = write_time;
+        }
+    }
+    std::sort(changed.begin(), changed.end());
+
+    std::vector<std::string> files;
+    for (auto &file : changed)
+    {
+        files.push_back(std::move(file.second));
+    }
+    return files;
+}
+
+// Applies the speeds of the files to the metric on disk and loads it into a new metric region of
+// the shared memory. osrm-routed switches to it as soon as it is complete, the static data is
+// kept as it is.
+int applySpeedFiles(customizer::CustomizationConfig config,
+                    const TrafficConfig &traffic_config,
+                    std::vector<std::string> files)
+{
+    util::Log() << "Applying " << files.size() << " speed files";
+    TIMER_START(update);
+
+    config.updater_config.segment_speed_lookup_paths = std::move(files);
+    TIMER_START(customize);
+    const auto customized = customizer::Customizer().Run(config);
+    TIMER_STOP(customize);
+    if (customized != EXIT_SUCCESS)
+    {
+        return customized;
+    }
+
+    TIMER_START(publish);
+    storage::Storage storage(storage::StorageConfig(config.base_path));
+    const auto published = storage.Run(traffic_config.max_wait,
+                                       /* use_huge_pages */ false,
+                                       /* interleave_numa_nodes */ false,
+                                       /* only_metric */ true,
+                                       /* lock_memory */ true);
+    TIMER_STOP(publish);
+    TIMER_STOP(update);
+
+    util::Log() << "Published the new metric " << TIMER_SEC(update) << "s after the speed files "
+                << "were found, customization took " << TIMER_SEC(customize)
+                << "s, loading into shared memory " << TIMER_SEC(publish) << "s";
+    return published;
+}
+}
+
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+    customizer::CustomizationConfig customization_config;
+    TrafficConfig traffic_config;
+
+    const auto result = parseArguments(argc, argv, customization_config, traffic_config);
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    // set the default in/output names
+    customization_config.UseDefaultOutputNames(customization_config.base_path);
+
+    if (1 > customization_config.requested_num_threads)
+    {
+        util::Log(logERROR) << "Number of threads must be 1 or larger";
+        return EXIT_FAILURE;
+    }
+    if (1 > traffic_config.poll_interval)
+    {
+        util::Log(logERROR) << "The poll interval must be at least one second";
+        return EXIT_FAILURE;
+    }
+    if (!boost::filesystem::is_regular_file(customization_config.GetPath(".osrm")))
+    {
+        util::Log(logERROR) << "Input file " << customization_config.GetPath(".osrm").string()
+                            << " not found!";
+        return EXIT_FAILURE;
+    }
+    if (!boost::filesystem::is_directory(traffic_config.watch_directory))
+    {
+        util::Log(logERROR) << "Speed file directory " << traffic_config.watch_directory
+                            << " not found!";
+        return EXIT_FAILURE;
+    }
+
+    tbb::task_scheduler_init init(customization_config.requested_num_threads);
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    util::Log() << "Watching " << traffic_config.watch_directory << " for speed files";
+    std::map<std::string, std::time_t> applied;
+    while (!stop_requested)
+    {
+        auto files = findChangedFiles(traffic_config.watch_directory, applied);
+        if (!files.empty())
+        {
+            // a broken speed file must not stop the updates, it is retried once it changes
+            try
+            {
+                const auto exitcode = applySpeedFiles(customization_config, traffic_config, files);
+                if (exitcode != EXIT_SUCCESS)
+                {
+                    return exitcode;
+                }
+            }
+            catch (const std::exception &e)
+            {
+                util::Log(logERROR) << "Could not apply the speed files: " << e.what();
+                if (traffic_config.once)
+                {
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        if (traffic_config.once)
+        {
+            break;
+        }
+
+        // wakes up every second to notice a stop request
+        for (int second = 0; second < traffic_config.poll_interval && !stop_requested; ++second)
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+
+    util::Log() << "Stopped watching for speed files";
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const std::bad_alloc &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logERROR) << "[exception] " << e.what();
+    util::Log(logERROR) << "Please provide more memory or consider using a larger swapfile";
+    return EXIT_FAILURE;
+}
+#ifdef _WIN32
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "[exception] " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
+#endif
@@ -0,0 +1,183 @@
+#include "updater/binary_source.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+namespace osrm
+{
+namespace updater
+{
+namespace binary
+{
+namespace
+{
+const char SEGMENT_FILE_MAGIC[8] = {'O', 'S', 'R', 'M', 'S', 'P', 'D', 0};
+
+std::uint64_t paddedNameLength(const std::uint32_t name_length)
+{
+    return (std::uint64_t{name_length} + 7) / 8 * 8;
+}
+
+bool readHeader(const std::string &path, SegmentFileHeader &header)
+{
+    boost::filesystem::ifstream file(path, std::ios::binary);
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    return file && std::memcmp(header.magic, SEGMENT_FILE_MAGIC, sizeof(header.magic)) == 0;
+}
+
+bool isAscending(const SegmentRecord &lhs, const SegmentRecord &rhs)
+{
+    return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+}
+}
+
+bool isSegmentFile(const std::string &path)
+{
+    SegmentFileHeader header;
+    return readHeader(path, header);
+}
+
+std::string readSegmentFileName(const std::string &path)
+{
+    SegmentFileHeader header;
+    if (!readHeader(path, header))
+    {
+        throw util::exception(path + " is no binary segment speed file" + SOURCE_REF);
+    }
+
+    std::string name(header.name_length, '\0');
+    boost::filesystem::ifstream file(path, std::ios::binary);
+    file.seekg(sizeof(header));
+    file.read(&name[0], name.size());
+    if (!file)
+    {
+        throw util::exception("Could not read the datasource name of " + path + SOURCE_REF);
+    }
+    return name;
+}
+
+SegmentLookupTable readSegmentValues(const std::string &path, const std::uint8_t source)
+{
+    boost::iostreams::mapped_file_source file(path);
+
+    SegmentFileHeader header;
+    if (file.size() < sizeof(header))
+    {
+        throw util::exception(path + " is no binary segment speed file" + SOURCE_REF);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SEGMENT_FILE_MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw util::exception(path + " is no binary segment speed file" + SOURCE_REF);
+    }
+    if (header.version != SegmentFileHeader::VERSION)
+    {
+        throw util::exception(path + " has version " + std::to_string(header.version) +
+                              " of the binary segment speed format, expected " +
+                              std::to_string(SegmentFileHeader::VERSION) + SOURCE_REF);
+    }
+    const auto records_offset = sizeof(header) + paddedNameLength(header.name_length);
+    if (file.size() < records_offset ||
+        (file.size() - records_offset) % sizeof(SegmentRecord) != 0 ||
+        (file.size() - records_offset) / sizeof(SegmentRecord) != header.num_records)
+    {
+        throw util::exception(path + " is truncated or has trailing data, it should hold " +
+                              std::to_string(header.num_records) + " records" + SOURCE_REF);
+    }
+
+    // the mapping is page aligned and the records start at a multiple of 8 bytes
+    const auto records_begin =
+        reinterpret_cast<const SegmentRecord *>(file.data() + records_offset);
+    const auto records_end = records_begin + header.num_records;
+
+    // LookupTable needs the keys in descending order, sorted files are just copied backwards
+    const auto sorted =
+        std::adjacent_find(records_begin, records_end, [](const auto &lhs, const auto &rhs) {
+            return !isAscending(lhs, rhs);
+        }) == records_end;
+
+    SegmentLookupTable lookup;
+    lookup.lookup.reserve(header.num_records);
+    const auto to_value = [source](const SegmentRecord &record) {
+        SpeedSource value;
+        value.speed = record.speed;
+        value.rate = record.rate;
+        value.source = source;
+        return std::make_pair(Segment{record.from, record.to}, value);
+    };
+    if (sorted)
+    {
+        std::transform(std::reverse_iterator<const SegmentRecord *>(records_end),
+                       std::reverse_iterator<const SegmentRecord *>(records_begin),
+                       std::back_inserter(lookup.lookup),
+                       to_value);
+    }
+    else
+    {
+        util::Log(logWARNING) << path << " is not sorted by ascending segment, sorting it";
+        std::transform(records_begin, records_end, std::back_inserter(lookup.lookup), to_value);
+        sortLookupValues(lookup.lookup);
+    }
+
+    util::Log() << "Loaded " << path << " with " << header.num_records << " values";
+    return lookup;
+}
+
+void writeSegmentValues(const std::string &path,
+                        const std::string &name,
+                        const SegmentLookupTable &lookup)
+{
+    if (name.size() > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw util::exception("Datasource name of " + path + " is too long" + SOURCE_REF);
+    }
+
+    SegmentFileHeader header;
+    std::memcpy(header.magic, SEGMENT_FILE_MAGIC, sizeof(header.magic));
+    header.version = SegmentFileHeader::VERSION;
+    header.name_length = static_cast<std::uint32_t>(name.size());
+    header.num_records = lookup.lookup.size();
+
+    boost::filesystem::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    std::string padded_name = name;
+    padded_name.resize(paddedNameLength(header.name_length), '\0');
+    file.write(padded_name.data(), padded_name.size());
+
+    // the lookup is sorted by descending segment, the file by ascending one
+    std::vector<SegmentRecord> records;
+    records.reserve(lookup.lookup.size());
+    std::transform(lookup.lookup.rbegin(),
+                   lookup.lookup.rend(),
+                   std::back_inserter(records),
+                   [](const auto &entry) {
+                       return SegmentRecord{entry.first.from,
+                                            entry.first.to,
+                                            entry.second.speed,
+                                            0,
+                                            entry.second.rate};
+                   });
+    file.write(reinterpret_cast<const char *>(records.data()),
+               records.size() * sizeof(SegmentRecord));
+
+    file.close();
+    if (!file)
+    {
+        throw util::exception("Could not write " + path + SOURCE_REF);
+    }
+}
+}
+}
+}
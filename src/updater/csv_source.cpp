@@ -2,28 +2,7 @@
 
 #include "updater/csv_file_parser.hpp"
 
-#include <boost/fusion/adapted/std_pair.hpp>
-#include <boost/fusion/include/adapt_adt.hpp>
-
-// clang-format off
-BOOST_FUSION_ADAPT_STRUCT(osrm::updater::Segment,
-                         (decltype(osrm::updater::Segment::from), from)
-                         (decltype(osrm::updater::Segment::to), to))
-BOOST_FUSION_ADAPT_STRUCT(osrm::updater::SpeedSource,
-                          (decltype(osrm::updater::SpeedSource::speed), speed)
-                          (decltype(osrm::updater::SpeedSource::rate), rate))
-BOOST_FUSION_ADAPT_STRUCT(osrm::updater::Turn,
-                          (decltype(osrm::updater::Turn::from), from)
-                          (decltype(osrm::updater::Turn::via), via)
-                          (decltype(osrm::updater::Turn::to), to))
-BOOST_FUSION_ADAPT_STRUCT(osrm::updater::PenaltySource,
-                          (decltype(osrm::updater::PenaltySource::duration), duration)
-                          (decltype(osrm::updater::PenaltySource::weight), weight))
-// clang-format on
-namespace
-{
-namespace qi = boost::spirit::qi;
-}
+#include <algorithm>
 
 namespace osrm
 {
@@ -31,10 +10,34 @@ namespace updater
 {
 namespace csv
 {
-SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths)
+namespace
+{
+// from_osm_id,to_osm_id,speed[,rate]
+bool parseSegmentLine(const char *&first,
+                      const char *last,
+                      std::pair<Segment, SpeedSource> &entry)
+{
+    return parseUnsigned(first, last, entry.first.from) && skipChar(first, last, ',') &&
+           parseUnsigned(first, last, entry.first.to) && skipChar(first, last, ',') &&
+           parseUnsigned(first, last, entry.second.speed) &&
+           parseOptionalReal(first, last, entry.second.rate);
+}
+
+// from_osm_id,via_osm_id,to_osm_id,penalty[,weight]
+bool parseTurnLine(const char *&first, const char *last, std::pair<Turn, PenaltySource> &entry)
+{
+    return parseUnsigned(first, last, entry.first.from) && skipChar(first, last, ',') &&
+           parseUnsigned(first, last, entry.first.via) && skipChar(first, last, ',') &&
+           parseUnsigned(first, last, entry.first.to) && skipChar(first, last, ',') &&
+           parseReal(first, last, entry.second.duration) &&
+           parseOptionalReal(first, last, entry.second.weight);
+}
+}
+
+SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths,
+                                     const std::size_t start_index)
 {
-    CSVFilesParser<Segment, SpeedSource> parser(
-        1, qi::ulong_long >> ',' >> qi::ulong_long, qi::uint_ >> -(',' >> qi::double_));
+    CSVFilesParser<Segment, SpeedSource> parser(start_index, parseSegmentLine);
 
     // Check consistency of keys in the result lookup table
     auto result = parser(paths);
@@ -53,10 +56,7 @@ SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths)
 
 TurnLookupTable readTurnValues(const std::vector<std::string> &paths)
 {
-    CSVFilesParser<Turn, PenaltySource> parser(1,
-                                               qi::ulong_long >> ',' >> qi::ulong_long >> ',' >>
-                                                   qi::ulong_long,
-                                               qi::double_ >> -(',' >> qi::double_));
+    CSVFilesParser<Turn, PenaltySource> parser(1, parseTurnLine);
     return parser(paths);
 }
 }
@@ -0,0 +1,74 @@
+#include "updater/segment_source.hpp"
+
+#include "updater/binary_source.hpp"
+#include "updater/csv_source.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace osrm
+{
+namespace updater
+{
+
+SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths)
+{
+    SegmentLookupTable result;
+    const auto add = [&result](SegmentLookupTable lookup) {
+        if (result.lookup.empty())
+        {
+            result = std::move(lookup);
+        }
+        else
+        {
+            result.lookup = mergeLookupValues(result.lookup, lookup.lookup);
+        }
+    };
+
+    // consecutive CSV files are parsed together, binary files are mapped one by one
+    std::vector<std::string> csv_paths;
+    std::size_t csv_start_index = 1;
+    for (std::size_t index = 0; index < paths.size(); ++index)
+    {
+        if (!binary::isSegmentFile(paths[index]))
+        {
+            if (csv_paths.empty())
+            {
+                csv_start_index = index + 1;
+            }
+            csv_paths.push_back(paths[index]);
+            continue;
+        }
+
+        if (!csv_paths.empty())
+        {
+            add(csv::readSegmentValues(csv_paths, csv_start_index));
+            csv_paths.clear();
+        }
+        add(binary::readSegmentValues(paths[index], static_cast<std::uint8_t>(index + 1)));
+    }
+    if (!csv_paths.empty())
+    {
+        add(csv::readSegmentValues(csv_paths, csv_start_index));
+    }
+
+    return result;
+}
+
+std::string readSegmentSourceName(const std::string &path)
+{
+    if (binary::isSegmentFile(path))
+    {
+        auto name = binary::readSegmentFileName(path);
+        if (!name.empty())
+        {
+            return name;
+        }
+    }
+    return boost::filesystem::path(path).stem().string();
+}
+}
+}
@@ -0,0 +1,142 @@
+#include "updater/speed_profiles.hpp"
+
+#include "updater/csv_file_parser.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+
+#include <tbb/parallel_for.h>
+
+#include <boost/assert.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <limits>
+#include <unordered_map>
+
+namespace osrm
+{
+namespace updater
+{
+namespace
+{
+// from_osm_id,to_osm_id,profile_id
+bool parseSegmentProfileLine(const char *&first,
+                             const char *last,
+                             std::pair<Segment, ProfileSource> &entry)
+{
+    return csv::parseUnsigned(first, last, entry.first.from) &&
+           csv::skipChar(first, last, ',') && csv::parseUnsigned(first, last, entry.first.to) &&
+           csv::skipChar(first, last, ',') &&
+           csv::parseUnsigned(first, last, entry.second.profile);
+}
+
+// profile_id,speed_0,...,speed_n
+bool parseSpeedProfileLine(const std::string &line,
+                           std::uint32_t &profile_id,
+                           std::vector<std::uint8_t> &speeds)
+{
+    const char *first = line.data();
+    const char *last = line.data() + line.size();
+    if (!csv::parseUnsigned(first, last, profile_id))
+    {
+        return false;
+    }
+    while (csv::skipChar(first, last, ','))
+    {
+        std::uint8_t speed;
+        if (!csv::parseUnsigned(first, last, speed))
+        {
+            return false;
+        }
+        speeds.push_back(speed);
+    }
+    return first == last && !speeds.empty();
+}
+}
+
+SpeedProfiles::SpeedProfiles(const std::string &speed_profile_path,
+                             const std::string &segment_profile_path)
+    : num_slots(0)
+{
+    boost::filesystem::ifstream speed_profile_file(speed_profile_path);
+    if (!speed_profile_file)
+    {
+        throw util::exception("Could not open the speed profile file " + speed_profile_path +
+                              SOURCE_REF);
+    }
+
+    std::unordered_map<std::uint32_t, std::uint32_t> profile_indexes;
+    std::string line;
+    for (std::size_t line_number = 1; std::getline(speed_profile_file, line); ++line_number)
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty())
+        {
+            continue;
+        }
+
+        std::uint32_t profile_id;
+        const auto begin = speeds.size();
+        if (!parseSpeedProfileLine(line, profile_id, speeds))
+        {
+            throw util::exception("Speed profile file " + speed_profile_path +
+                                  " malformed on line " + std::to_string(line_number) +
+                                  ", speeds are whole km/h up to 255" + SOURCE_REF);
+        }
+        const auto line_slots = speeds.size() - begin;
+        if (num_slots != 0 && line_slots != num_slots)
+        {
+            throw util::exception("Speed profile " + std::to_string(profile_id) + " in " +
+                                  speed_profile_path + " has " + std::to_string(line_slots) +
+                                  " time slots instead of " + std::to_string(num_slots) +
+                                  SOURCE_REF);
+        }
+        num_slots = line_slots;
+        if (!profile_indexes.emplace(profile_id, profile_indexes.size()).second)
+        {
+            throw util::exception("Speed profile " + std::to_string(profile_id) +
+                                  " is defined twice in " + speed_profile_path + SOURCE_REF);
+        }
+    }
+
+    csv::CSVFilesParser<Segment, ProfileSource> parser(1, parseSegmentProfileLine);
+    segments = parser({segment_profile_path});
+    for (auto &entry : segments.lookup)
+    {
+        const auto index = profile_indexes.find(entry.second.profile);
+        if (index == profile_indexes.end())
+        {
+            throw util::exception("Segment " + std::to_string(entry.first.from) + "," +
+                                  std::to_string(entry.first.to) + " in " + segment_profile_path +
+                                  " has the unknown speed profile " +
+                                  std::to_string(entry.second.profile) + SOURCE_REF);
+        }
+        entry.second.profile = index->second;
+    }
+
+    util::Log() << "Loaded " << GetNumberOfProfiles() << " speed profiles of " << num_slots
+                << " time slots for " << segments.lookup.size() << " segments";
+}
+
+SegmentLookupTable SpeedProfiles::GetSlotSpeeds(const std::size_t slot) const
+{
+    BOOST_ASSERT(slot < num_slots);
+
+    // the segments are already sorted and unique as LookupTable needs them
+    SegmentLookupTable lookup;
+    lookup.lookup.resize(segments.lookup.size());
+    tbb::parallel_for(std::size_t{0}, segments.lookup.size(), [&](const std::size_t index) {
+        const auto &entry = segments.lookup[index];
+        auto &value = lookup.lookup[index];
+        value.first = entry.first;
+        value.second.speed = speeds[entry.second.profile * num_slots + slot];
+        value.second.source = 1;
+    });
+    return lookup;
+}
+}
+}
@@ -1,5 +1,7 @@
 #include "updater/updater.hpp"
 #include "updater/csv_source.hpp"
+#include "updater/segment_index.hpp"
+#include "updater/segment_source.hpp"
 
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/edge_based_graph_factory.hpp"
@@ -11,9 +13,9 @@
 
 #include "storage/io.hpp"
 
+#include "util/coordinate_distances.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
-#include "util/for_each_pair.hpp"
 #include "util/graph_loader.hpp"
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
@@ -39,6 +41,7 @@
 #include <tbb/parallel_invoke.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <bitset>
 #include <cstdint>
@@ -195,23 +198,60 @@ updateSegmentData(const UpdaterConfig &config,
         segment_data_backup = std::make_unique<extractor::SegmentDataContainer>(segment_data);
     }
 
+    TIMER_START(index);
+    const SegmentIndex segment_speed_index(segment_speed_lookup);
+
+    // Bits of the nodes that start or end an updated segment by their id in the geometries.
+    // Segments without a marked node are skipped without decoding their OSM ids or looking them
+    // up, big extracts have many more segments than updates. Every task fills whole words.
+    std::vector<std::uint64_t> updated_nodes((osm_node_ids.size() + 63) / 64, 0);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, updated_nodes.size()),
+                      [&](const auto &range) {
+                          std::array<OSMNodeID, 64> osm_ids;
+                          for (auto word = range.begin(); word < range.end(); ++word)
+                          {
+                              const auto begin = word * 64;
+                              const auto end = std::min(osm_node_ids.size(), begin + 64);
+                              osm_node_ids.unpack(begin, end, osm_ids.begin());
+                              for (auto node = begin; node < end; ++node)
+                              {
+                                  if (segment_speed_index.HasNode(
+                                          static_cast<std::uint64_t>(osm_ids[node - begin])))
+                                  {
+                                      updated_nodes[word] |= std::uint64_t{1} << (node % 64);
+                                  }
+                              }
+                          }
+                      });
+    const auto isUpdated = [&updated_nodes](const NodeID node) {
+        return (updated_nodes[node / 64] >> (node % 64)) & 1;
+    };
+    TIMER_STOP(index);
+    util::Log() << "Indexing " << segment_speed_lookup.lookup.size() << " segment speeds took "
+                << TIMER_MSEC(index) << "ms.";
+
     tbb::concurrent_vector<GeometryID> updated_segments;
 
     using DirectionalGeometryID = extractor::SegmentDataContainer::DirectionalGeometryID;
     auto range = tbb::blocked_range<DirectionalGeometryID>(0, segment_data.GetNumberOfGeometries());
     tbb::parallel_for(range, [&, LUA_SOURCE](const auto &range) {
         auto &counters = segment_speeds_counters.local();
+        std::vector<util::Coordinate> geometry_coordinates;
         std::vector<double> segment_lengths;
         for (auto geometry_id = range.begin(); geometry_id < range.end(); geometry_id++)
         {
             auto nodes_range = segment_data.GetForwardGeometry(geometry_id);
 
-            segment_lengths.clear();
-            segment_lengths.reserve(nodes_range.size() + 1);
-            util::for_each_pair(nodes_range, [&](const auto &u, const auto &v) {
-                segment_lengths.push_back(util::coordinate_calculation::greatCircleDistance(
-                    coordinates[u], coordinates[v]));
-            });
+            geometry_coordinates.clear();
+            for (const auto node : nodes_range)
+            {
+                geometry_coordinates.push_back(coordinates[node]);
+            }
+            segment_lengths.resize(nodes_range.empty() ? 0 : nodes_range.size() - 1);
+            util::coordinate_calculation::greatCircleDistances(geometry_coordinates.data(),
+                                                               geometry_coordinates.data() + 1,
+                                                               segment_lengths.size(),
+                                                               segment_lengths.data());
 
             auto fwd_weights_range = segment_data.GetForwardWeights(geometry_id);
             auto fwd_durations_range = segment_data.GetForwardDurations(geometry_id);
@@ -219,6 +259,13 @@ updateSegmentData(const UpdaterConfig &config,
             bool fwd_was_updated = false;
             for (const auto segment_offset : util::irange<std::size_t>(0, fwd_weights_range.size()))
             {
+                if (!isUpdated(nodes_range[segment_offset]) ||
+                    !isUpdated(nodes_range[segment_offset + 1]))
+                {
+                    counters[LUA_SOURCE] += 1;
+                    continue;
+                }
+
                 auto u = osm_node_ids[nodes_range[segment_offset]];
                 auto v = osm_node_ids[nodes_range[segment_offset + 1]];
 
@@ -227,7 +274,7 @@ updateSegmentData(const UpdaterConfig &config,
                 if (u == v)
                     continue;
 
-                if (auto value = segment_speed_lookup({u, v}))
+                if (auto value = segment_speed_index({u, v}))
                 {
                     auto segment_length = segment_lengths[segment_offset];
                     auto new_duration = convertToDuration(value->speed, segment_length);
@@ -258,6 +305,13 @@ updateSegmentData(const UpdaterConfig &config,
 
             for (const auto segment_offset : util::irange<std::size_t>(0, rev_weights_range.size()))
             {
+                if (!isUpdated(nodes_range[segment_offset]) ||
+                    !isUpdated(nodes_range[segment_offset + 1]))
+                {
+                    counters[LUA_SOURCE] += 1;
+                    continue;
+                }
+
                 auto u = osm_node_ids[nodes_range[segment_offset]];
                 auto v = osm_node_ids[nodes_range[segment_offset + 1]];
 
@@ -266,7 +320,7 @@ updateSegmentData(const UpdaterConfig &config,
                 if (u == v)
                     continue;
 
-                if (auto value = segment_speed_lookup({v, u}))
+                if (auto value = segment_speed_index({v, u}))
                 {
                     auto segment_length = segment_lengths[segment_offset];
                     auto new_duration = convertToDuration(value->speed, segment_length);
@@ -392,12 +446,12 @@ void saveDatasourcesNames(const UpdaterConfig &config)
     sources.SetSourceName(source, "lua profile");
     source++;
 
-    // Only write the filename, without path or extension.
+    // Only write the name of a binary file or the filename, without path or extension.
     // This prevents information leakage, and keeps names short
     // for rendering in the debug tiles.
     for (auto const &name : config.segment_speed_lookup_paths)
     {
-        sources.SetSourceName(source, boost::filesystem::path(name).stem().string());
+        sources.SetSourceName(source, readSegmentSourceName(name));
         source++;
     }
 
@@ -410,7 +464,7 @@ updateTurnPenalties(const UpdaterConfig &config,
                     const TurnLookupTable &turn_penalty_lookup,
                     std::vector<TurnPenalty> &turn_weight_penalties,
                     std::vector<TurnPenalty> &turn_duration_penalties,
-                    extractor::PackedOSMIDs osm_node_ids)
+                    const extractor::PackedOSMIDs &osm_node_ids)
 {
     const auto weight_multiplier = profile_properties.GetWeightMultiplier();
 
@@ -419,40 +473,64 @@ updateTurnPenalties(const UpdaterConfig &config,
     auto turn_index_blocks = util::mmapFile<extractor::lookup::TurnIndexBlock>(
         config.GetPath(".osrm.turn_penalties_index"), turn_index_region);
 
-    // Get the turn penalty and update to the new value if required
+    TIMER_START(index);
+    const TurnIndex turn_penalty_index(turn_penalty_lookup);
+    TIMER_STOP(index);
+    util::Log() << "Indexing " << turn_penalty_lookup.lookup.size() << " turn penalties took "
+                << TIMER_MSEC(index) << "ms.";
+
+    // Turns through a via node without any penalty in the lookup are skipped without decoding
+    // their other OSM ids. Every task collects the turns it updated on its own.
+    tbb::enumerable_thread_specific<std::vector<std::uint64_t>> task_updated_turns;
+    tbb::parallel_for(
+        tbb::blocked_range<std::uint64_t>(0, turn_weight_penalties.size()),
+        [&](const tbb::blocked_range<std::uint64_t> &range) {
+            auto &updated_turns = task_updated_turns.local();
+            for (auto edge_index = range.begin(); edge_index < range.end(); ++edge_index)
+            {
+                // edges are stored by internal OSRM ids, these need to be mapped back to OSM ids
+                const auto &internal_turn = turn_index_blocks[edge_index];
+                const auto osm_turn = [&] {
+                    return Turn{osm_node_ids[internal_turn.from_id],
+                                osm_node_ids[internal_turn.via_id],
+                                osm_node_ids[internal_turn.to_id]};
+                };
+                // original turn weight/duration values
+                auto turn_weight_penalty = turn_weight_penalties[edge_index];
+
+                const auto via = static_cast<std::uint64_t>(osm_node_ids[internal_turn.via_id]);
+                if (turn_penalty_index.HasNode(via))
+                {
+                    if (auto value = turn_penalty_index(osm_turn()))
+                    {
+                        const auto turn_duration_penalty = boost::numeric_cast<TurnPenalty>(
+                            std::round(value->duration * 10.));
+                        turn_weight_penalty = boost::numeric_cast<TurnPenalty>(std::round(
+                            std::isfinite(value->weight)
+                                ? value->weight * weight_multiplier
+                                : turn_duration_penalty * weight_multiplier / 10.));
+
+                        turn_duration_penalties[edge_index] = turn_duration_penalty;
+                        turn_weight_penalties[edge_index] = turn_weight_penalty;
+                        updated_turns.push_back(edge_index);
+                    }
+                }
+
+                if (turn_weight_penalty < 0)
+                {
+                    const auto turn = osm_turn();
+                    util::Log(logWARNING) << "Negative turn penalty at " << turn.from << ", "
+                                          << turn.via << ", " << turn.to << ": turn penalty "
+                                          << turn_weight_penalty;
+                }
+            }
+        });
+
     std::vector<std::uint64_t> updated_turns;
-    for (std::uint64_t edge_index = 0; edge_index < turn_weight_penalties.size(); ++edge_index)
+    for (const auto &task_turns : task_updated_turns)
     {
-        // edges are stored by internal OSRM ids, these need to be mapped back to OSM ids
-        const extractor::lookup::TurnIndexBlock internal_turn = turn_index_blocks[edge_index];
-        const Turn osm_turn{osm_node_ids[internal_turn.from_id],
-                            osm_node_ids[internal_turn.via_id],
-                            osm_node_ids[internal_turn.to_id]};
-        // original turn weight/duration values
-        auto turn_weight_penalty = turn_weight_penalties[edge_index];
-        auto turn_duration_penalty = turn_duration_penalties[edge_index];
-
-        if (auto value = turn_penalty_lookup(osm_turn))
-        {
-            turn_duration_penalty =
-                boost::numeric_cast<TurnPenalty>(std::round(value->duration * 10.));
-            turn_weight_penalty = boost::numeric_cast<TurnPenalty>(std::round(
-                std::isfinite(value->weight) ? value->weight * weight_multiplier
-                                             : turn_duration_penalty * weight_multiplier / 10.));
-
-            turn_duration_penalties[edge_index] = turn_duration_penalty;
-            turn_weight_penalties[edge_index] = turn_weight_penalty;
-            updated_turns.push_back(edge_index);
-        }
-
-        if (turn_weight_penalty < 0)
-        {
-            util::Log(logWARNING) << "Negative turn penalty at " << osm_turn.from << ", "
-                                  << osm_turn.via << ", " << osm_turn.to << ": turn penalty "
-                                  << turn_weight_penalty;
-        }
+        updated_turns.insert(updated_turns.end(), task_turns.begin(), task_turns.end());
     }
-
     return updated_turns;
 }
 
@@ -511,10 +589,30 @@ Updater::NumNodesAndEdges Updater::LoadAndUpdateEdgeExpandedGraph() const
     return std::make_tuple(max_edge_id + 1, std::move(edge_based_edge_list));
 }
 
+Updater::NumNodesAndEdges
+Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<NodeID> &updated_nodes) const
+{
+    std::vector<EdgeWeight> node_weights;
+    std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
+    auto max_edge_id = Updater::LoadAndUpdateEdgeExpandedGraph(
+        edge_based_edge_list, node_weights, updated_nodes);
+    return std::make_tuple(max_edge_id + 1, std::move(edge_based_edge_list));
+}
+
 EdgeID
 Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
                                         std::vector<EdgeWeight> &node_weights) const
 {
+    std::vector<NodeID> updated_nodes;
+    return LoadAndUpdateEdgeExpandedGraph(edge_based_edge_list, node_weights, updated_nodes);
+}
+
+EdgeID
+Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+                                        std::vector<EdgeWeight> &node_weights,
+                                        std::vector<NodeID> &updated_nodes) const
+{
+    updated_nodes.clear();
     TIMER_START(load_edges);
 
     EdgeID max_edge_id = 0;
@@ -532,7 +630,10 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
 
     if (!update_edge_weights && !update_turn_penalties && !update_conditional_turns)
     {
-        saveDatasourcesNames(config);
+        if (config.save_updates)
+        {
+            saveDatasourcesNames(config);
+        }
         return max_edge_id;
     }
 
@@ -600,7 +701,12 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
     tbb::concurrent_vector<GeometryID> updated_segments;
     if (update_edge_weights)
     {
-        auto segment_speed_lookup = csv::readSegmentValues(config.segment_speed_lookup_paths);
+        SegmentLookupTable read_segment_speeds;
+        if (!segment_speeds)
+        {
+            read_segment_speeds = readSegmentValues(config.segment_speed_lookup_paths);
+        }
+        const auto &segment_speed_lookup = segment_speeds ? *segment_speeds : read_segment_speeds;
 
         TIMER_START(segment);
         updated_segments = updateSegmentData(config,
@@ -610,7 +716,10 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                                              coordinates,
                                              osm_node_ids);
         // Now save out the updated compressed geometries
-        extractor::files::writeSegmentData(config.GetPath(".osrm.geometry"), segment_data);
+        if (config.save_updates)
+        {
+            extractor::files::writeSegmentData(config.GetPath(".osrm.geometry"), segment_data);
+        }
         TIMER_STOP(segment);
         util::Log() << "Updating segment data took " << TIMER_MSEC(segment) << "ms.";
     }
@@ -716,6 +825,7 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                           }
                       });
 
+    tbb::concurrent_vector<NodeID> updated_edge_nodes;
     const auto update_edge = [&](extractor::EdgeBasedEdge &edge) {
         const auto node_id = edge.source;
         const auto geometry_id = node_data.GetGeometryID(node_id);
@@ -729,6 +839,9 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
         if (updated_iter != updated_segments.end() && updated_iter->id == geometry_id.id &&
             updated_iter->forward == geometry_id.forward)
         {
+            updated_edge_nodes.push_back(edge.source);
+            updated_edge_nodes.push_back(edge.target);
+
             // Find a segment with zero speed and simultaneously compute the new edge
             // weight
             EdgeWeight new_weight;
@@ -789,9 +902,14 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                                   update_edge(edge_based_edge_list[index]);
                               }
                           });
+
+        updated_nodes.assign(updated_edge_nodes.begin(), updated_edge_nodes.end());
+        tbb::parallel_sort(updated_nodes.begin(), updated_nodes.end());
+        updated_nodes.erase(std::unique(updated_nodes.begin(), updated_nodes.end()),
+                            updated_nodes.end());
     }
 
-    if (update_turn_penalties || update_conditional_turns)
+    if ((update_turn_penalties || update_conditional_turns) && config.save_updates)
     {
         const auto save_penalties = [](const auto &filename, const auto &data) -> void {
             storage::io::FileWriter writer(filename, storage::io::FileWriter::GenerateFingerprint);
@@ -817,7 +935,10 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
     }
 #endif
 
-    saveDatasourcesNames(config);
+    if (config.save_updates)
+    {
+        saveDatasourcesNames(config);
+    }
 
     TIMER_STOP(load_edges);
     util::Log() << "Done reading edges in " << TIMER_MSEC(load_edges) << "ms.";
@@ -0,0 +1,64 @@
+#include "util/allocation_statistics.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+// constant initialized, so operator new can use it before anything else ran on a thread
+thread_local AllocationStatistics thread_allocations;
+}
+
+AllocationStatistics GetThreadAllocationStatistics() { return thread_allocations; }
+
+#if OSRM_ALLOCATION_STATISTICS
+namespace
+{
+void *allocate(const std::size_t size) noexcept
+{
+    ++thread_allocations.allocations;
+    thread_allocations.bytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *allocateOrThrow(const std::size_t size)
+{
+    for (;;)
+    {
+        if (auto *pointer = allocate(size))
+            return pointer;
+        const auto handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+}
+#endif
+}
+}
+
+#if OSRM_ALLOCATION_STATISTICS
+void *operator new(std::size_t size) { return osrm::util::allocateOrThrow(size); }
+void *operator new[](std::size_t size) { return osrm::util::allocateOrThrow(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return osrm::util::allocate(size);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return osrm::util::allocate(size);
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { std::free(pointer); }
+#endif
@@ -0,0 +1,130 @@
+#include "util/chunk_arena.hpp"
+#include "util/huge_pages.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include <cstdint>
+#include <new>
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+void *mapChunk()
+{
+#ifdef __linux__
+    // Transparent huge pages are only used for aligned ranges. One huge page more than needed
+    // is mapped and the unaligned ends are unmapped again.
+    static const std::size_t huge_page_size = getHugePageSize();
+    const auto mapping_size = ChunkArena::CHUNK_SIZE + huge_page_size;
+    auto mapping =
+        ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    if (huge_page_size == 0)
+    {
+        return mapping;
+    }
+
+    const auto begin = reinterpret_cast<std::uintptr_t>(mapping);
+    const auto aligned = (begin + huge_page_size - 1) / huge_page_size * huge_page_size;
+    if (aligned > begin)
+    {
+        ::munmap(mapping, aligned - begin);
+    }
+    const auto end = aligned + ChunkArena::CHUNK_SIZE;
+    if (begin + mapping_size > end)
+    {
+        ::munmap(reinterpret_cast<void *>(end), begin + mapping_size - end);
+    }
+    auto chunk = reinterpret_cast<void *>(aligned);
+    adviseHugePages(chunk, ChunkArena::CHUNK_SIZE);
+    return chunk;
+#else
+    return new char[ChunkArena::CHUNK_SIZE]();
+#endif
+}
+
+void unmapChunk(void *chunk)
+{
+#ifdef __linux__
+    ::munmap(chunk, ChunkArena::CHUNK_SIZE);
+#else
+    delete[] static_cast<char *>(chunk);
+#endif
+}
+}
+
+constexpr std::size_t ChunkArena::CHUNK_SIZE;
+constexpr std::size_t ChunkArena::DEFAULT_MAX_CACHED_CHUNKS;
+
+ChunkArena &ChunkArena::GetInstance()
+{
+    static ChunkArena arena;
+    return arena;
+}
+
+ChunkArena::ChunkArena(const std::size_t max_cached_chunks) : max_cached_chunks(max_cached_chunks)
+{
+}
+
+ChunkArena::~ChunkArena() { Release(); }
+
+void *ChunkArena::Allocate()
+{
+    {
+        std::lock_guard<std::mutex> lock(cached_chunks_mutex);
+        if (!cached_chunks.empty())
+        {
+            auto chunk = cached_chunks.back();
+            cached_chunks.pop_back();
+            return chunk;
+        }
+    }
+    return mapChunk();
+}
+
+void ChunkArena::Free(void *chunk)
+{
+    if (chunk == nullptr)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(cached_chunks_mutex);
+        if (cached_chunks.size() < max_cached_chunks)
+        {
+            cached_chunks.push_back(chunk);
+            return;
+        }
+    }
+    unmapChunk(chunk);
+}
+
+void ChunkArena::Release()
+{
+    std::vector<void *> chunks;
+    {
+        std::lock_guard<std::mutex> lock(cached_chunks_mutex);
+        chunks.swap(cached_chunks);
+    }
+    for (auto chunk : chunks)
+    {
+        unmapChunk(chunk);
+    }
+}
+
+std::size_t ChunkArena::GetCachedChunks() const
+{
+    std::lock_guard<std::mutex> lock(cached_chunks_mutex);
+    return cached_chunks.size();
+}
+}
+}
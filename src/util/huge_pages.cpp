@@ -0,0 +1,251 @@
+#include "util/huge_pages.hpp"
+#include "util/log.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+namespace osrm
+{
+namespace util
+{
+
+std::size_t getHugePageSize()
+{
+#ifdef __linux__
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line))
+    {
+        std::istringstream fields(line);
+        std::string name;
+        std::size_t kilobytes;
+        if (fields >> name >> kilobytes && name == "Hugepagesize:")
+        {
+            return kilobytes * 1024;
+        }
+    }
+#endif
+    return 0;
+}
+
+std::size_t roundToHugePages(const std::size_t size)
+{
+    const auto huge_page_size = getHugePageSize();
+    if (huge_page_size == 0)
+    {
+        return size;
+    }
+    return (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+
+bool adviseHugePages(void *address, const std::size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    return ::madvise(address, size, MADV_HUGEPAGE) == 0;
+#else
+    (void)address;
+    (void)size;
+    return false;
+#endif
+}
+
+void prefaultPages(const void *address, const std::size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+#ifdef __linux__
+    const std::size_t page_size = ::sysconf(_SC_PAGESIZE);
+#else
+    const std::size_t page_size = 4096;
+#endif
+    const auto begin = reinterpret_cast<std::uintptr_t>(address) / page_size * page_size;
+    const auto end = reinterpret_cast<std::uintptr_t>(address) + size;
+
+#if defined(__linux__) && defined(MADV_POPULATE_READ)
+    // since Linux 5.14, older kernels reject the advice and the pages are read below
+    if (::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_POPULATE_READ) == 0)
+    {
+        return;
+    }
+#endif
+
+    // reading one byte maps the whole page
+    const auto num_pages = (end - begin + page_size - 1) / page_size;
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, num_pages),
+                      [&](const tbb::blocked_range<std::size_t> &pages) {
+                          for (auto page = pages.begin(); page != pages.end(); ++page)
+                          {
+                              *reinterpret_cast<const volatile char *>(begin + page * page_size);
+                          }
+                      });
+}
+
+bool lockPages(const void *address, const std::size_t size)
+{
+#ifdef __linux__
+    return ::mlock(address, size) == 0;
+#else
+    (void)address;
+    (void)size;
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+std::string describeLockedMemoryLimit()
+{
+#ifdef __linux__
+    ::rlimit limit;
+    if (::getrlimit(RLIMIT_MEMLOCK, &limit) == 0)
+    {
+        return limit.rlim_cur == RLIM_INFINITY ? "unlimited"
+                                               : std::to_string(limit.rlim_cur) + " bytes";
+    }
+#endif
+    return "unknown";
+}
+
+std::string describePages(const void *address)
+{
+#ifdef __linux__
+    // Every mapping in smaps starts with a "begin-end ..." line followed by "Name: value" lines
+    const auto target = reinterpret_cast<std::uintptr_t>(address);
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool in_mapping = false;
+    std::string page_size;
+    std::size_t transparent_kilobytes = 0;
+    while (std::getline(smaps, line))
+    {
+        std::uintptr_t begin, end;
+        char separator;
+        std::istringstream range(line);
+        if (range >> std::hex >> begin >> separator >> end && separator == '-')
+        {
+            if (in_mapping)
+            {
+                break;
+            }
+            in_mapping = begin <= target && target < end;
+            continue;
+        }
+        if (!in_mapping)
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string name;
+        std::size_t kilobytes;
+        if (!(fields >> name >> kilobytes))
+        {
+            continue;
+        }
+        if (name == "KernelPageSize:")
+        {
+            page_size = std::to_string(kilobytes) + " kB pages";
+        }
+        else if (name == "AnonHugePages:" || name == "ShmemPmdMapped:")
+        {
+            transparent_kilobytes += kilobytes;
+        }
+    }
+
+    if (!page_size.empty())
+    {
+        if (transparent_kilobytes > 0)
+        {
+            page_size += ", " + std::to_string(transparent_kilobytes) +
+                         " kB of them in transparent huge pages";
+        }
+        return page_size;
+    }
+#else
+    (void)address;
+#endif
+    return "pages of unknown size";
+}
+
+ProcessMemory::ProcessMemory(const std::size_t size, const bool use_huge_pages)
+    : memory(nullptr), mapping(nullptr), mapping_size(0)
+{
+#ifdef __linux__
+    const auto huge_page_size = use_huge_pages ? getHugePageSize() : 0;
+    if (huge_page_size > 0)
+    {
+        mapping_size = roundToHugePages(size);
+        mapping = ::mmap(nullptr,
+                         mapping_size,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                         -1,
+                         0);
+        if (mapping != MAP_FAILED)
+        {
+            memory = static_cast<char *>(mapping);
+            return;
+        }
+        util::Log(logWARNING) << "Could not allocate " << mapping_size
+                              << " bytes of huge pages: " << std::strerror(errno)
+                              << ", falling back to transparent huge pages";
+    }
+
+    // Transparent huge pages are only used for aligned ranges, so one page is spared to
+    // align the start of memory
+    mapping_size = size + huge_page_size;
+    mapping = ::mmap(
+        nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+        throw std::bad_alloc();
+    }
+    const auto begin = reinterpret_cast<std::uintptr_t>(mapping);
+    const auto aligned = huge_page_size > 0
+                             ? (begin + huge_page_size - 1) / huge_page_size * huge_page_size
+                             : begin;
+    memory = reinterpret_cast<char *>(aligned);
+    if (use_huge_pages && !adviseHugePages(memory, size))
+    {
+        util::Log(logWARNING) << "Transparent huge pages are not available, using regular pages";
+    }
+#else
+    if (use_huge_pages)
+    {
+        util::Log(logWARNING) << "Huge pages are not supported on this platform";
+    }
+    memory = new char[size]();
+#endif
+}
+
+ProcessMemory::~ProcessMemory()
+{
+#ifdef __linux__
+    if (mapping != nullptr)
+    {
+        ::munmap(mapping, mapping_size);
+        return;
+    }
+#endif
+    BOOST_ASSERT(mapping == nullptr);
+    delete[] memory;
+}
+}
+}
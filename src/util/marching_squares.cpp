@@ -0,0 +1,246 @@
+#include "util/marching_squares.hpp"
+
+#include <boost/assert.hpp>
+
+#include <unordered_map>
+
+namespace osrm
+{
+namespace util
+{
+namespace marching_squares
+{
+
+namespace
+{
+std::uint64_t toKey(const Point point)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(point.x)) << 32) |
+           static_cast<std::uint32_t>(point.y);
+}
+
+Point fromKey(const std::uint64_t key)
+{
+    return Point{static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32)),
+                 static_cast<std::int32_t>(static_cast<std::uint32_t>(key))};
+}
+
+// twice the signed area, positive for counter-clockwise rings
+std::int64_t doubledArea(const Ring &ring)
+{
+    std::int64_t area = 0;
+    for (std::size_t index = 0; index < ring.size(); ++index)
+    {
+        const auto &from = ring[index];
+        const auto &to = ring[(index + 1) % ring.size()];
+        area += static_cast<std::int64_t>(from.x) * to.y - static_cast<std::int64_t>(to.x) * from.y;
+    }
+    return area;
+}
+
+// the point must not be on the ring
+bool contains(const Ring &ring, const Point point)
+{
+    bool inside = false;
+    for (std::size_t index = 0, previous = ring.size() - 1; index < ring.size(); previous = index++)
+    {
+        const auto &from = ring[previous];
+        const auto &to = ring[index];
+        if ((from.y > point.y) != (to.y > point.y))
+        {
+            const double x = from.x + static_cast<double>(point.y - from.y) * (to.x - from.x) /
+                                          (to.y - from.y);
+            if (point.x < x)
+            {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+Ring dropCollinearPoints(const Ring &ring)
+{
+    Ring corners;
+    for (std::size_t index = 0; index < ring.size(); ++index)
+    {
+        const auto &previous = ring[(index + ring.size() - 1) % ring.size()];
+        const auto &point = ring[index];
+        const auto &next = ring[(index + 1) % ring.size()];
+        const auto cross = static_cast<std::int64_t>(point.x - previous.x) * (next.y - point.y) -
+                           static_cast<std::int64_t>(point.y - previous.y) * (next.x - point.x);
+        if (cross != 0)
+        {
+            corners.push_back(point);
+        }
+    }
+    return corners;
+}
+}
+
+void Grid::Close()
+{
+    const auto any_neighbour = [](const Grid &grid, const std::int64_t x, const std::int64_t y) {
+        for (std::int64_t dy = -1; dy <= 1; ++dy)
+            for (std::int64_t dx = -1; dx <= 1; ++dx)
+                if (grid.IsSet(x + dx, y + dy))
+                    return true;
+        return false;
+    };
+    const auto all_neighbours = [](const Grid &grid, const std::int64_t x, const std::int64_t y) {
+        for (std::int64_t dy = -1; dy <= 1; ++dy)
+            for (std::int64_t dx = -1; dx <= 1; ++dx)
+                if (!grid.IsSet(x + dx, y + dy))
+                    return false;
+        return true;
+    };
+
+    Grid dilated(width, height);
+    for (std::size_t y = 0; y < height; ++y)
+        for (std::size_t x = 0; x < width; ++x)
+            if (any_neighbour(*this, x, y))
+                dilated.Set(x, y);
+
+    for (std::size_t y = 0; y < height; ++y)
+        for (std::size_t x = 0; x < width; ++x)
+            cells[y * width + x] = all_neighbours(dilated, x, y);
+}
+
+std::vector<Polygon> traceContours(const Grid &grid)
+{
+    // every midpoint the outlines pass is the start of exactly one segment
+    std::unordered_map<std::uint64_t, Point> segments;
+    const auto add_segment = [&segments](const Point from, const Point to) {
+        const auto inserted = segments.emplace(toKey(from), to).second;
+        BOOST_ASSERT(inserted);
+        (void)inserted;
+    };
+
+    // A square between four cell centers, its segments keep the set corners on their left so
+    // that outer rings are counter-clockwise and holes clockwise. The squares along the borders
+    // of the grid close the outlines of the cells on them.
+    const auto width = static_cast<std::int32_t>(grid.GetWidth());
+    const auto height = static_cast<std::int32_t>(grid.GetHeight());
+    for (std::int32_t y = -1; y < height; ++y)
+    {
+        for (std::int32_t x = -1; x < width; ++x)
+        {
+            const auto corners = (grid.IsSet(x, y) ? 1 : 0) | (grid.IsSet(x + 1, y) ? 2 : 0) |
+                                 (grid.IsSet(x + 1, y + 1) ? 4 : 0) |
+                                 (grid.IsSet(x, y + 1) ? 8 : 0);
+            const Point bottom{2 * x + 1, 2 * y};
+            const Point right{2 * x + 2, 2 * y + 1};
+            const Point top{2 * x + 1, 2 * y + 2};
+            const Point left{2 * x, 2 * y + 1};
+            switch (corners)
+            {
+            case 1:
+                add_segment(bottom, left);
+                break;
+            case 2:
+                add_segment(right, bottom);
+                break;
+            case 3:
+                add_segment(right, left);
+                break;
+            case 4:
+                add_segment(top, right);
+                break;
+            case 5:
+                // the diagonal corners stay apart
+                add_segment(bottom, left);
+                add_segment(top, right);
+                break;
+            case 6:
+                add_segment(top, bottom);
+                break;
+            case 7:
+                add_segment(top, left);
+                break;
+            case 8:
+                add_segment(left, top);
+                break;
+            case 9:
+                add_segment(bottom, top);
+                break;
+            case 10:
+                add_segment(right, bottom);
+                add_segment(left, top);
+                break;
+            case 11:
+                add_segment(right, top);
+                break;
+            case 12:
+                add_segment(left, right);
+                break;
+            case 13:
+                add_segment(bottom, right);
+                break;
+            case 14:
+                add_segment(left, bottom);
+                break;
+            default:
+                // all or none of the corners are set
+                break;
+            }
+        }
+    }
+
+    std::vector<Ring> outer_rings;
+    std::vector<Ring> holes;
+    while (!segments.empty())
+    {
+        Ring ring;
+        auto point = fromKey(segments.begin()->first);
+        do
+        {
+            ring.push_back(point);
+            const auto segment = segments.find(toKey(point));
+            BOOST_ASSERT(segment != segments.end());
+            point = segment->second;
+            segments.erase(segment);
+        } while (!(point == ring.front()));
+
+        auto corners = dropCollinearPoints(ring);
+        if (doubledArea(corners) > 0)
+        {
+            outer_rings.push_back(std::move(corners));
+        }
+        else
+        {
+            holes.push_back(std::move(corners));
+        }
+    }
+
+    std::vector<Polygon> polygons(outer_rings.size());
+    std::vector<std::int64_t> areas(outer_rings.size());
+    for (std::size_t index = 0; index < outer_rings.size(); ++index)
+    {
+        areas[index] = doubledArea(outer_rings[index]);
+        polygons[index].outer = std::move(outer_rings[index]);
+    }
+
+    // a hole belongs to the smallest outer ring around it
+    for (auto &hole : holes)
+    {
+        auto smallest = polygons.size();
+        for (std::size_t index = 0; index < polygons.size(); ++index)
+        {
+            if ((smallest == polygons.size() || areas[index] < areas[smallest]) &&
+                contains(polygons[index].outer, hole.front()))
+            {
+                smallest = index;
+            }
+        }
+        BOOST_ASSERT(smallest != polygons.size());
+        if (smallest != polygons.size())
+        {
+            polygons[smallest].holes.push_back(std::move(hole));
+        }
+    }
+
+    return polygons;
+}
+}
+}
+}
@@ -1,7 +1,13 @@
 #include "util/name_table.hpp"
 #include "storage/io.hpp"
+#include "util/exception.hpp"
 #include "util/log.hpp"
 
+#include <boost/assert.hpp>
+
+#include <cstring>
+#include <unordered_map>
+
 namespace osrm
 {
 namespace util
@@ -37,7 +43,7 @@ StringView NameTable::GetNameForID(const NameID id) const
     if (id == INVALID_NAMEID)
         return {};
 
-    return m_name_table.at(id + 0);
+    return Resolve(m_name_table.at(id + 0));
 }
 
 StringView NameTable::GetDestinationsForID(const NameID id) const
@@ -45,7 +51,7 @@ StringView NameTable::GetDestinationsForID(const NameID id) const
     if (id == INVALID_NAMEID)
         return {};
 
-    return m_name_table.at(id + 1);
+    return Resolve(m_name_table.at(id + 1));
 }
 
 StringView NameTable::GetExitsForID(const NameID id) const
@@ -53,7 +59,7 @@ StringView NameTable::GetExitsForID(const NameID id) const
     if (id == INVALID_NAMEID)
         return {};
 
-    return m_name_table.at(id + 4);
+    return Resolve(m_name_table.at(id + 4));
 }
 
 StringView NameTable::GetRefForID(const NameID id) const
@@ -73,7 +79,7 @@ StringView NameTable::GetRefForID(const NameID id) const
     // Offset 0 is name, 1 is destination, 2 is pronunciation, 3 is ref, 4 is exits
     // See datafacades and extractor callbacks for details.
     const constexpr auto OFFSET_REF = 3u;
-    return m_name_table.at(id + OFFSET_REF);
+    return Resolve(m_name_table.at(id + OFFSET_REF));
 }
 
 StringView NameTable::GetPronunciationForID(const NameID id) const
@@ -93,7 +99,62 @@ StringView NameTable::GetPronunciationForID(const NameID id) const
     // Offset 0 is name, 1 is destination, 2 is pronunciation, 3 is ref, 4 is exits
     // See datafacades and extractor callbacks for details.
     const constexpr auto OFFSET_PRONUNCIATION = 2u;
-    return m_name_table.at(id + OFFSET_PRONUNCIATION);
+    return Resolve(m_name_table.at(id + OFFSET_PRONUNCIATION));
+}
+
+StringView NameTable::Resolve(const StringView string) const
+{
+    if (string.size() != STRING_REFERENCE_SIZE || string.front() != '\0')
+        return string;
+
+    std::uint32_t index;
+    std::memcpy(&index, string.data() + 1, sizeof(index));
+    return m_name_table.at(index);
+}
+
+void NameTable::InternStrings(std::vector<std::uint32_t> &offsets, std::vector<unsigned char> &data)
+{
+    BOOST_ASSERT(!offsets.empty() && offsets.back() == data.size());
+
+    std::vector<std::uint32_t> interned_offsets;
+    std::vector<unsigned char> interned_data;
+    interned_offsets.reserve(offsets.size());
+    interned_offsets.push_back(0);
+
+    // views into data of the first occurrence of every string longer than a reference
+    std::unordered_map<StringView, std::uint32_t> first_occurrences;
+    for (std::uint32_t index = 0; index + 1 < offsets.size(); ++index)
+    {
+        const StringView string(reinterpret_cast<const char *>(data.data()) + offsets[index],
+                                offsets[index + 1] - offsets[index]);
+
+        if (string.size() == STRING_REFERENCE_SIZE && string.front() == '\0')
+        {
+            throw util::exception("Name " + std::to_string(index) +
+                                  " starts with a NUL byte and can not be told from a reference");
+        }
+
+        const auto first_occurrence =
+            string.size() > STRING_REFERENCE_SIZE
+                ? first_occurrences.emplace(string, index)
+                : std::make_pair(first_occurrences.end(), true);
+        if (first_occurrence.second)
+        {
+            interned_data.insert(interned_data.end(), string.begin(), string.end());
+        }
+        else
+        {
+            const auto reference = first_occurrence.first->second;
+            const auto reference_bytes = reinterpret_cast<const unsigned char *>(&reference);
+            interned_data.push_back('\0');
+            interned_data.insert(
+                interned_data.end(), reference_bytes, reference_bytes + sizeof(reference));
+        }
+        interned_offsets.push_back(interned_data.size());
+    }
+
+    offsets.swap(interned_offsets);
+    data.swap(interned_data);
 }
 
 } // namespace util
@@ -0,0 +1,224 @@
+#include "util/numa.hpp"
+#include "util/log.hpp"
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace osrm
+{
+namespace util
+{
+namespace numa
+{
+
+namespace
+{
+// Parses the kernel's list format, e.g. "0-3,8-11"
+std::vector<unsigned> readList(const std::string &path)
+{
+    std::vector<unsigned> values;
+    std::ifstream file(path);
+    std::string line;
+    if (!std::getline(file, line))
+    {
+        return values;
+    }
+    boost::algorithm::trim(line);
+
+    std::vector<std::string> ranges;
+    boost::algorithm::split(ranges, line, boost::algorithm::is_any_of(","));
+    for (const auto &range : ranges)
+    {
+        if (range.empty())
+        {
+            continue;
+        }
+        const auto separator = range.find('-');
+        const auto first = std::strtoul(range.c_str(), nullptr, 10);
+        const auto last = separator == std::string::npos
+                              ? first
+                              : std::strtoul(range.c_str() + separator + 1, nullptr, 10);
+        for (auto value = first; value <= last; ++value)
+        {
+            values.push_back(static_cast<unsigned>(value));
+        }
+    }
+    return values;
+}
+
+const std::string NODE_DIRECTORY = "/sys/devices/system/node/";
+
+constexpr std::size_t BITS_PER_WORD = sizeof(unsigned long) * CHAR_BIT;
+
+// The nodes with memory as bit mask for the mempolicy calls, empty if there are less than two
+std::vector<unsigned long> getInterleaveMask()
+{
+    const auto memory_nodes = readList(NODE_DIRECTORY + "has_memory");
+    if (memory_nodes.size() < 2)
+    {
+        return {};
+    }
+
+    const auto max_node = *std::max_element(memory_nodes.begin(), memory_nodes.end());
+    std::vector<unsigned long> mask(max_node / BITS_PER_WORD + 1, 0);
+    for (const auto node : memory_nodes)
+    {
+        mask[node / BITS_PER_WORD] |= 1ul << (node % BITS_PER_WORD);
+    }
+    return mask;
+}
+}
+
+std::vector<Node> getNodes()
+{
+    std::vector<Node> nodes;
+    for (const auto id : readList(NODE_DIRECTORY + "online"))
+    {
+        nodes.push_back(
+            Node{id, readList(NODE_DIRECTORY + "node" + std::to_string(id) + "/cpulist")});
+    }
+
+    // nodes without CPUs only hold memory, no thread runs on them
+    nodes.erase(std::remove_if(nodes.begin(),
+                               nodes.end(),
+                               [](const Node &node) { return node.cpus.empty(); }),
+                nodes.end());
+    if (nodes.empty())
+    {
+        nodes.push_back(Node{0, {}});
+    }
+    return nodes;
+}
+
+unsigned getCurrentNode()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+    {
+        return node;
+    }
+#endif
+    return 0;
+}
+
+bool pinThreadToNode(const Node &node)
+{
+    if (node.cpus.empty())
+    {
+        return true;
+    }
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const auto cpu : node.cpus)
+    {
+        if (cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool interleaveMemory(void *address, const std::size_t size)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    const auto mask = getInterleaveMask();
+    if (mask.empty())
+    {
+        return false;
+    }
+
+    // the kernel ignores the last bit of maxnode, so it counts one more
+    if (::syscall(SYS_mbind,
+                  address,
+                  size,
+                  MPOL_INTERLEAVE,
+                  mask.data(),
+                  mask.size() * BITS_PER_WORD + 1,
+                  0) != 0)
+    {
+        util::Log(logWARNING) << "Could not interleave memory over NUMA nodes";
+        return false;
+    }
+    return true;
+#else
+    (void)address;
+    (void)size;
+    return false;
+#endif
+}
+
+bool bindMemory(void *address, const std::size_t size, const unsigned node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    if (getInterleaveMask().empty())
+    {
+        return false;
+    }
+
+    std::vector<unsigned long> mask(node / BITS_PER_WORD + 1, 0);
+    mask[node / BITS_PER_WORD] |= 1ul << (node % BITS_PER_WORD);
+    if (::syscall(SYS_mbind,
+                  address,
+                  size,
+                  MPOL_PREFERRED,
+                  mask.data(),
+                  mask.size() * BITS_PER_WORD + 1,
+                  0) != 0)
+    {
+        util::Log(logWARNING) << "Could not bind memory to NUMA node " << node;
+        return false;
+    }
+    return true;
+#else
+    (void)address;
+    (void)size;
+    (void)node;
+    return false;
+#endif
+}
+
+ThreadInterleave::ThreadInterleave() : active(false)
+{
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    const auto mask = getInterleaveMask();
+    active = !mask.empty() && ::syscall(SYS_set_mempolicy,
+                                        MPOL_INTERLEAVE,
+                                        mask.data(),
+                                        mask.size() * BITS_PER_WORD + 1) == 0;
+#endif
+}
+
+ThreadInterleave::~ThreadInterleave()
+{
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    if (active)
+    {
+        ::syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+    }
+#endif
+}
+}
+}
+}
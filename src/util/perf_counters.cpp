@@ -0,0 +1,117 @@
+#include "util/perf_counters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+const char *EVENT_NAMES[PerfCounterValues::NUMBER_OF_EVENTS] = {
+    "cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses"};
+
+#ifdef __linux__
+int openEvent(const std::uint32_t type, const std::uint64_t config)
+{
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // the calling thread on any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+}
+
+constexpr std::uint64_t cacheEvent(const std::uint64_t cache)
+{
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+}
+
+PerfCounters::PerfCounters()
+{
+    fds.fill(-1);
+#ifdef __linux__
+    fds[PerfCounterValues::CYCLES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[PerfCounterValues::INSTRUCTIONS] =
+        openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[PerfCounterValues::LLC_MISSES] =
+        openEvent(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_LL));
+    fds[PerfCounterValues::DTLB_MISSES] =
+        openEvent(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_DTLB));
+    fds[PerfCounterValues::BRANCH_MISSES] =
+        openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (const auto fd : fds)
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+#endif
+}
+
+bool PerfCounters::AnyAvailable() const
+{
+    return std::any_of(fds.begin(), fds.end(), [](const auto fd) { return fd >= 0; });
+}
+
+PerfCounterValues PerfCounters::Read() const
+{
+    PerfCounterValues counters;
+#ifdef __linux__
+    for (std::size_t event = 0; event < PerfCounterValues::NUMBER_OF_EVENTS; ++event)
+    {
+        if (fds[event] < 0)
+            continue;
+        // value, time enabled, time running
+        std::uint64_t values[3] = {0, 0, 0};
+        if (read(fds[event], values, sizeof(values)) != sizeof(values))
+            continue;
+        counters.values[event] =
+            values[2] > 0 && values[2] < values[1]
+                ? static_cast<std::uint64_t>(static_cast<double>(values[0]) * values[1] /
+                                             values[2])
+                : values[0];
+    }
+#endif
+    return counters;
+}
+
+util::json::Object PerfCounters::ToJSON(const PerfCounterValues &counters,
+                                        const double count) const
+{
+    util::json::Object json;
+    for (std::size_t event = 0; event < PerfCounterValues::NUMBER_OF_EVENTS; ++event)
+    {
+        if (fds[event] >= 0)
+            json.values[EVENT_NAMES[event]] = counters.values[event] / count;
+    }
+    if (Available(PerfCounterValues::CYCLES) && Available(PerfCounterValues::INSTRUCTIONS) &&
+        counters.values[PerfCounterValues::CYCLES] > 0)
+    {
+        json.values["ipc"] = static_cast<double>(counters.values[PerfCounterValues::INSTRUCTIONS]) /
+                             counters.values[PerfCounterValues::CYCLES];
+    }
+    return json;
+}
+}
+}
@@ -0,0 +1,177 @@
+#include "util/phase_profiler.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/log.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace osrm
+{
+namespace util
+{
+
+namespace
+{
+// rchar and wchar count the bytes of all read and write calls, read_bytes and write_bytes only
+// the ones that reached the storage layer
+void readIOCounters(std::uint64_t &bytes_read, std::uint64_t &bytes_written)
+{
+    bytes_read = 0;
+    bytes_written = 0;
+#ifdef __linux__
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    std::uint64_t value;
+    while (io >> key >> value)
+    {
+        if (key == "rchar:")
+            bytes_read = value;
+        else if (key == "wchar:")
+            bytes_written = value;
+    }
+#endif
+}
+
+double toSeconds(const std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+}
+}
+
+ResourceUsage GetResourceUsage()
+{
+    ResourceUsage usage{std::chrono::steady_clock::now(), 0., 0, 0, 0};
+#ifndef _WIN32
+    rusage self;
+    getrusage(RUSAGE_SELF, &self);
+    usage.cpu_seconds = self.ru_utime.tv_sec + self.ru_stime.tv_sec +
+                        (self.ru_utime.tv_usec + self.ru_stime.tv_usec) / 1000000.;
+#ifdef __linux__
+    // Under linux, ru.maxrss is in kb
+    usage.peak_rss_bytes = static_cast<std::uint64_t>(self.ru_maxrss) * 1024;
+#else
+    // Under BSD systems (OSX), it's in bytes
+    usage.peak_rss_bytes = self.ru_maxrss;
+#endif
+#endif
+    readIOCounters(usage.bytes_read, usage.bytes_written);
+    return usage;
+}
+
+PhaseProfiler &PhaseProfiler::GetInstance()
+{
+    static PhaseProfiler profiler;
+    return profiler;
+}
+
+std::size_t PhaseProfiler::Begin(std::string name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    phases.push_back(PhaseRecord{std::move(name), depth++, 0., 0., 0, 0, 0, 0});
+    return phases.size() - 1;
+}
+
+void PhaseProfiler::End(const std::size_t phase,
+                        const ResourceUsage &begin,
+                        const ResourceUsage &end)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    BOOST_ASSERT(depth > 0);
+    --depth;
+    BOOST_ASSERT(phase < phases.size());
+
+    auto &record = phases[phase];
+    record.wall_seconds = toSeconds(end.time - begin.time);
+    record.cpu_seconds = end.cpu_seconds - begin.cpu_seconds;
+    record.peak_rss_bytes = end.peak_rss_bytes;
+    record.peak_rss_delta_bytes =
+        end.peak_rss_bytes - std::min(begin.peak_rss_bytes, end.peak_rss_bytes);
+    record.bytes_read = end.bytes_read - std::min(begin.bytes_read, end.bytes_read);
+    record.bytes_written = end.bytes_written - std::min(begin.bytes_written, end.bytes_written);
+}
+
+std::vector<PhaseRecord> PhaseProfiler::GetPhases() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return phases;
+}
+
+void PhaseProfiler::Write(const boost::filesystem::path &path, const std::string &tool) const
+{
+    json::Array phases_json;
+    for (const auto &phase : GetPhases())
+    {
+        json::Object phase_json;
+        phase_json.values["name"] = phase.name;
+        phase_json.values["depth"] = static_cast<double>(phase.depth);
+        phase_json.values["wall_time"] = phase.wall_seconds;
+        phase_json.values["cpu_time"] = phase.cpu_seconds;
+        phase_json.values["peak_rss"] = static_cast<double>(phase.peak_rss_bytes);
+        phase_json.values["peak_rss_delta"] = static_cast<double>(phase.peak_rss_delta_bytes);
+        phase_json.values["bytes_read"] = static_cast<double>(phase.bytes_read);
+        phase_json.values["bytes_written"] = static_cast<double>(phase.bytes_written);
+        phases_json.values.push_back(std::move(phase_json));
+    }
+
+    json::Object report;
+    report.values["tool"] = tool;
+    report.values["phases"] = std::move(phases_json);
+
+    boost::filesystem::ofstream out(path);
+    if (!out)
+    {
+        throw util::exception("Could not open " + path.string() + " for writing" + SOURCE_REF);
+    }
+    json::render(out, report);
+    out << "\n";
+}
+
+ProfilePhase::ProfilePhase(std::string name)
+    : phase(PhaseProfiler::GetInstance().Begin(std::move(name))), begin(GetResourceUsage())
+{
+}
+
+ProfilePhase::~ProfilePhase() { Stop(); }
+
+void ProfilePhase::Stop()
+{
+    if (stopped)
+        return;
+    stopped = true;
+    PhaseProfiler::GetInstance().End(phase, begin, GetResourceUsage());
+}
+
+PhaseReport::PhaseReport(std::string tool_, boost::filesystem::path path_)
+    : tool(std::move(tool_)), path(std::move(path_)), run(tool)
+{
+}
+
+PhaseReport::~PhaseReport()
+{
+    run.Stop();
+    if (path.empty())
+        return;
+
+    try
+    {
+        PhaseProfiler::GetInstance().Write(path, tool);
+        util::Log() << "Wrote the phase report to " << path.string();
+    }
+    catch (const std::exception &e)
+    {
+        util::Log(logERROR) << e.what();
+    }
+}
+}
+}
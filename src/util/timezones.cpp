@@ -4,6 +4,7 @@
 #include "util/log.hpp"
 
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
 #include <boost/scope_exit.hpp>
@@ -11,22 +12,105 @@
 #include "rapidjson/document.h"
 #include "rapidjson/istreamwrapper.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <regex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 #include <time.h>
 
 // Function loads time zone shape polygons, computes a zone local time for utc_time,
-// creates a lookup R-tree and returns a lambda function that maps a point
+// creates a lookup grid and returns a lambda function that maps a point
 // to the corresponding local time
 namespace osrm
 {
 namespace updater
 {
 
-Timezoner::Timezoner(const char geojson[], std::time_t utc_time_now)
+constexpr double Timezoner::DEFAULT_CELL_SIZE;
+constexpr std::uint32_t Timezoner::INSIDE_ZONE;
+
+namespace
+{
+const char TIMEZONE_INDEX_MAGIC[8] = {'O', 'S', 'R', 'M', 'T', 'Z', 'I', 0};
+
+struct TimezoneIndexHeader
+{
+    static constexpr std::uint32_t VERSION = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t columns;
+    std::uint32_t rows;
+    std::uint32_t num_polygons;
+    double min_lon;
+    double min_lat;
+    double cell_size;
+};
+
+// cells of the grid that are not inside of a zone and touch no polygon
+const std::uint32_t EMPTY_CELL = 0;
+
+// margin around polygon segments so segments on the edge of a cell touch both neighbours
+const constexpr double CELL_EPSILON = 1e-9;
+
+// Returns the local time in the time zone of every name
+// Thread safety: MT-Unsafe const:env
+std::vector<struct tm> getLocalTimes(const std::vector<std::string> &tz_names,
+                                     const std::time_t utc_time)
+{
+    std::unordered_map<std::string, struct tm> local_time_memo;
+    std::vector<struct tm> local_times;
+    local_times.reserve(tz_names.size());
+    for (const auto &tzname : tz_names)
+    {
+        auto it = local_time_memo.find(tzname);
+        if (it == local_time_memo.end())
+        {
+            struct tm timeinfo;
+#if defined(_WIN32)
+            _putenv_s("TZ", tzname.c_str());
+            _tzset();
+            localtime_s(&timeinfo, &utc_time);
+#else
+            setenv("TZ", tzname.c_str(), 1);
+            tzset();
+            localtime_r(&utc_time, &timeinfo);
+#endif
+            it = local_time_memo.insert({tzname, timeinfo}).first;
+        }
+        local_times.push_back(it->second);
+    }
+    return local_times;
+}
+
+template <typename T> void writeVector(std::ostream &stream, const std::vector<T> &data)
+{
+    const std::uint64_t count = data.size();
+    stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    stream.write(reinterpret_cast<const char *>(data.data()), count * sizeof(T));
+}
+
+template <typename T>
+void readVector(std::istream &stream, const std::uint64_t file_size, std::vector<T> &data)
+{
+    std::uint64_t count = 0;
+    stream.read(reinterpret_cast<char *>(&count), sizeof(count));
+    if (!stream || count > file_size / sizeof(T))
+    {
+        throw util::exception("Time zone index is truncated");
+    }
+    data.resize(count);
+    stream.read(reinterpret_cast<char *>(data.data()), count * sizeof(T));
+}
+}
+
+Timezoner::Timezoner(const char geojson[], std::time_t utc_time_now, const double cell_size)
 {
     util::Log() << "Time zone validation based on UTC time : " << utc_time_now;
     rapidjson::Document doc;
@@ -39,10 +123,13 @@ Timezoner::Timezoner(const char geojson[], std::time_t utc_time_now)
                                     std::to_string(code) + " malformed at offset " +
                                     std::to_string(offset));
     }
-    LoadLocalTimesRTree(doc, utc_time_now);
+    LoadLocalTimes(doc, utc_time_now);
+    BuildGrid(cell_size);
 }
 
-Timezoner::Timezoner(const boost::filesystem::path &tz_shapes_filename, std::time_t utc_time_now)
+Timezoner::Timezoner(const boost::filesystem::path &tz_shapes_filename,
+                     std::time_t utc_time_now,
+                     const double cell_size)
 {
     util::Log() << "Time zone validation based on UTC time : " << utc_time_now;
 
@@ -52,6 +139,13 @@ Timezoner::Timezoner(const boost::filesystem::path &tz_shapes_filename, std::tim
     if (!file.is_open())
         throw osrm::util::exception("failed to open " + tz_shapes_filename.string());
 
+    // an index brings its own grid
+    if (isTimezoneIndexFile(tz_shapes_filename))
+    {
+        LoadIndex(tz_shapes_filename, utc_time_now);
+        return;
+    }
+
     util::Log() << "Parsing " + tz_shapes_filename.string();
     rapidjson::IStreamWrapper isw(file);
     rapidjson::Document geojson;
@@ -64,10 +158,11 @@ Timezoner::Timezoner(const boost::filesystem::path &tz_shapes_filename, std::tim
                                     " with error " + std::to_string(error_code) +
                                     ". JSON malformed at " + std::to_string(error_offset));
     }
-    LoadLocalTimesRTree(geojson, utc_time_now);
+    LoadLocalTimes(geojson, utc_time_now);
+    BuildGrid(cell_size);
 }
 
-void Timezoner::LoadLocalTimesRTree(rapidjson::Document &geojson, std::time_t utc_time)
+void Timezoner::LoadLocalTimes(rapidjson::Document &geojson, std::time_t utc_time)
 {
     if (!geojson.HasMember("type"))
         throw osrm::util::exception("Failed to parse time zone file. Missing type member.");
@@ -80,41 +175,20 @@ void Timezoner::LoadLocalTimesRTree(rapidjson::Document &geojson, std::time_t ut
     if (!geojson.HasMember("features"))
         throw osrm::util::exception("Failed to parse time zone file. Missing features list.");
 
-    // Lambda function that returns local time in the tzname time zone
-    // Thread safety: MT-Unsafe const:env
-    std::unordered_map<std::string, struct tm> local_time_memo;
-    auto get_local_time_in_tz = [utc_time, &local_time_memo](const char *tzname) {
-        auto it = local_time_memo.find(tzname);
-        if (it == local_time_memo.end())
-        {
-            struct tm timeinfo;
-#if defined(_WIN32)
-            _putenv_s("TZ", tzname);
-            _tzset();
-            localtime_s(&timeinfo, &utc_time);
-#else
-            setenv("TZ", tzname, 1);
-            tzset();
-            localtime_r(&utc_time, &timeinfo);
-#endif
-            it = local_time_memo.insert({tzname, timeinfo}).first;
-        }
-
-        return it->second;
-    };
     BOOST_ASSERT(geojson["features"].IsArray());
     const auto &features_array = geojson["features"].GetArray();
-    std::vector<rtree_t::value_type> polygons;
+    std::vector<polygon_t> polygons;
     for (rapidjson::SizeType i = 0; i < features_array.Size(); i++)
     {
         util::validateFeature(features_array[i]);
         // time zone geojson specific checks
-        if (!features_array[i]["properties"].GetObject().HasMember("TZID") &&
-            !features_array[i]["properties"].GetObject().HasMember("tzid"))
+        const auto &properties = features_array[i]["properties"].GetObject();
+        const char *tzid_member = properties.HasMember("tzid") ? "tzid" : "TZID";
+        if (!properties.HasMember(tzid_member))
         {
             throw osrm::util::exception("Feature is missing TZID member in properties.");
         }
-        else if (!features_array[i]["properties"].GetObject()["tzid"].IsString())
+        else if (!properties[tzid_member].IsString())
         {
             throw osrm::util::exception("Feature has non-string TZID value.");
         }
@@ -138,35 +212,356 @@ void Timezoner::LoadLocalTimesRTree(rapidjson::Document &geojson, std::time_t ut
                 const auto &coords = coords_outer_array[i].GetArray();
                 polygon.outer().emplace_back(coords[0].GetDouble(), coords[1].GetDouble());
             }
-            polygons.emplace_back(boost::geometry::return_envelope<box_t>(polygon),
-                                  local_times.size());
-
-            // Get time zone name and emplace polygon and local time for the UTC input
-            const auto &tzname =
-                features_array[i].GetObject()["properties"].GetObject()["tzid"].GetString();
-            local_times.push_back(local_time_t{polygon, get_local_time_in_tz(tzname)});
+            polygons.push_back(std::move(polygon));
+            tz_names.push_back(properties[tzid_member].GetString());
         }
         else
         {
             util::Log(logDEBUG) << "Skipping non-polygon shape in timezone file";
         }
     }
-    util::Log() << "Parsed " << polygons.size() << "time zone polygons." << std::endl;
-    // Create R-tree for collected shape polygons
-    rtree = rtree_t(polygons);
+    util::Log() << "Parsed " << polygons.size() << " time zone polygons." << std::endl;
+
+    // Emplace polygon and local time for the UTC input
+    auto zone_times = getLocalTimes(tz_names, utc_time);
+    for (std::size_t index = 0; index < polygons.size(); ++index)
+    {
+        local_times.push_back(local_time_t{std::move(polygons[index]), zone_times[index]});
+    }
+}
+
+void Timezoner::BuildGrid(const double cell_size_)
+{
+    if (!(cell_size_ > 0.))
+        throw osrm::util::exception("Time zone grid cell size must be positive");
+    if (local_times.size() >= INSIDE_ZONE)
+        throw osrm::util::exception("Too many time zone polygons");
+
+    cell_size = cell_size_;
+    cells.clear();
+    boundary_offsets.assign({0, 0});
+    boundary_polygons.clear();
+
+    // The spherical envelopes of the segments also cover the arcs of the great circles bulging
+    // beyond their end points, cells outside of them can't be crossed by the zone boundary. Long
+    // segments are split into pieces of half a cell so their envelopes only cover a few cells.
+    using segment_t = boost::geometry::model::segment<point_t>;
+    using linestring_t = boost::geometry::model::linestring<point_t>;
+    const auto max_piece_length = cell_size * M_PI / 180. / 2.;
+    std::vector<std::vector<box_t>> segment_boxes(local_times.size());
+    double max_lon = std::numeric_limits<double>::lowest();
+    double max_lat = std::numeric_limits<double>::lowest();
+    min_lon = std::numeric_limits<double>::max();
+    min_lat = std::numeric_limits<double>::max();
+    for (std::size_t index = 0; index < local_times.size(); ++index)
+    {
+        const auto &ring = local_times[index].first.outer();
+        linestring_t outline(ring.begin(), ring.end());
+        if (!ring.empty())
+            outline.push_back(ring.front());
+        linestring_t pieces;
+        boost::geometry::densify(outline, pieces, max_piece_length);
+        for (std::size_t point = 0; point + 1 < pieces.size(); ++point)
+        {
+            const segment_t segment{pieces[point], pieces[point + 1]};
+            const auto box = boost::geometry::return_envelope<box_t>(segment);
+            min_lon = std::min(min_lon, box.min_corner().get<0>());
+            min_lat = std::min(min_lat, box.min_corner().get<1>());
+            max_lon = std::max(max_lon, box.max_corner().get<0>());
+            max_lat = std::max(max_lat, box.max_corner().get<1>());
+            segment_boxes[index].push_back(box);
+        }
+    }
+    if (min_lon > max_lon)
+    {
+        columns = rows = 0;
+        return;
+    }
+    min_lon = std::max(min_lon, -180.);
+    min_lat = std::max(min_lat, -90.);
+    max_lon = std::min(max_lon, 180.);
+    max_lat = std::min(max_lat, 90.);
+
+    const auto num_columns = std::floor((max_lon - min_lon) / cell_size) + 1;
+    const auto num_rows = std::floor((max_lat - min_lat) / cell_size) + 1;
+    if (num_columns * num_rows >= INSIDE_ZONE)
+        throw osrm::util::exception("Time zone grid cell size " + std::to_string(cell_size) +
+                                    " is too small for the bounds of the zones");
+    columns = num_columns;
+    rows = num_rows;
+
+    const auto toColumn = [this](const double lon) {
+        const auto column = std::floor((lon - min_lon) / cell_size);
+        return static_cast<std::uint32_t>(std::max(0., std::min(column, columns - 1.)));
+    };
+    const auto toRow = [this](const double lat) {
+        const auto row = std::floor((lat - min_lat) / cell_size);
+        return static_cast<std::uint32_t>(std::max(0., std::min(row, rows - 1.)));
+    };
+    using boost::geometry::get;
+    using boost::geometry::min_corner;
+    using boost::geometry::max_corner;
+    const auto firstColumn = [&](const box_t &box) {
+        return toColumn(get<min_corner, 0>(box) - CELL_EPSILON);
+    };
+    const auto lastColumn = [&](const box_t &box) {
+        return toColumn(get<max_corner, 0>(box) + CELL_EPSILON);
+    };
+    const auto firstRow = [&](const box_t &box) {
+        return toRow(get<min_corner, 1>(box) - CELL_EPSILON);
+    };
+    const auto lastRow = [&](const box_t &box) {
+        return toRow(get<max_corner, 1>(box) + CELL_EPSILON);
+    };
+
+    const std::uint32_t NO_POLYGON = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> inside_polygon(columns * rows, NO_POLYGON);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> boundary_cells;
+    for (std::uint32_t index = 0; index < local_times.size(); ++index)
+    {
+        const auto &polygon = local_times[index].first;
+        if (segment_boxes[index].empty())
+            continue;
+
+        // the window of the grid around the polygon
+        std::uint32_t first_column = columns, last_column = 0, first_row = rows, last_row = 0;
+        for (const auto &box : segment_boxes[index])
+        {
+            first_column = std::min(first_column, firstColumn(box));
+            last_column = std::max(last_column, lastColumn(box));
+            first_row = std::min(first_row, firstRow(box));
+            last_row = std::max(last_row, lastRow(box));
+        }
+        const auto width = last_column - first_column + 1;
+
+        std::vector<bool> touched(width * (last_row - first_row + 1), false);
+        for (const auto &box : segment_boxes[index])
+        {
+            for (auto row = firstRow(box); row <= lastRow(box); ++row)
+            {
+                for (auto column = firstColumn(box); column <= lastColumn(box); ++column)
+                {
+                    touched[(row - first_row) * width + column - first_column] = true;
+                }
+            }
+        }
+
+        // Neighbouring cells in a row that the boundary does not touch are all inside or all
+        // outside of the polygon, one point test per run of them is enough
+        for (auto row = first_row; row <= last_row; ++row)
+        {
+            boost::optional<bool> run_inside;
+            for (auto column = first_column; column <= last_column; ++column)
+            {
+                const auto cell = row * columns + column;
+                if (touched[(row - first_row) * width + column - first_column])
+                {
+                    boundary_cells.emplace_back(cell, index);
+                    run_inside = boost::none;
+                    continue;
+                }
+                if (!run_inside)
+                {
+                    const point_t center{std::min(min_lon + (column + 0.5) * cell_size, 180.),
+                                         std::min(min_lat + (row + 0.5) * cell_size, 90.)};
+                    run_inside = boost::geometry::within(center, polygon);
+                }
+                if (*run_inside && inside_polygon[cell] == NO_POLYGON)
+                {
+                    inside_polygon[cell] = index;
+                }
+            }
+        }
+    }
+
+    std::sort(boundary_cells.begin(), boundary_cells.end());
+    cells.resize(inside_polygon.size(), EMPTY_CELL);
+    auto boundary_cell = boundary_cells.begin();
+    for (std::uint32_t cell = 0; cell < cells.size(); ++cell)
+    {
+        const auto end =
+            std::find_if(boundary_cell, boundary_cells.end(), [cell](const auto &entry) {
+                return entry.first != cell;
+            });
+        if (inside_polygon[cell] != NO_POLYGON)
+        {
+            cells[cell] = INSIDE_ZONE | inside_polygon[cell];
+        }
+        else if (boundary_cell != end)
+        {
+            cells[cell] = boundary_offsets.size() - 1;
+            std::transform(boundary_cell,
+                           end,
+                           std::back_inserter(boundary_polygons),
+                           [](const auto &entry) { return entry.second; });
+            boundary_offsets.push_back(boundary_polygons.size());
+        }
+        boundary_cell = end;
+    }
+
+    util::Log() << "Built a " << columns << "x" << rows << " time zone grid with "
+                << GetNumberOfBoundaryCells() << " boundary cells";
+}
+
+std::size_t Timezoner::GetNumberOfBoundaryCells() const
+{
+    return boundary_offsets.size() < 2 ? 0 : boundary_offsets.size() - 2;
+}
+
+boost::optional<std::size_t> Timezoner::GetCell(const point_t &point) const
+{
+    const auto column = std::floor((boost::geometry::get<0>(point) - min_lon) / cell_size);
+    const auto row = std::floor((boost::geometry::get<1>(point) - min_lat) / cell_size);
+    if (!(column >= 0. && column < columns && row >= 0. && row < rows))
+        return boost::none;
+    return static_cast<std::size_t>(row) * columns + static_cast<std::size_t>(column);
 }
 
 boost::optional<struct tm> Timezoner::operator()(const point_t &point) const
 {
-    std::vector<rtree_t::value_type> result;
-    rtree.query(boost::geometry::index::intersects(point), std::back_inserter(result));
-    for (const auto v : result)
+    const auto cell = GetCell(point);
+    if (!cell)
+        return boost::none;
+
+    const auto value = cells[*cell];
+    if (value & INSIDE_ZONE)
+        return local_times[value & ~INSIDE_ZONE].second;
+
+    for (auto offset = boundary_offsets[value]; offset < boundary_offsets[value + 1]; ++offset)
     {
-        const auto index = v.second;
+        const auto index = boundary_polygons[offset];
         if (boost::geometry::within(point, local_times[index].first))
             return local_times[index].second;
     }
     return boost::none;
 }
+
+void Timezoner::Write(const boost::filesystem::path &index_filename) const
+{
+    TimezoneIndexHeader header;
+    std::memcpy(header.magic, TIMEZONE_INDEX_MAGIC, sizeof(header.magic));
+    header.version = TimezoneIndexHeader::VERSION;
+    header.columns = columns;
+    header.rows = rows;
+    header.num_polygons = local_times.size();
+    header.min_lon = min_lon;
+    header.min_lat = min_lat;
+    header.cell_size = cell_size;
+
+    boost::filesystem::ofstream file(index_filename, std::ios::binary);
+    if (!file.is_open())
+        throw osrm::util::exception("failed to open " + index_filename.string());
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    // the names as one block of null terminated strings
+    std::vector<char> names;
+    for (const auto &name : tz_names)
+    {
+        names.insert(names.end(), name.begin(), name.end());
+        names.push_back('\0');
+    }
+    writeVector(file, names);
+
+    std::vector<std::uint64_t> ring_offsets{0};
+    std::vector<double> coordinates;
+    for (const auto &local_time : local_times)
+    {
+        for (const auto &point : local_time.first.outer())
+        {
+            coordinates.push_back(boost::geometry::get<0>(point));
+            coordinates.push_back(boost::geometry::get<1>(point));
+        }
+        ring_offsets.push_back(coordinates.size() / 2);
+    }
+    writeVector(file, ring_offsets);
+    writeVector(file, coordinates);
+
+    writeVector(file, cells);
+    writeVector(file, boundary_offsets);
+    writeVector(file, boundary_polygons);
+
+    if (!file)
+        throw osrm::util::exception("failed to write " + index_filename.string());
+}
+
+void Timezoner::LoadIndex(const boost::filesystem::path &index_filename, std::time_t utc_time)
+{
+    util::Log() << "Loading time zone index " + index_filename.string();
+    const auto file_size = boost::filesystem::file_size(index_filename);
+    boost::filesystem::ifstream file(index_filename, std::ios::binary);
+
+    TimezoneIndexHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, TIMEZONE_INDEX_MAGIC, sizeof(header.magic)) != 0)
+        throw osrm::util::exception(index_filename.string() + " is no time zone index");
+    if (header.version != TimezoneIndexHeader::VERSION)
+        throw osrm::util::exception(index_filename.string() + " has version " +
+                                    std::to_string(header.version) +
+                                    " of the time zone index format, expected " +
+                                    std::to_string(TimezoneIndexHeader::VERSION));
+
+    std::vector<char> names;
+    std::vector<std::uint64_t> ring_offsets;
+    std::vector<double> coordinates;
+    readVector(file, file_size, names);
+    readVector(file, file_size, ring_offsets);
+    readVector(file, file_size, coordinates);
+    readVector(file, file_size, cells);
+    readVector(file, file_size, boundary_offsets);
+    readVector(file, file_size, boundary_polygons);
+    if (!file)
+        throw osrm::util::exception(index_filename.string() + " is truncated");
+
+    for (auto name = names.begin(); name != names.end();)
+    {
+        const auto end = std::find(name, names.end(), '\0');
+        tz_names.emplace_back(name, end);
+        name = end == names.end() ? end : std::next(end);
+    }
+
+    const auto consistent =
+        tz_names.size() == header.num_polygons && ring_offsets.size() == header.num_polygons + 1 &&
+        std::is_sorted(ring_offsets.begin(), ring_offsets.end()) &&
+        ring_offsets.back() * 2 == coordinates.size() &&
+        cells.size() == std::uint64_t{header.columns} * header.rows &&
+        !boundary_offsets.empty() && boundary_offsets.back() == boundary_polygons.size() &&
+        std::all_of(cells.begin(),
+                    cells.end(),
+                    [&](const auto value) {
+                        return (value & INSIDE_ZONE) ? (value & ~INSIDE_ZONE) < header.num_polygons
+                                                     : value + 1 < boundary_offsets.size();
+                    }) &&
+        std::all_of(boundary_polygons.begin(), boundary_polygons.end(), [&](const auto index) {
+            return index < header.num_polygons;
+        });
+    if (!consistent)
+        throw osrm::util::exception(index_filename.string() + " is corrupted");
+
+    columns = header.columns;
+    rows = header.rows;
+    min_lon = header.min_lon;
+    min_lat = header.min_lat;
+    cell_size = header.cell_size;
+
+    auto zone_times = getLocalTimes(tz_names, utc_time);
+    for (std::size_t index = 0; index < tz_names.size(); ++index)
+    {
+        polygon_t polygon;
+        for (auto point = ring_offsets[index]; point < ring_offsets[index + 1]; ++point)
+        {
+            polygon.outer().emplace_back(coordinates[2 * point], coordinates[2 * point + 1]);
+        }
+        local_times.push_back(local_time_t{std::move(polygon), zone_times[index]});
+    }
+    util::Log() << "Loaded " << local_times.size() << " time zone polygons.";
+}
+
+bool isTimezoneIndexFile(const boost::filesystem::path &path)
+{
+    char magic[sizeof(TIMEZONE_INDEX_MAGIC)];
+    boost::filesystem::ifstream file(path, std::ios::binary);
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, TIMEZONE_INDEX_MAGIC, sizeof(magic)) == 0;
+}
 }
 }
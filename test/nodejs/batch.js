@@ -0,0 +1,106 @@
+var OSRM = require('../../');
+var test = require('tape');
+var data_path = require('./constants').data_path;
+var three_test_coordinates = require('./constants').three_test_coordinates;
+var two_test_coordinates = require('./constants').two_test_coordinates;
+
+
+test('batch: runs queries of different services in Monaco', function(assert) {
+    assert.plan(7);
+    var osrm = new OSRM(data_path);
+    var queries = [
+        {service: 'route', params: {coordinates: two_test_coordinates}},
+        {service: 'table', params: {coordinates: three_test_coordinates}},
+        {service: 'nearest', params: {coordinates: [two_test_coordinates[0]]}}
+    ];
+    osrm.batch(queries, function(err, results) {
+        assert.ifError(err);
+        assert.equal(results.length, 3);
+        assert.ok(results[0].routes.length);
+        assert.equal(results[1].durations.length, 3);
+        assert.ok(results[2].waypoints.length);
+        assert.notOk(results[0].code, 'code is stripped like for single queries');
+        assert.ok(Array.isArray(results[1].sources));
+    });
+});
+
+test('batch: a failing query does not fail the batch', function(assert) {
+    assert.plan(4);
+    var osrm = new OSRM(data_path);
+    var queries = [
+        {service: 'trip', params: {coordinates: two_test_coordinates, source: 'first', roundtrip: false}},
+        {service: 'route', params: {coordinates: two_test_coordinates}}
+    ];
+    osrm.batch(queries, function(err, results) {
+        assert.ifError(err);
+        assert.ok(results[0] instanceof Error);
+        assert.equal(results[0].message, 'NotImplemented');
+        assert.ok(results[1].routes.length);
+    });
+});
+
+test('batch: returns json buffers', function(assert) {
+    assert.plan(3);
+    var osrm = new OSRM(data_path);
+    var queries = [{service: 'route', params: {coordinates: two_test_coordinates}}];
+    osrm.batch(queries, {format: 'json_buffer'}, function(err, results) {
+        assert.ifError(err);
+        assert.ok(Buffer.isBuffer(results[0]));
+        assert.ok(JSON.parse(results[0].toString()).routes.length);
+    });
+});
+
+test('batch: throws on invalid queries', function(assert) {
+    assert.plan(5);
+    var osrm = new OSRM(data_path);
+    assert.throws(function() { osrm.batch([]); },
+        /Two arguments required/);
+    assert.throws(function() { osrm.batch({}, function() {}); },
+        /First arg must be an array of queries/);
+    assert.throws(function() { osrm.batch([{service: 'tile', params: [0, 0, 0]}], function() {}); },
+        /must be one of/);
+    assert.throws(function() { osrm.batch([{service: 'route'}], function() {}); },
+        /First arg must be an object/);
+    assert.throws(function() { osrm.batch([{service: 'route', params: {coordinates: two_test_coordinates}}]); },
+        /last argument must be a callback function/);
+});
+
+test('matchBatch: matches every trace like match does', function(assert) {
+    assert.plan(6);
+    var osrm = new OSRM(data_path);
+    var traces = [
+        {coordinates: three_test_coordinates, timestamps: [1424684612, 1424684616, 1424684620]},
+        {coordinates: two_test_coordinates}
+    ];
+    osrm.matchBatch(traces, function(err, results) {
+        assert.ifError(err);
+        assert.equal(results.length, 2);
+        assert.equal(results[0].matchings.length, 1);
+        assert.notOk(results[0].code, 'code is stripped like for single queries');
+        osrm.match(traces[1], function(err, single) {
+            assert.ifError(err);
+            assert.deepEqual(results[1], single);
+        });
+    });
+});
+
+test('matchBatch: returns json buffers', function(assert) {
+    assert.plan(3);
+    var osrm = new OSRM(data_path);
+    osrm.matchBatch([{coordinates: two_test_coordinates}], {format: 'json_buffer'}, function(err, results) {
+        assert.ifError(err);
+        assert.ok(Buffer.isBuffer(results[0]));
+        assert.ok(JSON.parse(results[0].toString()).matchings.length);
+    });
+});
+
+test('matchBatch: throws on invalid traces', function(assert) {
+    assert.plan(3);
+    var osrm = new OSRM(data_path);
+    assert.throws(function() { osrm.matchBatch([]); },
+        /Two arguments required/);
+    assert.throws(function() { osrm.matchBatch({}, function() {}); },
+        /First arg must be an array of traces/);
+    assert.throws(function() { osrm.matchBatch([{coordinates: [two_test_coordinates[0]]}], function() {}); },
+        /At least two coordinates must be provided/);
+});
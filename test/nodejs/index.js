@@ -129,9 +129,30 @@ test('constructor: throws on invalid custom limits', function(assert) {
     });
 });
 
+test('constructor: runs queries on a pool of its own threads', function(assert) {
+    assert.plan(3);
+    var osrm = new OSRM({path: monaco_path, threads: 2});
+    osrm.route({coordinates: [[7.41337, 43.72956], [7.41546, 43.73077]]}, function(err, route) {
+        assert.ifError(err);
+        assert.ok(route.routes.length);
+    });
+    osrm.nearest({coordinates: [[7.41337, 43.72956]]}, function(err, nearest) {
+        assert.ifError(err);
+    });
+});
+
+test('constructor: throws on an invalid thread count', function(assert) {
+    assert.plan(2);
+    assert.throws(function() { new OSRM({path: monaco_path, threads: -1}); },
+        /threads must be a non-negative integral number/);
+    assert.throws(function() { new OSRM({path: monaco_path, threads: 'many'}); },
+        /threads must be a non-negative integral number/);
+});
+
 require('./route.js');
 require('./trip.js');
 require('./match.js');
 require('./tile.js');
 require('./table.js');
 require('./nearest.js');
+require('./batch.js');
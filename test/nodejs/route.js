@@ -576,3 +576,18 @@ test('route:  in Monaco with custom limits on MLD', function(assert) {
     });
 });
 
+
+test('route: routes Monaco with a json_buffer result', function(assert) {
+    assert.plan(6);
+    var osrm = new OSRM(monaco_path);
+    osrm.route({coordinates: two_test_coordinates}, {format: 'json_buffer'}, function(err, result) {
+        assert.ifError(err);
+        assert.ok(Buffer.isBuffer(result), 'result must be a buffer');
+        var route = JSON.parse(result.toString());
+        assert.ok(route.waypoints);
+        assert.ok(route.routes);
+        assert.ok(route.routes[0].geometry);
+        assert.throws(function() { osrm.route({coordinates: two_test_coordinates}, {format: 'xml'}, function() {}); },
+            /format/);
+    });
+});
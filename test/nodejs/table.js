@@ -166,3 +166,47 @@ test('table: distance table in Monaco without hints', function(assert) {
         table.destinations.map(assertHasNoHints);
     });
 });
+
+test('table: binary output format', function(assert) {
+    assert.plan(6);
+    var osrm = new OSRM(data_path);
+    var options = {
+        coordinates: [three_test_coordinates[0], three_test_coordinates[1]],
+        output_format: 'binary'
+    };
+    osrm.table(options, function(err, table) {
+        assert.ifError(err);
+        assert.ok(Buffer.isBuffer(table), 'result must be a buffer');
+        assert.equal(table.toString('ascii', 0, 4), 'OSRM');
+        assert.equal(table.readUInt32LE(4), 1, 'format version');
+        // the root slot holds an object
+        assert.equal(table.readUInt32LE(8), 6);
+        assert.throws(function() { osrm.table({coordinates: options.coordinates, output_format: 'xml'}, function() {}); },
+            /output_format/);
+    });
+});
+
+test('table: typed output format', function(assert) {
+    assert.plan(10);
+    var osrm = new OSRM(data_path);
+    var options = {
+        coordinates: [three_test_coordinates[0], three_test_coordinates[1], three_test_coordinates[2]],
+        sources: [0, 1],
+        annotations: ['duration', 'distance']
+    };
+    osrm.table(options, function(err, expected) {
+        assert.ifError(err);
+        osrm.table(options, {format: 'typed'}, function(err, table) {
+            assert.ifError(err);
+            assert.ok(table.durations instanceof Float64Array, 'durations must be a Float64Array');
+            assert.ok(table.distances instanceof Float64Array, 'distances must be a Float64Array');
+            assert.equal(table.rows, 2);
+            assert.equal(table.columns, 3);
+            assert.deepEqual(Array.from(table.durations.subarray(3, 6)), expected.durations[1]);
+            assert.deepEqual(Array.from(table.distances.subarray(3, 6)), expected.distances[1]);
+            assert.equal(table.sources.length, 2);
+        });
+    });
+    assert.throws(function() { osrm.route({coordinates: two_test_coordinates}, {format: 'typed'}, function() {}); },
+        /format/);
+});
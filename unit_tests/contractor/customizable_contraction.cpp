@@ -0,0 +1,232 @@
+#include "contractor/customizable_contraction.hpp"
+
+#include "util/integer_range.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+BOOST_AUTO_TEST_SUITE(customizable_contraction)
+
+namespace
+{
+// 4x4 grid with bidirectional edges, node row * 4 + column and a turn id per edge
+//
+//  0 -  1 -  2 -  3
+//  |    |    |    |
+//  4 -  5 -  6 -  7
+//  |    |    |    |
+//  8 -  9 - 10 - 11
+//  |    |    |    |
+// 12 - 13 - 14 - 15
+std::vector<extractor::EdgeBasedEdge> makeGrid()
+{
+    std::vector<extractor::EdgeBasedEdge> edges;
+    NodeID turn_id = 0;
+    const auto add = [&](const NodeID from, const NodeID to, const bool backward) {
+        const EdgeWeight weight = 1 + (from * 7 + to * 3) % 5;
+        edges.emplace_back(from, to, turn_id++, weight, weight * 10., weight * 2, true, backward);
+    };
+    for (const auto row : util::irange<NodeID>(0, 4))
+    {
+        for (const auto column : util::irange<NodeID>(0, 4))
+        {
+            const auto node = row * 4 + column;
+            if (column < 3)
+                add(node, node + 1, true);
+            if (row < 3)
+                add(node, node + 4, node != 5);
+        }
+    }
+    // one way shortcut from the top left to the bottom right corner
+    add(15, 0, false);
+    return edges;
+}
+
+// cells of 2x2 nodes on the first level, the left and right half on the second
+partition::MultiLevelPartition makePartition()
+{
+    std::vector<CellID> l1(16), l2(16);
+    for (const auto node : util::irange<NodeID>(0, 16))
+    {
+        l1[node] = (node / 8) * 2 + (node % 4) / 2;
+        l2[node] = (node % 4) / 2;
+    }
+    return partition::MultiLevelPartition{{l1, l2}, {4, 2}};
+}
+
+std::vector<EdgeWeight> dijkstra(const std::vector<extractor::EdgeBasedEdge> &edges,
+                                 const NodeID source)
+{
+    std::vector<EdgeWeight> weights(16, INVALID_EDGE_WEIGHT);
+    weights[source] = 0;
+    // Bellman-Ford is enough for the grid
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (const auto &edge : edges)
+        {
+            const auto relax = [&](const NodeID from, const NodeID to) {
+                if (weights[from] != INVALID_EDGE_WEIGHT &&
+                    weights[from] + edge.data.weight < weights[to])
+                {
+                    weights[to] = weights[from] + edge.data.weight;
+                    changed = true;
+                }
+            };
+            if (edge.data.forward)
+                relax(edge.source, edge.target);
+            if (edge.data.backward)
+                relax(edge.target, edge.source);
+        }
+    }
+    return weights;
+}
+
+// Upward search from the source and downward search to the target, in rank order since all
+// edges lead to higher ranks
+EdgeWeight
+upDownSearch(const CCHTopology &topology, const std::vector<QueryEdge> &edges, NodeID s, NodeID t)
+{
+    std::vector<EdgeWeight> forward(16, INVALID_EDGE_WEIGHT), backward(16, INVALID_EDGE_WEIGHT);
+    forward[s] = 0;
+    backward[t] = 0;
+    for (const auto node : topology.rank_to_node)
+    {
+        for (const auto &edge : edges)
+        {
+            if (edge.source != node)
+                continue;
+            if (edge.data.forward && forward[node] != INVALID_EDGE_WEIGHT)
+                forward[edge.target] =
+                    std::min(forward[edge.target], forward[node] + edge.data.weight);
+            if (edge.data.backward && backward[node] != INVALID_EDGE_WEIGHT)
+                backward[edge.target] =
+                    std::min(backward[edge.target], backward[node] + edge.data.weight);
+        }
+    }
+    EdgeWeight weight = INVALID_EDGE_WEIGHT;
+    for (const auto node : util::irange<NodeID>(0, 16))
+    {
+        if (forward[node] != INVALID_EDGE_WEIGHT && backward[node] != INVALID_EDGE_WEIGHT)
+            weight = std::min(weight, forward[node] + backward[node]);
+    }
+    return weight;
+}
+}
+
+BOOST_AUTO_TEST_CASE(nested_dissection_order)
+{
+    const auto edges = makeGrid();
+    const auto node_to_rank = computeNestedDissectionOrder(makePartition(), edges, 16);
+
+    std::vector<NodeID> ranks = node_to_rank;
+    std::sort(ranks.begin(), ranks.end());
+    for (const auto rank : util::irange<NodeID>(0, 16))
+        BOOST_CHECK_EQUAL(ranks[rank], rank);
+
+    // nodes without a cut edge come first
+    for (const auto node : {2, 3, 8, 10, 11, 12, 14, 15})
+        BOOST_CHECK_LT(node_to_rank[node], 8);
+    // the separator between the cells of the first level, the nodes in the cell with lower id
+    for (const auto node : {4, 6, 7})
+    {
+        BOOST_CHECK_GE(node_to_rank[node], 8);
+        BOOST_CHECK_LT(node_to_rank[node], 11);
+    }
+    // the separator between the halves comes last, 0 is the end of the one way edge from 15
+    for (const auto node : {0, 1, 5, 9, 13})
+        BOOST_CHECK_GE(node_to_rank[node], 11);
+}
+
+BOOST_AUTO_TEST_CASE(customize_shortest_paths)
+{
+    const auto edges = makeGrid();
+    const auto topology =
+        contractTopology(computeNestedDissectionOrder(makePartition(), edges, 16), edges);
+    BOOST_CHECK_EQUAL(topology.GetNumberOfNodes(), 16);
+    BOOST_CHECK_EQUAL(topology.first_arc.size(), 17);
+    for (const auto rank : util::irange<NodeID>(0, 16))
+    {
+        BOOST_CHECK(std::is_sorted(topology.arc_head.begin() + topology.first_arc[rank],
+                                   topology.arc_head.begin() + topology.first_arc[rank + 1]));
+        for (const auto arc : util::irange(topology.first_arc[rank], topology.first_arc[rank + 1]))
+            BOOST_CHECK_GT(topology.arc_head[arc], rank);
+    }
+
+    const auto customized = customizeTopology(topology, edges);
+    const std::vector<QueryEdge> query_edges(customized.begin(), customized.end());
+
+    for (const auto &edge : query_edges)
+    {
+        BOOST_CHECK_LT(topology.node_to_rank[edge.source], topology.node_to_rank[edge.target]);
+        if (!edge.data.shortcut)
+            continue;
+
+        // both halves of a shortcut exist and add up to its weight
+        const NodeID middle = edge.data.turn_id;
+        const auto from = edge.data.forward ? edge.source : edge.target;
+        const auto to = edge.data.forward ? edge.target : edge.source;
+        EdgeWeight first = INVALID_EDGE_WEIGHT, second = INVALID_EDGE_WEIGHT;
+        for (const auto &half : query_edges)
+        {
+            if (half.source == middle && half.target == from && half.data.backward)
+                first = std::min(first, half.data.weight);
+            if (half.source == middle && half.target == to && half.data.forward)
+                second = std::min(second, half.data.weight);
+        }
+        BOOST_REQUIRE(first != INVALID_EDGE_WEIGHT && second != INVALID_EDGE_WEIGHT);
+        BOOST_CHECK_EQUAL(first + second, edge.data.weight);
+    }
+
+    for (const auto source : util::irange<NodeID>(0, 16))
+    {
+        const auto weights = dijkstra(edges, source);
+        for (const auto target : util::irange<NodeID>(0, 16))
+        {
+            BOOST_CHECK_EQUAL(upDownSearch(topology, query_edges, source, target),
+                              weights[target]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(customize_updated_weights)
+{
+    auto edges = makeGrid();
+    const auto topology =
+        contractTopology(computeNestedDissectionOrder(makePartition(), edges, 16), edges);
+
+    // closing edges keeps the topology, the arcs are only customized again
+    edges[0].data.weight = INVALID_EDGE_WEIGHT;
+    edges[5].data.weight = 100;
+    const auto customized = customizeTopology(topology, edges);
+    const std::vector<QueryEdge> query_edges(customized.begin(), customized.end());
+
+    for (const auto source : util::irange<NodeID>(0, 16))
+    {
+        const auto weights = dijkstra(
+            [&] {
+                auto open_edges = edges;
+                open_edges.erase(std::remove_if(open_edges.begin(),
+                                                open_edges.end(),
+                                                [](const auto &edge) {
+                                                    return edge.data.weight == INVALID_EDGE_WEIGHT;
+                                                }),
+                                 open_edges.end());
+                return open_edges;
+            }(),
+            source);
+        for (const auto target : util::irange<NodeID>(0, 16))
+        {
+            BOOST_CHECK_EQUAL(upDownSearch(topology, query_edges, source, target),
+                              weights[target]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
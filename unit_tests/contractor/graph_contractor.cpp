@@ -0,0 +1,254 @@
+#include "contractor/graph_contractor.hpp"
+#include "contractor/graph_contractor_adaptors.hpp"
+#include "contractor/query_benchmark.hpp"
+#include "extractor/edge_based_edge.hpp"
+
+#include "util/exception.hpp"
+#include "util/integer_range.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+BOOST_AUTO_TEST_SUITE(graph_contractor)
+
+namespace
+{
+constexpr NodeID GRID_SIZE = 6;
+constexpr NodeID NUMBER_OF_NODES = GRID_SIZE * GRID_SIZE;
+
+// Grid with bidirectional edges, the weights change with the offset
+std::vector<extractor::EdgeBasedEdge> makeGrid(const EdgeWeight offset)
+{
+    std::vector<extractor::EdgeBasedEdge> edges;
+    NodeID turn_id = 0;
+    const auto add = [&](const NodeID from, const NodeID to) {
+        const EdgeWeight weight = 1 + (from * 7 + to * 3 + offset) % 5;
+        edges.emplace_back(from, to, turn_id++, weight, weight * 10., weight * 2, true, true);
+    };
+    for (const auto row : util::irange<NodeID>(0, GRID_SIZE))
+    {
+        for (const auto column : util::irange<NodeID>(0, GRID_SIZE))
+        {
+            const auto node = row * GRID_SIZE + column;
+            if (column + 1 < GRID_SIZE)
+                add(node, node + 1);
+            if (row + 1 < GRID_SIZE)
+                add(node, node + GRID_SIZE);
+        }
+    }
+    return edges;
+}
+
+// Bellman-Ford from the source over the edges the direction allows
+template <typename Edges, typename Relax>
+std::vector<EdgeWeight> bellmanFord(const Edges &edges, const NodeID source, Relax relax_edge)
+{
+    std::vector<EdgeWeight> weights(NUMBER_OF_NODES, INVALID_EDGE_WEIGHT);
+    weights[source] = 0;
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (const auto &edge : edges)
+        {
+            relax_edge(edge, [&](const NodeID from, const NodeID to) {
+                if (weights[from] != INVALID_EDGE_WEIGHT &&
+                    weights[from] + edge.data.weight < weights[to])
+                {
+                    weights[to] = weights[from] + edge.data.weight;
+                    changed = true;
+                }
+            });
+        }
+    }
+    return weights;
+}
+
+std::vector<EdgeWeight> dijkstra(const std::vector<extractor::EdgeBasedEdge> &edges,
+                                 const NodeID source)
+{
+    return bellmanFord(edges, source, [](const auto &edge, const auto relax) {
+        relax(edge.source, edge.target);
+        relax(edge.target, edge.source);
+    });
+}
+
+// The hierarchy only stores upward edges, a path meets in its highest node
+EdgeWeight
+upDownSearch(const std::vector<QueryEdge> &edges, const NodeID source, const NodeID target)
+{
+    const auto forward = bellmanFord(edges, source, [](const auto &edge, const auto relax) {
+        if (edge.data.forward)
+            relax(edge.source, edge.target);
+    });
+    const auto backward = bellmanFord(edges, target, [](const auto &edge, const auto relax) {
+        if (edge.data.backward)
+            relax(edge.source, edge.target);
+    });
+    EdgeWeight weight = INVALID_EDGE_WEIGHT;
+    for (const auto node : util::irange<NodeID>(0, NUMBER_OF_NODES))
+    {
+        if (forward[node] != INVALID_EDGE_WEIGHT && backward[node] != INVALID_EDGE_WEIGHT)
+            weight = std::min(weight, forward[node] + backward[node]);
+    }
+    return weight;
+}
+
+std::vector<QueryEdge> contract(const std::vector<extractor::EdgeBasedEdge> &edges,
+                                std::vector<float> &node_levels,
+                                const bool fixed_order)
+{
+    GraphContractor contractor(NUMBER_OF_NODES,
+                               adaptToContractorInput(edges),
+                               node_levels,
+                               std::vector<EdgeWeight>(NUMBER_OF_NODES, 1));
+    contractor.Run(1.0, fixed_order);
+    if (node_levels.empty())
+        node_levels = contractor.GetNodeLevels();
+    const auto contracted = contractor.GetEdges<QueryEdge>();
+    return std::vector<QueryEdge>(contracted.begin(), contracted.end());
+}
+}
+
+BOOST_AUTO_TEST_CASE(fixed_order_shortest_paths)
+{
+    std::vector<float> node_levels;
+    const auto initial = contract(makeGrid(0), node_levels, false);
+    BOOST_REQUIRE_EQUAL(node_levels.size(), NUMBER_OF_NODES);
+
+    // the levels of the first run are kept for the updated weights
+    const auto levels = node_levels;
+    const auto updated_edges = makeGrid(2);
+    const auto updated = contract(updated_edges, node_levels, true);
+    BOOST_CHECK(node_levels == levels);
+
+    for (const auto source : util::irange<NodeID>(0, NUMBER_OF_NODES))
+    {
+        const auto initial_weights = dijkstra(makeGrid(0), source);
+        const auto updated_weights = dijkstra(updated_edges, source);
+        for (const auto target : util::irange<NodeID>(0, NUMBER_OF_NODES))
+        {
+            BOOST_CHECK_EQUAL(upDownSearch(initial, source, target), initial_weights[target]);
+            BOOST_CHECK_EQUAL(upDownSearch(updated, source, target), updated_weights[target]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(witness_search_rounds)
+{
+    GraphContractor contractor(NUMBER_OF_NODES,
+                               adaptToContractorInput(makeGrid(0)),
+                               {},
+                               std::vector<EdgeWeight>(NUMBER_OF_NODES, 1));
+    contractor.Run();
+
+    const auto &round_stats = contractor.GetRoundStats();
+    BOOST_REQUIRE(!round_stats.empty());
+    // the grid is sparse enough for hop limited witness searches
+    BOOST_CHECK_LE(round_stats.front().witness_hop_limit, 2);
+    BOOST_CHECK_EQUAL(round_stats.front().remaining_nodes, NUMBER_OF_NODES);
+
+    NodeID contracted_nodes = 0;
+    for (const auto round : util::irange<std::size_t>(0, round_stats.size()))
+    {
+        const auto &stats = round_stats[round];
+        BOOST_CHECK_GT(stats.contracted_nodes, 0);
+        BOOST_CHECK_GT(stats.witness_searches.searches, 0);
+        contracted_nodes += stats.contracted_nodes;
+        if (round > 0)
+        {
+            BOOST_CHECK_GE(stats.witness_hop_limit, round_stats[round - 1].witness_hop_limit);
+            BOOST_CHECK_EQUAL(stats.remaining_nodes,
+                              round_stats[round - 1].remaining_nodes -
+                                  round_stats[round - 1].contracted_nodes);
+        }
+    }
+    BOOST_CHECK_EQUAL(contracted_nodes + 1, NUMBER_OF_NODES);
+}
+
+BOOST_AUTO_TEST_CASE(resume_from_checkpoint)
+{
+    const auto checkpoint = boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path("osrm-checkpoint-%%%%-%%%%");
+    const auto edges = makeGrid(1);
+
+    // the first run stops after half of the nodes, the checkpoint of its last round is flushed
+    std::size_t interrupted_rounds = 0;
+    {
+        GraphContractor contractor(NUMBER_OF_NODES,
+                                   adaptToContractorInput(edges),
+                                   {},
+                                   std::vector<EdgeWeight>(NUMBER_OF_NODES, 1));
+        contractor.UseCheckpoint(checkpoint, std::chrono::seconds(0), false);
+        contractor.Run(0.5);
+        interrupted_rounds = contractor.GetRoundStats().size();
+    }
+    BOOST_REQUIRE(boost::filesystem::exists(checkpoint));
+
+    GraphContractor contractor(NUMBER_OF_NODES,
+                               adaptToContractorInput(edges),
+                               {},
+                               std::vector<EdgeWeight>(NUMBER_OF_NODES, 1));
+    contractor.UseCheckpoint(checkpoint, std::chrono::seconds(0), true);
+    contractor.Run();
+    BOOST_CHECK_GT(contractor.GetRoundStats().size(), interrupted_rounds);
+    BOOST_CHECK(contractor.GetCoreMarker().empty());
+    BOOST_CHECK_EQUAL(contractor.GetNodeLevels().size(), NUMBER_OF_NODES);
+    const auto contracted = contractor.GetEdges<QueryEdge>();
+    const std::vector<QueryEdge> query_edges(contracted.begin(), contracted.end());
+
+    for (const auto source : util::irange<NodeID>(0, NUMBER_OF_NODES))
+    {
+        const auto weights = dijkstra(edges, source);
+        for (const auto target : util::irange<NodeID>(0, NUMBER_OF_NODES))
+        {
+            BOOST_CHECK_EQUAL(upDownSearch(query_edges, source, target), weights[target]);
+        }
+    }
+
+    // a checkpoint of another graph is not resumed
+    auto other_edges = edges;
+    other_edges.pop_back();
+    GraphContractor other(NUMBER_OF_NODES,
+                          adaptToContractorInput(other_edges),
+                          {},
+                          std::vector<EdgeWeight>(NUMBER_OF_NODES, 1));
+    other.UseCheckpoint(checkpoint, std::chrono::seconds(0), true);
+    BOOST_CHECK_THROW(other.Run(), util::exception);
+
+    boost::filesystem::remove(checkpoint);
+}
+
+BOOST_AUTO_TEST_CASE(tune_core_benchmark)
+{
+    std::vector<float> node_levels;
+    contract(makeGrid(0), node_levels, false);
+
+    // cores of the same order answer the same workload, the grid is connected
+    for (const auto core_factor : {1.0, 0.5})
+    {
+        GraphContractor contractor(NUMBER_OF_NODES,
+                                   adaptToContractorInput(makeGrid(0)),
+                                   node_levels,
+                                   std::vector<EdgeWeight>(NUMBER_OF_NODES, 1));
+        contractor.Run(core_factor, true);
+        const auto is_core_node = contractor.GetCoreMarker();
+        BOOST_CHECK_EQUAL(is_core_node.empty(), core_factor == 1.0);
+
+        const QueryGraph graph{NUMBER_OF_NODES, contractor.GetEdges<QueryEdge>()};
+        const auto result = benchmarkQueries(graph, 20, 5);
+        BOOST_CHECK_GT(result.route_settled_nodes, 0);
+        BOOST_CHECK_EQUAL(result.table_connected_pairs, 25);
+
+        const auto packed_result = benchmarkQueries(PackedQueryGraph{graph}, 20, 5);
+        BOOST_CHECK_GT(packed_result.route_settled_nodes, 0);
+        BOOST_CHECK_EQUAL(packed_result.table_connected_pairs, 25);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+#include "contractor/packed_query_graph.hpp"
+
+#include "util/integer_range.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+BOOST_AUTO_TEST_SUITE(packed_query_graph)
+
+namespace
+{
+QueryEdge makeEdge(const NodeID source,
+                   const NodeID target,
+                   const EdgeWeight weight,
+                   const bool forward,
+                   const bool backward)
+{
+    QueryEdge edge;
+    edge.source = source;
+    edge.target = target;
+    edge.data.turn_id = source * 10 + target;
+    edge.data.shortcut = weight > 5;
+    edge.data.weight = weight;
+    edge.data.duration = weight * 2;
+    edge.data.distance = weight * 10.f;
+    edge.data.forward = forward;
+    edge.data.backward = backward;
+    return edge;
+}
+
+// 0 has a forward, a bidirectional and a backward edge, in target order backward comes first
+QueryGraph makeGraph()
+{
+    std::vector<QueryEdge> edges = {makeEdge(0, 1, 1, false, true),
+                                    makeEdge(0, 2, 7, true, true),
+                                    makeEdge(0, 3, 3, true, false),
+                                    makeEdge(2, 3, 4, true, false),
+                                    makeEdge(2, 3, 2, false, true)};
+    return QueryGraph{4, edges};
+}
+}
+
+BOOST_AUTO_TEST_CASE(direction_ranges)
+{
+    const auto graph = makeGraph();
+    const PackedQueryGraph packed{graph};
+
+    BOOST_CHECK_EQUAL(packed.GetNumberOfNodes(), 4);
+    BOOST_CHECK_EQUAL(packed.GetNumberOfEdges(), 5);
+    BOOST_CHECK_EQUAL(packed.GetOutDegree(0), 3);
+    BOOST_CHECK_EQUAL(packed.GetOutDegree(1), 0);
+    BOOST_CHECK_EQUAL(packed.GetOutDegree(2), 2);
+
+    // every edge of a direction range can be used in that direction, and no other edge
+    for (const auto node : util::irange<NodeID>(0, 4))
+    {
+        std::size_t forward_edges = 0, backward_edges = 0;
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            forward_edges += graph.GetEdgeData(edge).forward;
+            backward_edges += graph.GetEdgeData(edge).backward;
+        }
+        BOOST_CHECK_EQUAL(packed.GetForwardEdgeRange(node).size(), forward_edges);
+        BOOST_CHECK_EQUAL(packed.GetBackwardEdgeRange(node).size(), backward_edges);
+        for (const auto edge : packed.GetForwardEdgeRange(node))
+            BOOST_CHECK(packed.GetEdgeData(edge).forward);
+        for (const auto edge : packed.GetBackwardEdgeRange(node))
+            BOOST_CHECK(packed.GetEdgeData(edge).backward);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(edge_data)
+{
+    const auto graph = makeGraph();
+    const PackedQueryGraph packed{graph};
+
+    for (const auto node : util::irange<NodeID>(0, 4))
+    {
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = graph.GetEdgeData(edge);
+            const auto packed_edge = packed.FindSmallestEdge(
+                node, graph.GetTarget(edge), [&](const auto &other) {
+                    return other.forward == data.forward && other.backward == data.backward;
+                });
+            BOOST_REQUIRE(packed_edge != SPECIAL_EDGEID);
+            BOOST_CHECK_EQUAL(packed.GetTarget(packed_edge), graph.GetTarget(edge));
+            const auto packed_data = packed.GetEdgeData(packed_edge);
+            BOOST_CHECK_EQUAL(packed_data.turn_id, data.turn_id);
+            BOOST_CHECK_EQUAL(packed_data.shortcut, data.shortcut);
+            BOOST_CHECK_EQUAL(packed_data.weight, data.weight);
+            BOOST_CHECK_EQUAL(packed_data.duration, data.duration);
+            BOOST_CHECK_EQUAL(packed_data.distance, data.distance);
+        }
+    }
+
+    // the smallest of the two edges from 2 to 3
+    const auto smallest = packed.FindSmallestEdge(2, 3, [](const auto &) { return true; });
+    BOOST_CHECK_EQUAL(packed.GetEdgeData(smallest).weight, 2);
+
+    bool reverse = false;
+    BOOST_CHECK(packed.FindEdgeIndicateIfReverse(3, 0, reverse) != SPECIAL_EDGEID);
+    BOOST_CHECK(reverse);
+    BOOST_CHECK_EQUAL(packed.FindEdge(1, 0), SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(packed.GetTarget(packed.FindEdgeInEitherDirection(1, 0)), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
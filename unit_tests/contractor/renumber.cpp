@@ -0,0 +1,65 @@
+#include "contractor/renumber.hpp"
+
+#include "util/integer_range.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+BOOST_AUTO_TEST_SUITE(renumber_tests)
+
+BOOST_AUTO_TEST_CASE(locality_permutation)
+{
+    const std::vector<float> node_levels = {0, 2, 1, 2};
+    const std::vector<std::uint64_t> hilbert_codes = {5, 9, 0, 1};
+
+    // highest levels first, ties along the curve
+    const auto permutation = makeLocalityPermutation(node_levels, {}, hilbert_codes);
+    BOOST_CHECK((permutation == std::vector<NodeID>{3, 1, 2, 0}));
+
+    // the core comes before all levels
+    const auto core_permutation =
+        makeLocalityPermutation(node_levels, {true, false, false, false}, hilbert_codes);
+    BOOST_CHECK((core_permutation == std::vector<NodeID>{0, 2, 3, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(renumber_query_edges)
+{
+    const auto makeEdge = [](const NodeID source, const NodeID target, const NodeID id) {
+        QueryEdge edge;
+        edge.source = source;
+        edge.target = target;
+        edge.data.turn_id = id;
+        edge.data.shortcut = id < 4;
+        return edge;
+    };
+    util::DeallocatingVector<QueryEdge> edges;
+    edges.push_back(makeEdge(0, 1, 10));
+    edges.push_back(makeEdge(0, 2, 1));
+    edges.push_back(makeEdge(3, 1, 11));
+
+    renumber(edges, {2, 3, 1, 0});
+
+    BOOST_REQUIRE_EQUAL(edges.size(), 3);
+    // sorted by the new sources, turn ids of original edges stay, shortcuts get the new node
+    BOOST_CHECK_EQUAL(edges[0].source, 0);
+    BOOST_CHECK_EQUAL(edges[0].target, 3);
+    BOOST_CHECK_EQUAL(edges[0].data.turn_id, 11);
+    BOOST_CHECK_EQUAL(edges[1].target, 1);
+    BOOST_CHECK_EQUAL(edges[1].data.turn_id, 3);
+    BOOST_CHECK_EQUAL(edges[2].target, 3);
+    BOOST_CHECK_EQUAL(edges[2].data.turn_id, 10);
+
+    std::vector<bool> is_core_node = {true, false, false, true};
+    renumber(is_core_node, {2, 3, 1, 0});
+    BOOST_CHECK((is_core_node == std::vector<bool>{true, false, true, false}));
+
+    std::vector<bool> no_core;
+    renumber(no_core, {2, 3, 1, 0});
+    BOOST_CHECK(no_core.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
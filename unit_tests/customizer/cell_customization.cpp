@@ -2,6 +2,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include "customizer/cell_customizer.hpp"
+#include "customizer/edge_based_graph.hpp"
+#include "partition/edge_based_graph_reader.hpp"
 #include "partition/multi_level_graph.hpp"
 #include "partition/multi_level_partition.hpp"
 #include "util/static_graph.hpp"
@@ -26,6 +28,7 @@ auto makeGraph(const MultiLevelPartition &mlp, const std::vector<MockEdge> &mock
     {
         EdgeWeight weight;
         EdgeDuration duration;
+        EdgeDistance distance;
         bool forward;
         bool backward;
     };
@@ -35,13 +38,36 @@ auto makeGraph(const MultiLevelPartition &mlp, const std::vector<MockEdge> &mock
     for (const auto &m : mock_edges)
     {
         max_id = std::max<std::size_t>(max_id, std::max(m.start, m.target));
-        edges.push_back(Edge{m.start, m.target, m.weight, 2 * m.weight, true, false});
-        edges.push_back(Edge{m.target, m.start, m.weight, 2 * m.weight, false, true});
+        const EdgeDistance distance = 3.f * m.weight;
+        edges.push_back(Edge{m.start, m.target, m.weight, 2 * m.weight, distance, true, false});
+        edges.push_back(Edge{m.target, m.start, m.weight, 2 * m.weight, distance, false, true});
     }
     std::sort(edges.begin(), edges.end());
     return partition::MultiLevelGraph<EdgeData, osrm::storage::Ownership::Container>(
         mlp, max_id + 1, edges);
 }
+
+void checkEqualMetric(const MultiLevelPartition &mlp,
+                      const CellStorage &lhs,
+                      const CellStorage &rhs)
+{
+    for (LevelID level = 1; level < mlp.GetNumberOfLevels(); ++level)
+    {
+        for (CellID id = 0; id < mlp.GetNumberOfCells(level); ++id)
+        {
+            const auto lhs_cell = lhs.GetCell(level, id);
+            const auto rhs_cell = rhs.GetCell(level, id);
+            for (const auto node : lhs_cell.GetSourceNodes())
+            {
+                CHECK_EQUAL_COLLECTIONS(lhs_cell.GetOutWeight(node), rhs_cell.GetOutWeight(node));
+                CHECK_EQUAL_COLLECTIONS(lhs_cell.GetOutDuration(node),
+                                        rhs_cell.GetOutDuration(node));
+                CHECK_EQUAL_COLLECTIONS(lhs_cell.GetOutDistance(node),
+                                        rhs_cell.GetOutDistance(node));
+            }
+        }
+    }
+}
 }
 
 BOOST_AUTO_TEST_SUITE(cell_customization_tests)
@@ -260,6 +286,13 @@ BOOST_AUTO_TEST_CASE(four_levels_test)
     CHECK_EQUAL_RANGE(cell_2_1.GetInDuration(9), 0, INVALID_EDGE_WEIGHT);
     CHECK_EQUAL_RANGE(cell_2_1.GetInDuration(12), INVALID_EDGE_WEIGHT, 20);
 
+    const auto I = INVALID_EDGE_DISTANCE;
+    CHECK_EQUAL_RANGE(cell_2_1.GetOutDistance(9), 9.f, 0.f, I);
+    CHECK_EQUAL_RANGE(cell_2_1.GetOutDistance(13), I, I, 30.f);
+    CHECK_EQUAL_RANGE(cell_2_1.GetInDistance(8), 9.f, I);
+    CHECK_EQUAL_RANGE(cell_2_1.GetInDistance(9), 0.f, I);
+    CHECK_EQUAL_RANGE(cell_2_1.GetInDistance(12), I, 30.f);
+
     CellStorage storage_rec(mlp, graph);
     customizer.Customize(graph, storage_rec);
 
@@ -268,6 +301,133 @@ BOOST_AUTO_TEST_CASE(four_levels_test)
     CHECK_EQUAL_COLLECTIONS(cell_2_1.GetInWeight(8), storage_rec.GetCell(2, 1).GetInWeight(8));
     CHECK_EQUAL_COLLECTIONS(cell_2_1.GetInWeight(9), storage_rec.GetCell(2, 1).GetInWeight(9));
     CHECK_EQUAL_COLLECTIONS(cell_2_1.GetInWeight(12), storage_rec.GetCell(2, 1).GetInWeight(12));
+
+    // the matrix kernel on the upper levels yields the same metric
+    CellStorage storage_matrix(mlp, graph);
+    CellCustomizer(mlp, CellCustomizer::Kernel::Matrix).Customize(graph, storage_matrix);
+    checkEqualMetric(mlp, storage_rec, storage_matrix);
+}
+
+BOOST_AUTO_TEST_CASE(incremental_test)
+{
+    // node:                0  1  2  3  4  5  6  7
+    std::vector<CellID> l1{{0, 0, 1, 1, 2, 2, 3, 3}};
+    std::vector<CellID> l2{{0, 0, 0, 0, 1, 1, 1, 1}};
+    MultiLevelPartition mlp{{l1, l2}, {4, 2}};
+
+    std::vector<MockEdge> edges = {{0, 1, 1},
+                                   {1, 2, 1},
+                                   {2, 3, 1},
+                                   {3, 0, 1},
+                                   {3, 4, 1},
+                                   {4, 5, 1},
+                                   {5, 6, 1},
+                                   {6, 7, 1},
+                                   {7, 4, 1},
+                                   {5, 2, 1}};
+    auto graph = makeGraph(mlp, edges);
+
+    CellCustomizer customizer(mlp);
+    CellStorage storage(mlp, graph);
+    customizer.Customize(graph, storage);
+
+    // the edge 6 -> 7 gets slower, it is inside of cell 3 on level 1
+    edges[7].weight = 5;
+    auto updated_graph = makeGraph(mlp, edges);
+
+    CellStorage expected(mlp, updated_graph);
+    customizer.Customize(updated_graph, expected);
+
+    // cell 3 on level 1 and cell 1 on level 2
+    BOOST_CHECK_EQUAL(customizer.Customize(updated_graph, storage, {6, 7}), 2);
+
+    checkEqualMetric(mlp, storage, expected);
+
+    CellStorage matrix_expected(mlp, updated_graph);
+    CellCustomizer(mlp, CellCustomizer::Kernel::Matrix).Customize(updated_graph, matrix_expected);
+    checkEqualMetric(mlp, matrix_expected, expected);
+
+    // no updated nodes leave the metric as it is
+    BOOST_CHECK_EQUAL(customizer.Customize(updated_graph, storage, {}), 0);
+}
+
+BOOST_AUTO_TEST_CASE(multiple_metrics_test)
+{
+    // node:                0  1  2  3  4  5
+    std::vector<CellID> l1{{0, 0, 1, 1, 2, 2}};
+    std::vector<CellID> l2{{0, 0, 0, 0, 1, 1}};
+    MultiLevelPartition mlp{{l1, l2}, {3, 2}};
+
+    using extractor::EdgeBasedEdge;
+    std::vector<EdgeBasedEdge> metric_0 = {{0, 1, 0, 1, 1, 1, true, false},
+                                           {1, 0, 1, 1, 1, 1, true, false},
+                                           {1, 2, 2, 1, 1, 1, true, false},
+                                           {2, 3, 3, 1, 1, 1, true, false},
+                                           {3, 2, 4, 1, 1, 1, true, false},
+                                           {3, 0, 5, 1, 1, 1, true, false},
+                                           {3, 4, 6, 1, 1, 1, true, false},
+                                           {4, 5, 7, 1, 1, 1, true, false},
+                                           {5, 4, 8, 1, 1, 1, true, false},
+                                           {5, 2, 9, 1, 1, 1, true, false}};
+    // metric 1 is slower on 2 -> 3, closes 1 -> 0 and opens 4 -> 3 that is closed in metric 0
+    auto metric_1 = metric_0;
+    metric_1[3].data.weight = 5;
+    metric_1[1].data.weight = INVALID_EDGE_WEIGHT;
+    metric_0.push_back({4, 3, 10, INVALID_EDGE_WEIGHT, 1, 1, true, false});
+    metric_1.push_back({4, 3, 10, 2, 1, 1, true, false});
+
+    const auto num_nodes = 6;
+    const auto metric_edges =
+        prepareMetricEdgesForUsageInGraph<StaticEdgeBasedGraphEdge>({metric_0, metric_1});
+    BOOST_REQUIRE_EQUAL(metric_edges.size(), 2);
+    BOOST_REQUIRE_EQUAL(metric_edges[0].size(), metric_edges[1].size());
+
+    MultiLevelEdgeBasedGraph graph_0(mlp, num_nodes, metric_edges[0]);
+    MultiLevelEdgeBasedGraph graph_1(mlp, num_nodes, metric_edges[1]);
+
+    CellCustomizer customizer(mlp);
+    CellStorage storage(mlp, graph_0);
+    storage.SetNumberOfMetrics(2);
+    storage.SelectMetric(0);
+    customizer.Customize(graph_0, storage);
+    storage.SelectMetric(1);
+    customizer.Customize(graph_1, storage);
+
+    // every metric yields the metric of its own graph, the cells stay those of metric 0
+    const auto single_metric = [&](const std::vector<EdgeBasedEdge> &edges) {
+        MultiLevelEdgeBasedGraph graph(
+            mlp,
+            num_nodes,
+            prepareEdgesForUsageInGraph<StaticEdgeBasedGraphEdge>(splitBidirectionalEdges(edges)));
+        CellStorage expected(mlp, graph_0);
+        customizer.Customize(graph, expected);
+        return expected;
+    };
+    storage.SelectMetric(0);
+    checkEqualMetric(mlp, storage, single_metric(metric_0));
+    storage.SelectMetric(1);
+    checkEqualMetric(mlp, storage, single_metric(metric_1));
+
+    const auto weight_2_3 = [&](const std::size_t metric) {
+        storage.SelectMetric(metric);
+        const auto cell = storage.GetCell(1, 1);
+        const auto destinations = cell.GetDestinationNodes();
+        const auto column = std::find(destinations.begin(), destinations.end(), 3);
+        BOOST_REQUIRE(column != destinations.end());
+        return cell.GetOutWeight(2)[std::distance(destinations.begin(), column)];
+    };
+    BOOST_CHECK_EQUAL(weight_2_3(0), 1);
+    BOOST_CHECK_EQUAL(weight_2_3(1), 5);
+
+    // the layers share the edges, the second metric follows the first one
+    const auto num_edges = graph_0.GetNumberOfEdges();
+    graph_0.AddMetric(graph_1);
+    BOOST_CHECK_EQUAL(graph_0.GetNumberOfMetrics(), 2);
+    BOOST_CHECK_EQUAL(graph_0.GetNumberOfEdges(), num_edges);
+    const auto edge = graph_0.FindEdge(2, 3);
+    BOOST_REQUIRE(edge != SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(graph_0.GetEdgeData(edge).weight, 1);
+    BOOST_CHECK_EQUAL(graph_0.GetEdgeData(num_edges + edge).weight, 5);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
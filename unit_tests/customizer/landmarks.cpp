@@ -0,0 +1,135 @@
+#include <boost/test/unit_test.hpp>
+
+#include "customizer/landmarks.hpp"
+#include "util/static_graph.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::customizer;
+using namespace osrm::util;
+
+namespace
+{
+struct MockEdge
+{
+    NodeID start;
+    NodeID target;
+    EdgeWeight weight;
+};
+
+struct EdgeData
+{
+    EdgeWeight weight;
+    bool forward;
+    bool backward;
+};
+
+auto makeGraph(const std::size_t num_nodes, const std::vector<MockEdge> &mock_edges)
+{
+    using Edge = static_graph_details::SortableEdgeWithData<EdgeData>;
+    std::vector<Edge> edges;
+    for (const auto &m : mock_edges)
+    {
+        edges.push_back(Edge{m.start, m.target, m.weight, true, false});
+        edges.push_back(Edge{m.target, m.start, m.weight, false, true});
+    }
+    std::sort(edges.begin(), edges.end());
+    return StaticGraph<EdgeData>(num_nodes, edges);
+}
+
+// all pairs shortest paths, INVALID_EDGE_WEIGHT if there is no path
+auto makeWeights(const std::size_t num_nodes, const std::vector<MockEdge> &edges)
+{
+    const std::int64_t invalid = std::numeric_limits<std::int64_t>::max() / 4;
+    std::vector<std::vector<std::int64_t>> weights(num_nodes,
+                                                   std::vector<std::int64_t>(num_nodes, invalid));
+    for (std::size_t node = 0; node < num_nodes; ++node)
+        weights[node][node] = 0;
+    for (const auto &edge : edges)
+        weights[edge.start][edge.target] =
+            std::min<std::int64_t>(weights[edge.start][edge.target], edge.weight);
+    for (std::size_t via = 0; via < num_nodes; ++via)
+        for (std::size_t from = 0; from < num_nodes; ++from)
+            for (std::size_t to = 0; to < num_nodes; ++to)
+                weights[from][to] =
+                    std::min(weights[from][to], weights[from][via] + weights[via][to]);
+
+    std::vector<std::vector<EdgeWeight>> result(num_nodes, std::vector<EdgeWeight>(num_nodes));
+    for (std::size_t from = 0; from < num_nodes; ++from)
+        for (std::size_t to = 0; to < num_nodes; ++to)
+            result[from][to] = weights[from][to] == invalid
+                                   ? INVALID_EDGE_WEIGHT
+                                   : static_cast<EdgeWeight>(weights[from][to]);
+    return result;
+}
+}
+
+BOOST_AUTO_TEST_SUITE(landmarks_tests)
+
+BOOST_AUTO_TEST_CASE(no_landmarks)
+{
+    const auto graph = makeGraph(3, {{0, 1, 1}, {1, 2, 1}});
+    const auto landmarks = computeLandmarks(graph, 0);
+    BOOST_CHECK(landmarks.Empty());
+}
+
+BOOST_AUTO_TEST_CASE(lower_bounds)
+{
+    // 0 -> 1 -> 2 -> 3 -> 4 with a detour 1 -> 5 -> 3, a way back 4 -> 0 and a node 6 that is
+    // only reachable from 4
+    const std::size_t num_nodes = 7;
+    const std::vector<MockEdge> edges = {
+        {0, 1, 2}, {1, 2, 3}, {2, 3, 4}, {3, 4, 1}, {1, 5, 1}, {5, 3, 9}, {4, 0, 20}, {4, 6, 5}};
+    const auto graph = makeGraph(num_nodes, edges);
+    const auto weights = makeWeights(num_nodes, edges);
+
+    const auto landmarks = computeLandmarks(graph, 3);
+    BOOST_REQUIRE_EQUAL(landmarks.GetNumberOfLandmarks(), 3);
+
+    for (std::uint32_t landmark = 0; landmark < landmarks.GetNumberOfLandmarks(); ++landmark)
+    {
+        // the weights of a landmark are exact, find the landmark by its weight 0
+        NodeID landmark_node = SPECIAL_NODEID;
+        for (NodeID node = 0; node < num_nodes; ++node)
+        {
+            if (landmarks.GetWeightFrom(landmark, node) == 0)
+                landmark_node = node;
+        }
+        BOOST_REQUIRE(landmark_node != SPECIAL_NODEID);
+        BOOST_CHECK_EQUAL(landmarks.GetWeightTo(landmark, landmark_node), 0);
+
+        for (NodeID node = 0; node < num_nodes; ++node)
+        {
+            const auto from = weights[landmark_node][node];
+            const auto to = weights[node][landmark_node];
+            BOOST_CHECK_EQUAL(landmarks.GetWeightFrom(landmark, node),
+                              from == INVALID_EDGE_WEIGHT ? Landmarks::INVALID_WEIGHT
+                                                          : Landmarks::Weight(from));
+            BOOST_CHECK_EQUAL(landmarks.GetWeightTo(landmark, node),
+                              to == INVALID_EDGE_WEIGHT ? Landmarks::INVALID_WEIGHT
+                                                        : Landmarks::Weight(to));
+        }
+    }
+
+    for (NodeID from = 0; from < num_nodes; ++from)
+    {
+        for (NodeID to = 0; to < num_nodes; ++to)
+        {
+            const auto bound = landmarks.GetLowerBound(from, to);
+            BOOST_CHECK_GE(bound, 0);
+            if (weights[from][to] != INVALID_EDGE_WEIGHT)
+            {
+                BOOST_CHECK_LE(bound, weights[from][to]);
+            }
+        }
+    }
+
+    // the bounds are tight along the paths to and from the landmarks, at least one of them
+    // bounds the long way from 0 to 4 above the trivial bound
+    BOOST_CHECK_GT(landmarks.GetLowerBound(0, 4), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
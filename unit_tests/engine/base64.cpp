@@ -36,6 +36,39 @@ BOOST_AUTO_TEST_CASE(rfc4648_test_vectors_roundtrip)
     BOOST_CHECK_EQUAL(decodeBase64(encodeBase64("foobar")), "foobar");
 }
 
+// Section 5, the URL safe alphabet without padding
+BOOST_AUTO_TEST_CASE(rfc4648_url_test_vectors_roundtrip)
+{
+    using namespace osrm::engine;
+
+    const auto encode = [](const std::string &bytes) {
+        return encodeBase64URL(reinterpret_cast<const unsigned char *>(bytes.data()),
+                               bytes.size());
+    };
+    const auto decode = [](const std::string &encoded) {
+        std::string decoded;
+        BOOST_CHECK(decodeBase64URL(encoded, decoded));
+        return decoded;
+    };
+
+    BOOST_CHECK_EQUAL(encode(""), "");
+    BOOST_CHECK_EQUAL(encode("f"), "Zg");
+    BOOST_CHECK_EQUAL(encode("fo"), "Zm8");
+    BOOST_CHECK_EQUAL(encode("foo"), "Zm9v");
+    BOOST_CHECK_EQUAL(encode("foob"), "Zm9vYg");
+    BOOST_CHECK_EQUAL(encode("\xfb\xff"), "-_8");
+
+    for (const std::string bytes : {"", "f", "fo", "foo", "foob", "fooba", "foobar", "\xfb\xff"})
+    {
+        BOOST_CHECK_EQUAL(decode(encode(bytes)), bytes);
+    }
+
+    std::string decoded;
+    BOOST_CHECK(!decodeBase64URL("Zm9vY", decoded));
+    BOOST_CHECK(!decodeBase64URL("Zm8=", decoded));
+    BOOST_CHECK(!decodeBase64URL("+/8", decoded));
+}
+
 BOOST_AUTO_TEST_CASE(hint_encoding_decoding_roundtrip)
 {
     using namespace osrm::engine;
@@ -0,0 +1,51 @@
+#include "engine/deadline.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+
+BOOST_AUTO_TEST_SUITE(deadline)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+BOOST_AUTO_TEST_CASE(unset_deadline_never_expires)
+{
+    Deadline deadline = Deadline::After(boost::none);
+    BOOST_CHECK(!deadline.IsSet());
+    BOOST_CHECK(!deadline.IsExpired());
+    for (int i = 0; i < 10000; ++i)
+    {
+        deadline.Check();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(future_deadline_does_not_throw)
+{
+    Deadline deadline = Deadline::After(std::chrono::milliseconds(60 * 1000));
+    BOOST_CHECK(deadline.IsSet());
+    BOOST_CHECK(!deadline.IsExpired());
+    for (int i = 0; i < 10000; ++i)
+    {
+        deadline.Check();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(expired_deadline_throws_within_check_interval)
+{
+    Deadline deadline(Deadline::Clock::now() - std::chrono::milliseconds(1));
+    BOOST_CHECK(deadline.IsExpired());
+
+    // the clock is only sampled periodically, but an expired deadline is caught eventually
+    BOOST_CHECK_THROW(
+        {
+            for (int i = 0; i < 10000; ++i)
+            {
+                deadline.Check();
+            }
+        },
+        DeadlineExceeded);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,11 +1,13 @@
 #include "engine/douglas_peucker.hpp"
 #include "util/coordinate_calculation.hpp"
+#include "util/web_mercator.hpp"
 
 #include <boost/test/test_case_template.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include <osrm/coordinate.hpp>
 
+#include <random>
 #include <vector>
 
 BOOST_AUTO_TEST_SUITE(douglas_peucker_simplification)
@@ -114,4 +116,49 @@ BOOST_AUTO_TEST_CASE(remove_second_node_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(long_geometry_within_thresholds)
+{
+    // a random walk long enough for many full vectors of points per range
+    std::mt19937 generator(42);
+    std::normal_distribution<> step(0, 0.0005);
+    std::vector<util::Coordinate> input;
+    double lon = 7.4, lat = 43.7;
+    for (int index = 0; index < 5003; ++index)
+    {
+        lon += step(generator);
+        lat += step(generator);
+        input.push_back(util::Coordinate{util::FloatLongitude{lon}, util::FloatLatitude{lat}});
+    }
+
+    for (unsigned z = 0; z < detail::DOUGLAS_PEUCKER_THRESHOLDS_SIZE; z++)
+    {
+        const auto result = douglasPeucker(input, z);
+        BOOST_REQUIRE_GE(result.size(), 2);
+        BOOST_CHECK_EQUAL(result.front(), input.front());
+        BOOST_CHECK_EQUAL(result.back(), input.back());
+
+        // every dropped point is within the threshold of the segment it was dropped for
+        std::size_t kept = 0;
+        for (const auto &coordinate : input)
+        {
+            if (kept + 1 < result.size() && coordinate == result[kept + 1])
+            {
+                ++kept;
+                continue;
+            }
+            BOOST_REQUIRE_LT(kept + 1, result.size());
+            const auto projected = util::web_mercator::fromWGS84(coordinate);
+            const auto nearest = util::coordinate_calculation::projectPointOnSegment(
+                                     util::web_mercator::fromWGS84(result[kept]),
+                                     util::web_mercator::fromWGS84(result[kept + 1]),
+                                     projected)
+                                     .second;
+            const auto distance =
+                util::coordinate_calculation::squaredEuclideanDistance(projected, nearest);
+            BOOST_CHECK_LE(distance, detail::DOUGLAS_PEUCKER_THRESHOLDS[z]);
+        }
+        BOOST_CHECK_EQUAL(kept + 1, result.size());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+#include "engine/algorithm.hpp"
+#include "engine/heap_pool.hpp"
+#include "engine/search_engine_data.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+BOOST_AUTO_TEST_SUITE(heap_pool)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+struct TestHeapSet
+{
+    std::unique_ptr<int> heap;
+};
+}
+
+BOOST_AUTO_TEST_CASE(reuses_released_heaps)
+{
+    HeapPool<TestHeapSet> pool;
+
+    auto first = pool.Acquire();
+    BOOST_CHECK(!first.heap);
+    first.heap = std::make_unique<int>(42);
+    const auto *first_heap = first.heap.get();
+    pool.Release(std::move(first));
+
+    auto second = pool.Acquire();
+    BOOST_CHECK_EQUAL(second.heap.get(), first_heap);
+    pool.Release(std::move(second));
+
+    const auto statistics = pool.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.leased, 0);
+    BOOST_CHECK_EQUAL(statistics.high_water_mark, 1);
+    BOOST_CHECK_EQUAL(statistics.idle, 1);
+    BOOST_CHECK_EQUAL(statistics.created, 1);
+}
+
+BOOST_AUTO_TEST_CASE(keeps_at_most_max_idle_heaps)
+{
+    HeapPool<TestHeapSet> pool(std::size_t{1});
+
+    auto first = pool.Acquire();
+    auto second = pool.Acquire();
+    auto third = pool.Acquire();
+    BOOST_CHECK_EQUAL(pool.GetStatistics().leased, 3);
+
+    pool.Release(std::move(first));
+    pool.Release(std::move(second));
+    pool.Release(std::move(third));
+
+    const auto statistics = pool.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.leased, 0);
+    BOOST_CHECK_EQUAL(statistics.high_water_mark, 3);
+    BOOST_CHECK_EQUAL(statistics.idle, 1);
+    BOOST_CHECK_EQUAL(statistics.created, 3);
+}
+
+BOOST_AUTO_TEST_CASE(search_engine_data_leases_for_its_life_time)
+{
+    using Algorithm = routing_algorithms::mld::Algorithm;
+    SearchEngineData<Algorithm>::HeapPool pool;
+
+    {
+        SearchEngineData<Algorithm> heaps(pool);
+        heaps.InitializeOrClearFirstHeaps(10);
+        BOOST_CHECK(heaps.forward_heap_1);
+        BOOST_CHECK_EQUAL(pool.GetStatistics().leased, 1);
+    }
+    BOOST_CHECK_EQUAL(pool.GetStatistics().leased, 0);
+
+    // the next query gets the cleared heaps of the last one
+    SearchEngineData<Algorithm> heaps(pool);
+    BOOST_CHECK(heaps.forward_heap_1);
+    heaps.InitializeOrClearFirstHeaps(10);
+    BOOST_CHECK(heaps.forward_heap_1->Empty());
+    BOOST_CHECK_EQUAL(pool.GetStatistics().created, 1);
+}
+
+BOOST_AUTO_TEST_CASE(search_engine_data_counts_heap_operations)
+{
+    using Algorithm = routing_algorithms::mld::Algorithm;
+    SearchEngineData<Algorithm>::HeapPool pool;
+
+    const auto before = GetThreadSearchStatistics();
+    {
+        SearchEngineData<Algorithm> heaps(pool);
+        heaps.InitializeOrClearFirstHeaps(10);
+        heaps.forward_heap_1->Insert(1, 10, 1);
+        heaps.forward_heap_1->Insert(2, 20, 1);
+        heaps.forward_heap_1->DecreaseKey(2, 5);
+        heaps.reverse_heap_1->Insert(3, 10, 3);
+        heaps.forward_heap_1->DeleteMin();
+        heaps.reverse_heap_1->DeleteMin();
+    }
+    const auto first = GetThreadSearchStatistics() - before;
+    BOOST_CHECK_EQUAL(first.settled_nodes, 2);
+    BOOST_CHECK_EQUAL(first.relaxed_edges, 4);
+
+    // the reused heaps only count the operations of the next query
+    {
+        SearchEngineData<Algorithm> heaps(pool);
+        heaps.InitializeOrClearFirstHeaps(10);
+        heaps.forward_heap_1->Insert(1, 10, 1);
+    }
+    const auto second = GetThreadSearchStatistics() - before;
+    BOOST_CHECK_EQUAL(second.settled_nodes, 2);
+    BOOST_CHECK_EQUAL(second.relaxed_edges, 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,155 @@
+#include "engine/hint.hpp"
+#include "mocks/mock_datafacade.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(hint_test)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+// Two edge-based nodes over both directions of a geometry with three segments
+class HintFacade final : public test::MockBaseDataFacade
+{
+  public:
+    unsigned GetCheckSum() const override { return 42; }
+    std::size_t GetNumberOfEdgeBasedNodes() const override { return 2; }
+    GeometryID GetGeometryIndex(const NodeID id) const override
+    {
+        return GeometryID{7, id == 0};
+    }
+    ComponentID GetComponentID(const NodeID /* id */) const override
+    {
+        return ComponentID{3, false};
+    }
+    std::size_t GetNumberOfGeometrySegments(const EdgeID id) const override
+    {
+        return id == 7 ? 3 : 0;
+    }
+};
+
+struct Segment
+{
+    SegmentID forward_segment_id;
+    SegmentID reverse_segment_id;
+    unsigned short fwd_segment_position;
+};
+
+const util::Coordinate input_location{util::FloatLongitude{13.388}, util::FloatLatitude{52.517}};
+
+Hint makeHint(const Segment segment, const ComponentID component = ComponentID{3, false})
+{
+    const util::Coordinate location{util::FloatLongitude{13.3881},
+                                    util::FloatLatitude{52.5172}};
+    return Hint{PhantomNode{segment,
+                            component,
+                            120,
+                            80,
+                            10,
+                            -5,
+                            12,
+                            8,
+                            1,
+                            0,
+                            true,
+                            true,
+                            false,
+                            true,
+                            location,
+                            input_location},
+                42};
+}
+
+void checkSameHint(const Hint &lhs, const Hint &rhs)
+{
+    const auto &left = lhs.phantom;
+    const auto &right = rhs.phantom;
+    BOOST_CHECK_EQUAL(left.forward_segment_id.id, right.forward_segment_id.id);
+    BOOST_CHECK_EQUAL(left.forward_segment_id.enabled, right.forward_segment_id.enabled);
+    BOOST_CHECK_EQUAL(left.reverse_segment_id.id, right.reverse_segment_id.id);
+    BOOST_CHECK_EQUAL(left.reverse_segment_id.enabled, right.reverse_segment_id.enabled);
+    BOOST_CHECK_EQUAL(left.forward_weight, right.forward_weight);
+    BOOST_CHECK_EQUAL(left.reverse_weight, right.reverse_weight);
+    BOOST_CHECK_EQUAL(left.forward_weight_offset, right.forward_weight_offset);
+    BOOST_CHECK_EQUAL(left.reverse_weight_offset, right.reverse_weight_offset);
+    BOOST_CHECK_EQUAL(left.forward_duration, right.forward_duration);
+    BOOST_CHECK_EQUAL(left.reverse_duration, right.reverse_duration);
+    BOOST_CHECK_EQUAL(left.forward_duration_offset, right.forward_duration_offset);
+    BOOST_CHECK_EQUAL(left.reverse_duration_offset, right.reverse_duration_offset);
+    BOOST_CHECK_EQUAL(left.component.id, right.component.id);
+    BOOST_CHECK_EQUAL(left.component.is_tiny, right.component.is_tiny);
+    BOOST_CHECK_EQUAL(left.location, right.location);
+    BOOST_CHECK_EQUAL(left.input_location, right.input_location);
+    BOOST_CHECK_EQUAL(left.fwd_segment_position, right.fwd_segment_position);
+    BOOST_CHECK_EQUAL(left.IsValidForwardSource(), right.IsValidForwardSource());
+    BOOST_CHECK_EQUAL(left.IsValidForwardTarget(), right.IsValidForwardTarget());
+    BOOST_CHECK_EQUAL(left.IsValidReverseSource(), right.IsValidReverseSource());
+    BOOST_CHECK_EQUAL(left.IsValidReverseTarget(), right.IsValidReverseTarget());
+    BOOST_CHECK_EQUAL(lhs.data_checksum, rhs.data_checksum);
+}
+}
+
+BOOST_AUTO_TEST_CASE(validates_segments_in_facade)
+{
+    const HintFacade facade;
+    const Segment segment{{0, true}, {1, true}, 2};
+
+    BOOST_CHECK(makeHint(segment).IsValid(input_location, facade));
+    BOOST_CHECK(!makeHint(segment).IsValid(
+        util::Coordinate{util::FloatLongitude{13.}, util::FloatLatitude{52.}}, facade));
+
+    auto other_dataset = makeHint(segment);
+    other_dataset.data_checksum = 43;
+    BOOST_CHECK(!other_dataset.IsValid(input_location, facade));
+
+    // one way segments
+    const Segment one_way{{0, true}, {SPECIAL_SEGMENTID, false}, 0};
+    BOOST_CHECK(makeHint(one_way).IsValid(input_location, facade));
+    const Segment disabled{{0, false}, {SPECIAL_SEGMENTID, false}, 0};
+    BOOST_CHECK(!makeHint(disabled).IsValid(input_location, facade));
+
+    // ids, positions and components the facade does not have
+    BOOST_CHECK(!makeHint({{2, true}, {1, true}, 0}).IsValid(input_location, facade));
+    BOOST_CHECK(!makeHint({{0, true}, {5, true}, 0}).IsValid(input_location, facade));
+    BOOST_CHECK(!makeHint({{0, true}, {1, true}, 3}).IsValid(input_location, facade));
+    BOOST_CHECK(!makeHint(segment, ComponentID{4, false}).IsValid(input_location, facade));
+    BOOST_CHECK(!makeHint(segment, ComponentID{3, true}).IsValid(input_location, facade));
+}
+
+BOOST_AUTO_TEST_CASE(compact_encoding_roundtrip)
+{
+    for (const auto &hint : {makeHint({{0, true}, {1, true}, 2}),
+                             makeHint({{0, true}, {SPECIAL_SEGMENTID, false}, 0}),
+                             Hint{PhantomNode{}, 0}})
+    {
+        const auto encoded = hint.ToCompactBase64();
+        BOOST_CHECK_EQUAL(encoded.front(), COMPACT_HINT_PREFIX);
+        BOOST_CHECK_LT(encoded.size(), ENCODED_HINT_SIZE);
+        BOOST_CHECK(encoded.find_first_of("+/=") == std::string::npos);
+
+        const auto decoded = Hint::FromCompactBase64(encoded);
+        BOOST_REQUIRE(decoded);
+        checkSameHint(hint, *decoded);
+    }
+
+    BOOST_CHECK_LE(makeHint({{0, true}, {1, true}, 2}).ToCompactBase64().size(),
+                   ENCODED_HINT_SIZE / 2);
+}
+
+BOOST_AUTO_TEST_CASE(compact_encoding_rejects_malformed)
+{
+    const auto encoded = makeHint({{0, true}, {1, true}, 2}).ToCompactBase64();
+
+    for (std::size_t size = 0; size < encoded.size(); ++size)
+    {
+        BOOST_CHECK(!Hint::FromCompactBase64(encoded.substr(0, size)));
+    }
+    BOOST_CHECK(!Hint::FromCompactBase64(encoded + "AA"));
+    BOOST_CHECK(!Hint::FromCompactBase64(encoded.substr(1)));
+    BOOST_CHECK(!Hint::FromCompactBase64(".////"));
+    BOOST_CHECK(!Hint::FromCompactBase64(makeHint({{0, true}, {1, true}, 2}).ToBase64()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
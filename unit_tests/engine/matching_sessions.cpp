@@ -0,0 +1,71 @@
+#include "engine/matching_sessions.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(matching_sessions)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+BOOST_AUTO_TEST_CASE(same_id_same_session)
+{
+    MatchingSessions sessions(4, std::chrono::seconds(10));
+    const auto dataset = std::make_shared<int>(0);
+    const auto now = MatchingSessions::Clock::now();
+
+    const auto first = sessions.Get("a", dataset, now);
+    first->state.broken_steps = 1;
+    BOOST_CHECK_EQUAL(sessions.Get("a", dataset, now), first);
+    BOOST_CHECK(sessions.Get("b", dataset, now) != first);
+    BOOST_CHECK_EQUAL(sessions.Size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(unused_sessions_expire)
+{
+    MatchingSessions sessions(4, std::chrono::seconds(10));
+    const auto dataset = std::make_shared<int>(0);
+    const auto now = MatchingSessions::Clock::now();
+
+    const auto first = sessions.Get("a", dataset, now);
+    sessions.Get("b", dataset, now + std::chrono::seconds(5));
+    // using a session keeps it alive
+    BOOST_CHECK_EQUAL(sessions.Get("a", dataset, now + std::chrono::seconds(8)), first);
+
+    sessions.Get("c", dataset, now + std::chrono::seconds(16));
+    BOOST_CHECK_EQUAL(sessions.Size(), 2);
+    BOOST_CHECK_EQUAL(sessions.Get("a", dataset, now + std::chrono::seconds(16)), first);
+    BOOST_CHECK(sessions.Get("a", dataset, now + std::chrono::seconds(30)) != first);
+    BOOST_CHECK_EQUAL(sessions.Size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(least_recently_used_is_dropped)
+{
+    MatchingSessions sessions(2, std::chrono::seconds(10));
+    const auto dataset = std::make_shared<int>(0);
+    const auto now = MatchingSessions::Clock::now();
+
+    const auto first = sessions.Get("a", dataset, now);
+    const auto second = sessions.Get("b", dataset, now);
+    sessions.Get("a", dataset, now);
+    sessions.Get("c", dataset, now);
+    BOOST_CHECK_EQUAL(sessions.Size(), 2);
+    BOOST_CHECK_EQUAL(sessions.Get("a", dataset, now), first);
+    BOOST_CHECK(sessions.Get("b", dataset, now) != second);
+}
+
+BOOST_AUTO_TEST_CASE(new_dataset_drops_sessions)
+{
+    MatchingSessions sessions(4, std::chrono::seconds(10));
+    const auto dataset = std::make_shared<int>(0);
+    const auto now = MatchingSessions::Clock::now();
+
+    const auto first = sessions.Get("a", dataset, now);
+    sessions.Get("b", dataset, now);
+
+    const auto new_dataset = std::make_shared<int>(1);
+    BOOST_CHECK(sessions.Get("a", new_dataset, now) != first);
+    BOOST_CHECK_EQUAL(sessions.Size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
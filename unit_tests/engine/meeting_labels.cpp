@@ -0,0 +1,89 @@
+#include "engine/meeting_labels.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(meeting_labels)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+BOOST_AUTO_TEST_CASE(records_best_meeting)
+{
+    MeetingLabels labels(4);
+    labels.Clear();
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), SPECIAL_NODEID);
+    BOOST_CHECK_EQUAL(labels.GetBestWeight(), INVALID_EDGE_WEIGHT);
+
+    labels.Label(true, 1, 5);
+    BOOST_CHECK_EQUAL(labels.GetLabel(true, 1), 5);
+    BOOST_CHECK_EQUAL(labels.GetLabel(false, 1), INVALID_EDGE_WEIGHT);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), SPECIAL_NODEID);
+
+    labels.Label(false, 1, 7);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), 1);
+    BOOST_CHECK_EQUAL(labels.GetBestWeight(), 12);
+
+    // worse paths are ignored
+    labels.Label(false, 2, 1);
+    labels.Label(true, 2, 20);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), 1);
+    BOOST_CHECK_EQUAL(labels.GetBestWeight(), 12);
+
+    // so are paths of negative weight, a source behind the target on the same segment
+    labels.Label(true, 3, -4);
+    labels.Label(false, 3, 2);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), 1);
+
+    labels.Label(true, 2, 3);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), 2);
+    BOOST_CHECK_EQUAL(labels.GetBestWeight(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(clear_forgets_labels)
+{
+    MeetingLabels labels(2);
+    labels.Clear();
+    labels.Label(true, 0, 1);
+    labels.Label(false, 0, 1);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), 0);
+
+    labels.Clear(10);
+    BOOST_CHECK_EQUAL(labels.GetLabel(true, 0), INVALID_EDGE_WEIGHT);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), SPECIAL_NODEID);
+    BOOST_CHECK_EQUAL(labels.GetBestWeight(), 10);
+
+    // only paths below the upper bound are recorded
+    labels.Label(true, 1, 6);
+    labels.Label(false, 1, 4);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), SPECIAL_NODEID);
+    labels.Label(false, 1, 3);
+    BOOST_CHECK_EQUAL(labels.GetBestMiddle(), 1);
+    BOOST_CHECK_EQUAL(labels.GetBestWeight(), 9);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_directions_meet)
+{
+    const unsigned number_of_nodes = 10000;
+    MeetingLabels labels(number_of_nodes);
+
+    // both directions label every node at once, the lightest meeting is at the last node
+    for (int round = 0; round < 10; ++round)
+    {
+        labels.Clear();
+        std::thread reverse([&labels] {
+            for (NodeID node = 0; node < number_of_nodes; ++node)
+                labels.Label(false, node, number_of_nodes - node);
+        });
+        for (NodeID node = 0; node < number_of_nodes; ++node)
+            labels.Label(true, number_of_nodes - 1 - node, 2 * (number_of_nodes - 1 - node));
+        reverse.join();
+
+        BOOST_CHECK_EQUAL(labels.GetBestMiddle(), 0);
+        BOOST_CHECK_EQUAL(labels.GetBestWeight(), number_of_nodes);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -32,7 +32,9 @@ template <> struct SearchEngineData<routing_algorithms::offline::Algorithm>
     SearchEngineHeapPtr forward_heap_1;
     SearchEngineHeapPtr reverse_heap_1;
 
-    void InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes)
+    Deadline deadline;
+
+    void InitializeOrClearFirstHeaps(unsigned number_of_nodes)
     {
         if (forward_heap_1.get())
         {
@@ -127,6 +129,16 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
         return outData;
     }
 
+    const util::SearchEdge &GetSearchEdge(const EdgeID /*edgeID*/) const
+    {
+        static util::SearchEdge outEdge;
+        return outEdge;
+    }
+
+    EdgeID EndEdges(const NodeID /*node*/) const { return 0; }
+
+    void PrefetchNode(const NodeID /*node*/) const {}
+
     const auto &GetMultiLevelPartition() const { return external_partition; }
 
     const auto &GetCellStorage() const { return external_cell_storage; }
@@ -150,14 +162,18 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
 
     GeometryID GetGeometryIndex(const NodeID /*id*/) const override { return GeometryID{0, false}; }
 
-    std::vector<NodeID> GetUncompressedForwardGeometry(const EdgeID /*id*/) const override
+    std::size_t GetNumberOfEdgeBasedNodes() const override { return 0; }
+
+    std::size_t GetNumberOfGeometrySegments(const EdgeID /*id*/) const override { return 0; }
+
+    NodeForwardRange GetUncompressedForwardGeometry(const EdgeID /*id*/) const override
     {
         return {};
     }
 
-    std::vector<NodeID> GetUncompressedReverseGeometry(const EdgeID /*id*/) const override
+    NodeReverseRange GetUncompressedReverseGeometry(const EdgeID id) const override
     {
-        return {};
+        return NodeReverseRange(GetUncompressedForwardGeometry(id));
     }
 
     TurnPenalty GetWeightPenaltyForEdgeID(const unsigned /*id*/) const override
@@ -170,34 +186,34 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
         return INVALID_TURN_PENALTY;
     }
 
-    std::vector<EdgeWeight> GetUncompressedForwardWeights(const EdgeID /*id*/) const override
+    WeightForwardRange GetUncompressedForwardWeights(const EdgeID /*id*/) const override
     {
         return {};
     }
 
-    std::vector<EdgeWeight> GetUncompressedReverseWeights(const EdgeID /*id*/) const override
+    WeightReverseRange GetUncompressedReverseWeights(const EdgeID id) const override
     {
-        return {};
+        return WeightReverseRange(GetUncompressedForwardWeights(id));
     }
 
-    std::vector<EdgeWeight> GetUncompressedForwardDurations(const EdgeID /*geomID*/) const override
+    DurationForwardRange GetUncompressedForwardDurations(const EdgeID /*geomID*/) const override
     {
         return {};
     }
 
-    std::vector<EdgeWeight> GetUncompressedReverseDurations(const EdgeID /*geomID*/) const override
+    DurationReverseRange GetUncompressedReverseDurations(const EdgeID id) const override
     {
-        return {};
+        return DurationReverseRange(GetUncompressedForwardDurations(id));
     }
 
-    std::vector<DatasourceID> GetUncompressedForwardDatasources(const EdgeID /*id*/) const override
+    DatasourceForwardRange GetUncompressedForwardDatasources(const EdgeID /*id*/) const override
     {
         return {};
     }
 
-    std::vector<DatasourceID> GetUncompressedReverseDatasources(const EdgeID /*id*/) const override
+    DatasourceReverseRange GetUncompressedReverseDatasources(const EdgeID id) const override
     {
-        return {};
+        return DatasourceReverseRange(GetUncompressedForwardDatasources(id));
     }
 
     StringView GetDatasourceName(const DatasourceID /*id*/) const override { return StringView{}; }
@@ -219,58 +235,64 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
         return {};
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate /*input_coordinate*/,
-                               const float /*max_distance*/,
-                               const int /*bearing*/,
-                               const int /*bearing_range*/,
-                               const Approach /*approach*/) const override
+    std::vector<SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate /*input_coordinate*/,
+                             const float /*max_distance*/,
+                             const int /*bearing*/,
+                             const int /*bearing_range*/,
+                             const Approach /*approach*/) const override
+    {
+        return {};
+    }
+
+    std::vector<SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate /*input_coordinate*/,
+                             const float /*max_distance*/,
+                             const Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate /*input_coordinate*/,
-                               const float /*max_distance*/,
-                               const Approach /*approach*/) const override
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate /*input_coordinate*/,
+                      const unsigned /*max_results*/,
+                      const double /*max_distance*/,
+                      const int /*bearing*/,
+                      const int /*bearing_range*/,
+                      const Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate /*input_coordinate*/,
-                        const unsigned /*max_results*/,
-                        const double /*max_distance*/,
-                        const int /*bearing*/,
-                        const int /*bearing_range*/,
-                        const Approach /*approach*/) const override
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate /*input_coordinate*/,
+                      const unsigned /*max_results*/,
+                      const int /*bearing*/,
+                      const int /*bearing_range*/,
+                      const Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate /*input_coordinate*/,
-                        const unsigned /*max_results*/,
-                        const int /*bearing*/,
-                        const int /*bearing_range*/,
-                        const Approach /*approach*/) const override
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate /*input_coordinate*/,
+                      const unsigned /*max_results*/,
+                      const Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate /*input_coordinate*/,
-                        const unsigned /*max_results*/,
-                        const Approach /*approach*/) const override
+    std::vector<SegmentCandidate>
+    NearestCandidates(const util::Coordinate /*input_coordinate*/,
+                      const unsigned /*max_results*/,
+                      const double /*max_distance*/,
+                      const Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate /*input_coordinate*/,
-                        const unsigned /*max_results*/,
-                        const double /*max_distance*/,
-                        const Approach /*approach*/) const override
+    PhantomNodeWithDistance MakePhantomNode(const util::Coordinate /*input_coordinate*/,
+                                            const SegmentCandidate & /*candidate*/) const override
     {
         return {};
     }
@@ -357,6 +379,8 @@ class ContiguousInternalMemoryDataFacade<routing_algorithms::offline::Algorithm>
         return {};
     }
 
+    osrm::extractor::ClassData GetExcludedClasses() const override { return 0; }
+
     util::guidance::EntryClass GetEntryClass(const EdgeID /*turn_id*/) const override { return {}; }
     bool IsLeftHandDriving() const override { return false; }
 };
@@ -420,8 +444,8 @@ BOOST_AUTO_TEST_CASE(shortest_path)
     std::vector<osrm::engine::PhantomNodes> phantom_nodes;
     phantom_nodes.push_back({osrm::engine::PhantomNode{}, osrm::engine::PhantomNode{}});
 
-    auto route =
-        osrm::engine::routing_algorithms::shortestPathSearch(heaps, facade, phantom_nodes, false);
+    auto route = osrm::engine::routing_algorithms::shortestPathSearch(
+        heaps, facade, phantom_nodes, false, false);
 
     BOOST_CHECK_EQUAL(route.shortest_path_weight, INVALID_EDGE_WEIGHT);
 }
@@ -46,4 +46,44 @@ BOOST_AUTO_TEST_CASE(polyline6_test_case)
         decodePolyline<1000000>(encodePolyline<1000000>(coords.begin(), coords.end())).begin()));
 }
 
+BOOST_AUTO_TEST_CASE(polyline_appends_to_buffers)
+{
+    using namespace osrm::engine;
+    using namespace osrm::util;
+
+    const std::vector<Coordinate> coords({{FixedLongitude{-73990171}, FixedLatitude{40714701}},
+                                          {FixedLongitude{-73991801}, FixedLatitude{40717571}},
+                                          {FixedLongitude{-73985751}, FixedLatitude{40715651}}});
+
+    std::string polyline = "polyline(";
+    encodePolyline(coords.begin(), coords.end(), polyline);
+    BOOST_CHECK_EQUAL(polyline, "polyline({aowFperbM}PdI~Jyd@");
+
+    const std::vector<Coordinate> coords_truncated(
+        {{FixedLongitude{-73990170}, FixedLatitude{40714700}},
+         {FixedLongitude{-73991800}, FixedLatitude{40717570}},
+         {FixedLongitude{-73985750}, FixedLatitude{40715650}}});
+
+    std::vector<Coordinate> decoded(1);
+    decodePolyline(polyline.data() + 9, polyline.data() + polyline.size(), decoded);
+    BOOST_CHECK_EQUAL(decoded.size(), 4);
+    BOOST_CHECK(std::equal(coords_truncated.begin(), coords_truncated.end(), decoded.begin() + 1));
+}
+
+BOOST_AUTO_TEST_CASE(polyline_large_deltas)
+{
+    using namespace osrm::engine;
+    using namespace osrm::util;
+
+    // deltas that take the longest chunk sequences in both directions
+    const std::vector<Coordinate> coords({{FixedLongitude{-179999999}, FixedLatitude{-89999999}},
+                                          {FixedLongitude{179999999}, FixedLatitude{89999999}},
+                                          {FixedLongitude{0}, FixedLatitude{0}}});
+
+    BOOST_CHECK(std::equal(
+        coords.begin(),
+        coords.end(),
+        decodePolyline<1000000>(encodePolyline<1000000>(coords.begin(), coords.end())).begin()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
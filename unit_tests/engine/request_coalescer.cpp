@@ -0,0 +1,168 @@
+#include "engine/request_coalescer.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(request_coalescer)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+BOOST_AUTO_TEST_CASE(identical_requests_share_one_computation)
+{
+    RequestCoalescer<std::string> coalescer;
+    const auto dataset = std::make_shared<int>(0);
+    const auto key = coalescer.MakeKey(dataset, "route");
+
+    std::atomic<bool> computing{false};
+    std::atomic<int> computations{0};
+    const auto compute = [&](std::string &result) {
+        ++computations;
+        computing = true;
+        // keeps the computation in flight until all other requests wait for it
+        while (coalescer.GetCoalesced() < 3)
+        {
+            std::this_thread::yield();
+        }
+        result = "shared";
+        return Status::Ok;
+    };
+
+    std::vector<std::string> results(4);
+    std::vector<Status> statuses(4, Status::Error);
+    std::vector<std::thread> threads;
+    threads.emplace_back([&] { statuses[0] = coalescer.Run(key, results[0], compute); });
+    while (!computing)
+    {
+        std::this_thread::yield();
+    }
+    for (std::size_t index = 1; index < results.size(); ++index)
+    {
+        threads.emplace_back([&, index] {
+            statuses[index] =
+                coalescer.Run(coalescer.MakeKey(dataset, "route"), results[index], compute);
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(computations, 1);
+    BOOST_CHECK_EQUAL(coalescer.GetCoalesced(), 3);
+    for (std::size_t index = 0; index < results.size(); ++index)
+    {
+        BOOST_CHECK(statuses[index] == Status::Ok);
+        BOOST_CHECK_EQUAL(results[index], "shared");
+    }
+
+    // nothing is kept once the computation finished
+    std::string result;
+    coalescer.Run(key, result, compute);
+    BOOST_CHECK_EQUAL(computations, 2);
+}
+
+BOOST_AUTO_TEST_CASE(keyed_by_request_and_dataset)
+{
+    RequestCoalescer<std::string> coalescer;
+    const auto first_dataset = std::make_shared<int>(0);
+    const auto second_dataset = std::make_shared<int>(1);
+
+    const auto first = coalescer.MakeKey(first_dataset, "route");
+    BOOST_CHECK(first == coalescer.MakeKey(first_dataset, "route"));
+    BOOST_CHECK(!(first == coalescer.MakeKey(first_dataset, "tile")));
+    BOOST_CHECK(!(first == coalescer.MakeKey(second_dataset, "route")));
+
+    // a request arriving while another one with a different key computes does not wait
+    std::string outer_result, inner_result;
+    coalescer.Run(first, outer_result, [&](std::string &result) {
+        coalescer.Run(coalescer.MakeKey(first_dataset, "tile"),
+                      inner_result,
+                      [](std::string &inner) {
+                          inner = "tile";
+                          return Status::Ok;
+                      });
+        result = "route";
+        return Status::Error;
+    });
+    BOOST_CHECK_EQUAL(outer_result, "route");
+    BOOST_CHECK_EQUAL(inner_result, "tile");
+    BOOST_CHECK_EQUAL(coalescer.GetCoalesced(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(exceptions_reach_waiting_requests)
+{
+    RequestCoalescer<std::string> coalescer;
+    const auto key = coalescer.MakeKey(std::make_shared<int>(0), "route");
+
+    std::atomic<bool> computing{false};
+    const auto compute = [&](std::string &) -> Status {
+        computing = true;
+        while (coalescer.GetCoalesced() < 1)
+        {
+            std::this_thread::yield();
+        }
+        throw std::runtime_error("aborted");
+    };
+
+    std::string leader_result, follower_result;
+    bool leader_threw = false;
+    std::thread leader([&] {
+        try
+        {
+            coalescer.Run(key, leader_result, compute);
+        }
+        catch (const std::runtime_error &)
+        {
+            leader_threw = true;
+        }
+    });
+    while (!computing)
+    {
+        std::this_thread::yield();
+    }
+    BOOST_CHECK_THROW(coalescer.Run(key, follower_result, compute), std::runtime_error);
+    leader.join();
+    BOOST_CHECK(leader_threw);
+}
+
+BOOST_AUTO_TEST_CASE(encodes_every_parameter)
+{
+    api::RouteParameters parameters;
+    parameters.coordinates = {{util::FloatLongitude{7.41}, util::FloatLatitude{43.73}},
+                              {util::FloatLongitude{7.42}, util::FloatLatitude{43.74}}};
+    const auto encoded = EncodeRequest(parameters);
+    BOOST_CHECK_EQUAL(encoded, EncodeRequest(parameters));
+
+    auto binary = parameters;
+    binary.output_format = api::BaseParameters::OutputFormatType::Binary;
+    BOOST_CHECK_EQUAL(encoded, EncodeRequest(binary));
+
+    auto steps = parameters;
+    steps.steps = true;
+    BOOST_CHECK_NE(encoded, EncodeRequest(steps));
+
+    auto radiuses = parameters;
+    radiuses.radiuses = {boost::none, 10.};
+    auto other_radiuses = parameters;
+    other_radiuses.radiuses = {10., boost::none};
+    BOOST_CHECK_NE(EncodeRequest(radiuses), EncodeRequest(other_radiuses));
+
+    auto continue_straight = parameters;
+    continue_straight.continue_straight = false;
+    BOOST_CHECK_NE(encoded, EncodeRequest(continue_straight));
+
+    auto timeout = parameters;
+    timeout.timeout = std::chrono::milliseconds{100};
+    BOOST_CHECK_NE(encoded, EncodeRequest(timeout));
+
+    BOOST_CHECK_NE(EncodeRequest(api::TileParameters{1, 2, 12}),
+                   EncodeRequest(api::TileParameters{2, 1, 12}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,118 @@
+#include "engine/search_trace.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(search_trace)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+using Tracing = SearchTracePolicy<true>;
+
+BOOST_AUTO_TEST_CASE(counts_into_the_installed_trace)
+{
+    // nothing is counted without a trace
+    Tracing::Settled(10);
+    Tracing::Relaxed();
+
+    SearchTrace trace;
+    {
+        Tracing::Scope scope(&trace);
+        Tracing::Settled(3);
+        Tracing::Settled(7);
+        Tracing::Settled(5);
+        Tracing::Relaxed();
+        Tracing::Relaxed();
+        Tracing::Stalled();
+        Tracing::CellCrossed(2);
+        Tracing::CellCrossed(2);
+        Tracing::CellCrossed(1);
+
+        SearchTrace nested;
+        {
+            Tracing::Scope nested_scope(&nested);
+            Tracing::Relaxed();
+        }
+        BOOST_CHECK_EQUAL(nested.relaxed_edges, 1);
+        Tracing::Relaxed();
+    }
+    BOOST_CHECK(Tracing::Current() == nullptr);
+
+    BOOST_CHECK_EQUAL(trace.settled_nodes, 3);
+    BOOST_CHECK_EQUAL(trace.max_heap_size, 7);
+    BOOST_CHECK_EQUAL(trace.relaxed_edges, 3);
+    BOOST_CHECK_EQUAL(trace.stalled_nodes, 1);
+    BOOST_CHECK_EQUAL(trace.cells_crossed[1], 1);
+    BOOST_CHECK_EQUAL(trace.cells_crossed[2], 2);
+
+    const auto json = trace.ToJSON();
+    const auto &cells = json.values.at("cells_crossed").get<util::json::Array>().values;
+    BOOST_REQUIRE_EQUAL(cells.size(), 2);
+    BOOST_CHECK_EQUAL(cells[0].get<util::json::Number>().value, 1.);
+    BOOST_CHECK_EQUAL(cells[1].get<util::json::Number>().value, 2.);
+    BOOST_CHECK_EQUAL(json.values.at("settled_nodes").get<util::json::Number>().value, 3.);
+}
+
+BOOST_AUTO_TEST_CASE(workers_add_to_the_request_trace)
+{
+    SearchTrace trace;
+    Tracing::Scope scope(&trace);
+
+    const auto parent = Tracing::Current();
+    std::vector<std::thread> workers;
+    for (auto worker = 0; worker < 4; ++worker)
+    {
+        workers.emplace_back([parent] {
+            Tracing::WorkerScope worker_scope(parent);
+            for (auto node = 0; node < 1000; ++node)
+                Tracing::Settled(node);
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    BOOST_CHECK_EQUAL(trace.settled_nodes, 4000);
+    BOOST_CHECK_EQUAL(trace.max_heap_size, 999);
+}
+
+BOOST_AUTO_TEST_CASE(nested_unpacking_is_timed_once)
+{
+    SearchTrace trace;
+    Tracing::Scope scope(&trace);
+    {
+        Tracing::UnpackingTimer outer;
+        {
+            Tracing::UnpackingTimer inner;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    BOOST_CHECK(trace.unpacking_time >= std::chrono::milliseconds(4));
+    BOOST_CHECK(trace.unpacking_time < std::chrono::milliseconds(1000));
+}
+
+BOOST_AUTO_TEST_CASE(totals)
+{
+    SearchTrace first;
+    first.settled_nodes = 10;
+    first.max_heap_size = 4;
+    SearchTrace second;
+    second.settled_nodes = 5;
+    second.max_heap_size = 8;
+    second.unpacking_time = std::chrono::milliseconds(3);
+
+    SearchTraceTotals totals;
+    totals.Add(first);
+    totals.Add(second);
+
+    const auto statistics = totals.Get();
+    BOOST_CHECK_EQUAL(statistics.requests, 2);
+    BOOST_CHECK_EQUAL(statistics.totals.settled_nodes, 15);
+    BOOST_CHECK_EQUAL(statistics.totals.max_heap_size, 8);
+    BOOST_CHECK(statistics.totals.unpacking_time == std::chrono::milliseconds(3));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
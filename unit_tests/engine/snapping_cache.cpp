@@ -0,0 +1,82 @@
+#include "engine/snapping_cache.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+BOOST_AUTO_TEST_SUITE(snapping_cache)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+PhantomNodePair makePhantomNodes(const util::Coordinate location)
+{
+    PhantomNode phantom;
+    phantom.location = location;
+    phantom.input_location = location;
+    return std::make_pair(phantom, phantom);
+}
+
+const util::Coordinate coordinate{util::FloatLongitude{7.41}, util::FloatLatitude{43.73}};
+}
+
+BOOST_AUTO_TEST_CASE(keyed_by_snapping_parameters)
+{
+    SnappingCache cache(16);
+    const auto dataset = std::make_shared<int>(0);
+    const auto handle = cache.ForDataset(dataset);
+    BOOST_CHECK(handle);
+
+    const boost::optional<Bearing> bearing = Bearing{90, 10};
+    handle.Insert(coordinate, 5., bearing, Approach::CURB, makePhantomNodes(coordinate));
+
+    const auto cached = handle.Get(coordinate, 5., bearing, Approach::CURB);
+    BOOST_REQUIRE(cached);
+    BOOST_CHECK_EQUAL(cached->first.location, coordinate);
+
+    BOOST_CHECK(!handle.Get(coordinate, boost::none, bearing, Approach::CURB));
+    BOOST_CHECK(!handle.Get(coordinate, 5., boost::none, Approach::CURB));
+    BOOST_CHECK(!handle.Get(coordinate, 5., Bearing{90, 20}, Approach::CURB));
+    BOOST_CHECK(!handle.Get(coordinate, 5., bearing, Approach::UNRESTRICTED));
+
+    const util::Coordinate other{util::FloatLongitude{7.410001}, util::FloatLatitude{43.73}};
+    BOOST_CHECK(!handle.Get(other, 5., bearing, Approach::CURB));
+
+    const auto statistics = cache.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.hits, 1);
+    BOOST_CHECK_EQUAL(statistics.misses, 5);
+    BOOST_CHECK_EQUAL(statistics.entries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(dropped_on_new_dataset)
+{
+    SnappingCache cache(16);
+    const auto first_dataset = std::make_shared<int>(0);
+    const auto second_dataset = std::make_shared<int>(1);
+
+    const auto first = cache.ForDataset(first_dataset);
+    first.Insert(coordinate,
+                 boost::none,
+                 boost::none,
+                 Approach::UNRESTRICTED,
+                 makePhantomNodes(coordinate));
+    BOOST_CHECK(cache.ForDataset(first_dataset)
+                    .Get(coordinate, boost::none, boost::none, Approach::UNRESTRICTED));
+
+    const auto second = cache.ForDataset(second_dataset);
+    BOOST_CHECK_EQUAL(cache.GetStatistics().entries, 0);
+    BOOST_CHECK(!second.Get(coordinate, boost::none, boost::none, Approach::UNRESTRICTED));
+
+    // a query still running on the first dataset never fills the cache of the second
+    first.Insert(coordinate,
+                 boost::none,
+                 boost::none,
+                 Approach::UNRESTRICTED,
+                 makePhantomNodes(coordinate));
+    BOOST_CHECK(!second.Get(coordinate, boost::none, boost::none, Approach::UNRESTRICTED));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+#include "engine/tile_cache.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(tile_cache)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+struct TemporaryDirectory
+{
+    TemporaryDirectory()
+        : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path())
+    {
+    }
+
+    ~TemporaryDirectory() { boost::filesystem::remove_all(path); }
+
+    boost::filesystem::path path;
+};
+}
+
+BOOST_AUTO_TEST_CASE(keyed_by_tile_and_dataset)
+{
+    TileCache cache(16, "");
+    const auto first_dataset = std::make_shared<int>(0);
+    const auto second_dataset = std::make_shared<int>(1);
+    const api::TileParameters tile{8586, 5927, 14};
+
+    const auto key = cache.MakeKey(first_dataset, tile);
+    BOOST_CHECK(!cache.Get(key, "2017-10-10"));
+    cache.Insert(key, "2017-10-10", "tile");
+
+    const auto cached = cache.Get(cache.MakeKey(first_dataset, tile), "2017-10-10");
+    BOOST_REQUIRE(cached);
+    BOOST_CHECK_EQUAL(*cached, "tile");
+    BOOST_CHECK(!cache.Get(cache.MakeKey(first_dataset, {8586, 5928, 14}), "2017-10-10"));
+
+    // a new dataset drops the cached tiles
+    BOOST_CHECK(!cache.Get(cache.MakeKey(second_dataset, tile), "2017-10-10"));
+    BOOST_CHECK(!cache.Get(cache.MakeKey(first_dataset, tile), "2017-10-10"));
+
+    const auto statistics = cache.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.hits, 1);
+    BOOST_CHECK_EQUAL(statistics.misses, 4);
+    BOOST_CHECK_EQUAL(statistics.capacity, 16);
+}
+
+BOOST_AUTO_TEST_CASE(tiles_on_disk_outlive_the_cache)
+{
+    TemporaryDirectory directory;
+    const api::TileParameters tile{8586, 5927, 14};
+    {
+        TileCache cache(0, directory.path);
+        cache.Insert(cache.MakeKey(std::make_shared<int>(0), tile), "2017-10-10", "tile");
+        BOOST_CHECK_EQUAL(cache.GetStatistics().capacity, 0);
+    }
+    BOOST_CHECK(boost::filesystem::exists(directory.path / "2017-10-10/14/8586/5927.mvt"));
+
+    TileCache cache(16, directory.path);
+    const auto dataset = std::make_shared<int>(0);
+    const auto cached = cache.Get(cache.MakeKey(dataset, tile), "2017-10-10");
+    BOOST_REQUIRE(cached);
+    BOOST_CHECK_EQUAL(*cached, "tile");
+
+    // tiles read from disk are kept in memory
+    BOOST_CHECK_EQUAL(cache.GetStatistics().entries, 1);
+
+    // a dataset with another timestamp has none of them
+    BOOST_CHECK(!cache.Get(cache.MakeKey(std::make_shared<int>(1), tile), "2017-10-11"));
+}
+
+BOOST_AUTO_TEST_CASE(tile_paths_stay_below_directory)
+{
+    const api::TileParameters tile{1, 2, 12};
+    BOOST_CHECK_EQUAL(TileCache::GetTilePath("tiles", "2017-10-10T12:00:00Z", tile),
+                      boost::filesystem::path("tiles/2017-10-10T12_00_00Z/12/1/2.mvt"));
+    BOOST_CHECK_EQUAL(TileCache::GetTilePath("tiles", "../..", tile),
+                      boost::filesystem::path("tiles/_____/12/1/2.mvt"));
+    BOOST_CHECK_EQUAL(TileCache::GetTilePath("tiles", "", tile),
+                      boost::filesystem::path("tiles/_/12/1/2.mvt"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
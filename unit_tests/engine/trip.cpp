@@ -0,0 +1,191 @@
+#include "engine/trip/trip_brute_force.hpp"
+#include "engine/trip/trip_farthest_insertion.hpp"
+#include "engine/trip/trip_held_karp.hpp"
+#include "engine/trip/trip_local_search.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(trip_test)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+// an asymmetric table of random weights
+util::DistTableWrapper<EdgeWeight> randomTable(const std::size_t number_of_locations,
+                                               std::mt19937 &generator,
+                                               const EdgeWeight max_weight = 1000)
+{
+    std::uniform_int_distribution<EdgeWeight> weights(1, max_weight);
+    std::vector<EdgeWeight> table(number_of_locations * number_of_locations, 0);
+    for (std::size_t from = 0; from < number_of_locations; ++from)
+    {
+        for (std::size_t to = 0; to < number_of_locations; ++to)
+        {
+            if (from != to)
+                table[from * number_of_locations + to] = weights(generator);
+        }
+    }
+    return util::DistTableWrapper<EdgeWeight>(std::move(table), number_of_locations);
+}
+
+std::int64_t tripCost(const util::DistTableWrapper<EdgeWeight> &table,
+                      const std::vector<NodeID> &trip)
+{
+    std::int64_t cost = 0;
+    for (std::size_t index = 0; index < trip.size(); ++index)
+    {
+        cost += table(trip[index], trip[(index + 1) % trip.size()]);
+    }
+    return cost;
+}
+
+// farthest insertion that scans the whole trip for every location in every step
+std::vector<NodeID> scanningFarthestInsertion(const util::DistTableWrapper<EdgeWeight> &table)
+{
+    const auto number_of_locations = table.GetNumberOfNodes();
+    const auto farthest = std::distance(table.begin(),
+                                        std::max_element(table.begin() + 1, table.end()));
+    std::vector<NodeID> route = {static_cast<NodeID>(farthest / number_of_locations),
+                                 static_cast<NodeID>(farthest % number_of_locations)};
+    std::vector<bool> visited(number_of_locations, false);
+    visited[route[0]] = visited[route[1]] = true;
+    while (route.size() < number_of_locations)
+    {
+        EdgeWeight farthest_cost = std::numeric_limits<EdgeWeight>::min();
+        NodeID next_node = SPECIAL_NODEID;
+        std::size_t next_position = 0;
+        for (NodeID id = 0; id < number_of_locations; ++id)
+        {
+            if (visited[id])
+                continue;
+            EdgeWeight cost = INVALID_EDGE_WEIGHT;
+            std::size_t position = 0;
+            for (std::size_t index = 0; index < route.size(); ++index)
+            {
+                const auto to = (index + 1) % route.size();
+                const auto insertion =
+                    table(route[index], id) + table(id, route[to]) - table(route[index], route[to]);
+                if (insertion < cost)
+                {
+                    cost = insertion;
+                    position = to;
+                }
+            }
+            if (cost > farthest_cost)
+            {
+                farthest_cost = cost;
+                next_node = id;
+                next_position = position;
+            }
+        }
+        visited[next_node] = true;
+        route.insert(route.begin() + next_position, next_node);
+    }
+    return route;
+}
+
+bool isPermutation(const std::vector<NodeID> &trip)
+{
+    auto sorted = trip;
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t index = 0; index < sorted.size(); ++index)
+    {
+        if (sorted[index] != index)
+            return false;
+    }
+    return true;
+}
+}
+
+BOOST_AUTO_TEST_CASE(held_karp_matches_brute_force)
+{
+    std::mt19937 generator(42);
+    for (std::size_t number_of_locations = 1; number_of_locations < 9; ++number_of_locations)
+    {
+        for (int repetition = 0; repetition < 5; ++repetition)
+        {
+            const auto table = randomTable(number_of_locations, generator);
+            const auto held_karp = trip::HeldKarpTrip(number_of_locations, table);
+            const auto brute_force = trip::BruteForceTrip(number_of_locations, table);
+
+            BOOST_CHECK_EQUAL(held_karp.size(), number_of_locations);
+            BOOST_CHECK(isPermutation(held_karp));
+            BOOST_CHECK_EQUAL(held_karp.front(), 0);
+            BOOST_CHECK_EQUAL(tripCost(table, held_karp), tripCost(table, brute_force));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(held_karp_avoids_invalid_weights)
+{
+    // the only round trip is 0 -> 2 -> 1 -> 3 -> 0
+    const auto I = INVALID_EDGE_WEIGHT;
+    // clang-format off
+    std::vector<EdgeWeight> table = {0, I, 1, I,
+                                     I, 0, I, 1,
+                                     I, 1, 0, I,
+                                     1, I, I, 0};
+    // clang-format on
+    const util::DistTableWrapper<EdgeWeight> wrapper(std::move(table), 4);
+
+    const auto trip = trip::HeldKarpTrip(4, wrapper);
+    const std::vector<NodeID> expected = {0, 2, 1, 3};
+    BOOST_CHECK_EQUAL_COLLECTIONS(trip.begin(), trip.end(), expected.begin(), expected.end());
+}
+
+// Updating the cheapest insertions of the locations results in the trip of full scans, also
+// with many ties
+BOOST_AUTO_TEST_CASE(farthest_insertion_matches_full_scans)
+{
+    std::mt19937 generator(42);
+    for (const EdgeWeight max_weight : {3, 1000})
+    {
+        for (const std::size_t number_of_locations : {3, 4, 10, 17, 40, 100})
+        {
+            const auto table = randomTable(number_of_locations, generator, max_weight);
+            const auto trip = trip::FarthestInsertionTrip(number_of_locations, table);
+            const auto expected = scanningFarthestInsertion(table);
+            BOOST_CHECK(isPermutation(trip));
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                trip.begin(), trip.end(), expected.begin(), expected.end());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(local_search_improves_farthest_insertion)
+{
+    std::mt19937 generator(42);
+    for (const std::size_t number_of_locations : {4, 10, 17, 40})
+    {
+        const auto table = randomTable(number_of_locations, generator);
+        const auto initial = trip::FarthestInsertionTrip(number_of_locations, table);
+        const auto improved = trip::LocalSearchTrip(initial, table);
+
+        BOOST_CHECK_EQUAL(improved.size(), number_of_locations);
+        BOOST_CHECK(isPermutation(improved));
+        BOOST_CHECK_LE(tripCost(table, improved), tripCost(table, initial));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(local_search_finds_optimum_of_small_trips)
+{
+    // no 2-opt or Or-opt move improves the optimal trip
+    std::mt19937 generator(7);
+    const std::size_t number_of_locations = 12;
+    const auto table = randomTable(number_of_locations, generator);
+    const auto optimal = trip::HeldKarpTrip(number_of_locations, table);
+    const auto improved = trip::LocalSearchTrip(optimal, table);
+    BOOST_CHECK_EQUAL(tripCost(table, improved), tripCost(table, optimal));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
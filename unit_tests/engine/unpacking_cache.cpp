@@ -0,0 +1,69 @@
+#include "engine/unpacking_cache.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+BOOST_AUTO_TEST_SUITE(unpacking_cache)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+UnpackingCache::UnpackedShortcutPtr makeShortcut(const NodeID target)
+{
+    return std::make_shared<const UnpackingCache::UnpackedShortcut>(
+        UnpackingCache::UnpackedShortcut{{target - 1, 10}, {target, 11}});
+}
+}
+
+BOOST_AUTO_TEST_CASE(keyed_by_shortcut_and_direction)
+{
+    UnpackingCache cache(16);
+    const auto dataset = std::make_shared<int>(0);
+    const auto handle = cache.ForDataset(dataset);
+    BOOST_CHECK(handle);
+    BOOST_CHECK(!UnpackingCache::Handle{});
+
+    handle.Insert(3, false, makeShortcut(5));
+    handle.Insert(3, true, makeShortcut(8));
+
+    const auto forward = handle.Get(3, false);
+    BOOST_REQUIRE(forward);
+    BOOST_CHECK_EQUAL(forward->back().first, 5);
+    BOOST_CHECK_EQUAL(forward->back().second, 11);
+
+    const auto reversed = handle.Get(3, true);
+    BOOST_REQUIRE(reversed);
+    BOOST_CHECK_EQUAL(reversed->back().first, 8);
+
+    BOOST_CHECK(!handle.Get(4, false));
+
+    const auto statistics = cache.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.hits, 2);
+    BOOST_CHECK_EQUAL(statistics.misses, 1);
+    BOOST_CHECK_EQUAL(statistics.entries, 2);
+}
+
+BOOST_AUTO_TEST_CASE(dropped_on_new_dataset)
+{
+    UnpackingCache cache(16);
+    const auto first_dataset = std::make_shared<int>(0);
+    const auto second_dataset = std::make_shared<int>(1);
+
+    const auto first = cache.ForDataset(first_dataset);
+    first.Insert(3, false, makeShortcut(5));
+    BOOST_CHECK(cache.ForDataset(first_dataset).Get(3, false));
+
+    const auto second = cache.ForDataset(second_dataset);
+    BOOST_CHECK_EQUAL(cache.GetStatistics().entries, 0);
+    BOOST_CHECK(!second.Get(3, false));
+
+    // a query still running on the first dataset never fills the cache of the second
+    first.Insert(3, false, makeShortcut(5));
+    BOOST_CHECK(!second.Get(3, false));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
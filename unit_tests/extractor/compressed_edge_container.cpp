@@ -87,4 +87,48 @@ BOOST_AUTO_TEST_CASE(t_crossing)
     BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(2), 3);
 }
 
+BOOST_AUTO_TEST_CASE(bucket_segments)
+{
+    //   0   1   2   3   4
+    // 0---1---2---3---4---5
+    CompressedEdgeContainer container;
+
+    // compress 3---4---5 to 3---5, with a penalty at 4
+    container.CompressEdge(3, 4, 4, 5, 3, 4, 30, 40, 7, 70);
+    // compress 0---1---2 to 0---2
+    container.CompressEdge(0, 1, 1, 2, 1, 2, 10, 20);
+    // compress 0---2---3 to 0---3
+    container.CompressEdge(0, 2, 2, 3, 3, 5, 30, 50);
+    // compress 0---3---5 to 0---5, moves the segments of 0 into a larger chunk
+    container.CompressEdge(0, 3, 3, 5, 8, 14, 80, 140);
+    container.AddUncompressedEdge(6, 7, 5, 50);
+    container.AddUncompressedEdge(0, 7, 5, 50);
+
+    BOOST_CHECK(container.HasEntryForID(0));
+    BOOST_CHECK(!container.HasEntryForID(2));
+    BOOST_CHECK(!container.HasEntryForID(3));
+    BOOST_CHECK(container.HasEntryForID(6));
+    BOOST_CHECK(container.IsTrivial(6));
+    BOOST_CHECK(!container.HasEntryForID(1000));
+
+    const auto bucket = container.GetBucketReference(0);
+    const std::vector<NodeID> nodes = {1, 2, 3, 4, 4, 5};
+    const std::vector<SegmentWeight> weights = {1, 2, 5, 3, 7, 4};
+    const std::vector<SegmentDuration> durations = {10, 20, 50, 30, 70, 40};
+    BOOST_REQUIRE_EQUAL(bucket.size(), nodes.size());
+    for (std::size_t index = 0; index < bucket.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(bucket[index].node_id, nodes[index]);
+        BOOST_CHECK_EQUAL(bucket[index].weight, weights[index]);
+        BOOST_CHECK_EQUAL(bucket[index].duration, durations[index]);
+    }
+    BOOST_CHECK_EQUAL(bucket.rbegin()->node_id, 5);
+    BOOST_CHECK_EQUAL(std::distance(bucket.begin(), bucket.end()), 6);
+    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(0), 4);
+
+    // weights that don't fit into the packed storage are clipped
+    container.AddUncompressedEdge(8, 9, INVALID_SEGMENT_WEIGHT, 10);
+    BOOST_CHECK_EQUAL(container.GetBucketReference(8).front().weight, MAX_SEGMENT_WEIGHT);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
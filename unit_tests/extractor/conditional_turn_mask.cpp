@@ -0,0 +1,63 @@
+#include "extractor/conditional_turn_mask.hpp"
+#include "util/opening_hours.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(conditional_turn_mask)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+std::uint32_t
+minuteOfWeek(const std::uint32_t weekday, const std::uint32_t hour, const std::uint32_t minute)
+{
+    return (weekday * 24 + hour) * 60 + minute;
+}
+}
+
+BOOST_AUTO_TEST_CASE(weekday_and_time_ranges)
+{
+    ConditionalTurnMask mask;
+    BOOST_REQUIRE(compileConditionalTurnMask(util::ParseOpeningHours("Mo-Fr 07:00-09:30"), mask));
+
+    BOOST_CHECK(!mask.IsActive(minuteOfWeek(0, 8, 0)));
+    BOOST_CHECK(!mask.IsActive(minuteOfWeek(1, 6, 59)));
+    BOOST_CHECK(mask.IsActive(minuteOfWeek(1, 7, 0)));
+    BOOST_CHECK(mask.IsActive(minuteOfWeek(5, 9, 29)));
+    BOOST_CHECK(!mask.IsActive(minuteOfWeek(5, 9, 30)));
+    BOOST_CHECK(!mask.IsActive(minuteOfWeek(6, 8, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(overnight_ranges)
+{
+    ConditionalTurnMask mask;
+    BOOST_REQUIRE(compileConditionalTurnMask(util::ParseOpeningHours("Sa 22:00-02:00"), mask));
+
+    BOOST_CHECK(!mask.IsActive(minuteOfWeek(6, 21, 45)));
+    BOOST_CHECK(mask.IsActive(minuteOfWeek(6, 23, 0)));
+    // the week wraps around to Sunday
+    BOOST_CHECK(mask.IsActive(minuteOfWeek(0, 1, 45)));
+    BOOST_CHECK(!mask.IsActive(minuteOfWeek(0, 2, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(minute_of_week)
+{
+    BOOST_CHECK_EQUAL(ConditionalTurnMask::MinuteOfWeek(0), minuteOfWeek(4, 0, 0));
+    // Monday, 16 October 2017 08:30:59 UTC
+    BOOST_CHECK_EQUAL(ConditionalTurnMask::MinuteOfWeek(1508142659), minuteOfWeek(1, 8, 30));
+    // Saturday, 21 October 2017 23:59 UTC
+    BOOST_CHECK_EQUAL(ConditionalTurnMask::MinuteOfWeek(1508630340), minuteOfWeek(6, 23, 59));
+}
+
+BOOST_AUTO_TEST_CASE(date_ranges)
+{
+    // a weekly mask can't express dates
+    ConditionalTurnMask mask;
+    const auto conditions = util::ParseOpeningHours("Dec 24-26 08:00-12:00");
+    BOOST_REQUIRE(!conditions.empty());
+    BOOST_CHECK(!compileConditionalTurnMask(conditions, mask));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -149,6 +149,67 @@ BOOST_AUTO_TEST_CASE(loop_test)
     BOOST_CHECK(graph.FindEdge(4, 5) != SPECIAL_EDGEID);
 }
 
+BOOST_AUTO_TEST_CASE(parallel_chains)
+{
+    //
+    //     1---2
+    //    /     \
+    // 6-0       5-7
+    //    \     /
+    //     3---4
+    //
+    GraphCompressor compressor;
+
+    std::unordered_set<NodeID> barrier_nodes;
+    std::unordered_set<NodeID> traffic_lights;
+    std::vector<TurnRestriction> restrictions;
+    std::vector<ConditionalTurnRestriction> conditional_restrictions;
+    CompressedEdgeContainer container;
+    test::MockScriptingEnvironment scripting_environment;
+
+    std::vector<InputEdge> edges = {MakeUnitEdge(0, 1),
+                                    MakeUnitEdge(0, 3),
+                                    MakeUnitEdge(0, 6),
+                                    MakeUnitEdge(1, 0),
+                                    MakeUnitEdge(1, 2),
+                                    MakeUnitEdge(2, 1),
+                                    MakeUnitEdge(2, 5),
+                                    MakeUnitEdge(3, 0),
+                                    MakeUnitEdge(3, 4),
+                                    MakeUnitEdge(4, 3),
+                                    MakeUnitEdge(4, 5),
+                                    MakeUnitEdge(5, 2),
+                                    MakeUnitEdge(5, 4),
+                                    MakeUnitEdge(5, 7),
+                                    MakeUnitEdge(6, 0),
+                                    MakeUnitEdge(7, 5)};
+
+    Graph graph(8, edges);
+    compressor.Compress(barrier_nodes,
+                        traffic_lights,
+                        scripting_environment,
+                        restrictions,
+                        conditional_restrictions,
+                        graph,
+                        container);
+
+    // the upper chain joins 0 and 5 first, so the last node of the lower chain has to stay
+    BOOST_CHECK_EQUAL(graph.FindEdge(0, 1), SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(graph.FindEdge(0, 3), SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(1), 0);
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(2), 0);
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(3), 0);
+    BOOST_CHECK(graph.FindEdge(0, 5) != SPECIAL_EDGEID);
+    BOOST_CHECK(graph.FindEdge(5, 0) != SPECIAL_EDGEID);
+    BOOST_CHECK(graph.FindEdge(0, 4) != SPECIAL_EDGEID);
+    BOOST_CHECK(graph.FindEdge(4, 5) != SPECIAL_EDGEID);
+
+    const auto upper_edge = graph.FindEdge(0, 5);
+    BOOST_CHECK(container.HasEntryForID(upper_edge));
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(upper_edge).weight, 3);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(0, 4)).weight, 2);
+}
+
 BOOST_AUTO_TEST_CASE(t_intersection)
 {
     //
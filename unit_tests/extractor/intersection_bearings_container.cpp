@@ -0,0 +1,30 @@
+#include "extractor/intersection_bearings_container.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(intersection_bearings_container_test)
+
+using namespace osrm;
+using namespace osrm::extractor;
+using namespace osrm::util::guidance;
+
+BearingClass makeClass(const std::vector<DiscreteBearing> &bearings)
+{
+    return BearingClass(bearings.begin(), bearings.end());
+}
+
+BOOST_AUTO_TEST_CASE(bearings_of_nodes)
+{
+    const std::vector<BearingClass> classes = {
+        makeClass({0, 90, 180, 270}), makeClass({}), makeClass({13, 257})};
+    const IntersectionBearingsContainer container({2, 0, 1, 2}, classes);
+
+    BOOST_CHECK(container.GetBearingClass(0) == classes[2]);
+    BOOST_CHECK(container.GetBearingClass(1) == classes[0]);
+    BOOST_CHECK(container.GetBearingClass(2).getAvailableBearings().empty());
+    BOOST_CHECK(container.GetBearingClass(3) == classes[2]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
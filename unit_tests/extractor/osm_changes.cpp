@@ -0,0 +1,98 @@
+#include "extractor/osm_changes.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(osm_changes)
+
+using namespace osrm;
+using namespace osrm::extractor;
+using namespace osmium::builder::attr;
+
+namespace
+{
+osmium::memory::Buffer makeBuffer()
+{
+    return osmium::memory::Buffer(1024, osmium::memory::Buffer::auto_grow::yes);
+}
+
+// type and id of every object, with the name tag of the ways
+std::vector<std::string> describe(const osmium::memory::Buffer &buffer)
+{
+    std::vector<std::string> objects;
+    for (const auto &object : buffer.select<osmium::OSMObject>())
+    {
+        auto description = osmium::item_type_to_char(object.type()) + std::to_string(object.id());
+        if (const auto name = object.tags().get_value_by_key("name"))
+        {
+            description += std::string("=") + name;
+        }
+        objects.push_back(description);
+    }
+    return objects;
+}
+}
+
+BOOST_AUTO_TEST_CASE(apply_changes)
+{
+    auto input = makeBuffer();
+    osmium::builder::add_node(input, _id(1), _version(1));
+    osmium::builder::add_node(input, _id(2), _version(1));
+    osmium::builder::add_node(input, _id(4), _version(1));
+    auto ways = makeBuffer();
+    osmium::builder::add_way(ways, _id(10), _version(1), _tag("name", "old"));
+    osmium::builder::add_way(ways, _id(11), _version(1), _tag("name", "kept"));
+
+    auto change_objects = makeBuffer();
+    // deleted, created in between, created after the last node and changed twice
+    osmium::builder::add_node(change_objects, _id(2), _version(2), _deleted());
+    osmium::builder::add_node(change_objects, _id(3), _version(1));
+    osmium::builder::add_node(change_objects, _id(5), _version(1));
+    osmium::builder::add_way(change_objects, _id(10), _version(2), _tag("name", "first"));
+    osmium::builder::add_way(change_objects, _id(10), _version(3), _tag("name", "new"));
+    osmium::builder::add_way(change_objects, _id(12), _version(1), _tag("name", "created"));
+
+    OSMChanges changes(std::move(change_objects));
+    BOOST_CHECK_EQUAL(changes.NumberOfChanges(), 5);
+
+    const auto nodes = describe(changes.Apply(std::move(input)));
+    const std::vector<std::string> expected_nodes{"n1", "n3", "n4"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        nodes.begin(), nodes.end(), expected_nodes.begin(), expected_nodes.end());
+
+    // the node created after the last node of the input comes before the first way
+    const auto applied_ways = describe(changes.Apply(std::move(ways)));
+    const std::vector<std::string> expected_ways{"n5", "w10=new", "w11=kept"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        applied_ways.begin(), applied_ways.end(), expected_ways.begin(), expected_ways.end());
+
+    const auto remaining = describe(changes.Remaining());
+    const std::vector<std::string> expected_remaining{"w12=created"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(remaining.begin(),
+                                  remaining.end(),
+                                  expected_remaining.begin(),
+                                  expected_remaining.end());
+}
+
+BOOST_AUTO_TEST_CASE(unchanged_buffer)
+{
+    auto input = makeBuffer();
+    osmium::builder::add_node(input, _id(1), _version(1));
+    const auto data = input.data();
+
+    auto change_objects = makeBuffer();
+    osmium::builder::add_way(change_objects, _id(10), _version(2));
+    OSMChanges changes(std::move(change_objects));
+
+    // no change up to the last object, the buffer is not copied
+    const auto result = changes.Apply(std::move(input));
+    BOOST_CHECK(result.data() == data);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -79,4 +79,39 @@ BOOST_AUTO_TEST_CASE(raster_test)
         util::exception);
 }
 
+BOOST_AUTO_TEST_CASE(binary_raster_test)
+{
+    const RasterGrid ascii_grid{OSRM_FIXTURES_DIR "/raster_data.asc", 10, 10};
+
+    // tiles that do not divide the raster are padded
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("osrm-raster-%%%%-%%%%.bin");
+    writeRasterFile(path, ascii_grid, 4);
+    BOOST_CHECK(isRasterFile(path));
+    BOOST_CHECK(!isRasterFile(OSRM_FIXTURES_DIR "/raster_data.asc"));
+
+    {
+        const RasterGrid binary_grid{path};
+        BOOST_CHECK_EQUAL(binary_grid.Width(), 10);
+        BOOST_CHECK_EQUAL(binary_grid.Height(), 10);
+        for (std::size_t y = 0; y < 10; ++y)
+            for (std::size_t x = 0; x < 10; ++x)
+                BOOST_CHECK_EQUAL(binary_grid(x, y), ascii_grid(x, y));
+
+        RasterContainer sources;
+        BOOST_CHECK_EQUAL(sources.LoadRasterSource(path.string(), 1, 1.09, 1, 1.09, 10, 10), 0);
+        CHECK_QUERY(0, 1.09, 1.07, 140);
+        CHECK_QUERY(0, 1.054, 1.023, 40);
+        CHECK_INTERPOLATE(0, 1.054, 1.023, 54);
+        CHECK_INTERPOLATE(0, 1.3, 23.0, RasterDatum::get_invalid());
+
+        // the size is stored in the file and has to match
+        RasterContainer other_sources;
+        BOOST_CHECK_THROW(other_sources.LoadRasterSource(path.string(), 0, 1.1, 0, 1.1, 9, 10),
+                          util::exception);
+    }
+
+    boost::filesystem::remove(path);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
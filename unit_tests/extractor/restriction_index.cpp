@@ -0,0 +1,44 @@
+#include "extractor/restriction_index.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(restriction_index)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+BOOST_AUTO_TEST_CASE(node_restrictions)
+{
+    std::vector<TurnRestriction> restrictions{TurnRestriction{NodeRestriction{3, 4, 5}},
+                                              TurnRestriction{NodeRestriction{1, 2, 3}},
+                                              TurnRestriction{NodeRestriction{3, 4, 6}},
+                                              TurnRestriction{NodeRestriction{1, 2, 4}, true}};
+    RestrictionMap restriction_map(restrictions, IndexNodeByFromAndVia());
+
+    BOOST_CHECK_EQUAL(restriction_map.Size(), 4);
+    BOOST_CHECK(restriction_map.IsIndexed(1, 2));
+    BOOST_CHECK(restriction_map.IsIndexed(3, 4));
+    BOOST_CHECK(!restriction_map.IsIndexed(2, 1));
+    BOOST_CHECK(!restriction_map.IsIndexed(3, 5));
+
+    // restrictions of the same key are adjacent and keep their input order
+    const auto range = restriction_map.Restrictions(3, 4);
+    BOOST_REQUIRE_EQUAL(std::distance(range.first, range.second), 2);
+    BOOST_CHECK_EQUAL(range.first->second, &restrictions[0]);
+    BOOST_CHECK_EQUAL(std::next(range.first)->second, &restrictions[2]);
+
+    const auto empty = restriction_map.Restrictions(0, 0);
+    BOOST_CHECK(empty.first == empty.second);
+
+    BOOST_CHECK(isRestricted(3, 4, 5, restriction_map).first);
+    BOOST_CHECK(!isRestricted(3, 4, 7, restriction_map).first);
+    // only restriction forbids all other turns
+    BOOST_CHECK(isRestricted(1, 2, 5, restriction_map).first);
+    BOOST_CHECK_EQUAL(isRestricted(1, 2, 5, restriction_map).second, &restrictions[3]);
+    BOOST_CHECK(!isRestricted(0, 2, 5, restriction_map).first);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
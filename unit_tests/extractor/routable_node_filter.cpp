@@ -0,0 +1,80 @@
+#include "extractor/routable_node_filter.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(routable_node_filter)
+
+using namespace osrm;
+using namespace osrm::extractor;
+using namespace osmium::builder::attr;
+
+namespace
+{
+osmium::memory::Buffer makeBuffer()
+{
+    return osmium::memory::Buffer(1024, osmium::memory::Buffer::auto_grow::yes);
+}
+
+std::vector<std::string> describe(const osmium::memory::Buffer &buffer)
+{
+    std::vector<std::string> objects;
+    for (const auto &object : buffer.select<osmium::OSMObject>())
+    {
+        objects.push_back(osmium::item_type_to_char(object.type()) + std::to_string(object.id()));
+    }
+    return objects;
+}
+}
+
+BOOST_AUTO_TEST_CASE(filter_by_way_keys)
+{
+    auto ways = makeBuffer();
+    osmium::builder::add_way(ways, _id(10), _nodes({1, 2}), _tag("highway", "primary"));
+    osmium::builder::add_way(ways, _id(11), _nodes({2, 3, 4}), _tag("building", "yes"));
+    osmium::builder::add_way(ways, _id(12), _nodes({5, 6}), _tag("route", "ferry"));
+
+    RoutableNodeFilter filter({"highway", "route"});
+    for (const auto &way : ways.select<osmium::Way>())
+    {
+        filter.AddWay(way);
+    }
+    BOOST_CHECK_EQUAL(filter.NumberOfReferencedNodes(), 4);
+
+    auto input = makeBuffer();
+    for (const auto id : {1, 2, 3, 4, 5, 6, 7})
+    {
+        osmium::builder::add_node(input, _id(id));
+    }
+    for (const auto &way : ways.select<osmium::Way>())
+    {
+        input.add_item(way);
+        input.commit();
+    }
+    osmium::builder::add_relation(input, _id(20), _tag("type", "restriction"));
+
+    const std::vector<std::string> expected = {"n1", "n2", "n5", "n6", "w10", "w12", "r20"};
+    const auto filtered = describe(filter.Filter(input));
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        filtered.begin(), filtered.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(all_ways_without_keys)
+{
+    auto ways = makeBuffer();
+    osmium::builder::add_way(ways, _id(10), _nodes({1, 2}), _tag("building", "yes"));
+
+    RoutableNodeFilter filter({});
+    const auto &way = *ways.select<osmium::Way>().begin();
+    BOOST_CHECK(filter.IsCandidate(way));
+    filter.AddWay(way);
+    BOOST_CHECK_EQUAL(filter.NumberOfReferencedNodes(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+#include "extractor/suffix_table.hpp"
+#include "util/guidance/name_announcements.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(suffix_table)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+BOOST_AUTO_TEST_CASE(membership)
+{
+    std::vector<std::string> suffixes{
+        "N", "ne", "E", "se", "S", "sw", "W", "nw", "north", "east", "south", "west", "St", "Rd"};
+    for (auto index = 0; index < 200; ++index)
+        suffixes.push_back("suffix" + std::to_string(index));
+    // duplicates are ignored
+    suffixes.push_back("n");
+
+    const SuffixTable table(suffixes);
+
+    for (const auto &suffix : suffixes)
+    {
+        BOOST_CHECK(table.isSuffix(suffix));
+        BOOST_CHECK(table.isSuffix(util::StringView{suffix}));
+    }
+
+    BOOST_CHECK(table.isSuffix(std::string{"st"}));
+    BOOST_CHECK(table.isSuffix(std::string{"WEST"}));
+    BOOST_CHECK(table.isSuffix(std::string{"North"}));
+
+    BOOST_CHECK(!table.isSuffix(std::string{""}));
+    BOOST_CHECK(!table.isSuffix(std::string{"street"}));
+    BOOST_CHECK(!table.isSuffix(std::string{"wes"}));
+    BOOST_CHECK(!table.isSuffix(std::string{"wests"}));
+    BOOST_CHECK(!table.isSuffix(std::string{"suffix200"}));
+    BOOST_CHECK(!table.isSuffix(std::string{"a much longer name than any suffix"}));
+}
+
+BOOST_AUTO_TEST_CASE(empty_table)
+{
+    const SuffixTable table(std::vector<std::string>{});
+
+    BOOST_CHECK(!table.isSuffix(std::string{""}));
+    BOOST_CHECK(!table.isSuffix(std::string{"n"}));
+}
+
+BOOST_AUTO_TEST_CASE(name_changes)
+{
+    const SuffixTable table(std::vector<std::string>{"north", "west"});
+
+    const auto requiresNameAnnounced = [&table](const std::string &from, const std::string &to) {
+        return util::guidance::requiresNameAnnounced(from, "", "", "", to, "", "", "", table);
+    };
+
+    BOOST_CHECK(!requiresNameAnnounced("West Main", "Main"));
+    BOOST_CHECK(!requiresNameAnnounced("Main", "West Main"));
+    BOOST_CHECK(!requiresNameAnnounced("Main North", "Main"));
+    BOOST_CHECK(!requiresNameAnnounced("Main NORTH", "Main West"));
+    BOOST_CHECK(requiresNameAnnounced("East Main", "Main"));
+    BOOST_CHECK(requiresNameAnnounced("Main", "Elm"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
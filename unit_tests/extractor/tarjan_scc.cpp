@@ -0,0 +1,110 @@
+#include "extractor/tarjan_scc.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(tarjan_scc)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+using InputEdge = util::static_graph_details::SortableEdgeWithData<void>;
+using Graph = util::StaticGraph<void>;
+
+namespace
+{
+Graph makeGraph(const unsigned number_of_nodes, std::vector<InputEdge> edges)
+{
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return Graph(number_of_nodes, edges);
+}
+
+// all nodes reachable from source
+std::vector<bool> reachable(const Graph &graph, const NodeID source)
+{
+    std::vector<bool> visited(graph.GetNumberOfNodes(), false);
+    std::vector<NodeID> stack{source};
+    visited[source] = true;
+    while (!stack.empty())
+    {
+        const auto node = stack.back();
+        stack.pop_back();
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            const auto target = graph.GetTarget(edge);
+            if (!visited[target])
+            {
+                visited[target] = true;
+                stack.push_back(target);
+            }
+        }
+    }
+    return visited;
+}
+}
+
+BOOST_AUTO_TEST_CASE(small_graph)
+{
+    // 0 <-> 1 -> 2 <-> 3 <-> 4, 4 -> 5, 6 -> 6
+    const Graph graph = makeGraph(
+        7, {{0, 1}, {1, 0}, {1, 2}, {2, 3}, {3, 2}, {3, 4}, {4, 3}, {4, 5}, {6, 6}});
+
+    TarjanSCC<Graph> scc(graph);
+    scc.Run();
+
+    // numbered by the smallest node of every component
+    BOOST_CHECK_EQUAL(scc.GetNumberOfComponents(), 4);
+    BOOST_CHECK_EQUAL(scc.GetSizeOneCount(), 2);
+    const std::vector<unsigned> expected_ids{0, 0, 1, 1, 1, 2, 3};
+    const std::vector<unsigned> expected_sizes{2, 2, 3, 3, 3, 1, 1};
+    for (const auto node : util::irange<NodeID>(0, 7))
+    {
+        BOOST_CHECK_EQUAL(scc.GetComponentID(node), expected_ids[node]);
+        BOOST_CHECK_EQUAL(scc.GetComponentSize(scc.GetComponentID(node)), expected_sizes[node]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(random_graph)
+{
+    const unsigned number_of_nodes = 300;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<NodeID> node_distribution(0, number_of_nodes - 1);
+    std::vector<InputEdge> edges;
+    for (auto index = 0u; index < 400; ++index)
+    {
+        edges.push_back({node_distribution(generator), node_distribution(generator)});
+    }
+    const Graph graph = makeGraph(number_of_nodes, edges);
+
+    TarjanSCC<Graph> scc(graph);
+    scc.Run();
+
+    std::vector<std::vector<bool>> reached;
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        reached.push_back(reachable(graph, node));
+    }
+
+    std::vector<unsigned> sizes(number_of_nodes, 0);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        for (const auto other : util::irange<NodeID>(0, number_of_nodes))
+        {
+            const bool same_component = reached[node][other] && reached[other][node];
+            BOOST_CHECK_EQUAL(scc.GetComponentID(node) == scc.GetComponentID(other),
+                              same_component);
+            sizes[node] += same_component;
+        }
+        BOOST_CHECK_EQUAL(scc.GetComponentSize(scc.GetComponentID(node)), sizes[node]);
+    }
+    BOOST_CHECK_EQUAL(scc.GetSizeOneCount(), std::count(sizes.begin(), sizes.end(), 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
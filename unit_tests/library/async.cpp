@@ -0,0 +1,99 @@
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "coordinates.hpp"
+#include "fixture.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/nearest_parameters.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/route_parameters.hpp"
+#include "osrm/status.hpp"
+#include "osrm/table_parameters.hpp"
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(async)
+
+BOOST_AUTO_TEST_CASE(test_async_route_matches_sync)
+{
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    using namespace osrm;
+
+    RouteParameters params;
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+
+    json::Object expected;
+    BOOST_REQUIRE(osrm.Route(params, expected) == Status::Ok);
+
+    std::promise<json::Object> response;
+    osrm.RouteAsync(params,
+                    [&response](std::exception_ptr error, Status status, json::Object result) {
+                        BOOST_CHECK(!error);
+                        BOOST_CHECK(status == Status::Ok);
+                        response.set_value(std::move(result));
+                    });
+
+    const auto result = response.get_future().get();
+    BOOST_CHECK_EQUAL(result.values.at("code").get<json::String>().value, "Ok");
+    BOOST_CHECK_EQUAL(result.values.at("routes").get<json::Array>().values.size(),
+                      expected.values.at("routes").get<json::Array>().values.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_async_error_status)
+{
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    using namespace osrm;
+
+    // no coordinates
+    std::promise<json::Object> response;
+    osrm.NearestAsync(NearestParameters{},
+                      [&response](std::exception_ptr error, Status status, json::Object result) {
+                          BOOST_CHECK(!error);
+                          BOOST_CHECK(status == Status::Error);
+                          response.set_value(std::move(result));
+                      });
+
+    const auto result = response.get_future().get();
+    BOOST_CHECK_EQUAL(result.values.at("code").get<json::String>().value, "InvalidOptions");
+}
+
+BOOST_AUTO_TEST_CASE(test_async_destruction_waits_for_queries)
+{
+    using namespace osrm;
+
+    std::atomic<int> finished{0};
+    {
+        EngineConfig config;
+        config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+        config.use_shared_memory = false;
+        config.async_threads = 2;
+        OSRM osrm{config};
+
+        TableParameters params;
+        params.coordinates.push_back(get_dummy_location());
+        params.coordinates.push_back(get_dummy_location());
+        params.coordinates.push_back(get_dummy_location());
+
+        for (int query = 0; query < 16; ++query)
+        {
+            osrm.TableAsync(params,
+                            [&finished](std::exception_ptr error, Status status, json::Object) {
+                                BOOST_CHECK(!error);
+                                BOOST_CHECK(status == Status::Ok);
+                                ++finished;
+                            });
+        }
+    }
+    BOOST_CHECK_EQUAL(finished.load(), 16);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -13,6 +13,11 @@
 #include "osrm/osrm.hpp"
 #include "osrm/status.hpp"
 
+#include "util/json_renderer.hpp"
+
+#include <string>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(match)
 
 BOOST_AUTO_TEST_CASE(test_match)
@@ -64,4 +69,147 @@ BOOST_AUTO_TEST_CASE(test_match)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_match_parallel_matches_sequential)
+{
+    using namespace osrm;
+
+    const auto match = [](const int min_parallel_match_size) {
+        EngineConfig config;
+        config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+        config.use_shared_memory = false;
+        config.min_parallel_match_size = min_parallel_match_size;
+        OSRM osrm{config};
+
+        const std::vector<util::Coordinate> trace = {
+            {util::FloatLongitude{7.422176599502563}, util::FloatLatitude{43.73754595167546}},
+            {util::FloatLongitude{7.421715259552002}, util::FloatLatitude{43.73744517900973}},
+            {util::FloatLongitude{7.421489953994752}, util::FloatLatitude{43.73738316497729}},
+            {util::FloatLongitude{7.421286106109619}, util::FloatLatitude{43.737274640266}},
+            {util::FloatLongitude{7.420910596847533}, util::FloatLatitude{43.73714285999499}}};
+
+        // the same drive three times, an hour apart
+        MatchParameters params;
+        params.gaps = MatchParameters::GapsType::Split;
+        for (const unsigned start : {0u, 3600u, 7200u})
+        {
+            for (std::size_t index = 0; index < trace.size(); ++index)
+            {
+                params.coordinates.push_back(trace[index]);
+                params.timestamps.push_back(start + 5 * index);
+            }
+        }
+
+        json::Object result;
+        BOOST_CHECK(osrm.Match(params, result) == Status::Ok);
+        BOOST_CHECK_EQUAL(result.values.at("matchings").get<json::Array>().values.size(), 3);
+
+        std::vector<char> rendered;
+        util::json::render(rendered, result);
+        return std::string(rendered.begin(), rendered.end());
+    };
+
+    BOOST_CHECK_EQUAL(match(1), match(-1));
+}
+
+BOOST_AUTO_TEST_CASE(test_match_batch_matches_single_traces)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    const std::vector<util::Coordinate> trace = {
+        {util::FloatLongitude{7.422176599502563}, util::FloatLatitude{43.73754595167546}},
+        {util::FloatLongitude{7.421715259552002}, util::FloatLatitude{43.73744517900973}},
+        {util::FloatLongitude{7.421489953994752}, util::FloatLatitude{43.73738316497729}},
+        {util::FloatLongitude{7.421286106109619}, util::FloatLatitude{43.737274640266}},
+        {util::FloatLongitude{7.420910596847533}, util::FloatLatitude{43.73714285999499}}};
+
+    // every suffix of the trace, and a trace that is too short
+    std::vector<MatchParameters> batch;
+    for (std::size_t first = 0; first + 1 < trace.size(); ++first)
+    {
+        MatchParameters params;
+        params.coordinates.assign(trace.begin() + first, trace.end());
+        batch.push_back(std::move(params));
+    }
+    batch.emplace_back();
+    batch.back().coordinates.push_back(trace.front());
+
+    std::vector<json::Object> results;
+    BOOST_CHECK(osrm.MatchBatch(batch, results) == Status::Error);
+    BOOST_REQUIRE_EQUAL(results.size(), batch.size());
+
+    const auto render = [](const json::Object &result) {
+        std::vector<char> rendered;
+        util::json::render(rendered, result);
+        return std::string(rendered.begin(), rendered.end());
+    };
+    for (std::size_t index = 0; index + 1 < batch.size(); ++index)
+    {
+        json::Object single;
+        BOOST_CHECK(osrm.Match(batch[index], single) == Status::Ok);
+        BOOST_CHECK_EQUAL(render(results[index]), render(single));
+    }
+    BOOST_CHECK_EQUAL(results.back().values.at("code").get<json::String>().value,
+                      "InvalidOptions");
+}
+
+BOOST_AUTO_TEST_CASE(test_match_session_extends_trace)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_matching_sessions = 2;
+    OSRM osrm{config};
+
+    const std::vector<util::Coordinate> trace = {
+        {util::FloatLongitude{7.422176599502563}, util::FloatLatitude{43.73754595167546}},
+        {util::FloatLongitude{7.421715259552002}, util::FloatLatitude{43.73744517900973}},
+        {util::FloatLongitude{7.421489953994752}, util::FloatLatitude{43.73738316497729}},
+        {util::FloatLongitude{7.421286106109619}, util::FloatLatitude{43.737274640266}},
+        {util::FloatLongitude{7.420910596847533}, util::FloatLatitude{43.73714285999499}}};
+
+    const auto last_location = [](const json::Object &result) {
+        const auto &tracepoints = result.values.at("tracepoints").get<json::Array>().values;
+        return tracepoints.back().get<json::Object>().values.at("location").get<json::Array>();
+    };
+
+    MatchParameters full_params;
+    full_params.coordinates = trace;
+    json::Object full_result;
+    BOOST_CHECK(osrm.Match(full_params, full_result) == Status::Ok);
+
+    // the same trace, one coordinate per request
+    json::Object result;
+    for (std::size_t index = 0; index < trace.size(); ++index)
+    {
+        MatchParameters params;
+        params.session = "vehicle";
+        params.coordinates = {trace[index]};
+        params.timestamps = {static_cast<unsigned>(5 * index)};
+
+        result = json::Object{};
+        BOOST_CHECK(osrm.Match(params, result) == Status::Ok);
+        BOOST_CHECK_EQUAL(result.values.at("tracepoints").get<json::Array>().values.size(), 1);
+    }
+
+    const auto full_location = last_location(full_result);
+    const auto session_location = last_location(result);
+    BOOST_CHECK_EQUAL(session_location.values.at(0).get<json::Number>().value,
+                      full_location.values.at(0).get<json::Number>().value);
+    BOOST_CHECK_EQUAL(session_location.values.at(1).get<json::Number>().value,
+                      full_location.values.at(1).get<json::Number>().value);
+
+    // timestamps must not go back in time within a session
+    MatchParameters params;
+    params.session = "vehicle";
+    params.coordinates = {trace.front()};
+    params.timestamps = {0};
+    result = json::Object{};
+    BOOST_CHECK(osrm.Match(params, result) == Status::Error);
+    BOOST_CHECK_EQUAL(result.values.at("code").get<json::String>().value, "InvalidValue");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
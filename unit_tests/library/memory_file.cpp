@@ -0,0 +1,125 @@
+#include <boost/test/unit_test.hpp>
+
+#include "fixture.hpp"
+
+#include "osrm/engine_config.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+#include "osrm/tile_parameters.hpp"
+
+#include "storage/memory_file.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <exception>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(memory_file)
+
+void test_memory_file(const std::string &base_path, osrm::EngineConfig::Algorithm algorithm)
+{
+    using namespace osrm;
+
+    const auto memory_file =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    EngineConfig config;
+    config.storage_config = {base_path};
+    config.use_shared_memory = false;
+    config.algorithm = algorithm;
+    config.memory_file = memory_file.string();
+    config.memory_advice = {{"COORDINATE_LIST", EngineConfig::MemoryAdvice::Random},
+                            {"NAME_CHAR_DATA", EngineConfig::MemoryAdvice::WillNeed}};
+    BOOST_CHECK(config.IsValid());
+
+    // the tile renders speeds, turns and nodes from most blocks of the dataset
+    TileParameters params{17059, 11948, 15};
+    std::string reference;
+    BOOST_CHECK(getOSRM(base_path, algorithm).Tile(params, reference) == Status::Ok);
+
+    {
+        OSRM osrm{config};
+        BOOST_CHECK(boost::filesystem::exists(memory_file));
+        std::string tile;
+        BOOST_CHECK(osrm.Tile(params, tile) == Status::Ok);
+        BOOST_CHECK(reference == tile);
+    }
+
+    // a second engine maps the file it finds
+    const auto write_time = boost::filesystem::last_write_time(memory_file);
+    OSRM osrm{config};
+    BOOST_CHECK(boost::filesystem::last_write_time(memory_file) == write_time);
+    std::string tile;
+    BOOST_CHECK(osrm.Tile(params, tile) == Status::Ok);
+    BOOST_CHECK(reference == tile);
+
+    boost::filesystem::remove(memory_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_file_ch)
+{
+    test_memory_file(OSRM_TEST_DATA_DIR "/ch/monaco.osrm", osrm::EngineConfig::Algorithm::CH);
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_file_mld)
+{
+    test_memory_file(OSRM_TEST_DATA_DIR "/mld/monaco.osrm", osrm::EngineConfig::Algorithm::MLD);
+}
+
+// The data is read from the memory file into process memory and every block is checked
+BOOST_AUTO_TEST_CASE(test_load_from_memory_file)
+{
+    using namespace osrm;
+
+    const std::string base_path = OSRM_TEST_DATA_DIR "/ch/monaco.osrm";
+    const auto memory_file =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    storage::writeMemoryFile(storage::StorageConfig{base_path}, memory_file);
+
+    EngineConfig config;
+    config.storage_config = {base_path};
+    config.storage_config.memory_file = memory_file;
+    config.use_shared_memory = false;
+
+    TileParameters params{17059, 11948, 15};
+    std::string reference;
+    BOOST_CHECK(getOSRM(base_path).Tile(params, reference) == Status::Ok);
+    {
+        OSRM osrm{config};
+        std::string tile;
+        BOOST_CHECK(osrm.Tile(params, tile) == Status::Ok);
+        BOOST_CHECK(reference == tile);
+    }
+
+    storage::MemoryFileHeader header;
+    {
+        boost::filesystem::ifstream file(memory_file, std::ios::binary);
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    }
+    const auto &coordinates = header.blocks[storage::DataLayout::COORDINATE_LIST];
+    BOOST_REQUIRE(coordinates.size > 0);
+    {
+        boost::filesystem::fstream file(memory_file,
+                                        std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(coordinates.offset);
+        const char byte = file.get() ^ 1;
+        file.seekp(coordinates.offset);
+        file.put(byte);
+    }
+    BOOST_CHECK_THROW(OSRM{config}, std::exception);
+
+    boost::filesystem::remove(memory_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_unknown_memory_advice)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.memory_advice = {{"NO_SUCH_BLOCK", EngineConfig::MemoryAdvice::Random}};
+    BOOST_CHECK(!config.IsValid());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
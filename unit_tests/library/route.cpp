@@ -7,6 +7,7 @@
 
 #include "osrm/coordinate.hpp"
 #include "osrm/engine_config.hpp"
+#include "osrm/engine_statistics.hpp"
 #include "osrm/exception.hpp"
 #include "osrm/json_container.hpp"
 #include "osrm/osrm.hpp"
@@ -446,4 +447,218 @@ BOOST_AUTO_TEST_CASE(test_manual_setting_of_annotations_property)
     BOOST_CHECK_EQUAL(annotations.size(), 5);
 }
 
+BOOST_AUTO_TEST_CASE(test_route_cache_returns_same_routes)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_cached_routes = 16;
+    OSRM osrm{config};
+    auto uncached_osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    RouteParameters params;
+    params.steps = true;
+    params.alternatives = true;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+
+    json::Object reference;
+    BOOST_CHECK(uncached_osrm.Route(params, reference) == Status::Ok);
+
+    json::Object first, second;
+    BOOST_CHECK(osrm.Route(params, first) == Status::Ok);
+    BOOST_CHECK(osrm.Route(params, second) == Status::Ok);
+    CHECK_EQUAL_JSON(reference, first);
+    CHECK_EQUAL_JSON(reference, second);
+
+    // without alternatives the query has a key of its own
+    params.alternatives = false;
+    json::Object without_alternatives;
+    BOOST_CHECK(osrm.Route(params, without_alternatives) == Status::Ok);
+    BOOST_CHECK_EQUAL(without_alternatives.values.at("routes").get<json::Array>().values.size(),
+                      1);
+
+    const auto statistics = osrm.GetStatistics().route_cache;
+    BOOST_CHECK_EQUAL(statistics.hits, 1);
+    BOOST_CHECK_EQUAL(statistics.misses, 2);
+    BOOST_CHECK_EQUAL(statistics.entries, 2);
+    BOOST_CHECK_EQUAL(statistics.capacity, 16);
+
+    BOOST_CHECK_EQUAL(uncached_osrm.GetStatistics().route_cache.capacity, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_reroute_returns_same_routes)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_reroute_destinations = 4;
+    OSRM osrm{config};
+    auto reference_osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    const auto locations = get_locations_in_big_component();
+    RouteParameters params;
+    params.steps = true;
+    params.annotations = true;
+    params.coordinates = {locations[0], locations.back()};
+
+    // the first route to the destination searches its reverse search space, the others reuse it
+    for (const auto &source : {locations[0], locations[1], get_dummy_location(), locations.back()})
+    {
+        params.coordinates.front() = source;
+
+        json::Object reference, result;
+        params.reroute = false;
+        const auto reference_status = reference_osrm.Route(params, reference);
+        params.reroute = true;
+        BOOST_CHECK(osrm.Route(params, result) == reference_status);
+        CHECK_EQUAL_JSON(reference, result);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_route_unpacking_cache_returns_same_routes)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_cached_unpackings = 4096;
+    OSRM osrm{config};
+    auto uncached_osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    RouteParameters params;
+    params.steps = true;
+    params.alternatives = true;
+    params.annotations = true;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+
+    json::Object reference;
+    BOOST_CHECK(uncached_osrm.Route(params, reference) == Status::Ok);
+
+    // the second query unpacks the same shortcuts from the cache
+    json::Object first, second;
+    BOOST_CHECK(osrm.Route(params, first) == Status::Ok);
+    const auto misses = osrm.GetStatistics().unpacking_cache.misses;
+    BOOST_CHECK(osrm.Route(params, second) == Status::Ok);
+    CHECK_EQUAL_JSON(reference, first);
+    CHECK_EQUAL_JSON(reference, second);
+
+    const auto statistics = osrm.GetStatistics().unpacking_cache;
+    BOOST_CHECK_GT(misses, 0);
+    BOOST_CHECK_EQUAL(statistics.misses, misses);
+    BOOST_CHECK_GT(statistics.hits, 0);
+    BOOST_CHECK_EQUAL(statistics.capacity, 4096);
+
+    BOOST_CHECK_EQUAL(uncached_osrm.GetStatistics().unpacking_cache.capacity, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_route_parallel_legs_match_sequential_legs)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.min_parallel_route_size = 2;
+    OSRM osrm{config};
+    auto sequential_osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    RouteParameters params;
+    params.steps = true;
+    params.annotations = true;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+    params.coordinates.push_back(get_dummy_location());
+
+    // u-turns at the waypoints make the legs independent, otherwise only the unpacking is parallel
+    for (const bool continue_straight : {false, true})
+    {
+        params.continue_straight = continue_straight;
+
+        json::Object reference, result;
+        BOOST_CHECK(sequential_osrm.Route(params, reference) == Status::Ok);
+        BOOST_CHECK(osrm.Route(params, result) == Status::Ok);
+        CHECK_EQUAL_JSON(reference, result);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_route_parallel_search_matches_sequential_search)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/mld/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.algorithm = EngineConfig::Algorithm::MLD;
+    config.min_parallel_search_distance = 0;
+    OSRM osrm{config};
+    auto sequential_osrm = getOSRM(OSRM_TEST_DATA_DIR "/mld/monaco.osrm",
+                                   EngineConfig::Algorithm::MLD);
+
+    RouteParameters params;
+    params.steps = true;
+    params.annotations = true;
+    const auto locations = get_locations_in_big_component();
+    for (const auto &source : locations)
+    {
+        for (const auto &target : locations)
+        {
+            params.coordinates = {source, target};
+
+            json::Object reference, result;
+            BOOST_CHECK(sequential_osrm.Route(params, reference) == Status::Ok);
+            BOOST_CHECK(osrm.Route(params, result) == Status::Ok);
+            CHECK_EQUAL_JSON(reference, result);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_route_without_geometry_has_same_totals)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    RouteParameters params;
+    params.steps = true;
+    params.annotations = true;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+
+    // only assembles the distances of the legs
+    auto totals_only = params;
+    totals_only.steps = false;
+    totals_only.annotations = false;
+    totals_only.overview = RouteParameters::OverviewType::False;
+
+    json::Object full, totals;
+    BOOST_CHECK(osrm.Route(params, full) == Status::Ok);
+    BOOST_CHECK(osrm.Route(totals_only, totals) == Status::Ok);
+
+    const auto &full_route =
+        full.values.at("routes").get<json::Array>().values.at(0).get<json::Object>();
+    const auto &route =
+        totals.values.at("routes").get<json::Array>().values.at(0).get<json::Object>();
+    for (const auto key : {"distance", "duration", "weight"})
+    {
+        BOOST_CHECK_EQUAL(route.values.at(key).get<json::Number>().value,
+                          full_route.values.at(key).get<json::Number>().value);
+    }
+    BOOST_CHECK(route.values.find("geometry") == route.values.end());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,17 +2,28 @@
 #include <boost/test/unit_test.hpp>
 
 #include "coordinates.hpp"
+#include "equal_json.hpp"
 #include "fixture.hpp"
 #include "waypoint_check.hpp"
 
+#include "osrm/route_parameters.hpp"
+#include "osrm/table_matrices.hpp"
 #include "osrm/table_parameters.hpp"
+#include "osrm/table_writer.hpp"
 
 #include "osrm/coordinate.hpp"
 #include "osrm/engine_config.hpp"
+#include "osrm/engine_statistics.hpp"
 #include "osrm/json_container.hpp"
 #include "osrm/osrm.hpp"
 #include "osrm/status.hpp"
 
+#include "util/coordinate_calculation.hpp"
+#include "util/json_renderer.hpp"
+
+#include <string>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(table)
 
 BOOST_AUTO_TEST_CASE(test_table_three_coords_one_source_one_dest_matrix)
@@ -174,4 +185,534 @@ BOOST_AUTO_TEST_CASE(test_table_no_segment_for_some_coordinates)
     BOOST_CHECK_EQUAL(code, "NoSegment");
 }
 
+BOOST_AUTO_TEST_CASE(test_table_rendered_matches_json)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+    params.sources.push_back(0);
+
+    json::Object json_result;
+    const auto json_rc = osrm.Table(params, json_result);
+    BOOST_CHECK(json_rc == Status::Ok);
+
+    std::vector<char> expected;
+    util::json::render(expected, json_result);
+
+    std::vector<char> rendered;
+    const auto rendered_rc = osrm.Table(params, rendered);
+    BOOST_CHECK(rendered_rc == Status::Ok);
+    BOOST_CHECK_EQUAL(std::string(rendered.begin(), rendered.end()),
+                      std::string(expected.begin(), expected.end()));
+
+    // errors are rendered, too
+    params.radiuses = {boost::make_optional(0.), boost::none, boost::none};
+    params.radiuses.resize(params.coordinates.size());
+    rendered.clear();
+    BOOST_CHECK(osrm.Table(params, rendered) == Status::Error);
+    const std::string error(rendered.begin(), rendered.end());
+    BOOST_CHECK(error.find("\"code\":\"NoSegment\"") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_table_matrices_match_json)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+    params.sources.push_back(0);
+    params.annotations = TableParameters::AnnotationsType::All;
+
+    json::Object json_result;
+    BOOST_REQUIRE(osrm.Table(params, json_result) == Status::Ok);
+
+    TableMatrices matrices;
+    BOOST_REQUIRE(osrm.Table(params, matrices) == Status::Ok);
+    BOOST_CHECK_EQUAL(matrices.number_of_sources, 1);
+    BOOST_CHECK_EQUAL(matrices.number_of_destinations, params.coordinates.size());
+    BOOST_CHECK(matrices.response.values.count("sources"));
+    BOOST_CHECK(matrices.response.values.count("destinations"));
+
+    const auto check_matrix = [&](const std::string &name, const std::vector<double> &matrix) {
+        const auto &row = json_result.values.at(name)
+                              .get<json::Array>()
+                              .values.at(0)
+                              .get<json::Array>()
+                              .values;
+        BOOST_REQUIRE_EQUAL(matrix.size(), row.size());
+        for (std::size_t column = 0; column < row.size(); ++column)
+        {
+            BOOST_CHECK_EQUAL(matrix[column], row[column].get<json::Number>().value);
+        }
+    };
+    check_matrix("durations", matrices.durations);
+    check_matrix("distances", matrices.distances);
+
+    // errors end up in the response
+    params.radiuses = {boost::make_optional(0.), boost::none, boost::none};
+    params.radiuses.resize(params.coordinates.size());
+    BOOST_CHECK(osrm.Table(params, matrices) == Status::Error);
+    BOOST_CHECK(matrices.durations.empty());
+    BOOST_CHECK_EQUAL(matrices.response.values.at("code").get<json::String>().value, "NoSegment");
+}
+
+BOOST_AUTO_TEST_CASE(test_table_written_in_chunks_matches_rendered)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+
+    for (const auto annotations :
+         {TableParameters::AnnotationsType::Duration, TableParameters::AnnotationsType::All})
+    {
+        params.annotations = annotations;
+
+        std::vector<char> rendered;
+        BOOST_REQUIRE(osrm.Table(params, rendered) == Status::Ok);
+
+        std::vector<std::string> pieces;
+        TableWriter writer;
+        writer.rows_per_chunk = 1;
+        writer.write = [&pieces](std::vector<char> &piece) {
+            pieces.emplace_back(piece.begin(), piece.end());
+            return true;
+        };
+        BOOST_REQUIRE(osrm.Table(params, writer) == Status::Ok);
+        BOOST_CHECK_EQUAL(pieces.size(), params.coordinates.size());
+
+        std::string written;
+        for (const auto &piece : pieces)
+        {
+            written += piece;
+        }
+        BOOST_CHECK_EQUAL(written, std::string(rendered.begin(), rendered.end()));
+    }
+
+    // a writer that gives up cancels the table
+    TableWriter cancelling_writer;
+    cancelling_writer.rows_per_chunk = 1;
+    cancelling_writer.write = [](std::vector<char> &) { return false; };
+    BOOST_CHECK(osrm.Table(params, cancelling_writer) == Status::Error);
+    const std::string error(cancelling_writer.error.begin(), cancelling_writer.error.end());
+    BOOST_CHECK(error.find("\"code\":\"Cancelled\"") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_table_parallel_matches_sequential)
+{
+    using namespace osrm;
+
+    const auto table = [](const std::string &base_path,
+                          const EngineConfig::Algorithm algorithm,
+                          const int min_parallel_table_size) {
+        EngineConfig config;
+        config.storage_config = {base_path};
+        config.use_shared_memory = false;
+        config.algorithm = algorithm;
+        config.min_parallel_table_size = min_parallel_table_size;
+        OSRM osrm{config};
+
+        TableParameters params;
+        for (const auto &location : get_locations_in_big_component())
+        {
+            params.coordinates.push_back(location);
+        }
+
+        std::vector<char> rendered;
+        BOOST_CHECK(osrm.Table(params, rendered) == Status::Ok);
+        return std::string(rendered.begin(), rendered.end());
+    };
+
+    BOOST_CHECK_EQUAL(table(OSRM_TEST_DATA_DIR "/ch/monaco.osrm", EngineConfig::Algorithm::CH, 1),
+                      table(OSRM_TEST_DATA_DIR "/ch/monaco.osrm", EngineConfig::Algorithm::CH, -1));
+    BOOST_CHECK_EQUAL(
+        table(OSRM_TEST_DATA_DIR "/mld/monaco.osrm", EngineConfig::Algorithm::MLD, 1),
+        table(OSRM_TEST_DATA_DIR "/mld/monaco.osrm", EngineConfig::Algorithm::MLD, -1));
+}
+
+BOOST_AUTO_TEST_CASE(test_table_rphast_matches_buckets)
+{
+    using namespace osrm;
+
+    const auto table = [](const int min_parallel_table_size, const int min_rphast_table_size) {
+        EngineConfig config;
+        config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+        config.use_shared_memory = false;
+        config.algorithm = EngineConfig::Algorithm::CH;
+        config.min_parallel_table_size = min_parallel_table_size;
+        config.min_rphast_table_size = min_rphast_table_size;
+        OSRM osrm{config};
+
+        TableParameters params;
+        for (const auto &location : get_locations_in_big_component())
+        {
+            params.coordinates.push_back(location);
+        }
+        // a source and a destination on the same segment
+        params.coordinates.push_back(get_dummy_location());
+        params.coordinates.push_back(get_dummy_location());
+        params.annotations = TableParameters::AnnotationsType::All;
+
+        std::vector<char> rendered;
+        BOOST_CHECK(osrm.Table(params, rendered) == Status::Ok);
+        return std::string(rendered.begin(), rendered.end());
+    };
+
+    const auto buckets = table(-1, -1);
+    BOOST_CHECK_EQUAL(table(-1, 1), buckets);
+    BOOST_CHECK_EQUAL(table(1, 1), buckets);
+}
+
+BOOST_AUTO_TEST_CASE(test_table_fused_square_matches_separate_searches)
+{
+    using namespace osrm;
+
+    const auto table = [](const std::string &path,
+                          const EngineConfig::Algorithm algorithm,
+                          const int min_parallel_table_size,
+                          const int min_fused_table_size) {
+        EngineConfig config;
+        config.storage_config = {path};
+        config.use_shared_memory = false;
+        config.algorithm = algorithm;
+        config.min_parallel_table_size = min_parallel_table_size;
+        config.min_rphast_table_size = -1;
+        config.min_fused_table_size = min_fused_table_size;
+        OSRM osrm{config};
+
+        TableParameters params;
+        for (const auto &location : get_locations_in_big_component())
+        {
+            params.coordinates.push_back(location);
+        }
+        // a source and a destination on the same segment
+        params.coordinates.push_back(get_dummy_location());
+        params.coordinates.push_back(get_dummy_location());
+        params.annotations = TableParameters::AnnotationsType::All;
+
+        std::vector<char> rendered;
+        BOOST_CHECK(osrm.Table(params, rendered) == Status::Ok);
+        return std::string(rendered.begin(), rendered.end());
+    };
+
+    for (const auto &data : {std::make_pair(std::string(OSRM_TEST_DATA_DIR "/ch/monaco.osrm"),
+                                            EngineConfig::Algorithm::CH),
+                             std::make_pair(std::string(OSRM_TEST_DATA_DIR "/mld/monaco.osrm"),
+                                            EngineConfig::Algorithm::MLD)})
+    {
+        const auto separate = table(data.first, data.second, -1, -1);
+        BOOST_CHECK_EQUAL(table(data.first, data.second, -1, 0), separate);
+        BOOST_CHECK_EQUAL(table(data.first, data.second, 1, 0), separate);
+    }
+}
+
+// a single source always searches towards the cells of its targets, the full table may use buckets
+BOOST_AUTO_TEST_CASE(test_table_target_cells_match_buckets)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/mld/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.algorithm = EngineConfig::Algorithm::MLD;
+    OSRM osrm{config};
+
+    TableParameters params;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+    // a source and a destination on the same segment
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+    params.annotations = TableParameters::AnnotationsType::All;
+
+    json::Object table;
+    BOOST_REQUIRE(osrm.Table(params, table) == Status::Ok);
+    const auto &durations = table.values.at("durations").get<json::Array>().values;
+    const auto &distances = table.values.at("distances").get<json::Array>().values;
+
+    for (std::size_t source = 0; source < params.coordinates.size(); ++source)
+    {
+        params.sources = {source};
+        json::Object row;
+        BOOST_REQUIRE(osrm.Table(params, row) == Status::Ok);
+
+        // unreachable entries are null
+        const auto values = [](const json::Value &row) {
+            std::vector<double> result;
+            for (const auto &value : row.get<json::Array>().values)
+            {
+                result.push_back(value.is<json::Number>() ? value.get<json::Number>().value : -1);
+            }
+            return result;
+        };
+        const auto row_durations = values(row.values.at("durations").get<json::Array>().values[0]);
+        const auto row_distances = values(row.values.at("distances").get<json::Array>().values[0]);
+        const auto expected_durations = values(durations[source]);
+        const auto expected_distances = values(distances[source]);
+        BOOST_CHECK_EQUAL_COLLECTIONS(row_durations.begin(),
+                                      row_durations.end(),
+                                      expected_durations.begin(),
+                                      expected_durations.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(row_distances.begin(),
+                                      row_distances.end(),
+                                      expected_distances.begin(),
+                                      expected_distances.end());
+    }
+}
+
+// the paths of a table are the routes between the same coordinates
+BOOST_AUTO_TEST_CASE(test_table_paths_match_routes)
+{
+    using namespace osrm;
+
+    const auto check = [](const std::string &base_path,
+                          const EngineConfig::Algorithm algorithm,
+                          const int min_parallel_table_size) {
+        EngineConfig config;
+        config.storage_config = {base_path};
+        config.use_shared_memory = false;
+        config.algorithm = algorithm;
+        config.min_parallel_table_size = min_parallel_table_size;
+        OSRM osrm{config};
+
+        TableParameters params;
+        for (const auto &location : get_locations_in_big_component())
+        {
+            params.coordinates.push_back(location);
+        }
+        for (std::size_t source = 0; source < params.coordinates.size(); ++source)
+        {
+            for (std::size_t destination = 0; destination < params.coordinates.size();
+                 ++destination)
+            {
+                if (source != destination)
+                    params.paths.emplace_back(source, destination);
+            }
+        }
+
+        const auto check_paths = [&](const TableParameters &params) {
+            json::Object table;
+            BOOST_REQUIRE(osrm.Table(params, table) == Status::Ok);
+            const auto &paths = table.values.at("paths").get<json::Array>().values;
+            BOOST_REQUIRE_EQUAL(paths.size(), params.paths.size());
+
+            for (std::size_t index = 0; index < paths.size(); ++index)
+            {
+                const auto &path = paths[index].get<json::Object>().values;
+                const auto source = params.sources.empty()
+                                        ? params.paths[index].first
+                                        : params.sources[params.paths[index].first];
+                const auto destination = params.paths[index].second;
+                BOOST_CHECK_EQUAL(path.at("source").get<json::Number>().value,
+                                  params.paths[index].first);
+                BOOST_CHECK_EQUAL(path.at("destination").get<json::Number>().value, destination);
+
+                RouteParameters route_params;
+                route_params.coordinates = {params.coordinates[source],
+                                            params.coordinates[destination]};
+                route_params.overview = RouteParameters::OverviewType::Full;
+                json::Object route;
+                BOOST_REQUIRE(osrm.Route(route_params, route) == Status::Ok);
+                const auto &route_object =
+                    route.values.at("routes").get<json::Array>().values.at(0).get<json::Object>();
+                BOOST_CHECK_EQUAL(path.at("geometry").get<json::String>().value,
+                                  route_object.values.at("geometry").get<json::String>().value);
+            }
+        };
+
+        check_paths(params);
+
+        // a single source, which MLD searches towards the cells of the targets
+        params.sources = {1};
+        params.paths = {{0, 0}, {0, 2}, {0, 3}};
+        check_paths(params);
+    };
+
+    check(OSRM_TEST_DATA_DIR "/ch/monaco.osrm", EngineConfig::Algorithm::CH, -1);
+    check(OSRM_TEST_DATA_DIR "/ch/monaco.osrm", EngineConfig::Algorithm::CH, 1);
+    check(OSRM_TEST_DATA_DIR "/mld/monaco.osrm", EngineConfig::Algorithm::MLD, -1);
+    check(OSRM_TEST_DATA_DIR "/mld/monaco.osrm", EngineConfig::Algorithm::MLD, 1);
+}
+
+// Core-CH climbs the hierarchy to the core and searches the core once per source, its weights are
+// the ones of the fully contracted CH
+BOOST_AUTO_TEST_CASE(test_table_corech_matches_ch)
+{
+    using namespace osrm;
+
+    const auto table = [](const std::string &base_path,
+                          const EngineConfig::Algorithm algorithm,
+                          const int min_parallel_table_size) {
+        EngineConfig config;
+        config.storage_config = {base_path};
+        config.use_shared_memory = false;
+        config.algorithm = algorithm;
+        config.min_parallel_table_size = min_parallel_table_size;
+        OSRM osrm{config};
+
+        TableParameters params;
+        for (const auto &location : get_locations_in_big_component())
+        {
+            params.coordinates.push_back(location);
+        }
+        // a source and a destination on the same segment
+        params.coordinates.push_back(get_dummy_location());
+        params.coordinates.push_back(get_dummy_location());
+
+        json::Object result;
+        BOOST_REQUIRE(osrm.Table(params, result) == Status::Ok);
+        std::vector<double> durations;
+        for (const auto &row : result.values.at("durations").get<json::Array>().values)
+        {
+            for (const auto &value : row.get<json::Array>().values)
+            {
+                durations.push_back(value.is<json::Number>() ? value.get<json::Number>().value
+                                                             : -1);
+            }
+        }
+        return durations;
+    };
+
+    const auto ch = table(OSRM_TEST_DATA_DIR "/ch/monaco.osrm", EngineConfig::Algorithm::CH, -1);
+    const auto corech =
+        table(OSRM_TEST_DATA_DIR "/corech/monaco.osrm", EngineConfig::Algorithm::CoreCH, -1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(corech.begin(), corech.end(), ch.begin(), ch.end());
+
+    const auto parallel =
+        table(OSRM_TEST_DATA_DIR "/corech/monaco.osrm", EngineConfig::Algorithm::CoreCH, 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(parallel.begin(), parallel.end(), corech.begin(), corech.end());
+}
+
+BOOST_AUTO_TEST_CASE(test_table_distances)
+{
+    using namespace osrm;
+
+    const auto check = [](const std::string &base_path, const EngineConfig::Algorithm algorithm) {
+        EngineConfig config;
+        config.storage_config = {base_path};
+        config.use_shared_memory = false;
+        config.algorithm = algorithm;
+        OSRM osrm{config};
+
+        TableParameters params;
+        for (const auto &location : get_locations_in_big_component())
+        {
+            params.coordinates.push_back(location);
+        }
+
+        json::Object durations_result;
+        BOOST_CHECK(osrm.Table(params, durations_result) == Status::Ok);
+        BOOST_CHECK_EQUAL(durations_result.values.count("distances"), 0);
+
+        params.annotations = TableParameters::AnnotationsType::Distance;
+        json::Object distances_result;
+        BOOST_CHECK(osrm.Table(params, distances_result) == Status::Ok);
+        BOOST_CHECK_EQUAL(distances_result.values.count("durations"), 0);
+
+        params.annotations = TableParameters::AnnotationsType::All;
+        json::Object result;
+        BOOST_CHECK(osrm.Table(params, result) == Status::Ok);
+
+        // asking for distances does not change the durations
+        const auto number_of_coordinates = params.coordinates.size();
+        const auto &durations = result.values.at("durations").get<json::Array>().values;
+        const auto &expected_durations =
+            durations_result.values.at("durations").get<json::Array>().values;
+        const auto &distances = result.values.at("distances").get<json::Array>().values;
+        BOOST_REQUIRE_EQUAL(distances.size(), number_of_coordinates);
+
+        const auto &waypoints = result.values.at("sources").get<json::Array>().values;
+        const auto location = [&waypoints](const std::size_t index) {
+            const auto &coordinates = waypoints[index]
+                                          .get<json::Object>()
+                                          .values.at("location")
+                                          .get<json::Array>()
+                                          .values;
+            return util::Coordinate{
+                util::FloatLongitude{coordinates[0].get<json::Number>().value},
+                util::FloatLatitude{coordinates[1].get<json::Number>().value}};
+        };
+
+        for (std::size_t row = 0; row < number_of_coordinates; ++row)
+        {
+            const auto &distances_row = distances[row].get<json::Array>().values;
+            const auto &durations_row = durations[row].get<json::Array>().values;
+            const auto &expected_row = expected_durations[row].get<json::Array>().values;
+            BOOST_REQUIRE_EQUAL(distances_row.size(), number_of_coordinates);
+            BOOST_CHECK_EQUAL(distances_row[row].get<json::Number>().value, 0);
+
+            for (std::size_t column = 0; column < number_of_coordinates; ++column)
+            {
+                BOOST_CHECK_EQUAL(durations_row[column].get<json::Number>().value,
+                                  expected_row[column].get<json::Number>().value);
+
+                // no route is shorter than the straight line between its waypoints
+                const auto straight_line = util::coordinate_calculation::haversineDistance(
+                    location(row), location(column));
+                BOOST_CHECK_GE(distances_row[column].get<json::Number>().value + 1.,
+                               straight_line);
+            }
+        }
+    };
+
+    check(OSRM_TEST_DATA_DIR "/ch/monaco.osrm", EngineConfig::Algorithm::CH);
+    check(OSRM_TEST_DATA_DIR "/mld/monaco.osrm", EngineConfig::Algorithm::MLD);
+}
+
+BOOST_AUTO_TEST_CASE(test_table_snapping_cache)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_cached_snappings = 16;
+    OSRM osrm{config};
+    auto uncached_osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    for (const auto &location : get_locations_in_big_component())
+    {
+        params.coordinates.push_back(location);
+    }
+    // the same coordinate twice in one query
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+    params.generate_hints = false;
+
+    json::Object reference;
+    BOOST_REQUIRE(uncached_osrm.Table(params, reference) == Status::Ok);
+
+    json::Object first, second;
+    BOOST_REQUIRE(osrm.Table(params, first) == Status::Ok);
+    BOOST_REQUIRE(osrm.Table(params, second) == Status::Ok);
+    CHECK_EQUAL_JSON(reference, first);
+    CHECK_EQUAL_JSON(reference, second);
+
+    const auto statistics = osrm.GetStatistics().snapping_cache;
+    const auto number_of_coordinates = params.coordinates.size();
+    BOOST_CHECK_EQUAL(statistics.misses, number_of_coordinates - 1);
+    BOOST_CHECK_EQUAL(statistics.hits, number_of_coordinates + 1);
+    BOOST_CHECK_EQUAL(statistics.entries, number_of_coordinates - 1);
+    BOOST_CHECK_EQUAL(uncached_osrm.GetStatistics().snapping_cache.capacity, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
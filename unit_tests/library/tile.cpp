@@ -14,8 +14,13 @@
 #include "util/typedefs.hpp"
 #include "util/vector_tile.hpp"
 
+#include <boost/filesystem.hpp>
+
 #include <protozero/pbf_reader.hpp>
 
+#include <string>
+#include <unordered_map>
+
 #define CHECK_EQUAL_RANGE(R1, R2)                                                                  \
     BOOST_CHECK_EQUAL_COLLECTIONS(R1.begin(), R1.end(), R2.begin(), R2.end());
 
@@ -793,4 +798,40 @@ BOOST_AUTO_TEST_CASE(test_tile_nodes_mld)
     test_tile_nodes(osrm);
 }
 
+BOOST_AUTO_TEST_CASE(test_tile_cache_returns_same_tiles)
+{
+    using namespace osrm;
+
+    const auto directory =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_cached_tiles = 16;
+    config.tile_cache_directory = directory.string();
+    auto uncached_osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TileParameters params{17059, 11948, 15};
+    std::string reference;
+    BOOST_CHECK(uncached_osrm.Tile(params, reference) == Status::Ok);
+
+    {
+        OSRM osrm{config};
+        std::string first, second;
+        BOOST_CHECK(osrm.Tile(params, first) == Status::Ok);
+        BOOST_CHECK(osrm.Tile(params, second) == Status::Ok);
+        BOOST_CHECK(reference == first);
+        BOOST_CHECK(reference == second);
+    }
+
+    // a new engine serves the tile from the directory
+    config.max_cached_tiles = 0;
+    OSRM osrm{config};
+    std::string from_disk;
+    BOOST_CHECK(osrm.Tile(params, from_disk) == Status::Ok);
+    BOOST_CHECK(reference == from_disk);
+
+    boost::filesystem::remove_all(directory);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -42,6 +42,8 @@ class MockBaseDataFacade : public engine::datafacade::BaseDataFacade
     {
         return ComponentID{INVALID_COMPONENTID, false};
     }
+    std::size_t GetNumberOfEdgeBasedNodes() const override { return 0; }
+    std::size_t GetNumberOfGeometrySegments(const EdgeID /* id */) const override { return 0; }
     TurnPenalty GetWeightPenaltyForEdgeID(const unsigned /* id */) const override final
     {
         return 0;
@@ -50,40 +52,46 @@ class MockBaseDataFacade : public engine::datafacade::BaseDataFacade
     {
         return 0;
     }
-    std::vector<NodeID> GetUncompressedForwardGeometry(const EdgeID /* id */) const override
+    NodeForwardRange GetUncompressedForwardGeometry(const EdgeID /* id */) const override
     {
-        return {};
+        static const util::DeltaVectorView<NodeID> nodes;
+        return nodes.GetRange(0, 0);
     }
-    std::vector<NodeID> GetUncompressedReverseGeometry(const EdgeID /* id */) const override
+    NodeReverseRange GetUncompressedReverseGeometry(const EdgeID id) const override
     {
-        return {};
+        return NodeReverseRange(GetUncompressedForwardGeometry(id));
     }
-    std::vector<EdgeWeight> GetUncompressedForwardWeights(const EdgeID /* id */) const override
+    WeightForwardRange GetUncompressedForwardWeights(const EdgeID /* id */) const override
     {
-        std::vector<EdgeWeight> result_weights;
-        result_weights.resize(1);
-        result_weights[0] = 1;
-        return result_weights;
+        // a single segment of weight 1
+        static std::uint64_t words[] = {1};
+        static const extractor::SegmentDataView::SegmentWeightVector weights(
+            util::vector_view<std::uint64_t>(words, 1), 1);
+        return boost::make_iterator_range(weights.cbegin(), weights.cend());
     }
-    std::vector<EdgeWeight> GetUncompressedReverseWeights(const EdgeID id) const override
+    WeightReverseRange GetUncompressedReverseWeights(const EdgeID id) const override
     {
-        return GetUncompressedForwardWeights(id);
+        return WeightReverseRange(GetUncompressedForwardWeights(id));
     }
-    std::vector<EdgeWeight> GetUncompressedForwardDurations(const EdgeID id) const override
+    DurationForwardRange GetUncompressedForwardDurations(const EdgeID /* id */) const override
     {
-        return GetUncompressedForwardWeights(id);
+        static std::uint64_t words[] = {1};
+        static const extractor::SegmentDataView::SegmentDurationVector durations(
+            util::vector_view<std::uint64_t>(words, 1), 1);
+        return boost::make_iterator_range(durations.cbegin(), durations.cend());
     }
-    std::vector<EdgeWeight> GetUncompressedReverseDurations(const EdgeID id) const override
+    DurationReverseRange GetUncompressedReverseDurations(const EdgeID id) const override
     {
-        return GetUncompressedForwardWeights(id);
+        return DurationReverseRange(GetUncompressedForwardDurations(id));
     }
-    std::vector<DatasourceID> GetUncompressedForwardDatasources(const EdgeID /*id*/) const override
+    DatasourceForwardRange GetUncompressedForwardDatasources(const EdgeID /*id*/) const override
     {
-        return {};
+        static const extractor::SegmentDataView::SegmentDatasourceVector datasources;
+        return boost::make_iterator_range(datasources.cbegin(), datasources.cend());
     }
-    std::vector<DatasourceID> GetUncompressedReverseDatasources(const EdgeID /*id*/) const override
+    DatasourceReverseRange GetUncompressedReverseDatasources(const EdgeID id) const override
     {
-        return {};
+        return DatasourceReverseRange(GetUncompressedForwardDatasources(id));
     }
 
     StringView GetDatasourceName(const DatasourceID) const override final { return {}; }
@@ -99,58 +107,65 @@ class MockBaseDataFacade : public engine::datafacade::BaseDataFacade
         return {};
     }
 
-    std::vector<engine::PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate /*input_coordinate*/,
-                               const float /*max_distance*/,
-                               const int /*bearing*/,
-                               const int /*bearing_range*/,
-                               const engine::Approach /*approach*/) const override
+    std::vector<engine::SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate /*input_coordinate*/,
+                             const float /*max_distance*/,
+                             const int /*bearing*/,
+                             const int /*bearing_range*/,
+                             const engine::Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<engine::PhantomNodeWithDistance>
-    NearestPhantomNodesInRange(const util::Coordinate /*input_coordinate*/,
-                               const float /*max_distance*/,
-                               const engine::Approach /*approach*/) const override
+    std::vector<engine::SegmentCandidate>
+    NearestCandidatesInRange(const util::Coordinate /*input_coordinate*/,
+                             const float /*max_distance*/,
+                             const engine::Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<engine::PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate /*input_coordinate*/,
-                        const unsigned /*max_results*/,
-                        const double /*max_distance*/,
-                        const int /*bearing*/,
-                        const int /*bearing_range*/,
-                        const engine::Approach /*approach*/) const override
+    std::vector<engine::SegmentCandidate>
+    NearestCandidates(const util::Coordinate /*input_coordinate*/,
+                      const unsigned /*max_results*/,
+                      const double /*max_distance*/,
+                      const int /*bearing*/,
+                      const int /*bearing_range*/,
+                      const engine::Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<engine::PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate /*input_coordinate*/,
-                        const unsigned /*max_results*/,
-                        const int /*bearing*/,
-                        const int /*bearing_range*/,
-                        const engine::Approach /*approach*/) const override
+    std::vector<engine::SegmentCandidate>
+    NearestCandidates(const util::Coordinate /*input_coordinate*/,
+                      const unsigned /*max_results*/,
+                      const int /*bearing*/,
+                      const int /*bearing_range*/,
+                      const engine::Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<engine::PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate /*input_coordinate*/,
-                        const unsigned /*max_results*/,
-                        const engine::Approach /*approach*/) const override
+    std::vector<engine::SegmentCandidate>
+    NearestCandidates(const util::Coordinate /*input_coordinate*/,
+                      const unsigned /*max_results*/,
+                      const engine::Approach /*approach*/) const override
     {
         return {};
     }
 
-    std::vector<engine::PhantomNodeWithDistance>
-    NearestPhantomNodes(const util::Coordinate /*input_coordinate*/,
-                        const unsigned /*max_results*/,
-                        const double /*max_distance*/,
-                        const engine::Approach /*approach*/) const override
+    std::vector<engine::SegmentCandidate>
+    NearestCandidates(const util::Coordinate /*input_coordinate*/,
+                      const unsigned /*max_results*/,
+                      const double /*max_distance*/,
+                      const engine::Approach /*approach*/) const override
+    {
+        return {};
+    }
+
+    engine::PhantomNodeWithDistance
+    MakePhantomNode(const util::Coordinate /*input_coordinate*/,
+                    const engine::SegmentCandidate & /*candidate*/) const override
     {
         return {};
     }
@@ -207,6 +222,8 @@ class MockBaseDataFacade : public engine::datafacade::BaseDataFacade
         return {};
     }
 
+    extractor::ClassData GetExcludedClasses() const override final { return 0; }
+
     NameID GetNameIndex(const NodeID /* id */) const override { return 0; }
 
     StringView GetNameForID(const NameID) const override final { return {}; }
@@ -271,6 +288,7 @@ class MockAlgorithmDataFacade<engine::datafacade::CH>
 {
   private:
     EdgeData foo;
+    util::SearchEdge search_edge;
 
   public:
     unsigned GetNumberOfNodes() const override { return 0; }
@@ -278,6 +296,10 @@ class MockAlgorithmDataFacade<engine::datafacade::CH>
     unsigned GetOutDegree(const NodeID /* n */) const override { return 0; }
     NodeID GetTarget(const EdgeID /* e */) const override { return SPECIAL_NODEID; }
     const EdgeData &GetEdgeData(const EdgeID /* e */) const override { return foo; }
+    const util::SearchEdge &GetSearchEdge(const EdgeID /* e */) const override
+    {
+        return search_edge;
+    }
     EdgeID BeginEdges(const NodeID /* n */) const override { return SPECIAL_EDGEID; }
     EdgeID EndEdges(const NodeID /* n */) const override { return SPECIAL_EDGEID; }
     osrm::engine::datafacade::EdgeRange GetAdjacentEdgeRange(const NodeID /* node */) const override
@@ -27,8 +27,10 @@ class MockScriptingEnvironment : public extractor::ScriptingEnvironment
     }
 
     std::vector<std::string> GetNameSuffixList() override final { return {}; }
+    std::vector<std::string> GetWayPrefilterKeys() override final { return {}; }
 
     std::vector<std::string> GetRestrictions() override final { return {}; }
+    std::vector<std::vector<std::string>> GetExcludableClasses() override final { return {}; }
     void ProcessTurn(extractor::ExtractionTurn &) override final {}
     void ProcessSegment(extractor::ExtractionSegment &) override final {}
 
@@ -326,4 +326,155 @@ BOOST_AUTO_TEST_CASE(immutable_cell_storage)
     CHECK_EQUAL_COLLECTIONS(const_cell_4_0.GetDestinationNodes(), std::vector<EdgeWeight>{});
 }
 
+BOOST_AUTO_TEST_CASE(multiple_metrics)
+{
+    // node:                0  1  2  3
+    std::vector<CellID> l1{{0, 0, 1, 1}};
+    MultiLevelPartition mlp{{l1}, {2}};
+
+    std::vector<MockEdge> edges = {{0, 1}, {1, 0}, {1, 2}, {2, 3}, {3, 2}};
+
+    auto graph = makeGraph(edges);
+
+    CellStorage storage(mlp, graph);
+    BOOST_CHECK_EQUAL(storage.GetNumberOfMetrics(), 1);
+
+    *storage.GetCell(1, 0).GetOutWeight(1).begin() = 1;
+    *storage.GetCell(1, 1).GetOutWeight(2).begin() = 2;
+
+    storage.SetNumberOfMetrics(3);
+    BOOST_CHECK_EQUAL(storage.GetNumberOfMetrics(), 3);
+
+    // new metrics start out invalid and share the boundary nodes
+    storage.SelectMetric(2);
+    CHECK_EQUAL_RANGE(storage.GetCell(1, 0).GetSourceNodes(), 1);
+    CHECK_EQUAL_RANGE(storage.GetCell(1, 0).GetOutWeight(1), INVALID_EDGE_WEIGHT);
+    CHECK_EQUAL_RANGE(storage.GetCell(1, 1).GetOutDuration(2), MAXIMAL_EDGE_DURATION);
+    *storage.GetCell(1, 0).GetOutWeight(1).begin() = 3;
+    *storage.GetCell(1, 1).GetOutWeight(2).begin() = 4;
+
+    storage.SelectMetric(0);
+    CHECK_EQUAL_RANGE(storage.GetCell(1, 0).GetOutWeight(1), 1);
+    CHECK_EQUAL_RANGE(storage.GetCell(1, 1).GetInWeight(2), 2);
+
+    const auto &const_storage = storage;
+    storage.SelectMetric(2);
+    CHECK_EQUAL_RANGE(const_storage.GetCell(1, 0).GetOutWeight(1), 3);
+    CHECK_EQUAL_RANGE(const_storage.GetCell(1, 1).GetInWeight(2), 4);
+
+    // dropping metrics keeps the first ones
+    storage.SetNumberOfMetrics(1);
+    BOOST_CHECK_EQUAL(storage.GetNumberOfMetrics(), 1);
+    CHECK_EQUAL_RANGE(storage.GetCell(1, 0).GetOutWeight(1), 1);
+}
+
+// Quantized cells decode to exactly the values they had, including unreachable entries and
+// values too far above the smallest one of their row
+BOOST_AUTO_TEST_CASE(quantized_metrics)
+{
+    // node:                0  1  2  3  4  5  6  7  8  9 10 11
+    std::vector<CellID> l1{{0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5}};
+    std::vector<CellID> l2{{0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 3}};
+    std::vector<CellID> l3{{0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1}};
+    std::vector<CellID> l4{{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+    MultiLevelPartition mlp{{l1, l2, l3, l4}, {6, 4, 2, 1}};
+
+    std::vector<MockEdge> edges = {{0, 1},
+                                   {2, 3},
+                                   {3, 7},
+                                   {4, 0},
+                                   {4, 5},
+                                   {5, 6},
+                                   {6, 4},
+                                   {6, 7},
+                                   {7, 11},
+                                   {8, 9},
+                                   {9, 8},
+                                   {10, 11},
+                                   {11, 10}};
+    auto graph = makeGraph(edges);
+
+    CellStorage storage(mlp, graph);
+    storage.SetNumberOfMetrics(2);
+
+    const auto for_each_row = [&](auto f) {
+        for (LevelID level = 1; level < mlp.GetNumberOfLevels(); ++level)
+            for (CellID id = 0; id < mlp.GetNumberOfCells(level); ++id)
+                for (auto node : storage.GetCell(level, id).GetSourceNodes())
+                    f(level, id, node);
+    };
+
+    EdgeWeight value = 0;
+    for (std::size_t metric = 0; metric < 2; ++metric)
+    {
+        storage.SelectMetric(metric);
+        for_each_row([&](const LevelID level, const CellID id, const NodeID node) {
+            auto cell = storage.GetCell(level, id);
+            auto weight = cell.GetOutWeight(node).begin();
+            auto duration = cell.GetOutDuration(node).begin();
+            auto distance = cell.GetOutDistance(node).begin();
+            for (auto column = 0u; column < cell.GetDestinationNodes().size(); ++column)
+            {
+                ++value;
+                *weight++ = value % 5 == 0 ? INVALID_EDGE_WEIGHT : value;
+                *duration++ = value % 3 == 0 ? 1000000 * value : 2 * value;
+                *distance++ = value;
+            }
+        });
+    }
+
+    const auto collect = [&](const CellStorage &storage) {
+        std::vector<EdgeWeight> values;
+        for (LevelID level = 1; level < mlp.GetNumberOfLevels(); ++level)
+            for (CellID id = 0; id < mlp.GetNumberOfCells(level); ++id)
+            {
+                const auto cell = storage.GetCell(level, id);
+                for (auto node : cell.GetSourceNodes())
+                {
+                    for (auto weight : cell.GetOutWeight(node))
+                        values.push_back(weight);
+                    for (auto duration : cell.GetOutDuration(node))
+                        values.push_back(duration);
+                    for (auto distance : cell.GetOutDistance(node))
+                        values.push_back(distance);
+                }
+                for (auto node : cell.GetDestinationNodes())
+                {
+                    for (auto weight : cell.GetInWeight(node))
+                        values.push_back(weight);
+                    for (auto duration : cell.GetInDuration(node))
+                        values.push_back(duration);
+                }
+            }
+        return values;
+    };
+
+    const CellStorage &const_storage = storage;
+    std::vector<std::vector<EdgeWeight>> exact;
+    for (std::size_t metric = 0; metric < 2; ++metric)
+    {
+        storage.SelectMetric(metric);
+        exact.push_back(collect(const_storage));
+    }
+    BOOST_CHECK(exact[0] != exact[1]);
+
+    storage.Quantize();
+    BOOST_CHECK_EQUAL(storage.GetNumberOfMetrics(), 2);
+    for (std::size_t metric = 0; metric < 2; ++metric)
+    {
+        storage.SelectMetric(metric);
+        const auto quantized = collect(const_storage);
+        CHECK_EQUAL_COLLECTIONS(quantized, exact[metric]);
+    }
+
+    storage.Dequantize();
+    BOOST_CHECK_EQUAL(storage.GetNumberOfMetrics(), 2);
+    for (std::size_t metric = 0; metric < 2; ++metric)
+    {
+        storage.SelectMetric(metric);
+        const auto dequantized = collect(const_storage);
+        CHECK_EQUAL_COLLECTIONS(dequantized, exact[metric]);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
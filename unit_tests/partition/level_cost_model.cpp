@@ -0,0 +1,92 @@
+#include <boost/test/unit_test.hpp>
+
+#include "partition/level_cost_model.hpp"
+#include "util/static_graph.hpp"
+
+using namespace osrm;
+using namespace osrm::partition;
+
+namespace
+{
+struct MockEdge
+{
+    NodeID start;
+    NodeID target;
+};
+
+auto makeGraph(const std::vector<MockEdge> &mock_edges)
+{
+    struct EdgeData
+    {
+        bool forward;
+        bool backward;
+    };
+    using Edge = util::static_graph_details::SortableEdgeWithData<EdgeData>;
+    std::vector<Edge> edges;
+    std::size_t max_id = 0;
+    for (const auto &m : mock_edges)
+    {
+        max_id = std::max<std::size_t>(max_id, std::max(m.start, m.target));
+        edges.push_back(Edge{m.start, m.target, true, false});
+        edges.push_back(Edge{m.target, m.start, false, true});
+    }
+    std::sort(edges.begin(), edges.end());
+    return util::StaticGraph<EdgeData>(max_id + 1, edges);
+}
+
+// a path 0 - 1 - 2 - 3 with 12 edge entries, 2 at the ends and 4 at the inner nodes
+const std::vector<MockEdge> PATH = {{0, 1}, {1, 0}, {1, 2}, {2, 1}, {2, 3}, {3, 2}};
+}
+
+BOOST_AUTO_TEST_SUITE(level_cost_model_tests)
+
+BOOST_AUTO_TEST_CASE(one_cell)
+{
+    const auto graph = makeGraph(PATH);
+    const MultiLevelPartition mlp{{{0, 0, 0, 0}}, {1}};
+    const CellStorage storage(mlp, graph);
+
+    const auto cost = estimateLevelCost(mlp, storage, graph, 100);
+    // every query searches the whole graph, no cell has boundary nodes to customize
+    BOOST_CHECK_EQUAL(cost.query_arcs, 12);
+    BOOST_CHECK_EQUAL(cost.customization_arcs, 0);
+    BOOST_CHECK_EQUAL(cost.cell_storage_bytes, storage.GetMemorySize());
+}
+
+BOOST_AUTO_TEST_CASE(two_cells)
+{
+    const auto graph = makeGraph(PATH);
+    const MultiLevelPartition mlp{{{0, 0, 1, 1}, {0, 0, 0, 0}}, {2, 1}};
+    const CellStorage storage(mlp, graph);
+
+    const auto cost = estimateLevelCost(mlp, storage, graph, 1000);
+    // nodes 1 and 2 are the source and destination of their level 1 cells, each customized
+    // on the 6 edge entries of its cell
+    BOOST_CHECK_EQUAL(cost.customization_arcs, 12);
+    // a query inside one cell relaxes its 6 edges, between the cells the edges of both and the
+    // 2 clique arcs of the level 1 cells
+    BOOST_CHECK_GT(cost.query_arcs, 6);
+    BOOST_CHECK_LT(cost.query_arcs, 14);
+}
+
+BOOST_AUTO_TEST_CASE(recommendation)
+{
+    std::vector<LevelCost> costs(3);
+    costs[0].query_arcs = 10;
+    costs[0].customization_arcs = 10;
+    costs[0].cell_storage_bytes = 100;
+    costs[1].query_arcs = 5;
+    costs[1].customization_arcs = 10;
+    costs[1].cell_storage_bytes = 100;
+    costs[2].query_arcs = 5;
+    costs[2].customization_arcs = 100;
+    costs[2].cell_storage_bytes = 50;
+    BOOST_CHECK_EQUAL(recommendLevelConfiguration(costs), 1);
+
+    // costs of 0 do not decide
+    costs[1].customization_arcs = 0;
+    costs[2].customization_arcs = 0;
+    BOOST_CHECK_EQUAL(recommendLevelConfiguration(costs), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
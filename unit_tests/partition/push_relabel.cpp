@@ -0,0 +1,96 @@
+#include "partition/dinic_max_flow.hpp"
+#include "partition/graph_generator.hpp"
+#include "partition/graph_view.hpp"
+#include "partition/push_relabel_max_flow.hpp"
+
+#include "util/integer_range.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace osrm::partition;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_SUITE(push_relabel_algorithm)
+
+namespace
+{
+// Grid with a few extra edges between random nodes
+BisectionGraph makeGraph(const int rows, const int cols, const std::vector<NodeID> &extra)
+{
+    auto coordinates = makeGridCoordinates(rows, cols, 0.01, 0, 0);
+    auto edges = makeGridEdges(rows, cols, 0);
+    for (std::size_t index = 0; index + 1 < extra.size(); index += 2)
+    {
+        edges.push_back({extra[index], extra[index + 1], 1});
+        edges.push_back({extra[index + 1], extra[index], 1});
+    }
+    groupEdgesBySource(edges.begin(), edges.end());
+    return makeBisectionGraph(coordinates, adaptToBisectionEdge(std::move(edges)));
+}
+
+// number of edges from the source side to the other side
+std::size_t countCutEdges(const GraphView &view, const std::vector<bool> &flags)
+{
+    std::size_t cut_edges = 0;
+    for (const auto node : irange<NodeID>(0, view.NumberOfNodes()))
+        for (const auto &edge : view.Edges(node))
+            cut_edges += flags[node] && !flags[edge.target];
+    return cut_edges;
+}
+}
+
+BOOST_AUTO_TEST_CASE(grid_column_cut)
+{
+    const int rows = 10, cols = 10;
+    const auto graph = makeGraph(rows, cols, {});
+    GraphView view(graph);
+
+    // first and last column
+    DinicMaxFlow::SourceSinkNodes sources, sinks;
+    for (int row = 0; row < rows; ++row)
+    {
+        sources.insert(static_cast<NodeID>(row * cols));
+        sinks.insert(static_cast<NodeID>(row * cols + cols - 1));
+    }
+
+    const auto cut = PushRelabelMaxFlow()(view, sources, sinks);
+    BOOST_CHECK_EQUAL(cut.num_edges, rows);
+    BOOST_CHECK_EQUAL(countCutEdges(view, cut.flags), rows);
+    BOOST_CHECK_EQUAL(cut.num_nodes_source, std::count(cut.flags.begin(), cut.flags.end(), true));
+    for (const auto source : sources)
+        BOOST_CHECK(cut.flags[source]);
+    for (const auto sink : sinks)
+        BOOST_CHECK(!cut.flags[sink]);
+}
+
+BOOST_AUTO_TEST_CASE(same_flow_as_dinic)
+{
+    const int rows = 12, cols = 15;
+    const std::vector<NodeID> extra = {3, 170, 20, 95, 44, 131, 60, 61, 7, 150, 100, 12};
+    const auto graph = makeGraph(rows, cols, extra);
+    GraphView view(graph);
+
+    for (const int width : {1, 2, 4})
+    {
+        DinicMaxFlow::SourceSinkNodes sources, sinks;
+        for (int row = 0; row < rows; ++row)
+        {
+            for (int column = 0; column < width; ++column)
+            {
+                sources.insert(static_cast<NodeID>(row * cols + column));
+                sinks.insert(static_cast<NodeID>(row * cols + cols - 1 - column));
+            }
+        }
+
+        const auto dinic = DinicMaxFlow()(view, sources, sinks);
+        const auto push_relabel = PushRelabelMaxFlow()(view, sources, sinks);
+        BOOST_CHECK_EQUAL(push_relabel.num_edges, dinic.num_edges);
+        BOOST_CHECK_EQUAL(countCutEdges(view, push_relabel.flags), push_relabel.num_edges);
+        BOOST_CHECK_EQUAL(countCutEdges(view, dinic.flags), dinic.num_edges);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
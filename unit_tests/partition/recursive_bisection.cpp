@@ -3,6 +3,8 @@
 #include "partition/recursive_bisection_state.hpp"
 
 #include <algorithm>
+#include <climits>
+#include <map>
 #include <vector>
 
 #include <boost/test/test_case_template.hpp>
@@ -80,4 +82,66 @@ BOOST_AUTO_TEST_CASE(dividing_four_grid_cells)
             BOOST_CHECK(i == j || result[i * (rows * cols)] != result[j * (rows * cols)]);
 }
 
+BOOST_AUTO_TEST_CASE(bisecting_spilled_subtrees)
+{
+    const int rows = 20;
+    const int cols = 20;
+    const std::size_t maximum_cell_size = 30;
+
+    const auto coordinates = makeGridCoordinates(rows, cols, 0.01, 0, 0);
+    auto edges = makeGridEdges(rows, cols, 0);
+    groupEdgesBySource(edges.begin(), edges.end());
+    auto graph = makeBisectionGraph(coordinates, adaptToBisectionEdge(std::move(edges)));
+
+    // only the root cut of the single component on the whole graph
+    RecursiveBisection bisection(
+        graph, maximum_cell_size, 1.1, 0.25, 10, 1, MaxFlowAlgorithm::Dinic, 1);
+    BOOST_REQUIRE_EQUAL(bisection.NumberOfSubtrees(), 2);
+
+    auto result = bisection.BisectionIDs();
+    const auto scc_depth = bisection.SCCDepth();
+    const auto depth = scc_depth + 1;
+
+    std::size_t num_subtree_nodes = 0;
+    for (std::size_t index = 0; index < bisection.NumberOfSubtrees(); ++index)
+    {
+        const auto subtree = bisection.GetSubtree(index);
+        BOOST_CHECK_EQUAL(subtree.depth, depth);
+        BOOST_REQUIRE_EQUAL(subtree.edge_offsets.size(), subtree.original_ids.size() + 1);
+        num_subtree_nodes += subtree.original_ids.size();
+
+        auto subtree_graph = makeBisectionGraph(subtree);
+        BOOST_REQUIRE_EQUAL(subtree_graph.NumberOfNodes(), subtree.original_ids.size());
+        for (NodeID node = 0; node < subtree_graph.NumberOfNodes(); ++node)
+        {
+            BOOST_CHECK(subtree_graph.Node(node).coordinate ==
+                        coordinates[subtree.original_ids[node]]);
+            for (const auto &edge : subtree_graph.Edges(node))
+                BOOST_CHECK(edge.target < subtree_graph.NumberOfNodes());
+        }
+
+        RecursiveBisection subtree_bisection(
+            subtree_graph, subtree, scc_depth, maximum_cell_size, 1.1, 0.25, 10);
+        const auto &subtree_ids = subtree_bisection.BisectionIDs();
+        for (std::size_t node = 0; node < subtree.original_ids.size(); ++node)
+            result[subtree.original_ids[node]] = subtree_ids[node];
+    }
+    BOOST_CHECK_EQUAL(num_subtree_nodes, rows * cols);
+
+    // the subtrees keep the root cut and are bisected down to the cell size
+    const auto top_bits = [&](const BisectionID id) {
+        return id >> (sizeof(BisectionID) * CHAR_BIT - depth);
+    };
+    std::map<BisectionID, std::size_t> cell_sizes;
+    for (const auto id : result)
+        cell_sizes[id]++;
+    for (const auto &cell : cell_sizes)
+        BOOST_CHECK_LT(cell.second, maximum_cell_size);
+    BOOST_CHECK_GT(cell_sizes.size(), rows * cols / maximum_cell_size);
+
+    const auto root_side = bisection.BisectionIDs();
+    for (std::size_t node = 0; node < result.size(); ++node)
+        BOOST_CHECK_EQUAL(top_bits(result[node]), top_bits(root_side[node]));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+#include <boost/test/unit_test.hpp>
+
+#include "partition/shard_plan.hpp"
+#include "util/exception.hpp"
+#include "util/static_graph.hpp"
+
+using namespace osrm;
+using namespace osrm::partition;
+
+namespace
+{
+struct MockEdge
+{
+    NodeID start;
+    NodeID target;
+};
+
+auto makeGraph(const std::vector<MockEdge> &mock_edges)
+{
+    struct EdgeData
+    {
+        bool forward;
+        bool backward;
+    };
+    using Edge = util::static_graph_details::SortableEdgeWithData<EdgeData>;
+    std::vector<Edge> edges;
+    std::size_t max_id = 0;
+    for (const auto &m : mock_edges)
+    {
+        max_id = std::max<std::size_t>(max_id, std::max(m.start, m.target));
+        edges.push_back(Edge{m.start, m.target, true, false});
+        edges.push_back(Edge{m.target, m.start, false, true});
+    }
+    std::sort(edges.begin(), edges.end());
+    return util::StaticGraph<EdgeData>(max_id + 1, edges);
+}
+
+// a path 0 - 1 - 2 - 3 with 12 edge entries, 2 at the ends and 4 at the inner nodes
+const std::vector<MockEdge> PATH = {{0, 1}, {1, 0}, {1, 2}, {2, 1}, {2, 3}, {3, 2}};
+}
+
+BOOST_AUTO_TEST_SUITE(shard_plan_tests)
+
+BOOST_AUTO_TEST_CASE(balanced_by_edges)
+{
+    const auto graph = makeGraph(PATH);
+    const MultiLevelPartition mlp{{{0, 1, 2, 3}, {0, 0, 1, 1}}, {4, 2}};
+    const CellStorage storage(mlp, graph);
+
+    // the top level cells hold 6 edges each, both nodes of a cell are its boundary nodes
+    const auto plan = planShards(mlp, storage, graph, 2);
+    BOOST_CHECK_EQUAL(plan.cell_to_shard.size(), 2);
+    BOOST_CHECK_EQUAL(plan.cell_to_shard[0], 0);
+    BOOST_CHECK_EQUAL(plan.cell_to_shard[1], 1);
+    BOOST_CHECK_EQUAL(plan.shard_nodes[0], 2);
+    BOOST_CHECK_EQUAL(plan.shard_nodes[1], 2);
+    BOOST_CHECK_EQUAL(plan.shard_edges[0], 6);
+    BOOST_CHECK_EQUAL(plan.shard_edges[1], 6);
+    BOOST_CHECK_EQUAL(plan.overlay_nodes, 2);
+    BOOST_CHECK_EQUAL(plan.overlay_cell_storage_bytes, storage.GetMemorySize());
+}
+
+// every shard gets a cell even if the first ones did not reach their share of the edges yet
+BOOST_AUTO_TEST_CASE(one_cell_per_shard)
+{
+    const auto graph = makeGraph(PATH);
+    const MultiLevelPartition mlp{{{0, 1, 2, 3}}, {4}};
+    const CellStorage storage(mlp, graph);
+
+    const auto plan = planShards(mlp, storage, graph, 3);
+    BOOST_CHECK_EQUAL(plan.cell_to_shard[0], 0);
+    BOOST_CHECK_EQUAL(plan.cell_to_shard[1], 0);
+    BOOST_CHECK_EQUAL(plan.cell_to_shard[2], 1);
+    BOOST_CHECK_EQUAL(plan.cell_to_shard[3], 2);
+    BOOST_CHECK_EQUAL(plan.shard_edges[0], 6);
+    BOOST_CHECK_EQUAL(plan.shard_edges[1], 4);
+    BOOST_CHECK_EQUAL(plan.shard_edges[2], 2);
+    BOOST_CHECK_EQUAL(plan.overlay_nodes, 4);
+
+    BOOST_CHECK_THROW(planShards(mlp, storage, graph, 5), util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,121 @@
+#include "server/access_log.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(access_log)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+AccessRecord makeRecord(const std::string &request)
+{
+    AccessRecord record;
+    record.time = std::time(nullptr);
+    record.duration_ms = 1.5;
+    record.endpoint = "127.0.0.1";
+    record.agent = "curl";
+    record.status = 200;
+    record.request = request;
+    return record;
+}
+}
+
+BOOST_AUTO_TEST_CASE(format)
+{
+    auto record = makeRecord("/route/v1/driving/7.41,43.73;7.42,43.74");
+    std::tm time_stamp = {};
+    time_stamp.tm_mday = 5;
+    time_stamp.tm_mon = 2;
+    time_stamp.tm_year = 117;
+    time_stamp.tm_hour = 9;
+    time_stamp.tm_min = 7;
+    time_stamp.tm_sec = 3;
+    time_stamp.tm_isdst = -1;
+    record.time = std::mktime(&time_stamp);
+
+    BOOST_CHECK_EQUAL(formatAccessRecord(record),
+                      "05-03-2017 09:07:03 1.5ms 127.0.0.1 - curl 200 "
+                      "/route/v1/driving/7.41,43.73;7.42,43.74");
+
+    record.referrer = "osrm.org";
+    record.agent.clear();
+    record.status = 400;
+    BOOST_CHECK_EQUAL(formatAccessRecord(record),
+                      "05-03-2017 09:07:03 1.5ms 127.0.0.1 osrm.org - 400 "
+                      "/route/v1/driving/7.41,43.73;7.42,43.74");
+}
+
+BOOST_AUTO_TEST_CASE(all_threads)
+{
+    std::mutex mutex;
+    std::vector<std::string> lines;
+    {
+        AccessLog log(1024, [&](const std::string &line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+        });
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < 4; ++thread)
+        {
+            threads.emplace_back([&log, thread] {
+                for (int request = 0; request < 100; ++request)
+                {
+                    log.Log(makeRecord("/" + std::to_string(thread) + "/" +
+                                       std::to_string(request)));
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        BOOST_CHECK_EQUAL(log.GetDroppedRecords(), 0);
+    }
+
+    // the destructor writes what is still buffered
+    BOOST_REQUIRE_EQUAL(lines.size(), 400);
+    std::set<std::string> requests;
+    for (const auto &line : lines)
+        requests.insert(line.substr(line.rfind(' ') + 1));
+    BOOST_CHECK_EQUAL(requests.size(), 400);
+}
+
+BOOST_AUTO_TEST_CASE(full_ring_drops)
+{
+    std::mutex mutex;
+    std::condition_variable blocked;
+    bool writing = false;
+    bool release = false;
+
+    AccessLog log(4, [&](const std::string &) {
+        std::unique_lock<std::mutex> lock(mutex);
+        writing = true;
+        blocked.notify_all();
+        blocked.wait(lock, [&] { return release; });
+    });
+
+    // the writer blocks on the first record, which keeps its slot until it is written
+    log.Log(makeRecord("/0"));
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        blocked.wait(lock, [&] { return writing; });
+    }
+    for (int request = 1; request < 10; ++request)
+        log.Log(makeRecord("/" + std::to_string(request)));
+    BOOST_CHECK_EQUAL(log.GetDroppedRecords(), 6);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    blocked.notify_all();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
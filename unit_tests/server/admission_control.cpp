@@ -0,0 +1,89 @@
+#include "server/admission_control.hpp"
+#include "server/api/parsed_url.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(admission_control)
+
+using namespace osrm;
+using namespace osrm::server;
+
+BOOST_AUTO_TEST_CASE(request_cost_estimate)
+{
+    api::ParsedURL url;
+    url.query = "1,2;3,4;5,6?annotations=true;foo=bar";
+    BOOST_CHECK_EQUAL(EstimateRequestCost(url), 3);
+
+    url.query = "1,2";
+    BOOST_CHECK_EQUAL(EstimateRequestCost(url), 1);
+
+    url.query = "polyline(" + std::string(80, 'a') + ")?steps=true";
+    BOOST_CHECK_EQUAL(EstimateRequestCost(url), 10);
+}
+
+BOOST_AUTO_TEST_CASE(unlimited_service)
+{
+    AdmissionControl control;
+    control.SetLimits("table", {10, 0, std::chrono::milliseconds(0)});
+
+    const auto first = control.Admit("route", 1000);
+    const auto second = control.Admit("route", 1000);
+    BOOST_CHECK(first.IsAdmitted());
+    BOOST_CHECK(second.IsAdmitted());
+}
+
+BOOST_AUTO_TEST_CASE(shed_without_queue)
+{
+    AdmissionControl control;
+    control.SetLimits("table", {10, 0, std::chrono::milliseconds(0)});
+
+    {
+        const auto first = control.Admit("table", 6);
+        BOOST_CHECK(first.IsAdmitted());
+        const auto second = control.Admit("table", 4);
+        BOOST_CHECK(second.IsAdmitted());
+        const auto third = control.Admit("table", 1);
+        BOOST_CHECK(!third.IsAdmitted());
+    }
+
+    // budget is returned once tickets go out of scope, oversized requests run on their own
+    const auto large = control.Admit("table", 1000);
+    BOOST_CHECK(large.IsAdmitted());
+    const auto small = control.Admit("table", 1);
+    BOOST_CHECK(!small.IsAdmitted());
+}
+
+BOOST_AUTO_TEST_CASE(queued_request_is_admitted_after_release)
+{
+    AdmissionControl control;
+    control.SetLimits("match", {1, 1, std::chrono::milliseconds(5000)});
+
+    auto running = control.Admit("match", 1);
+    BOOST_REQUIRE(running.IsAdmitted());
+
+    std::thread releaser([&running] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        running = AdmissionControl::Ticket();
+    });
+
+    const auto queued = control.Admit("match", 1);
+    BOOST_CHECK(queued.IsAdmitted());
+    releaser.join();
+}
+
+BOOST_AUTO_TEST_CASE(queued_request_times_out)
+{
+    AdmissionControl control;
+    control.SetLimits("trip", {1, 1, std::chrono::milliseconds(10)});
+
+    const auto running = control.Admit("trip", 1);
+    BOOST_REQUIRE(running.IsAdmitted());
+    const auto queued = control.Admit("trip", 1);
+    BOOST_CHECK(!queued.IsAdmitted());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+#include "server/http/body_stream.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(body_stream)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+std::vector<char> makePiece(const std::string &text) { return {text.begin(), text.end()}; }
+
+std::string toString(const std::vector<char> &piece) { return {piece.begin(), piece.end()}; }
+}
+
+BOOST_AUTO_TEST_CASE(pieces_in_order)
+{
+    http::body_stream stream(0);
+    auto first = makePiece("first");
+    auto second = makePiece("second");
+    BOOST_CHECK(stream.write(first));
+    BOOST_CHECK(stream.write(second));
+    BOOST_CHECK(first.empty());
+
+    std::vector<char> piece;
+    BOOST_CHECK(stream.read(piece, nullptr) == http::body_stream::read_result::piece);
+    BOOST_CHECK_EQUAL(toString(piece), "first");
+    BOOST_CHECK(stream.read(piece, nullptr) == http::body_stream::read_result::piece);
+    BOOST_CHECK_EQUAL(toString(piece), "second");
+
+    bool ready = false;
+    BOOST_CHECK(stream.read(piece, [&ready]() { ready = true; }) ==
+                http::body_stream::read_result::pending);
+    stream.finish(true);
+    BOOST_CHECK(ready);
+    BOOST_CHECK(stream.read(piece, nullptr) == http::body_stream::read_result::finished);
+}
+
+BOOST_AUTO_TEST_CASE(failed_after_pieces)
+{
+    http::body_stream stream(0);
+    auto first = makePiece("first");
+    BOOST_CHECK(stream.write(first));
+    stream.finish(false);
+
+    // the pieces that were written are sent before the body is cut off
+    std::vector<char> piece;
+    BOOST_CHECK(stream.read(piece, nullptr) == http::body_stream::read_result::piece);
+    BOOST_CHECK(stream.read(piece, nullptr) == http::body_stream::read_result::failed);
+}
+
+BOOST_AUTO_TEST_CASE(ready_on_write)
+{
+    http::body_stream stream(1);
+    std::vector<char> piece;
+    std::promise<void> ready;
+    BOOST_CHECK(stream.read(piece, [&ready]() { ready.set_value(); }) ==
+                http::body_stream::read_result::pending);
+
+    std::thread producer([&stream]() {
+        auto first = makePiece("first");
+        stream.write(first);
+    });
+    ready.get_future().wait();
+    producer.join();
+    BOOST_CHECK(stream.read(piece, nullptr) == http::body_stream::read_result::piece);
+    BOOST_CHECK_EQUAL(toString(piece), "first");
+}
+
+BOOST_AUTO_TEST_CASE(full_stream_blocks_until_read)
+{
+    http::body_stream stream(1);
+    auto first = makePiece("first");
+    BOOST_CHECK(stream.write(first));
+
+    auto second_written = std::async(std::launch::async, [&stream]() {
+        auto second = makePiece("second");
+        return stream.write(second);
+    });
+    BOOST_CHECK(second_written.wait_for(std::chrono::milliseconds(50)) ==
+                std::future_status::timeout);
+
+    std::vector<char> piece;
+    BOOST_CHECK(stream.read(piece, nullptr) == http::body_stream::read_result::piece);
+    BOOST_CHECK(second_written.get());
+    BOOST_CHECK(stream.read(piece, nullptr) == http::body_stream::read_result::piece);
+    BOOST_CHECK_EQUAL(toString(piece), "second");
+}
+
+BOOST_AUTO_TEST_CASE(cancel_unblocks_writer)
+{
+    http::body_stream stream(1);
+    auto first = makePiece("first");
+    BOOST_CHECK(stream.write(first));
+
+    auto second_written = std::async(std::launch::async, [&stream]() {
+        auto second = makePiece("second");
+        return stream.write(second);
+    });
+    stream.cancel();
+    BOOST_CHECK(!second_written.get());
+
+    auto third = makePiece("third");
+    BOOST_CHECK(!stream.write(third));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+#include "server/http/compressor.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <zlib.h>
+
+#ifdef USE_BROTLI_LIBRARY
+#include <brotli/decode.h>
+#endif
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(http_compressor)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+std::vector<char> makeInput()
+{
+    std::vector<char> input;
+    for (int i = 0; i < 20000; ++i)
+    {
+        const auto number = std::to_string(i * 7919 % 10007);
+        input.insert(input.end(), number.begin(), number.end());
+        input.push_back(',');
+    }
+    return input;
+}
+
+std::vector<char> inflateAll(const std::vector<char> &compressed, const int window_bits)
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    BOOST_REQUIRE_EQUAL(inflateInit2(&stream, window_bits), Z_OK);
+
+    std::vector<char> output;
+    std::vector<char> buffer(4096);
+    int result = Z_OK;
+    while (result == Z_OK)
+    {
+        stream.next_out = reinterpret_cast<Bytef *>(buffer.data());
+        stream.avail_out = static_cast<uInt>(buffer.size());
+        result = inflate(&stream, Z_NO_FLUSH);
+        output.insert(output.end(), buffer.data(), buffer.data() + buffer.size() - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    BOOST_CHECK_EQUAL(result, Z_STREAM_END);
+    return output;
+}
+}
+
+BOOST_AUTO_TEST_CASE(chunked_gzip_roundtrip)
+{
+    const auto input = makeInput();
+    http::compressor compressor;
+
+    // run twice to make sure the reused stream is reset properly
+    for (int run = 0; run < 2; ++run)
+    {
+        BOOST_REQUIRE(compressor.reset(http::gzip_rfc1952, input));
+
+        std::vector<char> compressed, chunk;
+        bool finished = false;
+        std::size_t num_chunks = 0;
+        while (!finished)
+        {
+            finished = compressor.compress_chunk(chunk, 1024);
+            BOOST_CHECK_LE(chunk.size(), 1024);
+            compressed.insert(compressed.end(), chunk.begin(), chunk.end());
+            ++num_chunks;
+        }
+        BOOST_CHECK_GT(num_chunks, 1);
+
+        const auto decompressed = inflateAll(compressed, MAX_WBITS + 16);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            decompressed.begin(), decompressed.end(), input.begin(), input.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(deflate_roundtrip)
+{
+    const auto input = makeInput();
+    http::compressor compressor;
+
+    // switch the container type on the same compressor
+    BOOST_REQUIRE(compressor.reset(http::gzip_rfc1952, input));
+    BOOST_REQUIRE(compressor.reset(http::deflate_rfc1951, input));
+
+    std::vector<char> compressed;
+    compressor.compress_all(compressed);
+    BOOST_CHECK_LT(compressed.size(), input.size());
+
+    const auto decompressed = inflateAll(compressed, -MAX_WBITS);
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        decompressed.begin(), decompressed.end(), input.begin(), input.end());
+}
+
+BOOST_AUTO_TEST_CASE(accept_encoding_negotiation)
+{
+    BOOST_CHECK_EQUAL(http::negotiate_compression(""), http::no_compression);
+    BOOST_CHECK_EQUAL(http::negotiate_compression("identity"), http::no_compression);
+    BOOST_CHECK_EQUAL(http::negotiate_compression("deflate"), http::deflate_rfc1951);
+    BOOST_CHECK_EQUAL(http::negotiate_compression("deflate, gzip"), http::gzip_rfc1952);
+    BOOST_CHECK_EQUAL(http::negotiate_compression("GZIP"), http::gzip_rfc1952);
+    // explicit q-values win over the default preference
+    BOOST_CHECK_EQUAL(http::negotiate_compression("gzip;q=0.5, deflate"), http::deflate_rfc1951);
+    BOOST_CHECK_EQUAL(http::negotiate_compression("gzip;q=0, deflate;q=0"), http::no_compression);
+
+    const auto expected_br =
+        http::is_supported(http::brotli_rfc7932) ? http::brotli_rfc7932 : http::gzip_rfc1952;
+    BOOST_CHECK_EQUAL(http::negotiate_compression("gzip, deflate, br"), expected_br);
+
+    const auto expected_zstd =
+        http::is_supported(http::zstd_rfc8478) ? http::zstd_rfc8478 : http::gzip_rfc1952;
+    BOOST_CHECK_EQUAL(http::negotiate_compression("zstd, gzip"), expected_zstd);
+}
+
+#ifdef USE_BROTLI_LIBRARY
+BOOST_AUTO_TEST_CASE(chunked_brotli_roundtrip)
+{
+    const auto input = makeInput();
+    http::compressor compressor;
+    BOOST_REQUIRE(compressor.reset(http::brotli_rfc7932, input));
+
+    std::vector<char> compressed, chunk;
+    bool finished = false;
+    while (!finished)
+    {
+        finished = compressor.compress_chunk(chunk, 512);
+        compressed.insert(compressed.end(), chunk.begin(), chunk.end());
+    }
+
+    std::vector<char> decompressed(input.size());
+    std::size_t decompressed_size = decompressed.size();
+    BOOST_REQUIRE_EQUAL(
+        BrotliDecoderDecompress(compressed.size(),
+                                reinterpret_cast<const std::uint8_t *>(compressed.data()),
+                                &decompressed_size,
+                                reinterpret_cast<std::uint8_t *>(decompressed.data())),
+        BROTLI_DECODER_RESULT_SUCCESS);
+    BOOST_CHECK_EQUAL(decompressed_size, input.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        decompressed.begin(), decompressed.end(), input.begin(), input.end());
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+#include "server/metrics.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(server_metrics)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+bool contains(const std::string &haystack, const std::string &needle)
+{
+    return haystack.find(needle) != std::string::npos;
+}
+}
+
+BOOST_AUTO_TEST_CASE(service_index)
+{
+    Metrics metrics({"route", "table"});
+    BOOST_CHECK_EQUAL(metrics.ServiceIndex("route"), 0);
+    BOOST_CHECK_EQUAL(metrics.ServiceIndex("table"), 1);
+    BOOST_CHECK_EQUAL(metrics.ServiceIndex("unknown"), 2);
+    BOOST_CHECK_EQUAL(metrics.ServiceIndex(""), 2);
+}
+
+BOOST_AUTO_TEST_CASE(render_prometheus)
+{
+    Metrics metrics({"route", "table"});
+    const auto route = metrics.ServiceIndex("route");
+    const auto table = metrics.ServiceIndex("table");
+
+    metrics.RequestStarted(route);
+    metrics.RequestFinished(route, Metrics::RequestStatus::Ok, std::chrono::milliseconds(3));
+    metrics.ReplySent(route, 1000, 250);
+
+    metrics.RequestStarted(table);
+    metrics.RequestStarted(table);
+    metrics.RequestFinished(table, Metrics::RequestStatus::Rejected, std::chrono::seconds(20));
+
+    const auto rendered = metrics.RenderPrometheus();
+    BOOST_CHECK(contains(rendered, "# TYPE osrm_requests_total counter"));
+    BOOST_CHECK(contains(rendered, "osrm_requests_total{service=\"route\",status=\"ok\"} 1\n"));
+    BOOST_CHECK(contains(rendered, "osrm_requests_total{service=\"route\",status=\"error\"} 0\n"));
+    BOOST_CHECK(
+        contains(rendered, "osrm_requests_total{service=\"table\",status=\"rejected\"} 1\n"));
+    BOOST_CHECK(contains(rendered, "osrm_requests_in_flight{service=\"route\"} 0\n"));
+    BOOST_CHECK(contains(rendered, "osrm_requests_in_flight{service=\"table\"} 1\n"));
+
+    // 3ms falls into the 5ms bucket, buckets are cumulative
+    const std::string bucket = "osrm_request_duration_seconds_bucket";
+    BOOST_CHECK(contains(rendered, bucket + "{service=\"route\",le=\"0.002\"} 0\n"));
+    BOOST_CHECK(contains(rendered, bucket + "{service=\"route\",le=\"0.005\"} 1\n"));
+    BOOST_CHECK(contains(rendered, bucket + "{service=\"route\",le=\"10\"} 1\n"));
+    BOOST_CHECK(contains(rendered, bucket + "{service=\"table\",le=\"10\"} 0\n"));
+    BOOST_CHECK(contains(rendered, bucket + "{service=\"table\",le=\"+Inf\"} 1\n"));
+    BOOST_CHECK(
+        contains(rendered, "osrm_request_duration_seconds_sum{service=\"route\"} 0.003000\n"));
+    BOOST_CHECK(
+        contains(rendered, "osrm_request_duration_seconds_count{service=\"table\"} 1\n"));
+
+    BOOST_CHECK(contains(rendered, "osrm_response_bytes_total{service=\"route\"} 1000\n"));
+    BOOST_CHECK(contains(rendered, "osrm_sent_bytes_total{service=\"route\"} 250\n"));
+    BOOST_CHECK(contains(rendered, "osrm_compression_ratio{service=\"route\"} 0.25\n"));
+}
+
+BOOST_AUTO_TEST_CASE(render_engine_statistics)
+{
+    engine::EngineStatistics statistics;
+    statistics.route_cache = util::CacheStatistics{7, 3, 1, 2, 100};
+    statistics.snapping_cache = util::CacheStatistics{0, 0, 0, 0, 0};
+    statistics.unpacking_cache = util::CacheStatistics{40, 2, 0, 2, 64};
+    statistics.tile_cache = util::CacheStatistics{12, 4, 0, 4, 1000};
+    statistics.coalesced_requests = 5;
+    statistics.data_updates = engine::DataUpdateStatistics{2, 3500000, 500000, 3, 4096};
+
+    const auto rendered = Metrics::RenderPrometheus(statistics);
+    BOOST_CHECK(contains(rendered, "# TYPE osrm_cache_hits_total counter"));
+    BOOST_CHECK(contains(rendered, "osrm_cache_hits_total{cache=\"route\"} 7\n"));
+    BOOST_CHECK(contains(rendered, "osrm_cache_misses_total{cache=\"route\"} 3\n"));
+    BOOST_CHECK(contains(rendered, "osrm_cache_evictions_total{cache=\"route\"} 1\n"));
+    BOOST_CHECK(contains(rendered, "# TYPE osrm_cache_entries gauge"));
+    BOOST_CHECK(contains(rendered, "osrm_cache_entries{cache=\"route\"} 2\n"));
+    BOOST_CHECK(contains(rendered, "osrm_cache_capacity{cache=\"route\"} 100\n"));
+    BOOST_CHECK(contains(rendered, "osrm_cache_capacity{cache=\"snapping\"} 0\n"));
+    BOOST_CHECK(contains(rendered, "osrm_cache_hits_total{cache=\"unpacking\"} 40\n"));
+    BOOST_CHECK(contains(rendered, "osrm_cache_misses_total{cache=\"tile\"} 4\n"));
+    BOOST_CHECK(contains(rendered, "osrm_coalesced_requests_total 5\n"));
+    BOOST_CHECK(contains(rendered, "osrm_data_update_seconds_sum 3.500000\n"));
+    BOOST_CHECK(contains(rendered, "osrm_data_update_seconds_count 2\n"));
+    BOOST_CHECK(contains(rendered, "osrm_data_update_last_seconds 0.500000\n"));
+    BOOST_CHECK(contains(rendered, "# TYPE osrm_data_generations gauge"));
+    BOOST_CHECK(contains(rendered, "osrm_data_generations 3\n"));
+    BOOST_CHECK(contains(rendered, "osrm_data_generation_bytes 4096\n"));
+    // only engines built with search statistics have search metrics
+    BOOST_CHECK_EQUAL(contains(rendered, "osrm_search_settled_nodes_total"),
+                      engine::SearchTracing::enabled);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_recording)
+{
+    Metrics metrics({"route"});
+    const auto route = metrics.ServiceIndex("route");
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&metrics, route] {
+            for (int j = 0; j < 1000; ++j)
+            {
+                metrics.RequestStarted(route);
+                metrics.RequestFinished(
+                    route, Metrics::RequestStatus::Ok, std::chrono::microseconds(10));
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto rendered = metrics.RenderPrometheus();
+    BOOST_CHECK(contains(rendered, "osrm_requests_total{service=\"route\",status=\"ok\"} 4000\n"));
+    BOOST_CHECK(contains(rendered, "osrm_requests_in_flight{service=\"route\"} 0\n"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
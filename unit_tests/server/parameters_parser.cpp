@@ -1,8 +1,10 @@
 #include "server/api/parameters_parser.hpp"
+#include "server/api/binary_parameters_parser.hpp"
 
 #include "parameters_io.hpp"
 
 #include "engine/api/base_parameters.hpp"
+#include "engine/api/isochrone_parameters.hpp"
 #include "engine/api/match_parameters.hpp"
 #include "engine/api/nearest_parameters.hpp"
 #include "engine/api/route_parameters.hpp"
@@ -53,6 +55,7 @@ BOOST_AUTO_TEST_CASE(invalid_route_urls)
                       32UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?generate_hints=notboolean"),
                       23UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?output_format=xml"), 22UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&geometries=foo"),
                       34UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&overview=foo"),
@@ -74,6 +77,7 @@ BOOST_AUTO_TEST_CASE(invalid_route_urls)
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?annotations=true,false"), 24UL);
     BOOST_CHECK_EQUAL(
         testInvalidOptions<RouteParameters>("1,2;3,4?annotations=&overview=simplified"), 20UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?reroute=1"), 16UL);
 
     // BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>(), );
 }
@@ -86,6 +90,10 @@ BOOST_AUTO_TEST_CASE(invalid_table_urls)
         testInvalidOptions<TableParameters>("1,2;3,4?sources=1&destinations=1&bla=foo"), 32UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?sources=foo"), 16UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?destinations=foo"), 21UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?annotations=speed"), 20UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?paths="), 14UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?paths=0;1"), 15UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?paths=0,1;"), 17UL);
 }
 
 BOOST_AUTO_TEST_CASE(valid_route_hint)
@@ -336,6 +344,51 @@ BOOST_AUTO_TEST_CASE(valid_route_urls)
     auto result_13 = parseParameters<RouteParameters>("1,2;3,4");
     BOOST_CHECK(result_13);
     BOOST_CHECK_EQUAL(result_13->generate_hints, true);
+    BOOST_CHECK_EQUAL(result_13->compact_hints, false);
+
+    // Compact hints are accepted next to the fixed size ones
+    auto result_compact = parseParameters<RouteParameters>(
+        "1,2;3,4;5,6?compact_hints=true&hints=" + hints_4[0]->ToCompactBase64() + ";;" +
+        hints_4[2]->ToBase64());
+    BOOST_CHECK(result_compact);
+    BOOST_CHECK_EQUAL(result_compact->compact_hints, true);
+    BOOST_REQUIRE_EQUAL(result_compact->hints.size(), 3);
+    BOOST_CHECK(result_compact->hints[0] == hints_4[0]);
+    BOOST_CHECK(!result_compact->hints[1]);
+    BOOST_CHECK(result_compact->hints[2] == hints_4[2]);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?hints=.AAAA;"), 19UL);
+    BOOST_CHECK(result_13->output_format == RouteParameters::OutputFormatType::JSON);
+
+    auto result_binary = parseParameters<RouteParameters>("1,2;3,4?output_format=binary");
+    BOOST_CHECK(result_binary);
+    BOOST_CHECK(result_binary->output_format == RouteParameters::OutputFormatType::Binary);
+
+    BOOST_CHECK_EQUAL(result_13->metric, 0);
+    auto result_metric = parseParameters<RouteParameters>("1,2;3,4?metric=2");
+    BOOST_CHECK(result_metric);
+    BOOST_CHECK_EQUAL(result_metric->metric, 2);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?metric=-1"), 15UL);
+
+    BOOST_CHECK(result_13->exclude.empty());
+    auto result_exclude = parseParameters<RouteParameters>("1,2;3,4?exclude=toll,motorway");
+    BOOST_CHECK(result_exclude);
+    const std::vector<std::string> reference_exclude{"toll", "motorway"};
+    CHECK_EQUAL_RANGE(result_exclude->exclude, reference_exclude);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?exclude=toll,"), 20UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?exclude="), 16UL);
+
+    BOOST_CHECK(!result_13->departure_time);
+    auto result_departure =
+        parseParameters<RouteParameters>("1,2;3,4?departure_time=1500000000");
+    BOOST_CHECK(result_departure);
+    BOOST_CHECK_EQUAL(result_departure->departure_time.value_or(0), 1500000000);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?departure_time=-1"), 23UL);
+
+    BOOST_CHECK(!result_13->debug_stats);
+    auto result_debug = parseParameters<RouteParameters>("1,2;3,4?debug=stats");
+    BOOST_CHECK(result_debug);
+    BOOST_CHECK(result_debug->debug_stats);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?debug=all"), 14UL);
 
     // parse none annotations value correctly
     RouteParameters reference_14{};
@@ -471,6 +524,11 @@ BOOST_AUTO_TEST_CASE(valid_route_urls)
     CHECK_EQUAL_RANGE(reference_20.approaches, result_20->approaches);
     CHECK_EQUAL_RANGE(reference_20.coordinates, result_20->coordinates);
     CHECK_EQUAL_RANGE(reference_20.hints, result_20->hints);
+
+    auto result_21 = parseParameters<RouteParameters>("1,2;3,4?reroute=true");
+    BOOST_CHECK(result_21);
+    BOOST_CHECK(result_21->reroute);
+    BOOST_CHECK(!result_20->reroute);
 }
 
 BOOST_AUTO_TEST_CASE(valid_table_urls)
@@ -510,6 +568,22 @@ BOOST_AUTO_TEST_CASE(valid_table_urls)
     CHECK_EQUAL_RANGE(reference_1.radiuses, result_3->radiuses);
     CHECK_EQUAL_RANGE(reference_1.approaches, result_3->approaches);
     CHECK_EQUAL_RANGE(reference_1.coordinates, result_3->coordinates);
+
+    BOOST_CHECK(result_1->annotations == TableParameters::AnnotationsType::Duration);
+    auto result_4 = parseParameters<TableParameters>("1,2;3,4?annotations=distance");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK(result_4->annotations == TableParameters::AnnotationsType::Distance);
+    auto result_5 = parseParameters<TableParameters>("1,2;3,4?annotations=distance,duration");
+    BOOST_CHECK(result_5);
+    BOOST_CHECK(result_5->annotations == TableParameters::AnnotationsType::All);
+
+    BOOST_CHECK(result_1->paths.empty());
+    auto result_6 = parseParameters<TableParameters>("1,2;3,4?paths=0,1;1,0&sources=0");
+    BOOST_CHECK(result_6);
+    std::vector<std::pair<std::size_t, std::size_t>> paths_6 = {{0, 1}, {1, 0}};
+    BOOST_CHECK(result_6->paths == paths_6);
+    std::vector<std::size_t> sources_6 = {0};
+    CHECK_EQUAL_RANGE(sources_6, result_6->sources);
 }
 
 BOOST_AUTO_TEST_CASE(valid_match_urls)
@@ -537,6 +611,25 @@ BOOST_AUTO_TEST_CASE(valid_match_urls)
     CHECK_EQUAL_RANGE(reference_2.radiuses, result_2->radiuses);
     CHECK_EQUAL_RANGE(reference_2.approaches, result_2->approaches);
     CHECK_EQUAL_RANGE(reference_2.coordinates, result_2->coordinates);
+
+    // a session is extended by any number of coordinates
+    auto result_3 = parseParameters<MatchParameters>("1,2?session=vehicle_1-a&timestamps=5");
+    BOOST_CHECK(result_3);
+    BOOST_CHECK_EQUAL(result_3->session, "vehicle_1-a");
+    BOOST_CHECK(result_3->IsValid());
+    auto result_4 = parseParameters<MatchParameters>("1,2");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK(result_4->session.empty());
+    BOOST_CHECK(!result_4->IsValid());
+}
+
+BOOST_AUTO_TEST_CASE(invalid_match_session_urls)
+{
+    BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?session="), 16UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?session=a.b"), 17UL);
+    auto result = parseParameters<MatchParameters>("1,2;3,4?session=a&tidy=true");
+    BOOST_CHECK(result);
+    BOOST_CHECK(!result->IsValid());
 }
 
 BOOST_AUTO_TEST_CASE(valid_nearest_urls)
@@ -587,6 +680,39 @@ BOOST_AUTO_TEST_CASE(valid_tile_urls)
     BOOST_CHECK_EQUAL(reference_1.z, result_1->z);
 }
 
+BOOST_AUTO_TEST_CASE(valid_isochrone_urls)
+{
+    std::vector<util::Coordinate> coords_1 = {{util::FloatLongitude{1}, util::FloatLatitude{2}}};
+
+    auto result_1 = parseParameters<IsochroneParameters>("1,2?contours=300;600;900");
+    BOOST_CHECK(result_1);
+    BOOST_CHECK(result_1->IsValid());
+    CHECK_EQUAL_RANGE(coords_1, result_1->coordinates);
+    const std::vector<unsigned> contours_1 = {300, 600, 900};
+    CHECK_EQUAL_RANGE(contours_1, result_1->contours);
+    BOOST_CHECK(result_1->polygons);
+    BOOST_CHECK(!result_1->tile);
+
+    auto result_2 =
+        parseParameters<IsochroneParameters>("1,2?contours=600&polygons=false&tile=1,2,3");
+    BOOST_CHECK(result_2);
+    BOOST_CHECK(result_2->IsValid());
+    BOOST_CHECK(!result_2->polygons);
+    BOOST_CHECK(result_2->tile);
+    BOOST_CHECK_EQUAL(result_2->tile->x, 1);
+    BOOST_CHECK_EQUAL(result_2->tile->y, 2);
+    BOOST_CHECK_EQUAL(result_2->tile->z, 3);
+
+    // contours have to be ascending, tiles within their zoom level, one coordinate only
+    BOOST_CHECK(!parseParameters<IsochroneParameters>("1,2?contours=600;300")->IsValid());
+    BOOST_CHECK(!parseParameters<IsochroneParameters>("1,2?contours=0")->IsValid());
+    BOOST_CHECK(!parseParameters<IsochroneParameters>("1,2")->IsValid());
+    BOOST_CHECK(
+        !parseParameters<IsochroneParameters>("1,2?contours=600&tile=8,2,3")->IsValid());
+    BOOST_CHECK(!parseParameters<IsochroneParameters>("1,2;3,4?contours=600")->IsValid());
+    BOOST_CHECK_EQUAL(testInvalidOptions<IsochroneParameters>("1,2?contours=600;"), 16UL);
+}
+
 BOOST_AUTO_TEST_CASE(valid_trip_urls)
 {
     std::vector<util::Coordinate> coords_1 = {{util::FloatLongitude{1}, util::FloatLatitude{2}},
@@ -635,4 +761,94 @@ BOOST_AUTO_TEST_CASE(valid_trip_urls)
     BOOST_CHECK_EQUAL(param_fail_2, 33UL);
 }
 
+template <typename T> void appendBinary(std::string &body, const T value)
+{
+    body.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+BOOST_AUTO_TEST_CASE(binary_body)
+{
+    std::string body;
+    appendBinary<std::uint32_t>(body, 2);
+    appendBinary<std::uint32_t>(body, BINARY_RADIUSES | BINARY_BEARINGS);
+    appendBinary<std::int32_t>(body, 13388860);
+    appendBinary<std::int32_t>(body, 52517037);
+    appendBinary<std::int32_t>(body, 13397634);
+    appendBinary<std::int32_t>(body, 52529407);
+    appendBinary<double>(body, 5.5);
+    appendBinary<double>(body, std::numeric_limits<double>::quiet_NaN());
+    appendBinary<std::int16_t>(body, -1);
+    appendBinary<std::int16_t>(body, 0);
+    appendBinary<std::int16_t>(body, 200);
+    appendBinary<std::int16_t>(body, 10);
+
+    auto body_parameters = parseBinaryParameters(body);
+    BOOST_REQUIRE(body_parameters);
+
+    std::string query = ".json?sources=0&radiuses=1;2";
+    auto iter = query.begin();
+    auto result = parseParameters<TableParameters>(iter, query.end(), std::move(*body_parameters));
+    BOOST_REQUIRE(result);
+
+    std::vector<util::Coordinate> coordinates = {{util::FloatLongitude{13.388860},
+                                                  util::FloatLatitude{52.517037}},
+                                                 {util::FloatLongitude{13.397634},
+                                                  util::FloatLatitude{52.529407}}};
+    std::vector<boost::optional<double>> radiuses = {5.5, boost::none};
+    std::vector<boost::optional<engine::Bearing>> bearings = {boost::none,
+                                                              engine::Bearing{200, 10}};
+    std::vector<std::size_t> sources = {0};
+    CHECK_EQUAL_RANGE(result->coordinates, coordinates);
+    CHECK_EQUAL_RANGE(result->radiuses, radiuses);
+    CHECK_EQUAL_RANGE(result->bearings, bearings);
+    CHECK_EQUAL_RANGE(result->sources, sources);
+    BOOST_CHECK(result->hints.empty());
+    BOOST_CHECK(result->IsValid());
+
+    // truncated records and unknown sections
+    BOOST_CHECK(!parseBinaryParameters(body.substr(0, body.size() - 1)));
+    body[4] = 0x08;
+    BOOST_CHECK(!parseBinaryParameters(body));
+    BOOST_CHECK(!parseBinaryParameters(""));
+}
+
+BOOST_AUTO_TEST_CASE(binary_traces)
+{
+    const auto append_trace = [](std::string &body, const std::vector<std::int32_t> &fixed) {
+        std::string coordinates;
+        appendBinary<std::uint32_t>(coordinates, fixed.size() / 2);
+        appendBinary<std::uint32_t>(coordinates, 0);
+        for (const auto value : fixed)
+            appendBinary<std::int32_t>(coordinates, value);
+        appendBinary<std::uint32_t>(body, coordinates.size());
+        body += coordinates;
+        for (std::size_t index = 0; index < fixed.size() / 2; ++index)
+            appendBinary<std::uint32_t>(body, 10 * index);
+    };
+
+    std::string body;
+    appendBinary<std::uint32_t>(body, 2);
+    appendBinary<std::uint32_t>(body, BINARY_TIMESTAMPS);
+    append_trace(body, {13388860, 52517037, 13397634, 52529407});
+    append_trace(body, {13428555, 52523219, 13418555, 52523215, 13408555, 52523211});
+
+    const auto traces = parseBinaryTraces(body);
+    BOOST_REQUIRE(traces);
+    BOOST_REQUIRE_EQUAL(traces->size(), 2);
+    BOOST_CHECK_EQUAL((*traces)[0].parameters.coordinates.size(), 2);
+    BOOST_CHECK_EQUAL((*traces)[1].parameters.coordinates.size(), 3);
+    BOOST_CHECK_EQUAL((*traces)[1].parameters.coordinates[2],
+                      (util::Coordinate{util::FloatLongitude{13.408555},
+                                        util::FloatLatitude{52.523211}}));
+    std::vector<unsigned> timestamps = {0, 10, 20};
+    CHECK_EQUAL_RANGE((*traces)[1].timestamps, timestamps);
+
+    // truncated traces, trailing bytes and unknown sections
+    BOOST_CHECK(!parseBinaryTraces(body.substr(0, body.size() - 1)));
+    BOOST_CHECK(!parseBinaryTraces(body + '\0'));
+    body[4] = 0x02;
+    BOOST_CHECK(!parseBinaryTraces(body));
+    BOOST_CHECK(!parseBinaryTraces(""));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+#include "server/query_log.hpp"
+#include "util/exception.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(query_log)
+
+using namespace osrm;
+using namespace osrm::server;
+
+BOOST_AUTO_TEST_CASE(write_and_read)
+{
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("osrm-query-log-%%%%%%%%");
+
+    QueryRecord get;
+    get.timestamp_us = 1500000000000000;
+    get.latency_us = 1234;
+    get.status = 200;
+    get.url = "/route/v1/driving/7.41,43.73;7.42,43.74?overview=false";
+
+    QueryRecord post;
+    post.timestamp_us = get.timestamp_us + 10;
+    post.status = 400;
+    post.timeout_ms = 50;
+    post.url = "/table/v1/driving";
+    post.body = std::string("\x02\0\0\0\0\0\0\0", 8);
+
+    {
+        QueryLogWriter writer(path, 1.);
+        BOOST_CHECK(writer.Sample());
+        writer.Write(get);
+        writer.Write(post);
+    }
+
+    QueryLogReader reader(path);
+    QueryRecord record;
+    BOOST_REQUIRE(reader.Next(record));
+    BOOST_CHECK_EQUAL(record.timestamp_us, get.timestamp_us);
+    BOOST_CHECK_EQUAL(record.latency_us, get.latency_us);
+    BOOST_CHECK_EQUAL(record.status, get.status);
+    BOOST_CHECK_EQUAL(record.timeout_ms, 0);
+    BOOST_CHECK_EQUAL(record.url, get.url);
+    BOOST_CHECK(record.body.empty());
+
+    BOOST_REQUIRE(reader.Next(record));
+    BOOST_CHECK_EQUAL(record.status, post.status);
+    BOOST_CHECK_EQUAL(record.timeout_ms, post.timeout_ms);
+    BOOST_CHECK_EQUAL(record.url, post.url);
+    BOOST_CHECK(record.body == post.body);
+
+    BOOST_CHECK(!reader.Next(record));
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(sampling)
+{
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("osrm-query-log-%%%%%%%%");
+    {
+        QueryLogWriter writer(path, 0.25);
+        std::size_t sampled = 0;
+        for (auto request = 0; request < 1000; ++request)
+            sampled += writer.Sample();
+        BOOST_CHECK_EQUAL(sampled, 250);
+    }
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_logs)
+{
+    const auto path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("osrm-query-log-%%%%%%%%");
+    {
+        boost::filesystem::ofstream out(path);
+        out << "not a query log";
+    }
+    BOOST_CHECK_THROW(QueryLogReader{path}, util::exception);
+
+    {
+        QueryLogWriter writer(path, 1.);
+        QueryRecord record;
+        record.url = "/nearest/v1/driving/7.41,43.73";
+        writer.Write(record);
+    }
+    boost::filesystem::resize_file(path, boost::filesystem::file_size(path) - 5);
+    QueryLogReader reader(path);
+    QueryRecord record;
+    BOOST_CHECK_THROW(reader.Next(record), util::exception);
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
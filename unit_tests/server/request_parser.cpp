@@ -0,0 +1,139 @@
+#include "server/http/request.hpp"
+#include "server/request_parser.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <tuple>
+
+BOOST_AUTO_TEST_SUITE(request_parser)
+
+using namespace osrm;
+using namespace osrm::server;
+
+BOOST_AUTO_TEST_CASE(http_version_and_keep_alive)
+{
+    {
+        std::string input = "GET /route/v1 HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        RequestParser parser;
+        http::request request;
+        RequestParser::RequestStatus status;
+        std::tie(status, std::ignore, std::ignore) =
+            parser.parse(request, &input[0], &input[0] + input.size());
+        BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+        BOOST_CHECK_EQUAL(request.http_version_major, 1);
+        BOOST_CHECK_EQUAL(request.http_version_minor, 1);
+        BOOST_CHECK(request.keep_alive());
+    }
+
+    {
+        std::string input = "GET /route/v1 HTTP/1.1\r\nConnection: close\r\n\r\n";
+        RequestParser parser;
+        http::request request;
+        parser.parse(request, &input[0], &input[0] + input.size());
+        BOOST_CHECK_EQUAL(request.connection, "close");
+        BOOST_CHECK(!request.keep_alive());
+    }
+
+    {
+        std::string input = "GET /route/v1 HTTP/1.0\r\n\r\n";
+        RequestParser parser;
+        http::request request;
+        parser.parse(request, &input[0], &input[0] + input.size());
+        BOOST_CHECK_EQUAL(request.http_version_minor, 0);
+        BOOST_CHECK(!request.keep_alive());
+    }
+
+    {
+        std::string input = "GET /route/v1 HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n";
+        RequestParser parser;
+        http::request request;
+        parser.parse(request, &input[0], &input[0] + input.size());
+        BOOST_CHECK(request.keep_alive());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pipelined_requests)
+{
+    std::string input = "GET /first HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                        "GET /second HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    char *begin = &input[0];
+    char *end = &input[0] + input.size();
+
+    RequestParser first_parser;
+    http::request first_request;
+    RequestParser::RequestStatus status;
+    char *parsed_end;
+    std::tie(status, std::ignore, parsed_end) = first_parser.parse(first_request, begin, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(first_request.uri, "/first");
+    BOOST_CHECK(parsed_end != end);
+
+    RequestParser second_parser;
+    http::request second_request;
+    std::tie(status, std::ignore, parsed_end) =
+        second_parser.parse(second_request, parsed_end, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(second_request.uri, "/second");
+    BOOST_CHECK(parsed_end == end);
+}
+
+BOOST_AUTO_TEST_CASE(incremental_request)
+{
+    std::string input = "GET /route HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    char *begin = &input[0];
+    char *middle = begin + 10;
+    char *end = begin + input.size();
+
+    RequestParser parser;
+    http::request request;
+    RequestParser::RequestStatus status;
+    std::tie(status, std::ignore, std::ignore) = parser.parse(request, begin, middle);
+    BOOST_CHECK(status == RequestParser::RequestStatus::indeterminate);
+    std::tie(status, std::ignore, std::ignore) = parser.parse(request, middle, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(request.uri, "/route");
+}
+
+BOOST_AUTO_TEST_CASE(request_body)
+{
+    std::string input = "POST /table/v1/car/.json HTTP/1.1\r\n"
+                        "Content-Type: application/x-osrm-coordinates\r\n"
+                        "Content-Length: 5\r\nExpect: 100-continue\r\n\r\n" +
+                        std::string("ab\0de", 5) + "GET /next HTTP/1.1\r\n\r\n";
+    char *begin = &input[0];
+    char *headers_end = &input[0] + input.find("\r\n\r\n") + 4;
+    char *end = &input[0] + input.size();
+
+    RequestParser parser;
+    http::request request;
+    RequestParser::RequestStatus status;
+    char *parsed_end;
+    std::tie(status, std::ignore, std::ignore) = parser.parse(request, begin, headers_end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::indeterminate);
+    BOOST_CHECK(request.expect_continue);
+
+    std::tie(status, std::ignore, parsed_end) = parser.parse(request, headers_end, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(request.method, "POST");
+    BOOST_CHECK_EQUAL(request.content_type, "application/x-osrm-coordinates");
+    BOOST_CHECK_EQUAL(request.body, std::string("ab\0de", 5));
+    BOOST_CHECK_EQUAL(std::string(parsed_end, end), "GET /next HTTP/1.1\r\n\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(invalid_content_length)
+{
+    for (const std::string length : {"-1", "12a", "", "999999999999"})
+    {
+        std::string input = "POST /route HTTP/1.1\r\nContent-Length: " + length + "\r\n\r\n";
+        RequestParser parser;
+        http::request request;
+        RequestParser::RequestStatus status;
+        std::tie(status, std::ignore, std::ignore) =
+            parser.parse(request, &input[0], &input[0] + input.size());
+        BOOST_CHECK(status == RequestParser::RequestStatus::invalid);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+#include "server/service_executor.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(service_executor)
+
+using namespace osrm;
+using namespace osrm::server;
+
+BOOST_AUTO_TEST_CASE(invalid_pools)
+{
+    ServiceExecutor executor({"route", "match", "trip"}, 1);
+    BOOST_CHECK(executor.AddPool({"match", "trip"}, 2));
+    BOOST_CHECK(!executor.AddPool({"route", "match"}, 1));
+    BOOST_CHECK(!executor.AddPool({"foo"}, 1));
+    BOOST_CHECK(executor.AddPool({"route"}, 1));
+    BOOST_CHECK(executor.SetPriority("route", 10));
+    BOOST_CHECK(!executor.SetPriority("foo", 10));
+}
+
+BOOST_AUTO_TEST_CASE(separate_pools)
+{
+    ServiceExecutor executor({"route", "match"}, 1);
+    BOOST_REQUIRE(executor.AddPool({"match"}, 1));
+    executor.Start();
+
+    // a blocked match request must not hold up route requests
+    std::promise<void> release_match;
+    auto match_released = release_match.get_future().share();
+    std::promise<void> match_done;
+    executor.Post("match", [match_released, &match_done]() {
+        match_released.wait();
+        match_done.set_value();
+    });
+
+    std::promise<void> route_done;
+    executor.Post("route", [&route_done]() { route_done.set_value(); });
+    BOOST_CHECK(route_done.get_future().wait_for(std::chrono::seconds(10)) ==
+                std::future_status::ready);
+
+    release_match.set_value();
+    BOOST_CHECK(match_done.get_future().wait_for(std::chrono::seconds(10)) ==
+                std::future_status::ready);
+    executor.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(priorities)
+{
+    ServiceExecutor executor({"route", "match", "table"}, 1);
+    BOOST_REQUIRE(executor.SetPriority("route", 10));
+    BOOST_REQUIRE(executor.SetPriority("match", -1));
+
+    // queued before the single worker starts, so they run in priority order
+    std::mutex mutex;
+    std::vector<std::string> order;
+    const auto record = [&mutex, &order](const std::string &name) {
+        return [&mutex, &order, name]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(name);
+        };
+    };
+    executor.Post("match", record("match"));
+    executor.Post("table", record("table 1"));
+    executor.Post("route", record("route"));
+    executor.Post("foo", record("other"));
+    executor.Post("table", record("table 2"));
+
+    std::promise<void> done;
+    executor.Post("match", [&done]() { done.set_value(); });
+    executor.Start();
+    BOOST_REQUIRE(done.get_future().wait_for(std::chrono::seconds(10)) ==
+                  std::future_status::ready);
+    executor.Stop();
+
+    const std::vector<std::string> expected = {"route", "table 1", "other", "table 2", "match"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(queue_metrics)
+{
+    ServiceExecutor executor({"route"}, 1);
+    executor.Post("route", []() {});
+    executor.Post("route", []() {});
+    executor.Post("foo", []() {});
+
+    const auto rendered = executor.RenderPrometheus();
+    BOOST_CHECK(rendered.find("osrm_requests_queued{service=\"route\"} 2\n") !=
+                std::string::npos);
+    BOOST_CHECK(rendered.find("osrm_requests_queued{service=\"other\"} 1\n") !=
+                std::string::npos);
+    BOOST_CHECK(rendered.find("osrm_worker_threads{pool=\"default\"} 1\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
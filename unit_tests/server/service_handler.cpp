@@ -0,0 +1,120 @@
+#include "server/api/parsed_url.hpp"
+#include "server/service_handler.hpp"
+
+#include "util/exception.hpp"
+#include "util/json_container.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(service_handler)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+// Answers every query with its name and counts one route cache hit
+class NamedServiceHandler final : public ServiceHandlerInterface
+{
+  public:
+    NamedServiceHandler(std::string name, std::vector<std::string> services = {"route"})
+        : name(std::move(name)), services(std::move(services))
+    {
+    }
+
+    engine::Status RunQuery(api::ParsedURL,
+                            service::BaseService::BodyT &,
+                            const service::BaseService::TimeoutT &,
+                            service::BaseService::ResultT &result) override
+    {
+        result = util::json::Object();
+        result.get<util::json::Object>().values["dataset"] = name;
+        return engine::Status::Ok;
+    }
+
+    engine::Status RunBatchQuery(api::ParsedURL,
+                                 service::BaseService::TracesT &,
+                                 const service::BaseService::TimeoutT &,
+                                 service::BaseService::ResultT &result) override
+    {
+        result = util::json::Object();
+        result.get<util::json::Object>().values["dataset"] = name;
+        return engine::Status::Ok;
+    }
+
+    std::vector<std::string> GetServiceNames() const override { return services; }
+
+    engine::EngineStatistics GetEngineStatistics() const override
+    {
+        engine::EngineStatistics statistics{};
+        statistics.route_cache = util::CacheStatistics{1, 0, 0, 1, 10};
+        statistics.coalesced_requests = 2;
+        return statistics;
+    }
+
+  private:
+    std::string name;
+    std::vector<std::string> services;
+};
+
+std::string query(ServiceHandlerInterface &handler, const std::string &profile)
+{
+    api::ParsedURL url;
+    url.service = "route";
+    url.version = 1;
+    url.profile = profile;
+    service::BaseService::BodyT body;
+    service::BaseService::ResultT result;
+    if (handler.RunQuery(url, body, {}, result) != engine::Status::Ok)
+    {
+        return result.get<util::json::Object>().values["code"].get<util::json::String>().value;
+    }
+    return result.get<util::json::Object>().values["dataset"].get<util::json::String>().value;
+}
+}
+
+BOOST_AUTO_TEST_CASE(dispatch_by_profile)
+{
+    ProfileServiceHandler handler(std::make_unique<NamedServiceHandler>("car"));
+    handler.AddProfile("bike", std::make_unique<NamedServiceHandler>("bike"));
+    handler.AddProfile("truck", std::make_unique<NamedServiceHandler>("truck"));
+
+    BOOST_CHECK_EQUAL(query(handler, "bike"), "bike");
+    BOOST_CHECK_EQUAL(query(handler, "truck"), "truck");
+    BOOST_CHECK_EQUAL(query(handler, "driving"), "car");
+
+    const auto statistics = handler.GetEngineStatistics();
+    BOOST_CHECK_EQUAL(statistics.route_cache.hits, 3);
+    BOOST_CHECK_EQUAL(statistics.route_cache.capacity, 30);
+    BOOST_CHECK_EQUAL(statistics.coalesced_requests, 6);
+}
+
+BOOST_AUTO_TEST_CASE(unknown_profile_without_default)
+{
+    ProfileServiceHandler handler(nullptr);
+    handler.AddProfile("bike", std::make_unique<NamedServiceHandler>("bike"));
+
+    BOOST_CHECK_EQUAL(query(handler, "bike"), "bike");
+    BOOST_CHECK_EQUAL(query(handler, "driving"), "InvalidService");
+    BOOST_CHECK(handler.GetServiceNames() == std::vector<std::string>{"route"});
+}
+
+BOOST_AUTO_TEST_CASE(invalid_profiles)
+{
+    ProfileServiceHandler handler(std::make_unique<NamedServiceHandler>("car"));
+    handler.AddProfile("bike", std::make_unique<NamedServiceHandler>("bike"));
+
+    BOOST_CHECK_THROW(handler.AddProfile("bike", std::make_unique<NamedServiceHandler>("bike")),
+                      util::exception);
+    BOOST_CHECK_THROW(handler.AddProfile("foot",
+                                         std::make_unique<NamedServiceHandler>(
+                                             "foot", std::vector<std::string>{"route", "table"})),
+                      util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
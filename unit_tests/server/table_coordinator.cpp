@@ -0,0 +1,141 @@
+#include "server/table_coordinator.hpp"
+#include "server/api/binary_parameters_parser.hpp"
+
+#include "util/json_binary_renderer.hpp"
+#include "util/json_container.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(table_coordinator)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+std::string renderResponse(const util::json::Object &response)
+{
+    std::vector<char> buffer;
+    util::json::renderBinary(buffer, response);
+    return std::string(buffer.begin(), buffer.end());
+}
+
+util::json::Array makeRow(const std::vector<util::json::Value> &values)
+{
+    util::json::Array row;
+    row.values = values;
+    return row;
+}
+}
+
+BOOST_AUTO_TEST_CASE(plan_blocks)
+{
+    const auto blocks = planTableBlocks(10, 4);
+    BOOST_REQUIRE_EQUAL(blocks.size(), 3);
+    BOOST_CHECK_EQUAL(blocks[0].first_row, 0);
+    BOOST_CHECK_EQUAL(blocks[0].number_of_rows, 4);
+    BOOST_CHECK_EQUAL(blocks[2].first_row, 8);
+    BOOST_CHECK_EQUAL(blocks[2].number_of_rows, 2);
+
+    BOOST_CHECK(planTableBlocks(0, 4).empty());
+    BOOST_CHECK_EQUAL(planTableBlocks(3, 0).size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(target)
+{
+    TableCoordinatorConfig config;
+    BOOST_CHECK_EQUAL(makeTableTarget(config, {0, 2}),
+                      "/table/v1/driving/.json?sources=0;1&annotations=duration"
+                      "&output_format=binary");
+
+    config.profile = "foot";
+    config.distances = true;
+    BOOST_CHECK_EQUAL(makeTableTarget(config, {4, 1}),
+                      "/table/v1/foot/.json?sources=4&annotations=duration,distance"
+                      "&generate_hints=false&output_format=binary");
+}
+
+BOOST_AUTO_TEST_CASE(body_round_trip)
+{
+    const std::vector<util::Coordinate> coordinates = {
+        {util::FloatLongitude{7.41}, util::FloatLatitude{43.73}},
+        {util::FloatLongitude{7.42}, util::FloatLatitude{43.74}}};
+
+    const auto without_hints = api::parseBinaryParameters(encodeTableBody(coordinates, {}));
+    BOOST_REQUIRE(without_hints);
+    BOOST_CHECK(without_hints->coordinates == coordinates);
+    BOOST_CHECK(without_hints->hints.empty());
+
+    engine::Hint hint;
+    hint.data_checksum = 42;
+    const auto with_hints =
+        api::parseBinaryParameters(encodeTableBody(coordinates, {hint, boost::none}));
+    BOOST_REQUIRE(with_hints);
+    BOOST_CHECK(with_hints->coordinates == coordinates);
+    BOOST_REQUIRE_EQUAL(with_hints->hints.size(), 2);
+    BOOST_REQUIRE(with_hints->hints[0]);
+    BOOST_CHECK_EQUAL(with_hints->hints[0]->data_checksum, 42);
+    BOOST_CHECK(!with_hints->hints[1]);
+}
+
+BOOST_AUTO_TEST_CASE(decode_block)
+{
+    engine::Hint hint;
+    hint.data_checksum = 42;
+
+    util::json::Object with_hint;
+    with_hint.values["hint"] = hint.ToBase64();
+    util::json::Array destinations;
+    destinations.values.push_back(std::move(with_hint));
+    destinations.values.push_back(util::json::Object());
+
+    util::json::Array durations;
+    durations.values.push_back(makeRow({util::json::Number(0), util::json::Number(12.5)}));
+    // a row without a single route is no number array
+    durations.values.push_back(makeRow({util::json::Null(), util::json::Null()}));
+
+    util::json::Object response;
+    response.values["code"] = "Ok";
+    response.values["durations"] = std::move(durations);
+    response.values["destinations"] = std::move(destinations);
+    const auto rendered = renderResponse(response);
+
+    TableBlockResult result;
+    BOOST_REQUIRE(decodeTableBlock(rendered, {2, 2}, 2, result));
+    BOOST_CHECK_EQUAL(result.code, "Ok");
+    BOOST_REQUIRE_EQUAL(result.durations.size(), 4);
+    BOOST_CHECK_EQUAL(result.durations[0], 0.);
+    BOOST_CHECK_EQUAL(result.durations[1], 12.5);
+    BOOST_CHECK(std::isnan(result.durations[2]) && std::isnan(result.durations[3]));
+    BOOST_CHECK(result.distances.empty());
+    BOOST_REQUIRE_EQUAL(result.hints.size(), 2);
+    BOOST_REQUIRE(result.hints[0]);
+    BOOST_CHECK_EQUAL(result.hints[0]->data_checksum, 42);
+    BOOST_CHECK(!result.hints[1]);
+
+    // the matrix has to have the rows of the block
+    BOOST_CHECK(!decodeTableBlock(rendered, {0, 3}, 2, result));
+    BOOST_CHECK(!decodeTableBlock(rendered, {0, 2}, 3, result));
+    BOOST_CHECK(!decodeTableBlock(rendered.substr(0, rendered.size() / 2), {0, 2}, 2, result));
+    BOOST_CHECK(!decodeTableBlock("{\"code\":\"InvalidUrl\"}", {0, 2}, 2, result));
+}
+
+BOOST_AUTO_TEST_CASE(decode_error)
+{
+    util::json::Object response;
+    response.values["code"] = "TooBusy";
+    response.values["message"] = "Service table is overloaded, try again later";
+
+    TableBlockResult result;
+    BOOST_REQUIRE(decodeTableBlock(renderResponse(response), {0, 2}, 2, result));
+    BOOST_CHECK_EQUAL(result.code, "TooBusy");
+    BOOST_CHECK_EQUAL(result.message, "Service table is overloaded, try again later");
+    BOOST_CHECK(result.durations.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
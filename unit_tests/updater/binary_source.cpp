@@ -0,0 +1,142 @@
+#include "updater/binary_source.hpp"
+#include "updater/csv_source.hpp"
+#include "updater/segment_source.hpp"
+
+#include "util/exception.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(binary_source)
+
+using namespace osrm;
+using namespace osrm::updater;
+
+namespace
+{
+// A temporary file name with the extension, the file is removed with the object
+struct TemporaryPath
+{
+    TemporaryPath(const std::string &extension)
+        : path(boost::filesystem::temp_directory_path() /
+               boost::filesystem::unique_path("osrm-speeds-%%%%-%%%%" + extension))
+    {
+    }
+    ~TemporaryPath() { boost::filesystem::remove(path); }
+
+    std::string string() const { return path.string(); }
+
+    boost::filesystem::path path;
+};
+
+void writeFile(const TemporaryPath &path, const std::string &content)
+{
+    boost::filesystem::ofstream out(path.path, std::ios::binary);
+    out.write(content.data(), content.size());
+}
+
+// A binary file with the records in the given order without datasource name
+std::string makeFile(const std::vector<binary::SegmentRecord> &records)
+{
+    binary::SegmentFileHeader header;
+    std::memcpy(header.magic, "OSRMSPD", sizeof(header.magic));
+    header.version = binary::SegmentFileHeader::VERSION;
+    header.name_length = 0;
+    header.num_records = records.size();
+
+    std::string content(reinterpret_cast<const char *>(&header), sizeof(header));
+    content.append(reinterpret_cast<const char *>(records.data()),
+                   records.size() * sizeof(binary::SegmentRecord));
+    return content;
+}
+}
+
+BOOST_AUTO_TEST_CASE(write_and_read_test)
+{
+    TemporaryPath csv(".csv");
+    writeFile(csv, "3,4,30\n1,2,10,0.5\n2,3,20\n1,2,11,1.5\n");
+    TemporaryPath speeds(".bin");
+    binary::writeSegmentValues(speeds.string(), "traffic", csv::readSegmentValues({csv.string()}));
+
+    BOOST_CHECK(binary::isSegmentFile(speeds.string()));
+    BOOST_CHECK(!binary::isSegmentFile(csv.string()));
+    BOOST_CHECK_EQUAL(binary::readSegmentFileName(speeds.string()), "traffic");
+    BOOST_CHECK_EQUAL(readSegmentSourceName(speeds.string()), "traffic");
+    BOOST_CHECK_EQUAL(readSegmentSourceName(csv.string()), csv.path.stem().string());
+
+    const auto lookup = binary::readSegmentValues(speeds.string(), 3);
+    BOOST_CHECK_EQUAL(lookup.lookup.size(), 3);
+    const auto updated = lookup(Segment{1, 2});
+    BOOST_REQUIRE(updated);
+    BOOST_CHECK_EQUAL(updated->speed, 11);
+    BOOST_CHECK_EQUAL(updated->rate, 1.5);
+    BOOST_CHECK_EQUAL(updated->source, 3);
+    const auto without_rate = lookup(Segment{3, 4});
+    BOOST_REQUIRE(without_rate);
+    BOOST_CHECK_EQUAL(without_rate->speed, 30);
+    BOOST_CHECK(std::isnan(without_rate->rate));
+    BOOST_CHECK(!lookup(Segment{4, 5}));
+}
+
+BOOST_AUTO_TEST_CASE(unsorted_file_test)
+{
+    TemporaryPath speeds(".bin");
+    writeFile(speeds, makeFile({{5, 6, 50, 0, 1.}, {1, 2, 10, 0, 1.}, {5, 6, 51, 0, 2.}}));
+
+    const auto lookup = binary::readSegmentValues(speeds.string(), 1);
+    BOOST_CHECK_EQUAL(lookup.lookup.size(), 2);
+    const auto last = lookup(Segment{5, 6});
+    BOOST_REQUIRE(last);
+    BOOST_CHECK_EQUAL(last->speed, 51);
+    BOOST_CHECK(lookup(Segment{1, 2}));
+}
+
+BOOST_AUTO_TEST_CASE(mixed_files_test)
+{
+    TemporaryPath first(".csv");
+    writeFile(first, "1,2,10\n2,3,20\n3,4,30\n");
+    TemporaryPath second(".bin");
+    writeFile(second, makeFile({{1, 2, 11, 0, NAN}, {4, 5, 41, 0, NAN}}));
+    TemporaryPath third(".csv");
+    writeFile(third, "2,3,22\n");
+
+    const auto lookup = readSegmentValues({first.string(), second.string(), third.string()});
+    BOOST_CHECK_EQUAL(lookup.lookup.size(), 4);
+
+    const auto binary_value = lookup(Segment{1, 2});
+    BOOST_REQUIRE(binary_value);
+    BOOST_CHECK_EQUAL(binary_value->speed, 11);
+    BOOST_CHECK_EQUAL(binary_value->source, 2);
+    const auto last_csv = lookup(Segment{2, 3});
+    BOOST_REQUIRE(last_csv);
+    BOOST_CHECK_EQUAL(last_csv->speed, 22);
+    BOOST_CHECK_EQUAL(last_csv->source, 3);
+    const auto first_csv = lookup(Segment{3, 4});
+    BOOST_REQUIRE(first_csv);
+    BOOST_CHECK_EQUAL(first_csv->source, 1);
+    BOOST_CHECK(lookup(Segment{4, 5}));
+}
+
+BOOST_AUTO_TEST_CASE(invalid_file_test)
+{
+    TemporaryPath truncated(".bin");
+    auto content = makeFile({{1, 2, 10, 0, NAN}, {2, 3, 20, 0, NAN}});
+    content.resize(content.size() - 1);
+    writeFile(truncated, content);
+    BOOST_CHECK_THROW(binary::readSegmentValues(truncated.string(), 1), util::exception);
+
+    TemporaryPath version(".bin");
+    content = makeFile({});
+    content[8] = 2;
+    writeFile(version, content);
+    BOOST_CHECK_THROW(binary::readSegmentValues(version.string(), 1), util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,185 @@
+#include "updater/csv_file_parser.hpp"
+#include "updater/csv_source.hpp"
+
+#include "util/exception.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(csv_source)
+
+using namespace osrm;
+using namespace osrm::updater;
+
+namespace
+{
+// Writes the CSV content into a temporary file that is removed with the object
+struct TemporaryFile
+{
+    TemporaryFile(const std::string &content)
+        : path(boost::filesystem::temp_directory_path() /
+               boost::filesystem::unique_path("osrm-csv-%%%%-%%%%.csv"))
+    {
+        boost::filesystem::ofstream out(path, std::ios::binary);
+        out << content;
+    }
+    ~TemporaryFile() { boost::filesystem::remove(path); }
+
+    boost::filesystem::path path;
+};
+
+template <typename T> bool parse(const std::string &input, T &value, std::size_t &consumed)
+{
+    const char *first = input.data();
+    const auto ok = csv::parseUnsigned(first, input.data() + input.size(), value);
+    consumed = first - input.data();
+    return ok;
+}
+}
+
+BOOST_AUTO_TEST_CASE(parse_unsigned_test)
+{
+    std::uint64_t value = 0;
+    std::size_t consumed = 0;
+
+    BOOST_CHECK(parse(std::string("0"), value, consumed));
+    BOOST_CHECK_EQUAL(value, 0);
+    BOOST_CHECK(parse(std::string("42,"), value, consumed));
+    BOOST_CHECK_EQUAL(value, 42);
+    BOOST_CHECK_EQUAL(consumed, 2);
+    BOOST_CHECK(parse(std::string("12345678"), value, consumed));
+    BOOST_CHECK_EQUAL(value, 12345678);
+    BOOST_CHECK(parse(std::string("1234567,9"), value, consumed));
+    BOOST_CHECK_EQUAL(value, 1234567);
+    BOOST_CHECK_EQUAL(consumed, 7);
+    BOOST_CHECK(parse(std::string("3141592653589793,27"), value, consumed));
+    BOOST_CHECK_EQUAL(value, 3141592653589793);
+    BOOST_CHECK(parse(std::string("18446744073709551615"), value, consumed));
+    BOOST_CHECK_EQUAL(value, std::numeric_limits<std::uint64_t>::max());
+    BOOST_CHECK_EQUAL(consumed, 20);
+
+    BOOST_CHECK(!parse(std::string(""), value, consumed));
+    BOOST_CHECK(!parse(std::string("-1"), value, consumed));
+    BOOST_CHECK(!parse(std::string(",12345678"), value, consumed));
+    BOOST_CHECK(!parse(std::string("18446744073709551616"), value, consumed));
+    BOOST_CHECK(!parse(std::string("99999999999999999999"), value, consumed));
+    BOOST_CHECK_EQUAL(consumed, 0);
+
+    unsigned small = 0;
+    BOOST_CHECK(parse(std::string("4294967295"), small, consumed));
+    BOOST_CHECK_EQUAL(small, std::numeric_limits<unsigned>::max());
+    BOOST_CHECK(!parse(std::string("4294967296"), small, consumed));
+}
+
+BOOST_AUTO_TEST_CASE(segment_values_test)
+{
+    TemporaryFile first("1,2,10\n"
+                        "2,3,20,1.5\n"
+                        "3,4,30,comment\n"
+                        "\n"
+                        "4,5,40,2.5,comment\r\n"
+                        "1,2,11");
+    TemporaryFile second("2,3,21\n"
+                         "5,6,50\n");
+
+    const auto lookup = csv::readSegmentValues({first.path.string(), second.path.string()});
+    BOOST_CHECK_EQUAL(lookup.lookup.size(), 5);
+
+    const auto last_line = lookup(Segment{1, 2});
+    BOOST_REQUIRE(last_line);
+    BOOST_CHECK_EQUAL(last_line->speed, 11);
+    BOOST_CHECK(std::isnan(last_line->rate));
+    BOOST_CHECK_EQUAL(last_line->source, 1);
+
+    const auto last_file = lookup(Segment{2, 3});
+    BOOST_REQUIRE(last_file);
+    BOOST_CHECK_EQUAL(last_file->speed, 21);
+    BOOST_CHECK(std::isnan(last_file->rate));
+    BOOST_CHECK_EQUAL(last_file->source, 2);
+
+    const auto comment = lookup(Segment{3, 4});
+    BOOST_REQUIRE(comment);
+    BOOST_CHECK_EQUAL(comment->speed, 30);
+    BOOST_CHECK(std::isnan(comment->rate));
+
+    const auto rate = lookup(Segment{4, 5});
+    BOOST_REQUIRE(rate);
+    BOOST_CHECK_EQUAL(rate->speed, 40);
+    BOOST_CHECK_EQUAL(rate->rate, 2.5);
+
+    BOOST_CHECK(lookup(Segment{5, 6}));
+    BOOST_CHECK(!lookup(Segment{6, 7}));
+}
+
+BOOST_AUTO_TEST_CASE(chunked_segment_values_test)
+{
+    // large enough to be cut into several chunks that are parsed and merged separately
+    std::string content;
+    for (std::uint64_t node = 0; node < 200000; ++node)
+    {
+        content += std::to_string(node) + "," + std::to_string(node + 1) + "," +
+                   std::to_string(node % 100) + "\n";
+    }
+    content += "0,1,123\n";
+    TemporaryFile segments(content);
+
+    const auto lookup = csv::readSegmentValues({segments.path.string()});
+    BOOST_CHECK_EQUAL(lookup.lookup.size(), 200000);
+
+    const auto last_line = lookup(Segment{0, 1});
+    BOOST_REQUIRE(last_line);
+    BOOST_CHECK_EQUAL(last_line->speed, 123);
+
+    const auto middle = lookup(Segment{123456, 123457});
+    BOOST_REQUIRE(middle);
+    BOOST_CHECK_EQUAL(middle->speed, 56);
+}
+
+BOOST_AUTO_TEST_CASE(turn_values_test)
+{
+    TemporaryFile turns("1,2,3,5,comment\n"
+                        "1,2,4,-3.33,7,comment\n"
+                        "2,3,4,1e1\n");
+
+    const auto lookup = csv::readTurnValues({turns.path.string()});
+    BOOST_CHECK_EQUAL(lookup.lookup.size(), 3);
+
+    const auto comment = lookup(Turn{1, 2, 3});
+    BOOST_REQUIRE(comment);
+    BOOST_CHECK_EQUAL(comment->duration, 5);
+    BOOST_CHECK(std::isnan(comment->weight));
+
+    const auto weight = lookup(Turn{1, 2, 4});
+    BOOST_REQUIRE(weight);
+    BOOST_CHECK_EQUAL(weight->duration, -3.33);
+    BOOST_CHECK_EQUAL(weight->weight, 7);
+
+    const auto exponent = lookup(Turn{2, 3, 4});
+    BOOST_REQUIRE(exponent);
+    BOOST_CHECK_EQUAL(exponent->duration, 10);
+}
+
+BOOST_AUTO_TEST_CASE(malformed_and_empty_test)
+{
+    TemporaryFile negative("1,2,-10\n");
+    BOOST_CHECK_THROW(csv::readSegmentValues({negative.path.string()}), util::exception);
+
+    TemporaryFile garbage("1,2,10\n1,2,10x\n");
+    BOOST_CHECK_THROW(csv::readSegmentValues({garbage.path.string()}), util::exception);
+
+    TemporaryFile missing_value("1,2,3\n");
+    BOOST_CHECK_THROW(csv::readTurnValues({missing_value.path.string()}), util::exception);
+
+    TemporaryFile empty("");
+    BOOST_CHECK(csv::readSegmentValues({empty.path.string()}).lookup.empty());
+    BOOST_CHECK(csv::readSegmentValues({}).lookup.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,98 @@
+#include "updater/segment_index.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(segment_index)
+
+using namespace osrm;
+using namespace osrm::updater;
+
+BOOST_AUTO_TEST_CASE(lookup_test)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint64_t> random_node(1, 1u << 20);
+
+    SegmentLookupTable lookup;
+    for (unsigned speed = 0; speed < 10000; ++speed)
+    {
+        SpeedSource value;
+        value.speed = speed;
+        value.source = 1;
+        lookup.lookup.emplace_back(Segment{random_node(generator), random_node(generator)}, value);
+    }
+    sortLookupValues(lookup.lookup);
+
+    const SegmentIndex index(lookup);
+    std::set<std::uint64_t> nodes;
+    for (const auto &entry : lookup.lookup)
+    {
+        const auto value = index(entry.first);
+        BOOST_REQUIRE(value);
+        BOOST_CHECK_EQUAL(value->speed, entry.second.speed);
+        BOOST_CHECK(index.HasNode(entry.first.from));
+        BOOST_CHECK(index.HasNode(entry.first.to));
+        nodes.insert(entry.first.from);
+        nodes.insert(entry.first.to);
+    }
+
+    for (int sample = 0; sample < 10000; ++sample)
+    {
+        const Segment segment{random_node(generator), random_node(generator)};
+        BOOST_CHECK_EQUAL(static_cast<bool>(index(segment)), static_cast<bool>(lookup(segment)));
+        BOOST_CHECK_EQUAL(index.HasNode(segment.from), nodes.count(segment.from) > 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(turn_lookup_test)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint64_t> random_node(1, 1u << 10);
+
+    TurnLookupTable lookup;
+    for (unsigned duration = 0; duration < 10000; ++duration)
+    {
+        PenaltySource value;
+        value.duration = duration;
+        value.source = 1;
+        lookup.lookup.emplace_back(
+            Turn{random_node(generator), random_node(generator), random_node(generator)}, value);
+    }
+    sortLookupValues(lookup.lookup);
+
+    const TurnIndex index(lookup);
+    std::set<std::uint64_t> vias;
+    for (const auto &entry : lookup.lookup)
+    {
+        const auto value = index(entry.first);
+        BOOST_REQUIRE(value);
+        BOOST_CHECK_EQUAL(value->duration, entry.second.duration);
+        BOOST_CHECK(index.HasNode(entry.first.via));
+        vias.insert(entry.first.via);
+    }
+
+    for (int sample = 0; sample < 10000; ++sample)
+    {
+        const Turn turn{random_node(generator), random_node(generator), random_node(generator)};
+        const auto value = index(turn);
+        const auto expected = lookup(turn);
+        BOOST_REQUIRE_EQUAL(static_cast<bool>(value), static_cast<bool>(expected));
+        if (value)
+            BOOST_CHECK_EQUAL(value->duration, expected->duration);
+        BOOST_CHECK_EQUAL(index.HasNode(turn.via), vias.count(turn.via) > 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(empty_test)
+{
+    SegmentLookupTable lookup;
+    const SegmentIndex index(lookup);
+    BOOST_CHECK(!index(Segment{1, 2}));
+    BOOST_CHECK(!index.HasNode(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+#include "updater/speed_profiles.hpp"
+
+#include "util/exception.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(speed_profiles)
+
+using namespace osrm;
+using namespace osrm::updater;
+
+namespace
+{
+// A temporary file with the content, the file is removed with the object
+struct TemporaryFile
+{
+    TemporaryFile(const std::string &content)
+        : path(boost::filesystem::temp_directory_path() /
+               boost::filesystem::unique_path("osrm-profiles-%%%%-%%%%.csv"))
+    {
+        boost::filesystem::ofstream out(path, std::ios::binary);
+        out.write(content.data(), content.size());
+    }
+    ~TemporaryFile() { boost::filesystem::remove(path); }
+
+    std::string string() const { return path.string(); }
+
+    boost::filesystem::path path;
+};
+}
+
+BOOST_AUTO_TEST_CASE(slot_speeds_test)
+{
+    TemporaryFile profiles("7,10,20,30,40\n\n3,50,60,70,80\r\n");
+    TemporaryFile segments("1,2,3\n2,3,7\n3,4,3\n");
+    SpeedProfiles speed_profiles(profiles.string(), segments.string());
+
+    BOOST_CHECK_EQUAL(speed_profiles.GetNumberOfSlots(), 4);
+    BOOST_CHECK_EQUAL(speed_profiles.GetNumberOfProfiles(), 2);
+    BOOST_CHECK_EQUAL(speed_profiles.GetNumberOfSegments(), 3);
+
+    const auto first_slot = speed_profiles.GetSlotSpeeds(0);
+    BOOST_CHECK_EQUAL(first_slot.lookup.size(), 3);
+    const auto first = first_slot(Segment{1, 2});
+    BOOST_REQUIRE(first);
+    BOOST_CHECK_EQUAL(first->speed, 50);
+    BOOST_CHECK_EQUAL(first->source, 1);
+
+    const auto last_slot = speed_profiles.GetSlotSpeeds(3);
+    const auto second = last_slot(Segment{2, 3});
+    BOOST_REQUIRE(second);
+    BOOST_CHECK_EQUAL(second->speed, 40);
+    const auto third = last_slot(Segment{3, 4});
+    BOOST_REQUIRE(third);
+    BOOST_CHECK_EQUAL(third->speed, 80);
+    BOOST_CHECK(!last_slot(Segment{4, 5}));
+}
+
+BOOST_AUTO_TEST_CASE(invalid_profiles_test)
+{
+    TemporaryFile segments("1,2,3\n");
+
+    TemporaryFile inconsistent("3,10,20\n4,10,20,30\n");
+    BOOST_CHECK_THROW(SpeedProfiles(inconsistent.string(), segments.string()), util::exception);
+
+    TemporaryFile too_fast("3,10,256\n");
+    BOOST_CHECK_THROW(SpeedProfiles(too_fast.string(), segments.string()), util::exception);
+
+    TemporaryFile duplicate("3,10,20\n3,30,40\n");
+    BOOST_CHECK_THROW(SpeedProfiles(duplicate.string(), segments.string()), util::exception);
+
+    TemporaryFile unknown("4,10,20\n");
+    BOOST_CHECK_THROW(SpeedProfiles(unknown.string(), segments.string()), util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,7 +2,7 @@
 #include "util/geojson_validation.hpp"
 #include "util/timezones.hpp"
 
-#include <boost/filesystem/path.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(timezoner)
@@ -54,4 +54,94 @@ BOOST_AUTO_TEST_CASE(timezoner_test)
         "49.07206], [8.28369, 48.88277]]] }} ]}";
     BOOST_CHECK_THROW(Timezoner tz(missing_featc, now), util::exception);
 }
+
+namespace
+{
+// a triangle in Berlin time next to a square in London time
+const char two_zones[] =
+    "{ \"type\" : \"FeatureCollection\", \"features\": ["
+    "{ \"type\" : \"Feature\","
+    "\"properties\" : { \"tzid\" : \"Europe/Berlin\"}, \"geometry\" : { \"type\": \"polygon\", "
+    "\"coordinates\": [[[8.0,48.0], [9.0, 48.0], [8.0, 49.0], [8.0, 48.0]]] }},"
+    "{ \"type\" : \"Feature\","
+    "\"properties\" : { \"tzid\" : \"Europe/London\"}, \"geometry\" : { \"type\": \"polygon\", "
+    "\"coordinates\": [[[9.0,48.0], [10.0, 48.0], [10.0, 49.0], [9.0, 49.0], [9.0, 48.0]]] }} ]}";
+
+// the hour in the zone of the point, -1 outside of all zones
+int hourAt(const Timezoner &tz, const double lon, const double lat)
+{
+    const auto local_time = tz(point_t{lon, lat});
+    return local_time ? local_time->tm_hour : -1;
+}
+}
+
+BOOST_AUTO_TEST_CASE(timezoner_grid_lookup)
+{
+    // Monday, 16 October 2017 12:00 UTC
+    const std::time_t now = 1508155200;
+    const Timezoner tz(two_zones, now, 0.1);
+
+    BOOST_CHECK_EQUAL(tz.GetNumberOfCells(), 21 * 11);
+    BOOST_CHECK_GT(tz.GetNumberOfBoundaryCells(), 0);
+    BOOST_CHECK_LT(tz.GetNumberOfBoundaryCells(), tz.GetNumberOfCells() / 2);
+
+    BOOST_CHECK_EQUAL(hourAt(tz, 8.2, 48.2), 14);
+    BOOST_CHECK_EQUAL(hourAt(tz, 9.5, 48.5), 13);
+    // on both sides of the diagonal of the triangle
+    BOOST_CHECK_EQUAL(hourAt(tz, 8.49, 48.49), 14);
+    BOOST_CHECK_EQUAL(hourAt(tz, 8.52, 48.52), -1);
+    BOOST_CHECK_EQUAL(hourAt(tz, 7.9, 48.5), -1);
+    BOOST_CHECK_EQUAL(hourAt(tz, 9.5, 49.5), -1);
+
+    // the grid answers like a point in polygon test
+    const std::vector<std::pair<polygon_t, int>> zones = {
+        {polygon_t{{{8.0, 48.0}, {9.0, 48.0}, {8.0, 49.0}, {8.0, 48.0}}}, 14},
+        {polygon_t{{{9.0, 48.0}, {10.0, 48.0}, {10.0, 49.0}, {9.0, 49.0}, {9.0, 48.0}}}, 13}};
+    for (double lon = 7.95; lon < 10.1; lon += 0.0123)
+    {
+        for (double lat = 47.95; lat < 49.1; lat += 0.0117)
+        {
+            int expected = -1;
+            for (const auto &zone : zones)
+            {
+                if (boost::geometry::within(point_t{lon, lat}, zone.first))
+                {
+                    expected = zone.second;
+                    break;
+                }
+            }
+            BOOST_CHECK_EQUAL(hourAt(tz, lon, lat), expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(timezoner_index_file)
+{
+    const std::time_t now = 1508155200;
+    const Timezoner tz(two_zones, now, 0.1);
+
+    const auto index_path =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    tz.Write(index_path);
+    BOOST_CHECK(isTimezoneIndexFile(index_path));
+    BOOST_CHECK(!isTimezoneIndexFile(TEST_DATA_DIR "/test.geojson"));
+
+    // loaded at another time the local times change, the grid does not
+    const Timezoner loaded(index_path, now + 3600);
+    BOOST_CHECK_EQUAL(loaded.GetNumberOfCells(), tz.GetNumberOfCells());
+    BOOST_CHECK_EQUAL(loaded.GetNumberOfBoundaryCells(), tz.GetNumberOfBoundaryCells());
+    for (double lon = 7.95; lon < 10.1; lon += 0.0371)
+    {
+        for (double lat = 47.95; lat < 49.1; lat += 0.0293)
+        {
+            const auto hour = hourAt(tz, lon, lat);
+            BOOST_CHECK_EQUAL(hourAt(loaded, lon, lat), hour < 0 ? hour : (hour + 1) % 24);
+        }
+    }
+
+    // truncated files are rejected
+    boost::filesystem::resize_file(index_path, boost::filesystem::file_size(index_path) - 4);
+    BOOST_CHECK_THROW(Timezoner(index_path, now), util::exception);
+    boost::filesystem::remove(index_path);
+}
 BOOST_AUTO_TEST_SUITE_END()
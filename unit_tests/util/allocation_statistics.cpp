@@ -0,0 +1,46 @@
+#include "util/allocation_statistics.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(allocation_statistics)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(counts_the_allocations_of_the_thread)
+{
+    const auto before = GetThreadAllocationStatistics();
+    {
+        std::vector<std::uint64_t> values(100);
+        auto pointer = std::make_unique<std::uint32_t>(1);
+        BOOST_CHECK_EQUAL(values.size() + *pointer, 101);
+    }
+    const auto allocated = GetThreadAllocationStatistics() - before;
+
+    if (allocation_statistics_enabled)
+    {
+        BOOST_CHECK_EQUAL(allocated.allocations, 2);
+        BOOST_CHECK_EQUAL(allocated.bytes, 100 * sizeof(std::uint64_t) + sizeof(std::uint32_t));
+    }
+    else
+    {
+        BOOST_CHECK_EQUAL(allocated.allocations, 0);
+        BOOST_CHECK_EQUAL(allocated.bytes, 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(other_threads_are_not_counted)
+{
+    const auto before = GetThreadAllocationStatistics();
+    std::thread([] { std::vector<char> buffer(1000); }).join();
+    const auto allocated = GetThreadAllocationStatistics() - before;
+
+    // starting the thread may allocate its state on this thread
+    BOOST_CHECK_LT(allocated.bytes, 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
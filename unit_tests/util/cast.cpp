@@ -0,0 +1,56 @@
+#include "util/cast.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(cast_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+std::string appended(const double value)
+{
+    std::vector<char> out;
+    cast::append_with_precision(out, value);
+    return std::string(out.begin(), out.end());
+}
+
+BOOST_AUTO_TEST_CASE(append_with_precision_formatting)
+{
+    BOOST_CHECK_EQUAL(appended(0.), "0");
+    BOOST_CHECK_EQUAL(appended(-0.), "-0");
+    BOOST_CHECK_EQUAL(appended(100.), "100");
+    BOOST_CHECK_EQUAL(appended(13.38886), "13.38886");
+    BOOST_CHECK_EQUAL(appended(-52.517037), "-52.517037");
+    BOOST_CHECK_EQUAL(appended(0.1234567), "0.123457");
+    BOOST_CHECK_EQUAL(appended(1e-7), "0");
+    BOOST_CHECK_EQUAL(appended(1e20), "100000000000000000000");
+    BOOST_CHECK_EQUAL(appended(std::numeric_limits<double>::infinity()), "inf");
+}
+
+BOOST_AUTO_TEST_CASE(append_with_precision_matches_stream)
+{
+    // ties and values right next to them take the slow path
+    for (const double value : {0.0000005, 1.0000005, 2.5e-6, 123.4565, 0.0000015, 1e9, 1e15})
+    {
+        BOOST_CHECK_EQUAL(appended(value), cast::to_string_with_precision(value));
+        BOOST_CHECK_EQUAL(appended(-value), cast::to_string_with_precision(-value));
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> mantissa(-1000, 1000);
+    std::uniform_int_distribution<int> exponent(-10, 12);
+    for (int i = 0; i < 10000; ++i)
+    {
+        const auto value = mantissa(generator) * std::pow(10., exponent(generator));
+        BOOST_CHECK_EQUAL(appended(value), cast::to_string_with_precision(value));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+#include "util/chunk_arena.hpp"
+#include "util/deallocating_vector.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(chunk_arena_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(new_chunks_are_zeroed)
+{
+    ChunkArena arena(0);
+    auto chunk = static_cast<char *>(arena.Allocate());
+    BOOST_REQUIRE(chunk != nullptr);
+    BOOST_CHECK(std::all_of(
+        chunk, chunk + ChunkArena::CHUNK_SIZE, [](const char value) { return value == 0; }));
+    std::fill(chunk, chunk + ChunkArena::CHUNK_SIZE, 1);
+    arena.Free(chunk);
+    BOOST_CHECK_EQUAL(arena.GetCachedChunks(), 0);
+}
+
+// Freed chunks are reused until the cache is full, the others are returned to the system
+BOOST_AUTO_TEST_CASE(reuses_cached_chunks)
+{
+    ChunkArena arena(2);
+    std::vector<void *> chunks = {arena.Allocate(), arena.Allocate(), arena.Allocate()};
+    for (auto chunk : chunks)
+    {
+        arena.Free(chunk);
+    }
+    arena.Free(nullptr);
+    BOOST_CHECK_EQUAL(arena.GetCachedChunks(), 2);
+
+    auto reused = arena.Allocate();
+    BOOST_CHECK(std::find(chunks.begin(), chunks.begin() + 2, reused) != chunks.begin() + 2);
+    BOOST_CHECK_EQUAL(arena.GetCachedChunks(), 1);
+    arena.Free(reused);
+
+    arena.Release();
+    BOOST_CHECK_EQUAL(arena.GetCachedChunks(), 0);
+}
+
+struct Element
+{
+    Element() : value(42) {}
+    std::uint64_t value;
+};
+
+// Buckets of the arena hold constructed elements, also across resizes and the deallocation
+// iterator
+BOOST_AUTO_TEST_CASE(deallocating_vector_buckets)
+{
+    const std::size_t elements_per_block = ChunkArena::CHUNK_SIZE / sizeof(Element);
+
+    DeallocatingVector<Element> vector;
+    vector.resize(2 * elements_per_block + 3);
+    BOOST_CHECK_EQUAL(vector[0].value, 42);
+    BOOST_CHECK_EQUAL(vector[2 * elements_per_block + 2].value, 42);
+    for (const auto index : irange<std::size_t>(0, vector.size()))
+    {
+        vector[index].value = index;
+    }
+
+    vector.resize(elements_per_block + 1);
+    vector.push_back(Element());
+    BOOST_CHECK_EQUAL(vector.back().value, 42);
+
+    std::size_t expected = 0;
+    for (auto iter = vector.dbegin(); iter != vector.dend(); ++iter, ++expected)
+    {
+        if (expected < elements_per_block + 1)
+        {
+            BOOST_CHECK_EQUAL(iter->value, expected);
+        }
+    }
+    BOOST_CHECK_EQUAL(expected, elements_per_block + 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
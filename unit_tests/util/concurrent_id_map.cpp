@@ -0,0 +1,58 @@
+#include "util/concurrent_id_map.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(concurrent_id_map)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(find_or_add)
+{
+    ConcurrentIDMap<std::string, std::uint32_t> map;
+    BOOST_CHECK_EQUAL(map.ConcurrentFindOrAdd("a"), 0);
+    BOOST_CHECK_EQUAL(map.ConcurrentFindOrAdd("b"), 1);
+    BOOST_CHECK_EQUAL(map.ConcurrentFindOrAdd("a"), 0);
+    BOOST_CHECK_EQUAL(map.size(), 2);
+
+    auto moved = std::move(map);
+    BOOST_CHECK_EQUAL(moved.ConcurrentFindOrAdd("b"), 1);
+    BOOST_CHECK_EQUAL(moved.ConcurrentFindOrAdd("c"), 2);
+}
+
+BOOST_AUTO_TEST_CASE(dense_ids_from_parallel_inserts)
+{
+    const std::uint32_t number_of_keys = 10000;
+    ConcurrentIDMap<std::uint32_t, std::uint32_t> map;
+    // every key is requested by several threads at once
+    std::vector<std::uint32_t> ids(number_of_keys * 4);
+    tbb::parallel_for(std::size_t{0}, ids.size(), [&](const std::size_t index) {
+        ids[index] = map.ConcurrentFindOrAdd(index % number_of_keys);
+    });
+
+    BOOST_CHECK_EQUAL(map.size(), number_of_keys);
+    for (std::size_t index = number_of_keys; index < ids.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(ids[index], ids[index % number_of_keys]);
+    }
+
+    std::vector<std::uint32_t> keys_by_id(number_of_keys, number_of_keys);
+    map.ForEach([&](const std::uint32_t key, const std::uint32_t id) {
+        BOOST_REQUIRE_LT(id, number_of_keys);
+        keys_by_id[id] = key;
+    });
+    std::sort(keys_by_id.begin(), keys_by_id.end());
+    for (std::uint32_t key = 0; key < number_of_keys; ++key)
+    {
+        BOOST_CHECK_EQUAL(keys_by_id[key], key);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
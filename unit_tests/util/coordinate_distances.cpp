@@ -0,0 +1,91 @@
+#include "util/coordinate_distances.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(coordinate_distances_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+// a line with short segments, jumps across the globe and the antimeridian, and a tail after the
+// last vector
+std::vector<Coordinate> makeLine()
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<> step_distribution(-0.01, 0.01);
+
+    std::vector<Coordinate> line;
+    double lon = 13.38, lat = 52.51;
+    for (std::size_t index = 0; index < 41; ++index)
+    {
+        lon += step_distribution(generator);
+        lat += step_distribution(generator);
+        line.push_back({FloatLongitude{lon}, FloatLatitude{lat}});
+    }
+    line.push_back({FloatLongitude{179.999}, FloatLatitude{-33.8}});
+    line.push_back({FloatLongitude{-179.999}, FloatLatitude{-33.8}});
+    line.push_back({FloatLongitude{-179.999}, FloatLatitude{-33.8}});
+    line.push_back({FloatLongitude{-73.98}, FloatLatitude{40.75}});
+    line.push_back({FloatLongitude{106.07}, FloatLatitude{-40.75}});
+    line.push_back({FloatLongitude{0.}, FloatLatitude{89.9}});
+    line.push_back({FloatLongitude{180.}, FloatLatitude{89.9}});
+    line.push_back({FloatLongitude{13.38}, FloatLatitude{52.51}});
+    line.push_back({FloatLongitude{13.381}, FloatLatitude{52.5105}});
+    return line;
+}
+
+// the documented bound plus the rounding of both computations, the scalar atan2 of haversines
+// close to 0 loses a few more digits than the series
+void checkClose(const double distance, const double expected)
+{
+    BOOST_CHECK_LE(std::abs(distance - expected), 1e-9 * expected + 1e-6);
+}
+}
+
+BOOST_AUTO_TEST_CASE(haversine_distances_match_scalar)
+{
+    const auto line = makeLine();
+    std::vector<double> distances(line.size() - 1);
+    coordinate_calculation::haversineDistances(
+        line.data(), line.data() + 1, distances.size(), distances.data());
+
+    for (std::size_t index = 0; index < distances.size(); ++index)
+    {
+        checkClose(distances[index],
+                   coordinate_calculation::haversineDistance(line[index], line[index + 1]));
+    }
+    BOOST_CHECK_EQUAL(distances[42], 0.);
+}
+
+BOOST_AUTO_TEST_CASE(great_circle_distances_match_scalar)
+{
+    const auto line = makeLine();
+    std::vector<double> distances(line.size() - 1);
+    coordinate_calculation::greatCircleDistances(
+        line.data(), line.data() + 1, distances.size(), distances.data());
+
+    for (std::size_t index = 0; index < distances.size(); ++index)
+    {
+        checkClose(distances[index],
+                   coordinate_calculation::greatCircleDistance(line[index], line[index + 1]));
+    }
+    BOOST_CHECK_EQUAL(distances[42], 0.);
+}
+
+BOOST_AUTO_TEST_CASE(empty_range)
+{
+    const Coordinate coordinate{FloatLongitude{13.38}, FloatLatitude{52.51}};
+    double distance = -1.;
+    coordinate_calculation::haversineDistances(&coordinate, &coordinate, 0, &distance);
+    coordinate_calculation::greatCircleDistances(&coordinate, &coordinate, 0, &distance);
+    BOOST_CHECK_EQUAL(distance, -1.);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+#include "util/delta_vector.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/range/adaptor/reversed.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(delta_vector_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+std::vector<NodeID> makeNodes()
+{
+    std::mt19937 rng;
+    rng.seed(1337);
+    std::uniform_int_distribution<NodeID> any_node(0, std::numeric_limits<NodeID>::max());
+    std::uniform_int_distribution<int> step(-3, 3);
+
+    // runs of close ids like in geometries, separated by jumps
+    std::vector<NodeID> nodes;
+    for (auto run = 0; run < 40; ++run)
+    {
+        NodeID node = any_node(rng);
+        for (auto index = 0; index < run; ++index)
+        {
+            nodes.push_back(node);
+            node += step(rng);
+        }
+    }
+    nodes.push_back(0);
+    nodes.push_back(std::numeric_limits<NodeID>::max());
+    return nodes;
+}
+}
+
+BOOST_AUTO_TEST_CASE(encode_and_decode)
+{
+    const auto nodes = makeNodes();
+
+    DeltaVector<NodeID> encoded;
+    for (const auto node : nodes)
+        encoded.push_back(node);
+
+    BOOST_CHECK_EQUAL(encoded.size(), nodes.size());
+    BOOST_CHECK_LT(encoded.GetDeltas().size() +
+                       encoded.GetBlockOffsets().size() * sizeof(std::uint64_t),
+                   nodes.size() * sizeof(NodeID));
+
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+        BOOST_CHECK_EQUAL(encoded[index], nodes[index]);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(encoded.begin(), encoded.end(), nodes.begin(), nodes.end());
+
+    const auto reversed = boost::adaptors::reverse(boost::make_iterator_range(encoded));
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        reversed.begin(), reversed.end(), nodes.rbegin(), nodes.rend());
+}
+
+BOOST_AUTO_TEST_CASE(view_of_encoded_and_plain_values)
+{
+    auto nodes = makeNodes();
+
+    DeltaVector<NodeID> encoded;
+    for (const auto node : nodes)
+        encoded.push_back(node);
+
+    auto block_offsets = encoded.GetBlockOffsets();
+    auto deltas = encoded.GetDeltas();
+    DeltaVectorView<NodeID> encoded_view(
+        vector_view<std::uint64_t>(block_offsets.data(), block_offsets.size()),
+        vector_view<std::uint8_t>(deltas.data(), deltas.size()),
+        nodes.size());
+    DeltaVectorView<NodeID> plain_view(vector_view<NodeID>(nodes.data(), nodes.size()));
+    BOOST_CHECK(encoded_view.IsEncoded());
+    BOOST_CHECK(!plain_view.IsEncoded());
+
+    for (const auto &view : {encoded_view, plain_view})
+    {
+        BOOST_CHECK_EQUAL_COLLECTIONS(view.begin(), view.end(), nodes.begin(), nodes.end());
+
+        // sub ranges start and end within blocks like geometries do
+        const auto range = boost::make_iterator_range(view.begin() + 45, view.begin() + 103);
+        BOOST_CHECK_EQUAL(range.size(), 58);
+        BOOST_CHECK_EQUAL(range[57], nodes[102]);
+        const auto reversed = boost::adaptors::reverse(range);
+        BOOST_CHECK_EQUAL_COLLECTIONS(reversed.begin(),
+                                      reversed.end(),
+                                      nodes.rbegin() + (nodes.size() - 103),
+                                      nodes.rbegin() + (nodes.size() - 45));
+
+        const auto same_range = view.GetRange(45, 103);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            same_range.begin(), same_range.end(), range.begin(), range.end());
+        const auto same_reversed = boost::adaptors::reverse(same_range);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            same_reversed.begin(), same_reversed.end(), reversed.begin(), reversed.end());
+    }
+
+    DeltaVectorView<NodeID> empty;
+    BOOST_CHECK(empty.begin() == empty.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
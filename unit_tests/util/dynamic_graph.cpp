@@ -120,4 +120,40 @@ BOOST_AUTO_TEST_CASE(renumber_test)
     BOOST_CHECK_EQUAL(simple_graph.GetEdgeData(eit).id, 2);
 }
 
+BOOST_AUTO_TEST_CASE(compact_test)
+{
+    std::vector<TestInputEdge> input_edges = {TestInputEdge{0, 1, TestData{1}},
+                                              TestInputEdge{3, 0, TestData{2}},
+                                              TestInputEdge{3, 0, TestData{5}},
+                                              TestInputEdge{3, 4, TestData{3}},
+                                              TestInputEdge{4, 3, TestData{4}}};
+    TestDynamicGraph simple_graph(5, input_edges);
+
+    // the edges of 0 move to the end of the edge list
+    simple_graph.InsertEdge(0, 4, TestData{6});
+    simple_graph.DeleteEdge(3, simple_graph.FindEdge(3, 4));
+    BOOST_CHECK_EQUAL(simple_graph.GetNumberOfEdges(), 5);
+    BOOST_CHECK_GT(simple_graph.GetNumberOfEdgeSlots(), 5);
+
+    simple_graph.Compact();
+    BOOST_CHECK_EQUAL(simple_graph.GetNumberOfNodes(), 5);
+    BOOST_CHECK_EQUAL(simple_graph.GetNumberOfEdges(), 5);
+    BOOST_CHECK_EQUAL(simple_graph.GetNumberOfEdgeSlots(), 5);
+    BOOST_CHECK_EQUAL(simple_graph.GetEdgeData(simple_graph.FindEdge(0, 4)).id, 6);
+    BOOST_CHECK_EQUAL(simple_graph.GetEdgeData(simple_graph.FindEdge(4, 3)).id, 4);
+    BOOST_CHECK_EQUAL(simple_graph.FindEdge(3, 4), SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(simple_graph.GetOutDegree(3), 2);
+
+    // drop 2 and 4, only the edge 0 -> 1 is left as 2 -> 0
+    simple_graph.DeleteEdge(0, simple_graph.FindEdge(0, 4));
+    simple_graph.DeleteEdge(3, simple_graph.FindEdge(3, 0));
+    simple_graph.DeleteEdge(3, simple_graph.FindEdge(3, 0));
+    simple_graph.Compact({2, 0, SPECIAL_NODEID, 1, SPECIAL_NODEID});
+    BOOST_CHECK_EQUAL(simple_graph.GetNumberOfNodes(), 3);
+    BOOST_CHECK_EQUAL(simple_graph.GetNumberOfEdges(), 1);
+    BOOST_CHECK_EQUAL(simple_graph.GetEdgeData(simple_graph.FindEdge(2, 0)).id, 1);
+    BOOST_CHECK_EQUAL(simple_graph.GetOutDegree(0), 0);
+    BOOST_CHECK_EQUAL(simple_graph.GetOutDegree(1), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,73 @@
+#include "util/external_sorter.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(external_sorter_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+std::vector<std::uint64_t> randomValues(const std::size_t count)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint64_t> distribution(0, count / 2);
+    std::vector<std::uint64_t> values(count);
+    std::generate(values.begin(), values.end(), [&] { return distribution(generator); });
+    return values;
+}
+
+template <typename Sorter> std::vector<std::uint64_t> collect(Sorter &sorter)
+{
+    std::vector<std::uint64_t> sorted;
+    sorter.ForEach([&](const std::uint64_t value) { sorted.push_back(value); });
+    return sorted;
+}
+}
+
+BOOST_AUTO_TEST_CASE(sort_in_memory)
+{
+    auto values = randomValues(1000);
+    ExternalSorter<std::uint64_t> sorter(boost::filesystem::temp_directory_path(),
+                                         10000 * sizeof(std::uint64_t));
+    for (const auto value : values)
+        sorter.push_back(value);
+
+    BOOST_CHECK_EQUAL(sorter.size(), values.size());
+    BOOST_CHECK_EQUAL(sorter.NumberOfRuns(), 0);
+
+    std::sort(values.begin(), values.end());
+    const auto sorted = collect(sorter);
+    BOOST_CHECK_EQUAL_COLLECTIONS(sorted.begin(), sorted.end(), values.begin(), values.end());
+}
+
+BOOST_AUTO_TEST_CASE(merge_runs)
+{
+    auto values = randomValues(10001);
+    ExternalSorter<std::uint64_t, std::greater<std::uint64_t>> sorter(
+        boost::filesystem::temp_directory_path(), 1000 * sizeof(std::uint64_t));
+    for (const auto value : values)
+        sorter.push_back(value);
+
+    // buffers of 500 elements, the last one is merged from memory
+    BOOST_CHECK_EQUAL(sorter.NumberOfRuns(), 20);
+
+    std::sort(values.begin(), values.end(), std::greater<std::uint64_t>());
+    const auto sorted = collect(sorter);
+    BOOST_CHECK_EQUAL_COLLECTIONS(sorted.begin(), sorted.end(), values.begin(), values.end());
+
+    // the runs are kept until the sorter is destroyed
+    const auto sorted_again = collect(sorter);
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        sorted_again.begin(), sorted_again.end(), values.begin(), values.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
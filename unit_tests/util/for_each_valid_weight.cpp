@@ -0,0 +1,70 @@
+#include "util/for_each_valid_weight.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(for_each_valid_weight_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+// the arguments of the calls, flattened to index, weight, index, weight, ...
+std::vector<std::size_t> collect(const std::vector<EdgeWeight> &row, const EdgeWeight weight)
+{
+    std::vector<std::size_t> result;
+    for_each_valid_weight(
+        row.data(), row.size(), weight, [&](const std::size_t index, const EdgeWeight to_weight) {
+            result.push_back(index);
+            result.push_back(to_weight);
+        });
+    return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(skips_invalid_weights)
+{
+    const auto I = INVALID_EDGE_WEIGHT;
+    // longer than any vector, with a tail and a vector without a single valid weight
+    const std::vector<EdgeWeight> row = {1, I, 3, I, I, I, I, I, I, I, I, I, I, I, I, I, 0, I, 19};
+
+    const std::vector<std::size_t> expected = {0, 11, 2, 13, 16, 10, 18, 29};
+    const auto result = collect(row, 10);
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(matches_scalar_loop)
+{
+    std::vector<EdgeWeight> row;
+    for (EdgeWeight value = 0; value < 100; ++value)
+    {
+        row.push_back(value % 3 == 0 ? INVALID_EDGE_WEIGHT : value * 7);
+    }
+
+    for (std::size_t size = 0; size <= row.size(); ++size)
+    {
+        const std::vector<EdgeWeight> prefix(row.begin(), row.begin() + size);
+        std::vector<std::size_t> expected;
+        for (std::size_t index = 0; index < size; ++index)
+        {
+            if (prefix[index] != INVALID_EDGE_WEIGHT)
+            {
+                expected.push_back(index);
+                expected.push_back(42 + prefix[index]);
+            }
+        }
+        const auto result = collect(prefix, 42);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            result.begin(), result.end(), expected.begin(), expected.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(empty_row)
+{
+    BOOST_CHECK(collect({}, 0).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,9 @@
 #include <boost/test/test_case_template.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(hilbert_values_test)
 
 using namespace osrm::util;
@@ -82,4 +85,29 @@ BOOST_AUTO_TEST_CASE(hilbert_linearization_32bit_test)
     BOOST_CHECK_EQUAL(bit32(0xffffffff, 0xffffffff), 0xaaaaaaaaaaaaaaaa);
 }
 
+BOOST_AUTO_TEST_CASE(hilbert_order_test)
+{
+    BOOST_CHECK(GetHilbertOrder({}).empty());
+
+    // two clusters far apart, the coordinates of each cluster follow each other
+    const std::vector<Coordinate> coordinates = {
+        Coordinate{FloatLongitude{13.40}, FloatLatitude{52.52}},
+        Coordinate{FloatLongitude{-73.98}, FloatLatitude{40.75}},
+        Coordinate{FloatLongitude{13.41}, FloatLatitude{52.51}},
+        Coordinate{FloatLongitude{-73.97}, FloatLatitude{40.76}}};
+    const auto order = GetHilbertOrder(coordinates);
+
+    BOOST_REQUIRE_EQUAL(order.size(), coordinates.size());
+    std::vector<bool> seen(coordinates.size(), false);
+    for (std::size_t rank = 0; rank < order.size(); ++rank)
+    {
+        seen[order[rank]] = true;
+        BOOST_CHECK(rank == 0 || GetHilbertCode(coordinates[order[rank - 1]]) <=
+                                     GetHilbertCode(coordinates[order[rank]]));
+    }
+    BOOST_CHECK(std::all_of(seen.begin(), seen.end(), [](const bool value) { return value; }));
+    BOOST_CHECK_EQUAL(order[0] % 2, order[1] % 2);
+    BOOST_CHECK_EQUAL(order[2] % 2, order[3] % 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
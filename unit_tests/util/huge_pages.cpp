@@ -0,0 +1,63 @@
+#include "util/huge_pages.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(huge_pages_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(rounds_to_huge_pages)
+{
+    const auto huge_page_size = getHugePageSize();
+    if (huge_page_size == 0)
+    {
+        BOOST_CHECK_EQUAL(roundToHugePages(1000), 1000);
+        return;
+    }
+    BOOST_CHECK_EQUAL(roundToHugePages(0), 0);
+    BOOST_CHECK_EQUAL(roundToHugePages(1), huge_page_size);
+    BOOST_CHECK_EQUAL(roundToHugePages(huge_page_size), huge_page_size);
+    BOOST_CHECK_EQUAL(roundToHugePages(huge_page_size + 1), 2 * huge_page_size);
+}
+
+// Huge pages fall back to regular pages, memory is usable and zeroed either way
+BOOST_AUTO_TEST_CASE(process_memory_is_zeroed)
+{
+    const std::size_t size = 3 * 1024 * 1024 + 17;
+    for (const auto use_huge_pages : {false, true})
+    {
+        ProcessMemory memory(size, use_huge_pages);
+        BOOST_REQUIRE(memory.Get() != nullptr);
+        BOOST_CHECK(std::all_of(
+            memory.Get(), memory.Get() + size, [](const char value) { return value == 0; }));
+        std::fill(memory.Get(), memory.Get() + size, 1);
+        BOOST_CHECK(!describePages(memory.Get()).empty());
+    }
+}
+
+// Ranges need not start or end at page boundaries
+BOOST_AUTO_TEST_CASE(prefault_pages)
+{
+    std::vector<char> memory(5 * 4096 + 123, 1);
+    prefaultPages(memory.data() + 7, memory.size() - 7);
+    prefaultPages(memory.data(), 0);
+    BOOST_CHECK(std::all_of(
+        memory.begin(), memory.end(), [](const char value) { return value == 1; }));
+}
+
+// Locking fails only for lack of a high enough limit or of the permission to lock memory
+BOOST_AUTO_TEST_CASE(lock_pages)
+{
+    std::vector<char> memory(4096, 1);
+    BOOST_CHECK(lockPages(memory.data(), memory.size()) || errno == ENOMEM || errno == EPERM ||
+                errno == ENOSYS);
+    BOOST_CHECK(!describeLockedMemoryLimit().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,7 @@
 #include <boost/test/test_case_template.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <array>
 #include <exception>
 #include <numeric>
 #include <string>
@@ -41,6 +42,108 @@ BOOST_AUTO_TEST_CASE(io_data)
     BOOST_CHECK_EQUAL_COLLECTIONS(data_out.begin(), data_out.end(), data_in.begin(), data_in.end());
 }
 
+BOOST_AUTO_TEST_CASE(io_deallocating_vector)
+{
+    // 8192 elements fill a block of the vector
+    using Element = std::array<std::uint32_t, 256>;
+    for (const std::size_t size : {0, 3, 8192, 8195})
+    {
+        osrm::util::DeallocatingVector<Element> data_in, data_out;
+        for (const auto index : osrm::util::irange<std::uint32_t>(0, size))
+        {
+            data_in.push_back(Element{{index}});
+        }
+
+        {
+            osrm::storage::io::FileWriter outfile(
+                IO_TMP_FILE, osrm::storage::io::FileWriter::GenerateFingerprint);
+            osrm::storage::serialization::write(outfile, data_in);
+        }
+
+        osrm::storage::io::FileReader infile(IO_TMP_FILE,
+                                             osrm::storage::io::FileReader::VerifyFingerprint);
+        osrm::storage::serialization::read(infile, data_out);
+
+        BOOST_REQUIRE_EQUAL(data_out.size(), size);
+        for (const auto index : osrm::util::irange<std::uint32_t>(0, size))
+        {
+            BOOST_CHECK_EQUAL(data_out[index][0], index);
+        }
+        // the read vector can grow
+        data_out.push_back(Element{{1}});
+        BOOST_CHECK_EQUAL(data_out[size][0], 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(io_read_modes)
+{
+    // large enough for bulk reads over several direct chunks, at unaligned offsets
+    std::vector<std::uint32_t> data_in(5 * 1024 * 1024 + 7);
+    std::iota(begin(data_in), end(data_in), 0);
+
+    {
+        osrm::storage::io::FileWriter outfile(IO_TMP_FILE,
+                                              osrm::storage::io::FileWriter::GenerateFingerprint);
+        outfile.WriteOne<std::uint8_t>(42);
+        osrm::storage::serialization::write(outfile, data_in);
+        outfile.WriteOne<std::uint8_t>(43);
+    }
+
+    using FileReader = osrm::storage::io::FileReader;
+    for (const auto read_mode :
+         {FileReader::StreamRead, FileReader::BulkRead, FileReader::DirectRead})
+    {
+        FileReader infile(IO_TMP_FILE, FileReader::VerifyFingerprint, read_mode);
+        BOOST_CHECK_EQUAL(infile.ReadOne<std::uint8_t>(), 42);
+        std::vector<std::uint32_t> data_out;
+        osrm::storage::serialization::read(infile, data_out);
+        BOOST_CHECK(data_out == data_in);
+        BOOST_CHECK_EQUAL(infile.ReadOne<std::uint8_t>(), 43);
+
+        // reading past the end fails the same way in all modes
+        std::vector<std::uint32_t> too_large(data_in.size());
+        FileReader shortfile(IO_TMP_FILE, FileReader::VerifyFingerprint, read_mode);
+        shortfile.Skip<std::uint8_t>(1 + sizeof(std::uint64_t) + 8);
+        BOOST_CHECK_THROW(shortfile.ReadInto(too_large), osrm::util::RuntimeError);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(io_compressed_blocks)
+{
+    // several compression blocks, with values that cross block boundaries
+    std::vector<std::uint32_t> data_in(3 * 1024 * 1024 + 7);
+    std::iota(begin(data_in), end(data_in), 0);
+
+    using FileWriter = osrm::storage::io::FileWriter;
+    using FileReader = osrm::storage::io::FileReader;
+    {
+        FileWriter outfile(
+            IO_TMP_FILE, FileWriter::GenerateFingerprint, FileWriter::CompressBlocks);
+        outfile.WriteOne<std::uint8_t>(42);
+        osrm::storage::serialization::write(outfile, data_in);
+        outfile.WriteOne<std::uint8_t>(43);
+        BOOST_CHECK_THROW(outfile.SkipToBeginning(), osrm::util::exception);
+    }
+
+    for (const auto read_mode :
+         {FileReader::StreamRead, FileReader::BulkRead, FileReader::DirectRead})
+    {
+        FileReader infile(IO_TMP_FILE, FileReader::VerifyFingerprint, read_mode);
+        BOOST_CHECK_EQUAL(infile.ReadOne<std::uint8_t>(), 42);
+        std::vector<std::uint32_t> data_out;
+        osrm::storage::serialization::read(infile, data_out);
+        BOOST_CHECK(data_out == data_in);
+        BOOST_CHECK_EQUAL(infile.ReadOne<std::uint8_t>(), 43);
+        BOOST_CHECK_THROW(infile.ReadOne<std::uint8_t>(), osrm::util::RuntimeError);
+    }
+
+    FileReader skipping(IO_TMP_FILE, FileReader::VerifyFingerprint);
+    skipping.Skip<std::uint8_t>(1);
+    BOOST_CHECK_EQUAL(skipping.ReadVectorSize<std::uint32_t>(), data_in.size());
+    BOOST_CHECK_EQUAL(skipping.ReadOne<std::uint8_t>(), 43);
+    BOOST_CHECK_THROW(skipping.GetSize(), osrm::util::RuntimeError);
+}
+
 BOOST_AUTO_TEST_CASE(io_nonexistent_file)
 {
     try
@@ -0,0 +1,158 @@
+#include "util/json_binary_renderer.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(json_binary_renderer)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+template <typename T> T read(const std::vector<char> &buffer, const std::size_t offset)
+{
+    BOOST_REQUIRE_LE(offset + sizeof(T), buffer.size());
+    T value;
+    std::memcpy(&value, buffer.data() + offset, sizeof(T));
+    return value;
+}
+
+// Decodes the slot at the given offset back into JSON text, the way a client would walk it
+std::string decode(const std::vector<char> &buffer, const std::size_t slot)
+{
+    BOOST_REQUIRE_EQUAL(slot % 8, 0);
+    const auto type = read<std::uint32_t>(buffer, slot);
+    const auto size = read<std::uint32_t>(buffer, slot + 4);
+    const auto payload = read<std::uint64_t>(buffer, slot + 8);
+
+    const auto number = [](const double value) {
+        std::vector<char> out;
+        json::render(out, json::Object{{{"n", json::Number(value)}}});
+        return std::string(out.begin() + 5, out.end() - 1);
+    };
+
+    switch (type)
+    {
+    case json::BINARY_NULL:
+        return "null";
+    case json::BINARY_FALSE:
+        return "false";
+    case json::BINARY_TRUE:
+        return "true";
+    case json::BINARY_NUMBER:
+    {
+        double value;
+        std::memcpy(&value, &payload, sizeof(value));
+        return number(value);
+    }
+    case json::BINARY_STRING:
+        BOOST_REQUIRE_EQUAL(buffer[payload + size], '\0');
+        return "\"" + std::string(buffer.data() + payload, size) + "\"";
+    case json::BINARY_ARRAY:
+    {
+        std::string out = "[";
+        for (std::size_t index = 0; index < size; ++index)
+            out += (index == 0 ? "" : ",") + decode(buffer, payload + 16 * index);
+        return out + "]";
+    }
+    case json::BINARY_OBJECT:
+    {
+        std::string out = "{";
+        for (std::size_t index = 0; index < size; ++index)
+            out += (index == 0 ? "" : ",") + decode(buffer, payload + 32 * index) + ":" +
+                   decode(buffer, payload + 32 * index + 16);
+        return out + "}";
+    }
+    case json::BINARY_NUMBER_ARRAY:
+    {
+        BOOST_REQUIRE_EQUAL(payload % 8, 0);
+        std::string out = "[";
+        for (std::size_t index = 0; index < size; ++index)
+        {
+            const auto value = read<double>(buffer, payload + 8 * index);
+            out += (index == 0 ? "" : ",") + (std::isnan(value) ? "null" : number(value));
+        }
+        return out + "]";
+    }
+    }
+    BOOST_FAIL("unknown slot type " << type);
+    return "";
+}
+
+std::string renderJSON(const json::Object &object)
+{
+    std::vector<char> out;
+    json::render(out, object);
+    return std::string(out.begin(), out.end());
+}
+}
+
+BOOST_AUTO_TEST_CASE(header)
+{
+    std::vector<char> buffer;
+    json::renderBinary(buffer, json::Object());
+
+    BOOST_REQUIRE_EQUAL(buffer.size(), 24);
+    BOOST_CHECK_EQUAL(std::string(buffer.data(), 4), "OSRM");
+    BOOST_CHECK_EQUAL(read<std::uint32_t>(buffer, 4), json::BINARY_FORMAT_VERSION);
+    BOOST_CHECK_EQUAL(read<std::uint32_t>(buffer, 8), json::BINARY_OBJECT);
+    BOOST_CHECK_EQUAL(read<std::uint32_t>(buffer, 12), 0);
+}
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    json::Array durations;
+    durations.values.push_back(json::Array{{json::Number(0), json::Number(12.5)}});
+    durations.values.push_back(json::Array{{json::Null(), json::Number(0)}});
+
+    json::Object waypoint;
+    waypoint.values["name"] = json::String("Boulevard du Larvotto");
+    waypoint.values["location"] = json::Array{{json::Number(7.437), json::Number(43.7455)}};
+
+    json::Object response;
+    response.values["code"] = json::String("Ok");
+    response.values["durations"] = std::move(durations);
+    response.values["sources"] = json::Array{{std::move(waypoint)}};
+    response.values["empty"] = json::Array();
+    response.values["nulls"] = json::Array{{json::Null(), json::Null()}};
+    response.values["mixed"] = json::Array{{json::Number(1), json::True(), json::False()}};
+
+    std::vector<char> buffer;
+    json::renderBinary(buffer, response);
+    BOOST_CHECK_EQUAL(decode(buffer, 8), renderJSON(response));
+}
+
+BOOST_AUTO_TEST_CASE(packed_number_arrays)
+{
+    json::Object response;
+    response.values["row"] = json::Array{{json::Number(1), json::Null(), json::Number(3)}};
+    response.values["nulls"] = json::Array{{json::Null()}};
+
+    std::vector<char> buffer;
+    json::renderBinary(buffer, response);
+
+    const auto members = read<std::uint64_t>(buffer, 16);
+    const auto row = members + 16;
+    BOOST_CHECK_EQUAL(read<std::uint32_t>(buffer, row), json::BINARY_NUMBER_ARRAY);
+    BOOST_CHECK_EQUAL(read<std::uint32_t>(buffer, row + 4), 3);
+    const auto values = read<std::uint64_t>(buffer, row + 8);
+    BOOST_CHECK_EQUAL(read<double>(buffer, values), 1.);
+    BOOST_CHECK(std::isnan(read<double>(buffer, values + 8)));
+    BOOST_CHECK_EQUAL(read<double>(buffer, values + 16), 3.);
+
+    // without a single number there is nothing to tell null apart from a number
+    const auto nulls = members + 48;
+    BOOST_CHECK_EQUAL(read<std::uint32_t>(buffer, nulls), json::BINARY_ARRAY);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,47 @@
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(json_container)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(object_keeps_insertion_order)
+{
+    json::Object object;
+    object.values["zulu"] = json::Number(1);
+    object.values["alpha"] = json::String("a");
+    object.values["mike"] = json::True();
+    object.values["zulu"] = json::Number(2);
+
+    std::ostringstream out;
+    json::render(out, object);
+    BOOST_CHECK_EQUAL(out.str(), "{\"zulu\":2,\"alpha\":\"a\",\"mike\":true}");
+}
+
+BOOST_AUTO_TEST_CASE(object_lookup)
+{
+    json::Object object{{{"code", json::String("Ok")}, {"count", json::Number(3)}}};
+
+    BOOST_CHECK_EQUAL(object.values.size(), 2);
+    BOOST_CHECK_EQUAL(object.values.count("code"), 1);
+    BOOST_CHECK_EQUAL(object.values.count("message"), 0);
+    BOOST_CHECK_EQUAL(object.values.at("code").get<json::String>().value, "Ok");
+    BOOST_CHECK_THROW(object.values.at("message"), std::out_of_range);
+
+    BOOST_CHECK(!object.values.emplace("count", json::Number(4)).second);
+    BOOST_CHECK_EQUAL(object.values.at("count").get<json::Number>().value, 3);
+
+    BOOST_CHECK_EQUAL(object.values.erase("code"), 1);
+    BOOST_CHECK(object.values.find("code") == object.values.end());
+    BOOST_CHECK_EQUAL(object.values.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+#include "util/lru_cache.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(lru_cache_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(evicts_least_recently_used)
+{
+    // a single shard evicts in exact LRU order
+    ShardedLRUCache<int, int> cache(2, 1);
+    cache.Insert(1, std::make_shared<const int>(10));
+    cache.Insert(2, std::make_shared<const int>(20));
+
+    // touching 1 makes 2 the least recently used key
+    BOOST_CHECK_EQUAL(*cache.Get(1), 10);
+    cache.Insert(3, std::make_shared<const int>(30));
+
+    BOOST_CHECK(cache.Get(2) == nullptr);
+    BOOST_CHECK_EQUAL(*cache.Get(1), 10);
+    BOOST_CHECK_EQUAL(*cache.Get(3), 30);
+
+    const auto statistics = cache.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.hits, 3);
+    BOOST_CHECK_EQUAL(statistics.misses, 1);
+    BOOST_CHECK_EQUAL(statistics.evictions, 1);
+    BOOST_CHECK_EQUAL(statistics.entries, 2);
+    BOOST_CHECK_EQUAL(statistics.capacity, 2);
+}
+
+BOOST_AUTO_TEST_CASE(replaces_values)
+{
+    ShardedLRUCache<int, int> cache(4);
+    cache.Insert(1, std::make_shared<const int>(10));
+    const auto old_value = cache.Get(1);
+    cache.Insert(1, std::make_shared<const int>(11));
+
+    BOOST_CHECK_EQUAL(*cache.Get(1), 11);
+    // values handed out stay valid
+    BOOST_CHECK_EQUAL(*old_value, 10);
+    BOOST_CHECK_EQUAL(cache.GetStatistics().entries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(clear)
+{
+    ShardedLRUCache<int, int> cache(100);
+    for (int key = 0; key < 50; ++key)
+    {
+        cache.Insert(key, std::make_shared<const int>(key));
+    }
+    BOOST_CHECK_EQUAL(cache.GetStatistics().entries, 50);
+
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.GetStatistics().entries, 0);
+    BOOST_CHECK_EQUAL(cache.GetStatistics().evictions, 0);
+    BOOST_CHECK(cache.Get(0) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(bounded_size)
+{
+    ShardedLRUCache<int, int> cache(64, 8);
+    for (int key = 0; key < 1000; ++key)
+    {
+        cache.Insert(key, std::make_shared<const int>(key));
+    }
+    BOOST_CHECK_LE(cache.GetStatistics().entries, 64);
+    BOOST_CHECK_EQUAL(cache.GetStatistics().entries + cache.GetStatistics().evictions, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_access)
+{
+    ShardedLRUCache<int, int> cache(128);
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread)
+    {
+        threads.emplace_back([&cache, thread]() {
+            for (int iteration = 0; iteration < 1000; ++iteration)
+            {
+                const auto key = (thread * 1000 + iteration) % 200;
+                if (const auto value = cache.Get(key))
+                {
+                    BOOST_CHECK_EQUAL(*value, key);
+                }
+                else
+                {
+                    cache.Insert(key, std::make_shared<const int>(key));
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto statistics = cache.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.hits + statistics.misses, 4000);
+    BOOST_CHECK_LE(statistics.entries, 128);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#include "util/marching_squares.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+
+BOOST_AUTO_TEST_SUITE(marching_squares_test)
+
+using namespace osrm;
+using namespace osrm::util::marching_squares;
+
+namespace
+{
+std::int64_t doubledArea(const Ring &ring)
+{
+    std::int64_t area = 0;
+    for (std::size_t index = 0; index < ring.size(); ++index)
+    {
+        const auto &from = ring[index];
+        const auto &to = ring[(index + 1) % ring.size()];
+        area += static_cast<std::int64_t>(from.x) * to.y - static_cast<std::int64_t>(to.x) * from.y;
+    }
+    return area;
+}
+}
+
+BOOST_AUTO_TEST_CASE(single_cell)
+{
+    Grid grid(3, 3);
+    grid.Set(1, 1);
+
+    const auto polygons = traceContours(grid);
+    BOOST_REQUIRE_EQUAL(polygons.size(), 1);
+    BOOST_CHECK(polygons[0].holes.empty());
+
+    // a diamond through the midpoints around the center (2, 2)
+    const auto &outer = polygons[0].outer;
+    BOOST_REQUIRE_EQUAL(outer.size(), 4);
+    for (const auto &point : outer)
+    {
+        BOOST_CHECK_EQUAL(std::abs(point.x - 2) + std::abs(point.y - 2), 1);
+    }
+    BOOST_CHECK_GT(doubledArea(outer), 0);
+}
+
+BOOST_AUTO_TEST_CASE(block_with_hole)
+{
+    Grid grid(5, 5);
+    for (std::size_t y = 1; y <= 3; ++y)
+        for (std::size_t x = 1; x <= 3; ++x)
+            if (x != 2 || y != 2)
+                grid.Set(x, y);
+
+    const auto polygons = traceContours(grid);
+    BOOST_REQUIRE_EQUAL(polygons.size(), 1);
+    // the corners of the block are cut off
+    BOOST_CHECK_EQUAL(polygons[0].outer.size(), 8);
+    BOOST_CHECK_GT(doubledArea(polygons[0].outer), 0);
+
+    BOOST_REQUIRE_EQUAL(polygons[0].holes.size(), 1);
+    const auto &hole = polygons[0].holes[0];
+    BOOST_REQUIRE_EQUAL(hole.size(), 4);
+    for (const auto &point : hole)
+    {
+        BOOST_CHECK_EQUAL(std::abs(point.x - 4) + std::abs(point.y - 4), 1);
+    }
+    BOOST_CHECK_LT(doubledArea(hole), 0);
+}
+
+BOOST_AUTO_TEST_CASE(cells_on_the_border)
+{
+    Grid grid(2, 1);
+    grid.Set(0, 0);
+    grid.Set(1, 0);
+
+    const auto polygons = traceContours(grid);
+    BOOST_REQUIRE_EQUAL(polygons.size(), 1);
+    BOOST_CHECK_EQUAL(polygons[0].outer.size(), 6);
+    BOOST_CHECK(polygons[0].holes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(diagonal_cells)
+{
+    Grid grid(4, 4);
+    grid.Set(1, 1);
+    grid.Set(2, 2);
+
+    BOOST_CHECK_EQUAL(traceContours(grid).size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(closing_fills_gaps)
+{
+    Grid grid(5, 3);
+    grid.Set(1, 1);
+    grid.Set(3, 1);
+    BOOST_CHECK_EQUAL(traceContours(grid).size(), 2);
+
+    grid.Close();
+    BOOST_CHECK(grid.IsSet(1, 1));
+    BOOST_CHECK(grid.IsSet(2, 1));
+    BOOST_CHECK(grid.IsSet(3, 1));
+    BOOST_CHECK(!grid.IsSet(0, 1));
+    BOOST_CHECK(!grid.IsSet(2, 0));
+    BOOST_CHECK_EQUAL(traceContours(grid).size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
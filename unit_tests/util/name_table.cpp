@@ -19,7 +19,8 @@ BOOST_AUTO_TEST_SUITE(name_table)
 using namespace osrm;
 using namespace osrm::util;
 
-std::string PrapareNameTableData(std::vector<std::string> &data, bool fill_all)
+std::string
+PrapareNameTableData(std::vector<std::string> &data, bool fill_all, bool intern_strings = false)
 {
     NameTable::IndexedData indexed_data;
     std::vector<unsigned char> name_char_data;
@@ -60,6 +61,11 @@ std::string PrapareNameTableData(std::vector<std::string> &data, bool fill_all)
     }
     name_offsets.push_back(name_char_data.size());
 
+    if (intern_strings)
+    {
+        NameTable::InternStrings(name_offsets, name_char_data);
+    }
+
     TemporaryFile file;
     {
         storage::io::FileWriter writer(file.path, storage::io::FileWriter::HasNoFingerprint);
@@ -123,6 +129,46 @@ BOOST_AUTO_TEST_CASE(check_name_table_nofill)
     // CALLGRIND_STOP_INSTRUMENTATION;
 }
 
+BOOST_AUTO_TEST_CASE(check_name_table_interned)
+{
+    std::vector<std::string> expected_names = {"",
+                                               "Main Street",
+                                               "Main",
+                                               "Main Street",
+                                               "Station Road",
+                                               "ab",
+                                               "Main Street",
+                                               "Station Road",
+                                               "Main"};
+
+    const auto data = PrapareNameTableData(expected_names, true);
+    auto interned_data = PrapareNameTableData(expected_names, true, true);
+    BOOST_CHECK_LT(interned_data.size(), data.size());
+
+    NameTable name_table;
+    name_table.reset(&interned_data[0], &interned_data[interned_data.size()]);
+
+    for (std::size_t index = 0; index < expected_names.size(); ++index)
+    {
+        const NameID id = 5 * index;
+        BOOST_CHECK_EQUAL(name_table.GetNameForID(id), expected_names[index]);
+        BOOST_CHECK_EQUAL(name_table.GetRefForID(id), expected_names[index] + "_ref");
+        BOOST_CHECK_EQUAL(name_table.GetDestinationsForID(id), expected_names[index] + "_des");
+        BOOST_CHECK_EQUAL(name_table.GetPronunciationForID(id), expected_names[index] + "_pro");
+        BOOST_CHECK_EQUAL(name_table.GetExitsForID(id), expected_names[index] + "_ext");
+    }
+
+    // repeated strings are views of their first occurrence
+    BOOST_CHECK(name_table.GetNameForID(5 * 6).data() == name_table.GetNameForID(5).data());
+    BOOST_CHECK(name_table.GetRefForID(5 * 7).data() == name_table.GetRefForID(5 * 4).data());
+}
+
+BOOST_AUTO_TEST_CASE(check_name_table_nul_reference)
+{
+    std::vector<std::string> names = {std::string("\0abcd", 5)};
+    BOOST_CHECK_THROW(PrapareNameTableData(names, false, true), util::exception);
+}
+
 BOOST_AUTO_TEST_CASE(check_invalid_ids)
 {
     NameTable name_table;
@@ -0,0 +1,41 @@
+#include "util/numa.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(numa_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(threads_run_on_their_node)
+{
+    const auto nodes = numa::getNodes();
+    BOOST_REQUIRE(!nodes.empty());
+
+    for (const auto &node : nodes)
+    {
+        std::thread([&node] {
+            BOOST_CHECK(numa::pinThreadToNode(node));
+            // without NUMA support every thread is on node 0
+            BOOST_CHECK_EQUAL(numa::getCurrentNode(), node.id);
+        }).join();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(interleaving_falls_back)
+{
+    // with a single node there is nothing to interleave, both are no-ops then
+    numa::ThreadInterleave interleave;
+    std::vector<char> memory(1 << 20, 1);
+    BOOST_CHECK(std::all_of(memory.begin(), memory.end(), [](const char value) { return value; }));
+    if (numa::getNodes().size() < 2)
+    {
+        BOOST_CHECK(!interleave.IsActive());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
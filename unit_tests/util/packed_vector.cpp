@@ -7,6 +7,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <algorithm>
+#include <iterator>
 #include <numeric>
 #include <random>
 
@@ -203,4 +204,70 @@ BOOST_AUTO_TEST_CASE(packed_vector_33bit_continious)
     }
 }
 
+template <std::size_t Bits> void check_bulk_access(const std::size_t size)
+{
+    const std::uint64_t mask = ~std::uint64_t{0} >> (64 - Bits);
+    std::mt19937 rng(1337);
+    std::vector<std::uint64_t> values(size);
+    std::generate(values.begin(), values.end(), [&] { return (rng() * rng()) & mask; });
+
+    // grown by push_back there is no sentinel word after the last block
+    PackedVector<std::uint64_t, Bits> packed;
+    for (const auto value : values)
+        packed.push_back(value);
+
+    for (const auto first : {std::size_t{0}, std::size_t{1}, std::size_t{64}, size / 3})
+    {
+        for (const auto last : {first, first + 1, size / 2 + 5, size - 1, size})
+        {
+            if (last < first || last > size)
+                continue;
+
+            std::vector<std::uint64_t> unpacked;
+            packed.unpack(first, last, std::back_inserter(unpacked));
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                unpacked.begin(), unpacked.end(), values.begin() + first, values.begin() + last);
+
+            const auto range = packed.unpacked(first, last);
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                range.begin(), range.end(), values.begin() + first, values.begin() + last);
+        }
+    }
+
+    PackedVector<std::uint64_t, Bits> repacked(size);
+    std::vector<std::uint64_t> reversed(values.rbegin(), values.rend());
+    repacked.pack(0, values.begin(), values.begin() + size / 3);
+    repacked.pack(size / 3, values.begin() + size / 3, values.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(repacked.cbegin(), repacked.cend(), values.begin(), values.end());
+
+    repacked.pack(7, reversed.begin(), reversed.end() - 7);
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        BOOST_CHECK_EQUAL(repacked[index], index < 7 ? values[index] : reversed[index - 7]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(packed_vector_bulk_access)
+{
+    check_bulk_access<1>(300);
+    check_bulk_access<10>(200);
+    check_bulk_access<22>(1000);
+    check_bulk_access<33>(1000);
+    check_bulk_access<57>(257);
+    check_bulk_access<63>(130);
+}
+
+BOOST_AUTO_TEST_CASE(packed_vector_bulk_access_osm_ids)
+{
+    PackedVector<OSMNodeID, 33> packed_ids(200);
+    std::vector<OSMNodeID> ids;
+    for (const auto index : irange<std::uint64_t>(0, 200))
+        ids.push_back(OSMNodeID{(index * 0x9E3779B97F4A7C15ULL) >> 31});
+
+    packed_ids.pack(0, ids.begin(), ids.end());
+    std::vector<OSMNodeID> unpacked(200);
+    packed_ids.unpack(0, 200, unpacked.begin());
+    BOOST_CHECK(unpacked == ids);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
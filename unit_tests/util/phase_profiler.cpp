@@ -0,0 +1,83 @@
+#include "util/phase_profiler.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+const static std::string PHASE_REPORT_TMP_FILE = "test_phase_report.tmp";
+
+BOOST_AUTO_TEST_SUITE(phase_profiler)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(nested_phases)
+{
+    const auto first = PhaseProfiler::GetInstance().GetPhases().size();
+
+    {
+        ProfilePhase outer("outer");
+        {
+            ProfilePhase inner("inner");
+            std::vector<char> buffer(1024 * 1024, 1);
+            BOOST_CHECK_EQUAL(buffer.back(), 1);
+        }
+        ProfilePhase stopped("stopped");
+        stopped.Stop();
+        stopped.Stop();
+    }
+    ProfilePhase after("after");
+    after.Stop();
+
+    const auto phases = PhaseProfiler::GetInstance().GetPhases();
+    BOOST_REQUIRE_EQUAL(phases.size(), first + 4);
+
+    BOOST_CHECK_EQUAL(phases[first].name, "outer");
+    BOOST_CHECK_EQUAL(phases[first].depth, phases[first + 3].depth);
+    BOOST_CHECK_EQUAL(phases[first + 1].name, "inner");
+    BOOST_CHECK_EQUAL(phases[first + 1].depth, phases[first].depth + 1);
+    BOOST_CHECK_EQUAL(phases[first + 2].name, "stopped");
+    BOOST_CHECK_EQUAL(phases[first + 2].depth, phases[first].depth + 1);
+    BOOST_CHECK_EQUAL(phases[first + 3].name, "after");
+
+    for (auto index = first; index < phases.size(); ++index)
+    {
+        BOOST_CHECK_GE(phases[index].wall_seconds, 0.);
+        BOOST_CHECK_GE(phases[index].cpu_seconds, 0.);
+        BOOST_CHECK_LE(phases[index].peak_rss_delta_bytes, phases[index].peak_rss_bytes);
+    }
+    BOOST_CHECK_GE(phases[first].wall_seconds, phases[first + 1].wall_seconds);
+}
+
+BOOST_AUTO_TEST_CASE(write_report)
+{
+    {
+        PhaseReport report("osrm-test", PHASE_REPORT_TMP_FILE);
+        ProfilePhase phase("writing");
+    }
+
+    BOOST_REQUIRE(boost::filesystem::exists(PHASE_REPORT_TMP_FILE));
+    boost::filesystem::ifstream in(PHASE_REPORT_TMP_FILE);
+    const std::string json{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    boost::filesystem::remove(PHASE_REPORT_TMP_FILE);
+
+    BOOST_CHECK(json.find("\"tool\":\"osrm-test\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"name\":\"osrm-test\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"name\":\"writing\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"peak_rss_delta\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"bytes_written\"") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(no_report_without_path)
+{
+    {
+        PhaseReport report("osrm-test", "");
+    }
+    BOOST_CHECK(!boost::filesystem::exists(PHASE_REPORT_TMP_FILE));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
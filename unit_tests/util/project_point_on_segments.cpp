@@ -0,0 +1,81 @@
+#include "util/project_point_on_segments.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(project_point_on_segments_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(lat_to_y_matches_scalar)
+{
+    // covers both the approximated range and the poles, with a tail after the last vector
+    std::vector<double> latitudes;
+    for (double latitude = -89.5; latitude <= 89.5; latitude += 0.7)
+    {
+        latitudes.push_back(latitude);
+    }
+    latitudes.push_back(-70.);
+    latitudes.push_back(70.);
+    latitudes.push_back(70.1);
+
+    auto projected = latitudes;
+    web_mercator::latToYapprox(projected.data(), projected.size());
+    for (std::size_t index = 0; index < latitudes.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(projected[index],
+                          web_mercator::latToYapprox(FloatLatitude{latitudes[index]}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(projection_matches_scalar)
+{
+    std::mt19937 generator(13);
+    std::uniform_real_distribution<> lon_distribution(13.3, 13.4);
+    std::uniform_real_distribution<> lat_distribution(52.5, 52.6);
+
+    const std::size_t size = 37;
+    std::vector<double> source_lon, source_lat, target_lon, target_lat;
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        source_lon.push_back(lon_distribution(generator));
+        source_lat.push_back(lat_distribution(generator));
+        target_lon.push_back(lon_distribution(generator));
+        target_lat.push_back(lat_distribution(generator));
+    }
+    // a degenerated segment
+    target_lon[3] = source_lon[3];
+    target_lat[3] = source_lat[3];
+
+    const FloatCoordinate coordinate{FloatLongitude{13.35}, FloatLatitude{52.55}};
+    std::vector<double> nearest_lon(size), nearest_lat(size);
+    coordinate_calculation::projectPointOnSegments(coordinate,
+                                                   source_lon.data(),
+                                                   source_lat.data(),
+                                                   target_lon.data(),
+                                                   target_lat.data(),
+                                                   size,
+                                                   nearest_lon.data(),
+                                                   nearest_lat.data());
+
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        const auto expected = coordinate_calculation::projectPointOnSegment(
+                                  {FloatLongitude{source_lon[index]},
+                                   FloatLatitude{source_lat[index]}},
+                                  {FloatLongitude{target_lon[index]},
+                                   FloatLatitude{target_lat[index]}},
+                                  coordinate)
+                                  .second;
+        BOOST_CHECK_EQUAL(nearest_lon[index], static_cast<double>(expected.lon));
+        BOOST_CHECK_EQUAL(nearest_lat[index], static_cast<double>(expected.lat));
+    }
+    BOOST_CHECK_EQUAL(nearest_lon[3], source_lon[3]);
+    BOOST_CHECK_EQUAL(nearest_lat[3], source_lat[3]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
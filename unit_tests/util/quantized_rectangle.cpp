@@ -0,0 +1,94 @@
+#include "util/quantized_rectangle.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/mpl/list.hpp>
+
+#include <algorithm>
+#include <random>
+
+BOOST_AUTO_TEST_SUITE(quantized_rectangle_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+RectangleInt2D
+makeRectangle(const int min_lon, const int max_lon, const int min_lat, const int max_lat)
+{
+    return RectangleInt2D{FixedLongitude{min_lon},
+                          FixedLongitude{max_lon},
+                          FixedLatitude{min_lat},
+                          FixedLatitude{max_lat}};
+}
+
+bool contains(const RectangleInt2D &outer, const RectangleInt2D &inner)
+{
+    return outer.min_lon <= inner.min_lon && inner.max_lon <= outer.max_lon &&
+           outer.min_lat <= inner.min_lat && inner.max_lat <= outer.max_lat;
+}
+}
+
+using QuantizedRectangles =
+    boost::mpl::list<QuantizedRectangle<8>, QuantizedRectangle<16>, QuantizedRectangle<32>>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(decoded_contains_encoded, QuantizedRectangleT, QuantizedRectangles)
+{
+    std::mt19937 generator(42);
+    const auto frame = makeRectangle(13000000, 13500000, 52000000, 52400000);
+    std::uniform_int_distribution<> lon_distribution(13000000, 13500000);
+    std::uniform_int_distribution<> lat_distribution(52000000, 52400000);
+
+    for (int sample = 0; sample < 1000; ++sample)
+    {
+        auto lon = std::minmax(lon_distribution(generator), lon_distribution(generator));
+        auto lat = std::minmax(lat_distribution(generator), lat_distribution(generator));
+        const auto rectangle = makeRectangle(lon.first, lon.second, lat.first, lat.second);
+
+        const auto decoded = QuantizedRectangleT{frame, rectangle}.Decode(frame);
+        BOOST_CHECK(contains(decoded, rectangle));
+        BOOST_CHECK(contains(frame, decoded));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rounds_to_steps)
+{
+    // 255 steps of 2 per axis
+    const auto frame = makeRectangle(0, 510, -510, 0);
+
+    const auto exact = QuantizedRectangle<8>{frame, makeRectangle(10, 20, -20, -10)}.Decode(frame);
+    BOOST_CHECK(exact.min_lon == FixedLongitude{10});
+    BOOST_CHECK(exact.max_lon == FixedLongitude{20});
+    BOOST_CHECK(exact.min_lat == FixedLatitude{-20});
+    BOOST_CHECK(exact.max_lat == FixedLatitude{-10});
+
+    const auto rounded =
+        QuantizedRectangle<8>{frame, makeRectangle(11, 19, -19, -11)}.Decode(frame);
+    BOOST_CHECK(rounded.min_lon == FixedLongitude{10});
+    BOOST_CHECK(rounded.max_lon == FixedLongitude{20});
+    BOOST_CHECK(rounded.min_lat == FixedLatitude{-20});
+    BOOST_CHECK(rounded.max_lat == FixedLatitude{-10});
+
+    // the whole frame and degenerated frames
+    const auto whole = QuantizedRectangle<8>{frame, frame}.Decode(frame);
+    BOOST_CHECK(whole.min_lon == frame.min_lon && whole.max_lon == frame.max_lon);
+    BOOST_CHECK(whole.min_lat == frame.min_lat && whole.max_lat == frame.max_lat);
+
+    const auto point = makeRectangle(7, 7, 3, 3);
+    const auto decoded_point = QuantizedRectangle<8>{point, point}.Decode(point);
+    BOOST_CHECK(decoded_point.min_lon == FixedLongitude{7} &&
+                decoded_point.max_lon == FixedLongitude{7});
+    BOOST_CHECK(decoded_point.min_lat == FixedLatitude{3} &&
+                decoded_point.max_lat == FixedLatitude{3});
+}
+
+BOOST_AUTO_TEST_CASE(compact_sizes)
+{
+    BOOST_CHECK_EQUAL(sizeof(QuantizedRectangle<8>), 4);
+    BOOST_CHECK_EQUAL(sizeof(QuantizedRectangle<16>), 8);
+    BOOST_CHECK_EQUAL(sizeof(QuantizedRectangle<32>), sizeof(RectangleInt2D));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
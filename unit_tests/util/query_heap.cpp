@@ -24,9 +24,15 @@ typedef NodeID TestNodeID;
 typedef int TestKey;
 typedef int TestWeight;
 typedef boost::mpl::list<ArrayStorage<TestNodeID, TestKey>,
+                         GenerationArrayStorage<TestNodeID, TestKey>,
                          MapStorage<TestNodeID, TestKey>,
                          UnorderedMapStorage<TestNodeID, TestKey>>
     storage_types;
+typedef boost::mpl::list<BoostHeapContainer<TestWeight, TestKey>,
+                         DAryHeapContainer<TestWeight, TestKey, 2>,
+                         DAryHeapContainer<TestWeight, TestKey>,
+                         RadixHeapContainer<TestWeight, TestKey>>
+    container_types;
 
 template <unsigned NUM_ELEM> struct RandomDataFixture
 {
@@ -157,4 +163,110 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(decrease_key_test, T, storage_types, RandomData
     }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(clear_test, T, storage_types, RandomDataFixture<NUM_NODES>)
+{
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, T> heap(NUM_NODES);
+
+    for (unsigned idx : order)
+    {
+        heap.Insert(ids[idx], weights[idx], data[idx]);
+    }
+
+    // heaps are reused between queries, nothing of the last one may shine through
+    heap.Clear();
+    BOOST_CHECK(heap.Empty());
+    for (auto id : ids)
+    {
+        BOOST_CHECK(!heap.WasInserted(id));
+    }
+
+    heap.Insert(ids.back(), weights.back(), data.back());
+    BOOST_CHECK(heap.WasInserted(ids.back()));
+    BOOST_CHECK(!heap.WasInserted(ids.front()));
+    BOOST_CHECK_EQUAL(heap.GetData(ids.back()).value, data.back().value);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(container_delete_min_test,
+                                 T,
+                                 container_types,
+                                 RandomDataFixture<NUM_NODES>)
+{
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, ArrayStorage<TestNodeID, TestKey>, T>
+        heap(NUM_NODES);
+
+    for (unsigned idx : order)
+    {
+        heap.Insert(ids[idx], weights[idx], data[idx]);
+    }
+    BOOST_CHECK_EQUAL(heap.Size(), NUM_NODES);
+
+    for (auto id : ids)
+    {
+        BOOST_CHECK(!heap.WasRemoved(id));
+        BOOST_CHECK_EQUAL(heap.MinKey(), weights[id]);
+        BOOST_CHECK_EQUAL(id, heap.DeleteMin());
+        BOOST_CHECK(heap.WasRemoved(id));
+    }
+    BOOST_CHECK(heap.Empty());
+
+    for (unsigned idx : order)
+    {
+        heap.Insert(ids[idx], weights[idx], data[idx]);
+    }
+    heap.DeleteAll();
+    BOOST_CHECK(heap.Empty());
+    BOOST_CHECK(heap.WasRemoved(ids.front()));
+}
+
+// Runs Dijkstra the way the routing algorithms do, so decrease-key stays monotone
+BOOST_AUTO_TEST_CASE_TEMPLATE(container_dijkstra_test, T, container_types)
+{
+    constexpr unsigned num_nodes = 1000;
+    constexpr unsigned num_edges = 5000;
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<TestNodeID> node_distribution(0, num_nodes - 1);
+    std::uniform_int_distribution<TestWeight> weight_distribution(0, 20);
+    std::vector<std::vector<std::pair<TestNodeID, TestWeight>>> adjacency(num_nodes);
+    for (unsigned edge = 0; edge < num_edges; ++edge)
+    {
+        adjacency[node_distribution(generator)].emplace_back(node_distribution(generator),
+                                                             weight_distribution(generator));
+    }
+
+    const auto dijkstra = [&](auto &heap, const TestNodeID source) {
+        std::vector<TestWeight> distances(num_nodes, std::numeric_limits<TestWeight>::max());
+        heap.Clear();
+        // negative source weights like the phantom node offsets
+        heap.Insert(source, -10, {source});
+        while (!heap.Empty())
+        {
+            const auto weight = heap.MinKey();
+            const auto node = heap.DeleteMin();
+            distances[node] = weight;
+            for (const auto &edge : adjacency[node])
+            {
+                const auto to_weight = weight + edge.second;
+                if (!heap.WasInserted(edge.first))
+                    heap.Insert(edge.first, to_weight, {node});
+                else if (!heap.WasRemoved(edge.first) && to_weight < heap.GetKey(edge.first))
+                    heap.DecreaseKey(edge.first, to_weight);
+            }
+        }
+        return distances;
+    };
+
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, ArrayStorage<TestNodeID, TestKey>>
+        reference_heap(num_nodes);
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, ArrayStorage<TestNodeID, TestKey>, T>
+        heap(num_nodes);
+    for (const TestNodeID source : {0u, 17u, 999u})
+    {
+        const auto expected = dijkstra(reference_heap, source);
+        const auto actual = dijkstra(heap, source);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            actual.begin(), actual.end(), expected.begin(), expected.end());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
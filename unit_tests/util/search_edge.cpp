@@ -0,0 +1,54 @@
+#include "util/search_edge.hpp"
+#include "contractor/query_graph.hpp"
+#include "util/exception.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(search_edge_test)
+
+using namespace osrm;
+using namespace osrm::util;
+
+using EdgeArrayEntry = contractor::QueryGraph::EdgeArrayEntry;
+
+EdgeArrayEntry makeEdge(const NodeID target, const EdgeWeight weight, bool forward, bool backward)
+{
+    EdgeArrayEntry edge;
+    edge.target = target;
+    edge.data.turn_id = 7;
+    edge.data.weight = weight;
+    edge.data.duration = 2 * weight;
+    edge.data.forward = forward;
+    edge.data.backward = backward;
+    return edge;
+}
+
+BOOST_AUTO_TEST_CASE(fill_search_edges)
+{
+    const std::vector<EdgeArrayEntry> edges = {makeEdge(1, 10, true, false),
+                                               makeEdge(2, MAX_SEARCH_EDGE_WEIGHT, false, true)};
+    std::vector<SearchEdge> search_edges(edges.size());
+    fillSearchEdges(edges.begin(), edges.end(), search_edges.begin());
+
+    BOOST_CHECK_EQUAL(search_edges[0].target, 1);
+    BOOST_CHECK_EQUAL(search_edges[0].weight, 10);
+    BOOST_CHECK(search_edges[0].forward);
+    BOOST_CHECK(!search_edges[0].backward);
+    BOOST_CHECK_EQUAL(search_edges[1].target, 2);
+    BOOST_CHECK_EQUAL(search_edges[1].weight, MAX_SEARCH_EDGE_WEIGHT);
+    BOOST_CHECK(!search_edges[1].forward);
+    BOOST_CHECK(search_edges[1].backward);
+}
+
+BOOST_AUTO_TEST_CASE(weight_too_large)
+{
+    const std::vector<EdgeArrayEntry> edges = {
+        makeEdge(1, MAX_SEARCH_EDGE_WEIGHT + 1, true, true)};
+    std::vector<SearchEdge> search_edges(edges.size());
+    BOOST_CHECK_THROW(fillSearchEdges(edges.begin(), edges.end(), search_edges.begin()),
+                      util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
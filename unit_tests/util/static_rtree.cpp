@@ -170,6 +170,8 @@ struct GraphFixture
             d.forward_segment_id = {pair.second, true};
             d.reverse_segment_id = {pair.first, true};
             d.fwd_segment_position = 0;
+            d.forward_bearing = static_cast<unsigned short>(
+                std::round(coordinate_calculation::bearing(coords[d.u], coords[d.v])));
             edges.emplace_back(d);
         }
     }
@@ -364,11 +366,59 @@ BOOST_AUTO_TEST_CASE(radius_regression_test)
 
     {
         auto results =
-            query.NearestPhantomNodesInRange(input, 0.01, osrm::engine::Approach::UNRESTRICTED);
+            query.NearestCandidatesInRange(input, 0.01, osrm::engine::Approach::UNRESTRICTED);
         BOOST_CHECK_EQUAL(results.size(), 0);
     }
 }
 
+// Pruning by distance must not drop any segment within the radius
+BOOST_FIXTURE_TEST_CASE(radius_pruning_test, TestRandomGraphFixture_MultipleLevels)
+{
+    std::string leaves_path;
+    std::string nodes_path;
+    build_rtree<TestRandomGraphFixture_MultipleLevels>(
+        "test_radius_pruning", this, leaves_path, nodes_path);
+    TestStaticRTree rtree(nodes_path, leaves_path, coords);
+
+    std::mt19937 g(RANDOM_SEED);
+    std::uniform_int_distribution<> lat_udist(WORLD_MIN_LAT, WORLD_MAX_LAT);
+    std::uniform_int_distribution<> lon_udist(WORLD_MIN_LON, WORLD_MAX_LON);
+    using CandidateSegment = TestStaticRTree::CandidateSegment;
+    const auto accept_all = [](const CandidateSegment &) { return std::make_pair(true, true); };
+    for (unsigned i = 0; i < 100; i++)
+    {
+        const Coordinate input{FixedLongitude{lon_udist(g)}, FixedLatitude{lat_udist(g)}};
+        const auto within = [&input](const double max_distance) {
+            return [&input, max_distance](const std::size_t, const CandidateSegment &segment) {
+                return coordinate_calculation::haversineDistance(
+                           input, web_mercator::toWGS84(segment.fixed_projected_coordinate)) >
+                       max_distance;
+            };
+        };
+
+        for (const double max_distance : {10000., 500000., 2000000.})
+        {
+            const auto expected = rtree.Nearest(input, accept_all, within(max_distance));
+            const auto pruned = rtree.Nearest(input,
+                                              max_distance,
+                                              [](const TestData &) { return true; },
+                                              accept_all,
+                                              within(max_distance));
+            // segments at the same distance may come in a different order
+            const auto endpoints = [](const std::vector<TestData> &segments) {
+                std::vector<std::pair<NodeID, NodeID>> pairs;
+                for (const auto &segment : segments)
+                {
+                    pairs.emplace_back(segment.u, segment.v);
+                }
+                std::sort(pairs.begin(), pairs.end());
+                return pairs;
+            };
+            BOOST_CHECK(endpoints(pruned) == endpoints(expected));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(bearing_tests)
 {
     using Coord = std::pair<FloatLongitude, FloatLatitude>;
@@ -391,56 +441,56 @@ BOOST_AUTO_TEST_CASE(bearing_tests)
     Coordinate input(FloatLongitude{5.1}, FloatLatitude{5.0});
 
     {
-        auto results = query.NearestPhantomNodes(input, 5, osrm::engine::Approach::UNRESTRICTED);
+        auto results = query.NearestCandidates(input, 5, osrm::engine::Approach::UNRESTRICTED);
         BOOST_CHECK_EQUAL(results.size(), 2);
-        BOOST_CHECK_EQUAL(results.back().phantom_node.forward_segment_id.id, 0);
-        BOOST_CHECK_EQUAL(results.back().phantom_node.reverse_segment_id.id, 1);
+        BOOST_CHECK_EQUAL(results.back().data.forward_segment_id.id, 0);
+        BOOST_CHECK_EQUAL(results.back().data.reverse_segment_id.id, 1);
     }
 
     {
         auto results =
-            query.NearestPhantomNodes(input, 5, 270, 10, osrm::engine::Approach::UNRESTRICTED);
+            query.NearestCandidates(input, 5, 270, 10, osrm::engine::Approach::UNRESTRICTED);
         BOOST_CHECK_EQUAL(results.size(), 0);
     }
 
     {
         auto results =
-            query.NearestPhantomNodes(input, 5, 45, 10, osrm::engine::Approach::UNRESTRICTED);
+            query.NearestCandidates(input, 5, 45, 10, osrm::engine::Approach::UNRESTRICTED);
         BOOST_CHECK_EQUAL(results.size(), 2);
 
-        BOOST_CHECK(results[0].phantom_node.forward_segment_id.enabled);
-        BOOST_CHECK(!results[0].phantom_node.reverse_segment_id.enabled);
-        BOOST_CHECK_EQUAL(results[0].phantom_node.forward_segment_id.id, 1);
+        BOOST_CHECK(results[0].data.forward_segment_id.enabled);
+        BOOST_CHECK(!results[0].data.reverse_segment_id.enabled);
+        BOOST_CHECK_EQUAL(results[0].data.forward_segment_id.id, 1);
 
-        BOOST_CHECK(!results[1].phantom_node.forward_segment_id.enabled);
-        BOOST_CHECK(results[1].phantom_node.reverse_segment_id.enabled);
-        BOOST_CHECK_EQUAL(results[1].phantom_node.reverse_segment_id.id, 1);
+        BOOST_CHECK(!results[1].data.forward_segment_id.enabled);
+        BOOST_CHECK(results[1].data.reverse_segment_id.enabled);
+        BOOST_CHECK_EQUAL(results[1].data.reverse_segment_id.id, 1);
     }
 
     {
         auto results =
-            query.NearestPhantomNodesInRange(input, 11000, osrm::engine::Approach::UNRESTRICTED);
+            query.NearestCandidatesInRange(input, 11000, osrm::engine::Approach::UNRESTRICTED);
         BOOST_CHECK_EQUAL(results.size(), 2);
     }
 
     {
-        auto results = query.NearestPhantomNodesInRange(
+        auto results = query.NearestCandidatesInRange(
             input, 11000, 270, 10, osrm::engine::Approach::UNRESTRICTED);
         BOOST_CHECK_EQUAL(results.size(), 0);
     }
 
     {
-        auto results = query.NearestPhantomNodesInRange(
+        auto results = query.NearestCandidatesInRange(
             input, 11000, 45, 10, osrm::engine::Approach::UNRESTRICTED);
         BOOST_CHECK_EQUAL(results.size(), 2);
 
-        BOOST_CHECK(results[0].phantom_node.forward_segment_id.enabled);
-        BOOST_CHECK(!results[0].phantom_node.reverse_segment_id.enabled);
-        BOOST_CHECK_EQUAL(results[0].phantom_node.forward_segment_id.id, 1);
+        BOOST_CHECK(results[0].data.forward_segment_id.enabled);
+        BOOST_CHECK(!results[0].data.reverse_segment_id.enabled);
+        BOOST_CHECK_EQUAL(results[0].data.forward_segment_id.id, 1);
 
-        BOOST_CHECK(!results[1].phantom_node.forward_segment_id.enabled);
-        BOOST_CHECK(results[1].phantom_node.reverse_segment_id.enabled);
-        BOOST_CHECK_EQUAL(results[1].phantom_node.reverse_segment_id.id, 1);
+        BOOST_CHECK(!results[1].data.forward_segment_id.enabled);
+        BOOST_CHECK(results[1].data.reverse_segment_id.enabled);
+        BOOST_CHECK_EQUAL(results[1].data.reverse_segment_id.id, 1);
     }
 }
 
@@ -4,6 +4,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(string_util)
 
@@ -22,6 +24,16 @@ BOOST_AUTO_TEST_CASE(json_escaping)
     BOOST_CHECK_EQUAL(output, "Aleja \\\"Solidarnosci\\\"");
 }
 
+BOOST_AUTO_TEST_CASE(json_escaping_into_buffer)
+{
+    std::vector<char> output{'"'};
+    escape_JSON("a/b\n\"c\"", output);
+    output.push_back('"');
+
+    const std::string rendered(output.begin(), output.end());
+    BOOST_CHECK_EQUAL(rendered, "\"a\\/b\\n\\\"c\\\"\"");
+}
+
 BOOST_AUTO_TEST_CASE(print_int)
 {
     const std::string input{"\b\\"};